@@ -53,6 +53,17 @@ void TFE_OpReset(TFE_Op* op_to_reset, const char* op_or_function_name,
   }
 }
 
+void TFE_OpFreeze(TFE_Op* op, TF_Status* status) {
+  tensorflow::ImmediateExecutionOperation* operation = tensorflow::unwrap(op);
+  if (!tensorflow::EagerOperation::classof(operation)) {
+    status->status = tensorflow::errors::Unimplemented(
+        "TFE_OpFreeze is only supported for eager operations");
+    return;
+  }
+  tensorflow::OperationFromInterface(operation)->Freeze();
+  status->status = ::tensorflow::OkStatus();
+}
+
 void TFE_ContextEnableGraphCollection(TFE_Context* ctx) {
   tensorflow::unwrap(ctx)->SetShouldStoreGraphs(true);
 }
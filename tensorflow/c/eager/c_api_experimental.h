@@ -34,6 +34,14 @@ TF_CAPI_EXPORT extern void TFE_OpReset(TFE_Op* op_to_reset,
                                        const char* raw_device_name,
                                        TF_Status* status);
 
+// Freezes `op` for repeated executions with new inputs, which are added with
+// `TFE_OpAddInput` or `TFE_OpAddInputList` after every `TFE_Execute` clears
+// them. The attributes inferred from the inputs of the first execution are
+// kept, and the kernel it resolves is reused by the later executions whose
+// inputs have the same dtypes and devices, which skips the placement of the op
+// and the hashing of its attributes. `TFE_OpReset` unfreezes `op`.
+TF_CAPI_EXPORT extern void TFE_OpFreeze(TFE_Op* op, TF_Status* status);
+
 // Enables only graph collection in RunMetadata on the functions executed from
 // this context.
 TF_CAPI_EXPORT extern void TFE_ContextEnableGraphCollection(TFE_Context* ctx);
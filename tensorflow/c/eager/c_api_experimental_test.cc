@@ -368,6 +368,72 @@ void Executor_MatMul_CPU(bool async) {
 TEST(CAPI, Executor_MatMul_CPU) { Executor_MatMul_CPU(false); }
 TEST(CAPI, Executor_MatMul_CPUAsync) { Executor_MatMul_CPU(true); }
 
+TEST(CAPI, FrozenOp) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  TFE_TensorHandle* one = TestScalarTensorHandle(ctx, 1.0f);
+  TFE_Op* add = AddOp(ctx, one, one);
+  TFE_OpFreeze(add, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteTensorHandle(one);
+
+  // The frozen op is executed with new inputs.
+  for (float value : {1.0f, 2.0f, 3.0f}) {
+    if (value != 1.0f) {
+      TFE_TensorHandle* input = TestScalarTensorHandle(ctx, value);
+      TFE_OpAddInput(add, input, status);
+      ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+      TFE_OpAddInput(add, input, status);
+      ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+      TFE_DeleteTensorHandle(input);
+    }
+    TFE_TensorHandle* retval = nullptr;
+    int num_retvals = 1;
+    TFE_Execute(add, &retval, &num_retvals, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TF_Tensor* t = TFE_TensorHandleResolve(retval, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    EXPECT_EQ(2 * value, *static_cast<float*>(TF_TensorData(t)));
+    TF_DeleteTensor(t);
+    TFE_DeleteTensorHandle(retval);
+  }
+
+  // The attributes inferred from the first inputs are kept.
+  TFE_TensorHandle* int_input = TestScalarTensorHandle(ctx, 1);
+  TFE_OpAddInput(add, int_input, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_OpAddInput(add, int_input, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_TensorHandle* retval = nullptr;
+  int num_retvals = 1;
+  TFE_Execute(add, &retval, &num_retvals, status);
+  EXPECT_NE(TF_OK, TF_GetCode(status));
+
+  // Resetting the op unfreezes it.
+  TFE_OpReset(add, "AddV2", nullptr, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_OpAddInput(add, int_input, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_OpAddInput(add, int_input, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_Execute(add, &retval, &num_retvals, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TF_Tensor* t = TFE_TensorHandleResolve(retval, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(2, *static_cast<int*>(TF_TensorData(t)));
+  TF_DeleteTensor(t);
+  TFE_DeleteTensorHandle(retval);
+  TFE_DeleteTensorHandle(int_input);
+
+  TFE_DeleteOp(add);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+
 void Deleter(void* data, size_t unused, void* tensor_handle) {
   TFE_DeleteTensorHandle(static_cast<TFE_TensorHandle*>(tensor_handle));
 }
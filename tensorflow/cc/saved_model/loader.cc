@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/fingerprinting.h"
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/cc/saved_model/util.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_def.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
@@ -258,9 +260,54 @@ Status RunRestore(const RunOptions& run_options, const string& export_dir,
 
   AddAssetsTensorsToInputs(export_dir, asset_file_defs, &inputs);
 
+  const uint64 restore_start_microseconds = Env::Default()->NowMicros();
   RunMetadata run_metadata;
-  return RunOnce(run_options, inputs, {}, {string(restore_op_name)},
-                 nullptr /* outputs */, &run_metadata, session);
+  TF_RETURN_IF_ERROR(RunOnce(run_options, inputs, {},
+                             {string(restore_op_name)}, nullptr /* outputs */,
+                             &run_metadata, session));
+  const uint64 restore_microseconds =
+      GetLatencyMicroseconds(restore_start_microseconds);
+  metrics::CheckpointReadDuration(kCCLoadLabel).Add(restore_microseconds);
+
+  // Failing to stat the data files only affects the metrics.
+  std::vector<string> data_files;
+  int64_t restored_bytes = 0;
+  if (Env::Default()
+          ->GetMatchingPaths(strings::StrCat(variables_path, ".data-*"),
+                             &data_files)
+          .ok()) {
+    for (const string& data_file : data_files) {
+      uint64 file_size = 0;
+      if (Env::Default()->GetFileSize(data_file, &file_size).ok()) {
+        restored_bytes += file_size;
+      }
+    }
+  }
+  metrics::CheckpointRestoredBytes(kCCLoadLabel).IncrementBy(restored_bytes);
+  LOG(INFO) << "Restored " << restored_bytes << " bytes of variables in "
+            << restore_microseconds << " microseconds.";
+  return OkStatus();
+}
+
+// Makes the RestoreV2 ops of `graph_def` map the tensors they restore instead
+// of reading them, so the variables assigned from them are only read from the
+// checkpoint when first used.
+void MarkRestoreOpsForMapping(GraphDef* graph_def) {
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    if (node.op() == "RestoreV2") {
+      (*node.mutable_attr())[kMapRestoredTensorsAttr].set_b(true);
+    }
+  }
+}
+
+// Makes the RestoreV2 ops of `graph_def` share the tensors they restore with
+// identical tensors restored by other models loaded in this process.
+void MarkRestoreOpsForSharing(GraphDef* graph_def) {
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    if (node.op() == "RestoreV2") {
+      (*node.mutable_attr())[kShareRestoredTensorsAttr].set_b(true);
+    }
+  }
 }
 
 }  // namespace
@@ -284,6 +331,14 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                               SavedModelBundle* const bundle) {
   TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
                                                     &bundle->meta_graph_def));
+  if (session_options.config.experimental()
+          .lazy_load_saved_model_variables()) {
+    MarkRestoreOpsForMapping(bundle->meta_graph_def.mutable_graph_def());
+  }
+  if (session_options.config.experimental()
+          .share_identical_saved_model_variables()) {
+    MarkRestoreOpsForSharing(bundle->meta_graph_def.mutable_graph_def());
+  }
   TF_RETURN_IF_ERROR(
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
   TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
@@ -97,6 +97,13 @@ auto* checkpoint_read_durations = monitoring::Sampler<1>::New(
     // Scale of 1000, growth factor of 1.5 with upper bound of ~184 minutes.
     monitoring::Buckets::Exponential(1000, 1.5, 41));
 
+// Counter that accumulates the size of the data files of restored checkpoints.
+auto* checkpoint_restored_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/core/checkpoint/read/restored_bytes",
+    "Total size in bytes of the data files of the checkpoints successfully "
+    "restored.",
+    "api_label");
+
 // Distribution of async checkpoint write durations.
 auto* async_checkpoint_write_durations = monitoring::Sampler<1>::New(
     {
@@ -165,6 +172,10 @@ monitoring::SamplerCell& CheckpointReadDuration(absl::string_view api_label) {
   return *checkpoint_read_durations->GetCell(std::string(api_label));
 }
 
+monitoring::CounterCell& CheckpointRestoredBytes(absl::string_view api_label) {
+  return *checkpoint_restored_bytes->GetCell(std::string(api_label));
+}
+
 monitoring::SamplerCell& CheckpointWriteDuration(absl::string_view api_label) {
   return *checkpoint_write_durations->GetCell(std::string(api_label));
 }
@@ -71,6 +71,11 @@ monitoring::CounterCell& SavedModelReadApi(absl::string_view api_label);
 // field `api_label`.
 monitoring::SamplerCell& CheckpointReadDuration(absl::string_view api_label);
 
+// Returns "/tensorflow/core/checkpoint/read/restored_bytes" cell belonging to
+// field `api_label`. It is incremented by the size of the data files of each
+// checkpoint that is successfully restored.
+monitoring::CounterCell& CheckpointRestoredBytes(absl::string_view api_label);
+
 // Returns "/tensorflow/core/checkpoint/write/write_durations" cell belonging to
 // field `api_label`.
 monitoring::SamplerCell& CheckpointWriteDuration(absl::string_view api_label);
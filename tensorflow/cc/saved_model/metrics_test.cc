@@ -49,6 +49,12 @@ TEST(MetricsTest, TestCheckpointRead) {
   EXPECT_EQ(CheckpointReadDuration("foo").value().num(), 1);
 }
 
+TEST(MetricsTest, TestCheckpointRestoredBytes) {
+  EXPECT_EQ(CheckpointRestoredBytes("foo").value(), 0);
+  CheckpointRestoredBytes("foo").IncrementBy(100);
+  EXPECT_EQ(CheckpointRestoredBytes("foo").value(), 100);
+}
+
 TEST(MetricsTest, TestCheckpointWrite) {
   EXPECT_EQ(CheckpointWriteDuration("foo").value().num(), 0);
   CheckpointWriteDuration("foo").Add(100);
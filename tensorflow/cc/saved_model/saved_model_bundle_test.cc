@@ -141,6 +141,37 @@ TEST_F(LoaderTest, TagMatch) {
   CheckSavedModelBundle(export_dir, bundle);
 }
 
+TEST_F(LoaderTest, LazyLoadVariables) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  session_options.config.mutable_experimental()
+      ->set_lazy_load_saved_model_variables(true);
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  CheckSavedModelBundle(export_dir, bundle);
+}
+
+TEST_F(LoaderTest, ShareIdenticalVariables) {
+  SessionOptions session_options;
+  session_options.config.mutable_experimental()
+      ->set_share_identical_saved_model_variables(true);
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  SavedModelBundle bundle, other_bundle;
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &other_bundle));
+  CheckSavedModelBundle(export_dir, bundle);
+  CheckSavedModelBundle(export_dir, other_bundle);
+}
+
 TEST_F(LoaderTest, ReadMetaGraphFromSavedModel) {
   SavedModelBundle bundle;
   SessionOptions session_options;
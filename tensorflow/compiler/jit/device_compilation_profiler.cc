@@ -62,8 +62,9 @@ void RegisterExecutionForCluster(
 // signature before  we attempt to compile it.
 constexpr int64_t kDefaultCompilationThreshold = 2;
 
-// Maximum number of ongoing compilations.
-constexpr int64_t kMaxNumOngoingCompilations = kNumAsyncDeviceCompilerThreads;
+// Maximum number of ongoing (running or queued) asynchronous compilations.
+constexpr int64_t kMaxNumOngoingCompilations =
+    kMaxNumOngoingAsyncDeviceCompilations;
 
 }  // namespace
 
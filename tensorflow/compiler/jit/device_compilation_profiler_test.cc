@@ -189,8 +189,7 @@ TEST(DeviceCompilationProfilerTest, ShouldCompileClusterAsync) {
   NameAttrList function;
   function.set_name("TestFunc");
 
-  const int64_t kMaxNumOngoingCompilations = 10;
-  for (int i = 0; i < kMaxNumOngoingCompilations; ++i) {
+  for (int i = 0; i < kMaxNumOngoingAsyncDeviceCompilations; ++i) {
     profiler->IncrementOngoingAsyncCompilations();
   }
 
@@ -0,0 +1,85 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/device_compilation_queue.h"
+
+#include <utility>
+#include <vector>
+
+namespace tensorflow {
+
+void DeviceCompilationQueue::Enqueue(const Signature& signature,
+                                     int64_t priority,
+                                     std::function<void()> compile,
+                                     std::function<void()> cancel) {
+  mutex_lock lock(mu_);
+  PendingCompilation& pending = pending_[signature];
+  pending.priority = priority;
+  pending.last_request_us = env_->NowMicros();
+  if (!pending.compile) {
+    pending.compile = std::move(compile);
+    pending.cancel = std::move(cancel);
+  }
+}
+
+bool DeviceCompilationQueue::RecordRequest(const Signature& signature,
+                                           int64_t priority) {
+  mutex_lock lock(mu_);
+  auto it = pending_.find(signature);
+  if (it == pending_.end()) return false;
+  it->second.priority = priority;
+  it->second.last_request_us = env_->NowMicros();
+  return true;
+}
+
+std::optional<std::function<void()>> DeviceCompilationQueue::Pop() {
+  std::vector<std::function<void()>> cancelled;
+  std::optional<std::function<void()>> compile;
+  {
+    mutex_lock lock(mu_);
+    const uint64_t now_us = env_->NowMicros();
+    auto best = pending_.end();
+    for (auto it = pending_.begin(); it != pending_.end();) {
+      if (now_us - it->second.last_request_us >
+          static_cast<uint64_t>(staleness_us_)) {
+        cancelled.push_back(std::move(it->second.cancel));
+        pending_.erase(it++);
+        continue;
+      }
+      if (best == pending_.end() ||
+          it->second.priority > best->second.priority) {
+        best = it;
+      }
+      ++it;
+    }
+    if (best != pending_.end()) {
+      compile = std::move(best->second.compile);
+      pending_.erase(best);
+    }
+  }
+  // Invoke the callbacks without holding the lock, as they may re-enter the
+  // queue.
+  for (auto& cancel : cancelled) {
+    if (cancel) cancel();
+  }
+  return compile;
+}
+
+int64_t DeviceCompilationQueue::size() const {
+  mutex_lock lock(mu_);
+  return pending_.size();
+}
+
+}  // namespace tensorflow
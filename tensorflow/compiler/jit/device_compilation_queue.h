@@ -0,0 +1,86 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_QUEUE_H_
+#define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_QUEUE_H_
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Holds asynchronous cluster compilations that have been requested but not
+// started yet. Compilations are handed out in order of how often their cluster
+// signature has been requested, so that the hottest clusters of a warming up
+// model get compiled first. Compilations for signatures that have not been
+// requested for `staleness_us` are cancelled instead of being compiled.
+//
+// Thread-safe.
+class DeviceCompilationQueue {
+ public:
+  using Signature = DeviceCompilationClusterSignature;
+
+  // `env` is used to read the current time and must outlive the queue.
+  DeviceCompilationQueue(Env* env, int64_t staleness_us)
+      : env_(env), staleness_us_(staleness_us) {}
+
+  // Adds a compilation for `signature` with the given `priority` (typically
+  // its request count). `compile` is invoked when the compilation gets popped
+  // and `cancel` if it is dropped instead. If a compilation for `signature` is
+  // already pending this behaves like `RecordRequest`.
+  void Enqueue(const Signature& signature, int64_t priority,
+               std::function<void()> compile, std::function<void()> cancel);
+
+  // Records a new request for `signature` with its updated `priority`. Returns
+  // false if no compilation is pending for `signature`.
+  bool RecordRequest(const Signature& signature, int64_t priority);
+
+  // Removes the pending compilation with the highest priority and returns its
+  // `compile` callback. Stale compilations encountered along the way are
+  // removed and their `cancel` callbacks invoked. Returns std::nullopt if no
+  // compilation is pending.
+  std::optional<std::function<void()>> Pop();
+
+  // Returns the number of pending compilations.
+  int64_t size() const;
+
+ private:
+  struct PendingCompilation {
+    int64_t priority;
+    uint64_t last_request_us;
+    std::function<void()> compile;
+    std::function<void()> cancel;
+  };
+
+  Env* const env_;
+  const int64_t staleness_us_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<Signature, PendingCompilation, Signature::Hash> pending_
+      TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeviceCompilationQueue);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_QUEUE_H_
@@ -0,0 +1,93 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/device_compilation_queue.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/fake_clock_env.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64_t kStalenessUs = 1000;
+
+DeviceCompilationClusterSignature BuildSignature(const std::string& name) {
+  NameAttrList fn;
+  fn.set_name(name);
+  std::vector<XlaCompiler::Argument> args(1);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({4});
+  return DeviceCompilationClusterSignature::Build(fn, args).value();
+}
+
+TEST(DeviceCompilationQueueTest, PopsHighestPriorityFirst) {
+  FakeClockEnv env(Env::Default());
+  DeviceCompilationQueue queue(&env, kStalenessUs);
+
+  std::vector<std::string> compiled;
+  for (const auto& [name, priority] :
+       std::vector<std::pair<std::string, int64_t>>{
+           {"a", 1}, {"b", 5}, {"c", 3}}) {
+    queue.Enqueue(
+        BuildSignature(name), priority,
+        [&compiled, name = name] { compiled.push_back(name); }, nullptr);
+  }
+  // Requests for an already queued cluster raise its priority.
+  EXPECT_TRUE(queue.RecordRequest(BuildSignature("a"), 4));
+  EXPECT_FALSE(queue.RecordRequest(BuildSignature("d"), 10));
+  EXPECT_EQ(queue.size(), 3);
+
+  while (auto compile = queue.Pop()) {
+    (*compile)();
+  }
+  EXPECT_EQ(compiled, (std::vector<std::string>{"b", "a", "c"}));
+  EXPECT_EQ(queue.size(), 0);
+  EXPECT_FALSE(queue.Pop().has_value());
+}
+
+TEST(DeviceCompilationQueueTest, CancelsStaleCompilations) {
+  FakeClockEnv env(Env::Default());
+  DeviceCompilationQueue queue(&env, kStalenessUs);
+
+  int num_compiled = 0;
+  std::vector<std::string> cancelled;
+  queue.Enqueue(
+      BuildSignature("cold"), 10, [&num_compiled] { ++num_compiled; },
+      [&cancelled] { cancelled.push_back("cold"); });
+  queue.Enqueue(
+      BuildSignature("hot"), 1, [&num_compiled] { ++num_compiled; },
+      [&cancelled] { cancelled.push_back("hot"); });
+
+  // Only the "hot" cluster keeps being requested.
+  env.AdvanceByMicroseconds(kStalenessUs);
+  EXPECT_TRUE(queue.RecordRequest(BuildSignature("hot"), 2));
+  env.AdvanceByMicroseconds(1);
+
+  auto compile = queue.Pop();
+  ASSERT_TRUE(compile.has_value());
+  (*compile)();
+  EXPECT_EQ(num_compiled, 1);
+  EXPECT_EQ(cancelled, std::vector<std::string>{"cold"});
+  EXPECT_EQ(queue.size(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_compilation_cache.h"
 #include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
+#include "tensorflow/compiler/jit/device_compilation_queue.h"
 #include "tensorflow/compiler/jit/device_compiler_client.h"
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
 #include "tensorflow/compiler/jit/flags.h"
@@ -145,13 +146,16 @@ class DeviceCompiler : public ResourceBase {
       DeviceCompilationProfiler* profiler, mutex* mu)
       TF_EXCLUSIVE_LOCKS_REQUIRED(*mu);
 
+  // Queues a background compilation of `sig`. Queued compilations are started
+  // in order of their `request_count`; see DeviceCompilationQueue.
   Status CompileAsynchronous(const DeviceCompilationClusterSignature& sig,
                              const XlaCompiler::CompileOptions& compile_options,
                              const XlaCompiler::Options& options,
                              const std::vector<XlaCompiler::Argument>& args,
                              const NameAttrList& function, CompileScope scope,
                              OpKernelContext* ctx,
-                             DeviceCompilationProfiler* profiler);
+                             DeviceCompilationProfiler* profiler,
+                             int64_t request_count);
 
   std::unique_ptr<DeviceExecutablePersistor<ExecutableType, ClientType>>
       persistor_;
@@ -159,6 +163,9 @@ class DeviceCompiler : public ResourceBase {
       compiler_client_;
   std::unique_ptr<DeviceCompilationCache<ExecutableType>> cache_;
 
+  // Asynchronous compilations waiting for a compiler thread.
+  std::unique_ptr<DeviceCompilationQueue> async_compilation_queue_;
+
   // Pool of threads for asynchronous compilations.
   std::unique_ptr<thread::ThreadPool> async_compiler_threads_;
 
@@ -205,6 +212,8 @@ DeviceCompiler<ExecutableType, ClientType>::DeviceCompiler(
     : persistor_(std::move(persistor)),
       compiler_client_(std::move(compiler_client)) {
   cache_ = std::make_unique<DeviceCompilationCache<ExecutableType>>();
+  async_compilation_queue_ = std::make_unique<DeviceCompilationQueue>(
+      tensorflow::Env::Default(), kAsyncDeviceCompilationStalenessUs);
   async_compiler_threads_ = std::make_unique<tensorflow::thread::ThreadPool>(
       tensorflow::Env::Default(), "async_compiler_threads",
       kNumAsyncDeviceCompilerThreads);
@@ -347,7 +356,7 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
     const XlaCompiler::Options& options,
     const std::vector<XlaCompiler::Argument>& args,
     const NameAttrList& function, CompileScope scope, OpKernelContext* ctx,
-    DeviceCompilationProfiler* profiler) {
+    DeviceCompilationProfiler* profiler, int64_t request_count) {
   // Explicitly capture all required data by value for async compilation.
   // Update compilation state in cache.
   cache_->Store(signature, DeviceCompileState::kCompiling, std::nullopt,
@@ -363,7 +372,7 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
   // All values are captured by value. Make sure that all pointer values (like
   // entry) do not get freed until the lambda has finished.
   const std::string& function_name = function.name();
-  async_compiler_threads_->Schedule([=] {
+  auto compile = [=] {
     VLOG(2) << "Starting asynchronous compilation of cluster " << function_name
             << '.';
     // We don't need to lock mu, but do it anyway to satisfy thread safety
@@ -381,6 +390,25 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
       cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
                     std::nullopt);
     }
+  };
+  // Compilations of clusters that stopped being executed before a compiler
+  // thread picked them up are dropped. The cluster is compiled again if it
+  // gets executed later on.
+  auto cancel = [=] {
+    VLOG(2) << "Cancelled asynchronous compilation of cluster "
+            << function_name << " as it is no longer being executed.";
+    profiler->DecrementOngoingAsyncCompilations();
+    cache_->Store(signature, DeviceCompileState::kUncompiled, std::nullopt,
+                  std::nullopt, std::nullopt);
+  };
+  async_compilation_queue_->Enqueue(signature, request_count,
+                                    std::move(compile), std::move(cancel));
+  // Every queued compilation schedules one pop, so the queue is drained by
+  // the time the thread pool is destroyed.
+  async_compiler_threads_->Schedule([this] {
+    if (auto queued_compile = async_compilation_queue_->Pop()) {
+      (*queued_compile)();
+    }
   });
   return OkStatus();
 }
@@ -464,9 +492,9 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     } else if (compile_mode == DeviceCompileMode::kAsync) {
       VLOG(2) << "Queueing asynchronous compilation for signature: "
               << human_signature;
-      TF_RETURN_IF_ERROR(CompileAsynchronous(signature, compile_options,
-                                             options, args, function, scope,
-                                             ctx, profiler));
+      TF_RETURN_IF_ERROR(CompileAsynchronous(
+          signature, compile_options, options, args, function, scope, ctx,
+          profiler, current_request_count));
       return OkStatus();
     } else {
       VLOG(2) << "Instantly compiling for signature: " << human_signature;
@@ -478,6 +506,8 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
   } else if (state == DeviceCompileState::kCompiling) {
     VLOG(2) << "Ongoing asynchronous compilation for signature: "
             << human_signature;
+    // Bump the priority of the compilation if it hasn't started yet.
+    async_compilation_queue_->RecordRequest(signature, current_request_count);
     return OkStatus();
   } else if (state == DeviceCompileState::kCompiled) {
     VLOG(2) << "Already Compiled for signature: " << human_signature;
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -59,6 +60,17 @@ class DeviceExecutablePersistor {
 
     // The cache persistence prefix to use if serializing/deserialzing entries.
     std::string persistence_prefix;
+
+    // If true, entries are only loaded from `persistent_cache_directory` and
+    // newly compiled executables are never written back. Useful when the
+    // directory is shared by many processes and populated by only a few.
+    bool persistent_cache_read_only = false;
+
+    // Describes everything besides the cluster signature and the HLO that
+    // affects the generated executable (e.g. XLA compiler flags and the
+    // device model). Entries persisted under a different compilation
+    // environment are never loaded.
+    std::string compilation_environment;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -93,6 +105,9 @@ class DeviceExecutablePersistor {
   const std::string& persistent_cache_directory() const {
     return persistent_cache_directory_;
   }
+  bool persistent_cache_read_only() const {
+    return persistent_cache_read_only_;
+  }
 
  private:
   // Returns a cache key proto that identifies an entry in the compilation
@@ -108,7 +123,9 @@ class DeviceExecutablePersistor {
       DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const;
 
   // Saves the cache entry in the file directory supplied during the
-  // construction of this class. Overwrites existing entries.
+  // construction of this class. Overwrites existing entries. The entry is
+  // published atomically so that it is safe to read concurrently, including
+  // from other processes sharing the directory.
   Status SaveSerializedEntry(const XlaSerializedCacheEntry& entry) const;
 
   // Tries to read a cache entry given a `key` by searching the file directory
@@ -134,6 +151,12 @@ class DeviceExecutablePersistor {
   // specified file system directory path.
   const std::string persistent_cache_directory_;
 
+  // If true, executables are never saved to `persistent_cache_directory_`.
+  const bool persistent_cache_read_only_;
+
+  // Fingerprint of the compilation environment, or 0 if none was provided.
+  const uint64 compilation_environment_fingerprint_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(DeviceExecutablePersistor);
 };
 
@@ -144,7 +167,12 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
     : device_type_(device_type),
       disable_strict_signature_checks_(config.disable_strict_signature_checks),
       persistence_prefix_(config.persistence_prefix),
-      persistent_cache_directory_(config.persistent_cache_directory) {}
+      persistent_cache_directory_(config.persistent_cache_directory),
+      persistent_cache_read_only_(config.persistent_cache_read_only),
+      compilation_environment_fingerprint_(
+          config.compilation_environment.empty()
+              ? 0
+              : Fingerprint64(config.compilation_environment)) {}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
@@ -154,7 +182,11 @@ std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
-      key.device_type());
+      key.device_type(),
+      key.compilation_environment_fingerprint() == 0
+          ? ""
+          : absl::StrCat(kXlaSerializedCacheKeySeparator,
+                         key.compilation_environment_fingerprint()));
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -175,6 +207,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
       DeterministicProtoHash64(hlo_module));
   serialized_cache_key.set_device_type(device_type().type_string());
   serialized_cache_key.set_prefix(persistence_prefix());
+  serialized_cache_key.set_compilation_environment_fingerprint(
+      compilation_environment_fingerprint_);
   return serialized_cache_key;
 }
 
@@ -234,7 +268,22 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
   Env* env = Env::Default();
   TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_directory_));
   const std::string file_path = GetFilePath(entry.key());
-  return WriteBinaryProto(env, file_path, entry);
+
+  // Write to a uniquely named temporary file first and then rename it into
+  // place, so that readers never observe a partially written entry.
+  std::string tmp_file_path = file_path;
+  if (!env->CreateUniqueFileName(&tmp_file_path, ".tmp")) {
+    return errors::Internal("Unable to create a temporary file name for ",
+                            file_path);
+  }
+  Status status = WriteBinaryProto(env, tmp_file_path, entry);
+  if (status.ok()) {
+    status = env->RenameFile(tmp_file_path, file_path);
+  }
+  if (!status.ok()) {
+    env->DeleteFile(tmp_file_path).IgnoreError();
+  }
+  return status;
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -321,6 +370,10 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
                "provided.";
     return OkStatus();
   }
+  if (persistent_cache_read_only_) {
+    VLOG(1) << "Not persisting executable. The persistent cache is read-only.";
+    return OkStatus();
+  }
 
   XLA_SCOPED_LOGGING_TIMER(
       absl::StrCat("Serializing and saving cache entry: ", signature_str));
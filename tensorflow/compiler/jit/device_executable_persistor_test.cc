@@ -24,6 +24,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/strings/match.h"
 #include "tensorflow/cc/framework/scope.h"
 #include "tensorflow/cc/ops/function_ops.h"
 #include "tensorflow/cc/ops/math_ops.h"
@@ -479,5 +480,72 @@ TEST_F(DeviceExecutionPersistorTest, LoadSerializedExecutableEmpty) {
               testing::StatusIs(error::INVALID_ARGUMENT));
 }
 
+TEST_F(DeviceExecutionPersistorTest, PersistReadOnly) {
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir_,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  config.persistent_cache_read_only = true;
+  XlaDeviceExecutablePersistor persistor(config, DefaultOptions().device_type);
+
+  MockCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_)).Times(0);
+  EXPECT_CALL(mock_client, BuildSerializedExecutable(_, _)).Times(0);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/456, "signature_string", DefaultOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  auto key =
+      CreateCacheKey(/*signature_hash=*/456, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  auto entry = ReadCacheEntryFromFile(key, cache_dir_);
+  EXPECT_FALSE(entry.ok());
+}
+
+TEST_F(DeviceExecutionPersistorTest, LoadCompilationEnvironmentMismatch) {
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir_,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  config.compilation_environment = "environment_a";
+  XlaDeviceExecutablePersistor persistor(config, DefaultOptions().device_type);
+
+  MockCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(StatusOr<std::string>(serialized_executable_)));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_ASSERT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/789, "signature_string", DefaultOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  // The entry is published under its final name, without leaving any
+  // temporary files behind.
+  std::vector<std::string> file_names;
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir_, &file_names));
+  for (const std::string& file_name : file_names) {
+    EXPECT_FALSE(absl::EndsWith(file_name, ".tmp")) << file_name;
+  }
+
+  EXPECT_CALL(mock_client, LoadExecutable(_, _, serialized_executable_))
+      .WillOnce(Return(ByMove(std::move(executable))));
+  auto loaded_executable = persistor.TryToLoadExecutable(
+      /*signature_hash=*/789, "signature_string", DefaultOptions(),
+      compilation_result_add_, &mock_client);
+  ASSERT_TRUE(loaded_executable.has_value());
+  EXPECT_TRUE(loaded_executable->ok());
+
+  // A process with different compiler flags or device must not pick up the
+  // entry.
+  config.compilation_environment = "environment_b";
+  XlaDeviceExecutablePersistor other_persistor(config,
+                                               DefaultOptions().device_type);
+  auto other_loaded_executable = other_persistor.TryToLoadExecutable(
+      /*signature_hash=*/789, "signature_string", DefaultOptions(),
+      compilation_result_add_, &mock_client);
+  EXPECT_FALSE(other_loaded_executable.has_value());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -96,6 +96,11 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_max_cluster_size",
            &mark_for_compilation_flags->tf_xla_max_cluster_size,
            "Maximum number of operators in an XLA compilation."),
+      Flag("tf_xla_cost_based_clustering",
+           &mark_for_compilation_flags->tf_xla_cost_based_clustering,
+           "(experimental) Do not compile clusters whose estimated benefit, "
+           "from the ops XLA can fuse, does not outweigh their launch overhead "
+           "and the risk of recompilations from inputs with varying shapes."),
       Flag(
           "tf_xla_ops_to_cluster",
           &mark_for_compilation_flags->tf_xla_ops_to_cluster,
@@ -154,7 +159,11 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_persistent_cache_prefix",
            &mark_for_compilation_flags->tf_xla_persistent_cache_prefix,
            "Specifies the persistance cache prefix. Default is "
-           "\"xla_compile_cache\"")};
+           "\"xla_compile_cache\""),
+      Flag("tf_xla_persistent_cache_read_only",
+           &mark_for_compilation_flags->tf_xla_persistent_cache_read_only,
+           "If true, JIT-compiled executables are only loaded from and never "
+           "saved to the persistent cache directory. Defaults to false.")};
   flag_list->insert(flag_list->end(), new_flags.begin(), new_flags.end());
 }
 
@@ -197,6 +206,7 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_min_cluster_size = 4;
   mark_for_compilation_flags->tf_xla_max_cluster_size =
       std::numeric_limits<int32>::max();
+  mark_for_compilation_flags->tf_xla_cost_based_clustering = false;
   mark_for_compilation_flags->tf_xla_clustering_debug = false;
   mark_for_compilation_flags->tf_xla_cpu_global_jit = false;
   mark_for_compilation_flags->tf_xla_clustering_fuel =
@@ -210,6 +220,7 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
+  mark_for_compilation_flags->tf_xla_persistent_cache_read_only = false;
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
@@ -219,6 +230,8 @@ void AllocateAndParseFlags() {
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
   ops_flags->tf_xla_use_device_api = false;
+  ops_flags->tf_xla_shape_buckets = "";
+  ops_flags->tf_xla_shape_bucket_dimension = 0;
 
   // The `enable_mlir_bridge` flag allows the user to explicitly request that
   // their program is (or isn't) compiled using the MLIR-based TF-to-XLA bridge.
@@ -274,6 +287,14 @@ void AllocateAndParseFlags() {
        Flag("tf_xla_use_device_api", &ops_flags->tf_xla_use_device_api,
             "If true, uses the Device API (PjRt) for single device compilation."
             " Defaults to false."),
+       Flag("tf_xla_shape_buckets", &ops_flags->tf_xla_shape_buckets,
+            "Comma-separated increasing list of sizes, or \"pow2\". If set, "
+            "dimension tf_xla_shape_bucket_dimension of the cluster inputs is "
+            "padded up to the next bucket and one executable is compiled per "
+            "bucket. The real sizes are passed to XLA as dynamic dimensions."),
+       Flag("tf_xla_shape_bucket_dimension",
+            &ops_flags->tf_xla_shape_bucket_dimension,
+            "The input dimension that tf_xla_shape_buckets applies to."),
 
        Flag("tf_mlir_enable_mlir_bridge", &enable_mlir_bridge,
             "Enables experimental MLIR-Based TensorFlow Compiler Bridge.",
@@ -59,6 +59,11 @@ struct MarkForCompilationPassFlags {
   // Maximum number of operators in an XLA compilation.
   int32 tf_xla_max_cluster_size;
 
+  // If true, clusters whose estimated benefit from compilation does not
+  // outweigh their launch and recompilation overhead are not compiled.
+  // Ignored for operators explicitly marked for compilation.
+  bool tf_xla_cost_based_clustering;
+
   // If non-empty, limit XLA clustering to the following TF operations.
   string tf_xla_ops_to_cluster;
 
@@ -101,6 +106,11 @@ struct MarkForCompilationPassFlags {
 
   // Specifies the persistance cache prefix. Default is "xla_compile_cache"
   string tf_xla_persistent_cache_prefix;
+
+  // If true, executables are loaded from but never saved to
+  // `tf_xla_persistent_cache_directory`. Useful when the directory is shared
+  // by many processes. Defaults to false.
+  bool tf_xla_persistent_cache_read_only;
 };
 
 // Flags associated with the XLA bridge's xla_device module.
@@ -126,6 +136,14 @@ struct XlaOpsCommonFlags {
   // If true, uses Device API (PjRt) for single device compilation. Defaults to
   // false.
   bool tf_xla_use_device_api;
+  // Sizes that dimension `tf_xla_shape_bucket_dimension` of the cluster inputs
+  // is padded up to before compilation, so that one executable is compiled per
+  // bucket instead of one per input shape. Either a comma-separated increasing
+  // list of sizes or "pow2" for powers of two. Empty (the default) disables
+  // bucketing.
+  string tf_xla_shape_buckets;
+  // The input dimension that is bucketed. Defaults to 0.
+  int32 tf_xla_shape_bucket_dimension;
 };
 
 // Flags for the build_xla_ops pass.
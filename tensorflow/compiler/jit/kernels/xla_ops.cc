@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_compiler.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
 #include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/shape_bucketing.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
 #include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/compiler/jit/xla_platform_info.h"
@@ -244,6 +245,18 @@ XlaLocalLaunchBase::XlaLocalLaunchBase(OpKernelConstruction* ctx,
       platform_info_(XlaPlatformInfoFromDevice(ctx->device())),
       has_ref_vars_(has_ref_vars) {}
 
+// Returns the shape buckets requested with --tf_xla_shape_buckets. The flags
+// are parsed on first use.
+static StatusOr<const ShapeBuckets*> GetShapeBucketsFromFlags() {
+  static const StatusOr<ShapeBuckets>* buckets = [] {
+    const XlaOpsCommonFlags& flags = GetXlaOpsCommonFlags();
+    return new StatusOr<ShapeBuckets>(ShapeBuckets::Parse(
+        flags.tf_xla_shape_buckets, flags.tf_xla_shape_bucket_dimension));
+  }();
+  TF_RETURN_IF_ERROR(buckets->status());
+  return &buckets->value();
+}
+
 static Status CompileToLocalExecutable(
     OpKernelContext* ctx, const NameAttrList& function, bool has_ref_vars,
     const XlaPlatformInfo& platform_info,
@@ -293,6 +306,24 @@ static Status CompileToLocalExecutable(
   compile_options.alias_resource_update =
       !has_ref_vars && may_alias_resource_update;
 
+  TF_ASSIGN_OR_RETURN(const ShapeBuckets* shape_buckets,
+                      GetShapeBucketsFromFlags());
+  if (shape_buckets->enabled()) {
+    // Compile for the bucket of every input. PopulateInputs pads the inputs
+    // to match, and the outputs come back with their real shapes.
+    std::vector<XlaCompiler::Argument> bucketed_args = args;
+    TF_ASSIGN_OR_RETURN(
+        int num_bucketed,
+        shape_buckets->BucketArguments(absl::MakeSpan(bucketed_args)));
+    if (num_bucketed > 0) {
+      VLOG(2) << "Bucketed " << num_bucketed << " inputs of "
+              << function.name();
+      return xla_device_compiler->CompileIfNeeded(
+          options, function, bucketed_args, compile_options, compile_mode,
+          profiler, compilation_result, executable);
+    }
+  }
+
   return xla_device_compiler->CompileIfNeeded(
       options, function, args, compile_options, compile_mode, profiler,
       compilation_result, executable);
@@ -104,6 +104,10 @@ class MarkForCompilationPassImpl {
     int max_cluster_size;
     int min_cluster_size;
 
+    // If true, decluster the clusters whose estimated benefit from compilation
+    // does not outweigh their launch and recompilation overhead.
+    bool cost_based_clustering;
+
     // Compiler fuel for the auto-clustering algorithm.
     //
     // We decrement this value by one on every time we choose a compilation
@@ -295,6 +299,15 @@ class MarkForCompilationPassImpl {
   // This function removes "obviously bad" cases like these.
   Status DeclusterNodes();
 
+  // Declusters the clusters that are not expected to be profitable when
+  // debug_options_.cost_based_clustering is set.
+  //
+  // The benefit of a cluster is estimated from the kernel launches and memory
+  // round trips that fusing its ops saves.  It is weighed against the overhead
+  // of launching the cluster and against the risk of recompilations, which
+  // grows with the number of cluster inputs whose shapes may vary.
+  Status DeclusterUnprofitableClusters();
+
   // Manifests the clustering decisions into the TF graph by tagging nodes with
   // an `_XlaCluster` attribute.  Also some basic filter logic, like
   // tf_xla_min_cluster_size, are applied here.
@@ -900,6 +913,122 @@ Status MarkForCompilationPassImpl::DeclusterNodes() {
   return OkStatus();
 }
 
+// The cost model of DeclusterUnprofitableClusters, in units of the overhead
+// of running one TF kernel.
+
+// Fusing an op into a neighbor saves its kernel launch and a round trip of
+// its output through memory.
+constexpr double kFusedOpSavings = 1.5;
+
+// A cluster runs _XlaCompile and _XlaRun kernels in place of its ops.
+constexpr double kClusterLaunchCost = 2.0;
+
+// Every cluster input whose shape may vary across steps may cause
+// recompilations, whose cost is amortized over the steps reusing them.
+constexpr double kVaryingInputShapeCost = 4.0;
+
+// Returns true if XLA can fuse `n` with its neighbors, as opposed to ops like
+// MatMul or Conv2D which are emitted as library calls of their own.
+bool IsFusibleOp(const Node& n) {
+  static const absl::flat_hash_set<string>* fusible_ops = [] {
+    auto* fusible_ops = new absl::flat_hash_set<string>;
+    for (const char* category : {"PW", "RED", "PWRED", "REDUCEWINDOW",
+                                 "REDUCEWINDOWPW", "BN", "MISC"}) {
+      const std::vector<string>& ops = GetAllowlistTable()->at(category);
+      fusible_ops->insert(ops.begin(), ops.end());
+    }
+    return fusible_ops;
+  }();
+  return fusible_ops->contains(n.type_string());
+}
+
+// Returns true if the shape of output `output_index` of `n` may change from
+// step to step, either because it depends on the values of the inputs or
+// because the shape attribute of `n` is not fully defined.
+bool OutputShapeMayVary(const Node& n, int output_index) {
+  static const auto* data_dependent_shape_ops =
+      new absl::flat_hash_set<string>{"Where",
+                                      "Unique",
+                                      "UniqueV2",
+                                      "UniqueWithCounts",
+                                      "UniqueWithCountsV2",
+                                      "DynamicPartition",
+                                      "SparseToDense",
+                                      "StringSplit"};
+  if (data_dependent_shape_ops->contains(n.type_string())) {
+    return true;
+  }
+  PartialTensorShape shape;
+  if (GetNodeAttr(n.attrs(), "shape", &shape).ok()) {
+    return !shape.IsFullyDefined();
+  }
+  std::vector<PartialTensorShape> shapes;
+  for (const char* attr_name : {"output_shapes", "_output_shapes"}) {
+    if (GetNodeAttr(n.attrs(), attr_name, &shapes).ok() &&
+        output_index < shapes.size()) {
+      return !shapes[output_index].IsFullyDefined();
+    }
+  }
+  return false;
+}
+
+Status MarkForCompilationPassImpl::DeclusterUnprofitableClusters() {
+  if (!debug_options_.cost_based_clustering) {
+    return OkStatus();
+  }
+
+  absl::flat_hash_map<Cluster*, std::vector<Node*>> nodes_in_cluster;
+  for (Node* n : compilation_candidates_) {
+    Cluster* cluster = GetClusterForNode(n);
+    if (cluster != nullptr && !declustered_nodes_.contains(n)) {
+      nodes_in_cluster[cluster].push_back(n);
+    }
+  }
+
+  for (const auto& [cluster, nodes] : nodes_in_cluster) {
+    // As for tf_xla_min_cluster_size, explicitly requested clusters and
+    // clusters with functional control flow are always kept.
+    if (cluster->is_xla_compile_attr_true() ||
+        cluster->has_functional_control_flow()) {
+      continue;
+    }
+
+    int num_fusible_ops = 0;
+    int num_other_ops = 0;
+    absl::flat_hash_set<std::pair<const Node*, int>> varying_inputs;
+    for (Node* n : nodes) {
+      if (!n->IsIdentity() && !n->IsConstant()) {
+        ++(IsFusibleOp(*n) ? num_fusible_ops : num_other_ops);
+      }
+      for (const Edge* e : n->in_edges()) {
+        if (!e->IsControlEdge() && GetClusterForNode(e->src()) != cluster &&
+            OutputShapeMayVary(*e->src(), e->src_output())) {
+          varying_inputs.insert({e->src(), e->src_output()});
+        }
+      }
+    }
+
+    // A cluster of fusible ops only is emitted as at least one kernel, while
+    // the fusible ops of other clusters can be fused into their library calls.
+    const int num_fused_ops =
+        num_other_ops > 0 ? num_fusible_ops : std::max(num_fusible_ops - 1, 0);
+    const double benefit = kFusedOpSavings * num_fused_ops -
+                           kClusterLaunchCost -
+                           kVaryingInputShapeCost * varying_inputs.size();
+    VLOG(3) << "Estimated benefit of compiling "
+            << cluster->DebugString(*graph_) << ": " << benefit << " (" << num_fusible_ops << " fusible ops, "
+            << num_other_ops << " other ops, " << varying_inputs.size()
+            << " inputs with varying shapes)";
+    if (benefit <= 0) {
+      VLOG(2) << "Declustering " << cluster->DebugString(*graph_)
+              << " because its estimated benefit is " << benefit;
+      declustered_nodes_.insert(nodes.begin(), nodes.end());
+    }
+  }
+
+  return OkStatus();
+}
+
 // Tracks monotonic sequence numbers for graphs.
 class ClusterSequenceNumberGenerator {
  public:
@@ -1562,6 +1691,7 @@ Status MarkForCompilationPassImpl::Run() {
 
   TF_RETURN_IF_ERROR(RunEdgeContractionLoop());
   TF_RETURN_IF_ERROR(DeclusterNodes());
+  TF_RETURN_IF_ERROR(DeclusterUnprofitableClusters());
   TF_RETURN_IF_ERROR(CreateClusters());
   TF_RETURN_IF_ERROR(DumpDebugInfo());
 
@@ -1880,6 +2010,7 @@ Status MarkForCompilationPass::Run(
       flags->tf_xla_deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.cost_based_clustering = flags->tf_xla_cost_based_clustering;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -1899,6 +2030,7 @@ Status MarkForCompilationPass::RunForTest(
   debug_options.deterministic_cluster_names = deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.cost_based_clustering = flags->tf_xla_cost_based_clustering;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/mark_for_compilation_pass_test_helper.h"
 #include "tensorflow/compiler/jit/node_matchers.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
@@ -687,6 +688,44 @@ TEST(XlaCompilationTest, ClusterNodesWithMismatchingInputDeadness) {
   EXPECT_EQ(clusters["add_b"], clusters["add_c"]);
 }
 
+TEST(XlaCompilationTest, CostBasedClustering) {
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  const bool cost_based_clustering = flags->tf_xla_cost_based_clustering;
+  flags->tf_xla_cost_based_clustering = true;
+
+  Scope root = Scope::NewRootScope().ExitOnError();
+  // Builds a chain of `length` Relu ops, reading a placeholder of `shape`.
+  auto make_chain = [&](const string& name, const PartialTensorShape& shape,
+                        int length) {
+    Output output =
+        ops::Placeholder(root.WithOpName(name + "/input"), DT_FLOAT,
+                         ops::Placeholder::Shape(shape));
+    for (int i = 0; i < length; i++) {
+      output = ops::Relu(root.WithOpName(absl::StrCat(name, "/relu", i)),
+                         output);
+    }
+  };
+  make_chain("short", PartialTensorShape({2, 3}), 2);
+  make_chain("long", PartialTensorShape({2, 3}), 4);
+  make_chain("dynamic", PartialTensorShape({-1, 3}), 4);
+  make_chain("long_dynamic", PartialTensorShape({-1, 3}), 8);
+
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  TF_ASSERT_OK(root.ToGraph(graph.get()));
+  TF_ASSERT_OK(MarkForCompilationPassTestHelper::MarkForCompilation(&graph));
+  flags->tf_xla_cost_based_clustering = cost_based_clustering;
+
+  // Fusing two ops doesn't pay for the cluster launch, and fusing four doesn't
+  // pay for the recompilations when the input shape varies.
+  auto clusters = GetClusters(*graph);
+  EXPECT_EQ(clusters.count("short/relu0"), 0);
+  EXPECT_EQ(clusters.count("dynamic/relu0"), 0);
+  EXPECT_EQ(clusters.count("long/relu0"), 1);
+  EXPECT_EQ(clusters.count("long_dynamic/relu0"), 1);
+  EXPECT_EQ(clusters["long/relu0"], clusters["long/relu3"]);
+  EXPECT_EQ(clusters["long_dynamic/relu0"], clusters["long_dynamic/relu7"]);
+}
+
 namespace {
 Node* MakeRead(const Scope& scope, const string& id,
                Node** var_handle_op = nullptr) {
@@ -0,0 +1,96 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include <algorithm>
+#include <variant>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/tf2xla/shape_util.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+
+StatusOr<ShapeBuckets> ShapeBuckets::Parse(absl::string_view spec,
+                                           int dimension) {
+  ShapeBuckets buckets;
+  if (dimension < 0) {
+    return errors::InvalidArgument("Invalid shape bucket dimension ",
+                                   dimension);
+  }
+  buckets.dimension_ = dimension;
+  if (spec.empty()) return buckets;
+  if (spec == "pow2") {
+    buckets.powers_of_two_ = true;
+    return buckets;
+  }
+  for (absl::string_view size_str : absl::StrSplit(spec, ',')) {
+    int64_t size;
+    if (!absl::SimpleAtoi(size_str, &size) || size <= 0) {
+      return errors::InvalidArgument("Invalid shape bucket size \"", size_str,
+                                     "\" in \"", spec, "\"");
+    }
+    if (!buckets.sizes_.empty() && size <= buckets.sizes_.back()) {
+      return errors::InvalidArgument(
+          "Shape buckets must be strictly increasing: \"", spec, "\"");
+    }
+    buckets.sizes_.push_back(size);
+  }
+  return buckets;
+}
+
+std::optional<int64_t> ShapeBuckets::BucketFor(int64_t size) const {
+  if (powers_of_two_) {
+    return static_cast<int64_t>(NextPowerOfTwo64(size));
+  }
+  auto it = std::lower_bound(sizes_.begin(), sizes_.end(), size);
+  if (it == sizes_.end()) return std::nullopt;
+  return *it;
+}
+
+StatusOr<int> ShapeBuckets::BucketArguments(
+    absl::Span<XlaCompiler::Argument> args) const {
+  if (!enabled()) return 0;
+  int num_bucketed = 0;
+  for (XlaCompiler::Argument& arg : args) {
+    // Resources have to keep their shape, and arguments that already carry
+    // an XLA shape may have been given a layout or dynamism by the caller.
+    if (arg.kind != XlaCompiler::Argument::kParameter ||
+        !std::holds_alternative<TensorShape>(arg.shape)) {
+      continue;
+    }
+    const TensorShape& tensor_shape = std::get<TensorShape>(arg.shape);
+    if (tensor_shape.dims() <= dimension_) continue;
+    int64_t size = tensor_shape.dim_size(dimension_);
+    if (size == 0) continue;
+    std::optional<int64_t> bucket = BucketFor(size);
+    if (!bucket.has_value()) continue;
+
+    xla::Shape xla_shape;
+    TF_RETURN_IF_ERROR(TensorShapeToXLAShape(arg.type, tensor_shape,
+                                             &xla_shape));
+    xla_shape.set_dimensions(dimension_, *bucket);
+    xla_shape.set_dynamic_dimension(dimension_, true);
+    arg.shape = xla_shape;
+    ++num_bucketed;
+  }
+  return num_bucketed;
+}
+
+}  // namespace tensorflow
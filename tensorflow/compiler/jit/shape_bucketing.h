@@ -0,0 +1,69 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+#define TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace tensorflow {
+
+// Rounds one dimension of the inputs of an XLA cluster up to a fixed set of
+// sizes, so that inputs with a varying sequence length or batch size share an
+// executable per bucket instead of triggering a compilation per shape.
+//
+// Bucketed arguments are compiled as bounded dynamic shapes: the bucket is the
+// bound of the dimension and the real size is read from the argument at run
+// time. XLA's DynamicPadder masks the padding, so reductions and other ops
+// that see the bucketed dimension still compute the unpadded result, and the
+// outputs come back with their real shapes.
+class ShapeBuckets {
+ public:
+  // Creates a disabled instance that leaves all arguments unchanged.
+  ShapeBuckets() = default;
+
+  // Parses `spec`, which is either "pow2" or a comma-separated, strictly
+  // increasing list of positive sizes. An empty `spec` disables bucketing.
+  static StatusOr<ShapeBuckets> Parse(absl::string_view spec, int dimension);
+
+  bool enabled() const { return powers_of_two_ || !sizes_.empty(); }
+  int dimension() const { return dimension_; }
+
+  // Returns the smallest bucket that holds `size`, or nullopt if `size` is
+  // larger than every bucket.
+  std::optional<int64_t> BucketFor(int64_t size) const;
+
+  // Turns every parameter argument whose bucketed dimension is non-empty and
+  // fits a bucket into a bounded dynamic shape. Returns the number of
+  // arguments that were changed.
+  StatusOr<int> BucketArguments(
+      absl::Span<XlaCompiler::Argument> args) const;
+
+ private:
+  bool powers_of_two_ = false;
+  std::vector<int64_t> sizes_;
+  int dimension_ = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
@@ -0,0 +1,117 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include <variant>
+#include <vector>
+
+#include "tensorflow/compiler/xla/shape.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(ShapeBucketsTest, ParsesExplicitSizes) {
+  TF_ASSERT_OK_AND_ASSIGN(ShapeBuckets buckets,
+                          ShapeBuckets::Parse("8,32,128", /*dimension=*/1));
+  EXPECT_TRUE(buckets.enabled());
+  EXPECT_EQ(buckets.dimension(), 1);
+  EXPECT_EQ(buckets.BucketFor(1), 8);
+  EXPECT_EQ(buckets.BucketFor(8), 8);
+  EXPECT_EQ(buckets.BucketFor(9), 32);
+  EXPECT_EQ(buckets.BucketFor(128), 128);
+  EXPECT_EQ(buckets.BucketFor(129), std::nullopt);
+}
+
+TEST(ShapeBucketsTest, ParsesPowersOfTwo) {
+  TF_ASSERT_OK_AND_ASSIGN(ShapeBuckets buckets,
+                          ShapeBuckets::Parse("pow2", /*dimension=*/0));
+  EXPECT_EQ(buckets.BucketFor(1), 1);
+  EXPECT_EQ(buckets.BucketFor(3), 4);
+  EXPECT_EQ(buckets.BucketFor(64), 64);
+  EXPECT_EQ(buckets.BucketFor(65), 128);
+}
+
+TEST(ShapeBucketsTest, RejectsInvalidSpecs) {
+  EXPECT_FALSE(ShapeBuckets::Parse("8,abc", 0).ok());
+  EXPECT_FALSE(ShapeBuckets::Parse("8,0", 0).ok());
+  EXPECT_FALSE(ShapeBuckets::Parse("32,8", 0).ok());
+  EXPECT_FALSE(ShapeBuckets::Parse("8", -1).ok());
+}
+
+TEST(ShapeBucketsTest, EmptySpecLeavesArgumentsUnchanged) {
+  TF_ASSERT_OK_AND_ASSIGN(ShapeBuckets buckets, ShapeBuckets::Parse("", 0));
+  EXPECT_FALSE(buckets.enabled());
+
+  std::vector<XlaCompiler::Argument> args(1);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({5, 3});
+  TF_ASSERT_OK_AND_ASSIGN(int num_bucketed,
+                          buckets.BucketArguments(absl::MakeSpan(args)));
+  EXPECT_EQ(num_bucketed, 0);
+  EXPECT_TRUE(std::holds_alternative<TensorShape>(args[0].shape));
+}
+
+TEST(ShapeBucketsTest, BucketsParametersAsBoundedDynamicShapes) {
+  TF_ASSERT_OK_AND_ASSIGN(ShapeBuckets buckets,
+                          ShapeBuckets::Parse("4,16", /*dimension=*/0));
+
+  std::vector<XlaCompiler::Argument> args(5);
+  // Bucketed.
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({5, 3});
+  // Scalar: nothing to bucket.
+  args[1].kind = XlaCompiler::Argument::kParameter;
+  args[1].type = DT_INT32;
+  args[1].shape = TensorShape({});
+  // Larger than the largest bucket.
+  args[2].kind = XlaCompiler::Argument::kParameter;
+  args[2].type = DT_FLOAT;
+  args[2].shape = TensorShape({17});
+  // Resources keep their shape.
+  args[3].kind = XlaCompiler::Argument::kResource;
+  args[3].resource_kind = XlaResource::kVariable;
+  args[3].initialized = true;
+  args[3].type = DT_FLOAT;
+  args[3].shape = TensorShape({3});
+  // Constants are not parameters of the XLA computation.
+  args[4].kind = XlaCompiler::Argument::kConstant;
+  args[4].type = DT_INT32;
+  args[4].shape = TensorShape({2});
+  args[4].constant_value = Tensor(DT_INT32, {2});
+
+  TF_ASSERT_OK_AND_ASSIGN(int num_bucketed,
+                          buckets.BucketArguments(absl::MakeSpan(args)));
+  EXPECT_EQ(num_bucketed, 1);
+
+  ASSERT_TRUE(std::holds_alternative<xla::Shape>(args[0].shape));
+  const xla::Shape& shape = std::get<xla::Shape>(args[0].shape);
+  EXPECT_EQ(shape.element_type(), xla::F32);
+  EXPECT_EQ(shape.dimensions(0), 16);
+  EXPECT_EQ(shape.dimensions(1), 3);
+  EXPECT_TRUE(shape.is_dynamic_dimension(0));
+  EXPECT_FALSE(shape.is_dynamic_dimension(1));
+
+  for (int i = 1; i < args.size(); ++i) {
+    EXPECT_TRUE(std::holds_alternative<TensorShape>(args[i].shape)) << i;
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -25,6 +25,16 @@ namespace tensorflow {
 // The number of compiler threads to use for asynchronous device compilation.
 inline constexpr int64_t kNumAsyncDeviceCompilerThreads = 10;
 
+// The maximum number of asynchronous device compilations that are either
+// running or waiting for a compiler thread.
+inline constexpr int64_t kMaxNumOngoingAsyncDeviceCompilations =
+    10 * kNumAsyncDeviceCompilerThreads;
+
+// Asynchronous compilations of clusters that have not been requested for this
+// long are cancelled before they start.
+inline constexpr int64_t kAsyncDeviceCompilationStalenessUs =
+    60 * 1000 * 1000;
+
 enum class DeviceCompileMode {
   kLazy,
   kStrict,
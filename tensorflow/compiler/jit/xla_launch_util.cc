@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <set>
@@ -294,6 +296,67 @@ static void PopulateExecutionInputBuffer(xla::ExecutionInput& execution_input,
   }
 }
 
+// Copies `t` into a newly allocated buffer in the layout XLA expects for an
+// argument of the bounded dynamic shape `device_shape`: the elements of `t`,
+// densely packed, in a buffer sized for the bounds, followed by the int32 size
+// of every dimension. This is what PadToStatic reads the argument from.
+static StatusOr<se::OwningDeviceMemory> PackDynamicInputBuffer(
+    OpKernelContext* ctx, const Tensor& t, const xla::Shape& device_shape,
+    int device_ordinal, se::DeviceMemoryAllocator* allocator) {
+  if (t.dims() != device_shape.rank()) {
+    return errors::InvalidArgument("Input of shape ", t.shape().DebugString(),
+                                   " does not match compiled shape ",
+                                   device_shape.ToString());
+  }
+  for (int i = 0; i < t.dims(); ++i) {
+    if (t.dim_size(i) > device_shape.dimensions(i) ||
+        (!device_shape.is_dynamic_dimension(i) &&
+         t.dim_size(i) != device_shape.dimensions(i))) {
+      return errors::InvalidArgument(
+          "Input of shape ", t.shape().DebugString(),
+          " does not fit compiled shape ", device_shape.ToString());
+    }
+  }
+
+  const int64_t metadata_offset = xla::ShapeUtil::ByteSizeOf(
+      xla::ShapeUtil::MakeStaticShape(device_shape));
+  const int64_t buffer_size = metadata_offset + t.dims() * sizeof(int32_t);
+  TF_ASSIGN_OR_RETURN(se::OwningDeviceMemory buffer,
+                      allocator->Allocate(device_ordinal, buffer_size));
+
+  se::DeviceMemoryBase src = XlaTensor::DeviceMemoryFromTensor(t);
+  se::DeviceMemoryBase data(buffer->opaque(), t.TotalBytes());
+  se::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  if (stream == nullptr) {
+    // Host platform: the buffers are plain host memory.
+    std::memcpy(data.opaque(), src.opaque(), t.TotalBytes());
+    int32_t* metadata = reinterpret_cast<int32_t*>(
+        static_cast<char*>(buffer->opaque()) + metadata_offset);
+    for (int i = 0; i < t.dims(); ++i) {
+      metadata[i] = static_cast<int32_t>(t.dim_size(i));
+    }
+    return std::move(buffer);
+  }
+
+  if (t.TotalBytes() > 0) {
+    stream->ThenMemcpy(&data, src, t.TotalBytes());
+  }
+  // Write the sizes with memsets so that no host buffer has to outlive the
+  // enqueued copies.
+  for (int i = 0; i < t.dims(); ++i) {
+    se::DeviceMemoryBase dim_size(static_cast<char*>(buffer->opaque()) +
+                                      metadata_offset + i * sizeof(int32_t),
+                                  sizeof(int32_t));
+    stream->ThenMemset32(&dim_size, static_cast<uint32_t>(t.dim_size(i)),
+                         sizeof(int32_t));
+  }
+  if (!stream->ok()) {
+    return errors::Internal("Failed to copy a dynamically shaped input.");
+  }
+  return std::move(buffer);
+}
+
 StatusOr<std::vector<xla::ExecutionInput>>
 XlaComputationLaunchContext::PopulateInputs(
     OpKernelContext* ctx,
@@ -346,6 +409,17 @@ XlaComputationLaunchContext::PopulateInputs(
 
     arguments.emplace_back(device_shape, host_shape);
     xla::ExecutionInput& execution_input = arguments.back();
+    if (device_shape.is_dynamic()) {
+      // Arguments compiled with bounded dynamic shapes, e.g. by shape
+      // bucketing, are handed to XLA in a buffer of their own that also holds
+      // the real dimension sizes.
+      TF_ASSIGN_OR_RETURN(se::OwningDeviceMemory buffer,
+                          PackDynamicInputBuffer(ctx, *t, device_shape,
+                                                 device_ordinal_,
+                                                 xla_allocator_));
+      *execution_input.MutableBuffer(xla::ShapeIndex{}) = std::move(buffer);
+      continue;
+    }
     se::DeviceMemoryBase dmem = XlaTensor::DeviceMemoryFromTensor(*t);
     PopulateExecutionInputBuffer(execution_input, xla::ShapeIndex{}, dmem,
                                  donate_buffer, device_ordinal_,
@@ -17,21 +17,38 @@ limitations under the License.
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/jit/device_compiler_client.h"
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/core/tpu/tpu_defs.h"
 
 namespace tensorflow {
 namespace {
 using XlaDeviceCompiler =
     DeviceCompiler<xla::LocalExecutable, xla::LocalClient>;
+
+// Returns a description of the XLA compiler flags and of the device that the
+// executables built by `client` depend on, so that persisted executables are
+// only shared between processes that would have compiled them identically.
+std::string GetCompilationEnvironment(const xla::LocalClient& client) {
+  std::string debug_options;
+  SerializeToStringDeterministic(xla::GetDebugOptionsFromFlags(),
+                                 &debug_options);
+  const se::DeviceDescription& description =
+      client.backend().default_stream_executor()->GetDeviceDescription();
+  return absl::StrCat(client.platform()->Name(), ";", description.model_str(),
+                      ";", description.platform_version(), ";",
+                      debug_options);
+}
 }  // namespace
 
 xla::StatusOr<std::optional<std::set<int>>> ParseVisibleDeviceList(
@@ -64,8 +81,12 @@ Status BuildXlaDeviceCompiler(DeviceBase* device, FunctionLibraryRuntime* flr,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_directory,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix);
+  persistor_config.persistent_cache_read_only =
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only;
 
   if (platform_info.xla_device_metadata()) {
+    persistor_config.compilation_environment = GetCompilationEnvironment(
+        *platform_info.xla_device_metadata()->client());
     auto persistor = std::make_unique<XlaDeviceExecutablePersistor>(
         std::move(persistor_config),
         platform_info.xla_device_metadata()->jit_device_type());
@@ -138,6 +159,8 @@ Status BuildXlaDeviceCompiler(DeviceBase* device, FunctionLibraryRuntime* flr,
                                    platform_info.device_type().type());
   }
 
+  persistor_config.compilation_environment =
+      GetCompilationEnvironment(*client.value());
   auto persistor = std::make_unique<XlaDeviceExecutablePersistor>(
       std::move(persistor_config),
       DeviceType(registration->compilation_device_name));
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_MLIR_LITE_COMMON_TFL_PASS_CONFIG_H_
 #define TENSORFLOW_COMPILER_MLIR_LITE_COMMON_TFL_PASS_CONFIG_H_
 
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
@@ -46,7 +47,10 @@ struct PassConfig {
         enable_hlo_to_tf_conversion(false),
         enable_dynamic_update_slice(false),
         preserve_assert_op(false),
-        enable_stablehlo_conversion(false) {}
+        enable_stablehlo_conversion(false),
+        minimize_peak_memory(false),
+        rematerialization_memory_budget_bytes(0),
+        palettize_weights_num_clusters(0) {}
 
   // If `emit_builtin_tflite_ops` is true, TF Lite legalization passes will be
   // added, which produces TF Lite ops.
@@ -91,6 +95,13 @@ struct PassConfig {
   bool preserve_assert_op;
   // Whether to enable TF->stablehlo passes.
   bool enable_stablehlo_conversion;
+  // Whether to reorder the ops to minimize the peak size of the TFLite arena.
+  bool minimize_peak_memory;
+  // If positive, the largest peak size of the TFLite arena in bytes, which
+  // tensors are recomputed to stay within.
+  int64_t rematerialization_memory_budget_bytes;
+  // If positive, the number of values in the palettes of palettized weights.
+  int palettize_weights_num_clusters;
 };
 
 inline llvm::raw_ostream& operator<<(llvm::raw_ostream& os,
@@ -116,7 +127,12 @@ inline llvm::raw_ostream& operator<<(llvm::raw_ostream& os,
             << "\nenable_hlo_to_tf_conversion: "
             << pass_config.enable_hlo_to_tf_conversion
             << "\nenable_stablehlo_conversion: "
-            << pass_config.enable_stablehlo_conversion << "\n";
+            << pass_config.enable_stablehlo_conversion
+            << "\nminimize_peak_memory: " << pass_config.minimize_peak_memory
+            << "\nrematerialization_memory_budget_bytes: "
+            << pass_config.rematerialization_memory_budget_bytes
+            << "\npalettize_weights_num_clusters: "
+            << pass_config.palettize_weights_num_clusters << "\n";
 }
 
 }  // namespace TFL
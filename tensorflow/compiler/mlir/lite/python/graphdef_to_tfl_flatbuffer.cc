@@ -114,6 +114,11 @@ Status ConvertGraphDefToTFLiteFlatBuffer(const toco::ModelFlags& model_flags,
   pass_config.guarantee_all_funcs_one_use =
       toco_flags.guarantee_all_funcs_one_use();
   pass_config.enable_stablehlo_conversion = toco_flags.convert_to_stablehlo();
+  pass_config.minimize_peak_memory = toco_flags.minimize_peak_memory();
+  pass_config.rematerialization_memory_budget_bytes =
+      toco_flags.rematerialization_memory_budget_bytes();
+  pass_config.palettize_weights_num_clusters =
+      toco_flags.palettize_weights_num_clusters();
 
   return internal::ConvertMLIRToTFLiteFlatBuffer(
       model_flags, toco_flags, std::move(module), pass_config,
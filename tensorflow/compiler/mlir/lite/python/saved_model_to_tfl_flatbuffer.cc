@@ -199,6 +199,11 @@ Status ConvertSavedModelToTFLiteFlatBuffer(const toco::ModelFlags& model_flags,
   pass_config.guarantee_all_funcs_one_use =
       toco_flags.guarantee_all_funcs_one_use();
   pass_config.enable_stablehlo_conversion = toco_flags.convert_to_stablehlo();
+  pass_config.minimize_peak_memory = toco_flags.minimize_peak_memory();
+  pass_config.rematerialization_memory_budget_bytes =
+      toco_flags.rematerialization_memory_budget_bytes();
+  pass_config.palettize_weights_num_clusters =
+      toco_flags.palettize_weights_num_clusters();
 
   // TODO(b/153507667): Pass the session object when importing logic is removed.
   auto status = internal::ConvertMLIRToTFLiteFlatBuffer(
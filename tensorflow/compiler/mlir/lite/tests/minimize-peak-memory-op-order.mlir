@@ -0,0 +1,34 @@
+// RUN: tf-opt %s -tfl-minimize-peak-memory-op-order | FileCheck %s
+
+// Running the branch reading the large tensor first frees it before the other
+// large tensor is allocated.
+// CHECK-LABEL: reorder_to_free_large_tensor
+func.func @reorder_to_free_large_tensor(%arg0: tensor<1x4xf32>, %arg1: tensor<2xi32>) -> (tensor<1x4xf32>, tensor<1x4xf32>) {
+  %0 = "tfl.tile"(%arg0, %arg1) : (tensor<1x4xf32>, tensor<2xi32>) -> tensor<1024x4xf32>
+  %1 = "tfl.tile"(%arg0, %arg1) : (tensor<1x4xf32>, tensor<2xi32>) -> tensor<1024x4xf32>
+  %2 = "tfl.slice"(%0, %arg1, %arg1) : (tensor<1024x4xf32>, tensor<2xi32>, tensor<2xi32>) -> tensor<1x4xf32>
+  %3 = "tfl.slice"(%1, %arg1, %arg1) : (tensor<1024x4xf32>, tensor<2xi32>, tensor<2xi32>) -> tensor<1x4xf32>
+  func.return %2, %3 : tensor<1x4xf32>, tensor<1x4xf32>
+
+// CHECK-NEXT: %[[TILE0:.*]] = "tfl.tile"
+// CHECK-NEXT: %[[SLICE0:.*]] = "tfl.slice"(%[[TILE0]]
+// CHECK-NEXT: %[[TILE1:.*]] = "tfl.tile"
+// CHECK-NEXT: %[[SLICE1:.*]] = "tfl.slice"(%[[TILE1]]
+// CHECK-NEXT: return %[[SLICE0]], %[[SLICE1]]
+}
+
+// The order is kept when it has the lowest peak already.
+// CHECK-LABEL: keep_order
+func.func @keep_order(%arg0: tensor<1x4xf32>, %arg1: tensor<2xi32>) -> (tensor<1x4xf32>, tensor<1x4xf32>) {
+  %0 = "tfl.tile"(%arg0, %arg1) : (tensor<1x4xf32>, tensor<2xi32>) -> tensor<1024x4xf32>
+  %1 = "tfl.slice"(%0, %arg1, %arg1) : (tensor<1024x4xf32>, tensor<2xi32>, tensor<2xi32>) -> tensor<1x4xf32>
+  %2 = "tfl.tile"(%arg0, %arg1) : (tensor<1x4xf32>, tensor<2xi32>) -> tensor<1024x4xf32>
+  %3 = "tfl.slice"(%2, %arg1, %arg1) : (tensor<1024x4xf32>, tensor<2xi32>, tensor<2xi32>) -> tensor<1x4xf32>
+  func.return %3, %1 : tensor<1x4xf32>, tensor<1x4xf32>
+
+// CHECK-NEXT: %[[TILE0:.*]] = "tfl.tile"
+// CHECK-NEXT: %[[SLICE0:.*]] = "tfl.slice"(%[[TILE0]]
+// CHECK-NEXT: %[[TILE1:.*]] = "tfl.tile"
+// CHECK-NEXT: %[[SLICE1:.*]] = "tfl.slice"(%[[TILE1]]
+// CHECK-NEXT: return %[[SLICE1]], %[[SLICE0]]
+}
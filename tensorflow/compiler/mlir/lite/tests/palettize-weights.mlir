@@ -0,0 +1,42 @@
+// RUN: tf-opt %s -tfl-palettize-weights='num-clusters=2 min-elements=8' | FileCheck %s
+
+// The filter is stored as uint8 indices into the means of its two clusters.
+// CHECK-LABEL: palettize_fully_connected
+func.func @palettize_fully_connected(%arg0: tensor<1x4xf32>) -> tensor<1x2xf32> {
+  %0 = "tfl.pseudo_const"() {value = dense<[[1.0, 1.5, -2.0, -2.5], [0.5, 1.0, -1.5, -2.0]]> : tensor<2x4xf32>} : () -> tensor<2x4xf32>
+  %1 = "tfl.no_value"() {value} : () -> none
+  %2 = "tfl.fully_connected"(%arg0, %0, %1) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x4xf32>, tensor<2x4xf32>, none) -> tensor<1x2xf32>
+  func.return %2 : tensor<1x2xf32>
+
+// CHECK-DAG: %[[PALETTE:.*]] = "tfl.pseudo_const"() {value = dense<[-2.000000e+00, 1.000000e+00]> : tensor<2xf32>}
+// CHECK-DAG: %[[INDICES:.*]] = "tfl.pseudo_const"() {value = dense<{{\[\[}}1, 1, 0, 0], [1, 1, 0, 0]]> : tensor<2x4xui8>}
+// CHECK: %[[FILTER:.*]] = "tfl.gather"(%[[PALETTE]], %[[INDICES]]) {axis = 0 : i32, batch_dims = 0 : i32} : (tensor<2xf32>, tensor<2x4xui8>) -> tensor<2x4xf32>
+// CHECK: "tfl.fully_connected"(%arg0, %[[FILTER]], %{{.*}})
+}
+
+// A filter shared by two ops is palettized once.
+// CHECK-LABEL: palettize_shared_filter
+func.func @palettize_shared_filter(%arg0: tensor<1x4xf32>) -> (tensor<1x2xf32>, tensor<1x2xf32>) {
+  %0 = "tfl.pseudo_const"() {value = dense<[[1.0, 1.5, -2.0, -2.5], [0.5, 1.0, -1.5, -2.0]]> : tensor<2x4xf32>} : () -> tensor<2x4xf32>
+  %1 = "tfl.no_value"() {value} : () -> none
+  %2 = "tfl.fully_connected"(%arg0, %0, %1) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x4xf32>, tensor<2x4xf32>, none) -> tensor<1x2xf32>
+  %3 = "tfl.fully_connected"(%arg0, %0, %1) {fused_activation_function = "RELU", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x4xf32>, tensor<2x4xf32>, none) -> tensor<1x2xf32>
+  func.return %2, %3 : tensor<1x2xf32>, tensor<1x2xf32>
+
+// CHECK: %[[FILTER:.*]] = "tfl.gather"
+// CHECK-NOT: "tfl.gather"
+// CHECK: "tfl.fully_connected"(%arg0, %[[FILTER]], %{{.*}})
+// CHECK: "tfl.fully_connected"(%arg0, %[[FILTER]], %{{.*}})
+}
+
+// Filters with fewer elements than min-elements are kept.
+// CHECK-LABEL: keep_small_filter
+func.func @keep_small_filter(%arg0: tensor<1x2xf32>) -> tensor<1x2xf32> {
+  %0 = "tfl.pseudo_const"() {value = dense<[[1.0, 2.0], [3.0, 4.0]]> : tensor<2x2xf32>} : () -> tensor<2x2xf32>
+  %1 = "tfl.no_value"() {value} : () -> none
+  %2 = "tfl.fully_connected"(%arg0, %0, %1) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x2xf32>, tensor<2x2xf32>, none) -> tensor<1x2xf32>
+  func.return %2 : tensor<1x2xf32>
+
+// CHECK-NOT: "tfl.gather"
+// CHECK: "tfl.fully_connected"
+}
@@ -0,0 +1,32 @@
+// RUN: tf-opt %s -tfl-rematerialize='memory-budget-bytes=20000' | FileCheck %s
+
+// The first tile is live but unused while the second one is read, so it is
+// recomputed after that, pinned behind the op reading the second one.
+// CHECK-LABEL: rematerialize_tensor_live_at_peak
+func.func @rematerialize_tensor_live_at_peak(%arg0: tensor<1x4xf32>, %arg1: tensor<2xi32>) -> (tensor<1x4xf32>, tensor<1x4xf32>) {
+  %0 = "tfl.tile"(%arg0, %arg1) : (tensor<1x4xf32>, tensor<2xi32>) -> tensor<1024x4xf32>
+  %1 = "tfl.tile"(%arg0, %arg1) : (tensor<1x4xf32>, tensor<2xi32>) -> tensor<1024x4xf32>
+  %2 = "tfl.slice"(%1, %arg1, %arg1) : (tensor<1024x4xf32>, tensor<2xi32>, tensor<2xi32>) -> tensor<1x4xf32>
+  %3 = "tfl.slice"(%0, %arg1, %arg1) : (tensor<1024x4xf32>, tensor<2xi32>, tensor<2xi32>) -> tensor<1x4xf32>
+  func.return %2, %3 : tensor<1x4xf32>, tensor<1x4xf32>
+
+// CHECK-NEXT: %[[TILE0:.*]] = "tfl.tile"(%arg0, %arg1)
+// CHECK-NEXT: %[[SLICE0:.*]], %[[CONTROL:.*]] = tfl.control_node controls "tfl.slice"(%[[TILE0]], %arg1, %arg1)
+// CHECK-NEXT: %[[TILE1:.*]], %{{.*}} = tfl.control_node(%[[CONTROL]]) controls "tfl.tile"(%arg0, %arg1)
+// CHECK-NEXT: %[[SLICE1:.*]] = "tfl.slice"(%[[TILE1]], %arg1, %arg1)
+// CHECK-NEXT: return %[[SLICE0]], %[[SLICE1]]
+}
+
+// Nothing is recomputed when the peak is within the budget.
+// CHECK-LABEL: within_budget
+func.func @within_budget(%arg0: tensor<1x4xf32>, %arg1: tensor<2xi32>) -> (tensor<1x4xf32>, tensor<1x4xf32>) {
+  %0 = "tfl.tile"(%arg0, %arg1) : (tensor<1x4xf32>, tensor<2xi32>) -> tensor<1024x4xf32>
+  %1 = "tfl.slice"(%0, %arg1, %arg1) : (tensor<1024x4xf32>, tensor<2xi32>, tensor<2xi32>) -> tensor<1x4xf32>
+  %2 = "tfl.slice"(%0, %arg1, %arg1) : (tensor<1024x4xf32>, tensor<2xi32>, tensor<2xi32>) -> tensor<1x4xf32>
+  func.return %1, %2 : tensor<1x4xf32>, tensor<1x4xf32>
+
+// CHECK-NEXT: "tfl.tile"
+// CHECK-NEXT: "tfl.slice"
+// CHECK-NEXT: "tfl.slice"
+// CHECK-NEXT: return
+}
@@ -397,6 +397,24 @@ void AddPostVariableFreezingTFToTFLConversionPasses(
   if (pass_config.outline_tf_while) {
     pass_manager->addPass(mlir::TFL::CreateWhileOutlinePass());
   }
+  if (pass_config.palettize_weights_num_clusters > 0) {
+    pass_manager->addNestedPass<mlir::func::FuncOp>(
+        mlir::TFL::CreatePalettizeWeightsPass(
+            pass_config.palettize_weights_num_clusters));
+  }
+  if (pass_config.minimize_peak_memory) {
+    pass_manager->addNestedPass<mlir::func::FuncOp>(
+        mlir::TFL::CreateMinimizePeakMemoryOpOrderPass());
+  }
+  if (pass_config.rematerialization_memory_budget_bytes > 0) {
+    // The control dependencies added by rematerialization replace the order
+    // the runtime derives for ops with side effects, so these are pinned too.
+    pass_manager->addNestedPass<mlir::func::FuncOp>(
+        mlir::TFL::CreatePinOpsWithSideEffectsPass());
+    pass_manager->addNestedPass<mlir::func::FuncOp>(
+        mlir::TFL::CreateRematerializePass(
+            pass_config.rematerialization_memory_budget_bytes));
+  }
   if (pass_config.runtime_verification) {
     pass_manager->addNestedPass<mlir::func::FuncOp>(
         mlir::TFL::CreateRuntimeVerifyPass());
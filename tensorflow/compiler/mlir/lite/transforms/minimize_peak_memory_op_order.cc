@@ -0,0 +1,244 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/lite/ir/tfl_ops.h"
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h"
+#include "tensorflow/compiler/mlir/lite/utils/arena_utils.h"
+
+namespace mlir {
+namespace TFL {
+namespace {
+#define GEN_PASS_DEF_MINIMIZEPEAKMEMORYOPORDERPASS
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h.inc"
+
+// The ops of a block and the tensors they read and write, as the arena
+// planner sees them.
+class ArenaModel {
+ public:
+  explicit ArenaModel(Block* block) {
+    for (Operation& op : block->without_terminator()) {
+      index_.try_emplace(&op, ops_.size());
+      ops_.push_back(&op);
+    }
+    inputs_.resize(ops_.size());
+    predecessors_.resize(ops_.size());
+
+    int last_side_effecting_op = -1;
+    for (int i = 0, e = ops_.size(); i < e; ++i) {
+      Operation* op = ops_[i];
+      llvm::SetVector<int> predecessors;
+      llvm::SetVector<Value> inputs;
+      // Operands of nested ops count as operands of `op`.
+      op->walk([&](Operation* nested_op) {
+        for (Value operand : nested_op->getOperands()) {
+          Operation* parent = operand.getDefiningOp();
+          if (parent == nullptr) continue;
+          Operation* ancestor = block->findAncestorOpInBlock(*parent);
+          if (ancestor == nullptr || ancestor == op) continue;
+          predecessors.insert(index_.lookup(ancestor));
+          inputs.insert(operand);
+        }
+      });
+      // Ops with side effects keep their relative order.
+      if (!isMemoryEffectFree(op)) {
+        if (last_side_effecting_op >= 0) {
+          predecessors.insert(last_side_effecting_op);
+        }
+        last_side_effecting_op = i;
+      }
+      predecessors_[i] = predecessors.takeVector();
+      inputs_[i] = inputs.takeVector();
+      for (Value input : inputs_[i]) ++num_users_[input];
+    }
+
+    // Model outputs are never deallocated.
+    for (Value output : block->getTerminator()->getOperands()) {
+      ++num_users_[output];
+    }
+  }
+
+  int num_ops() const { return ops_.size(); }
+  Operation* op(int i) const { return ops_[i]; }
+  const std::vector<int>& predecessors(int i) const {
+    return predecessors_[i];
+  }
+
+  // Simulates the arena over the execution of the ops in `order`, and returns
+  // the largest number of bytes live during any op. As in the arena planner,
+  // the outputs of an op are allocated before it runs, and an input is freed
+  // after the last op reading it. Model inputs are live throughout whatever the
+  // order, so they are left out.
+  int64_t GetPeakBytes(const std::vector<int>& order) const {
+    llvm::DenseMap<Value, int> remaining_users = num_users_;
+    int64_t live_bytes = 0;
+    int64_t peak_bytes = 0;
+    for (int i : order) {
+      live_bytes += GetAllocatedBytes(i);
+      peak_bytes = std::max(peak_bytes, live_bytes);
+      live_bytes -= GetFreedBytes(i, remaining_users);
+    }
+    return peak_bytes;
+  }
+
+  // Returns the bytes of the outputs of op `i`.
+  int64_t GetAllocatedBytes(int i) const {
+    int64_t bytes = 0;
+    for (Value result : ops_[i]->getResults()) bytes += GetArenaBytes(result);
+    return bytes;
+  }
+
+  // Returns the bytes of the tensors freed after op `i`, given the number of
+  // users of each tensor that have not run yet, which is updated.
+  int64_t GetFreedBytes(int i,
+                        llvm::DenseMap<Value, int>& remaining_users) const {
+    int64_t bytes = 0;
+    for (Value input : inputs_[i]) {
+      if (--remaining_users[input] == 0) bytes += GetArenaBytes(input);
+    }
+    // Outputs without users are freed right away.
+    for (Value result : ops_[i]->getResults()) {
+      if (remaining_users.lookup(result) == 0) bytes += GetArenaBytes(result);
+    }
+    return bytes;
+  }
+
+  // Returns the bytes GetFreedBytes would return, without updating
+  // `remaining_users`.
+  int64_t PeekFreedBytes(
+      int i, const llvm::DenseMap<Value, int>& remaining_users) const {
+    int64_t bytes = 0;
+    for (Value input : inputs_[i]) {
+      if (remaining_users.lookup(input) == 1) bytes += GetArenaBytes(input);
+    }
+    for (Value result : ops_[i]->getResults()) {
+      if (remaining_users.lookup(result) == 0) bytes += GetArenaBytes(result);
+    }
+    return bytes;
+  }
+
+  const llvm::DenseMap<Value, int>& num_users() const { return num_users_; }
+
+ private:
+  std::vector<Operation*> ops_;
+  llvm::DenseMap<Operation*, int> index_;
+  // Ops that must run before each op.
+  std::vector<std::vector<int>> predecessors_;
+  // Tensors produced in the block and read by each op.
+  std::vector<std::vector<Value>> inputs_;
+  // Number of ops reading each tensor, plus one for model outputs.
+  llvm::DenseMap<Value, int> num_users_;
+};
+
+// Orders the ops greedily: of the ops that are ready to run, runs the one that
+// grows the live memory the least, then the one needing the least memory while
+// it runs, then the one that comes first in the current order.
+std::vector<int> GetGreedyOrder(const ArenaModel& model) {
+  const int num_ops = model.num_ops();
+  std::vector<int> num_pending_predecessors(num_ops);
+  std::vector<std::vector<int>> successors(num_ops);
+  std::vector<int> ready;
+  for (int i = 0; i < num_ops; ++i) {
+    num_pending_predecessors[i] = model.predecessors(i).size();
+    for (int predecessor : model.predecessors(i)) {
+      successors[predecessor].push_back(i);
+    }
+    if (num_pending_predecessors[i] == 0) ready.push_back(i);
+  }
+
+  llvm::DenseMap<Value, int> remaining_users = model.num_users();
+  std::vector<int> order;
+  order.reserve(num_ops);
+  while (!ready.empty()) {
+    auto best = ready.end();
+    int64_t best_growth = 0;
+    int64_t best_allocated = 0;
+    for (auto it = ready.begin(); it != ready.end(); ++it) {
+      const int64_t allocated = model.GetAllocatedBytes(*it);
+      const int64_t growth =
+          allocated - model.PeekFreedBytes(*it, remaining_users);
+      if (best == ready.end() || growth < best_growth ||
+          (growth == best_growth && allocated < best_allocated) ||
+          (growth == best_growth && allocated == best_allocated &&
+           *it < *best)) {
+        best = it;
+        best_growth = growth;
+        best_allocated = allocated;
+      }
+    }
+    const int op = *best;
+    ready.erase(best);
+    order.push_back(op);
+    model.GetFreedBytes(op, remaining_users);
+    for (int successor : successors[op]) {
+      if (--num_pending_predecessors[successor] == 0) {
+        ready.push_back(successor);
+      }
+    }
+  }
+  return order;
+}
+
+struct MinimizePeakMemoryOpOrderPass
+    : public impl::MinimizePeakMemoryOpOrderPassBase<
+          MinimizePeakMemoryOpOrderPass> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(MinimizePeakMemoryOpOrderPass)
+
+  void runOnOperation() override;
+};
+
+void MinimizePeakMemoryOpOrderPass::runOnOperation() {
+  func::FuncOp func = getOperation();
+  if (func.isExternal()) return;
+  Block* block = &func.getBody().front();
+  ArenaModel model(block);
+
+  std::vector<int> current_order(model.num_ops());
+  std::iota(current_order.begin(), current_order.end(), 0);
+  const std::vector<int> order = GetGreedyOrder(model);
+  // The dependencies are taken from a valid order, so there is no cycle and
+  // every op is ordered.
+  assert(order.size() == current_order.size());
+
+  const int64_t current_peak_bytes = model.GetPeakBytes(current_order);
+  const int64_t peak_bytes = model.GetPeakBytes(order);
+  if (peak_bytes >= current_peak_bytes) return;
+
+  Operation* terminator = block->getTerminator();
+  for (int i : order) model.op(i)->moveBefore(terminator);
+}
+
+}  // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+CreateMinimizePeakMemoryOpOrderPass() {
+  return std::make_unique<MinimizePeakMemoryOpOrderPass>();
+}
+
+static PassRegistration<MinimizePeakMemoryOpOrderPass> pass;
+
+}  // namespace TFL
+}  // namespace mlir
@@ -0,0 +1,210 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/Builders.h"  // from @llvm-project
+#include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
+#include "mlir/IR/Matchers.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/lite/ir/tfl_ops.h"
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h"
+
+namespace mlir {
+namespace TFL {
+namespace {
+#define GEN_PASS_DEF_PALETTIZEWEIGHTSPASS
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h.inc"
+
+// Largest number of k-means iterations run for a weight.
+constexpr int kMaxIterations = 32;
+
+// Largest palette indexed by uint8 indices.
+constexpr int kMaxUint8PaletteSize = 256;
+
+// Largest palette indexed by int16 indices.
+constexpr int kMaxInt16PaletteSize = 1 << 15;
+
+// Clusters `sorted_values` with 1D k-means, and returns the distinct cluster
+// centers in increasing order. Values are represented exactly if there are at
+// most `num_clusters` distinct ones.
+std::vector<float> GetPalette(const std::vector<float>& sorted_values,
+                              int num_clusters) {
+  std::vector<float> palette;
+  std::unique_copy(sorted_values.begin(), sorted_values.end(),
+                   std::back_inserter(palette));
+  if (palette.size() <= static_cast<size_t>(num_clusters)) return palette;
+
+  // Starts from evenly spaced quantiles.
+  const size_t num_values = sorted_values.size();
+  palette.resize(num_clusters);
+  for (int k = 0; k < num_clusters; ++k) {
+    palette[k] = sorted_values[(2 * k + 1) * num_values / (2 * num_clusters)];
+  }
+
+  std::vector<double> sums(num_clusters);
+  std::vector<int64_t> counts(num_clusters);
+  for (int iteration = 0; iteration < kMaxIterations; ++iteration) {
+    std::fill(sums.begin(), sums.end(), 0.0);
+    std::fill(counts.begin(), counts.end(), 0);
+    // The values and the centers are sorted, so each cluster is a range of
+    // the values.
+    int cluster = 0;
+    for (float value : sorted_values) {
+      while (cluster + 1 < num_clusters &&
+             value - palette[cluster] > palette[cluster + 1] - value) {
+        ++cluster;
+      }
+      sums[cluster] += value;
+      ++counts[cluster];
+    }
+
+    bool converged = true;
+    for (int k = 0; k < num_clusters; ++k) {
+      // Empty clusters keep their center.
+      if (counts[k] == 0) continue;
+      const float center = sums[k] / counts[k];
+      if (center != palette[k]) converged = false;
+      palette[k] = center;
+    }
+    llvm::sort(palette);
+    if (converged) break;
+  }
+  palette.erase(std::unique(palette.begin(), palette.end()), palette.end());
+  return palette;
+}
+
+// Returns the index of the center of `palette` closest to `value`.
+int GetPaletteIndex(const std::vector<float>& palette, float value) {
+  auto it = llvm::lower_bound(palette, value);
+  if (it == palette.end()) return palette.size() - 1;
+  if (it != palette.begin() && value - *std::prev(it) <= *it - value) --it;
+  return std::distance(palette.begin(), it);
+}
+
+template <typename IndexT>
+DenseElementsAttr GetIndices(const std::vector<float>& palette,
+                             DenseFPElementsAttr weight, Type index_type) {
+  std::vector<IndexT> indices;
+  indices.reserve(weight.getNumElements());
+  for (float value : weight.getValues<float>()) {
+    indices.push_back(GetPaletteIndex(palette, value));
+  }
+  auto type = RankedTensorType::get(weight.getType().getShape(), index_type);
+  return DenseElementsAttr::get(type, llvm::ArrayRef<IndexT>(indices));
+}
+
+struct PalettizeWeightsPass
+    : public impl::PalettizeWeightsPassBase<PalettizeWeightsPass> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(PalettizeWeightsPass)
+
+  PalettizeWeightsPass() = default;
+  PalettizeWeightsPass(const PalettizeWeightsPass&) {}
+  explicit PalettizeWeightsPass(int num_clusters) {
+    this->num_clusters_ = num_clusters;
+  }
+
+  void runOnOperation() override;
+
+ private:
+  // Returns a gather of a palette expanding to `weight`, or null if `weight`
+  // isn't a constant float tensor of at least `min_elements_` elements.
+  Value Palettize(OpBuilder& builder, Value weight);
+};
+
+Value PalettizeWeightsPass::Palettize(OpBuilder& builder, Value weight) {
+  DenseFPElementsAttr attr;
+  if (!matchPattern(weight, m_Constant(&attr)) ||
+      !attr.getElementType().isF32() ||
+      attr.getNumElements() < min_elements_) {
+    return {};
+  }
+
+  std::vector<float> sorted_values(attr.getValues<float>().begin(),
+                                   attr.getValues<float>().end());
+  llvm::sort(sorted_values);
+  const std::vector<float> palette = GetPalette(sorted_values, num_clusters_);
+
+  builder.setInsertionPointAfter(weight.getDefiningOp());
+  Location loc = weight.getLoc();
+  auto palette_type = RankedTensorType::get(
+      {static_cast<int64_t>(palette.size())}, builder.getF32Type());
+  auto palette_op = builder.create<ConstOp>(
+      loc,
+      DenseElementsAttr::get(palette_type, llvm::ArrayRef<float>(palette)));
+  DenseElementsAttr indices =
+      palette.size() <= static_cast<size_t>(kMaxUint8PaletteSize)
+          ? GetIndices<uint8_t>(palette, attr,
+                                builder.getIntegerType(8, /*isSigned=*/false))
+          : GetIndices<int16_t>(palette, attr, builder.getIntegerType(16));
+  auto indices_op = builder.create<ConstOp>(loc, indices);
+  return builder.create<GatherOp>(
+      loc, attr.getType(), palette_op.getResult(), indices_op.getResult(),
+      builder.getI32IntegerAttr(0), builder.getI32IntegerAttr(0));
+}
+
+void PalettizeWeightsPass::runOnOperation() {
+  func::FuncOp func = getOperation();
+  if (num_clusters_ < 2 || num_clusters_ > kMaxInt16PaletteSize) {
+    func.emitError() << "num-clusters must be between 2 and "
+                     << kMaxInt16PaletteSize << ", got " << num_clusters_;
+    return signalPassFailure();
+  }
+
+  OpBuilder builder(func.getContext());
+  // Weights shared by several ops are palettized once.
+  llvm::DenseMap<Value, Value> palettized_weights;
+  func.walk([&](Operation* op) {
+    if (!isa<FullyConnectedOp, Conv2DOp, DepthwiseConv2DOp>(op)) return;
+    Value weight = op->getOperand(1);
+    auto it = palettized_weights.find(weight);
+    if (it == palettized_weights.end()) {
+      it = palettized_weights.try_emplace(weight, Palettize(builder, weight))
+               .first;
+    }
+    if (it->second) op->setOperand(1, it->second);
+  });
+
+  for (const auto& [weight, palettized_weight] : palettized_weights) {
+    if (palettized_weight && weight.use_empty()) {
+      weight.getDefiningOp()->erase();
+    }
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> CreatePalettizeWeightsPass(
+    int num_clusters) {
+  return std::make_unique<PalettizeWeightsPass>(num_clusters);
+}
+
+std::unique_ptr<OperationPass<func::FuncOp>> CreatePalettizeWeightsPass() {
+  return std::make_unique<PalettizeWeightsPass>();
+}
+
+static PassRegistration<PalettizeWeightsPass> pass;
+
+}  // namespace TFL
+}  // namespace mlir
@@ -227,6 +227,23 @@ std::unique_ptr<OperationPass<func::FuncOp>> CreatePinOpsWithSideEffectsPass();
 std::unique_ptr<OperationPass<func::FuncOp>>
 CreatePartitionedTopologicalSortPass();
 
+// Creates a pass that reorders operations to minimize the peak memory of the
+// TFLite arena.
+std::unique_ptr<OperationPass<func::FuncOp>>
+CreateMinimizePeakMemoryOpOrderPass();
+
+// Creates a pass that recomputes tensors to keep the peak memory of the TFLite
+// arena within `memory_budget_bytes`.
+std::unique_ptr<OperationPass<func::FuncOp>> CreateRematerializePass(
+    int64_t memory_budget_bytes);
+std::unique_ptr<OperationPass<func::FuncOp>> CreateRematerializePass();
+
+// Creates a pass that stores float weights as indices into a palette of at
+// most `num_clusters` values, expanded by a gather op.
+std::unique_ptr<OperationPass<func::FuncOp>> CreatePalettizeWeightsPass(
+    int num_clusters);
+std::unique_ptr<OperationPass<func::FuncOp>> CreatePalettizeWeightsPass();
+
 #define GEN_PASS_DECL_DEFAULTQUANTPARAMSPASS
 #define GEN_PASS_DECL_DENSETOSPARSEPASS
 #define GEN_PASS_DECL_LEGALIZETFPASS
@@ -0,0 +1,254 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/Block.h"  // from @llvm-project
+#include "mlir/IR/Builders.h"  // from @llvm-project
+#include "mlir/IR/Matchers.h"  // from @llvm-project
+#include "mlir/Interfaces/SideEffectInterfaces.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/lite/ir/tfl_ops.h"
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h"
+#include "tensorflow/compiler/mlir/lite/utils/arena_utils.h"
+
+namespace mlir {
+namespace TFL {
+namespace {
+#define GEN_PASS_DEF_REMATERIALIZEPASS
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h.inc"
+
+// Lifetimes of the tensors produced in a block, in positions of the ops of the
+// block, as the arena planner assigns them: a tensor is live from the op
+// producing it up to the last op reading it, and model outputs up to the end.
+class Lifetimes {
+ public:
+  explicit Lifetimes(Block* block) {
+    for (Operation& op : block->without_terminator()) {
+      positions_.try_emplace(&op, ops_.size());
+      ops_.push_back(&op);
+    }
+    const int end = ops_.size();
+    live_bytes_.assign(end, 0);
+    for (int i = 0; i < end; ++i) {
+      for (Value result : ops_[i]->getResults()) {
+        std::vector<int>& users = users_[result];
+        for (Operation* user : result.getUsers()) {
+          Operation* ancestor = block->findAncestorOpInBlock(*user);
+          users.push_back(ancestor == block->getTerminator()
+                              ? end
+                              : positions_.lookup(ancestor));
+        }
+        llvm::sort(users);
+        users.erase(std::unique(users.begin(), users.end()), users.end());
+
+        const int64_t bytes = GetArenaBytes(result);
+        const int last = users.empty() ? i : std::min(users.back(), end - 1);
+        for (int j = i; j <= last; ++j) live_bytes_[j] += bytes;
+      }
+    }
+  }
+
+  int num_ops() const { return ops_.size(); }
+  Operation* op(int i) const { return ops_[i]; }
+  int position(Operation* op) const { return positions_.lookup(op); }
+  int64_t live_bytes(int i) const { return live_bytes_[i]; }
+
+  // Positions of the ops reading `value`, in order. Returns the number of ops
+  // for model outputs.
+  const std::vector<int>& users(Value value) const {
+    return users_.find(value)->second;
+  }
+
+  // Returns whether `value` is live at position `i` whatever is done with the
+  // other tensors.
+  bool IsAvailableAt(Value value, int i) const {
+    if (value.isa<BlockArgument>() || matchPattern(value, m_Constant())) {
+      return true;
+    }
+    auto it = users_.find(value);
+    return it != users_.end() && !it->second.empty() && it->second.back() >= i;
+  }
+
+ private:
+  std::vector<Operation*> ops_;
+  llvm::DenseMap<Operation*, int> positions_;
+  llvm::DenseMap<Value, std::vector<int>> users_;
+  // Bytes of the tensors live while each op runs.
+  std::vector<int64_t> live_bytes_;
+};
+
+// A tensor to recompute right before `position`, instead of keeping it live
+// since it was last read at a position before `peak`.
+struct Candidate {
+  Value value;
+  int position;
+  int64_t bytes;
+};
+
+// Returns the tensor whose recomputation frees the most memory at position
+// `peak`, if any. Only tensors produced by ops without side effects and
+// regions, from tensors that are live anyway at the recomputation, are
+// recomputed, so no other tensor is kept live longer.
+llvm::Optional<Candidate> FindCandidate(const Lifetimes& lifetimes,
+                                        int peak) {
+  llvm::Optional<Candidate> best;
+  for (int i = 0; i < peak; ++i) {
+    Operation* op = lifetimes.op(i);
+    if (op->getNumResults() != 1 || op->getNumRegions() != 0 ||
+        !isMemoryEffectFree(op) || matchPattern(op, m_Constant())) {
+      continue;
+    }
+    Value value = op->getResult(0);
+    const int64_t bytes = GetArenaBytes(value);
+    if (bytes == 0 || (best && bytes <= best->bytes)) continue;
+
+    // The tensor must not be read at the peak, and is recomputed for the first
+    // op reading it after the peak. Model outputs are live until the end.
+    const std::vector<int>& users = lifetimes.users(value);
+    auto next_user = llvm::lower_bound(users, peak);
+    if (next_user != users.end() && *next_user == peak) continue;
+    if (next_user == users.end() || *next_user == lifetimes.num_ops()) {
+      continue;
+    }
+    if (llvm::all_of(op->getOperands(), [&](Value operand) {
+          return lifetimes.IsAvailableAt(operand, *next_user);
+        })) {
+      best = Candidate{value, *next_user, bytes};
+    }
+  }
+  return best;
+}
+
+// Wraps `op` in a TFL::ControlNodeOp depending on `control_inputs`, and
+// returns the wrapping op.
+ControlNodeOp WrapInControlNode(Operation* op, ValueRange control_inputs) {
+  OpBuilder builder(op);
+  Location loc = op->getLoc();
+  auto outer_op = builder.create<ControlNodeOp>(
+      loc, op->getResultTypes(), ControlType::get(op->getContext()),
+      control_inputs);
+  Region region;
+  Block* new_block = new Block;
+  region.push_back(new_block);
+  builder.setInsertionPointToEnd(&region.front());
+  Operation* inner_op = builder.clone(*op);
+  builder.create<YieldOp>(loc, inner_op->getResults());
+  outer_op.getBody().takeBody(region);
+  op->replaceAllUsesWith(outer_op.getOutputs());
+  op->erase();
+  return outer_op;
+}
+
+// Returns the control token of `op`, wrapping it in a TFL::ControlNodeOp
+// first if needed.
+Value GetControlToken(Operation* op) {
+  auto control_node = dyn_cast<ControlNodeOp>(op);
+  if (!control_node) control_node = WrapInControlNode(op, {});
+  return control_node.getControl();
+}
+
+// Recomputes `candidate.value` right before the op at `candidate.position`,
+// for that op and the later ones. The recomputation is pinned after the op
+// before it, so that the runtime does not move it back to where the tensor
+// was live.
+void Rematerialize(const Lifetimes& lifetimes, int peak,
+                   const Candidate& candidate) {
+  Operation* op = candidate.value.getDefiningOp();
+  Operation* user = lifetimes.op(candidate.position);
+  Block* block = user->getBlock();
+  OpBuilder builder(user);
+  Operation* clone = builder.clone(*op);
+  candidate.value.replaceUsesWithIf(
+      clone->getResult(0), [&](OpOperand& use) {
+        Operation* ancestor = block->findAncestorOpInBlock(*use.getOwner());
+        return ancestor != block->getTerminator() &&
+               lifetimes.position(ancestor) >= candidate.position;
+      });
+  if (op->use_empty()) op->erase();
+
+  // Constants are not scheduled by the runtime, so they can't be pinned.
+  for (int i = candidate.position - 1; i >= peak; --i) {
+    Operation* predecessor = lifetimes.op(i);
+    if (matchPattern(predecessor, m_Constant())) continue;
+    WrapInControlNode(clone, GetControlToken(predecessor));
+    break;
+  }
+}
+
+class RematerializePass
+    : public impl::RematerializePassBase<RematerializePass> {
+ public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(RematerializePass)
+
+  RematerializePass() = default;
+  RematerializePass(const RematerializePass&) {}
+  explicit RematerializePass(int64_t memory_budget_bytes) {
+    this->memory_budget_bytes_ = memory_budget_bytes;
+  }
+
+  void runOnOperation() override;
+};
+
+void RematerializePass::runOnOperation() {
+  func::FuncOp func = getOperation();
+  if (func.isExternal()) return;
+  Block* block = &func.getBody().front();
+
+  // Every rematerialization lowers the live memory at the peak, so this takes
+  // at most one step per tensor in practice; the bound guards against cycles.
+  const int max_steps = block->getOperations().size();
+  for (int step = 0; step < max_steps; ++step) {
+    Lifetimes lifetimes(block);
+    if (lifetimes.num_ops() == 0) return;
+    int peak = 0;
+    for (int i = 1; i < lifetimes.num_ops(); ++i) {
+      if (lifetimes.live_bytes(i) > lifetimes.live_bytes(peak)) peak = i;
+    }
+    if (lifetimes.live_bytes(peak) <= memory_budget_bytes_) return;
+
+    llvm::Optional<Candidate> candidate = FindCandidate(lifetimes, peak);
+    if (!candidate) {
+      emitWarning(func.getLoc())
+          << "peak arena size of " << lifetimes.live_bytes(peak)
+          << " bytes exceeds the budget of " << memory_budget_bytes_
+          << " bytes, and no tensor live at the peak can be rematerialized";
+      return;
+    }
+    Rematerialize(lifetimes, peak, *candidate);
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> CreateRematerializePass(
+    int64_t memory_budget_bytes) {
+  return std::make_unique<RematerializePass>(memory_budget_bytes);
+}
+
+std::unique_ptr<OperationPass<func::FuncOp>> CreateRematerializePass() {
+  return std::make_unique<RematerializePass>();
+}
+
+static PassRegistration<RematerializePass> pass;
+
+}  // namespace TFL
+}  // namespace mlir
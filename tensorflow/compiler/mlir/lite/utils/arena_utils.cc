@@ -0,0 +1,49 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/mlir/lite/utils/arena_utils.h"
+
+#include <cstdint>
+
+#include "mlir/Dialect/Quant/QuantTypes.h"  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
+#include "mlir/IR/Matchers.h"  // from @llvm-project
+
+namespace mlir {
+namespace TFL {
+
+int64_t GetArenaBytes(Value value) {
+  auto type = value.getType().dyn_cast<ShapedType>();
+  if (!type || !type.hasRank() || matchPattern(value, m_Constant())) return 0;
+
+  Type element_type = type.getElementType();
+  int64_t num_lanes = 1;
+  if (auto quant_type = element_type.dyn_cast<quant::QuantizedType>()) {
+    element_type = quant_type.getStorageType();
+  } else if (auto complex_type = element_type.dyn_cast<ComplexType>()) {
+    element_type = complex_type.getElementType();
+    num_lanes = 2;
+  }
+  if (!element_type.isIntOrFloat()) return 0;
+
+  int64_t bytes = num_lanes * ((element_type.getIntOrFloatBitWidth() + 7) / 8);
+  for (int64_t dim : type.getShape()) {
+    if (!ShapedType::isDynamic(dim)) bytes *= dim;
+  }
+  return (bytes + kArenaAlignment - 1) / kArenaAlignment * kArenaAlignment;
+}
+
+}  // namespace TFL
+}  // namespace mlir
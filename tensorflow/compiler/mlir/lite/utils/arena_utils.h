@@ -0,0 +1,39 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_MLIR_LITE_UTILS_ARENA_UTILS_H_
+#define TENSORFLOW_COMPILER_MLIR_LITE_UTILS_ARENA_UTILS_H_
+
+#include <cstdint>
+
+#include "mlir/IR/Value.h"  // from @llvm-project
+
+namespace mlir {
+namespace TFL {
+
+// Alignment of the tensors in the TFLite arena, as kDefaultTensorAlignment in
+// tensorflow/lite/util.h.
+constexpr int64_t kArenaAlignment = 64;
+
+// Returns the number of arena bytes needed by `value` at runtime, rounded up
+// to the arena alignment. Constants live in the flatbuffer and values that
+// are not tensors of numbers are allocated dynamically, so neither takes
+// arena memory. Dynamic dimensions are counted as one.
+int64_t GetArenaBytes(Value value);
+
+}  // namespace TFL
+}  // namespace mlir
+
+#endif  // TENSORFLOW_COMPILER_MLIR_LITE_UTILS_ARENA_UTILS_H_
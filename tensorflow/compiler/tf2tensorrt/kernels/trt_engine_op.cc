@@ -16,6 +16,7 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
@@ -27,6 +28,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_logger.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_lru_cache.h"
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_persistent_engine_cache.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_shape_optimization_profiles.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
@@ -42,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -132,6 +135,68 @@ class AsyncHelper : public core::RefCounted {
   AsyncOpKernel::DoneCallback done_;
 };
 
+// Maximum number of engines built with adapted profiles for a TRTEngineOp. The
+// engines they replace are kept alive, so this also bounds their memory.
+constexpr int kMaxAdaptedEngines = 3;
+
+// What a background thread needs to build an engine with adapted profiles,
+// copied from the TRTEngineOp so that the thread doesn't access the op.
+struct AdaptedEngineBuildParams {
+  string name;
+  string device_name;
+  int platform_device_id;
+  GraphDef segment_graph_def;
+  TrtPrecisionMode precision_mode;
+  int batch_size;
+  int64 workspace_size;
+  std::vector<PartialTensorShape> input_partial_shapes;
+  bool use_explicit_precision;
+};
+
+// Builds an explicit batch engine with `profiles` and hands it over to
+// `cache_res`, which installs it on the next inference call.
+Status BuildAdaptedEngine(const AdaptedEngineBuildParams& params,
+                          TrtShapeOptimizationProfile profiles,
+                          TRTEngineCacheResource* cache_res) {
+  tensorflow::profiler::TraceMe activity(
+      "BuildAdaptedEngine", tensorflow::profiler::TraceMeLevel::kInfo);
+  const cudaError_t err = cudaSetDevice(params.platform_device_id);
+  if (err != cudaSuccess) {
+    return errors::Internal("Couldn't set cuda device to ",
+                            params.platform_device_id, ": ",
+                            cudaGetErrorString(err));
+  }
+  std::unordered_map<string, tensorflow::DeviceProperties> device_map;
+  DeviceNameUtils::ParsedName full_parsed_name;
+  DeviceNameUtils::ParseFullName(params.device_name, &full_parsed_name);
+  device_map.emplace(params.device_name,
+                     grappler::GetDeviceInfo(full_parsed_name));
+  tensorflow::grappler::VirtualCluster cluster(device_map);
+
+  // The OpKernelContext is only needed to read resource inputs, which
+  // segments with adapted profiles don't have.
+  TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
+  TF_RETURN_IF_ERROR(convert::ConvertGraphDefToEngine(
+      params.segment_graph_def, /*ctx=*/nullptr, params.precision_mode,
+      params.batch_size, params.workspace_size, params.input_partial_shapes,
+      &logger, cache_res->allocator_.get(), /*calibrator=*/nullptr, &engine,
+      /*use_calibration=*/false, /*use_implicit_batch=*/false,
+      /*convert_successfully=*/nullptr, &profiles, params.name,
+      params.use_explicit_precision, &cluster));
+  std::vector<ExecutionContext> exec_contexts;
+  TF_RETURN_IF_ERROR(
+      profiles.CreateExecutionContexts(engine.get(), &exec_contexts));
+
+  auto adapted_engine =
+      std::make_unique<TRTEngineCacheResource::AdaptedEngine>();
+  adapted_engine->engine_context = std::make_unique<EngineContext>(
+      std::move(engine), std::move(exec_contexts));
+  adapted_engine->profiles = std::move(profiles);
+  mutex_lock lock(cache_res->adaptive_profiles_mu_);
+  cache_res->adapted_engine_ = std::move(adapted_engine);
+  return OkStatus();
+}
+
 }  // end anonymous namespace
 
 //  This OP can construct TRTEngine on the fly and if construction of engine
@@ -190,12 +255,34 @@ class TRTEngineOp : public AsyncOpKernel {
 
   // Builds and returns a cuda engine for the input shapes. If building the
   // engine fails, enters a dummy entry into the cache_resource cache so we
-  // don't continually try to build the same failing engine.
+  // don't continually try to build the same failing engine. If the persistent
+  // engine cache is enabled, the engine is loaded from it when possible, and
+  // added to it otherwise.
   StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> BuildEngine(
       const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
       bool use_calibration, TRTInt8Calibrator* calibrator,
       TRTEngineCacheResource* cache_resource, OpKernelContext* ctx);
 
+  // Returns the key of the engine for `input_shapes` in the persistent engine
+  // cache, or an empty string if the engine can't be cached persistently.
+  string GetPersistentEngineCacheKey(
+      const std::vector<PartialTensorShape>& input_shapes, int batch_size,
+      bool use_calibration, const TrtShapeOptimizationProfile& profiles,
+      const DeviceProperties& device_properties);
+
+  // Records input shapes which no optimization profile includes. Once they
+  // were seen adaptive_profiles_threshold_ times, builds an engine in the
+  // background whose profiles also include the frequent ones.
+  void MaybeAdaptProfiles(const std::vector<TensorShape>& input_concrete_shapes,
+                          OpKernelContext* ctx,
+                          TRTEngineCacheResource* cache_res)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
+
+  // Replaces the cached engine and its profiles by the engine built by
+  // MaybeAdaptProfiles, if it is ready.
+  void MaybeInstallAdaptedEngine(TRTEngineCacheResource* cache_res)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
+
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
 
@@ -273,6 +360,12 @@ class TRTEngineOp : public AsyncOpKernel {
 
   // Whether to use explicit precision (QDQ) mode.
   bool use_explicit_precision_;
+
+  // Number of inference calls with input shapes outside of the optimization
+  // profiles after which the profiles are adapted to these shapes, set by the
+  // TF_TRT_ADAPTIVE_PROFILES_THRESHOLD environment variable. Zero disables
+  // the adaptation.
+  int64 adaptive_profiles_threshold_;
 };
 
 #define TYPECASE(dt, X)                                       \
@@ -468,6 +561,11 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
     use_explicit_precision_ = false;
   }
 
+  OP_REQUIRES_OK(context,
+                 ReadInt64FromEnvVar("TF_TRT_ADAPTIVE_PROFILES_THRESHOLD",
+                                     /*default_val=*/0,
+                                     &adaptive_profiles_threshold_));
+
   native_execution_func_handle_ = kInvalidHandle;
   if (!static_engine_) {
     OP_REQUIRES_OK(context, ImportSegmentGraphDef(context->function_library(),
@@ -1090,10 +1188,37 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
   std::unordered_map<string, tensorflow::DeviceProperties> device_map;
   DeviceNameUtils::ParsedName full_parsed_name;
   DeviceNameUtils::ParseFullName(ctx->device()->name(), &full_parsed_name);
-  device_map.emplace(ctx->device()->name(),
-                     grappler::GetDeviceInfo(full_parsed_name));
+  const DeviceProperties device_properties =
+      grappler::GetDeviceInfo(full_parsed_name);
+  device_map.emplace(ctx->device()->name(), device_properties);
   tensorflow::grappler::VirtualCluster cluster(device_map);
 
+  const string persistent_cache_key = GetPersistentEngineCacheKey(
+      conversion_input_shapes, batch_size, use_calibration,
+      cache_resource->profiles_, device_properties);
+  if (!persistent_cache_key.empty()) {
+    StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> cached_engine =
+        LoadPersistentEngine(GetPersistentEngineCacheDir(),
+                             persistent_cache_key,
+                             cache_resource->allocator_.get(), &logger);
+    if (cached_engine.ok()) {
+      VLOG(1) << "Loaded the TensorRT engine for " << name()
+              << " from the persistent engine cache with key "
+              << persistent_cache_key;
+      if (!use_implicit_batch_) {
+        TF_RETURN_IF_ERROR(cache_resource->profiles_.RestoreProfiles(
+            cached_engine->get(), ctx->num_inputs()));
+      }
+      return std::move(cached_engine).value();
+    }
+    if (!errors::IsNotFound(cached_engine.status())) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX
+          << "Failed to load the TensorRT engine for " << name()
+          << " from the persistent engine cache, building it instead. "
+          << "Reason: " << cached_engine.status();
+    }
+  }
+
   TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
   auto status = convert::ConvertGraphDefToEngine(
       segment_graph_def_, ctx, precision_mode_, batch_size, workspace_size_,
@@ -1111,9 +1236,46 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
                                    std::make_unique<EngineContext>());
     return status;
   }
+  if (!persistent_cache_key.empty()) {
+    status = SavePersistentEngine(GetPersistentEngineCacheDir(),
+                                  persistent_cache_key, engine.get());
+    if (!status.ok()) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX
+          << "Failed to save the TensorRT engine for " << name()
+          << " to the persistent engine cache. Reason: " << status;
+    }
+  }
   return engine;
 }
 
+string TRTEngineOp::GetPersistentEngineCacheKey(
+    const std::vector<PartialTensorShape>& input_shapes, int batch_size,
+    bool use_calibration, const TrtShapeOptimizationProfile& profiles,
+    const DeviceProperties& device_properties) {
+  // Calibrated engines depend on the calibration data, and engines of segments
+  // with resource inputs on the variable values, neither of which is part of
+  // the key.
+  if (GetPersistentEngineCacheDir().empty() || use_calibration ||
+      segment_graph_def_.node().empty() ||
+      !absl::c_all_of(input_mask_, [](bool is_input) { return is_input; })) {
+    return "";
+  }
+  const auto& environment = device_properties.environment();
+  const auto architecture = environment.find("architecture");
+  if (architecture == environment.end()) {
+    return "";
+  }
+  const string build_options = StrCat(
+      "precision_mode: ", DebugString(precision_mode_),
+      ", batch_size: ", use_implicit_batch_ ? batch_size : 0,
+      ", workspace_size: ", workspace_size_,
+      ", use_implicit_batch: ", use_implicit_batch_,
+      ", use_explicit_precision: ", use_explicit_precision_);
+  return PersistentEngineCacheKey(segment_graph_def_, input_shapes,
+                                  profiles.ProfilesDebugString(), build_options,
+                                  architecture->second);
+}
+
 StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_concrete_shapes, OpKernelContext* ctx,
     TRTEngineCacheResource* cache_res) {
@@ -1240,12 +1402,17 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
                                           0);
   }  // static_engine_
 
+  if (adaptive_profiles_threshold_ > 0) {
+    MaybeInstallAdaptedEngine(cache_res);
+  }
+
   int profile_id = -1;
   if (!use_implicit_batch_) {
     profile_id = cache_res->profiles_.GetProfileNumber(input_concrete_shapes);
     // Since all profiles are already created at this point, finding no
     // compatible profiles results in falling back to native TF.
     if (profile_id == -1) {
+      MaybeAdaptProfiles(input_concrete_shapes, ctx, cache_res);
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
   }
@@ -1296,6 +1463,93 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
                                         use_implicit_batch_ ? 0 : profile_id);
 }
 
+void TRTEngineOp::MaybeAdaptProfiles(
+    const std::vector<TensorShape>& input_concrete_shapes,
+    OpKernelContext* ctx, TRTEngineCacheResource* cache_res) {
+  // Only a dynamic shape engine which was built successfully is adapted.
+  // Engines of segments with resource inputs need the OpKernelContext to be
+  // built, which the background thread doesn't have.
+  auto& cache = cache_res->cache_;
+  if (adaptive_profiles_threshold_ <= 0 || !allow_build_at_runtime_ ||
+      use_calibration_ || segment_graph_def_.node().empty() ||
+      cache.size() != 1 || cache.begin()->second->GetCudaEngine() == nullptr ||
+      !absl::c_all_of(input_mask_, [](bool is_input) { return is_input; })) {
+    return;
+  }
+  cache_res->profiles_.RecordUnmatchedShapes(input_concrete_shapes);
+  if (cache_res->profiles_.NumUnmatchedShapes() <
+      adaptive_profiles_threshold_) {
+    return;
+  }
+  {
+    mutex_lock lock(cache_res->adaptive_profiles_mu_);
+    if (cache_res->building_adapted_engine_ || cache_res->adapted_engine_ ||
+        cache_res->num_adapted_engines_ >= kMaxAdaptedEngines) {
+      return;
+    }
+    cache_res->building_adapted_engine_ = true;
+    ++cache_res->num_adapted_engines_;
+  }
+  // Shapes seen in less than 1% of the unmatched calls are left out, so that
+  // outliers don't widen the profiles.
+  TrtShapeOptimizationProfile profiles =
+      cache_res->profiles_.AdaptToUnmatchedShapes(
+          input_partial_shapes_,
+          std::max<int64>(1, cache_res->profiles_.NumUnmatchedShapes() / 100));
+  cache_res->profiles_.ClearUnmatchedShapes();
+
+  AdaptedEngineBuildParams params;
+  params.name = name();
+  params.device_name = ctx->device()->name();
+  params.platform_device_id =
+      ctx->device()->tensorflow_accelerator_device_info()->gpu_id;
+  params.segment_graph_def = segment_graph_def_;
+  params.precision_mode = precision_mode_;
+  params.batch_size = input_concrete_shapes[0].dim_size(0);
+  params.workspace_size = workspace_size_;
+  params.input_partial_shapes = input_partial_shapes_;
+  params.use_explicit_precision = use_explicit_precision_;
+  VLOG(1) << "Building a TensorRT engine with adapted profiles for " << name()
+          << ": " << profiles.ProfilesDebugString();
+
+  cache_res->Ref();
+  Env::Default()->SchedClosure([params = std::move(params),
+                                profiles = std::move(profiles),
+                                cache_res]() mutable {
+    core::ScopedUnref sc(cache_res);
+    Status status = BuildAdaptedEngine(params, std::move(profiles), cache_res);
+    if (!status.ok()) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX
+          << "Building an engine with adapted profiles for " << params.name
+          << " failed, keeping the current engine. Reason: " << status;
+    }
+    mutex_lock lock(cache_res->adaptive_profiles_mu_);
+    cache_res->building_adapted_engine_ = false;
+  });
+}
+
+void TRTEngineOp::MaybeInstallAdaptedEngine(
+    TRTEngineCacheResource* cache_res) {
+  std::unique_ptr<TRTEngineCacheResource::AdaptedEngine> adapted_engine;
+  {
+    mutex_lock lock(cache_res->adaptive_profiles_mu_);
+    adapted_engine = std::move(cache_res->adapted_engine_);
+  }
+  auto& cache = cache_res->cache_;
+  if (!adapted_engine || cache.size() != 1) {
+    return;
+  }
+  // Inference calls which already looked up the current engine may still be
+  // running it, so it is retired rather than destroyed.
+  cache_res->retired_engines_.push_back(
+      std::move(adapted_engine->engine_context));
+  std::swap(cache_res->retired_engines_.back(), cache.begin()->second);
+  cache_res->profiles_.ReplaceProfiles(std::move(adapted_engine->profiles));
+  VLOG(1) << "Replaced the TensorRT engine of " << name()
+          << " by an engine with adapted profiles: "
+          << cache_res->profiles_.ProfilesDebugString();
+}
+
 // TODO(hinsu): Move this allocation to CalibrationContext constructor, if
 // possible.
 Status TRTEngineOp::AllocateCalibrationResources(
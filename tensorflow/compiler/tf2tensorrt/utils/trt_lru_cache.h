@@ -251,6 +251,23 @@ class TRTEngineCacheResource : public ResourceBase {
   // generation and engine build. During runtime the list of profiles is used to
   // look up a matching profile for the input data.
   TrtShapeOptimizationProfile profiles_;
+
+  // An engine built in the background with profiles adapted to the input
+  // shapes observed at runtime, waiting to replace the cached engine.
+  struct AdaptedEngine {
+    std::unique_ptr<EngineContext> engine_context;
+    TrtShapeOptimizationProfile profiles;
+  };
+
+  mutex adaptive_profiles_mu_;
+  bool building_adapted_engine_ TF_GUARDED_BY(adaptive_profiles_mu_) = false;
+  int num_adapted_engines_ TF_GUARDED_BY(adaptive_profiles_mu_) = 0;
+  std::unique_ptr<AdaptedEngine> adapted_engine_
+      TF_GUARDED_BY(adaptive_profiles_mu_);
+
+  // Engines replaced by adapted engines. They are kept alive because inference
+  // calls which looked them up before the replacement may still run them.
+  std::vector<std::unique_ptr<EngineContext>> retired_engines_;
 };
 
 #endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
@@ -0,0 +1,134 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_persistent_engine_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/compiler/tf2tensorrt/common/utils.h"
+#include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/util/env_var.h"
+
+#if GOOGLE_CUDA && GOOGLE_TENSORRT
+#include "third_party/tensorrt/NvInfer.h"
+
+namespace tensorflow {
+namespace tensorrt {
+namespace {
+
+// Version of the key derivation. Bump it when the key changes, so engines
+// cached under the old key are not picked up.
+constexpr int kKeyVersion = 1;
+
+string EngineFilename(const string& cache_dir, const string& key) {
+  return io::JoinPath(cache_dir, absl::StrCat(key, ".trt_engine"));
+}
+
+}  // namespace
+
+const string& GetPersistentEngineCacheDir() {
+  static const string* cache_dir = [] {
+    string* cache_dir = new string;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_TRT_PERSISTENT_ENGINE_CACHE_DIR",
+                                     /*default_val=*/"", cache_dir));
+    if (!cache_dir->empty()) {
+      LOG(INFO) << "Using the TF-TRT persistent engine cache in " << *cache_dir;
+    }
+    return cache_dir;
+  }();
+  return *cache_dir;
+}
+
+string PersistentEngineCacheKey(
+    const GraphDef& segment_graph_def,
+    const std::vector<PartialTensorShape>& input_shapes,
+    const string& profiles, const string& build_options,
+    const string& compute_capability) {
+  string serialized_graph;
+  SerializeToStringDeterministic(segment_graph_def, &serialized_graph);
+  const string description = absl::StrCat(
+      "key_version: ", kKeyVersion,
+      "\ngraph: ", Fingerprint64(serialized_graph),
+      "\ninput_shapes: ", DebugString(input_shapes),
+      "\nprofiles: ", profiles,
+      "\nbuild_options: ", build_options,
+      "\ntensorrt: ", absl::StrJoin(GetLinkedTensorRTVersion(), "."),
+      "\ncompute_capability: ", compute_capability);
+  return absl::StrCat(absl::Hex(Fingerprint64(description), absl::kZeroPad16));
+}
+
+StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> LoadPersistentEngine(
+    const string& cache_dir, const string& key,
+    nvinfer1::IGpuAllocator* allocator, nvinfer1::ILogger* logger) {
+  const string filename = EngineFilename(cache_dir, key);
+  string serialized_engine;
+  TF_RETURN_IF_ERROR(
+      ReadFileToString(Env::Default(), filename, &serialized_engine));
+
+  TrtUniquePtrType<nvinfer1::IRuntime> runtime(
+      nvinfer1::createInferRuntime(*logger));
+  TRT_ENSURE(runtime);
+  runtime->setGpuAllocator(allocator);
+  // Need to initialize plugins in order to deserialize engines that contain
+  // plugins.
+  MaybeInitializeTrtPlugins(logger);
+  TrtUniquePtrType<nvinfer1::ICudaEngine> engine(runtime->deserializeCudaEngine(
+      serialized_engine.data(), serialized_engine.size(), nullptr));
+  if (!engine) {
+    return errors::DataLoss("Failed to deserialize the TensorRT engine in ",
+                            filename);
+  }
+  return engine;
+}
+
+Status SavePersistentEngine(const string& cache_dir, const string& key,
+                            nvinfer1::ICudaEngine* engine) {
+  TRT_ENSURE(engine);
+  TrtUniquePtrType<nvinfer1::IHostMemory> engine_data(engine->serialize());
+  if (!engine_data) {
+    return errors::Internal("Failed to serialize the TensorRT engine.");
+  }
+
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(cache_dir));
+  const string filename = EngineFilename(cache_dir, key);
+  string tmp_filename = filename;
+  if (!env->CreateUniqueFileName(&tmp_filename, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            filename);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(
+      env, tmp_filename,
+      StringPiece(static_cast<const char*>(engine_data->data()),
+                  engine_data->size())));
+  Status s = env->RenameFile(tmp_filename, filename);
+  if (!s.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return s;
+}
+
+}  // namespace tensorrt
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
@@ -0,0 +1,74 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_PERSISTENT_ENGINE_CACHE_H_
+#define TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_PERSISTENT_ENGINE_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+#if GOOGLE_CUDA && GOOGLE_TENSORRT
+#include "third_party/tensorrt/NvInfer.h"
+
+namespace tensorflow {
+namespace tensorrt {
+
+// A directory of serialized TensorRT engines shared by all the processes that
+// serve the same model, so that engines are built once, either offline or by
+// the first replica, rather than by every process on its first inference.
+// The directory is set by the TF_TRT_PERSISTENT_ENGINE_CACHE_DIR environment
+// variable and may live on a shared file system. Running the converted model
+// once with representative inputs and the variable set populates the cache.
+//
+// Engines are keyed by everything they depend on, so a stale engine is never
+// loaded: the segment graph, the input shapes and optimization profiles, the
+// build options, the TensorRT version and the compute capability of the GPU.
+
+// Returns the persistent engine cache directory, or an empty string if the
+// cache is disabled.
+const string& GetPersistentEngineCacheDir();
+
+// Returns the key of the engine built from `segment_graph_def`.
+// `build_options` describes the options the engine is built with, such as the
+// precision mode, and `compute_capability` the GPU it is built for.
+string PersistentEngineCacheKey(
+    const GraphDef& segment_graph_def,
+    const std::vector<PartialTensorShape>& input_shapes,
+    const string& profiles, const string& build_options,
+    const string& compute_capability);
+
+// Loads the engine with `key` from the cache in `cache_dir`. Returns NotFound
+// if the cache has no such engine.
+StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> LoadPersistentEngine(
+    const string& cache_dir, const string& key,
+    nvinfer1::IGpuAllocator* allocator, nvinfer1::ILogger* logger);
+
+// Saves `engine` with `key` into the cache in `cache_dir`. The engine is
+// written to a temporary file and then renamed, so concurrent readers and
+// writers never see a partial engine.
+Status SavePersistentEngine(const string& cache_dir, const string& key,
+                            nvinfer1::ICudaEngine* engine);
+
+}  // namespace tensorrt
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
+#endif  // TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_PERSISTENT_ENGINE_CACHE_H_
@@ -0,0 +1,68 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_persistent_engine_cache.h"
+
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_logger.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+#if GOOGLE_CUDA && GOOGLE_TENSORRT
+
+namespace tensorflow {
+namespace tensorrt {
+namespace {
+
+GraphDef SegmentGraph(const string& op) {
+  GraphDef graph_def;
+  NodeDef* node = graph_def.add_node();
+  node->set_name("node");
+  node->set_op(op);
+  return graph_def;
+}
+
+TEST(PersistentEngineCacheTest, KeyCoversEngineDependencies) {
+  const std::vector<PartialTensorShape> shapes = {PartialTensorShape({-1, 2})};
+  const string key = PersistentEngineCacheKey(SegmentGraph("Relu"), shapes,
+                                              "profiles", "options", "8.0");
+  EXPECT_EQ(key, PersistentEngineCacheKey(SegmentGraph("Relu"), shapes,
+                                          "profiles", "options", "8.0"));
+  EXPECT_NE(key, PersistentEngineCacheKey(SegmentGraph("Tanh"), shapes,
+                                          "profiles", "options", "8.0"));
+  EXPECT_NE(key, PersistentEngineCacheKey(SegmentGraph("Relu"),
+                                          {PartialTensorShape({-1, 3})},
+                                          "profiles", "options", "8.0"));
+  EXPECT_NE(key, PersistentEngineCacheKey(SegmentGraph("Relu"), shapes,
+                                          "other profiles", "options", "8.0"));
+  EXPECT_NE(key, PersistentEngineCacheKey(SegmentGraph("Relu"), shapes,
+                                          "profiles", "other options", "8.0"));
+  EXPECT_NE(key, PersistentEngineCacheKey(SegmentGraph("Relu"), shapes,
+                                          "profiles", "options", "8.6"));
+}
+
+TEST(PersistentEngineCacheTest, MissingEngine) {
+  Logger& logger = *Logger::GetLogger();
+  EXPECT_TRUE(errors::IsNotFound(
+      LoadPersistentEngine(testing::TmpDir(), "missing_key",
+                           /*allocator=*/nullptr, &logger)
+          .status()));
+}
+
+}  // namespace
+}  // namespace tensorrt
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
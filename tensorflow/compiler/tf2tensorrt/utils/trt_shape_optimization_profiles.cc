@@ -19,6 +19,7 @@ limitations under the License.
 #include <functional>
 
 #include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/tf2tensorrt/common/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -646,6 +647,53 @@ int TrtShapeOptimizationProfile::GetNumProfiles() const {
   return profiles_.size();
 }
 
+string TrtShapeOptimizationProfile::ProfilesDebugString() const {
+  string result;
+  for (const OptimizationProfileConfig& profile : profiles_) {
+    absl::StrAppend(&result, profile.DebugString());
+  }
+  return result;
+}
+
+void TrtShapeOptimizationProfile::RecordUnmatchedShapes(
+    const std::vector<TensorShape>& shapes) {
+  UnmatchedShapes& unmatched = unmatched_shapes_[shapes];
+  if (unmatched.count == 0) {
+    unmatched.shape_values = actual_shape_values_;
+  }
+  ++unmatched.count;
+  ++num_unmatched_shapes_;
+}
+
+TrtShapeOptimizationProfile TrtShapeOptimizationProfile::AdaptToUnmatchedShapes(
+    const std::vector<PartialTensorShape>& input_partial_shapes,
+    int64 min_count) const {
+  TrtShapeOptimizationProfile adapted = *this;
+  for (const auto& [shapes, unmatched] : unmatched_shapes_) {
+    if (unmatched.count < min_count) {
+      continue;
+    }
+    VLOG(1) << "Adding shape(s) " << DebugString(shapes) << " seen "
+            << unmatched.count << " time(s) to the profiles.";
+    adapted.input_shapes_.push_back(shapes);
+    adapted.input_shape_values_.push_back(unmatched.shape_values);
+  }
+  adapted.ClearUnmatchedShapes();
+  adapted.profiles_.clear();
+  adapted.InitProfiles(input_partial_shapes, strategy_);
+  return adapted;
+}
+
+void TrtShapeOptimizationProfile::ReplaceProfiles(
+    TrtShapeOptimizationProfile&& adapted) {
+  input_shapes_ = std::move(adapted.input_shapes_);
+  input_shape_values_ = std::move(adapted.input_shape_values_);
+  profiles_ = std::move(adapted.profiles_);
+  need_profiles_ = adapted.need_profiles_;
+  strategy_ = adapted.strategy_;
+  ClearUnmatchedShapes();
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <list>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -256,6 +257,35 @@ class TrtShapeOptimizationProfile {
   // Returns number of created profiles.
   int GetNumProfiles() const;
 
+  // Returns a description of the created profiles, which identifies the
+  // profiles an engine is built for.
+  string ProfilesDebugString() const;
+
+  // Records input shapes that none of the profiles includes, together with the
+  // shape values of the current inference call.
+  void RecordUnmatchedShapes(const std::vector<TensorShape>& shapes);
+
+  // Returns the number of recorded inference calls with unmatched shapes.
+  int64 NumUnmatchedShapes() const { return num_unmatched_shapes_; }
+
+  void ClearUnmatchedShapes() {
+    unmatched_shapes_.clear();
+    num_unmatched_shapes_ = 0;
+  }
+
+  // Returns a copy of these profiles, recreated with the same strategy from the
+  // collected shapes and the unmatched shapes recorded at least `min_count`
+  // times, so that they cover the shapes observed at runtime.
+  TrtShapeOptimizationProfile AdaptToUnmatchedShapes(
+      const std::vector<PartialTensorShape>& input_partial_shapes,
+      int64 min_count) const;
+
+  // Takes over the profiles of `adapted`, which was returned by
+  // `AdaptToUnmatchedShapes` and used to build an engine for the same network.
+  // The shape values of the current inference call are kept, since concurrent
+  // inference calls may be using them.
+  void ReplaceProfiles(TrtShapeOptimizationProfile&& adapted);
+
   bool HasShape() const { return !input_shapes_.empty(); }
   bool NeedProfiles() const { return need_profiles_; }
 
@@ -295,6 +325,18 @@ class TrtShapeOptimizationProfile {
   // The optimization profiles generated from input_shapes_.
   std::vector<OptimizationProfileConfig> profiles_;
 
+  // Input shapes that none of the profiles includes, recorded by
+  // RecordUnmatchedShapes.
+  struct UnmatchedShapes {
+    int64 count = 0;
+    // Shape values of the first inference call with these shapes.
+    std::vector<nvinfer1::Dims> shape_values;
+  };
+  std::unordered_map<std::vector<TensorShape>, UnmatchedShapes,
+                     VectorTensorShapeHasher>
+      unmatched_shapes_;
+  int64 num_unmatched_shapes_ = 0;
+
   // The optimization profile for calibration.
   OptimizationProfileConfig calib_profiles_;
 
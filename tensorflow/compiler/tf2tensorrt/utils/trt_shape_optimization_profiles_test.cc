@@ -250,6 +250,56 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   CheckProfile(unseen_shapes, &profile, has_prof, false);
 }
 
+TEST_P(TrtShapeOptimizationProfileTest, AdaptToUnmatchedShapes) {
+  nvinfer1::Dims3 dims(-1, -1, 10);
+  DefineNetwork(network_.get(), dims);
+
+  TrtShapeOptimizationProfile profile;
+  profile.SetInputMask(std::vector<bool>(2, true));
+
+  std::vector<std::vector<nvinfer1::Dims3>> input_profiles{
+      {nvinfer1::Dims3(2, 2, 10), nvinfer1::Dims3(2, 2, 10)},
+      {nvinfer1::Dims3(3, 3, 10), nvinfer1::Dims3(3, 3, 10)},
+  };
+  for (auto dim_vec : input_profiles) {
+    profile.AddShape(DimVecToShapeVec(dim_vec, true));
+  }
+  std::vector<PartialTensorShape> input_partial_shapes;
+  TF_CHECK_OK(GetNetworkInputShapes(network_.get(), &input_partial_shapes));
+  profile.InitProfiles(input_partial_shapes, strategy_);
+
+  // Shapes which none of the profiles includes, one of them seen only once.
+  std::vector<nvinfer1::Dims3> frequent_shapes{nvinfer1::Dims3(16, 16, 10),
+                                               nvinfer1::Dims3(16, 16, 10)};
+  std::vector<nvinfer1::Dims3> rare_shapes{nvinfer1::Dims3(32, 32, 10),
+                                           nvinfer1::Dims3(32, 32, 10)};
+  for (int i = 0; i < 3; i++) {
+    profile.RecordUnmatchedShapes(DimVecToShapeVec(frequent_shapes, true));
+  }
+  profile.RecordUnmatchedShapes(DimVecToShapeVec(rare_shapes, true));
+  EXPECT_EQ(profile.NumUnmatchedShapes(), 4);
+
+  TrtShapeOptimizationProfile adapted =
+      profile.AdaptToUnmatchedShapes(input_partial_shapes, /*min_count=*/2);
+  EXPECT_EQ(adapted.NumUnmatchedShapes(), 0);
+
+  TF_CHECK_OK(adapted.ConfigureBuilder(builder_.get(), builder_config_.get(),
+                                       network_.get()));
+  engine = TrtUniquePtrType<nvinfer1::ICudaEngine>(
+      builder_->buildEngineWithConfig(*network_.get(), *builder_config_.get()));
+  ASSERT_NE(nullptr, engine);
+  TF_CHECK_OK(adapted.CreateExecutionContexts(engine.get(), &exec_contexts_));
+
+  // The adapted profiles include the collected and the frequent shapes.
+  bool test_optimal_prof = strategy_ == ProfileStrategy::kOptimal ||
+                           strategy_ == ProfileStrategy::kRangeOptimal;
+  for (auto dimvec : input_profiles) {
+    CheckProfile(dimvec, &adapted, true, test_optimal_prof);
+  }
+  CheckProfile(frequent_shapes, &adapted, true, test_optimal_prof);
+  CheckProfile(rare_shapes, &adapted, false, false);
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
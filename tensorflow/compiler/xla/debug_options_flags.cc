@@ -40,6 +40,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_backend_optimization_level(3);
   opts.set_xla_gpu_autotune_level(4);
   opts.set_xla_cpu_multi_thread_eigen(true);
+  opts.set_xla_cpu_enable_concurrent_calls(false);
   opts.set_xla_gpu_cuda_data_dir("./cuda_sdk_lib");
   opts.set_xla_gpu_asm_extra_flags("");
   opts.set_xla_gpu_use_runtime_fusion(true);
@@ -49,6 +50,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_dump_include_timestamp(false);
   opts.set_xla_dump_max_hlo_modules(-1);
   opts.set_xla_dump_module_metadata(false);
+  opts.set_xla_slow_hlo_pass_threshold_ms(60 * 1000);
   opts.set_xla_dump_hlo_as_long_text(false);
   opts.set_xla_dump_enable_mlir_pretty_form(true);
 #ifdef ENABLE_MKL
@@ -75,6 +77,8 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
 
   // TODO(b/258036887): Remove this flag once CUDA Graphs are fully supported.
   opts.set_xla_gpu_enable_cuda_graphs(false);
+  opts.set_xla_gpu_cuda_graph_min_graph_size(5);
+  opts.set_xla_gpu_threshold_for_windowed_einsum_mib(100000);
 
   // Despite the name, fast min/max on GPUs does not seem to be any faster, and
   // adds very counter-intuitive "NaN-swallowing" behavior.
@@ -99,10 +103,14 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_gpu_shape_checks(DebugOptions::RUNTIME);
   opts.set_xla_gpu_enable_mlir_lowering(true);
   opts.set_xla_gpu_enable_softmax_fusion(true);
+  opts.set_xla_gpu_enable_row_normalization_emitter(false);
+  opts.set_xla_gpu_enable_memory_budget_rematerialization(false);
   opts.set_xla_gpu_normalize_layouts(true);
   opts.set_xla_gpu_simplify_all_fp_conversions(true);
   opts.set_xla_dump_latency_hiding_schedule(false);
   opts.set_xla_gpu_enable_latency_hiding_scheduler(false);
+  opts.set_xla_gpu_enable_priority_fusion(false);
+  opts.set_xla_gpu_autotune_database_dir("");
 
   opts.set_xla_cpu_enable_mlir_tiling_and_fusion(false);
   return opts;
@@ -424,6 +432,12 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       debug_options->xla_cpu_multi_thread_eigen(),
       "When generating calls to Eigen in the CPU backend, use multi-threaded "
       "Eigen mode."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_enable_concurrent_calls",
+      bool_setter_for(&DebugOptions::set_xla_cpu_enable_concurrent_calls),
+      debug_options->xla_cpu_enable_concurrent_calls(),
+      "When true, independent expensive instructions in the entry computation "
+      "of XLA:CPU programs run concurrently on the intra-op thread pool."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_cuda_data_dir", debug_options->mutable_xla_gpu_cuda_data_dir(),
       "If non-empty, specifies a local directory containing ptxas and nvvm "
@@ -622,7 +636,14 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       bool_setter_for(&DebugOptions::set_xla_dump_module_metadata),
       debug_options->xla_dump_module_metadata(),
       "Dumps HloModuleMetadata as text protos to the directory specified "
-      "by --xla_dump_to."));
+      "by --xla_dump_to. This includes the wall time, instruction counts and "
+      "resident set size before and after each HLO pass."));
+  flag_list->push_back(tsl::Flag(
+      "xla_slow_hlo_pass_threshold_ms",
+      int64_setter_for(&DebugOptions::set_xla_slow_hlo_pass_threshold_ms),
+      debug_options->xla_slow_hlo_pass_threshold_ms(),
+      "HLO pass runs taking at least this many milliseconds are logged as "
+      "warnings. 0 disables the warning."));
   flag_list->push_back(
       tsl::Flag("xla_dump_compress_protos",
                 bool_setter_for(&DebugOptions::set_xla_dump_compress_protos),
@@ -731,6 +752,14 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
           &DebugOptions::set_xla_gpu_all_reduce_combine_threshold_bytes),
       debug_options->xla_gpu_all_reduce_combine_threshold_bytes(),
       "Size threshold (in bytes) for the GPU all-reduce combiner."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_all_reduce_combine_max_delay_us",
+      int64_setter_for(
+          &DebugOptions::set_xla_gpu_all_reduce_combine_max_delay_us),
+      debug_options->xla_gpu_all_reduce_combine_max_delay_us(),
+      "If positive, the GPU all-reduce combiner only combines all-reduces "
+      "whose operands are estimated to be ready within this many "
+      "microseconds of each other."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_all_reduce_contiguous",
       bool_setter_for(&DebugOptions::set_xla_gpu_all_reduce_contiguous),
@@ -766,6 +795,12 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       bool_setter_for(&DebugOptions::set_xla_gpu_enable_cuda_graphs),
       debug_options->xla_gpu_enable_cuda_graphs(),
       "Use CUDA graphs to execute XLA GPU executables when possible."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_cuda_graph_min_graph_size",
+      int64_setter_for(&DebugOptions::set_xla_gpu_cuda_graph_min_graph_size),
+      debug_options->xla_gpu_cuda_graph_min_graph_size(),
+      "Capture only sequences of at least this many consecutive kernel "
+      "launches, memsets and copies into a CUDA graph."));
   flag_list->push_back(
       tsl::Flag("xla_dump_disable_metadata",
                 bool_setter_for(&DebugOptions::set_xla_dump_disable_metadata),
@@ -825,6 +860,20 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
                                  setter_for_xla_gpu_enable_softmax_fusion,
                                  debug_options->xla_gpu_enable_softmax_fusion(),
                                  "Enable MLIR-based softmax fusion."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_row_normalization_emitter",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_row_normalization_emitter),
+      debug_options->xla_gpu_enable_row_normalization_emitter(),
+      "Fuse softmax, layer normalization and RMS normalization patterns and "
+      "emit them with one thread block per row in XLA:GPU."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_memory_budget_rematerialization",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_memory_budget_rematerialization),
+      debug_options->xla_gpu_enable_memory_budget_rematerialization(),
+      "Rematerialize modules whose peak memory exceeds the device memory in "
+      "XLA:GPU, choosing the values to recompute with the cost model."));
   flag_list->push_back(
       tsl::Flag("xla_gpu_normalize_layouts",
                 bool_setter_for(&DebugOptions::set_xla_gpu_normalize_layouts),
@@ -854,6 +903,28 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
                     &DebugOptions::set_xla_gpu_enable_latency_hiding_scheduler),
                 debug_options->xla_gpu_enable_latency_hiding_scheduler(),
                 "Enable latency-hiding scheduler for XLA:GPU"));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_threshold_for_windowed_einsum_mib",
+      int64_setter_for(
+          &DebugOptions::set_xla_gpu_threshold_for_windowed_einsum_mib),
+      debug_options->xla_gpu_threshold_for_windowed_einsum_mib(),
+      "Decompose the all-gather or reduce-scatter of dot operands of at least "
+      "this many MiB into collective-permutes overlapping with partial dots "
+      "when partitioning SPMD programs."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_priority_fusion",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_priority_fusion),
+      debug_options->xla_gpu_enable_priority_fusion(),
+      "Merge fusions in order of the run time savings predicted by the GPU "
+      "performance model instead of running FusionMerger."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_autotune_database_dir",
+      string_setter_for(&DebugOptions::set_xla_gpu_autotune_database_dir),
+      debug_options->xla_gpu_autotune_database_dir(),
+      "Directory of a GEMM and convolution autotuning database shared across "
+      "processes. Compilations load it before autotuning and merge their new "
+      "results back, so compiling representative modules (e.g. with "
+      "run_hlo_module) with this flag set precomputes the database."));
 }  // NOLINT(readability/fn_size)
 
 // Allocates flag_values and flag_objects; this function must not be called more
@@ -20,6 +20,7 @@ limitations under the License.
 #include <cmath>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <numeric>
@@ -29,6 +30,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -44,6 +46,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_sharding.h"
 #include "tensorflow/compiler/xla/service/dump.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/heap_simulator.h"
 #include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_ordering.h"
@@ -369,6 +372,50 @@ std::vector<std::vector<double>> ReshardingCostsForTupleOperand(
   return resharding_costs;
 }
 
+// Adds to every strategy of a dot or convolution the cost of the flops each
+// device runs under it. The flops are divided among the tiles of the output,
+// and further among the partial results when the strategy splits the
+// contracting dimensions, so replicated strategies pay for the whole op.
+void AddComputeCosts(const HloInstruction* ins,
+                     const ClusterEnvironment& cluster_env,
+                     std::unique_ptr<StrategyVector>& strategies) {
+  const double flop_cost = cluster_env.solver_option_.flop_cost;
+  if (flop_cost <= 0 || strategies->is_tuple) {
+    return;
+  }
+  const Shape& lhs_shape = ins->operand(0)->shape();
+  double flops;
+  std::vector<int64_t> lhs_contracting_dims;
+  if (ins->opcode() == HloOpcode::kDot) {
+    flops = HloCostAnalysis::GetDotFlops(lhs_shape, ins->shape(),
+                                         ins->dot_dimension_numbers());
+    absl::c_copy(ins->dot_dimension_numbers().lhs_contracting_dimensions(),
+                 std::back_inserter(lhs_contracting_dims));
+  } else {
+    CHECK_EQ(ins->opcode(), HloOpcode::kConvolution);
+    flops = HloCostAnalysis::GetConvolutionFlops(
+        ins, lhs_shape, ins->operand(1)->shape(), ins->shape());
+    lhs_contracting_dims.push_back(
+        ins->convolution_dimension_numbers().input_feature_dimension());
+  }
+
+  for (ShardingStrategy& strategy : strategies->leaf_vector) {
+    if (strategy.output_sharding.IsManual()) {
+      continue;
+    }
+    double num_shards = strategy.output_sharding.NumTiles();
+    if (!strategy.input_shardings.empty()) {
+      const HloSharding& lhs_spec = strategy.input_shardings[0];
+      if (!lhs_spec.IsTileMaximal() && !lhs_spec.IsManual()) {
+        for (int64_t dim : lhs_contracting_dims) {
+          num_shards *= lhs_spec.tile_assignment().dim(dim);
+        }
+      }
+    }
+    strategy.compute_cost += flop_cost * flops / num_shards;
+  }
+}
+
 // Add "Replicate()" strategy
 void AddReplicatedStrategy(const HloInstruction* ins, const Shape& shape,
                            const ClusterEnvironment& cluster_env,
@@ -1785,6 +1832,10 @@ BuildStrategyAndCost(const HloInstructionSequence& sequence,
           ins->sharding(), cluster_env, trimmed_strategy_map, call_graph,
           solver_option.nd_sharding_iteratively_strict_search_space);
     }
+    if (ins->opcode() == HloOpcode::kDot ||
+        ins->opcode() == HloOpcode::kConvolution) {
+      AddComputeCosts(ins, cluster_env, strategies);
+    }
     if (!strategies->is_tuple && strategies->following) {
       if (!LeafVectorsAreConsistent(
               strategies->leaf_vector, strategies->following->leaf_vector,
@@ -3739,6 +3790,7 @@ StatusOr<bool> AutoSharding::Run(
   }
   solver_option.force_batch_dim_to_mesh_dim =
       option_.force_batch_dim_to_mesh_dim;
+  solver_option.flop_cost = option_.device_flop_cost;
   solver_option.allow_replicated_parameters =
       option_.allow_replicated_parameters;
   solver_option.prefer_reduce_scatter = option_.prefer_reduce_scatter;
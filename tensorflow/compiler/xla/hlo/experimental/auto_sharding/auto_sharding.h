@@ -157,6 +157,13 @@ struct AutoShardingOption {
   // element models the communication performance along each mesh dimension.
   std::vector<double> device_mesh_alpha;
   std::vector<double> device_mesh_beta;
+  // Cost of one floating point operation on a device, in the unit of
+  // device_mesh_alpha and device_mesh_beta. If positive, every sharding
+  // strategy of a dot or convolution also costs the flops each device runs
+  // under it, so that the solver minimizes the estimated step time rather than
+  // the communication alone, e.g. when choosing between replicating and
+  // splitting a dot. Default value 0 only models communication.
+  double device_flop_cost = 0;
   // Load the strategy vector instead of solving one.
   bool load_strategy = false;
   std::vector<int64_t> strategy_vector;
@@ -222,6 +229,7 @@ struct AutoShardingOption {
                                  absl::StrJoin(device_mesh_alpha, ","), "]"));
     lines.push_back(absl::StrCat("device_mesh_beta: [",
                                  absl::StrJoin(device_mesh_beta, ","), "]"));
+    lines.push_back(absl::StrCat("device_flop_cost: ", device_flop_cost));
 
     lines.push_back(absl::StrCat("load_strategy: ", load_strategy));
     if (load_strategy) {
@@ -251,6 +259,11 @@ struct AutoShardingOption {
                        "device_mesh_shape=",
                        absl::StrJoin(device_mesh_shape, ",")));
     }
+    if (device_flop_cost < 0) {
+      return tsl::errors::OutOfRange(absl::StrCat(
+          "device_flop_cost needs to be non-negative: device_flop_cost=",
+          device_flop_cost));
+    }
     if (device_mesh_alpha.empty()) {
       // Generates simple device_mesh_alpha based on the size of
       // device_mesh_shape.
@@ -362,6 +375,10 @@ void SetInNodesWithInstruction(std::unique_ptr<StrategyVector>& strategies,
 
 void RemoveDuplicatedStrategy(std::unique_ptr<StrategyVector>& strategies);
 
+void AddComputeCosts(const HloInstruction* ins,
+                     const ClusterEnvironment& cluster_env,
+                     std::unique_ptr<StrategyVector>& strategies);
+
 Status FilterStrategy(const HloInstruction* ins, const Shape& shape,
                       std::unique_ptr<StrategyVector>& strategies,
                       const ClusterEnvironment& cluster_env,
@@ -46,6 +46,10 @@ struct AutoShardingSolverOption {
   bool override_all_to_all_cost;
   double all_to_all_cost;
 
+  // Cost of one floating point operation on a device. Dot and convolution
+  // strategies are charged for their flops only if it is positive.
+  double flop_cost;
+
   // If true, allow replicated parameters.
   bool allow_replicated_parameters;
 
@@ -0,0 +1,98 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/hlo/experimental/auto_sharding/auto_sharding.h"
+
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+
+namespace xla {
+namespace spmd {
+namespace {
+
+using AutoShardingTest = HloTestBase;
+
+// A dot with replicated operands whose replicated result is consumed by a
+// replicated root. Splitting its contracting dimension over mesh dimension 0
+// only (a recomputation on mesh dimension 1) avoids all communication over
+// the slow mesh dimension 1, at the price of running half of the flops on
+// every device instead of a quarter.
+constexpr absl::string_view kReplicatedDotHlo = R"(
+HloModule module
+
+ENTRY %entry {
+  %param0 = f32[256,4]{1,0} parameter(0), sharding={replicated}
+  %param1 = f32[4,256]{1,0} parameter(1), sharding={replicated}
+  %dot = f32[256,256]{1,0} dot(%param0, %param1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  ROOT %negate = f32[256,256]{1,0} negate(%dot), sharding={replicated}
+})";
+
+AutoShardingOption DotOnSlowMeshOption() {
+  AutoShardingOption option;
+  option.enable = true;
+  option.solve_nd_sharding_iteratively = false;
+  option.allow_recompute_heavy_op = true;
+  option.device_mesh_shape = {2, 2};
+  option.device_mesh_ids = {0, 1, 2, 3};
+  option.device_mesh_alpha = {1.0, 1.0};
+  option.device_mesh_beta = {0.0, 1.0};
+  return option;
+}
+
+TEST_F(AutoShardingTest, DeviceFlopCostDefaultKeepsRecomputedDot) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kReplicatedDotHlo));
+  AutoShardingOption option = DotOnSlowMeshOption();
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, AutoSharding(option).Run(module.get()));
+  EXPECT_TRUE(changed);
+  const HloInstruction* dot = FindInstruction(module.get(), "dot");
+  ASSERT_NE(dot, nullptr);
+  ASSERT_TRUE(dot->has_sharding());
+  EXPECT_TRUE(dot->sharding().IsReplicated()) << dot->sharding().ToString();
+}
+
+TEST_F(AutoShardingTest, DeviceFlopCostSplitsDot) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kReplicatedDotHlo));
+  AutoShardingOption option = DotOnSlowMeshOption();
+  // The dot runs 2 * 256 * 256 * 4 flops, so the recomputation now costs
+  // 131072 more than a split over all 4 devices, which outweighs the
+  // all-gather of the tiled result over mesh dimension 1.
+  option.device_flop_cost = 1.0;
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, AutoSharding(option).Run(module.get()));
+  EXPECT_TRUE(changed);
+  const HloInstruction* dot = FindInstruction(module.get(), "dot");
+  ASSERT_NE(dot, nullptr);
+  ASSERT_TRUE(dot->has_sharding());
+  EXPECT_FALSE(dot->sharding().IsReplicated()) << dot->sharding().ToString();
+  EXPECT_EQ(dot->sharding().NumTiles(), 4) << dot->sharding().ToString();
+}
+
+TEST_F(AutoShardingTest, NegativeDeviceFlopCostIsRejected) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kReplicatedDotHlo));
+  AutoShardingOption option = DotOnSlowMeshOption();
+  option.device_flop_cost = -1.0;
+  EXPECT_FALSE(AutoSharding(option).Run(module.get()).ok());
+}
+
+}  // namespace
+}  // namespace spmd
+}  // namespace xla
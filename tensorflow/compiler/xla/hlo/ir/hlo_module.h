@@ -381,6 +381,15 @@ class HloModule {
     return result;
   }
 
+  // Gives 'instruction' a name and an id that are unique in this module. Unlike
+  // the two functions above, this is thread-safe, so that HloComputationPasses
+  // can add instructions to different computations of the module concurrently.
+  void UniquifyInstruction(HloInstruction* instruction) {
+    absl::MutexLock lock(&instruction_uniquing_mutex_);
+    instruction->UniquifyName(&instruction_name_uniquer_);
+    instruction->SetUniqueId(NewUniqueInstructionId());
+  }
+
   // input_output_alias_config indicates the list of aliased buffers that are
   // expected from the module.
   HloInputOutputAliasConfig& input_output_alias_config() {
@@ -570,6 +579,8 @@ class HloModule {
   NameUniquer computation_name_uniquer_{/*separator=*/"."};
   NameUniquer instruction_name_uniquer_{/*separator=*/"."};
   int next_unique_id_ = 0;
+  // Serializes UniquifyInstruction.
+  absl::Mutex instruction_uniquing_mutex_;
 
   // Used to keep track of the next unique module id that should be assigned.
   static std::atomic<int> next_unique_module_id_;
@@ -92,6 +92,20 @@ class HloModuleMetadata {
           pass_metadata->set_module_changed(module_changed);
         });
   }
+  Status set_current_pass_instruction_counts(int64_t before, int64_t after) {
+    return MutateCurrentHloPassMetadata(
+        [before, after](HloPassMetadata* pass_metadata) {
+          pass_metadata->set_instruction_count_before(before);
+          pass_metadata->set_instruction_count_after(after);
+        });
+  }
+  Status set_current_pass_rss_bytes(int64_t before, int64_t after) {
+    return MutateCurrentHloPassMetadata(
+        [before, after](HloPassMetadata* pass_metadata) {
+          pass_metadata->set_rss_bytes_before(before);
+          pass_metadata->set_rss_bytes_after(after);
+        });
+  }
   Status set_current_pass_module_id(int64_t module_id) {
     return MutateCurrentHloPassMetadata(
         [&module_id](HloPassMetadata* pass_metadata) {
@@ -75,6 +75,12 @@ struct CompileOptions {
   // XLA compilation profile version.
   int64_t profile_version = 0;
 
+  // If true, the outputs of the executable are allocated from the memory of
+  // deleted outputs of the same size, of executables compiled with this option,
+  // rather than by the device allocator. Suits executables that are run over
+  // and over with the same shapes. Ignored by clients that do not support it.
+  bool recycle_output_buffers = false;
+
   // Set multi_slice_config to trigger compilation for DCN connected multi
   // slice operation.
   const MultiSliceConfig* multi_slice_config = nullptr;
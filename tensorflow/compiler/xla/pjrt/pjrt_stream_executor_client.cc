@@ -226,6 +226,8 @@ PjRtStreamExecutorClient::PjRtStreamExecutorClient(
   } else {
     allocator_ = client_->backend().memory_allocator();
   }
+  recycling_allocator_ =
+      std::make_unique<RecyclingDeviceMemoryAllocator>(allocator_);
 
   if (!host_memory_allocator_) {
     host_memory_allocator_ = std::make_unique<CpuAllocator>();
@@ -266,6 +268,9 @@ PjRtStreamExecutorClient::GetHloCostAnalysis() const {
 
 namespace {
 
+// Size of the chunks in which large host buffers are staged and transferred.
+constexpr int64_t kHostToDeviceTransferChunkSize = 8 << 20;
+
 // Ensures that it is safe to deallocate any buffers that have been enqueued in
 // an operation on stream. Called only in rare error cases that are triggered
 // during enqueue. These cases generally correspond to resource exhaustion.
@@ -771,16 +776,27 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
     }
   }
 
+  se::Stream* h2d_stream = local_device->GetHostToDeviceStream();
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<PjRtStreamExecutorBuffer> py_buffer,
-      AllocateDestinationBuffer(compact_shape, device, local_device,
-                                local_device->host_to_device_stream(),
+      AllocateDestinationBuffer(compact_shape, device, local_device, h2d_stream,
                                 /*is_uninitialized_create=*/false, this));
 
   PjRtStreamExecutorBuffer::ScopedHold device_buffer(
       py_buffer->GetBufferWithUsageHold());
   CHECK(device_buffer.ok());
 
+  // A large array that the transfer manager would transfer as a single copy of
+  // its staged bytes is instead staged and transferred a chunk at a time, so
+  // that the transfer of a chunk overlaps the staging of the next.
+  const Shape& on_device_shape = py_buffer->on_device_shape();
+  const bool transfer_in_chunks =
+      size > kHostToDeviceTransferChunkSize && host_and_device_strides_equal &&
+      on_device_shape.IsArray() && on_device_shape.is_static() &&
+      on_device_shape.layout() == compact_shape.layout() &&
+      transfer_manager->GetByteSizeRequirement(on_device_shape) == size &&
+      dynamic_cast<GenericTransferManager*>(transfer_manager) != nullptr;
+
   // If necessary, allocate a host-side buffer for staging host-to-device
   // transfers. On GPU this is a buffer in pinned memory.
   std::shared_ptr<void> staging_buffer;
@@ -795,25 +811,41 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
         });
   }
 
+  // A transpose that runs before returning to the caller is split across the
+  // thread pool, unless the caller is a thread of the pool; one that runs on
+  // the thread pool is not, as it would then wait for work queued behind it.
+  const bool transpose_during_call =
+      host_buffer_semantics == HostBufferSemantics::kImmutableOnlyDuringCall;
   std::shared_ptr<TransposePlan> transpose;
   if (!host_and_device_strides_equal) {
     absl::InlinedVector<int64_t, 4> permutation(dims.size());
     absl::c_reverse_copy(compact_shape.layout().minor_to_major(),
                          permutation.begin());
     absl::MutexLock lock(&transpose_mu_);
-    TF_ASSIGN_OR_RETURN(transpose,
-                        transpose_cache_.GetOrCreate(
-                            primitive_util::ByteWidth(type), dims, permutation,
-                            TransposePlan::Striding{*byte_strides}));
+    TF_ASSIGN_OR_RETURN(
+        transpose,
+        transpose_cache_.GetOrCreate(
+            primitive_util::ByteWidth(type), dims, permutation,
+            TransposePlan::Striding{*byte_strides},
+            /*output_tiling=*/TransposePlan::Tiling{},
+            TransposePlan::Transformation::kNone,
+            /*num_threads=*/transpose_during_call ? thread_pool_.NumThreads()
+                                                  : 1));
   }
 
   // Copy the buffer into a staging buffer before returning control to the
   // caller if the caller only guaranteed that the buffer is valid for the
   // duration of the call. Otherwise, we stage (if necessary) on a separate
   // thread.
-  if (host_buffer_semantics == HostBufferSemantics::kImmutableOnlyDuringCall) {
+  if (transpose_during_call) {
     if (transpose) {
-      transpose->Execute(data, staging_buffer.get());
+      std::function<void(std::function<void()>)> schedule_work;
+      if (thread_pool_.CurrentThreadId() < 0) {
+        schedule_work = [this](std::function<void()> fn) {
+          thread_pool_.Schedule(std::move(fn));
+        };
+      }
+      transpose->Execute(data, staging_buffer.get(), schedule_work);
     } else {
       std::memcpy(staging_buffer.get(), data, size);
     }
@@ -830,13 +862,13 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
   // TODO(misard) assess if it would be preferable to introduce a heuristic to
   // put the transfer into the calling thread for small literals.
   auto transfer_h2d =
-      [local_client = client(), transfer_manager, local_device, data, size,
-       movable_device_buffer{device_buffer.ToClosure()}, shape,
-       py_buffer{py_buffer.get()},
-       on_device_shape{py_buffer->on_device_shape()},
+      [local_client = client(), transfer_manager, local_device, h2d_stream,
+       data, size, movable_device_buffer{device_buffer.ToClosure()}, shape,
+       py_buffer{py_buffer.get()}, on_device_shape{on_device_shape},
        staging_buffer{std::move(staging_buffer)},
        on_done_with_host_buffer{std::move(on_done_with_host_buffer)},
-       host_buffer_semantics, transpose{std::move(transpose)}]() {
+       host_buffer_semantics, transpose{std::move(transpose)},
+       transfer_in_chunks]() mutable {
         PjRtStreamExecutorBuffer::ScopedHold device_buffer(
             movable_device_buffer);
         // This function uses TF_CHECK_OK and value() since we have no way
@@ -849,7 +881,25 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
         // If applicable on the backend, stage the transfer via host memory
         // allocated via the host_memory_allocator. On GPU, this is pinned
         // memory.
-        if (staging_buffer) {
+        if (staging_buffer && transfer_in_chunks &&
+            host_buffer_semantics !=
+                HostBufferSemantics::kImmutableOnlyDuringCall) {
+          // Each chunk is copied from its own range of the staging buffer,
+          // which is only released by the callback enqueued on h2d_stream
+          // below, i.e. once the copies of all the chunks are done.
+          char* device_data =
+              static_cast<char*>(buffer.root_buffer().opaque());
+          char* staging_data = static_cast<char*>(staging_buffer.get());
+          for (int64_t offset = 0; offset < size;
+               offset += kHostToDeviceTransferChunkSize) {
+            int64_t chunk_size =
+                std::min(kHostToDeviceTransferChunkSize, size - offset);
+            std::memcpy(staging_data + offset,
+                        static_cast<const char*>(data) + offset, chunk_size);
+            se::DeviceMemoryBase chunk(device_data + offset, chunk_size);
+            h2d_stream->ThenMemcpy(&chunk, staging_data + offset, chunk_size);
+          }
+        } else if (staging_buffer) {
           // If we didn't already copy the input buffer into the staging buffer,
           // do so now.
           if (host_buffer_semantics !=
@@ -866,24 +916,23 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
               static_cast<const char*>(staging_buffer.get()),
               ShapeUtil::DeviceShapeToHostShape(on_device_shape));
           TF_CHECK_OK(transfer_manager->TransferLiteralToDeviceAsync(
-              local_device->host_to_device_stream(), literal, buffer));
+              h2d_stream, literal, buffer));
         } else {
           BorrowingLiteral literal(
               reinterpret_cast<const char*>(data),
               ShapeUtil::DeviceShapeToHostShape(on_device_shape));
           // Otherwise, just transfer the literal.
           TF_CHECK_OK(transfer_manager->TransferLiteralToDeviceAsync(
-              local_device->host_to_device_stream(), literal, buffer));
+              h2d_stream, literal, buffer));
         }
 
         std::shared_ptr<BufferSequencingEvent> event =
             device_buffer->definition_events()[0];
         TF_CHECK_OK(AddDestinationBufferSynchronization(
-            local_device, std::move(device_buffer), event,
-            local_device->host_to_device_stream()));
+            local_device, std::move(device_buffer), event, h2d_stream));
 
         local_device->ThenExecuteCallback(
-            local_device->host_to_device_stream(),
+            h2d_stream,
             [staging_buffer{std::move(staging_buffer)},
              on_done_with_host_buffer{std::move(on_done_with_host_buffer)}]() {
               if (on_done_with_host_buffer) {
@@ -1788,8 +1837,10 @@ PjRtStreamExecutorExecutable::PjRtStreamExecutorExecutable(
     std::shared_ptr<DeviceAssignment> device_assignment,
     std::vector<LogicalDeviceIds> addressable_device_logical_ids,
     std::vector<PjRtDevice*> addressable_devices,
-    PjRtStreamExecutorClient* client)
+    PjRtStreamExecutorClient* client, bool recycle_output_buffers)
     : client_(client),
+      allocator_(recycle_output_buffers ? client->recycling_allocator()
+                                        : client->allocator()),
       device_assignment_(std::move(device_assignment)),
       parameter_is_tupled_arguments_(parameter_is_tupled_arguments),
       addressable_device_logical_ids_(
@@ -1905,7 +1956,7 @@ PjRtStreamExecutorExecutable::MakeExecutionInputsAndWaitForEvents(
       ShapeTree<MaybeOwningDeviceMemory>::iterator iterator_end =
           execution_input.MutableBuffers()->end();
       device_buffers[i].AddToInput(&input_iterator, iterator_end,
-                                   &execution_input, client_->allocator());
+                                   &execution_input, allocator_);
       CHECK(input_iterator == iterator_end);
     }
   }
@@ -2172,7 +2223,7 @@ StatusOr<ScopedShapedBuffer> PjRtStreamExecutorExecutable::EnqueueExecution(
   ExecutableRunOptions run_options;
   run_options.set_stream(device_state->compute_stream());
   run_options.set_host_to_device_stream(device_state->host_to_device_stream());
-  run_options.set_allocator(client_->allocator());
+  run_options.set_allocator(allocator_);
   run_options.set_intra_op_thread_pool(
       client_->client()->backend().eigen_intra_op_thread_pool_device());
   run_options.set_device_assignment(device_assignment.get());
@@ -2229,7 +2280,7 @@ StatusOr<ScopedShapedBuffer> PjRtStreamExecutorExecutable::EnqueueExecution(
     compute_callbacks.push_back(
         [references{std::make_tuple(executables_[executable_idx],
                                     compute_reservation, device_assignment)},
-         donated_ptrs{std::move(donated_ptrs)}, allocator{client_->allocator()},
+         donated_ptrs{std::move(donated_ptrs)}, allocator{allocator_},
          device_ordinal]() {
           for (const auto& ptr : donated_ptrs) {
             TF_CHECK_OK(allocator->Deallocate(device_ordinal, ptr));
@@ -2274,7 +2325,7 @@ PjRtStreamExecutorExecutable::MakeOutputBuffers(
       ShapedBuffer root_buffer_holder = result_buffer.release();
       se::DeviceMemoryBase root_buffer = root_buffer_holder.root_buffer();
       compute_callbacks.push_back(
-          [root_buffer, allocator{client_->allocator()}, device_ordinal]() {
+          [root_buffer, allocator{allocator_}, device_ordinal]() {
             TF_CHECK_OK(allocator->Deallocate(device_ordinal, root_buffer));
           });
     }
@@ -2694,7 +2745,8 @@ PjRtStreamExecutorClient::Compile(const XlaComputation& computation,
   auto executable = std::make_unique<PjRtStreamExecutorExecutable>(
       std::move(local_executables), options.parameter_is_tupled_arguments,
       std::move(device_assignment), std::move(addressable_device_logical_ids),
-      std::move(addressable_devices), this);
+      std::move(addressable_devices), this,
+      options.recycle_output_buffers);
 
   TF_RETURN_IF_ERROR(
       executable->SetUpDonation(options.parameter_is_tupled_arguments));
@@ -2778,7 +2830,8 @@ PjRtStreamExecutorClient::DeserializeExecutable(
   auto executable = std::make_unique<PjRtStreamExecutorExecutable>(
       std::move(local_executables), options->parameter_is_tupled_arguments,
       std::move(device_assignment), std::move(addressable_device_logical_ids),
-      std::move(addressable_devices), this);
+      std::move(addressable_devices), this,
+      options->recycle_output_buffers);
 
   TF_RETURN_IF_ERROR(
       executable->SetUpDonation(options->parameter_is_tupled_arguments));
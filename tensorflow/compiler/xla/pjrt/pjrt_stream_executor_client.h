@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/pjrt/local_device_state.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_future.h"
+#include "tensorflow/compiler/xla/pjrt/recycling_device_memory_allocator.h"
 #include "tensorflow/compiler/xla/pjrt/tracked_device_buffer.h"
 #include "tensorflow/compiler/xla/pjrt/transpose.h"
 #include "tensorflow/compiler/xla/service/computation_layout.h"
@@ -278,6 +279,12 @@ class PjRtStreamExecutorClient : public PjRtClient {
   }
   LocalClient* client() const { return client_; }
   se::DeviceMemoryAllocator* allocator() const { return allocator_; }
+  // Allocator wrapping allocator() that recycles the memory deallocated
+  // through it, for executables compiled with
+  // CompileOptions::recycle_output_buffers.
+  se::DeviceMemoryAllocator* recycling_allocator() const {
+    return recycling_allocator_.get();
+  }
   tsl::Allocator* host_memory_allocator() const {
     return host_memory_allocator_.get();
   }
@@ -348,6 +355,7 @@ class PjRtStreamExecutorClient : public PjRtClient {
   // complete.
   se::DeviceMemoryAllocator* allocator_;
   std::unique_ptr<se::DeviceMemoryAllocator> owned_allocator_;
+  std::unique_ptr<RecyclingDeviceMemoryAllocator> recycling_allocator_;
 
   // Includes all devices, including non-local devices on multi-host platforms.
   std::vector<std::unique_ptr<PjRtStreamExecutorDevice>> owned_devices_;
@@ -716,7 +724,7 @@ class PjRtStreamExecutorExecutable : public PjRtLoadedExecutable {
       std::shared_ptr<DeviceAssignment> device_assignment,
       std::vector<LogicalDeviceIds> addressable_device_logical_ids,
       std::vector<PjRtDevice*> addressable_devices,
-      PjRtStreamExecutorClient* client);
+      PjRtStreamExecutorClient* client, bool recycle_output_buffers = false);
 
   ~PjRtStreamExecutorExecutable() override = default;
 
@@ -860,6 +868,9 @@ class PjRtStreamExecutorExecutable : public PjRtLoadedExecutable {
   // asynchronous execution, the process being executed can outlive the
   // executable itself.
   PjRtStreamExecutorClient* const client_;
+  // Allocator of the outputs and temporaries of the executables, which also
+  // deallocates the donated arguments.
+  se::DeviceMemoryAllocator* const allocator_;
   // One executable per partition.
   std::vector<std::shared_ptr<LocalExecutable>> executables_;
   // On device shapes of the executable parameters.
@@ -15,25 +15,41 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/pjrt/pjrt_stream_executor_client.h"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <numeric>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <gmock/gmock.h>
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/compiler/xla/array2d.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
 #include "tensorflow/compiler/xla/client/xla_builder.h"
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/pjrt/local_device_state.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
 #include "tensorflow/compiler/xla/service/platform_util.h"
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/test.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/tsl/framework/allocator.h"
+#include "tensorflow/tsl/platform/casts.h"
+#include "tensorflow/tsl/platform/mem.h"
 
 namespace xla {
 namespace {
 
-xla::StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient() {
+xla::StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient(
+    bool should_stage_host_to_device_transfers = false,
+    std::unique_ptr<tsl::Allocator> host_memory_allocator = nullptr) {
   LocalClient* local_client = xla::ClientLibrary::LocalClientOrDie();
   TF_ASSIGN_OR_RETURN(se::Platform * platform,
                       PlatformUtil::GetPlatform("Host"));
@@ -51,8 +67,8 @@ xla::StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient() {
   devices.emplace_back(std::move(device));
   return std::make_unique<PjRtStreamExecutorClient>(
       "cpu", local_client, std::move(devices), /*process_index=*/0,
-      /*allocator=*/nullptr, /*host_memory_allocator=*/nullptr,
-      /*should_stage_host_to_device_transfers=*/false,
+      /*allocator=*/nullptr, std::move(host_memory_allocator),
+      should_stage_host_to_device_transfers,
       /*gpu_run_options=*/nullptr);
 }
 
@@ -114,5 +130,150 @@ TEST(PjRtStreamExecutorClientTest, DonateSameBufferTwice) {
               ::testing::HasSubstr("f(donate(a), donate(a))"));
 }
 
+TEST(PjRtStreamExecutorClientTest, RecycleOutputBuffers) {
+  auto shape = xla::ShapeUtil::MakeShape(xla::F32, {4});
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  TF_ASSERT_OK_AND_ASSIGN(auto* device0, client->LookupDevice(0));
+  XlaBuilder builder("Add");
+  auto a = Parameter(&builder, 0, shape, "a");
+  Add(a, a);
+  TF_ASSERT_OK_AND_ASSIGN(auto computation, builder.Build());
+  CompileOptions compile_options;
+  compile_options.recycle_output_buffers = true;
+  TF_ASSERT_OK_AND_ASSIGN(auto executable,
+                          client->Compile(computation, compile_options));
+
+  // The outputs of every run are deleted before the next one, so that they
+  // may be recycled.
+  for (int i = 0; i < 4; ++i) {
+    Literal input = LiteralUtil::CreateR1<float>({1.0f * i, 2, 3, 4});
+    TF_ASSERT_OK_AND_ASSIGN(auto input_buffer,
+                            client->BufferFromHostLiteral(input, device0));
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto results,
+        executable->Execute({{input_buffer.get()}}, /*options=*/{}));
+    ASSERT_EQ(results.size(), 1);
+    ASSERT_EQ(results[0].size(), 1);
+    TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> result,
+                            results[0][0]->ToLiteralSync());
+    EXPECT_EQ(*result, LiteralUtil::CreateR1<float>({2.0f * i, 4, 6, 8}));
+  }
+}
+
+// A host allocator that overwrites its allocations when they are freed, so
+// that a staging buffer released before the transfers out of it are done
+// corrupts the transferred data.
+class PoisoningAllocator : public tsl::Allocator {
+ public:
+  std::string Name() override { return "poisoning"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    void* ptr = tsl::port::AlignedMalloc(num_bytes, alignment);
+    absl::MutexLock lock(&mu_);
+    sizes_[ptr] = num_bytes;
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    {
+      absl::MutexLock lock(&mu_);
+      auto it = sizes_.find(ptr);
+      CHECK(it != sizes_.end());
+      std::memset(ptr, 0xff, it->second);
+      sizes_.erase(it);
+    }
+    tsl::port::AlignedFree(ptr);
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_map<void*, size_t> sizes_ ABSL_GUARDED_BY(mu_);
+};
+
+// Transfers `num_elements` floats through a staging buffer and checks that
+// they arrive intact. Large enough arrays are transferred in 8 MiB chunks.
+void TestStagedTransfer(int64_t num_elements) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto client,
+      GetClient(/*should_stage_host_to_device_transfers=*/true,
+                std::make_unique<PoisoningAllocator>()));
+  TF_ASSERT_OK_AND_ASSIGN(auto* device0, client->LookupDevice(0));
+  std::vector<float> data(num_elements);
+  std::iota(data.begin(), data.end(), 0.0f);
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data.data(), F32, {num_elements}, /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableUntilTransferCompletes,
+          /*on_done_with_host_buffer=*/nullptr, device0));
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> literal,
+                          buffer->ToLiteralSync());
+  EXPECT_EQ(*literal, LiteralUtil::CreateR1<float>(data));
+}
+
+constexpr int64_t kChunkElements = (8 << 20) / sizeof(float);
+
+TEST(PjRtStreamExecutorClientTest, StagedTransferBelowChunkSize) {
+  TestStagedTransfer(1000);
+}
+
+TEST(PjRtStreamExecutorClientTest, StagedTransferOfMultipleChunks) {
+  TestStagedTransfer(2 * kChunkElements);
+}
+
+TEST(PjRtStreamExecutorClientTest, StagedTransferWithPartialLastChunk) {
+  TestStagedTransfer(2 * kChunkElements + 3);
+}
+
+TEST(PjRtStreamExecutorClientTest, TransposeDuringCallOnThreadPool) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  TF_ASSERT_OK_AND_ASSIGN(auto* device0, client->LookupDevice(0));
+  // A column-major host buffer is transposed into the device's row-major
+  // layout before BufferFromHostBuffer returns, split across the client's
+  // thread pool.
+  constexpr int64_t kRows = 300;
+  constexpr int64_t kCols = 200;
+  std::vector<int32_t> column_major(kRows * kCols);
+  for (int64_t c = 0; c < kCols; ++c) {
+    for (int64_t r = 0; r < kRows; ++r) {
+      column_major[c * kRows + r] = r * kCols + c;
+    }
+  }
+  const std::vector<int64_t> byte_strides = {sizeof(int32_t),
+                                             kRows * sizeof(int32_t)};
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          column_major.data(), S32, {kRows, kCols}, byte_strides,
+          PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall,
+          /*on_done_with_host_buffer=*/nullptr, device0));
+  // The host buffer may be reused as soon as the call returns.
+  std::fill(column_major.begin(), column_major.end(), -1);
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> literal,
+                          buffer->ToLiteralSync());
+  Array2D<int32_t> expected(kRows, kCols);
+  expected.FillIota(0);
+  EXPECT_EQ(*literal, LiteralUtil::CreateR2FromArray2D<int32_t>(expected));
+}
+
+TEST(PjRtStreamExecutorClientTest, HostToDeviceStreamsRotate) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  TF_ASSERT_OK_AND_ASSIGN(auto* device0, client->LookupDevice(0));
+  TF_ASSERT_OK_AND_ASSIGN(
+      LocalDeviceState * local_device,
+      tensorflow::down_cast<PjRtStreamExecutorDevice*>(device0)
+          ->GetLocalDeviceState());
+  se::Stream* first = local_device->GetHostToDeviceStream();
+  absl::flat_hash_set<se::Stream*> streams = {first};
+  se::Stream* stream = local_device->GetHostToDeviceStream();
+  while (stream != first) {
+    EXPECT_NE(stream, local_device->host_to_device_stream());
+    EXPECT_TRUE(streams.insert(stream).second);
+    stream = local_device->GetHostToDeviceStream();
+  }
+  EXPECT_NE(first, local_device->host_to_device_stream());
+  EXPECT_GT(streams.size(), 1);
+}
+
 }  // namespace
 }  // namespace xla
@@ -0,0 +1,142 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/recycling_device_memory_allocator.h"
+
+#include <utility>
+#include <vector>
+
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace xla {
+
+RecyclingDeviceMemoryAllocator::RecyclingDeviceMemoryAllocator(
+    se::DeviceMemoryAllocator* allocator)
+    : se::DeviceMemoryAllocator(allocator->platform()),
+      allocator_(allocator) {}
+
+RecyclingDeviceMemoryAllocator::~RecyclingDeviceMemoryAllocator() {
+  absl::MutexLock lock(&mu_);
+  for (auto& [key, memory] : recycled_) {
+    const auto& [device_ordinal, memory_space, size] = key;
+    for (void* opaque : memory) {
+      TF_CHECK_OK(allocator_->Deallocate(device_ordinal,
+                                         se::DeviceMemoryBase(opaque, size)));
+    }
+  }
+}
+
+tsl::StatusOr<se::OwningDeviceMemory> RecyclingDeviceMemoryAllocator::Allocate(
+    int device_ordinal, uint64_t size, bool retry_on_failure,
+    int64_t memory_space) {
+  if (size == 0) {
+    return allocator_->Allocate(device_ordinal, size, retry_on_failure,
+                                memory_space);
+  }
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = recycled_.find(Key(device_ordinal, memory_space, size));
+    if (it != recycled_.end() && !it->second.empty()) {
+      void* opaque = it->second.back();
+      it->second.pop_back();
+      allocations_[{device_ordinal, opaque}] = {memory_space, size};
+      return se::OwningDeviceMemory(se::DeviceMemoryBase(opaque, size),
+                                    device_ordinal, this);
+    }
+  }
+
+  tsl::StatusOr<se::OwningDeviceMemory> memory = allocator_->Allocate(
+      device_ordinal, size, retry_on_failure, memory_space);
+  if (!memory.ok() && recycled_bytes(device_ordinal) > 0) {
+    // The recycled memory of other shapes may be what the allocation needs.
+    VLOG(2) << "Releasing recycled memory of device " << device_ordinal
+            << " after failing to allocate " << size << " bytes: "
+            << memory.status();
+    TF_RETURN_IF_ERROR(ReleaseRecycledMemory(device_ordinal));
+    memory = allocator_->Allocate(device_ordinal, size, retry_on_failure,
+                                  memory_space);
+  }
+  TF_RETURN_IF_ERROR(memory.status());
+  se::DeviceMemoryBase base = memory->Release();
+  absl::MutexLock lock(&mu_);
+  allocations_[{device_ordinal, base.opaque()}] = {memory_space, size};
+  return se::OwningDeviceMemory(base, device_ordinal, this);
+}
+
+tsl::Status RecyclingDeviceMemoryAllocator::Deallocate(
+    int device_ordinal, se::DeviceMemoryBase mem) {
+  if (mem.is_null()) {
+    return tsl::OkStatus();
+  }
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = allocations_.find({device_ordinal, mem.opaque()});
+    if (it != allocations_.end()) {
+      const auto [memory_space, size] = it->second;
+      allocations_.erase(it);
+      recycled_[Key(device_ordinal, memory_space, size)].push_back(
+          mem.opaque());
+      return tsl::OkStatus();
+    }
+  }
+  return allocator_->Deallocate(device_ordinal, mem);
+}
+
+bool RecyclingDeviceMemoryAllocator::AllowsAsynchronousDeallocation() const {
+  return allocator_->AllowsAsynchronousDeallocation();
+}
+
+tsl::StatusOr<se::Stream*> RecyclingDeviceMemoryAllocator::GetStream(
+    int device_ordinal) {
+  return allocator_->GetStream(device_ordinal);
+}
+
+tsl::Status RecyclingDeviceMemoryAllocator::ReleaseRecycledMemory(
+    int device_ordinal) {
+  std::vector<se::DeviceMemoryBase> to_release;
+  {
+    absl::MutexLock lock(&mu_);
+    for (auto it = recycled_.begin(); it != recycled_.end();) {
+      const auto& [ordinal, memory_space, size] = it->first;
+      if (ordinal != device_ordinal) {
+        ++it;
+        continue;
+      }
+      for (void* opaque : it->second) {
+        to_release.push_back(se::DeviceMemoryBase(opaque, size));
+      }
+      recycled_.erase(it++);
+    }
+  }
+  for (const se::DeviceMemoryBase& mem : to_release) {
+    TF_RETURN_IF_ERROR(allocator_->Deallocate(device_ordinal, mem));
+  }
+  return tsl::OkStatus();
+}
+
+int64_t RecyclingDeviceMemoryAllocator::recycled_bytes(
+    int device_ordinal) const {
+  absl::MutexLock lock(&mu_);
+  int64_t bytes = 0;
+  for (const auto& [key, memory] : recycled_) {
+    if (std::get<0>(key) == device_ordinal) {
+      bytes += std::get<2>(key) * memory.size();
+    }
+  }
+  return bytes;
+}
+
+}  // namespace xla
@@ -0,0 +1,92 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_PJRT_RECYCLING_DEVICE_MEMORY_ALLOCATOR_H_
+#define TENSORFLOW_COMPILER_XLA_PJRT_RECYCLING_DEVICE_MEMORY_ALLOCATOR_H_
+
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/compiler/xla/stream_executor/device_memory.h"
+#include "tensorflow/compiler/xla/stream_executor/device_memory_allocator.h"
+#include "tensorflow/compiler/xla/types.h"
+
+namespace xla {
+
+// A device memory allocator that keeps the memory deallocated through it, and
+// hands it back out to later allocations of the same device, memory space and
+// size instead of going to the underlying allocator.
+//
+// This suits executables that are run over and over with arguments of the
+// same shapes: once the outputs of a run are deleted, the next run allocates
+// its outputs from the recycled memory. Memory is handed out again under the
+// same ordering guarantees as the underlying allocator would reuse it, since
+// it is only recycled once it would have been deallocated.
+//
+// Memory that was not allocated through this allocator is deallocated
+// directly by the underlying allocator. The recycled memory is released when
+// an allocation fails, after which the allocation is retried, and when the
+// allocator is destroyed.
+class RecyclingDeviceMemoryAllocator : public se::DeviceMemoryAllocator {
+ public:
+  // `allocator` must outlive this allocator.
+  explicit RecyclingDeviceMemoryAllocator(se::DeviceMemoryAllocator* allocator);
+  ~RecyclingDeviceMemoryAllocator() override;
+
+  tsl::StatusOr<se::OwningDeviceMemory> Allocate(int device_ordinal,
+                                                 uint64_t size,
+                                                 bool retry_on_failure,
+                                                 int64_t memory_space) override;
+
+  // Pull in two-arg overload that sets retry_on_failure to true.
+  using se::DeviceMemoryAllocator::Allocate;
+
+  tsl::Status Deallocate(int device_ordinal, se::DeviceMemoryBase mem) override;
+
+  bool AllowsAsynchronousDeallocation() const override;
+
+  tsl::StatusOr<se::Stream*> GetStream(int device_ordinal) override;
+
+  // Returns the recycled memory of `device_ordinal` to the underlying
+  // allocator.
+  tsl::Status ReleaseRecycledMemory(int device_ordinal);
+
+  // Returns the number of bytes of recycled memory held for `device_ordinal`.
+  int64_t recycled_bytes(int device_ordinal) const;
+
+ private:
+  // Device ordinal, memory space and size of an allocation.
+  using Key = std::tuple<int, int64_t, uint64_t>;
+
+  se::DeviceMemoryAllocator* const allocator_;
+
+  mutable absl::Mutex mu_;
+  // Memory space and size of every live allocation made through this
+  // allocator, by device ordinal and address.
+  absl::flat_hash_map<std::pair<int, const void*>,
+                      std::pair<int64_t, uint64_t>>
+      allocations_ ABSL_GUARDED_BY(mu_);
+  // Recycled memory by device ordinal, memory space and size.
+  absl::flat_hash_map<Key, std::vector<void*>> recycled_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_PJRT_RECYCLING_DEVICE_MEMORY_ALLOCATOR_H_
@@ -0,0 +1,138 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/recycling_device_memory_allocator.h"
+
+#include <cstdint>
+
+#include "tensorflow/compiler/xla/service/platform_util.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/statusor.h"
+
+namespace xla {
+namespace {
+
+// Allocates host memory and counts the calls it gets. Allocations larger than
+// `limit` bytes in total fail.
+class CountingAllocator : public se::DeviceMemoryAllocator {
+ public:
+  explicit CountingAllocator(const se::Platform* platform, int64_t limit)
+      : se::DeviceMemoryAllocator(platform), limit_(limit) {}
+
+  tsl::StatusOr<se::OwningDeviceMemory> Allocate(
+      int device_ordinal, uint64_t size, bool retry_on_failure,
+      int64_t memory_space) override {
+    ++num_allocations_;
+    if (size == 0) {
+      return se::OwningDeviceMemory();
+    }
+    if (allocated_bytes_ + static_cast<int64_t>(size) > limit_) {
+      return ResourceExhausted("Out of memory allocating %d bytes", size);
+    }
+    allocated_bytes_ += size;
+    return se::OwningDeviceMemory(
+        se::DeviceMemoryBase(new char[size], size), device_ordinal, this);
+  }
+
+  tsl::Status Deallocate(int device_ordinal,
+                         se::DeviceMemoryBase mem) override {
+    if (!mem.is_null()) {
+      ++num_deallocations_;
+      allocated_bytes_ -= mem.size();
+      delete[] static_cast<char*>(mem.opaque());
+    }
+    return tsl::OkStatus();
+  }
+
+  tsl::StatusOr<se::Stream*> GetStream(int device_ordinal) override {
+    return Unimplemented("GetStream");
+  }
+
+  int num_allocations() const { return num_allocations_; }
+  int num_deallocations() const { return num_deallocations_; }
+  int64_t allocated_bytes() const { return allocated_bytes_; }
+
+ private:
+  const int64_t limit_;
+  int num_allocations_ = 0;
+  int num_deallocations_ = 0;
+  int64_t allocated_bytes_ = 0;
+};
+
+const se::Platform* HostPlatform() {
+  return PlatformUtil::GetPlatform("Host").value();
+}
+
+TEST(RecyclingDeviceMemoryAllocatorTest, RecyclesSameSizeAndMemorySpace) {
+  CountingAllocator base(HostPlatform(), /*limit=*/1 << 20);
+  RecyclingDeviceMemoryAllocator allocator(&base);
+
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory a, allocator.Allocate(0, 64));
+  const void* a_opaque = a->opaque();
+  a = se::OwningDeviceMemory();
+  EXPECT_EQ(base.num_deallocations(), 0);
+  EXPECT_EQ(allocator.recycled_bytes(0), 64);
+
+  // Allocations of another size, memory space or device get new memory.
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory b, allocator.Allocate(0, 32));
+  TF_ASSERT_OK_AND_ASSIGN(
+      se::OwningDeviceMemory c,
+      allocator.Allocate(0, 64, /*retry_on_failure=*/true, /*memory_space=*/1));
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory d, allocator.Allocate(1, 64));
+  EXPECT_EQ(base.num_allocations(), 4);
+
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory e, allocator.Allocate(0, 64));
+  EXPECT_EQ(e->opaque(), a_opaque);
+  EXPECT_EQ(base.num_allocations(), 4);
+  EXPECT_EQ(allocator.recycled_bytes(0), 0);
+}
+
+TEST(RecyclingDeviceMemoryAllocatorTest, ForwardsForeignMemory) {
+  CountingAllocator base(HostPlatform(), /*limit=*/1 << 20);
+  RecyclingDeviceMemoryAllocator allocator(&base);
+
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory a, base.Allocate(0, 64));
+  TF_ASSERT_OK(allocator.Deallocate(0, a.Release()));
+  EXPECT_EQ(base.num_deallocations(), 1);
+  EXPECT_EQ(allocator.recycled_bytes(0), 0);
+}
+
+TEST(RecyclingDeviceMemoryAllocatorTest, ReleasesRecycledMemoryOnFailure) {
+  CountingAllocator base(HostPlatform(), /*limit=*/100);
+  RecyclingDeviceMemoryAllocator allocator(&base);
+
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory a, allocator.Allocate(0, 64));
+  a = se::OwningDeviceMemory();
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory b, allocator.Allocate(0, 80));
+  EXPECT_EQ(base.num_deallocations(), 1);
+  EXPECT_EQ(base.allocated_bytes(), 80);
+  EXPECT_EQ(allocator.recycled_bytes(0), 0);
+}
+
+TEST(RecyclingDeviceMemoryAllocatorTest, ReleasesRecycledMemoryOnDestruction) {
+  CountingAllocator base(HostPlatform(), /*limit=*/1 << 20);
+  {
+    RecyclingDeviceMemoryAllocator allocator(&base);
+    TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory a,
+                            allocator.Allocate(0, 64));
+  }
+  EXPECT_EQ(base.num_deallocations(), 1);
+  EXPECT_EQ(base.allocated_bytes(), 0);
+}
+
+}  // namespace
+}  // namespace xla
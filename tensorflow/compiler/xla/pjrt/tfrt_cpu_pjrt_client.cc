@@ -641,18 +641,30 @@ StatusOr<std::unique_ptr<PjRtBuffer>> TfrtCpuClient::BufferFromHostBuffer(
       // into major-to-minor layout. Currently we choose to always do this
       // synchronously.
       // TODO(phawkins): consider performing the transpose asynchronously.
-      // TODO(phawkins): parallelize the transpose.
       std::shared_ptr<TransposePlan> transpose;
       {
         absl::InlinedVector<int64_t, 4> permutation(dims.size());
         absl::c_iota(permutation, 0);
         absl::MutexLock lock(&transpose_mu_);
         TF_ASSIGN_OR_RETURN(
-            transpose, transpose_cache_.GetOrCreate(
-                           primitive_util::ByteWidth(type), dims, permutation,
-                           TransposePlan::Striding{*byte_strides}));
+            transpose,
+            transpose_cache_.GetOrCreate(
+                primitive_util::ByteWidth(type), dims, permutation,
+                TransposePlan::Striding{*byte_strides},
+                /*output_tiling=*/TransposePlan::Tiling{},
+                TransposePlan::Transformation::kNone,
+                /*num_threads=*/pjrt_client_thread_pool()->NumThreads()));
       }
-      transpose->Execute(data, dst_data_ptr);
+      // The transpose is split across the thread pool, unless the caller is a
+      // thread of the pool which would then wait for work queued behind it.
+      std::function<void(std::function<void()>)> schedule_work;
+      if (pjrt_client_thread_pool()->CurrentThreadId() < 0) {
+        schedule_work = [pool = pjrt_client_thread_pool()](
+                            std::function<void()> fn) {
+          pool->Schedule(std::move(fn));
+        };
+      }
+      transpose->Execute(data, dst_data_ptr, schedule_work);
       if (on_done_with_host_buffer) {
         on_done_with_host_buffer();
         on_done_with_host_buffer = nullptr;
@@ -1110,11 +1110,19 @@ void TransposePlan::Initialize() {
         break;
       case 2:
         min_inner_block_elems = 8;
+#ifdef EIGEN_VECTORIZE_AVX512
+        max_inner_block_elems = 16;
+#else
         max_inner_block_elems = 8;
+#endif
         break;
       case 4:
         min_inner_block_elems = 4;
+#ifdef EIGEN_VECTORIZE_AVX512
+        max_inner_block_elems = 16;
+#else
         max_inner_block_elems = 8;
+#endif
         break;
       case 8:
         min_inner_block_elems = 2;
@@ -341,6 +341,10 @@ std::vector<TransposeTestCase> GetTransposeTestCases() {
                         /*input_tiling=*/{2, 4}),
       TransposeTestCase(/*dims=*/{12, 7}, /*permutation=*/{1, 0},
                         /*input_tiling=*/{}, /*output_tiling=*/{5, 2}),
+      // Large enough for 16x16 blocks, which AVX-512 builds use for 16- and
+      // 32-bit elements, along with partial blocks at the edges.
+      TransposeTestCase(/*dims=*/{100, 70}, /*permutation=*/{1, 0},
+                        /*input_tiling=*/{}, /*output_tiling=*/{}),
       TransposeTestCase(/*dims=*/{128, 224, 224, 3},
                         /*permutation=*/{3, 1, 2, 0},
                         /*input_tiling=*/{},
@@ -391,6 +395,7 @@ TEST_P(TransposeTest, TransposeInt64) { TestTranspose<int64_t>(1); }
 TEST_P(TransposeTest, TransposeInt128) { TestTranspose<absl::int128>(1); }
 
 TEST_P(TransposeTest, ParallelTransposeInt8) { TestTranspose<int8_t>(16); }
+TEST_P(TransposeTest, ParallelTransposeInt16) { TestTranspose<int16_t>(16); }
 TEST_P(TransposeTest, ParallelTransposeInt32) { TestTranspose<int32_t>(16); }
 
 INSTANTIATE_TEST_SUITE_P(TransposeTestInstance, TransposeTest,
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/all_reduce_combiner.h"
 
 #include <algorithm>
+#include <functional>
 #include <list>
 #include <memory>
 #include <optional>
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/all_reduce_key.h"
 #include "tensorflow/compiler/xla/service/collective_combiner_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_domain_map.h"
 #include "tensorflow/compiler/xla/service/hlo_query.h"
 #include "tensorflow/compiler/xla/service/hlo_sharding_util.h"
@@ -108,6 +110,14 @@ AllReduceCombiner::AllReduceCombiner(int64_t combine_threshold_in_bytes,
     : combine_threshold_in_bytes_(combine_threshold_in_bytes),
       combine_threshold_count_(combine_threshold_count) {}
 
+AllReduceCombiner::AllReduceCombiner(
+    int64_t combine_threshold_in_bytes, int64_t combine_threshold_count,
+    HloCostAnalysis::Options cost_analysis_options, double max_delay_seconds)
+    : combine_threshold_in_bytes_(combine_threshold_in_bytes),
+      combine_threshold_count_(combine_threshold_count),
+      cost_analysis_options_(std::move(cost_analysis_options)),
+      max_delay_seconds_(max_delay_seconds) {}
+
 StatusOr<bool> AllReduceCombiner::Run(
     HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
@@ -139,11 +149,38 @@ StatusOr<bool> AllReduceCombiner::Run(
       return GetAllReduceKey(instruction, domain_map.get());
     };
 
+    // Time at which each instruction finishes, if the computation runs one
+    // instruction at a time in post order.
+    absl::flat_hash_map<const HloInstruction*, double> ready_times;
+    std::function<bool(absl::Span<HloInstruction* const>,
+                       const HloInstruction*)>
+        can_combine_fn;
+    if (cost_analysis_options_.has_value()) {
+      HloCostAnalysis cost_analysis(*cost_analysis_options_);
+      TF_RETURN_IF_ERROR(computation->Accept(&cost_analysis));
+      double time = 0;
+      for (const HloInstruction* instruction :
+           computation->MakeInstructionPostOrder()) {
+        time += cost_analysis.optimal_seconds(*instruction);
+        ready_times[instruction] = time;
+      }
+      can_combine_fn = [&](absl::Span<HloInstruction* const> to_combine,
+                           const HloInstruction* instruction) {
+        auto first = ready_times.find(to_combine.front()->operand(0));
+        auto next = ready_times.find(instruction->operand(0));
+        if (first == ready_times.end() || next == ready_times.end()) {
+          return true;
+        }
+        return next->second - first->second <= max_delay_seconds_;
+      };
+    }
+
     TF_ASSIGN_OR_RETURN(
         bool computation_changed,
         CombineInstructionsByKey<AllReduceKey>(
             computation, key_fn, &CombineAllReduces,
-            combine_threshold_in_bytes_, combine_threshold_count_));
+            combine_threshold_in_bytes_, combine_threshold_count_,
+            std::move(can_combine_fn)));
     changed |= computation_changed;
   }
 
@@ -16,9 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_ALL_REDUCE_COMBINER_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_ALL_REDUCE_COMBINER_H_
 
+#include <optional>
+
 #include "absl/strings/string_view.h"
 #include "tensorflow/compiler/xla/array2d.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
@@ -34,6 +37,18 @@ class AllReduceCombiner : public HloModulePass {
   AllReduceCombiner(int64_t combine_threshold_in_bytes,
                     int64_t combine_threshold_count);
 
+  // Like above, but an all-reduce is only combined with all-reduces whose
+  // operands are estimated to be ready at most `max_delay_seconds` after its
+  // own, so that e.g. the first gradients of a backward pass are not held
+  // back until the last ones are computed. Instructions are assumed to run
+  // one at a time in post order, each for the time estimated by an
+  // HloCostAnalysis with `cost_analysis_options`, which must set per-second
+  // rates.
+  AllReduceCombiner(int64_t combine_threshold_in_bytes,
+                    int64_t combine_threshold_count,
+                    HloCostAnalysis::Options cost_analysis_options,
+                    double max_delay_seconds);
+
   absl::string_view name() const override { return "all-reduce-combiner"; }
 
   using HloPassInterface::Run;
@@ -47,6 +62,12 @@ class AllReduceCombiner : public HloModulePass {
 
   // Combine all reduce ops up to this threshold (number of operands).
   int64_t combine_threshold_count_;
+
+  // Estimates when all-reduce operands are ready, if set.
+  std::optional<HloCostAnalysis::Options> cost_analysis_options_;
+
+  // Maximum difference between the ready times of combined all-reduces.
+  double max_delay_seconds_ = 0;
 };
 
 }  // namespace xla
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
 #include "tensorflow/compiler/xla/literal.h"
 #include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_matchers.h"
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
@@ -206,6 +207,30 @@ TEST_F(AllReduceCombinerTest, RespectThreshold) {
   }
 }
 
+// Tests that all reduces whose operands are ready far apart are not combined.
+TEST_F(AllReduceCombinerTest, RespectMaxDelay) {
+  auto module = CreateNewVerifiedModule();
+  HloComputation* sum = MakeReduction(HloOpcode::kAdd, module.get());
+
+  HloComputation::Builder b(TestName());
+  std::vector<HloInstruction*> inputs;
+  MakeCrossReplicaReductions({4, 4, 4, 4}, {sum, sum, sum, sum}, &inputs, &b);
+  module->AddEntryComputation(b.Build());
+
+  // Each constant, broadcast and all reduce chain accesses 4 + 4100 + 8192
+  // bytes, so at 1 MiB/s consecutive inputs are ready ~11.7ms apart.
+  HloCostAnalysis::Options options{
+      [](const Shape& shape) { return ShapeUtil::ByteSizeOf(shape, 8); }};
+  options.set_flops_per_second(1e12);
+  options.set_bytes_per_second(1024 * 1024);
+  AllReduceCombiner combine(1024 * 1024, kMaxCombineCount, options,
+                            /*max_delay_seconds=*/0.02);
+  ASSERT_EQ(AllReduceCount(*module), inputs.size());
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, combine.Run(module.get()));
+  EXPECT_EQ(AllReduceCount(*module), 2);
+  EXPECT_TRUE(changed);
+}
+
 // Tests that dependent all reduces are not combined.
 TEST_F(AllReduceCombinerTest, NoDependentCombination) {
   auto module = CreateNewVerifiedModule();
@@ -41,13 +41,17 @@ namespace xla {
 //
 // `key_fn` should return equal keys for two instructions that might be combined
 // together. Instructions will be combined until the threshold for output byte
-// size or instruction count is reached.
+// size or instruction count is reached, or until `can_combine_fn`, if set,
+// returns false for the next instruction and the ones selected so far.
 template <typename K>
 StatusOr<bool> CombineInstructionsByKey(
     HloComputation* computation,
     absl::FunctionRef<std::optional<K>(const HloInstruction*)> key_fn,
     absl::FunctionRef<Status(absl::Span<HloInstruction* const>)> combine_fn,
-    int64_t combine_threshold_bytes, int64_t combine_threshold_count) {
+    int64_t combine_threshold_bytes, int64_t combine_threshold_count,
+    std::function<bool(absl::Span<HloInstruction* const>,
+                       const HloInstruction*)>
+        can_combine_fn = nullptr) {
   // Cache keys for each instruction and build sets of instructions with the
   // same key that might be combined together.
   absl::flat_hash_map<HloInstruction*, K> keys;
@@ -129,6 +133,12 @@ StatusOr<bool> CombineInstructionsByKey(
         break;
       }
 
+      if (can_combine_fn && !to_combine.empty() &&
+          !can_combine_fn(to_combine, instruction)) {
+        VLOG(1) << "Instruction can't be combined with the current set.";
+        break;
+      }
+
       VLOG(1) << "Adding instruction to set.";
       to_combine.push_back(instruction);
       to_combine_bytes += instruction_bytes;
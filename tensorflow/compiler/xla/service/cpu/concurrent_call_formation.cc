@@ -0,0 +1,217 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/concurrent_call_formation.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/cpu/backend_config.pb.h"
+#include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
+#include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/dynamic_update_slice_util.h"
+
+namespace xla {
+namespace cpu {
+
+namespace {
+
+// Returns true if the lowering of 'instruction' runs on the intra-op thread
+// pool itself. Running such instructions concurrently would only make them
+// compete for the same threads.
+bool UsesIntraOpThreadPool(const HloInstruction& instruction,
+                           const TargetMachineFeatures& features) {
+  if (!instruction.GetModule()
+           ->config()
+           .debug_options()
+           .xla_cpu_multi_thread_eigen()) {
+    return false;
+  }
+  switch (instruction.opcode()) {
+    case HloOpcode::kDot:
+      return DotImplementationUsesIntraOpThreadPool(instruction, features);
+    case HloOpcode::kConvolution:
+      return PotentiallyImplementedAsEigenConvolution(instruction, features);
+    case HloOpcode::kFft:
+      return true;
+    case HloOpcode::kFusion:
+      return absl::c_any_of(
+          instruction.fused_instructions(),
+          [&](const HloInstruction* fused) {
+            return UsesIntraOpThreadPool(*fused, features);
+          });
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+bool ConcurrentCallFormation::IsCandidate(
+    const HloInstruction& instruction) const {
+  // The emitted code of these instructions only touches their operands and
+  // their own output buffer, so it is safe to run them on any thread.
+  // Instructions that call other computations (other than thread-local
+  // reducers and comparators) are excluded, as are in-place
+  // dynamic-update-slices, which write into their operand's buffer.
+  switch (instruction.opcode()) {
+    case HloOpcode::kConvolution:
+    case HloOpcode::kDot:
+    case HloOpcode::kFft:
+    case HloOpcode::kFusion:
+    case HloOpcode::kReduce:
+    case HloOpcode::kReduceWindow:
+    case HloOpcode::kSelectAndScatter:
+    case HloOpcode::kSort:
+      break;
+    default:
+      if (!instruction.IsElementwise()) {
+        return false;
+      }
+  }
+  if (instruction.HasSideEffect() ||
+      !instruction.control_predecessors().empty() ||
+      !instruction.control_successors().empty() ||
+      llvm_ir::MayBeImplementedAsInPlaceDynamicUpdateSlice(&instruction)) {
+    return false;
+  }
+  return !UsesIntraOpThreadPool(instruction, target_machine_features_);
+}
+
+void ConcurrentCallFormation::FormConcurrentCall(
+    HloModule* module, HloComputation* computation,
+    absl::Span<HloInstruction* const> members) {
+  const std::string group_name =
+      absl::StrCat("concurrent_group_", members.front()->name());
+
+  // Outline each member into its own call, so that each one is emitted as a
+  // separate function.
+  std::vector<HloInstruction*> calls;
+  calls.reserve(members.size() + 1);
+  for (HloInstruction* member : members) {
+    calls.push_back(module->OutlineExpressionFromComputation(
+        {member}, absl::StrCat("concurrent_", member->name()), computation));
+  }
+
+  // Route every use of the calls through a tuple, so that outlining the calls
+  // together with the tuple leaves a single value to return.
+  HloInstruction* tuple =
+      computation->AddInstruction(HloInstruction::CreateTuple(calls));
+  for (int64_t i = 0; i < calls.size(); ++i) {
+    HloInstruction* call = calls[i];
+    std::vector<HloInstruction*> users;
+    for (HloInstruction* user : call->users()) {
+      if (user != tuple) {
+        users.push_back(user);
+      }
+    }
+    HloInstruction* element = computation->AddInstruction(
+        HloInstruction::CreateGetTupleElement(call->shape(), tuple, i));
+    TF_CHECK_OK(call->ReplaceUsesWith(users, element));
+    if (computation->root_instruction() == call) {
+      computation->set_root_instruction(element);
+    }
+  }
+  calls.push_back(tuple);
+
+  HloInstruction* group =
+      module->OutlineExpressionFromComputation(calls, group_name, computation);
+  BackendConfig backend_config;
+  backend_config.set_concurrent_calls(true);
+  TF_CHECK_OK(group->set_backend_config(backend_config));
+
+  VLOG(2) << "Formed concurrent call " << group->name() << " with "
+          << members.size() << " calls";
+}
+
+StatusOr<bool> ConcurrentCallFormation::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  XLA_VLOG_LINES(2, "ConcurrentCallFormation ENTRY");
+  XLA_VLOG_LINES(3, module->ToString());
+  if (max_parallelism_ < 2) {
+    return false;
+  }
+
+  HloComputation* computation = module->entry_computation();
+  HloCostAnalysis cost_analysis(shape_size_function_);
+  Status status = computation->root_instruction()->Accept(&cost_analysis);
+  if (!status.ok()) {
+    // HloCostAnalysis does not support every instruction (e.g. some custom
+    // calls); without costs there is no way to tell what is worth running
+    // concurrently.
+    VLOG(1) << "Not forming concurrent calls: " << status;
+    return false;
+  }
+
+  // Bucket the candidates by their depth. Two instructions of the same depth
+  // can't depend on each other, since a dependency would make one of them
+  // strictly deeper than the other.
+  absl::flat_hash_map<const HloInstruction*, int64_t> depth;
+  std::map<int64_t, std::vector<HloInstruction*>> candidates_by_depth;
+  for (HloInstruction* instruction : computation->MakeInstructionPostOrder()) {
+    int64_t instruction_depth = 0;
+    for (const HloInstruction* operand : instruction->operands()) {
+      instruction_depth = std::max(instruction_depth, depth[operand] + 1);
+    }
+    for (const HloInstruction* predecessor :
+         instruction->control_predecessors()) {
+      instruction_depth = std::max(instruction_depth, depth[predecessor] + 1);
+    }
+    depth[instruction] = instruction_depth;
+
+    const int64_t cost =
+        std::max(static_cast<int64_t>(cost_analysis.flop_count(*instruction)),
+                 static_cast<int64_t>(cost_analysis.bytes_accessed(
+                     *instruction)));
+    if (cost >= min_cost_ && IsCandidate(*instruction)) {
+      candidates_by_depth[instruction_depth].push_back(instruction);
+    }
+  }
+
+  // Merging the members of a group keeps the depths computed above a valid
+  // topological order, so later groups can't form a cycle through earlier
+  // ones.
+  bool changed = false;
+  for (const auto& [unused_depth, candidates] : candidates_by_depth) {
+    for (int64_t begin = 0; begin + 1 < candidates.size();
+         begin += max_parallelism_) {
+      const int64_t size = std::min<int64_t>(max_parallelism_,
+                                             candidates.size() - begin);
+      if (size < 2) {
+        break;
+      }
+      FormConcurrentCall(
+          module, computation,
+          absl::MakeConstSpan(candidates).subspan(begin, size));
+      changed = true;
+    }
+  }
+
+  XLA_VLOG_LINES(2, "ConcurrentCallFormation EXIT");
+  XLA_VLOG_LINES(3, module->ToString());
+  return changed;
+}
+
+}  // namespace cpu
+}  // namespace xla
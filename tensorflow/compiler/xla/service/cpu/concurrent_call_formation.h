@@ -0,0 +1,98 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CONCURRENT_CALL_FORMATION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CONCURRENT_CALL_FORMATION_H_
+
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/service/cpu/target_machine_features.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace cpu {
+
+// ConcurrentCallFormation finds expensive instructions in the entry
+// computation that do not depend on each other and arranges for them to run
+// at the same time on the intra-op thread pool.
+//
+// Instructions are grouped by their depth in the dependency graph (the length
+// of the longest path to them from an instruction without operands), so the
+// members of a group are independent by construction. Each member of a group
+// is outlined into its own kCall, and the calls are in turn outlined into a
+// single kCall whose computation returns a tuple of them:
+//
+//   concurrent_group {
+//     p0 = parameter(0) ...
+//     call.0 = call(...), to_apply=concurrent_fusion.0
+//     call.1 = call(...), to_apply=concurrent_fusion.1
+//     ROOT tuple = tuple(call.0, call.1)
+//   }
+//
+// The outer kCall is marked with BackendConfig::concurrent_calls, which makes
+// the IrEmitter dispatch the inner calls through a runtime fork/join call.
+//
+// Instructions that already run on the intra-op thread pool (Eigen dots,
+// convolutions and FFTs, and instructions split up by ParallelTaskAssigner)
+// are left alone, as are instructions with side effects or control
+// dependencies.
+class ConcurrentCallFormation : public HloModulePass {
+ public:
+  // Instructions whose cost (the larger of their flop count and the number of
+  // bytes they access) is below this are not worth dispatching to another
+  // thread.
+  static constexpr int64_t kDefaultMinCost = 1 << 16;
+
+  // 'max_parallelism': the maximum number of calls per group.
+  // 'shape_size': shape size function used by HloCostAnalysis.
+  // 'min_cost': the minimum cost of an instruction to be run concurrently.
+  ConcurrentCallFormation(const int64_t max_parallelism,
+                          const HloCostAnalysis::ShapeSizeFunction& shape_size,
+                          const TargetMachineFeatures* target_machine_features,
+                          const int64_t min_cost = kDefaultMinCost)
+      : max_parallelism_(max_parallelism),
+        min_cost_(min_cost),
+        shape_size_function_(shape_size),
+        target_machine_features_(*target_machine_features) {}
+  ~ConcurrentCallFormation() override {}
+
+  absl::string_view name() const override {
+    return "cpu-concurrent-call-formation";
+  }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  // Returns true if 'instruction' may run concurrently with other
+  // instructions, ignoring its cost.
+  bool IsCandidate(const HloInstruction& instruction) const;
+
+  // Outlines 'members' into a concurrent call in 'computation'.
+  void FormConcurrentCall(HloModule* module, HloComputation* computation,
+                          absl::Span<HloInstruction* const> members);
+
+  int64_t max_parallelism_;
+  int64_t min_cost_;
+  HloCostAnalysis::ShapeSizeFunction shape_size_function_;
+  const TargetMachineFeatures& target_machine_features_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CONCURRENT_CALL_FORMATION_H_
@@ -0,0 +1,164 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/concurrent_call_formation.h"
+
+#include "tensorflow/compiler/xla/service/cpu/backend_config.pb.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
+#include "tensorflow/compiler/xla/service/cpu/target_machine_features_fake.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+
+namespace xla {
+namespace {
+
+class ConcurrentCallFormationTest : public HloTestBase {
+ protected:
+  const HloCostAnalysis::ShapeSizeFunction shape_size_func_ =
+      cpu::CpuExecutable::ShapeSizeBytes;
+
+  const int max_parallelism_ = 4;
+
+  cpu::TargetMachineFeaturesWithFakeAlignmentLogic target_machine_features_;
+
+  ConcurrentCallFormationTest()
+      : HloTestBase(), target_machine_features_([](int64_t shape_size) {
+          return cpu::TargetMachineFeatures::kEigenExpectedTensorAlignment;
+        }) {}
+
+  StatusOr<bool> RunConcurrentCallFormation(HloModule* module) {
+    return cpu::ConcurrentCallFormation(max_parallelism_, shape_size_func_,
+                                        &target_machine_features_)
+        .Run(module);
+  }
+
+  // Returns the concurrent calls in the entry computation of 'module'.
+  std::vector<const HloInstruction*> ConcurrentCalls(const HloModule& module) {
+    std::vector<const HloInstruction*> calls;
+    for (const HloInstruction* instruction :
+         module.entry_computation()->instructions()) {
+      if (instruction->opcode() != HloOpcode::kCall) {
+        continue;
+      }
+      auto backend_config = instruction->backend_config<cpu::BackendConfig>();
+      if (backend_config.ok() && backend_config->concurrent_calls()) {
+        calls.push_back(instruction);
+      }
+    }
+    return calls;
+  }
+};
+
+TEST_F(ConcurrentCallFormationTest, IndependentReducesRunConcurrently) {
+  const std::string hlo_string = R"(
+    HloModule TestConcurrentCalls_Independent
+    add {
+      lhs = f32[] parameter(0)
+      rhs = f32[] parameter(1)
+      ROOT add = f32[] add(lhs, rhs)
+    }
+    ENTRY Independent {
+      p0 = f32[512,512]{1,0} parameter(0)
+      p1 = f32[512,512]{1,0} parameter(1)
+      zero = f32[] constant(0)
+      reduce.0 = f32[512]{0} reduce(p0, zero), dimensions={1}, to_apply=add
+      reduce.1 = f32[512]{0} reduce(p1, zero), dimensions={1}, to_apply=add
+      ROOT tuple = (f32[512]{0}, f32[512]{0}) tuple(reduce.0, reduce.1)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunConcurrentCallFormation(m.get()));
+  EXPECT_TRUE(changed);
+
+  std::vector<const HloInstruction*> calls = ConcurrentCalls(*m);
+  ASSERT_EQ(calls.size(), 1);
+  const HloInstruction* root = calls[0]->to_apply()->root_instruction();
+  ASSERT_EQ(root->opcode(), HloOpcode::kTuple);
+  ASSERT_EQ(root->operand_count(), 2);
+  for (const HloInstruction* branch : root->operands()) {
+    ASSERT_EQ(branch->opcode(), HloOpcode::kCall);
+    EXPECT_EQ(branch->to_apply()->root_instruction()->opcode(),
+              HloOpcode::kReduce);
+  }
+}
+
+TEST_F(ConcurrentCallFormationTest, DependentReducesRunSequentially) {
+  const std::string hlo_string = R"(
+    HloModule TestConcurrentCalls_Dependent
+    add {
+      lhs = f32[] parameter(0)
+      rhs = f32[] parameter(1)
+      ROOT add = f32[] add(lhs, rhs)
+    }
+    ENTRY Dependent {
+      p0 = f32[512,512,4]{2,1,0} parameter(0)
+      zero = f32[] constant(0)
+      reduce.0 = f32[512,512]{1,0} reduce(p0, zero), dimensions={2},
+        to_apply=add
+      ROOT reduce.1 = f32[512]{0} reduce(reduce.0, zero), dimensions={1},
+        to_apply=add
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunConcurrentCallFormation(m.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(ConcurrentCallFormationTest, CheapInstructionsRunSequentially) {
+  const std::string hlo_string = R"(
+    HloModule TestConcurrentCalls_Cheap
+    ENTRY Cheap {
+      p0 = f32[16]{0} parameter(0)
+      p1 = f32[16]{0} parameter(1)
+      exp = f32[16]{0} exponential(p0)
+      log = f32[16]{0} log(p1)
+      ROOT tuple = (f32[16]{0}, f32[16]{0}) tuple(exp, log)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunConcurrentCallFormation(m.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(ConcurrentCallFormationTest, RootIsRoutedThroughConcurrentCall) {
+  const std::string hlo_string = R"(
+    HloModule TestConcurrentCalls_Root
+    ENTRY Root {
+      p0 = f32[512,512]{1,0} parameter(0)
+      p1 = f32[512,512]{1,0} parameter(1)
+      exp = f32[512,512]{1,0} exponential(p0)
+      ROOT log = f32[512,512]{1,0} log(p1)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunConcurrentCallFormation(m.get()));
+  EXPECT_TRUE(changed);
+  ASSERT_EQ(ConcurrentCalls(*m).size(), 1);
+  const HloInstruction* root = m->entry_computation()->root_instruction();
+  ASSERT_EQ(root->opcode(), HloOpcode::kGetTupleElement);
+  EXPECT_EQ(root->operand(0), ConcurrentCalls(*m)[0]);
+}
+
+}  // namespace
+}  // namespace xla
@@ -110,6 +110,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/copy_insertion.h"
 #include "tensorflow/compiler/xla/service/cpu/buffer_info_util.h"
 #include "tensorflow/compiler/xla/service/cpu/compiler_functor.h"
+#include "tensorflow/compiler/xla/service/cpu/concurrent_call_formation.h"
 #include "tensorflow/compiler/xla/service/cpu/conv_canonicalization.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_instruction_fusion.h"
@@ -789,6 +790,10 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
     // TODO(b/29630486) Support multi-threaded AOT.
     pipeline.AddPass<ParallelTaskAssigner>(
         max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
+    if (module->config().debug_options().xla_cpu_enable_concurrent_calls()) {
+      pipeline.AddPass<ConcurrentCallFormation>(
+          max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
+    }
   }
   // Copy insertion should be performed immediately before IR emission to
   // avoid inserting unnecessary copies (later pass adds an instruction which
@@ -103,6 +103,11 @@ enum class DotImplementationStrategy {
   // and the output have to be row major.
   kTiledLlvmIrGemm,
 
+  // Like kTiledLlvmIrGemm, but for a Matrix*Matrix operation with few rows in
+  // the LHS, such as the dots of small batch inference.  All the rows are
+  // computed at once in registers, so the RHS is streamed through only once.
+  kTiledLlvmIrSkinnyGemm,
+
   // The dot operation is lowered into linalg.matmul op and lowered to LLVM IR.
   kLinalgMatmul,
 
@@ -188,8 +193,10 @@ class DotOpEmitter {
   // Lowers the dot operation as a tiled Matrix*Vector loop.
   void EmitTiledLlvmIrGemv();
 
-  // Lowers the dot operation as a tiled Matrix*Matrix loop.
-  void EmitTiledLlvmIrGemm();
+  // Lowers the dot operation as a Matrix*Matrix loop tiled by `tile_size`, as
+  // returned by GetGemmTileSize or GetSkinnyGemmTileSize.
+  void EmitTiledLlvmIrGemm(
+      const std::tuple<int64_t, int64_t, int64_t>& tile_size);
 
   // Lowers the dot operation through MLIR's linalg.matmul.
   Status EmitLinalgMatmul();
@@ -217,6 +224,27 @@ class DotOpEmitter {
         .value_or(kDefaultTileSize);
   }
 
+  // Returns the tile size for a GEMM with `m` rows in the LHS that keeps a
+  // tile of the result of all the rows, as wide as possible, in registers.
+  std::tuple<int64_t, int64_t, int64_t> GetSkinnyGemmTileSize(int64_t m) const {
+    if (auto tile_size = options::LlvmIrGemmTileSize(hlo_module_config_)) {
+      return *tile_size;
+    }
+    // Registers left for the tiles of the RHS and the broadcasts of the LHS.
+    constexpr int64_t kNumNonAccumulatorRegisters = 4;
+    constexpr int64_t kTileSizeK = 4;
+    const int64_t num_accumulators =
+        target_machine_features_.vector_register_count(
+            *b_->GetInsertBlock()->getParent()) -
+        kNumNonAccumulatorRegisters;
+    for (int64_t num_vectors = 3; num_vectors >= 1; --num_vectors) {
+      if (m * num_vectors <= num_accumulators) {
+        return {m, kTileSizeK, num_vectors};
+      }
+    }
+    return {std::max<int64_t>(num_accumulators, 1), kTileSizeK, 1};
+  }
+
   std::array<int64_t, 3> GetMlirGemmTileSize() const {
     // Tile by 4 x registers x register size. This was picked by running
     // small matmuls on Haswell and Skylake. There's a lot of room for
@@ -376,7 +404,8 @@ Status DotOpEmitter::EmitLinalgMatmul() {
       });
 }
 
-void DotOpEmitter::EmitTiledLlvmIrGemm() {
+void DotOpEmitter::EmitTiledLlvmIrGemm(
+    const std::tuple<int64_t, int64_t, int64_t>& tile_size) {
   PrimitiveType primitive_type = dot_info_.result_shape.element_type();
   MatMultDims mat_mult_dims = GetMatMultDims();
 
@@ -402,8 +431,7 @@ void DotOpEmitter::EmitTiledLlvmIrGemm() {
           *b_->GetInsertBlock()->getParent(), primitive_type);
 
   int64_t tile_size_m, tile_size_k, tile_size_n_in_vector_width;
-  std::tie(tile_size_m, tile_size_k, tile_size_n_in_vector_width) =
-      GetGemmTileSize();
+  std::tie(tile_size_m, tile_size_k, tile_size_n_in_vector_width) = tile_size;
 
   EmitSmallGemm(
       /*scalar_type=*/primitive_type,
@@ -573,7 +601,11 @@ Status DotOpEmitter::Emit() {
       return OkStatus();
 
     case DotImplementationStrategy::kTiledLlvmIrGemm:
-      EmitTiledLlvmIrGemm();
+      EmitTiledLlvmIrGemm(GetGemmTileSize());
+      return OkStatus();
+
+    case DotImplementationStrategy::kTiledLlvmIrSkinnyGemm:
+      EmitTiledLlvmIrGemm(GetSkinnyGemmTileSize(GetMatMultDims().m));
       return OkStatus();
 
     case DotImplementationStrategy::kLinalgMatmul:
@@ -1193,6 +1225,42 @@ bool CanEmitTiledLlvmIrGemm(
   return true;
 }
 
+// Returns whether the GEMM `dot_info` has few enough rows in the LHS for the
+// result of all of them to be computed at once in registers, and a small
+// enough RHS for a single thread to be faster than Eigen.
+bool CanEmitTiledLlvmIrSkinnyGemm(
+    const HloModuleConfig& config, const DotInfo& dot_info,
+    const TargetMachineFeatures& target_machine_features) {
+  CHECK(IsAlignedGemm(dot_info, target_machine_features));
+
+  if (options::SkinnyLlvmIrGemmDisabled(config)) {
+    return false;
+  }
+
+  // Up to 16 rows fit with at least one vector per row in the 32 registers of
+  // AVX-512, which covers the batch sizes of latency-sensitive inference.
+  constexpr int64_t kMaxSkinnyGemmM = 16;
+  // Elements of an RHS that is still cheap enough to stream through once.
+  constexpr int64_t kMaxSkinnyGemmRhsElements = 1 << 18;
+
+  int64_t m = dot_info.result_shape.dimensions(0);
+  int64_t k = dot_info.lhs_shape.dimensions(
+      dot_info.dim_nums.lhs_contracting_dimensions(0));
+  int64_t n = dot_info.result_shape.dimensions(1);
+  if (m > kMaxSkinnyGemmM || k * n > kMaxSkinnyGemmRhsElements) {
+    return false;
+  }
+
+  bool lhs_canonical = dot_info.dim_nums.lhs_contracting_dimensions(0) == 1;
+  bool rhs_canonical = dot_info.dim_nums.rhs_contracting_dimensions(0) == 0;
+  if (!(lhs_canonical && rhs_canonical)) {
+    return false;
+  }
+
+  PrimitiveType element_type = dot_info.result_shape.element_type();
+  return element_type == F32 || element_type == F64 || element_type == S32;
+}
+
 DotImplementationStrategy GetDotImplementationStrategy(
     const HloModuleConfig& config, const DotInfo& dot_info,
     const TargetMachineFeatures& target_machine_features) {
@@ -1227,6 +1295,10 @@ DotImplementationStrategy GetDotImplementationStrategy(
     if (CanEmitTiledLlvmIrGemm(config, dot_info, target_machine_features)) {
       return DotImplementationStrategy::kTiledLlvmIrGemm;
     }
+    if (CanEmitTiledLlvmIrSkinnyGemm(config, dot_info,
+                                     target_machine_features)) {
+      return DotImplementationStrategy::kTiledLlvmIrSkinnyGemm;
+    }
     return DotImplementationStrategy::kEigen;
   }
 
@@ -1481,6 +1553,23 @@ bool DotImplementationCanHandleTranspose(
          impl_strategy == DotImplementationStrategy::kEigen;
 }
 
+bool DotImplementationUsesIntraOpThreadPool(
+    const HloInstruction& dot_instr,
+    const TargetMachineFeatures& target_machine_features) {
+  const HloModuleConfig& config = dot_instr.GetModule()->config();
+  if (!ShouldUseMultiThreadedEigen(config)) {
+    return false;
+  }
+  // Batch dots are emitted as a loop over inner dots, any of which may use
+  // Eigen.
+  if (dot_instr.dot_dimension_numbers().lhs_batch_dimensions_size() > 0) {
+    return true;
+  }
+  return GetDotImplementationStrategy(config, DotInfo(dot_instr),
+                                      target_machine_features) ==
+         DotImplementationStrategy::kEigen;
+}
+
 bool DotOperandsAndResultMustHaveRowMajorLayout(
     const HloInstruction& dot_instr,
     const TargetMachineFeatures& target_machine_features) {
@@ -1496,6 +1585,7 @@ bool DotOperandsAndResultMustHaveRowMajorLayout(
                                    DotInfo(dot_instr), target_machine_features);
 
   return impl_strategy == DotImplementationStrategy::kTiledLlvmIrGemm ||
+         impl_strategy == DotImplementationStrategy::kTiledLlvmIrSkinnyGemm ||
          impl_strategy == DotImplementationStrategy::kEigen;
 }
 
@@ -42,6 +42,12 @@ bool DotImplementationCanHandleTranspose(
     const HloInstruction& dot_instr,
     const TargetMachineFeatures& target_machine_features);
 
+// Returns true if our lowering strategy for `dot_instr` calls into Eigen
+// routines that run on the intra-op thread pool.
+bool DotImplementationUsesIntraOpThreadPool(
+    const HloInstruction& dot_instr,
+    const TargetMachineFeatures& target_machine_features);
+
 // Returns the index for an operand to `hlo` that should ideally be column
 // major.  Returns nullopt if there is no such operand or if `hlo` is not a dot
 // or a fusion containing a dot.
@@ -2265,6 +2265,8 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
     if (ComputationTransitivelyContainsCustomCall(computation)) {
       EmitEarlyReturnIfErrorStatus();
     }
+  } else if (IsConcurrentCall(*call)) {
+    TF_RETURN_IF_ERROR(EmitConcurrentCall(call));
   } else {
     EmitGlobalCall(*computation, computation->name());
   }
@@ -2272,6 +2274,69 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
   return OkStatus();
 }
 
+bool IrEmitter::IsConcurrentCall(const HloInstruction& call) const {
+  auto backend_config_or = call.backend_config<BackendConfig>();
+  if (!backend_config_or.ok() || !backend_config_or->concurrent_calls()) {
+    return false;
+  }
+  // Passes that run after concurrent calls were formed may have changed the
+  // computation; fall back to running it sequentially in that case.
+  const HloComputation* computation = call.to_apply();
+  const HloInstruction* root = computation->root_instruction();
+  if (root->opcode() != HloOpcode::kTuple) {
+    return false;
+  }
+  for (const HloInstruction* instruction : computation->instructions()) {
+    if (instruction != root &&
+        instruction->opcode() != HloOpcode::kParameter &&
+        (instruction->opcode() != HloOpcode::kCall ||
+         instruction->user_count() != 1 || instruction->users()[0] != root)) {
+      return false;
+    }
+  }
+  return absl::c_all_of(root->operands(), [](const HloInstruction* operand) {
+    return operand->opcode() == HloOpcode::kCall;
+  });
+}
+
+Status IrEmitter::EmitConcurrentCall(HloInstruction* call) {
+  // The LLVM function emitted for `call->to_apply()` would run the calls one
+  // after the other. Instead, dispatch the functions of the calls themselves
+  // and write the tuple the computation returns here.
+  const HloInstruction* root = call->to_apply()->root_instruction();
+  std::vector<llvm::Function*> functions;
+  std::vector<llvm::Value*> results;
+  bool contains_custom_call = false;
+  for (const HloInstruction* branch : root->operands()) {
+    HloComputation* branch_computation = branch->to_apply();
+    functions.push_back(FindOrDie(
+        emitted_functions_,
+        ComputationToEmit{branch_computation, allow_reassociation_}));
+    TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice slice,
+                        assignment_.GetUniqueTopLevelSlice(branch));
+    results.push_back(EmitBufferPointer(slice, branch->shape()));
+    contains_custom_call |=
+        ComputationTransitivelyContainsCustomCall(branch_computation);
+  }
+
+  EmitCallToConcurrentCalls(
+      GetArrayFunctionCallArguments(
+          /*parameter_addresses=*/{}, &b_, call->name(),
+          /*return_value_buffer=*/
+          llvm::Constant::getNullValue(b_.getInt8PtrTy()),
+          /*exec_run_options_arg=*/GetExecutableRunOptionsArgument(),
+          /*buffer_table_arg=*/GetBufferTableArgument(),
+          /*status_arg=*/GetStatusArgument(),
+          /*profile_counters_arg=*/GetProfileCountersArgument()),
+      functions, &b_, call->name());
+  if (contains_custom_call) {
+    EmitEarlyReturnIfErrorStatus();
+  }
+
+  llvm_ir::EmitTuple(GetIrArrayFor(call), results, &b_);
+  return OkStatus();
+}
+
 Status IrEmitter::HandleSliceToDynamic(HloInstruction* hlo) {
   TF_RETURN_IF_ERROR(EmitTargetAddressForOp(hlo));
   std::vector<llvm::Value*> dynamic_dims;
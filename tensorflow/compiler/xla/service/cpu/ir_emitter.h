@@ -303,6 +303,14 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   // to explicitly pass parameters or return results.
   void EmitGlobalCall(const HloComputation& callee, absl::string_view name);
 
+  // Returns true if `call` was marked by ConcurrentCallFormation and its
+  // computation still has the form that EmitConcurrentCall expects.
+  bool IsConcurrentCall(const HloInstruction& call) const;
+
+  // Emits `call` such that the calls returned by its computation run
+  // concurrently.
+  Status EmitConcurrentCall(HloInstruction* call);
+
   // Returns the buffer to which a global call to `callee` would have written
   // its result.
   llvm::Value* GetBufferForGlobalCallReturnValue(const HloComputation& callee);
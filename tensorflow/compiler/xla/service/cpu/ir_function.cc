@@ -349,5 +349,57 @@ Status EmitCallToParallelForkJoin(
   return OkStatus();
 }
 
+void EmitCallToConcurrentCalls(const std::vector<llvm::Value*>& arguments,
+                               absl::Span<llvm::Function* const> functions,
+                               llvm::IRBuilder<>* b, const std::string& name) {
+  llvm::Module* module = b->GetInsertBlock()->getModule();
+  llvm::Type* i8_ptr_type = b->getInt8PtrTy();
+
+  // Build ConcurrentCalls function type.
+  std::vector<llvm::Type*> compute_function_params =
+      GetComputeFunctionParams(module, /*num_dynamic_loop_bounds=*/0);
+  // Number of compute functions.
+  compute_function_params.push_back(b->getInt32Ty());
+  // Array of compute function pointers.
+  compute_function_params.push_back(i8_ptr_type->getPointerTo());
+
+  llvm::FunctionType* concurrent_calls_type = llvm::FunctionType::get(
+      /*Result=*/llvm::Type::getVoidTy(module->getContext()),
+      /*Params=*/compute_function_params,
+      /*isVarArg=*/false);
+
+  llvm::Function* concurrent_calls_func = llvm::dyn_cast<llvm::Function>(
+      module
+          ->getOrInsertFunction(runtime::kConcurrentCallsSymbolName,
+                                concurrent_calls_type)
+          .getCallee());
+  concurrent_calls_func->setCallingConv(llvm::CallingConv::C);
+  concurrent_calls_func->setDoesNotThrow();
+
+  // Store the compute function pointers in a constant global array.
+  std::vector<llvm::Constant*> function_ptrs;
+  function_ptrs.reserve(functions.size());
+  for (llvm::Function* function : functions) {
+    function_ptrs.push_back(
+        llvm::ConstantExpr::getBitCast(function, i8_ptr_type));
+  }
+  llvm::ArrayType* functions_array_type =
+      llvm::ArrayType::get(i8_ptr_type, function_ptrs.size());
+  llvm::GlobalVariable* global_functions_array = new llvm::GlobalVariable(
+      /*M=*/*module,
+      /*Ty=*/functions_array_type,
+      /*isConstant=*/true,
+      /*Linkage=*/llvm::GlobalValue::PrivateLinkage,
+      /*Initializer=*/
+      llvm::ConstantArray::get(functions_array_type, function_ptrs),
+      /*Name=*/absl::StrCat(name, "_concurrent_functions"));
+
+  std::vector<llvm::Value*> concurrent_calls_arguments(arguments);
+  concurrent_calls_arguments.push_back(b->getInt32(functions.size()));
+  concurrent_calls_arguments.push_back(
+      b->CreateBitCast(global_functions_array, i8_ptr_type->getPointerTo()));
+  b->CreateCall(concurrent_calls_func, concurrent_calls_arguments);
+}
+
 }  // namespace cpu
 }  // namespace xla
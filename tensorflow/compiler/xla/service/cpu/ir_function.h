@@ -150,6 +150,12 @@ Status EmitCallToParallelForkJoin(
     absl::Span<const int64_t> dimension_partition_counts, llvm::IRBuilder<>* b,
     llvm::Function* parallel_function, const std::string& name);
 
+// Emits a call to a runtime function which runs all of 'functions'
+// concurrently (and joins threads before returning).
+void EmitCallToConcurrentCalls(const std::vector<llvm::Value*>& arguments,
+                               absl::Span<llvm::Function* const> functions,
+                               llvm::IRBuilder<>* b, const std::string& name);
+
 }  // namespace cpu
 }  // namespace xla
 
@@ -17,6 +17,13 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "absl/base/dynamic_annotations.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -29,6 +36,44 @@ limitations under the License.
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      void*, int64_t*, uint64_t*);
 
+// Signature of compute functions without dynamic loop bounds.
+using CallFunctionType = void (*)(void*, const void*, const void**, void**,
+                                  void*, uint64_t*);
+
+namespace {
+
+// Sets `status` to a failure joining the error messages in `statuses`, if any.
+void SetFailureIfAnyFailed(const std::vector<XlaCustomCallStatus>& statuses,
+                           absl::string_view label, void* status) {
+  // Collect all error messages (if any).
+  std::vector<std::pair<int32_t, absl::string_view>> error_messages;
+  for (int32_t i = 0; i < statuses.size(); ++i) {
+    std::optional<absl::string_view> msg =
+        xla::CustomCallStatusGetMessage(&statuses[i]);
+    if (msg) {
+      error_messages.emplace_back(i, *msg);
+    }
+  }
+
+  if (!error_messages.empty()) {
+    // Join all error messages into a single string to serve as the message for
+    // the returned status.
+    std::string error_message = absl::StrJoin(
+        error_messages, "\n",
+        [label](std::string* out, std::pair<int32_t, absl::string_view> p) {
+          int32_t idx = p.first;
+          absl::string_view msg = p.second;
+          absl::StrAppend(out,
+                          absl::StrFormat("%s %d error: %s", label, idx, msg));
+        });
+    XlaCustomCallStatusSetFailure(
+        reinterpret_cast<XlaCustomCallStatus*>(status), error_message.data(),
+        error_message.length());
+  }
+}
+
+}  // namespace
+
 // Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
 // Calls 'function_ptr' for first partition inline.
 // Uses blocking counter to synchronize threads after parallel calls complete.
@@ -102,30 +147,58 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   VLOG(3) << "ParallelForkJoin partition 0 done.";
   bc.Wait();
 
-  // Collect all error messages (if any).
-  std::vector<std::pair<int32_t, absl::string_view>> error_messages;
-  for (int32_t i = 0; i < num_partitions; ++i) {
-    std::optional<absl::string_view> msg =
-        xla::CustomCallStatusGetMessage(&statuses[i]);
-    if (msg) {
-      error_messages.emplace_back(i, *msg);
+  SetFailureIfAnyFailed(statuses, "Partition", status);
+  VLOG(2) << "ParallelForkJoin EXIT";
+}
+
+// Runs the 'num_functions' compute functions in 'function_ptrs' concurrently
+// and returns once all of them are done.
+//
+// The calling thread and up to 'numThreads() - 1' tasks on the intra-op thread
+// pool pull functions to run from a shared counter. Functions may themselves
+// block on tasks they enqueue on the intra-op thread pool (e.g. Eigen
+// contractions), so at least one thread of the pool is always left free to make
+// progress on those.
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ConcurrentCalls(
+    void* result_ptr, const void* run_options_ptr, const void** params,
+    void** buffer_table, void* status, uint64_t* prof_counters,
+    int32_t num_functions, void** function_ptrs) {
+  VLOG(2) << "ConcurrentCalls ENTRY num_functions: " << num_functions;
+  CHECK_GT(num_functions, 0);
+  CHECK_NE(function_ptrs, nullptr);
+  const xla::ExecutableRunOptions* run_options =
+      static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
+  CHECK_NE(run_options, nullptr);
+  const Eigen::ThreadPoolDevice* thread_pool =
+      run_options->intra_op_thread_pool();
+  CHECK_NE(thread_pool, nullptr);
+
+  std::vector<XlaCustomCallStatus> statuses(num_functions);
+  std::atomic<int32_t> next_function(0);
+  auto run_functions = [&]() {
+    for (int32_t i = next_function++; i < num_functions;
+         i = next_function++) {
+      CallFunctionType function =
+          reinterpret_cast<CallFunctionType>(function_ptrs[i]);
+      function(result_ptr, run_options_ptr, params, buffer_table,
+               &statuses[i], prof_counters);
+      VLOG(3) << "ConcurrentCalls function " << i << " done.";
     }
-  }
+  };
 
-  if (!error_messages.empty()) {
-    // Join all error messages into a single string to serve as the message for
-    // the returned status.
-    std::string error_message = absl::StrJoin(
-        error_messages, "\n",
-        [](std::string* out, std::pair<int32_t, absl::string_view> p) {
-          int32_t idx = p.first;
-          absl::string_view msg = p.second;
-          absl::StrAppend(out,
-                          absl::StrFormat("Partition %d error: %s", idx, msg));
-        });
-    XlaCustomCallStatusSetFailure(
-        reinterpret_cast<XlaCustomCallStatus*>(status), error_message.data(),
-        error_message.length());
+  const int32_t num_helpers =
+      std::max<int32_t>(0, std::min<int32_t>(num_functions - 1,
+                                             thread_pool->numThreads() - 1));
+  tsl::BlockingCounter bc(num_helpers);
+  for (int32_t i = 0; i < num_helpers; ++i) {
+    thread_pool->enqueueNoNotification([&run_functions, &bc]() {
+      run_functions();
+      bc.DecrementCount();
+    });
   }
-  VLOG(2) << "ParallelForkJoin EXIT";
+  run_functions();
+  bc.Wait();
+
+  SetFailureIfAnyFailed(statuses, "Function", status);
+  VLOG(2) << "ConcurrentCalls EXIT";
 }
@@ -93,6 +93,24 @@ TEST_P(CpuEigenDotOperationTest, DotTransposeOp) {
   CompileAndCheck(builder.Build(), spec.filecheck_lines);
 }
 
+// Dots with few rows in the LHS are emitted as tiled LLVM IR instead.
+TEST_F(CpuEigenDotOperationTest, SkinnyDotOp) {
+  HloComputation::Builder builder(TestName());
+
+  auto lhs_shape = ShapeUtil::MakeShape(F32, {8, 256});
+  auto rhs_shape = ShapeUtil::MakeShape(F32, {256, 1024});
+  auto result_shape = ShapeUtil::MakeShape(F32, {8, 1024});
+
+  HloInstruction* lhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, lhs_shape, "input"));
+  HloInstruction* rhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(1, rhs_shape, "input"));
+
+  builder.AddInstruction(CreateCanonicalDot(result_shape, lhs, rhs));
+  CompileAndCheck(builder.Build(),
+                  R"(CHECK-NOT: call void @__xla_cpu_runtime_EigenMatMulF32)");
+}
+
 std::vector<DotTestSpec> GetDotTestCases() {
   std::vector<DotTestSpec> result;
   // The fp16 test runs a 32-bit matmul because we promote fp16 gemms to fp32
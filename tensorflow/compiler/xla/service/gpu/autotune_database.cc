@@ -0,0 +1,171 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_database.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/compiler/xla/autotune_serialize.h"
+#include "tensorflow/compiler/xla/stream_executor/dnn.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/path.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// Merges `from` into `into`, keyed on (device, hlo). Returns whether `into`
+// changed.
+bool MergeEntries(
+    const tsl::protobuf::RepeatedPtrField<AutotuneResults::Entry>& from,
+    tsl::protobuf::RepeatedPtrField<AutotuneResults::Entry>* into) {
+  absl::flat_hash_map<std::pair<std::string, std::string>, int> index;
+  for (int i = 0; i < into->size(); ++i) {
+    const AutotuneResults::Entry& entry = into->Get(i);
+    index.emplace(std::make_pair(entry.device(), entry.hlo()), i);
+  }
+  bool changed = false;
+  for (const AutotuneResults::Entry& entry : from) {
+    auto it = index.find(std::make_pair(entry.device(), entry.hlo()));
+    if (it == index.end()) {
+      index.emplace(std::make_pair(entry.device(), entry.hlo()), into->size());
+      *into->Add() = entry;
+      changed = true;
+    } else if (into->Get(it->second).result().SerializeAsString() !=
+               entry.result().SerializeAsString()) {
+      *into->Mutable(it->second)->mutable_result() = entry.result();
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+std::string CuDnnVersionString(se::StreamExecutor* stream_exec) {
+  se::dnn::DnnSupport* dnn = stream_exec->AsDnn();
+  if (dnn == nullptr) return "none";
+  StatusOr<se::dnn::VersionInfo> version = dnn->GetVersion();
+  if (!version.ok()) return "unknown";
+  return absl::StrCat(version->major_version(), ".", version->minor_version(),
+                      ".", version->patch());
+}
+
+absl::Mutex loaded_paths_mu(absl::kConstInit);
+absl::flat_hash_set<std::string>& LoadedPaths()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(loaded_paths_mu) {
+  static auto* loaded_paths = new absl::flat_hash_set<std::string>();
+  return *loaded_paths;
+}
+
+}  // namespace
+
+StatusOr<std::string> GetAutotuneDatabasePath(
+    absl::string_view dir, se::StreamExecutor* stream_exec) {
+  std::string file_name = absl::StrCat(
+      "autotune_cuda_", stream_exec->GetDeviceDescription().runtime_version(),
+      "_cudnn_", CuDnnVersionString(stream_exec), ".pb");
+  // Keep the file name portable.
+  for (char& c : file_name) {
+    if (!absl::ascii_isalnum(c) && c != '.' && c != '_') c = '-';
+  }
+  return tsl::io::JoinPath(dir, file_name);
+}
+
+Status LoadAutotuneDatabase(absl::string_view dir,
+                            se::StreamExecutor* stream_exec) {
+  TF_ASSIGN_OR_RETURN(std::string path,
+                      GetAutotuneDatabasePath(dir, stream_exec));
+  absl::MutexLock lock(&loaded_paths_mu);
+  if (!LoadedPaths().insert(path).second) {
+    return OkStatus();
+  }
+
+  tsl::Env* env = tsl::Env::Default();
+  if (!env->FileExists(path).ok()) {
+    VLOG(1) << "No autotune database at " << path;
+    return OkStatus();
+  }
+  std::string data;
+  TF_RETURN_IF_ERROR(tsl::ReadFileToString(env, path, &data));
+  if (Status status = LoadAutotuneResults(data); !status.ok()) {
+    LOG(WARNING) << "Ignoring autotune database " << path << ": " << status;
+    return OkStatus();
+  }
+  VLOG(1) << "Loaded autotune database " << path;
+  return OkStatus();
+}
+
+Status MergeIntoAutotuneDatabase(absl::string_view dir,
+                                 se::StreamExecutor* stream_exec) {
+  TF_ASSIGN_OR_RETURN(std::string path,
+                      GetAutotuneDatabasePath(dir, stream_exec));
+  TF_ASSIGN_OR_RETURN(std::string serialized, SerializeAutotuneResults());
+  AutotuneResults results;
+  if (!results.ParseFromString(serialized)) {
+    return tsl::errors::Internal("Failed to parse autotune results.");
+  }
+
+  // Start from what other processes have written so far, unless the file is
+  // unreadable or was written by an incompatible version.
+  tsl::Env* env = tsl::Env::Default();
+  AutotuneResults database;
+  std::string data;
+  if (env->FileExists(path).ok() &&
+      tsl::ReadFileToString(env, path, &data).ok() &&
+      database.ParseFromString(data) &&
+      database.version() == results.version()) {
+    if (!MergeAutotuneResults(results, &database)) {
+      return OkStatus();
+    }
+  } else {
+    database = std::move(results);
+  }
+
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(std::string(dir)));
+  std::string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return tsl::errors::Internal("Unable to create a temporary file name for ",
+                                 path);
+  }
+  Status status =
+      tsl::WriteStringToFile(env, tmp_path, database.SerializeAsString());
+  if (status.ok()) {
+    status = env->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+    return status;
+  }
+  VLOG(1) << "Wrote " << database.dots_size() << " dot and "
+          << database.convs_size() << " conv results to autotune database "
+          << path;
+  return OkStatus();
+}
+
+bool MergeAutotuneResults(const AutotuneResults& from, AutotuneResults* into) {
+  bool changed = MergeEntries(from.dots(), into->mutable_dots());
+  changed |= MergeEntries(from.convs(), into->mutable_convs());
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,68 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_DATABASE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_DATABASE_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/autotune_results.pb.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
+
+namespace xla {
+namespace gpu {
+
+// An on-disk database of GEMM and convolution autotuning results that can be
+// shared by many processes, e.g. by placing it on a shared filesystem.
+//
+// The database is a directory with one file per CUDA runtime and cuDNN
+// version, since autotuning results are only meaningful for the library
+// versions they were measured with. Each file holds a serialized
+// AutotuneResults proto whose entries are keyed by the device model and the
+// canonical HLO of the dot/conv, which covers shapes, types and layouts.
+//
+// Loading a database only pre-populates the autotuning caches of
+// GemmAlgorithmPicker and GpuConvAlgorithmPicker: anything not covered is
+// autotuned as usual. Merging writes the in-process results back, keeping the
+// entries other processes have added in the meantime.
+
+// Returns the path of the database file in `dir` that applies to
+// `stream_exec`.
+StatusOr<std::string> GetAutotuneDatabasePath(absl::string_view dir,
+                                              se::StreamExecutor* stream_exec);
+
+// Loads the database file in `dir` that applies to `stream_exec` into the
+// autotuning caches, unless it has already been loaded by this process. A
+// missing or incompatible file is not an error.
+Status LoadAutotuneDatabase(absl::string_view dir,
+                            se::StreamExecutor* stream_exec);
+
+// Merges the autotuning results of this process into the database file in
+// `dir` that applies to `stream_exec`. The file is only rewritten if this adds
+// or changes entries, and it is replaced atomically so that concurrent readers
+// never observe a partially written file.
+Status MergeIntoAutotuneDatabase(absl::string_view dir,
+                                 se::StreamExecutor* stream_exec);
+
+// Adds the entries of `from` to `into`, replacing entries of `into` for the
+// same device and HLO. Returns whether `into` changed.
+bool MergeAutotuneResults(const AutotuneResults& from, AutotuneResults* into);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_DATABASE_H_
@@ -0,0 +1,70 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_database.h"
+
+#include <string>
+
+#include "tensorflow/compiler/xla/autotune_results.pb.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+AutotuneResults::Entry MakeEntry(const std::string& device,
+                                 const std::string& hlo, int64_t algorithm) {
+  AutotuneResults::Entry entry;
+  entry.set_device(device);
+  entry.set_hlo(hlo);
+  entry.mutable_result()->mutable_gemm()->set_algorithm(algorithm);
+  return entry;
+}
+
+TEST(AutotuneDatabaseTest, MergeAddsNewEntries) {
+  AutotuneResults from, into;
+  *into.add_dots() = MakeEntry("sm_80", "dot.1", 1);
+  *from.add_dots() = MakeEntry("sm_80", "dot.2", 2);
+  *from.add_dots() = MakeEntry("sm_70", "dot.1", 3);
+
+  EXPECT_TRUE(MergeAutotuneResults(from, &into));
+  EXPECT_EQ(into.dots_size(), 3);
+  EXPECT_EQ(into.convs_size(), 0);
+}
+
+TEST(AutotuneDatabaseTest, MergeReplacesChangedEntries) {
+  AutotuneResults from, into;
+  *into.add_convs() = MakeEntry("sm_80", "conv.1", 1);
+  *from.add_convs() = MakeEntry("sm_80", "conv.1", 4);
+
+  EXPECT_TRUE(MergeAutotuneResults(from, &into));
+  ASSERT_EQ(into.convs_size(), 1);
+  EXPECT_EQ(into.convs(0).result().gemm().algorithm(), 4);
+}
+
+TEST(AutotuneDatabaseTest, MergeOfKnownEntriesIsNoOp) {
+  AutotuneResults from, into;
+  *into.add_dots() = MakeEntry("sm_80", "dot.1", 1);
+  *into.add_convs() = MakeEntry("sm_80", "conv.1", 2);
+  *from.add_dots() = MakeEntry("sm_80", "dot.1", 1);
+
+  EXPECT_FALSE(MergeAutotuneResults(from, &into));
+  EXPECT_EQ(into.dots_size(), 1);
+  EXPECT_EQ(into.convs_size(), 1);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -174,23 +174,6 @@ Status FusionInstructionMerger::Run() {
   return OkStatus();
 }
 
-bool TransposesMostData(const HloInstruction& fusion) {
-  float score = 0;
-
-  for (const HloInstruction* instr : fusion.fused_instructions()) {
-    if (IsPhysicallyTransposing(*instr)) {
-      score += 1.0 * ShapeUtil::ElementsInRecursive(instr->shape()) /
-               ShapeUtil::ElementsInRecursive(fusion.shape());
-      if (score >= 0.5) {
-        VLOG(3) << fusion.ToString() << " transpose ratio exceeds " << score;
-        return true;
-      }
-    }
-  }
-
-  return false;
-}
-
 FusionDecision FusionInstructionMerger::ShouldFuse(HloInstruction* producer) {
   ++total_visited_;
 
@@ -107,6 +107,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_sanitize_constant_names.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_scatter_expander.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_shape_verifier.h"
+#include "tensorflow/compiler/xla/service/gpu/graph_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/hlo_fusion_stats.h"
 #include "tensorflow/compiler/xla/service/gpu/horizontal_input_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/horizontal_loop_fusion.h"
@@ -118,6 +119,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/metrics.h"
 #include "tensorflow/compiler/xla/service/gpu/move_copy_to_users.h"
 #include "tensorflow/compiler/xla/service/gpu/multi_output_fusion.h"
+#include "tensorflow/compiler/xla/service/gpu/priority_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/reduction_degenerate_dim_remover.h"
 #include "tensorflow/compiler/xla/service/gpu/reduction_dimension_grouper.h"
 #include "tensorflow/compiler/xla/service/gpu/reduction_layout_normalizer.h"
@@ -136,6 +138,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_dce.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
+#include "tensorflow/compiler/xla/service/hlo_rematerialization.h"
 #include "tensorflow/compiler/xla/service/hlo_verifier.h"
 #include "tensorflow/compiler/xla/service/layout_normalization.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
@@ -409,7 +412,8 @@ void AddHloVerifier(HloPassPipeline* pipeline, HloVerifierOpts&& opts = {},
 Status GpuCompiler::OptimizeHloModule(
     HloModule* hlo_module, se::StreamExecutor* stream_exec,
     se::DeviceMemoryAllocator* device_allocator,
-    const GpuTargetConfig& gpu_target_config) {
+    const GpuTargetConfig& gpu_target_config,
+    tsl::thread::ThreadPool* thread_pool) {
   const DebugOptions& debug_options = hlo_module->config().debug_options();
 
   AlgebraicSimplifierOptions layout_insensitive_algsimp_opts({},
@@ -461,7 +465,10 @@ Status GpuCompiler::OptimizeHloModule(
         /*is_spmd=*/true, /*propagate_metadata=*/false,
         hlo_module->config().allow_spmd_sharding_propagation_to_output());
     spmd_pipeline.AddPass<spmd::StatefulRngSpmdPartitioner>(
-        num_partitions, hlo_module->config().replica_count());
+        num_partitions, hlo_module->config().replica_count(),
+        hlo_module->config()
+            .debug_options()
+            .xla_gpu_threshold_for_windowed_einsum_mib());
     spmd_pipeline.AddPass<CollectivePermuteMotion>();
     TF_RETURN_IF_ERROR(spmd_pipeline.Run(hlo_module).status());
   } else {
@@ -474,6 +481,7 @@ Status GpuCompiler::OptimizeHloModule(
 
   {
     HloPassPipeline pipeline("optimization");
+    pipeline.set_thread_pool(thread_pool);
     AddHloVerifier(&pipeline);
     pipeline.AddPass<AllToAllDecomposer>();
 
@@ -714,7 +722,14 @@ Status GpuCompiler::OptimizeHloModule(
     fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/false);
     fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/true);
     const GpuDeviceInfo gpu_device_info = gpu_target_config.gpu_device_info;
-    fusion.AddPass<FusionMerger>(gpu_device_info, ShapeSizeBytesFunction());
+    if (hlo_module->config()
+            .debug_options()
+            .xla_gpu_enable_priority_fusion()) {
+      fusion.AddPass<GpuPriorityFusion>(gpu_device_info,
+                                        ShapeSizeBytesFunction());
+    } else {
+      fusion.AddPass<FusionMerger>(gpu_device_info, ShapeSizeBytesFunction());
+    }
     fusion.AddPass<GpuMultiOutputFusion>(gpu_device_info,
                                          ShapeSizeBytesFunction());
     fusion.AddPass<HloCSE>(/*is_layout_sensitive=*/true,
@@ -744,9 +759,26 @@ Status GpuCompiler::OptimizeHloModule(
     pipeline.AddPass<AllGatherCombiner>(
         /*combine_threshold_in_bytes=*/1024 * 1024 * 1024,
         /*combine_threshold_count=*/256);
-    pipeline.AddPass<AllReduceCombiner>(
-        debug_options.xla_gpu_all_reduce_combine_threshold_bytes(),
-        /*combine_threshold_count=*/256);
+    int64_t all_reduce_combine_max_delay_us =
+        debug_options.xla_gpu_all_reduce_combine_max_delay_us();
+    if (all_reduce_combine_max_delay_us > 0) {
+      // Estimate when the all-reduce operands are ready with the roofline
+      // rates of the device, as GpuPerformanceModel does.
+      const GpuDeviceInfo& gpu_device_info = gpu_target_config.gpu_device_info;
+      HloCostAnalysis::Options options{ShapeSizeBytesFunction()};
+      options.set_flops_per_second(2 * 1e9 * gpu_device_info.clock_rate_ghz *
+                                   gpu_device_info.core_count *
+                                   gpu_device_info.fpus_per_core);
+      options.set_bytes_per_second(gpu_device_info.memory_bandwidth);
+      pipeline.AddPass<AllReduceCombiner>(
+          debug_options.xla_gpu_all_reduce_combine_threshold_bytes(),
+          /*combine_threshold_count=*/256, options,
+          /*max_delay_seconds=*/all_reduce_combine_max_delay_us * 1e-6);
+    } else {
+      pipeline.AddPass<AllReduceCombiner>(
+          debug_options.xla_gpu_all_reduce_combine_threshold_bytes(),
+          /*combine_threshold_count=*/256);
+    }
     pipeline.AddPass<ReduceScatterCombiner>(
         /*combine_threshold_in_bytes=*/30 * 1024 * 1024,
         /*combine_threshold_count=*/256);
@@ -875,9 +907,12 @@ Status GpuCompiler::OptimizeHloPostLayoutAssignment(
     // in the softmax codegen pipeline. However we should run before
     // ReductionDimensionGrouper, as that makes matching the softmax pattern
     // harder.
-    if (hlo_module->config().debug_options().xla_gpu_enable_softmax_fusion()) {
+    if (debug_options.xla_gpu_enable_softmax_fusion() ||
+        debug_options.xla_gpu_enable_row_normalization_emitter()) {
       pipeline.AddPass<HloPassFix<AlgebraicSimplifier>>(options);
-      pipeline.AddPass<SoftmaxFusion>();
+      pipeline.AddPass<SoftmaxFusion>(
+          /*match_normalizations=*/
+          debug_options.xla_gpu_enable_row_normalization_emitter());
     }
 
     pipeline.AddPass<ReductionDimensionGrouper>();
@@ -989,8 +1024,9 @@ StatusOr<std::unique_ptr<HloModule>> GpuCompiler::RunHloPasses(
       tsl::profiler::TraceMeLevel::kInfo);
 
   GpuTargetConfig gpu_target_config = GetGpuTargetConfig(stream_exec);
-  TF_RETURN_IF_ERROR(OptimizeHloModule(
-      module.get(), stream_exec, options.device_allocator, gpu_target_config));
+  TF_RETURN_IF_ERROR(OptimizeHloModule(module.get(), stream_exec,
+                                       options.device_allocator,
+                                       gpu_target_config, options.thread_pool));
 
   TF_RETURN_IF_ERROR(PrepareHloModuleForIrEmitting(module.get()));
 
@@ -1013,8 +1049,9 @@ StatusOr<std::unique_ptr<HloModule>> GpuCompiler::RunHloPassesWithoutDevice(
   tsl::profiler::TraceMe activity(
       [&] { return absl::StrCat("HLO Transforms:", module->name()); },
       tsl::profiler::TraceMeLevel::kInfo);
-  TF_RETURN_IF_ERROR(OptimizeHloModule(
-      module.get(), nullptr, options.device_allocator, gpu_target_config));
+  TF_RETURN_IF_ERROR(OptimizeHloModule(module.get(), nullptr,
+                                       options.device_allocator,
+                                       gpu_target_config, options.thread_pool));
 
   TF_RETURN_IF_ERROR(PrepareHloModuleForIrEmitting(module.get()));
 
@@ -1033,11 +1070,70 @@ static std::optional<bool> DummyCanShareBufferFunction(const HloInstruction*,
   return std::nullopt;
 }
 
+StatusOr<bool> RematerializeToFitDeviceMemory(
+    HloModule* hlo_module, int pointer_size,
+    const GpuDeviceInfo& gpu_device_info) {
+  if (!hlo_module->config()
+           .debug_options()
+           .xla_gpu_enable_memory_budget_rematerialization() ||
+      gpu_device_info.device_memory_size <= 0) {
+    return false;
+  }
+  auto shape_size_function = [pointer_size](const Shape& shape) {
+    return GetSizeOfShape(shape, pointer_size);
+  };
+
+  // Recompute costs are only queried once some computation is found to
+  // exceed the limit, so the cost analysis is deferred until then. It covers
+  // every non-fusion computation, as rematerialization also applies to the
+  // bodies of while loops, conditionals and calls.
+  std::unique_ptr<GpuHloCostAnalysis> cost_analysis;
+  Status cost_analysis_status;
+  auto recompute_cost_function = [&](const HloInstruction* instruction) {
+    if (cost_analysis == nullptr) {
+      // Estimates run times with the roofline rates of the device, as
+      // GpuPerformanceModel does.
+      HloCostAnalysis::Options options{shape_size_function};
+      options.set_flops_per_second(2 * 1e9 * gpu_device_info.clock_rate_ghz *
+                                   gpu_device_info.core_count *
+                                   gpu_device_info.fpus_per_core);
+      options.set_bytes_per_second(gpu_device_info.memory_bandwidth);
+      cost_analysis = std::make_unique<GpuHloCostAnalysis>(options);
+      for (HloComputation* computation :
+           hlo_module->MakeNonfusionComputations()) {
+        cost_analysis_status.Update(computation->Accept(cost_analysis.get()));
+      }
+    }
+    return static_cast<double>(cost_analysis->optimal_seconds(*instruction));
+  };
+
+  HloRematerialization::RematerializationSizes sizes;
+  HloRematerialization rematerialization(
+      shape_size_function, gpu_device_info.device_memory_size, &sizes,
+      HloRematerialization::RematerializationPass::kPostFusion,
+      /*block_size_limit=*/1, /*block_rematerialization_factor=*/1,
+      /*compact_shape_function=*/nullptr,
+      HloRematerialization::RematerializationMode::kRecomputeOnly,
+      /*min_remat_size=*/0, recompute_cost_function);
+  TF_ASSIGN_OR_RETURN(bool changed, rematerialization.Run(hlo_module));
+  TF_RETURN_IF_ERROR(cost_analysis_status);
+  if (changed) {
+    VLOG(1) << "Rematerialized " << hlo_module->name()
+            << " to fit in device memory: peak memory reduced from "
+            << tsl::strings::HumanReadableNumBytes(sizes.before_bytes)
+            << " to " << tsl::strings::HumanReadableNumBytes(sizes.after_bytes);
+  }
+  return changed;
+}
+
 StatusOr<std::unique_ptr<BufferAssignment>> GpuCompiler::AssignBuffers(
     HloModule* hlo_module, se::StreamExecutor* stream_exec) {
   const GpuDeviceInfo gpu_device_info = GetGpuDeviceInfo(stream_exec);
   TF_RETURN_IF_ERROR(
       ScheduleGpuModule(hlo_module, pointer_size_, gpu_device_info));
+  TF_RETURN_IF_ERROR(RematerializeToFitDeviceMemory(hlo_module, pointer_size_,
+                                                    gpu_device_info)
+                         .status());
 
   auto buffer_size_bytes_function =
       [this](const BufferValue& buffer_value) -> int64_t {
@@ -1217,6 +1313,9 @@ static Status CompileModuleToLlvmIrImpl(
 
   TF_RETURN_IF_ERROR(
       ScheduleGpuModule(hlo_module, pointer_size, gpu_device_info));
+  TF_RETURN_IF_ERROR(RematerializeToFitDeviceMemory(hlo_module, pointer_size,
+                                                    gpu_device_info)
+                         .status());
 
   auto buffer_size_bytes_function =
       [pointer_size](const BufferValue& buffer_value) -> int64_t {
@@ -1355,6 +1454,11 @@ static Status CompileModuleToLlvmIrImpl(
   auto thunk_sequence = ir_emitter->ConsumeThunkSequence();
   ForAllThunks([](Thunk* thunk) { thunk->ClearCompileTimeInfo(); },
                thunk_sequence.get());
+  const DebugOptions& debug_options = hlo_module->config().debug_options();
+  if (debug_options.xla_gpu_enable_cuda_graphs()) {
+    CaptureThunksIntoGraphs(thunk_sequence.get(),
+                            debug_options.xla_gpu_cuda_graph_min_graph_size());
+  }
   results->executable = std::move(thunk_sequence);
   return OkStatus();
 }
@@ -183,10 +183,13 @@ class GpuCompiler : public LLVMCompiler {
 
  private:
   // Stream_executor is null during AOT compilation.
+  // `thread_pool` may be null; if not, computation passes run concurrently
+  // on it.
   Status OptimizeHloModule(HloModule* hlo_module,
                            se::StreamExecutor* stream_exec,
                            se::DeviceMemoryAllocator* device_allocator,
-                           const GpuTargetConfig& gpu_target_config);
+                           const GpuTargetConfig& gpu_target_config,
+                           tsl::thread::ThreadPool* thread_pool);
 
   virtual Status OptimizeHloConvolutionCanonicalization(
       HloModule* hlo_module, se::CudaComputeCapability cuda_compute_capability,
@@ -243,6 +246,16 @@ StatusOr<std::unique_ptr<llvm::Module>> CompileModuleToLlvmIr(
     se::CudaComputeCapability cuda_compute_capability,
     se::RocmComputeCapability rocm_compute_capability, int pointer_size);
 
+// Rematerializes the scheduled `hlo_module` if its peak memory exceeds the
+// memory of the device and --xla_gpu_enable_memory_budget_rematerialization
+// is set. Of the values that can be recomputed, the ones with the lowest
+// estimated run time per byte saved are recomputed first, so that models
+// which would otherwise run out of memory are slowed down the least. Returns
+// whether the module was changed.
+StatusOr<bool> RematerializeToFitDeviceMemory(
+    HloModule* hlo_module, int pointer_size,
+    const GpuDeviceInfo& gpu_device_info);
+
 // Compiles the given LMHLO module to an executable.
 // ir_emitter_context should be partially populated: buffer_assignment
 // or buffer_allocations should not be populated, while other fields should be
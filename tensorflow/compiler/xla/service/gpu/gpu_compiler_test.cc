@@ -15,6 +15,8 @@ limitations under the License.
 
 #include <memory>
 
+#include "tensorflow/compiler/xla/service/gpu/gpu_compiler.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info_for_tests.h"
 #include "tensorflow/compiler/xla/service/gpu/horizontal_loop_fusion.h"
 #include "tensorflow/compiler/xla/service/hlo_matchers.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
@@ -66,6 +68,89 @@ ENTRY main {
                                     op::GetTupleElement(op::Fusion())));
 }
 
+TEST_F(GpuCompilerTest, RematerializeToFitDeviceMemoryInWhileBody) {
+  const char* hlo_text = R"(
+HloModule while_remat, is_scheduled=true
+
+%cond (cond_param: (f32[], f32[1024])) -> pred[] {
+  %cond_param = (f32[], f32[1024]{0}) parameter(0)
+  ROOT %false = pred[] constant(false)
+}
+
+%body (body_param: (f32[], f32[1024])) -> (f32[], f32[1024]) {
+  %body_param = (f32[], f32[1024]{0}) parameter(0)
+  %scalar = f32[] get-tuple-element(%body_param), index=0
+  %vec = f32[1024]{0} get-tuple-element(%body_param), index=1
+  %expensive = f32[1024]{0} exponential(f32[1024]{0} %vec)
+  %cheap = f32[1024]{0} broadcast(f32[] %scalar), dimensions={}
+  %add.0 = f32[1024]{0} add(f32[1024]{0} %expensive, f32[1024]{0} %cheap)
+  %big = f32[4096]{0} broadcast(f32[] %scalar), dimensions={}
+  %slice = f32[1024]{0} slice(f32[4096]{0} %big), slice={[0:1024]}
+  %add.1 = f32[1024]{0} add(f32[1024]{0} %expensive, f32[1024]{0} %slice)
+  %add.2 = f32[1024]{0} add(f32[1024]{0} %cheap, f32[1024]{0} %add.1)
+  %add.3 = f32[1024]{0} add(f32[1024]{0} %add.0, f32[1024]{0} %add.2)
+  %add.4 = f32[1024]{0} add(f32[1024]{0} %add.3, f32[1024]{0} %vec)
+  ROOT %tuple = (f32[], f32[1024]{0}) tuple(f32[] %scalar, f32[1024]{0} %add.4)
+}
+
+ENTRY %entry {
+  %param = (f32[], f32[1024]{0}) parameter(0)
+  ROOT %while = (f32[], f32[1024]{0}) while(%param), condition=%cond, body=%body
+}
+)";
+  HloModuleConfig config = GetModuleConfigForTest();
+  DebugOptions debug_options = config.debug_options();
+  debug_options.set_xla_gpu_enable_memory_budget_rematerialization(true);
+  config.set_debug_options(debug_options);
+  TF_ASSERT_OK_AND_ASSIGN(auto original,
+                          ParseAndReturnVerifiedModule(hlo_text, config));
+
+  // Find the largest device memory size that requires rematerialization.
+  // There, recomputing either broadcast or the exponential saves enough, and
+  // the cost analysis of the while body is what picks the cheap broadcast.
+  GpuDeviceInfo gpu_device_info = TestGpuDeviceInfo::RTXA6000DeviceInfo();
+  std::unique_ptr<HloModule> module;
+  bool changed = false;
+  for (int64_t memory_size = 256 * 1024; !changed && memory_size > 0;
+       memory_size -= 256) {
+    module = original->Clone();
+    gpu_device_info.device_memory_size = memory_size;
+    TF_ASSERT_OK_AND_ASSIGN(
+        changed, RematerializeToFitDeviceMemory(
+                     module.get(), /*pointer_size=*/8, gpu_device_info));
+  }
+  ASSERT_TRUE(changed);
+
+  const HloComputation* body = module->GetComputationWithName("body");
+  ASSERT_NE(body, nullptr);
+  const HloInstruction* expensive = body->GetInstructionWithName("expensive");
+  const HloInstruction* cheap = body->GetInstructionWithName("cheap");
+  EXPECT_EQ(body->GetInstructionWithName("add.1")->operand(0), expensive);
+  EXPECT_THAT(body->GetInstructionWithName("add.2")->operand(0),
+              ::testing::AllOf(op::Broadcast(op::GetTupleElement()),
+                               ::testing::Ne(cheap)));
+}
+
+TEST_F(GpuCompilerTest, RematerializeToFitDeviceMemoryIsOptIn) {
+  const char* hlo_text = R"(
+HloModule no_remat, is_scheduled=true
+
+ENTRY %entry {
+  %param = f32[] parameter(0)
+  %a = f32[1024]{0} broadcast(f32[] %param), dimensions={}
+  %b = f32[1024]{0} broadcast(f32[] %param), dimensions={}
+  ROOT %add = f32[1024]{0} add(f32[1024]{0} %a, f32[1024]{0} %b)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+  GpuDeviceInfo gpu_device_info = TestGpuDeviceInfo::RTXA6000DeviceInfo();
+  gpu_device_info.device_memory_size = 1;
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed, RematerializeToFitDeviceMemory(
+                        module.get(), /*pointer_size=*/8, gpu_device_info));
+  EXPECT_FALSE(changed);
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
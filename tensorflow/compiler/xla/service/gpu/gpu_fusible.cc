@@ -91,6 +91,23 @@ bool IsPhysicallyTransposing(const HloInstruction& instr) {
                                          instr.shape(), instr.dimensions()));
 }
 
+bool TransposesMostData(const HloInstruction& fusion) {
+  float score = 0;
+
+  for (const HloInstruction* instr : fusion.fused_instructions()) {
+    if (IsPhysicallyTransposing(*instr)) {
+      score += 1.0 * ShapeUtil::ElementsInRecursive(instr->shape()) /
+               ShapeUtil::ElementsInRecursive(fusion.shape());
+      if (score >= 0.5) {
+        VLOG(3) << fusion.ToString() << " transpose ratio exceeds " << score;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
 bool IsReduceInputFusion(const HloInstruction& instr) {
   return instr.opcode() == HloOpcode::kFusion &&
          HasAnyUnnestedReductionRoot(instr.called_computations()[0]);
@@ -64,6 +64,10 @@ inline constexpr int64_t MaxOperandsAndOutputsPerFusion() { return 64; }
 // to uncoalesced data access and may thus not be beneficial.
 bool IsPhysicallyTransposing(const HloInstruction& instr);
 
+// Whether at least half of the output elements of `fusion` are produced by
+// physically transposing instructions.
+bool TransposesMostData(const HloInstruction& fusion);
+
 // Note that reduction ops are lowered in different ways. Reduce input fusions
 // are lowered by IrEmitterUnnested::EmitReductionToVector and must be rooted at
 // reduction-to-vector ops. Other reduction ops are lowered by
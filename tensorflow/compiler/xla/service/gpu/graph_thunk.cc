@@ -0,0 +1,352 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/graph_thunk.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/service/gpu/conditional_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/copy_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/for_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/kernel_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/memset_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/runtime/graph_launch.h"
+#include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/while_thunk.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/profiler/lib/scoped_annotation.h"
+
+#if GOOGLE_CUDA
+#include "third_party/gpus/cuda/include/cuda_runtime_api.h"
+#include "tensorflow/compiler/xla/stream_executor/gpu/gpu_stream.h"
+#endif  // #if GOOGLE_CUDA
+
+namespace xla {
+namespace gpu {
+
+using ::tsl::profiler::ScopedAnnotation;
+
+struct GraphThunk::Graph {
+  // A stream owned by this graph, so that capturing never records work that
+  // other threads enqueue on the stream the executable runs on.
+  std::unique_ptr<se::Stream> capture_stream;
+
+  absl::Mutex mutex;
+
+#if GOOGLE_CUDA
+  GraphInstances::OwnedGraphExec exec ABSL_GUARDED_BY(mutex);
+#endif  // #if GOOGLE_CUDA
+
+  // Hash of the buffer addresses `exec` was captured with.
+  size_t ptrs_hash ABSL_GUARDED_BY(mutex) = 0;
+
+  // Set once capturing failed; from then on sub-thunks run one by one.
+  bool capture_failed ABSL_GUARDED_BY(mutex) = false;
+};
+
+static void AddAllocations(const Thunk& thunk,
+                           absl::flat_hash_set<BufferAllocation::Index>* out) {
+  switch (thunk.kind()) {
+    case Thunk::kKernel:
+      for (const BufferAllocation* arg :
+           static_cast<const KernelThunk&>(thunk).arguments()) {
+        out->insert(arg->index());
+      }
+      break;
+    case Thunk::kCopy: {
+      const auto& copy = static_cast<const DeviceToDeviceCopyThunk&>(thunk);
+      out->insert(copy.source().index());
+      out->insert(copy.destination().index());
+      break;
+    }
+    case Thunk::kMemset32BitValue:
+      out->insert(static_cast<const Memset32BitValueThunk&>(thunk)
+                      .destination()
+                      .index());
+      break;
+    case Thunk::kMemzero:
+      out->insert(
+          static_cast<const MemzeroThunk&>(thunk).destination().index());
+      break;
+    case Thunk::kSequential:
+      for (const std::unique_ptr<Thunk>& sub_thunk :
+           static_cast<const SequentialThunk&>(thunk).thunks()) {
+        AddAllocations(*sub_thunk, out);
+      }
+      break;
+    default:
+      LOG(FATAL) << "Thunk is not capturable: " << thunk.kind();
+  }
+}
+
+GraphThunk::GraphThunk(ThunkInfo thunk_info, ThunkSequence thunks)
+    : Thunk(Kind::kGraph, thunk_info), thunks_(std::move(thunks)) {
+  absl::flat_hash_set<BufferAllocation::Index> allocations;
+  for (const std::unique_ptr<Thunk>& thunk : thunks_) {
+    AddAllocations(*thunk, &allocations);
+  }
+  allocations_.assign(allocations.begin(), allocations.end());
+  absl::c_sort(allocations_);
+}
+
+GraphThunk::~GraphThunk() = default;
+
+/*static*/ bool GraphThunk::IsGraphCapturable(const Thunk& thunk) {
+  switch (thunk.kind()) {
+    // Kernel launches, device-to-device copies and memsets are all plain
+    // stream operations. Library calls are left out: they may allocate
+    // workspace or synchronize with the host on first use, which is not
+    // allowed while capturing.
+    case Thunk::kKernel:
+    case Thunk::kCopy:
+    case Thunk::kMemset32BitValue:
+    case Thunk::kMemzero:
+      return true;
+    case Thunk::kSequential:
+      return absl::c_all_of(
+          static_cast<const SequentialThunk&>(thunk).thunks(),
+          [](const std::unique_ptr<Thunk>& sub_thunk) {
+            return IsGraphCapturable(*sub_thunk);
+          });
+    default:
+      return false;
+  }
+}
+
+std::string GraphThunk::ToStringExtra(int indent) const {
+  std::string result = "\n";
+  absl::StrAppend(&result, thunks().ToString(indent + 1, nullptr));
+  return result;
+}
+
+Status GraphThunk::Initialize(const GpuExecutable& executable,
+                              se::StreamExecutor* executor) {
+  for (auto& thunk : thunks_) {
+    TF_RETURN_IF_ERROR(thunk->Initialize(executable, executor));
+  }
+
+  absl::MutexLock lock(&mutex_);
+  std::unique_ptr<Graph>& graph = graphs_[executor];
+  if (graph == nullptr) {
+    graph = std::make_unique<Graph>();
+    graph->capture_stream = std::make_unique<se::Stream>(executor);
+    graph->capture_stream->Init();
+    if (!graph->capture_stream->ok()) {
+      return InternalError("Failed to initialize a CUDA graph capture stream");
+    }
+  }
+  return OkStatus();
+}
+
+Status GraphThunk::ExecuteThunks(const ExecuteParams& params) {
+  for (const auto& thunk : thunks_) {
+    ScopedAnnotation annotation([&] { return thunk->profile_annotation(); });
+    TF_RETURN_IF_ERROR(thunk->ExecuteOnStream(params));
+  }
+  return OkStatus();
+}
+
+#if GOOGLE_CUDA
+
+// Captures the work `thunks` enqueue into a CUDA graph, using `stream` instead
+// of the stream in `params`.
+static StatusOr<GraphInstances::OwnedGraph> CaptureGraph(
+    const ThunkSequence& thunks, const Thunk::ExecuteParams& params,
+    se::Stream* stream) {
+  Thunk::ExecuteParams capture_params = params;
+  capture_params.stream = stream;
+
+  cudaStream_t cuda_stream = se::gpu::AsGpuStreamValue(stream);
+  if (auto err =
+          cudaStreamBeginCapture(cuda_stream, cudaStreamCaptureModeThreadLocal);
+      err != cudaSuccess) {
+    return InternalError("Stream begin capture failed: %s",
+                         cudaGetErrorString(err));
+  }
+
+  Status captured = OkStatus();
+  for (const auto& thunk : thunks) {
+    captured = thunk->ExecuteOnStream(capture_params);
+    if (!captured.ok()) break;
+  }
+
+  // Always stop capturing the stream before checking `captured`.
+  cudaGraph_t graph;
+  if (auto err = cudaStreamEndCapture(cuda_stream, &graph);
+      err != cudaSuccess) {
+    return InternalError("Stream end capture failed: %s",
+                         cudaGetErrorString(err));
+  }
+  GraphInstances::OwnedGraph owned_graph(graph);
+  TF_RETURN_IF_ERROR(captured);
+  return std::move(owned_graph);
+}
+
+// Makes `exec` an executable instance of `graph`, updating the existing
+// instance when possible.
+static Status InstantiateGraph(const GraphInstances::OwnedGraph& graph,
+                               GraphInstances::OwnedGraphExec* exec) {
+  if (*exec != nullptr) {
+    cudaGraphExecUpdateResult update_result;
+    cudaGraphNode_t error_node;
+    if (auto err = cudaGraphExecUpdate(exec->get(), graph.get(), &error_node,
+                                       &update_result);
+        err == cudaSuccess && update_result == cudaGraphExecUpdateSuccess) {
+      return OkStatus();
+    }
+    // The topology changed, e.g. because launch dimensions differ between
+    // captures. Clear the error and fall back to a new instance.
+    cudaGetLastError();
+    VLOG(3) << "CUDA graph update failed, instantiating a new graph";
+  }
+
+  cudaGraphExec_t instance;
+  if (auto err = cudaGraphInstantiate(&instance, graph.get(), nullptr, nullptr,
+                                      0);
+      err != cudaSuccess) {
+    return InternalError("Graph instantiation failed: %s",
+                         cudaGetErrorString(err));
+  }
+  exec->reset(instance);
+  return OkStatus();
+}
+
+#endif  // #if GOOGLE_CUDA
+
+Status GraphThunk::ExecuteOnStream(const ExecuteParams& params) {
+#if GOOGLE_CUDA
+  se::StreamExecutor* executor = params.stream->parent();
+  Graph* graph;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = graphs_.find(executor);
+    TF_RET_CHECK(it != graphs_.end())
+        << "Initialize() not called for StreamExecutor " << executor;
+    graph = it->second.get();
+  }
+
+  size_t ptrs_hash = 0;
+  for (BufferAllocation::Index index : allocations_) {
+    ptrs_hash = absl::HashOf(
+        ptrs_hash, params.buffer_allocations->GetDeviceAddress(index).opaque());
+  }
+
+  // Graph instances are updated in place, so executions of this thunk on the
+  // same device must not interleave.
+  absl::MutexLock lock(&graph->mutex);
+  if (graph->capture_failed) {
+    return ExecuteThunks(params);
+  }
+
+  if (graph->exec == nullptr || graph->ptrs_hash != ptrs_hash) {
+    VLOG(3) << (graph->exec == nullptr ? "Capture" : "Update")
+            << " CUDA graph of " << thunks_.size() << " thunks";
+    StatusOr<GraphInstances::OwnedGraph> captured =
+        CaptureGraph(thunks_, params, graph->capture_stream.get());
+    Status status = captured.status();
+    if (status.ok()) {
+      status = InstantiateGraph(*captured, &graph->exec);
+    }
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to capture a CUDA graph, executing "
+                   << thunks_.size() << " thunks without it: " << status;
+      graph->capture_failed = true;
+      graph->exec.reset();
+      return ExecuteThunks(params);
+    }
+    graph->ptrs_hash = ptrs_hash;
+  }
+
+  if (auto err = cudaGraphLaunch(graph->exec.get(),
+                                 se::gpu::AsGpuStreamValue(params.stream));
+      err != cudaSuccess) {
+    return InternalError("Failed to launch CUDA graph: %s",
+                         cudaGetErrorString(err));
+  }
+  return OkStatus();
+
+#else  // #if !GOOGLE_CUDA
+
+  return ExecuteThunks(params);
+
+#endif  // #if GOOGLE_CUDA
+}
+
+static void CaptureThunksIntoGraphs(SequentialThunk* sequential_thunk,
+                                    int64_t min_graph_size) {
+  CaptureThunksIntoGraphs(&sequential_thunk->thunks(), min_graph_size);
+}
+
+void CaptureThunksIntoGraphs(ThunkSequence* thunk_sequence,
+                             int64_t min_graph_size) {
+  ThunkSequence result;
+  ThunkSequence run;
+  auto flush_run = [&] {
+    if (run.size() >= std::max<int64_t>(min_graph_size, 1)) {
+      result.push_back(std::make_unique<GraphThunk>(
+          Thunk::ThunkInfo(/*op=*/nullptr), std::move(run)));
+    } else {
+      for (std::unique_ptr<Thunk>& thunk : run) {
+        result.push_back(std::move(thunk));
+      }
+    }
+    run.clear();
+  };
+
+  for (std::unique_ptr<Thunk>& thunk : *thunk_sequence) {
+    if (GraphThunk::IsGraphCapturable(*thunk)) {
+      run.push_back(std::move(thunk));
+      continue;
+    }
+    flush_run();
+
+    if (thunk->kind() == Thunk::kConditional) {
+      auto* cond_thunk = static_cast<ConditionalThunk*>(thunk.get());
+      for (const std::unique_ptr<SequentialThunk>& branch_thunks :
+           cond_thunk->branch_thunks()) {
+        CaptureThunksIntoGraphs(branch_thunks.get(), min_graph_size);
+      }
+    } else if (thunk->kind() == Thunk::kFor) {
+      auto* for_thunk = static_cast<ForThunk*>(thunk.get());
+      CaptureThunksIntoGraphs(for_thunk->body_thunk_sequence(),
+                              min_graph_size);
+    } else if (thunk->kind() == Thunk::kSequential) {
+      CaptureThunksIntoGraphs(static_cast<SequentialThunk*>(thunk.get()),
+                              min_graph_size);
+    } else if (thunk->kind() == Thunk::kWhile) {
+      auto* while_thunk = static_cast<WhileThunk*>(thunk.get());
+      CaptureThunksIntoGraphs(while_thunk->condition_thunk_sequence(),
+                              min_graph_size);
+      CaptureThunksIntoGraphs(while_thunk->body_thunk_sequence(),
+                              min_graph_size);
+    }
+    result.push_back(std::move(thunk));
+  }
+  flush_run();
+
+  *thunk_sequence = std::move(result);
+}
+
+}  // namespace gpu
+}  // namespace xla
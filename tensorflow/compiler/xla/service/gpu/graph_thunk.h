@@ -0,0 +1,90 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GRAPH_THUNK_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GRAPH_THUNK_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/compiler/xla/service/buffer_assignment.h"
+#include "tensorflow/compiler/xla/service/gpu/thunk.h"
+#include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
+
+namespace xla {
+namespace gpu {
+
+// A thunk that captures a sequence of sub-thunks into a CUDA graph the first
+// time it runs, and then replays the graph with a single launch instead of
+// launching every sub-thunk on its own.
+//
+// Captured graphs are keyed by the device addresses of the buffer allocations
+// the sub-thunks access. When an execution uses different addresses, the
+// sub-thunks are captured again and the graph instance is updated in place,
+// which is much cheaper than instantiating a new one.
+//
+// Only thunks that enqueue device work without synchronizing with the host can
+// be captured, see `IsGraphCapturable`. If capturing fails, or CUDA is not
+// available, the sub-thunks are executed one by one as usual.
+//
+// This is thread-safe.
+class GraphThunk : public Thunk {
+ public:
+  GraphThunk(ThunkInfo thunk_info, ThunkSequence thunks);
+  GraphThunk(const GraphThunk&) = delete;
+  GraphThunk& operator=(const GraphThunk&) = delete;
+  ~GraphThunk() override;
+
+  ThunkSequence& thunks() { return thunks_; }
+  const ThunkSequence& thunks() const { return thunks_; }
+  std::string ToStringExtra(int indent) const override;
+
+  Status Initialize(const GpuExecutable& executable,
+                    se::StreamExecutor* executor) override;
+  Status ExecuteOnStream(const ExecuteParams& params) override;
+
+  // Returns whether `thunk` can be part of a GraphThunk.
+  static bool IsGraphCapturable(const Thunk& thunk);
+
+ private:
+  struct Graph;
+
+  Status ExecuteThunks(const ExecuteParams& params);
+
+  // The list of sub-thunks.
+  ThunkSequence thunks_;
+
+  // Buffer allocations accessed by the sub-thunks.
+  std::vector<BufferAllocation::Index> allocations_;
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<se::StreamExecutor*, std::unique_ptr<Graph>> graphs_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+// Replaces every run of at least `min_graph_size` consecutive capturable thunks
+// in `thunk_sequence`, including the bodies of control flow thunks, with a
+// GraphThunk.
+void CaptureThunksIntoGraphs(ThunkSequence* thunk_sequence,
+                             int64_t min_graph_size);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GRAPH_THUNK_H_
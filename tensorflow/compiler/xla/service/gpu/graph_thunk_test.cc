@@ -0,0 +1,108 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/graph_thunk.h"
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/compiler/xla/service/buffer_assignment.h"
+#include "tensorflow/compiler/xla/service/gpu/memset_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/replica_id_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class GraphThunkTest : public ::testing::Test {
+ protected:
+  std::unique_ptr<Thunk> Memzero() {
+    return std::make_unique<MemzeroThunk>(
+        Thunk::ThunkInfo(nullptr),
+        BufferAllocation::Slice(&allocation_, 0, 4), mlir::Value());
+  }
+
+  std::unique_ptr<Thunk> ReplicaId() {
+    return std::make_unique<ReplicaIdThunk>(
+        Thunk::ThunkInfo(nullptr),
+        BufferAllocation::Slice(&allocation_, 0, 4));
+  }
+
+  BufferAllocation allocation_{/*index=*/0, /*size=*/4, /*color=*/0};
+};
+
+TEST_F(GraphThunkTest, CapturesLongEnoughRuns) {
+  ThunkSequence thunks;
+  thunks.push_back(Memzero());
+  thunks.push_back(Memzero());
+  thunks.push_back(ReplicaId());
+  thunks.push_back(Memzero());
+  thunks.push_back(ReplicaId());
+  thunks.push_back(Memzero());
+  thunks.push_back(Memzero());
+  thunks.push_back(Memzero());
+
+  CaptureThunksIntoGraphs(&thunks, /*min_graph_size=*/2);
+
+  ASSERT_EQ(thunks.size(), 5);
+  EXPECT_EQ(thunks[0]->kind(), Thunk::kGraph);
+  EXPECT_EQ(static_cast<GraphThunk*>(thunks[0].get())->thunks().size(), 2);
+  EXPECT_EQ(thunks[1]->kind(), Thunk::kReplicaId);
+  EXPECT_EQ(thunks[2]->kind(), Thunk::kMemzero);
+  EXPECT_EQ(thunks[3]->kind(), Thunk::kReplicaId);
+  EXPECT_EQ(thunks[4]->kind(), Thunk::kGraph);
+  EXPECT_EQ(static_cast<GraphThunk*>(thunks[4].get())->thunks().size(), 3);
+}
+
+TEST_F(GraphThunkTest, CapturesInsideSequentialThunks) {
+  ThunkSequence body;
+  body.push_back(ReplicaId());
+  body.push_back(Memzero());
+  body.push_back(Memzero());
+  ThunkSequence thunks;
+  thunks.push_back(std::make_unique<SequentialThunk>(Thunk::ThunkInfo(nullptr),
+                                                     std::move(body)));
+
+  CaptureThunksIntoGraphs(&thunks, /*min_graph_size=*/2);
+
+  ASSERT_EQ(thunks.size(), 1);
+  ASSERT_EQ(thunks[0]->kind(), Thunk::kSequential);
+  const ThunkSequence& captured =
+      static_cast<SequentialThunk*>(thunks[0].get())->thunks();
+  ASSERT_EQ(captured.size(), 2);
+  EXPECT_EQ(captured[0]->kind(), Thunk::kReplicaId);
+  EXPECT_EQ(captured[1]->kind(), Thunk::kGraph);
+}
+
+TEST_F(GraphThunkTest, CapturableSequentialThunkIsCapturedWhole) {
+  ThunkSequence body;
+  body.push_back(Memzero());
+  body.push_back(Memzero());
+  ThunkSequence thunks;
+  thunks.push_back(std::make_unique<SequentialThunk>(Thunk::ThunkInfo(nullptr),
+                                                     std::move(body)));
+  thunks.push_back(Memzero());
+
+  CaptureThunksIntoGraphs(&thunks, /*min_graph_size=*/2);
+
+  ASSERT_EQ(thunks.size(), 1);
+  EXPECT_EQ(thunks[0]->kind(), Thunk::kGraph);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
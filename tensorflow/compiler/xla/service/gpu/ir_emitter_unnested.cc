@@ -1820,6 +1820,271 @@ Status IrEmitterUnnested::EmitUnnestedTranspose(
   return OkStatus();
 }
 
+// Returns whether EmitRowNormalization supports `fused_computation`. Every
+// reduce must reduce the minor dimension of an array shaped like the root, and
+// the results of the reductions may only reach the root through elementwise
+// ops and broadcasts along the minor dimension. Other broadcasts may not
+// transpose and reshapes may only insert or delete 1-sized dimensions. A block
+// computing one row of the root then only uses the results of the reductions,
+// and the elements of the inputs shaped like the root, of that row.
+static bool CanEmitRowNormalization(const HloComputation* fused_computation) {
+  const HloInstruction* root = fused_computation->root_instruction();
+  const Shape& shape = root->shape();
+  if (!shape.IsArray() || shape.rank() == 0 ||
+      ShapeUtil::IsZeroElementArray(shape) ||
+      !LayoutUtil::IsMonotonicWithDim0Major(shape.layout()) ||
+      !IsInt32(ShapeUtil::ElementsIn(shape) / shape.dimensions().back())) {
+    return false;
+  }
+  const int64_t minor_dim = shape.rank() - 1;
+  // The instructions whose values depend on the result of a reduction.
+  absl::flat_hash_set<const HloInstruction*> uses_reduction;
+  bool has_reduction = false;
+  for (const HloInstruction* instr :
+       fused_computation->MakeInstructionPostOrder()) {
+    bool reads_reduction =
+        absl::c_any_of(instr->operands(), [&](const HloInstruction* operand) {
+          return uses_reduction.contains(operand);
+        });
+    switch (instr->opcode()) {
+      case HloOpcode::kParameter:
+      case HloOpcode::kConstant:
+        break;
+      case HloOpcode::kReduce: {
+        const Shape& input_shape = instr->operand(0)->shape();
+        if (instr->operand_count() != 2 || instr->dimensions().size() != 1 ||
+            instr->dimensions(0) != minor_dim ||
+            !ShapeUtil::SameDimensions(input_shape, shape) ||
+            !LayoutUtil::IsMonotonicWithDim0Major(input_shape.layout()) ||
+            uses_reduction.contains(instr->operand(1))) {
+          return false;
+        }
+        has_reduction = true;
+        reads_reduction = true;
+        break;
+      }
+      case HloOpcode::kBroadcast:
+        if (!absl::c_is_sorted(instr->dimensions())) {
+          return false;
+        }
+        if (!reads_reduction) {
+          break;
+        }
+        if (!ShapeUtil::SameDimensions(instr->shape(), shape) ||
+            absl::c_linear_search(instr->dimensions(), minor_dim)) {
+          return false;
+        }
+        for (int64_t dim = 0; dim < minor_dim; ++dim) {
+          if (shape.dimensions(dim) != 1 &&
+              !absl::c_linear_search(instr->dimensions(), dim)) {
+            return false;
+          }
+        }
+        break;
+      case HloOpcode::kReshape:
+        if (!instr->ReshapeMerelyInsertsOrDeletes1SizedDimensions()) {
+          return false;
+        }
+        break;
+      default:
+        if (!instr->IsElementwise()) {
+          return false;
+        }
+    }
+    if (reads_reduction) {
+      uses_reduction.insert(instr);
+    }
+  }
+  return has_reduction;
+}
+
+Status IrEmitterUnnested::EmitRowNormalization(
+    mlir::lmhlo::FusionOp fusion, HloComputation* fused_computation) {
+  // Longer rows are processed in several steps by every thread.
+  constexpr int64_t kMaxThreadsPerBlock = 1024;
+  // Inputs shaped like the output are cached as long as their rows fit into
+  // this many bytes together. The other ones are read from global memory
+  // whenever they are used, mostly hitting the L2 cache.
+  constexpr int64_t kMaxSharedMemoryBytes = 32 * 1024;
+
+  const HloInstruction* root = fused_computation->root_instruction();
+  const Shape& shape = root->shape();
+  const int64_t row_size = shape.dimensions().back();
+  const int64_t num_rows = ShapeUtil::ElementsIn(shape) / row_size;
+  const int64_t threads_per_block = std::min<int64_t>(
+      {RoundUpTo<int64_t>(row_size, WarpSize()), kMaxThreadsPerBlock,
+       ir_emitter_context_->gpu_device_info().threads_per_block_limit});
+  const int64_t num_warps = threads_per_block / WarpSize();
+  LaunchDimensions launch_dimensions(num_rows, threads_per_block);
+  VLOG(3) << "Launch dimensions of "
+          << mlir::mhlo::GetDebugNameFromLocation(fusion.getLoc()) << ": "
+          << launch_dimensions.ToString();
+
+  TF_ASSIGN_OR_RETURN(std::vector<llvm_ir::IrArray> ir_arrays,
+                      BuildKernelThunk(fusion, launch_dimensions));
+  llvm::Type* index_ty =
+      GetIndexTypeForKernel(fusion, launch_dimensions.launch_bound(), &b_);
+  auto constant = [&](uint64_t c) -> llvm::Constant* {
+    return llvm::ConstantInt::get(index_ty, c);
+  };
+  auto shared_element_address = [&](llvm::GlobalVariable* shared,
+                                    llvm::Value* index) {
+    llvm::Type* array_type = shared->getValueType();
+    return CastSharedToGlobal(
+        InBoundsGEP(array_type, shared, {constant(0), index}),
+        array_type->getArrayElementType());
+  };
+
+  llvm::Value* thread_id = EmitThreadId(threads_per_block, index_ty);
+  llvm::Value* row = EmitBlockId(static_cast<int32_t>(num_rows), index_ty);
+  llvm::Value* lane_id = b_.CreateURem(thread_id, constant(WarpSize()));
+  llvm::Value* warp_id = b_.CreateUDiv(thread_id, constant(WarpSize()));
+
+  // Returns the index of the element in column `column` of the row of the
+  // block.
+  std::vector<llvm::Value*> row_multidim;
+  if (shape.rank() > 1) {
+    Shape row_shape = ShapeUtil::DeleteDimension(shape.rank() - 1, shape);
+    row_multidim = IrArray::Index(row, row_shape, &b_).multidim();
+  }
+  auto element_index = [&](llvm::Value* column) {
+    std::vector<llvm::Value*> multidim = row_multidim;
+    multidim.push_back(column);
+    return IrArray::Index(multidim, shape.dimensions(), index_ty);
+  };
+
+  KernelSupportLibrary ksl(&b_);
+  FusedIrEmitter fused_emitter(elemental_emitter_);
+  int64_t shared_memory_bytes = 0;
+  for (int i = 0; i < fused_computation->num_parameters(); ++i) {
+    const HloInstruction* parameter =
+        fused_computation->parameter_instruction(i);
+    const IrArray& ir_array = ir_arrays[i];
+    const int64_t row_bytes =
+        row_size * ShapeUtil::ByteSizeOfPrimitiveType(
+                       parameter->shape().element_type());
+    if (!ShapeUtil::SameDimensions(parameter->shape(), shape) ||
+        shared_memory_bytes + row_bytes > kMaxSharedMemoryBytes) {
+      fused_emitter.BindGenerator(
+          *parameter, [this, ir_array, parameter](const IrArray::Index& index) {
+            return ir_array.EmitReadArrayElement(index, &b_,
+                                                 parameter->name());
+          });
+      continue;
+    }
+    shared_memory_bytes += row_bytes;
+    llvm::Type* element_type = llvm_ir::PrimitiveTypeToIrType(
+        parameter->shape().element_type(), module_);
+    llvm::GlobalVariable* row_cache = llvm_ir::AllocateSharedMemoryTile(
+        module_, llvm::ArrayType::get(element_type, row_size),
+        StrCat(parameter->name(), "_row"));
+    ksl.For("cache_row", thread_id, constant(row_size),
+            constant(threads_per_block), [&](llvm::Value* column) {
+              Store(ir_array.EmitReadArrayElement(element_index(column), &b_,
+                                                  parameter->name()),
+                    shared_element_address(row_cache, column));
+            });
+    fused_emitter.BindGenerator(
+        *parameter, [&, row_cache, element_type](const IrArray::Index& index) {
+          llvm::Value* column = index.multidim().back();
+          return Load(element_type, shared_element_address(row_cache, column),
+                      "cached_element");
+        });
+  }
+  if (shared_memory_bytes > 0) {
+    EmitSyncThreads();
+  }
+
+  for (const HloInstruction* instr :
+       fused_computation->MakeInstructionPostOrder()) {
+    if (instr->opcode() != HloOpcode::kReduce) {
+      continue;
+    }
+    const HloComputation* reducer = instr->to_apply();
+    llvm::Type* element_type =
+        llvm_ir::PrimitiveTypeToIrType(instr->shape().element_type(), module_);
+    TF_ASSIGN_OR_RETURN(llvm_ir::ElementGenerator input_generator,
+                        fused_emitter.GetGenerator(*instr->operand(0)));
+    TF_ASSIGN_OR_RETURN(llvm_ir::ElementGenerator init_generator,
+                        fused_emitter.GetGenerator(*instr->operand(1)));
+    TF_ASSIGN_OR_RETURN(llvm::Value * initial_value,
+                        init_generator(IrArray::Index(index_ty)));
+    llvm::AllocaInst* partial_result_address =
+        llvm_ir::EmitAllocaAtFunctionEntry(element_type, "partial_result",
+                                           &b_);
+    llvm::AllocaInst* input_address =
+        llvm_ir::EmitAllocaAtFunctionEntry(element_type, "input", &b_);
+    Store(initial_value, partial_result_address);
+    TF_RETURN_IF_ERROR(ksl.ForWithStatus(
+        "reduce_row", thread_id, constant(row_size),
+        constant(threads_per_block), [&](llvm::Value* column) -> Status {
+          TF_ASSIGN_OR_RETURN(llvm::Value * input,
+                              input_generator(element_index(column)));
+          Store(input, input_address);
+          TF_ASSIGN_OR_RETURN(
+              std::vector<llvm::Value*> results,
+              ComputeNestedElementFromAddrs(
+                  *reducer, {partial_result_address, input_address}));
+          Store(results[0], partial_result_address);
+          return OkStatus();
+        }));
+
+    // Reduces the partial results of every warp, then those of the warps.
+    const TypedPointer partial_result = {partial_result_address, element_type};
+    EmitFullWarpShuffleDownLoopForReduce(reducer, {partial_result},
+                                         threads_per_block);
+    llvm::GlobalVariable* warp_results = llvm_ir::AllocateSharedMemoryTile(
+        module_, llvm::ArrayType::get(element_type, num_warps),
+        "warp_results");
+    llvm::GlobalVariable* row_result = llvm_ir::AllocateSharedMemoryTile(
+        module_, llvm::ArrayType::get(element_type, 1), "row_result");
+    ksl.If("store_warp_result", b_.CreateICmpEQ(lane_id, constant(0)), [&] {
+      Store(Load(element_type, partial_result_address),
+            shared_element_address(warp_results, warp_id));
+    });
+    EmitSyncThreads();
+    ksl.If("reduce_warp_results", b_.CreateICmpEQ(warp_id, constant(0)), [&] {
+      Store(initial_value, partial_result_address);
+      ksl.If("load_warp_result",
+             b_.CreateICmpULT(lane_id, constant(num_warps)), [&] {
+               Store(Load(element_type,
+                          shared_element_address(warp_results, lane_id)),
+                     partial_result_address);
+             });
+      if (num_warps > 1) {
+        EmitFullWarpShuffleDownLoopForReduce(reducer, {partial_result},
+                                             threads_per_block);
+      }
+      ksl.If("store_row_result", b_.CreateICmpEQ(lane_id, constant(0)), [&] {
+        Store(Load(element_type, partial_result_address),
+              shared_element_address(row_result, constant(0)));
+      });
+    });
+    EmitSyncThreads();
+
+    // All the elements of the reduce that the block uses are the one of its
+    // row.
+    fused_emitter.BindGenerator(
+        *instr, [&, row_result, element_type](const IrArray::Index&) {
+          return Load(element_type,
+                      shared_element_address(row_result, constant(0)),
+                      "row_result");
+        });
+  }
+
+  TF_ASSIGN_OR_RETURN(llvm_ir::ElementGenerator root_generator,
+                      fused_emitter.GetGenerator(*root));
+  const IrArray& output_array = ir_arrays[fused_computation->num_parameters()];
+  return ksl.ForWithStatus(
+      "write_row", thread_id, constant(row_size), constant(threads_per_block),
+      [&](llvm::Value* column) -> Status {
+        IrArray::Index index = element_index(column);
+        TF_ASSIGN_OR_RETURN(llvm::Value * value, root_generator(index));
+        output_array.EmitWriteArrayElement(index, value, &b_);
+        return OkStatus();
+      });
+}
+
 Status IrEmitterUnnested::EmitFusion(mlir::Operation* op) {
   auto fusion_op = mlir::cast<mlir::lmhlo::FusionOp>(op);
   TF_ASSIGN_OR_RETURN(
@@ -1827,6 +2092,13 @@ Status IrEmitterUnnested::EmitFusion(mlir::Operation* op) {
       GetOrCreateSubComputationFromRegion(&fusion_op.getRegion(),
                                           /*is_fusion=*/true));
 
+  if (auto fusion_type =
+          fusion_op->getAttrOfType<mlir::StringAttr>("fusion_type");
+      fusion_type && fusion_type.getValue() == "row_normalization_fusion" &&
+      CanEmitRowNormalization(fused_computation)) {
+    return EmitRowNormalization(fusion_op, fused_computation);
+  }
+
   if (HasAnyUnnestedReductionRoot(fused_computation)) {
     return EmitUnnestedReduction(fusion_op, fused_computation);
   }
@@ -471,6 +471,21 @@ class IrEmitterUnnested : public IrEmitter {
   Status EmitUnnestedTranspose(mlir::lmhlo::FusionOp fusion,
                                HloComputation* fused_computation);
 
+  // Emits a fusion of a softmax, layer normalization or RMS normalization
+  // formed by SoftmaxFusion, one row of the output per block:
+  //
+  //   cache the row of every input shaped like the output in shared memory
+  //   for each reduce of the fusion:
+  //     every thread reduces a strided part of the row
+  //     reduce the partial results of the block, as row reductions do
+  //     store the result of the row in shared memory
+  //   every thread computes a strided part of the output row
+  //
+  // The inputs are thus read from global memory once, however many
+  // reductions use them.
+  Status EmitRowNormalization(mlir::lmhlo::FusionOp fusion,
+                              HloComputation* fused_computation);
+
   // Computes the KernelMappingScheme for the reduce HLO and indicates whether
   // the reduction is a row reduction. For an un-fused reduce op, unnested_hlo
   // and first_reduce are the same instruction. For a kInput fusion,
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/algebraic_simplifier.h"
 #include "tensorflow/compiler/xla/service/call_inliner.h"
 #include "tensorflow/compiler/xla/service/dump.h"
+#include "tensorflow/compiler/xla/service/gpu/autotune_database.h"
 #include "tensorflow/compiler/xla/service/gpu/cublas_cudnn.h"
 #include "tensorflow/compiler/xla/service/gpu/cublas_pad_for_gemms.h"
 #include "tensorflow/compiler/xla/service/gpu/cudnn_fused_conv_rewriter.h"
@@ -115,6 +116,17 @@ Status NVPTXCompiler::OptimizeHloPostLayoutAssignment(
     HloModule* hlo_module, se::StreamExecutor* stream_exec,
     se::DeviceMemoryAllocator* device_allocator,
     const GpuTargetConfig& gpu_target_config) {
+  const std::string& autotune_database_dir =
+      hlo_module->config().debug_options().xla_gpu_autotune_database_dir();
+  const bool use_autotune_database =
+      stream_exec != nullptr && !autotune_database_dir.empty();
+  if (use_autotune_database) {
+    // Seeds the conv and gemm algorithm pickers' caches, so this has to happen
+    // before any of them run.
+    TF_RETURN_IF_ERROR(
+        LoadAutotuneDatabase(autotune_database_dir, stream_exec));
+  }
+
   HloPassPipeline pre_pipeline("nvptx post-layout_assignment part 1");
 
   // This needs to run before GemmRewriter, which is part of
@@ -166,6 +178,16 @@ Status NVPTXCompiler::OptimizeHloPostLayoutAssignment(
 
   TF_RETURN_IF_ERROR(post_pipeline.Run(hlo_module).status());
 
+  if (use_autotune_database) {
+    // A stale database only costs autotuning time, so don't fail compilation.
+    if (Status status =
+            MergeIntoAutotuneDatabase(autotune_database_dir, stream_exec);
+        !status.ok()) {
+      LOG(WARNING) << "Failed to update the autotune database in "
+                   << autotune_database_dir << ": " << status;
+    }
+  }
+
   return OkStatus();
 }
 
@@ -0,0 +1,348 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/priority_fusion.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
+#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_reachability.h"
+#include "tensorflow/tsl/platform/errors.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// A way of merging `producer` into its users. If `consumer` is null the
+// producer is merged into all of its users, otherwise it is merged into
+// `consumer` as a multi-output fusion.
+struct FusionCandidate {
+  HloInstruction* producer = nullptr;
+  HloInstruction* consumer = nullptr;
+  absl::Duration savings;
+};
+
+class PriorityFusionImpl {
+ public:
+  PriorityFusionImpl(HloComputation* computation, const GpuDeviceInfo& d,
+                     HloCostAnalysis::ShapeSizeFunction f)
+      : computation_(computation),
+        gpu_device_info_(d),
+        cost_analysis_(GpuHloCostAnalysis::Options{
+            f, /*per_second_rates=*/{},
+            /*count_multiple_input_accesses=*/true}) {}
+
+  StatusOr<bool> Run();
+
+ private:
+  FusionDecision CanFuseIntoAllUsers(HloInstruction* producer);
+  FusionDecision CanMultiOutputFuse(HloInstruction* producer,
+                                    HloInstruction* consumer);
+
+  // Returns the legal candidate for `producer` with the largest predicted
+  // savings, or std::nullopt if no candidate is predicted to be faster.
+  std::optional<FusionCandidate> BestCandidate(HloInstruction* producer);
+
+  void UpdatePriority(HloInstruction* producer);
+  void RemoveFromQueue(HloInstruction* producer);
+
+  // Apply `candidate` and return the fusions whose cost changed.
+  StatusOr<std::vector<HloInstruction*>> FuseIntoAllUsers(
+      HloInstruction* producer);
+  StatusOr<HloInstruction*> MultiOutputFuse(HloInstruction* producer,
+                                            HloInstruction* consumer);
+
+  HloComputation* computation_;
+  const GpuDeviceInfo& gpu_device_info_;
+  GpuHloCostAnalysis cost_analysis_;
+  FusionInfoCache fusion_info_cache_;
+  std::unique_ptr<HloReachabilityMap> reachability_;
+
+  // Candidates ordered by decreasing savings. Ties are broken by the unique id
+  // of the producer to keep the pass deterministic.
+  using QueueKey = std::pair<absl::Duration, int>;
+  std::map<QueueKey, FusionCandidate, std::greater<QueueKey>> queue_;
+  absl::flat_hash_map<HloInstruction*, QueueKey> queue_keys_;
+};
+
+FusionDecision PriorityFusionImpl::CanFuseIntoAllUsers(
+    HloInstruction* producer) {
+  // Library fusions match specific patterns and input fusions need to be
+  // rooted at a particular HLO, so only loop fusions can be merged.
+  if (!producer->IsLoopFusion()) {
+    return "not a loop fusion";
+  }
+  bool has_reduction_user = false;
+  for (const HloInstruction* user : producer->users()) {
+    if (user->opcode() == HloOpcode::kBitcast) {
+      return "not fusing bitcast ops";
+    }
+    if (FusionDecision fusible = IsProducerConsumerFusible(*producer, *user);
+        !fusible) {
+      return fusible;
+    }
+    has_reduction_user |= IsInputFusibleReduction(*user);
+  }
+  // Connecting a reduction to a producer that transposes most data would
+  // worsen its memory access pattern.
+  if (has_reduction_user && TransposesMostData(*producer)) {
+    return "would read mostly uncoalesced";
+  }
+  for (const HloInstruction* user : producer->users()) {
+    if (FusionDecision fits = FusionFitsInBudget(
+            *user, *producer, /*is_consumer_producer_fusion=*/true,
+            &fusion_info_cache_);
+        !fits) {
+      return fits;
+    }
+    if (cost_analysis_.ProducerConsumerMergedTooLarge(*producer, *user)) {
+      return FusionDecision{} << "if merged with " << user->name()
+                              << " will generate huge IR";
+    }
+  }
+  return {};
+}
+
+FusionDecision PriorityFusionImpl::CanMultiOutputFuse(
+    HloInstruction* producer, HloInstruction* consumer) {
+  if (!IsFusibleAsMultiOutputFusionRoot(*consumer)) {
+    return "consumer not eligible as multi-output fusion root";
+  }
+  if (FusionDecision fusible =
+          IsProducerConsumerMultiOutputFusible(*producer, *consumer);
+      !fusible) {
+    return fusible;
+  }
+  // Fusing would create a cycle if another operand of the consumer can be
+  // reached from the producer.
+  for (const HloInstruction* operand : consumer->operands()) {
+    if (operand != producer && reachability_->IsReachable(producer, operand)) {
+      return FusionDecision{} << producer->name()
+                              << " would introduce a cycle when fused";
+    }
+  }
+  if (FusionDecision fits =
+          FusionFitsInBudget(*producer, *consumer,
+                             /*is_consumer_producer_fusion=*/false,
+                             &fusion_info_cache_);
+      !fits) {
+    return fits;
+  }
+  if (cost_analysis_.ProducerConsumerMergedTooLarge(*producer, *consumer)) {
+    return FusionDecision{} << "if merged with " << consumer->name()
+                            << " will generate huge IR";
+  }
+  return {};
+}
+
+std::optional<FusionCandidate> PriorityFusionImpl::BestCandidate(
+    HloInstruction* producer) {
+  if (producer->opcode() != HloOpcode::kFusion || producer->users().empty()) {
+    return std::nullopt;
+  }
+
+  std::optional<FusionCandidate> best;
+  auto consider = [&](HloInstruction* consumer,
+                      const GpuPerformanceModel::RunTimes& t) {
+    absl::Duration savings = t.time_unfused - t.time_fused;
+    VLOG(4) << "Fusing " << producer->name() << " into "
+            << (consumer ? consumer->name() : "all users")
+            << " is predicted to save " << savings;
+    if (savings > absl::ZeroDuration() &&
+        (!best.has_value() || savings > best->savings)) {
+      best = FusionCandidate{producer, consumer, savings};
+    }
+  };
+
+  if (FusionDecision decision = CanFuseIntoAllUsers(producer); decision) {
+    consider(/*consumer=*/nullptr,
+             GpuPerformanceModel::EstimateRunTimes(
+                 producer, &cost_analysis_, gpu_device_info_,
+                 producer->users(), /*multi_output=*/false));
+  } else {
+    VLOG(5) << "Not fusing " << producer->name()
+            << " into all users: " << decision.Explain();
+  }
+
+  // Multi-output fusion with the only user is equivalent to the above unless
+  // that user is a multi-output fusion already.
+  if (producer->user_count() > 1 ||
+      producer->users()[0]->IsMultiOutputFusion()) {
+    for (HloInstruction* consumer : producer->users()) {
+      if (FusionDecision decision = CanMultiOutputFuse(producer, consumer);
+          !decision) {
+        VLOG(5) << "Not multi-output fusing " << producer->name() << " into "
+                << consumer->name() << ": " << decision.Explain();
+        continue;
+      }
+      consider(consumer, GpuPerformanceModel::EstimateRunTimes(
+                             producer, &cost_analysis_, gpu_device_info_,
+                             {consumer}, /*multi_output=*/true));
+    }
+  }
+  return best;
+}
+
+void PriorityFusionImpl::RemoveFromQueue(HloInstruction* producer) {
+  auto it = queue_keys_.find(producer);
+  if (it == queue_keys_.end()) return;
+  queue_.erase(it->second);
+  queue_keys_.erase(it);
+}
+
+void PriorityFusionImpl::UpdatePriority(HloInstruction* producer) {
+  RemoveFromQueue(producer);
+  if (std::optional<FusionCandidate> candidate = BestCandidate(producer)) {
+    QueueKey key{candidate->savings, producer->unique_id()};
+    queue_.emplace(key, *candidate);
+    queue_keys_.emplace(producer, key);
+  }
+}
+
+StatusOr<std::vector<HloInstruction*>> PriorityFusionImpl::FuseIntoAllUsers(
+    HloInstruction* producer) {
+  std::vector<HloInstruction*> consumers;
+  std::vector<HloInstruction*> users = producer->users();
+  for (HloInstruction* user : users) {
+    TF_RETURN_IF_ERROR(cost_analysis_.RemoveInstruction(user));
+
+    // Wrap consumers which are not fusions first.
+    HloInstruction* consumer = user;
+    if (consumer->opcode() != HloOpcode::kFusion) {
+      RemoveFromQueue(user);
+      consumer = computation_->AddInstruction(HloInstruction::CreateFusion(
+          user->shape(), ChooseFusionKind(*producer, *user), user));
+      TF_RETURN_IF_ERROR(computation_->ReplaceInstruction(user, consumer));
+    }
+
+    consumer->MergeFusionInstruction(producer);
+    TF_RETURN_IF_ERROR(cost_analysis_.RevisitInstruction(consumer));
+    fusion_info_cache_.Invalidate(consumer);
+    consumers.push_back(consumer);
+  }
+
+  CHECK_EQ(0, producer->user_count()) << producer->ToString();
+  TF_RETURN_IF_ERROR(cost_analysis_.RemoveInstruction(producer));
+  fusion_info_cache_.Invalidate(producer);
+  TF_RETURN_IF_ERROR(computation_->RemoveInstruction(producer));
+  return consumers;
+}
+
+StatusOr<HloInstruction*> PriorityFusionImpl::MultiOutputFuse(
+    HloInstruction* producer, HloInstruction* consumer) {
+  fusion_info_cache_.Invalidate(producer);
+  fusion_info_cache_.Invalidate(consumer);
+  TF_RETURN_IF_ERROR(cost_analysis_.RemoveInstruction(producer));
+  TF_RETURN_IF_ERROR(cost_analysis_.RemoveInstruction(consumer));
+
+  HloInstruction* fusion = consumer;
+  if (consumer->opcode() != HloOpcode::kFusion) {
+    RemoveFromQueue(consumer);
+    fusion = computation_->AddInstruction(HloInstruction::CreateFusion(
+        consumer->shape(), ChooseFusionKind(*producer, *consumer), consumer));
+    TF_RETURN_IF_ERROR(computation_->ReplaceInstruction(consumer, fusion));
+  }
+  fusion->MergeFusionInstructionIntoMultiOutput(producer);
+  TF_RETURN_IF_ERROR(cost_analysis_.RevisitInstruction(fusion));
+  return fusion;
+}
+
+StatusOr<bool> PriorityFusionImpl::Run() {
+  TF_RETURN_IF_ERROR(computation_->Accept(&cost_analysis_));
+  reachability_ = HloReachabilityMap::Build(computation_);
+  for (HloInstruction* instr : computation_->MakeInstructionPostOrder()) {
+    UpdatePriority(instr);
+  }
+
+  bool changed = false;
+  while (!queue_.empty()) {
+    FusionCandidate candidate = queue_.begin()->second;
+    HloInstruction* producer = candidate.producer;
+    RemoveFromQueue(producer);
+    if (!ConsumeFuel("priority-fusion", [&] {
+          return absl::StrFormat("Not fusing %s.", producer->name());
+        })) {
+      continue;
+    }
+
+    VLOG(2) << "Fusing " << producer->name() << " into "
+            << (candidate.consumer ? candidate.consumer->name() : "all users")
+            << ", predicted savings: " << candidate.savings;
+    std::vector<HloInstruction*> consumers;
+    if (candidate.consumer == nullptr) {
+      TF_ASSIGN_OR_RETURN(consumers, FuseIntoAllUsers(producer));
+    } else {
+      TF_ASSIGN_OR_RETURN(HloInstruction * fusion,
+                          MultiOutputFuse(producer, candidate.consumer));
+      consumers.push_back(fusion);
+    }
+    changed = true;
+    reachability_ = HloReachabilityMap::Build(computation_);
+
+    // The merge changed the cost of the consumers, both as producers
+    // themselves and as users of their operands. Any candidate that referred
+    // to a removed instruction is among these as well.
+    absl::flat_hash_set<HloInstruction*> affected;
+    for (HloInstruction* consumer : consumers) {
+      affected.insert(consumer);
+      for (HloInstruction* operand : consumer->operands()) {
+        affected.insert(operand);
+      }
+    }
+    for (HloInstruction* instr : affected) {
+      UpdatePriority(instr);
+    }
+  }
+  return changed;
+}
+
+}  // namespace
+
+StatusOr<bool> GpuPriorityFusion::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  bool changed = false;
+  for (HloComputation* computation :
+       module->MakeNonfusionComputations(execution_threads)) {
+    // Skip Softmax CustomCall computations.
+    if (computation->IsCustomCallComputation() &&
+        IsSoftmaxCustomCall(*computation->CustomCallInstruction())) {
+      continue;
+    }
+    PriorityFusionImpl impl(computation, gpu_device_info_,
+                            shape_size_function_);
+    TF_ASSIGN_OR_RETURN(bool computation_changed, impl.Run());
+    changed |= computation_changed;
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,64 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_PRIORITY_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_PRIORITY_FUSION_H_
+
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// An HLO pass that merges fusion instructions greedily in order of the run
+// time savings predicted by GpuPerformanceModel.
+//
+// For every fusion it considers two kinds of candidates:
+// * Merging the fusion into all of its users, duplicating it if there is more
+//   than one user (as done by FusionMerger).
+// * Merging the fusion into a single user as a multi-output fusion, so that
+//   its other users read its result from the multi-output fusion (as done by
+//   the producer-consumer part of GpuMultiOutputFusion).
+//
+// All legal candidates are priced with the performance model and kept in a
+// priority queue. The candidate with the largest predicted savings is applied
+// first, after which the candidates of all affected fusions are re-evaluated.
+// Candidates predicted to be slower are never applied, and the usual fusion
+// budget checks prevent merges that would be too large to emit efficiently.
+//
+// Sibling multi-output fusion is left to GpuMultiOutputFusion.
+class GpuPriorityFusion : public HloModulePass {
+ public:
+  GpuPriorityFusion(const GpuDeviceInfo& d,
+                    HloCostAnalysis::ShapeSizeFunction f)
+      : gpu_device_info_(d), shape_size_function_(f) {}
+  absl::string_view name() const override { return "priority-fusion"; }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  const GpuDeviceInfo gpu_device_info_;
+  HloCostAnalysis::ShapeSizeFunction shape_size_function_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_PRIORITY_FUSION_H_
@@ -0,0 +1,116 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/priority_fusion.h"
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info_for_tests.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class PriorityFusionTest : public HloTestBase {
+  HloCostAnalysis::ShapeSizeFunction ShapeSizeBytesFunction() const {
+    return [&](const Shape& shape) {
+      constexpr int64_t kPointerSize = 8;
+      return ShapeUtil::ByteSizeOf(shape, kPointerSize);
+    };
+  }
+
+ public:
+  GpuPriorityFusion priority_fusion_{TestGpuDeviceInfo::RTXA6000DeviceInfo(),
+                                     ShapeSizeBytesFunction()};
+};
+
+TEST_F(PriorityFusionTest, MergeSharedFusionIntoAllUsers) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule MergeSharedFusion
+
+comp.2 {
+  p0 = (f32[4]{0}, f32[4]{0}, f32[4]{0}) parameter(0)
+  gte.1 = f32[4]{0} get-tuple-element(p0), index=1
+  gte.2 = f32[4]{0} get-tuple-element(p0), index=2
+  ROOT add = f32[4]{0} add(gte.1, gte.2)
+}
+
+comp.1 {
+  p1 = f32[4]{0} parameter(1)
+  p0 = f32[4]{0} parameter(0)
+  add = f32[4]{0} add(p1, p0)
+  ROOT multiply = f32[4]{0} multiply(add, p0)
+}
+
+comp {
+  p1 = f32[4]{0} parameter(1)
+  p0 = f32[4]{0} parameter(0)
+  multiply = f32[4]{0} multiply(p1, p0)
+  ROOT add = f32[4]{0} add(multiply, p0)
+}
+
+ENTRY entry {
+  constant = f32[4]{0} constant({1, 1, 1, 1})
+  param = (f32[4]{0}, f32[4]{0}, f32[4]{0}) parameter(0)
+  fusion.4 = f32[4]{0} fusion(param), kind=kLoop, calls=comp.2
+  fusion.5 = f32[4]{0} fusion(constant, fusion.4), kind=kLoop, calls=comp.1
+  fusion.6 = f32[4]{0} fusion(constant, fusion.4), kind=kLoop, calls=comp
+  ROOT tuple = (f32[4]{0}, f32[4]{0}) tuple(fusion.5, fusion.6)
+})")
+                    .value();
+  EXPECT_TRUE(priority_fusion_.Run(module.get()).value());
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Tuple(op::Fusion(op::Constant(), op::Parameter()),
+                              op::Fusion(op::Constant(), op::Parameter())));
+  EXPECT_EQ(7, root->operand(0)->fused_instruction_count());
+  EXPECT_EQ(7, root->operand(1)->fused_instruction_count());
+}
+
+TEST_F(PriorityFusionTest, DoNotMergeInputFusion) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule DoNotMergeInputFusion
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+reduce_comp {
+  p0 = f32[32,32]{1,0} parameter(0)
+  zero = f32[] constant(0)
+  ROOT reduce = f32[32]{0} reduce(p0, zero), dimensions={1}, to_apply=add
+}
+
+negate_comp {
+  p0 = f32[32]{0} parameter(0)
+  ROOT negate = f32[32]{0} negate(p0)
+}
+
+ENTRY entry {
+  p0 = f32[32,32]{1,0} parameter(0)
+  reduce = f32[32]{0} fusion(p0), kind=kInput, calls=reduce_comp
+  ROOT negate = f32[32]{0} fusion(reduce), kind=kLoop, calls=negate_comp
+})")
+                    .value();
+  EXPECT_FALSE(priority_fusion_.Run(module.get()).value());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -80,7 +80,47 @@ bool IsSupportedReductionComputation(HloComputation* computation) {
   return kSupportedOpcodes->contains(root->opcode());
 }
 
-bool MatchesSoftmaxPattern(HloInstruction* instr) {
+// Returns whether `hlo` is a constant, possibly broadcast.
+bool IsBroadcastedConstant(const HloInstruction* hlo) {
+  if (hlo->opcode() == HloOpcode::kBroadcast) {
+    hlo = hlo->operand(0);
+  }
+  return hlo->opcode() == HloOpcode::kConstant;
+}
+
+// Returns the operand of `hlo` if it is an unary elementwise op, or its
+// non-constant operand if it is a binary elementwise op with a constant
+// operand. Layer and RMS normalizations use such ops to turn the sums they
+// reduce into means, to add an epsilon and to take a reciprocal square root.
+// Returns nullptr for any other op.
+HloInstruction* NormalizationStatisticOperand(HloInstruction* hlo) {
+  if (!hlo->IsElementwise() || hlo->operand_count() == 0 ||
+      hlo->operand_count() > 2) {
+    return nullptr;
+  }
+  if (hlo->operand_count() == 1) {
+    return hlo->mutable_operand(0);
+  }
+  bool lhs_is_constant = IsBroadcastedConstant(hlo->operand(0));
+  bool rhs_is_constant = IsBroadcastedConstant(hlo->operand(1));
+  if (lhs_is_constant == rhs_is_constant) {
+    return nullptr;
+  }
+  return hlo->mutable_operand(lhs_is_constant ? 1 : 0);
+}
+
+// Returns whether `producer`, the operand of a reduce, is the square of
+// another value that the softmax pattern rooted at `root` is computed from, as
+// in the variance of a layer normalization or the mean square of an RMS
+// normalization.
+bool IsSquareOfPatternInput(const HloInstruction* root,
+                            const HloInstruction* producer) {
+  return producer->opcode() == HloOpcode::kMultiply &&
+         producer->operand(0) == producer->operand(1) &&
+         producer != root->operand(0);
+}
+
+bool MatchesSoftmaxPattern(HloInstruction* instr, bool match_normalizations) {
   // Match the following pattern:
   //
   // producer
@@ -99,6 +139,10 @@ bool MatchesSoftmaxPattern(HloInstruction* instr) {
   //
   // If any op between the producer and the root (both included) involves arrays
   // of complex numbers, the pattern does not match.
+  //
+  // With `match_normalizations`, the reduce can also be followed by ops that
+  // scale or shift it by constants, and its operand can be the square of the
+  // producer, so that the statistics of layer and RMS normalizations match.
 
   HloInstruction* root;
   HloInstruction* broadcast;
@@ -111,14 +155,19 @@ bool MatchesSoftmaxPattern(HloInstruction* instr) {
                                   .WithOneUse())
                  // The root operation should be an elementwise binary op of
                  // rank 2.
-                 .WithPredicate([](const HloInstruction* instr) {
-                   if (!instr->shape().IsArray()) return false;
+                 .WithPredicate([&](const HloInstruction* instr) {
+                   if (!instr->shape().IsArray() ||
+                       !instr->IsElementwiseBinary()) {
+                     return false;
+                   }
+                   // The row normalization emitter supports rows of any
+                   // size.
+                   if (match_normalizations) return true;
 
                    int64_t rank = instr->shape().rank();
-                   return instr->IsElementwiseBinary() &&
-                          // We rely on L1 cache for performance, and there are
-                          // 256 elements in L1 cache per warp.
-                          instr->shape().dimensions().back() <= 256 &&
+                   // We rely on L1 cache for performance, and there are 256
+                   // elements in L1 cache per warp.
+                   return instr->shape().dimensions().back() <= 256 &&
                           // If the product of the first dimensions is 1, it
                           // currently crashes the pipeline. Also, we expect
                           // that the performance is not so good if the
@@ -160,6 +209,16 @@ bool MatchesSoftmaxPattern(HloInstruction* instr) {
       has_major_to_minor_layout = false;
     }
   }
+  while (match_normalizations &&
+         reduce_or_unary->opcode() != HloOpcode::kReduce) {
+    reduce_or_unary = NormalizationStatisticOperand(reduce_or_unary);
+    if (reduce_or_unary == nullptr || reduce_or_unary->user_count() != 1) {
+      return false;
+    }
+    if (!HasDefaultLayout(reduce_or_unary->shape())) {
+      has_major_to_minor_layout = false;
+    }
+  }
 
   // The reduction should reduce the last dimension of the operand shape.
   if (reduce_or_unary->opcode() != HloOpcode::kReduce ||
@@ -206,6 +265,15 @@ bool MatchesSoftmaxPattern(HloInstruction* instr) {
     }
     producer = producer->mutable_operand(0);
   }
+  if (match_normalizations && IsSquareOfPatternInput(root, producer)) {
+    if (!HasDefaultLayout(producer->shape())) {
+      has_major_to_minor_layout = false;
+    }
+    if (producer->user_count() != 1) {
+      return false;
+    }
+    producer = producer->mutable_operand(0);
+  }
   if (!HasDefaultLayout(producer->shape())) {
     has_major_to_minor_layout = false;
   }
@@ -249,7 +317,8 @@ bool MatchesSoftmaxPattern(HloInstruction* instr) {
   return true;
 }
 
-HloInstruction* SoftmaxProducer(HloInstruction* softmax_root) {
+HloInstruction* SoftmaxProducer(HloInstruction* softmax_root,
+                                bool match_normalizations) {
   // The softmax producer is found by going up the chain
   // -> broadcast -> (reshape) -> reduce -> producer
   auto reduce_or_unary = softmax_root->mutable_operand(1)->mutable_operand(0);
@@ -258,12 +327,17 @@ HloInstruction* SoftmaxProducer(HloInstruction* softmax_root) {
     if (reduce_or_unary->opcode() == HloOpcode::kConvert) {
       has_convert_around_reduce = true;
     }
-    reduce_or_unary = reduce_or_unary->mutable_operand(0);
+    reduce_or_unary = reduce_or_unary->opcode() == HloOpcode::kReshape
+                          ? reduce_or_unary->mutable_operand(0)
+                          : NormalizationStatisticOperand(reduce_or_unary);
   }
   HloInstruction* producer = reduce_or_unary->mutable_operand(0);
   if (has_convert_around_reduce && producer->opcode() == HloOpcode::kConvert) {
     producer = producer->mutable_operand(0);
   }
+  if (match_normalizations && IsSquareOfPatternInput(softmax_root, producer)) {
+    producer = producer->mutable_operand(0);
+  }
   return producer;
 }
 
@@ -399,9 +473,10 @@ StatusOr<bool> SoftmaxFusion::Run(
       continue;
     }
     for (HloInstruction* instr : comp->MakeInstructionPostOrder()) {
-      if (MatchesSoftmaxPattern(instr)) {
+      if (MatchesSoftmaxPattern(instr, match_normalizations_)) {
         softmax_roots.push_back(instr);
-        softmax_producer_to_root_mapping[SoftmaxProducer(instr)] = instr;
+        softmax_producer_to_root_mapping[SoftmaxProducer(
+            instr, match_normalizations_)] = instr;
       }
     }
   }
@@ -463,7 +538,8 @@ StatusOr<bool> SoftmaxFusion::Run(
       merged_root = softmax_producer_to_root_mapping[current];
       processed_softmax_roots.insert(merged_root);
     }
-    HloInstruction* merged_producer = SoftmaxProducer(root);
+    HloInstruction* merged_producer =
+        SoftmaxProducer(root, match_normalizations_);
     TF_ASSIGN_OR_RETURN(bool replaced, TryReplaceSoftmaxWithCustomCall(
                                            merged_root, merged_producer));
     changed = changed || replaced;
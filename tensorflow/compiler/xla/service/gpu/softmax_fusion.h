@@ -24,9 +24,16 @@ limitations under the License.
 namespace xla::gpu {
 
 // Pass to match softmax patterns and replace them with custom calls.
+//
+// If `match_normalizations` is true, the pass also matches the patterns of
+// layer normalization and RMS normalization, whose reductions are scaled into
+// means, and possibly shifted by an epsilon and turned into reciprocal square
+// roots, before they are broadcast. These patterns are only supported by the
+// row normalization emitter of IrEmitterUnnested, not by the MLIR lowering.
 class SoftmaxFusion : public HloModulePass {
  public:
-  SoftmaxFusion() = default;
+  explicit SoftmaxFusion(bool match_normalizations = false)
+      : match_normalizations_(match_normalizations) {}
 
   absl::string_view name() const override { return "softmax_fusion"; }
 
@@ -34,6 +41,9 @@ class SoftmaxFusion : public HloModulePass {
   StatusOr<bool> Run(
       HloModule* module,
       const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  bool match_normalizations_;
 };
 
 }  // namespace xla::gpu
@@ -1118,6 +1118,95 @@ ENTRY main {
   EXPECT_TRUE(RunAndCompare(std::move(module), ErrorSpec(1e-6, 1e-6)));
 }
 
+constexpr char kRmsNormHlo[] = R"(
+HloModule rms_norm
+
+add_computation {
+  arg_0 = f32[] parameter(0)
+  arg_1 = f32[] parameter(1)
+  ROOT add = f32[] add(arg_0, arg_1)
+}
+
+ENTRY main {
+  param_0 = f32[256,128]{1,0} parameter(0)
+  square = f32[256,128]{1,0} multiply(param_0, param_0)
+  constant_zero = f32[] constant(0)
+  reduce = f32[256]{0} reduce(square, constant_zero), dimensions={1}, to_apply=add_computation
+  constant_size = f32[] constant(128)
+  broadcast_size = f32[256]{0} broadcast(constant_size), dimensions={}
+  mean_square = f32[256]{0} divide(reduce, broadcast_size)
+  constant_epsilon = f32[] constant(1e-6)
+  broadcast_epsilon = f32[256]{0} broadcast(constant_epsilon), dimensions={}
+  add = f32[256]{0} add(mean_square, broadcast_epsilon)
+  rsqrt = f32[256]{0} rsqrt(add)
+  broadcast = f32[256,128]{1,0} broadcast(rsqrt), dimensions={0}
+  ROOT multiply = f32[256,128]{1,0} multiply(param_0, broadcast)
+}
+)";
+
+TEST_F(SoftmaxFusionTest, RmsNormPatternIsNotMatchedByDefault) {
+  auto module = ParseAndReturnVerifiedModule(kRmsNormHlo).value();
+  SoftmaxFusion fusion;
+  EXPECT_FALSE(fusion.Run(module.get()).value());
+}
+
+TEST_F(SoftmaxFusionTest, RmsNormPattern) {
+  auto module = ParseAndReturnVerifiedModule(kRmsNormHlo).value();
+  SoftmaxFusion fusion(/*match_normalizations=*/true);
+  EXPECT_TRUE(fusion.Run(module.get()).value());
+  EXPECT_TRUE(verifier().Run(module.get()).status().ok());
+  VLOG(2) << module->ToString();
+  auto* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, GmockMatch(m::CustomCall(m::Parameter(0))));
+  ASSERT_THAT(root->to_apply()->root_instruction(),
+              GmockMatch(m::Multiply(m::Parameter(0),
+                                     m::Broadcast(m::Rsqrt(m::Add())))));
+}
+
+TEST_F(SoftmaxFusionTest, LayerNormPattern) {
+  const std::string& hlo_string = R"(
+HloModule layer_norm
+
+add_computation {
+  arg_0 = f32[] parameter(0)
+  arg_1 = f32[] parameter(1)
+  ROOT add = f32[] add(arg_0, arg_1)
+}
+
+ENTRY main {
+  param_0 = f32[128,512]{1,0} parameter(0)
+  constant_zero = f32[] constant(0)
+  reduce = f32[128]{0} reduce(param_0, constant_zero), dimensions={1}, to_apply=add_computation
+  constant_size = f32[] constant(512)
+  broadcast_size = f32[128]{0} broadcast(constant_size), dimensions={}
+  mean = f32[128]{0} divide(reduce, broadcast_size)
+  broadcast_mean = f32[128,512]{1,0} broadcast(mean), dimensions={0}
+  centered = f32[128,512]{1,0} subtract(param_0, broadcast_mean)
+  square = f32[128,512]{1,0} multiply(centered, centered)
+  second_reduce = f32[128]{0} reduce(square, constant_zero), dimensions={1}, to_apply=add_computation
+  variance = f32[128]{0} divide(second_reduce, broadcast_size)
+  constant_epsilon = f32[] constant(1e-5)
+  broadcast_epsilon = f32[128]{0} broadcast(constant_epsilon), dimensions={}
+  add = f32[128]{0} add(variance, broadcast_epsilon)
+  rsqrt = f32[128]{0} rsqrt(add)
+  broadcast = f32[128,512]{1,0} broadcast(rsqrt), dimensions={0}
+  ROOT multiply = f32[128,512]{1,0} multiply(centered, broadcast)
+}
+)";
+  auto module = ParseAndReturnVerifiedModule(hlo_string).value();
+  SoftmaxFusion fusion(/*match_normalizations=*/true);
+  EXPECT_TRUE(fusion.Run(module.get()).value());
+  EXPECT_TRUE(verifier().Run(module.get()).status().ok());
+  VLOG(2) << module->ToString();
+  auto* root = module->entry_computation()->root_instruction();
+  // Both patterns are fused into one custom call.
+  ASSERT_THAT(root, GmockMatch(m::CustomCall(m::Parameter(0))));
+  ASSERT_THAT(
+      root->to_apply()->root_instruction(),
+      GmockMatch(m::Multiply(m::Subtract(m::Parameter(0), m::Broadcast()),
+                             m::Broadcast(m::Rsqrt(m::Add())))));
+}
+
 class SoftmaxFusionEnd2EndTest
     : public HloTestBase,
       public ::testing::WithParamInterface<::testing::tuple<int, int>> {
@@ -0,0 +1,157 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+
+#include "tensorflow/compiler/xla/service/gpu/tests/gpu_codegen_test.h"
+#include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/tests/filecheck.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+class RowNormalizationTest : public GpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = GpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_gpu_enable_row_normalization_emitter(true);
+    return debug_options;
+  }
+};
+
+TEST_F(RowNormalizationTest, Softmax) {
+  const char* hlo_text = R"(
+HloModule Softmax
+
+max_computation {
+  arg_0 = f32[] parameter(0)
+  arg_1 = f32[] parameter(1)
+  ROOT maximum = f32[] maximum(arg_0, arg_1)
+}
+
+add_computation {
+  arg_0 = f32[] parameter(0)
+  arg_1 = f32[] parameter(1)
+  ROOT add = f32[] add(arg_0, arg_1)
+}
+
+ENTRY main {
+  param_0 = f32[64,1000] parameter(0)
+  constant_neg_inf = f32[] constant(-inf)
+  reduce = f32[64] reduce(param_0, constant_neg_inf), dimensions={1}, to_apply=max_computation
+  broadcast = f32[64,1000] broadcast(reduce), dimensions={0}
+  subtract = f32[64,1000] subtract(param_0, broadcast)
+  exponential = f32[64,1000] exponential(subtract)
+  constant_zero = f32[] constant(0)
+  second_reduce = f32[64] reduce(exponential, constant_zero), dimensions={1}, to_apply=add_computation
+  second_broadcast = f32[64,1000] broadcast(second_reduce), dimensions={0}
+  ROOT divide = f32[64,1000] divide(exponential, second_broadcast)
+}
+)";
+
+  CompileAndVerifyIr(hlo_text,
+                     R"(
+CHECK: cache_row
+CHECK: reduce_row
+CHECK: reduce_row
+CHECK: write_row
+)",
+                     /*match_optimized_ir=*/false);
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-5, 1e-5}));
+}
+
+TEST_F(RowNormalizationTest, LayerNorm) {
+  const char* hlo_text = R"(
+HloModule LayerNorm
+
+add_computation {
+  arg_0 = f32[] parameter(0)
+  arg_1 = f32[] parameter(1)
+  ROOT add = f32[] add(arg_0, arg_1)
+}
+
+ENTRY main {
+  param_0 = f32[16,4096] parameter(0)
+  constant_zero = f32[] constant(0)
+  sum = f32[16] reduce(param_0, constant_zero), dimensions={1}, to_apply=add_computation
+  constant_size = f32[] constant(4096)
+  broadcast_size = f32[16] broadcast(constant_size), dimensions={}
+  mean = f32[16] divide(sum, broadcast_size)
+  broadcast_mean = f32[16,4096] broadcast(mean), dimensions={0}
+  centered = f32[16,4096] subtract(param_0, broadcast_mean)
+  square = f32[16,4096] multiply(centered, centered)
+  square_sum = f32[16] reduce(square, constant_zero), dimensions={1}, to_apply=add_computation
+  variance = f32[16] divide(square_sum, broadcast_size)
+  constant_epsilon = f32[] constant(1e-5)
+  broadcast_epsilon = f32[16] broadcast(constant_epsilon), dimensions={}
+  shifted_variance = f32[16] add(variance, broadcast_epsilon)
+  inverse_stddev = f32[16] rsqrt(shifted_variance)
+  broadcast_inverse_stddev = f32[16,4096] broadcast(inverse_stddev), dimensions={0}
+  ROOT normalized = f32[16,4096] multiply(centered, broadcast_inverse_stddev)
+}
+)";
+
+  CompileAndVerifyIr(hlo_text,
+                     R"(
+CHECK: cache_row
+CHECK: reduce_row
+CHECK: reduce_row
+CHECK: write_row
+)",
+                     /*match_optimized_ir=*/false);
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-4, 1e-4}));
+}
+
+TEST_F(RowNormalizationTest, RmsNorm) {
+  const char* hlo_text = R"(
+HloModule RmsNorm
+
+add_computation {
+  arg_0 = f32[] parameter(0)
+  arg_1 = f32[] parameter(1)
+  ROOT add = f32[] add(arg_0, arg_1)
+}
+
+ENTRY main {
+  param_0 = f32[8,32,2048] parameter(0)
+  square = f32[8,32,2048] multiply(param_0, param_0)
+  constant_zero = f32[] constant(0)
+  square_sum = f32[8,32] reduce(square, constant_zero), dimensions={2}, to_apply=add_computation
+  constant_size = f32[] constant(2048)
+  broadcast_size = f32[8,32] broadcast(constant_size), dimensions={}
+  mean_square = f32[8,32] divide(square_sum, broadcast_size)
+  constant_epsilon = f32[] constant(1e-6)
+  broadcast_epsilon = f32[8,32] broadcast(constant_epsilon), dimensions={}
+  shifted_mean_square = f32[8,32] add(mean_square, broadcast_epsilon)
+  inverse_rms = f32[8,32] rsqrt(shifted_mean_square)
+  broadcast_inverse_rms = f32[8,32,2048] broadcast(inverse_rms), dimensions={0,1}
+  ROOT normalized = f32[8,32,2048] multiply(param_0, broadcast_inverse_rms)
+}
+)";
+
+  CompileAndVerifyIr(hlo_text,
+                     R"(
+CHECK: cache_row
+CHECK: reduce_row
+CHECK: write_row
+)",
+                     /*match_optimized_ir=*/false);
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-4, 1e-4}));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -70,6 +70,8 @@ Thunk::ExecuteParams::ExecuteParams(
       return "kFor";
     case Thunk::kGemm:
       return "kGemm";
+    case Thunk::kGraph:
+      return "kGraph";
     case Thunk::kInfeed:
       return "kInfeed";
     case Thunk::kKernel:
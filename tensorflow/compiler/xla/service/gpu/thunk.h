@@ -56,6 +56,7 @@ class Thunk {
     kFft,
     kFor,
     kGemm,
+    kGraph,
     kInfeed,
     kKernel,
     kMemset32BitValue,
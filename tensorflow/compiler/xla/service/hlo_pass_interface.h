@@ -140,6 +140,10 @@ class HloPassInterface {
       const absl::flat_hash_set<absl::string_view>& execution_threads) = 0;
 
   virtual bool IsPassPipeline() { return false; }
+
+  // Returns true if this is an HloComputationPass, which HloPassPipeline may
+  // run on several computations concurrently.
+  virtual bool IsComputationPass() { return false; }
 };
 
 // Base class for passes which are module-scoped.
@@ -167,6 +171,43 @@ class HloModulePass : public HloPassInterface {
   virtual void UpdateLayout(Shape* shape) {}
 };
 
+// Base class for passes which transform each non-fusion computation
+// independently of all others. When given a thread pool, HloPassPipeline runs
+// RunOnComputation on several computations of a module at the same time, so
+// implementations must follow this contract:
+//
+//   * Only `computation` and the instructions in it may be read and modified.
+//     Instructions may be added to and removed from `computation`, but
+//     computations may not be added to or removed from the module, and called
+//     computations (including fusion computations) may not be modified.
+//   * Module-wide state such as the config or the schedule may not be
+//     modified.
+//   * Any state of the pass itself that RunOnComputation mutates must be
+//     thread-safe.
+class HloComputationPass : public HloModulePass {
+ public:
+  // Runs the pass on `computation`. Returns whether it was changed.
+  virtual StatusOr<bool> RunOnComputation(HloComputation* computation) = 0;
+
+  // Runs the pass on the non-fusion computations with the specified
+  // `execution_threads` one after the other.
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(HloModule* module,
+                     const absl::flat_hash_set<absl::string_view>&
+                         execution_threads) override {
+    bool changed = false;
+    for (HloComputation* computation :
+         module->MakeNonfusionComputations(execution_threads)) {
+      TF_ASSIGN_OR_RETURN(bool computation_changed,
+                          RunOnComputation(computation));
+      changed |= computation_changed;
+    }
+    return changed;
+  }
+
+  bool IsComputationPass() override { return true; }
+};
+
 // Base class for passes which are module-group scoped. These passes cannot run
 // on an HLO module.
 class HloModuleGroupPass : public HloPassInterface {
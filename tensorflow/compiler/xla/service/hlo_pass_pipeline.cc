@@ -15,8 +15,14 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 
+#include <cstdio>
 #include <functional>
 #include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -28,6 +34,10 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/lib/monitoring/counter.h"
+#include "tensorflow/tsl/lib/monitoring/sampler.h"
+#include "tensorflow/tsl/platform/blocking_counter.h"
+#include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/logging.h"
 #include "tensorflow/tsl/platform/status.h"
@@ -36,6 +46,97 @@ namespace xla {
 
 namespace {
 
+auto* pass_duration_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/xla/service/hlo_pass/duration_usecs",
+     "The wall-clock time spent in each run of an HLO pass in microseconds.",
+     "pass"},
+    // Minimum: 1 us, maximum: 1 us * 2 ^ 34 == ~4.8 hours.
+    {tsl::monitoring::Buckets::Exponential(1, 2, 35)});
+
+auto* pathological_pass_runs = tsl::monitoring::Counter<2>::New(
+    "/xla/service/hlo_pass/pathological_runs",
+    "The number of HLO pass runs that took unusually long or that blew up the "
+    "size of the module.",
+    "pass", "reason");
+
+// Passes growing a module of at least kMinInstructionsForBlowup instructions
+// by kInstructionBlowupFactor or more are reported as pathological.
+constexpr int64_t kMinInstructionsForBlowup = 10000;
+constexpr int64_t kInstructionBlowupFactor = 2;
+
+// Resource usage of one run of a pass, recorded in its HloPassMetadata.
+struct PassProfile {
+  int64_t instruction_count_before = 0;
+  int64_t instruction_count_after = 0;
+  int64_t rss_bytes_before = 0;
+  int64_t rss_bytes_after = 0;
+};
+
+// Returns the resident set size of this process in bytes, or 0 if it is not
+// known.
+int64_t GetCurrentRssBytes() {
+#if defined(__linux__)
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (statm == nullptr) {
+    return 0;
+  }
+  long long size_pages = 0;      // NOLINT(runtime/int)
+  long long resident_pages = 0;  // NOLINT(runtime/int)
+  const int matched = fscanf(statm, "%lld %lld", &size_pages, &resident_pages);
+  fclose(statm);
+  if (matched != 2) {
+    return 0;
+  }
+  return static_cast<int64_t>(resident_pages) * sysconf(_SC_PAGESIZE);
+#else
+  return 0;
+#endif
+}
+
+int64_t InstructionCount(const HloModule& module) {
+  return module.instruction_count();
+}
+
+int64_t InstructionCount(const HloModuleGroup& module_group) {
+  int64_t count = 0;
+  for (const HloModule* module : module_group.modules()) {
+    count += module->instruction_count();
+  }
+  return count;
+}
+
+// Exports a run of `pass_name` as metrics, and warns about it if it took
+// longer than `slow_pass_threshold_ms` (if positive) or blew up the module.
+void ReportPassRun(absl::string_view pass_name, int64_t duration_usecs,
+                   const PassProfile& profile,
+                   int64_t slow_pass_threshold_ms) {
+  pass_duration_usecs->GetCell(std::string(pass_name))->Add(duration_usecs);
+  const bool slow = slow_pass_threshold_ms > 0 &&
+                    duration_usecs >= slow_pass_threshold_ms * 1000;
+  const bool blowup =
+      profile.instruction_count_after >= kMinInstructionsForBlowup &&
+      profile.instruction_count_after >=
+          kInstructionBlowupFactor * profile.instruction_count_before;
+  if (!slow && !blowup) {
+    return;
+  }
+  if (slow) {
+    pathological_pass_runs->GetCell(std::string(pass_name), "slow")
+        ->IncrementBy(1);
+  }
+  if (blowup) {
+    pathological_pass_runs->GetCell(std::string(pass_name), "blowup")
+        ->IncrementBy(1);
+  }
+  LOG(WARNING) << "HLO pass " << pass_name << " took "
+               << duration_usecs / 1000 << " ms, changed the number of "
+               << "instructions from " << profile.instruction_count_before
+               << " to " << profile.instruction_count_after
+               << " and the resident set size from "
+               << profile.rss_bytes_before << " to " << profile.rss_bytes_after
+               << " bytes.";
+}
+
 void RecordPassStartMetadata(HloModule& module, const std::string& pass_name,
                              const std::string& pipeline_name) {
   module.metadata()->RecordPassStart();
@@ -54,21 +155,26 @@ void RecordPassStartMetadata(HloModuleGroup& module_group,
 
 Status AttemptRecordPassEndMetadata(HloModule& module,
                                     const std::string& pass_name,
-                                    bool module_changed) {
+                                    bool module_changed,
+                                    const PassProfile& profile) {
   // Module id is set here instead of RecordPassStartMetadata because it may
   // change in the middle of the pass, and we want the final id.
   TF_RETURN_IF_ERROR(
       module.metadata()->set_current_pass_module_id(module.unique_id()));
   TF_RETURN_IF_ERROR(
       module.metadata()->set_current_pass_module_changed(module_changed));
+  TF_RETURN_IF_ERROR(module.metadata()->set_current_pass_instruction_counts(
+      profile.instruction_count_before, profile.instruction_count_after));
+  TF_RETURN_IF_ERROR(module.metadata()->set_current_pass_rss_bytes(
+      profile.rss_bytes_before, profile.rss_bytes_after));
   TF_RETURN_IF_ERROR(module.metadata()->RecordPassEnd());
   return OkStatus();
 }
 
 void RecordPassEndMetadata(HloModule& module, const std::string& pass_name,
-                           bool module_changed) {
+                           bool module_changed, const PassProfile& profile) {
   Status status =
-      AttemptRecordPassEndMetadata(module, pass_name, module_changed);
+      AttemptRecordPassEndMetadata(module, pass_name, module_changed, profile);
   if (!status.ok()) {
     LOG(FATAL) << status;
   }
@@ -76,23 +182,25 @@ void RecordPassEndMetadata(HloModule& module, const std::string& pass_name,
 
 Status AttemptRecordPassEndMetadata(HloModuleGroup& module_group,
                                     const std::string& pass_name,
-                                    bool module_changed) {
+                                    bool module_changed,
+                                    const PassProfile& profile) {
   for (HloModule* module : module_group.modules()) {
     for (HloModule* other_module : module_group.modules()) {
       TF_RETURN_IF_ERROR(
           module->metadata()->add_current_pass_module_group_module_id(
               other_module->unique_id()));
     }
-    TF_RETURN_IF_ERROR(
-        AttemptRecordPassEndMetadata(*module, pass_name, module_changed));
+    TF_RETURN_IF_ERROR(AttemptRecordPassEndMetadata(*module, pass_name,
+                                                    module_changed, profile));
   }
   return OkStatus();
 }
 
 void RecordPassEndMetadata(HloModuleGroup& module_group,
-                           const std::string& pass_name, bool module_changed) {
-  Status status =
-      AttemptRecordPassEndMetadata(module_group, pass_name, module_changed);
+                           const std::string& pass_name, bool module_changed,
+                           const PassProfile& profile) {
+  Status status = AttemptRecordPassEndMetadata(module_group, pass_name,
+                                               module_changed, profile);
   if (!status.ok()) {
     LOG(FATAL) << status;
   }
@@ -154,6 +262,8 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
   // Copy string by value since debug options could get clobbered in an hlo
   // module group pass.
   std::string dump_regex = debug_options.xla_dump_hlo_pass_re();
+  const int64_t slow_pass_threshold_ms =
+      debug_options.xla_slow_hlo_pass_threshold_ms();
   static constexpr absl::string_view kPipelineStart = "pipeline-start";
   static constexpr absl::string_view kPipelineEnd = "pipeline-end";
   std::string pipeline_name = std::string(name());
@@ -167,8 +277,13 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
                                /*before_pass_name=*/passes.empty()
                                    ? kPipelineEnd
                                    : passes.front()->name());
-  RecordPassEndMetadata(*hlo, std::string(kPipelineStart),
-                        /*module_changed=*/false);
+  const int64_t start_instruction_count = InstructionCount(*hlo);
+  const int64_t start_rss_bytes = GetCurrentRssBytes();
+  RecordPassEndMetadata(
+      *hlo, std::string(kPipelineStart),
+      /*module_changed=*/false,
+      PassProfile{start_instruction_count, start_instruction_count,
+                  start_rss_bytes, start_rss_bytes});
 
   bool changed = false;
   for (int i = 0; i < passes.size(); i++) {
@@ -181,6 +296,10 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
       compilation_stats_->StartPass(pass_name);
     }
     RecordPassStartMetadata(*hlo, pass_name, pipeline_name);
+    PassProfile profile;
+    profile.instruction_count_before = InstructionCount(*hlo);
+    profile.rss_bytes_before = GetCurrentRssBytes();
+    const uint64_t start_usecs = tsl::Env::Default()->NowMicros();
     // Embed RunHelper into lambda to enable recording of error statuses
     auto run_helper_lambda =
         [this, pass_name](
@@ -195,6 +314,15 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
         };
     TF_ASSIGN_OR_RETURN(bool pass_changed,
                         run_helper_lambda(pass, hlo, execution_threads));
+    const uint64_t duration_usecs =
+        tsl::Env::Default()->NowMicros() - start_usecs;
+    profile.instruction_count_after = InstructionCount(*hlo);
+    profile.rss_bytes_after = GetCurrentRssBytes();
+    // Nested pipelines report the passes they run themselves.
+    if (!pass->IsPassPipeline()) {
+      ReportPassRun(pass_name, duration_usecs, profile,
+                    slow_pass_threshold_ms);
+    }
     SetInstructionMetadata(*hlo);
     if (!dump_regex.empty() && (pass_changed || dump_regex != ".*")) {
       MaybeDumpHloAndSaveFilenames(*hlo,
@@ -203,7 +331,7 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
                                        ? kPipelineEnd
                                        : passes[i + 1]->name());
     }
-    RecordPassEndMetadata(*hlo, pass_name, pass_changed);
+    RecordPassEndMetadata(*hlo, pass_name, pass_changed, profile);
     changed |= pass_changed;
     if (pass_changed) {
       VLOG(3) << "  Pass caused changes " << pass->name();
@@ -226,6 +354,35 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
   return changed;
 }
 
+StatusOr<bool> HloPassPipeline::RunComputationPassConcurrently(
+    HloComputationPass* pass, HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  std::vector<HloComputation*> computations =
+      module->MakeNonfusionComputations(execution_threads);
+  if (computations.size() <= 1) {
+    return pass->Run(module, execution_threads);
+  }
+  VLOG(2) << "  Running " << pass->name() << " on " << computations.size()
+          << " computations concurrently";
+
+  std::vector<StatusOr<bool>> results(computations.size(), false);
+  tsl::BlockingCounter counter(computations.size());
+  for (int64_t i = 0; i < computations.size(); ++i) {
+    thread_pool_->Schedule([&, i] {
+      results[i] = pass->RunOnComputation(computations[i]);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  bool changed = false;
+  for (StatusOr<bool>& result : results) {
+    TF_ASSIGN_OR_RETURN(bool computation_changed, std::move(result));
+    changed |= computation_changed;
+  }
+  return changed;
+}
+
 std::vector<HloPassInterface*> HloPassPipeline::GetEnabledPasses(
     const DebugOptions& debug_options) {
   if (debug_options.xla_disable_all_hlo_passes()) {
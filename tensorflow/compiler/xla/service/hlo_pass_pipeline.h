@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace xla {
 
@@ -89,6 +90,14 @@ class HloPassPipeline : public HloPassInterface {
 
   bool IsPassPipeline() override { return true; }
 
+  // Sets the thread pool on which HloComputationPasses of this pipeline (and
+  // of nested pipelines that don't have a thread pool of their own) run on the
+  // computations of a module concurrently. Null, the default, runs them on one
+  // computation after the other.
+  void set_thread_pool(tsl::thread::ThreadPool* thread_pool) {
+    thread_pool_ = thread_pool;
+  }
+
   // Return size of passes_.
   int PassesSize() { return passes_.size(); }
   // Return reference to pass specified by index.
@@ -134,26 +143,52 @@ class HloPassPipeline : public HloPassInterface {
   // empty thread list means all `execution_threads` are considered. These
   // helpers enable templating of the core of the pipeline logic by providing
   // HloModule and HloModuleGroup specific methods with the same name.
-  static StatusOr<bool> RunHelper(
+  StatusOr<bool> RunHelper(
       HloPassInterface* pass, HloModule* module,
       const absl::flat_hash_set<absl::string_view>& execution_threads) {
-    TF_ASSIGN_OR_RETURN(bool changed, pass->Run(module, execution_threads));
+    PropagateThreadPool(pass);
+    TF_ASSIGN_OR_RETURN(
+        bool changed,
+        thread_pool_ != nullptr && pass->IsComputationPass()
+            ? RunComputationPassConcurrently(
+                  static_cast<HloComputationPass*>(pass), module,
+                  execution_threads)
+            : pass->Run(module, execution_threads));
     module->Cleanup();
     return changed;
   }
-  static StatusOr<bool> RunHelper(
+  StatusOr<bool> RunHelper(
       HloPassInterface* pass, HloModuleGroup* module_group,
       const absl::flat_hash_set<absl::string_view>& execution_threads) {
+    PropagateThreadPool(pass);
     TF_ASSIGN_OR_RETURN(
         bool changed, pass->RunOnModuleGroup(module_group, execution_threads));
     module_group->Cleanup();
     return changed;
   }
 
+  // Runs `pass` on the non-fusion computations of `module` with the specified
+  // `execution_threads` on thread_pool_.
+  StatusOr<bool> RunComputationPassConcurrently(
+      HloComputationPass* pass, HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads);
+
+  // Hands thread_pool_ down to `pass` if it is a pipeline without a thread
+  // pool of its own.
+  void PropagateThreadPool(HloPassInterface* pass) {
+    if (thread_pool_ != nullptr && pass->IsPassPipeline()) {
+      auto* pipeline = static_cast<HloPassPipeline*>(pass);
+      if (pipeline->thread_pool_ == nullptr) {
+        pipeline->thread_pool_ = thread_pool_;
+      }
+    }
+  }
+
   const std::string name_;
   std::vector<std::unique_ptr<HloPassInterface>> passes_;
   std::vector<std::unique_ptr<HloPassInterface>> invariant_checkers_;
   bool run_called_ = false;
+  tsl::thread::ThreadPool* thread_pool_ = nullptr;
 
   CompilationStats* compilation_stats_;
   // Default stats instance for when one is not passed in the constructor.
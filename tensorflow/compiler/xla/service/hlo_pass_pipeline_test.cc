@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
@@ -22,6 +26,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace xla {
 namespace {
@@ -112,6 +118,19 @@ class BazToQuxModuleGroupPass : public HloModuleGroupPass {
   }
 };
 
+// A computation pass which negates the root of every computation.
+class NegateRootComputationPass : public HloComputationPass {
+  absl::string_view name() const override { return "negate-root"; }
+
+  StatusOr<bool> RunOnComputation(HloComputation* computation) override {
+    HloInstruction* root = computation->root_instruction();
+    computation->set_root_instruction(
+        computation->AddInstruction(HloInstruction::CreateUnary(
+            root->shape(), HloOpcode::kNegate, root)));
+    return true;
+  }
+};
+
 // An invariant checker pass which returns an error if there exists an
 // instruction named 'bar'.
 class BarBlowerUpper : public HloModulePass {
@@ -289,6 +308,53 @@ ENTRY main {
   EXPECT_EQ(root1->name(), "bar");
 }
 
+TEST_F(HloPassPipelineTest, ComputationPassRunsOnThreadPool) {
+  const std::string module_str = R"(
+HloModule ComputationPassRunsOnThreadPool
+
+f {
+  p = f32[] parameter(0)
+  ROOT m = f32[] multiply(p, p)
+}
+
+g {
+  p = f32[] parameter(0)
+  ROOT a = f32[] add(p, p)
+}
+
+ENTRY main {
+  a = f32[] parameter(0)
+  c0 = f32[] call(a), to_apply=f
+  c1 = f32[] call(a), to_apply=g
+  ROOT s = f32[] subtract(c0, c1)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_str));
+
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "test",
+                                      /*num_threads=*/4);
+  HloPassPipeline pipeline(TestName());
+  pipeline.set_thread_pool(&thread_pool);
+  // The thread pool is handed down to nested pipelines.
+  pipeline.AddPass<HloPassPipeline>("nested")
+      .AddPass<NegateRootComputationPass>();
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pipeline.Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  // Instructions added concurrently still get unique names and ids.
+  absl::flat_hash_set<int> unique_ids;
+  absl::flat_hash_set<std::string> root_names;
+  for (HloComputation* computation : module->computations()) {
+    HloInstruction* root = computation->root_instruction();
+    EXPECT_EQ(root->opcode(), HloOpcode::kNegate);
+    EXPECT_TRUE(root_names.insert(root->name()).second);
+    for (HloInstruction* instruction : computation->instructions()) {
+      EXPECT_TRUE(unique_ids.insert(instruction->unique_id()).second);
+    }
+  }
+}
+
 TEST_F(HloPassPipelineTest, InvariantChecker) {
   const std::string module_str = R"(
 HloModule InvariantChecker
@@ -401,5 +467,37 @@ TEST_F(HloPassPipelineTest, SetHloModuleMetadata) {
   }
 }
 
+TEST_F(HloPassPipelineTest, RecordsInstructionCountsInHloModuleMetadata) {
+  const std::string module_str = R"(
+HloModule RecordsInstructionCounts
+
+ENTRY main {
+  a = f32[] parameter(0)
+  ROOT foo = f32[] negate(a)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_str));
+
+  HloPassPipeline pipeline(TestName());
+  pipeline.AddPass<NegateRootComputationPass>();
+  pipeline.AddPass<FooToBarModulePass>();
+  TF_ASSERT_OK(pipeline.Run(module.get()).status());
+
+  const HloModuleMetadataProto& metadata = module->metadata().proto();
+  ASSERT_THAT(metadata.pass_metadata(), SizeIs(3));
+  const HloPassMetadata& negate_root = metadata.pass_metadata(1);
+  EXPECT_THAT(negate_root.pass_name(), StrEq("negate-root"));
+  EXPECT_EQ(negate_root.instruction_count_before(), 2);
+  EXPECT_EQ(negate_root.instruction_count_after(), 3);
+  const HloPassMetadata& foo_to_bar = metadata.pass_metadata(2);
+  EXPECT_EQ(foo_to_bar.instruction_count_before(), 3);
+  EXPECT_EQ(foo_to_bar.instruction_count_after(), 3);
+#if defined(__linux__)
+  EXPECT_GT(foo_to_bar.rss_bytes_before(), 0);
+  EXPECT_GT(foo_to_bar.rss_bytes_after(), 0);
+#endif
+}
+
 }  // namespace
 }  // namespace xla
@@ -155,6 +155,11 @@ struct Item {
 
   bool is_skip_node = false;
 
+  // The instruction of the original program that 'instruction' is a
+  // rematerialization of, or nullptr if it isn't a rematerialization. Used to
+  // look up recompute costs, which are only known for the original program.
+  const HloInstruction* rematerialized_from = nullptr;
+
  private:
   friend class InstructionList;
 
@@ -502,7 +507,9 @@ class MemoryUsageTracker {
       const HloRematerialization::CompactShapeFunction& compact_shape_function,
       const TuplePointsToAnalysis& points_to_analysis,
       const InstructionList& instruction_list,
-      HloRematerialization::RematerializationMode mode);
+      HloRematerialization::RematerializationMode mode,
+      const HloRematerialization::RecomputeCostFunction&
+          recompute_cost_function);
 
   // Starts the placement of the given instruction. This adds the sizes of the
   // LogicalBuffers defined by the instruction to the current memory
@@ -512,9 +519,9 @@ class MemoryUsageTracker {
   // EndInstruction memory for dead operand(s) is freed.
   Status BeginInstruction(Item* item);
 
-  int64_t RematerializationCost(const std::vector<Item*>& items,
-                                int64_t memory_reduced,
-                                int64_t memory_limit_bytes) {
+  double RematerializationCost(const std::vector<Item*>& items,
+                               int64_t memory_reduced,
+                               int64_t memory_limit_bytes) {
     // If none of the users of any 'item' have been placed in the
     // sequence (as tracked by memory_tracker), then rematerialization of
     // 'item' is a zero-cost move of 'item->instruction' in the sequence.
@@ -533,6 +540,16 @@ class MemoryUsageTracker {
     }
 
     CHECK_GT(memory_reduced, 0);
+    if (recompute_cost_function_) {
+      // Return the cost of recomputing the block per byte saved.
+      double recompute_cost = 0;
+      for (auto* item : items) {
+        recompute_cost += recompute_cost_function_(
+            item->rematerialized_from != nullptr ? item->rematerialized_from
+                                                 : item->instruction);
+      }
+      return recompute_cost / memory_reduced;
+    }
     // Return the inverse of the benefit of rematerialization.
     return memory_limit_bytes / memory_reduced;
   }
@@ -787,6 +804,10 @@ class MemoryUsageTracker {
   Item* in_progress_item_ = nullptr;
 
   HloRematerialization::RematerializationMode mode_;
+
+  // Returns the cost of recomputing an instruction. May be empty.
+  const HloRematerialization::RecomputeCostFunction& recompute_cost_function_;
+
   // All buffers in the computation.
   std::vector<Buffer> buffers_;
 };
@@ -797,12 +818,14 @@ MemoryUsageTracker::MemoryUsageTracker(
     const HloRematerialization::CompactShapeFunction& compact_shape_function,
     const TuplePointsToAnalysis& points_to_analysis,
     const InstructionList& instruction_list,
-    HloRematerialization::RematerializationMode mode)
+    HloRematerialization::RematerializationMode mode,
+    const HloRematerialization::RecomputeCostFunction& recompute_cost_function)
     : computation_(computation),
       instruction_list_(instruction_list),
       size_function_(size_function),
       compact_shape_function_(compact_shape_function),
-      mode_(mode) {
+      mode_(mode),
+      recompute_cost_function_(recompute_cost_function) {
   PointsToSet::BufferSet live_out_set =
       points_to_analysis.GetPointsToSet(computation_->root_instruction())
           .CreateFlattenedSet();
@@ -1390,7 +1413,7 @@ MemoryUsageTracker::PickRematerializationCandidates(
     absl::flat_hash_map<const HloInstruction*, bool>* rematerializable_map,
     int min_block_size, int max_block_size, int64_t peak_memory_bytes) {
   std::vector<Item*> best_items;
-  int64_t best_cost = 0;
+  double best_cost = 0;
   RematStrategy best_strategy;
 
   int effort = 0;
@@ -1443,7 +1466,7 @@ MemoryUsageTracker::PickRematerializationCandidates(
               effort++;
               if (memory_reduced > 0 &&
                   size + reduced_size < peak_memory_bytes) {
-                const int64_t cost = memory_limit_bytes / memory_reduced;
+                const double cost = memory_limit_bytes / memory_reduced;
                 if (best_items.empty() || cost < best_cost) {
                   VLOG(3) << "candidate " << candidate->name() << "("
                           << candidate->ToShortString() << ")"
@@ -1491,7 +1514,7 @@ MemoryUsageTracker::PickRematerializationCandidates(
       const int64_t memory_reduced = MemoryReducedIfRematerialized(block);
       effort++;
       if (memory_reduced > 0) {
-        const int cost =
+        const double cost =
             RematerializationCost(block, memory_reduced, memory_limit_bytes);
 
         VLOG(5) << "Candidate block of size " << block.size()
@@ -1587,6 +1610,9 @@ StatusOr<int64_t> RematerializeInstructions(
     }
 
     Item* remat_item = instruction_list->CreateItem(remat);
+    remat_item->rematerialized_from = best_item->rematerialized_from != nullptr
+                                          ? best_item->rematerialized_from
+                                          : best;
 
     // Replace each remaining use of 'best' with the rematerialization.
     absl::InlinedVector<Item*, 4> indirect_users;
@@ -1847,7 +1873,7 @@ StatusOr<int64_t> HloRematerialization::ComputePeakMemory(
   InstructionList instruction_list(order);
   MemoryUsageTracker tracker(computation, size_function_,
                              compact_shape_function_, *points_to_analysis_,
-                             instruction_list, mode_);
+                             instruction_list, mode_, recompute_cost_function_);
   int64_t peak_memory = tracker.memory_usage();
   for (auto* item = instruction_list.first(); item != nullptr;
        item = instruction_list.next(item)) {
@@ -1904,7 +1930,7 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
   InstructionList instruction_list(schedule->sequence(computation));
   MemoryUsageTracker memory_tracker(
       computation, size_function_, compact_shape_function_,
-      *points_to_analysis_, instruction_list, mode_);
+      *points_to_analysis_, instruction_list, mode_, recompute_cost_function_);
 
   instruction_list.PromoteNodesToSkip([&](Item* item) {
     return memory_tracker.AllocatedSize(item) >= min_remat_size;
@@ -43,6 +43,10 @@ class HloRematerialization : public HloModulePass {
 
   using CompactShapeFunction = std::function<StatusOr<Shape>(const Shape&)>;
 
+  // Returns the cost, e.g. the estimated run time, of recomputing the given
+  // instruction.
+  using RecomputeCostFunction = std::function<double(const HloInstruction*)>;
+
   // Helper struct that communicates the before / after sizes for the
   // rematerialization process.
   struct RematerializationSizes {
@@ -81,13 +85,20 @@ class HloRematerialization : public HloModulePass {
   //
   //   compact_shape_function: Function which returns the compact form of a
   //   shape. If nullptr is provided, an default identity function is used.
+  //
+  //   recompute_cost_function: Function which returns the cost of recomputing
+  //     an instruction. If provided, blocks are recomputed in order of their
+  //     recompute cost per byte of memory saved rather than of the bytes
+  //     saved only. Recompute costs aren't comparable to the cost of
+  //     compression, so this is meant to be used with kRecomputeOnly.
   explicit HloRematerialization(
       const ShapeSizeFunction& size_function, int64_t memory_limit_bytes,
       RematerializationSizes* sizes, RematerializationPass pass_location,
       int block_size_limit, int block_rematerialization_factor,
       CompactShapeFunction compact_shape_function = nullptr,
       RematerializationMode mode = RematerializationMode::kRecomputeAndCompress,
-      int64_t min_remat_size = 0)
+      int64_t min_remat_size = 0,
+      RecomputeCostFunction recompute_cost_function = nullptr)
       : size_function_(size_function),
         memory_limit_bytes_(memory_limit_bytes),
         sizes_(sizes),
@@ -98,7 +109,8 @@ class HloRematerialization : public HloModulePass {
                                     ? DefaultCompactShapeFunction
                                     : std::move(compact_shape_function)),
         mode_(mode),
-        min_remat_size_(min_remat_size) {}
+        min_remat_size_(min_remat_size),
+        recompute_cost_function_(std::move(recompute_cost_function)) {}
   ~HloRematerialization() override = default;
 
   absl::string_view name() const override { return "rematerialization"; }
@@ -225,6 +237,10 @@ class HloRematerialization : public HloModulePass {
 
   int64_t min_remat_size_;
 
+  // Returns the cost of recomputing an instruction, or nullptr to rank
+  // candidates by the memory they save only.
+  const RecomputeCostFunction recompute_cost_function_;
+
   // Tracking available channel id numbers to use to apply to rematerialized
   // channel instructions
   int64_t next_channel_id_;
@@ -1197,6 +1197,52 @@ ENTRY %entry {
                       op::Fusion(AllOf(op::Fusion(), ::testing::Ne(fusion0)))));
 }
 
+TEST_F(HloRematerializationTest, RecomputeCostFunction) {
+  const std::string& hlo_string = R"(
+HloModule recompute_cost, is_scheduled=true
+
+ENTRY %entry {
+  %param = f32[] parameter(0)
+  %expensive = f32[1024]{0} broadcast(f32[] %param), dimensions={}
+  %cheap = f32[1024]{0} broadcast(f32[] %param), dimensions={}
+  %add.0 = f32[1024]{0} add(f32[1024]{0} %expensive, f32[1024]{0} %cheap)
+  %big = f32[4096]{0} broadcast(f32[] %param), dimensions={}
+  %slice = f32[1024]{0} slice(f32[4096]{0} %big), slice={[0:1024]}
+  %add.1 = f32[1024]{0} add(f32[1024]{0} %expensive, f32[1024]{0} %slice)
+  %add.2 = f32[1024]{0} add(f32[1024]{0} %cheap, f32[1024]{0} %add.1)
+  ROOT %add.3 = f32[1024]{0} add(f32[1024]{0} %add.0, f32[1024]{0} %add.2)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  const HloComputation* computation = module->entry_computation();
+  const HloInstruction* expensive =
+      computation->GetInstructionWithName("expensive");
+  const HloInstruction* cheap = computation->GetInstructionWithName("cheap");
+
+  // Rematerializing either broadcast reduces the peak memory of 32KB at the
+  // slice by the same 4KB, which is enough to fit in the 30KB left once the
+  // output is subtracted. Only the cost function tells them apart.
+  HloRematerialization remat(
+      ByteSizeOf, /*memory_limit_bytes=*/34 * 1024, /*sizes=*/nullptr,
+      HloRematerialization::RematerializationPass::kPreFusion,
+      /*block_size_limit=*/1, /*block_rematerialization_factor=*/1, nullptr,
+      HloRematerialization::RematerializationMode::kRecomputeOnly,
+      /*min_remat_size=*/0,
+      /*recompute_cost_function=*/[&](const HloInstruction* instruction) {
+        return instruction == cheap ? 1.0 : 10.0;
+      });
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, remat.Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  const HloInstruction* add_1 = computation->GetInstructionWithName("add.1");
+  const HloInstruction* add_2 = computation->GetInstructionWithName("add.2");
+  EXPECT_EQ(add_1->operand(0), expensive);
+  EXPECT_THAT(add_2->operand(0),
+              AllOf(op::Broadcast(op::Parameter()), ::testing::Ne(cheap)));
+}
+
 }  // namespace
 
 }  // namespace xla
@@ -56,7 +56,8 @@ namespace xla {
 namespace {
 struct CanonicalAsyncOp {
   HloOpcode outer;  // kAsyncStart or kAsyncDone
-  HloOpcode inner;  // kAllReduce, kAllGather, kAllToAll, kCollectivePermute
+  HloOpcode inner;  // kAllReduce, kAllGather, kAllToAll, kCollectivePermute,
+                    // or kCopy
 };
 
 CanonicalAsyncOp GetCanonicalAsyncOp(const HloInstruction& hlo) {
@@ -76,6 +77,10 @@ CanonicalAsyncOp GetCanonicalAsyncOp(const HloInstruction& hlo) {
       return {HloOpcode::kAsyncDone, HloOpcode::kAllGather};
     case HloOpcode::kCollectivePermuteDone:
       return {HloOpcode::kAsyncDone, HloOpcode::kCollectivePermute};
+    case HloOpcode::kCopyStart:
+      return {HloOpcode::kAsyncStart, HloOpcode::kCopy};
+    case HloOpcode::kCopyDone:
+      return {HloOpcode::kAsyncDone, HloOpcode::kCopy};
     default:
       return {hlo.opcode(), hlo.opcode()};
   }
@@ -130,6 +135,8 @@ bool AsyncTracker::IsSupportedAsyncDone(const HloInstruction& hlo) const {
       case HloOpcode::kAllReduce:
       case HloOpcode::kCollectivePermute:
         return true;
+      case HloOpcode::kCopy:
+        return config_.schedule_copies;
       default:
         return false;
     }
@@ -151,6 +158,8 @@ bool AsyncTracker::IsSupportedAsyncStart(const HloInstruction& hlo) const {
       case HloOpcode::kAllReduce:
       case HloOpcode::kCollectivePermute:
         return true;
+      case HloOpcode::kCopy:
+        return config_.schedule_copies;
       default:
         return false;
     }
@@ -161,7 +170,7 @@ bool AsyncTracker::IsSupportedAsyncStart(const HloInstruction& hlo) const {
 ResourcesVector AsyncTracker::GetResourcesFromInstruction(
     const HloInstruction& hlo) const {
   CanonicalAsyncOp op = GetCanonicalAsyncOp(hlo);
-  auto get_resource_for_op = [](HloOpcode op) -> ResourceType {
+  auto get_resource_for_op = [this](HloOpcode op) -> ResourceType {
     switch (op) {
       case HloOpcode::kAllReduce:
         return ResourceType::kAllReduce;
@@ -171,6 +180,9 @@ ResourcesVector AsyncTracker::GetResourcesFromInstruction(
         return ResourceType::kAllToAll;
       case HloOpcode::kCollectivePermute:
         return ResourceType::kCollectivePermute;
+      case HloOpcode::kCopy:
+        return config_.schedule_copies ? ResourceType::kCopy
+                                       : ResourceType::kNoResource;
       default:
         return ResourceType::kNoResource;
     }
@@ -1216,6 +1228,8 @@ DefaultSchedulerCore::ScheduleComputation(const HloComputation* computation) {
       config_.send_recv_host_overlap_limit;
   sched_state.max_concurrent_async[ResourceType::kRecvHost] =
       config_.send_recv_host_overlap_limit;
+  sched_state.max_concurrent_async[ResourceType::kCopy] =
+      config_.copy_overlap_limit;
   // Collect the bottom roots of the graph (nodes that don't have any
   // successor)
   // We are going to use them as starting point for scheduling.
@@ -1321,6 +1335,7 @@ LatencyHidingScheduler::LatencyHidingStatistics(
     kCollectivePermute,
     kSend,
     kRecv,
+    kCopy,
   };
   auto opcode_to_async_kind = [](HloOpcode opcode) {
     switch (opcode) {
@@ -1334,6 +1349,8 @@ LatencyHidingScheduler::LatencyHidingStatistics(
         return AsyncKind::kSend;
       case HloOpcode::kRecv:
         return AsyncKind::kRecv;
+      case HloOpcode::kCopyStart:
+        return AsyncKind::kCopy;
       default:
         return AsyncKind::kNotAsync;
     }
@@ -1415,6 +1432,7 @@ LatencyHidingScheduler::LatencyHidingStatistics(
       wasted_time_per_collective[AsyncKind::kCollectivePermute],
       /*send_wasted_cycles=*/wasted_time_per_collective[AsyncKind::kSend],
       /*recv_wasted_cycles=*/wasted_time_per_collective[AsyncKind::kRecv],
+      /*copy_wasted_cycles=*/wasted_time_per_collective[AsyncKind::kCopy],
       /*total_cycles=*/current_time,
       /*memory_pressure_peak=*/
       memory_pressure_state ? mem_pressure_tracker.initial_memory_pressure() +
@@ -1435,7 +1453,8 @@ std::string LatencyHidingScheduler::SchedulerStatisticsString(
                       sched_stats.all_reduce_wasted_cycles +
                       sched_stats.collective_permute_wasted_cycles +
                       sched_stats.send_wasted_cycles +
-                      sched_stats.recv_wasted_cycles,
+                      sched_stats.recv_wasted_cycles +
+                      sched_stats.copy_wasted_cycles,
                   "\n");
   absl::StrAppend(&result, "Wasted cycles for collective-permute: ",
                   sched_stats.collective_permute_wasted_cycles, "\n");
@@ -1449,6 +1468,9 @@ std::string LatencyHidingScheduler::SchedulerStatisticsString(
   absl::StrAppend(&result,
                   "Wasted cycles for recv: ", sched_stats.recv_wasted_cycles,
                   "\n");
+  absl::StrAppend(&result,
+                  "Wasted cycles for copy: ", sched_stats.copy_wasted_cycles,
+                  "\n");
   absl::StrAppend(&result, "Total cycles: ", sched_stats.total_cycles, "\n");
   absl::StrAppend(&result, "Memory pressure peak (bytes): ",
                   sched_stats.memory_pressure_peak, "\n");
@@ -45,7 +45,8 @@ enum class ResourceType {
   kSendRecv = 5,
   kSendHost = 6,
   kRecvHost = 7,
-  kNumResources = 8,
+  kCopy = 8,
+  kNumResources = 9,
 };
 
 enum class ResourceUsageType {
@@ -71,7 +72,11 @@ struct SchedulerConfig {
   int64_t all_reduce_overlap_limit = 1;
   int64_t send_recv_overlap_limit = 1;
   int64_t send_recv_host_overlap_limit = 1;
+  int64_t copy_overlap_limit = 1;
   bool schedule_send_recvs = false;
+  // Schedule copy-start/copy-done pairs (e.g. prefetches from and evictions to
+  // host memory) to overlap with compute.
+  bool schedule_copies = false;
   // Consider send recv as the same resource. Some platforms do not take well
   // overlapping the send/recv ops between themselves.
   bool force_send_recv_to_use_same_resource = false;
@@ -335,12 +340,19 @@ class BufferInfoTracker {
   BufferInfoTracker(const HloModule* module,
                     const HloAliasAnalysis* alias_analysis,
                     const HloCostAnalysis::ShapeSizeFunction& shape_size_bytes);
+  // Buffers outside of the default memory space (e.g. buffers offloaded to
+  // host memory) don't take up device memory, so they are tracked with a size
+  // of zero.
   static ValueInfo CreateBufferInfo(
       const HloBuffer* value, const HloInstruction* first_definition,
       const HloCostAnalysis::ShapeSizeFunction& shape_size_bytes) {
+    const Shape& shape = value->values()[0]->shape();
+    const bool in_default_memory_space =
+        !shape.has_layout() ||
+        shape.layout().memory_space() == Layout::kDefaultMemorySpace;
     return ValueInfo{
         /*value=*/value, /*first_definition=*/first_definition,
-        /*buffer_size=*/shape_size_bytes(value->values()[0]->shape())};
+        /*buffer_size=*/in_default_memory_space ? shape_size_bytes(shape) : 0};
   }
   const ValueInfo& GetBufferInfo(HloBuffer::Id id) const {
     return buffer_infos_[id];
@@ -653,6 +665,7 @@ class LatencyHidingScheduler : public HloModulePass {
     double collective_permute_wasted_cycles = 0;
     double send_wasted_cycles = 0;
     double recv_wasted_cycles = 0;
+    double copy_wasted_cycles = 0;
     double total_cycles = 0;
     int64_t memory_pressure_peak = 0;
   };
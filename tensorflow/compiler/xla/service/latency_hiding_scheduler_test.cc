@@ -2445,4 +2445,62 @@ ENTRY %module {
                                         new_instruction_sequence, "ata1"));
 }
 
+TEST_F(LatencyHidingSchedulerTest, CopyFromHostOverlapsWithCompute) {
+  absl::string_view hlo_string = R"(
+HloModule module, is_scheduled=true
+
+ENTRY %module {
+  p0 = f32[16,64,256]{2,1,0} parameter(0)
+  p1 = f32[16,64,256]{2,1,0} parameter(1)
+  p2 = f32[16,256,256]{2,1,0:S(1)} parameter(2)
+  cs = (f32[16,256,256]{2,1,0}, f32[16,256,256]{2,1,0:S(1)}, u32[])
+    copy-start(p2)
+  cd = f32[16,256,256]{2,1,0} copy-done(cs)
+  c0 = f32[16,256,256]{2,1,0} convolution(p0, p1),
+    window={size=16 stride=15 lhs_dilate=16}, dim_labels=0fb_0io->0fb
+  ROOT a0 = f32[16,256,256]{2,1,0} add(cd, c0)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo_module, ParseHloText(hlo_string));
+  HloSchedule& module_schedule = hlo_module->schedule();
+  HloComputation* entry_computation = hlo_module->entry_computation();
+
+  SchedulerConfig sched_config = GetDefaultSchedConfig();
+  sched_config.schedule_copies = true;
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunScheduler(hlo_module.get(), sched_config));
+  EXPECT_TRUE(changed);
+  std::vector<HloInstruction*> new_instruction_sequence =
+      module_schedule.sequence(entry_computation).instructions();
+
+  if (VLOG_IS_ON(1)) {
+    for (auto* new_i : new_instruction_sequence) {
+      VLOG(1) << new_i->ToString();
+    }
+  }
+
+  EXPECT_LT(GetIndex(new_instruction_sequence, "cs"),
+            GetIndex(new_instruction_sequence, "c0"));
+  EXPECT_GT(GetIndex(new_instruction_sequence, "cd"),
+            GetIndex(new_instruction_sequence, "c0"));
+}
+
+TEST_F(LatencyHidingSchedulerTest, CopiesAreNotScheduledByDefault) {
+  absl::string_view hlo_string = R"(
+HloModule module, is_scheduled=true
+
+ENTRY %module {
+  p0 = f32[16,256,256]{2,1,0:S(1)} parameter(0)
+  cs = (f32[16,256,256]{2,1,0}, f32[16,256,256]{2,1,0:S(1)}, u32[])
+    copy-start(p0)
+  ROOT cd = f32[16,256,256]{2,1,0} copy-done(cs)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo_module, ParseHloText(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunScheduler(hlo_module.get()));
+  EXPECT_FALSE(changed);
+}
+
 }  // namespace xla
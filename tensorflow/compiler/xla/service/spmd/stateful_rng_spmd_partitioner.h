@@ -45,9 +45,15 @@ class StatefulRngSpmdPartitioningVisitor
 
 class StatefulRngSpmdPartitioner : public spmd::SpmdPartitioner {
  public:
-  StatefulRngSpmdPartitioner(int64_t num_partitions, int64_t num_replicas)
-      : spmd::SpmdPartitioner(num_partitions, num_replicas,
-                              GetSpmdPartitionerOptions()) {}
+  // Dots whose operands reach `threshold_for_windowed_einsum_mib` are
+  // partitioned as windowed einsums, which overlap the all-gather or
+  // reduce-scatter of an operand with partial dots. The default is large
+  // enough to keep them disabled.
+  StatefulRngSpmdPartitioner(int64_t num_partitions, int64_t num_replicas,
+                             int64_t threshold_for_windowed_einsum_mib = 100000)
+      : spmd::SpmdPartitioner(
+            num_partitions, num_replicas,
+            GetSpmdPartitionerOptions(threshold_for_windowed_einsum_mib)) {}
 
  protected:
   std::unique_ptr<spmd::SpmdPartitioningVisitor> CreateVisitor(
@@ -64,12 +70,12 @@ class StatefulRngSpmdPartitioner : public spmd::SpmdPartitioner {
       const HloInstruction* hlo) override;
 
  private:
-  static spmd::SpmdPartitionerOptions GetSpmdPartitionerOptions() {
+  static spmd::SpmdPartitionerOptions GetSpmdPartitionerOptions(
+      int64_t threshold_for_windowed_einsum_mib) {
     spmd::SpmdPartitionerOptions options;
     options.allow_module_signature_change = true;
-    // Setting windowed einsum threshold to be large to disable it for GPU by
-    // default.
-    options.threshold_for_windowed_einsum_mib = 100000;
+    options.threshold_for_windowed_einsum_mib =
+        threshold_for_windowed_einsum_mib;
     return options;
   }
 };
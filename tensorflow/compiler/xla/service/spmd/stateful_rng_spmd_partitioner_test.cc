@@ -38,7 +38,8 @@ class StatefulRngSpmdPartitionerTest : public HloTestBase {
  public:
   StatusOr<std::unique_ptr<HloModule>> PartitionComputation(
       absl::string_view hlo_module, int64_t num_partitions,
-      std::function<void(HloPassPipeline &pipeline)> add_passes = nullptr) {
+      std::function<void(HloPassPipeline &pipeline)> add_passes = nullptr,
+      int64_t threshold_for_windowed_einsum_mib = 100000) {
     TF_ASSIGN_OR_RETURN(
         auto module, ParseAndReturnVerifiedModule(
                          hlo_module, GetModuleConfigForTest(
@@ -51,8 +52,8 @@ class StatefulRngSpmdPartitionerTest : public HloTestBase {
       add_passes(pass);
     }
     pass.AddPass<ShardingPropagation>(/*is_spmd=*/true);
-    pass.AddPass<StatefulRngSpmdPartitioner>(num_partitions,
-                                             /*num_replicas=*/1);
+    pass.AddPass<StatefulRngSpmdPartitioner>(
+        num_partitions, /*num_replicas=*/1, threshold_for_windowed_einsum_mib);
     pass.AddPass<HloVerifier>(/*layout_sensitive=*/false,
                               /*allow_mixed_precision=*/false);
     TF_RETURN_IF_ERROR(pass.Run(module.get()).status());
@@ -116,6 +117,41 @@ ENTRY entry {
   VerifyNoAllReduce(module.get());
 }
 
+TEST_F(StatefulRngSpmdPartitionerTest, WindowedEinsumThreshold) {
+  absl::string_view hlo_string = R"(
+HloModule module
+
+ENTRY entry {
+  %lhs = f32[16,64] parameter(0), sharding={devices=[2,1]0,1}
+  %rhs = f32[64,32] parameter(1), sharding={devices=[1,2]0,1}
+  ROOT %dot = f32[16,32] dot(%lhs, %rhs), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}, sharding={devices=[2,1]0,1}
+}
+)";
+
+  auto count_loops = [](HloModule *module) {
+    int64_t num_loops = 0;
+    for (HloInstruction *hlo : module->entry_computation()->instructions()) {
+      num_loops += hlo->opcode() == HloOpcode::kWhile;
+    }
+    return num_loops;
+  };
+
+  // By default the rhs is all-gathered before the dot.
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module, PartitionComputation(hlo_string, /*num_partitions=*/2));
+  EXPECT_EQ(count_loops(module.get()), 0);
+
+  // Otherwise the dot loops over windows of the rhs rotated across partitions
+  // by collective-permutes.
+  TF_ASSERT_OK_AND_ASSIGN(
+      module, PartitionComputation(hlo_string, /*num_partitions=*/2,
+                                   /*add_passes=*/nullptr,
+                                   /*threshold_for_windowed_einsum_mib=*/0));
+  XLA_VLOG_LINES(1, module->ToString());
+  EXPECT_EQ(count_loops(module.get()), 1);
+}
+
 }  // namespace
 }  // namespace spmd
 }  // namespace xla
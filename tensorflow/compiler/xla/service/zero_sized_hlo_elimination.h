@@ -21,12 +21,9 @@ limitations under the License.
 
 // HLO pass that replaces zero sized Hlos with a zero sized constant literal.
 namespace xla {
-class ZeroSizedHloElimination : public HloModulePass {
+class ZeroSizedHloElimination : public HloComputationPass {
  public:
-  using HloPassInterface::Run;
-  StatusOr<bool> Run(
-      HloModule* module,
-      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+  StatusOr<bool> RunOnComputation(HloComputation* computation) override;
   absl::string_view name() const override {
     return "zero_sized_hlo_elimination";
   }
@@ -321,6 +321,13 @@ Stream &Stream::InitWithTimer(Timer *timer) {
   return Init().InitTimer(timer);
 }
 
+Stream &Stream::InitWithPriority(int priority) {
+  VLOG_CALL(PARAM(priority));
+
+  implementation_->SetPriority(priority);
+  return Init();
+}
+
 Stream &Stream::ThenRecordEvent(Event *event) {
   VLOG_CALL(PARAM(event));
 
@@ -150,6 +150,15 @@ class Stream {
   // Convenience wrapper around Init() and InitTimer().
   Stream &InitWithTimer(Timer *t);
 
+  // Initializes the stream with the given priority. As with the CUDA stream
+  // priorities, lower numbers are higher priorities, and work on higher
+  // priority streams is scheduled ahead of pending work on lower priority
+  // ones. Platforms without stream priorities ignore the priority.
+  Stream &InitWithPriority(int priority) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the priority the stream was initialized with.
+  int priority() const { return implementation_->priority(); }
+
   // Get or create a sub-stream from this stream. If there is any sub-stream in
   // the pool that can be reused then just return this sub-stream.  Otherwise
   // create a new sub-stream.
@@ -129,6 +129,14 @@ class StreamInterface {
   // or a nullptr.
   virtual void** GpuStreamMemberHack() { return nullptr; }
 
+  // Sets the priority the stream is created with, which must be done before
+  // the stream is allocated. Platforms without stream priorities ignore it.
+  virtual void SetPriority(int priority) {}
+
+  // Returns the priority of the stream, or 0 if the platform has no stream
+  // priorities.
+  virtual int priority() const { return 0; }
+
  private:
   SE_DISALLOW_COPY_AND_ASSIGN(StreamInterface);
 };
@@ -41,6 +41,15 @@ TEST_F(StreamTest, InitOk) {
   EXPECT_TRUE(stream.ok());
 }
 
+TEST_F(StreamTest, InitWithPriorityOk) {
+  std::unique_ptr<StreamExecutor> executor = NewStreamExecutor();
+  Stream stream(executor.get());
+  stream.InitWithPriority(-1);
+  EXPECT_TRUE(stream.ok());
+  // The host platform has no stream priorities.
+  EXPECT_EQ(stream.priority(), 0);
+}
+
 TEST_F(StreamTest, OneSubStream) {
   std::unique_ptr<StreamExecutor> executor = NewStreamExecutor();
   Stream stream(executor.get());
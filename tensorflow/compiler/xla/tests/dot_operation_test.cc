@@ -414,6 +414,9 @@ std::vector<DotTestParam> CreateDotTestParameters() {
   add_matrix_matrix_dot_test(/*m=*/12, /*k=*/117, /*n=*/7);
   add_matrix_matrix_dot_test(/*m=*/270, /*k=*/270, /*n=*/520);
   add_matrix_matrix_dot_test(/*m=*/260, /*k=*/3, /*n=*/520);
+  // Skinny dots, with few rows in the LHS.
+  add_matrix_matrix_dot_test(/*m=*/8, /*k=*/256, /*n=*/1024);
+  add_matrix_matrix_dot_test(/*m=*/13, /*k=*/130, /*n=*/67);
 
   return params;
 }
@@ -51,6 +51,7 @@ limitations under the License.
 #include "mlir/Tools/mlir-translate/Translation.h"  // from @llvm-project
 #include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_casting_utils.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
 #include "tensorflow/compiler/xla/mlir/utils/error_util.h"
 #include "tensorflow/compiler/xla/mlir_hlo/lhlo/IR/lhlo_ops.h"
 #include "tensorflow/compiler/xla/mlir_hlo/lhlo_gpu/IR/lhlo_gpu_ops.h"
@@ -832,8 +833,18 @@ tsl::StatusOr<lmhlo::FusionOp> LhloDialectEmitter::EmitSoftmax(
     const HloInstruction* instr) {
   Location loc = getLocation(instr);
 
-  NamedAttribute attr(builder_.getStringAttr("fusion_type"),
-                      builder_.getStringAttr("softmax_fusion"));
+  // Softmax fusions are lowered through MLIR, unless the row normalization
+  // emitter of XLA:GPU is enabled.
+  const bool use_row_normalization_emitter =
+      instr->GetModule()
+          ->config()
+          .debug_options()
+          .xla_gpu_enable_row_normalization_emitter();
+  NamedAttribute attr(
+      builder_.getStringAttr("fusion_type"),
+      builder_.getStringAttr(use_row_normalization_emitter
+                                 ? "row_normalization_fusion"
+                                 : "softmax_fusion"));
   auto fusion = builder_.create<lmhlo::FusionOp>(
       loc, llvm::SmallVector<NamedAttribute>{attr});
   auto after_fusion = builder_.saveInsertionPoint();
@@ -48,6 +48,12 @@ string BuildGraphOptions::DebugString() const {
       break;
   }
   strings::StrAppend(&rv, "\ncollective_order: ", collective_order_str);
+  if (!feed_shapes.empty()) {
+    strings::StrAppend(&rv, "\nFeed shapes: ");
+    for (auto& it : feed_shapes) {
+      strings::StrAppend(&rv, it.first, ": ", it.second.DebugString(), ", ");
+    }
+  }
   return rv;
 }
 
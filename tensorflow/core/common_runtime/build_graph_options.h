@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_BUILD_GRAPH_OPTIONS_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BUILD_GRAPH_OPTIONS_H_
 
+#include <unordered_map>
 #include <vector>
 
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/graph/collective_order.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -40,6 +42,11 @@ struct BuildGraphOptions {
   // edges, if `kAttrs` encode as attribute on collective op.
   GraphCollectiveOrder collective_order = GraphCollectiveOrder::kNone;
 
+  // If not empty, the exact shapes of (a subset of) the tensors in
+  // `callable_options.feed()`, keyed by feed name. The graph is optimized for
+  // these shapes, and must only be run with feeds that have them.
+  std::unordered_map<string, TensorShape> feed_shapes;
+
   string DebugString() const;
 };
 
@@ -0,0 +1,290 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace {
+
+// Size in bytes of one (index, value) pair of a TOP_K tensor.
+int64_t TopKPairBytes(DataType dtype) {
+  return sizeof(int32) + DataTypeSize(dtype);
+}
+
+template <typename From, typename To>
+void Cast(const Tensor& input, Tensor* output) {
+  output->flat<To>() = input.flat<From>().template cast<To>();
+}
+
+template <typename T>
+Status CastCompress(const CollImplDetails& details, const Tensor& input,
+                    Tensor* output) {
+  if (details.compression == COLLECTIVE_COMPRESSION_FLOAT16) {
+    Cast<T, Eigen::half>(input, output);
+  } else {
+    Cast<T, bfloat16>(input, output);
+  }
+  return OkStatus();
+}
+
+template <typename T>
+Status CastDecompress(const CollImplDetails& details, const Tensor& input,
+                      Tensor* output) {
+  if (details.compression == COLLECTIVE_COMPRESSION_FLOAT16) {
+    Cast<Eigen::half, T>(input, output);
+  } else {
+    Cast<bfloat16, T>(input, output);
+  }
+  return OkStatus();
+}
+
+// The TOP_K format is the sorted indices of the selected values, as int32,
+// followed by the values themselves.
+template <typename T>
+Status TopKCompress(const CollImplDetails& details, const Tensor& input,
+                    Tensor* residual, Tensor* output) {
+  const int64_t n = input.NumElements();
+  const int64_t k = CompressedTopKCount(details.topk_ratio, n);
+  std::vector<T> values(input.flat<T>().data(), input.flat<T>().data() + n);
+  if (residual != nullptr) {
+    const T* r = residual->flat<T>().data();
+    for (int64_t i = 0; i < n; ++i) {
+      values[i] += r[i];
+    }
+  }
+  std::vector<int32> indices(n);
+  std::iota(indices.begin(), indices.end(), 0);
+  auto larger = [&values](int32 a, int32 b) {
+    return std::abs(values[a]) > std::abs(values[b]) ||
+           (std::abs(values[a]) == std::abs(values[b]) && a < b);
+  };
+  if (k < n) {
+    std::nth_element(indices.begin(), indices.begin() + k, indices.end(),
+                     larger);
+  }
+  indices.resize(k);
+  std::sort(indices.begin(), indices.end());
+
+  char* out = const_cast<char*>(output->tensor_data().data());
+  std::memcpy(out, indices.data(), k * sizeof(int32));
+  out += k * sizeof(int32);
+  for (int64_t j = 0; j < k; ++j) {
+    std::memcpy(out + j * sizeof(T), &values[indices[j]], sizeof(T));
+  }
+  if (residual != nullptr) {
+    for (int32 i : indices) {
+      values[i] = T(0);
+    }
+    std::copy(values.begin(), values.end(), residual->flat<T>().data());
+  }
+  return OkStatus();
+}
+
+template <typename T>
+Status TopKDecompress(const CollImplDetails& details, const Tensor& input,
+                      Tensor* output) {
+  const int64_t n = output->NumElements();
+  const int64_t k = CompressedTopKCount(details.topk_ratio, n);
+  if (input.TotalBytes() != k * TopKPairBytes(output->dtype())) {
+    return errors::Internal("Compressed tensor has ", input.TotalBytes(),
+                            " bytes, expected ",
+                            k * TopKPairBytes(output->dtype()));
+  }
+  const char* in = input.tensor_data().data();
+  T* out = output->flat<T>().data();
+  std::fill(out, out + n, T(0));
+  for (int64_t j = 0; j < k; ++j) {
+    int32 index;
+    std::memcpy(&index, in + j * sizeof(int32), sizeof(int32));
+    if (index < 0 || index >= n) {
+      return errors::Internal("Compressed tensor has out of range index ",
+                              index);
+    }
+    std::memcpy(&out[index], in + k * sizeof(int32) + j * sizeof(T),
+                sizeof(T));
+  }
+  return OkStatus();
+}
+
+template <typename T>
+Status DoCompress(const CollImplDetails& details, const Tensor& input,
+                  Tensor* residual, Tensor* output) {
+  if (details.compression == COLLECTIVE_COMPRESSION_TOP_K) {
+    return TopKCompress<T>(details, input, residual, output);
+  }
+  return CastCompress<T>(details, input, output);
+}
+
+template <typename T>
+Status DoDecompress(const CollImplDetails& details, const Tensor& input,
+                    Tensor* output) {
+  if (details.compression == COLLECTIVE_COMPRESSION_TOP_K) {
+    return TopKDecompress<T>(details, input, output);
+  }
+  return CastDecompress<T>(details, input, output);
+}
+
+}  // namespace
+
+Status ValidateCollectiveCompression(const CollectiveParams& col_params) {
+  const CollImplDetails& details = col_params.instance.impl_details;
+  if (details.compression == COLLECTIVE_COMPRESSION_NONE) {
+    return OkStatus();
+  }
+  if (details.compression < COLLECTIVE_COMPRESSION_NONE ||
+      details.compression > COLLECTIVE_COMPRESSION_TOP_K) {
+    return errors::InvalidArgument("Unknown collective compression ",
+                                   details.compression);
+  }
+  if (col_params.group.device_type.type_string() != DEVICE_CPU) {
+    return errors::Unimplemented(
+        "Collective compression is only supported on CPU devices, got ",
+        col_params.group.device_type.type_string());
+  }
+  if (col_params.instance.data_type != DT_FLOAT &&
+      col_params.instance.data_type != DT_DOUBLE) {
+    return errors::InvalidArgument(
+        "Collective compression requires float or double values, got ",
+        DataTypeString(col_params.instance.data_type));
+  }
+  if (details.compression == COLLECTIVE_COMPRESSION_TOP_K) {
+    if (col_params.instance.type != REDUCTION_COLLECTIVE ||
+        (col_params.merge_op != nullptr &&
+         col_params.merge_op->type_string() != "Add")) {
+      return errors::InvalidArgument(
+          "Top-k collective compression requires an Add reduction");
+    }
+    if (!(details.topk_ratio > 0 && details.topk_ratio <= 1)) {
+      return errors::InvalidArgument("topk_ratio must be in (0, 1], got ",
+                                     details.topk_ratio);
+    }
+  }
+  return OkStatus();
+}
+
+int64_t CompressedTopKCount(float topk_ratio, int64_t num_elements) {
+  if (num_elements == 0) {
+    return 0;
+  }
+  const int64_t k = static_cast<int64_t>(std::ceil(topk_ratio * num_elements));
+  return std::min(num_elements, std::max<int64_t>(1, k));
+}
+
+Tensor AllocateCompressedTensor(const CollImplDetails& details, DataType dtype,
+                                int64_t num_elements) {
+  switch (details.compression) {
+    case COLLECTIVE_COMPRESSION_FLOAT16:
+      return Tensor(DT_HALF, TensorShape({num_elements}));
+    case COLLECTIVE_COMPRESSION_BFLOAT16:
+      return Tensor(DT_BFLOAT16, TensorShape({num_elements}));
+    case COLLECTIVE_COMPRESSION_TOP_K:
+      return Tensor(DT_UINT8,
+                    TensorShape({CompressedTopKCount(details.topk_ratio,
+                                                     num_elements) *
+                                 TopKPairBytes(dtype)}));
+    default:
+      return Tensor(dtype, TensorShape({num_elements}));
+  }
+}
+
+Status CompressTensor(const CollImplDetails& details, const Tensor& input,
+                      Tensor* residual, Tensor* output) {
+  *output = AllocateCompressedTensor(details, input.dtype(),
+                                     input.NumElements());
+  if (residual != nullptr &&
+      residual->NumElements() != input.NumElements()) {
+    return errors::Internal("Residual has ", residual->NumElements(),
+                            " elements, expected ", input.NumElements());
+  }
+  switch (input.dtype()) {
+    case DT_FLOAT:
+      return DoCompress<float>(details, input, residual, output);
+    case DT_DOUBLE:
+      return DoCompress<double>(details, input, residual, output);
+    default:
+      return errors::InvalidArgument("Cannot compress a tensor of type ",
+                                     DataTypeString(input.dtype()));
+  }
+}
+
+Status DecompressTensor(const CollImplDetails& details, const Tensor& input,
+                        Tensor* output) {
+  if (details.compression != COLLECTIVE_COMPRESSION_TOP_K &&
+      input.NumElements() != output->NumElements()) {
+    return errors::Internal("Compressed tensor has ", input.NumElements(),
+                            " elements, expected ", output->NumElements());
+  }
+  switch (output->dtype()) {
+    case DT_FLOAT:
+      return DoDecompress<float>(details, input, output);
+    case DT_DOUBLE:
+      return DoDecompress<double>(details, input, output);
+    default:
+      return errors::InvalidArgument("Cannot decompress a tensor of type ",
+                                     DataTypeString(output->dtype()));
+  }
+}
+
+CollectiveCompressionResiduals* CollectiveCompressionResiduals::Global() {
+  static CollectiveCompressionResiduals* global =
+      new CollectiveCompressionResiduals;
+  return global;
+}
+
+Tensor CollectiveCompressionResiduals::Get(const string& key, int64_t step_id,
+                                           DataType dtype,
+                                           int64_t num_elements) {
+  mutex_lock l(mu_);
+  if (num_steps_ == 0 || step_id != last_step_id_) {
+    last_step_id_ = step_id;
+    ++num_steps_;
+    for (auto it = residuals_.begin(); it != residuals_.end();) {
+      if (num_steps_ - it->second.last_step > kMaxIdleSteps) {
+        residuals_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+  Residual& residual = residuals_[key];
+  residual.last_step = num_steps_;
+  Tensor& tensor = residual.tensor;
+  if (tensor.dtype() != dtype || tensor.NumElements() != num_elements ||
+      !tensor.IsInitialized()) {
+    tensor = Tensor(dtype, TensorShape({num_elements}));
+    std::memset(const_cast<char*>(tensor.tensor_data().data()), 0,
+                tensor.TotalBytes());
+  }
+  return tensor;
+}
+
+size_t CollectiveCompressionResiduals::size() {
+  mutex_lock l(mu_);
+  return residuals_.size();
+}
+
+}  // namespace tensorflow
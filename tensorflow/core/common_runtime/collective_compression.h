@@ -0,0 +1,102 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_COMPRESSION_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_COMPRESSION_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Lossy wire formats for collective transfers between tasks, selected by
+// `CollImplDetails::compression`.
+//
+// FLOAT16 and BFLOAT16 cast the values to 16 bits. TOP_K sends the
+// `topk_ratio` fraction of the values with the largest magnitude as
+// (index, value) pairs and zeroes the others; the values that were not sent
+// are kept as a residual and added to the next tensor compressed with the
+// same residual (error feedback).
+//
+// All compressed tensors are in host memory.
+
+// Returns OK if the compression requested by `col_params` can be applied to
+// the collective. Compression is only supported for float and double values
+// on CPU devices, and TOP_K only for reductions with the Add merge op.
+Status ValidateCollectiveCompression(const CollectiveParams& col_params);
+
+// Returns the number of values sent by TOP_K for a tensor of `num_elements`.
+int64_t CompressedTopKCount(float topk_ratio, int64_t num_elements);
+
+// Allocates the host tensor that `num_elements` values of type `dtype` are
+// sent as under `details.compression`.
+Tensor AllocateCompressedTensor(const CollImplDetails& details, DataType dtype,
+                                int64_t num_elements);
+
+// Compresses `input` into `output`, which is allocated by this function.
+// `residual` is only used by TOP_K and may be null to disable error feedback.
+Status CompressTensor(const CollImplDetails& details, const Tensor& input,
+                      Tensor* residual, Tensor* output);
+
+// Decompresses `input` into the already allocated `output`.
+Status DecompressTensor(const CollImplDetails& details, const Tensor& input,
+                        Tensor* output);
+
+// Process-wide store of the TOP_K error feedback residuals, keyed by a
+// string that identifies the sending device and chunk of a collective
+// instance.
+//
+// A residual only carries over between steps that reuse the instance key,
+// as functions do. Residuals that have not been used during the last
+// `kMaxIdleSteps` distinct steps are evicted, so that instances that are not
+// run again, e.g. ones with a fresh instance key per call, do not accumulate.
+class CollectiveCompressionResiduals {
+ public:
+  static constexpr int64_t kMaxIdleSteps = 16;
+
+  static CollectiveCompressionResiduals* Global();
+
+  // Returns the residual for `key` in step `step_id`, creating a zero-filled
+  // one if there is none of the given type and size. The returned tensor
+  // shares its buffer with the stored residual.
+  Tensor Get(const string& key, int64_t step_id, DataType dtype,
+             int64_t num_elements);
+
+  // Returns the number of stored residuals.
+  size_t size();
+
+ private:
+  struct Residual {
+    Tensor tensor;
+    // Value of `num_steps_` when the residual was last used.
+    int64_t last_step = 0;
+  };
+
+  mutex mu_;
+  absl::flat_hash_map<string, Residual> residuals_ TF_GUARDED_BY(mu_);
+  // Number of times a step other than the previous one used the store.
+  int64_t num_steps_ TF_GUARDED_BY(mu_) = 0;
+  int64_t last_step_id_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_COMPRESSION_H_
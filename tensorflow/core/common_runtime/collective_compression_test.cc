@@ -0,0 +1,142 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_compression.h"
+
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+CollImplDetails Details(CollectiveCompression compression,
+                        float topk_ratio = 0.5) {
+  CollImplDetails details;
+  details.compression = compression;
+  details.topk_ratio = topk_ratio;
+  return details;
+}
+
+Tensor RoundTrip(const CollImplDetails& details, const Tensor& input,
+                 Tensor* residual = nullptr) {
+  Tensor wire;
+  TF_CHECK_OK(CompressTensor(details, input, residual, &wire));
+  Tensor expected_wire = AllocateCompressedTensor(details, input.dtype(),
+                                                  input.NumElements());
+  EXPECT_EQ(wire.dtype(), expected_wire.dtype());
+  EXPECT_EQ(wire.TotalBytes(), expected_wire.TotalBytes());
+  Tensor output(input.dtype(), input.shape());
+  TF_CHECK_OK(DecompressTensor(details, wire, &output));
+  return output;
+}
+
+TEST(CollectiveCompressionTest, Float16) {
+  CollImplDetails details = Details(COLLECTIVE_COMPRESSION_FLOAT16);
+  Tensor input = test::AsTensor<float>({1.0f, -2.5f, 1000.1f, 1e-3f});
+  Tensor wire;
+  TF_ASSERT_OK(CompressTensor(details, input, nullptr, &wire));
+  EXPECT_EQ(wire.dtype(), DT_HALF);
+  test::ExpectTensorNear<float>(RoundTrip(details, input), input, 1.0);
+}
+
+TEST(CollectiveCompressionTest, Bfloat16) {
+  CollImplDetails details = Details(COLLECTIVE_COMPRESSION_BFLOAT16);
+  Tensor input = test::AsTensor<double>({1.0, -2.0, 0.5, 64.0});
+  // These values are exactly representable in bfloat16.
+  test::ExpectTensorEqual<double>(RoundTrip(details, input), input);
+}
+
+TEST(CollectiveCompressionTest, TopKKeepsLargestValues) {
+  CollImplDetails details = Details(COLLECTIVE_COMPRESSION_TOP_K, 0.5);
+  Tensor input = test::AsTensor<float>({0.1f, -4.0f, 0.2f, 3.0f});
+  test::ExpectTensorEqual<float>(
+      RoundTrip(details, input), test::AsTensor<float>({0, -4.0f, 0, 3.0f}));
+}
+
+TEST(CollectiveCompressionTest, TopKErrorFeedback) {
+  CollImplDetails details = Details(COLLECTIVE_COMPRESSION_TOP_K, 0.25);
+  Tensor residual(DT_FLOAT, TensorShape({4}));
+  residual.flat<float>().setZero();
+  Tensor input = test::AsTensor<float>({1.0f, 2.0f, 3.0f, 4.0f});
+  test::ExpectTensorEqual<float>(RoundTrip(details, input, &residual),
+                                 test::AsTensor<float>({0, 0, 0, 4.0f}));
+  test::ExpectTensorEqual<float>(residual,
+                                 test::AsTensor<float>({1.0f, 2.0f, 3.0f, 0}));
+  // The values that were held back are sent once they have accumulated.
+  test::ExpectTensorEqual<float>(RoundTrip(details, input, &residual),
+                                 test::AsTensor<float>({0, 0, 6.0f, 0}));
+  test::ExpectTensorEqual<float>(
+      residual, test::AsTensor<float>({2.0f, 4.0f, 0, 4.0f}));
+}
+
+TEST(CollectiveCompressionTest, TopKCount) {
+  EXPECT_EQ(CompressedTopKCount(0.01, 0), 0);
+  EXPECT_EQ(CompressedTopKCount(0.01, 10), 1);
+  EXPECT_EQ(CompressedTopKCount(0.01, 1000), 10);
+  EXPECT_EQ(CompressedTopKCount(1.0, 7), 7);
+}
+
+TEST(CollectiveCompressionTest, Validate) {
+  CollectiveParams* cp = new CollectiveParams;
+  core::ScopedUnref unref(cp);
+  cp->instance.type = REDUCTION_COLLECTIVE;
+  cp->instance.data_type = DT_FLOAT;
+  TF_EXPECT_OK(ValidateCollectiveCompression(*cp));
+  cp->instance.impl_details.compression = COLLECTIVE_COMPRESSION_TOP_K;
+  TF_EXPECT_OK(ValidateCollectiveCompression(*cp));
+  cp->instance.impl_details.topk_ratio = 0;
+  EXPECT_EQ(ValidateCollectiveCompression(*cp).code(),
+            error::INVALID_ARGUMENT);
+  cp->instance.impl_details.compression = COLLECTIVE_COMPRESSION_FLOAT16;
+  cp->instance.data_type = DT_INT32;
+  EXPECT_EQ(ValidateCollectiveCompression(*cp).code(),
+            error::INVALID_ARGUMENT);
+  cp->instance.data_type = DT_FLOAT;
+  cp->group.device_type = DeviceType(DEVICE_GPU);
+  EXPECT_EQ(ValidateCollectiveCompression(*cp).code(), error::UNIMPLEMENTED);
+}
+
+TEST(CollectiveCompressionTest, ResidualsAreReset) {
+  CollectiveCompressionResiduals residuals;
+  Tensor r = residuals.Get("test", /*step_id=*/1, DT_FLOAT, 4);
+  r.flat<float>().setConstant(1.0f);
+  EXPECT_EQ(residuals.Get("test", 1, DT_FLOAT, 4).flat<float>()(0), 1.0f);
+  EXPECT_EQ(residuals.Get("test", 1, DT_FLOAT, 8).flat<float>()(0), 0.0f);
+}
+
+TEST(CollectiveCompressionTest, IdleResidualsAreEvicted) {
+  constexpr int64_t kMaxIdleSteps =
+      CollectiveCompressionResiduals::kMaxIdleSteps;
+  CollectiveCompressionResiduals residuals;
+  residuals.Get("reused", /*step_id=*/0, DT_FLOAT, 4)
+      .flat<float>()
+      .setConstant(1.0f);
+  for (int64_t step_id = 1; step_id <= 2 * kMaxIdleSteps; ++step_id) {
+    // An instance that runs in every step keeps its residual, while one
+    // that ran in a single step is evicted.
+    Tensor reused = residuals.Get("reused", step_id, DT_FLOAT, 4);
+    EXPECT_EQ(reused.flat<float>()(0), 1.0f);
+    residuals.Get(strings::StrCat("once:", step_id), step_id, DT_FLOAT, 4);
+  }
+  // The last kMaxIdleSteps + 1 single-step residuals are still kept.
+  EXPECT_EQ(residuals.size(), 1 + kMaxIdleSteps + 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,420 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_fusion_pass.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/control_flow.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCollectiveReduceV2[] = "CollectiveReduceV2";
+
+// Input indices of CollectiveReduceV2.
+constexpr int kInputIndex = 0;
+constexpr int kGroupSizeIndex = 1;
+constexpr int kGroupKeyIndex = 2;
+constexpr int kInstanceKeyIndex = 3;
+constexpr int kFirstOrderingTokenIndex = 4;
+
+// Attributes that must agree between the members of a bucket. They are copied
+// from the first member onto the fused op.
+constexpr const char* kFusedAttrs[] = {
+    "merge_op", "final_op", "communication_hint", "timeout_seconds",
+    "max_subdivs_per_device"};
+
+struct Candidate {
+  Node* node;
+  int32 instance_key;
+  TensorShape shape;
+  int64_t bytes;
+};
+
+bool IsBackEdge(const Edge& edge) { return edge.src()->IsNextIteration(); }
+
+// Returns true and sets `value` if input `index` of `n` is a scalar int32
+// constant.
+bool GetConstInt32Input(const Node* n, int index, int32* value) {
+  const Edge* e;
+  if (!n->input_edge(index, &e).ok() || !e->src()->IsConstant()) {
+    return false;
+  }
+  const TensorProto* proto;
+  Tensor t;
+  if (!TryGetNodeAttr(e->src()->attrs(), "value", &proto) ||
+      !t.FromProto(*proto) || t.dtype() != DT_INT32 || t.NumElements() != 1) {
+    return false;
+  }
+  *value = t.flat<int32>()(0);
+  return true;
+}
+
+// Returns a string identifying the value of input `index` of `n`: the value
+// itself for scalar int32 constants, and the producing tensor otherwise.
+string InputKey(const Node* n, int index) {
+  int32 value;
+  if (GetConstInt32Input(n, index, &value)) {
+    return strings::StrCat("const:", value);
+  }
+  const Edge* e;
+  if (!n->input_edge(index, &e).ok()) {
+    return "";
+  }
+  return strings::StrCat(e->src()->name(), ":", e->src_output());
+}
+
+// Returns the key that two CollectiveReduceV2 ops must share to be fused.
+string FusionKey(const Node* n, const ControlFlowInfo& cf_info) {
+  string key = strings::StrCat(n->assigned_device_name(), "|",
+                               cf_info.frame_name, "|",
+                               DataTypeString(n->input_type(kInputIndex)), "|",
+                               InputKey(n, kGroupSizeIndex), "|",
+                               InputKey(n, kGroupKeyIndex));
+  for (int i = kFirstOrderingTokenIndex; i < n->num_inputs(); ++i) {
+    strings::StrAppend(&key, "|", InputKey(n, i));
+  }
+  for (const char* attr_name : kFusedAttrs) {
+    const AttrValue* attr = n->attrs().Find(attr_name);
+    strings::StrAppend(&key, "|", attr_name, "=",
+                       attr == nullptr ? "" : SummarizeAttrValue(*attr));
+  }
+  return key;
+}
+
+// Returns true if `n` can be fused and fills in `candidate`.
+bool GetCandidate(Node* n, const ShapeRefiner& refiner,
+                  int64_t threshold_bytes, Candidate* candidate) {
+  if (n->type_string() != kCollectiveReduceV2 ||
+      n->assigned_device_name().empty()) {
+    return false;
+  }
+  if (!GetConstInt32Input(n, kInstanceKeyIndex, &candidate->instance_key)) {
+    return false;
+  }
+  const Edge* e;
+  if (!n->input_edge(kInputIndex, &e).ok()) {
+    return false;
+  }
+  shape_inference::InferenceContext* ctx = refiner.GetContext(e->src());
+  if (ctx == nullptr) {
+    return false;
+  }
+  shape_inference::ShapeHandle shape = ctx->output(e->src_output());
+  if (!ctx->FullyDefined(shape)) {
+    return false;
+  }
+  candidate->shape = TensorShape();
+  for (int i = 0; i < ctx->Rank(shape); ++i) {
+    candidate->shape.AddDim(ctx->Value(ctx->Dim(shape, i)));
+  }
+  if (candidate->shape.num_elements() > std::numeric_limits<int32>::max()) {
+    return false;
+  }
+  candidate->node = n;
+  candidate->bytes = candidate->shape.num_elements() *
+                     DataTypeSize(n->input_type(kInputIndex));
+  return candidate->bytes < threshold_bytes;
+}
+
+// Returns true if fusing `bucket` and `candidate` into a single node would
+// create a cycle, i.e. if one of them depends on another through a data edge
+// or through a node outside of the bucket. `topo_index` maps node ids to
+// their position in a topological order of the graph.
+bool CreatesCycle(const Graph& g, const std::vector<Candidate>& bucket,
+                  Node* candidate, const std::vector<int>& topo_index) {
+  absl::flat_hash_set<const Node*> members = {candidate};
+  for (const Candidate& c : bucket) {
+    members.insert(c.node);
+  }
+  int max_index = 0;
+  std::deque<const Node*> queue;
+  for (const Node* n : members) {
+    max_index = std::max(max_index, topo_index[n->id()]);
+    for (const Edge* e : n->out_edges()) {
+      if (!members.contains(e->dst())) {
+        queue.push_back(e->dst());
+      } else if (!e->IsControlEdge()) {
+        return true;
+      }
+    }
+  }
+  // Nodes that come after all members in topological order cannot reach any
+  // of them.
+  std::vector<bool> visited(g.num_node_ids(), false);
+  while (!queue.empty()) {
+    const Node* n = queue.front();
+    queue.pop_front();
+    if (visited[n->id()] || topo_index[n->id()] > max_index) {
+      continue;
+    }
+    if (members.contains(n)) {
+      return true;
+    }
+    visited[n->id()] = true;
+    for (const Edge* e : n->out_edges()) {
+      if (!IsBackEdge(*e)) {
+        queue.push_back(e->dst());
+      }
+    }
+  }
+  return false;
+}
+
+void ComputeTopologicalIndex(const Graph& g, std::vector<int>* topo_index) {
+  std::vector<Node*> order;
+  GetReversePostOrder(g, &order, NodeComparatorName(),
+                      [](const Edge& e) { return !IsBackEdge(e); });
+  topo_index->assign(g.num_node_ids(), 0);
+  for (int i = 0; i < order.size(); ++i) {
+    (*topo_index)[order[i]->id()] = i;
+  }
+}
+
+Tensor Int32Vector(const std::vector<int32>& values) {
+  Tensor t(DT_INT32, TensorShape({static_cast<int64_t>(values.size())}));
+  std::copy(values.begin(), values.end(), t.flat<int32>().data());
+  return t;
+}
+
+// Replaces the members of `bucket` with
+//   Reshape(-1) -> ConcatV2 -> CollectiveReduceV2 -> SplitV -> Reshape(shape).
+Status FuseBucket(Graph* g, const std::vector<Candidate>& bucket) {
+  Node* first = bucket.front().node;
+  const string prefix = strings::StrCat(first->name(), "/CollectiveFusion");
+  absl::flat_hash_set<const Node*> members;
+  for (const Candidate& c : bucket) {
+    members.insert(c.node);
+  }
+
+  auto make_node = [g, first, &prefix](StringPiece op, StringPiece suffix) {
+    NodeDebugInfo debug_info(*first);
+    NodeBuilder builder(g->NewName(strings::StrCat(prefix, "/", suffix)), op,
+                        OpRegistry::Global(), &debug_info);
+    builder.Device(first->requested_device());
+    return builder;
+  };
+  auto finalize = [g, first](NodeBuilder& builder, Node** node) -> Status {
+    TF_RETURN_IF_ERROR(builder.Finalize(g, node));
+    (*node)->set_assigned_device_name(first->assigned_device_name());
+    return OkStatus();
+  };
+  auto make_const = [&make_node, &finalize](const Tensor& value,
+                                            StringPiece suffix, Node** node) {
+    NodeBuilder builder = make_node("Const", suffix)
+                              .Attr("dtype", value.dtype())
+                              .Attr("value", value);
+    return finalize(builder, node);
+  };
+
+  Node* flat_shape;
+  TF_RETURN_IF_ERROR(make_const(Int32Vector({-1}), "flat_shape", &flat_shape));
+  Node* axis;
+  TF_RETURN_IF_ERROR(make_const(Tensor(int32{0}), "axis", &axis));
+
+  std::vector<NodeBuilder::NodeOut> flat_inputs;
+  std::vector<int32> sizes;
+  std::vector<Node*> control_inputs;
+  for (const Candidate& c : bucket) {
+    const Edge* e;
+    TF_RETURN_IF_ERROR(c.node->input_edge(kInputIndex, &e));
+    NodeBuilder builder = make_node("Reshape", "flatten")
+                              .Input(e->src(), e->src_output())
+                              .Input(flat_shape);
+    Node* flat;
+    TF_RETURN_IF_ERROR(finalize(builder, &flat));
+    flat_inputs.emplace_back(flat, 0);
+    sizes.push_back(c.shape.num_elements());
+    for (const Edge* in : c.node->in_edges()) {
+      if (in->IsControlEdge() && !members.contains(in->src())) {
+        control_inputs.push_back(in->src());
+      }
+    }
+  }
+
+  NodeBuilder concat_builder =
+      make_node("ConcatV2", "concat").Input(flat_inputs).Input(axis);
+  Node* concat;
+  TF_RETURN_IF_ERROR(finalize(concat_builder, &concat));
+
+  std::vector<NodeBuilder::NodeOut> ordering_tokens;
+  std::vector<NodeBuilder::NodeOut> scalar_inputs;
+  for (int i = kGroupSizeIndex; i < first->num_inputs(); ++i) {
+    const Edge* e;
+    TF_RETURN_IF_ERROR(first->input_edge(i, &e));
+    (i < kFirstOrderingTokenIndex ? scalar_inputs : ordering_tokens)
+        .emplace_back(e->src(), e->src_output());
+  }
+  NodeBuilder reduce_builder = make_node(kCollectiveReduceV2, "reduce")
+                                   .Input(concat)
+                                   .Input(scalar_inputs[0])
+                                   .Input(scalar_inputs[1])
+                                   .Input(scalar_inputs[2])
+                                   .Input(ordering_tokens)
+                                   .ControlInputs(control_inputs);
+  for (const char* attr_name : kFusedAttrs) {
+    const AttrValue* attr = first->attrs().Find(attr_name);
+    if (attr != nullptr) {
+      reduce_builder.Attr(attr_name, *attr);
+    }
+  }
+  Node* reduce;
+  TF_RETURN_IF_ERROR(finalize(reduce_builder, &reduce));
+
+  Node* size_splits;
+  TF_RETURN_IF_ERROR(
+      make_const(Int32Vector(sizes), "size_splits", &size_splits));
+  NodeBuilder split_builder = make_node("SplitV", "split")
+                                  .Input(reduce)
+                                  .Input(size_splits)
+                                  .Input(axis)
+                                  .Attr("num_split",
+                                        static_cast<int>(bucket.size()));
+  Node* split;
+  TF_RETURN_IF_ERROR(finalize(split_builder, &split));
+
+  for (int i = 0; i < bucket.size(); ++i) {
+    const Candidate& c = bucket[i];
+    std::vector<int32> dims(c.shape.dim_sizes().begin(),
+                            c.shape.dim_sizes().end());
+    Node* shape;
+    TF_RETURN_IF_ERROR(make_const(Int32Vector(dims), "shape", &shape));
+    NodeBuilder builder =
+        make_node("Reshape", "unflatten").Input(split, i).Input(shape);
+    Node* output;
+    TF_RETURN_IF_ERROR(finalize(builder, &output));
+    std::vector<const Edge*> out_edges(c.node->out_edges().begin(),
+                                       c.node->out_edges().end());
+    for (const Edge* e : out_edges) {
+      if (members.contains(e->dst())) {
+        continue;
+      }
+      if (e->IsControlEdge()) {
+        g->AddControlEdge(reduce, e->dst());
+      } else {
+        g->AddEdge(output, 0, e->dst(), e->dst_input());
+      }
+    }
+  }
+  for (const Candidate& c : bucket) {
+    g->RemoveNode(c.node);
+  }
+  VLOG(2) << "Fused " << bucket.size() << " collectives into "
+          << reduce->name();
+  return OkStatus();
+}
+
+}  // namespace
+
+CollectiveFusionPass::CollectiveFusionPass() {
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_COLLECTIVE_FUSION_THRESHOLD_BYTES",
+                                  /*default_val=*/0, &threshold_bytes_));
+}
+
+Status CollectiveFusionPass::Run(const GraphOptimizationPassOptions& options) {
+  if (threshold_bytes_ <= 0 || options.graph == nullptr) {
+    return OkStatus();
+  }
+  Graph* g = options.graph->get();
+  if (g == nullptr ||
+      std::none_of(g->op_nodes().begin(), g->op_nodes().end(),
+                   [](const Node* n) {
+                     return n->type_string() == kCollectiveReduceV2;
+                   })) {
+    return OkStatus();
+  }
+
+  std::vector<ControlFlowInfo> cf_info;
+  Status s = BuildControlFlowInfo(g, &cf_info);
+  if (!s.ok()) {
+    VLOG(1) << "Skipping collective fusion: " << s;
+    return OkStatus();
+  }
+  // Best-effort shape inference: nodes whose shapes cannot be inferred are
+  // simply not fused.
+  ShapeRefiner refiner(g->versions(), g->op_registry());
+  refiner.set_require_shape_inference_fns(false);
+  std::vector<Node*> order;
+  GetReversePostOrder(*g, &order, NodeComparatorName(),
+                      [](const Edge& e) { return !IsBackEdge(e); });
+  for (const Node* n : order) {
+    refiner.AddNode(n).IgnoreError();
+  }
+
+  // An ordered map, so that the buckets are fused in the same order on every
+  // worker.
+  std::map<string, std::vector<Candidate>> groups;
+  for (Node* n : order) {
+    Candidate candidate;
+    if (GetCandidate(n, refiner, threshold_bytes_, &candidate)) {
+      groups[FusionKey(n, cf_info[n->id()])].push_back(candidate);
+    }
+  }
+
+  std::vector<int> topo_index;
+  ComputeTopologicalIndex(*g, &topo_index);
+  auto flush = [g, &topo_index](std::vector<Candidate>* bucket) -> Status {
+    if (bucket->size() > 1) {
+      TF_RETURN_IF_ERROR(FuseBucket(g, *bucket));
+      ComputeTopologicalIndex(*g, &topo_index);
+    }
+    bucket->clear();
+    return OkStatus();
+  };
+  for (auto& group : groups) {
+    std::vector<Candidate>& candidates = group.second;
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) {
+                return std::make_pair(a.instance_key, a.node->name()) <
+                       std::make_pair(b.instance_key, b.node->name());
+              });
+    std::vector<Candidate> bucket;
+    int64_t bucket_bytes = 0;
+    for (const Candidate& candidate : candidates) {
+      if (!bucket.empty() &&
+          (bucket_bytes + candidate.bytes > threshold_bytes_ ||
+           CreatesCycle(*g, bucket, candidate.node, topo_index))) {
+        TF_RETURN_IF_ERROR(flush(&bucket));
+        bucket_bytes = 0;
+      }
+      bucket.push_back(candidate);
+      bucket_bytes += candidate.bytes;
+    }
+    TF_RETURN_IF_ERROR(flush(&bucket));
+  }
+  return OkStatus();
+}
+
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_PLACEMENT, 10,
+                      CollectiveFusionPass);
+
+}  // namespace tensorflow
@@ -0,0 +1,57 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_FUSION_PASS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_FUSION_PASS_H_
+
+#include <cstdint>
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+
+namespace tensorflow {
+
+// Fuses small `CollectiveReduceV2` ops into buckets that run as a single
+// all-reduce on a packed buffer.
+//
+// Two ops can share a bucket if they are placed on the same device, in the
+// same frame, and agree on the group, the ordering tokens and all reduction
+// attributes. The inputs of a bucket are flattened and concatenated, reduced
+// by one `CollectiveReduceV2` that uses the instance key of the first member,
+// and split back into the original shapes.
+//
+// Every worker must make the same fusion decisions, or the fused collectives
+// would not match up. Buckets are therefore formed from the graph alone:
+// candidates are visited in order of their (constant) instance keys and a
+// bucket is closed once adding the next input would exceed the threshold.
+// Ops whose input size or instance key is not statically known are left
+// alone, as are ops whose fusion would create a cycle.
+//
+// The pass is disabled unless a positive threshold is given, either to the
+// constructor or through the TF_COLLECTIVE_FUSION_THRESHOLD_BYTES environment
+// variable.
+class CollectiveFusionPass : public GraphOptimizationPass {
+ public:
+  CollectiveFusionPass();
+  explicit CollectiveFusionPass(int64_t threshold_bytes)
+      : threshold_bytes_(threshold_bytes) {}
+
+  Status Run(const GraphOptimizationPassOptions& options) override;
+
+ private:
+  int64_t threshold_bytes_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_FUSION_PASS_H_
@@ -0,0 +1,176 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_fusion_pass.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+class CollectiveFusionPassTest : public ::testing::Test {
+ protected:
+  CollectiveFusionPassTest()
+      : graph_(std::make_unique<Graph>(OpRegistry::Global())) {}
+
+  Node* Place(Node* n) {
+    n->set_assigned_device_name(kDevice);
+    return n;
+  }
+
+  Node* Const(const Tensor& value) {
+    Node* n;
+    TF_CHECK_OK(NodeBuilder(graph_->NewName("const"), "Const")
+                    .Attr("dtype", value.dtype())
+                    .Attr("value", value)
+                    .Finalize(graph_.get(), &n));
+    return Place(n);
+  }
+
+  Node* Identity(Node* input) {
+    Node* n;
+    TF_CHECK_OK(NodeBuilder(graph_->NewName("identity"), "Identity")
+                    .Input(input)
+                    .Finalize(graph_.get(), &n));
+    return Place(n);
+  }
+
+  Node* Reduce(Node* input, int instance_key, int group_key = 1) {
+    Node* n;
+    TF_CHECK_OK(NodeBuilder(graph_->NewName("reduce"), "CollectiveReduceV2")
+                    .Input(input)
+                    .Input(Const(Tensor(2)))
+                    .Input(Const(Tensor(group_key)))
+                    .Input(Const(Tensor(instance_key)))
+                    .Input(std::vector<NodeBuilder::NodeOut>())
+                    .Attr("merge_op", "Add")
+                    .Attr("final_op", "Div")
+                    .Finalize(graph_.get(), &n));
+    return Place(n);
+  }
+
+  Node* FloatInput(int num_elements) {
+    return Const(test::AsTensor<float>(std::vector<float>(num_elements, 1.0f),
+                                       {num_elements}));
+  }
+
+  void RunPass(int64_t threshold_bytes) {
+    GraphOptimizationPassOptions options;
+    options.graph = &graph_;
+    CollectiveFusionPass pass(threshold_bytes);
+    TF_ASSERT_OK(pass.Run(options));
+  }
+
+  std::vector<Node*> FindOps(const string& op) {
+    std::vector<Node*> nodes;
+    for (Node* n : graph_->op_nodes()) {
+      if (n->type_string() == op) {
+        nodes.push_back(n);
+      }
+    }
+    return nodes;
+  }
+
+  std::unique_ptr<Graph> graph_;
+};
+
+TEST_F(CollectiveFusionPassTest, FusesSmallReductions) {
+  Node* out3 = Identity(Reduce(FloatInput(3), /*instance_key=*/3));
+  Node* out1 = Identity(Reduce(
+      Const(test::AsTensor<float>({1, 2, 3, 4}, {2, 2})), /*instance_key=*/1));
+  Node* out2 = Identity(Reduce(FloatInput(1), /*instance_key=*/2));
+  RunPass(/*threshold_bytes=*/1024);
+
+  std::vector<Node*> reduces = FindOps("CollectiveReduceV2");
+  ASSERT_EQ(reduces.size(), 1);
+  // The fused op uses the smallest instance key of the bucket.
+  const Edge* instance_key;
+  TF_ASSERT_OK(reduces[0]->input_edge(3, &instance_key));
+  const TensorProto* value;
+  TF_ASSERT_OK(GetNodeAttr(instance_key->src()->attrs(), "value", &value));
+  EXPECT_EQ(value->int_val(0), 1);
+  EXPECT_EQ(reduces[0]->assigned_device_name(), kDevice);
+
+  // Members are packed in order of their instance keys.
+  std::vector<Node*> splits = FindOps("SplitV");
+  ASSERT_EQ(splits.size(), 1);
+  const Edge* size_splits;
+  TF_ASSERT_OK(splits[0]->input_edge(1, &size_splits));
+  TF_ASSERT_OK(GetNodeAttr(size_splits->src()->attrs(), "value", &value));
+  Tensor sizes;
+  ASSERT_TRUE(sizes.FromProto(*value));
+  test::ExpectTensorEqual<int32>(sizes, test::AsTensor<int32>({4, 1, 3}));
+
+  for (Node* out : {out1, out2, out3}) {
+    const Edge* e;
+    TF_ASSERT_OK(out->input_edge(0, &e));
+    EXPECT_EQ(e->src()->type_string(), "Reshape");
+  }
+}
+
+TEST_F(CollectiveFusionPassTest, RespectsThreshold) {
+  for (int instance_key = 1; instance_key <= 3; ++instance_key) {
+    Identity(Reduce(FloatInput(4), instance_key));
+  }
+  // Two 16-byte inputs fit under the threshold, the third does not.
+  RunPass(/*threshold_bytes=*/40);
+  EXPECT_EQ(FindOps("CollectiveReduceV2").size(), 2);
+  EXPECT_EQ(FindOps("SplitV").size(), 1);
+}
+
+TEST_F(CollectiveFusionPassTest, DisabledWithoutThreshold) {
+  Identity(Reduce(FloatInput(4), /*instance_key=*/1));
+  Identity(Reduce(FloatInput(4), /*instance_key=*/2));
+  RunPass(/*threshold_bytes=*/0);
+  EXPECT_EQ(FindOps("CollectiveReduceV2").size(), 2);
+}
+
+TEST_F(CollectiveFusionPassTest, DoesNotFuseDependentReductions) {
+  Node* first = Reduce(FloatInput(4), /*instance_key=*/1);
+  Identity(Reduce(Identity(first), /*instance_key=*/2));
+  RunPass(/*threshold_bytes=*/1024);
+  EXPECT_EQ(FindOps("CollectiveReduceV2").size(), 2);
+}
+
+TEST_F(CollectiveFusionPassTest, FusesControlDependentReductions) {
+  Node* first = Reduce(FloatInput(4), /*instance_key=*/1);
+  Node* second = Reduce(FloatInput(4), /*instance_key=*/2);
+  graph_->AddControlEdge(first, second);
+  Identity(first);
+  Identity(second);
+  RunPass(/*threshold_bytes=*/1024);
+  EXPECT_EQ(FindOps("CollectiveReduceV2").size(), 1);
+}
+
+TEST_F(CollectiveFusionPassTest, DoesNotFuseDifferentGroups) {
+  Identity(Reduce(FloatInput(4), /*instance_key=*/1, /*group_key=*/1));
+  Identity(Reduce(FloatInput(4), /*instance_key=*/2, /*group_key=*/2));
+  RunPass(/*threshold_bytes=*/1024);
+  EXPECT_EQ(FindOps("CollectiveReduceV2").size(), 2);
+}
+
+}  // namespace
+}  // namespace tensorflow
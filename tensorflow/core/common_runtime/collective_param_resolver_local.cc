@@ -67,7 +67,20 @@ const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
       return nccl ? "NcclBroadcast" : "HierarchicalTreeBroadcast";
 
     case REDUCTION_COLLECTIVE:
-      return nccl ? "NcclReduce" : "RingReduce";
+      // Only the partial reduction can complete without all contributions.
+      if (cp->instance.impl_details.min_contributions > 0) {
+        return "PartialReduce";
+      }
+      if (nccl) return "NcclReduce";
+      // The hierarchical ring requires the same number of devices in every
+      // task, so fall back to the flat ring for unbalanced groups.  Note that
+      // group_size % num_tasks == 0 is not enough, e.g. 3 + 1 devices.
+      if (cp->instance.impl_details.communication_hint ==
+              "hierarchical_ring" &&
+          cp->group.num_tasks > 0 && cp->group.same_num_devices_per_task) {
+        return "HierarchicalRingReduce";
+      }
+      return "RingReduce";
 
     case GATHER_COLLECTIVE:
       return nccl ? "NcclGather" : "RingGather";
@@ -447,11 +460,28 @@ GlobalDeviceMap EstablishGlobalRank(const CollGroupParams& gp,
     TaskDeviceMap& tdm = iter.second;
     OrderTaskDeviceMap(gpu_ring_order, &tdm);
   }
-  // Connect the global rank order by the lexicographical order of the tasks.
-  std::set<string> tasks;
+  // Connect the global rank order by the network position of the tasks, so
+  // that tasks under the same switch are adjacent in the ring and each switch
+  // boundary is crossed as few times as possible. Tasks without coordinates,
+  // or with equal ones, keep their lexicographical order.
+  std::vector<string> tasks;
+  std::unordered_map<string, const DeviceLocality*> task_locality;
   for (const CollGroupMember& member : gp.members) {
-    tasks.insert(member.task);
-  }
+    if (task_locality.emplace(member.task, &member.device.locality()).second) {
+      tasks.push_back(member.task);
+    }
+  }
+  std::sort(tasks.begin(), tasks.end());
+  std::stable_sort(tasks.begin(), tasks.end(),
+                   [&task_locality](const string& lhs, const string& rhs) {
+                     const auto& lhs_coords =
+                         task_locality.at(lhs)->network_coordinates();
+                     const auto& rhs_coords =
+                         task_locality.at(rhs)->network_coordinates();
+                     return std::lexicographical_compare(
+                         lhs_coords.begin(), lhs_coords.end(),
+                         rhs_coords.begin(), rhs_coords.end());
+                   });
   int next_rank = 0;
   for (const string& task : tasks) {
     TaskDeviceMap* tdm = &gdm[task];
@@ -732,6 +762,27 @@ void CollectiveParamResolverLocal::CompleteInstanceLocal(
                             " and data_type ", cp->instance.data_type));
       return;
     }
+    // Compressed values can only be decoded by members that expect them,
+    // and members must agree on the quorum of a partial reduction.
+    const CollImplDetails& expected = ir->shared->instance.impl_details;
+    const CollImplDetails& details = cp->instance.impl_details;
+    if (expected.min_contributions != details.min_contributions) {
+      done(errors::InvalidArgument(
+          "Collective instance ", cp->instance.instance_key,
+          " expected min_contributions ", expected.min_contributions,
+          " but got ", details.min_contributions));
+      return;
+    }
+    if (expected.compression != details.compression ||
+        (details.compression == COLLECTIVE_COMPRESSION_TOP_K &&
+         expected.topk_ratio != details.topk_ratio)) {
+      done(errors::InvalidArgument(
+          "Collective instance ", cp->instance.instance_key,
+          " expected compression ", expected.compression, " with topk_ratio ",
+          expected.topk_ratio, " but got compression ", details.compression,
+          " with topk_ratio ", details.topk_ratio));
+      return;
+    }
   }
   CompleteInstanceFromInitializedIRec(device, cp, ir, done);
 }
@@ -83,6 +83,39 @@ class CollectiveParamResolverLocalTest : public ::testing::Test {
     return device->attributes();
   }
 
+  void AssignCollectiveType(CollectiveParams* cp) {
+    prl_->AssignCollectiveType(cp);
+  }
+
+  // Returns reduction params for a group whose i-th task has
+  // devices_per_task[i] devices, already grouped the way FinishGroup does.
+  CollectiveParams* HierarchicalRingParams(
+      const std::vector<int>& devices_per_task) {
+    auto* cp = new CollectiveParams();
+    cp->instance.type = REDUCTION_COLLECTIVE;
+    cp->instance.impl_details.communication_hint = "hierarchical_ring";
+    cp->group.device_type = DeviceType("CPU");
+    for (int t = 0; t < devices_per_task.size(); ++t) {
+      string task = strings::StrCat("/job:worker/replica:0/task:", t);
+      for (int d = 0; d < devices_per_task[t]; ++d) {
+        CollGroupMember member;
+        member.device.set_name(strings::StrCat(task, "/device:CPU:", d));
+        member.task = task;
+        cp->group.members.push_back(member);
+        cp->group.num_devices_per_task[task]++;
+      }
+    }
+    cp->group.group_size = cp->group.members.size();
+    cp->group.num_tasks = devices_per_task.size();
+    cp->group.same_num_devices_per_task = true;
+    for (int n : devices_per_task) {
+      if (n != devices_per_task[0]) {
+        cp->group.same_num_devices_per_task = false;
+      }
+    }
+    return cp;
+  }
+
   string task_name_;
   std::unique_ptr<DeviceMgr> device_mgr_;
   std::unique_ptr<DeviceResolverLocal> drl_;
@@ -160,6 +193,32 @@ TEST_F(CollectiveParamResolverLocalTest, CompleteDefaultRanking) {
                             });
 }
 
+TEST_F(CollectiveParamResolverLocalTest, CompleteDefaultRankingByNetwork) {
+  // Tasks 0 and 2 share a rack, as do tasks 1 and 3.
+  const std::vector<std::vector<int32>> coordinates = {
+      {0, 0}, {0, 1}, {0, 0}, {0, 1}};
+  CollGroupParams group;
+  group.device_type = DeviceType("CPU");
+  group.num_tasks = coordinates.size();
+  group.group_size = coordinates.size();
+  for (int task = 0; task < coordinates.size(); ++task) {
+    CollGroupMember member;
+    member.task = strings::StrCat("/job:worker/replica:0/task:", task);
+    member.device.set_name(strings::StrCat(member.task, "/device:CPU:0"));
+    for (int32_t coordinate : coordinates[task]) {
+      member.device.mutable_locality()->add_network_coordinates(coordinate);
+    }
+    group.members.push_back(member);
+  }
+  RunCompleteDefaultRanking(group, {},
+                            {
+                                "/job:worker/replica:0/task:0/device:CPU:0",
+                                "/job:worker/replica:0/task:2/device:CPU:0",
+                                "/job:worker/replica:0/task:1/device:CPU:0",
+                                "/job:worker/replica:0/task:3/device:CPU:0",
+                            });
+}
+
 TEST_F(CollectiveParamResolverLocalTest, CompleteParamsReduction1Task) {
   CollectiveParams* cps[NUM_DEVS];
   Status statuses[NUM_DEVS];
@@ -208,6 +267,51 @@ TEST_F(CollectiveParamResolverLocalTest, CompleteParamsReduction1Task) {
   }
 }
 
+TEST_F(CollectiveParamResolverLocalTest, CompleteParamsCompressionMismatch) {
+  CollectiveParams* cps[NUM_DEVS];
+  Status statuses[NUM_DEVS];
+  Notification note[NUM_DEVS];
+  for (int i = 0; i < NUM_DEVS; ++i) {
+    cps[i] = new CollectiveParams();
+    CollectiveParams* cp = cps[i];
+    cp->group.group_key = 1;
+    cp->group.group_size = 3;
+    cp->group.device_type = DeviceType("CPU");
+    cp->group.num_tasks = 1;
+    cp->instance.instance_key = 7;
+    cp->instance.type = REDUCTION_COLLECTIVE;
+    cp->instance.data_type = DataType(DT_FLOAT);
+    cp->instance.shape = TensorShape({5});
+    // Only the first member compresses its transfers.
+    cp->instance.impl_details.compression =
+        i == 0 ? COLLECTIVE_COMPRESSION_BFLOAT16 : COLLECTIVE_COMPRESSION_NONE;
+    Env::Default()->SchedClosure([this, i, cp, &note, &statuses]() {
+      string device =
+          strings::StrCat("/job:localhost/replica:0/task:0/device:CPU:", i);
+      prl_->CompleteParamsAsync(GetDeviceAttributes(device), cp,
+                                nullptr /*CancellationManager*/,
+                                [&statuses, &note, i](const Status& s) {
+                                  statuses[i] = s;
+                                  note[i].Notify();
+                                });
+    });
+  }
+  for (int i = 0; i < NUM_DEVS; ++i) {
+    note[i].WaitForNotification();
+  }
+  int num_mismatches = 0;
+  for (int i = 0; i < NUM_DEVS; ++i) {
+    if (!statuses[i].ok()) {
+      EXPECT_EQ(statuses[i].code(), error::INVALID_ARGUMENT);
+      EXPECT_THAT(statuses[i].error_message(),
+                  ::testing::HasSubstr("expected compression"));
+      ++num_mismatches;
+    }
+    cps[i]->Unref();
+  }
+  EXPECT_GT(num_mismatches, 0);
+}
+
 void InitializeCollectiveParamsForBroadcast(int instance_key, int device_idx,
                                             bool is_source,
                                             CollectiveParams* cp) {
@@ -223,6 +327,22 @@ void InitializeCollectiveParamsForBroadcast(int instance_key, int device_idx,
   cp->is_source = is_source;
 }
 
+TEST_F(CollectiveParamResolverLocalTest, HierarchicalRingBalancedTasks) {
+  CollectiveParams* cp = HierarchicalRingParams({2, 2});
+  core::ScopedUnref unref(cp);
+  AssignCollectiveType(cp);
+  EXPECT_EQ(cp->instance.impl_details.collective_name,
+            "HierarchicalRingReduce");
+}
+
+TEST_F(CollectiveParamResolverLocalTest, HierarchicalRingUnbalancedTasks) {
+  // 4 devices over 2 tasks divide evenly, but the tasks are not balanced.
+  CollectiveParams* cp = HierarchicalRingParams({3, 1});
+  core::ScopedUnref unref(cp);
+  AssignCollectiveType(cp);
+  EXPECT_EQ(cp->instance.impl_details.collective_name, "RingReduce");
+}
+
 TEST_F(CollectiveParamResolverLocalTest, CompleteParamsBroadcast1Task) {
   constexpr int kInstanceKey = 5;
   CollectiveParams* cps[NUM_DEVS];
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -63,14 +64,17 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/core/threadpool_options.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/nccl/collective_communicator.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -90,6 +94,10 @@ auto* direct_session_runs = monitoring::Counter<0>::New(
     "/tensorflow/core/direct_session_runs",
     "The number of times DirectSession::Run() has been called.");
 
+// One in this many closures scheduled on an inter-op pool has its schedule
+// delay recorded.
+constexpr uint32 kInterOpScheduleDelaySamplingPeriod = 64;
+
 Status NewThreadPoolFromThreadPoolOptions(
     const SessionOptions& options,
     const ThreadPoolOptionProto& thread_pool_options, int pool_number,
@@ -98,6 +106,9 @@ Status NewThreadPoolFromThreadPoolOptions(
   if (num_threads == 0) {
     num_threads = NumInterOpThreadsFromSessionOptions(options);
   }
+  const bool allow_spinning =
+      !options.config.experimental().disable_thread_spinning() &&
+      !thread_pool_options.disable_spinning();
   const string& name = thread_pool_options.global_name();
   if (name.empty()) {
     // Session-local threadpool.
@@ -105,8 +116,7 @@ Status NewThreadPoolFromThreadPoolOptions(
             << pool_number << ": " << num_threads;
     *pool = new thread::ThreadPool(
         options.env, ThreadOptions(), strings::StrCat("Compute", pool_number),
-        num_threads, !options.config.experimental().disable_thread_spinning(),
-        /*allocator=*/nullptr);
+        num_threads, allow_spinning, /*allocator=*/nullptr);
     *owned = true;
     return OkStatus();
   }
@@ -122,8 +132,7 @@ Status NewThreadPoolFromThreadPoolOptions(
     mvalue->first = thread_pool_options.num_threads();
     mvalue->second = new thread::ThreadPool(
         options.env, ThreadOptions(), strings::StrCat("Compute", pool_number),
-        num_threads, !options.config.experimental().disable_thread_spinning(),
-        /*allocator=*/nullptr);
+        num_threads, allow_spinning, /*allocator=*/nullptr);
   } else {
     if (mvalue->first != thread_pool_options.num_threads()) {
       return errors::InvalidArgument(
@@ -156,6 +165,23 @@ string GetRendezvousKey(const string& tensor_name,
                          frame_iter.frame_id, ":", frame_iter.iter_id);
 }
 
+// Returns true if the kernel of `node_def` may be shared by the executors of
+// several signatures. Kernels of stateful ops are already shared through the
+// OpSegment, and function calls, or ops taking functions, hold handles
+// instantiated in a particular library.
+bool IsShareableKernel(FunctionLibraryRuntime* lib, const NodeDef& node_def) {
+  if (lib->IsStateful(node_def.op()) ||
+      lib->GetFunctionLibraryDefinition()->Find(node_def.op()) != nullptr) {
+    return false;
+  }
+  for (const auto& attr : node_def.attr()) {
+    if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 class DirectSessionFactory : public SessionFactory {
@@ -639,7 +665,19 @@ Status DirectSession::RunInternal(
     };
   } else {
     default_runner = [pool](Executor::Args::Closure c) {
-      pool->Schedule(std::move(c));
+      // Sample the delay until a thread picks up the closure, which includes
+      // waking up a parked thread, to tell how well the pool keeps up.
+      static thread_local uint32 num_scheduled = 0;
+      if (++num_scheduled % kInterOpScheduleDelaySamplingPeriod != 0) {
+        pool->Schedule(std::move(c));
+        return;
+      }
+      const uint64 schedule_time_us = Env::Default()->NowMicros();
+      pool->Schedule([c = std::move(c), schedule_time_us]() {
+        metrics::UpdateInterOpScheduleDelay(Env::Default()->NowMicros() -
+                                            schedule_time_us);
+        c();
+      });
     };
   }
 
@@ -865,10 +903,15 @@ Status DirectSession::Run(const RunOptions& run_options,
   metrics::RecordGraphInputTensors(input_size);
 
   // Check if we already have an executor for these arguments.
-  ExecutorsAndKeys* executors_and_keys;
+  std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
   RunStateArgs run_state_args(run_options.debug_options());
   run_state_args.collective_graph_key =
       run_options.experimental().collective_graph_key();
+  if (options_.config.experimental().max_shape_specialized_graphs() > 0) {
+    for (const auto& it : inputs) {
+      run_state_args.feed_shapes.emplace(it.first, it.second.shape());
+    }
+  }
 
   TF_RETURN_IF_ERROR(GetOrCreateExecutors(input_tensor_names, output_names,
                                           target_nodes, &executors_and_keys,
@@ -908,7 +951,7 @@ Status DirectSession::Run(const RunOptions& run_options,
   }
 
   TF_RETURN_IF_ERROR(RunInternal(step_id, run_options, &call_frame,
-                                 executors_and_keys, run_metadata,
+                                 executors_and_keys.get(), run_metadata,
                                  threadpool_options));
 
   // Receive outputs.
@@ -965,7 +1008,7 @@ Status DirectSession::PRunSetup(const std::vector<string>& input_names,
   thread::ThreadPool* pool = thread_pools_[0].first;
 
   // Check if we already have an executor for these arguments.
-  ExecutorsAndKeys* executors_and_keys;
+  std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
   // TODO(cais): TFDBG support for partial runs.
   DebugOptions debug_options;
   RunStateArgs run_state_args(debug_options);
@@ -980,6 +1023,7 @@ Status DirectSession::PRunSetup(const std::vector<string>& input_names,
   PartialRunState* run_state =
       new PartialRunState(input_names, output_names, args.step_id, &devices_);
   run_state->rendez.reset(new IntraProcessRendezvous(device_mgr_.get()));
+  run_state->executors_and_keys = executors_and_keys;
   {
     mutex_lock l(executor_lock_);
     if (!partial_runs_
@@ -1037,26 +1081,18 @@ Status DirectSession::PRun(const string& handle, const NamedTensorList& inputs,
                            const std::vector<string>& output_names,
                            std::vector<Tensor>* outputs) {
   TF_RETURN_IF_ERROR(CheckNotClosed());
-  std::vector<string> parts = str_util::Split(handle, ';');
-  const string& key = parts[0];
   // Get the executors for this partial run.
   ExecutorsAndKeys* executors_and_keys;
   PartialRunState* run_state;
   {
     mutex_lock l(executor_lock_);  // could use reader lock
-    auto exc_it = executors_.find(key);
-    if (exc_it == executors_.end()) {
-      return errors::InvalidArgument(
-          "Must run 'setup' before performing partial runs!");
-    }
-    executors_and_keys = exc_it->second.get();
-
     auto prun_it = partial_runs_.find(handle);
     if (prun_it == partial_runs_.end()) {
       return errors::InvalidArgument(
           "Must run 'setup' before performing partial runs!");
     }
     run_state = prun_it->second.get();
+    executors_and_keys = run_state->executors_and_keys.get();
 
     // Make sure that this is a new set of feeds that are still pending.
     for (const auto& input : inputs) {
@@ -1315,6 +1351,7 @@ Status DirectSession::CreateExecutors(
   options.use_function_convention = !run_state_args->is_partial_run;
   options.collective_graph_key =
       callable_options.run_options().experimental().collective_graph_key();
+  options.feed_shapes = run_state_args->feed_shapes;
   if (options_.config.experimental()
           .collective_deterministic_sequential_execution()) {
     options.collective_order = GraphCollectiveOrder::kEdges;
@@ -1324,6 +1361,15 @@ Status DirectSession::CreateExecutors(
 
   std::unique_ptr<FunctionInfo> func_info(new FunctionInfo);
   std::unique_ptr<ExecutorsAndKeys> ek(new ExecutorsAndKeys);
+  // Kernels created with the libraries of `func_info` may already be shared
+  // with other executors, so the libraries must outlive them even if the
+  // creation fails.
+  auto keep_func_info = gtl::MakeCleanup([this, &func_info, run_state_args] {
+    if (run_state_args->share_executors && func_info != nullptr) {
+      mutex_lock l(executor_lock_);
+      functions_.push_back(std::move(func_info));
+    }
+  });
 
   ek->callable_options = callable_options;
 
@@ -1390,14 +1436,19 @@ Status DirectSession::CreateExecutors(
     params.session_metadata = session_metadata;
     params.function_library = lib;
     auto opseg = device->op_segment();
+    const bool share_kernels = run_state_args->share_executors;
     params.create_kernel =
-        [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
-                           OpKernel** kernel) {
+        [this, lib, opseg, share_kernels](
+            const std::shared_ptr<const NodeProperties>& props,
+            OpKernel** kernel) {
           // NOTE(mrry): We must not share function kernels (implemented
           // using `CallOp`) between subgraphs, because `CallOp::handle_`
           // is tied to a particular subgraph. Even if the function itself
           // is stateful, the `CallOp` that invokes it is not.
           if (!OpSegment::ShouldOwnKernel(lib, props->node_def.op())) {
+            if (share_kernels && IsShareableKernel(lib, props->node_def)) {
+              return FindOrCreateSharedKernel(lib, props, kernel);
+            }
             return lib->CreateKernel(props, kernel);
           }
           auto create_fn = [lib, &props](OpKernel** kernel) {
@@ -1409,7 +1460,8 @@ Status DirectSession::CreateExecutors(
           return opseg->FindOrCreate(session_handle_, props->node_def.name(),
                                      kernel, create_fn);
         };
-    params.delete_kernel = [lib](OpKernel* kernel) {
+    params.delete_kernel = [this, lib, share_kernels](OpKernel* kernel) {
+      if (share_kernels && ReleaseSharedKernel(kernel)) return;
       if (kernel && !OpSegment::ShouldOwnKernel(lib, kernel->type_string()))
         delete kernel;
     };
@@ -1432,10 +1484,44 @@ Status DirectSession::CreateExecutors(
     item->executor = nullptr;
     item->device = device;
     auto executor_type = options_.config.experimental().executor_type();
+    const bool keep_graph =
+        !options_.config.experimental().disable_output_partition_graphs() ||
+        options_.config.graph_options().build_cost_model() > 0;
+
+    // Reuses the executor of an identical partition of another signature.
+    if (run_state_args->share_executors) {
+      GraphDef partition_graph_def;
+      partition_graph->ToGraphDef(&partition_graph_def);
+      string serialized_graph;
+      if (SerializeToStringDeterministic(partition_graph_def,
+                                         &serialized_graph)) {
+        const Fprint128 fingerprint = Fingerprint128(serialized_graph);
+        item->partition_key =
+            strings::StrCat(device->name(), "/", executor_type, "/",
+                            fingerprint.high64, "_", fingerprint.low64);
+        mutex_lock l(executor_lock_);
+        auto it = shared_partitions_.find(item->partition_key);
+        if (it != shared_partitions_.end()) {
+          item->executor = it->second.executor.lock();
+          item->graph = it->second.graph.lock();
+          if (item->executor == nullptr ||
+              (keep_graph && item->graph == nullptr)) {
+            item->executor = nullptr;
+            item->graph = nullptr;
+          }
+        }
+      }
+      if (item->executor != nullptr) {
+        VLOG(1) << "Sharing the executor of partition " << item->partition_key;
+        continue;
+      }
+    }
+
+    std::unique_ptr<Executor> executor;
     TF_RETURN_IF_ERROR(
-        NewExecutor(executor_type, params, *partition_graph, &item->executor));
-    if (!options_.config.experimental().disable_output_partition_graphs() ||
-        options_.config.graph_options().build_cost_model() > 0) {
+        NewExecutor(executor_type, params, *partition_graph, &executor));
+    item->executor = std::move(executor);
+    if (keep_graph) {
       item->graph = std::move(partition_graph);
     }
   }
@@ -1480,7 +1566,8 @@ Status DirectSession::CreateExecutors(
 
 Status DirectSession::GetOrCreateExecutors(
     gtl::ArraySlice<string> inputs, gtl::ArraySlice<string> outputs,
-    gtl::ArraySlice<string> target_nodes, ExecutorsAndKeys** executors_and_keys,
+    gtl::ArraySlice<string> target_nodes,
+    std::shared_ptr<ExecutorsAndKeys>* executors_and_keys,
     RunStateArgs* run_state_args) {
   int64_t handle_name_counter_value = -1;
   if (LogMemory::IsEnabled() || run_state_args->is_partial_run) {
@@ -1493,11 +1580,25 @@ Status DirectSession::GetOrCreateExecutors(
         run_state_args->debug_options.debug_tensor_watch_opts());
   }
 
+  // Appends the shapes of the fed tensors, in the order of `names`, to the key
+  // of executors specialized for them.
+  const auto append_feed_shapes = [run_state_args](
+                                      gtl::ArraySlice<string> names,
+                                      string* key) {
+    if (run_state_args->feed_shapes.empty()) return;
+    strings::StrAppend(key, "/");
+    for (const string& name : names) {
+      strings::StrAppend(
+          key, run_state_args->feed_shapes.at(name).DebugString(), ",");
+    }
+  };
+
   // Fast lookup path, no sorting.
-  const string key = strings::StrCat(
+  string key = strings::StrCat(
       absl::StrJoin(inputs, ","), "->", absl::StrJoin(outputs, ","), "/",
       absl::StrJoin(target_nodes, ","), "/", run_state_args->is_partial_run,
       "/", debug_tensor_watches_summary);
+  append_feed_shapes(inputs, &key);
   // Set the handle, if it's needed to log memory or for partial run.
   if (handle_name_counter_value >= 0) {
     run_state_args->handle =
@@ -1506,10 +1607,11 @@ Status DirectSession::GetOrCreateExecutors(
 
   // See if we already have the executors for this run.
   {
-    mutex_lock l(executor_lock_);  // could use reader lock
+    mutex_lock l(executor_lock_);
     auto it = executors_.find(key);
     if (it != executors_.end()) {
-      *executors_and_keys = it->second.get();
+      TouchCachedExecutors(it->second.get());
+      *executors_and_keys = it->second;
       return OkStatus();
     }
   }
@@ -1527,10 +1629,12 @@ Status DirectSession::GetOrCreateExecutors(
   std::vector<string> tn_sorted(target_nodes.begin(), target_nodes.end());
   std::sort(tn_sorted.begin(), tn_sorted.end());
 
-  const string sorted_key = strings::StrCat(
+  const string generic_sorted_key = strings::StrCat(
       absl::StrJoin(inputs_sorted, ","), "->",
       absl::StrJoin(outputs_sorted, ","), "/", absl::StrJoin(tn_sorted, ","),
       "/", run_state_args->is_partial_run, "/", debug_tensor_watches_summary);
+  string sorted_key = generic_sorted_key;
+  append_feed_shapes(inputs_sorted, &sorted_key);
   // Set the handle, if its needed to log memory or for partial run.
   if (handle_name_counter_value >= 0) {
     run_state_args->handle =
@@ -1538,13 +1642,26 @@ Status DirectSession::GetOrCreateExecutors(
   }
 
   // See if we already have the executors for this run.
+  bool max_shape_specializations_reached = false;
   {
     mutex_lock l(executor_lock_);
     auto it = executors_.find(sorted_key);
     if (it != executors_.end()) {
-      *executors_and_keys = it->second.get();
+      TouchCachedExecutors(it->second.get());
+      *executors_and_keys = it->second;
       return OkStatus();
     }
+    max_shape_specializations_reached =
+        !run_state_args->feed_shapes.empty() &&
+        num_shape_specialized_executors_[generic_sorted_key] >=
+            options_.config.experimental().max_shape_specialized_graphs();
+  }
+  // Once a signature has been specialized for the maximum number of shape
+  // combinations, other shapes run the executors for dynamic shapes.
+  if (max_shape_specializations_reached) {
+    run_state_args->feed_shapes.clear();
+    return GetOrCreateExecutors(inputs, outputs, target_nodes,
+                                executors_and_keys, run_state_args);
   }
 
   // Nothing found, so create the executors and store in the cache.
@@ -1568,11 +1685,16 @@ Status DirectSession::GetOrCreateExecutors(
   callable_options.mutable_run_options()
       ->mutable_experimental()
       ->set_collective_graph_key(run_state_args->collective_graph_key);
+  run_state_args->share_executors =
+      options_.config.experimental().share_executors_across_signatures();
   std::unique_ptr<ExecutorsAndKeys> ek;
   std::unique_ptr<FunctionInfo> func_info;
   TF_RETURN_IF_ERROR(
       CreateExecutors(callable_options, &ek, &func_info, run_state_args));
 
+  // Destroyed after executor_lock_ is released.
+  std::vector<std::shared_ptr<ExecutorsAndKeys>> evicted;
+
   // Reacquire the lock, try to insert into the map.
   mutex_lock l(executor_lock_);
 
@@ -1580,18 +1702,130 @@ Status DirectSession::GetOrCreateExecutors(
   // reuse the already created one.
   auto insert_result = executors_.emplace(
       sorted_key, std::shared_ptr<ExecutorsAndKeys>(std::move(ek)));
+  ExecutorsAndKeys* cached = insert_result.first->second.get();
   if (insert_result.second) {
     functions_.push_back(std::move(func_info));
+    if (!run_state_args->feed_shapes.empty()) {
+      ++num_shape_specialized_executors_[generic_sorted_key];
+      cached->shape_specialized_key = generic_sorted_key;
+    }
+    cached->cache_keys.push_back(sorted_key);
+    cached->lru_position = executors_lru_.insert(executors_lru_.end(), cached);
+    for (const PerPartitionExecutorsAndLib& item : cached->items) {
+      if (!item.partition_key.empty()) {
+        SharedPartition& shared = shared_partitions_[item.partition_key];
+        if (shared.executor.expired()) {
+          shared.executor = item.executor;
+          shared.graph = item.graph;
+        }
+      }
+    }
+  } else if (run_state_args->share_executors) {
+    // The kernels of the executors we created may be shared.
+    functions_.push_back(std::move(func_info));
   }
+  TouchCachedExecutors(cached);
 
   // Insert the value under the original key, so the fast path lookup will work
   // if the user uses the same order of inputs, outputs, and targets again.
-  executors_.emplace(key, insert_result.first->second);
-  *executors_and_keys = insert_result.first->second.get();
+  if (executors_.emplace(key, insert_result.first->second).second) {
+    cached->cache_keys.push_back(key);
+  }
+  *executors_and_keys = insert_result.first->second;
+  EvictCachedExecutors(&evicted);
+
+  return OkStatus();
+}
+
+void DirectSession::TouchCachedExecutors(ExecutorsAndKeys* executors_and_keys) {
+  executors_lru_.splice(executors_lru_.begin(), executors_lru_,
+                        executors_and_keys->lru_position);
+}
+
+void DirectSession::EvictCachedExecutors(
+    std::vector<std::shared_ptr<ExecutorsAndKeys>>* evicted) {
+  const int max_cached_executors =
+      options_.config.experimental().max_cached_executors();
+  if (max_cached_executors <= 0) return;
+  // Forgets the shared partitions of the executors evicted earlier.
+  for (auto it = shared_partitions_.begin(); it != shared_partitions_.end();) {
+    if (it->second.executor.expired()) {
+      shared_partitions_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  while (executors_lru_.size() > static_cast<size_t>(max_cached_executors)) {
+    ExecutorsAndKeys* executors_and_keys = executors_lru_.back();
+    executors_lru_.pop_back();
+    VLOG(1) << "Evicting the executors of " << executors_and_keys->cache_keys[0]
+            << " from the cache.";
+    if (!executors_and_keys->shape_specialized_key.empty()) {
+      --num_shape_specialized_executors_[executors_and_keys
+                                             ->shape_specialized_key];
+    }
+    // Runs in progress and partial runs keep their own references.
+    for (const string& key : executors_and_keys->cache_keys) {
+      auto it = executors_.find(key);
+      evicted->push_back(std::move(it->second));
+      executors_.erase(it);
+    }
+  }
+}
 
+Status DirectSession::FindOrCreateSharedKernel(
+    FunctionLibraryRuntime* lib,
+    const std::shared_ptr<const NodeProperties>& props, OpKernel** kernel) {
+  string serialized_node_def;
+  if (!SerializeToStringDeterministic(props->node_def, &serialized_node_def)) {
+    return lib->CreateKernel(props, kernel);
+  }
+  const Fprint128 fingerprint = Fingerprint128(serialized_node_def);
+  const string key =
+      strings::StrCat(lib->device()->name(), "/", props->node_def.name(), "/",
+                      fingerprint.high64, "_", fingerprint.low64);
+  {
+    mutex_lock l(shared_kernels_lock_);
+    auto it = shared_kernels_.find(key);
+    if (it != shared_kernels_.end()) {
+      ++it->second.second;
+      *kernel = it->second.first;
+      return OkStatus();
+    }
+  }
+  OpKernel* new_kernel = nullptr;
+  TF_RETURN_IF_ERROR(lib->CreateKernel(props, &new_kernel));
+  mutex_lock l(shared_kernels_lock_);
+  auto insert_result =
+      shared_kernels_.emplace(key, std::make_pair(new_kernel, 1));
+  if (insert_result.second) {
+    shared_kernel_keys_.emplace(new_kernel, key);
+  } else {
+    // Another executor created the kernel concurrently.
+    delete new_kernel;
+    ++insert_result.first->second.second;
+  }
+  *kernel = insert_result.first->second.first;
   return OkStatus();
 }
 
+bool DirectSession::ReleaseSharedKernel(OpKernel* kernel) {
+  OpKernel* unused_kernel = nullptr;
+  {
+    mutex_lock l(shared_kernels_lock_);
+    auto key_it = shared_kernel_keys_.find(kernel);
+    if (key_it == shared_kernel_keys_.end()) return false;
+    auto it = shared_kernels_.find(key_it->second);
+    if (--it->second.second == 0) {
+      unused_kernel = kernel;
+      shared_kernels_.erase(it);
+      shared_kernel_keys_.erase(key_it);
+    }
+  }
+  delete unused_kernel;
+  return true;
+}
+
 Status DirectSession::CreateGraphs(
     const BuildGraphOptions& subgraph_options,
     std::unordered_map<string, std::unique_ptr<Graph>>* outputs,
@@ -1861,6 +2095,13 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("MakeCallable()"));
 
+  if (callable_options.fetch_into_provided_tensors() &&
+      !callable_options.fetch_devices().empty()) {
+    return errors::InvalidArgument(
+        "fetch_into_provided_tensors requires the fetched tensors to be "
+        "backed by host memory, but fetch_devices is set.");
+  }
+
   std::unique_ptr<ExecutorsAndKeys> ek;
   std::unique_ptr<FunctionInfo> func_info;
   RunStateArgs run_state_args(callable_options.run_options().debug_options());
@@ -1879,10 +2120,12 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   RunCallableCallFrame(DirectSession* session,
                        ExecutorsAndKeys* executors_and_keys,
                        const std::vector<Tensor>* feed_tensors,
+                       std::vector<Tensor>* owned_feed_tensors,
                        std::vector<Tensor>* fetch_tensors)
       : session_(session),
         executors_and_keys_(executors_and_keys),
         feed_tensors_(feed_tensors),
+        owned_feed_tensors_(owned_feed_tensors),
         fetch_tensors_(fetch_tensors) {}
 
   size_t num_args() const override {
@@ -1901,19 +2144,57 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     return OkStatus();
   }
 
+  // Moving an owned feed into the graph leaves its buffer with a single
+  // reference, so that the kernels reading it may forward it.
+  void ConsumeArg(int index, Tensor* val) override {
+    *val = std::move((*owned_feed_tensors_)[index]);
+  }
+  bool CanConsumeArg(int index) const override {
+    return owned_feed_tensors_ != nullptr;
+  }
+
   Status SetRetval(int index, const Tensor& val) override {
     if (index > fetch_tensors_->size()) {
       return errors::Internal("RetVal index out of bounds: ", index);
     }
+    if (executors_and_keys_->callable_options.fetch_into_provided_tensors()) {
+      return CopyIntoProvidedTensor(val, &(*fetch_tensors_)[index]);
+    }
     (*fetch_tensors_)[index] = val;
     return OkStatus();
   }
 
  private:
+  // Copies `val` into the buffer of `fetch`, which the caller of
+  // RunCallable() provided for it.
+  static Status CopyIntoProvidedTensor(const Tensor& val, Tensor* fetch) {
+    if (fetch->dtype() != val.dtype() || fetch->shape() != val.shape()) {
+      return errors::InvalidArgument(
+          "Provided fetch tensor of type ", DataTypeString(fetch->dtype()),
+          " and shape ", fetch->shape().DebugString(),
+          " does not match the fetched tensor of type ",
+          DataTypeString(val.dtype()), " and shape ",
+          val.shape().DebugString());
+    }
+    if (!DataTypeCanUseMemcpy(val.dtype())) {
+      return errors::InvalidArgument("Cannot fetch a tensor of type ",
+                                     DataTypeString(val.dtype()),
+                                     " into a provided tensor.");
+    }
+    // The fetched value may already live in the provided buffer, e.g. when
+    // that buffer was also fed and is fetched unchanged.
+    if (val.TotalBytes() > 0 && fetch->data() != val.data()) {
+      std::memcpy(fetch->data(), val.data(), val.TotalBytes());
+    }
+    return OkStatus();
+  }
+
   DirectSession* const session_;                   // Not owned.
   ExecutorsAndKeys* const executors_and_keys_;     // Not owned.
   const std::vector<Tensor>* const feed_tensors_;  // Not owned.
-  std::vector<Tensor>* const fetch_tensors_;       // Not owned.
+  // May be null. Not owned.
+  std::vector<Tensor>* const owned_feed_tensors_;
+  std::vector<Tensor>* const fetch_tensors_;  // Not owned.
 };
 
 ::tensorflow::Status DirectSession::RunCallable(
@@ -1927,6 +2208,31 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     CallableHandle handle, const std::vector<Tensor>& feed_tensors,
     std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
     const thread::ThreadPoolOptions& threadpool_options) {
+  return RunCallableInternal(handle, feed_tensors,
+                             /*owned_feed_tensors=*/nullptr, fetch_tensors,
+                             run_metadata, threadpool_options);
+}
+
+::tensorflow::Status DirectSession::RunCallable(
+    CallableHandle handle, std::vector<Tensor>&& feed_tensors,
+    std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata) {
+  return RunCallable(handle, std::move(feed_tensors), fetch_tensors,
+                     run_metadata, thread::ThreadPoolOptions());
+}
+
+::tensorflow::Status DirectSession::RunCallable(
+    CallableHandle handle, std::vector<Tensor>&& feed_tensors,
+    std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+    const thread::ThreadPoolOptions& threadpool_options) {
+  return RunCallableInternal(handle, feed_tensors, &feed_tensors,
+                             fetch_tensors, run_metadata, threadpool_options);
+}
+
+::tensorflow::Status DirectSession::RunCallableInternal(
+    CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+    std::vector<Tensor>* owned_feed_tensors,
+    std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+    const thread::ThreadPoolOptions& threadpool_options) {
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("RunCallable()"));
   direct_session_runs->GetCell()->IncrementBy(1);
@@ -1960,7 +2266,15 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
         "Expected ", executors_and_keys->input_types.size(),
         " feed tensors, but got ", feed_tensors.size());
   }
-  if (fetch_tensors != nullptr) {
+  if (executors_and_keys->callable_options.fetch_into_provided_tensors()) {
+    if (fetch_tensors == nullptr ||
+        fetch_tensors->size() != executors_and_keys->output_types.size()) {
+      return errors::InvalidArgument(
+          "Expected ", executors_and_keys->output_types.size(),
+          " provided fetch tensors, but got ",
+          fetch_tensors == nullptr ? 0 : fetch_tensors->size());
+    }
+  } else if (fetch_tensors != nullptr) {
     fetch_tensors->resize(executors_and_keys->output_types.size());
   } else if (!executors_and_keys->output_types.empty()) {
     return errors::InvalidArgument(
@@ -1992,6 +2306,7 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
       }
     }
     actual_feed_tensors = converted_feed_tensors.get();
+    owned_feed_tensors = converted_feed_tensors.get();
   } else {
     actual_feed_tensors = &feed_tensors;
   }
@@ -1999,7 +2314,8 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   // A specialized CallFrame implementation that takes advantage of the
   // optimized RunCallable interface.
   RunCallableCallFrame call_frame(this, executors_and_keys.get(),
-                                  actual_feed_tensors, fetch_tensors);
+                                  actual_feed_tensors, owned_feed_tensors,
+                                  fetch_tensors);
 
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(step_id, run_state_args.handle);
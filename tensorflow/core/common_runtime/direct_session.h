@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_DIRECT_SESSION_H_
 
 #include <atomic>
+#include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -131,6 +132,16 @@ class DirectSession : public Session {
       std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
       const thread::ThreadPoolOptions& threadpool_options) override;
 
+  ::tensorflow::Status RunCallable(CallableHandle handle,
+                                   std::vector<Tensor>&& feed_tensors,
+                                   std::vector<Tensor>* fetch_tensors,
+                                   RunMetadata* run_metadata) override;
+
+  ::tensorflow::Status RunCallable(
+      CallableHandle handle, std::vector<Tensor>&& feed_tensors,
+      std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options) override;
+
   ::tensorflow::Status ReleaseCallable(CallableHandle handle) override;
 
   ::tensorflow::Status Finalize() override;
@@ -142,12 +153,15 @@ class DirectSession : public Session {
   friend class DirectSessionCollectiveTest;
 
   // We create one executor and its dependent library runtime for
-  // every partition.
+  // every partition. The graph and the executor may be shared with other
+  // ExecutorsAndKeys running an identical partition, in which case
+  // 'partition_key' identifies it.
   struct PerPartitionExecutorsAndLib {
-    std::unique_ptr<Graph> graph = nullptr;
+    std::shared_ptr<Graph> graph = nullptr;
     Device* device = nullptr;                // not owned.
     FunctionLibraryRuntime* flib = nullptr;  // not owned.
-    std::unique_ptr<Executor> executor;
+    std::shared_ptr<Executor> executor;
+    string partition_key;
   };
 
   // An ExecutorsAndKeys is created for a given set of feeds/fetches.
@@ -176,6 +190,16 @@ class DirectSession : public Session {
     CallableOptions callable_options;
 
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+    // If not empty, the shapes of the fed tensors keyed by input name. The
+    // executors are then looked up, or created, for exactly these shapes.
+    std::unordered_map<string, TensorShape> feed_shapes;
+
+    // The keys of this object in executors_, its position in executors_lru_,
+    // and, if it is specialized for feed shapes, the key of the signature it
+    // specializes. Guarded by executor_lock_.
+    std::vector<string> cache_keys;
+    std::list<ExecutorsAndKeys*>::iterator lru_position;
+    string shape_specialized_key;
   };
 
   // A FunctionInfo object is created for every unique set of feeds/fetches.
@@ -216,6 +240,8 @@ class DirectSession : public Session {
     std::unordered_map<string, bool> pending_inputs;   // true if fed
     std::unordered_map<string, bool> pending_outputs;  // true if fetched
     core::RefCountPtr<IntraProcessRendezvous> rendez = nullptr;
+    // Keeps the executors alive if they are evicted from the cache.
+    std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
 
     PartialRunState(const std::vector<string>& pending_input_names,
                     const std::vector<string>& pending_output_names,
@@ -236,6 +262,9 @@ class DirectSession : public Session {
     std::unique_ptr<Graph> graph;
     const DebugOptions& debug_options;
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+    // If true, the created executors may share kernels and partitions with
+    // the cached executors of other signatures.
+    bool share_executors = false;
   };
 
   // Retrieves an already existing set of executors to run 'inputs' and
@@ -243,7 +272,28 @@ class DirectSession : public Session {
   ::tensorflow::Status GetOrCreateExecutors(
       gtl::ArraySlice<string> inputs, gtl::ArraySlice<string> outputs,
       gtl::ArraySlice<string> target_nodes,
-      ExecutorsAndKeys** executors_and_keys, RunStateArgs* run_state_args);
+      std::shared_ptr<ExecutorsAndKeys>* executors_and_keys,
+      RunStateArgs* run_state_args);
+
+  // Marks 'executors_and_keys' as the most recently used cached executors.
+  void TouchCachedExecutors(ExecutorsAndKeys* executors_and_keys)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(executor_lock_);
+
+  // Evicts the least recently used executors until at most
+  // max_cached_executors are cached. The evicted executors are moved to
+  // 'evicted', so that they can be destroyed without holding executor_lock_.
+  void EvictCachedExecutors(
+      std::vector<std::shared_ptr<ExecutorsAndKeys>>* evicted)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(executor_lock_);
+
+  // Looks up the shared kernel of the node 'props', or creates it with 'lib'.
+  ::tensorflow::Status FindOrCreateSharedKernel(
+      FunctionLibraryRuntime* lib,
+      const std::shared_ptr<const NodeProperties>& props, OpKernel** kernel);
+
+  // Releases a kernel returned by FindOrCreateSharedKernel(), deleting it
+  // once it has no user left. Returns false if 'kernel' is not shared.
+  bool ReleaseSharedKernel(OpKernel* kernel);
 
   // Creates a set of executors to run the subgraph defined by
   // `callable_options`.
@@ -269,6 +319,14 @@ class DirectSession : public Session {
       RunMetadata* run_metadata,
       const thread::ThreadPoolOptions& threadpool_options);
 
+  // Runs the callable `handle` on `feed_tensors`. If `owned_feed_tensors` is
+  // not null, it must point to `feed_tensors`, which the run may consume.
+  ::tensorflow::Status RunCallableInternal(
+      CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+      std::vector<Tensor>* owned_feed_tensors,
+      std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options);
+
   // Returns whether inter-op execution uses a global pool or the input
   // `run_options` requests being run on inter_op_thread_pool = 0 in case
   // multiple pools are configured.
@@ -366,6 +424,31 @@ class DirectSession : public Session {
   // same ExecutorsAndKey object.
   std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
       TF_GUARDED_BY(executor_lock_);
+  // Number of shape-specialized executors created for each signature, see
+  // ConfigProto.Experimental.max_shape_specialized_graphs.
+  std::unordered_map<string, int> num_shape_specialized_executors_
+      TF_GUARDED_BY(executor_lock_);
+  // The cached executors, from the most to the least recently used.
+  std::list<ExecutorsAndKeys*> executors_lru_ TF_GUARDED_BY(executor_lock_);
+
+  // The partitions of the cached executors that later executors can share,
+  // keyed by PerPartitionExecutorsAndLib::partition_key. See
+  // ConfigProto.Experimental.share_executors_across_signatures.
+  struct SharedPartition {
+    std::weak_ptr<Graph> graph;
+    std::weak_ptr<Executor> executor;
+  };
+  std::unordered_map<string, SharedPartition> shared_partitions_
+      TF_GUARDED_BY(executor_lock_);
+
+  // The stateless kernels shared by the executors of several signatures,
+  // keyed by device, node name and fingerprint of the NodeDef, with their
+  // number of users.
+  mutex shared_kernels_lock_;
+  std::unordered_map<string, std::pair<OpKernel*, int>> shared_kernels_
+      TF_GUARDED_BY(shared_kernels_lock_);
+  std::unordered_map<const OpKernel*, string> shared_kernel_keys_
+      TF_GUARDED_BY(shared_kernels_lock_);
 
   class RunCallableCallFrame;
   struct Callable {
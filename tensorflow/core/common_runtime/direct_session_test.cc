@@ -551,6 +551,79 @@ TEST_F(DirectSessionMinusAXTest, TestFeed_Callable) {
   EXPECT_FLOAT_EQ(39.0, mat(1, 0));
 }
 
+// Returns a graph computing "y" = -"x", for a float vector "x" of 4 elements.
+GraphDef NegGraph() {
+  Graph graph(OpRegistry::Global());
+  Node* x = test::graph::Constant(&graph, Tensor(DT_FLOAT, TensorShape({4})),
+                                  "x");
+  TF_CHECK_OK(NodeBuilder("y", "Neg").Input(x).Finalize(&graph, nullptr));
+  GraphDef def;
+  graph.ToGraphDef(&def);
+  return def;
+}
+
+TEST(DirectSessionTest, RunCallableForwardsOwnedFeeds) {
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(NegGraph()));
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(MakeCallableOptions({"x"}, {"y"}, {}),
+                                     &handle));
+
+  std::vector<Tensor> inputs = {test::AsTensor<float>({1, 2, 3, 4})};
+  const float* input_data = inputs[0].flat<float>().data();
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(
+      session->RunCallable(handle, std::move(inputs), &outputs, nullptr));
+
+  ASSERT_EQ(1, outputs.size());
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({-1, -2, -3, -4}),
+                                 outputs[0]);
+  // The fed buffer had no other reference, so Neg computed in place.
+  EXPECT_EQ(input_data, outputs[0].flat<float>().data());
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
+TEST(DirectSessionTest, RunCallableFetchesIntoProvidedTensors) {
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(NegGraph()));
+  CallableOptions callable_options = MakeCallableOptions({"x"}, {"y"}, {});
+  callable_options.set_fetch_into_provided_tensors(true);
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  const Tensor input = test::AsTensor<float>({1, 2, 3, 4});
+  std::vector<Tensor> outputs = {Tensor(DT_FLOAT, TensorShape({4}))};
+  const float* output_data = outputs[0].flat<float>().data();
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(session->RunCallable(handle, {input}, &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ(output_data, outputs[0].flat<float>().data());
+    test::ExpectTensorEqual<float>(test::AsTensor<float>({-1, -2, -3, -4}),
+                                   outputs[0]);
+  }
+  // The feed is unchanged, since it was still referenced by `input`.
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({1, 2, 3, 4}), input);
+
+  std::vector<Tensor> missing_outputs;
+  Status s =
+      session->RunCallable(handle, {input}, &missing_outputs, nullptr);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+
+  std::vector<Tensor> mismatched_outputs = {
+      Tensor(DT_FLOAT, TensorShape({2, 2}))};
+  s = session->RunCallable(handle, {input}, &mismatched_outputs, nullptr);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "does not match")) << s;
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+
+  (*callable_options.mutable_fetch_devices())["y"] =
+      "/job:localhost/replica:0/task:0/device:CPU:0";
+  s = session->MakeCallable(callable_options, &handle);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
 TEST_F(DirectSessionMinusAXTest, TestConcurrency) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -996,6 +1069,114 @@ TEST(DirectSessionTest, MultipleFeedTest_Callable) {
   EXPECT_TRUE(absl::StrContains(s.error_message(), "fed more than once"));
 }
 
+TEST(DirectSessionTest, ShapeSpecializedGraphs) {
+  Graph g(OpRegistry::Global());
+  Node* x;
+  TF_ASSERT_OK(NodeBuilder("x", "Placeholder")
+                   .Attr("dtype", DT_FLOAT)
+                   .Attr("shape", PartialTensorShape({-1}))
+                   .Finalize(&g, &x));
+  Node* y = test::graph::Unary(&g, "Shape", x);
+  Node* z = test::graph::Unary(&g, "Identity", y);
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_max_shape_specialized_graphs(2);
+  options.config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_min_graph_nodes(-1);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+
+  RunOptions run_options;
+  run_options.set_output_partition_graphs(true);
+  for (int size : {2, 3, 2, 4}) {
+    Tensor x_value(DT_FLOAT, TensorShape({size}));
+    x_value.flat<float>().setZero();
+    std::vector<Tensor> outputs;
+    RunMetadata run_metadata;
+    TF_ASSERT_OK(session->Run(run_options, {{x->name(), x_value}},
+                              {z->name() + ":0"}, {}, &outputs,
+                              &run_metadata));
+    ASSERT_EQ(1, outputs.size());
+    test::ExpectTensorEqual<int32>(test::AsTensor<int32>({size}), outputs[0]);
+
+    // The first two shapes get graphs in which the shape is folded, while the
+    // last one runs the graph optimized for dynamic shapes.
+    bool has_shape_op = false;
+    for (const GraphDef& partition : run_metadata.partition_graphs()) {
+      for (const NodeDef& node : partition.node()) {
+        if (node.op() == "Shape") has_shape_op = true;
+      }
+    }
+    EXPECT_EQ(size == 4, has_shape_op) << "size: " << size;
+  }
+}
+
+TEST_F(DirectSessionMinusAXTest, BoundedExecutorsCache) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_max_cached_executors(1);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // The partial run keeps its executors while other signatures evict them.
+  string handle;
+  TF_ASSERT_OK(session->PRunSetup({}, {y_ + ":0"}, {}, &handle));
+
+  // Every run evicts the executors of the previous signature.
+  for (int i = 0; i < 2; ++i) {
+    for (const string& fetch : {y_, y_neg_, z_}) {
+      std::vector<Tensor> outputs;
+      TF_ASSERT_OK(session->Run({}, {fetch + ":0"}, {}, &outputs));
+      ASSERT_EQ(1, outputs.size());
+      const float expected = fetch == y_ ? 5.0 : -5.0;
+      EXPECT_FLOAT_EQ(expected, outputs[0].matrix<float>()(0, 0));
+    }
+  }
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->PRun(handle, {}, {y_ + ":0"}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+}
+
+TEST_F(DirectSessionMinusAXTest, ShareExecutorsAcrossSignatures) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_share_executors_across_signatures(
+      true);
+  options.config.mutable_experimental()->set_max_cached_executors(2);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  RunOptions run_options;
+  run_options.set_output_partition_graphs(true);
+  for (int i = 0; i < 2; ++i) {
+    for (const std::vector<string>& fetches :
+         std::vector<std::vector<string>>{{y_ + ":0"},
+                                          {y_neg_ + ":0"},
+                                          {y_ + ":0", z_ + ":0"},
+                                          {z_ + ":0", y_ + ":0"},
+                                          {z_ + ":0"}}) {
+      std::vector<Tensor> outputs;
+      RunMetadata run_metadata;
+      TF_ASSERT_OK(session->Run(run_options, {}, fetches, {}, &outputs,
+                                &run_metadata));
+      ASSERT_EQ(fetches.size(), outputs.size());
+      for (int j = 0; j < fetches.size(); ++j) {
+        const float expected = fetches[j] == y_ + ":0" ? 5.0 : -5.0;
+        EXPECT_FLOAT_EQ(expected, outputs[j].matrix<float>()(0, 0));
+      }
+      EXPECT_GT(run_metadata.partition_graphs_size(), 0);
+    }
+  }
+}
+
 TEST(DirectSessionTest, TestTensorConnectionUseTwice) {
   Graph graph(OpRegistry::Global());
 
@@ -2179,6 +2360,33 @@ TEST(DirectSessionTest, TestSessionInterOpThreadsInvalidOptions) {
   }
 }
 
+TEST(DirectSessionTest, TestSessionInterOpThreadsWithoutSpinning) {
+  Graph g(OpRegistry::Global());
+  Tensor t(DT_FLOAT, TensorShape({}));
+  t.scalar<float>()() = {1.2f};
+  Node* x = test::graph::Constant(&g, t);
+  Node* y = test::graph::Unary(&g, "Neg", x);
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  SessionOptions options;
+  options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_opt_level(OptimizerOptions::L0);
+  auto* pool_config = options.config.add_session_inter_op_thread_pool();
+  pool_config->set_num_threads(2);
+  pool_config->set_disable_spinning(true);
+
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_ASSERT_OK(session->Create(def));
+  for (int i = 0; i < 100; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {y->name() + ":0"}, {}, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_FLOAT_EQ(outputs[0].scalar<float>()(), -1.2f);
+  }
+}
+
 TEST(DirectSessionTest, TestDirectSessionRunClose) {
   // Construct a graph with a variable and a single assign.
   Graph g(OpRegistry::Global());
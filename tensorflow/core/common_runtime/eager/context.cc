@@ -88,6 +88,14 @@ bool ReadBoolFromEnvVar(StringPiece env_var_name, bool default_val) {
   return default_val;
 }
 
+int64_t ReadInt64FromEnvVar(StringPiece env_var_name, int64_t default_val) {
+  int64_t val;
+  if (tensorflow::ReadInt64FromEnvVar(env_var_name, default_val, &val).ok()) {
+    return val;
+  }
+  return default_val;
+}
+
 auto* eager_context_created =
     monitoring::Gauge<bool, 0>::New("/tensorflow/core/eager_context_created",
                                     "True if an eager context was created.");
@@ -163,6 +171,11 @@ EagerContext::EagerContext(
       rendezvous_(rendezvous),
       thread_pool_(NewThreadPoolFromSessionOptions(opts)),
       cluster_flr_(cluster_flr),
+      kernel_cache_shard_capacity_(
+          (std::max<int64_t>(
+               ReadInt64FromEnvVar("TF_EAGER_KERNEL_CACHE_MAX_SIZE", 0), 0) +
+           kNumKernelCacheShards - 1) /
+          kNumKernelCacheShards),
       log_device_placement_(opts.config.log_device_placement()),
       allow_soft_placement_(opts.config.allow_soft_placement()),
       num_active_steps_(0),
@@ -486,7 +499,11 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     // during this time as well.
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
-    kernel_cache_.clear();
+    for (auto& shard : kernel_cache_shards_) {
+      mutex_lock sl(shard.mu);
+      shard.kernels.clear();
+    }
+    kernel_cache_generation_.fetch_add(1, std::memory_order_release);
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
     }
@@ -954,7 +971,7 @@ Status EagerContext::AddFunctionDef(const FunctionDef& fdef,
     if (registered_function == nullptr) {
       registered_function = new RegisteredFunction;
       registered_function->cached_kernel_keys =
-          std::make_unique<std::vector<Fprint128>>();
+          std::make_unique<absl::flat_hash_set<Fprint128, Fprint128Hasher>>();
       gtl::InsertOrUpdate(&registered_functions_, fdef.signature().name(),
                           registered_function);
     } else {
@@ -1006,9 +1023,12 @@ Status EagerContext::RemoveFunction(const string& func) {
   }
   bool is_last_ref = registered_function->RefCountIsOne();
   if (is_last_ref) {
-    for (auto& key : *registered_function->cached_kernel_keys) {
-      kernel_cache_.erase(key);
+    for (const auto& key : *registered_function->cached_kernel_keys) {
+      KernelCacheShard& shard = GetKernelCacheShard(key);
+      mutex_lock sl(shard.mu);
+      shard.kernels.erase(key);
     }
+    kernel_cache_generation_.fetch_add(1, std::memory_order_release);
     registered_functions_.erase(func);
   }
   registered_function->Unref();
@@ -1075,12 +1095,17 @@ Status EagerContext::SyncExecutors() {
 
 core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
     Fprint128 cache_key) {
-  tf_shared_lock l(cache_mu_);
-  auto iter = kernel_cache_.find(cache_key);
-  if (iter == kernel_cache_.end()) {
+  KernelCacheShard& shard = GetKernelCacheShard(cache_key);
+  tf_shared_lock l(shard.mu);
+  auto iter = shard.kernels.find(cache_key);
+  if (iter == shard.kernels.end()) {
     return nullptr;
   }
-  core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
+  if (kernel_cache_shard_capacity_ > 0) {
+    iter->second.last_use.store(shard.clock.fetch_add(1) + 1,
+                                std::memory_order_relaxed);
+  }
+  core::RefCountPtr<KernelAndDevice> new_ref(iter->second.kernel.get());
   new_ref->Ref();
   return new_ref;
 }
@@ -1097,12 +1122,38 @@ void EagerContext::AddKernelToCache(Fprint128 cache_key,
   mutex_lock ml(cache_mu_);
   core::RefCountPtr<KernelAndDevice> new_ref(kernel);
   new_ref->Ref();
-  kernel_cache_[cache_key] = std::move(new_ref);
+  {
+    KernelCacheShard& shard = GetKernelCacheShard(cache_key);
+    mutex_lock sl(shard.mu);
+    KernelCacheEntry& entry = shard.kernels[cache_key];
+    entry.kernel = std::move(new_ref);
+    if (kernel_cache_shard_capacity_ > 0) {
+      entry.last_use.store(shard.clock.fetch_add(1) + 1,
+                           std::memory_order_relaxed);
+      // Kernels are only added on a cache miss, after the kernel has been
+      // created, so a linear scan for the least recently used one is cheap in
+      // comparison.
+      while (static_cast<int64_t>(shard.kernels.size()) >
+             kernel_cache_shard_capacity_) {
+        auto lru = shard.kernels.end();
+        for (auto it = shard.kernels.begin(); it != shard.kernels.end();
+             ++it) {
+          if (lru == shard.kernels.end() ||
+              it->second.last_use.load(std::memory_order_relaxed) <
+                  lru->second.last_use.load(std::memory_order_relaxed)) {
+            lru = it;
+          }
+        }
+        // The kernel stays alive as long as it is referenced by pending ops.
+        shard.kernels.erase(lru);
+      }
+    }
+  }
   auto* registered_function =
       gtl::FindPtrOrNull(registered_functions_, kernel->name());
   // The kernel name can be either a primitive op or a function.
   if (registered_function != nullptr) {
-    registered_function->cached_kernel_keys->emplace_back(cache_key);
+    registered_function->cached_kernel_keys->insert(cache_key);
   }
 }
 
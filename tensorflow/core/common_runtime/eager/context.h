@@ -16,6 +16,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_CONTEXT_H_
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <map>
 #include <memory>
@@ -25,6 +27,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/types/optional.h"
 #include "tensorflow/c/eager/immediate_execution_context.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
@@ -265,6 +268,13 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
   void AddDeviceToCache(Fprint128 device_cache_key, Device* device);
 
+  // Incremented whenever kernels are removed from the cache other than by
+  // eviction, after which the kernels held outside of the cache must not be
+  // reused either.
+  int64_t KernelCacheGeneration() const {
+    return kernel_cache_generation_.load(std::memory_order_acquire);
+  }
+
   bool LogDevicePlacement() const { return log_device_placement_; }
   void SetLogDevicePlacement(bool enable) override {
     log_device_placement_ = enable;
@@ -744,16 +754,42 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   std::function<void(std::function<void()>)> runner_;
 
+  // The kernel cache is split in shards with their own lock, so that the
+  // lookups of concurrent op dispatches do not contend on a single lock.
+  // Kernels are only added under `cache_mu_`, which is acquired before the
+  // lock of any shard.
+  static constexpr int kNumKernelCacheShards = 16;
+  struct KernelCacheEntry {
+    core::RefCountPtr<KernelAndDevice> kernel;
+    // Clock of the shard when the kernel was last used, only maintained for
+    // bounded caches.
+    std::atomic<uint64> last_use{0};
+  };
+  // Aligned to avoid the false sharing of the locks of neighbouring shards.
+  struct alignas(64) KernelCacheShard {
+    mutex mu;
+    std::atomic<uint64> clock{0};
+    std::unordered_map<Fprint128, KernelCacheEntry, Fprint128Hasher> kernels
+        TF_GUARDED_BY(mu);
+  };
+  KernelCacheShard& GetKernelCacheShard(const Fprint128& cache_key) {
+    // The hashes of the maps use the low bits of the keys.
+    return kernel_cache_shards_[cache_key.high64 % kNumKernelCacheShards];
+  }
+
   mutex cache_mu_;
   mutex device_cache_mu_;
   struct RegisteredFunction : public core::RefCounted {
     ~RegisteredFunction() override {}
 
-    std::unique_ptr<std::vector<Fprint128>> cached_kernel_keys;
+    std::unique_ptr<absl::flat_hash_set<Fprint128, Fprint128Hasher>>
+        cached_kernel_keys;
   };
-  std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
-                     Fprint128Hasher>
-      kernel_cache_ TF_GUARDED_BY(cache_mu_);
+  std::array<KernelCacheShard, kNumKernelCacheShards> kernel_cache_shards_;
+  // Maximum number of kernels cached per shard, or 0 if the cache is not
+  // bounded. The least recently used kernels of a full shard are evicted.
+  const int64_t kernel_cache_shard_capacity_;
+  std::atomic<int64_t> kernel_cache_generation_{0};
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
   absl::flat_hash_map<Fprint128, Device*, Fprint128Hasher> device_cache_
@@ -404,5 +404,81 @@ TEST_F(EagerContextTest, ReuseGlobalRendezvous) {
   TestGlobalRendezvous(context(), true);
 }
 
+core::RefCountPtr<KernelAndDevice> CreateKernel(EagerContext* context,
+                                                const string& name) {
+  return core::RefCountPtr<KernelAndDevice>(new KernelAndDeviceFunc(
+      /*flr=*/nullptr, /*pflr=*/nullptr, /*input_devices=*/{},
+      /*composite_devices=*/{}, /*input_resource_dtypes_and_shapes=*/{},
+      /*runner=*/nullptr, /*collective_executor=*/nullptr,
+      context->HostCPU(), name, /*outputs_on_op_device=*/false,
+      /*allow_small_function_optimizations=*/false,
+      /*allow_control_flow_sync_execution=*/false,
+      /*shape_inference_on_tfe_dialect_import=*/true,
+      /*int_args_and_retvals_on_device=*/false,
+      /*xla_compile_device_type=*/absl::nullopt,
+      /*rendezvous_factory=*/Rendezvous::Factory(),
+      /*get_op_id=*/nullptr));
+}
+
+TEST_F(EagerContextTest, KernelCache) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  const FunctionDef x_times_two = FDH::Define(
+      "XTimesTwo", {"x: float"}, {"y: float"}, {},
+      {{{"y"}, "Mul", {"x", "x"}, {{"T", DT_FLOAT}}}});
+  TF_ASSERT_OK(context()->AddFunctionDef(x_times_two));
+
+  std::vector<core::RefCountPtr<KernelAndDevice>> kernels;
+  for (uint64 i = 0; i < 100; ++i) {
+    kernels.push_back(CreateKernel(context(), i % 2 ? "XTimesTwo" : "Op"));
+    context()->AddKernelToCache(Fprint128{i, i * 7}, kernels.back().get());
+  }
+  for (uint64 i = 0; i < 100; ++i) {
+    EXPECT_EQ(context()->GetCachedKernel(Fprint128{i, i * 7}).get(),
+              kernels[i].get());
+  }
+  EXPECT_EQ(context()->GetCachedKernel(Fprint128{100, 700}), nullptr);
+
+  // Removing the function removes its kernels from the cache.
+  TF_ASSERT_OK(context()->RemoveFunction("XTimesTwo"));
+  for (uint64 i = 0; i < 100; ++i) {
+    EXPECT_EQ(context()->GetCachedKernel(Fprint128{i, i * 7}).get(),
+              i % 2 ? nullptr : kernels[i].get());
+  }
+
+  context()->ClearCachesAndDefaultExecutor();
+  EXPECT_EQ(context()->GetCachedKernel(Fprint128{0, 0}), nullptr);
+}
+
+TEST_F(EagerContextTest, BoundedKernelCache) {
+  // Two kernels per shard of the cache.
+  setenv("TF_EAGER_KERNEL_CACHE_MAX_SIZE", "32", 1);
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  unsetenv("TF_EAGER_KERNEL_CACHE_MAX_SIZE");
+
+  std::vector<core::RefCountPtr<KernelAndDevice>> kernels;
+  for (uint64 i = 0; i < 3; ++i) {
+    kernels.push_back(CreateKernel(context(), "Op"));
+  }
+  // The keys fall in the same shard.
+  const Fprint128 key0{0, 0};
+  const Fprint128 key1{1, 16};
+  const Fprint128 key2{2, 32};
+  context()->AddKernelToCache(key0, kernels[0].get());
+  context()->AddKernelToCache(key1, kernels[1].get());
+  EXPECT_EQ(context()->GetCachedKernel(key0).get(), kernels[0].get());
+  // Evicts the least recently used kernel.
+  context()->AddKernelToCache(key2, kernels[2].get());
+  EXPECT_EQ(context()->GetCachedKernel(key0).get(), kernels[0].get());
+  EXPECT_EQ(context()->GetCachedKernel(key1), nullptr);
+  EXPECT_EQ(context()->GetCachedKernel(key2).get(), kernels[2].get());
+
+  // Keys of other shards are not evicted.
+  for (uint64 i = 1; i < 16; ++i) {
+    context()->AddKernelToCache(Fprint128{i, i}, kernels[0].get());
+  }
+  EXPECT_EQ(context()->GetCachedKernel(key0).get(), kernels[0].get());
+  EXPECT_EQ(context()->GetCachedKernel(key2).get(), kernels[2].get());
+}
+
 }  // namespace
 }  // namespace tensorflow
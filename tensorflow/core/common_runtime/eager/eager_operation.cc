@@ -272,6 +272,8 @@ Status EagerOperation::AddInput(AbstractTensorHandle* input) {
     custom_device_tensor_handles_count_++;
   }
   AddTensorHandle(h);
+  // The attributes of a frozen op are inferred by its first execution.
+  if (is_frozen_ && prepared_kernel_.kernel != nullptr) return OkStatus();
   return MaybeInferSingleInputAttrs(h);
 }
 
@@ -287,6 +289,7 @@ Status EagerOperation::AddInputList(
         down_cast<ImmediateExecutionTensorHandle*>(input);
     AddTensorHandle(h);
   }
+  if (is_frozen_ && prepared_kernel_.kernel != nullptr) return OkStatus();
   return InferInputListAttrs(inputs.size());
 }
 
@@ -342,6 +345,8 @@ Status EagerOperation::Reset(
   attrs_.Reset(op);
   stack_trace_.reset();
   is_function_ = is_function;
+  is_frozen_ = false;
+  prepared_kernel_.kernel.reset();
   cancellation_manager_ = nullptr;
   executor_ = executor ? executor : &ctx_.Executor();
   if (eager_func_params.has_value()) {
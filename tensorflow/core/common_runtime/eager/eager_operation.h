@@ -146,6 +146,37 @@ class EagerOperation : public ImmediateExecutionOperation {
   bool is_function() const { return is_function_; }
   bool colocation_exempt() const { return colocation_exempt_; }
 
+  // Freezes the op for repeated executions with new inputs, which are added
+  // after every execution clears them. The attributes inferred from the inputs
+  // of the first execution are kept, and the kernel it resolves is reused by
+  // the later executions whose inputs have the same dtypes and devices, which
+  // skips the placement, the hashing of the attributes and the lookup of the
+  // kernel cache. Reset() unfreezes the op.
+  void Freeze() { is_frozen_ = true; }
+  bool is_frozen() const { return is_frozen_; }
+
+  // The dtype and devices of an input of a prepared kernel.
+  struct PreparedInput {
+    TensorHandle::HandleType type;
+    tensorflow::Device* device;
+    tensorflow::Device* resource_device;
+    DataType dtype;
+    // The first dtype and shape of the resource of a resource input.
+    absl::optional<DtypeAndPartialTensorShape> resource_dtype_and_shape;
+  };
+  // The kernel resolved by the last execution of a frozen op, along with the
+  // state of the op and its context it was resolved for.
+  struct PreparedKernel {
+    core::RefCountPtr<KernelAndDevice> kernel;
+    Fprint128 op_cache_key;
+    int64_t kernel_cache_generation;
+    bool allow_soft_placement;
+    bool run_eager_op_as_function;
+    bool reuse_rendezvous_for_functions;
+    absl::InlinedVector<PreparedInput, 4> inputs;
+  };
+  PreparedKernel* MutablePreparedKernel() { return &prepared_kernel_; }
+
   tensorflow::EagerContext& EagerContext() const { return ctx_; }
 
   AttrBuilder* MutableAttrs() { return &attrs_; }
@@ -274,6 +305,8 @@ class EagerOperation : public ImmediateExecutionOperation {
   absl::optional<ManagedStackTrace> stack_trace_;
   bool is_function_;  // Conceptually const, but can't be because of Reset
   bool colocation_exempt_;
+  bool is_frozen_ = false;
+  PreparedKernel prepared_kernel_;
   CancellationManager* cancellation_manager_ = nullptr;  // Not owned.
   EagerExecutor* executor_;                              // Not owned.
 
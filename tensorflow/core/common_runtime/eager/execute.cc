@@ -1073,10 +1073,123 @@ Fprint128 GetDeviceCacheKey(EagerOperation* op, const EagerContext& ctx) {
   return device_cache_key;
 }
 
+// Describes the dtype and devices of `handle` as an input of a prepared
+// kernel, which are those the kernel cache key depends on.
+Status GetPreparedInput(TensorHandle* handle,
+                        EagerOperation::PreparedInput* input) {
+  input->type = handle->Type();
+  input->device = handle->device();
+  input->resource_device = handle->resource_device();
+  input->dtype = handle->dtype;
+  input->resource_dtype_and_shape.reset();
+  if (handle->dtype == DT_RESOURCE) {
+    std::vector<DtypeAndPartialTensorShape> resource_dtypes_and_shapes;
+    TF_RETURN_IF_ERROR(
+        handle->GetResourceHandleDtypesAndShapes(&resource_dtypes_and_shapes));
+    if (!resource_dtypes_and_shapes.empty()) {
+      input->resource_dtype_and_shape = resource_dtypes_and_shapes.at(0);
+    }
+  }
+  return OkStatus();
+}
+
+bool IsSamePreparedInput(const EagerOperation::PreparedInput& a,
+                         const EagerOperation::PreparedInput& b) {
+  if (a.type != b.type || a.device != b.device ||
+      a.resource_device != b.resource_device || a.dtype != b.dtype ||
+      a.resource_dtype_and_shape.has_value() !=
+          b.resource_dtype_and_shape.has_value()) {
+    return false;
+  }
+  return !a.resource_dtype_and_shape.has_value() ||
+         (a.resource_dtype_and_shape->dtype ==
+              b.resource_dtype_and_shape->dtype &&
+          a.resource_dtype_and_shape->shape.IsIdenticalTo(
+              b.resource_dtype_and_shape->shape));
+}
+
+// Returns the kernel resolved by a previous execution of the frozen `op`, or
+// nullptr if the op, its inputs or its context changed since.
+core::RefCountPtr<KernelAndDevice> GetPreparedKernel(EagerOperation* op) {
+  EagerOperation::PreparedKernel* prepared = op->MutablePreparedKernel();
+  if (prepared->kernel == nullptr) return nullptr;
+  EagerContext& ctx = op->EagerContext();
+  if (prepared->kernel_cache_generation != ctx.KernelCacheGeneration() ||
+      prepared->allow_soft_placement != ctx.AllowSoftPlacement() ||
+      prepared->run_eager_op_as_function != ctx.RunEagerOpAsFunction() ||
+      prepared->reuse_rendezvous_for_functions !=
+          ctx.GetReuseRendezvousForFunctions()) {
+    return nullptr;
+  }
+  // The cache key of the attributes is only recomputed when they or the device
+  // of the op changed.
+  if (!(prepared->op_cache_key ==
+        op->MutableAttrs()->CacheKey(op->DeviceName()))) {
+    return nullptr;
+  }
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  if (!op->TensorHandleInputs(&inputs).ok() ||
+      inputs->size() != prepared->inputs.size()) {
+    return nullptr;
+  }
+  EagerOperation::PreparedInput input;
+  for (int i = 0, end = inputs->size(); i < end; ++i) {
+    if (!GetPreparedInput((*inputs)[i], &input).ok() ||
+        !IsSamePreparedInput(input, prepared->inputs[i])) {
+      return nullptr;
+    }
+  }
+  prepared->kernel->Ref();
+  return core::RefCountPtr<KernelAndDevice>(prepared->kernel.get());
+}
+
+// Records `kernel` as resolved for the frozen `op` and its current inputs, as
+// of the `kernel_cache_generation` of its context.
+void PrepareKernel(EagerOperation* op, int64_t kernel_cache_generation,
+                   KernelAndDevice* kernel) {
+  EagerOperation::PreparedKernel* prepared = op->MutablePreparedKernel();
+  prepared->kernel.reset();
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  if (!op->TensorHandleInputs(&inputs).ok()) return;
+  prepared->inputs.resize(inputs->size());
+  for (int i = 0, end = inputs->size(); i < end; ++i) {
+    if (!GetPreparedInput((*inputs)[i], &prepared->inputs[i]).ok()) return;
+  }
+  EagerContext& ctx = op->EagerContext();
+  prepared->op_cache_key = op->MutableAttrs()->CacheKey(op->DeviceName());
+  prepared->kernel_cache_generation = kernel_cache_generation;
+  prepared->allow_soft_placement = ctx.AllowSoftPlacement();
+  prepared->run_eager_op_as_function = ctx.RunEagerOpAsFunction();
+  prepared->reuse_rendezvous_for_functions =
+      ctx.GetReuseRendezvousForFunctions();
+  kernel->Ref();
+  prepared->kernel.reset(kernel);
+}
+
 Status GetOrCreateKernelAndDevice(
     EagerOperation* op, TensorHandle** retvals, int* num_retvals,
     core::RefCountPtr<KernelAndDevice>* out_kernel) {
   EagerContext& ctx = op->EagerContext();
+  // `op` may be replaced below by a call op wrapping it.
+  EagerOperation* frozen_op = op->is_frozen() ? op : nullptr;
+  int64_t kernel_cache_generation = 0;
+  if (frozen_op != nullptr) {
+    core::RefCountPtr<KernelAndDevice> kernel = GetPreparedKernel(op);
+    if (kernel != nullptr) {
+      int num_outputs = kernel->num_outputs();
+      if (num_outputs > *num_retvals) {
+        return errors::InvalidArgument("Expecting ", num_outputs,
+                                       " outputs, but *num_retvals is ",
+                                       *num_retvals);
+      }
+      *num_retvals = num_outputs;
+      *out_kernel = std::move(kernel);
+      return OkStatus();
+    }
+    // Read before looking up the kernel, so that a kernel removed from the
+    // cache meanwhile is not prepared.
+    kernel_cache_generation = ctx.KernelCacheGeneration();
+  }
   Device* device = absl::get<Device*>(op->Device());
 
   // Set the EagerOperation's device prior to extracting the input_device_ptrs
@@ -1294,6 +1407,10 @@ Status GetOrCreateKernelAndDevice(
     }
   }
 
+  if (frozen_op != nullptr) {
+    PrepareKernel(frozen_op, kernel_cache_generation, kernel.get());
+  }
+
   int num_outputs = kernel->num_outputs();
   if (num_outputs > *num_retvals) {
     return errors::InvalidArgument("Expecting ", num_outputs,
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <deque>
 #include <memory>
 #include <vector>
 
@@ -60,6 +61,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -142,13 +144,24 @@ struct KernelTimer {
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// The work-stealing queues, and the index of the queue within them, owned by
+// the work-stealing worker running on the current thread (if any). See
+// `ExecutorState::WorkStealingQueues`.
+thread_local const void* current_work_stealing_queues = nullptr;
+thread_local int current_work_stealing_queue_index = -1;
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool work_stealing_scheduling = false,
+                        bool adaptive_inlining = false)
+      : immutable_state_(p),
+        work_stealing_scheduling_(work_stealing_scheduling),
+        adaptive_inlining_(adaptive_inlining) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
-    kernel_stats_.Initialize(immutable_state_.graph_view());
+    kernel_stats_.Initialize(immutable_state_.graph_view(), adaptive_inlining_);
     return OkStatus();
   }
 
@@ -163,15 +176,37 @@ class ExecutorImpl : public Executor {
    public:
     KernelStats() = default;
 
-    void Initialize(const GraphView& gview) {
+    // If `adaptive` is true, the cost of every synchronous kernel is sampled,
+    // including kernels for which IsExpensive() returns false, and whether a
+    // node is expensive is decided from its measured cost alone.
+    void Initialize(const GraphView& gview, bool adaptive = false) {
+      adaptive_ = adaptive;
       is_expensive_.resize(gview.num_nodes());
+      is_tracked_.resize(gview.num_nodes());
       cost_estimates_ =
           std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
+      if (adaptive_) {
+        dispatch_ = std::make_unique<std::atomic<bool>[]>(gview.num_nodes());
+        num_samples_ =
+            std::make_unique<std::atomic_uint_fast32_t[]>(gview.num_nodes());
+      }
       for (int32_t i = 0; i < gview.num_nodes(); ++i) {
-        if (gview.node(i)) {
-          is_expensive_[i] =
-              gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
-          cost_estimates_[i] = kInitialCostEstimateCycles;
+        const NodeItem* item = gview.node(i);
+        if (item) {
+          is_expensive_[i] = item->kernel && item->kernel->IsExpensive();
+          // The cost of asynchronous kernels is not measured, so they keep
+          // their static marker.
+          is_tracked_[i] =
+              adaptive_ ? item->kernel && !item->kernel_is_async
+                        : static_cast<bool>(is_expensive_[i]);
+          // Kernels marked as inexpensive start out inlined in adaptive mode,
+          // as they are in the default mode.
+          cost_estimates_[i] =
+              is_expensive_[i] ? kInitialCostEstimateCycles : 0;
+          if (adaptive_) {
+            dispatch_[i] = is_expensive_[i];
+            num_samples_[i] = 0;
+          }
         }
       }
     }
@@ -180,20 +215,24 @@ class ExecutorImpl : public Executor {
     // executor uses this flag to optimize graph execution, for example
     // by "inlining" inexpensive kernels.
     bool IsExpensive(const NodeItem& node) const {
+      if (adaptive_ && is_tracked_[node.node_id]) {
+        return dispatch_[node.node_id].load(std::memory_order_relaxed);
+      }
       return is_expensive_[node.node_id] &&
              (cost_estimates_[node.node_id].load(std::memory_order_relaxed) >
               kOpIsExpensiveThresholdCycles);
     }
 
-    // Returns the value of kernel->IsExpensive().
-    bool HasExpensiveMarker(const NodeItem& node) const {
-      return is_expensive_[node.node_id];
+    // Returns true iff the cost of the given node should be measured. By
+    // default this is the value of kernel->IsExpensive().
+    bool IsCostTracked(const NodeItem& node) const {
+      return is_tracked_[node.node_id];
     }
 
     // Updates the dynamic cost estimate, which is used to determine whether the
     // given node is expensive. The new cost estimate is a weighted average of
     // the old cost estimate and the latest cost. We only update cost estimates
-    // for kernels for which IsExpensive() return true.
+    // for kernels for which IsCostTracked() returns true.
     void UpdateCostEstimate(const NodeItem& node, uint64 elapsed_cycles) {
       // N.B. Updates to `cost_estimate` are atomic but unlocked.  Simultaneous
       // updates may result in one or more updates being ignored.  This does not
@@ -205,6 +244,13 @@ class ExecutorImpl : public Executor {
           ((kCostDecay - 1) * prev_estimate + elapsed_cycles) / kCostDecay;
 
       cost_estimate.store(new_estimate, std::memory_order_relaxed);
+
+      if (adaptive_ && num_samples_[node.node_id].fetch_add(
+                           1, std::memory_order_relaxed) %
+                               kSamplesPerDecision ==
+                           kSamplesPerDecision - 1) {
+        ReevaluateDecision(node.node_id, new_estimate);
+      }
     }
 
    private:
@@ -214,14 +260,43 @@ class ExecutorImpl : public Executor {
     static constexpr uint64 kInitialCostEstimateCycles = 100 * 1000 * 1000;
     static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
     static constexpr uint64 kCostDecay = 10;
+    // Number of cost samples between two re-evaluations of whether a node is
+    // inlined or dispatched in adaptive mode.
+    static constexpr uint32 kSamplesPerDecision = 8;
+
+    // Flips the inline-vs-dispatch decision of node `id` when its estimated
+    // cost moves far enough across kOpIsExpensiveThresholdCycles. The margin
+    // keeps nodes whose cost is close to the threshold from oscillating.
+    void ReevaluateDecision(int32_t id, uint64 estimate) {
+      std::atomic<bool>& dispatch = dispatch_[id];
+      if (dispatch.load(std::memory_order_relaxed)) {
+        if (estimate < kOpIsExpensiveThresholdCycles / 2) {
+          dispatch.store(false, std::memory_order_relaxed);
+        }
+      } else if (estimate > 2 * kOpIsExpensiveThresholdCycles) {
+        dispatch.store(true, std::memory_order_relaxed);
+      }
+    }
 
+    bool adaptive_ = false;
     std::vector<bool> is_expensive_;
+    std::vector<bool> is_tracked_;
     // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+    // Only allocated in adaptive mode: the current decision of each node, and
+    // the number of cost samples taken.
+    std::unique_ptr<std::atomic<bool>[]> dispatch_;
+    std::unique_ptr<std::atomic_uint_fast32_t[]> num_samples_;
   };
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  // If true, ready expensive nodes are scheduled on work-stealing queues. See
+  // `ExecutorState::WorkStealingQueues`.
+  const bool work_stealing_scheduling_;
+  // If true, whether a node runs inline or is dispatched to the thread pool
+  // adapts to its measured cost. See `KernelStats::Initialize`.
+  const bool adaptive_inlining_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
@@ -280,7 +355,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                bool work_stealing_scheduling = false);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -294,6 +370,123 @@ class ExecutorState {
 
   struct AsyncState;
 
+  // Ready queues for scheduling expensive nodes in the work-stealing mode.
+  //
+  // Instead of dispatching every ready expensive node to `runner_` as its own
+  // closure, nodes are pushed onto queues which are drained by a bounded number
+  // of worker closures. Each worker owns one queue. A worker pushes the
+  // successors of the nodes it runs onto its own queue and pops them from the
+  // back, so that their inputs are likely still in its cache, and steals from
+  // the front of the other queues once its own queue is empty.
+  //
+  // The queues are shared with the workers because a worker may still be
+  // looking for work after the last node has completed and the `ExecutorState`
+  // has been deleted. Workers only access the `ExecutorState` to process a node
+  // they popped, which keeps the step alive.
+  class WorkStealingQueues {
+   public:
+    explicit WorkStealingQueues(int num_queues) : queues_(num_queues) {}
+
+    int num_queues() const { return queues_.size(); }
+
+    // Pushes `nodes` onto the queue at `index`.
+    void Push(int index, TaggedNodeSeq* nodes) {
+      num_queued_.fetch_add(nodes->size());
+      Queue& queue = queues_[index];
+      mutex_lock l(queue.mu);
+      for (auto& node : *nodes) {
+        queue.nodes.push_back(node);
+      }
+    }
+
+    // Pops the most recently pushed node from the queue at `index`, or steals
+    // the least recently pushed node from another queue.
+    absl::optional<TaggedNode> Pop(int index) {
+      if (num_queued_.load() == 0) {
+        return absl::nullopt;
+      }
+      for (int i = 0; i < queues_.size(); ++i) {
+        Queue& queue = queues_[(index + i) % queues_.size()];
+        mutex_lock l(queue.mu);
+        if (queue.nodes.empty()) {
+          continue;
+        }
+        absl::optional<TaggedNode> node;
+        if (i == 0) {
+          node.emplace(queue.nodes.back());
+          queue.nodes.pop_back();
+        } else {
+          node.emplace(queue.nodes.front());
+          queue.nodes.pop_front();
+        }
+        num_queued_.fetch_sub(1);
+        return node;
+      }
+      return absl::nullopt;
+    }
+
+    bool HasQueuedNodes() const { return num_queued_.load() > 0; }
+
+    // Registers a new worker if fewer than `num_queues()` workers are running.
+    bool TryAddWorker() {
+      int num_workers = num_workers_.load();
+      while (num_workers < queues_.size()) {
+        if (num_workers_.compare_exchange_weak(num_workers, num_workers + 1)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Claims an unowned queue for a registered worker and returns its index.
+    int ClaimQueue() {
+      for (int i = 0; i < queues_.size(); ++i) {
+        Queue& queue = queues_[i];
+        mutex_lock l(queue.mu);
+        if (!queue.owned) {
+          queue.owned = true;
+          return i;
+        }
+      }
+      LOG(FATAL) << "More work-stealing workers than queues.";
+    }
+
+    // Releases the queue at `index` and unregisters its worker.
+    void RemoveWorker(int index) {
+      {
+        Queue& queue = queues_[index];
+        mutex_lock l(queue.mu);
+        queue.owned = false;
+      }
+      num_workers_.fetch_sub(1);
+    }
+
+    // Returns the index of the next queue for pushing nodes from threads which
+    // do not run a worker.
+    int NextQueue() { return next_queue_.fetch_add(1) % queues_.size(); }
+
+   private:
+    struct Queue {
+      mutex mu;
+      std::deque<TaggedNode> nodes TF_GUARDED_BY(mu);
+      bool owned TF_GUARDED_BY(mu) = false;
+    };
+
+    std::vector<Queue> queues_;
+    std::atomic<int64_t> num_queued_{0};
+    std::atomic<int> num_workers_{0};
+    std::atomic<uint32> next_queue_{0};
+  };
+
+  // Schedules `nodes` on the work-stealing queues, starting new workers for
+  // those that cannot be run by the current worker.
+  void ScheduleWorkStealing(TaggedNodeSeq* nodes, int64_t scheduled_nsec);
+
+  // Runs a work-stealing worker until there are no queued nodes left.
+  static void RunWorkStealingWorker(ExecutorState* state,
+                                    std::shared_ptr<WorkStealingQueues> queues,
+                                    int64_t scheduled_nsec);
+
   // Process a ready node in current thread.
   void Process(TaggedNode node, int64_t scheduled_nsec);
 
@@ -392,6 +585,8 @@ class ExecutorState {
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
+  // Set iff the executor uses work-stealing scheduling.
+  std::shared_ptr<WorkStealingQueues> work_stealing_queues_;
 
   PropagatorStateType propagator_;
 
@@ -413,7 +608,7 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, bool work_stealing_scheduling)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -442,6 +637,10 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
+  if (work_stealing_scheduling && !run_all_kernels_inline_) {
+    work_stealing_queues_ = std::make_shared<WorkStealingQueues>(
+        std::max(1, port::MaxParallelism()));
+  }
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
@@ -584,6 +783,8 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   OpKernel* op_kernel = item.kernel;
   Device* device = immutable_state_.params().device;
   const bool is_expensive = kernel_stats_->IsExpensive(item);
+  const bool sample_metrics = metrics::ShouldSampleOpKernelExecution();
+  const int64_t start_nsec = sample_metrics ? NowInNsec() : 0;
 
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tracing::ScopedRegion region(tracing::EventCategory::kCompute,
@@ -595,7 +796,7 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
         },
         profiler::GetTFTraceMeLevel(is_expensive));
     device->Compute(op_kernel, &ctx);
-  } else if (kernel_stats_->HasExpensiveMarker(item)) {
+  } else if (kernel_stats_->IsCostTracked(item)) {
     KernelTimer timer;
     device->Compute(op_kernel, &ctx);
     // For expensive kernels, always update the cost estimate. For inexpensive
@@ -609,6 +810,9 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   } else {
     device->Compute(op_kernel, &ctx);
   }
+  if (TF_PREDICT_FALSE(sample_metrics)) {
+    metrics::RecordOpKernelExecution(&ctx, NowInNsec() - start_nsec);
+  }
   nodestats::SetOpEnd(stats);
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
   s = ProcessOutputs(item, &ctx, outputs->data(), stats);
@@ -625,12 +829,17 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
   DCHECK(async_kernel != nullptr);
   AsyncState* state =
       new AsyncState(params, tagged_node, &item, first_input, stats);
+  const int64_t start_nsec =
+      metrics::ShouldSampleOpKernelExecution() ? NowInNsec() : 0;
 
-  auto done = [this, state, activity_id]() {
+  auto done = [this, state, activity_id, start_nsec]() {
     Device* device = immutable_state_.params().device;
     NodeExecStatsInterface* stats = state->stats;  // Shorthand
     Entry* first_input = state->first_input;       // Shorthand
 
+    if (TF_PREDICT_FALSE(start_nsec != 0)) {
+      metrics::RecordOpKernelExecution(&state->ctx, NowInNsec() - start_nsec);
+    }
     nodestats::SetOpEnd(stats);
     EntryVector outputs(state->item->num_outputs);
     Status s = ProcessOutputs(*state->item, &state->ctx, outputs.data(), stats);
@@ -718,6 +927,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   } else {
     params.device = device;
   }
+  params.step_allocator = device->GetStepArenaAllocator();
   params.start_time_usecs = start_time_usecs_;
   params.deadline = deadline_;
   params.log_memory = log_memory_;
@@ -1255,7 +1465,9 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     TaggedNodeSeq expensive_nodes;
-    if (inline_ready == nullptr) {
+    if (inline_ready == nullptr && work_stealing_queues_) {
+      ScheduleWorkStealing(ready, scheduled_nsec);
+    } else if (inline_ready == nullptr) {
       // Schedule to run all the ready ops in thread pool.
       for (auto& tagged_node : *ready) {
         RunTask([=]() { Process(tagged_node, scheduled_nsec); },
@@ -1285,7 +1497,9 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       }
     }
     if (!expensive_nodes.empty()) {
-      if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
+      if (work_stealing_queues_) {
+        ScheduleWorkStealing(&expensive_nodes, scheduled_nsec);
+      } else if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
         for (auto& tagged_node : expensive_nodes) {
           RunTask(std::bind(&ExecutorState::Process, this, tagged_node,
                             scheduled_nsec),
@@ -1329,6 +1543,53 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ScheduleWorkStealing(
+    TaggedNodeSeq* nodes, int64_t scheduled_nsec) {
+  int num_new_workers = nodes->size();
+  int queue_index;
+  if (current_work_stealing_queues == work_stealing_queues_.get()) {
+    // The current worker will run one of the nodes once it is done with the
+    // current one, so that only the others need new workers.
+    queue_index = current_work_stealing_queue_index;
+    --num_new_workers;
+  } else {
+    queue_index = work_stealing_queues_->NextQueue();
+  }
+  work_stealing_queues_->Push(queue_index, nodes);
+  for (int i = 0; i < num_new_workers && work_stealing_queues_->TryAddWorker();
+       ++i) {
+    RunTask([this, queues = work_stealing_queues_, scheduled_nsec]() {
+      RunWorkStealingWorker(this, std::move(queues), scheduled_nsec);
+    });
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunWorkStealingWorker(
+    ExecutorState* state, std::shared_ptr<WorkStealingQueues> queues,
+    int64_t scheduled_nsec) {
+  const void* parent_queues = current_work_stealing_queues;
+  const int parent_queue_index = current_work_stealing_queue_index;
+  current_work_stealing_queues = queues.get();
+  while (true) {
+    const int index = queues->ClaimQueue();
+    current_work_stealing_queue_index = index;
+    while (absl::optional<TaggedNode> node = queues->Pop(index)) {
+      // `state` is alive while any of its nodes is outstanding.
+      state->Process(*node, scheduled_nsec);
+    }
+    queues->RemoveWorker(index);
+    // A node may have been pushed after this worker last checked the queues
+    // but before it was unregistered, without starting a new worker.
+    if (!queues->HasQueuedNodes() || !queues->TryAddWorker()) {
+      break;
+    }
+  }
+  current_work_stealing_queues = parent_queues;
+  current_work_stealing_queue_index = parent_queue_index;
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1470,20 +1731,26 @@ void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
                                                &kernel_stats_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        work_stealing_scheduling_))
         ->RunAsync(std::move(done));
   } else {
     (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+                                              &kernel_stats_,
+                                              work_stealing_scheduling_))
         ->RunAsync(std::move(done));
   }
 }
 
 }  // namespace
 
-Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
-                        Executor** executor) {
-  ExecutorImpl* impl = new ExecutorImpl(params);
+namespace {
+
+Status NewLocalExecutorImpl(const LocalExecutorParams& params,
+                            const Graph& graph, bool work_stealing_scheduling,
+                            bool adaptive_inlining, Executor** executor) {
+  ExecutorImpl* impl =
+      new ExecutorImpl(params, work_stealing_scheduling, adaptive_inlining);
   const Status s = impl->Initialize(graph);
   if (s.ok()) {
     *executor = impl;
@@ -1493,6 +1760,15 @@ Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
   return s;
 }
 
+}  // namespace
+
+Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
+                        Executor** executor) {
+  return NewLocalExecutorImpl(params, graph,
+                              /*work_stealing_scheduling=*/false,
+                              /*adaptive_inlining=*/false, executor);
+}
+
 Status CreateNonCachedKernel(Device* device, FunctionLibraryRuntime* flib,
                              const std::shared_ptr<const NodeProperties>& props,
                              int graph_def_version, OpKernel** kernel) {
@@ -1510,20 +1786,38 @@ namespace {
 class DefaultExecutorRegistrar {
  public:
   DefaultExecutorRegistrar() {
-    Factory* factory = new Factory;
+    Factory* factory = new Factory(/*work_stealing_scheduling=*/false,
+                                   /*adaptive_inlining=*/false);
     ExecutorFactory::Register("", factory);
     ExecutorFactory::Register("DEFAULT", factory);
+    ExecutorFactory::Register(
+        "WORK_STEALING", new Factory(/*work_stealing_scheduling=*/true,
+                                     /*adaptive_inlining=*/false));
+    ExecutorFactory::Register(
+        "ADAPTIVE_INLINING", new Factory(/*work_stealing_scheduling=*/false,
+                                         /*adaptive_inlining=*/true));
   }
 
  private:
   class Factory : public ExecutorFactory {
+   public:
+    Factory(bool work_stealing_scheduling, bool adaptive_inlining)
+        : work_stealing_scheduling_(work_stealing_scheduling),
+          adaptive_inlining_(adaptive_inlining) {}
+
     Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
                        std::unique_ptr<Executor>* out_executor) override {
       Executor* ret = nullptr;
-      TF_RETURN_IF_ERROR(NewLocalExecutor(params, std::move(graph), &ret));
+      TF_RETURN_IF_ERROR(NewLocalExecutorImpl(params, std::move(graph),
+                                              work_stealing_scheduling_,
+                                              adaptive_inlining_, &ret));
       out_executor->reset(ret);
       return OkStatus();
     }
+
+   private:
+    const bool work_stealing_scheduling_;
+    const bool adaptive_inlining_;
   };
 };
 static DefaultExecutorRegistrar registrar;
@@ -0,0 +1,193 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the per-node overhead of the executors on synthetic graphs of
+// representative shapes. The ops are cheap so that the time is dominated by
+// scheduling. Besides the time per node, every benchmark reports the closures
+// handed off to the thread pool and the allocations per step.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::test::function::NDef;
+
+// The executors to compare, selected by an argument of the benchmarks.
+constexpr const char* kExecutorTypes[] = {"", "SINGLE_THREADED_EXECUTOR"};
+constexpr const char* kExecutorLabels[] = {"DEFAULT",
+                                           "SINGLE_THREADED_EXECUTOR"};
+
+SessionOptions* GetOptions() {
+  static SessionOptions* options = [] {
+    EnableCPUAllocatorStats();
+    auto* options = new SessionOptions;
+    options->config.set_intra_op_parallelism_threads(1);
+    return options;
+  }();
+  return options;
+}
+
+Node* Scalar(Graph* g) {
+  return test::graph::Constant(g, test::AsScalar<float>(1.0f));
+}
+
+// Runs `g` with the executor at index `executor` of `kExecutorTypes`, and
+// reports the time per node given that `num_nodes` nodes run per step.
+void RunGraph(Graph* g, int executor, int64_t num_nodes,
+              ::testing::benchmark::State& state) {
+  state.SetLabel(kExecutorLabels[executor]);
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, GetOptions(), nullptr, nullptr,
+                  kExecutorTypes[executor], /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(state.iterations() * num_nodes);
+  state.counters["time_per_node"] = ::benchmark::Counter(
+      num_nodes, ::benchmark::Counter::kIsIterationInvariantRate |
+                     ::benchmark::Counter::kInvert);
+}
+
+// A scalar fanned out to `width` independent ops, which are summed up.
+void BM_FanOut(::testing::benchmark::State& state) {
+  const int width = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* input = Scalar(g);
+  std::vector<Node*> outputs;
+  for (int i = 0; i < width; ++i) {
+    outputs.push_back(test::graph::Unary(g, "Neg", input));
+  }
+  test::graph::Multi(g, "AddN", outputs);
+  RunGraph(g, state.range(1), g->num_op_nodes(), state);
+}
+
+BENCHMARK(BM_FanOut)
+    ->UseRealTime()
+    ->ArgPair(16, 0)
+    ->ArgPair(16, 1)
+    ->ArgPair(256, 0)
+    ->ArgPair(256, 1)
+    ->ArgPair(4096, 0)
+    ->ArgPair(4096, 1);
+
+// A chain of `length` dependent ops.
+void BM_Chain(::testing::benchmark::State& state) {
+  const int length = state.range(0);
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* node = Scalar(g);
+  for (int i = 0; i < length; ++i) {
+    node = test::graph::Unary(g, "Neg", node);
+  }
+  RunGraph(g, state.range(1), g->num_op_nodes(), state);
+}
+
+BENCHMARK(BM_Chain)
+    ->UseRealTime()
+    ->ArgPair(16, 0)
+    ->ArgPair(16, 1)
+    ->ArgPair(256, 0)
+    ->ArgPair(256, 1)
+    ->ArgPair(4096, 0)
+    ->ArgPair(4096, 1);
+
+// `depth` layers of `width` binary ops, each reading two random ops of the
+// previous layer, as in graphs of many small ops.
+void BM_ManySmallOps(::testing::benchmark::State& state) {
+  const int width = state.range(0);
+  const int depth = state.range(1);
+  Graph* g = new Graph(OpRegistry::Global());
+  random::PhiloxRandom philox(1729, 17);
+  random::SimplePhilox rand(&philox);
+  std::vector<Node*> layer(width, Scalar(g));
+  for (int i = 0; i < depth; ++i) {
+    std::vector<Node*> next_layer;
+    for (int j = 0; j < width; ++j) {
+      next_layer.push_back(test::graph::Add(g, layer[rand.Uniform(width)],
+                                            layer[rand.Uniform(width)]));
+    }
+    layer = std::move(next_layer);
+  }
+  RunGraph(g, state.range(2), g->num_op_nodes(), state);
+}
+
+BENCHMARK(BM_ManySmallOps)
+    ->UseRealTime()
+    ->Args({4, 256, 0})
+    ->Args({4, 256, 1})
+    ->Args({64, 16, 0})
+    ->Args({64, 16, 1})
+    ->Args({64, 256, 0})
+    ->Args({64, 256, 1});
+
+// A while loop incrementing a counter `iterations` times, with the
+// Switch/Merge control flow that functional loops are lowered to. The single
+// threaded executor doesn't support this control flow, so only the default
+// executor runs it.
+void BM_WhileLoop(::testing::benchmark::State& state) {
+  const int iterations = state.range(0);
+  const auto constant = [](const string& name, int32 value) {
+    return NDef(name, "Const", {},
+                {{"value", test::AsScalar<int32>(value)}, {"dtype", DT_INT32}});
+  };
+  const auto enter = [](const string& name, const string& input,
+                        bool is_constant) {
+    return NDef(name, "Enter", {input},
+                {{"T", DT_INT32},
+                 {"frame_name", "loop"},
+                 {"is_constant", is_constant},
+                 {"parallel_iterations", 10}});
+  };
+  GraphDef graph_def = test::function::GDef({
+      constant("zero", 0),
+      constant("limit", iterations),
+      constant("one", 1),
+      enter("enter", "zero", false),
+      enter("limit_enter", "limit", true),
+      enter("one_enter", "one", true),
+      NDef("merge", "Merge", {"enter", "next"}, {{"T", DT_INT32}, {"N", 2}}),
+      NDef("less", "Less", {"merge", "limit_enter"}, {{"T", DT_INT32}}),
+      NDef("cond", "LoopCond", {"less"}),
+      NDef("switch", "Switch", {"merge", "cond"}, {{"T", DT_INT32}}),
+      NDef("body", "Add", {"switch:1", "one_enter"}, {{"T", DT_INT32}}),
+      NDef("next", "NextIteration", {"body"}, {{"T", DT_INT32}}),
+      NDef("exit", "Exit", {"switch"}, {{"T", DT_INT32}}),
+  });
+  Graph* g = new Graph(OpRegistry::Global());
+  TF_CHECK_OK(ConvertGraphDefToGraph({}, graph_def, g));
+  // The loop condition and switch run once more than the body.
+  RunGraph(g, /*executor=*/0, 11 + 6 * iterations, state);
+}
+
+BENCHMARK(BM_WhileLoop)->UseRealTime()->Arg(1)->Arg(100)->Arg(10000);
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <algorithm>
+#include <atomic>
 
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -25,13 +26,16 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -39,8 +43,11 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/lib/monitoring/test_utils.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/test.h"
@@ -72,8 +79,11 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor based on a graph 'gdef'. If
+  // `executor_type` is non-empty, the executor is created by the registered
+  // factory for that type.
+  void Create(std::unique_ptr<const Graph> graph,
+              const std::string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
@@ -88,7 +98,13 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    if (executor_type.empty()) {
+      TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    } else {
+      std::unique_ptr<Executor> executor;
+      TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &executor));
+      exec_ = executor.release();
+    }
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -181,6 +197,74 @@ TEST_F(ExecutorTest, SimpleAdd) {
   EXPECT_EQ(2.0, V(out));  // out = 1.0 + 1.0 = 2.0
 }
 
+using ::tensorflow::monitoring::testing::CellReader;
+using ::tensorflow::monitoring::testing::Histogram;
+
+class ExecutorMetricsTest : public ExecutorTest {
+ protected:
+  ~ExecutorMetricsTest() override {
+    metrics::SetOpKernelExecutionSamplingPeriod(0);
+  }
+
+  // Runs c = a + b on scalar floats.
+  void RunAdd() {
+    auto g = std::make_unique<Graph>(OpRegistry::Global());
+    auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+    auto in1 = test::graph::Recv(g.get(), "b", "float", ALICE, 1, BOB);
+    auto tmp = test::graph::Add(g.get(), in0, in1);
+    test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+    Create(std::move(g));
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "b"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(2.0, V(out));
+  }
+};
+
+TEST_F(ExecutorMetricsTest, OpKernelExecutionSampled) {
+  CellReader<int64_t> executions(
+      "/tensorflow/core/op_kernel_executions");
+  CellReader<Histogram> durations(
+      "/tensorflow/core/op_kernel_duration_nsecs_histogram");
+  CellReader<int64_t> input_bytes(
+      "/tensorflow/core/op_kernel_input_bytes");
+  CellReader<int64_t> output_bytes(
+      "/tensorflow/core/op_kernel_output_bytes");
+
+  metrics::SetOpKernelExecutionSamplingPeriod(1);
+  RunAdd();
+
+  EXPECT_EQ(executions.Delta("Add"), 1);
+  EXPECT_EQ(durations.Delta("Add").num(), 1);
+  // Two float scalars in, one out.
+  EXPECT_EQ(input_bytes.Delta("Add"), 8);
+  EXPECT_EQ(output_bytes.Delta("Add"), 4);
+}
+
+TEST_F(ExecutorMetricsTest, OpKernelExecutionNotSampledByDefault) {
+  CellReader<int64_t> executions(
+      "/tensorflow/core/op_kernel_executions");
+  CellReader<Histogram> durations(
+      "/tensorflow/core/op_kernel_duration_nsecs_histogram");
+  CellReader<int64_t> input_bytes(
+      "/tensorflow/core/op_kernel_input_bytes");
+
+  for (int i = 0; i < 10; ++i) {
+    RunAdd();
+  }
+
+  EXPECT_EQ(executions.Delta("Add"), 0);
+  EXPECT_EQ(durations.Delta("Add").num(), 0);
+  EXPECT_EQ(input_bytes.Delta("Add"), 0);
+}
+
 TEST_F(ExecutorTest, SelfAdd) {
   // v0 <- a
   // v1 = v0 + v0
@@ -261,6 +345,116 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING");
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
+TEST_F(ExecutorTest, RandomTreeAdaptiveInlining) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "ADAPTIVE_INLINING");
+  // Run enough steps for the inlining decisions to be re-evaluated.
+  for (int iters = 0; iters < 32; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
+// Forwards its input after sleeping for `delay_micros`, so that its measured
+// cost can be changed between the steps of an executor.
+class DelayedIdentityOp : public OpKernel {
+ public:
+  explicit DelayedIdentityOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const int64_t delay = delay_micros.load(std::memory_order_relaxed);
+    if (delay > 0) Env::Default()->SleepForMicroseconds(delay);
+    context->set_output(0, context->input(0));
+  }
+
+  bool IsExpensive() override { return false; }
+
+  static std::atomic<int64_t> delay_micros;
+};
+
+std::atomic<int64_t> DelayedIdentityOp::delay_micros{0};
+
+REGISTER_OP("DelayedIdentity").Input("x: float").Output("y: float");
+REGISTER_KERNEL_BUILDER(Name("DelayedIdentity").Device(DEVICE_CPU),
+                        DelayedIdentityOp);
+
+TEST_F(ExecutorTest, AdaptiveInliningFollowsMeasuredCost) {
+  // The outputs of "x" are ready together, so that "delayed" is dispatched to
+  // the runner once it is expensive, while "identity" runs inline.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto x = test::graph::Identity(g.get(), in);
+  auto delayed = test::graph::Unary(g.get(), "DelayedIdentity", x);
+  auto identity = test::graph::Identity(g.get(), x);
+  auto sum = test::graph::Add(g.get(), delayed, identity);
+  test::graph::Send(g.get(), sum, "b", BOB, 1, ALICE);
+  Create(std::move(g), "ADAPTIVE_INLINING");
+  std::atomic<int> num_tasks{0};
+  runner_ = [this, &num_tasks](std::function<void()> fn) {
+    num_tasks.fetch_add(1);
+    thread_pool_->Schedule(fn);
+  };
+  // Runs one step and returns the number of closures passed to the runner.
+  auto run_step = [this, &num_tasks]() {
+    num_tasks = 0;
+    Rendezvous::Args args;
+    TF_CHECK_OK(
+        rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+    TF_CHECK_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_CHECK_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                              &is_dead));
+    EXPECT_EQ(2.0, V(out));
+    return num_tasks.load();
+  };
+
+  // Every node starts out inlined.
+  const int num_inline_tasks = run_step();
+
+  // The cost of inlined nodes is only sampled on some steps, and the decision
+  // is re-evaluated every few samples.
+  constexpr int kMaxSteps = 2000;
+  DelayedIdentityOp::delay_micros = 2000;
+  int step = 0;
+  while (step < kMaxSteps && run_step() == num_inline_tasks) ++step;
+  EXPECT_LT(step, kMaxSteps) << "\"delayed\" was never dispatched";
+  EXPECT_EQ(run_step(), num_inline_tasks + 1);
+
+  // Once it is cheap again, its estimate decays back below the threshold.
+  DelayedIdentityOp::delay_micros = 0;
+  step = 0;
+  while (step < kMaxSteps && run_step() != num_inline_tasks) ++step;
+  EXPECT_LT(step, kMaxSteps) << "\"delayed\" was never inlined again";
+  EXPECT_EQ(run_step(), num_inline_tasks);
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -95,6 +95,8 @@ GPUBFCAllocator::GPUBFCAllocator(
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.small_chunk_cache = opts.small_chunk_cache;
+        o.compaction_threshold = opts.compaction_threshold;
         return o;
       }()) {}
 
@@ -46,6 +46,8 @@ class GPUBFCAllocator : public tsl::BFCAllocator {
 
     double fragmentation_fraction = 0;
     bool allow_retry_on_failure = true;
+    bool small_chunk_cache = false;
+    double compaction_threshold = 0;
   };
 
   GPUBFCAllocator(std::unique_ptr<tsl::SubAllocator> sub_allocator,
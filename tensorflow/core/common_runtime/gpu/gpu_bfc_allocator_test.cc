@@ -329,6 +329,139 @@ TEST_P(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   }
 }
 
+TEST_P(GPUBFCAllocatorTest, SmallChunkCacheReusesChunks) {
+  GPUBFCAllocator::Options options;
+  options.small_chunk_cache = true;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+  void* first = a.AllocateRaw(1, 1000);
+  a.DeallocateRaw(first);
+  CheckStats(&a, 1, 0, 1024, 1024);
+
+  // Served from the cache: the same chunk comes back, but sizes and stats
+  // reflect the new request.
+  void* second = a.AllocateRaw(1, 900);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(900, a.RequestedSize(second));
+  EXPECT_EQ(1024, a.AllocatedSize(second));
+  CheckStats(&a, 2, 1024, 1024, 1024);
+  a.DeallocateRaw(second);
+  CheckStats(&a, 2, 0, 1024, 1024);
+}
+
+TEST_P(GPUBFCAllocatorTest, SmallChunkCacheReleasedWhenOutOfMemory) {
+  GPUBFCAllocator::Options options;
+  options.small_chunk_cache = true;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 2 << 20, "GPU_0_bfc", options);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 32; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 64 << 10));
+    ASSERT_NE(nullptr, ptrs.back());
+  }
+  for (void* ptr : ptrs) {
+    a.DeallocateRaw(ptr);
+  }
+  // Only possible once the cached chunks have been coalesced again.
+  void* large = a.AllocateRaw(1, 2 << 20);
+  EXPECT_NE(nullptr, large);
+  a.DeallocateRaw(large);
+}
+
+TEST_P(GPUBFCAllocatorTest, SmallChunkCacheMultiThreaded) {
+  GPUBFCAllocator::Options options;
+  options.small_chunk_cache = true;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+  {
+    thread::ThreadPool pool(Env::Default(), "small_chunk_cache", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&a, t] {
+        random::PhiloxRandom philox(t, 17);
+        random::SimplePhilox rand(&philox);
+        std::vector<void*> live;
+        for (int i = 0; i < 10000; ++i) {
+          if (live.size() < 64 && rand.OneIn(2)) {
+            live.push_back(a.AllocateRaw(1, 1 + rand.Uniform(96 << 10)));
+            ASSERT_NE(nullptr, live.back());
+          } else if (!live.empty()) {
+            int j = rand.Uniform(live.size());
+            a.DeallocateRaw(live[j]);
+            live[j] = live.back();
+            live.pop_back();
+          }
+        }
+        for (void* ptr : live) {
+          a.DeallocateRaw(ptr);
+        }
+      });
+    }
+  }
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->bytes_in_use);
+}
+
+#if CUDA_VERSION >= 10020
+TEST(GPUBFCAllocatorCompactionTest, CompactReleasesFragmentedFreeMemory) {
+  constexpr size_t k2MiB = 2 << 20;
+  PlatformDeviceId gpu_id(0);
+  auto executor =
+      DeviceIdUtil::ExecutorForPlatformDeviceId(GPUMachineManager(), gpu_id)
+          .value();
+  auto* gpu_context = reinterpret_cast<stream_executor::gpu::GpuContext*>(
+      executor->implementation()->GpuContextHack());
+  auto sub_allocator =
+      tensorflow::GpuVirtualMemAllocator::Create(
+          {}, {}, *gpu_context, gpu_id,
+          /*virtual_address_space_size=*/8 * k2MiB, {},
+          /*page_granular_mappings=*/true)
+          .value();
+  GPUBFCAllocator::Options options;
+  options.garbage_collection = false;
+  options.allow_retry_on_failure = false;
+  options.compaction_threshold = 0.25;
+  GPUBFCAllocator a(std::move(sub_allocator), 4 * k2MiB, "GPU_0_bfc",
+                    options);
+
+  // Fill the memory and free every other 2MiB.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 16; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, k2MiB / 4));
+    ASSERT_NE(nullptr, ptrs.back());
+  }
+  for (int i = 0; i < 16; ++i) {
+    if ((i / 4) % 2 == 0) {
+      a.DeallocateRaw(ptrs[i]);
+    }
+  }
+  EXPECT_NEAR(0.5, a.FragmentationMetric(), 1e-6);
+  EXPECT_EQ(nullptr, a.AllocateRaw(1, 2 * k2MiB));
+
+  EXPECT_EQ(2 * k2MiB, a.MaybeCompact([] { return true; }));
+  EXPECT_EQ(0, a.FragmentationMetric());
+
+  // The released pages can now back a contiguous allocation.
+  void* large = a.AllocateRaw(1, 2 * k2MiB);
+  EXPECT_NE(nullptr, large);
+  a.DeallocateRaw(large);
+  for (int i = 0; i < 16; ++i) {
+    if ((i / 4) % 2 == 1) {
+      a.DeallocateRaw(ptrs[i]);
+    }
+  }
+}
+
+TEST(GPUBFCAllocatorCompactionTest, CompactRequiresPartialFrees) {
+  constexpr size_t k2MiB = 2 << 20;
+  GPUBFCAllocator::Options options;
+  options.garbage_collection = false;
+  GPUBFCAllocator a(CreateVirtualMemorySubAllocator(), 4 * k2MiB, "GPU_0_bfc",
+                    options);
+  void* ptr = a.AllocateRaw(1, 256);
+  // Without page granular mappings, nothing can be released.
+  EXPECT_EQ(0, a.Compact([] { return true; }));
+  a.DeallocateRaw(ptr);
+}
+#endif
+
 TEST_P(GPUBFCAllocatorTest, DISABLED_AllocatorReceivesZeroMemory) {
   GPUBFCAllocator a(GetParam()(1ul << 62), 1UL << 60, "GPU_0_bfc", {});
   GPUBFCAllocator b(GetParam()(1ul << 62), 1UL << 60, "GPU_0_bfc", {});
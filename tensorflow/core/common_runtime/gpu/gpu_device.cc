@@ -41,6 +41,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
@@ -252,7 +253,6 @@ class BaseGPUDevice::StreamGroupFactory {
       int priority = GetPriority(tf_device_id.value(), options);
       group->priority = priority;
       group->compute = GetStream(executor, priority);
-      group->compute->Init();
       VLOG(2) << "Created stream[" << stream_group_within_gpu
               << "] = " << group->compute << " with priority: " << priority;
 
@@ -261,7 +261,6 @@ class BaseGPUDevice::StreamGroupFactory {
       // queue init until they are first used. For optimal performance,
       // compute and nccl streams must be immediate siblings.
       group->nccl = GetStream(executor, priority);
-      group->nccl->Init();
       VLOG(2) << "Created nccl_stream[" << stream_group_within_gpu
               << "] = " << group->nccl;
 
@@ -271,12 +270,10 @@ class BaseGPUDevice::StreamGroupFactory {
 #endif
 
       group->host_to_device = GetStream(executor, priority);
-      group->host_to_device->Init();
       VLOG(2) << "Created host_to_device_stream[" << stream_group_within_gpu
               << "] = " << group->host_to_device;
 
       group->device_to_host = GetStream(executor, priority);
-      group->device_to_host->Init();
       VLOG(2) << "Created device_to_host_stream[" << stream_group_within_gpu
               << "] = " << group->device_to_host;
 
@@ -291,11 +288,21 @@ class BaseGPUDevice::StreamGroupFactory {
       }
       for (int i = 0; i < num_d2d_streams; ++i) {
         se::Stream* stream = GetStream(executor, priority);
-        stream->Init();
         group->device_to_device.push_back(stream);
         VLOG(2) << "Created device_to_device_stream[" << stream_group_within_gpu
                 << "] = " << group->device_to_device.back();
       }
+    } else if (GetPriority(tf_device_id.value(), options) != group->priority) {
+      // The streams are shared by all the sessions using the device, and the
+      // allocator of the device must not be shared across streams, so the
+      // priority of the first session wins. Sessions that need a different
+      // priority should use another virtual device.
+      LOG(WARNING) << "Ignoring priority "
+                   << GetPriority(tf_device_id.value(), options)
+                   << " of stream group " << stream_group_within_gpu
+                   << " of GPU " << tf_device_id.value()
+                   << ", whose streams were created with priority "
+                   << group->priority;
     }
     return group;
   }
@@ -372,11 +379,10 @@ class BaseGPUDevice::StreamGroupFactory {
     return priority;
   }
 
-  // Returns a Stream with the underlying GPUStream with the given priority.
+  // Returns an initialized Stream with the given priority.
   se::Stream* GetStream(se::StreamExecutor* executor, int priority) {
     auto stream = new se::Stream(executor);
-    static_cast<stream_executor::gpu::GpuStream*>(stream->implementation())
-        ->SetPriority(priority);
+    stream->InitWithPriority(priority);
     return stream;
   }
 
@@ -473,6 +479,8 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
       options.config.gpu_options().experimental().kernel_tracker_max_interval(),
       options.config.gpu_options().experimental().kernel_tracker_max_bytes(),
       options.config.gpu_options().experimental().kernel_tracker_max_pending());
+  bfc_allocator_ = GPUProcessState::singleton()->GetGPUBFCAllocator(
+      tf_device_id_);
   timestamped_allocator_ =
       options.config.gpu_options().experimental().timestamped_allocator();
   pending_cap_ = tracker_params.max_pending;
@@ -746,7 +754,14 @@ Status BaseGPUDevice::Sync() {
   // enqueued the operation has completed.  We do use other streams for copies
   // and collectives, but in those cases the (Async)OpKernels themselves block
   // until the queued operation has finished.
-  return stream_->compute->BlockHostUntilDone();
+  Status status = stream_->compute->BlockHostUntilDone();
+  // Sync is called at step boundaries, which is a good time to compact
+  // fragmented free memory.
+  if (status.ok() && bfc_allocator_ != nullptr) {
+    bfc_allocator_->MaybeCompact(
+        [this] { return stream_->compute->BlockHostUntilDone().ok(); });
+  }
+  return status;
 }
 
 void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
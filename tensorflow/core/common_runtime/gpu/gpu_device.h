@@ -54,6 +54,7 @@ class StreamInterface;
 }
 
 namespace tensorflow {
+class GPUBFCAllocator;
 class GPUKernelTracker;
 
 class ConcretePerOpGpuDevice : public PerOpGpuDevice {
@@ -157,6 +158,8 @@ class BaseGPUDevice : public LocalDevice {
  protected:
   Allocator* gpu_allocator_;  // not owned
   Allocator* cpu_allocator_;  // not owned
+  // The BFC allocator behind gpu_allocator_, if any. Not owned.
+  GPUBFCAllocator* bfc_allocator_ = nullptr;
 
   se::StreamExecutor* executor_;  // not owned
   std::unique_ptr<ScopedAllocatorMgr> scoped_allocator_mgr_;
@@ -17,9 +17,12 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 
+#include <stdlib.h>
+
 #include "tensorflow/compiler/xla/stream_executor/device_id_utils.h"
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_cudamallocasync_allocator.h"
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
@@ -589,6 +592,48 @@ TEST_F(GPUDeviceTest, StreamToIdMultipleVirtualDevices) {
   EXPECT_FALSE(BaseGPUDevice::FindTfDeviceId(nullptr).has_value());
 }
 
+#if GOOGLE_CUDA && CUDA_VERSION >= 10020
+TEST_F(GPUDeviceTest, SyncCompactsFragmentedMemory) {
+  constexpr size_t k2MiB = 2 << 20;
+  // Compaction makes the device use the virtual memory allocator.
+  setenv("TF_GPU_BFC_COMPACTION_THRESHOLD", "0.25", /*overwrite=*/1);
+  SessionOptions opts = MakeSessionOptions("0", 0, 1, {{64}});
+  std::vector<std::unique_ptr<Device>> devices;
+  Status status = DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices);
+  unsetenv("TF_GPU_BFC_COMPACTION_THRESHOLD");
+  TF_ASSERT_OK(status);
+  ASSERT_THAT(devices, SizeIs(1));
+  GPUBFCAllocator* allocator =
+      GPUProcessState::singleton()->GetGPUBFCAllocator(tsl::TfDeviceId(0));
+  ASSERT_NE(allocator, nullptr);
+
+  // Fill half of the memory and free every other 4MiB of it.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 16; ++i) {
+    ptrs.push_back(allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                          k2MiB));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  for (int i = 0; i < 16; ++i) {
+    if ((i / 2) % 2 == 0) {
+      allocator->DeallocateRaw(ptrs[i]);
+    }
+  }
+  ASSERT_GE(allocator->FragmentationMetric(), 0.25);
+
+  // The step boundary releases the free pages.
+  TF_ASSERT_OK(devices[0]->Sync());
+  EXPECT_EQ(allocator->FragmentationMetric(), 0);
+
+  for (int i = 0; i < 16; ++i) {
+    if ((i / 2) % 2 == 1) {
+      allocator->DeallocateRaw(ptrs[i]);
+    }
+  }
+}
+#endif
+
 class GPUKernelTrackerTest : public ::testing::Test {
  protected:
   void Init(const GPUKernelTracker::Params& params) {
@@ -75,6 +75,16 @@ static bool UseCudaMallocAsyncAllocator() {
 #endif
 }
 
+// Fragmentation above which the GPU BFC allocators compact their free memory
+// at step boundaries, or 0 if compaction is disabled. Read whenever an
+// allocator is created.
+static double BFCCompactionThreshold() {
+  float threshold = 0;
+  TF_CHECK_OK(tsl::ReadFloatFromEnvVar("TF_GPU_BFC_COMPACTION_THRESHOLD", 0,
+                                       &threshold));
+  return threshold;
+}
+
 /*static*/ GPUProcessState* GPUProcessState::singleton(GPUProcessState* ps) {
   static GPUProcessState* instance = ps ? ps : new GPUProcessState;
   DCHECK((!ps) || (ps == instance))
@@ -108,16 +118,13 @@ static std::unique_ptr<SubAllocator> CreateSubAllocator(
                       .value();
 
   // FIXME(imintz): Observed OOM issues when using the virtual memory
-  // allocators. This should be reenabled when resolved.
-#if 0 && defined(GOOGLE_CUDA) && CUDA_VERSION >= 10020
-  // Use the old allocator when unified memory is required.
-  // TODO(imintz): Remove the cuMemAlloc capability of this allocator.
-  if (options.per_process_gpu_memory_fraction() > 1.0 ||
-      options.experimental().use_unified_memory()) {
-    return new se::DeviceMemAllocator(executor, platform_device_id,
-                                  /*use_unified_memory=*/true, alloc_visitors,
-                                  {});
-  } else {
+  // allocators. Until that is resolved, they are only used when compaction of
+  // fragmented free memory is enabled, which needs them to release pages.
+#if defined(GOOGLE_CUDA) && CUDA_VERSION >= 10020
+  // Unified memory still requires the old allocator.
+  if (BFCCompactionThreshold() > 0 &&
+      options.per_process_gpu_memory_fraction() <= 1.0 &&
+      !options.experimental().use_unified_memory()) {
     auto* gpu_context = reinterpret_cast<stream_executor::gpu::GpuContext*>(
         executor->implementation()->GpuContextHack());
 
@@ -125,7 +132,8 @@ static std::unique_ptr<SubAllocator> CreateSubAllocator(
     platform_peer_gpu_ids.reserve(peer_gpu_ids.size());
     for (const tsl::TfDeviceId tf_device_id : peer_gpu_ids) {
       tsl::PlatformDeviceId platform_device_id;
-      TF_CHECK_OK(GpuIdManager::TfToPlatformDeviceId(tf_device_id, &platform_device_id));
+      TF_CHECK_OK(GpuIdManager::TfToPlatformDeviceId(tf_device_id,
+                                                     &platform_device_id));
       platform_peer_gpu_ids.insert(platform_device_id);
     }
     std::vector<tsl::PlatformDeviceId> platform_peer_gpu_ids_vec(
@@ -136,14 +144,18 @@ static std::unique_ptr<SubAllocator> CreateSubAllocator(
     // collection.
     // TODO(imintz): Update BFC allocator to ensure it doesn't create holes in
     // the va space.
-    return GpuVirtualMemAllocator::Create(
-               alloc_visitors, {}, *gpu_context, platform_device_id,
-               /*virtual_address_space_size=*/total_bytes * 2,
-               platform_peer_gpu_ids_vec)
-        .value()
-        .release();
+    auto allocator = GpuVirtualMemAllocator::Create(
+        alloc_visitors, {}, *gpu_context, platform_device_id,
+        /*virtual_address_space_size=*/total_bytes * 2,
+        platform_peer_gpu_ids_vec, /*page_granular_mappings=*/true);
+    if (allocator.ok()) {
+      return std::move(allocator).value();
+    }
+    LOG(WARNING) << "Not compacting GPU memory, the virtual memory allocator "
+                    "is unavailable: "
+                 << allocator.status();
   }
-#else
+#endif
   return absl::WrapUnique(new se::DeviceMemAllocator(
       executor, platform_device_id,
       (options.per_process_gpu_memory_fraction() > 1.0 ||
@@ -197,6 +209,7 @@ Allocator* GPUProcessState::GetGPUAllocator(
               !options.experimental().disallow_retry_on_allocation_failure();
           o.fragmentation_fraction =
               options.experimental().internal_fragmentation_fraction();
+          o.compaction_threshold = BFCCompactionThreshold();
           return o;
         }());
     Allocator* gpu_allocator = gpu_bfc_allocator.get();
@@ -264,6 +277,20 @@ Allocator* GPUProcessState::GetGPUAllocator(
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 }
 
+GPUBFCAllocator* GPUProcessState::GetGPUBFCAllocator(
+    tsl::TfDeviceId tf_device_id) {
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+  mutex_lock l(mu_);
+  if (tf_device_id.value() >= static_cast<int64_t>(gpu_allocators_.size())) {
+    return nullptr;
+  }
+  return gpu_allocators_[tf_device_id.value()].bfc_allocator;
+#else
+  return nullptr;
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
 SharedCounter* GPUProcessState::GPUAllocatorCounter(
     tsl::TfDeviceId tf_device_id) {
   DCHECK(process_state_);
@@ -130,6 +130,10 @@ class GPUProcessState {
 
   SharedCounter* GPUAllocatorCounter(tsl::TfDeviceId tf_device_id);
 
+  // Returns the BFC allocator backing GetGPUAllocator() for the given GPU, or
+  // nullptr if there is none (e.g. if a cudaMalloc based allocator is used).
+  GPUBFCAllocator* GetGPUBFCAllocator(tsl::TfDeviceId tf_device_id);
+
  protected:
   // GPUProcessState is a singleton that should not normally be deleted except
   // at process shutdown.
@@ -0,0 +1,167 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_buffer_pool.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/stream_executor/device_host_allocator.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+auto* staging_requests = monitoring::Counter<2>::New(
+    "/tensorflow/core/gpu_staging_buffer_pool/requests",
+    "The number of staging buffers requested from a GPU staging buffer pool, "
+    "by outcome ('served' or 'rejected').",
+    "pool", "outcome");
+
+auto* staging_pool_hits = monitoring::Counter<1>::New(
+    "/tensorflow/core/gpu_staging_buffer_pool/pool_hits",
+    "The number of staging buffer requests served with an idle buffer of the "
+    "pool.",
+    "pool");
+
+auto* staging_evictions = monitoring::Counter<1>::New(
+    "/tensorflow/core/gpu_staging_buffer_pool/evictions",
+    "The number of idle staging buffers freed because the pool was full.",
+    "pool");
+
+auto* staging_bytes_in_use = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/gpu_staging_buffer_pool/bytes_in_use",
+    "The number of requested bytes of the staging buffers in use.", "pool");
+
+}  // namespace
+
+GPUStagingBufferPool::GPUStagingBufferPool(SubAllocator* host_allocator,
+                                           const Options& options)
+    : options_(options),
+      pool_(options.max_pooled_buffers, /*auto_resize=*/false, host_allocator,
+            new Pow2Rounder, options.name) {}
+
+/* static */ GPUStagingBufferPool* GPUStagingBufferPool::Get(
+    se::StreamExecutor* stream_exec) {
+  static const int64_t max_mb = [] {
+    int64_t mb;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GPU_STAGING_POOL_MAX_MB", 512, &mb));
+    return mb;
+  }();
+  if (max_mb <= 0) {
+    return nullptr;
+  }
+  static mutex* mu = new mutex;
+  static auto* pools =
+      new absl::flat_hash_map<se::StreamExecutor*,
+                              std::unique_ptr<GPUStagingBufferPool>>;
+  mutex_lock l(*mu);
+  std::unique_ptr<GPUStagingBufferPool>& pool = (*pools)[stream_exec];
+  if (pool == nullptr) {
+    Options options;
+    options.name =
+        absl::StrCat("gpu_staging_buffer_pool_", stream_exec->device_ordinal());
+    options.max_bytes_in_use = max_mb << 20;
+    options.max_buffer_bytes =
+        std::min(options.max_buffer_bytes, options.max_bytes_in_use);
+    const int numa_node = stream_exec->GetDeviceDescription().numa_node();
+    pool = std::make_unique<GPUStagingBufferPool>(
+        new se::DeviceHostAllocator(stream_exec, std::max(numa_node, 0), {},
+                                    {}),
+        options);
+  }
+  return pool.get();
+}
+
+/* static */ bool GPUStagingBufferPool::StageDeviceToHostCopies() {
+  static const bool stage = [] {
+    bool value;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_GPU_STAGE_DEVICE_TO_HOST_COPIES",
+                                   /*default_val=*/false, &value));
+    return value;
+  }();
+  return stage;
+}
+
+void* GPUStagingBufferPool::Allocate(size_t num_bytes) {
+  {
+    mutex_lock l(mu_);
+    if (num_bytes > options_.max_buffer_bytes ||
+        bytes_in_use_ + num_bytes > options_.max_bytes_in_use) {
+      ++num_rejected_;
+      staging_requests->GetCell(options_.name, "rejected")->IncrementBy(1);
+      return nullptr;
+    }
+    bytes_in_use_ += num_bytes;
+    peak_bytes_in_use_ = std::max(peak_bytes_in_use_, bytes_in_use_);
+  }
+  void* ptr = pool_.AllocateRaw(Allocator::kAllocatorAlignment, num_bytes);
+  mutex_lock l(mu_);
+  if (ptr == nullptr) {
+    bytes_in_use_ -= num_bytes;
+    ++num_rejected_;
+    staging_requests->GetCell(options_.name, "rejected")->IncrementBy(1);
+  } else {
+    ++num_allocs_;
+    staging_requests->GetCell(options_.name, "served")->IncrementBy(1);
+  }
+  staging_bytes_in_use->GetCell(options_.name)->Set(bytes_in_use_);
+  ExportPoolCounts();
+  return ptr;
+}
+
+void GPUStagingBufferPool::Deallocate(void* ptr, size_t num_bytes) {
+  pool_.DeallocateRaw(ptr);
+  mutex_lock l(mu_);
+  bytes_in_use_ -= num_bytes;
+  staging_bytes_in_use->GetCell(options_.name)->Set(bytes_in_use_);
+  ExportPoolCounts();
+}
+
+void GPUStagingBufferPool::ExportPoolCounts() {
+  // The counts of `pool_` only grow, and are exported under `mu_`, so the
+  // increments are never negative.
+  const int64_t pool_hits = pool_.get_from_pool_count();
+  if (pool_hits > exported_pool_hits_) {
+    staging_pool_hits->GetCell(options_.name)
+        ->IncrementBy(pool_hits - exported_pool_hits_);
+    exported_pool_hits_ = pool_hits;
+  }
+  const int64_t evictions = pool_.evicted_count();
+  if (evictions > exported_evictions_) {
+    staging_evictions->GetCell(options_.name)
+        ->IncrementBy(evictions - exported_evictions_);
+    exported_evictions_ = evictions;
+  }
+}
+
+GPUStagingBufferPool::Stats GPUStagingBufferPool::GetStats() {
+  Stats stats;
+  stats.num_pool_hits = pool_.get_from_pool_count();
+  stats.num_evicted = pool_.evicted_count();
+  mutex_lock l(mu_);
+  stats.num_allocs = num_allocs_;
+  stats.num_rejected = num_rejected_;
+  stats.bytes_in_use = bytes_in_use_;
+  stats.peak_bytes_in_use = peak_bytes_in_use_;
+  return stats;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,113 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STAGING_BUFFER_POOL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STAGING_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A pool of pinned host buffers used by GPUUtil to stage copies between GPU
+// memory and CPU tensors in pageable memory, which the driver would otherwise
+// stage itself at a fraction of the bandwidth.
+//
+// Buffers are bucketed by power-of-two size by a PoolAllocator and recycled
+// across steps. Requests larger than `max_buffer_bytes`, or that would make
+// the bytes in use exceed `max_bytes_in_use`, are rejected so that the caller
+// can fall back to an unstaged copy.
+//
+// The requests, pool hits, evictions and bytes in use are exported as
+// monitoring metrics under /tensorflow/core/gpu_staging_buffer_pool/,
+// labeled by the name of the pool.
+//
+// This class is thread-safe.
+class GPUStagingBufferPool {
+ public:
+  struct Options {
+    // Name of the pool, which labels its metrics.
+    std::string name = "gpu_staging_buffer_pool";
+    // Maximum number of idle buffers kept for reuse.
+    size_t max_pooled_buffers = 64;
+    // Largest request that is served.
+    size_t max_buffer_bytes = 64 << 20;
+    // Maximum number of requested bytes in use at once.
+    size_t max_bytes_in_use = 512 << 20;
+  };
+
+  struct Stats {
+    // Requests served, and the number of those served from the pool.
+    int64_t num_allocs = 0;
+    int64_t num_pool_hits = 0;
+    // Requests rejected because of the caps.
+    int64_t num_rejected = 0;
+    // Idle buffers freed because the pool was full.
+    int64_t num_evicted = 0;
+    int64_t bytes_in_use = 0;
+    int64_t peak_bytes_in_use = 0;
+  };
+
+  // Takes ownership of `host_allocator`, which should allocate pinned memory.
+  GPUStagingBufferPool(SubAllocator* host_allocator, const Options& options);
+
+  // Returns the pool for staging copies to and from the GPU of `stream_exec`,
+  // creating it on first use. Returns nullptr if staging buffers are disabled
+  // by setting TF_GPU_STAGING_POOL_MAX_MB to 0.
+  static GPUStagingBufferPool* Get(se::StreamExecutor* stream_exec);
+
+  // Returns whether copies from the GPU to pageable CPU tensors are staged as
+  // well, which costs an extra host memcpy out of the pinned buffer. Enabled
+  // by setting TF_GPU_STAGE_DEVICE_TO_HOST_COPIES to true.
+  static bool StageDeviceToHostCopies();
+
+  // Returns a buffer of at least `num_bytes`, or nullptr if the request is
+  // rejected.
+  void* Allocate(size_t num_bytes);
+
+  // Returns a buffer obtained from Allocate(num_bytes) to the pool.
+  void Deallocate(void* ptr, size_t num_bytes);
+
+  Stats GetStats();
+
+ private:
+  // Exports the pool hits and evictions counted by `pool_` since the last
+  // call.
+  void ExportPoolCounts() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Options options_;
+  PoolAllocator pool_;
+
+  mutex mu_;
+  int64_t exported_pool_hits_ TF_GUARDED_BY(mu_) = 0;
+  int64_t exported_evictions_ TF_GUARDED_BY(mu_) = 0;
+  int64_t bytes_in_use_ TF_GUARDED_BY(mu_) = 0;
+  int64_t peak_bytes_in_use_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_allocs_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_rejected_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GPUStagingBufferPool);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STAGING_BUFFER_POOL_H_
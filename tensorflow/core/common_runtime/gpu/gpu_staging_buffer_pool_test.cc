@@ -0,0 +1,137 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_buffer_pool.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+GPUStagingBufferPool::Options TestOptions() {
+  GPUStagingBufferPool::Options options;
+  options.max_pooled_buffers = 4;
+  options.max_buffer_bytes = 1 << 20;
+  options.max_bytes_in_use = 2 << 20;
+  return options;
+}
+
+TEST(GPUStagingBufferPoolTest, ReusesBuffersAcrossRequests) {
+  GPUStagingBufferPool pool(
+      new BasicCPUAllocator(port::kNUMANoAffinity, {}, {}), TestOptions());
+  void* p1 = pool.Allocate(1000);
+  ASSERT_NE(p1, nullptr);
+  pool.Deallocate(p1, 1000);
+  // Rounded up to the same power-of-two bucket, so served from the pool.
+  void* p2 = pool.Allocate(900);
+  EXPECT_EQ(p1, p2);
+  pool.Deallocate(p2, 900);
+
+  GPUStagingBufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.num_allocs, 2);
+  EXPECT_EQ(stats.num_pool_hits, 1);
+  EXPECT_EQ(stats.num_rejected, 0);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.peak_bytes_in_use, 1000);
+}
+
+TEST(GPUStagingBufferPoolTest, RejectsRequestsOverTheCaps) {
+  GPUStagingBufferPool pool(
+      new BasicCPUAllocator(port::kNUMANoAffinity, {}, {}), TestOptions());
+  EXPECT_EQ(pool.Allocate((1 << 20) + 1), nullptr);
+
+  void* p1 = pool.Allocate(1 << 20);
+  void* p2 = pool.Allocate(1 << 20);
+  ASSERT_NE(p1, nullptr);
+  ASSERT_NE(p2, nullptr);
+  EXPECT_EQ(pool.Allocate(1), nullptr);
+  pool.Deallocate(p1, 1 << 20);
+  void* p3 = pool.Allocate(1);
+  EXPECT_NE(p3, nullptr);
+  pool.Deallocate(p2, 1 << 20);
+  pool.Deallocate(p3, 1);
+
+  GPUStagingBufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.num_allocs, 3);
+  EXPECT_EQ(stats.num_rejected, 2);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.peak_bytes_in_use, 2 << 20);
+}
+
+TEST(GPUStagingBufferPoolTest, EvictsWhenPoolIsFull) {
+  GPUStagingBufferPool pool(
+      new BasicCPUAllocator(port::kNUMANoAffinity, {}, {}), TestOptions());
+  std::vector<void*> buffers;
+  for (int i = 0; i < 6; ++i) {
+    buffers.push_back(pool.Allocate(1024 << i));
+    ASSERT_NE(buffers.back(), nullptr);
+  }
+  for (int i = 0; i < 6; ++i) {
+    pool.Deallocate(buffers[i], 1024 << i);
+  }
+  EXPECT_EQ(pool.GetStats().num_evicted, 2);
+}
+
+TEST(GPUStagingBufferPoolTest, ExportsMetrics) {
+  using monitoring::testing::CellReader;
+  CellReader<int64_t> requests(
+      "/tensorflow/core/gpu_staging_buffer_pool/requests");
+  CellReader<int64_t> pool_hits(
+      "/tensorflow/core/gpu_staging_buffer_pool/pool_hits");
+  CellReader<int64_t> evictions(
+      "/tensorflow/core/gpu_staging_buffer_pool/evictions");
+  CellReader<int64_t> bytes_in_use(
+      "/tensorflow/core/gpu_staging_buffer_pool/bytes_in_use");
+  GPUStagingBufferPool::Options options = TestOptions();
+  options.name = "metrics_test_pool";
+  GPUStagingBufferPool pool(
+      new BasicCPUAllocator(port::kNUMANoAffinity, {}, {}), options);
+
+  void* p1 = pool.Allocate(1000);
+  ASSERT_NE(p1, nullptr);
+  EXPECT_EQ(bytes_in_use.Read("metrics_test_pool"), 1000);
+  pool.Deallocate(p1, 1000);
+  EXPECT_EQ(bytes_in_use.Read("metrics_test_pool"), 0);
+  void* p2 = pool.Allocate(900);
+  ASSERT_NE(p2, nullptr);
+  EXPECT_EQ(pool.Allocate((1 << 20) + 1), nullptr);
+  pool.Deallocate(p2, 900);
+  EXPECT_EQ(requests.Delta("metrics_test_pool", "served"), 2);
+  EXPECT_EQ(requests.Delta("metrics_test_pool", "rejected"), 1);
+  EXPECT_EQ(pool_hits.Delta("metrics_test_pool"), 1);
+  EXPECT_EQ(evictions.Delta("metrics_test_pool"), 0);
+
+  // Returns buffers of 6 other sizes to the pool, which holds 4 idle buffers,
+  // so 3 of the 7 idle buffers are evicted.
+  std::vector<void*> buffers;
+  for (int i = 0; i < 6; ++i) {
+    buffers.push_back(pool.Allocate(4096 << i));
+    ASSERT_NE(buffers.back(), nullptr);
+  }
+  for (int i = 0; i < 6; ++i) {
+    pool.Deallocate(buffers[i], 4096 << i);
+  }
+  EXPECT_EQ(requests.Delta("metrics_test_pool", "served"), 6);
+  EXPECT_EQ(pool_hits.Delta("metrics_test_pool"), 0);
+  EXPECT_EQ(evictions.Delta("metrics_test_pool"), 3);
+  EXPECT_EQ(pool.GetStats().num_evicted, 3);
+}
+
+}  // namespace
+}  // namespace tensorflow
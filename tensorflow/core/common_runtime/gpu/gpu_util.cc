@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_buffer_pool.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
@@ -292,20 +293,39 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
   send_device_to_host_stream->ThenWaitFor(send_stream);
 
   const int64_t total_bytes = gpu_tensor->TotalBytes();
+  void* dst_ptr = nullptr;
+  GPUStagingBufferPool* staging_pool = nullptr;
+  void* staging_buffer = nullptr;
   if (total_bytes > 0) {
     void* src_ptr = GetBase(gpu_tensor);
     DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
-    void* dst_ptr = GetBase(cpu_tensor);
-    send_device_to_host_stream->ThenMemcpy(dst_ptr, gpu_src_ptr, total_bytes);
+    dst_ptr = GetBase(cpu_tensor);
+    // Copy through a pinned buffer if the destination is pageable and the
+    // extra host memcpy out of it is enabled.
+    if (NeedStaging(cpu_tensor) &&
+        GPUStagingBufferPool::StageDeviceToHostCopies()) {
+      staging_pool = GPUStagingBufferPool::Get(dev_info->stream->parent());
+      if (staging_pool != nullptr) {
+        staging_buffer = staging_pool->Allocate(total_bytes);
+      }
+    }
+    send_device_to_host_stream->ThenMemcpy(
+        staging_buffer != nullptr ? staging_buffer : dst_ptr, gpu_src_ptr,
+        total_bytes);
   }
   // Use of the input may outlive stack scope, so keep a ref.
   TensorReference input_ref(*gpu_tensor);
   dev_info->event_mgr->ThenExecute(
       send_device_to_host_stream,
-      [send_device_to_host_stream, done, input_ref]() {
+      [send_device_to_host_stream, done, input_ref, dst_ptr, total_bytes,
+       staging_pool, staging_buffer]() {
         if (!send_device_to_host_stream->ok()) {
           LOG(FATAL) << "GPU->CPU Memcpy failed";
         }
+        if (staging_buffer != nullptr) {
+          std::memcpy(dst_ptr, staging_buffer, total_bytes);
+          staging_pool->Deallocate(staging_buffer, total_bytes);
+        }
         input_ref.Unref();
         done(OkStatus());
       });
@@ -342,6 +362,7 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
 
   bool do_staging = false;
   void* staging_buffer = nullptr;
+  GPUStagingBufferPool* staging_pool = nullptr;
   Allocator* host_memory_allocator = device_context->host_memory_allocator();
 
   // Use of cpu_tensor may outlive stack scope, so keep a ref.
@@ -354,18 +375,27 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
     DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
 
     if (NeedStaging(cpu_tensor)) {
-      if (host_memory_allocator == nullptr) {
-        LOG_FIRST_N(WARNING, 1)
-            << "No host memory allocator is available to "
-               "stage data for CPU->GPU transfer. Staging will be skipped.";
-      } else {
-        do_staging = true;
+      // Prefer the size-bucketed staging pool, which recycles its buffers
+      // across steps, and fall back to the host memory allocator.
+      staging_pool = GPUStagingBufferPool::Get(dev_info->stream->parent());
+      if (staging_pool != nullptr) {
+        staging_buffer = staging_pool->Allocate(total_bytes);
+      }
+      if (staging_buffer == nullptr) {
+        staging_pool = nullptr;
+        if (host_memory_allocator == nullptr) {
+          LOG_FIRST_N(WARNING, 1)
+              << "No host memory allocator is available to "
+                 "stage data for CPU->GPU transfer. Staging will be skipped.";
+        } else {
+          staging_buffer = host_memory_allocator->AllocateRaw(
+              tensorflow::Allocator::kAllocatorAlignment, total_bytes);
+        }
       }
+      do_staging = staging_buffer != nullptr;
     }
 
     if (do_staging) {
-      staging_buffer = host_memory_allocator->AllocateRaw(
-          tensorflow::Allocator::kAllocatorAlignment, total_bytes);
       std::memcpy(staging_buffer, src_ptr, total_bytes);
       input_ref.Unref();
 
@@ -380,8 +410,10 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   dev_info->event_mgr->ThenExecute(
       recv_host_to_device_stream,
       [recv_host_to_device_stream, done, input_ref, do_staging, staging_buffer,
-       host_memory_allocator]() {
-        if (do_staging) {
+       staging_pool, total_bytes, host_memory_allocator]() {
+        if (staging_pool != nullptr) {
+          staging_pool->Deallocate(staging_buffer, total_bytes);
+        } else if (do_staging) {
           host_memory_allocator->DeallocateRaw(staging_buffer);
         } else {
           input_ref.Unref();
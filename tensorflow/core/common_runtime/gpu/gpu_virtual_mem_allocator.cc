@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
 #include "absl/strings/str_format.h"
 #include "tensorflow/compiler/xla/stream_executor/lib/status.h"
 #include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
@@ -64,7 +68,8 @@ GpuVirtualMemAllocator::Create(
     const std::vector<Visitor>& alloc_visitors,
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
-    const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids) {
+    const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids,
+    bool page_granular_mappings) {
   tsl::profiler::TraceMe traceme("GpuVirtualMemAllocator::Create");
 
   std::vector<GpuDeviceHandle> access_gpu_handles;
@@ -108,7 +113,8 @@ GpuVirtualMemAllocator::Create(
 
   return std::unique_ptr<GpuVirtualMemAllocator>(new GpuVirtualMemAllocator(
       alloc_visitors, free_visitors, gpu_context, gpu_id,
-      std::move(access_gpu_handles), vmem, max_granularity));
+      std::move(access_gpu_handles), vmem, max_granularity,
+      page_granular_mappings));
 }
 
 GpuVirtualMemAllocator::GpuVirtualMemAllocator(
@@ -116,13 +122,14 @@ GpuVirtualMemAllocator::GpuVirtualMemAllocator(
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     tsl::PlatformDeviceId gpu_id,
     const std::vector<GpuDeviceHandle> access_gpu_handles,
-    GpuDriver::VmemSpan vmem, size_t granularity)
+    GpuDriver::VmemSpan vmem, size_t granularity, bool page_granular_mappings)
     : SubAllocator(alloc_visitors, free_visitors),
       gpu_context_(gpu_context),
       gpu_id_(gpu_id),
       access_gpu_handles_(access_gpu_handles),
       vmem_(vmem),
-      granularity_(granularity) {}
+      granularity_(granularity),
+      page_granular_mappings_(page_granular_mappings) {}
 
 GpuVirtualMemAllocator::~GpuVirtualMemAllocator() {
   for (const auto mapping : mappings_) {
@@ -145,37 +152,71 @@ void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
   // virtual memory at the specific address at the end of the initial vmem
   // reservation.
   if (next_va + padded_bytes > vmem_.base + vmem_.size_bytes) {
-    LOG(ERROR) << "OOM in GPU virtual memory allocator when attempting to "
-                  "allocate {request: "
-               << tsl::strings::HumanReadableNumBytes(num_bytes)
-               << ", aligned: " << padded_bytes << "} bytes.";
-    return nullptr;
+    next_va = page_granular_mappings_ ? FindHole(padded_bytes) : 0;
+    if (next_va == 0) {
+      LOG(ERROR) << "OOM in GPU virtual memory allocator when attempting to "
+                    "allocate {request: "
+                 << tsl::strings::HumanReadableNumBytes(num_bytes)
+                 << ", aligned: " << padded_bytes << "} bytes.";
+      return nullptr;
+    }
   }
 
-  // Create physical memory backing allocation.
-  auto maybe_handle =
-      GpuDriver::CreateMemoryHandle(&gpu_context_, padded_bytes);
-  if (!maybe_handle.ok()) {
-    LOG(ERROR) << maybe_handle.status();
-    return nullptr;
-  }
-  GpuDriver::GenericMemoryHandle handle = std::move(maybe_handle).value();
-
-  // Map VAs for this physical memory.
-  auto status =
-      GpuDriver::MapMemory(&gpu_context_, next_va, handle, access_gpu_handles_);
-  if (!status.ok()) {
-    LOG(ERROR) << status;
-    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
-    return nullptr;
+  // Create the physical memory backing the allocation and map VAs for it.
+  const size_t handle_bytes =
+      page_granular_mappings_ ? granularity_ : padded_bytes;
+  std::vector<Mapping> new_mappings;
+  new_mappings.reserve(padded_bytes / handle_bytes);
+  for (size_t offset = 0; offset < padded_bytes; offset += handle_bytes) {
+    auto maybe_handle =
+        GpuDriver::CreateMemoryHandle(&gpu_context_, handle_bytes);
+    Status status = maybe_handle.status();
+    if (status.ok()) {
+      status = GpuDriver::MapMemory(&gpu_context_, next_va + offset,
+                                    *maybe_handle, access_gpu_handles_);
+      if (!status.ok()) {
+        GpuDriver::ReleaseMemoryHandle(&gpu_context_,
+                                       std::move(maybe_handle).value());
+      }
+    }
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      for (Mapping& mapping : new_mappings) {
+        GpuDriver::UnmapMemory(&gpu_context_, mapping.va,
+                               mapping.physical.bytes);
+        GpuDriver::ReleaseMemoryHandle(&gpu_context_,
+                                       std::move(mapping.physical));
+      }
+      return nullptr;
+    }
+    new_mappings.push_back({next_va + offset, std::move(maybe_handle).value()});
   }
-  next_alloc_offset_ += handle.bytes;
-  mappings_.push_back({next_va, std::move(handle)});
+  next_alloc_offset_ =
+      std::max(next_alloc_offset_,
+               static_cast<size_t>(next_va + padded_bytes - vmem_.base));
+  auto insert_it =
+      std::lower_bound(mappings_.begin(), mappings_.end(), next_va,
+                       [](const Mapping& mapping, GpuDevicePtr va) {
+                         return mapping.va < va;
+                       });
+  mappings_.insert(insert_it, std::make_move_iterator(new_mappings.begin()),
+                   std::make_move_iterator(new_mappings.end()));
   VisitAlloc(reinterpret_cast<void*>(next_va), gpu_id_.value(), padded_bytes);
   *bytes_received = padded_bytes;
   return reinterpret_cast<void*>(next_va);
 }
 
+GpuDevicePtr GpuVirtualMemAllocator::FindHole(size_t num_bytes) const {
+  GpuDevicePtr hole_begin = vmem_.base;
+  for (const Mapping& mapping : mappings_) {
+    if (mapping.va - hole_begin >= num_bytes) {
+      return hole_begin;
+    }
+    hole_begin = mapping.va + mapping.physical.bytes;
+  }
+  return 0;
+}
+
 void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
   tsl::profiler::TraceMe traceme("GpuVirtualMemAllocator::Free");
 
@@ -40,6 +40,12 @@ namespace tensorflow {
 // reserving a large chunk of virtual addresses at construction and then mapping
 // physical memory pages to this virtual address range as requested.
 //
+// If `page_granular_mappings` is set, physical memory is mapped in units of the
+// allocation granularity, so that any granularity-aligned range of an
+// allocation can be freed on its own, and holes left by frees are reused once
+// the end of the virtual address range is reached. This lets the BFC allocator
+// compact fragmented free memory (see BFCAllocator::Compact).
+//
 // This class is not thread-safe.
 class GpuVirtualMemAllocator : public tsl::SubAllocator {
  public:
@@ -48,7 +54,8 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
       const std::vector<Visitor>& free_visitors,
       stream_executor::gpu::GpuContext& gpu_context,
       tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
-      const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids);
+      const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids,
+      bool page_granular_mappings = false);
   ~GpuVirtualMemAllocator() override;
 
   // Allocates memory at least as large as requested by num_bytes. Will be
@@ -62,9 +69,10 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
   // allocation happens at the end, then the next_alloc_offset_ is moved back,
   // otherwise a hole is created.
   //
-  // Holes are not re-used, all allocations continue to come at the end of the
-  // next_alloc_offset_. To accommodate this, the virtual_address_space_size
-  // should be much larger than the max physical size of the allocator.
+  // Unless page_granular_mappings is set, holes are not re-used, all
+  // allocations continue to come at the end of the next_alloc_offset_. To
+  // accommodate this, the virtual_address_space_size should be much larger than
+  // the max physical size of the allocator.
   //
   // In practice, since the BFC allocator coalesces adjacent AllocationRegions,
   // this free function should never be invoked.
@@ -72,6 +80,10 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
 
   bool SupportsCoalescing() const override { return true; }
 
+  size_t PartialFreeGranularity() const override {
+    return page_granular_mappings_ ? granularity_ : 0;
+  }
+
  private:
   GpuVirtualMemAllocator(
       const std::vector<Visitor>& alloc_visitors,
@@ -79,7 +91,12 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
       stream_executor::gpu::GpuContext& gpu_context,
       tsl::PlatformDeviceId gpu_id,
       std::vector<stream_executor::gpu::GpuDeviceHandle> access_device_handles,
-      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity);
+      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity,
+      bool page_granular_mappings);
+
+  // Returns the start of the first hole between mappings of at least
+  // `num_bytes`, or 0 if there is none.
+  stream_executor::gpu::GpuDevicePtr FindHole(size_t num_bytes) const;
 
   stream_executor::gpu::GpuContext& gpu_context_;
   tsl::PlatformDeviceId gpu_id_;
@@ -100,6 +117,8 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
   // Smallest allocation as determined by CUDA.
   const size_t granularity_;
 
+  const bool page_granular_mappings_;
+
   struct Mapping {
     stream_executor::gpu::GpuDevicePtr va;
     stream_executor::gpu::GpuDriver::GenericMemoryHandle physical;
@@ -34,7 +34,8 @@ using ::stream_executor::gpu::GpuDriver;
 constexpr size_t k2MiB{2 << 20};
 
 // Creates an allocator with 8 MiB of virtual address space.
-std::unique_ptr<GpuVirtualMemAllocator> CreateAllocator() {
+std::unique_ptr<GpuVirtualMemAllocator> CreateAllocator(
+    bool page_granular_mappings = false) {
   tsl::PlatformDeviceId gpu_id(0);
   auto executor = se::DeviceIdUtil::ExecutorForPlatformDeviceId(
                       se::GPUMachineManager(), gpu_id)
@@ -43,7 +44,8 @@ std::unique_ptr<GpuVirtualMemAllocator> CreateAllocator() {
       executor->implementation()->GpuContextHack());
   return GpuVirtualMemAllocator::Create(
              {}, {}, *gpu_context, gpu_id,
-             /*virtual_address_space_size=*/4 * k2MiB, {})
+             /*virtual_address_space_size=*/4 * k2MiB, {},
+             page_granular_mappings)
       .value();
 }
 
@@ -179,6 +181,36 @@ TEST(GpuVirtualMemAllocatorTest, FreeRange) {
   ASSERT_EQ(re_alloc, first_alloc);
 }
 
+TEST(GpuVirtualMemAllocatorTest, PageGranularPartialFree) {
+  auto allocator = CreateAllocator(/*page_granular_mappings=*/true);
+  EXPECT_EQ(allocator->PartialFreeGranularity(), k2MiB);
+  size_t bytes_received;  // Ignored in this test.
+  void* first_alloc = allocator->Alloc(
+      /*alignment=*/0, /*num_bytes=*/3 * k2MiB, &bytes_received);
+  ASSERT_NE(first_alloc, nullptr);
+  void* middle = reinterpret_cast<char*>(first_alloc) + k2MiB;
+
+  // Free the middle of the allocation on its own.
+  allocator->Free(middle, k2MiB);
+
+  void* second_alloc =
+      allocator->Alloc(/*alignment=*/0, /*num_bytes=*/k2MiB, &bytes_received);
+  ASSERT_EQ(second_alloc, reinterpret_cast<char*>(first_alloc) + 3 * k2MiB);
+
+  // The end of the virtual address space is reached, so the hole is reused.
+  void* third_alloc =
+      allocator->Alloc(/*alignment=*/0, /*num_bytes=*/k2MiB, &bytes_received);
+  ASSERT_EQ(third_alloc, middle);
+  void* over_alloc =
+      allocator->Alloc(/*alignment=*/0, /*num_bytes=*/k2MiB, &bytes_received);
+  ASSERT_EQ(over_alloc, nullptr);
+}
+
+TEST(GpuVirtualMemAllocatorTest, NoPartialFreeByDefault) {
+  auto allocator = CreateAllocator();
+  EXPECT_EQ(allocator->PartialFreeGranularity(), 0);
+}
+
 }  // namespace
 }  // namespace tensorflow
 
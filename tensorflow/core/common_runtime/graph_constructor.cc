@@ -48,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -102,7 +103,8 @@ class GraphConstructor {
           importing(false),
           validate_nodes(in.validate_nodes),
           validate_colocation_constraints(false),
-          add_default_attributes(in.add_default_attributes) {}
+          add_default_attributes(in.add_default_attributes),
+          thread_pool(in.thread_pool) {}
     Options(const ImportGraphDefOptions& in)  // NOLINT(runtime/explicit)
         : allow_internal_ops(false),
           expect_device_spec(false),
@@ -157,6 +159,11 @@ class GraphConstructor {
     bool add_default_attributes = true;
 
     string default_device;
+
+    // If set, PrepareNodeDefs() prepares all nodes in parallel on this pool.
+    // Only set when not importing, since importing rewrites the nodes in
+    // topological order. Not owned.
+    thread::ThreadPool* thread_pool = nullptr;
   };
 
   typedef gtl::ArraySlice<const NodeDef*> NodeDefSlice;
@@ -238,6 +245,12 @@ class GraphConstructor {
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
+  // Looks up the op of `node_def`, adds the default attributes and validates
+  // it as requested by `opts_`, when not importing.
+  Status PrepareNodeDef(NodeDef* node_def) const;
+  // Consumes and prepares all nodes in parallel on `opts_.thread_pool`, into
+  // `prepared_node_defs_` and `prepare_status_`.
+  void PrepareNodeDefs();
   // Modifies node_def's inputs according to opts_.input_map.
   // input_already_exists is a pre-initialized vector of length
   // node_def->input_size(). This function will mark inputs that are remapped to
@@ -289,7 +302,7 @@ class GraphConstructor {
   virtual const NodeDef& get_node_def(int i) const = 0;
   // Destructively reads the i^th node in the graph, avoiding a copy if
   // possible. After calling this method, the result of get_node_def(i) is
-  // undefined.
+  // undefined. May be called concurrently for distinct nodes.
   virtual NodeDef consume_node_def(int i) = 0;
   // Returns the version information for the graph, or nullptr if none is
   // available.
@@ -393,6 +406,12 @@ class GraphConstructor {
   };
   std::vector<EdgeInfo> back_edges_;
 
+  // The nodes consumed and prepared by PrepareNodeDefs() and the status of
+  // their preparation, indexed like node_defs_. Empty if the nodes are
+  // consumed and prepared one at a time by Convert().
+  std::vector<NodeDef> prepared_node_defs_;
+  std::vector<Status> prepare_status_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GraphConstructor);
 };
 
@@ -459,7 +478,9 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
   }
 
   GraphDef graph_def_;
-  std::vector<bool> is_consumed_;
+  // Not a std::vector<bool>, so that distinct nodes can be consumed
+  // concurrently.
+  std::vector<uint8_t> is_consumed_;
 };
 
 bool ForwardCompatibilityWindowPassed(const VersionDef& versions) {
@@ -835,6 +856,34 @@ Status GraphConstructor::ValidateShape(Node* node) {
   return OkStatus();
 }
 
+Status GraphConstructor::PrepareNodeDef(NodeDef* node_def) const {
+  const OpDef* op_def;
+  TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
+  if (opts_.add_default_attributes) {
+    AddDefaultsToNodeDef(*op_def, node_def);
+  }
+  if (opts_.validate_nodes) {
+    TF_RETURN_IF_ERROR(ValidateNodeDef(*node_def, *op_def));
+  }
+  return OkStatus();
+}
+
+void GraphConstructor::PrepareNodeDefs() {
+  DCHECK(!opts_.importing);
+  const int64_t num_nodes = node_def_count();
+  prepared_node_defs_.resize(num_nodes);
+  prepare_status_.resize(num_nodes);
+  // Roughly the cost in cycles of copying, completing and validating a node.
+  constexpr int64_t kPrepareNodeDefCost = 10000;
+  opts_.thread_pool->ParallelFor(
+      num_nodes, kPrepareNodeDefCost, [this](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          prepared_node_defs_[i] = consume_node_def(i);
+          prepare_status_[i] = PrepareNodeDef(&prepared_node_defs_[i]);
+        }
+      });
+}
+
 Status GraphConstructor::ModifyNodeDefForImport(NodeDef* node_def) {
   const OpDef* op_def;
   TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
@@ -1130,6 +1179,13 @@ Status GraphConstructor::Convert() {
     TF_RETURN_IF_ERROR(g_->AddFunctionLibrary(*library()));
   }
 
+  // Without renaming, the nodes don't depend on each other until their edges
+  // are added, so they can be prepared in any order.
+  if (opts_.thread_pool != nullptr && !opts_.importing) {
+    PrepareNodeDefs();
+  }
+  const bool prepared = !prepared_node_defs_.empty();
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1146,7 +1202,8 @@ Status GraphConstructor::Convert() {
     inputs.clear();
     bool has_data_back_edge = false;
 
-    NodeDef node_def = consume_node_def(o);
+    NodeDef node_def =
+        prepared ? std::move(prepared_node_defs_[o]) : consume_node_def(o);
 
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
@@ -1242,16 +1299,10 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
+    } else if (prepared) {
+      TF_RETURN_IF_ERROR(prepare_status_[o]);
     } else {
-      const OpDef* op_def;
-      TF_RETURN_IF_ERROR(
-          g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
-      if (opts_.add_default_attributes) {
-        AddDefaultsToNodeDef(*op_def, &node_def);
-      }
-      if (opts_.validate_nodes) {
-        TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, *op_def));
-      }
+      TF_RETURN_IF_ERROR(PrepareNodeDef(&node_def));
     }
 
     TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
@@ -1291,7 +1342,9 @@ Status GraphConstructor::Convert() {
                  << " NODES IN A CYCLE";
     for (int64_t i = 0; i < node_def_count(); i++) {
       if (pending_count_[i] != 0) {
-        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(get_node_def(i))
+        LOG(WARNING) << "PENDING: "
+                     << SummarizeNodeDef(prepared ? prepared_node_defs_[i]
+                                                  : get_node_def(i))
                      << " WITH PENDING COUNT = " << pending_count_[i];
       }
     }
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/version.h"
 
@@ -923,6 +924,54 @@ TEST_F(GraphConstructorTest, Error_ControlEdgeBeforeRealInput) {
       {"Node 't2': Control dependencies must come after regular dependencies"});
 }
 
+TEST_F(GraphConstructorTest, ConvertInParallel) {
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  GraphDef gdef;
+  CHECK(protobuf::TextFormat::ParseFromString(
+      "node { name: 'W1' op: 'TestParams' }"
+      "node { name: 'input' op: 'TestInput' input: [ '^W1' ] }"
+      "node { name: 't1' op: 'TestMul' input: [ 'W1', 'input:1' ] }"
+      "node { name: 'next' op: 'NextIteration' input: [ 'merge' ]"
+      "       attr { key: 'T' value { type: DT_FLOAT } } }"
+      "node { name: 'merge' op: 'Merge' input: [ 't1', 'next' ]"
+      "       attr { key: 'N' value { i: 2 } }"
+      "       attr { key: 'T' value { type: DT_FLOAT } } }"
+      "node { name: 'default' op: 'TestDefaultAttr' }",
+      &gdef));
+  GraphConstructorOptions opts;
+  opts.validate_nodes = true;
+  opts.thread_pool = &pool;
+  TF_EXPECT_OK(ConvertGraphDefToGraph(opts, gdef, &graph_));
+  EXPECT_TRUE(HasEdge("W1", 0, "t1", 0));
+  EXPECT_TRUE(HasEdge("input", 1, "t1", 1));
+  EXPECT_TRUE(HasControlEdge("W1", "input"));
+  EXPECT_TRUE(HasEdge("t1", 0, "merge", 0));
+  EXPECT_TRUE(HasEdge("next", 0, "merge", 1));
+  int32 default_int;
+  TF_EXPECT_OK(
+      GetNodeAttr(FindNode("default")->attrs(), "default_int", &default_int));
+  EXPECT_EQ(31415, default_int);
+}
+
+TEST_F(GraphConstructorTest, ConvertInParallelReportsInvalidNode) {
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  const string original_graph_description = GraphDebugString();
+  GraphDef gdef;
+  CHECK(protobuf::TextFormat::ParseFromString(
+      "node { name: 'W1' op: 'TestParams' }"
+      "node { name: 'input' op: 'TestInput' }"
+      "node { name: 't1' op: 'TestMul' input: [ 'W1', 'input:1' ]"
+      "       attr { key: 'unknown' value { i: 1 } } }",
+      &gdef));
+  GraphConstructorOptions opts;
+  opts.validate_nodes = true;
+  opts.thread_pool = &pool;
+  Status s = ConvertGraphDefToGraph(opts, std::move(gdef), &graph_);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(s.error_message().find("unknown") != string::npos) << s;
+  EXPECT_EQ(original_graph_description, GraphDebugString());
+}
+
 TEST_F(GraphConstructorTest, ImportGraphDef) {
   GraphDef def;
   ImportGraphDefOptions opts;
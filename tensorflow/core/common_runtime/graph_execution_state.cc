@@ -22,6 +22,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_join.h"
@@ -57,6 +58,8 @@ limitations under the License.
 
 #ifndef IS_MOBILE_PLATFORM
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/profiled_op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 #endif  // IS_MOBILE_PLATFORM
@@ -498,6 +501,44 @@ Status GetFeedShapeAndTypeFromAttribute(const NodeDef& node,
   return OkStatus();
 }
 
+// Returns the exact shapes of the feeds produced by the first output of a node,
+// keyed by node name.
+absl::flat_hash_map<string, TensorShape> GetFeedShapesByNode(
+    const BuildGraphOptions& options) {
+  absl::flat_hash_map<string, TensorShape> feed_shapes;
+  for (const auto& it : options.feed_shapes) {
+    const SafeTensorId feed = ParseTensorName(it.first);
+    if (feed.index() == 0) feed_shapes.emplace(feed.node(), it.second);
+  }
+  return feed_shapes;
+}
+
+// Pins the shapes of the fed placeholders of a shape-specialized graph, so that
+// shape inference in the optimizers propagates them. The placeholders are
+// replaced by the feed rewrites after optimization.
+void SpecializeFeedShapes(
+    const absl::flat_hash_map<string, TensorShape>& feed_shapes,
+    GraphDef* graph_def) {
+  if (feed_shapes.empty()) return;
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    if (node.op() != "Placeholder" && node.op() != "PlaceholderV2" &&
+        node.op() != "PlaceholderWithDefault") {
+      continue;
+    }
+    auto it = feed_shapes.find(node.name());
+    if (it == feed_shapes.end()) continue;
+    PartialTensorShape declared_shape;
+    if (!TryGetNodeAttr(node, "shape", &declared_shape) ||
+        !declared_shape.IsCompatibleWith(it->second)) {
+      continue;
+    }
+    it->second.AsProto((*node.mutable_attr())["shape"].mutable_shape());
+    node.mutable_attr()->erase("_output_shapes");
+    VLOG(2) << "Specialized the shape of feed " << node.name() << " to "
+            << it->second.DebugString();
+  }
+}
+
 }  // namespace
 
 Status GraphExecutionState::PruneGraph(
@@ -682,6 +723,8 @@ Status GraphExecutionState::OptimizeGraph(
     }
 
     // Add feeds to the GrapplerItem if we know them.
+    const absl::flat_hash_map<string, TensorShape> feed_shapes =
+        GetFeedShapesByNode(options);
     absl::flat_hash_set<absl::string_view> node_names;
     if (!(options.callable_options.feed().empty() &&
           options.callable_options.tensor_connection().empty())) {
@@ -756,6 +799,14 @@ Status GraphExecutionState::OptimizeGraph(
           }
         }
 
+        // Graphs specialized for the shapes of the fed tensors are optimized
+        // using those shapes.
+        auto exact_shape = feed_shapes.find(node->name());
+        if (exact_shape != feed_shapes.end() &&
+            partial_shape.IsCompatibleWith(exact_shape->second)) {
+          shape = exact_shape->second;
+        }
+
         VLOG(3) << "Add feed for: " << node->name() << "; type: " << type
                 << "; shape: " << shape;
         Tensor fake_input(type, shape);
@@ -792,10 +843,26 @@ Status GraphExecutionState::OptimizeGraph(
     if (flib_def) {
       *item.graph.mutable_library() = flib_def->ToProto();
     }
+    SpecializeFeedShapes(feed_shapes, &item.graph);
 
     // Construct a virtual cluster and find the cpu_device, which the
     // ConstantFolding optimizer will use for partial evaluation of the graph.
-    grappler::VirtualCluster cluster(device_set_);
+    // Cost-model-driven optimizers use measured op costs if a profile is
+    // configured.
+    std::unique_ptr<grappler::OpLevelCostEstimator> node_estimator;
+    const string& cost_profile_path = session_options_->config.graph_options()
+                                          .rewrite_options()
+                                          .cost_profile_path();
+    if (!cost_profile_path.empty()) {
+      OpPerformanceList profile;
+      TF_RETURN_IF_ERROR(grappler::ReadOpPerformanceList(
+          Env::Default(), cost_profile_path, &profile));
+      node_estimator =
+          std::make_unique<grappler::ProfiledOpLevelCostEstimator>(profile);
+    } else {
+      node_estimator = std::make_unique<grappler::OpLevelCostEstimator>();
+    }
+    grappler::VirtualCluster cluster(device_set_, std::move(node_estimator));
     Device* cpu_device = nullptr;
     for (const auto& device : device_set_->devices()) {
       if (device->parsed_name().id == 0 &&
@@ -0,0 +1,385 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+// Set true for greater intelligibility of debug mode log messages.
+#define READABLE_KEYS false
+
+namespace tensorflow {
+namespace {
+
+// The phases of the algorithm, used to tell apart the transfers of a chunk.
+enum Phase {
+  kLocalReduceScatter = 0,
+  kRemoteReduceScatter = 1,
+  kRemoteAllGather = 2,
+  kLocalAllGather = 3,
+};
+
+// Key to be used for BufRendezvous by HierarchicalRingReducer.
+string HierarchicalRingBufKey(const string& exec_key, int phase, int chunk,
+                              int src_idx) {
+  if (READABLE_KEYS) {
+    return strings::StrCat("hierarchical_ring_reduce(", exec_key, "):phase(",
+                           phase, "):chunk(", chunk, "):src(", src_idx, ")");
+  } else {
+    return strings::StrCat(exec_key, ":", phase, ":", chunk, ":", src_idx);
+  }
+}
+
+}  // namespace
+
+HierarchicalRingReducer::HierarchicalRingReducer()
+    : col_ctx_(nullptr), col_params_(nullptr), done_(nullptr) {}
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  CHECK_EQ(col_params->instance.impl_details.collective_name,
+           "HierarchicalRingReduce");
+  const CollGroupParams& group = col_params->group;
+  if (group.num_tasks <= 0 || group.group_size % group.num_tasks != 0) {
+    return errors::InvalidArgument(
+        "HierarchicalRingReduce requires the same number of devices in every "
+        "task, but got ",
+        group.group_size, " devices in ", group.num_tasks, " tasks");
+  }
+  // Precondition: members are sorted so that all devices in the same task are
+  // adjacent.
+  const int local_size = group.group_size / group.num_tasks;
+  for (int di = 0; di < group.group_size; ++di) {
+    if (group.members[di].task != group.members[di - di % local_size].task) {
+      return errors::InvalidArgument(
+          "HierarchicalRingReduce requires the same number of devices in "
+          "every task, but task ",
+          group.members[di].task, " has a different number of devices");
+    }
+  }
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this doesn't require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+  done_ = std::move(done);
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  Status s;
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    // We are running in a blockable thread and the callback can't block so
+    // just wait here on the copy.
+    Notification note;
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &s](const Status& status) {
+          s.Update(status);
+          note.Notify();
+        });
+    note.WaitForNotification();
+  }
+  if (s.ok()) {
+    s = RunAllReduce();
+  }
+  chunks_.clear();
+  tmp_chunks_.clear();
+  if (s.ok()) {
+    // Recover the output from the adaptor.
+    ca_->ConsumeFinalValue(col_ctx_->output);
+  }
+  ca_.reset();
+  VLOG(2) << "device=" << col_ctx_->device_name << " return status " << s;
+  done_(s);
+}
+
+Status HierarchicalRingReducer::RunAllReduce() {
+  const int group_size = col_params_->group.group_size;
+  const int num_tasks = col_params_->group.num_tasks;
+  const int local_size = group_size / num_tasks;
+  const int my_idx = col_params_->default_rank;
+  const int task_idx = my_idx / local_size;
+  const int local_rank = my_idx % local_size;
+
+  // Shard s consists of the chunks [s * num_tasks, (s + 1) * num_tasks).
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output, group_size,
+                                  col_ctx_->device->GetAllocator(attr)));
+  chunks_.resize(group_size);
+  tmp_chunks_.resize(group_size);
+  for (int c = 0; c < group_size; ++c) {
+    if (ca_->ChunkBytes(c) > 0) {
+      chunks_[c] = ca_->ChunkAlias(c);
+      tmp_chunks_[c] = ca_->TempChunk(c);
+    }
+  }
+  if (col_params_->final_op) {
+    TF_RETURN_IF_ERROR(InitGroupSizeTensor());
+  }
+  TF_RETURN_IF_ERROR(WaitForQueuedEvents());
+
+  std::vector<int> local_ring(local_size);
+  std::vector<std::vector<int>> shards(local_size);
+  for (int r = 0; r < local_size; ++r) {
+    local_ring[r] = task_idx * local_size + r;
+    for (int t = 0; t < num_tasks; ++t) {
+      shards[r].push_back(r * num_tasks + t);
+    }
+  }
+  std::vector<int> remote_ring(num_tasks);
+  std::vector<std::vector<int>> shard_chunks(num_tasks);
+  for (int t = 0; t < num_tasks; ++t) {
+    remote_ring[t] = t * local_size + local_rank;
+    shard_chunks[t].push_back(local_rank * num_tasks + t);
+  }
+
+  {
+    profiler::TraceMe activity("LocalReduceScatter",
+                               profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(RingReduceScatter(kLocalReduceScatter, local_ring,
+                                         local_rank, shards));
+  }
+  {
+    profiler::TraceMe activity("RemoteAllReduce",
+                               profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(RingReduceScatter(kRemoteReduceScatter, remote_ring,
+                                         task_idx, shard_chunks));
+    // This device now holds the final value of exactly one chunk.
+    const int owned_chunk = local_rank * num_tasks + task_idx;
+    if (col_params_->final_op && ca_->ChunkBytes(owned_chunk) > 0) {
+      Status s = collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->final_op, &chunks_[owned_chunk], &group_size_tensor_);
+      if (!s.ok()) {
+        StartAbort(s);
+        return s;
+      }
+    }
+    TF_RETURN_IF_ERROR(
+        RingAllGather(kRemoteAllGather, remote_ring, task_idx, shard_chunks));
+  }
+  {
+    profiler::TraceMe activity("LocalAllGather",
+                               profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(
+        RingAllGather(kLocalAllGather, local_ring, local_rank, shards));
+  }
+  VLOG(2) << this << " device=" << col_ctx_->device_name << " finish;"
+          << " final value " << ca_->DebugString();
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::RingReduceScatter(
+    int phase, const std::vector<int>& ring, int rank,
+    const std::vector<std::vector<int>>& segments) {
+  const int n = ring.size();
+  // In step k, forward the segment reduced in the previous step and reduce
+  // the segment received from the preceding device.  After n-1 steps the
+  // last segment received is segments[rank].
+  for (int k = 0; k < n - 1; ++k) {
+    const int send_seg = (rank - k - 1 + 2 * n) % n;
+    const int recv_seg = (rank - k - 2 + 2 * n) % n;
+    TF_RETURN_IF_ERROR(RingStep(phase, ring[(rank + 1) % n], segments[send_seg],
+                                ring[(rank + n - 1) % n], segments[recv_seg],
+                                /*reduce=*/true));
+  }
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::RingAllGather(
+    int phase, const std::vector<int>& ring, int rank,
+    const std::vector<std::vector<int>>& segments) {
+  const int n = ring.size();
+  // In step k, forward the segment received in the previous step, starting
+  // with the segment owned by this device.
+  for (int k = 0; k < n - 1; ++k) {
+    const int send_seg = (rank - k + n) % n;
+    const int recv_seg = (rank - k - 1 + n) % n;
+    TF_RETURN_IF_ERROR(RingStep(phase, ring[(rank + 1) % n], segments[send_seg],
+                                ring[(rank + n - 1) % n], segments[recv_seg],
+                                /*reduce=*/false));
+  }
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::RingStep(int phase, int send_to,
+                                         const std::vector<int>& send_chunks,
+                                         int recv_from,
+                                         const std::vector<int>& recv_chunks,
+                                         bool reduce) {
+  const CollGroupMember& send_member = col_params_->group.members[send_to];
+  const CollGroupMember& recv_member = col_params_->group.members[recv_from];
+  mutex mu;
+  condition_variable all_done;
+  int pending_count = 0;
+  Status status;
+  auto done = [&mu, &all_done, &pending_count, &status](const Status& s) {
+    mutex_lock l(mu);
+    status.Update(s);
+    if (--pending_count == 0) {
+      all_done.notify_all();
+    }
+  };
+  // Account for all transfers up front, so that the callbacks of the early
+  // ones cannot observe a zero count.
+  {
+    mutex_lock l(mu);
+    for (int c : send_chunks) {
+      if (ca_->ChunkBytes(c) > 0) ++pending_count;
+    }
+    for (int c : recv_chunks) {
+      if (ca_->ChunkBytes(c) > 0) ++pending_count;
+    }
+  }
+  for (int c : send_chunks) {
+    if (ca_->ChunkBytes(c) == 0) continue;
+    col_ctx_->col_exec->remote_access()->PostToPeer(
+        send_member.device.name(), send_member.task,
+        HierarchicalRingBufKey(col_ctx_->exec_key, phase, c,
+                               col_params_->default_rank),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), &chunks_[c],
+        col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+        done);
+  }
+  for (int c : recv_chunks) {
+    if (ca_->ChunkBytes(c) == 0) continue;
+    col_ctx_->col_exec->remote_access()->RecvFromPeer(
+        recv_member.device.name(), recv_member.task, recv_member.is_local,
+        HierarchicalRingBufKey(col_ctx_->exec_key, phase, c, recv_from),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0),
+        reduce ? &tmp_chunks_[c] : &chunks_[c], col_ctx_->device_locality,
+        0 /*dev_to_dev_stream_index*/, col_ctx_->op_ctx->cancellation_manager(),
+        done);
+  }
+  {
+    mutex_lock l(mu);
+    while (pending_count > 0) {
+      all_done.wait(l);
+    }
+  }
+  if (!status.ok()) {
+    StartAbort(status);
+    return status;
+  }
+  if (reduce) {
+    for (int c : recv_chunks) {
+      if (ca_->ChunkBytes(c) == 0) continue;
+      Status s = collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, &chunks_[c], &tmp_chunks_[c]);
+      if (!s.ok()) {
+        StartAbort(s);
+        return s;
+      }
+    }
+  }
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::InitGroupSizeTensor() {
+  Tensor group_size_val = ca_->Scalar(col_params_->group.group_size);
+  if (col_params_->group.device_type == "CPU") {
+    group_size_tensor_ = group_size_val;
+    return OkStatus();
+  }
+  group_size_tensor_ = ca_->Scalar(
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+      AllocationAttributes());
+  Notification note;
+  Status status;
+  col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+      &group_size_val, col_ctx_->device, &group_size_tensor_,
+      [&note, &status](const Status& s) {
+        status = s;
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+Status HierarchicalRingReducer::WaitForQueuedEvents() {
+  const DeviceBase::AcceleratorDeviceInfo* gpu_info =
+      col_ctx_->device->tensorflow_accelerator_device_info();
+  if (gpu_info == nullptr) {
+    return OkStatus();
+  }
+  // The temp chunks allocated above are not guaranteed to be valid (e.g. for
+  // RDMA write) until the events currently queued on the compute stream have
+  // completed.
+  profiler::TraceMe activity("WaitForQueuedEvents",
+                             profiler::TraceMeLevel::kInfo);
+  Notification note;
+  Status s = gpu_info->default_context->ThenExecute(
+      col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); });
+  if (!s.ok()) {
+    return errors::Internal(
+        "Failed to dispatch ThenExecute in HierarchicalRingReducer");
+  }
+  note.WaitForNotification();
+  return OkStatus();
+}
+
+void HierarchicalRingReducer::StartAbort(const Status& s) {
+  // If this is not a cancellation, abort the CollectiveExecutor so that the
+  // other devices of the group do not wait for this one forever.
+  CancellationManager* cancel_mgr = col_ctx_->op_ctx->cancellation_manager();
+  if (cancel_mgr == nullptr ||
+      (!cancel_mgr->IsCancelled() && !cancel_mgr->IsCancelling())) {
+    col_ctx_->col_exec->StartAbort(s);
+  }
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,98 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Hierarchical ring-algorithm implementation of collective all-reduce, for
+// groups whose tasks all have the same number of devices.
+//
+// With L devices per task and T tasks the tensor is split into L shards of T
+// chunks each. The reduction then runs in three phases:
+//  1. A ring reduce-scatter among the devices of each task, after which the
+//     device with local rank r holds the task-wide sum of shard r.
+//  2. A ring all-reduce of shard r among the devices with local rank r of all
+//     tasks.
+//  3. A ring all-gather of the shards among the devices of each task.
+// Only phase 2 crosses task boundaries, and it moves 1/L of the data that a
+// flat ring over all devices would send to other tasks.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer();
+  ~HierarchicalRingReducer() override = default;
+
+  // Checks that every task of the group has the same number of devices.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Begins async execution of the hierarchical all-reduce.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Runs the three phases of the all-reduce on the output tensor.
+  Status RunAllReduce();
+
+  // Runs a ring reduce-scatter in which the device at `rank` of `ring` ends up
+  // holding the reduced value of `segments[rank]`. `ring` holds the group
+  // member indices of the devices and each segment is a list of chunks.
+  Status RingReduceScatter(int phase, const std::vector<int>& ring, int rank,
+                           const std::vector<std::vector<int>>& segments);
+
+  // Runs a ring all-gather in which the device at `rank` of `ring` starts out
+  // holding `segments[rank]` and ends up holding all segments.
+  Status RingAllGather(int phase, const std::vector<int>& ring, int rank,
+                       const std::vector<std::vector<int>>& segments);
+
+  // Concurrently sends the chunks `send_chunks` to group member `send_to` and
+  // receives the chunks `recv_chunks` from group member `recv_from`, then
+  // merges the received values into the local ones if `reduce` is true.
+  // Blocks until all transfers have completed.
+  Status RingStep(int phase, int send_to, const std::vector<int>& send_chunks,
+                  int recv_from, const std::vector<int>& recv_chunks,
+                  bool reduce);
+
+  // Creates the on-device scalar holding the group size for `final_op`.
+  Status InitGroupSizeTensor();
+
+  // Blocks until the allocations enqueued so far on the device are usable
+  // by other devices.
+  Status WaitForQueuedEvents();
+
+  // Aborts the collective executor unless the op is being cancelled.
+  void StartAbort(const Status& s);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  StatusCallback done_;
+  std::unique_ptr<CollectiveAdapter> ca_;
+  std::vector<Tensor> chunks_;
+  std::vector<Tensor> tmp_chunks_;
+  Tensor group_size_tensor_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
@@ -0,0 +1,166 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetKernel(const string& op, DataType dtype,
+                                    const DeviceType& device_type,
+                                    DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder("node", op);
+  TF_CHECK_OK(builder.Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalRingReducerTest : public ::testing::Test {
+ protected:
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, DataType dtype, const TensorShape& shape,
+                   CollectiveTestEnv* test_env)
+        : test_env_(test_env), tensor_(dtype, shape) {
+      col_params_ =
+          CreateCollectiveParams(*test_env_, rank, "HierarchicalRingReduce",
+                                 REDUCTION_COLLECTIVE, dtype, shape);
+      string dev_name = col_params_->group.members[rank].device.name();
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(dev_name, &device_))
+          << "Couldn't find device " << dev_name
+          << " existing devices: " << test_env_->device_mgr->DebugString();
+      merge_op_ = GetKernel("Add", dtype, test_env_->device_type, device_);
+      final_op_ = GetKernel("Div", dtype, test_env_->device_type, device_);
+      col_params_->merge_op = merge_op_.get();
+      col_params_->final_op = final_op_.get();
+    }
+
+    void DoReduce() {
+      status_ = RunCollective(test_env_, col_params_.get(), device_, &tensor_,
+                              &tensor_);
+    }
+
+    CollectiveTestEnv* test_env_;
+    Tensor tensor_;
+    Device* device_;
+    core::RefCountPtr<CollectiveParams> col_params_;
+    std::unique_ptr<OpKernel> merge_op_;
+    std::unique_ptr<OpKernel> final_op_;
+    Status status_;
+  };
+
+  void Init(int num_workers, int num_devices, DataType dtype,
+            const TensorShape& shape) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    for (int rank = 0; rank < num_workers * num_devices; ++rank) {
+      instances_.push_back(std::make_unique<DeviceInstance>(
+          rank, dtype, shape, test_env_.get()));
+    }
+  }
+
+  void Reduce() {
+    std::atomic<int> done(0);
+    for (auto& di : instances_) {
+      SchedClosure([&di, &done] {
+        di->DoReduce();
+        ++done;
+      });
+    }
+    while (done < static_cast<int>(instances_.size())) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+  }
+
+  template <typename T>
+  void RunTest(DataType dtype, int num_workers, int num_devices,
+               int tensor_len) {
+    Init(num_workers, num_devices, dtype, TensorShape({tensor_len}));
+    std::vector<T> expected(tensor_len);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      Tensor* t = &instances_[di]->tensor_;
+      for (int i = 0; i < tensor_len; ++i) {
+        T value = static_cast<T>(di * 10 + i);
+        t->flat<T>()(i) = value;
+        expected[i] += value;
+      }
+    }
+    Reduce();
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] /= static_cast<T>(num_workers * num_devices);
+    }
+    for (auto& di : instances_) {
+      TF_EXPECT_OK(di->status_);
+      test::ExpectTensorEqual<T>(test::AsTensor<T>(expected), di->tensor_);
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceInstance>> instances_;
+};
+
+#define DEF_TEST(B, T, W, D, L)                                                \
+  TEST_F(HierarchicalRingReducerTest, DaTy##B##_Wkr##W##_Dev##D##_Len##L) {    \
+    RunTest<T>(DT_##B, W, D, L);                                               \
+  }
+
+DEF_TEST(FLOAT, float, 1, 2, 1)
+DEF_TEST(FLOAT, float, 1, 2, 1001)
+DEF_TEST(FLOAT, float, 2, 1, 17)
+DEF_TEST(FLOAT, float, 2, 4, 1)
+DEF_TEST(FLOAT, float, 2, 4, 17)
+DEF_TEST(FLOAT, float, 2, 4, 1001)
+DEF_TEST(FLOAT, float, 3, 2, 1001)
+DEF_TEST(FLOAT, float, 4, 1, 1001)
+DEF_TEST(DOUBLE, double, 2, 4, 1001)
+DEF_TEST(INT64, int64_t, 3, 2, 1001)
+
+TEST_F(HierarchicalRingReducerTest, UnequalDevicesPerTaskFails) {
+  Init(2, 2, DT_FLOAT, TensorShape({8}));
+  CollectiveParams* cp = instances_[0]->col_params_.get();
+  // Move the last device of the first task to the second task.
+  cp->group.members[1].task = cp->group.members[2].task;
+  HierarchicalRingReducer reducer;
+  Status s = reducer.InitializeCollectiveParams(cp);
+  EXPECT_EQ(s.code(), error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -17,12 +17,14 @@ limitations under the License.
 
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/local_device.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/op_segment.h"
@@ -169,6 +171,7 @@ void Benchmark::RunWithRendezvousArgs(
   Executor::Args args;
   args.rendezvous = rendez_;
   args.runner = [this](std::function<void()> closure) {
+    num_scheduled_closures_.fetch_add(1, std::memory_order_relaxed);
     pool_->Schedule(closure);
   };
   static const int kWarmupRuns = 3;
@@ -188,6 +191,10 @@ void Benchmark::RunWithRendezvousArgs(
   TF_CHECK_OK(device_->Sync());
   VLOG(3) << kWarmupRuns << " warmup runs done.";
 
+  Allocator* allocator = device_->GetAllocator(AllocatorAttributes());
+  const absl::optional<AllocatorStats> start_stats = allocator->GetStats();
+  num_scheduled_closures_ = 0;
+
   // Benchmark loop. Timer starts automatically at the beginning of the loop
   // and ends automatically after the last iteration.
   for (auto s : state) {
@@ -204,6 +211,17 @@ void Benchmark::RunWithRendezvousArgs(
     }
   }
   TF_CHECK_OK(device_->Sync());
+
+  // Closures handed off to the thread pool by the executor, and allocations
+  // when the allocator of the device collects stats.
+  state.counters["closures_per_step"] = benchmark::Counter(
+      num_scheduled_closures_, benchmark::Counter::kAvgIterations);
+  const absl::optional<AllocatorStats> end_stats = allocator->GetStats();
+  if (start_stats && end_stats) {
+    state.counters["allocations_per_step"] =
+        benchmark::Counter(end_stats->num_allocs - start_stats->num_allocs,
+                           benchmark::Counter::kAvgIterations);
+  }
 }
 
 }  // end namespace test
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_BENCHMARK_TESTLIB_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_BENCHMARK_TESTLIB_H_
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -73,6 +74,9 @@ class Benchmark {
   FunctionLibraryRuntime* flr_;  // Not owned.
   std::unique_ptr<Executor> exec_;
 
+  // Number of closures passed to the runner by the executor.
+  std::atomic<int64_t> num_scheduled_closures_{0};
+
   TF_DISALLOW_COPY_AND_ASSIGN(Benchmark);
 };
 
@@ -148,10 +148,17 @@ LocalDevice::LocalDevice(const SessionOptions& options,
     }
   } else {
     // Each LocalDevice owns a separate ThreadPoolDevice for numerical
-    // computations.
-    // TODO(tucker): NUMA for these too?
+    // computations. With NUMA affinity its threads are pinned to the node of
+    // the device, so that work stealing between them stays on that node.
+    int numa_node = port::kNUMANoAffinity;
+    Allocator* numa_allocator = nullptr;
+    if (options.config.experimental().use_numa_affinity()) {
+      numa_node = attributes.locality().numa_node();
+      DCHECK_LT(numa_node, port::NUMANumNodes());
+      numa_allocator = ProcessState::singleton()->GetCPUAllocator(numa_node);
+    }
     owned_tp_info_.reset(new LocalDevice::EigenThreadPoolInfo(
-        options, port::kNUMANoAffinity, nullptr));
+        options, numa_node, numa_allocator));
     tp_info = owned_tp_info_.get();
   }
   set_tensorflow_cpu_worker_threads(&tp_info->eigen_worker_threads_);
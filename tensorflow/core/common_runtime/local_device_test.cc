@@ -0,0 +1,75 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/local_device.h"
+
+#include <stdlib.h>
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+class LocalDeviceTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    // Every device owns its thread pool. This is read when the first device
+    // of the process is created.
+    setenv("TF_OVERRIDE_GLOBAL_THREADPOOL", "1", 1);
+  }
+
+  static std::unique_ptr<ThreadPoolDevice> CreateDevice(
+      const SessionOptions& options) {
+    DeviceLocality locality;
+    locality.set_numa_node(0);
+    return std::make_unique<ThreadPoolDevice>(
+        options, "/device:CPU:0", Bytes(256), locality, cpu_allocator());
+  }
+
+  static void ExpectThreadPoolRuns(Device* device) {
+    const DeviceBase::CpuWorkerThreads* threads =
+        device->tensorflow_cpu_worker_threads();
+    ASSERT_NE(threads, nullptr);
+    BlockingCounter counter(4);
+    for (int i = 0; i < 4; ++i) {
+      threads->workers->Schedule([&counter]() { counter.DecrementCount(); });
+    }
+    counter.Wait();
+  }
+};
+
+TEST_F(LocalDeviceTest, OwnedThreadPoolWithNumaAffinity) {
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  std::unique_ptr<ThreadPoolDevice> device = CreateDevice(options);
+  // The Eigen device of the pool allocates from the NUMA node of the device.
+  EXPECT_NE(device->eigen_cpu_device()->allocator(), nullptr);
+  ExpectThreadPoolRuns(device.get());
+}
+
+TEST_F(LocalDeviceTest, OwnedThreadPoolWithoutNumaAffinity) {
+  std::unique_ptr<ThreadPoolDevice> device = CreateDevice(SessionOptions());
+  EXPECT_EQ(device->eigen_cpu_device()->allocator(), nullptr);
+  ExpectThreadPoolRuns(device.get());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/lower_while_op.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_split.h"
 #include "tensorflow/core/common_runtime/inline_function_utils.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph.h"
@@ -60,6 +63,12 @@ constexpr const char* const kLowerAsMultiDeviceFunctionAttr =
 //      |
 //      V
 //   consumer
+//
+// So are loop invariant tensors, which body_func returns unchanged. Feeding
+// them to every iteration by a constant Enter node saves the Merge, Switch and
+// NextIteration nodes each iteration would otherwise run for them, and lets
+// the ops of an iteration that only depend on them start without waiting for
+// the previous iteration.
 class LowerWhileHelper {
  public:
   static Status Run(Node* while_op, const NameAttrList& cond_fn,
@@ -82,6 +91,10 @@ class LowerWhileHelper {
 
   Status RunInternal();
 
+  // Finds the loop variables that `body_fn` returns unchanged and sets them in
+  // `is_loop_invariant_`.
+  void FindLoopInvariants(const NameAttrList& body_fn);
+
   void InitializeInputOutputToLoweredNodeMap();
 
   // Creates an Enter node for each `while_op_` input and adds them to
@@ -131,6 +144,11 @@ class LowerWhileHelper {
   // Returns whether the While op's input/output at `index` is a `DT_RESOURCE`.
   bool IsResource(int index);
 
+  // Returns whether the While op's input/output at `index` is fed to every
+  // iteration by a constant Enter node, because it is a `DT_RESOURCE` or loop
+  // invariant.
+  bool IsLoopConstant(int index);
+
   // The original While op.
   Node* while_op_;
   // The call node for the cond branch.
@@ -170,10 +188,15 @@ class LowerWhileHelper {
   std::vector<Node*> next_iterations_nodes_;
   // Maps from the loop input/output indices to their corresponding
   // Merge/Switch/NextIteration/Exit node indices. For inputs/outputs of
-  // `DT_RESOURCE` type there are no Merge/Switch/NextIteration/Exit nodes
-  // in which case the mapping contains -1.
+  // `DT_RESOURCE` type and loop invariants there are no
+  // Merge/Switch/NextIteration/Exit nodes in which case the mapping contains
+  // -1.
   std::vector<int> op_input_output_to_lowered_node_;
 
+  // Whether the loop input/output at each index is returned unchanged by the
+  // body function.
+  std::vector<bool> is_loop_invariant_;
+
   size_t num_loop_inputs_;
 };
 
@@ -210,6 +233,53 @@ LowerWhileHelper::LowerWhileHelper(Node* while_op, const NameAttrList& cond_fn,
   exit_nodes_.reserve(num_loop_inputs_);
   next_iterations_nodes_.reserve(num_loop_inputs_);
   op_input_output_to_lowered_node_.resize(num_loop_inputs_, -1);
+  is_loop_invariant_.resize(num_loop_inputs_, false);
+  FindLoopInvariants(body_fn);
+}
+
+void LowerWhileHelper::FindLoopInvariants(const NameAttrList& body_fn) {
+  const FunctionDef* body =
+      flib_def_ != nullptr ? flib_def_->Find(body_fn.name()) : nullptr;
+  if (body == nullptr ||
+      body->signature().input_arg_size() != num_loop_inputs_ ||
+      body->signature().output_arg_size() != num_loop_inputs_) {
+    return;
+  }
+  absl::flat_hash_map<absl::string_view, const NodeDef*> nodes;
+  for (const NodeDef& node : body->node_def()) {
+    nodes[node.name()] = &node;
+  }
+
+  std::vector<bool> is_loop_invariant(num_loop_inputs_, false);
+  bool has_loop_variable = false;
+  for (int i = 0; i < num_loop_inputs_; i++) {
+    if (IsResource(i)) {
+      continue;
+    }
+    auto ret = body->ret().find(body->signature().output_arg(i).name());
+    if (ret == body->ret().end()) {
+      return;
+    }
+    // Follow the chain of Identity nodes, which functions usually return,
+    // from the returned tensor up to its source.
+    absl::string_view tensor = ret->second;
+    while (tensor != body->signature().input_arg(i).name()) {
+      auto node = nodes.find(std::vector<absl::string_view>(
+          absl::StrSplit(tensor, ':'))[0]);
+      if (node == nodes.end() || node->second->op() != "Identity" ||
+          node->second->input_size() != 1) {
+        break;
+      }
+      tensor = node->second->input(0);
+    }
+    is_loop_invariant[i] = tensor == body->signature().input_arg(i).name();
+    has_loop_variable |= !is_loop_invariant[i];
+  }
+  // The lowering needs at least one Merge and Switch node to anchor the
+  // function calls in the loop frame.
+  if (has_loop_variable) {
+    is_loop_invariant_ = std::move(is_loop_invariant);
+  }
 }
 
 Status LowerWhileHelper::RunInternal() {
@@ -229,7 +299,7 @@ Status LowerWhileHelper::RunInternal() {
 void LowerWhileHelper::InitializeInputOutputToLoweredNodeMap() {
   int counter = 0;
   for (int i = 0; i < num_loop_inputs_; i++) {
-    if (!IsResource(i)) {
+    if (!IsLoopConstant(i)) {
       op_input_output_to_lowered_node_[i] = counter++;
     }
   }
@@ -250,7 +320,7 @@ Status LowerWhileHelper::CreateEnterNodes() {
             .Attr("parallel_iterations", parallel_iterations_)
             .Device(edge->src()->requested_device())
             .AssignedDevice(edge->src()->assigned_device_name());
-    if (IsResource(edge->dst_input())) {
+    if (IsLoopConstant(edge->dst_input())) {
       builder.Attr("is_constant", true);
     }
     TF_RETURN_IF_ERROR(builder.Finalize(graph_, &enter_node));
@@ -279,10 +349,11 @@ Status LowerWhileHelper::CreateEnterNodes() {
 }
 
 Status LowerWhileHelper::CreateMergeNodes() {
-  for (Node* enter_node : enter_nodes_) {
-    if (enter_node->output_type(0) == DT_RESOURCE) {
+  for (int i = 0; i < num_loop_inputs_; i++) {
+    if (IsLoopConstant(i)) {
       continue;
     }
+    Node* enter_node = enter_nodes_[i];
     Node* merge_node;
     TF_RETURN_IF_ERROR(
         NodeBuilder(NewName("merge"), "Merge", flib_def_, &debug_info_)
@@ -297,7 +368,7 @@ Status LowerWhileHelper::CreateMergeNodes() {
 
 Status LowerWhileHelper::CreateCondFuncCallNode() {
   for (int i = 0; i < num_loop_inputs_; i++) {
-    if (IsResource(i)) {
+    if (IsLoopConstant(i)) {
       cond_call_builder_.Input(NodeOut(enter_nodes_[i], 0));
     } else {
       cond_call_builder_.Input(
@@ -320,7 +391,7 @@ Status LowerWhileHelper::CreateCondFuncCallNode() {
 
 Status LowerWhileHelper::CreateSwitchNodes() {
   for (int i = 0; i < num_loop_inputs_; i++) {
-    if (IsResource(i)) {
+    if (IsLoopConstant(i)) {
       continue;
     }
     string op_name;
@@ -349,7 +420,7 @@ Status LowerWhileHelper::CreateSwitchNodes() {
 
 Status LowerWhileHelper::CreateBodyFuncCallNode() {
   for (int i = 0; i < num_loop_inputs_; i++) {
-    if (IsResource(i)) {
+    if (IsLoopConstant(i)) {
       body_call_builder_.Input(NodeOut(enter_nodes_[i], 0));
     } else {
       body_call_builder_.Input(
@@ -383,9 +454,10 @@ Status LowerWhileHelper::CreateExitNodes() {
   std::vector<NodeOut> outputs;
   outputs.reserve(num_loop_inputs_);
   for (int i = 0; i < num_loop_inputs_; i++) {
-    if (IsResource(i)) {
+    if (IsLoopConstant(i)) {
       // Note(srbs): A resource output of this While should never be used but we
-      // need this for the IdentityN node below.
+      // need this for the IdentityN node below. A loop invariant output is the
+      // input of the While.
       OutputTensor resource_tensor;
       TF_RETURN_IF_ERROR(enter_nodes_[i]->input_tensor(0, &resource_tensor));
       outputs.emplace_back(resource_tensor);
@@ -443,7 +515,7 @@ Status LowerWhileHelper::CreateExitNodes() {
 Status LowerWhileHelper::CreateNextIterationNodes() {
   for (int i = 0; i < num_loop_inputs_; i++) {
     Node* next_iteration;
-    if (IsResource(i)) {
+    if (IsLoopConstant(i)) {
       continue;
     }
     Node* merge_node = merge_nodes_[op_input_output_to_lowered_node_[i]];
@@ -472,7 +544,7 @@ Status LowerWhileHelper::UpdateConsumers() {
     if (e->IsControlEdge()) {
       graph_->AddControlEdge(lowered_while_executed_, e->dst());
     } else {
-      if (IsResource(e->src_output())) {
+      if (IsLoopConstant(e->src_output())) {
         OutputTensor resource;
         TF_RETURN_IF_ERROR(
             enter_nodes_[e->src_output()]->input_tensor(0, &resource));
@@ -502,6 +574,10 @@ bool LowerWhileHelper::IsResource(int index) {
   return while_op_->input_type(index) == DT_RESOURCE;
 }
 
+bool LowerWhileHelper::IsLoopConstant(int index) {
+  return IsResource(index) || is_loop_invariant_[index];
+}
+
 }  // namespace
 
 Status RewriteWhileNode(Node* n, Graph* g,
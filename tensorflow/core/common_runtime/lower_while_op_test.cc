@@ -512,6 +512,93 @@ TEST(LowerWhileOpTest, MultipleInputs) {
   }
 }
 
+TEST(LowerWhileOpTest, LoopInvariantInput) {
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+
+  // Add test functions for cond and body. The body returns `y` unchanged.
+  FunctionDefLibrary f_lib_proto;
+  *(f_lib_proto.add_function()) = FunctionDefHelper::Create(
+      "XPlusY", {"x: int32", "y: int32"}, {"s: int32", "t: int32"}, {},
+      {{{"s"}, "Add", {"x", "y"}, {{"T", DT_INT32}}},
+       {{"t"}, "Identity", {"y"}, {{"T", DT_INT32}}}},
+      {{"s", "s:z:0"}, {"t", "t:output:0"}});
+  *(f_lib_proto.add_function()) = test::function::XYXLessThanOrEqualToN(8);
+
+  Scope root = Scope::NewRootScope().ExitOnError();
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(f_lib_proto));
+  auto a = ops::Placeholder(root.WithOpName("A"), DT_INT32);
+  auto b = ops::Placeholder(root.WithOpName("B"), DT_INT32);
+  Node* while_node;
+  std::vector<NodeBuilder::NodeOut> inputs(
+      {NodeBuilder::NodeOut(a.node()), NodeBuilder::NodeOut(b.node())});
+  AttrValue cond_func;
+  cond_func.mutable_func()->set_name("XYXLessThanOrEqualToN");
+  AttrValue body_func;
+  body_func.mutable_func()->set_name("XPlusY");
+  TF_ASSERT_OK(
+      NodeBuilder("while", "While", &root.graph()->flib_def())
+          .Input(inputs)
+          .Attr("T", {DT_INT32, DT_INT32})
+          .Attr("cond", cond_func)
+          .Attr("body", body_func)
+          .Attr(LowerFunctionalOpsPass::kLowerUsingSwitchMergeAttr, true)
+          .Finalize(root.graph(), &while_node));
+  TF_ASSERT_OK(root.DoShapeInference(while_node));
+  TF_ASSERT_OK(root.ToGraph(graph.get()));
+
+  TF_ASSERT_OK(Rewrite(&graph));
+
+  int enter_count = 0;
+  int constant_enter_count = 0;
+  int exit_count = 0;
+  int switch_count = 0;
+  int merge_count = 0;
+  int next_iteration_count = 0;
+  for (const auto* op : graph->op_nodes()) {
+    if (op->IsEnter()) {
+      ++enter_count;
+      bool is_constant;
+      TF_ASSERT_OK(GetNodeAttr(op->attrs(), "is_constant", &is_constant));
+      if (is_constant) {
+        ++constant_enter_count;
+      }
+    }
+    if (op->IsExit()) {
+      ++exit_count;
+    }
+    if (op->IsSwitch()) {
+      ++switch_count;
+    }
+    if (op->IsMerge()) {
+      ++merge_count;
+    }
+    if (op->IsNextIteration()) {
+      ++next_iteration_count;
+    }
+    ASSERT_NE(op->type_string(), "While");
+  }
+  // The loop invariant input is fed to every iteration by a constant Enter
+  // node, without Merge, Switch, NextIteration and Exit nodes.
+  ASSERT_EQ(enter_count, 2);
+  ASSERT_EQ(constant_enter_count, 1);
+  ASSERT_EQ(exit_count, 1);
+  ASSERT_EQ(switch_count, 1);
+  ASSERT_EQ(merge_count, 1);
+  ASSERT_EQ(next_iteration_count, 1);
+
+  // Verify execution.
+  ClientSession session(root, SessionOptionsWithInlining());
+  ClientSession::FeedType feeds;
+  feeds.emplace(Output(a.node()), Input::Initializer(1));
+  feeds.emplace(Output(b.node()), Input::Initializer(3));
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(session.Run(
+      feeds, {Output(while_node, 0), Output(while_node, 1)}, &out_tensors));
+  ASSERT_EQ(out_tensors.size(), 2);
+  EXPECT_EQ(out_tensors[0].scalar<int>()(), 10);
+  EXPECT_EQ(out_tensors[1].scalar<int>()(), 3);
+}
+
 TEST(LowerWhileOpTest, DoNotInlineLoweredFunctions) {
   std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
 
@@ -20,6 +20,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/common_runtime/function_body.h"
 #include "tensorflow/core/common_runtime/function_def_utils.h"
@@ -30,6 +31,9 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 
 namespace tensorflow {
@@ -494,4 +498,71 @@ StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraph(
                                     ret_nodes.size()};
 }
 
+std::optional<uint64_t> OptimizeFunctionGraphFingerprint(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
+    const std::vector<CompositeDevice*>& composite_devices,
+    Device* default_device) {
+  if (options.graph_collector != nullptr) {
+    return std::nullopt;
+  }
+  const FunctionLibraryDefinition* lib_def =
+      options.lib_def == nullptr ? input_lib_def : options.lib_def;
+  const FunctionDef* fdef = lib_def->Find(function_name);
+  if (fdef == nullptr) {
+    return std::nullopt;
+  }
+
+  // Only keep the options that affect the optimized graph, so that e.g. the
+  // state handle or the executor type do not prevent reuse.
+  FunctionLibraryRuntime::InstantiateOptions key_options;
+  key_options.target = options.target;
+  key_options.input_devices = options.input_devices;
+  key_options.output_devices = options.output_devices;
+  key_options.input_resource_dtypes_and_shapes =
+      options.input_resource_dtypes_and_shapes;
+  key_options.config_proto = options.config_proto;
+  uint64_t fingerprint = Fingerprint64(strings::StrCat(
+      TF_VERSION_STRING, ";", TF_GRAPH_DEF_VERSION, ";",
+      Canonicalize(function_name, attrs, key_options), ";",
+      options.is_component_function, ";", options.xla_compile_device_type,
+      ";", options.shape_inference_on_tfe_dialect_import, ";",
+      options.optimize_graph_fn != nullptr, ";",
+      default_device != nullptr ? default_device->name() : ""));
+
+  // The function and everything it reaches, in a deterministic order.
+  std::vector<string> function_names =
+      lib_def->ReachableDefinitions(*fdef).ListFunctionNames();
+  function_names.push_back(function_name);
+  std::sort(function_names.begin(), function_names.end());
+  string serialized;
+  for (const string& name : function_names) {
+    const FunctionDef* reachable_fdef = lib_def->Find(name);
+    if (reachable_fdef == nullptr) continue;
+    SerializeToStringDeterministic(*reachable_fdef, &serialized);
+    fingerprint = FingerprintCat64(fingerprint, Fingerprint64(serialized));
+    const string gradient = lib_def->FindGradient(name);
+    if (!gradient.empty()) {
+      fingerprint = FingerprintCat64(fingerprint, Fingerprint64(gradient));
+    }
+  }
+
+  std::vector<string> device_names;
+  for (const Device* device : dev_set.devices()) {
+    device_names.push_back(
+        strings::StrCat(device->name(), ":", device->device_type()));
+  }
+  std::sort(device_names.begin(), device_names.end());
+  for (const CompositeDevice* device : composite_devices) {
+    device_names.push_back(
+        strings::StrCat(device->name(), "=",
+                        absl::StrJoin(*device->underlying_devices(), ",")));
+  }
+  for (const string& name : device_names) {
+    fingerprint = FingerprintCat64(fingerprint, Fingerprint64(name));
+  }
+  return fingerprint;
+}
+
 }  // namespace tensorflow
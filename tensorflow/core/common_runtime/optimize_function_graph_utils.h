@@ -17,7 +17,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZE_FUNCTION_GRAPH_UTILS_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZE_FUNCTION_GRAPH_UTILS_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -60,6 +62,21 @@ StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraph(
     const std::vector<CompositeDevice*>& composite_devices, Device* cpu_device,
     Device* default_device, Env* env);
 
+// Returns a fingerprint of the inputs of OptimizeFunctionGraph() that
+// determine its result: the function and the definitions it reaches, its
+// attrs, the placement-related instantiate options and the devices. Returns
+// nullopt if the result must not be reused, e.g. because the function cannot
+// be found or a graph collector expects to observe the optimization.
+//
+// `options.optimize_graph_fn` cannot be fingerprinted; its behavior is
+// assumed to be determined by `options.config_proto`.
+std::optional<uint64_t> OptimizeFunctionGraphFingerprint(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
+    const std::vector<CompositeDevice*>& composite_devices,
+    Device* default_device);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZE_FUNCTION_GRAPH_UTILS_H_
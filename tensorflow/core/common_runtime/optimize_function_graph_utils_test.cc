@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/optimize_function_graph_utils.h"
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -103,5 +104,45 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphReturnsCorrectResult) {
   EXPECT_THAT(aot_result->ret_types, ElementsAre(DT_STRING));
 }
 
+TEST(OptimizeFunctionGraphTest, FingerprintDependsOnFunctionAndOptions) {
+  FunctionLibraryRuntime::InstantiateOptions opts;
+  opts.is_multi_device_function = true;
+  FunctionDefLibrary proto;
+  *(proto.add_function()) = test::function::FindDevice();
+  auto lib_def =
+      std::make_unique<FunctionLibraryDefinition>(OpRegistry::Global(), proto);
+
+  std::vector<std::unique_ptr<Device>> devices;
+  CreateCpuDeviceList(kDevicePrefix, 2, devices);
+  DeviceSet device_set;
+  for (const auto& device : devices) {
+    device_set.AddDevice(device.get());
+  }
+
+  const std::optional<uint64_t> fingerprint = OptimizeFunctionGraphFingerprint(
+      "FindDevice", {}, opts, device_set, lib_def.get(),
+      /*composite_devices=*/{}, devices[0].get());
+  ASSERT_TRUE(fingerprint.has_value());
+  // Options that do not affect the optimized graph do not change the key.
+  opts.executor_type = "SINGLE_THREADED_EXECUTOR";
+  EXPECT_EQ(OptimizeFunctionGraphFingerprint(
+                "FindDevice", {}, opts, device_set, lib_def.get(),
+                /*composite_devices=*/{}, devices[0].get()),
+            fingerprint);
+  EXPECT_NE(OptimizeFunctionGraphFingerprint(
+                "FindDevice", {}, opts, device_set, lib_def.get(),
+                /*composite_devices=*/{}, devices[1].get()),
+            fingerprint);
+  opts.target = devices[1]->name();
+  EXPECT_NE(OptimizeFunctionGraphFingerprint(
+                "FindDevice", {}, opts, device_set, lib_def.get(),
+                /*composite_devices=*/{}, devices[0].get()),
+            fingerprint);
+  EXPECT_FALSE(OptimizeFunctionGraphFingerprint(
+                   "Missing", {}, opts, device_set, lib_def.get(),
+                   /*composite_devices=*/{}, devices[0].get())
+                   .has_value());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,136 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
+
+#include <utility>
+
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+OptimizedFunctionGraphCache::OptimizedFunctionGraphCache(Env* env,
+                                                         std::string cache_dir,
+                                                         int64_t max_bytes)
+    : env_(env), cache_dir_(std::move(cache_dir)), max_bytes_(max_bytes) {}
+
+/* static */
+OptimizedFunctionGraphCache* OptimizedFunctionGraphCache::Global() {
+  static OptimizedFunctionGraphCache* cache = []() {
+    std::string cache_dir;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_OPTIMIZED_FUNCTION_GRAPH_CACHE_DIR",
+                                     "", &cache_dir));
+    bool enabled;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_OPTIMIZED_FUNCTION_GRAPH_CACHE",
+                                   /*default_val=*/!cache_dir.empty(),
+                                   &enabled));
+    if (!enabled) {
+      return static_cast<OptimizedFunctionGraphCache*>(nullptr);
+    }
+    if (!cache_dir.empty()) {
+      Status s = Env::Default()->RecursivelyCreateDir(cache_dir);
+      if (!s.ok()) {
+        LOG(WARNING) << "Not persisting optimized function graphs in "
+                     << cache_dir << ": " << s;
+        cache_dir.clear();
+      }
+    }
+    return new OptimizedFunctionGraphCache(Env::Default(), cache_dir);
+  }();
+  return cache;
+}
+
+std::string OptimizedFunctionGraphCache::CacheFilename(
+    uint64_t fingerprint) const {
+  return io::JoinPath(cache_dir_,
+                      strings::StrCat(strings::Hex(fingerprint), ".pb"));
+}
+
+std::shared_ptr<const OptimizedFunctionGraph>
+OptimizedFunctionGraphCache::Lookup(uint64_t fingerprint) {
+  {
+    mutex_lock l(mu_);
+    auto it = graphs_.find(fingerprint);
+    if (it != graphs_.end()) {
+      ++num_hits_;
+      return it->second;
+    }
+  }
+  if (!cache_dir_.empty()) {
+    const std::string filename = CacheFilename(fingerprint);
+    if (env_->FileExists(filename).ok()) {
+      auto graph = std::make_shared<OptimizedFunctionGraph>();
+      Status s = ReadBinaryProto(env_, filename, graph.get());
+      if (s.ok()) {
+        mutex_lock l(mu_);
+        ++num_hits_;
+        if (bytes_ < max_bytes_ && graphs_.emplace(fingerprint, graph).second) {
+          bytes_ += graph->ByteSizeLong();
+        }
+        return graph;
+      }
+      LOG(WARNING) << "Ignoring unreadable optimized function graph "
+                   << filename << ": " << s;
+    }
+  }
+  mutex_lock l(mu_);
+  ++num_misses_;
+  return nullptr;
+}
+
+void OptimizedFunctionGraphCache::Insert(uint64_t fingerprint,
+                                         OptimizedFunctionGraph graph) {
+  auto shared_graph =
+      std::make_shared<const OptimizedFunctionGraph>(std::move(graph));
+  if (!cache_dir_.empty()) {
+    // Write to a temporary file first so that concurrent readers, possibly in
+    // other processes, never observe a partially written graph.
+    const std::string filename = CacheFilename(fingerprint);
+    const std::string tmp_filename = strings::StrCat(
+        filename, ".tmp.", env_->NowMicros(), "_", random::New64());
+    Status s = WriteBinaryProto(env_, tmp_filename, *shared_graph);
+    if (s.ok()) {
+      s = env_->RenameFile(tmp_filename, filename);
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to persist optimized function graph "
+                   << filename << ": " << s;
+      env_->DeleteFile(tmp_filename).IgnoreError();
+    }
+  }
+  mutex_lock l(mu_);
+  if (bytes_ >= max_bytes_) {
+    return;
+  }
+  if (graphs_.emplace(fingerprint, shared_graph).second) {
+    bytes_ += shared_graph->ByteSizeLong();
+  }
+}
+
+int64_t OptimizedFunctionGraphCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
+int64_t OptimizedFunctionGraphCache::num_misses() const {
+  mutex_lock l(mu_);
+  return num_misses_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,81 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_FUNCTION_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_FUNCTION_GRAPH_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/optimized_function_graph.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A content-addressed cache of optimized function graphs, keyed by the
+// fingerprint of everything the optimization depends on (see
+// `OptimizeFunctionGraphFingerprint`). Instantiating a function whose graph,
+// devices and options match an earlier instantiation can then skip placement
+// and the graph optimization passes.
+//
+// If a cache directory is given, inserted graphs are also written to
+// `<cache_dir>/<fingerprint>.pb`, and lookups that miss in memory fall back
+// to these files, so that the cache survives restarts of the process.
+//
+// This class is thread-safe.
+class OptimizedFunctionGraphCache {
+ public:
+  OptimizedFunctionGraphCache(Env* env, std::string cache_dir,
+                              int64_t max_bytes = int64_t{1} << 30);
+
+  // Returns the process-wide cache, or nullptr if it is disabled. The cache
+  // is enabled by setting TF_OPTIMIZED_FUNCTION_GRAPH_CACHE=true, or by
+  // setting TF_OPTIMIZED_FUNCTION_GRAPH_CACHE_DIR to a directory in which the
+  // graphs are persisted.
+  static OptimizedFunctionGraphCache* Global();
+
+  // Returns the graph with the given fingerprint, or nullptr if there is none.
+  std::shared_ptr<const OptimizedFunctionGraph> Lookup(uint64_t fingerprint);
+
+  // Adds `graph` under `fingerprint`. Graphs are not added once the cached
+  // graphs use more than `max_bytes` in memory.
+  void Insert(uint64_t fingerprint, OptimizedFunctionGraph graph);
+
+  int64_t num_hits() const;
+  int64_t num_misses() const;
+
+ private:
+  std::string CacheFilename(uint64_t fingerprint) const;
+
+  Env* const env_;
+  const std::string cache_dir_;
+  const int64_t max_bytes_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<uint64_t, std::shared_ptr<const OptimizedFunctionGraph>>
+      graphs_ TF_GUARDED_BY(mu_);
+  int64_t bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_hits_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_misses_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(OptimizedFunctionGraphCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_FUNCTION_GRAPH_CACHE_H_
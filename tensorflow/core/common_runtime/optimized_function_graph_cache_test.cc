@@ -0,0 +1,91 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/optimized_function_graph.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+OptimizedFunctionGraph TestGraph(const std::string& name) {
+  OptimizedFunctionGraph graph;
+  graph.set_name(name);
+  graph.set_num_return_nodes(1);
+  return graph;
+}
+
+std::string TestDir(const std::string& name) {
+  const std::string dir = io::JoinPath(testing::TmpDir(), name);
+  TF_CHECK_OK(Env::Default()->RecursivelyCreateDir(dir));
+  return dir;
+}
+
+TEST(OptimizedFunctionGraphCacheTest, InsertAndLookupInMemory) {
+  OptimizedFunctionGraphCache cache(Env::Default(), /*cache_dir=*/"");
+  EXPECT_EQ(cache.Lookup(1), nullptr);
+  cache.Insert(1, TestGraph("f"));
+  std::shared_ptr<const OptimizedFunctionGraph> graph = cache.Lookup(1);
+  ASSERT_NE(graph, nullptr);
+  EXPECT_EQ(graph->name(), "f");
+  EXPECT_EQ(cache.Lookup(2), nullptr);
+  EXPECT_EQ(cache.num_hits(), 1);
+  EXPECT_EQ(cache.num_misses(), 2);
+}
+
+TEST(OptimizedFunctionGraphCacheTest, PersistsAcrossInstances) {
+  const std::string dir = TestDir("persists");
+  {
+    OptimizedFunctionGraphCache cache(Env::Default(), dir);
+    cache.Insert(42, TestGraph("g"));
+  }
+  OptimizedFunctionGraphCache cache(Env::Default(), dir);
+  std::shared_ptr<const OptimizedFunctionGraph> graph = cache.Lookup(42);
+  ASSERT_NE(graph, nullptr);
+  EXPECT_EQ(graph->name(), "g");
+  EXPECT_EQ(graph->num_return_nodes(), 1);
+  EXPECT_EQ(cache.Lookup(43), nullptr);
+}
+
+TEST(OptimizedFunctionGraphCacheTest, DoesNotKeepGraphsOverMemoryLimit) {
+  OptimizedFunctionGraphCache cache(Env::Default(), /*cache_dir=*/"",
+                                    /*max_bytes=*/0);
+  cache.Insert(1, TestGraph("f"));
+  EXPECT_EQ(cache.Lookup(1), nullptr);
+}
+
+TEST(OptimizedFunctionGraphCacheTest, IgnoresUnreadableFiles) {
+  const std::string dir = TestDir("unreadable");
+  OptimizedFunctionGraphCache cache(Env::Default(), dir);
+  cache.Insert(7, TestGraph("h"));
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+  ASSERT_EQ(children.size(), 1);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(),
+                                 io::JoinPath(dir, children[0]),
+                                 "not a serialized graph"));
+  OptimizedFunctionGraphCache other_cache(Env::Default(), dir);
+  EXPECT_EQ(other_cache.Lookup(7), nullptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
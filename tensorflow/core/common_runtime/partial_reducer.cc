@@ -0,0 +1,384 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/partial_reducer.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+// The member that collects the contributions and distributes the result.
+constexpr int kLeaderRank = 0;
+
+// Key to be used for BufRendezvous by PartialReducer.
+string PartialReduceBufKey(const string& exec_key, const char* kind,
+                           int rank) {
+  return strings::StrCat(exec_key, ":", kind, ":", rank);
+}
+
+// Returns a CancellationManager that is cancelled along with `parent`.
+std::unique_ptr<CancellationManager> NewChildCancellationManager(
+    CancellationManager* parent) {
+  return parent != nullptr ? std::make_unique<CancellationManager>(parent)
+                           : std::make_unique<CancellationManager>();
+}
+
+}  // namespace
+
+PartialReducer::PartialReducer() : col_ctx_(nullptr), col_params_(nullptr) {}
+
+Status PartialReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  CHECK_EQ(col_params->instance.impl_details.collective_name, "PartialReduce");
+  const int min_contributions =
+      col_params->instance.impl_details.min_contributions;
+  if (min_contributions <= 0 ||
+      min_contributions > col_params->group.group_size) {
+    return errors::InvalidArgument(
+        "PartialReduce requires min_contributions in [1, ",
+        col_params->group.group_size, "], but got ", min_contributions);
+  }
+  if (col_params->merge_op != nullptr &&
+      col_params->merge_op->type_string() != "Add") {
+    return errors::InvalidArgument(
+        "PartialReduce requires merge_op Add, but got ",
+        col_params->merge_op->type_string());
+  }
+  if (col_params->final_op != nullptr &&
+      col_params->final_op->type_string() != "Div") {
+    return errors::InvalidArgument(
+        "PartialReduce requires final_op Div, but got ",
+        col_params->final_op->type_string());
+  }
+  return OkStatus();
+}
+
+Status PartialReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void PartialReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+  Status s = col_params_->default_rank == kLeaderRank ? RunLeader()
+                                                      : RunMember();
+  VLOG(2) << "device=" << col_ctx_->device_name << " return status " << s;
+  done(s);
+}
+
+Status PartialReducer::RunLeader() {
+  const int group_size = col_params_->group.group_size;
+  std::vector<Tensor> contributions(group_size);
+  std::vector<bool> arrived(group_size, false);
+  int num_contributions = 0;
+  {
+    profiler::TraceMe activity("CollectContributions",
+                               profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(
+        CollectContributions(&contributions, &arrived, &num_contributions));
+  }
+  VLOG(1) << "PartialReduce " << col_ctx_->exec_key << " uses "
+          << num_contributions << " of " << group_size << " contributions";
+
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    TF_RETURN_IF_ERROR(CopyTensor(col_ctx_->input, col_ctx_->output));
+  }
+  // Reduce in rank order, so that the result does not depend on the order in
+  // which the contributions arrived.
+  for (int r = 0; r < group_size; ++r) {
+    if (!arrived[r]) continue;
+    Status s = collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, col_ctx_->output, &contributions[r]);
+    if (!s.ok()) {
+      StartAbort(s);
+      return s;
+    }
+  }
+  contributions.clear();
+  if (col_params_->final_op) {
+    // Rescale to the contributions that were actually reduced.
+    Allocator* allocator =
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0));
+    std::unique_ptr<CollectiveAdapter> ca(MakeCollectiveAdapter(
+        col_ctx_->output, /*num_chunks=*/1, allocator));
+    Tensor count_val = ca->Scalar(num_contributions);
+    Tensor count = count_val;
+    if (col_params_->group.device_type != "CPU") {
+      count = ca->Scalar(allocator, AllocationAttributes());
+      Notification note;
+      Status status;
+      col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+          &count_val, col_ctx_->device, &count,
+          [&note, &status](const Status& s) {
+            status = s;
+            note.Notify();
+          });
+      note.WaitForNotification();
+      TF_RETURN_IF_ERROR(status);
+    }
+    Status s = collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op, col_ctx_->output, &count);
+    if (!s.ok()) {
+      StartAbort(s);
+      return s;
+    }
+  }
+  return PostResult();
+}
+
+Status PartialReducer::CollectContributions(std::vector<Tensor>* contributions,
+                                            std::vector<bool>* arrived,
+                                            int* num_contributions) {
+  const int group_size = col_params_->group.group_size;
+  const int needed = col_params_->instance.impl_details.min_contributions;
+  CancellationManager* op_cm = col_ctx_->op_ctx->cancellation_manager();
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+
+  mutex mu;
+  condition_variable cv;
+  // The leader's own contribution always counts.
+  int received = 1;
+  int pending = group_size - 1;
+  bool quorum = received >= needed;
+  Status first_error;
+  std::vector<std::unique_ptr<CancellationManager>> cms(group_size);
+  for (int r = 0; r < group_size; ++r) {
+    if (r == kLeaderRank) continue;
+    cms[r] = NewChildCancellationManager(op_cm);
+    (*contributions)[r] =
+        Tensor(col_ctx_->device->GetAllocator(attr), col_ctx_->output->dtype(),
+               col_ctx_->output->shape());
+  }
+  TF_RETURN_IF_ERROR(WaitForQueuedEvents());
+
+  for (int r = 0; r < group_size; ++r) {
+    if (r == kLeaderRank) continue;
+    const CollGroupMember& member = col_params_->group.members[r];
+    col_ctx_->col_exec->remote_access()->RecvFromPeer(
+        member.device.name(), member.task, member.is_local,
+        PartialReduceBufKey(col_ctx_->exec_key, "contribution", r),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(), attr,
+        &(*contributions)[r], col_ctx_->device_locality,
+        0 /*dev_to_dev_stream_index*/, cms[r].get(),
+        [&, r](const Status& s) {
+          mutex_lock l(mu);
+          // Contributions that arrive after the quorum are dropped.
+          if (!quorum) {
+            if (s.ok()) {
+              (*arrived)[r] = true;
+              quorum = ++received >= needed;
+            } else {
+              first_error.Update(s);
+            }
+          }
+          --pending;
+          cv.notify_all();
+        });
+  }
+  {
+    mutex_lock l(mu);
+    while (!quorum && received + pending >= needed) {
+      cv.wait(l);
+    }
+  }
+  // Withdraw the receives of the contributions that are no longer needed.
+  for (auto& cm : cms) {
+    if (cm != nullptr) cm->StartCancel();
+  }
+  Status s;
+  {
+    mutex_lock l(mu);
+    while (pending > 0) {
+      cv.wait(l);
+    }
+    if (quorum) {
+      *num_contributions = received;
+      return OkStatus();
+    }
+    s = errors::Unavailable("PartialReduce received only ", received,
+                            " of the ", needed, " required contributions: ",
+                            first_error.ToString());
+  }
+  StartAbort(s);
+  return s;
+}
+
+Status PartialReducer::PostResult() {
+  // The output may be modified by the consumers of the op as soon as it is
+  // done, so the members receive a copy that lives until they have fetched it.
+  auto result = std::make_shared<Tensor>(
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0)),
+      col_ctx_->output->dtype(), col_ctx_->output->shape());
+  TF_RETURN_IF_ERROR(CopyTensor(col_ctx_->output, result.get()));
+  for (int r = 0; r < col_params_->group.group_size; ++r) {
+    if (r == kLeaderRank) continue;
+    const CollGroupMember& member = col_params_->group.members[r];
+    col_ctx_->col_exec->remote_access()->PostToPeer(
+        member.device.name(), member.task,
+        PartialReduceBufKey(col_ctx_->exec_key, "result", r), col_ctx_->device,
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), result.get(),
+        col_ctx_->device_locality, /*cancellation_manager=*/nullptr,
+        [result, r](const Status& s) {
+          if (!s.ok()) {
+            VLOG(1) << "PartialReduce result was not received by member " << r
+                    << ": " << s;
+          }
+        });
+  }
+  return OkStatus();
+}
+
+Status PartialReducer::RunMember() {
+  const CollGroupMember& leader = col_params_->group.members[kLeaderRank];
+  CancellationManager* op_cm = col_ctx_->op_ctx->cancellation_manager();
+  // The contribution is withdrawn once the result has arrived, whether or not
+  // the leader used it.
+  std::unique_ptr<CancellationManager> contribution_cm =
+      NewChildCancellationManager(op_cm);
+  Notification contribution_done;
+  col_ctx_->col_exec->remote_access()->PostToPeer(
+      leader.device.name(), leader.task,
+      PartialReduceBufKey(col_ctx_->exec_key, "contribution",
+                          col_params_->default_rank),
+      col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->input_alloc_attr(0), col_ctx_->input,
+      col_ctx_->device_locality, contribution_cm.get(),
+      [this, &contribution_done](const Status& s) {
+        if (!s.ok()) {
+          VLOG(1) << "PartialReduce contribution of "
+                  << col_ctx_->device_name << " was dropped: " << s;
+        }
+        contribution_done.Notify();
+      });
+
+  // With in-place computation the result must not overwrite the input while
+  // the leader may still be reading it.
+  const bool in_place =
+      DMAHelper::base(col_ctx_->input) == DMAHelper::base(col_ctx_->output);
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  Tensor result;
+  if (in_place) {
+    result = Tensor(col_ctx_->device->GetAllocator(attr),
+                    col_ctx_->output->dtype(), col_ctx_->output->shape());
+  }
+  Notification result_done;
+  Status status;
+  col_ctx_->col_exec->remote_access()->RecvFromPeer(
+      leader.device.name(), leader.task, leader.is_local,
+      PartialReduceBufKey(col_ctx_->exec_key, "result",
+                          col_params_->default_rank),
+      col_ctx_->device, col_ctx_->op_ctx->op_device_context(), attr,
+      in_place ? &result : col_ctx_->output, col_ctx_->device_locality,
+      0 /*dev_to_dev_stream_index*/, op_cm,
+      [&result_done, &status](const Status& s) {
+        status = s;
+        result_done.Notify();
+      });
+  result_done.WaitForNotification();
+  contribution_cm->StartCancel();
+  contribution_done.WaitForNotification();
+  if (!status.ok()) {
+    StartAbort(status);
+    return status;
+  }
+  if (in_place) {
+    TF_RETURN_IF_ERROR(CopyTensor(&result, col_ctx_->output));
+  }
+  return OkStatus();
+}
+
+Status PartialReducer::WaitForQueuedEvents() {
+  const DeviceBase::AcceleratorDeviceInfo* gpu_info =
+      col_ctx_->device->tensorflow_accelerator_device_info();
+  if (gpu_info == nullptr) {
+    return OkStatus();
+  }
+  // The buffers allocated for the contributions are not guaranteed to be
+  // valid (e.g. for RDMA write) until the events currently queued on the
+  // compute stream have completed.
+  Notification note;
+  Status s = gpu_info->default_context->ThenExecute(
+      col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); });
+  if (!s.ok()) {
+    return errors::Internal("Failed to dispatch ThenExecute in PartialReducer");
+  }
+  note.WaitForNotification();
+  return OkStatus();
+}
+
+Status PartialReducer::CopyTensor(const Tensor* src, Tensor* dst) {
+  Notification note;
+  Status status;
+  profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->op_device_context(), col_ctx_->device, col_ctx_->device,
+      col_ctx_->op_ctx->output_alloc_attr(0),
+      col_ctx_->op_ctx->output_alloc_attr(0), src, dst,
+      0 /*dev_to_dev_stream_index*/, [&note, &status](const Status& s) {
+        status = s;
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+void PartialReducer::StartAbort(const Status& s) {
+  // If this is not a cancellation, abort the CollectiveExecutor so that the
+  // other devices of the group do not wait for this one forever.
+  CancellationManager* cancel_mgr = col_ctx_->op_ctx->cancellation_manager();
+  if (cancel_mgr == nullptr ||
+      (!cancel_mgr->IsCancelled() && !cancel_mgr->IsCancelling())) {
+    col_ctx_->col_exec->StartAbort(s);
+  }
+}
+
+namespace {
+REGISTER_COLLECTIVE(PartialReduce, PartialReducer);
+}  // namespace
+
+}  // namespace tensorflow
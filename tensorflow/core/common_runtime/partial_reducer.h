@@ -0,0 +1,90 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PARTIAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_PARTIAL_REDUCER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Straggler-tolerant all-reduce, for synchronous training with backup
+// workers. The member with rank 0 acts as the leader: every other member
+// sends its contribution to the leader, which waits only for the first
+// `impl_details.min_contributions` of them, counting its own. The remaining
+// receives are cancelled and late contributions are dropped. The leader then
+// reduces the contributions in rank order, divides the sum by the number of
+// contributions instead of the group size, and sends the result to every
+// member, including the ones whose contribution was dropped. All members thus
+// end up with the same value.
+//
+// The wait for contributions is bounded by `impl_details.timeout_seconds`.
+// Only mean reductions, i.e. merge_op Add and final_op Div, are supported.
+class PartialReducer : public CollectiveImplementationInterface {
+ public:
+  PartialReducer();
+  ~PartialReducer() override = default;
+
+  // Checks that the reduction is a mean and that `min_contributions` is
+  // valid for the group.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Begins async execution of the partial all-reduce.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Collects the contributions, reduces them into the output and sends the
+  // result to the other members.
+  Status RunLeader();
+
+  // Sends the input to the leader and receives the result into the output.
+  Status RunMember();
+
+  // Receives the contributions of the other members into `contributions`
+  // until `min_contributions` members, counting the leader, have
+  // contributed. Sets `arrived[r]` for the members whose contribution is used.
+  Status CollectContributions(std::vector<Tensor>* contributions,
+                              std::vector<bool>* arrived,
+                              int* num_contributions);
+
+  // Sends a copy of the output to every other member without waiting for the
+  // members to receive it, so that stragglers cannot hold up the leader.
+  Status PostResult();
+
+  // Blocks until the allocations enqueued so far on the device are usable
+  // by other devices.
+  Status WaitForQueuedEvents();
+
+  // Copies `src` into `dst` on the device and blocks until done.
+  Status CopyTensor(const Tensor* src, Tensor* dst);
+
+  // Aborts the collective executor unless the op is being cancelled.
+  void StartAbort(const Status& s);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_PARTIAL_REDUCER_H_
@@ -0,0 +1,203 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/partial_reducer.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetKernel(const string& op, DataType dtype,
+                                    const DeviceType& device_type,
+                                    DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder("node", op);
+  TF_CHECK_OK(builder.Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class PartialReducerTest : public ::testing::Test {
+ protected:
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, int min_contributions, DataType dtype,
+                   const TensorShape& shape, CollectiveTestEnv* test_env)
+        : test_env_(test_env), tensor_(dtype, shape) {
+      col_params_ = CreateCollectiveParams(*test_env_, rank, "PartialReduce",
+                                           REDUCTION_COLLECTIVE, dtype, shape);
+      col_params_->instance.impl_details.min_contributions = min_contributions;
+      string dev_name = col_params_->group.members[rank].device.name();
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(dev_name, &device_))
+          << "Couldn't find device " << dev_name
+          << " existing devices: " << test_env_->device_mgr->DebugString();
+      merge_op_ = GetKernel("Add", dtype, test_env_->device_type, device_);
+      final_op_ = GetKernel("Div", dtype, test_env_->device_type, device_);
+      col_params_->merge_op = merge_op_.get();
+      col_params_->final_op = final_op_.get();
+    }
+
+    void DoReduce() {
+      status_ = RunCollective(test_env_, col_params_.get(), device_, &tensor_,
+                              &tensor_);
+    }
+
+    CollectiveTestEnv* test_env_;
+    Tensor tensor_;
+    Device* device_;
+    core::RefCountPtr<CollectiveParams> col_params_;
+    std::unique_ptr<OpKernel> merge_op_;
+    std::unique_ptr<OpKernel> final_op_;
+    Status status_;
+  };
+
+  void Init(int num_workers, int num_devices, int min_contributions,
+            DataType dtype, const TensorShape& shape) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    for (int rank = 0; rank < num_workers * num_devices; ++rank) {
+      instances_.push_back(std::make_unique<DeviceInstance>(
+          rank, min_contributions, dtype, shape, test_env_.get()));
+    }
+  }
+
+  // Runs the collective on the first `num_running` instances.
+  void Reduce(int num_running) {
+    std::atomic<int> done(0);
+    for (int i = 0; i < num_running; ++i) {
+      DeviceInstance* di = instances_[i].get();
+      SchedClosure([di, &done] {
+        di->DoReduce();
+        ++done;
+      });
+    }
+    while (done < num_running) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+  }
+
+  template <typename T>
+  void FillInputs(int tensor_len) {
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      Tensor* t = &instances_[di]->tensor_;
+      for (int i = 0; i < tensor_len; ++i) {
+        t->flat<T>()(i) = static_cast<T>(di * 10 + i);
+      }
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceInstance>> instances_;
+};
+
+TEST_F(PartialReducerTest, FullQuorumComputesMean) {
+  const int kNumWorkers = 2;
+  const int kNumDevices = 2;
+  const int kTensorLen = 17;
+  const int group_size = kNumWorkers * kNumDevices;
+  Init(kNumWorkers, kNumDevices, group_size, DT_FLOAT,
+       TensorShape({kTensorLen}));
+  FillInputs<float>(kTensorLen);
+  std::vector<float> expected(kTensorLen);
+  for (int di = 0; di < group_size; ++di) {
+    for (int i = 0; i < kTensorLen; ++i) {
+      expected[i] += instances_[di]->tensor_.flat<float>()(i);
+    }
+  }
+  for (int i = 0; i < kTensorLen; ++i) {
+    expected[i] /= group_size;
+  }
+  Reduce(group_size);
+  for (auto& di : instances_) {
+    TF_EXPECT_OK(di->status_);
+    test::ExpectTensorEqual<float>(test::AsTensor<float>(expected),
+                                   di->tensor_);
+  }
+}
+
+TEST_F(PartialReducerTest, PartialQuorumGivesSameResultEverywhere) {
+  const int kTensorLen = 1001;
+  Init(2, 2, 2, DT_DOUBLE, TensorShape({kTensorLen}));
+  FillInputs<double>(kTensorLen);
+  Reduce(instances_.size());
+  for (auto& di : instances_) {
+    TF_EXPECT_OK(di->status_);
+    test::ExpectTensorEqual<double>(instances_[0]->tensor_, di->tensor_);
+  }
+}
+
+TEST_F(PartialReducerTest, StragglerDoesNotBlockQuorum) {
+  const int kTensorLen = 8;
+  Init(1, 4, 3, DT_FLOAT, TensorShape({kTensorLen}));
+  FillInputs<float>(kTensorLen);
+  // The last member never runs, and the mean of the others is expected.
+  std::vector<float> expected(kTensorLen);
+  for (int di = 0; di < 3; ++di) {
+    for (int i = 0; i < kTensorLen; ++i) {
+      expected[i] += instances_[di]->tensor_.flat<float>()(i) / 3;
+    }
+  }
+  Reduce(3);
+  for (int di = 0; di < 3; ++di) {
+    TF_EXPECT_OK(instances_[di]->status_);
+    test::ExpectTensorNear<float>(test::AsTensor<float>(expected),
+                                  instances_[di]->tensor_, 1e-5);
+  }
+}
+
+TEST_F(PartialReducerTest, InvalidMinContributionsFails) {
+  Init(1, 2, 3, DT_FLOAT, TensorShape({8}));
+  PartialReducer reducer;
+  Status s = reducer.InitializeCollectiveParams(
+      instances_[0]->col_params_.get());
+  EXPECT_EQ(s.code(), error::INVALID_ARGUMENT);
+}
+
+TEST_F(PartialReducerTest, NonMeanReductionFails) {
+  Init(1, 2, 1, DT_FLOAT, TensorShape({8}));
+  DeviceInstance* di = instances_[0].get();
+  std::unique_ptr<OpKernel> mul =
+      GetKernel("Mul", DT_FLOAT, test_env_->device_type, di->device_);
+  di->col_params_->merge_op = mul.get();
+  PartialReducer reducer;
+  Status s = reducer.InitializeCollectiveParams(di->col_params_.get());
+  EXPECT_EQ(s.code(), error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -27,18 +27,34 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_partition.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Returns true if the sends between two devices of the same process should
+// be coalesced into one grouped send/recv. See
+// `PartitionOptions::group_send_recv`.
+bool GroupSendRecvEnabled() {
+  static const bool enabled = [] {
+    bool enabled;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_GROUP_SEND_RECV", /*default_val=*/false,
+                           &enabled));
+    return enabled;
+  }();
+  return enabled;
+}
+
 // A helper to partiton a `graph` given a `device_set` and a `graph`.
 // `partitions` maps device names to the graphdef assigned to that device.
 Status PartitionFunctionGraph(
     const DeviceSet& device_set, Graph* graph,
     std::unordered_map<string, GraphDef>* partitions,
     std::function<string(const Node*)> node_to_loc,
-    std::function<string(const Edge*)> get_tensor_name_attr) {
+    std::function<string(const Edge*)> get_tensor_name_attr,
+    bool group_send_recv = false) {
   PartitionOptions partition_options;
   if (node_to_loc != nullptr) {
     partition_options.node_to_loc = node_to_loc;
@@ -66,6 +82,7 @@ Status PartitionFunctionGraph(
   };
   partition_options.control_flow_added = false;
   partition_options.get_tensor_name_attr = get_tensor_name_attr;
+  partition_options.group_send_recv = group_send_recv;
 
   return Partition(partition_options, graph, partitions);
 }
@@ -119,7 +136,8 @@ Status PartitionFunctionGraph(
   std::unordered_map<string, GraphDef> partitions;
   TF_RETURN_IF_ERROR(
       PartitionFunctionGraph(device_set, graph.get(), &partitions,
-                             /*node_to_loc=*/nullptr, get_tensor_name_attr));
+                             /*node_to_loc=*/nullptr, get_tensor_name_attr,
+                             GroupSendRecvEnabled()));
 
   for (auto& partition : partitions) {
     const string& device = partition.first;
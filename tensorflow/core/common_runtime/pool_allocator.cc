@@ -131,6 +131,9 @@ void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
   } else {
     size_t bytes_received;
     void* ptr = allocator_->Alloc(kPoolAlignment, num_bytes, &bytes_received);
+    if (ptr == nullptr) {
+      return nullptr;
+    }
     return PrepareChunk(ptr, alignment, bytes_received);
   }
 }
@@ -31,6 +31,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function_optimization_registry.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/common_runtime/optimize_function_graph_utils.h"
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
+#include "tensorflow/core/common_runtime/optimized_function_graph_info.h"
 #include "tensorflow/core/common_runtime/partitioning_utils.h"
 #include "tensorflow/core/common_runtime/placer.h"
 #include "tensorflow/core/common_runtime/rendezvous_util.h"
@@ -412,6 +414,48 @@ Status FunctionRetsToTensors(const std::vector<FunctionRet>* function_rets,
   }
   return OkStatus();
 }
+
+// Like OptimizeFunctionGraph(), but reuses the result of an earlier
+// optimization of the same function and options from the
+// OptimizedFunctionGraphCache, if it is enabled.
+StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraphOrReadFromCache(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
+    const std::vector<CompositeDevice*>& composite_devices, Device* cpu_device,
+    Device* default_device, Env* env) {
+  OptimizedFunctionGraphCache* cache = OptimizedFunctionGraphCache::Global();
+  std::optional<uint64_t> fingerprint;
+  if (cache != nullptr) {
+    fingerprint = OptimizeFunctionGraphFingerprint(
+        function_name, attrs, options, dev_set, input_lib_def,
+        composite_devices, default_device);
+  }
+  if (fingerprint.has_value()) {
+    std::shared_ptr<const OptimizedFunctionGraph> cached =
+        cache->Lookup(*fingerprint);
+    if (cached != nullptr) {
+      StatusOr<OptimizedFunctionGraphInfo> info =
+          OptimizedFunctionGraphInfo::FromProto(*cached);
+      if (info.ok()) {
+        VLOG(1) << "Reusing the optimized graph of function \""
+                << function_name << "\"";
+        return info;
+      }
+      LOG(WARNING) << "Ignoring cached optimized graph of function \""
+                   << function_name << "\": " << info.status();
+    }
+  }
+  TF_ASSIGN_OR_RETURN(
+      OptimizedFunctionGraphInfo info,
+      OptimizeFunctionGraph(function_name, attrs, options, dev_set,
+                            input_lib_def, composite_devices, cpu_device,
+                            default_device, env));
+  if (fingerprint.has_value()) {
+    cache->Insert(*fingerprint, OptimizedFunctionGraphInfo::ToProto(info));
+  }
+  return info;
+}
 }  // namespace
 
 ProcessFunctionLibraryRuntime::AsyncAttributes::Summary
@@ -558,7 +602,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
 
   const uint64 optimization_start_time_usecs = Env::Default()->NowMicros();
   TF_ASSIGN_OR_RETURN(auto optimized_graph_info,
-                      OptimizeFunctionGraph(
+                      OptimizeFunctionGraphOrReadFromCache(
                           function_name, attrs, options, *dev_set, lib_def_,
                           composite_devices, cpu_device, default_device, env_));
 
@@ -59,6 +59,10 @@ class RenamedDevice : public Device {
     return underlying_device_->GetAllocator(attr);
   }
 
+  Allocator* GetStepArenaAllocator() override {
+    return underlying_device_->GetStepArenaAllocator();
+  }
+
   Allocator* GetScopedAllocator(AllocatorAttributes attr,
                                 int64_t step_id) override {
     return underlying_device_->GetScopedAllocator(attr, step_id);
@@ -20,6 +20,7 @@ limitations under the License.
 #include <functional>
 #include <utility>
 
+#include "tensorflow/core/common_runtime/collective_compression.h"
 #include "tensorflow/core/common_runtime/collective_rma_local.h"
 #include "tensorflow/core/common_runtime/collective_util.h"
 #include "tensorflow/core/common_runtime/copy_tensor.h"
@@ -178,6 +179,7 @@ Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
 }  // namespace
 
 Status RingAlg::InitializeCollectiveParams(CollectiveParams* col_params) {
+  TF_RETURN_IF_ERROR(ValidateCollectiveCompression(*col_params));
   const string& device_name =
       col_params->group.members[col_params->default_rank].device.name();
   // Each subdiv permutation is a ring formed by rotating each
@@ -404,13 +406,55 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  const Tensor* send_tensor = &rf->chunk;
+  StatusCallback send_done = done;
+  if (CompressesField(*rf)) {
+    const CollImplDetails& details = col_params_->instance.impl_details;
+    if ((rf->second_pass || col_params_->merge_op == nullptr) &&
+        col_params_->group.num_tasks > 1) {
+      // Round final values to the wire precision in place before sending
+      // them anywhere, so that the members that receive them uncompressed
+      // end up with the same values as those that receive them compressed.
+      Tensor rounded;
+      Status s = CompressTensor(details, rf->chunk, nullptr, &rounded);
+      if (s.ok()) s = DecompressTensor(details, rounded, &rf->chunk);
+      if (!s.ok()) {
+        done(s);
+        return;
+      }
+    }
+    if (InOtherTask(send_to_dev_idx)) {
+      Tensor residual;
+      if (details.compression == COLLECTIVE_COMPRESSION_TOP_K) {
+        residual = CollectiveCompressionResiduals::Global()->Get(
+            strings::StrCat(name_, ":", col_ctx_->device_name, ":",
+                            col_params_->instance.instance_key, ":",
+                            rf->sc_idx),
+            col_ctx_->step_id, rf->chunk.dtype(), rf->chunk.NumElements());
+      }
+      Tensor* wire = new Tensor;
+      Status s = CompressTensor(details, rf->chunk,
+                                residual.IsInitialized() ? &residual : nullptr,
+                                wire);
+      if (!s.ok()) {
+        delete wire;
+        done(s);
+        return;
+      }
+      send_tensor = wire;
+      send_done = [wire, done](const Status& s) {
+        delete wire;
+        done(s);
+      };
+    }
+  }
   col_ctx_->col_exec->remote_access()->PostToPeer(
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), send_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
-      done);
+      send_done);
 }
 
 void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
@@ -424,14 +468,47 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  Tensor* recv_tensor = dst_tensor;
+  StatusCallback recv_done = done;
+  if (CompressesField(*rf) && InOtherTask(rf->recv_dev_idx)) {
+    const CollImplDetails* details = &col_params_->instance.impl_details;
+    Tensor* wire = new Tensor(AllocateCompressedTensor(
+        *details, dst_tensor->dtype(), dst_tensor->NumElements()));
+    recv_tensor = wire;
+    recv_done = [details, wire, dst_tensor, done](const Status& s) {
+      Status status = s;
+      if (status.ok()) {
+        status = DecompressTensor(*details, *wire, dst_tensor);
+      }
+      delete wire;
+      done(status);
+    };
+  }
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
       col_params_->group.members[rf->recv_dev_idx].is_local, recv_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
+      col_ctx_->op_ctx->output_alloc_attr(0), recv_tensor,
       col_ctx_->device_locality, rf->subdiv_idx,
-      col_ctx_->op_ctx->cancellation_manager(), done);
+      col_ctx_->op_ctx->cancellation_manager(), recv_done);
+}
+
+bool RingAlg::InOtherTask(int dev_idx) const {
+  return col_params_->group.members[dev_idx].task !=
+         col_params_->group.members[col_params_->default_rank].task;
+}
+
+bool RingAlg::CompressesField(const RingField& rf) const {
+  const CollectiveCompression compression =
+      col_params_->instance.impl_details.compression;
+  if (compression == COLLECTIVE_COMPRESSION_NONE) {
+    return false;
+  }
+  // Top-k sparsification would drop most of the final values, so it only
+  // applies to the partial reductions of the first pass.
+  return compression != COLLECTIVE_COMPRESSION_TOP_K ||
+         (!rf.second_pass && col_params_->merge_op != nullptr);
 }
 
 string RingAlg::FieldState() {
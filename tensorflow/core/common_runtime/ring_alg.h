@@ -83,6 +83,11 @@ class RingAlg : public CollectiveImplementationInterface {
   void AdvanceToSecondPass(RingField* rf);
   void DispatchSend(RingField* rf, const StatusCallback& done);
   void DispatchRecv(RingField* rf, const StatusCallback& done);
+  // Returns true if the transfers of rf in its current pass use the wire
+  // compression requested in the CollectiveParams.  Only transfers between
+  // tasks are compressed.
+  bool CompressesField(const RingField& rf) const;
+  bool InOtherTask(int dev_idx) const;
 
   // For constructing log messages for debugging.
   string FieldState();
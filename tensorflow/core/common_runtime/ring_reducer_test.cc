@@ -204,6 +204,38 @@ class RingReducerTest : public ::testing::Test {
   int32 reduce_counter_ TF_GUARDED_BY(mu_) = 0;
 };
 
+#if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+TEST_F(RingReducerTest, CompressedTransfersBetweenTasks) {
+  const int kNumWorkers = 2;
+  const int kNumDevices = 2;
+  const int kTensorLen = 8;
+  Init(kNumWorkers, kNumDevices, DT_FLOAT, TensorShape({kTensorLen}),
+       DEVICE_CPU, /*num_subdivs=*/1, /*fail_after=*/0);
+  std::vector<float> expected(kTensorLen);
+  for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+    // Transfers between the two workers are compressed.
+    instances_[di]->col_params_->instance.impl_details.compression =
+        COLLECTIVE_COMPRESSION_BFLOAT16;
+    instances_[di]->InitTensor([&expected, di](Tensor* t) {
+      for (int i = 0; i < kTensorLen; ++i) {
+        // Small integers and their quarters are exact in bfloat16.
+        t->flat<float>()(i) = di * 10 + i;
+        expected[i] += di * 10 + i;
+      }
+    });
+  }
+  Reduce(/*fail_after=*/0);
+  for (int i = 0; i < kTensorLen; ++i) {
+    expected[i] /= instances_.size();
+  }
+  for (auto& instance : instances_) {
+    TF_EXPECT_OK(instance->status_);
+    test::ExpectTensorEqual<float>(test::AsTensor<float>(expected),
+                                   instance->tensor());
+  }
+}
+#endif
+
 class RingReducerInitParamsTest : public ::testing::Test {
  protected:
   void RunSubdivPermsTest(
@@ -15,18 +15,30 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/single_threaded_executor.h"
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <queue>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -67,11 +79,24 @@ typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
 static const string& kSingleThreadedExecutor =
     *new string("SINGLE_THREADED_EXECUTOR");
+static const string& kStaticScheduleExecutor =
+    *new string("STATIC_SCHEDULE_EXECUTOR");
+
+// The maximum number of lanes of the schedule of an executor registered as
+// `kStaticScheduleExecutor`.
+constexpr int kMaxStaticScheduleLanes = 4;
 
 class SingleThreadedExecutorImpl : public Executor {
  public:
-  explicit SingleThreadedExecutorImpl(const LocalExecutorParams& params)
-      : params_(params) {}
+  explicit SingleThreadedExecutorImpl(const LocalExecutorParams& params,
+                                      int num_lanes = 1,
+                                      bool plan_memory = false)
+      : params_(params),
+        num_lanes_(num_lanes),
+        plan_memory_(plan_memory),
+        executor_type_(num_lanes > 1 || plan_memory
+                           ? &kStaticScheduleExecutor
+                           : &kSingleThreadedExecutor) {}
 
   ~SingleThreadedExecutorImpl() override {
     for (const KernelState& kernel_state : kernels_) {
@@ -251,10 +276,37 @@ class SingleThreadedExecutorImpl : public Executor {
     } else {
       total_num_inputs_ = 0;
     }
+
+    // Record the dependencies between kernels for building the static
+    // schedule. Dependencies on arguments and constant tensors are always
+    // satisfied at the beginning of a step.
+    if (num_lanes_ > 1) {
+      kernel_inputs_.resize(kernels_.size());
+      kernel_outputs_.resize(kernels_.size());
+      for (size_t i = 0; i < kernels_.size(); ++i) {
+        for (const Edge* e : nodes_with_kernels[i]->out_edges()) {
+          auto it = node_to_index_map.find(e->dst());
+          if (it == node_to_index_map.end()) {
+            continue;
+          }
+          std::vector<size_t>& inputs = kernel_inputs_[it->second];
+          if (inputs.empty() || inputs.back() != i) {
+            inputs.push_back(i);
+            kernel_outputs_[i].push_back(it->second);
+          }
+        }
+      }
+    }
     return OkStatus();
   }
 
   Status Run(const Args& args) override {
+    const StaticSchedule* schedule = schedule_.load(std::memory_order_acquire);
+    if (UseStaticSchedule(schedule, args)) {
+      // Run the lanes of the static schedule and wait for them to finish.
+      return Executor::Run(args);
+    }
+
     // The inputs to each kernel are stored contiguously in `inputs`.
     //
     // We use `kernels_[i].input_start_index` and `kernels_[i].num_inputs` to
@@ -307,42 +359,229 @@ class SingleThreadedExecutorImpl : public Executor {
 
     // Prepare the parameters that will be the same for all kernels.
     OpKernelContext::Params params;
-    params.step_id = args.step_id;
-    params.device = device;
-    params.log_memory = false;  // TODO(mrry): Too severe?
-    params.rendezvous = args.rendezvous;
-    params.session_state = args.session_state;
-    params.session_metadata = params_.session_metadata;
-    params.tensor_store = args.tensor_store;
-    params.cancellation_manager = args.cancellation_manager;
-    params.call_frame = args.call_frame;
-    params.function_library = params_.function_library;
-    params.resource_manager = device->resource_manager();
-    params.step_container = args.step_container;
-    params.collective_executor = args.collective_executor;
-    params.stack_trace = args.stack_trace;
-    params.slice_reader_cache = nullptr;  // TODO(mrry): Too severe?
-
     Args::Runner runner_copy = args.runner;
-    params.runner = &runner_copy;
-    params.run_all_kernels_inline = args.run_all_kernels_inline;
-    params.stats_collector = args.stats_collector;
-    params.executor_type = &kSingleThreadedExecutor;
-
-    // NOTE(mrry): We are assuming that the graph is loopless and condless.
-    params.frame_iter = FrameAndIter(0, 0);
-    params.is_input_dead = false;
-
-    device->TryGetDeviceContext(&params.op_device_context).IgnoreError();
+    PrepareParams(args, device, &runner_copy, &params);
     auto context_cleanup = gtl::MakeCleanup([&params] {
       if (params.op_device_context != nullptr) {
         params.op_device_context->Unref();
       }
     });
 
+    // Serve the intermediate tensors from the static memory plan, or record
+    // the allocations of this step to build it.
+    PlannedMemoryStep memory_step;
+    bool succeeded = false;
+    auto memory_cleanup = gtl::MakeCleanup([this, &memory_step, &succeeded] {
+      FinishPlannedMemoryStep(succeeded, &memory_step);
+    });
+    if (plan_memory_) {
+      Allocator* step_allocator = StartPlannedMemoryStep(&memory_step);
+      if (step_allocator != nullptr) {
+        params.step_allocator = step_allocator;
+      }
+    }
+
+    TF_RETURN_IF_ERROR(InitializeInputs(args, &inputs));
+
+    // Record the cost of each kernel if the static schedule has not been built
+    // yet.
+    std::vector<int64_t> kernel_costs;
+    if (num_lanes_ > 1 && schedule == nullptr) {
+      kernel_costs.resize(kernels_.size());
+    }
+
+    // Execute the kernels one-at-a-time in topological order.
+    for (size_t i = 0; i < kernels_.size(); ++i) {
+      const uint64 start_nsec = kernel_costs.empty() ? 0 : EnvTime::NowNanos();
+      TF_RETURN_IF_ERROR(RunKernel(i, device, &params, &inputs, &node_inputs,
+                                   &input_alloc_attrs));
+      if (!kernel_costs.empty()) {
+        kernel_costs[i] = EnvTime::NowNanos() - start_nsec;
+      }
+    }
+    if (!kernel_costs.empty()) {
+      InstallSchedule(kernel_costs);
+    }
+    succeeded = true;
+    return OkStatus();
+  }
+
+  // Execute all operations in the calling thread when asynchronous execution
+  // is requested. Callers may expect to perform expensive work in the calling
+  // thread even when the execution itself is single-threaded.
+  //
+  // This also avoid stack-overflow issues with functional control flow.
+  void RunAsync(const Args& args, DoneCallback done) override {
+    const StaticSchedule* schedule = schedule_.load(std::memory_order_acquire);
+    if (!UseStaticSchedule(schedule, args)) {
+      args.runner([this, args, done]() { done(Run(args)); });
+      return;
+    }
+    RunStaticSchedule(*schedule, args, std::move(done));
+  }
+
+ private:
+  // A precompiled multi-lane schedule of `kernels_`, built from the kernel
+  // costs measured during the first step.
+  struct StaticSchedule {
+    // For each lane, the indices in `kernels_` of the kernels it runs, in
+    // execution order. The concatenation of the lanes in the order in which
+    // the kernels were scheduled is a topological order of the graph.
+    std::vector<std::vector<size_t>> lanes;
+
+    // For each kernel, the identifiers of the producers in other lanes that
+    // must have run before the kernel can run.
+    std::vector<std::vector<int>> cross_lane_inputs;
+
+    // For each kernel, its producer identifier if kernels in other lanes
+    // depend on it, or -1 otherwise.
+    std::vector<int> cross_lane_producer_ids;
+
+    int num_cross_lane_producers = 0;
+  };
+
+  // The state of a step executed by `RunStaticSchedule()`, shared by the
+  // lanes of the step. The lane that finishes last deletes it.
+  struct StepState {
+    StepState(const StaticSchedule& schedule, const Args& args,
+              DoneCallback done)
+        : schedule(schedule),
+          args(args),
+          runner(args.runner),
+          lane_positions(schedule.lanes.size(), 0),
+          num_pending_lanes(schedule.lanes.size()),
+          producer_done(schedule.num_cross_lane_producers, false),
+          waiting_lanes(schedule.num_cross_lane_producers),
+          done(std::move(done)) {}
+
+    const StaticSchedule& schedule;
+    const Args args;
+    Args::Runner runner;
+    Device* device = nullptr;
+    std::unique_ptr<Device> user_device;
+    // See the comment at the beginning of `Run()` for the layout.
+    std::vector<Entry> inputs;
+
+    // For each lane, the position of the next kernel to run in the lane. Only
+    // accessed by the closure currently running the lane.
+    std::vector<size_t> lane_positions;
+    std::atomic<int> num_pending_lanes;
+
+    mutex mu;
+    Status status TF_GUARDED_BY(mu);
+    bool aborted TF_GUARDED_BY(mu) = false;
+    // For each cross-lane producer, whether it has run.
+    std::vector<bool> producer_done TF_GUARDED_BY(mu);
+    // For each cross-lane producer, the lanes waiting for it to run.
+    std::vector<std::vector<int>> waiting_lanes TF_GUARDED_BY(mu);
+
+    DoneCallback done;
+  };
+
+  // The allocator state of a step that executes the kernels one-at-a-time with
+  // memory planning. At most one of the members is set.
+  struct PlannedMemoryStep {
+    core::RefCountPtr<AllocationRecorder> recorder;
+    core::RefCountPtr<PlannedStepAllocator> allocator;
+  };
+
+  // Returns the allocator for the intermediate tensors of a step, or nullptr
+  // if the step should allocate them as usual. The first step records its
+  // allocations, later steps replay the resulting plan. Steps that overlap
+  // with another step using the plan allocate as usual.
+  Allocator* StartPlannedMemoryStep(PlannedMemoryStep* step) {
+    mutex_lock l(memory_mu_);
+    if (planned_allocator_ != nullptr) {
+      if (!planned_allocator_->StartStep()) {
+        return nullptr;
+      }
+      planned_allocator_->Ref();
+      step->allocator.reset(planned_allocator_.get());
+      return step->allocator.get();
+    }
+    if (recording_memory_) {
+      return nullptr;
+    }
+    recording_memory_ = true;
+    step->recorder.reset(
+        new AllocationRecorder(params_.device->GetAllocator({})));
+    return step->recorder.get();
+  }
+
+  // Ends a step started by `StartPlannedMemoryStep()`, and builds the memory
+  // plan from the allocations of the step if it recorded them successfully.
+  void FinishPlannedMemoryStep(bool succeeded, PlannedMemoryStep* step) {
+    if (step->allocator != nullptr) {
+      step->allocator->EndStep();
+      return;
+    }
+    if (step->recorder == nullptr) {
+      return;
+    }
+    std::vector<AllocationRecord> records = step->recorder->StopRecording();
+    core::RefCountPtr<PlannedStepAllocator> planned_allocator;
+    if (succeeded) {
+      StaticMemoryPlan plan = PlanStaticMemory(records);
+      VLOG(1) << "Static memory plan uses an arena of " << plan.arena_bytes
+              << " bytes for " << records.size() << " allocations.";
+      planned_allocator.reset(new PlannedStepAllocator(
+          params_.device->GetAllocator({}), std::move(plan)));
+    }
+    mutex_lock l(memory_mu_);
+    recording_memory_ = false;
+    if (planned_allocator != nullptr) {
+      planned_allocator_ = std::move(planned_allocator);
+    }
+  }
+
+  // Returns true if a step should execute the lanes of `schedule`. A schedule
+  // with a single lane is equivalent to executing the kernels in topological
+  // order on the calling thread.
+  static bool UseStaticSchedule(const StaticSchedule* schedule,
+                                const Args& args) {
+    return schedule != nullptr && schedule->lanes.size() > 1 &&
+           !args.run_all_kernels_inline;
+  }
+
+  // Fills in the parameters that are the same for all kernels of a step.
+  // The caller owns the reference on `params->op_device_context`.
+  void PrepareParams(const Args& args, Device* device, Args::Runner* runner,
+                     OpKernelContext::Params* params) const {
+    params->step_id = args.step_id;
+    params->device = device;
+    params->step_allocator = device->GetStepArenaAllocator();
+    params->log_memory = false;  // TODO(mrry): Too severe?
+    params->rendezvous = args.rendezvous;
+    params->session_state = args.session_state;
+    params->session_metadata = params_.session_metadata;
+    params->tensor_store = args.tensor_store;
+    params->cancellation_manager = args.cancellation_manager;
+    params->call_frame = args.call_frame;
+    params->function_library = params_.function_library;
+    params->resource_manager = device->resource_manager();
+    params->step_container = args.step_container;
+    params->collective_executor = args.collective_executor;
+    params->stack_trace = args.stack_trace;
+    params->slice_reader_cache = nullptr;  // TODO(mrry): Too severe?
+
+    params->runner = runner;
+    params->run_all_kernels_inline = args.run_all_kernels_inline;
+    params->stats_collector = args.stats_collector;
+    params->executor_type = executor_type_;
+
+    // NOTE(mrry): We are assuming that the graph is loopless and condless.
+    params->frame_iter = FrameAndIter(0, 0);
+    params->is_input_dead = false;
+
+    device->TryGetDeviceContext(&params->op_device_context).IgnoreError();
+
     // TODO(mrry): Consider implementing forwarding.
-    params.forward_from_array = nullptr;
+    params->forward_from_array = nullptr;
+  }
 
+  // Forwards the arguments of the step and the constant tensors to the inputs
+  // of the kernels that consume them.
+  Status InitializeInputs(const Args& args, std::vector<Entry>* inputs) const {
     const size_t received_args =
         args.call_frame ? args.call_frame->num_args() : 0;
     if (TF_PREDICT_FALSE(arg_output_locations_.size() > received_args)) {
@@ -360,7 +599,7 @@ class SingleThreadedExecutorImpl : public Executor {
       if (num_destinations > 0) {
         if (args.call_frame->CanConsumeArg(i)) {
           // The first destination input can consume the argument.
-          Entry& first_input = inputs[arg_output_locations_[i][0]];
+          Entry& first_input = (*inputs)[arg_output_locations_[i][0]];
           first_input.state = Entry::State::HAS_VALUE;
           first_input.val.Init();
           args.call_frame->ConsumeArg(i, first_input.val.get());
@@ -371,7 +610,7 @@ class SingleThreadedExecutorImpl : public Executor {
           // forward their input, we could arrange the kernel order so that
           // one of those kernels was executed last.
           for (size_t j = 1; j < num_destinations; ++j) {
-            Entry& input = inputs[arg_output_locations_[i][j]];
+            Entry& input = (*inputs)[arg_output_locations_[i][j]];
             input.state = Entry::State::HAS_VALUE;
             input.val.Init(*first_input.val);
           }
@@ -379,7 +618,7 @@ class SingleThreadedExecutorImpl : public Executor {
           const Tensor* arg;
           TF_RETURN_IF_ERROR(args.call_frame->GetArg(i, &arg));
           for (size_t j = 0; j < num_destinations; ++j) {
-            Entry& input = inputs[arg_output_locations_[i][j]];
+            Entry& input = (*inputs)[arg_output_locations_[i][j]];
             // NOTE: We must make at least one shallow copy of the argument
             // tensor that remains live until all consuming kernels have
             // executed, to keep the reference count > 1, and inhibit buffer
@@ -398,106 +637,376 @@ class SingleThreadedExecutorImpl : public Executor {
     // to the inputs of kernels that consume them.
     for (const ConstTensorKernelState& kernel_state : const_tensor_kernels_) {
       for (size_t i = 0; i < kernel_state.output_locations.size(); ++i) {
-        Entry& input = inputs[kernel_state.output_locations[i]];
+        Entry& input = (*inputs)[kernel_state.output_locations[i]];
         input.state = Entry::State::HAS_CONST_TENSOR;
         input.const_tensor = &kernel_state.const_tensor;
       }
     }
+    return OkStatus();
+  }
 
-    // Execute the kernels one-at-a-time in topological order.
-    for (size_t i = 0; i < kernels_.size(); ++i) {
-      const KernelState& kernel_state = kernels_[i];
-
-      // Prepare the per-kernel parameters.
-      const size_t input_start_index = kernel_state.input_start_index;
-      const size_t num_inputs = kernel_state.num_inputs;
-      const size_t num_outputs = kernel_state.num_outputs;
-
-      node_inputs.clear();
-      node_inputs.resize(num_inputs);
-      input_alloc_attrs.clear();
-      input_alloc_attrs.resize(num_inputs);
-      for (size_t j = 0; j < num_inputs; ++j) {
-        Entry& input = inputs[input_start_index + j];
-        switch (input.state) {
-          case Entry::State::HAS_CONST_TENSOR:
-            // NOTE(mrry): This `const_cast` is necessary because `TensorValue`
-            // stores a non-const `Tensor*`, and relies on the `OpKernelContext`
-            // accessors making dynamic checks that prevent using an immutable
-            // tensor as a mutable tensor.
-            node_inputs[j].tensor = const_cast<Tensor*>(input.const_tensor);
-            break;
-          case Entry::State::HAS_VALUE:
-            node_inputs[j].tensor = input.val.get();
-            break;
-          default:
-            DCHECK(false) << "Input did not have a valid value.";
-        }
-        input_alloc_attrs[j] = input_alloc_attrs_[input_start_index + j];
-      }
-      params.inputs = node_inputs;
-      params.input_alloc_attrs = input_alloc_attrs;
-      params.op_kernel = kernel_state.kernel;
-      params.output_attr_array = kernel_state.output_alloc_attrs.data();
-      OpKernelContext ctx(&params, num_outputs);
-
-      // Actually execute the kernel.
-      device->Compute(kernel_state.kernel, &ctx);
-      TF_RETURN_IF_ERROR(ctx.status());
-
-      // Free the inputs to the current kernel.
-      for (size_t j = 0; j < num_inputs; ++j) {
-        inputs[input_start_index + j].ClearVal();
+  // Runs `kernels_[i]` and forwards its outputs to the inputs of the kernels
+  // that depend on them.
+  Status RunKernel(size_t i, Device* device, OpKernelContext::Params* params,
+                   std::vector<Entry>* inputs, TensorValueVec* node_inputs,
+                   AllocatorAttributeVec* input_alloc_attrs) const {
+    const KernelState& kernel_state = kernels_[i];
+
+    // Prepare the per-kernel parameters.
+    const size_t input_start_index = kernel_state.input_start_index;
+    const size_t num_inputs = kernel_state.num_inputs;
+    const size_t num_outputs = kernel_state.num_outputs;
+
+    node_inputs->clear();
+    node_inputs->resize(num_inputs);
+    input_alloc_attrs->clear();
+    input_alloc_attrs->resize(num_inputs);
+    for (size_t j = 0; j < num_inputs; ++j) {
+      Entry& input = (*inputs)[input_start_index + j];
+      switch (input.state) {
+        case Entry::State::HAS_CONST_TENSOR:
+          // NOTE(mrry): This `const_cast` is necessary because `TensorValue`
+          // stores a non-const `Tensor*`, and relies on the `OpKernelContext`
+          // accessors making dynamic checks that prevent using an immutable
+          // tensor as a mutable tensor.
+          (*node_inputs)[j].tensor = const_cast<Tensor*>(input.const_tensor);
+          break;
+        case Entry::State::HAS_VALUE:
+          (*node_inputs)[j].tensor = input.val.get();
+          break;
+        default:
+          DCHECK(false) << "Input did not have a valid value.";
       }
+      (*input_alloc_attrs)[j] = input_alloc_attrs_[input_start_index + j];
+    }
+    params->inputs = *node_inputs;
+    params->input_alloc_attrs = *input_alloc_attrs;
+    params->op_kernel = kernel_state.kernel;
+    params->output_attr_array = kernel_state.output_alloc_attrs.data();
+    OpKernelContext ctx(params, num_outputs);
 
-      // Forward the outputs of the kernel to the inputs of subsequent kernels.
-      for (size_t j = 0; j < num_outputs; ++j) {
-        TensorValue val = ctx.release_output(j);
-        const size_t num_destinations = kernel_state.output_locations[j].size();
-        if (num_destinations > 0) {
-          // TODO(mrry): Consider flattening the `output_locations` vector
-          // to improve the cache-friendliness of this loop.
-          for (size_t k = 0; k < num_destinations - 1; ++k) {
-            // TODO(mrry): Validate that the types match the expected values or
-            // ensure that the necessary validation has already happened.
-            Entry& input = inputs[kernel_state.output_locations[j][k]];
-            input.state = Entry::State::HAS_VALUE;
-            if (val.tensor != nullptr) {
-              input.val.Init(*val.tensor);
-            } else {
-              input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
-            }
-          }
-          // Move `arg` to the last consumer to avoid the cost of copying it.
-          Entry& input =
-              inputs[kernel_state.output_locations[j][num_destinations - 1]];
+    // Actually execute the kernel.
+    device->Compute(kernel_state.kernel, &ctx);
+    TF_RETURN_IF_ERROR(ctx.status());
+
+    // Free the inputs to the current kernel.
+    for (size_t j = 0; j < num_inputs; ++j) {
+      (*inputs)[input_start_index + j].ClearVal();
+    }
+
+    // Forward the outputs of the kernel to the inputs of subsequent kernels.
+    for (size_t j = 0; j < num_outputs; ++j) {
+      TensorValue val = ctx.release_output(j);
+      const size_t num_destinations = kernel_state.output_locations[j].size();
+      if (num_destinations > 0) {
+        // TODO(mrry): Consider flattening the `output_locations` vector
+        // to improve the cache-friendliness of this loop.
+        for (size_t k = 0; k < num_destinations - 1; ++k) {
+          // TODO(mrry): Validate that the types match the expected values or
+          // ensure that the necessary validation has already happened.
+          Entry& input = (*inputs)[kernel_state.output_locations[j][k]];
           input.state = Entry::State::HAS_VALUE;
           if (val.tensor != nullptr) {
-            input.val.Init(std::move(*val.tensor));
+            input.val.Init(*val.tensor);
           } else {
             input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
           }
         }
-        delete val.tensor;
+        // Move `arg` to the last consumer to avoid the cost of copying it.
+        Entry& input =
+            (*inputs)[kernel_state.output_locations[j][num_destinations - 1]];
+        input.state = Entry::State::HAS_VALUE;
+        if (val.tensor != nullptr) {
+          input.val.Init(std::move(*val.tensor));
+        } else {
+          input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
+        }
       }
+      delete val.tensor;
     }
     return OkStatus();
   }
 
-  // Execute all operations in the calling thread when asynchronous execution
-  // is requested. Callers may expect to perform expensive work in the calling
-  // thread even when the execution itself is single-threaded.
-  //
-  // This also avoid stack-overflow issues with functional control flow.
-  void RunAsync(const Args& args, DoneCallback done) override {
-    args.runner([this, args, done]() { done(Run(args)); });
+  // Builds the static schedule from the measured `kernel_costs` and publishes
+  // it for subsequent steps, unless a concurrent step already did.
+  void InstallSchedule(const std::vector<int64_t>& kernel_costs) {
+    auto schedule = std::make_unique<StaticSchedule>(
+        BuildStaticSchedule(kernel_costs));
+    mutex_lock l(schedule_mu_);
+    if (schedule_owner_ != nullptr) {
+      return;
+    }
+    schedule_owner_ = std::move(schedule);
+    schedule_.store(schedule_owner_.get(), std::memory_order_release);
   }
 
- private:
+  // Simulates list scheduling of `kernels_` on `num_lanes` lanes, using the
+  // length of the longest path to a sink as the priority of a ready kernel.
+  // Returns the estimated step time and stores the lane of each kernel in
+  // `kernel_lanes` and the kernels in scheduling order in `order`.
+  int64_t SimulateSchedule(const std::vector<int64_t>& kernel_costs,
+                           const std::vector<int64_t>& priorities,
+                           int num_lanes, std::vector<int>* kernel_lanes,
+                           std::vector<size_t>* order) const {
+    const size_t num_kernels = kernels_.size();
+    kernel_lanes->assign(num_kernels, -1);
+    order->clear();
+    order->reserve(num_kernels);
+    std::vector<int64_t> finish_nsec(num_kernels, 0);
+    std::vector<int64_t> lane_free_nsec(num_lanes, 0);
+    std::vector<size_t> num_pending(num_kernels);
+    std::priority_queue<std::pair<int64_t, size_t>> ready;
+    for (size_t i = 0; i < num_kernels; ++i) {
+      num_pending[i] = kernel_inputs_[i].size();
+      if (num_pending[i] == 0) {
+        ready.push({priorities[i], i});
+      }
+    }
+    int64_t makespan_nsec = 0;
+    while (!ready.empty()) {
+      const size_t i = ready.top().second;
+      ready.pop();
+      int best_lane = 0;
+      int64_t best_start_nsec = std::numeric_limits<int64_t>::max();
+      for (int lane = 0; lane < num_lanes; ++lane) {
+        int64_t start_nsec = lane_free_nsec[lane];
+        for (size_t input : kernel_inputs_[i]) {
+          const int64_t delay_nsec =
+              (*kernel_lanes)[input] == lane ? 0 : kCrossLaneDelayNsec;
+          start_nsec = std::max(start_nsec, finish_nsec[input] + delay_nsec);
+        }
+        if (start_nsec < best_start_nsec) {
+          best_lane = lane;
+          best_start_nsec = start_nsec;
+        }
+      }
+      (*kernel_lanes)[i] = best_lane;
+      finish_nsec[i] = best_start_nsec + kernel_costs[i];
+      lane_free_nsec[best_lane] = finish_nsec[i];
+      makespan_nsec = std::max(makespan_nsec, finish_nsec[i]);
+      order->push_back(i);
+      for (size_t output : kernel_outputs_[i]) {
+        if (--num_pending[output] == 0) {
+          ready.push({priorities[output], output});
+        }
+      }
+    }
+    return makespan_nsec + (num_lanes - 1) * kLaneStartupNsec;
+  }
+
+  StaticSchedule BuildStaticSchedule(
+      const std::vector<int64_t>& measured_costs) const {
+    const size_t num_kernels = kernels_.size();
+    std::vector<int64_t> kernel_costs(num_kernels);
+    for (size_t i = 0; i < num_kernels; ++i) {
+      kernel_costs[i] = std::max<int64_t>(measured_costs[i], 1);
+    }
+    // `kernels_` is in topological order, so the priorities can be computed
+    // in a single backwards pass.
+    std::vector<int64_t> priorities(num_kernels);
+    for (size_t i = num_kernels; i-- > 0;) {
+      int64_t max_output_priority = 0;
+      for (size_t output : kernel_outputs_[i]) {
+        max_output_priority = std::max(max_output_priority, priorities[output]);
+      }
+      priorities[i] = kernel_costs[i] + max_output_priority;
+    }
+
+    // Use the smallest number of lanes with the lowest estimated step time.
+    int num_lanes = 1;
+    std::vector<int> kernel_lanes;
+    std::vector<size_t> order;
+    int64_t best_nsec = SimulateSchedule(kernel_costs, priorities, num_lanes,
+                                         &kernel_lanes, &order);
+    for (int n = 2; n <= num_lanes_; ++n) {
+      std::vector<int> candidate_lanes;
+      std::vector<size_t> candidate_order;
+      const int64_t nsec = SimulateSchedule(kernel_costs, priorities, n,
+                                            &candidate_lanes, &candidate_order);
+      if (nsec < best_nsec) {
+        num_lanes = n;
+        best_nsec = nsec;
+        kernel_lanes = std::move(candidate_lanes);
+        order = std::move(candidate_order);
+      }
+    }
+    VLOG(1) << "Static schedule uses " << num_lanes << " lanes with an "
+            << "estimated step time of " << best_nsec << "ns.";
+
+    StaticSchedule schedule;
+    schedule.lanes.resize(num_lanes);
+    for (size_t i : order) {
+      schedule.lanes[kernel_lanes[i]].push_back(i);
+    }
+    schedule.cross_lane_inputs.resize(num_kernels);
+    schedule.cross_lane_producer_ids.assign(num_kernels, -1);
+    for (size_t i = 0; i < num_kernels; ++i) {
+      for (size_t input : kernel_inputs_[i]) {
+        if (kernel_lanes[input] == kernel_lanes[i]) {
+          continue;
+        }
+        int& producer_id = schedule.cross_lane_producer_ids[input];
+        if (producer_id < 0) {
+          producer_id = schedule.num_cross_lane_producers++;
+        }
+        schedule.cross_lane_inputs[i].push_back(producer_id);
+      }
+    }
+    return schedule;
+  }
+
+  // Runs one step by executing each lane of `schedule` in a separate closure.
+  // A lane that reaches a kernel whose inputs from other lanes are not ready
+  // yet is parked and resumed by the lane that produces the missing input, so
+  // lanes never block each other and only kernels with consumers in other
+  // lanes require synchronization.
+  void RunStaticSchedule(const StaticSchedule& schedule, const Args& args,
+                         DoneCallback done) {
+    auto* step = new StepState(schedule, args, std::move(done));
+    step->device = params_.device;
+    if (args.user_intra_op_threadpool != nullptr) {
+      step->user_device = RenamedDevice::NewRenamedDevice(
+          step->device->name(), step->device, /*owns_underlying=*/false,
+          /*isolate_session_state=*/false, args.user_intra_op_threadpool);
+      step->device = step->user_device.get();
+    }
+    step->inputs.resize(total_num_inputs_);
+    Status s = InitializeInputs(step->args, &step->inputs);
+    if (!s.ok()) {
+      DoneCallback done = std::move(step->done);
+      delete step;
+      done(s);
+      return;
+    }
+    // The last lane to finish deletes `step`, possibly before `runner` returns.
+    Args::Runner runner = step->runner;
+    for (int lane = 0; lane < schedule.lanes.size(); ++lane) {
+      runner([this, step, lane]() { RunLane(step, lane); });
+    }
+  }
+
+  // Runs `lane` of a step and finishes the step if it was the last lane.
+  void RunLane(StepState* step, int lane) const {
+    if (!RunLaneKernels(step, lane)) {
+      return;
+    }
+    if (step->num_pending_lanes.fetch_sub(1) == 1) {
+      Status s;
+      {
+        mutex_lock l(step->mu);
+        s = step->status;
+      }
+      DoneCallback done = std::move(step->done);
+      delete step;
+      done(s);
+    }
+  }
+
+  // Runs the kernels of `lane` until the lane is done or has to wait for a
+  // kernel in another lane. Returns false if the lane is waiting.
+  bool RunLaneKernels(StepState* step, int lane) const {
+    const StaticSchedule& schedule = step->schedule;
+    const std::vector<size_t>& lane_kernels = schedule.lanes[lane];
+    size_t& position = step->lane_positions[lane];
+
+    OpKernelContext::Params params;
+    PrepareParams(step->args, step->device, &step->runner, &params);
+    auto context_cleanup = gtl::MakeCleanup([&params] {
+      if (params.op_device_context != nullptr) {
+        params.op_device_context->Unref();
+      }
+    });
+    TensorValueVec node_inputs;
+    AllocatorAttributeVec input_alloc_attrs;
+
+    for (; position < lane_kernels.size(); ++position) {
+      const size_t i = lane_kernels[position];
+      // Only kernels with inputs from other lanes need to synchronize, which
+      // is also when this lane observes errors in other lanes.
+      if (!schedule.cross_lane_inputs[i].empty()) {
+        mutex_lock l(step->mu);
+        if (step->aborted) {
+          break;
+        }
+        for (int producer_id : schedule.cross_lane_inputs[i]) {
+          if (!step->producer_done[producer_id]) {
+            step->waiting_lanes[producer_id].push_back(lane);
+            return false;
+          }
+        }
+      }
+      Status s = RunKernel(i, step->device, &params, &step->inputs,
+                           &node_inputs, &input_alloc_attrs);
+      if (!s.ok()) {
+        mutex_lock l(step->mu);
+        if (!step->aborted) {
+          step->aborted = true;
+          step->status = s;
+        }
+        break;
+      }
+      if (schedule.cross_lane_producer_ids[i] >= 0) {
+        MarkProducerDone(step, schedule.cross_lane_producer_ids[i]);
+      }
+    }
+    // If the step was aborted, release the remaining producers of this lane
+    // so that the lanes waiting for them observe the error.
+    for (; position < lane_kernels.size(); ++position) {
+      const int producer_id =
+          schedule.cross_lane_producer_ids[lane_kernels[position]];
+      if (producer_id >= 0) {
+        MarkProducerDone(step, producer_id);
+      }
+    }
+    return true;
+  }
+
+  // Marks the producer with `producer_id` as done and resumes the lanes
+  // waiting for it.
+  void MarkProducerDone(StepState* step, int producer_id) const {
+    std::vector<int> waiting_lanes;
+    {
+      mutex_lock l(step->mu);
+      step->producer_done[producer_id] = true;
+      waiting_lanes.swap(step->waiting_lanes[producer_id]);
+    }
+    for (int lane : waiting_lanes) {
+      step->runner([this, step, lane]() { RunLane(step, lane); });
+    }
+  }
+
+  // Rough estimates of the overhead of handing a tensor to another lane and of
+  // starting an additional lane, used when building the static schedule.
+  static constexpr int64_t kCrossLaneDelayNsec = 2000;
+  static constexpr int64_t kLaneStartupNsec = 5000;
+
   const LocalExecutorParams params_;
 
+  // The maximum number of lanes of the static schedule. If 1, the kernels are
+  // always executed one-at-a-time in topological order.
+  const int num_lanes_;
+  // If true, steps that execute the kernels one-at-a-time allocate the
+  // intermediate tensors according to a static memory plan.
+  const bool plan_memory_;
+  const string* const executor_type_;
+
+  mutex memory_mu_;
+  bool recording_memory_ TF_GUARDED_BY(memory_mu_) = false;
+  core::RefCountPtr<PlannedStepAllocator> planned_allocator_
+      TF_GUARDED_BY(memory_mu_);
+
+  // The static schedule, built after the first step if `num_lanes_ > 1`.
+  mutex schedule_mu_;
+  std::unique_ptr<StaticSchedule> schedule_owner_ TF_GUARDED_BY(schedule_mu_);
+  std::atomic<const StaticSchedule*> schedule_{nullptr};
+
   // All following members are read-only after Initialize().
 
+  // For each kernel, the indices in `kernels_` of the kernels it depends on
+  // and the kernels that depend on it. Only set if `num_lanes_ > 1`.
+  std::vector<std::vector<size_t>> kernel_inputs_;
+  std::vector<std::vector<size_t>> kernel_outputs_;
+
   // The sum of the number of inputs for each node in the graph. This determines
   // the length of the flat `inputs` vector. See comment at the beginning of
   // `RunAsync()` for details.
@@ -573,6 +1082,8 @@ class SingleThreadedExecutorRegistrar {
  public:
   SingleThreadedExecutorRegistrar() {
     ExecutorFactory::Register(kSingleThreadedExecutor, new Factory());
+    ExecutorFactory::Register(kStaticScheduleExecutor,
+                              new StaticScheduleFactory());
   }
 
  private:
@@ -585,6 +1096,18 @@ class SingleThreadedExecutorRegistrar {
       return OkStatus();
     }
   };
+
+  class StaticScheduleFactory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret;
+      TF_RETURN_IF_ERROR(NewStaticScheduleExecutor(
+          params, graph,
+          std::min(kMaxStaticScheduleLanes, port::MaxParallelism()), &ret));
+      out_executor->reset(ret);
+      return OkStatus();
+    }
+  };
 };
 static SingleThreadedExecutorRegistrar registrar;
 
@@ -598,4 +1121,21 @@ Status NewSingleThreadedExecutor(const LocalExecutorParams& params,
   return OkStatus();
 }
 
+Status NewStaticScheduleExecutor(const LocalExecutorParams& params,
+                                 const Graph& graph, int num_lanes,
+                                 Executor** executor) {
+  if (num_lanes < 1) {
+    return errors::InvalidArgument(
+        "The number of lanes of a static schedule must be positive, but got ",
+        num_lanes, ".");
+  }
+  // The lanes of later steps allocate concurrently, so the memory plan is
+  // only replayed, and its arena only allocated, with a single lane.
+  auto impl = std::make_unique<SingleThreadedExecutorImpl>(
+      params, num_lanes, /*plan_memory=*/num_lanes == 1);
+  TF_RETURN_IF_ERROR(impl->Initialize(graph));
+  *executor = impl.release();
+  return OkStatus();
+}
+
 }  // namespace tensorflow
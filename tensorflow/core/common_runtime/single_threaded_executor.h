@@ -54,6 +54,29 @@ namespace tensorflow {
 Status NewSingleThreadedExecutor(const LocalExecutorParams& params,
                                  const Graph& graph, Executor** executor);
 
+// Creates a new `Executor` for executing `graph` according to a static schedule
+// with up to `num_lanes` parallel lanes.
+//
+// The returned executor has the same limitations as the single-threaded
+// executor, and is intended for inference graphs that are executed repeatedly
+// with the same amount of work per step. The first step executes the kernels
+// one at a time, as the single-threaded executor does, and measures their
+// costs. These costs are then used to assign each kernel to a lane and order
+// the lanes, and subsequent steps replay that schedule without tracking
+// pending inputs per node: only kernels that consume outputs from another lane
+// synchronize with it.
+//
+// With a single lane, steps also use a static memory plan for the
+// intermediate tensors: the first step records the sizes and lifetimes of its
+// allocations, which are then packed into a single arena that later steps
+// reuse (see `PlanStaticMemory()`). With more lanes, the intermediate tensors
+// are allocated from the device as usual.
+//
+// The executor is registered as "STATIC_SCHEDULE_EXECUTOR".
+Status NewStaticScheduleExecutor(const LocalExecutorParams& params,
+                                 const Graph& graph, int num_lanes,
+                                 Executor** executor);
+
 // Returns OkStatus() for ops which are compatible with synchronous execution,
 // and otherwise returns an error message appropriate for propagation if needed.
 // If `allow_control_flow_sync_execution` is set to `true` control
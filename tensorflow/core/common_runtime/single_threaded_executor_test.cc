@@ -14,9 +14,11 @@ limitations under the License.
 ==============================================================================*/
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
@@ -25,6 +27,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/single_threaded_executor.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/rendezvous.h"
@@ -40,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -103,8 +108,15 @@ class ExecutorTest : public ::testing::Test {
     params.delete_kernel = [](OpKernel* kernel) {
       DeleteNonCachedKernel(kernel);
     };
-    TF_CHECK_OK(
-        NewExecutor("SINGLE_THREADED_EXECUTOR", params, *graph, &exec_));
+    if (static_schedule_lanes_ > 0) {
+      Executor* executor;
+      TF_CHECK_OK(NewStaticScheduleExecutor(params, *graph,
+                                            static_schedule_lanes_, &executor));
+      exec_.reset(executor);
+    } else {
+      TF_CHECK_OK(
+          NewExecutor("SINGLE_THREADED_EXECUTOR", params, *graph, &exec_));
+    }
     runner_ = [](const std::function<void()>& fn) { fn(); };
     rendez_ = NewLocalRendezvous();
   }
@@ -153,6 +165,9 @@ class ExecutorTest : public ::testing::Test {
   std::unique_ptr<Device> device_;
   std::unique_ptr<Executor> exec_ = nullptr;
   Executor::Args::Runner runner_;
+  // If positive, `Create()` builds a static schedule executor with this many
+  // lanes.
+  int static_schedule_lanes_ = 0;
   Rendezvous* rendez_ = nullptr;
 };
 
@@ -324,6 +339,166 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(retvals[0]));
 }
 
+TEST_F(ExecutorTest, StaticScheduleRandomTree) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  static_schedule_lanes_ = 4;
+  Create(std::move(g));
+  thread::ThreadPool pool(Env::Default(), "static_schedule", 4);
+  runner_ = [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); };
+  // The first step records the kernel costs and the others replay the static
+  // schedule.
+  for (int i = 0; i < 4; ++i) {
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({V(1.0)}));
+    TF_ASSERT_OK(Run(&call_frame));
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    EXPECT_EQ(4096.0, V(retvals[0]));
+  }
+}
+
+TEST_F(ExecutorTest, StaticMemoryPlan) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(256, g.get());
+  // With a single lane, all steps execute the kernels one-at-a-time and replay
+  // the memory plan recorded in the first step.
+  static_schedule_lanes_ = 1;
+  Create(std::move(g));
+  for (int i = 0; i < 4; ++i) {
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({V(i)}));
+    TF_ASSERT_OK(Run(&call_frame));
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    EXPECT_EQ(256.0 * i, V(retvals[0]));
+  }
+}
+
+// Builds arg -> Mock -> Mock -> retval, where each Mock forwards its input
+// and allocates a temporary tensor of 1024 floats.
+std::unique_ptr<Graph> BuildMockChain() {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Node* node = test::graph::Arg(g.get(), 0, DT_FLOAT);
+  for (int i = 0; i < 2; ++i) {
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Mock")
+                    .Input(node)
+                    .Finalize(g.get(), &node));
+  }
+  test::graph::Retval(g.get(), 0, node);
+  FixupSourceAndSinkEdges(g.get());
+  return g;
+}
+
+// The allocator and temporary buffer used by each kernel in a step.
+struct StepAllocations {
+  std::vector<Allocator*> allocators;
+  std::vector<const void*> buffers;
+};
+
+TEST_F(ExecutorTest, StaticMemoryPlanReusesArenaAcrossSteps) {
+  std::vector<StepAllocations> steps;
+  static_schedule_lanes_ = 1;
+  Create(BuildMockChain(), [&steps](OpKernelContext* ctx) {
+    ctx->set_output(0, ctx->input(0));
+    Tensor temp;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, {1024}, &temp));
+    steps.back().allocators.push_back(ctx->get_allocator({}));
+    steps.back().buffers.push_back(temp.tensor_data().data());
+  });
+  for (int i = 0; i < 4; ++i) {
+    steps.emplace_back();
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({V(i)}));
+    TF_ASSERT_OK(Run(&call_frame));
+    ASSERT_EQ(steps.back().buffers.size(), 2);
+  }
+
+  // The first step records its allocations, later steps are served from the
+  // arena of the plan.
+  EXPECT_NE(dynamic_cast<AllocationRecorder*>(steps[0].allocators[0]),
+            nullptr);
+  auto* planned_allocator =
+      dynamic_cast<PlannedStepAllocator*>(steps[1].allocators[0]);
+  ASSERT_NE(planned_allocator, nullptr);
+  EXPECT_EQ(planned_allocator->num_planned_allocations(), 6);
+  for (int i = 1; i < 4; ++i) {
+    EXPECT_EQ(steps[i].allocators[0], planned_allocator);
+    EXPECT_EQ(steps[i].allocators[1], planned_allocator);
+    // Every step reuses the same memory for the temporary tensors, which do
+    // not overlap in time, so they share their offset in the arena.
+    EXPECT_EQ(steps[i].buffers, steps[1].buffers);
+    EXPECT_EQ(steps[i].buffers[0], steps[i].buffers[1]);
+  }
+}
+
+TEST_F(ExecutorTest, NoStaticMemoryPlanWithLanes) {
+  std::vector<StepAllocations> steps;
+  static_schedule_lanes_ = 2;
+  Create(BuildMockChain(), [&steps](OpKernelContext* ctx) {
+    ctx->set_output(0, ctx->input(0));
+    steps.back().allocators.push_back(ctx->get_allocator({}));
+  });
+  for (int i = 0; i < 4; ++i) {
+    steps.emplace_back();
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({V(i)}));
+    TF_ASSERT_OK(Run(&call_frame));
+  }
+  // Neither recorded nor served from an arena.
+  for (const StepAllocations& step : steps) {
+    for (Allocator* allocator : step.allocators) {
+      EXPECT_EQ(allocator, device_->GetAllocator({}));
+    }
+  }
+}
+
+TEST_F(ExecutorTest, StaticScheduleOpError) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in = test::graph::Arg(g.get(), 0, DT_FLOAT);
+  std::vector<Node*> branches;
+  for (int i = 0; i < 8; ++i) {
+    Node* branch = in;
+    for (int j = 0; j < 64; ++j) {
+      branch = test::graph::Identity(g.get(), branch, 0);
+    }
+    branches.push_back(branch);
+  }
+  Node* mock;
+  TF_ASSERT_OK(NodeBuilder(g->NewName("n"), "Mock")
+                   .Input(branches[0])
+                   .Finalize(g.get(), &mock));
+  Node* sum = mock;
+  for (int i = 1; i < branches.size(); ++i) {
+    sum = test::graph::Add(g.get(), sum, branches[i]);
+  }
+  test::graph::Retval(g.get(), 0, sum);
+  FixupSourceAndSinkEdges(g.get());
+  static_schedule_lanes_ = 4;
+  // Succeeds in the first step, which builds the static schedule, and fails in
+  // all later steps.
+  std::atomic<int> num_calls(0);
+  Create(std::move(g), [&](OpKernelContext* ctx) {
+    if (num_calls.fetch_add(1) > 0) {
+      ctx->SetStatus(errors::Internal("Mock error"));
+      return;
+    }
+    ctx->set_output(0, ctx->input(0));
+  });
+  thread::ThreadPool pool(Env::Default(), "static_schedule", 4);
+  runner_ = [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); };
+  {
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({V(1.0)}));
+    TF_ASSERT_OK(Run(&call_frame));
+  }
+  for (int i = 0; i < 2; ++i) {
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({V(1.0)}));
+    EXPECT_TRUE(errors::IsInternal(Run(&call_frame)));
+  }
+}
+
 TEST_F(ExecutorTest, OpError) {
   auto g = std::make_unique<Graph>(OpRegistry::Global());
   auto zero = test::graph::Constant(g.get(), V(0.0));
@@ -0,0 +1,210 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <algorithm>
+
+namespace tensorflow {
+namespace {
+
+size_t RoundUpToAlignment(size_t num_bytes) {
+  return (num_bytes + Allocator::kAllocatorAlignment - 1) /
+         Allocator::kAllocatorAlignment * Allocator::kAllocatorAlignment;
+}
+
+}  // namespace
+
+void* AllocationRecorder::AllocateRaw(size_t alignment, size_t num_bytes) {
+  void* ptr = base_->AllocateRaw(alignment, num_bytes);
+  if (ptr == nullptr) {
+    return nullptr;
+  }
+  Ref();
+  mutex_lock l(mu_);
+  if (recording_) {
+    AllocationRecord record;
+    record.num_bytes = num_bytes;
+    record.alignment = alignment;
+    record.allocation_time = time_++;
+    live_allocations_[ptr] = records_.size();
+    records_.push_back(record);
+  }
+  return ptr;
+}
+
+void AllocationRecorder::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  {
+    mutex_lock l(mu_);
+    auto it = live_allocations_.find(ptr);
+    if (it != live_allocations_.end()) {
+      if (recording_) {
+        records_[it->second].deallocation_time = time_++;
+      }
+      live_allocations_.erase(it);
+    }
+  }
+  base_->DeallocateRaw(ptr);
+  // May delete `this`.
+  Unref();
+}
+
+std::vector<AllocationRecord> AllocationRecorder::StopRecording() {
+  mutex_lock l(mu_);
+  recording_ = false;
+  return std::move(records_);
+}
+
+StaticMemoryPlan PlanStaticMemory(
+    const std::vector<AllocationRecord>& records) {
+  StaticMemoryPlan plan;
+  plan.allocations.reserve(records.size());
+  std::vector<size_t> planned;
+  for (size_t i = 0; i < records.size(); ++i) {
+    const AllocationRecord& record = records[i];
+    plan.allocations.emplace_back(record.num_bytes, -1);
+    if (record.deallocation_time >= 0 && record.num_bytes > 0 &&
+        record.alignment <= Allocator::kAllocatorAlignment) {
+      planned.push_back(i);
+    }
+  }
+  std::stable_sort(planned.begin(), planned.end(), [&](size_t a, size_t b) {
+    return records[a].num_bytes > records[b].num_bytes;
+  });
+
+  // The planned allocations placed so far, in placement order.
+  std::vector<size_t> placed;
+  placed.reserve(planned.size());
+  std::vector<std::pair<int64_t, size_t>> conflicts;
+  for (size_t i : planned) {
+    const AllocationRecord& record = records[i];
+    // Collect the ranges of the placed allocations that are alive at the same
+    // time, sorted by offset.
+    conflicts.clear();
+    for (size_t j : placed) {
+      const AllocationRecord& other = records[j];
+      if (other.allocation_time < record.deallocation_time &&
+          record.allocation_time < other.deallocation_time) {
+        conflicts.emplace_back(plan.allocations[j].second,
+                               RoundUpToAlignment(other.num_bytes));
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end());
+    // Find the lowest offset with a gap large enough for the allocation.
+    const size_t num_bytes = RoundUpToAlignment(record.num_bytes);
+    size_t offset = 0;
+    for (const auto& conflict : conflicts) {
+      if (offset + num_bytes <= conflict.first) {
+        break;
+      }
+      offset = std::max(offset, conflict.first + conflict.second);
+    }
+    plan.allocations[i].second = offset;
+    plan.arena_bytes = std::max(plan.arena_bytes, offset + num_bytes);
+    placed.push_back(i);
+  }
+  return plan;
+}
+
+PlannedStepAllocator::PlannedStepAllocator(Allocator* base,
+                                           StaticMemoryPlan plan)
+    : base_(base), plan_(std::move(plan)) {
+  if (plan_.arena_bytes > 0) {
+    arena_ = static_cast<char*>(
+        base_->AllocateRaw(Allocator::kAllocatorAlignment, plan_.arena_bytes));
+  }
+}
+
+PlannedStepAllocator::~PlannedStepAllocator() {
+  if (arena_ != nullptr) {
+    base_->DeallocateRaw(arena_);
+  }
+}
+
+bool PlannedStepAllocator::StartStep() {
+  mutex_lock l(mu_);
+  if (in_step_ || !live_ranges_.empty()) {
+    return false;
+  }
+  in_step_ = true;
+  matches_plan_ = arena_ != nullptr;
+  next_allocation_ = 0;
+  return true;
+}
+
+void PlannedStepAllocator::EndStep() {
+  mutex_lock l(mu_);
+  in_step_ = false;
+  matches_plan_ = false;
+}
+
+bool PlannedStepAllocator::IsRangeFree(size_t offset, size_t num_bytes) const {
+  auto it = live_ranges_.lower_bound(offset);
+  if (it != live_ranges_.end() && it->first < offset + num_bytes) {
+    return false;
+  }
+  if (it != live_ranges_.begin()) {
+    --it;
+    if (it->first + it->second > offset) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void* PlannedStepAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  {
+    mutex_lock l(mu_);
+    if (matches_plan_) {
+      const size_t i = next_allocation_++;
+      if (i >= plan_.allocations.size() ||
+          plan_.allocations[i].first != num_bytes ||
+          alignment > Allocator::kAllocatorAlignment) {
+        matches_plan_ = false;
+      } else if (plan_.allocations[i].second >= 0 &&
+                 IsRangeFree(plan_.allocations[i].second, num_bytes)) {
+        const size_t offset = plan_.allocations[i].second;
+        live_ranges_[offset] = num_bytes;
+        num_planned_allocations_.fetch_add(1, std::memory_order_relaxed);
+        Ref();
+        return arena_ + offset;
+      }
+    }
+  }
+  void* ptr = base_->AllocateRaw(alignment, num_bytes);
+  if (ptr != nullptr) {
+    Ref();
+  }
+  return ptr;
+}
+
+void PlannedStepAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  char* p = static_cast<char*>(ptr);
+  if (arena_ != nullptr && p >= arena_ && p < arena_ + plan_.arena_bytes) {
+    mutex_lock l(mu_);
+    live_ranges_.erase(p - arena_);
+  } else {
+    base_->DeallocateRaw(ptr);
+  }
+  // May delete `this`.
+  Unref();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,156 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// An allocation made during a recorded step. Times are positions in the
+// sequence of allocations and deallocations of the step.
+struct AllocationRecord {
+  size_t num_bytes = 0;
+  size_t alignment = 0;
+  int64_t allocation_time = 0;
+  // -1 if the allocation was not deallocated before the end of the step.
+  int64_t deallocation_time = -1;
+};
+
+// Forwards allocations to an underlying allocator and records their sizes
+// and lifetimes until `StopRecording()` is called.
+//
+// Holds a reference on itself for each live allocation, so that it may be
+// released while tensors allocated from it are still alive.
+class AllocationRecorder : public Allocator, public core::RefCounted {
+ public:
+  // `base` is not owned and must outlive the allocations.
+  explicit AllocationRecorder(Allocator* base) : base_(base) {}
+
+  std::string Name() override { return base_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Returns the allocations recorded so far, in allocation order. Later
+  // allocations and deallocations are forwarded without being recorded.
+  std::vector<AllocationRecord> StopRecording();
+
+ private:
+  Allocator* const base_;  // Not owned.
+
+  mutex mu_;
+  bool recording_ TF_GUARDED_BY(mu_) = true;
+  int64_t time_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<AllocationRecord> records_ TF_GUARDED_BY(mu_);
+  // Maps live recorded allocations to their index in `records_`.
+  absl::flat_hash_map<void*, size_t> live_allocations_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AllocationRecorder);
+};
+
+// Preassigned offsets in a single arena for the allocations of a step.
+struct StaticMemoryPlan {
+  // The size of the arena.
+  size_t arena_bytes = 0;
+  // For each recorded allocation, in allocation order, its size and its
+  // offset in the arena, or -1 if it is not planned.
+  std::vector<std::pair<size_t, int64_t>> allocations;
+};
+
+// Packs the allocations in `records` into an arena such that allocations
+// with overlapping lifetimes do not overlap, greedily placing the largest
+// allocations first at the lowest offset that fits (as TFLite's arena planner
+// does). Allocations that were not deallocated before the end of the step,
+// are empty or require an alignment larger than
+// `Allocator::kAllocatorAlignment` are not planned.
+StaticMemoryPlan PlanStaticMemory(const std::vector<AllocationRecord>& records);
+
+// An allocator that replays a `StaticMemoryPlan` in every step.
+//
+// Within a step started by `StartStep()`, the `i`th allocation is served from
+// its planned offset in the arena if its size matches the plan and the planned
+// range is not in use. After the first allocation that does not match the
+// plan, and outside of steps, allocations are forwarded to the underlying
+// allocator. This keeps the allocator correct if a step allocates differently
+// from the recorded one, e.g. because a kernel allocates from multiple threads.
+//
+// Holds a reference on itself for each live allocation, so that it may be
+// released while tensors allocated from it are still alive.
+class PlannedStepAllocator : public Allocator, public core::RefCounted {
+ public:
+  // `base` is not owned and must outlive the allocations. The arena is
+  // allocated from `base`.
+  PlannedStepAllocator(Allocator* base, StaticMemoryPlan plan);
+  ~PlannedStepAllocator() override;
+
+  std::string Name() override { return base_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Starts replaying the plan. Returns false if another step is replaying the
+  // plan, or if allocations in the arena from an earlier step are still alive,
+  // in which case the caller should not use this allocator for its step.
+  bool StartStep();
+  void EndStep();
+
+  // Returns the number of allocations served from the arena so far.
+  int64_t num_planned_allocations() const {
+    return num_planned_allocations_.load();
+  }
+
+ private:
+  // Returns true if the range [offset, offset + num_bytes) of the arena is not
+  // used by a live allocation.
+  bool IsRangeFree(size_t offset, size_t num_bytes) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_;  // Not owned.
+  const StaticMemoryPlan plan_;
+  char* arena_ = nullptr;
+  std::atomic<int64_t> num_planned_allocations_{0};
+
+  mutex mu_;
+  bool in_step_ TF_GUARDED_BY(mu_) = false;
+  // Whether the allocations of the current step have matched the plan so far.
+  bool matches_plan_ TF_GUARDED_BY(mu_) = false;
+  size_t next_allocation_ TF_GUARDED_BY(mu_) = 0;
+  // Maps the offsets of live allocations in the arena to their sizes.
+  std::map<size_t, size_t> live_ranges_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PlannedStepAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
@@ -0,0 +1,168 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+
+AllocationRecord Record(size_t num_bytes, int64_t allocation_time,
+                        int64_t deallocation_time) {
+  AllocationRecord record;
+  record.num_bytes = num_bytes;
+  record.alignment = kAlignment;
+  record.allocation_time = allocation_time;
+  record.deallocation_time = deallocation_time;
+  return record;
+}
+
+bool Overlap(const StaticMemoryPlan& plan, int a, int b) {
+  const auto& x = plan.allocations[a];
+  const auto& y = plan.allocations[b];
+  return x.second < y.second + static_cast<int64_t>(y.first) &&
+         y.second < x.second + static_cast<int64_t>(x.first);
+}
+
+TEST(StaticMemoryPlanTest, ReusesMemoryOfDisjointLifetimes) {
+  // a: [0, 3), b: [1, 4), c: [5, 6), d: [2, 7).
+  StaticMemoryPlan plan = PlanStaticMemory(
+      {Record(1024, 0, 3), Record(512, 1, 4), Record(1024, 5, 6),
+       Record(256, 2, 7)});
+  ASSERT_EQ(plan.allocations.size(), 4);
+  EXPECT_FALSE(Overlap(plan, 0, 1));
+  EXPECT_FALSE(Overlap(plan, 0, 3));
+  EXPECT_FALSE(Overlap(plan, 1, 3));
+  EXPECT_FALSE(Overlap(plan, 2, 3));
+  // `c` reuses the memory of `a` or `b`.
+  EXPECT_EQ(plan.arena_bytes, 1024 + 512 + 256);
+  for (const auto& allocation : plan.allocations) {
+    EXPECT_GE(allocation.second, 0);
+    EXPECT_EQ(allocation.second % kAlignment, 0);
+  }
+}
+
+TEST(StaticMemoryPlanTest, EscapingAllocationsAreNotPlanned) {
+  StaticMemoryPlan plan =
+      PlanStaticMemory({Record(1024, 0, -1), Record(0, 1, 2),
+                        Record(64, 3, 4)});
+  ASSERT_EQ(plan.allocations.size(), 3);
+  EXPECT_EQ(plan.allocations[0].second, -1);
+  EXPECT_EQ(plan.allocations[1].second, -1);
+  EXPECT_EQ(plan.allocations[2].second, 0);
+  EXPECT_EQ(plan.arena_bytes, 64);
+}
+
+TEST(AllocationRecorderTest, RecordsLifetimes) {
+  core::RefCountPtr<AllocationRecorder> recorder(
+      new AllocationRecorder(cpu_allocator()));
+  void* a = recorder->AllocateRaw(kAlignment, 100);
+  void* b = recorder->AllocateRaw(kAlignment, 200);
+  recorder->DeallocateRaw(a);
+  void* c = recorder->AllocateRaw(kAlignment, 300);
+  recorder->DeallocateRaw(c);
+  std::vector<AllocationRecord> records = recorder->StopRecording();
+  recorder->DeallocateRaw(b);
+
+  ASSERT_EQ(records.size(), 3);
+  EXPECT_EQ(records[0].num_bytes, 100);
+  EXPECT_EQ(records[0].allocation_time, 0);
+  EXPECT_EQ(records[0].deallocation_time, 2);
+  EXPECT_EQ(records[1].num_bytes, 200);
+  EXPECT_EQ(records[1].deallocation_time, -1);
+  EXPECT_EQ(records[2].num_bytes, 300);
+  EXPECT_EQ(records[2].allocation_time, 3);
+  EXPECT_EQ(records[2].deallocation_time, 4);
+}
+
+// Runs the allocations of a step with two intermediate buffers of `num_bytes`
+// bytes each and one output, which is returned.
+void* RunStep(Allocator* allocator, size_t num_bytes) {
+  void* a = allocator->AllocateRaw(kAlignment, num_bytes);
+  memset(a, 1, num_bytes);
+  void* b = allocator->AllocateRaw(kAlignment, num_bytes);
+  memset(b, 2, num_bytes);
+  allocator->DeallocateRaw(a);
+  void* out = allocator->AllocateRaw(kAlignment, 16);
+  allocator->DeallocateRaw(b);
+  return out;
+}
+
+TEST(PlannedStepAllocatorTest, ReplaysPlan) {
+  core::RefCountPtr<AllocationRecorder> recorder(
+      new AllocationRecorder(cpu_allocator()));
+  void* out = RunStep(recorder.get(), 1024);
+  StaticMemoryPlan plan = PlanStaticMemory(recorder->StopRecording());
+  recorder->DeallocateRaw(out);
+  EXPECT_EQ(plan.arena_bytes, 2048);
+
+  core::RefCountPtr<PlannedStepAllocator> allocator(
+      new PlannedStepAllocator(cpu_allocator(), std::move(plan)));
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(allocator->StartStep());
+    out = RunStep(allocator.get(), 1024);
+    allocator->EndStep();
+    allocator->DeallocateRaw(out);
+  }
+  EXPECT_EQ(allocator->num_planned_allocations(), 6);
+}
+
+TEST(PlannedStepAllocatorTest, FallsBackAfterMismatch) {
+  core::RefCountPtr<AllocationRecorder> recorder(
+      new AllocationRecorder(cpu_allocator()));
+  void* out = RunStep(recorder.get(), 1024);
+  StaticMemoryPlan plan = PlanStaticMemory(recorder->StopRecording());
+  recorder->DeallocateRaw(out);
+
+  core::RefCountPtr<PlannedStepAllocator> allocator(
+      new PlannedStepAllocator(cpu_allocator(), std::move(plan)));
+  ASSERT_TRUE(allocator->StartStep());
+  out = RunStep(allocator.get(), 4096);
+  allocator->EndStep();
+  allocator->DeallocateRaw(out);
+  EXPECT_EQ(allocator->num_planned_allocations(), 0);
+}
+
+TEST(PlannedStepAllocatorTest, DoesNotStartWhileArenaIsInUse) {
+  core::RefCountPtr<AllocationRecorder> recorder(
+      new AllocationRecorder(cpu_allocator()));
+  recorder->DeallocateRaw(recorder->AllocateRaw(kAlignment, 1024));
+  core::RefCountPtr<PlannedStepAllocator> allocator(new PlannedStepAllocator(
+      cpu_allocator(), PlanStaticMemory(recorder->StopRecording())));
+
+  ASSERT_TRUE(allocator->StartStep());
+  EXPECT_FALSE(allocator->StartStep());
+  // The allocation escapes the step.
+  void* escaped = allocator->AllocateRaw(kAlignment, 1024);
+  EXPECT_EQ(allocator->num_planned_allocations(), 1);
+  allocator->EndStep();
+  EXPECT_FALSE(allocator->StartStep());
+
+  // The tensor keeps the arena alive after it is released.
+  PlannedStepAllocator* raw_allocator = allocator.release();
+  raw_allocator->Unref();
+  memset(escaped, 0, 1024);
+  raw_allocator->DeallocateRaw(escaped);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,169 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// Every allocation is preceded by `kHeaderBytes` bytes, the last of which hold
+// its `Header`, so that the returned pointers stay aligned.
+constexpr size_t kHeaderBytes = Allocator::kAllocatorAlignment;
+
+size_t RoundUpToAlignment(size_t num_bytes) {
+  return (num_bytes + Allocator::kAllocatorAlignment - 1) /
+         Allocator::kAllocatorAlignment * Allocator::kAllocatorAlignment;
+}
+
+}  // namespace
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base, size_t chunk_bytes,
+                                       size_t max_allocation_bytes,
+                                       int max_free_chunks)
+    : base_(base),
+      chunk_bytes_(RoundUpToAlignment(chunk_bytes)),
+      max_allocation_bytes_(std::min(max_allocation_bytes, chunk_bytes_)),
+      max_free_chunks_(max_free_chunks) {}
+
+void StepArenaAllocator::Shutdown() {
+  Chunk* current;
+  std::vector<Chunk*> free_chunks;
+  {
+    mutex_lock l(mu_);
+    shutdown_ = true;
+    current = current_;
+    current_ = nullptr;
+    free_chunks.swap(free_chunks_);
+  }
+  for (Chunk* chunk : free_chunks) {
+    FreeChunk(chunk);
+  }
+  if (current != nullptr) {
+    UnrefChunk(current);
+  }
+  VLOG_IF(1, num_chunks_.load() > 0)
+      << "StepArenaAllocator shut down with " << num_chunks_.load()
+      << " chunks with live allocations.";
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (alignment > Allocator::kAllocatorAlignment ||
+      kHeaderBytes + num_bytes > max_allocation_bytes_) {
+    return AllocateFromBase(alignment, num_bytes);
+  }
+  const size_t reserved_bytes = kHeaderBytes + RoundUpToAlignment(num_bytes);
+  Chunk* retired = nullptr;
+  char* ptr;
+  Chunk* chunk;
+  {
+    mutex_lock l(mu_);
+    if (current_ == nullptr || current_->used + reserved_bytes > chunk_bytes_) {
+      Chunk* new_chunk = NewChunk();
+      if (new_chunk == nullptr) {
+        return nullptr;
+      }
+      retired = current_;
+      current_ = new_chunk;
+    }
+    chunk = current_;
+    ptr = chunk->data + chunk->used + kHeaderBytes;
+    chunk->used += reserved_bytes;
+    chunk->num_live.fetch_add(1, std::memory_order_relaxed);
+  }
+  Header* header = reinterpret_cast<Header*>(ptr) - 1;
+  header->chunk = chunk;
+  header->base_ptr = nullptr;
+  if (retired != nullptr) {
+    UnrefChunk(retired);
+  }
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  const Header* header = static_cast<const Header*>(ptr) - 1;
+  if (header->chunk == nullptr) {
+    base_->DeallocateRaw(header->base_ptr);
+    return;
+  }
+  UnrefChunk(header->chunk);
+}
+
+void* StepArenaAllocator::AllocateFromBase(size_t alignment,
+                                           size_t num_bytes) {
+  // Reserve a whole alignment unit for the header so that the returned pointer
+  // keeps the requested alignment.
+  const size_t header_bytes = std::max(alignment, kHeaderBytes);
+  char* base_ptr = static_cast<char*>(
+      base_->AllocateRaw(std::max(alignment, Allocator::kAllocatorAlignment),
+                         header_bytes + num_bytes));
+  if (base_ptr == nullptr) {
+    return nullptr;
+  }
+  char* ptr = base_ptr + header_bytes;
+  Header* header = reinterpret_cast<Header*>(ptr) - 1;
+  header->chunk = nullptr;
+  header->base_ptr = base_ptr;
+  return ptr;
+}
+
+StepArenaAllocator::Chunk* StepArenaAllocator::NewChunk() {
+  if (!free_chunks_.empty()) {
+    Chunk* chunk = free_chunks_.back();
+    free_chunks_.pop_back();
+    return chunk;
+  }
+  void* data = base_->AllocateRaw(Allocator::kAllocatorAlignment, chunk_bytes_);
+  if (data == nullptr) {
+    return nullptr;
+  }
+  num_chunks_.fetch_add(1);
+  Ref();
+  Chunk* chunk = new Chunk;
+  chunk->data = static_cast<char*>(data);
+  return chunk;
+}
+
+void StepArenaAllocator::UnrefChunk(Chunk* chunk) {
+  if (chunk->num_live.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+  // The chunk is no longer the current chunk and has no live allocations.
+  {
+    mutex_lock l(mu_);
+    if (!shutdown_ && free_chunks_.size() < max_free_chunks_) {
+      chunk->used = 0;
+      chunk->num_live.store(1, std::memory_order_relaxed);
+      free_chunks_.push_back(chunk);
+      return;
+    }
+  }
+  FreeChunk(chunk);
+}
+
+void StepArenaAllocator::FreeChunk(Chunk* chunk) {
+  base_->DeallocateRaw(chunk->data);
+  delete chunk;
+  num_chunks_.fetch_sub(1);
+  // May delete `this`.
+  Unref();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,119 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// An allocator for the intermediate tensors of a step, which serves small
+// allocations by bumping a pointer within large chunks obtained from an
+// underlying allocator.
+//
+// Each chunk counts its live allocations. Once a chunk is full and all of its
+// allocations have been deallocated, which for short-lived intermediate tensors
+// usually happens by the end of the step, it is reset and reused, so that
+// steady-state steps rarely call into the underlying allocator. Allocations
+// that outlive the step, e.g. fetched outputs or values assigned to variables,
+// keep their chunk alive until they are deallocated, which makes the arena safe
+// to use for any allocation at the cost of pinning the rest of the chunk.
+//
+// Allocations larger than `max_allocation_bytes` or with an alignment larger
+// than `Allocator::kAllocatorAlignment` are forwarded to the underlying
+// allocator.
+//
+// Each chunk holds a reference on the allocator, so that tensors allocated
+// from it may outlive its owner. The owner must call `Shutdown()` before
+// dropping its reference.
+class StepArenaAllocator : public Allocator, public core::RefCounted {
+ public:
+  static constexpr size_t kDefaultChunkBytes = 1 << 20;
+  static constexpr size_t kDefaultMaxAllocationBytes = 64 << 10;
+  static constexpr int kDefaultMaxFreeChunks = 16;
+
+  // `base` is not owned and must outlive this allocator.
+  explicit StepArenaAllocator(
+      Allocator* base, size_t chunk_bytes = kDefaultChunkBytes,
+      size_t max_allocation_bytes = kDefaultMaxAllocationBytes,
+      int max_free_chunks = kDefaultMaxFreeChunks);
+
+  // Returns the unused chunks to the underlying allocator and stops reusing
+  // chunks. Chunks with live allocations are returned once these have been
+  // deallocated.
+  void Shutdown();
+
+  std::string Name() override { return "step_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Returns the number of chunks allocated from the underlying allocator
+  // that have not been returned to it.
+  int64_t num_chunks() const { return num_chunks_.load(); }
+
+ private:
+  struct Chunk {
+    char* data;
+    size_t used = 0;
+    // The number of live allocations, plus one while the chunk is the current
+    // chunk of the arena.
+    std::atomic<int64_t> num_live{1};
+  };
+
+  // Stored immediately before each returned pointer.
+  struct Header {
+    // The chunk containing the allocation, or nullptr if it was forwarded to
+    // the underlying allocator.
+    Chunk* chunk;
+    // The pointer returned by the underlying allocator for forwarded
+    // allocations.
+    void* base_ptr;
+  };
+
+  void* AllocateFromBase(size_t alignment, size_t num_bytes);
+  Chunk* NewChunk() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Drops a reference on `chunk`, and recycles it if it was the last one.
+  void UnrefChunk(Chunk* chunk);
+  void FreeChunk(Chunk* chunk);
+
+  Allocator* const base_;  // Not owned.
+  const size_t chunk_bytes_;
+  const size_t max_allocation_bytes_;
+  const int max_free_chunks_;
+  std::atomic<int64_t> num_chunks_{0};
+
+  mutex mu_;
+  bool shutdown_ TF_GUARDED_BY(mu_) = false;
+  Chunk* current_ TF_GUARDED_BY(mu_) = nullptr;
+  std::vector<Chunk*> free_chunks_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
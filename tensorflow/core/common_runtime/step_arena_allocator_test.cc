@@ -0,0 +1,124 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kChunkBytes = 4096;
+constexpr size_t kMaxAllocationBytes = 1024;
+constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+
+class StepArenaAllocatorTest : public ::testing::Test {
+ protected:
+  StepArenaAllocatorTest()
+      : allocator_(new StepArenaAllocator(cpu_allocator(), kChunkBytes,
+                                          kMaxAllocationBytes,
+                                          /*max_free_chunks=*/1)) {}
+
+  ~StepArenaAllocatorTest() override {
+    if (allocator_) {
+      allocator_->Shutdown();
+    }
+  }
+
+  core::RefCountPtr<StepArenaAllocator> allocator_;
+};
+
+TEST_F(StepArenaAllocatorTest, AllocationsAreAligned) {
+  std::vector<void*> ptrs;
+  for (size_t num_bytes : {1, 7, 64, 100, 1000}) {
+    void* ptr = allocator_->AllocateRaw(kAlignment, num_bytes);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % kAlignment, 0);
+    memset(ptr, 0xff, num_bytes);
+    ptrs.push_back(ptr);
+  }
+  EXPECT_EQ(allocator_->num_chunks(), 1);
+  for (void* ptr : ptrs) {
+    allocator_->DeallocateRaw(ptr);
+  }
+}
+
+TEST_F(StepArenaAllocatorTest, ReusesChunksOnceAllocationsAreFreed) {
+  // Fill more than one chunk, as a step would.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 16; ++i) {
+    ptrs.push_back(allocator_->AllocateRaw(kAlignment, 512));
+  }
+  const int64_t num_chunks = allocator_->num_chunks();
+  EXPECT_GT(num_chunks, 1);
+  for (void* ptr : ptrs) {
+    allocator_->DeallocateRaw(ptr);
+  }
+  // Later steps reuse the retired chunks instead of allocating new ones.
+  for (int step = 0; step < 4; ++step) {
+    ptrs.clear();
+    for (int i = 0; i < 16; ++i) {
+      ptrs.push_back(allocator_->AllocateRaw(kAlignment, 512));
+    }
+    for (void* ptr : ptrs) {
+      allocator_->DeallocateRaw(ptr);
+    }
+  }
+  EXPECT_LE(allocator_->num_chunks(), num_chunks);
+}
+
+TEST_F(StepArenaAllocatorTest, LargeAllocationsUseBaseAllocator) {
+  void* ptr = allocator_->AllocateRaw(kAlignment, 2 * kChunkBytes);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(allocator_->num_chunks(), 0);
+  memset(ptr, 0xff, 2 * kChunkBytes);
+  allocator_->DeallocateRaw(ptr);
+
+  void* aligned = allocator_->AllocateRaw(4 * kAlignment, 8);
+  ASSERT_NE(aligned, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % (4 * kAlignment), 0);
+  EXPECT_EQ(allocator_->num_chunks(), 0);
+  allocator_->DeallocateRaw(aligned);
+}
+
+TEST_F(StepArenaAllocatorTest, EscapingTensorsOutliveAllocator) {
+  Tensor escaped(allocator_.get(), DT_FLOAT, TensorShape({4}));
+  escaped.flat<float>().setConstant(42.0f);
+  {
+    // Intermediate tensors of the step fill the rest of the chunks.
+    std::vector<Tensor> intermediates;
+    for (int i = 0; i < 32; ++i) {
+      intermediates.emplace_back(allocator_.get(), DT_FLOAT,
+                                 TensorShape({128}));
+      intermediates.back().flat<float>().setZero();
+    }
+  }
+  allocator_->Shutdown();
+  allocator_.reset();
+  // The chunk of `escaped` stays alive until the tensor is destroyed.
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(escaped.flat<float>()(i), 42.0f);
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -44,6 +44,7 @@ info. It does not have any negative impact on performance. */
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 #ifdef INTEL_MKL
@@ -52,6 +53,23 @@ info. It does not have any negative impact on performance. */
 #endif  // INTEL_MKL
 
 namespace tensorflow {
+namespace {
+
+bool UseStepArenaAllocatorFromEnvironment() {
+  static const bool use_step_arena_allocator = [] {
+    bool flag;
+    auto status = ReadBoolFromEnvVar("TF_CPU_STEP_ARENA_ALLOCATOR",
+                                     /*default_val=*/false, &flag);
+    if (!status.ok()) {
+      LOG(ERROR) << "UseStepArenaAllocator: " << status.error_message();
+      return false;
+    }
+    return flag;
+  }();
+  return use_step_arena_allocator;
+}
+
+}  // namespace
 
 ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                    const string& name, Bytes memory_limit,
@@ -61,6 +79,9 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                name, DEVICE_CPU, memory_limit, locality)),
       allocator_(allocator),
       scoped_allocator_mgr_(new ScopedAllocatorMgr(name)) {
+  if (UseStepArenaAllocatorFromEnvironment()) {
+    step_arena_allocator_.reset(new StepArenaAllocator(allocator_));
+  }
   auto s = NodeFileWriter::GetNodeFileWriterIfEnabled(name, env());
   if (!s.ok()) {
     LOG(ERROR) << s.status();
@@ -101,12 +122,20 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
 #endif  // defined(ENABLE_ONEDNN_OPENMP) && defined(INTEL_MKL)
 }
 
-ThreadPoolDevice::~ThreadPoolDevice() {}
+ThreadPoolDevice::~ThreadPoolDevice() {
+  if (step_arena_allocator_) {
+    step_arena_allocator_->Shutdown();
+  }
+}
 
 Allocator* ThreadPoolDevice::GetAllocator(AllocatorAttributes attr) {
   return allocator_;
 }
 
+Allocator* ThreadPoolDevice::GetStepArenaAllocator() {
+  return step_arena_allocator_.get();
+}
+
 Allocator* ThreadPoolDevice::GetScopedAllocator(AllocatorAttributes attr,
                                                 int64_t step_id) {
   if (attr.scope_id > 0) {
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/local_device.h"
 #include "tensorflow/core/common_runtime/node_file_writer.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 
 namespace tensorflow {
 
@@ -31,6 +32,9 @@ class ThreadPoolDevice : public LocalDevice {
   ~ThreadPoolDevice() override;
 
   Allocator* GetAllocator(AllocatorAttributes attr) override;
+  // Returns an arena for the intermediate tensors of steps if the
+  // TF_CPU_STEP_ARENA_ALLOCATOR environment variable is set.
+  Allocator* GetStepArenaAllocator() override;
   Allocator* GetScopedAllocator(AllocatorAttributes attr,
                                 int64_t step_id) override;
   ScopedAllocatorMgr* GetScopedAllocatorMgr() const override {
@@ -55,6 +59,7 @@ class ThreadPoolDevice : public LocalDevice {
 
   Allocator* allocator_;  // Not owned
   std::unique_ptr<ScopedAllocatorMgr> scoped_allocator_mgr_;
+  core::RefCountPtr<StepArenaAllocator> step_arena_allocator_;
   NodeFileWriter* node_file_writer_ = nullptr;  // not owned
 };
 
@@ -38,7 +38,16 @@ class ThreadPoolDeviceFactory : public DeviceFactory {
   Status CreateDevices(const SessionOptions& options, const string& name_prefix,
                        std::vector<std::unique_ptr<Device>>* devices) override {
     int num_numa_nodes = port::NUMANumNodes();
-    int n = 1;
+    const bool use_numa_affinity =
+        options.config.experimental().use_numa_affinity();
+    if (use_numa_affinity && port::NUMAEnabled()) {
+      // Give each device allocations bound to its own NUMA node, so that the
+      // tensors its threads work on are local to them.
+      ProcessState::singleton()->EnableNUMA();
+    }
+    // With NUMA affinity, default to one device, and thus one thread pool
+    // pinned to its node, per NUMA node.
+    int n = use_numa_affinity ? num_numa_nodes : 1;
     auto iter = options.config.device_count().find("CPU");
     if (iter != options.config.device_count().end()) {
       n = iter->second;
@@ -46,7 +55,7 @@ class ThreadPoolDeviceFactory : public DeviceFactory {
     for (int i = 0; i < n; i++) {
       string name = strings::StrCat(name_prefix, "/device:CPU:", i);
       std::unique_ptr<ThreadPoolDevice> tpd;
-      if (options.config.experimental().use_numa_affinity()) {
+      if (use_numa_affinity) {
         int numa_node = i % num_numa_nodes;
         if (numa_node != i) {
           LOG(INFO) << "Only " << num_numa_nodes
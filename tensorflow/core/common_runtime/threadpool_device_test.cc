@@ -15,7 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/threadpool_device.h"
 
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -68,5 +73,39 @@ TEST(ThreadPoolDeviceTest, CopyTensor) {
   device_context->Unref();
 }
 
+std::vector<std::unique_ptr<Device>> CreateCpuDevices(
+    const SessionOptions& options) {
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_CHECK_OK(DeviceFactory::GetFactory("CPU")->CreateDevices(
+      options, "/job:localhost/replica:0/task:0", &devices));
+  return devices;
+}
+
+TEST(ThreadPoolDeviceFactoryTest, OneDeviceWithoutNumaAffinity) {
+  EXPECT_EQ(CreateCpuDevices(SessionOptions()).size(), 1);
+}
+
+TEST(ThreadPoolDeviceFactoryTest, OneDevicePerNumaNode) {
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  std::vector<std::unique_ptr<Device>> devices = CreateCpuDevices(options);
+  ASSERT_EQ(devices.size(), port::NUMANumNodes());
+  for (int i = 0; i < devices.size(); ++i) {
+    EXPECT_EQ(devices[i]->attributes().locality().numa_node(), i);
+  }
+}
+
+TEST(ThreadPoolDeviceFactoryTest, DeviceCountOverridesNumaNodes) {
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  (*options.config.mutable_device_count())["CPU"] = 3;
+  std::vector<std::unique_ptr<Device>> devices = CreateCpuDevices(options);
+  ASSERT_EQ(devices.size(), 3);
+  for (int i = 0; i < devices.size(); ++i) {
+    EXPECT_EQ(devices[i]->attributes().locality().numa_node(),
+              i % port::NUMANumNodes());
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <limits>
 #include <string>
 #include <vector>
@@ -23,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
+#include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/status.h"
@@ -37,9 +41,426 @@ namespace {
 // `UncompressElement` function will determine what to read according to the
 // version.
 constexpr int kCompressedElementVersion = 0;
+// Version of `CompressedElement`s whose components are compressed separately,
+// each with its own codec.
+constexpr int kPerComponentCompressedElementVersion = 1;
+
+// Components smaller than this are always compressed with snappy, since the
+// choice of codec makes little difference for them.
+constexpr size_t kMinAdaptiveCompressionBytes = 4096;
+// Number of leading bytes of a component that are compressed to estimate how
+// well snappy compresses the whole component.
+constexpr size_t kCompressionSampleBytes = 64 * 1024;
+// A component has to shrink to at most this fraction of its size to be worth
+// compressing with snappy.
+constexpr double kMaxSnappyCompressionRatio = 0.9;
+// Delta-varint encoding is used if it shrinks an integer component to at most
+// this fraction of its size.
+constexpr double kMaxDeltaVarintCompressionRatio = 0.25;
+
+bool IsIntegerDataType(DataType dtype) {
+  switch (dtype) {
+    case DT_INT8:
+    case DT_INT16:
+    case DT_INT32:
+    case DT_INT64:
+    case DT_UINT8:
+    case DT_UINT16:
+    case DT_UINT32:
+    case DT_UINT64:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsFloatingPointDataType(DataType dtype) {
+  switch (dtype) {
+    case DT_HALF:
+    case DT_BFLOAT16:
+    case DT_FLOAT:
+    case DT_DOUBLE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+// Calls `fn(value)` with each value of `data`, which holds integers of type
+// `T`, converted to `int64_t`.
+template <typename T, typename Fn>
+void ForEachInteger(StringPiece data, Fn fn) {
+  const size_t n = data.size() / sizeof(T);
+  for (size_t i = 0; i < n; ++i) {
+    T value;
+    std::memcpy(&value, data.data() + i * sizeof(T), sizeof(T));
+    fn(static_cast<int64_t>(value));
+  }
+}
+
+template <typename Fn>
+void ForEachInteger(DataType dtype, StringPiece data, Fn fn) {
+  switch (dtype) {
+    case DT_INT8:
+      return ForEachInteger<int8_t>(data, fn);
+    case DT_INT16:
+      return ForEachInteger<int16_t>(data, fn);
+    case DT_INT32:
+      return ForEachInteger<int32_t>(data, fn);
+    case DT_INT64:
+      return ForEachInteger<int64_t>(data, fn);
+    case DT_UINT8:
+      return ForEachInteger<uint8_t>(data, fn);
+    case DT_UINT16:
+      return ForEachInteger<uint16_t>(data, fn);
+    case DT_UINT32:
+      return ForEachInteger<uint32_t>(data, fn);
+    case DT_UINT64:
+      return ForEachInteger<uint64_t>(data, fn);
+    default:
+      return;
+  }
+}
+
+// Returns the number of bytes delta-varint encoding of `data` takes.
+size_t DeltaVarintLength(DataType dtype, StringPiece data) {
+  size_t length = 0;
+  uint64_t previous = 0;
+  ForEachInteger(dtype, data, [&](int64_t value) {
+    const uint64_t current = static_cast<uint64_t>(value);
+    length += core::VarintLength(
+        ZigZagEncode(static_cast<int64_t>(current - previous)));
+    previous = current;
+  });
+  return length;
+}
+
+class NoneCodec : public ComponentCodec {
+ public:
+  bool Supports(DataType dtype) const override { return true; }
+
+  Status Encode(DataType dtype, StringPiece data,
+                std::string* out) const override {
+    out->append(data.data(), data.size());
+    return OkStatus();
+  }
+
+  Status Decode(DataType dtype, StringPiece encoded, char* out,
+                size_t size) const override {
+    if (encoded.size() != size) {
+      return errors::Internal("Uncompressed size mismatch. Expected ", size,
+                              " bytes but got ", encoded.size());
+    }
+    if (size > 0) {
+      std::memcpy(out, encoded.data(), size);
+    }
+    return OkStatus();
+  }
+};
+
+class SnappyCodec : public ComponentCodec {
+ public:
+  bool Supports(DataType dtype) const override { return true; }
+
+  Status Encode(DataType dtype, StringPiece data,
+                std::string* out) const override {
+    if (data.size() > kuint32max) {
+      return errors::OutOfRange("Encountered dataset component of size ",
+                                data.size(),
+                                ", exceeding the 4GB Snappy limit.");
+    }
+    std::string compressed;
+    if (!port::Snappy_Compress(data.data(), data.size(), &compressed)) {
+      return errors::Internal("Failed to compress using snappy.");
+    }
+    out->append(compressed);
+    return OkStatus();
+  }
+
+  Status Decode(DataType dtype, StringPiece encoded, char* out,
+                size_t size) const override {
+    size_t uncompressed_size;
+    if (!port::Snappy_GetUncompressedLength(encoded.data(), encoded.size(),
+                                            &uncompressed_size)) {
+      return errors::Internal(
+          "Could not get snappy uncompressed length. Compressed data size: ",
+          encoded.size());
+    }
+    if (uncompressed_size != size) {
+      return errors::Internal("Uncompressed size mismatch. Snappy expects ",
+                              uncompressed_size,
+                              " whereas the tensor metadata suggests ", size);
+    }
+    if (!port::Snappy_Uncompress(encoded.data(), encoded.size(), out)) {
+      return errors::Internal("Failed to perform snappy decompression.");
+    }
+    return OkStatus();
+  }
+};
+
+class DeltaVarintCodec : public ComponentCodec {
+ public:
+  bool Supports(DataType dtype) const override {
+    return IsIntegerDataType(dtype);
+  }
+
+  Status Encode(DataType dtype, StringPiece data,
+                std::string* out) const override {
+    const size_t offset = out->size();
+    out->resize(offset + (data.size() / DataTypeSize(dtype)) *
+                             core::kMaxVarint64Bytes);
+    char* pos = &(*out)[offset];
+    uint64_t previous = 0;
+    ForEachInteger(dtype, data, [&](int64_t value) {
+      const uint64_t current = static_cast<uint64_t>(value);
+      pos = core::EncodeVarint64(
+          pos, ZigZagEncode(static_cast<int64_t>(current - previous)));
+      previous = current;
+    });
+    out->resize(pos - out->data());
+    return OkStatus();
+  }
+
+  Status Decode(DataType dtype, StringPiece encoded, char* out,
+                size_t size) const override {
+    switch (dtype) {
+      case DT_INT8:
+        return DecodeIntegers<int8_t>(encoded, out, size);
+      case DT_INT16:
+        return DecodeIntegers<int16_t>(encoded, out, size);
+      case DT_INT32:
+        return DecodeIntegers<int32_t>(encoded, out, size);
+      case DT_INT64:
+        return DecodeIntegers<int64_t>(encoded, out, size);
+      case DT_UINT8:
+        return DecodeIntegers<uint8_t>(encoded, out, size);
+      case DT_UINT16:
+        return DecodeIntegers<uint16_t>(encoded, out, size);
+      case DT_UINT32:
+        return DecodeIntegers<uint32_t>(encoded, out, size);
+      case DT_UINT64:
+        return DecodeIntegers<uint64_t>(encoded, out, size);
+      default:
+        return errors::Internal("Delta-varint decoding does not support ",
+                                DataTypeString(dtype), " tensors.");
+    }
+  }
+
+ private:
+  template <typename T>
+  static Status DecodeIntegers(StringPiece encoded, char* out, size_t size) {
+    const char* pos = encoded.data();
+    const char* limit = encoded.data() + encoded.size();
+    uint64_t previous = 0;
+    for (size_t i = 0; i < size / sizeof(T); ++i) {
+      uint64_t delta;
+      pos = core::GetVarint64Ptr(pos, limit, &delta);
+      if (pos == nullptr) {
+        return errors::Internal("Failed to decode delta-varint data.");
+      }
+      previous += static_cast<uint64_t>(ZigZagDecode(delta));
+      const T value = static_cast<T>(previous);
+      std::memcpy(out + i * sizeof(T), &value, sizeof(T));
+    }
+    if (pos != limit) {
+      return errors::Internal("Unexpected trailing delta-varint data.");
+    }
+    return OkStatus();
+  }
+};
+
+class ShuffleSnappyCodec : public ComponentCodec {
+ public:
+  bool Supports(DataType dtype) const override {
+    return IsFloatingPointDataType(dtype);
+  }
+
+  Status Encode(DataType dtype, StringPiece data,
+                std::string* out) const override {
+    const size_t width = DataTypeSize(dtype);
+    const size_t n = data.size() / width;
+    std::string shuffled(data.size(), '\0');
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t b = 0; b < width; ++b) {
+        shuffled[b * n + i] = data[i * width + b];
+      }
+    }
+    return snappy_.Encode(dtype, shuffled, out);
+  }
+
+  Status Decode(DataType dtype, StringPiece encoded, char* out,
+                size_t size) const override {
+    std::string shuffled(size, '\0');
+    TF_RETURN_IF_ERROR(snappy_.Decode(dtype, encoded, &shuffled[0], size));
+    const size_t width = DataTypeSize(dtype);
+    const size_t n = size / width;
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t b = 0; b < width; ++b) {
+        out[i * width + b] = shuffled[b * n + i];
+      }
+    }
+    return OkStatus();
+  }
+
+ private:
+  const SnappyCodec snappy_;
+};
+
+// Returns the bytes of a non-`memcpy`able `component` as a contiguous buffer,
+// recording the sizes of its pieces in `metadata`.
+std::string NonMemcpyableComponentData(const Tensor& component,
+                                       CompressedComponentMetadata* metadata) {
+  std::string data;
+  if (component.dtype() == DT_STRING) {
+    const auto& flats = component.unaligned_flat<tstring>();
+    size_t total_size = 0;
+    for (int64_t i = 0; i < flats.size(); ++i) {
+      total_size += flats(i).size();
+    }
+    data.reserve(total_size);
+    for (int64_t i = 0; i < flats.size(); ++i) {
+      data.append(flats(i).data(), flats(i).size());
+      metadata->add_uncompressed_bytes(flats(i).size());
+    }
+    return data;
+  }
+  TensorProto proto;
+  component.AsProtoTensorContent(&proto);
+  proto.SerializeToString(&data);
+  metadata->add_uncompressed_bytes(data.size());
+  return data;
+}
+
+// Uncompresses a `CompressedElement` written with per-component codecs.
+Status UncompressComponents(const CompressedElement& compressed,
+                            std::vector<Tensor>* out) {
+  out->clear();
+  out->reserve(compressed.component_metadata_size());
+  StringPiece data = compressed.data();
+  for (const auto& metadata : compressed.component_metadata()) {
+    const ComponentCodec* codec = GetComponentCodec(metadata.codec());
+    if (codec == nullptr || !codec->Supports(metadata.dtype())) {
+      return errors::Internal("Unsupported compression codec ",
+                              CompressionCodec_Name(metadata.codec()), " for ",
+                              DataTypeString(metadata.dtype()), " component.");
+    }
+    if (metadata.compressed_bytes() > data.size()) {
+      return errors::Internal("Compressed component size ",
+                              metadata.compressed_bytes(),
+                              " exceeds the remaining compressed data size ",
+                              data.size());
+    }
+    StringPiece encoded = data.substr(0, metadata.compressed_bytes());
+    data.remove_prefix(metadata.compressed_bytes());
+
+    size_t uncompressed_size = 0;
+    for (uint64_t size : metadata.uncompressed_bytes()) {
+      uncompressed_size += size;
+    }
+    if (DataTypeCanUseMemcpy(metadata.dtype())) {
+      out->emplace_back(metadata.dtype(), metadata.tensor_shape());
+      if (metadata.uncompressed_bytes_size() != 1 ||
+          uncompressed_size != out->back().TotalBytes()) {
+        return errors::Internal("Uncompressed size mismatch for component of ",
+                                "shape ", out->back().shape().DebugString());
+      }
+      TensorBuffer* buffer = DMAHelper::buffer(&out->back());
+      TF_RETURN_IF_ERROR(codec->Decode(
+          metadata.dtype(), encoded,
+          buffer ? static_cast<char*>(buffer->data()) : nullptr,
+          uncompressed_size));
+      continue;
+    }
+
+    std::string uncompressed(uncompressed_size, '\0');
+    TF_RETURN_IF_ERROR(codec->Decode(metadata.dtype(), encoded,
+                                     &uncompressed[0], uncompressed_size));
+    if (metadata.dtype() == DT_STRING) {
+      out->emplace_back(metadata.dtype(), metadata.tensor_shape());
+      const auto& flats = out->back().unaligned_flat<tstring>();
+      if (flats.size() != metadata.uncompressed_bytes_size()) {
+        return errors::Internal("Expected ", flats.size(),
+                                " strings but the metadata describes ",
+                                metadata.uncompressed_bytes_size());
+      }
+      const char* pos = uncompressed.data();
+      for (int i = 0; i < metadata.uncompressed_bytes_size(); ++i) {
+        flats(i).assign(pos, metadata.uncompressed_bytes(i));
+        pos += metadata.uncompressed_bytes(i);
+      }
+      continue;
+    }
+    TensorProto tp;
+    if (!tp.ParseFromString(uncompressed)) {
+      return errors::Internal("Could not parse TensorProto");
+    }
+    out->emplace_back();
+    if (!out->back().FromProto(tp)) {
+      return errors::Internal("Could not parse Tensor");
+    }
+  }
+  if (!data.empty()) {
+    return errors::Internal("Unexpected trailing compressed data of size ",
+                            data.size());
+  }
+  return OkStatus();
+}
 
 }  // namespace
 
+const ComponentCodec* GetComponentCodec(CompressionCodec codec) {
+  static const NoneCodec* none_codec = new NoneCodec();
+  static const SnappyCodec* snappy_codec = new SnappyCodec();
+  static const DeltaVarintCodec* delta_varint_codec = new DeltaVarintCodec();
+  static const ShuffleSnappyCodec* shuffle_snappy_codec =
+      new ShuffleSnappyCodec();
+  switch (codec) {
+    case COMPRESSION_CODEC_NONE:
+      return none_codec;
+    case COMPRESSION_CODEC_SNAPPY:
+      return snappy_codec;
+    case COMPRESSION_CODEC_DELTA_VARINT:
+      return delta_varint_codec;
+    case COMPRESSION_CODEC_SHUFFLE_SNAPPY:
+      return shuffle_snappy_codec;
+    default:
+      return nullptr;
+  }
+}
+
+CompressionCodec SelectCompressionCodec(const Tensor& component) {
+  if (!DataTypeCanUseMemcpy(component.dtype()) ||
+      component.TotalBytes() < kMinAdaptiveCompressionBytes) {
+    return COMPRESSION_CODEC_SNAPPY;
+  }
+  StringPiece data = component.tensor_data();
+  if (IsFloatingPointDataType(component.dtype())) {
+    return COMPRESSION_CODEC_SHUFFLE_SNAPPY;
+  }
+  if (IsIntegerDataType(component.dtype()) &&
+      DeltaVarintLength(component.dtype(), data) <=
+          kMaxDeltaVarintCompressionRatio * data.size()) {
+    return COMPRESSION_CODEC_DELTA_VARINT;
+  }
+  StringPiece sample = data.substr(0, kCompressionSampleBytes);
+  std::string compressed_sample;
+  if (!port::Snappy_Compress(sample.data(), sample.size(),
+                             &compressed_sample) ||
+      compressed_sample.size() > kMaxSnappyCompressionRatio * sample.size()) {
+    return COMPRESSION_CODEC_NONE;
+  }
+  return COMPRESSION_CODEC_SNAPPY;
+}
+
 class Iov {
  public:
   explicit Iov(size_t size) : iov_(size), idx_(0), num_bytes_(0) {}
@@ -137,8 +558,63 @@ Status CompressElement(const std::vector<Tensor>& element,
   return OkStatus();
 }
 
+Status CompressElement(const std::vector<Tensor>& element,
+                       const std::vector<CompressionCodec>& codecs,
+                       CompressedElement* out) {
+  if (codecs.size() != element.size()) {
+    return errors::InvalidArgument("Expected one codec per component, but got ",
+                                   codecs.size(), " codecs for ",
+                                   element.size(), " components.");
+  }
+  std::string* data = out->mutable_data();
+  for (int i = 0; i < element.size(); ++i) {
+    const Tensor& component = element[i];
+    const ComponentCodec* codec = GetComponentCodec(codecs[i]);
+    if (codec == nullptr || !codec->Supports(component.dtype())) {
+      return errors::InvalidArgument(
+          "Compression codec ", CompressionCodec_Name(codecs[i]),
+          " does not support ", DataTypeString(component.dtype()),
+          " components.");
+    }
+    CompressedComponentMetadata* metadata =
+        out->mutable_component_metadata()->Add();
+    metadata->set_dtype(component.dtype());
+    component.shape().AsProto(metadata->mutable_tensor_shape());
+    metadata->set_codec(codecs[i]);
+    const size_t offset = data->size();
+    if (DataTypeCanUseMemcpy(component.dtype())) {
+      StringPiece component_data = component.tensor_data();
+      metadata->add_uncompressed_bytes(component_data.size());
+      TF_RETURN_IF_ERROR(
+          codec->Encode(component.dtype(), component_data, data));
+    } else {
+      TF_RETURN_IF_ERROR(codec->Encode(
+          component.dtype(), NonMemcpyableComponentData(component, metadata),
+          data));
+    }
+    metadata->set_compressed_bytes(data->size() - offset);
+  }
+  out->set_version(kPerComponentCompressedElementVersion);
+  VLOG(3) << "Compressed element with per-component codecs to "
+          << data->size() << " bytes";
+  return OkStatus();
+}
+
+Status CompressElementWithAdaptiveCodecs(const std::vector<Tensor>& element,
+                                         CompressedElement* out) {
+  std::vector<CompressionCodec> codecs;
+  codecs.reserve(element.size());
+  for (const Tensor& component : element) {
+    codecs.push_back(SelectCompressionCodec(component));
+  }
+  return CompressElement(element, codecs, out);
+}
+
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out) {
+  if (compressed.version() == kPerComponentCompressedElementVersion) {
+    return UncompressComponents(compressed, out);
+  }
   if (compressed.version() != kCompressedElementVersion) {
     return errors::Internal("Unsupported compressed element version: ",
                             compressed.version());
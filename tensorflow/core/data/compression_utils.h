@@ -35,10 +35,55 @@ namespace data {
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
+// Compresses each component of `element` separately, using the codec at the
+// same index of `codecs`.
+//
+// Returns an error if `codecs` does not have one codec per component or if a
+// codec does not support the dtype of its component.
+Status CompressElement(const std::vector<Tensor>& element,
+                       const std::vector<CompressionCodec>& codecs,
+                       CompressedElement* out);
+
+// Compresses each component of `element` with the codec chosen for it by
+// `SelectCompressionCodec`.
+Status CompressElementWithAdaptiveCodecs(const std::vector<Tensor>& element,
+                                         CompressedElement* out);
+
 // Uncompresses a `CompressedElement` into a vector of tensor components.
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out);
 
+// Chooses the codec for compressing `component` based on its dtype and a
+// cheap inspection of its contents:
+// - Integer tensors whose consecutive values are close to each other use
+//   delta-varint encoding.
+// - Floating point tensors use byte shuffling followed by snappy.
+// - Tensors whose contents snappy fails to compress meaningfully (e.g. encoded
+//   images) are stored uncompressed, which saves CPU on both ends.
+// - All other tensors use snappy.
+CompressionCodec SelectCompressionCodec(const Tensor& component);
+
+// Encodes and decodes the data of a single element component.
+class ComponentCodec {
+ public:
+  virtual ~ComponentCodec() = default;
+
+  // Returns whether the codec can compress components of type `dtype`.
+  virtual bool Supports(DataType dtype) const = 0;
+
+  // Appends the encoding of `data`, the bytes of a component of type `dtype`,
+  // to `out`.
+  virtual Status Encode(DataType dtype, StringPiece data,
+                        std::string* out) const = 0;
+
+  // Decodes `encoded` into the `size` bytes pointed to by `out`.
+  virtual Status Decode(DataType dtype, StringPiece encoded, char* out,
+                        size_t size) const = 0;
+};
+
+// Returns the implementation of `codec`, or nullptr if there is none.
+const ComponentCodec* GetComponentCodec(CompressionCodec codec);
+
 }  // namespace data
 }  // namespace tensorflow
 
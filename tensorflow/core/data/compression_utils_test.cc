@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -104,9 +105,116 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
               StatusIs(error::INTERNAL));
 }
 
+TEST_P(ParameterizedCompressionUtilsTest, AdaptiveCodecsRoundTrip) {
+  std::vector<Tensor> element = GetParam();
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElementWithAdaptiveCodecs(element, &compressed));
+  EXPECT_EQ(1, compressed.version());
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
+// Returns sorted ids with small gaps, as produced by sparse feature lookups.
+Tensor SortedIds(int64_t n) {
+  Tensor ids = CreateTensor<int64_t>(TensorShape{n});
+  for (int64_t i = 0; i < n; ++i) {
+    ids.flat<int64_t>()(i) = 1000000 + 3 * i + i % 2;
+  }
+  return ids;
+}
+
+// Returns `n` pseudo-random bytes, which snappy cannot compress.
+Tensor RandomBytes(int64_t n) {
+  Tensor bytes = CreateTensor<uint8>(TensorShape{n});
+  uint64_t state = 42;
+  for (int64_t i = 0; i < n; ++i) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    bytes.flat<uint8>()(i) = static_cast<uint8>(state >> 56);
+  }
+  return bytes;
+}
+
+Tensor Floats(int64_t n) {
+  Tensor floats = CreateTensor<float>(TensorShape{n});
+  for (int64_t i = 0; i < n; ++i) {
+    floats.flat<float>()(i) = 0.5f * i;
+  }
+  return floats;
+}
+
+TEST(CompressionUtilsTest, SelectCompressionCodec) {
+  EXPECT_EQ(SelectCompressionCodec(SortedIds(4096)),
+            COMPRESSION_CODEC_DELTA_VARINT);
+  EXPECT_EQ(SelectCompressionCodec(RandomBytes(1 << 16)),
+            COMPRESSION_CODEC_NONE);
+  EXPECT_EQ(SelectCompressionCodec(Floats(4096)),
+            COMPRESSION_CODEC_SHUFFLE_SNAPPY);
+  EXPECT_EQ(SelectCompressionCodec(SortedIds(16)), COMPRESSION_CODEC_SNAPPY);
+  EXPECT_EQ(SelectCompressionCodec(
+                CreateTensor<tstring>(TensorShape{2}, {"abc", "xyz"})),
+            COMPRESSION_CODEC_SNAPPY);
+}
+
+TEST(CompressionUtilsTest, PerComponentCodecsRoundTrip) {
+  std::vector<Tensor> element = {
+      SortedIds(4096),
+      CreateTensor<int32>(TensorShape{4}, {-5, 7, -(1 << 30), 1 << 30}),
+      CreateTensor<uint64>(TensorShape{2}, {0, ~0ull}),
+      RandomBytes(1000),
+      Floats(1000),
+      CreateTensor<double>(TensorShape{3}, {1.5, -2.25, 1e300}),
+      CreateTensor<tstring>(TensorShape{3}, {"abc", "", "xyz"}),
+      CreateTensor<int64_t>(TensorShape{0})};
+  std::vector<CompressionCodec> codecs = {
+      COMPRESSION_CODEC_DELTA_VARINT, COMPRESSION_CODEC_DELTA_VARINT,
+      COMPRESSION_CODEC_DELTA_VARINT, COMPRESSION_CODEC_NONE,
+      COMPRESSION_CODEC_SHUFFLE_SNAPPY, COMPRESSION_CODEC_SHUFFLE_SNAPPY,
+      COMPRESSION_CODEC_NONE, COMPRESSION_CODEC_SNAPPY};
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, codecs, &compressed));
+  ASSERT_EQ(compressed.component_metadata_size(), element.size());
+  for (int i = 0; i < codecs.size(); ++i) {
+    EXPECT_EQ(compressed.component_metadata(i).codec(), codecs[i]);
+  }
+  // Delta-varint encodes each small gap in a single byte.
+  EXPECT_LT(compressed.component_metadata(0).compressed_bytes(), 4096 + 16);
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(element, round_trip_element,
+                                               /*compare_order=*/true));
+}
+
+TEST(CompressionUtilsTest, UnsupportedCodec) {
+  std::vector<Tensor> element = {Floats(4)};
+  CompressedElement compressed;
+  EXPECT_THAT(
+      CompressElement(element, {COMPRESSION_CODEC_DELTA_VARINT}, &compressed),
+      StatusIs(error::INVALID_ARGUMENT, HasSubstr("does not support")));
+}
+
+TEST(CompressionUtilsTest, WrongNumberOfCodecs) {
+  std::vector<Tensor> element = {Floats(4), Floats(4)};
+  CompressedElement compressed;
+  EXPECT_THAT(CompressElement(element, {COMPRESSION_CODEC_NONE}, &compressed),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(CompressionUtilsTest, TruncatedPerComponentData) {
+  std::vector<Tensor> element = {SortedIds(100)};
+  CompressedElement compressed;
+  TF_ASSERT_OK(
+      CompressElement(element, {COMPRESSION_CODEC_DELTA_VARINT}, &compressed));
+  compressed.mutable_data()->resize(compressed.data().size() - 1);
+  std::vector<Tensor> round_trip_element;
+  EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
+              StatusIs(error::INTERNAL));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
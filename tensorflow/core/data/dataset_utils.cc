@@ -884,6 +884,11 @@ bool ShouldUsePrivateThreadPool(const Options& options) {
          ThreadingOptions::kPrivateThreadpoolSize;
 }
 
+bool ShouldPinToNumaNode(const Options& options) {
+  return options.threading_options().optional_numa_node_case() ==
+         ThreadingOptions::kNumaNode;
+}
+
 bool ShouldUseAutotuning(const Options& options) {
   return options.autotune_options().optional_enabled_case() !=
              AutotuneOptions::kEnabled ||
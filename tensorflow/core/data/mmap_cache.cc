@@ -0,0 +1,326 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/mmap_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/raw_coding.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kCacheFileSuffix[] = ".mmap_cache";
+constexpr char kTempFileInfix[] = ".tmp.";
+constexpr uint64_t kMagic = 0x31434d4d41544644ull;  // "DFTAMMC1"
+// index_offset, index_length, num_elements, num_components, magic.
+constexpr size_t kFooterSize = 5 * sizeof(uint64_t);
+// dtype, serialized and rank, offset and length, each at least one byte.
+constexpr uint64_t kMinIndexEntrySize = 5;
+constexpr char kZeros[Allocator::kAllocatorAlignment] = {};
+
+// A tensor buffer that aliases a range of a memory-mapped cache file. Holds a
+// reference to the mapping so the pages stay valid while the tensor is alive.
+class MmapTensorBuffer : public TensorBuffer {
+ public:
+  MmapTensorBuffer(std::shared_ptr<const ReadOnlyMemoryRegion> region,
+                   uint64_t offset, uint64_t length)
+      : TensorBuffer(const_cast<char*>(
+            static_cast<const char*>(region->data()) + offset)),
+        region_(std::move(region)),
+        length_(length) {}
+
+  size_t size() const override { return length_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64_t>(length_));
+    proto->set_allocator_name("MmapCache");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<const ReadOnlyMemoryRegion> region_;
+  const uint64_t length_;
+};
+
+}  // namespace
+
+std::string MmapCacheFilename(const std::string& directory,
+                              uint64_t fingerprint) {
+  return io::JoinPath(directory,
+                      strings::StrCat(fingerprint, kCacheFileSuffix));
+}
+
+StatusOr<std::unique_ptr<MmapCacheWriter>> MmapCacheWriter::Create(
+    Env* env, const std::string& filename, int64_t num_components) {
+  TF_RETURN_IF_ERROR(
+      env->RecursivelyCreateDir(std::string(io::Dirname(filename))));
+  std::string tmp_filename = strings::StrCat(
+      filename, kTempFileInfix, env->NowMicros(), "_", random::New64());
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(tmp_filename, &file));
+  return absl::WrapUnique(new MmapCacheWriter(env, filename,
+                                              std::move(tmp_filename),
+                                              num_components, std::move(file)));
+}
+
+MmapCacheWriter::MmapCacheWriter(Env* env, std::string filename,
+                                 std::string tmp_filename,
+                                 int64_t num_components,
+                                 std::unique_ptr<WritableFile> file)
+    : env_(env),
+      filename_(std::move(filename)),
+      tmp_filename_(std::move(tmp_filename)),
+      num_components_(num_components),
+      file_(std::move(file)) {}
+
+MmapCacheWriter::~MmapCacheWriter() {
+  if (finalized_) {
+    return;
+  }
+  file_.reset();
+  Status s = env_->DeleteFile(tmp_filename_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete incomplete cache file " << tmp_filename_
+                 << ": " << s;
+  }
+}
+
+Status MmapCacheWriter::Append(StringPiece data) {
+  TF_RETURN_IF_ERROR(file_->Append(data));
+  offset_ += data.size();
+  return OkStatus();
+}
+
+Status MmapCacheWriter::Align() {
+  const uint64_t remainder = offset_ % Allocator::kAllocatorAlignment;
+  if (remainder == 0) {
+    return OkStatus();
+  }
+  return Append(
+      StringPiece(kZeros, Allocator::kAllocatorAlignment - remainder));
+}
+
+Status MmapCacheWriter::Write(const std::vector<Tensor>& element) {
+  if (finalized_) {
+    return errors::FailedPrecondition("Cache ", filename_,
+                                      " has already been finalized.");
+  }
+  if (element.size() != num_components_) {
+    return errors::InvalidArgument("Expected an element with ", num_components_,
+                                   " components but got ", element.size(),
+                                   ".");
+  }
+  for (const Tensor& tensor : element) {
+    TF_RETURN_IF_ERROR(Align());
+    MmapCacheComponent component;
+    component.dtype = tensor.dtype();
+    component.shape = tensor.shape();
+    component.offset = offset_;
+    component.serialized = !DataTypeCanUseMemcpy(tensor.dtype());
+    if (component.serialized) {
+      TensorProto proto;
+      tensor.AsProtoTensorContent(&proto);
+      std::string serialized;
+      if (!proto.SerializeToString(&serialized)) {
+        return errors::Internal("Failed to serialize tensor of type ",
+                                DataTypeString(tensor.dtype()),
+                                " for the cache.");
+      }
+      TF_RETURN_IF_ERROR(Append(serialized));
+      component.length = serialized.size();
+    } else {
+      StringPiece data = tensor.tensor_data();
+      TF_RETURN_IF_ERROR(Append(data));
+      component.length = data.size();
+    }
+    index_.push_back(std::move(component));
+  }
+  ++num_elements_;
+  return OkStatus();
+}
+
+Status MmapCacheWriter::Finalize() {
+  if (finalized_) {
+    return errors::FailedPrecondition("Cache ", filename_,
+                                      " has already been finalized.");
+  }
+  TF_RETURN_IF_ERROR(Align());
+  std::string index;
+  for (const MmapCacheComponent& component : index_) {
+    core::PutVarint32(&index, component.dtype);
+    core::PutVarint32(&index, component.serialized ? 1 : 0);
+    core::PutVarint32(&index, component.shape.dims());
+    for (int64_t dim : component.shape.dim_sizes()) {
+      core::PutVarint64(&index, dim);
+    }
+    core::PutVarint64(&index, component.offset);
+    core::PutVarint64(&index, component.length);
+  }
+  const uint64_t index_offset = offset_;
+  TF_RETURN_IF_ERROR(Append(index));
+  std::string footer;
+  core::PutFixed64(&footer, index_offset);
+  core::PutFixed64(&footer, index.size());
+  core::PutFixed64(&footer, num_elements_);
+  core::PutFixed64(&footer, num_components_);
+  core::PutFixed64(&footer, kMagic);
+  TF_RETURN_IF_ERROR(Append(footer));
+  TF_RETURN_IF_ERROR(file_->Close());
+  file_.reset();
+  // The rename is atomic, so readers never observe a partially written cache.
+  // If another writer published the same cache concurrently, its contents are
+  // identical and replacing it is harmless: existing mappings keep referring
+  // to the replaced file.
+  TF_RETURN_IF_ERROR(env_->RenameFile(tmp_filename_, filename_));
+  finalized_ = true;
+  index_.clear();
+  return OkStatus();
+}
+
+StatusOr<std::unique_ptr<MmapCacheReader>> MmapCacheReader::Open(
+    Env* env, const std::string& filename) {
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_RETURN_IF_ERROR(env->NewReadOnlyMemoryRegionFromFile(filename, &region));
+  const char* data = static_cast<const char*>(region->data());
+  const uint64_t length = region->length();
+  if (length < kFooterSize ||
+      core::DecodeFixed64(data + length - sizeof(uint64_t)) != kMagic) {
+    return errors::DataLoss("File ", filename, " is not a valid cache file.");
+  }
+  const char* footer = data + length - kFooterSize;
+  const uint64_t index_offset = core::DecodeFixed64(footer);
+  const uint64_t index_length = core::DecodeFixed64(footer + 8);
+  const int64_t num_elements = core::DecodeFixed64(footer + 16);
+  const int64_t num_components = core::DecodeFixed64(footer + 24);
+  if (index_offset > length - kFooterSize ||
+      index_length != length - kFooterSize - index_offset) {
+    return errors::DataLoss("Cache file ", filename,
+                            " has a corrupted footer.");
+  }
+  // The index must be large enough for the number of components in the
+  // footer, which bounds the memory reserved for it by the file size.
+  if (num_elements < 0 || num_components < 0 ||
+      (num_components > 0 &&
+       static_cast<uint64_t>(num_elements) >
+           index_length / kMinIndexEntrySize / num_components)) {
+    return errors::DataLoss("Cache file ", filename,
+                            " has a corrupted footer.");
+  }
+
+  std::vector<MmapCacheComponent> index;
+  index.reserve(num_elements * num_components);
+  StringPiece input(data + index_offset, index_length);
+  for (int64_t i = 0; i < num_elements * num_components; ++i) {
+    MmapCacheComponent component;
+    uint32 dtype, serialized, rank;
+    if (!core::GetVarint32(&input, &dtype) ||
+        !core::GetVarint32(&input, &serialized) ||
+        !core::GetVarint32(&input, &rank)) {
+      return errors::DataLoss("Cache file ", filename,
+                              " has a corrupted index.");
+    }
+    std::vector<int64_t> dims(rank);
+    for (uint32 d = 0; d < rank; ++d) {
+      uint64 dim;
+      if (!core::GetVarint64(&input, &dim)) {
+        return errors::DataLoss("Cache file ", filename,
+                                " has a corrupted index.");
+      }
+      dims[d] = dim;
+    }
+    uint64 offset, component_length;
+    if (!core::GetVarint64(&input, &offset) ||
+        !core::GetVarint64(&input, &component_length) ||
+        offset + component_length > index_offset) {
+      return errors::DataLoss("Cache file ", filename,
+                              " has a corrupted index.");
+    }
+    TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(dims, &component.shape));
+    component.dtype = static_cast<DataType>(dtype);
+    component.serialized = serialized != 0;
+    component.offset = offset;
+    component.length = component_length;
+    index.push_back(std::move(component));
+  }
+  return absl::WrapUnique(new MmapCacheReader(std::move(region), num_elements,
+                                              num_components,
+                                              std::move(index)));
+}
+
+MmapCacheReader::MmapCacheReader(
+    std::shared_ptr<const ReadOnlyMemoryRegion> region, int64_t num_elements,
+    int64_t num_components, std::vector<MmapCacheComponent> index)
+    : region_(std::move(region)),
+      num_elements_(num_elements),
+      num_components_(num_components),
+      index_(std::move(index)) {}
+
+Status MmapCacheReader::Get(int64_t index, std::vector<Tensor>* out) const {
+  if (index < 0 || index >= num_elements_) {
+    return errors::OutOfRange("Index out of range [0, ", num_elements_,
+                              "): ", index);
+  }
+  out->clear();
+  out->reserve(num_components_);
+  const char* data = static_cast<const char*>(region_->data());
+  for (int64_t i = 0; i < num_components_; ++i) {
+    const MmapCacheComponent& component = index_[index * num_components_ + i];
+    if (component.serialized) {
+      TensorProto proto;
+      if (!proto.ParseFromArray(data + component.offset, component.length)) {
+        return errors::DataLoss("Failed to parse cached tensor at offset ",
+                                component.offset, ".");
+      }
+      Tensor tensor;
+      if (!tensor.FromProto(proto)) {
+        return errors::DataLoss("Failed to restore cached tensor at offset ",
+                                component.offset, ".");
+      }
+      out->push_back(std::move(tensor));
+      continue;
+    }
+    if (component.length !=
+        component.shape.num_elements() * DataTypeSize(component.dtype)) {
+      return errors::DataLoss("Cached tensor at offset ", component.offset,
+                              " has an unexpected size.");
+    }
+    core::RefCountPtr<TensorBuffer> buffer(
+        new MmapTensorBuffer(region_, component.offset, component.length));
+    out->emplace_back(component.dtype, component.shape, std::move(buffer));
+  }
+  return OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,133 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_MMAP_CACHE_H_
+#define TENSORFLOW_CORE_DATA_MMAP_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+
+// Returns the path of the memory-mapped cache file for a dataset with the
+// given fingerprint inside `directory`.
+std::string MmapCacheFilename(const std::string& directory,
+                              uint64_t fingerprint);
+
+// Location and metadata of a single element component inside a cache file.
+struct MmapCacheComponent {
+  DataType dtype;
+  TensorShape shape;
+  uint64_t offset;
+  uint64_t length;
+  // Whether the component is stored as a serialized `TensorProto` rather than
+  // as raw tensor bytes.
+  bool serialized;
+};
+
+// Writes dataset elements into a single arena file whose layout allows the
+// tensor contents to be memory-mapped and aliased without copying.
+//
+// Elements are written to a temporary file which is atomically renamed to
+// `filename` by `Finalize()`, so that concurrent readers (possibly in other
+// processes) only ever observe complete caches. If the writer is destroyed
+// before `Finalize()` is called, the temporary file is deleted.
+//
+// The file consists of the tensor contents, each aligned to
+// `Allocator::kAllocatorAlignment`, followed by an index and a fixed-size
+// footer. Components whose dtype can be memcpy-ed are stored as raw bytes;
+// all other components are stored as serialized `TensorProto`s.
+class MmapCacheWriter {
+ public:
+  // Creates a writer for elements with `num_components` components.
+  static StatusOr<std::unique_ptr<MmapCacheWriter>> Create(
+      Env* env, const std::string& filename, int64_t num_components);
+
+  ~MmapCacheWriter();
+
+  // Appends `element` to the cache.
+  Status Write(const std::vector<Tensor>& element);
+
+  // Writes the index and publishes the cache at its final location.
+  Status Finalize();
+
+  // Returns the number of elements written so far.
+  int64_t num_elements() const { return num_elements_; }
+
+ private:
+  MmapCacheWriter(Env* env, std::string filename, std::string tmp_filename,
+                  int64_t num_components, std::unique_ptr<WritableFile> file);
+
+  Status Append(StringPiece data);
+  Status Align();
+
+  Env* const env_;
+  const std::string filename_;
+  const std::string tmp_filename_;
+  const int64_t num_components_;
+  std::unique_ptr<WritableFile> file_;
+  uint64_t offset_ = 0;
+  int64_t num_elements_ = 0;
+  bool finalized_ = false;
+  std::vector<MmapCacheComponent> index_;
+};
+
+// Reads the elements of a cache written by `MmapCacheWriter`.
+//
+// The cache file is memory-mapped once and the returned tensors for
+// memcpy-able dtypes alias the mapped pages. The mapping remains valid for as
+// long as either the reader or any of the returned tensors are alive.
+class MmapCacheReader {
+ public:
+  // Opens the cache at `filename`. Returns `NotFound` if the cache does not
+  // exist and `DataLoss` if the file is not a valid cache.
+  static StatusOr<std::unique_ptr<MmapCacheReader>> Open(
+      Env* env, const std::string& filename);
+
+  // Returns the number of elements in the cache.
+  int64_t size() const { return num_elements_; }
+
+  // Returns the number of components of each element.
+  int64_t num_components() const { return num_components_; }
+
+  // Returns the number of bytes of the mapped file.
+  uint64_t bytes() const { return region_->length(); }
+
+  // Reads the element at `index`.
+  Status Get(int64_t index, std::vector<Tensor>* out) const;
+
+ private:
+  MmapCacheReader(std::shared_ptr<const ReadOnlyMemoryRegion> region,
+                  int64_t num_elements, int64_t num_components,
+                  std::vector<MmapCacheComponent> index);
+
+  const std::shared_ptr<const ReadOnlyMemoryRegion> region_;
+  const int64_t num_elements_;
+  const int64_t num_components_;
+  const std::vector<MmapCacheComponent> index_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_MMAP_CACHE_H_
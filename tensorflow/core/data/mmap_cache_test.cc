@@ -0,0 +1,175 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/mmap_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/tsl/platform/status_matchers.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tsl::testing::StatusIs;
+
+std::string TestFilename(const std::string& name) {
+  return MmapCacheFilename(io::JoinPath(testing::TmpDir(), name),
+                           /*fingerprint=*/1234);
+}
+
+TEST(MmapCacheTest, RoundTrip) {
+  const std::string filename = TestFilename("round_trip");
+  std::vector<std::vector<Tensor>> elements = {
+      {CreateTensor<int64_t>(TensorShape{3}, {1, 2, 3}),
+       CreateTensor<tstring>(TensorShape{2}, {"a", "bc"})},
+      {CreateTensor<int64_t>(TensorShape{0}),
+       CreateTensor<tstring>(TensorShape{}, {"xyz"})},
+      {CreateTensor<int64_t>(TensorShape{2, 2}, {4, 5, 6, 7}),
+       CreateTensor<tstring>(TensorShape{1}, {""})},
+  };
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<MmapCacheWriter> writer,
+      MmapCacheWriter::Create(Env::Default(), filename, /*num_components=*/2));
+  for (const auto& element : elements) {
+    TF_ASSERT_OK(writer->Write(element));
+  }
+  EXPECT_EQ(writer->num_elements(), elements.size());
+  TF_ASSERT_OK(writer->Finalize());
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<MmapCacheReader> reader,
+                          MmapCacheReader::Open(Env::Default(), filename));
+  ASSERT_EQ(reader->size(), elements.size());
+  EXPECT_EQ(reader->num_components(), 2);
+  for (int64_t i = 0; i < elements.size(); ++i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(reader->Get(i, &element));
+    ASSERT_EQ(element.size(), 2);
+    test::ExpectEqual(element[0], elements[i][0]);
+    test::ExpectEqual(element[1], elements[i][1]);
+  }
+}
+
+TEST(MmapCacheTest, TensorsAliasMappedFile) {
+  const std::string filename = TestFilename("alias");
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<MmapCacheWriter> writer,
+      MmapCacheWriter::Create(Env::Default(), filename, /*num_components=*/1));
+  TF_ASSERT_OK(writer->Write({CreateTensor<int32>(TensorShape{3}, {1, 2, 3})}));
+  TF_ASSERT_OK(writer->Write({CreateTensor<float>(TensorShape{2}, {.5, .25})}));
+  TF_ASSERT_OK(writer->Finalize());
+
+  std::vector<Tensor> element;
+  {
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<MmapCacheReader> reader,
+                            MmapCacheReader::Open(Env::Default(), filename));
+    TF_ASSERT_OK(reader->Get(1, &element));
+    ASSERT_EQ(element.size(), 1);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(element[0].tensor_data().data()) %
+                  Allocator::kAllocatorAlignment,
+              0);
+  }
+  // The tensor keeps the mapping alive after the reader is destroyed.
+  test::ExpectEqual(element[0], CreateTensor<float>(TensorShape{2}, {.5, .25}));
+}
+
+TEST(MmapCacheTest, UnfinalizedCacheIsNotPublished) {
+  const std::string filename = TestFilename("unfinalized");
+  {
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<MmapCacheWriter> writer,
+                            MmapCacheWriter::Create(Env::Default(), filename,
+                                                    /*num_components=*/1));
+    TF_ASSERT_OK(writer->Write({CreateTensor<int64_t>(TensorShape{}, {1})}));
+  }
+  EXPECT_THAT(MmapCacheReader::Open(Env::Default(), filename).status(),
+              StatusIs(error::NOT_FOUND));
+  std::vector<std::string> children;
+  TF_ASSERT_OK(
+      Env::Default()->GetChildren(io::Dirname(filename).data(), &children));
+  EXPECT_TRUE(children.empty());
+}
+
+TEST(MmapCacheTest, WrongNumberOfComponents) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<MmapCacheWriter> writer,
+      MmapCacheWriter::Create(Env::Default(), TestFilename("components"),
+                              /*num_components=*/2));
+  EXPECT_THAT(writer->Write({CreateTensor<int64_t>(TensorShape{}, {1})}),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(MmapCacheTest, InvalidFile) {
+  const std::string filename = TestFilename("invalid");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(
+      std::string(io::Dirname(filename))));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 "definitely not a cache file"));
+  EXPECT_THAT(MmapCacheReader::Open(Env::Default(), filename).status(),
+              StatusIs(error::DATA_LOSS));
+}
+
+TEST(MmapCacheTest, IndexOutOfRange) {
+  const std::string filename = TestFilename("out_of_range");
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<MmapCacheWriter> writer,
+      MmapCacheWriter::Create(Env::Default(), filename, /*num_components=*/1));
+  TF_ASSERT_OK(writer->Write({CreateTensor<int64_t>(TensorShape{}, {1})}));
+  TF_ASSERT_OK(writer->Finalize());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<MmapCacheReader> reader,
+                          MmapCacheReader::Open(Env::Default(), filename));
+  std::vector<Tensor> element;
+  EXPECT_THAT(reader->Get(1, &element), StatusIs(error::OUT_OF_RANGE));
+}
+
+// Overwrites the `i`-th 64-bit field of the footer of the cache file.
+void OverwriteFooterField(const std::string& filename, int i, uint64_t value) {
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  ASSERT_GE(contents.size(), 5 * sizeof(uint64_t));
+  const size_t field_offset = contents.size() - (5 - i) * sizeof(uint64_t);
+  for (size_t b = 0; b < sizeof(uint64_t); ++b) {
+    contents[field_offset + b] = static_cast<char>(value >> (8 * b));
+  }
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+}
+
+TEST(MmapCacheTest, CorruptedElementCount) {
+  for (uint64_t num_elements : {uint64_t{1} << 40, ~uint64_t{0}}) {
+    const std::string filename = TestFilename("corrupted_count");
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<MmapCacheWriter> writer,
+                            MmapCacheWriter::Create(Env::Default(), filename,
+                                                    /*num_components=*/2));
+    TF_ASSERT_OK(writer->Write({CreateTensor<int64_t>(TensorShape{}, {1}),
+                                CreateTensor<int64_t>(TensorShape{}, {2})}));
+    TF_ASSERT_OK(writer->Finalize());
+    // The index holds a single element, so a larger count is rejected before
+    // any memory is reserved for it.
+    OverwriteFooterField(filename, /*i=*/2, num_elements);
+    EXPECT_THAT(MmapCacheReader::Open(Env::Default(), filename).status(),
+                StatusIs(error::DATA_LOSS));
+  }
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
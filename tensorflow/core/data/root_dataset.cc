@@ -16,16 +16,26 @@ limitations under the License.
 #include "tensorflow/core/data/root_dataset.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <functional>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/memory/memory.h"
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/model.pb.h"
+#include "tensorflow/core/framework/thread_factory.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/stringprintf.h"
 
@@ -45,6 +55,54 @@ constexpr char kPrivateThreadpoolSize[] = "threadpool_size";
 constexpr char kRamBudget[] = "ram_budget_megabytes";
 constexpr char kRamUsage[] = "ram_usage_megabytes";
 constexpr char kMaxBufferBytes[] = "max_buffered_megabytes";
+constexpr char kNumaNode[] = "numa_node";
+
+// Environment variable that overrides the directory in which the `WARM_START`
+// autotuning algorithm persists model profiles.
+constexpr char kWarmStartProfileDirEnvVar[] = "TF_DATA_AUTOTUNE_PROFILE_DIR";
+constexpr char kWarmStartProfileDir[] = "tf_data_autotune_profiles";
+constexpr char kWarmStartProfileSuffix[] = ".model_profile";
+
+// Returns the directory in which model profiles are persisted.
+std::string WarmStartProfileDir() {
+  const char* dir = std::getenv(kWarmStartProfileDirEnvVar);
+  if (dir != nullptr && *dir != '\0') {
+    return dir;
+  }
+  std::vector<string> tmp_dirs;
+  Env::Default()->GetLocalTempDirectories(&tmp_dirs);
+  return io::JoinPath(tmp_dirs.empty() ? "/tmp" : tmp_dirs.front(),
+                      kWarmStartProfileDir);
+}
+
+// Thread factory that pins the threads it starts to a NUMA node. Threads are
+// started by `base` if set and by the default environment otherwise.
+class NumaThreadFactory : public ThreadFactory {
+ public:
+  NumaThreadFactory(std::shared_ptr<ThreadFactory> base, int numa_node)
+      : base_(std::move(base)), numa_node_(numa_node) {}
+
+  std::unique_ptr<Thread> StartThread(const string& name,
+                                      std::function<void()> fn) override {
+    auto pinned_fn = [numa_node = numa_node_, fn = std::move(fn)]() {
+      // The thread may be reused by `base_` once `fn` returns, so the previous
+      // affinity is restored afterwards.
+      const int previous_numa_node = port::NUMAGetThreadNodeAffinity();
+      port::NUMASetThreadNodeAffinity(numa_node);
+      fn();
+      port::NUMASetThreadNodeAffinity(previous_numa_node);
+    };
+    if (base_) {
+      return base_->StartThread(name, std::move(pinned_fn));
+    }
+    return absl::WrapUnique(
+        Env::Default()->StartThread({}, name, std::move(pinned_fn)));
+  }
+
+ private:
+  const std::shared_ptr<ThreadFactory> base_;
+  const int numa_node_;
+};
 
 // If value `x` matches `y`, returns default value `z`. Otherwise, return `x`.
 inline int64_t value_or_default(int64_t x, int64_t y, int64_t z) {
@@ -60,6 +118,19 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
     params->private_threadpool_size =
         options.threading_options().private_threadpool_size();
   }
+  if (ShouldPinToNumaNode(options)) {
+    const int64_t numa_node = options.threading_options().numa_node();
+    if (!port::NUMAEnabled()) {
+      LOG(WARNING) << "Ignoring `numa_node` option because NUMA is not "
+                      "supported on this platform.";
+    } else if (numa_node < 0 || numa_node >= port::NUMANumNodes()) {
+      LOG(WARNING) << "Ignoring `numa_node` option because NUMA node "
+                   << numa_node << " does not exist; the number of NUMA nodes "
+                   << "is " << port::NUMANumNodes() << ".";
+    } else {
+      params->numa_node = numa_node;
+    }
+  }
   params->autotune = ShouldUseAutotuning(options);
   if (params->autotune) {
     params->autotune_algorithm = model::AutotuneAlgorithm::DEFAULT;
@@ -106,6 +177,11 @@ void AddTraceMetadata(const RootDataset::Params& params,
                                     params.private_threadpool_size, 0,
                                     port::MaxParallelism())))));
   }
+  if (params.numa_node != port::kNUMANoAffinity) {
+    trace_metadata->push_back(std::make_pair(
+        kNumaNode,
+        strings::Printf("%lld", static_cast<long long>(params.numa_node))));
+  }
   auto experiments = GetExperiments();
   if (!experiments.empty()) {
     trace_metadata->push_back(
@@ -152,8 +228,10 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       threadpool_size_ =
           value_or_default(dataset()->params_.private_threadpool_size, 0,
                            port::MaxParallelism());
+      ThreadOptions thread_options;
+      thread_options.numa_node = dataset()->params_.numa_node;
       thread_pool_ = std::make_unique<thread::ThreadPool>(
-          Env::Default(), ThreadOptions{}, "data_private_threadpool",
+          Env::Default(), thread_options, "data_private_threadpool",
           threadpool_size_);
     }
     cancellation_manager_ = std::make_unique<CancellationManager>();
@@ -164,6 +242,17 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   bool SymbolicCheckpointCompatible() const override { return true; }
 
   Status Initialize(IteratorContext* ctx) override {
+    if (model_ && dataset()->params_.autotune_algorithm ==
+                      model::AutotuneAlgorithm::WARM_START) {
+      StatusOr<std::string> profile = WarmStartProfileFilename();
+      if (profile.ok()) {
+        model_->SetWarmStartProfile(*profile);
+      } else {
+        LOG(WARNING) << "Failed to determine the autotuning profile of the "
+                        "input pipeline; autotuning will not be warm-started: "
+                     << profile.status();
+      }
+    }
     IteratorContext iter_ctx(CreateParams(ctx));
     TF_RETURN_IF_ERROR(dataset()->input_->MakeIterator(&iter_ctx, this,
                                                        prefix(), &input_impl_));
@@ -257,9 +346,43 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       params.runner =
           RunnerWithMaxParallelism(params.runner, max_intra_op_parallelism_);
     }
+    const int numa_node = dataset()->params_.numa_node;
+    if (numa_node != port::kNUMANoAffinity) {
+      params.thread_factory = std::make_shared<NumaThreadFactory>(
+          std::move(params.thread_factory), numa_node);
+      params.allocator_getter =
+          [numa_node, base = std::move(params.allocator_getter)](
+              AllocatorAttributes attrs) -> Allocator* {
+        if (!attrs.gpu_compatible() || !base) {
+          return cpu_allocator(numa_node);
+        }
+        return base(attrs);
+      };
+    }
     return params;
   }
 
+  // Returns the file in which the `WARM_START` autotuning algorithm persists
+  // the model profile of this pipeline. The file is keyed by the fingerprint
+  // of the input dataset graph so that later runs of the same pipeline can
+  // reuse it.
+  StatusOr<std::string> WarmStartProfileFilename() {
+    SerializationContext::Params params;
+    std::vector<std::pair<string, Tensor>> input_list;
+    params.input_list = &input_list;
+    params.external_state_policy = ExternalStatePolicy::POLICY_IGNORE;
+    GraphDef graph_def;
+    TF_RETURN_IF_ERROR(AsGraphDef(dataset()->input_,
+                                  SerializationContext(params), &graph_def));
+    uint64 fingerprint;
+    TF_RETURN_IF_ERROR(HashGraph(graph_def, &fingerprint));
+    const std::string dir = WarmStartProfileDir();
+    TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(dir));
+    return io::JoinPath(
+        dir, strings::StrCat(strings::Hex(fingerprint, strings::kZeroPad16),
+                             kWarmStartProfileSuffix));
+  }
+
   Status EnsureModelThreadStarted(IteratorContext* ctx) {
     mutex_lock l(mu_);
     if (!model_thread_) {
@@ -127,6 +127,40 @@ TEST(SerializationUtilsTest, CheckpointElementsRoundTrip) {
   }
 }
 
+TEST(SerializationUtilsTest, UpdateCheckpointElements) {
+  std::vector<std::vector<Tensor>> elements;
+  elements.push_back(CreateTensors<int32>(TensorShape({3}), {{1, 2, 3}}));
+  elements.push_back(CreateTensors<int32>(TensorShape({2}), {{4, 5}}));
+  elements.push_back(CreateTensors<int32>(TensorShape({1}), {{6}}));
+  tstring test_prefix = full_name("test_prefix");
+  MemoryCheckpoint checkpoint;
+  TF_ASSERT_OK(WriteElementsToCheckpoint(&checkpoint, test_prefix, elements));
+
+  elements[1] = CreateTensors<int32>(TensorShape({1}), {{7}});
+  elements[2].clear();
+  MemoryCheckpoint update;
+  TF_ASSERT_OK(UpdateCheckpointElements(&update, test_prefix, elements,
+                                        /*checkpoint_indices=*/{1, 2}));
+  checkpoint.Merge(update);
+
+  VariantTensorDataWriter writer;
+  TF_ASSERT_OK(checkpoint.Save(&writer));
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+  VariantTensorDataReader reader(data);
+  std::unique_ptr<TestContext> ctx;
+  TF_ASSERT_OK(TestContext::Create(&ctx));
+  std::vector<std::vector<Tensor>> read_elements;
+  TF_ASSERT_OK(ReadElementsFromCheckpoint(ctx->iter_ctx(), &reader, test_prefix,
+                                          &read_elements));
+  ASSERT_EQ(read_elements.size(), 3);
+  ASSERT_EQ(read_elements[0].size(), 1);
+  test::ExpectEqual(read_elements[0][0], elements[0][0]);
+  ASSERT_EQ(read_elements[1].size(), 1);
+  test::ExpectEqual(read_elements[1][0], elements[1][0]);
+  EXPECT_TRUE(read_elements[2].empty());
+}
+
 TEST(SerializationUtilsTest, VariantTensorDataRoundtrip) {
   VariantTensorDataWriter writer;
   TF_ASSERT_OK(writer.WriteScalar(full_name("Int64"), 24));
@@ -15,19 +15,25 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/logging_utils.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -46,6 +52,12 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// Optionally, evicted elements are spilled to a local directory (typically on
+// an SSD) instead of being dropped, so trainers that fall behind the in-memory
+// window read them from disk rather than skipping them. Only elements that some
+// trainer has not read yet are spilled, and the spilled elements are dropped
+// oldest first once they are behind all trainers or exceed the spill budget.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -78,7 +90,8 @@ namespace data {
 // To use the cache, the user needs to define a `CachableSequence` to generate
 // an infinite sequence of data. It should implement a `GetNext` method to
 // produce elements, and a `GetElementSizeBytes` method to estimate the element
-// size in bytes.
+// size in bytes. To spill evicted elements to disk, it should also implement
+// `SerializeElement` and `ParseElement`.
 template <class ElementType>
 class CachableSequence {
  public:
@@ -89,6 +102,28 @@ class CachableSequence {
 
   // Returns the estimated size of the element in bytes.
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
+
+  // Serializes an element to be spilled to disk. Elements are not spilled if
+  // this returns an error.
+  virtual StatusOr<std::string> SerializeElement(const ElementType&) const {
+    return errors::Unimplemented(
+        "The cachable sequence does not support spilling elements.");
+  }
+
+  // Parses an element serialized by `SerializeElement`.
+  virtual StatusOr<ElementType> ParseElement(const std::string&) const {
+    return errors::Unimplemented(
+        "The cachable sequence does not support spilling elements.");
+  }
+};
+
+// Options for spilling elements evicted from a `CrossTrainerCache` to disk.
+struct CrossTrainerCacheSpillOptions {
+  // Local directory for the spilled elements. Spilling is disabled if empty.
+  // The directory must not be shared with other caches.
+  std::string directory;
+  // Maximum total size of the spilled elements in bytes.
+  size_t max_spill_size_bytes = 0;
 };
 
 // Sliding-window cache shared across concurrent trainers.
@@ -98,17 +133,20 @@ class CrossTrainerCache {
   // Creates a `CrossTrainerCache` with `max_cache_size_bytes` of memory budget.
   // The cache should be able to hold at least one element, i.e.:
   // REQUIRES: `max_cache_size_bytes >= max(GetElementSizeBytes(*))`
+  //
+  // Evicted elements are spilled to disk as described by `spill_options`.
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
-      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
-  virtual ~CrossTrainerCache() = default;
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      const CrossTrainerCacheSpillOptions& spill_options = {});
+  virtual ~CrossTrainerCache();
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
 
   // Gets the next element for a trainer. A `trainer_id` identifies the trainer
   // reading from the cache. A trainer reads the next element it hasn't read
   // before. After a trainer reads data, the data is cached and reused by other
-  // trainers.
+  // trainers. A new trainer starts reading from the in-memory window.
   StatusOr<std::shared_ptr<const ElementType>> Get(
       const std::string& trainer_id);
 
@@ -124,6 +162,8 @@ class CrossTrainerCache {
   struct CacheQueryResult {
     std::shared_ptr<const ElementType> element;
     bool cache_hit;
+    // Size of the element read from disk, or 0 if it was read from memory.
+    size_t spill_read_bytes = 0;
   };
 
   // Returns the next element and metrics about this query.
@@ -135,9 +175,14 @@ class CrossTrainerCache {
   bool IsElementReady(const std::string& trainer_id);
 
   // Returns the absolute element index relative to the dataset (not relative to
-  // the cached elements).
+  // the cached elements). Indices before `cache_start_index_` refer to spilled
+  // elements.
   size_t GetElementIndex(const std::string& trainer_id);
 
+  // Returns the smallest element index that some trainer has not read, or the
+  // maximum index if there are no trainers.
+  size_t MinReadIndex() const;
+
   // Returns the next element for `trainer_id`.
   StatusOr<std::shared_ptr<const ElementType>> GetElement(
       const std::string& trainer_id);
@@ -145,9 +190,24 @@ class CrossTrainerCache {
   // Reads a new element and writes it into the cache.
   Status ExtendCache();
 
-  // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
-  // `new_element_size_bytes` is the size of the new element being inserted.
-  void FreeSpace(size_t new_element_size_bytes);
+  // Evicts the first `spilled_sizes.size()` elements of `cache_`, recording the
+  // bytes spilled for each of them, and drops spilled elements beyond the spill
+  // budget. Appends the files of the dropped elements to `files_to_delete`.
+  void FreeSpace(const std::vector<size_t>& spilled_sizes,
+                 std::vector<std::string>& files_to_delete);
+
+  // Writes the element at `element_index` to the spill directory. Returns the
+  // number of bytes written, or 0 if the element is not spilled.
+  size_t SpillElement(size_t element_index, const ElementType& element,
+                      size_t min_read_index);
+
+  // Reads the element at `element_index` from the spill directory. Returns
+  // `NotFound` if the element was not spilled or has been dropped.
+  StatusOr<std::shared_ptr<const ElementType>> ReadSpilledElement(
+      size_t element_index, size_t& bytes_read);
+
+  // Returns the file of the spilled element at `element_index`.
+  std::string SpillFilename(size_t element_index) const;
 
   // Records the cache hit rate and cache size.
   void RecordMetrics(const CacheQueryResult& result);
@@ -158,6 +218,8 @@ class CrossTrainerCache {
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
 
+  const CrossTrainerCacheSpillOptions spill_options_;
+
   mutable mutex mu_;
   mutable condition_variable cv_;
 
@@ -170,12 +232,20 @@ class CrossTrainerCache {
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
   size_t cache_start_index_ TF_GUARDED_BY(mu_) = 0;
 
+  // `spilled_sizes_` stores the sizes of the elements evicted from `cache_`
+  // which may be on disk, starting at `spill_start_index_` and ending at
+  // `cache_start_index_`. A size of 0 means the element was not spilled.
+  std::deque<size_t> spilled_sizes_ TF_GUARDED_BY(mu_);
+  size_t spill_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  size_t spill_start_index_ TF_GUARDED_BY(mu_) = 0;
+
   // True if one thread is extending the cache.
   bool extending_cache_ TF_GUARDED_BY(mu_) = false;
 
   // Maps trainer IDs to element indices. The indices are absolute indices
   // within the dataset. The actual index to use with `cache_` would be
-  // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`.
+  // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`. Eviction
+  // uses them to tell which elements are behind all trainers.
   absl::flat_hash_map<std::string, size_t> trainer_to_element_index_map_
       TF_GUARDED_BY(mu_);
 };
@@ -183,13 +253,38 @@ class CrossTrainerCache {
 template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
-    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    const CrossTrainerCacheSpillOptions& spill_options)
     : max_cache_size_bytes_(max_cache_size_bytes),
-      cachable_sequence_(std::move(cachable_sequence)) {
+      cachable_sequence_(std::move(cachable_sequence)),
+      spill_options_(spill_options) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
   VLOG(2) << "Initialized tf.data service cross-trainer cache with "
           << FormatBytes(max_cache_size_bytes) << " of memory.";
+  if (spill_options_.directory.empty()) {
+    return;
+  }
+  Status s = Env::Default()->RecursivelyCreateDir(spill_options_.directory);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to create the tf.data service cross-trainer cache "
+                 << "spill directory " << spill_options_.directory << ": " << s;
+  }
+}
+
+template <class ElementType>
+CrossTrainerCache<ElementType>::~CrossTrainerCache() {
+  if (spill_options_.directory.empty()) {
+    return;
+  }
+  mutex_lock l(mu_);
+  for (size_t i = 0; i < spilled_sizes_.size(); ++i) {
+    if (spilled_sizes_[i] > 0) {
+      Env::Default()->DeleteFile(SpillFilename(spill_start_index_ + i))
+          .IgnoreError();
+    }
+  }
+  Env::Default()->DeleteDir(spill_options_.directory).IgnoreError();
 }
 
 template <class ElementType>
@@ -212,20 +307,27 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
   while (true) {
+    std::optional<size_t> spilled_element_index;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
       if (IsElementReady(trainer_id)) {
-        TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
-                            GetElement(trainer_id));
-        return CacheQueryResult{element,
-                                /*is_cache_hit=*/!should_extend_cache};
-      }
-
-      // Extends the cache or waits for another thread to extend the cache. When
-      // concurrent trainers wait for the next element, only one of them should
-      // extend the cache.
-      if (extending_cache_) {
+        const size_t element_index = GetElementIndex(trainer_id);
+        if (element_index >= cache_start_index_) {
+          TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
+                              GetElement(trainer_id));
+          return CacheQueryResult{element,
+                                  /*is_cache_hit=*/!should_extend_cache};
+        }
+        // The element has been evicted from memory. It is read from disk
+        // without holding `mu_`.
+        trainer_to_element_index_map_[trainer_id] = element_index + 1;
+        spilled_element_index = element_index;
+        should_extend_cache = false;
+      } else if (extending_cache_) {
+        // Extends the cache or waits for another thread to extend the cache.
+        // When concurrent trainers wait for the next element, only one of them
+        // should extend the cache.
         should_extend_cache = false;
         cv_.wait(l);
       } else {
@@ -234,6 +336,23 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    if (spilled_element_index.has_value()) {
+      size_t bytes_read = 0;
+      StatusOr<std::shared_ptr<const ElementType>> element =
+          ReadSpilledElement(*spilled_element_index, bytes_read);
+      if (element.ok()) {
+        return CacheQueryResult{*element, /*is_cache_hit=*/true, bytes_read};
+      }
+      // Skips elements which were not spilled or could not be read, as if they
+      // had been dropped.
+      if (!errors::IsNotFound(element.status())) {
+        LOG(WARNING) << "Failed to read tf.data service cross-trainer cache "
+                     << "element " << *spilled_element_index
+                     << " from disk: " << element.status();
+      }
+      continue;
+    }
+
     if (should_extend_cache) {
       Status s = ExtendCache();
       mutex_lock l(mu_);
@@ -270,11 +389,22 @@ CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
 template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  size_t element_index = trainer_to_element_index_map_[trainer_id];
-  if (element_index < cache_start_index_) {
-    element_index = cache_start_index_;
+  auto it = trainer_to_element_index_map_.find(trainer_id);
+  if (it == trainer_to_element_index_map_.end()) {
+    return cache_start_index_;
+  }
+  return std::max(it->second, spill_start_index_);
+}
+
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::MinReadIndex() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  size_t min_read_index = std::numeric_limits<size_t>::max();
+  for (const auto& [trainer_id, element_index] :
+       trainer_to_element_index_map_) {
+    min_read_index = std::min(min_read_index, element_index);
   }
-  return element_index;
+  return min_read_index;
 }
 
 template <class ElementType>
@@ -289,31 +419,133 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
         " and cache size: ", max_cache_size_bytes_);
   }
 
-  mutex_lock l(mu_);
-  TF_RETURN_IF_ERROR(status_);
-  FreeSpace(new_element_size_bytes);
-  cache_.push_back(std::make_shared<ElementType>(std::move(element)));
-  cache_size_bytes_ += new_element_size_bytes;
-  return OkStatus();
+  // Only the thread extending the cache evicts elements, so the elements to
+  // evict stay at the front of `cache_` while they are spilled without holding
+  // `mu_`. Trainers keep reading them from memory in the meantime.
+  std::vector<std::shared_ptr<const ElementType>> evicted;
+  size_t first_evicted_index = 0;
+  size_t min_read_index = 0;
+  {
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(status_);
+    first_evicted_index = cache_start_index_;
+    min_read_index = MinReadIndex();
+    size_t cache_size_bytes = cache_size_bytes_;
+    for (const std::shared_ptr<const ElementType>& cached : cache_) {
+      if (cache_size_bytes + new_element_size_bytes <= max_cache_size_bytes_) {
+        break;
+      }
+      evicted.push_back(cached);
+      cache_size_bytes -= cachable_sequence_->GetElementSizeBytes(*cached);
+    }
+  }
+
+  std::vector<size_t> spilled_sizes;
+  spilled_sizes.reserve(evicted.size());
+  for (size_t i = 0; i < evicted.size(); ++i) {
+    spilled_sizes.push_back(
+        SpillElement(first_evicted_index + i, *evicted[i], min_read_index));
+  }
+
+  Status status;
+  std::vector<std::string> files_to_delete;
+  {
+    mutex_lock l(mu_);
+    FreeSpace(spilled_sizes, files_to_delete);
+    status = status_;
+    if (status.ok()) {
+      cache_.push_back(std::make_shared<ElementType>(std::move(element)));
+      cache_size_bytes_ += new_element_size_bytes;
+    }
+  }
+  for (const std::string& filename : files_to_delete) {
+    Env::Default()->DeleteFile(filename).IgnoreError();
+  }
+  return status;
 }
 
 template <class ElementType>
-void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
+void CrossTrainerCache<ElementType>::FreeSpace(
+    const std::vector<size_t>& spilled_sizes,
+    std::vector<std::string>& files_to_delete)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  size_t num_elements_discarded = 0;
-  while (!cache_.empty() &&
-         cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
-    size_t free_bytes =
+  for (size_t spilled_bytes : spilled_sizes) {
+    cache_size_bytes_ -=
         cachable_sequence_->GetElementSizeBytes(*cache_.front());
     cache_.pop_front();
-    cache_size_bytes_ -= free_bytes;
     ++cache_start_index_;
-    ++num_elements_discarded;
+    spilled_sizes_.push_back(spilled_bytes);
+    spill_size_bytes_ += spilled_bytes;
   }
 
-  VLOG(3) << "Freed " << num_elements_discarded << " element(s) from "
+  // Drops the spilled elements furthest behind: those beyond the spill budget,
+  // those all trainers have read, and leading elements which were not spilled.
+  const size_t min_read_index = MinReadIndex();
+  while (!spilled_sizes_.empty() &&
+         (spill_size_bytes_ > spill_options_.max_spill_size_bytes ||
+          spill_start_index_ < min_read_index || spilled_sizes_.front() == 0)) {
+    if (spilled_sizes_.front() > 0) {
+      files_to_delete.push_back(SpillFilename(spill_start_index_));
+    }
+    spill_size_bytes_ -= spilled_sizes_.front();
+    spilled_sizes_.pop_front();
+    ++spill_start_index_;
+  }
+
+  VLOG(3) << "Freed " << spilled_sizes.size() << " element(s) from "
           << "tf.data service cross-trainer cache. Memory usage: "
-          << FormatBytes(cache_size_bytes_) << ".";
+          << FormatBytes(cache_size_bytes_)
+          << ". Disk usage: " << FormatBytes(spill_size_bytes_) << ".";
+}
+
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::SpillElement(size_t element_index,
+                                                    const ElementType& element,
+                                                    size_t min_read_index) {
+  if (spill_options_.directory.empty() || element_index < min_read_index) {
+    return 0;
+  }
+  StatusOr<std::string> serialized =
+      cachable_sequence_->SerializeElement(element);
+  Status s = serialized.status();
+  if (s.ok()) {
+    s = WriteStringToFile(Env::Default(), SpillFilename(element_index),
+                          *serialized);
+  }
+  if (!s.ok()) {
+    VLOG(1) << "Failed to spill tf.data service cross-trainer cache element "
+            << element_index << ": " << s;
+    return 0;
+  }
+  // Empty elements are not distinguishable from elements that are not spilled.
+  const size_t spilled_bytes = std::max<size_t>(serialized->size(), 1);
+  metrics::RecordTFDataServiceCrossTrainerCacheSpillBytes(
+      /*is_read=*/false, spilled_bytes);
+  return spilled_bytes;
+}
+
+template <class ElementType>
+StatusOr<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::ReadSpilledElement(size_t element_index,
+                                                   size_t& bytes_read) {
+  if (spill_options_.directory.empty()) {
+    return errors::NotFound("tf.data service cross-trainer cache element ",
+                            element_index, " was not spilled.");
+  }
+  std::string serialized;
+  TF_RETURN_IF_ERROR(ReadFileToString(
+      Env::Default(), SpillFilename(element_index), &serialized));
+  TF_ASSIGN_OR_RETURN(ElementType element,
+                      cachable_sequence_->ParseElement(serialized));
+  bytes_read = std::max<size_t>(serialized.size(), 1);
+  return std::make_shared<const ElementType>(std::move(element));
+}
+
+template <class ElementType>
+std::string CrossTrainerCache<ElementType>::SpillFilename(
+    size_t element_index) const {
+  return io::JoinPath(spill_options_.directory,
+                      absl::StrCat("element_", element_index));
 }
 
 template <class ElementType>
@@ -340,6 +572,10 @@ template <class ElementType>
 void CrossTrainerCache<ElementType>::RecordMetrics(
     const CacheQueryResult& result) {
   metrics::RecordTFDataServiceCrossTrainerCacheQuery(result.cache_hit);
+  if (result.spill_read_bytes > 0) {
+    metrics::RecordTFDataServiceCrossTrainerCacheSpillBytes(
+        /*is_read=*/true, result.spill_read_bytes);
+  }
   size_t cache_size_bytes = 0;
   {
     mutex_lock l(mu_);
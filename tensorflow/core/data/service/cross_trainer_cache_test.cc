@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
@@ -61,6 +63,21 @@ class InfiniteRange : public CachableSequence<int64_t> {
   int64_t next_ = 0;
 };
 
+class SpillableInfiniteRange : public InfiniteRange {
+ public:
+  StatusOr<std::string> SerializeElement(
+      const int64_t& element) const override {
+    return absl::StrCat(element);
+  }
+  StatusOr<int64_t> ParseElement(const std::string& serialized) const override {
+    int64_t element = 0;
+    if (!absl::SimpleAtoi(serialized, &element)) {
+      return errors::DataLoss("Invalid element: ", serialized);
+    }
+    return element;
+  }
+};
+
 class TensorDataset : public CachableSequence<Tensor> {
  public:
   StatusOr<Tensor> GetNext() override { return Tensor("Test Tensor"); }
@@ -190,6 +207,49 @@ TEST(CrossTrainerCacheTest, SlowTrainersSkipData) {
   EXPECT_THAT(cache.Get("Slow trainer 2"), IsOkAndHolds(Pointee(Gt(94))));
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadSpilledData) {
+  CellReader<int64_t> cell_reader(
+      "/tensorflow/data/service/cross_trainer_cache_spill_bytes");
+  CrossTrainerCacheSpillOptions spill_options;
+  spill_options.directory = io::JoinPath(testing::TmpDir(), "spill_read");
+  spill_options.max_spill_size_bytes = 1024;
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SpillableInfiniteRange>(), spill_options);
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // 1 to 14 are read from disk, and 15 to 19 from memory.
+  for (int i = 1; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  // 0 is not spilled because both trainers have read it.
+  EXPECT_EQ(cell_reader.Delta("write"), 9 * 1 + 5 * 2);
+  EXPECT_EQ(cell_reader.Delta("read"), 9 * 1 + 5 * 2);
+}
+
+TEST(CrossTrainerCacheTest, SpilledDataIsBounded) {
+  CrossTrainerCacheSpillOptions spill_options;
+  spill_options.directory = io::JoinPath(testing::TmpDir(), "spill_bounded");
+  spill_options.max_spill_size_bytes = 4;
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SpillableInfiniteRange>(), spill_options);
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // Only "13" and "14" fit into the 4 bytes of spilled data.
+  for (int i = 13; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
 TEST(CrossTrainerCacheTest, NewTrainersStartLate) {
   CrossTrainerCache<int64_t> cache(
       /*max_cache_size_bytes=*/5 * sizeof(int64_t),
@@ -114,6 +114,41 @@ Status DataServiceDispatcherClient::GetSplit(int64_t iteration_id,
   return OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetSplits(int64_t iteration_id,
+                                              int64_t repetition,
+                                              int64_t split_provider_index,
+                                              int64_t max_splits,
+                                              std::vector<Tensor>& splits,
+                                              bool& end_of_splits) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetSplitRequest req;
+  req.set_iteration_id(iteration_id);
+  req.set_repetition(repetition);
+  req.set_split_provider_index(split_provider_index);
+  req.set_max_splits(max_splits);
+  GetSplitResponse resp;
+  grpc::ClientContext client_ctx;
+  grpc::Status status = stub_->GetSplit(&client_ctx, req, &resp);
+  if (!status.ok()) {
+    return grpc_util::WrapError("Failed to get splits", status);
+  }
+  splits.clear();
+  end_of_splits = resp.end_of_splits();
+  if (end_of_splits) {
+    return OkStatus();
+  }
+  splits.resize(1 + resp.additional_splits_size());
+  if (!splits[0].FromProto(resp.split())) {
+    return errors::Internal("Failed to parse split tensor proto");
+  }
+  for (int i = 0; i < resp.additional_splits_size(); ++i) {
+    if (!splits[i + 1].FromProto(resp.additional_splits(i))) {
+      return errors::Internal("Failed to parse split tensor proto");
+    }
+  }
+  return OkStatus();
+}
+
 Status DataServiceDispatcherClient::Snapshot(
     const DatasetDef& dataset, const std::string& directory,
     const experimental::DistributedSnapshotMetadata& metadata) {
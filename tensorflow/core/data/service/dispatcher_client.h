@@ -64,6 +64,12 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
                   int64_t split_provider_index, Tensor& split,
                   bool& end_of_splits);
 
+  // Like `GetSplit`, but gets up to `max_splits` next splits at once and
+  // stores them in `splits`. `splits` is empty iff `end_of_splits` is true.
+  Status GetSplits(int64_t iteration_id, int64_t repetition,
+                   int64_t split_provider_index, int64_t max_splits,
+                   std::vector<Tensor>& splits, bool& end_of_splits);
+
   // Gets the next split for the specified source of a stream of the snapshot in
   // `directory`. If `end_of_splits` returns true, then there are no more splits
   // to be processed for the specified stream source.
@@ -18,7 +18,9 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -48,6 +50,7 @@ using ::tensorflow::data::testing::LocalTempFilename;
 using ::tensorflow::data::testing::RangeDataset;
 using ::tensorflow::testing::StatusIs;
 using ::testing::AllOf;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 constexpr const char kProtocol[] = "grpc";
@@ -175,6 +178,37 @@ TEST_F(DispatcherClientTest, SnapshotsInHeartbeat) {
   }
 }
 
+TEST_F(DispatcherClientTest, SnapshotStreamsPerWorker) {
+  TestCluster::Config config;
+  config.num_workers = 1;
+  config.snapshot_streams_per_worker = 2;
+  test_cluster_ = std::make_unique<TestCluster>(config);
+  TF_ASSERT_OK(test_cluster_->Initialize());
+  dispatcher_client_ = std::make_unique<DataServiceDispatcherClient>(
+      test_cluster_->DispatcherAddress(), kProtocol);
+  TF_ASSERT_OK_AND_ASSIGN(absl::flat_hash_set<std::string> directories,
+                          StartDummySnapshots());
+  WorkerHeartbeatRequest worker_heartbeat_request;
+  worker_heartbeat_request.set_worker_address(test_cluster_->WorkerAddress(0));
+  // The worker is assigned the same streams on every heartbeat.
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(
+        WorkerHeartbeatResponse worker_heartbeat_response,
+        dispatcher_client_->WorkerHeartbeat(worker_heartbeat_request));
+    absl::flat_hash_map<std::string, std::vector<int64_t>> streams;
+    for (const auto& snapshot_task :
+         worker_heartbeat_response.snapshot_tasks()) {
+      streams[snapshot_task.base_path()].push_back(
+          snapshot_task.stream_index());
+    }
+    ASSERT_EQ(streams.size(), directories.size());
+    for (const auto& [directory, stream_indices] : streams) {
+      ASSERT_TRUE(directories.count(directory));
+      EXPECT_THAT(stream_indices, ElementsAre(0, 1));
+    }
+  }
+}
+
 TEST_F(DispatcherClientTest, GetSnapshotSplit) {
   TF_ASSERT_OK_AND_ASSIGN(absl::flat_hash_set<std::string> directories,
                           StartDummySnapshots());
@@ -194,6 +228,52 @@ TEST_F(DispatcherClientTest, GetSnapshotSplit) {
   }
 }
 
+TEST_F(DispatcherClientTest, GetSplits) {
+  // Without workers, the splits are only read by this test.
+  test_cluster_ = std::make_unique<TestCluster>(/*num_workers=*/0);
+  TF_ASSERT_OK(test_cluster_->Initialize());
+  dispatcher_client_ = std::make_unique<DataServiceDispatcherClient>(
+      test_cluster_->DispatcherAddress(), kProtocol);
+  DataServiceMetadata metadata = GetDefaultMetadata();
+  metadata.set_cardinality(10);
+  TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id,
+                          RegisterDataset(RangeDataset(10), metadata));
+  ProcessingModeDef processing_mode;
+  processing_mode.set_sharding_policy(ProcessingModeDef::DYNAMIC);
+  int64_t job_id = 0;
+  TF_ASSERT_OK(dispatcher_client_->GetOrCreateJob(
+      dataset_id, processing_mode, /*job_name=*/std::nullopt,
+      /*num_consumers=*/std::nullopt,
+      /*use_cross_trainer_cache=*/false, TARGET_WORKERS_AUTO, job_id));
+  int64_t iteration_client_id = 0;
+  TF_ASSERT_OK(dispatcher_client_->GetOrCreateIteration(
+      job_id, /*repetition=*/0, iteration_client_id));
+  WorkerHeartbeatRequest worker_heartbeat_request;
+  worker_heartbeat_request.set_worker_address("localhost:0");
+  TF_ASSERT_OK_AND_ASSIGN(
+      WorkerHeartbeatResponse worker_heartbeat_response,
+      dispatcher_client_->WorkerHeartbeat(worker_heartbeat_request));
+  ASSERT_EQ(worker_heartbeat_response.new_tasks_size(), 1);
+  const int64_t iteration_id =
+      worker_heartbeat_response.new_tasks(0).iteration_id();
+
+  // The splits of the last batch are returned before the end of splits.
+  std::vector<int64_t> split_values;
+  std::vector<int64_t> batch_sizes;
+  for (bool end_of_splits = false; !end_of_splits;) {
+    std::vector<Tensor> splits;
+    TF_ASSERT_OK(dispatcher_client_->GetSplits(
+        iteration_id, /*repetition=*/0, /*split_provider_index=*/0,
+        /*max_splits=*/4, splits, end_of_splits));
+    batch_sizes.push_back(splits.size());
+    for (const Tensor& split : splits) {
+      split_values.push_back(split.scalar<int64_t>()());
+    }
+  }
+  EXPECT_THAT(batch_sizes, ElementsAre(4, 4, 2, 0));
+  EXPECT_THAT(split_values, ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+}
+
 TEST_F(DispatcherClientTest, RegisterDatasetWithExplicitId) {
   DataServiceMetadata metadata = GetDefaultMetadata();
   metadata.set_cardinality(10);
@@ -345,27 +345,50 @@ Status DataServiceDispatcherImpl::CreateSnapshotStream(
 
 Status DataServiceDispatcherImpl::PopulateSnapshotInfo(
     absl::string_view worker_address, WorkerHeartbeatResponse* response) {
+  const int64_t streams_per_worker =
+      std::max<int64_t>(config_.snapshot_streams_per_worker(), 1);
   for (auto& [snapshot_directory, snapshot_state] : snapshots_) {
-    SnapshotTaskDef* snapshot_task = response->add_snapshot_tasks();
-    snapshot_task->set_base_path(snapshot_directory);
+    std::vector<int64_t> stream_indices;
     if (auto it = snapshot_state.assigned_streams.find(worker_address);
         it != snapshot_state.assigned_streams.end()) {
-      snapshot_task->set_stream_index(it->second);
-      continue;
+      stream_indices.assign(it->second.begin(), it->second.end());
+      std::sort(stream_indices.begin(), stream_indices.end());
     }
-    if (snapshot_state.mode != SnapshotState::Mode::kActive) continue;
     // TODO(mpcallanan): Handle orphaned streams.
-    TF_RETURN_IF_ERROR(CreateSnapshotStream(snapshot_directory, worker_address,
-                                            snapshot_state));
-    snapshot_task->set_stream_index(snapshot_state.streams.size() - 1);
-    snapshot_state.assigned_streams[worker_address] =
-        snapshot_task->stream_index();
-    VLOG(1) << "creating stream #" << snapshot_task->stream_index()
-            << " and assigning to worker " << worker_address;
+    while (snapshot_state.mode == SnapshotState::Mode::kActive &&
+           static_cast<int64_t>(stream_indices.size()) < streams_per_worker) {
+      TF_RETURN_IF_ERROR(CreateSnapshotStream(
+          snapshot_directory, worker_address, snapshot_state));
+      stream_indices.push_back(snapshot_state.streams.size() - 1);
+      snapshot_state.assigned_streams[worker_address].insert(
+          stream_indices.back());
+      VLOG(1) << "creating stream #" << stream_indices.back()
+              << " and assigning to worker " << worker_address;
+    }
+    for (int64_t stream_index : stream_indices) {
+      SnapshotTaskDef* snapshot_task = response->add_snapshot_tasks();
+      snapshot_task->set_base_path(snapshot_directory);
+      snapshot_task->set_stream_index(stream_index);
+    }
   }
   return OkStatus();
 }
 
+void DataServiceDispatcherImpl::UpdateSnapshotProgress(
+    const WorkerHeartbeatRequest& request) {
+  for (const SnapshotTaskProgress& progress :
+       request.snapshot_task_progress()) {
+    auto it = snapshots_.find(progress.snapshot_task().base_path());
+    if (it == snapshots_.end()) continue;
+    std::vector<StreamState>& streams = it->second.streams;
+    const int64_t stream_index = progress.snapshot_task().stream_index();
+    if (stream_index < 0 || stream_index >= streams.size()) continue;
+    StreamState& stream_state = streams[stream_index];
+    stream_state.num_committed_chunks = std::max(
+        stream_state.num_committed_chunks, progress.num_committed_chunks());
+  }
+}
+
 Status DataServiceDispatcherImpl::WorkerHeartbeat(
     const WorkerHeartbeatRequest* request, WorkerHeartbeatResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
@@ -400,6 +423,7 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
       FindTasksToDelete(current_tasks, assigned_tasks, response));
   TF_RETURN_IF_ERROR(
       FindNewTasks(worker_address, current_tasks, assigned_tasks, response));
+  UpdateSnapshotProgress(*request);
   TF_RETURN_IF_ERROR(PopulateSnapshotInfo(worker_address, response));
 
   VLOG(4) << "Finished worker heartbeat for worker at address "
@@ -472,20 +496,37 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
   SplitProvider* split_provider =
       split_providers_[iteration_id][provider_index].get();
   DCHECK(split_provider != nullptr);
-  Tensor split;
+  // Batches of splits are journaled as a single update.
+  const int64_t max_splits = std::max<int64_t>(request->max_splits(), 1);
+  std::vector<Tensor> splits;
   bool end_of_splits = false;
-  TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
-  TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
-                                         request->split_provider_index(),
-                                         end_of_splits));
-  response->set_end_of_splits(end_of_splits);
+  while (splits.size() < max_splits) {
+    Tensor split;
+    TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
+    if (end_of_splits) break;
+    splits.push_back(std::move(split));
+  }
+  if (!splits.empty()) {
+    TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
+                                           provider_index, splits.size(),
+                                           /*finished=*/false));
+  }
   if (end_of_splits) {
+    TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
+                                           provider_index, /*num_splits=*/0,
+                                           /*finished=*/true));
     // Reset the split provider to prepare for the next iteration.
-    TF_RETURN_IF_ERROR(split_providers_[iteration_id][provider_index]->Reset());
-  } else {
-    split.AsProtoTensorContent(response->mutable_split());
+    TF_RETURN_IF_ERROR(split_provider->Reset());
+  }
+  // If the end was reached after some splits, those are returned first. The
+  // next request then gets `end_of_splits`, as its repetition is over.
+  response->set_end_of_splits(splits.empty());
+  for (int64_t i = 0; i < splits.size(); ++i) {
+    splits[i].AsProtoTensorContent(i == 0 ? response->mutable_split()
+                                          : response->add_additional_splits());
   }
-  VLOG(3) << "Returning from GetSplit, end_of_splits=" << end_of_splits;
+  VLOG(3) << "Returning " << splits.size()
+          << " splits from GetSplit, end_of_splits=" << splits.empty();
   return OkStatus();
 }
 
@@ -1181,7 +1222,12 @@ Status DataServiceDispatcherImpl::GetSnapshotSplit(
     stream_state.active_sources.erase(request->source_index());
     if (stream_state.active_sources.empty()) {
       stream_state.mode = StreamState::Mode::kDone;
-      snapshot_state.assigned_streams.erase(stream_state.worker_address);
+      if (auto it =
+              snapshot_state.assigned_streams.find(stream_state.worker_address);
+          it != snapshot_state.assigned_streams.end()) {
+        it->second.erase(request->stream_index());
+        if (it->second.empty()) snapshot_state.assigned_streams.erase(it);
+      }
     }
     snapshot_state.mode = snapshot_state.assigned_streams.empty()
                               ? SnapshotState::Mode::kDone
@@ -1266,13 +1312,14 @@ Status DataServiceDispatcherImpl::CheckStarted() TF_LOCKS_EXCLUDED(mu_) {
 
 Status DataServiceDispatcherImpl::RecordSplitProduced(
     int64_t iteration_id, int64_t repetition, int64_t split_provider_index,
-    bool finished) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    int64_t num_splits, bool finished) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   Update update;
   ProduceSplitUpdate* produce_split = update.mutable_produce_split();
   produce_split->set_iteration_id(iteration_id);
   produce_split->set_repetition(repetition);
   produce_split->set_split_provider_index(split_provider_index);
   produce_split->set_finished(finished);
+  if (!finished) produce_split->set_num_splits(num_splits);
   return Apply(update);
 }
 
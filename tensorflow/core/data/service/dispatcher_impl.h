@@ -86,6 +86,10 @@ struct StreamState {
   std::string worker_address;
   // Indices of all unfinished sources.
   absl::flat_hash_set<int64_t> active_sources;
+  // Number of chunks of the stream committed to the snapshot, as last reported
+  // by the worker. Readers can consume these chunks before the snapshot is
+  // done.
+  int64_t num_committed_chunks = 0;
 };
 
 struct SnapshotState {
@@ -105,8 +109,10 @@ struct SnapshotState {
   // All streams for the snapshot.
   std::vector<StreamState> streams;
   // Indices of all unfinished streams with a known worker assignment, keyed by
-  // worker address.
-  absl::flat_hash_map<std::string, int64_t> assigned_streams;
+  // worker address. A worker writes up to
+  // `DispatcherConfig.snapshot_streams_per_worker` streams in parallel.
+  absl::flat_hash_map<std::string, absl::flat_hash_set<int64_t>>
+      assigned_streams;
   // Indices of all unfinished streams with an unknown worker assignment.
   absl::flat_hash_set<int64_t> unassigned_streams;
   // A counter of all assigned splits for the snapshot.
@@ -338,6 +344,9 @@ class DataServiceDispatcherImpl {
   Status PopulateSnapshotInfo(absl::string_view worker_address,
                               WorkerHeartbeatResponse* response)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Records the progress of the snapshot streams reported in `request`.
+  void UpdateSnapshotProgress(const WorkerHeartbeatRequest& request)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Creates a new snapshot stream, both writing it on-disk to
   // `snapshot_directory` and adding an entry in-memory to `snapshots_state`.
   Status CreateSnapshotStream(absl::string_view snapshot_directory,
@@ -384,10 +393,11 @@ class DataServiceDispatcherImpl {
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Checks that the dispatcher has started, returning UNAVAILABLE if it hasn't.
   Status CheckStarted() TF_LOCKS_EXCLUDED(mu_);
-  // Records that a split was produced by a call to `GetSplit`.
+  // Records that `num_splits` splits were produced by a call to `GetSplit`, or
+  // that the split provider reached its end if `finished`.
   Status RecordSplitProduced(int64_t iteration_id, int64_t repetition,
-                             int64_t split_provider_index, bool finished)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+                             int64_t split_provider_index, int64_t num_splits,
+                             bool finished) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, updating both the journal and the in-memory state.
   Status Apply(const Update& update) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, but doesn't update the journal. Only meant to be
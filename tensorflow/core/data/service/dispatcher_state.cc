@@ -192,7 +192,8 @@ void DispatcherState::ProduceSplit(const ProduceSplitUpdate& produce_split) {
     state.indices[provider_index] = 0;
     return;
   }
-  state.indices[provider_index]++;
+  state.indices[provider_index] +=
+      std::max<int64_t>(produce_split.num_splits(), 1);
 }
 
 void DispatcherState::AcquireIterationClient(
@@ -0,0 +1,108 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shared_memory.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/mmap_cache.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr const char kProbePrefix[] = "tf_data_shm_probe_";
+constexpr const char kElementPrefix[] = "tf_data_shm_element_";
+
+std::string UniqueSuffix() {
+  return absl::StrCat(Env::Default()->NowMicros(), "_", random::New64());
+}
+
+// Returns whether `filename` is an absolute path without "." or ".."
+// components, directly inside `directory`, whose name starts with `prefix`.
+bool IsFileInDirectory(const std::string& directory,
+                       const std::string& filename, absl::string_view prefix) {
+  if (directory.empty() || !io::IsAbsolutePath(filename) ||
+      filename != io::CleanPath(filename)) {
+    return false;
+  }
+  return io::Dirname(filename) == io::CleanPath(directory) &&
+         absl::StartsWith(io::Basename(filename), prefix);
+}
+
+}  // namespace
+
+StatusOr<std::string> CreateSharedMemoryProbe(const std::string& directory) {
+  std::string probe_file =
+      io::JoinPath(directory, absl::StrCat(kProbePrefix, UniqueSuffix()));
+  TF_RETURN_IF_ERROR(WriteStringToFile(Env::Default(), probe_file, ""));
+  return probe_file;
+}
+
+bool IsSharedMemoryProbe(const std::string& directory,
+                         const std::string& probe_file) {
+  return IsFileInDirectory(directory, probe_file, kProbePrefix) &&
+         Env::Default()->FileExists(probe_file).ok();
+}
+
+StatusOr<std::string> WriteElementToSharedMemory(
+    const std::string& directory, const std::vector<Tensor>& element) {
+  std::string filename = io::JoinPath(
+      io::CleanPath(directory), absl::StrCat(kElementPrefix, UniqueSuffix()));
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<MmapCacheWriter> writer,
+      MmapCacheWriter::Create(Env::Default(), filename, element.size()));
+  TF_RETURN_IF_ERROR(writer->Write(element));
+  TF_RETURN_IF_ERROR(writer->Finalize());
+  return filename;
+}
+
+Status ReadElementFromSharedMemory(const std::string& directory,
+                                   const std::string& filename,
+                                   std::vector<Tensor>& element) {
+  if (!IsFileInDirectory(directory, filename, kElementPrefix)) {
+    return errors::InvalidArgument("Invalid shared memory element file ",
+                                   filename, " for directory ", directory);
+  }
+  StatusOr<std::unique_ptr<MmapCacheReader>> reader =
+      MmapCacheReader::Open(Env::Default(), filename);
+  // The mapping stays valid after the file is deleted.
+  Status s = Env::Default()->DeleteFile(filename);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete shared memory element file " << filename
+                 << ": " << s;
+  }
+  TF_RETURN_IF_ERROR(reader.status());
+  if ((*reader)->size() != 1) {
+    return errors::Internal("Expected shared memory file ", filename,
+                            " to contain a single element, but it contains ",
+                            (*reader)->size());
+  }
+  return (*reader)->Get(0, &element);
+}
+
+}  // namespace data
+}  // namespace tensorflow
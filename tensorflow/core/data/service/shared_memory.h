@@ -0,0 +1,68 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+// Utilities for transferring dataset elements between a tf.data service worker
+// and a client running as separate processes on the same host.
+//
+// The client creates a probe file in a shared memory directory and sends its
+// path with each GetElement request. The worker only honors probes directly
+// inside the shared memory directory of its configuration. If it can see the
+// probe, it shares the memory file system with the client, so it writes the
+// element to a new file in that directory instead of serializing it into the
+// response.
+// The client memory-maps the file, and the returned tensors alias the mapped
+// pages. The client deletes the file as soon as it is mapped; the pages are
+// released once the last tensor referencing them is destroyed.
+namespace tensorflow {
+namespace data {
+
+// Default directory for shared memory files.
+constexpr const char kSharedMemoryDirectory[] = "/dev/shm";
+
+// Creates a new probe file in `directory` and returns its path.
+StatusOr<std::string> CreateSharedMemoryProbe(const std::string& directory);
+
+// Returns whether `probe_file` is a probe created by `CreateSharedMemoryProbe`
+// directly inside `directory` that is visible to this process. Returns false
+// if `directory` is empty.
+bool IsSharedMemoryProbe(const std::string& directory,
+                         const std::string& probe_file);
+
+// Writes `element` to a new file in `directory` and returns the path of the
+// file.
+StatusOr<std::string> WriteElementToSharedMemory(
+    const std::string& directory, const std::vector<Tensor>& element);
+
+// Reads an element written by `WriteElementToSharedMemory` into `directory`
+// and deletes the file. Returns an InvalidArgument error if `filename` is not
+// an element file directly inside `directory`. The memcpy-able components of
+// `element` alias the mapped file.
+Status ReadElementFromSharedMemory(const std::string& directory,
+                                   const std::string& filename,
+                                   std::vector<Tensor>& element);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_H_
@@ -0,0 +1,150 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shared_memory.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+// Returns a new directory for the shared memory files of a test.
+std::string NewDirectory(const std::string& name) {
+  const std::string directory = io::JoinPath(testing::TmpDir(), name);
+  TF_CHECK_OK(Env::Default()->RecursivelyCreateDir(directory));
+  return directory;
+}
+
+TEST(SharedMemoryTest, RoundTrip) {
+  const std::string directory = NewDirectory("round_trip");
+  TF_ASSERT_OK_AND_ASSIGN(std::string probe_file,
+                          CreateSharedMemoryProbe(directory));
+  EXPECT_TRUE(IsSharedMemoryProbe(directory, probe_file));
+  std::vector<Tensor> element = {
+      CreateTensor<int64_t>(TensorShape{2, 2}, {1, 2, 3, 4}),
+      CreateTensor<tstring>(TensorShape{2}, {"a", "bc"})};
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename,
+                          WriteElementToSharedMemory(directory, element));
+  EXPECT_EQ(io::Dirname(filename), io::Dirname(probe_file));
+
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(
+      ReadElementFromSharedMemory(directory, filename, round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(element, round_trip_element,
+                                               /*compare_order=*/true));
+  EXPECT_THAT(Env::Default()->FileExists(filename),
+              StatusIs(error::NOT_FOUND));
+}
+
+TEST(SharedMemoryTest, MissingProbe) {
+  const std::string directory = NewDirectory("missing_probe");
+  TF_ASSERT_OK_AND_ASSIGN(std::string probe_file,
+                          CreateSharedMemoryProbe(directory));
+  TF_ASSERT_OK(Env::Default()->DeleteFile(probe_file));
+  EXPECT_FALSE(IsSharedMemoryProbe(directory, probe_file));
+}
+
+TEST(SharedMemoryTest, NotAProbe) {
+  const std::string directory = NewDirectory("not_a_probe");
+  const std::string filename = io::JoinPath(directory, "not_a_probe");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, ""));
+  EXPECT_FALSE(IsSharedMemoryProbe(directory, filename));
+}
+
+TEST(SharedMemoryTest, NoDirectory) {
+  const std::string directory = NewDirectory("no_directory");
+  TF_ASSERT_OK_AND_ASSIGN(std::string probe_file,
+                          CreateSharedMemoryProbe(directory));
+  EXPECT_FALSE(IsSharedMemoryProbe(/*directory=*/"", probe_file));
+}
+
+TEST(SharedMemoryTest, ProbeOutsideDirectory) {
+  const std::string directory = NewDirectory("probe_outside");
+  const std::string other_directory = NewDirectory("probe_outside_other");
+  TF_ASSERT_OK_AND_ASSIGN(std::string probe_file,
+                          CreateSharedMemoryProbe(other_directory));
+  EXPECT_FALSE(IsSharedMemoryProbe(directory, probe_file));
+  // Neither subdirectories nor parent directories are accepted.
+  EXPECT_FALSE(IsSharedMemoryProbe(testing::TmpDir(), probe_file));
+  const std::string nested_directory = NewDirectory("probe_outside/nested");
+  TF_ASSERT_OK_AND_ASSIGN(std::string nested_probe_file,
+                          CreateSharedMemoryProbe(nested_directory));
+  EXPECT_FALSE(IsSharedMemoryProbe(directory, nested_probe_file));
+}
+
+TEST(SharedMemoryTest, ProbePathTraversal) {
+  const std::string directory = NewDirectory("traversal");
+  const std::string other_directory = NewDirectory("traversal_other");
+  TF_ASSERT_OK_AND_ASSIGN(std::string probe_file,
+                          CreateSharedMemoryProbe(other_directory));
+  // The probe exists, but is only reachable through "..".
+  const std::string traversal = io::JoinPath(
+      directory, "..", "traversal_other", io::Basename(probe_file));
+  TF_ASSERT_OK(Env::Default()->FileExists(traversal));
+  EXPECT_FALSE(IsSharedMemoryProbe(directory, traversal));
+  EXPECT_FALSE(IsSharedMemoryProbe(
+      other_directory,
+      io::JoinPath(other_directory, ".", io::Basename(probe_file))));
+}
+
+TEST(SharedMemoryTest, RelativeProbe) {
+  EXPECT_FALSE(IsSharedMemoryProbe(".", "tf_data_shm_probe_0"));
+}
+
+TEST(SharedMemoryTest, InvalidElementFile) {
+  const std::string directory = NewDirectory("invalid_element");
+  const std::string filename = io::JoinPath(directory, "not_an_element");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, ""));
+  std::vector<Tensor> element;
+  EXPECT_THAT(ReadElementFromSharedMemory(directory, filename, element),
+              StatusIs(error::INVALID_ARGUMENT));
+  TF_EXPECT_OK(Env::Default()->FileExists(filename));
+}
+
+TEST(SharedMemoryTest, ElementFileOutsideDirectory) {
+  const std::string directory = NewDirectory("element_outside");
+  const std::string other_directory = NewDirectory("element_outside_other");
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string filename,
+      WriteElementToSharedMemory(other_directory,
+                                 {CreateTensor<int64_t>(TensorShape{}, {1})}));
+  std::vector<Tensor> element;
+  EXPECT_THAT(ReadElementFromSharedMemory(directory, filename, element),
+              StatusIs(error::INVALID_ARGUMENT));
+  EXPECT_THAT(
+      ReadElementFromSharedMemory(
+          directory,
+          io::JoinPath(directory, "..", "element_outside_other",
+                       io::Basename(filename)),
+          element),
+      StatusIs(error::INVALID_ARGUMENT));
+  // A rejected file is not deleted.
+  TF_EXPECT_OK(Env::Default()->FileExists(filename));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -24,6 +24,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/snapshot/file_utils.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/snapshot/utils.h"
@@ -60,6 +61,7 @@ StatusOr<int64_t> GetFileIndex(const std::string& filename,
 }  // namespace
 
 constexpr int64_t SnapshotWriterParams::kDefaultMaxChunkSizeBytes;
+constexpr int64_t SnapshotWriterParams::kDefaultMinChunkSizeBytes;
 
 SnapshotStreamWriter::SnapshotStreamWriter(
     const SnapshotWriterParams& params, std::unique_ptr<TaskIterator> iterator)
@@ -73,6 +75,11 @@ SnapshotStreamWriter::SnapshotStreamWriter(
       checkpoints_directory_(
           CheckpointsDirectory(params.snapshot_path, params.stream_index)),
       iterator_(std::move(iterator)),
+      chunk_size_limit_bytes_(
+          params.target_chunk_write_duration > absl::ZeroDuration()
+              ? std::min(params.min_chunk_size_bytes,
+                         params.max_chunk_size_bytes)
+              : params.max_chunk_size_bytes),
       snapshot_thread_(RunSnapshotThread()) {
   DCHECK_NE(iterator_, nullptr);
 }
@@ -120,6 +127,7 @@ bool SnapshotStreamWriter::ShouldWriteChunk() const TF_LOCKS_EXCLUDED(mu_) {
 }
 
 Status SnapshotStreamWriter::WriteChunk() {
+  const int64_t start_micros = params_.env->NowMicros();
   std::string chunk_file_path = GetChunkFilePath();
   snapshot_util::TFRecordWriter writer(chunk_file_path, params_.compression);
   TF_RETURN_IF_ERROR(writer.Initialize(params_.env));
@@ -127,7 +135,11 @@ Status SnapshotStreamWriter::WriteChunk() {
     TF_RETURN_IF_ERROR(WriteRecord(writer));
   }
   TF_RETURN_IF_ERROR(writer.Close());
-  return CommitChunk();
+  const int64_t chunk_size_bytes = chunk_size_bytes_;
+  TF_RETURN_IF_ERROR(CommitChunk());
+  AdaptChunkSize(chunk_size_bytes,
+                 absl::Microseconds(params_.env->NowMicros() - start_micros));
+  return OkStatus();
 }
 
 Status SnapshotStreamWriter::CommitChunk() {
@@ -141,9 +153,31 @@ Status SnapshotStreamWriter::CommitChunk() {
       params_.env->RenameFile(GetChunkFilePath(), GetCommittedChunkFilePath()));
   ++chunk_index_;
   chunk_size_bytes_ = 0;
+  mutex_lock l(mu_);
+  num_committed_chunks_ = chunk_index_;
   return OkStatus();
 }
 
+void SnapshotStreamWriter::AdaptChunkSize(int64_t chunk_size_bytes,
+                                          absl::Duration write_duration) {
+  if (params_.target_chunk_write_duration <= absl::ZeroDuration() ||
+      chunk_size_bytes == 0) {
+    return;
+  }
+  const double bytes_per_second =
+      chunk_size_bytes /
+      std::max(absl::ToDoubleSeconds(write_duration), 1e-3);
+  chunk_size_limit_bytes_ = static_cast<int64_t>(std::clamp(
+      bytes_per_second *
+          absl::ToDoubleSeconds(params_.target_chunk_write_duration),
+      static_cast<double>(std::min(params_.min_chunk_size_bytes,
+                                   params_.max_chunk_size_bytes)),
+      static_cast<double>(params_.max_chunk_size_bytes)));
+  VLOG(2) << "Wrote a snapshot chunk of " << chunk_size_bytes << " bytes in "
+          << write_duration << "; the next chunks will have up to "
+          << chunk_size_limit_bytes_ << " bytes.";
+}
+
 std::string SnapshotStreamWriter::GetChunkFilePath() const {
   return tsl::io::JoinPath(uncommitted_chunks_directory_,
                            absl::StrCat("chunk_", chunk_index_));
@@ -157,7 +191,7 @@ std::string SnapshotStreamWriter::GetCommittedChunkFilePath() const {
 
 bool SnapshotStreamWriter::ShouldWriteRecord() const TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
-  return chunk_size_bytes_ < params_.max_chunk_size_bytes &&
+  return chunk_size_bytes_ < chunk_size_limit_bytes_ &&
          !end_of_sequence_ && completed_.ok();
 }
 
@@ -202,6 +236,12 @@ StatusOr<bool> SnapshotStreamWriter::Completed() const TF_LOCKS_EXCLUDED(mu_) {
   return completed_;
 }
 
+int64_t SnapshotStreamWriter::NumCommittedChunks() const
+    TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  return num_committed_chunks_;
+}
+
 StatusOr<bool> SnapshotStreamWriter::Wait() TF_LOCKS_EXCLUDED(mu_) {
   snapshot_thread_.reset();
   mutex_lock l(mu_);
@@ -277,6 +317,8 @@ Status SnapshotStreamWriter::Restore() {
   TF_RETURN_IF_ERROR(iterator_->Restore(serialized_tensors[0]));
   TF_RETURN_IF_ERROR(SyncCheckpointWithChunks(*checkpoint_index));
   chunk_index_ = *checkpoint_index + 1;
+  mutex_lock l(mu_);
+  num_committed_chunks_ = chunk_index_;
   return OkStatus();
 }
 
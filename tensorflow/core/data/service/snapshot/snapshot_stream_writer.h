@@ -20,6 +20,7 @@ limitations under the License.
 #include <optional>
 #include <string>
 
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/task_runner.h"
 #include "tensorflow/core/data/service/worker.pb.h"
@@ -51,9 +52,22 @@ struct SnapshotWriterParams {
   // The maximum number of bytes in each chunk.
   int64_t max_chunk_size_bytes = kDefaultMaxChunkSizeBytes;
 
+  // If positive, the size of each chunk is adapted to the throughput observed
+  // when writing the previous chunks, so that writing and committing a chunk
+  // takes about this long. Chunks then become readable at a steady pace on
+  // slow file systems, without being tiny on fast ones. The chunk size stays
+  // between `min_chunk_size_bytes` and `max_chunk_size_bytes`. Otherwise,
+  // every chunk has `max_chunk_size_bytes`.
+  absl::Duration target_chunk_write_duration = absl::ZeroDuration();
+
+  // The minimum number of bytes in each chunk when adapting the chunk size.
+  int64_t min_chunk_size_bytes = kDefaultMinChunkSizeBytes;
+
  private:
   static constexpr int64_t kDefaultMaxChunkSizeBytes =
       10 * (size_t{1} << 30);  // 10GB
+  static constexpr int64_t kDefaultMinChunkSizeBytes =
+      64 * (size_t{1} << 20);  // 64MB
 };
 
 // Responsible for writing one snapshot stream, which is organized as following:
@@ -95,6 +109,12 @@ class SnapshotStreamWriter {
   // the caller.
   StatusOr<bool> Completed() const;
 
+  // Returns the number of chunks committed so far. Committed chunks are named
+  // `chunk_<stream_index>_<chunk_index>` with consecutive chunk indices from
+  // 0, and can be read before the stream is completed. This does not block the
+  // caller.
+  int64_t NumCommittedChunks() const;
+
   // Waits for the writer to finish writing the snapshot stream and returns the
   // final status.
   StatusOr<bool> Wait();
@@ -124,6 +144,11 @@ class SnapshotStreamWriter {
   // Commits the current chunk.
   Status CommitChunk();
 
+  // Adapts the size of the next chunks to the time it took to write and commit
+  // a chunk of `chunk_size_bytes`. See
+  // `SnapshotWriterParams::target_chunk_write_duration`.
+  void AdaptChunkSize(int64_t chunk_size_bytes, absl::Duration write_duration);
+
   // Returns the path of the current chunk.
   std::string GetChunkFilePath() const;
   std::string GetCommittedChunkFilePath() const;
@@ -177,6 +202,8 @@ class SnapshotStreamWriter {
   int64_t chunk_index_ = 0;
   // Size of the current chunk.
   int64_t chunk_size_bytes_ = 0;
+  // Number of bytes after which the current chunk is committed.
+  int64_t chunk_size_limit_bytes_;
 
   // True if the dataset is exhausted.
   bool end_of_sequence_ = false;
@@ -189,6 +216,9 @@ class SnapshotStreamWriter {
   // - If the snapshot has not finished, this is false.
   StatusOr<bool> completed_ TF_GUARDED_BY(mu_) = false;
 
+  // Number of chunks committed so far.
+  int64_t num_committed_chunks_ TF_GUARDED_BY(mu_) = 0;
+
   std::unique_ptr<Thread> snapshot_thread_;
 };
 
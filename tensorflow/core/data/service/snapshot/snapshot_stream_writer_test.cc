@@ -23,6 +23,7 @@ limitations under the License.
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/task_runner.h"
@@ -213,6 +214,35 @@ TEST_P(SnapshotStreamWriterParameterizedTest, WriteSnapshotChunks) {
   }
 }
 
+TEST_P(SnapshotStreamWriterParameterizedTest, AdaptChunkSize) {
+  int64_t range = 10;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                          TestIterator(testing::RangeDataset(range)));
+
+  std::string compression = GetParam();
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  SnapshotWriterParams writer_params{snapshot_path, /*stream_index=*/0,
+                                     compression, Env::Default()};
+  writer_params.target_chunk_write_duration = absl::Hours(1);
+  writer_params.min_chunk_size_bytes = 1;
+  SnapshotStreamWriter snapshot_writer(writer_params, std::move(iterator));
+  EXPECT_THAT(snapshot_writer.Wait(), IsOkAndHolds(true));
+  EXPECT_EQ(snapshot_writer.NumCommittedChunks(), 2);
+
+  // The first chunk has the minimum size. It is written so fast that the next
+  // chunk fits the rest of the dataset.
+  EXPECT_THAT(ReadSnapshot<int64_t>(
+                  tsl::io::JoinPath(CommittedChunksDirectory(snapshot_path),
+                                    "chunk_0_0"),
+                  compression, /*num_elements=*/1),
+              IsOkAndHolds(ElementsAre(0)));
+  EXPECT_THAT(ReadSnapshot<int64_t>(
+                  tsl::io::JoinPath(CommittedChunksDirectory(snapshot_path),
+                                    "chunk_0_1"),
+                  compression, /*num_elements=*/9),
+              IsOkAndHolds(ElementsAre(1, 2, 3, 4, 5, 6, 7, 8, 9)));
+}
+
 TEST_P(SnapshotStreamWriterParameterizedTest, WriteDoneFile) {
   int64_t range = 10;
   TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/core/data/service/split_provider.h"
 
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/data/service/common.pb.h"
@@ -39,15 +41,26 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits) {
     dispatcher_ =
         std::make_unique<DataServiceDispatcherClient>(address_, protocol_);
   }
-  TF_RETURN_IF_ERROR(grpc_util::Retry(
-      [this, split, end_of_splits] {
-        return dispatcher_->GetSplit(iteration_id_, repetition_,
-                                     split_provider_index_, *split,
-                                     *end_of_splits);
-      },
-      "get next split",
-      /*deadline_micros=*/Env::Default()->NowMicros() +
-          (timeout_ms_ * EnvTime::kMillisToMicros)));
+  if (splits_.empty()) {
+    std::vector<Tensor> splits;
+    TF_RETURN_IF_ERROR(grpc_util::Retry(
+        [this, &splits, end_of_splits] {
+          return dispatcher_->GetSplits(iteration_id_, repetition_,
+                                        split_provider_index_,
+                                        splits_per_request_, splits,
+                                        *end_of_splits);
+        },
+        "get next split",
+        /*deadline_micros=*/Env::Default()->NowMicros() +
+            (timeout_ms_ * EnvTime::kMillisToMicros)));
+    splits_.assign(std::make_move_iterator(splits.begin()),
+                   std::make_move_iterator(splits.end()));
+  }
+  *end_of_splits = splits_.empty();
+  if (!*end_of_splits) {
+    *split = std::move(splits_.front());
+    splits_.pop_front();
+  }
   if (*end_of_splits) {
     VLOG(1) << "Reached end of splits for iteration_id=" << iteration_id_
             << ", repetition=" << repetition_;
@@ -62,6 +75,7 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits) {
 Status DataServiceSplitProvider::Reset() {
   mutex_lock l(mu_);
   repetition_++;
+  splits_.clear();
   return OkStatus();
 }
 
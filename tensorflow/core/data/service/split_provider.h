@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 
+#include <algorithm>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
@@ -32,16 +34,19 @@ namespace tensorflow {
 namespace data {
 
 // SplitProvider which reads splits from a tf.data service dispatcher over RPC.
+// Requests `splits_per_request` splits at once, and returns them one by one.
 class DataServiceSplitProvider : public SplitProvider {
  public:
   DataServiceSplitProvider(const std::string& address,
                            const std::string& protocol, int64_t iteration_id,
-                           int64_t split_provider_index, int64_t timeout_ms)
+                           int64_t split_provider_index, int64_t timeout_ms,
+                           int64_t splits_per_request = 1)
       : address_(address),
         protocol_(protocol),
         iteration_id_(iteration_id),
         split_provider_index_(split_provider_index),
-        timeout_ms_(timeout_ms) {}
+        timeout_ms_(timeout_ms),
+        splits_per_request_(std::max<int64_t>(splits_per_request, 1)) {}
 
   Status GetNext(Tensor* split, bool* end_of_splits) override;
   Status Reset() override;
@@ -56,10 +61,13 @@ class DataServiceSplitProvider : public SplitProvider {
   const int64_t iteration_id_;
   const int64_t split_provider_index_;
   const int64_t timeout_ms_;
+  const int64_t splits_per_request_;
 
   mutex mu_;
   int64_t repetition_ = 0;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_;
+  // Splits of the current repetition received but not yet returned.
+  std::deque<Tensor> splits_ TF_GUARDED_BY(mu_);
 };
 
 // Makes split providers for `dataset_def` and stores them in `split_providers`.
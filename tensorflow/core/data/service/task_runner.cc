@@ -16,9 +16,12 @@ limitations under the License.
 
 #include <algorithm>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -34,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -91,8 +95,16 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    CrossTrainerCacheSpillOptions spill_options;
+    if (!worker_config.cross_trainer_cache_spill_dir().empty()) {
+      spill_options.directory =
+          io::JoinPath(worker_config.cross_trainer_cache_spill_dir(),
+                       absl::StrCat("task_", task_def.task_id()));
+      spill_options.max_spill_size_bytes = std::max<int64_t>(
+          worker_config.cross_trainer_cache_spill_size_bytes(), 0);
+    }
+    out = std::make_unique<CachingTaskRunner>(
+        std::move(iterator), max_cache_size_bytes, spill_options);
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -160,13 +172,20 @@ void FirstComeFirstServedTaskRunner::Cancel() {
   buffer_.Cancel(errors::Cancelled("tf.data service FCFS task is cancelled."));
 }
 
-CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                                     size_t max_cache_size_bytes)
+CachingTaskRunner::CachingTaskRunner(
+    std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+    const CrossTrainerCacheSpillOptions& spill_options)
     : fcfs_task_runner_(std::move(iterator)),
       cache_(max_cache_size_bytes,
-             std::make_unique<GetElementResultSequence>(fcfs_task_runner_)) {
+             std::make_unique<GetElementResultSequence>(fcfs_task_runner_),
+             spill_options) {
   LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
             << FormatBytes(max_cache_size_bytes) << " of memory.";
+  if (!spill_options.directory.empty()) {
+    LOG(INFO) << "Spilling up to "
+              << FormatBytes(spill_options.max_spill_size_bytes)
+              << " of evicted elements to " << spill_options.directory << ".";
+  }
 }
 
 CachingTaskRunner::~CachingTaskRunner() { Cancel(); }
@@ -200,6 +219,36 @@ size_t CachingTaskRunner::GetElementResultSequence::GetElementSizeBytes(
   return element.EstimatedMemoryUsageBytes();
 }
 
+StatusOr<std::string>
+CachingTaskRunner::GetElementResultSequence::SerializeElement(
+    const GetElementResult& element) const {
+  GetElementResponse response;
+  TF_RETURN_IF_ERROR(
+      CompressElement(element.components, response.mutable_compressed()));
+  response.set_element_index(element.element_index);
+  response.set_end_of_sequence(element.end_of_sequence);
+  response.set_skip_task(element.skip);
+  return response.SerializeAsString();
+}
+
+StatusOr<GetElementResult>
+CachingTaskRunner::GetElementResultSequence::ParseElement(
+    const std::string& serialized) const {
+  GetElementResponse response;
+  if (!response.ParseFromString(serialized)) {
+    return errors::DataLoss(
+        "Failed to parse a spilled tf.data service cross-trainer cache "
+        "element.");
+  }
+  GetElementResult result;
+  TF_RETURN_IF_ERROR(
+      UncompressElement(response.compressed(), &result.components));
+  result.element_index = response.element_index();
+  result.end_of_sequence = response.end_of_sequence();
+  result.skip = response.skip_task();
+  return result;
+}
+
 void CachingTaskRunner::Cancel() {
   VLOG(2) << "Cancelling tf.data service cross-trainer cache task.";
   if (!cache_.IsCancelled()) {
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/data/service/common.pb.h"
@@ -140,8 +141,9 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
 // read the full dataset.
 class CachingTaskRunner : public TaskRunner {
  public:
-  explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                             size_t max_cache_size_bytes);
+  explicit CachingTaskRunner(
+      std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+      const CrossTrainerCacheSpillOptions& spill_options = {});
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -164,6 +166,10 @@ class CachingTaskRunner : public TaskRunner {
         FirstComeFirstServedTaskRunner& fcfs_task_runner);
     StatusOr<GetElementResult> GetNext() override;
     size_t GetElementSizeBytes(const GetElementResult& element) const override;
+    StatusOr<std::string> SerializeElement(
+        const GetElementResult& element) const override;
+    StatusOr<GetElementResult> ParseElement(
+        const std::string& serialized) const override;
 
    private:
     FirstComeFirstServedTaskRunner& fcfs_task_runner_;
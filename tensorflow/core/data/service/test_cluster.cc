@@ -57,6 +57,8 @@ Status TestCluster::Initialize() {
       config_.job_gc_check_interval_ms);
   dispatcher_config.set_job_gc_timeout_ms(config_.job_gc_timeout_ms);
   dispatcher_config.set_client_timeout_ms(config_.client_timeout_ms);
+  dispatcher_config.set_snapshot_streams_per_worker(
+      config_.snapshot_streams_per_worker);
   TF_RETURN_IF_ERROR(NewDispatchServer(dispatcher_config, dispatcher_));
   TF_RETURN_IF_ERROR(dispatcher_->Start());
   dispatcher_address_ = absl::StrCat("localhost:", dispatcher_->BoundPort());
@@ -75,6 +77,7 @@ Status TestCluster::AddWorker() {
   config.set_dispatcher_address(dispatcher_address_);
   config.set_worker_address("localhost:%port%");
   config.set_heartbeat_interval_ms(config_.worker_heartbeat_interval_ms);
+  config.set_shared_memory_directory(config_.worker_shared_memory_directory);
   TF_RETURN_IF_ERROR(NewWorkerServer(config, worker));
   TF_RETURN_IF_ERROR(worker->Start());
   worker_addresses_.push_back(absl::StrCat("localhost:", worker->BoundPort()));
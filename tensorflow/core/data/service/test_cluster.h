@@ -53,6 +53,8 @@ class TestCluster {
     int64_t worker_heartbeat_interval_ms = 0;
     int64_t job_gc_check_interval_ms = 0;
     int64_t job_gc_timeout_ms = 0;
+    int64_t snapshot_streams_per_worker = 0;
+    std::string worker_shared_memory_directory;
   };
 
   // Creates a new test cluster with a dispatcher and `num_workers` workers.
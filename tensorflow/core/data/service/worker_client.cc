@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/credentials_factory.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/shared_memory.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/service/worker_impl.h"
@@ -41,8 +42,10 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -78,7 +81,8 @@ Status DataServiceWorkerClient::EnsureInitialized() {
 }
 
 std::string DataServiceWorkerClient::GetDataTransferProtocol() const {
-  if (transfer_protocol_ == kGrpcTransferProtocol &&
+  if ((transfer_protocol_ == kGrpcTransferProtocol ||
+       transfer_protocol_ == kSharedMemoryTransferProtocol) &&
       LocalWorkers::Get(address_) != nullptr) {
     return kLocalTransferProtocol;
   }
@@ -87,10 +91,15 @@ std::string DataServiceWorkerClient::GetDataTransferProtocol() const {
 
 void DataServiceWorkerClient::TryCancel() { client_->TryCancel(); }
 
+// Client for the gRPC transfer protocol. If `shared_memory_probe_file` is
+// nonempty, the client sends it with each request so that a worker on the same
+// host can return elements through shared memory.
 class GrpcDataTransferClient : public DataTransferClient {
  public:
   GrpcDataTransferClient(std::shared_ptr<grpc::ChannelCredentials> credentials,
-                         std::string address) {
+                         std::string address,
+                         std::string shared_memory_probe_file = "")
+      : shared_memory_probe_file_(std::move(shared_memory_probe_file)) {
     VLOG(2) << "Create GrpcDataTransferClient for worker " << address << ".";
     grpc::ChannelArguments args;
     args.SetMaxReceiveMessageSize(-1);
@@ -98,8 +107,40 @@ class GrpcDataTransferClient : public DataTransferClient {
     stub_ = WorkerService::NewStub(channel);
   }
 
+  ~GrpcDataTransferClient() override {
+    if (shared_memory_probe_file_.empty()) {
+      return;
+    }
+    Status s = Env::Default()->DeleteFile(shared_memory_probe_file_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete shared memory probe "
+                   << shared_memory_probe_file_ << ": " << s;
+    }
+  }
+
   Status GetElement(const GetElementRequest& req,
                     GetElementResult& result) override {
+    if (!shared_memory_probe_file_.empty()) {
+      GetElementRequest shared_memory_req = req;
+      shared_memory_req.set_shared_memory_probe_file(
+          shared_memory_probe_file_);
+      return GetElementInternal(shared_memory_req, result);
+    }
+    return GetElementInternal(req, result);
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel GrpcDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+  }
+
+ private:
+  Status GetElementInternal(const GetElementRequest& req,
+                            GetElementResult& result) {
     VLOG(3) << "GetElement for task " << req.task_id() << " from gRPC worker "
             << "server.";
     {
@@ -140,22 +181,19 @@ class GrpcDataTransferClient : public DataTransferClient {
           }
         }
         break;
+      case GetElementResponse::kSharedMemoryFile:
+        // Only files next to the probe of this client are read.
+        TF_RETURN_IF_ERROR(ReadElementFromSharedMemory(
+            std::string(io::Dirname(shared_memory_probe_file_)),
+            resp.shared_memory_file(), result.components));
+        break;
       case GetElementResponse::ELEMENT_NOT_SET:
         break;
     }
     return OkStatus();
   }
 
-  void TryCancel() override {
-    VLOG(2) << "Cancel GrpcDataTransferClient.";
-    mutex_lock l(mu_);
-    cancelled_ = true;
-    for (const auto& ctx : active_contexts_) {
-      ctx->TryCancel();
-    }
-  }
-
- private:
+  const std::string shared_memory_probe_file_;
   mutex mu_;
   std::unique_ptr<WorkerService::Stub> stub_;
   // Set of all currently active clients contexts. Used to support
@@ -184,6 +222,26 @@ class GrpcTransferClientRegistrar {
 };
 static GrpcTransferClientRegistrar gprc_client_registrar;
 
+class SharedMemoryTransferClientRegistrar {
+ public:
+  SharedMemoryTransferClientRegistrar() {
+    DataTransferClient::Register(
+        kSharedMemoryTransferProtocol,
+        [](DataTransferClient::Config config,
+           std::unique_ptr<DataTransferClient>* out) {
+          std::shared_ptr<grpc::ChannelCredentials> credentials;
+          TF_RETURN_IF_ERROR(CredentialsFactory::CreateClientCredentials(
+              config.protocol, &credentials));
+          TF_ASSIGN_OR_RETURN(std::string probe_file,
+                              CreateSharedMemoryProbe(kSharedMemoryDirectory));
+          *out = std::make_unique<GrpcDataTransferClient>(
+              credentials, config.address, std::move(probe_file));
+          return OkStatus();
+        });
+  }
+};
+static SharedMemoryTransferClientRegistrar shared_memory_client_registrar;
+
 class LocalDataTransferClient : public DataTransferClient {
  public:
   explicit LocalDataTransferClient(absl::string_view worker_address)
@@ -31,6 +31,9 @@ namespace data {
 
 constexpr const char kLocalTransferProtocol[] = "local";
 constexpr const char kGrpcTransferProtocol[] = "grpc";
+// Sends requests over gRPC, but receives elements through shared memory when
+// the worker runs on the same host as the client.
+constexpr const char kSharedMemoryTransferProtocol[] = "shm";
 
 // Client for communicating with the tf.data service worker.
 class DataServiceWorkerClient : public DataServiceClientBase {
@@ -18,24 +18,34 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/credentials_factory.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
+#include "tensorflow/core/data/service/shared_memory.h"
 #include "tensorflow/core/data/service/test_cluster.h"
 #include "tensorflow/core/data/service/test_util.h"
+#include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/service/worker_impl.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -56,8 +66,14 @@ constexpr const char kProtocol[] = "grpc";
 
 class WorkerClientTest : public ::testing::Test {
  protected:
-  void SetUp() override {
-    test_cluster_ = std::make_unique<TestCluster>(/*num_workers=*/1);
+  void SetUp() override { InitializeTestCluster(); }
+
+  void InitializeTestCluster(
+      const std::string& worker_shared_memory_directory = "") {
+    TestCluster::Config config;
+    config.num_workers = 1;
+    config.worker_shared_memory_directory = worker_shared_memory_directory;
+    test_cluster_ = std::make_unique<TestCluster>(config);
     TF_ASSERT_OK(test_cluster_->Initialize());
     dispatcher_client_ = std::make_unique<DataServiceDispatcherClient>(
         test_cluster_->DispatcherAddress(), kProtocol);
@@ -116,6 +132,25 @@ class WorkerClientTest : public ::testing::Test {
     return result;
   }
 
+  // Sends a GetElement request with `probe_file` to the gRPC server of the
+  // worker, bypassing the client.
+  StatusOr<GetElementResponse> GetElementWithProbe(
+      const int64_t task_id, const std::string& probe_file) {
+    std::shared_ptr<grpc::ChannelCredentials> credentials;
+    TF_RETURN_IF_ERROR(
+        CredentialsFactory::CreateClientCredentials(kProtocol, &credentials));
+    std::unique_ptr<WorkerService::Stub> stub = WorkerService::NewStub(
+        grpc::CreateChannel(GetWorkerAddress(), credentials));
+    grpc::ClientContext ctx;
+    GetElementRequest request;
+    GetElementResponse response;
+    request.set_task_id(task_id);
+    request.set_shared_memory_probe_file(probe_file);
+    TF_RETURN_IF_ERROR(
+        FromGrpcStatus(stub->GetElement(&ctx, request, &response)));
+    return response;
+  }
+
   std::string GetDispatcherAddress() const {
     return test_cluster_->DispatcherAddress();
   }
@@ -197,6 +232,105 @@ TEST_F(WorkerClientTest, GrpcRead) {
                        MatchesRegex("Local worker.*is no longer available.*")));
 }
 
+// Workers writing elements to the shared memory directory of the clients.
+class SharedMemoryWorkerClientTest : public WorkerClientTest {
+ protected:
+  void SetUp() override {
+    if (!Env::Default()->IsDirectory(kSharedMemoryDirectory).ok()) {
+      GTEST_SKIP() << kSharedMemoryDirectory << " is not available.";
+    }
+    InitializeTestCluster(kSharedMemoryDirectory);
+  }
+};
+
+TEST_F(SharedMemoryWorkerClientTest, SharedMemoryRead) {
+  const int64_t range = 5;
+  TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id, RegisterDataset(range));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t iteration_client_id,
+                          CreateIteration(dataset_id));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t task_id,
+                          GetTaskToRead(iteration_client_id));
+  // Removes the worker from `LocalWorkers`, so that the client reads from it
+  // as if it were another process on the same host.
+  LocalWorkers::Remove(GetWorkerAddress());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataServiceWorkerClient> client,
+                          GetWorkerClient(kSharedMemoryTransferProtocol));
+  for (int64_t i = 0; i < range; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                            GetElement(*client, task_id));
+    test::ExpectEqual(result.components[0], Tensor(int64_t{i * i}));
+    EXPECT_FALSE(result.end_of_sequence);
+  }
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                          GetElement(*client, task_id));
+  EXPECT_TRUE(result.end_of_sequence);
+}
+
+TEST_F(SharedMemoryWorkerClientTest, WorkerOnlyHonorsConfiguredDirectory) {
+  TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id,
+                          RegisterDataset(/*range=*/3));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t iteration_client_id,
+                          CreateIteration(dataset_id));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t task_id,
+                          GetTaskToRead(iteration_client_id));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::string probe_file,
+                          CreateSharedMemoryProbe(kSharedMemoryDirectory));
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResponse response,
+                          GetElementWithProbe(task_id, probe_file));
+  ASSERT_EQ(response.element_case(), GetElementResponse::kSharedMemoryFile);
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(ReadElementFromSharedMemory(
+      kSharedMemoryDirectory, response.shared_memory_file(), element));
+  test::ExpectEqual(element[0], Tensor(int64_t{0}));
+
+  // A probe reached through ".." is returned through gRPC.
+  TF_ASSERT_OK_AND_ASSIGN(
+      response,
+      GetElementWithProbe(
+          task_id, io::JoinPath(kSharedMemoryDirectory, "..",
+                                io::Basename(kSharedMemoryDirectory),
+                                io::Basename(probe_file))));
+  EXPECT_NE(response.element_case(), GetElementResponse::kSharedMemoryFile);
+  TF_ASSERT_OK(Env::Default()->DeleteFile(probe_file));
+
+  // So is a probe outside of the directory of the worker.
+  TF_ASSERT_OK_AND_ASSIGN(probe_file,
+                          CreateSharedMemoryProbe(::testing::TempDir()));
+  TF_ASSERT_OK_AND_ASSIGN(response, GetElementWithProbe(task_id, probe_file));
+  EXPECT_NE(response.element_case(), GetElementResponse::kSharedMemoryFile);
+  EXPECT_FALSE(response.end_of_sequence());
+  TF_ASSERT_OK(Env::Default()->DeleteFile(probe_file));
+}
+
+TEST_F(WorkerClientTest, SharedMemoryReadWithoutConfiguredDirectory) {
+  if (!Env::Default()->IsDirectory(kSharedMemoryDirectory).ok()) {
+    GTEST_SKIP() << kSharedMemoryDirectory << " is not available.";
+  }
+  const int64_t range = 3;
+  TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id, RegisterDataset(range));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t iteration_client_id,
+                          CreateIteration(dataset_id));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t task_id,
+                          GetTaskToRead(iteration_client_id));
+  TF_ASSERT_OK_AND_ASSIGN(std::string probe_file,
+                          CreateSharedMemoryProbe(kSharedMemoryDirectory));
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResponse response,
+                          GetElementWithProbe(task_id, probe_file));
+  EXPECT_NE(response.element_case(), GetElementResponse::kSharedMemoryFile);
+  TF_ASSERT_OK(Env::Default()->DeleteFile(probe_file));
+
+  // The client falls back to reading the elements through gRPC.
+  LocalWorkers::Remove(GetWorkerAddress());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataServiceWorkerClient> client,
+                          GetWorkerClient(kSharedMemoryTransferProtocol));
+  for (int64_t i = 1; i < range; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                            GetElement(*client, task_id));
+    test::ExpectEqual(result.components[0], Tensor(int64_t{i * i}));
+  }
+}
+
 TEST_F(WorkerClientTest, LocalServerShutsDown) {
   TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id,
                           RegisterDataset(/*range=*/5));
@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/export.pb.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/shared_memory.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/snapshot/snapshot_stream_writer.h"
 #include "tensorflow/core/data/service/split_provider.h"
@@ -71,6 +72,9 @@ namespace {
 constexpr absl::Duration kRetryInterval = absl::Seconds(5);
 constexpr absl::Duration kDefaultHeartBeatInterval = absl::Seconds(30);
 constexpr absl::Duration kDefaultDispatcherTimeout = absl::Hours(1);
+// How long writing and committing a snapshot chunk should take, so that
+// readers can consume the chunks of a snapshot while it is being written.
+constexpr absl::Duration kSnapshotChunkWriteDuration = absl::Minutes(1);
 
 using WorkerConfig = experimental::WorkerConfig;
 
@@ -387,7 +391,8 @@ DataServiceWorkerImpl::MakeDatasetIterator(standalone::Dataset& dataset,
     for (int i = 0; i < task_def.num_split_providers(); ++i) {
       split_providers.push_back(std::make_unique<DataServiceSplitProvider>(
           config_.dispatcher_address(), config_.protocol(),
-          task_def.iteration_id(), i, config_.dispatcher_timeout_ms()));
+          task_def.iteration_id(), i, config_.dispatcher_timeout_ms(),
+          config_.splits_per_request()));
     }
     TF_RETURN_IF_ERROR(
         dataset.MakeIterator(std::move(split_providers), &iterator));
@@ -420,8 +425,16 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
   response->set_end_of_sequence(result.end_of_sequence);
   response->set_skip_task(result.skip);
   if (!response->end_of_sequence() && !response->skip_task()) {
-    TF_RETURN_IF_ERROR(
-        MoveElementToResponse(std::move(result.components), *response));
+    if (IsSharedMemoryProbe(config_.shared_memory_directory(),
+                            request->shared_memory_probe_file())) {
+      TF_ASSIGN_OR_RETURN(
+          *response->mutable_shared_memory_file(),
+          WriteElementToSharedMemory(config_.shared_memory_directory(),
+                                     result.components));
+    } else {
+      TF_RETURN_IF_ERROR(
+          MoveElementToResponse(std::move(result.components), *response));
+    }
     VLOG(3) << "Producing an element for task " << request->task_id();
   }
   return OkStatus();
@@ -566,6 +579,7 @@ DataServiceWorkerImpl::GetSnapshotTaskProgress() const {
       progress.set_error_code(completed.status().code());
       progress.set_error_message(completed.status().error_message());
     }
+    progress.set_num_committed_chunks(stream_writer->NumCommittedChunks());
     snapshot_task_progress.push_back(std::move(progress));
   }
   return snapshot_task_progress;
@@ -615,15 +629,15 @@ Status DataServiceWorkerImpl::UpdateSnapshotWriters(
                         MakeSnapshotTaskIterator(dataset_def));
 
     // TODO(b/258691097): Support compression.
+    SnapshotWriterParams params{snapshot_task.base_path(),
+                                snapshot_task.stream_index(),
+                                tsl::io::compression::kNone, Env::Default()};
+    params.target_chunk_write_duration = kSnapshotChunkWriteDuration;
     // TODO(b/258691097): If the response does not contain a snapshot task,
     // cancel it from `snapshot_writers_`.
     snapshot_writers_.try_emplace(
         SnapshotTask{snapshot_task.base_path(), snapshot_task.stream_index()},
-        std::make_unique<SnapshotStreamWriter>(
-            SnapshotWriterParams{snapshot_task.base_path(),
-                                 snapshot_task.stream_index(),
-                                 tsl::io::compression::kNone, Env::Default()},
-            std::move(iterator)));
+        std::make_unique<SnapshotStreamWriter>(params, std::move(iterator)));
   }
   return OkStatus();
 }
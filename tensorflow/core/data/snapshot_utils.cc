@@ -44,6 +44,9 @@ limitations under the License.
 #include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tensorflow/tsl/lib/io/snappy/snappy_inputbuffer.h"
 #include "tensorflow/tsl/lib/io/snappy/snappy_outputbuffer.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_inputstream.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_outputbuffer.h"
 
 namespace tensorflow {
 namespace data {
@@ -189,15 +192,21 @@ Status CustomWriter::Initialize(tensorflow::Env* env) {
   }
 #else   // IS_SLIM_BUILD
   if (compression_type_ == io::compression::kGzip) {
-    zlib_underlying_dest_.swap(dest_);
+    underlying_dest_.swap(dest_);
     io::ZlibCompressionOptions zlib_options;
     zlib_options = io::ZlibCompressionOptions::GZIP();
 
     io::ZlibOutputBuffer* zlib_output_buffer = new io::ZlibOutputBuffer(
-        zlib_underlying_dest_.get(), zlib_options.input_buffer_size,
+        underlying_dest_.get(), zlib_options.input_buffer_size,
         zlib_options.output_buffer_size, zlib_options);
     TF_CHECK_OK(zlib_output_buffer->Init());
     dest_.reset(zlib_output_buffer);
+  } else if (compression_type_ == io::compression::kZstd) {
+    underlying_dest_.swap(dest_);
+    auto zstd_output_buffer = std::make_unique<tsl::io::ZstdOutputBuffer>(
+        underlying_dest_.get(), tsl::io::ZstdCompressionOptions());
+    TF_RETURN_IF_ERROR(zstd_output_buffer->Init());
+    dest_ = std::move(zstd_output_buffer);
   }
 #endif  // IS_SLIM_BUILD
   simple_tensor_mask_.reserve(dtypes_.size());
@@ -304,9 +313,9 @@ Status CustomWriter::Close() {
     TF_RETURN_IF_ERROR(dest_->Close());
     dest_ = nullptr;
   }
-  if (zlib_underlying_dest_ != nullptr) {
-    TF_RETURN_IF_ERROR(zlib_underlying_dest_->Close());
-    zlib_underlying_dest_ = nullptr;
+  if (underlying_dest_ != nullptr) {
+    TF_RETURN_IF_ERROR(underlying_dest_->Close());
+    underlying_dest_ = nullptr;
   }
   return OkStatus();
 }
@@ -767,6 +776,10 @@ Status CustomReader::Initialize(Env* env) {
     input_stream_ = std::make_unique<io::ZlibInputStream>(
         input_stream_.release(), zlib_options.input_buffer_size,
         zlib_options.output_buffer_size, zlib_options, true);
+  } else if (compression_type_ == io::compression::kZstd) {
+    input_stream_ = std::make_unique<tsl::io::ZstdInputStream>(
+        input_stream_.release(), tsl::io::ZstdCompressionOptions(),
+        /*owns_input_stream=*/true);
   } else if (compression_type_ == io::compression::kSnappy) {
     if (version_ == 0) {
       input_stream_ = std::make_unique<tsl::io::SnappyInputBuffer>(
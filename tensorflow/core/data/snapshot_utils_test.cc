@@ -89,10 +89,12 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kNone, 1);
   SnapshotRoundTrip(io::compression::kGzip, 1);
   SnapshotRoundTrip(io::compression::kSnappy, 1);
+  SnapshotRoundTrip(io::compression::kZstd, 1);
 
   SnapshotRoundTrip(io::compression::kNone, 2);
   SnapshotRoundTrip(io::compression::kGzip, 2);
   SnapshotRoundTrip(io::compression::kSnappy, 2);
+  SnapshotRoundTrip(io::compression::kZstd, 2);
 }
 
 TEST(SnapshotUtilTest, MetadataFileRoundTrip) {
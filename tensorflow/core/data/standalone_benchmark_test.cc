@@ -0,0 +1,367 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// End to end benchmarks of canonical tf.data input pipelines, run through the
+// standalone API on reproducible synthetic data. Besides the elements per
+// second, each benchmark reports the process CPU time per element and the
+// time it takes the autotuner to reach steady state throughput. Run with
+// `--benchmark_filter=all --benchmark_format=json` to get machine readable
+// results for tracking across versions.
+
+#include <algorithm>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace standalone {
+namespace {
+
+using ::tensorflow::test::AsScalar;
+using ::tensorflow::test::function::GDef;
+using ::tensorflow::test::function::NDef;
+
+constexpr int64_t kNumRecords = 4096;
+constexpr int64_t kRecordSize = 256;  // Floats per record.
+constexpr int64_t kNumFiles = 8;
+constexpr int64_t kBatchSize = 32;
+constexpr int64_t kAutotune = -1;
+
+// Number of batches over which throughput is measured to detect when the
+// autotuner has converged.
+constexpr int kConvergenceWindow = 64;
+
+// Throughput relative to the steady state one at which the autotuner is
+// considered to have converged.
+constexpr double kConvergenceThreshold = 0.9;
+
+// Returns the value of element `i` of record `record`. Records are the same on
+// every run so that results are comparable across versions.
+float RecordValue(int64_t record, int64_t i) {
+  return static_cast<float>((record * 7919 + i * 104729) % 65536) / 65536.0f;
+}
+
+FunctionDef ParseRecord() {
+  return FunctionDefHelper::Create(
+      /*function_name=*/"ParseRecord",
+      /*in_def=*/{"record: string"},
+      /*out_def=*/{"values: float"},
+      /*attr_def=*/{},
+      /*node_def=*/
+      {{{"values"}, "DecodeRaw", {"record"}, {{"out_type", DT_FLOAT}}}},
+      /*ret_def=*/{{"values", "values:output:0"}});
+}
+
+FunctionDef SquareRecord() {
+  return FunctionDefHelper::Create(
+      /*function_name=*/"SquareRecord",
+      /*in_def=*/{"x: float"},
+      /*out_def=*/{"y: float"},
+      /*attr_def=*/{},
+      /*node_def=*/{{{"y"}, "Square", {"x"}, {{"T", DT_FLOAT}}}},
+      /*ret_def=*/{{"y", "y:y:0"}});
+}
+
+FunctionDef ReadTFRecords() {
+  return FunctionDefHelper::Create(
+      /*function_name=*/"ReadTFRecords",
+      /*in_def=*/{"filename: string"},
+      /*out_def=*/{"records: variant"},
+      /*attr_def=*/{},
+      /*node_def=*/
+      {{{"compression_type"},
+        "Const",
+        {},
+        {{"value", AsScalar<tstring>("")}, {"dtype", DT_STRING}}},
+       {{"buffer_size"},
+        "Const",
+        {},
+        {{"value", AsScalar<int64_t>(256 << 10)}, {"dtype", DT_INT64}}},
+       {{"records"},
+        "TFRecordDataset",
+        {"filename", "compression_type:output:0", "buffer_size:output:0"},
+        {}}},
+      /*ret_def=*/{{"records", "records:handle:0"}});
+}
+
+NodeDef ConstNode(const std::string& name, const Tensor& value) {
+  return NDef(name, "Const", /*inputs=*/{},
+              {{"value", value}, {"dtype", value.dtype()}});
+}
+
+NodeDef ParallelMapNode(const std::string& name, const std::string& input,
+                        const std::string& num_parallel_calls,
+                        const std::string& function_name,
+                        const TensorShape& output_shape) {
+  return NDef(name, "ParallelMapDatasetV2", {input, num_parallel_calls},
+              {{"f", FunctionDefHelper::FunctionRef(function_name)},
+               {"Targuments", DataTypeSlice{}},
+               {"output_shapes", gtl::ArraySlice<TensorShape>{output_shape}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_FLOAT}},
+               {"deterministic", "true"},
+               {"preserve_cardinality", true}});
+}
+
+// Returns the nodes that repeat `input` forever and then apply
+// map(Square) -> batch -> prefetch, with autotuned parallelism and buffer
+// size.
+std::vector<NodeDef> MapBatchPrefetchNodes(const std::string& input) {
+  const TensorShape record_shape({kRecordSize});
+  const TensorShape batch_shape({kBatchSize, kRecordSize});
+  return {
+      ConstNode("count", AsScalar<int64_t>(-1)),
+      NDef("repeat", "RepeatDataset", {input, "count"},
+           {{"output_shapes", gtl::ArraySlice<TensorShape>{record_shape}},
+            {"output_types", gtl::ArraySlice<DataType>{DT_FLOAT}}}),
+      ConstNode("autotune", AsScalar<int64_t>(kAutotune)),
+      ParallelMapNode("map", "repeat", "autotune", "SquareRecord",
+                      record_shape),
+      ConstNode("batch_size", AsScalar<int64_t>(kBatchSize)),
+      ConstNode("drop_remainder", AsScalar<bool>(true)),
+      NDef("batch", "BatchDatasetV2", {"map", "batch_size", "drop_remainder"},
+           {{"output_shapes", gtl::ArraySlice<TensorShape>{batch_shape}},
+            {"output_types", gtl::ArraySlice<DataType>{DT_FLOAT}}}),
+      NDef("prefetch", "PrefetchDataset", {"batch", "autotune"},
+           {{"output_shapes", gtl::ArraySlice<TensorShape>{batch_shape}},
+            {"output_types", gtl::ArraySlice<DataType>{DT_FLOAT}}}),
+      NDef("dataset", "_Retval", {"prefetch"},
+           {{"T", DT_VARIANT}, {"index", 0}}),
+  };
+}
+
+// Returns the graph of
+//   from_tensor_slices(records).repeat().map(square).batch().prefetch()
+// over records held in memory.
+GraphDef InMemoryPipeline() {
+  Tensor records(DT_FLOAT, TensorShape({kNumRecords, kRecordSize}));
+  auto records_matrix = records.matrix<float>();
+  for (int64_t record = 0; record < kNumRecords; ++record) {
+    for (int64_t i = 0; i < kRecordSize; ++i) {
+      records_matrix(record, i) = RecordValue(record, i);
+    }
+  }
+  std::vector<NodeDef> nodes = {
+      ConstNode("records", records),
+      NDef("source", "TensorSliceDataset", {"records"},
+           {{"Toutput_types", gtl::ArraySlice<DataType>{DT_FLOAT}},
+            {"output_shapes",
+             gtl::ArraySlice<TensorShape>{TensorShape({kRecordSize})}}}),
+  };
+  for (NodeDef& node : MapBatchPrefetchNodes("source")) {
+    nodes.push_back(std::move(node));
+  }
+  return GDef(nodes, {SquareRecord()});
+}
+
+// Writes the records to `kNumFiles` TFRecord files in a temporary directory
+// and returns their names.
+StatusOr<std::vector<tstring>> WriteTFRecordFiles() {
+  std::string directory;
+  if (!Env::Default()->LocalTempFilename(&directory)) {
+    return errors::Internal("Failed to create a temporary file name.");
+  }
+  TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(directory));
+  std::vector<tstring> filenames;
+  std::vector<float> values(kRecordSize);
+  for (int64_t file = 0; file < kNumFiles; ++file) {
+    filenames.push_back(
+        io::JoinPath(directory, absl::StrCat("records_", file)));
+    std::unique_ptr<WritableFile> writable_file;
+    TF_RETURN_IF_ERROR(
+        Env::Default()->NewWritableFile(filenames.back(), &writable_file));
+    io::RecordWriter writer(writable_file.get());
+    for (int64_t record = file; record < kNumRecords; record += kNumFiles) {
+      for (int64_t i = 0; i < kRecordSize; ++i) {
+        values[i] = RecordValue(record, i);
+      }
+      TF_RETURN_IF_ERROR(writer.WriteRecord(
+          StringPiece(reinterpret_cast<const char*>(values.data()),
+                      values.size() * sizeof(float))));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(writable_file->Close());
+  }
+  return filenames;
+}
+
+// Returns the graph of
+//   from_tensor_slices(filenames).interleave(TFRecordDataset).map(parse)
+//       .repeat().map(square).batch().prefetch()
+// over records read from `filenames`.
+GraphDef OnDiskPipeline(const std::vector<tstring>& filenames) {
+  std::vector<NodeDef> nodes = {
+      ConstNode("filenames",
+                test::AsTensor<tstring>(
+                    filenames,
+                    TensorShape({static_cast<int64_t>(filenames.size())}))),
+      NDef("files", "TensorSliceDataset", {"filenames"},
+           {{"Toutput_types", gtl::ArraySlice<DataType>{DT_STRING}},
+            {"output_shapes", gtl::ArraySlice<TensorShape>{TensorShape()}},
+            {"is_files", true}}),
+      ConstNode("cycle_length", AsScalar<int64_t>(kNumFiles)),
+      ConstNode("block_length", AsScalar<int64_t>(1)),
+      NDef("interleave", "InterleaveDataset",
+           {"files", "cycle_length", "block_length"},
+           {{"f", FunctionDefHelper::FunctionRef("ReadTFRecords")},
+            {"Targuments", DataTypeSlice{}},
+            {"output_shapes", gtl::ArraySlice<TensorShape>{TensorShape()}},
+            {"output_types", gtl::ArraySlice<DataType>{DT_STRING}}}),
+      ConstNode("parse_parallelism", AsScalar<int64_t>(kAutotune)),
+      ParallelMapNode("parse", "interleave", "parse_parallelism", "ParseRecord",
+                      TensorShape({kRecordSize})),
+  };
+  for (NodeDef& node : MapBatchPrefetchNodes("parse")) {
+    nodes.push_back(std::move(node));
+  }
+  return GDef(nodes, {ReadTFRecords(), ParseRecord(), SquareRecord()});
+}
+
+// Returns the time in microseconds from the start of the run after which the
+// throughput over every window of `kConvergenceWindow` batches is within
+// `kConvergenceThreshold` of the throughput over the second half of the run,
+// given the completion time of every batch.
+double ConvergenceTimeUsecs(const std::vector<uint64>& batch_end_usecs,
+                            uint64 start_usecs) {
+  const int num_batches = batch_end_usecs.size();
+  if (num_batches < 2 * kConvergenceWindow) return 0;
+  const int half = num_batches / 2;
+  const double steady_batches_per_usec =
+      static_cast<double>(num_batches - 1 - half) /
+      std::max<uint64>(batch_end_usecs.back() - batch_end_usecs[half], 1);
+  for (int end = num_batches - 1; end >= kConvergenceWindow; --end) {
+    const int begin = end - kConvergenceWindow;
+    const double batches_per_usec =
+        static_cast<double>(kConvergenceWindow) /
+        std::max<uint64>(batch_end_usecs[end] - batch_end_usecs[begin], 1);
+    if (batches_per_usec < kConvergenceThreshold * steady_batches_per_usec) {
+      return batch_end_usecs[end] - start_usecs;
+    }
+  }
+  return 0;
+}
+
+void RunPipeline(const GraphDef& graph_def,
+                 ::testing::benchmark::State& state) {
+  std::unique_ptr<Dataset> dataset;
+  TF_CHECK_OK(Dataset::FromGraph({}, graph_def, &dataset));
+  std::unique_ptr<Iterator> iterator;
+  TF_CHECK_OK(dataset->MakeIterator(&iterator));
+
+  std::vector<uint64> batch_end_usecs;
+  const std::clock_t start_cpu = std::clock();
+  const uint64 start_usecs = Env::Default()->NowMicros();
+  for (auto _ : state) {
+    std::vector<Tensor> outputs;
+    bool end_of_input = false;
+    TF_CHECK_OK(iterator->GetNext(&outputs, &end_of_input));
+    CHECK(!end_of_input);
+    batch_end_usecs.push_back(Env::Default()->NowMicros());
+  }
+  const double cpu_usecs =
+      1e6 * static_cast<double>(std::clock() - start_cpu) / CLOCKS_PER_SEC;
+
+  const int64_t num_elements = state.iterations() * kBatchSize;
+  state.SetItemsProcessed(num_elements);
+  state.counters["cpu_usecs_per_element"] = cpu_usecs / num_elements;
+  if (!batch_end_usecs.empty()) {
+    state.counters["first_batch_usecs"] = batch_end_usecs[0] - start_usecs;
+  }
+  state.counters["autotune_convergence_usecs"] =
+      ConvergenceTimeUsecs(batch_end_usecs, start_usecs);
+}
+
+void BM_InMemoryPipeline(::testing::benchmark::State& state) {
+  RunPipeline(InMemoryPipeline(), state);
+}
+
+BENCHMARK(BM_InMemoryPipeline)->UseRealTime()->MinTime(2.0);
+
+void BM_OnDiskPipeline(::testing::benchmark::State& state) {
+  StatusOr<std::vector<tstring>> filenames = WriteTFRecordFiles();
+  TF_CHECK_OK(filenames.status());
+  RunPipeline(OnDiskPipeline(*filenames), state);
+}
+
+BENCHMARK(BM_OnDiskPipeline)->UseRealTime()->MinTime(2.0);
+
+// Checks that the pipelines produce the records they are built from.
+void ExpectSquaredRecordBatches(const GraphDef& graph_def) {
+  std::unique_ptr<Dataset> dataset;
+  TF_ASSERT_OK(Dataset::FromGraph({}, graph_def, &dataset));
+  std::unique_ptr<Iterator> iterator;
+  TF_ASSERT_OK(dataset->MakeIterator(&iterator));
+  std::vector<int64_t> num_seen(kNumRecords, 0);
+  for (int64_t batch = 0; batch < 2 * kNumRecords / kBatchSize; ++batch) {
+    std::vector<Tensor> outputs;
+    bool end_of_input = false;
+    TF_ASSERT_OK(iterator->GetNext(&outputs, &end_of_input));
+    ASSERT_FALSE(end_of_input);
+    ASSERT_EQ(outputs.size(), 1);
+    ASSERT_EQ(outputs[0].shape(), TensorShape({kBatchSize, kRecordSize}));
+    auto values = outputs[0].matrix<float>();
+    for (int64_t i = 0; i < kBatchSize; ++i) {
+      // Recovers the record from its first value, which is unique.
+      int64_t record = 0;
+      while (record < kNumRecords &&
+             RecordValue(record, 0) * RecordValue(record, 0) != values(i, 0)) {
+        ++record;
+      }
+      ASSERT_LT(record, kNumRecords);
+      EXPECT_EQ(values(i, kRecordSize - 1),
+                RecordValue(record, kRecordSize - 1) *
+                    RecordValue(record, kRecordSize - 1));
+      ++num_seen[record];
+    }
+  }
+  for (int64_t record = 0; record < kNumRecords; ++record) {
+    EXPECT_EQ(num_seen[record], 2) << "record " << record;
+  }
+}
+
+TEST(StandaloneBenchmarkTest, InMemoryPipeline) {
+  ExpectSquaredRecordBatches(InMemoryPipeline());
+}
+
+TEST(StandaloneBenchmarkTest, OnDiskPipeline) {
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<tstring> filenames,
+                          WriteTFRecordFiles());
+  ExpectSquaredRecordBatches(OnDiskPipeline(filenames));
+}
+
+}  // namespace
+}  // namespace standalone
+}  // namespace data
+}  // namespace tensorflow
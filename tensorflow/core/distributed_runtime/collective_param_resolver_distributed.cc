@@ -72,6 +72,9 @@ class CompleteInstanceCall : public CancellableCall {
     }
     req_.set_device(device_name);
     req_.set_is_source(is_source);
+    req_.set_compression(instance.impl_details.compression);
+    req_.set_topk_ratio(instance.impl_details.topk_ratio);
+    req_.set_min_contributions(instance.impl_details.min_contributions);
   }
 
   ~CompleteInstanceCall() override {}
@@ -178,6 +181,10 @@ void CollectiveParamResolverDistributed::CompleteInstanceAsync(
   for (int32_t offset : request->subdiv_offset()) {
     cp->instance.impl_details.subdiv_offsets.push_back(offset);
   }
+  cp->instance.impl_details.compression =
+      static_cast<CollectiveCompression>(request->compression());
+  cp->instance.impl_details.topk_ratio = request->topk_ratio();
+  cp->instance.impl_details.min_contributions = request->min_contributions();
   StatusCallback done_and_cleanup = [cp, done](const Status& s) {
     done(s);
     cp->Unref();
@@ -67,6 +67,8 @@ class MockCoordinationServiceAgent : public CoordinationServiceAgent {
                       const CoordinationServiceConfig& configs,
                       std::unique_ptr<CoordinationClient> leader_client,
                       StatusCallback error_fn));
+  MOCK_METHOD1(SetAggregationParentClient,
+               Status(std::unique_ptr<CoordinationClient> parent_client));
   MOCK_METHOD0(IsInitialized, bool());
   MOCK_METHOD0(IsConnected, bool());
   MOCK_METHOD0(IsError, bool());
@@ -95,6 +97,18 @@ class MockCoordinationServiceAgent : public CoordinationServiceAgent {
   MOCK_METHOD1(DeleteKeyValue, Status(const std::string& key));
   MOCK_METHOD2(UpdateKeyValue,
                Status(const std::string& key, const std::string& value));
+  MOCK_METHOD1(InsertKeyValues, Status(const std::vector<KeyValueEntry>& kvs));
+  MOCK_METHOD2(GetKeyValues, StatusOr<std::vector<std::string>>(
+                                 const std::vector<std::string>& keys,
+                                 absl::Duration timeout));
+  MOCK_METHOD3(WatchKeyValueDir,
+               StatusOr<std::vector<KeyValueEntry>>(const std::string& key,
+                                                    int64_t min_entries,
+                                                    absl::Duration timeout));
+  MOCK_METHOD2(InsertLargeKeyValue,
+               Status(const std::string& key, const std::string& value));
+  MOCK_METHOD2(GetLargeKeyValue, StatusOr<std::string>(const std::string& key,
+                                                       absl::Duration timeout));
   MOCK_METHOD2(StartWatchKey, Status(const std::string& key,
                                      ChangedKeyValuesCallback on_change));
   MOCK_METHOD1(StopWatchKey, Status(const std::string& key));
@@ -104,11 +118,14 @@ class MockCoordinationServiceAgent : public CoordinationServiceAgent {
                     StatusCallback done));
   MOCK_METHOD2(CancelBarrierAsync,
                void(const std::string& barrier_id, StatusCallback done));
+  MOCK_METHOD1(GetAliveTasks, StatusOr<std::vector<CoordinatedTask>>(
+                                   const std::vector<CoordinatedTask>& tasks));
   MOCK_METHOD0(GetEnv, StatusOr<Env*>());
   MOCK_METHOD1(SetError, void(const Status& error));
   MOCK_METHOD2(ActivateWatch,
                Status(const std::string& key,
                       const std::map<std::string, std::string>&));
+  MOCK_METHOD0(GetAggregator, tsl::CoordinationAggregator*());
   // NOLINTEND
 };
 
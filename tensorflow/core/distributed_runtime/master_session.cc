@@ -2017,6 +2017,12 @@ Status MasterSession::MakeCallable(const MakeCallableRequest& req,
   opts.callable_options = req.options();
   opts.use_function_convention = false;
 
+  if (req.options().prefetch_steps() > 0 && req.options().feed_size() > 0) {
+    return errors::InvalidArgument(
+        "CallableOptions.prefetch_steps is only supported for callables "
+        "without feeds.");
+  }
+
   ReffedClientGraph* callable;
 
   {
@@ -2083,6 +2089,7 @@ Status MasterSession::RunCallable(CallOptions* opts,
                                   RunCallableResponse* resp) {
   UpdateLastAccessTime();
   ReffedClientGraph* callable;
+  std::shared_ptr<PrefetchedStep> prefetched;
   {
     mutex_lock l(mu_);
     if (closed_) {
@@ -2098,13 +2105,63 @@ Status MasterSession::RunCallable(CallOptions* opts,
           "Attempted to run callable after handle was released: ", handle);
     }
     callable = iter->second;
-    callable->Ref();
-    ++num_running_;
+    const int32 prefetch_steps =
+        callable->callable_options().prefetch_steps();
+    if (prefetch_steps > 0) {
+      // Hand out the oldest in-flight step and top the queue back up, so
+      // that the workers already run the following steps while the client
+      // consumes this one.
+      PrefetchQueue* queue = &prefetched_steps_[handle];
+      if (queue->empty()) {
+        StartPrefetchedStep(callable, queue);
+      }
+      prefetched = std::move(queue->front());
+      queue->pop_front();
+      while (queue->size() < static_cast<size_t>(prefetch_steps)) {
+        StartPrefetchedStep(callable, queue);
+      }
+    } else {
+      callable->Ref();
+      ++num_running_;
+    }
+  }
+  if (prefetched != nullptr) {
+    return WaitForPrefetchedStep(opts, prefetched.get(), resp);
   }
   core::ScopedUnref unref_callable(callable);
   return DoRunCallable(opts, callable, req, resp);
 }
 
+void MasterSession::StartPrefetchedStep(ReffedClientGraph* rcg,
+                                        PrefetchQueue* queue) {
+  auto step = std::make_shared<PrefetchedStep>();
+  ++num_running_;
+  rcg->Ref();
+  Ref();
+  SchedClosure([this, rcg, step]() {
+    step->status =
+        DoRunCallable(&step->call_opts, rcg, step->req, &step->resp);
+    step->done.Notify();
+    rcg->Unref();
+    Unref();
+  });
+  queue->push_back(std::move(step));
+}
+
+Status MasterSession::WaitForPrefetchedStep(CallOptions* opts,
+                                            PrefetchedStep* step,
+                                            RunCallableResponse* resp) {
+  // The step runs with its own call options because it may have been started
+  // before `opts` existed; forward cancellation from the client to it.
+  opts->SetCancelCallback([step]() { step->call_opts.StartCancel(); });
+  step->done.WaitForNotification();
+  opts->ClearCancelCallback();
+  if (step->status.ok()) {
+    resp->Swap(&step->resp);
+  }
+  return step->status;
+}
+
 Status MasterSession::ReleaseCallable(const ReleaseCallableRequest& req,
                                       ReleaseCallableResponse* resp) {
   UpdateLastAccessTime();
@@ -2116,6 +2173,9 @@ Status MasterSession::ReleaseCallable(const ReleaseCallableRequest& req,
       to_unref = iter->second;
       callables_.erase(iter);
     }
+    // Steps still in flight hold their own references and finish in the
+    // background; their results are discarded.
+    prefetched_steps_.erase(req.handle());
   }
   if (to_unref != nullptr) {
     to_unref->Unref();
@@ -2138,6 +2198,7 @@ Status MasterSession::Close() {
     ClearRunsTable(&to_unref, &run_graphs_);
     ClearRunsTable(&to_unref, &partial_run_graphs_);
     ClearRunsTable(&to_unref, &callables_);
+    prefetched_steps_.clear();
   }
   for (ReffedClientGraph* rcg : to_unref) rcg->Unref();
   if (should_delete_worker_sessions_) {
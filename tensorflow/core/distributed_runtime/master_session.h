@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_MASTER_SESSION_H_
 
 #include <atomic>
+#include <deque>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
@@ -27,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/master_env.h"
 #include "tensorflow/core/distributed_runtime/message_wrappers.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/master.pb.h"
@@ -157,6 +160,20 @@ class MasterSession : public core::RefCounted {
   int64_t next_callable_handle_ TF_GUARDED_BY(mu_) = 0;
   RCGMap callables_ TF_GUARDED_BY(mu_);
 
+  // A step of a callable started ahead of the RunCallable() call that returns
+  // its result. See `CallableOptions.prefetch_steps`.
+  struct PrefetchedStep {
+    CallOptions call_opts;
+    RunCallableRequest req;
+    RunCallableResponse resp;
+    Status status;
+    Notification done;
+  };
+  typedef std::deque<std::shared_ptr<PrefetchedStep>> PrefetchQueue;
+  // Prefetched steps of each callable, in the order they were started.
+  std::unordered_map<uint64, PrefetchQueue> prefetched_steps_
+      TF_GUARDED_BY(mu_);
+
   struct PerStepState {
     bool collect_costs = false;
     bool collect_timeline = false;
@@ -238,6 +255,12 @@ class MasterSession : public core::RefCounted {
   Status DoRunCallable(CallOptions* opts, ReffedClientGraph* rcg,
                        const RunCallableRequest& req,
                        RunCallableResponse* resp);
+  // Starts a step of `rcg` in the background and appends it to `queue`.
+  void StartPrefetchedStep(ReffedClientGraph* rcg, PrefetchQueue* queue)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Waits for `step` to finish and moves its result into `resp`.
+  Status WaitForPrefetchedStep(CallOptions* opts, PrefetchedStep* step,
+                               RunCallableResponse* resp);
   Status PostRunCleanup(MasterSession::ReffedClientGraph* rcg, uint64 step_id,
                         const RunOptions& run_options, PerStepState* pss,
                         const std::unique_ptr<ProfileHandler>& ph,
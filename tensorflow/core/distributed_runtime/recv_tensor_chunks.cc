@@ -0,0 +1,165 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/recv_tensor_chunks.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+int64_t RecvTensorChunkBytes() {
+  static const int64_t chunk_bytes = [] {
+    int64_t value;
+    Status s = ReadInt64FromEnvVar("TF_RECV_TENSOR_CHUNK_BYTES", 0, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << "Ignoring TF_RECV_TENSOR_CHUNK_BYTES: " << s;
+      return int64_t{0};
+    }
+    return std::max(value, int64_t{0});
+  }();
+  return chunk_bytes;
+}
+
+int64_t RecvTensorChunksInFlight() {
+  static const int64_t chunks_in_flight = [] {
+    int64_t value;
+    Status s =
+        ReadInt64FromEnvVar("TF_RECV_TENSOR_CHUNKS_IN_FLIGHT", 4, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << "Ignoring TF_RECV_TENSOR_CHUNKS_IN_FLIGHT: " << s;
+      return int64_t{4};
+    }
+    return std::max(value, int64_t{1});
+  }();
+  return chunks_in_flight;
+}
+
+bool ShouldSendInChunks(const RecvTensorRequest& request, const Tensor& tensor,
+                        bool is_dead) {
+  return request.chunk_bytes() > 0 && !is_dead && tensor.IsInitialized() &&
+         DataTypeCanUseMemcpy(tensor.dtype()) &&
+         tensor.TotalBytes() > static_cast<uint64_t>(request.chunk_bytes());
+}
+
+int64_t NumTensorChunks(uint64_t length, int64_t chunk_bytes) {
+  DCHECK_GT(chunk_bytes, 0);
+  return (length + chunk_bytes - 1) / chunk_bytes;
+}
+
+bool GetChunkedTensorDescription(const RecvTensorResponse& response,
+                                 ChunkedTensorDescription* description) {
+  return response.transport_options().Is<ChunkedTensorDescription>() &&
+         response.transport_options().UnpackTo(description);
+}
+
+bool GetRecvTensorChunkRequest(const RecvTensorRequest& request,
+                               RecvTensorChunkRequest* chunk) {
+  return request.transport_options().Is<RecvTensorChunkRequest>() &&
+         request.transport_options().UnpackTo(chunk);
+}
+
+Status ChunkedTensorRegistry::Register(int64_t step_id, const Tensor& tensor,
+                                       RecvTensorResponse* response) {
+  const uint64_t length = tensor.TotalBytes();
+  Entry entry;
+  entry.step_id = step_id;
+  entry.remaining_bytes = length;
+  TF_RETURN_IF_ERROR(entry.bytes.BitcastFrom(
+      tensor, DT_UINT8, TensorShape({static_cast<int64_t>(length)})));
+
+  ChunkedTensorDescription description;
+  description.set_dtype(tensor.dtype());
+  tensor.shape().AsProto(description.mutable_tensor_shape());
+  description.set_length(length);
+  {
+    mutex_lock l(mu_);
+    description.set_handle(next_handle_++);
+    entries_.emplace(description.handle(), std::move(entry));
+  }
+  // The contents are fetched by the receiver, so the response only carries
+  // the description of the tensor.
+  response->clear_tensor();
+  response->set_is_dead(false);
+  response->mutable_transport_options()->PackFrom(description);
+  return OkStatus();
+}
+
+Status ChunkedTensorRegistry::GetChunk(int64_t step_id,
+                                       const RecvTensorChunkRequest& request,
+                                       Tensor* chunk) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(request.handle());
+  if (it == entries_.end() || it->second.step_id != step_id) {
+    return errors::FailedPrecondition("Tensor ", request.handle(),
+                                      " of step ", step_id,
+                                      " is not available to fetch chunks of.");
+  }
+  Entry& entry = it->second;
+  const uint64_t length = entry.bytes.NumElements();
+  if (request.length() == 0 || request.offset() > length ||
+      request.length() > length - request.offset()) {
+    return errors::InvalidArgument("Invalid chunk [", request.offset(), ", ",
+                                   request.offset() + request.length(),
+                                   ") of a tensor of ", length, " bytes.");
+  }
+  const uint64_t begin = request.offset();
+  const uint64_t end = begin + request.length();
+  auto next = entry.served_chunks.lower_bound(begin);
+  if (next != entry.served_chunks.end() && next->first == begin &&
+      next->second == request.length()) {
+    // A retried request, e.g. after the response was lost, does not count
+    // towards the bytes fetched.
+    *chunk = entry.bytes.Slice(begin, end);
+    return OkStatus();
+  }
+  if ((next != entry.served_chunks.end() && next->first < end) ||
+      (next != entry.served_chunks.begin() &&
+       std::prev(next)->first + std::prev(next)->second > begin)) {
+    return errors::InvalidArgument("Chunk [", begin, ", ", end,
+                                   ") overlaps a chunk that was already "
+                                   "fetched.");
+  }
+  *chunk = entry.bytes.Slice(begin, end);
+  entry.served_chunks.emplace_hint(next, begin, request.length());
+  entry.remaining_bytes -= request.length();
+  if (entry.remaining_bytes == 0) {
+    // `*chunk` keeps the buffer alive until the last chunk has been sent.
+    entries_.erase(it);
+  }
+  return OkStatus();
+}
+
+void ChunkedTensorRegistry::ReleaseStep(int64_t step_id) {
+  mutex_lock l(mu_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.step_id == step_id) {
+      entries_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+int64_t ChunkedTensorRegistry::size() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+}  // namespace tensorflow
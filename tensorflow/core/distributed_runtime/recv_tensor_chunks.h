@@ -0,0 +1,118 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSOR_CHUNKS_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSOR_CHUNKS_H_
+
+#include <cstdint>
+#include <map>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// Chunked RecvTensor transfers split very large tensors into many small
+// RecvTensor RPCs. The receiver offers `chunk_bytes` in its request; if the
+// tensor is larger, the sender replies with a ChunkedTensorDescription only.
+// The receiver then allocates the destination tensor and keeps several
+// RecvTensorChunkRequests in flight, copying every chunk into place as soon as
+// it arrives. This bounds the size of individual messages and of the
+// intermediate buffers, and lets the chunks of one tensor use several
+// channels to the sender.
+
+// Returns the chunk size offered by receivers, read from the environment
+// variable TF_RECV_TENSOR_CHUNK_BYTES. Zero, the default, disables chunked
+// transfers.
+int64_t RecvTensorChunkBytes();
+
+// Returns the maximum number of chunks of a tensor that are fetched
+// concurrently, read from the environment variable
+// TF_RECV_TENSOR_CHUNKS_IN_FLIGHT. Defaults to 4.
+int64_t RecvTensorChunksInFlight();
+
+// Returns true if `tensor` should be sent in chunks to the receiver that sent
+// `request`.
+bool ShouldSendInChunks(const RecvTensorRequest& request, const Tensor& tensor,
+                        bool is_dead);
+
+// Returns the number of chunks of at most `chunk_bytes` that `length` bytes
+// are split into.
+int64_t NumTensorChunks(uint64_t length, int64_t chunk_bytes);
+
+// Returns true and fills `description` if the contents of the tensor in
+// `response` have to be fetched in chunks.
+bool GetChunkedTensorDescription(const RecvTensorResponse& response,
+                                 ChunkedTensorDescription* description);
+
+// Returns true and fills `chunk` if `request` fetches a chunk of a tensor
+// instead of a tensor from the rendezvous.
+bool GetRecvTensorChunkRequest(const RecvTensorRequest& request,
+                               RecvTensorChunkRequest* chunk);
+
+// Holds the tensors a worker sends in chunks until all their chunks have been
+// fetched, or until the step they belong to is cleaned up.
+//
+// This class is thread-safe.
+class ChunkedTensorRegistry {
+ public:
+  ChunkedTensorRegistry() = default;
+
+  // Registers `tensor`, which must reside in host memory, for step `step_id`
+  // and fills `response` with its description.
+  Status Register(int64_t step_id, const Tensor& tensor,
+                  RecvTensorResponse* response);
+
+  // Sets `*chunk` to a DT_UINT8 tensor aliasing the bytes of a registered
+  // tensor requested by `request`. A retried request for a chunk that was
+  // already returned is served again, but chunks overlapping another one are
+  // rejected. The registry drops its reference to the tensor once every byte
+  // has been returned.
+  Status GetChunk(int64_t step_id, const RecvTensorChunkRequest& request,
+                  Tensor* chunk);
+
+  // Drops the tensors registered for `step_id` that have not been fetched
+  // completely, e.g. because the step was aborted.
+  void ReleaseStep(int64_t step_id);
+
+  // Returns the number of tensors currently registered.
+  int64_t size() const;
+
+ private:
+  struct Entry {
+    int64_t step_id;
+    // The contents of the registered tensor as a flat DT_UINT8 tensor.
+    Tensor bytes;
+    // The number of bytes not covered by `served_chunks`.
+    uint64_t remaining_bytes;
+    // The offsets and lengths of the chunks returned so far.
+    std::map<uint64_t, uint64_t> served_chunks;
+  };
+
+  mutable mutex mu_;
+  uint64_t next_handle_ TF_GUARDED_BY(mu_) = 1;
+  absl::flat_hash_map<uint64_t, Entry> entries_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ChunkedTensorRegistry);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSOR_CHUNKS_H_
@@ -0,0 +1,177 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/recv_tensor_chunks.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+RecvTensorChunkRequest ChunkRequest(uint64_t handle, uint64_t offset,
+                                    uint64_t length) {
+  RecvTensorChunkRequest request;
+  request.set_handle(handle);
+  request.set_offset(offset);
+  request.set_length(length);
+  return request;
+}
+
+TEST(RecvTensorChunksTest, ShouldSendInChunks) {
+  RecvTensorRequest request;
+  Tensor tensor = test::AsTensor<float>({1, 2, 3, 4});
+  EXPECT_FALSE(ShouldSendInChunks(request, tensor, /*is_dead=*/false));
+  request.set_chunk_bytes(16);
+  EXPECT_FALSE(ShouldSendInChunks(request, tensor, /*is_dead=*/false));
+  request.set_chunk_bytes(8);
+  EXPECT_TRUE(ShouldSendInChunks(request, tensor, /*is_dead=*/false));
+  EXPECT_FALSE(ShouldSendInChunks(request, tensor, /*is_dead=*/true));
+  EXPECT_FALSE(ShouldSendInChunks(
+      request, test::AsTensor<tstring>({"aaaaaaaa", "bbbbbbbb"}),
+      /*is_dead=*/false));
+}
+
+TEST(RecvTensorChunksTest, NumTensorChunks) {
+  EXPECT_EQ(NumTensorChunks(16, 8), 2);
+  EXPECT_EQ(NumTensorChunks(17, 8), 3);
+  EXPECT_EQ(NumTensorChunks(1, 8), 1);
+}
+
+TEST(RecvTensorChunksTest, FetchAllChunks) {
+  ChunkedTensorRegistry registry;
+  Tensor tensor = test::AsTensor<int32>({1, 2, 3, 4, 5}, TensorShape({5}));
+  RecvTensorResponse response;
+  TF_ASSERT_OK(registry.Register(/*step_id=*/7, tensor, &response));
+
+  ChunkedTensorDescription description;
+  ASSERT_TRUE(GetChunkedTensorDescription(response, &description));
+  EXPECT_EQ(description.dtype(), DT_INT32);
+  EXPECT_EQ(TensorShape(description.tensor_shape()), TensorShape({5}));
+  EXPECT_EQ(description.length(), 20);
+  EXPECT_FALSE(response.is_dead());
+  EXPECT_FALSE(response.has_tensor());
+  EXPECT_EQ(registry.size(), 1);
+
+  // Reassemble the tensor from chunks fetched out of order.
+  Tensor received(DT_INT32, TensorShape({5}));
+  char* dst = const_cast<char*>(received.tensor_data().data());
+  for (uint64_t offset : {8, 0, 16}) {
+    const uint64_t length = std::min<uint64_t>(8, 20 - offset);
+    Tensor chunk;
+    TF_ASSERT_OK(registry.GetChunk(
+        7, ChunkRequest(description.handle(), offset, length), &chunk));
+    ASSERT_EQ(chunk.dtype(), DT_UINT8);
+    ASSERT_EQ(chunk.TotalBytes(), length);
+    std::memcpy(dst + offset, chunk.tensor_data().data(), length);
+  }
+  test::ExpectTensorEqual<int32>(received, tensor);
+  EXPECT_EQ(registry.size(), 0);
+
+  Tensor chunk;
+  EXPECT_TRUE(errors::IsFailedPrecondition(registry.GetChunk(
+      7, ChunkRequest(description.handle(), 0, 8), &chunk)));
+}
+
+TEST(RecvTensorChunksTest, InvalidChunks) {
+  ChunkedTensorRegistry registry;
+  RecvTensorResponse response;
+  TF_ASSERT_OK(registry.Register(
+      /*step_id=*/1, test::AsTensor<float>({1, 2, 3, 4}), &response));
+  ChunkedTensorDescription description;
+  ASSERT_TRUE(GetChunkedTensorDescription(response, &description));
+
+  Tensor chunk;
+  EXPECT_TRUE(errors::IsFailedPrecondition(registry.GetChunk(
+      /*step_id=*/2, ChunkRequest(description.handle(), 0, 4), &chunk)));
+  EXPECT_TRUE(errors::IsFailedPrecondition(registry.GetChunk(
+      1, ChunkRequest(description.handle() + 1, 0, 4), &chunk)));
+  EXPECT_TRUE(errors::IsInvalidArgument(registry.GetChunk(
+      1, ChunkRequest(description.handle(), 12, 8), &chunk)));
+  EXPECT_TRUE(errors::IsInvalidArgument(registry.GetChunk(
+      1, ChunkRequest(description.handle(), 0, 0), &chunk)));
+  EXPECT_EQ(registry.size(), 1);
+}
+
+TEST(RecvTensorChunksTest, RetriedChunks) {
+  ChunkedTensorRegistry registry;
+  Tensor tensor = test::AsTensor<int32>({1, 2, 3, 4, 5}, TensorShape({5}));
+  RecvTensorResponse response;
+  TF_ASSERT_OK(registry.Register(/*step_id=*/7, tensor, &response));
+  ChunkedTensorDescription description;
+  ASSERT_TRUE(GetChunkedTensorDescription(response, &description));
+
+  Tensor received(DT_INT32, TensorShape({5}));
+  char* dst = const_cast<char*>(received.tensor_data().data());
+  auto fetch = [&](uint64_t offset, uint64_t length) {
+    Tensor chunk;
+    TF_ASSERT_OK(registry.GetChunk(
+        7, ChunkRequest(description.handle(), offset, length), &chunk));
+    ASSERT_EQ(chunk.TotalBytes(), length);
+    std::memcpy(dst + offset, chunk.tensor_data().data(), length);
+  };
+
+  // Every chunk but the last one is requested twice, which does not complete
+  // the transfer early.
+  for (uint64_t offset : {0, 8}) {
+    fetch(offset, 8);
+    fetch(offset, 8);
+    EXPECT_EQ(registry.size(), 1);
+  }
+
+  // Chunks overlapping the ones already fetched are rejected.
+  Tensor chunk;
+  EXPECT_TRUE(errors::IsInvalidArgument(registry.GetChunk(
+      7, ChunkRequest(description.handle(), 4, 8), &chunk)));
+  EXPECT_TRUE(errors::IsInvalidArgument(registry.GetChunk(
+      7, ChunkRequest(description.handle(), 12, 8), &chunk)));
+  EXPECT_TRUE(errors::IsInvalidArgument(registry.GetChunk(
+      7, ChunkRequest(description.handle(), 0, 4), &chunk)));
+  EXPECT_EQ(registry.size(), 1);
+
+  fetch(16, 4);
+  test::ExpectTensorEqual<int32>(received, tensor);
+  EXPECT_EQ(registry.size(), 0);
+}
+
+TEST(RecvTensorChunksTest, ReleaseStep) {
+  ChunkedTensorRegistry registry;
+  RecvTensorResponse response;
+  TF_ASSERT_OK(registry.Register(1, test::AsTensor<float>({1, 2}), &response));
+  TF_ASSERT_OK(registry.Register(2, test::AsTensor<float>({3, 4}), &response));
+  EXPECT_EQ(registry.size(), 2);
+  registry.ReleaseStep(1);
+  EXPECT_EQ(registry.size(), 1);
+  registry.ReleaseStep(2);
+  EXPECT_EQ(registry.size(), 0);
+}
+
+TEST(RecvTensorChunksTest, ChunkRequestRoundTrip) {
+  RecvTensorRequest request;
+  RecvTensorChunkRequest chunk;
+  EXPECT_FALSE(GetRecvTensorChunkRequest(request, &chunk));
+  request.mutable_transport_options()->PackFrom(ChunkRequest(3, 4, 5));
+  ASSERT_TRUE(GetRecvTensorChunkRequest(request, &chunk));
+  EXPECT_EQ(chunk.handle(), 3);
+  EXPECT_EQ(chunk.offset(), 4);
+  EXPECT_EQ(chunk.length(), 5);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,149 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_ENQUEUE_BATCHER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_ENQUEUE_BATCHER_H_
+
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+
+// Sends the streaming enqueue requests of a remote context through a
+// `Dispatcher`, which provides
+//   void SendNextRequest(const EnqueueRequest&, EnqueueResponse*,
+//                        StatusCallback);
+//   void CancelCall();
+// like StreamingRPCDispatcher<EnqueueResponse>.
+//
+// With a `max_batch_size` greater than 1, the requests that are enqueued
+// while a request is in flight are merged into batches of up to that many
+// queue items. The batches are sent one at a time, in order, once the request
+// in flight completes, and the responses of their items are split back to
+// the callers. Every caller of a batch gets the status of the batch.
+template <typename Dispatcher>
+class EnqueueBatcher : public core::RefCounted {
+ public:
+  template <typename... DispatcherArgs>
+  explicit EnqueueBatcher(int64_t max_batch_size,
+                          DispatcherArgs&&... dispatcher_args)
+      : dispatcher_(std::forward<DispatcherArgs>(dispatcher_args)...),
+        max_batch_size_(max_batch_size) {}
+
+  // Sends `request`, or a batch including it, and invokes `done` once
+  // `response` has been filled with the responses of its items.
+  void Enqueue(const EnqueueRequest& request, EnqueueResponse* response,
+               StatusCallback done) {
+    if (max_batch_size_ <= 1) {
+      dispatcher_.SendNextRequest(request, response, std::move(done));
+      return;
+    }
+    {
+      mutex_lock l(mu_);
+      if (in_flight_) {
+        if (batches_.empty() || batches_.back().request.queue_size() +
+                                        request.queue_size() >
+                                    max_batch_size_) {
+          batches_.emplace_back();
+        }
+        Batch& batch = batches_.back();
+        batch.request.MergeFrom(request);
+        batch.items.push_back(
+            {response, request.queue_size(), std::move(done)});
+        return;
+      }
+      in_flight_ = true;
+    }
+    Ref();
+    dispatcher_.SendNextRequest(
+        request, response, [this, done = std::move(done)](const Status& s) {
+          done(s);
+          SendNextBatch();
+          Unref();
+        });
+  }
+
+  void CancelCall() { dispatcher_.CancelCall(); }
+
+ private:
+  struct Item {
+    EnqueueResponse* response;
+    int num_queue_items;
+    StatusCallback done;
+  };
+  struct Batch {
+    EnqueueRequest request;
+    std::vector<Item> items;
+  };
+
+  // Sends the next batch once the request in flight completed.
+  void SendNextBatch() {
+    Batch batch;
+    {
+      mutex_lock l(mu_);
+      if (batches_.empty()) {
+        in_flight_ = false;
+        return;
+      }
+      batch = std::move(batches_.front());
+      batches_.pop_front();
+    }
+    auto response = std::make_shared<EnqueueResponse>();
+    auto items = std::make_shared<std::vector<Item>>(std::move(batch.items));
+    Ref();
+    dispatcher_.SendNextRequest(
+        batch.request, response.get(),
+        [this, response, items](const Status& s) {
+          // The responses of the items are split back to their requests.
+          int offset = 0;
+          for (Item& item : *items) {
+            if (s.ok()) {
+              for (int i = 0; i < item.num_queue_items &&
+                              offset + i < response->queue_response_size();
+                   ++i) {
+                item.response->add_queue_response()->Swap(
+                    response->mutable_queue_response(offset + i));
+              }
+            }
+            offset += item.num_queue_items;
+            item.done(s);
+          }
+          SendNextBatch();
+          Unref();
+        });
+  }
+
+  Dispatcher dispatcher_;
+  const int64_t max_batch_size_;
+
+  mutex mu_;
+  // Whether a request is in flight, after which the batches are sent.
+  bool in_flight_ TF_GUARDED_BY(mu_) = false;
+  std::deque<Batch> batches_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace eager
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_ENQUEUE_BATCHER_H_
@@ -0,0 +1,210 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/eager/enqueue_batcher.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+// The requests sent by a FakeDispatcher, which are completed by the test.
+struct SentRequests {
+  struct Sent {
+    EnqueueRequest request;
+    EnqueueResponse* response;
+    StatusCallback done;
+  };
+  std::vector<Sent> sent;
+  int num_cancelled = 0;
+
+  // Completes the `i`-th request with `status`, answering each of its queue
+  // items with the op id of its operation.
+  void Complete(int i, const Status& status) {
+    Sent& s = sent[i];
+    if (status.ok()) {
+      for (const QueueItem& item : s.request.queue()) {
+        s.response->add_queue_response()->add_shape()->add_dim()->set_size(
+            item.operation().id());
+      }
+    }
+    StatusCallback done = std::move(s.done);
+    done(status);
+  }
+};
+
+class FakeDispatcher {
+ public:
+  explicit FakeDispatcher(SentRequests* sent) : sent_(sent) {}
+
+  void SendNextRequest(const EnqueueRequest& request,
+                       EnqueueResponse* response, StatusCallback done) {
+    sent_->sent.push_back({request, response, std::move(done)});
+  }
+
+  void CancelCall() { ++sent_->num_cancelled; }
+
+ private:
+  SentRequests* sent_;
+};
+
+using FakeBatcher = EnqueueBatcher<FakeDispatcher>;
+
+EnqueueRequest Request(std::vector<int64_t> op_ids) {
+  EnqueueRequest request;
+  request.set_context_id(1);
+  for (int64_t id : op_ids) {
+    request.add_queue()->mutable_operation()->set_id(id);
+  }
+  return request;
+}
+
+std::vector<int64_t> OpIds(const EnqueueRequest& request) {
+  std::vector<int64_t> ids;
+  for (const QueueItem& item : request.queue()) {
+    ids.push_back(item.operation().id());
+  }
+  return ids;
+}
+
+std::vector<int64_t> ResponseIds(const EnqueueResponse& response) {
+  std::vector<int64_t> ids;
+  for (const QueueResponse& item : response.queue_response()) {
+    ids.push_back(item.shape(0).dim(0).size());
+  }
+  return ids;
+}
+
+TEST(EnqueueBatcherTest, NoBatchingByDefault) {
+  SentRequests sent;
+  core::RefCountPtr<FakeBatcher> batcher(
+      new FakeBatcher(/*max_batch_size=*/1, &sent));
+  EnqueueResponse responses[3];
+  std::vector<Status> statuses(3, errors::Unknown("not done"));
+  for (int i = 0; i < 3; ++i) {
+    batcher->Enqueue(Request({i}), &responses[i],
+                     [&statuses, i](const Status& s) { statuses[i] = s; });
+  }
+  ASSERT_EQ(sent.sent.size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(OpIds(sent.sent[i].request), std::vector<int64_t>({i}));
+    sent.Complete(i, OkStatus());
+    TF_EXPECT_OK(statuses[i]);
+    EXPECT_EQ(ResponseIds(responses[i]), std::vector<int64_t>({i}));
+  }
+}
+
+TEST(EnqueueBatcherTest, BatchBoundaries) {
+  SentRequests sent;
+  core::RefCountPtr<FakeBatcher> batcher(
+      new FakeBatcher(/*max_batch_size=*/3, &sent));
+  // The first request goes out alone. The ones that follow while it is in
+  // flight are batched up to 3 queue items, without splitting a request.
+  const std::vector<std::vector<int64_t>> requests = {
+      {0}, {1}, {2, 3}, {4, 5}, {6}, {7}, {8, 9, 10}};
+  const int n = requests.size();
+  std::vector<EnqueueResponse> responses(n);
+  std::vector<Status> statuses(n, errors::Unknown("not done"));
+  for (int i = 0; i < n; ++i) {
+    batcher->Enqueue(Request(requests[i]), &responses[i],
+                     [&statuses, i](const Status& s) { statuses[i] = s; });
+  }
+  ASSERT_EQ(sent.sent.size(), 1);
+  EXPECT_EQ(OpIds(sent.sent[0].request), std::vector<int64_t>({0}));
+
+  // Each batch is only sent once the previous request completed.
+  sent.Complete(0, OkStatus());
+  ASSERT_EQ(sent.sent.size(), 2);
+  EXPECT_EQ(OpIds(sent.sent[1].request), std::vector<int64_t>({1, 2, 3}));
+  sent.Complete(1, OkStatus());
+  ASSERT_EQ(sent.sent.size(), 3);
+  EXPECT_EQ(OpIds(sent.sent[2].request), std::vector<int64_t>({4, 5, 6}));
+  sent.Complete(2, OkStatus());
+  ASSERT_EQ(sent.sent.size(), 4);
+  EXPECT_EQ(OpIds(sent.sent[3].request), std::vector<int64_t>({7}));
+  sent.Complete(3, OkStatus());
+  ASSERT_EQ(sent.sent.size(), 5);
+  EXPECT_EQ(OpIds(sent.sent[4].request), std::vector<int64_t>({8, 9, 10}));
+  sent.Complete(4, OkStatus());
+  EXPECT_EQ(sent.sent.size(), 5);
+
+  // Every caller gets the responses of its own queue items.
+  for (int i = 0; i < n; ++i) {
+    TF_EXPECT_OK(statuses[i]);
+    EXPECT_EQ(ResponseIds(responses[i]), requests[i]);
+  }
+
+  // With nothing in flight, the next request goes out alone again.
+  EnqueueResponse response;
+  batcher->Enqueue(Request({11}), &response, [](const Status& s) {});
+  ASSERT_EQ(sent.sent.size(), 6);
+  EXPECT_EQ(OpIds(sent.sent[5].request), std::vector<int64_t>({11}));
+  sent.Complete(5, OkStatus());
+}
+
+TEST(EnqueueBatcherTest, ErrorIsPropagatedToEveryCallerOfTheBatch) {
+  SentRequests sent;
+  core::RefCountPtr<FakeBatcher> batcher(
+      new FakeBatcher(/*max_batch_size=*/4, &sent));
+  const int n = 4;
+  std::vector<EnqueueResponse> responses(n);
+  std::vector<Status> statuses(n, errors::Unknown("not done"));
+  for (int i = 0; i < n; ++i) {
+    batcher->Enqueue(Request({i}), &responses[i],
+                     [&statuses, i](const Status& s) { statuses[i] = s; });
+  }
+  sent.Complete(0, OkStatus());
+  ASSERT_EQ(sent.sent.size(), 2);
+  EXPECT_EQ(OpIds(sent.sent[1].request), std::vector<int64_t>({1, 2, 3}));
+
+  // A request enqueued while the batch is in flight is not part of it.
+  EnqueueResponse last_response;
+  Status last_status = errors::Unknown("not done");
+  batcher->Enqueue(Request({4}), &last_response,
+                   [&last_status](const Status& s) { last_status = s; });
+
+  sent.Complete(1, errors::Internal("batch failed"));
+  TF_EXPECT_OK(statuses[0]);
+  for (int i = 1; i < n; ++i) {
+    EXPECT_EQ(statuses[i].code(), error::INTERNAL) << i;
+    EXPECT_EQ(statuses[i].error_message(), "batch failed") << i;
+    EXPECT_EQ(responses[i].queue_response_size(), 0) << i;
+  }
+  EXPECT_EQ(last_status.code(), error::UNKNOWN);
+
+  // The failure does not stall the requests that follow.
+  ASSERT_EQ(sent.sent.size(), 3);
+  EXPECT_EQ(OpIds(sent.sent[2].request), std::vector<int64_t>({4}));
+  sent.Complete(2, OkStatus());
+  TF_EXPECT_OK(last_status);
+  EXPECT_EQ(ResponseIds(last_response), std::vector<int64_t>({4}));
+}
+
+TEST(EnqueueBatcherTest, CancelCall) {
+  SentRequests sent;
+  core::RefCountPtr<FakeBatcher> batcher(
+      new FakeBatcher(/*max_batch_size=*/4, &sent));
+  batcher->CancelCall();
+  EXPECT_EQ(sent.num_cancelled, 1);
+}
+
+}  // namespace
+}  // namespace eager
+}  // namespace tensorflow
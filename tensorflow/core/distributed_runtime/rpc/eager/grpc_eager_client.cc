@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 
+#include <memory>
 #include <string>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/rpc/eager/enqueue_batcher.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
@@ -72,6 +74,27 @@ bool EnableStreaming() {
   return result;
 }
 
+/* Retrieve the global env variable.
+ * Setting environment variable
+ * "TF_EAGER_CLIENT_STREAMING_ENQUEUE_MAX_BATCH_SIZE" to a value greater than 1
+ * batches the streaming enqueue requests to a remote worker. While a request
+ * is in flight, the requests that follow are merged into batches of up to this
+ * number of queue items, which are sent one at a time, in order, as a single
+ * request each. This reduces the number of requests of fine-grained remote
+ * ops, which then only wait on each other through their remote tensor
+ * handles. Note that an item failing on the remote worker fails all the items
+ * of its batch.
+ */
+int64_t StreamingEnqueueMaxBatchSize() {
+  int64_t result;
+  TF_CHECK_OK(ReadInt64FromEnvVar(
+      "TF_EAGER_CLIENT_STREAMING_ENQUEUE_MAX_BATCH_SIZE", 1, &result));
+  return result;
+}
+
+using GrpcEnqueueBatcher =
+    EnqueueBatcher<StreamingRPCDispatcher<EnqueueResponse>>;
+
 // Ref-counted thread to handle callbacks for completed requests a GRPC
 // completion queue. The thread might be shared by multiple eager clients, and
 // each one of them should hold a reference count to ensure that the thread
@@ -178,10 +201,10 @@ class GrpcEagerClient : public EagerClient {
             << request->DebugString();
 
     mutex_lock l(mu_);
-    const auto& it = enqueue_dispatchers_.find(request->context_id());
-    if (it != enqueue_dispatchers_.end()) {
-      it->second.CancelCall();
-      enqueue_dispatchers_.erase(it);
+    const auto& it = enqueue_batchers_.find(request->context_id());
+    if (it != enqueue_batchers_.end()) {
+      it->second->CancelCall();
+      enqueue_batchers_.erase(it);
     } else if (EnableStreaming()) {
       LOG(ERROR) << "Remote EagerContext with id " << request->context_id()
                  << " does not seem to exist.";
@@ -200,18 +223,18 @@ class GrpcEagerClient : public EagerClient {
     // Streaming enqueue is allowed only when the both are enabled.
     if (EnableStreaming() && enable_streaming_enqueue) {
       mutex_lock l(mu_);
-      auto it = enqueue_dispatchers_.find(request->context_id());
-      if (it == enqueue_dispatchers_.end()) {
-        auto it_and_bool = enqueue_dispatchers_.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(request->context_id()),
-            std::forward_as_tuple(
-                &stub_, cq_,
-                "/tensorflow.eager.EagerService/StreamingEnqueue"));
-        it = it_and_bool.first;
+      auto it = enqueue_batchers_.find(request->context_id());
+      if (it == enqueue_batchers_.end()) {
+        it = enqueue_batchers_
+                 .emplace(request->context_id(),
+                          new GrpcEnqueueBatcher(
+                              StreamingEnqueueMaxBatchSize(), &stub_, cq_,
+                              "/tensorflow.eager.EagerService/"
+                              "StreamingEnqueue"))
+                 .first;
       }
       // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
-      it->second.SendNextRequest(*request, response, std::move(done_wrapped));
+      it->second->Enqueue(*request, response, std::move(done_wrapped));
     } else {
       Notification n;
       Status status;
@@ -234,8 +257,10 @@ class GrpcEagerClient : public EagerClient {
 
   mutable mutex mu_;
 
-  std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
-      enqueue_dispatchers_ TF_GUARDED_BY(mu_);
+  // Batchers hold a reference to themselves while they have a request in
+  // flight, so they outlive the closing of their context.
+  std::unordered_map<uint64, core::RefCountPtr<GrpcEnqueueBatcher>>
+      enqueue_batchers_ TF_GUARDED_BY(mu_);
 
   StatusCallback callback_wrapper(StatusCallback done) {
     Ref();
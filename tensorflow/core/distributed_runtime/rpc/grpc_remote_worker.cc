@@ -67,7 +67,9 @@ class GrpcRemoteWorker : public WorkerInterface {
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
         logger_(logger),
-        target_(target) {}
+        target_(target),
+        recvtensor_metrics_(RpcLinkMetrics::Get(target_, recvtensor_)),
+        recvbuf_metrics_(RpcLinkMetrics::Get(target_, recvbuf_)) {}
 
   ~GrpcRemoteWorker() override {}
 
@@ -133,18 +135,20 @@ class GrpcRemoteWorker : public WorkerInterface {
     // Type-specialized logging for this method.
     bool logging_active = logger_->LoggingActive() || VLOG_IS_ON(2);
 
+    recvbuf_metrics_->CallStarted();
     auto callback = [this, request, response, done, start_usec,
                      logging_active](Status s) {
+      int64_t end_usec = Env::Default()->NowMicros();
+      RecvBufRespExtra extra;
+      response->transport_options().UnpackTo(&extra);
+      int64_t num_bytes = 0;
+      for (const auto& chunk : extra.tensor_content()) {
+        num_bytes += chunk.size();
+      }
+      recvbuf_metrics_->CallFinished(end_usec - start_usec, num_bytes, s);
       if (logging_active) {
         if (logger_->LoggingActive()) {
-          int64_t end_usec = Env::Default()->NowMicros();
           int64_t step_id = request->step_id();
-          RecvBufRespExtra extra;
-          response->transport_options().UnpackTo(&extra);
-          int64_t num_bytes = 0;
-          for (const auto& chunk : extra.tensor_content()) {
-            num_bytes += chunk.size();
-          }
           int64_t send_start_usec = start_usec;
           // Prefer start time reported by the sender, if available.
           if (response->send_start_micros()) {
@@ -202,13 +206,15 @@ class GrpcRemoteWorker : public WorkerInterface {
     // Type-specialized logging for this method.
     bool logging_active = logger_->LoggingActive() || VLOG_IS_ON(2);
 
+    recvtensor_metrics_->CallStarted();
     auto callback = [this, request, response, done, start_usec,
                      logging_active](Status s) {
+      int64_t end_usec = Env::Default()->NowMicros();
+      int64_t bytes = response->tensor().TotalBytes();
+      recvtensor_metrics_->CallFinished(end_usec - start_usec, bytes, s);
       if (logging_active) {
         if (logger_->LoggingActive()) {
-          int64_t end_usec = Env::Default()->NowMicros();
           int64_t step_id = request->step_id();
-          int64_t bytes = response->tensor().TotalBytes();
           int64_t send_start_usec = start_usec;
           // If a send start time was reported by the other side, use
           // that instead.  Maybe we should mark the display if we're using
@@ -335,6 +341,8 @@ class GrpcRemoteWorker : public WorkerInterface {
   // Support for logging.
   WorkerCacheLogger* logger_;
   const string target_;
+  RpcLinkMetrics* const recvtensor_metrics_;  // Not owned.
+  RpcLinkMetrics* const recvbuf_metrics_;     // Not owned.
 
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcRemoteWorker);
 };
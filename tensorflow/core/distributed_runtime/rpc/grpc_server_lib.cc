@@ -208,6 +208,12 @@ Status GrpcServer::Init(const GrpcServerOptions& opts) {
   }
   worker_env_.local_devices = worker_env_.device_mgr->ListDevices();
   master_env_.local_devices = worker_env_.device_mgr->ListDevices();
+  if (!config.experimental().network_coordinates().empty()) {
+    for (Device* device : worker_env_.local_devices) {
+      device->set_network_coordinates(
+          config.experimental().network_coordinates());
+    }
+  }
 
   int num_tasks = 0;
   for (auto& job : server_def_.cluster().job()) {
@@ -219,6 +225,10 @@ Status GrpcServer::Init(const GrpcServerOptions& opts) {
   worker_env_.rendezvous_mgr = opts.rendezvous_mgr_func == nullptr
                                    ? new RpcRendezvousMgr(&worker_env_)
                                    : opts.rendezvous_mgr_func(&worker_env_);
+  if (opts.tensor_transport_func) {
+    tensor_transport_ = opts.tensor_transport_func(server_def_, &worker_env_);
+    worker_env_.tensor_transport = tensor_transport_.get();
+  }
   string unused;
   string default_worker_name;
   if (!DeviceNameUtils::SplitDeviceName(master_env_.local_devices[0]->name(),
@@ -271,7 +281,25 @@ Status GrpcServer::Init(const GrpcServerOptions& opts) {
   coordination_service_ =
       new GrpcCoordinationServiceImpl(compute_pool, &builder);
 
-  profiler_service_ = profiler::CreateProfilerService();
+  int64_t sampling_interval_ms = 0;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_PROFILER_SAMPLING_INTERVAL_MS", 0,
+                                         &sampling_interval_ms));
+  if (sampling_interval_ms > 0) {
+    // Profiles 1% of the time, and serves the op metrics of the last samples
+    // from the Monitor rpc.
+    profiler::OpMetricsSampler::Options sampler_options;
+    sampler_options.sample_interval_ms = sampling_interval_ms;
+    op_metrics_sampler_ =
+        std::make_unique<profiler::OpMetricsSampler>(sampler_options);
+    op_metrics_sampler_->Start();
+    profiler_service_ = profiler::CreateProfilerService(
+        [sampler = op_metrics_sampler_.get()](const MonitorRequest& request,
+                                              MonitorResponse* response) {
+          return sampler->Monitor(request, response);
+        });
+  } else {
+    profiler_service_ = profiler::CreateProfilerService();
+  }
   builder.RegisterService(profiler_service_.get());
 
   // Add any extra services to be started.
@@ -33,10 +33,12 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
 #include "tensorflow/core/distributed_runtime/server_lib.h"
 #include "tensorflow/core/distributed_runtime/session_mgr.h"
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/profiler/convert/op_metrics_sampler.h"
 #include "tensorflow/tsl/distributed_runtime/rpc/async_service_interface.h"
 #include "tensorflow/tsl/profiler/protobuf/profiler_service.grpc.pb.h"
 
@@ -54,6 +56,12 @@ typedef std::function<CollectiveExecutorMgrInterface*(
     const ConfigProto&, const WorkerEnv*, WorkerCacheInterface*)>
     CollectiveMgrCreationFunction;
 
+// function that creates a TensorTransport, or returns nullptr if tensors
+// should only be transferred over gRPC.
+typedef std::function<std::unique_ptr<TensorTransport>(const ServerDef&,
+                                                       const WorkerEnv*)>
+    TensorTransportCreationFunction;
+
 // function that registers a service to the server. The service needs to
 // be registered before builder.BuildAndStart().
 typedef std::function<void(const WorkerEnv*, ::grpc::ServerBuilder*)>
@@ -68,6 +76,7 @@ struct GrpcServerOptions {
   ServiceInitFunction service_func = nullptr;
   RendezvousMgrCreationFunction rendezvous_mgr_func = nullptr;
   CollectiveMgrCreationFunction collective_mgr_func = nullptr;
+  TensorTransportCreationFunction tensor_transport_func = nullptr;
   WorkerCreationFunction worker_func = nullptr;
   StatsPublisherFactory stats_factory = CreateNoOpStatsPublisher;
   GrpcWorkerServiceOptions worker_service_options;
@@ -212,6 +221,9 @@ class GrpcServer : public ServerInterface {
 
   // Implementation of a TensorFlow worker, and RPC polling thread.
   WorkerEnv worker_env_;
+  // Outlives the rendezvous manager, which may still be pulling tensors
+  // through it while it shuts down.
+  std::unique_ptr<TensorTransport> tensor_transport_;
   std::unique_ptr<const DeviceMgr> owned_device_manager_;
   std::unique_ptr<GrpcWorker> worker_impl_;
   tsl::AsyncServiceInterface* worker_service_ = nullptr;
@@ -227,6 +239,10 @@ class GrpcServer : public ServerInterface {
   tsl::AsyncServiceInterface* coordination_service_ = nullptr;
   std::unique_ptr<Thread> coordination_thread_ TF_GUARDED_BY(mu_);
 
+  // Samples op metrics for the Monitor rpc of the profiler service, when
+  // TF_PROFILER_SAMPLING_INTERVAL_MS is set.
+  std::unique_ptr<profiler::OpMetricsSampler> op_metrics_sampler_;
+
   // TensorFlow profiler service implementation.
   std::unique_ptr<grpc::ProfilerService::Service> profiler_service_ = nullptr;
 
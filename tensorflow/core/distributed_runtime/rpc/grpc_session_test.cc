@@ -196,6 +196,48 @@ TEST(GrpcSessionTest, CallableWithOnDeviceFeedsAndFetches) {
   TF_CHECK_OK(session->Close());
 }
 
+TEST(GrpcSessionTest, CallableWithPrefetchedSteps) {
+  GraphDef graph;
+  string node_names[3];
+  // c = a * b
+  CreateGraphDef(&graph, node_names);
+
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 2, &cluster));
+
+  std::unique_ptr<Session> session(
+      NewRemote(Options(cluster->targets()[0], 1)));
+  ASSERT_TRUE(session != nullptr);
+  TF_CHECK_OK(session->Create(graph));
+
+  {
+    CallableOptions opts;
+    opts.add_fetch(node_names[2] + ":0");
+    opts.set_prefetch_steps(2);
+    Session::CallableHandle handle;
+    TF_CHECK_OK(session->MakeCallable(opts, &handle));
+    for (int i = 0; i < 5; ++i) {
+      std::vector<Tensor> outputs;
+      TF_CHECK_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+      ASSERT_EQ(1, outputs.size());
+      ASSERT_EQ(4.0, outputs[0].flat<float>()(0));
+    }
+    // Releasing the callable with steps still in flight is fine.
+    TF_CHECK_OK(session->ReleaseCallable(handle));
+  }
+  {
+    CallableOptions opts;
+    opts.add_feed(node_names[0] + ":0");
+    opts.add_fetch(node_names[2] + ":0");
+    opts.set_prefetch_steps(1);
+    Session::CallableHandle handle;
+    Status status = session->MakeCallable(opts, &handle);
+    EXPECT_EQ(error::INVALID_ARGUMENT, status.code());
+  }
+
+  TF_CHECK_OK(session->Close());
+}
+
 TEST(GrpcSessionTest, BasicNonProtoAPIConsistentOrder) {
   GraphDef graph;
   string node_names[3];
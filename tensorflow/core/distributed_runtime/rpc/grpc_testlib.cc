@@ -63,11 +63,17 @@ Status TestCluster::MakeTestCluster(const string& binary_path,
     if (!options.env->FileExists(binary_path).ok()) {
       return errors::Internal("Could not find grpc_testlib_server");
     }
-    const std::vector<string> argv(
+    std::vector<string> argv(
         {binary_path, /* see grpc_testlib_server.cc for flags */
          tf_jobs, "--tf_job=localhost", strings::StrCat("--tf_task=", i),
          strings::StrCat("--num_cpus=", num_cpus),
          strings::StrCat("--num_gpus=", num_gpus)});
+    const string& collective_group_leader =
+        options.config.experimental().collective_group_leader();
+    if (!collective_group_leader.empty()) {
+      argv.push_back(strings::StrCat("--collective_group_leader=",
+                                     collective_group_leader));
+    }
     ret->subprocesses_.emplace_back(CreateSubProcess(argv));
     bool success = ret->subprocesses_[i]->Start();
     if (!success) {
@@ -0,0 +1,270 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the gRPC transport between the workers of an in-process test
+// cluster: RecvTensor throughput across tensor sizes from CPU and GPU sources,
+// rendezvous overhead as a function of the number of cut edges, and the
+// bandwidth of the ring all-reduce (RingReducer), ring all-gather
+// (RingGatherer) and tree broadcast (HierarchicalTreeBroadcaster) collectives.
+// Run with `--benchmark_filter=all`.
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_testlib.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/port.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::test::function::GDef;
+using ::tensorflow::test::function::NDef;
+
+constexpr int kNumWorkers = 4;
+constexpr char kGroupLeader[] = "/job:localhost/replica:0/task:0";
+
+SessionOptions ClusterOptions() {
+  SessionOptions options;
+  (*options.config.mutable_device_count())["CPU"] = 1;
+  (*options.config.mutable_device_count())["GPU"] =
+      IsGoogleCudaEnabled() ? 1 : 0;
+  options.config.mutable_experimental()->set_collective_group_leader(
+      kGroupLeader);
+  return options;
+}
+
+const test::TestCluster* GetCluster() {
+  static test::TestCluster* cluster = [] {
+    std::unique_ptr<test::TestCluster> cluster;
+    TF_CHECK_OK(test::TestCluster::MakeTestCluster(ClusterOptions(),
+                                                   kNumWorkers, &cluster));
+    return cluster.release();
+  }();
+  return cluster;
+}
+
+// Returns the name of the first device of `type` of worker `task`, or an
+// empty string if there is none.
+string DeviceName(int task, const string& type) {
+  const string name = strings::StrCat("/job:localhost/replica:0/task:", task,
+                                      "/device:", type, ":0");
+  for (const DeviceAttributes& device : GetCluster()->devices()) {
+    if (device.name() == name) return name;
+  }
+  return "";
+}
+
+// Collective instances of different benchmarks must not share keys, as their
+// parameters are cached by the workers.
+int NextCollectiveKey() {
+  static std::atomic<int> next_key{1};
+  return next_key++;
+}
+
+Tensor Zeros(int64_t num_elements) {
+  Tensor tensor(DT_FLOAT, TensorShape({num_elements}));
+  tensor.flat<float>().setZero();
+  return tensor;
+}
+
+NodeDef ConstNode(const string& name, const Tensor& value,
+                  const string& device) {
+  return NDef(name, "Const", /*inputs=*/{},
+              {{"value", value}, {"dtype", DT_FLOAT}}, device);
+}
+
+// Returns a node on `device` that completes once all of `inputs` have.
+NodeDef DoneNode(const std::vector<string>& inputs, const string& device) {
+  std::vector<string> control_inputs;
+  for (const string& input : inputs) {
+    control_inputs.push_back(strings::StrCat("^", input));
+  }
+  return NDef("done", "NoOp", control_inputs, {}, device);
+}
+
+// Runs `graph_def` up to its "done" node for every iteration of `state`, and
+// reports `bytes_per_step` as the bytes processed per iteration.
+void RunGraph(const GraphDef& graph_def, int64_t bytes_per_step,
+              ::testing::benchmark::State& state) {
+  SessionOptions options = ClusterOptions();
+  options.target = strings::StrCat("grpc://", GetCluster()->targets()[0]);
+  options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_opt_level(OptimizerOptions::L0);
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_CHECK_OK(session->Create(graph_def));
+
+  // Warms up the connections and caches of the workers.
+  for (int i = 0; i < 3; ++i) {
+    TF_CHECK_OK(session->Run({}, {}, {"done"}, nullptr));
+  }
+  for (auto s : state) {
+    TF_CHECK_OK(session->Run({}, {}, {"done"}, nullptr));
+  }
+  state.SetBytesProcessed(state.iterations() * bytes_per_step);
+  TF_CHECK_OK(session->Close());
+}
+
+// Measures RecvTensor by transferring a tensor of `state.range(0)` bytes from
+// a device of worker 1 to the CPU of worker 0.
+void BM_RecvTensor(::testing::benchmark::State& state,
+                   const string& source_type) {
+  const int64_t num_bytes = state.range(0);
+  const string source = DeviceName(1, source_type);
+  if (source.empty()) {
+    state.SkipWithError(
+        strings::StrCat("No ", source_type, " device in the cluster").c_str());
+    return;
+  }
+  const string sink = DeviceName(0, "CPU");
+  GraphDef graph_def =
+      GDef({ConstNode("source", Zeros(num_bytes / sizeof(float)), source),
+            NDef("sink", "Identity", {"source"}, {{"T", DT_FLOAT}}, sink),
+            DoneNode({"sink"}, sink)});
+  RunGraph(graph_def, num_bytes, state);
+}
+
+void BM_RecvTensorFromCPU(::testing::benchmark::State& state) {
+  BM_RecvTensor(state, "CPU");
+}
+
+BENCHMARK(BM_RecvTensorFromCPU)->UseRealTime()->Range(1 << 10, 16 << 20);
+
+void BM_RecvTensorFromGPU(::testing::benchmark::State& state) {
+  BM_RecvTensor(state, "GPU");
+}
+
+BENCHMARK(BM_RecvTensorFromGPU)->UseRealTime()->Range(1 << 10, 16 << 20);
+
+// Measures the rendezvous overhead of `state.range(0)` edges cut between
+// worker 1 and worker 0, each carrying a scalar.
+void BM_CutEdges(::testing::benchmark::State& state) {
+  const int num_edges = state.range(0);
+  const string source = DeviceName(1, "CPU");
+  const string sink = DeviceName(0, "CPU");
+  std::vector<NodeDef> nodes;
+  std::vector<string> sinks;
+  for (int i = 0; i < num_edges; ++i) {
+    const string source_name = strings::StrCat("source_", i);
+    sinks.push_back(strings::StrCat("sink_", i));
+    nodes.push_back(ConstNode(source_name, Zeros(1), source));
+    nodes.push_back(
+        NDef(sinks.back(), "Identity", {source_name}, {{"T", DT_FLOAT}}, sink));
+  }
+  nodes.push_back(DoneNode(sinks, sink));
+  RunGraph(GDef(nodes), num_edges * sizeof(float), state);
+  state.SetItemsProcessed(state.iterations() * num_edges);
+}
+
+BENCHMARK(BM_CutEdges)->UseRealTime()->RangeMultiplier(4)->Range(1, 4096);
+
+// Measures a collective over the CPUs of all workers, with one node per worker
+// returned by `make_node(task, device, shape)`. Each worker contributes an
+// "input_<task>" tensor of `state.range(0)` bytes.
+void BM_Collective(
+    ::testing::benchmark::State& state,
+    const std::function<NodeDef(int task, const string& device,
+                                const TensorShape& shape)>& make_node) {
+  const int64_t num_bytes = state.range(0);
+  const Tensor input = Zeros(num_bytes / sizeof(float));
+  std::vector<NodeDef> nodes;
+  std::vector<string> collectives;
+  for (int task = 0; task < kNumWorkers; ++task) {
+    const string device = DeviceName(task, "CPU");
+    nodes.push_back(ConstNode(strings::StrCat("input_", task), input, device));
+    nodes.push_back(make_node(task, device, input.shape()));
+    collectives.push_back(nodes.back().name());
+  }
+  nodes.push_back(DoneNode(collectives, DeviceName(0, "CPU")));
+  RunGraph(GDef(nodes), num_bytes, state);
+}
+
+void BM_RingReduce(::testing::benchmark::State& state) {
+  const int group_key = NextCollectiveKey();
+  const int instance_key = NextCollectiveKey();
+  BM_Collective(state, [&](int task, const string& device,
+                           const TensorShape& shape) {
+    // The ring implementation is the default one on CPUs.
+    return NDef(strings::StrCat("reduce_", task), "CollectiveReduce",
+                {strings::StrCat("input_", task)},
+                {{"T", DT_FLOAT},
+                 {"group_size", kNumWorkers},
+                 {"group_key", group_key},
+                 {"instance_key", instance_key},
+                 {"merge_op", "Add"},
+                 {"final_op", "Id"},
+                 {"subdiv_offsets", gtl::ArraySlice<int>{0}}},
+                device);
+  });
+}
+
+void BM_RingGather(::testing::benchmark::State& state) {
+  const int group_key = NextCollectiveKey();
+  const int instance_key = NextCollectiveKey();
+  BM_Collective(state, [&](int task, const string& device,
+                           const TensorShape& shape) {
+    return NDef(strings::StrCat("gather_", task), "CollectiveGather",
+                {strings::StrCat("input_", task)},
+                {{"T", DT_FLOAT},
+                 {"group_size", kNumWorkers},
+                 {"group_key", group_key},
+                 {"instance_key", instance_key},
+                 {"shape", shape}},
+                device);
+  });
+}
+
+void BM_TreeBroadcast(::testing::benchmark::State& state) {
+  const int group_key = NextCollectiveKey();
+  const int instance_key = NextCollectiveKey();
+  BM_Collective(state, [&](int task, const string& device,
+                           const TensorShape& shape) {
+    const std::vector<std::pair<string, FunctionDefHelper::AttrValueWrapper>>
+        attrs = {{"T", DT_FLOAT},
+                 {"group_size", kNumWorkers},
+                 {"group_key", group_key},
+                 {"instance_key", instance_key},
+                 {"shape", shape}};
+    if (task == 0) {
+      return NDef("broadcast_0", "CollectiveBcastSend", {"input_0"}, attrs,
+                  device);
+    }
+    return NDef(strings::StrCat("broadcast_", task), "CollectiveBcastRecv", {},
+                attrs, device);
+  });
+}
+
+BENCHMARK(BM_RingReduce)->UseRealTime()->Range(1 << 10, 16 << 20);
+BENCHMARK(BM_RingGather)->UseRealTime()->Range(1 << 10, 16 << 20);
+BENCHMARK(BM_TreeBroadcast)->UseRealTime()->Range(1 << 10, 16 << 20);
+
+}  // namespace
+}  // namespace tensorflow
@@ -37,6 +37,8 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/recv_tensor_chunks.h"
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
@@ -431,6 +433,21 @@ GrpcWorker::GrpcWorker(WorkerEnv* worker_env, const ConfigProto& config)
   }
 }
 
+void GrpcWorker::GetStatusAsync(CallOptions* opts,
+                                const GetStatusRequest* request,
+                                GetStatusResponse* response, bool fail_fast,
+                                StatusCallback done) {
+  Worker::GetStatusAsync(
+      opts, request, response, fail_fast,
+      [response, done = std::move(done)](const Status& s) {
+        for (RpcLinkStats& stats : *response->mutable_link_stats()) {
+          stats.set_num_retries(
+              tsl::GetRpcRetries(stats.peer(), stats.method()));
+        }
+        done(s);
+      });
+}
+
 void GrpcWorker::EnableResponseCache() {
   VLOG(3) << "Enabling gRPC tensor response cache.";
   response_cache_ = std::make_unique<GrpcResponseCache>();
@@ -447,11 +464,51 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   const int64_t request_id = request->request_id();
   const int64_t step_id = request->step_id();
 
+  // Requests for the chunks of a large tensor are served from the tensors
+  // registered by an earlier request, without going through the rendezvous.
+  RecvTensorChunkRequest chunk_request;
+  if (GetRecvTensorChunkRequest(*request, &chunk_request)) {
+    Tensor chunk;
+    Status s = chunked_tensors_.GetChunk(step_id, chunk_request, &chunk);
+    if (s.ok()) {
+      grpc::EncodeTensorToByteBuffer(/*is_dead=*/false, chunk,
+                                     /*require_ack=*/false, response);
+    }
+    done(s);
+    return;
+  }
+
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  // If the receiver offered the same transport, large tensors are exported
+  // through it and only their description is sent in the response.
+  TensorTransport* transport =
+      env_->tensor_transport != nullptr &&
+              AcceptsTensorTransport(*request, *env_->tensor_transport)
+          ? env_->tensor_transport
+          : nullptr;
+
+  // Tensors larger than the chunk size offered by the receiver are only
+  // described in the response and fetched in chunks afterwards.
+  auto do_response = [this, request, response, done, cache_enabled, transport,
+                      step_id](const Tensor& tensor, bool is_dead,
+                               const Status& status) {
+    const bool export_tensor = status.ok() && transport != nullptr &&
+                               ShouldExportTensor(*transport, tensor, is_dead);
+    if (export_tensor ||
+        (status.ok() && ShouldSendInChunks(*request, tensor, is_dead))) {
+      RecvTensorResponse proto;
+      Status s = export_tensor
+                     ? ExportTensor(transport, step_id, tensor, &proto)
+                     : chunked_tensors_.Register(step_id, tensor, &proto);
+      if (s.ok()) {
+        proto.set_send_start_micros(Env::Default()->NowMicros());
+        proto.set_require_ack(cache_enabled);
+        grpc::EncodeRecvTensorResponseToByteBuffer(proto, response);
+      }
+      done(s);
+      return;
+    }
     if (status.ok()) {
       grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
     }
@@ -516,11 +573,37 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   });
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, rendezvous_done, src_dev, request](
+      [opts, rendezvous_done, src_dev, request, transport](
           const Status& status, const Rendezvous::Args& send_args,
           const Rendezvous::Args& recv_args, const Tensor& val,
           const bool is_dead) {
         opts->ClearCancelCallback();
+        // Tensors exported through the transport are pulled by the receiver
+        // from wherever they reside, so there is no need to stage them in
+        // host memory first. An accelerator-resident tensor may however
+        // still be being written on the send stream, so it is only exported
+        // once that stream has completed the work enqueued so far. If that
+        // cannot be arranged, it is staged through host memory below.
+        if (status.ok() && transport != nullptr &&
+            ShouldExportTensor(*transport, val, is_dead)) {
+          DeviceContext* send_dev_context = send_args.device_context;
+          if (!src_dev->tensorflow_accelerator_device_info() ||
+              send_args.alloc_attrs.on_host()) {
+            rendezvous_done(val, is_dead, status);
+            return;
+          }
+          if (send_dev_context != nullptr &&
+              send_dev_context->stream() != nullptr) {
+            Status s = send_dev_context->ThenExecute(
+                src_dev, send_dev_context->stream(),
+                [rendezvous_done, val, is_dead, status]() {
+                  rendezvous_done(val, is_dead, status);
+                });
+            if (s.ok()) return;
+            VLOG(1) << "Staging " << request->rendezvous_key()
+                    << " through host memory: " << s;
+          }
+        }
         if (status.ok()) {
           // DMA can only be used for Tensors that do not fall into
           // the following three odd edge cases: 1) a zero-size
@@ -746,6 +829,7 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
     // a worker crashes before acking a request.
     response_cache_->CleanEntriesForStep(request->step_id());
   }
+  chunked_tensors_.ReleaseStep(request->step_id());
   Worker::CleanupGraphAsync(request, response, done);
 }
 
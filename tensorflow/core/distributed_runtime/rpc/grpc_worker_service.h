@@ -20,6 +20,7 @@ limitations under the License.
 #include <unordered_map>
 
 #include "grpcpp/server_builder.h"
+#include "tensorflow/core/distributed_runtime/recv_tensor_chunks.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
@@ -51,6 +52,11 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Adds the retries made by the gRPC layer to the link stats.
+  void GetStatusAsync(CallOptions* opts, const GetStatusRequest* request,
+                      GetStatusResponse* response, bool fail_fast,
+                      StatusCallback done) override;
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -70,6 +76,8 @@ class GrpcWorker : public Worker {
  private:
   std::unique_ptr<GrpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
+  // Large tensors whose chunks have not all been fetched by the receiver.
+  ChunkedTensorRegistry chunked_tensors_;
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env,
@@ -15,12 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/recv_tensor_chunks.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
@@ -55,11 +62,14 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
 // Used only to retrieve tensors from remote processes.
 class RpcRecvTensorCall : public BaseRecvTensorCall {
  public:
-  RpcRecvTensorCall() : wi_(nullptr), dst_device_(nullptr) {}
+  RpcRecvTensorCall()
+      : wi_(nullptr), dst_device_(nullptr), transport_(nullptr) {}
 
   void Init(WorkerInterface* wi, int64_t step_id, StringPiece key,
             AllocatorAttributes alloc_attrs, Device* dst_device,
-            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done,
+            TensorTransport* transport,
+            std::shared_ptr<WorkerCacheInterface> worker_cache) {
     wi_ = wi;
     alloc_attrs_ = alloc_attrs;
     dst_device_ = dst_device;
@@ -68,6 +78,18 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    if (transport != nullptr && transport->CanImport(dst_device, alloc_attrs)) {
+      transport_ = transport;
+      RequestTensorTransport(*transport_, &req_);
+    }
+    // Chunks are copied into the destination tensor on the host, so chunked
+    // transfers are only offered for destinations in host memory.
+    if (RecvTensorChunkBytes() > 0 &&
+        (dst_device->device_type() == DEVICE_CPU || alloc_attrs.on_host())) {
+      chunk_bytes_ = RecvTensorChunkBytes();
+      worker_cache_ = std::move(worker_cache);
+      req_.set_chunk_bytes(chunk_bytes_);
+    }
   }
 
   void Reset() {
@@ -78,6 +100,12 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
     alloc_attrs_ = AllocatorAttributes();
     dst_device_ = nullptr;
+    transport_ = nullptr;
+    pulled_tensor_ = Tensor();
+    has_pulled_tensor_ = false;
+    chunk_bytes_ = 0;
+    worker_cache_.reset();
+    chunks_done_ = nullptr;
     // We don't clear opts_ and assume that Init will set up the state for
     // opts_ appropriately.
     req_.Clear();
@@ -85,6 +113,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     {
       mutex_lock l(mu_);
       status_ = OkStatus();
+      chunk_fetches_.clear();
     }
     done_ = nullptr;
   }
@@ -105,6 +134,9 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     {
       mutex_lock l(mu_);
       status_.Update(s);
+      for (auto& fetch : chunk_fetches_) {
+        fetch->opts.StartCancel();
+      }
     }
     opts_.StartCancel();
   }
@@ -121,7 +153,9 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     wi_ = nullptr;
   }
 
-  const Tensor& tensor() const { return resp_.tensor(); }
+  const Tensor& tensor() const {
+    return has_pulled_tensor_ ? pulled_tensor_ : resp_.tensor();
+  }
 
   bool is_dead() const { return resp_.metadata().is_dead(); }
 
@@ -141,9 +175,19 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
       // Make sure the Rendezvous abort checking is finished before running the
       // callback, which might destroy the current call object.
       abort_checked->WaitForNotification();
+      RemoteTensorBuffer buffer;
+      ChunkedTensorDescription chunks;
       if (!s.ok()) {
         mutex_lock l(mu_);
         status_.Update(s);
+      } else if (transport_ != nullptr &&
+                 GetRemoteTensorBuffer(resp_.metadata(), &buffer)) {
+        PullTensor(buffer, std::move(recv_done));
+        return;
+      } else if (chunk_bytes_ > 0 &&
+                 GetChunkedTensorDescription(resp_.metadata(), &chunks)) {
+        FetchChunks(chunks, std::move(recv_done));
+        return;
       }
       recv_done();
     };
@@ -166,6 +210,186 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     abort_checked->Notify();
   }
 
+  // Pulls the contents of a tensor that the sender exported through the
+  // transport instead of returning them in the response.
+  void PullTensor(const RemoteTensorBuffer& buffer,
+                  std::function<void()> recv_done) {
+    Status s;
+    if (buffer.transport() != transport_->name()) {
+      s = errors::Internal("Received a tensor exported by transport ",
+                           buffer.transport(), " instead of ",
+                           transport_->name());
+    }
+    if (s.ok()) {
+      s = AllocatePulledTensor(buffer.dtype(), buffer.tensor_shape(),
+                               buffer.length());
+    }
+    if (!s.ok()) {
+      {
+        mutex_lock l(mu_);
+        status_.Update(s);
+      }
+      recv_done();
+      return;
+    }
+    has_pulled_tensor_ = true;
+    transport_->PullAsync(
+        src_worker_, buffer, dst_device_, &pulled_tensor_,
+        [this, recv_done = std::move(recv_done)](const Status& s) {
+          if (!s.ok()) {
+            mutex_lock l(mu_);
+            status_.Update(s);
+          }
+          recv_done();
+        });
+  }
+
+  // Allocates the destination of a tensor whose contents are not part of the
+  // response.
+  Status AllocatePulledTensor(DataType dtype,
+                              const TensorShapeProto& shape_proto,
+                              uint64 length) {
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(shape_proto, &shape));
+    pulled_tensor_ =
+        Tensor(dst_device_->GetAllocator(alloc_attrs_), dtype, shape);
+    if (!pulled_tensor_.IsInitialized() ||
+        pulled_tensor_.TotalBytes() != length) {
+      return errors::ResourceExhausted("Failed to allocate ", length,
+                                       " bytes on ", dst_device_->name(),
+                                       " to receive ", req_.rendezvous_key());
+    }
+    return OkStatus();
+  }
+
+  // A RecvTensor call fetching chunks of the tensor one after the other.
+  struct ChunkFetch {
+    WorkerInterface* wi = nullptr;  // Not owned.
+    CallOptions opts;
+    RecvTensorRequest req;
+    TensorResponse resp;
+  };
+
+  // Fetches the contents of a tensor that the sender only described in the
+  // response, with up to RecvTensorChunksInFlight() concurrent calls. Every
+  // call after the first uses its own WorkerInterface, so that the calls are
+  // spread over all the channels the worker cache has to the sender.
+  void FetchChunks(const ChunkedTensorDescription& description,
+                   std::function<void()> recv_done) {
+    Status s = AllocatePulledTensor(description.dtype(),
+                                    description.tensor_shape(),
+                                    description.length());
+    if (!s.ok()) {
+      {
+        mutex_lock l(mu_);
+        status_.Update(s);
+      }
+      recv_done();
+      return;
+    }
+    has_pulled_tensor_ = true;
+    chunk_handle_ = description.handle();
+    num_chunks_ = NumTensorChunks(description.length(), chunk_bytes_);
+    chunks_done_ = std::move(recv_done);
+    const int64_t num_fetches =
+        std::min(num_chunks_, RecvTensorChunksInFlight());
+    std::vector<ChunkFetch*> fetches;
+    {
+      mutex_lock l(mu_);
+      next_chunk_ = 0;
+      for (int64_t i = 0; i < num_fetches; ++i) {
+        WorkerInterface* wi =
+            i == 0 ? wi_ : worker_cache_->GetOrCreateWorker(src_worker_);
+        if (wi == nullptr) break;
+        chunk_fetches_.push_back(std::make_unique<ChunkFetch>());
+        chunk_fetches_.back()->wi = wi;
+        fetches.push_back(chunk_fetches_.back().get());
+      }
+      pending_fetches_ = fetches.size();
+    }
+    for (ChunkFetch* fetch : fetches) {
+      FetchNextChunk(fetch);
+    }
+  }
+
+  void FetchNextChunk(ChunkFetch* fetch) {
+    int64_t chunk = -1;
+    bool finished = false;
+    {
+      mutex_lock l(mu_);
+      if (!status_.ok() || next_chunk_ == num_chunks_) {
+        finished = --pending_fetches_ == 0;
+      } else {
+        chunk = next_chunk_++;
+      }
+    }
+    if (chunk < 0) {
+      if (finished) {
+        FinishChunks();
+      }
+      return;
+    }
+    const uint64 offset = chunk * chunk_bytes_;
+    const uint64 length =
+        std::min<uint64>(chunk_bytes_, pulled_tensor_.TotalBytes() - offset);
+    RecvTensorChunkRequest chunk_request;
+    chunk_request.set_handle(chunk_handle_);
+    chunk_request.set_offset(offset);
+    chunk_request.set_length(length);
+    fetch->req.Clear();
+    fetch->req.set_step_id(req_.step_id());
+    fetch->req.set_rendezvous_key(req_.rendezvous_key());
+    fetch->req.mutable_transport_options()->PackFrom(chunk_request);
+    fetch->resp.Clear();
+    fetch->resp.InitAlloc(dst_device_, alloc_attrs_);
+    fetch->wi->RecvTensorAsync(
+        &fetch->opts, &fetch->req, &fetch->resp,
+        [this, fetch, offset, length](const Status& s) {
+          Status status = s;
+          const Tensor& bytes = fetch->resp.tensor();
+          if (status.ok() &&
+              (bytes.dtype() != DT_UINT8 || bytes.TotalBytes() != length)) {
+            status = errors::Internal("Received ", bytes.TotalBytes(),
+                                      " bytes instead of a chunk of ", length,
+                                      " bytes of ", req_.rendezvous_key());
+          }
+          if (status.ok()) {
+            std::memcpy(
+                static_cast<char*>(DMAHelper::base(&pulled_tensor_)) + offset,
+                DMAHelper::base(&bytes), length);
+          } else {
+            // Stop the other fetches early.
+            StartAbort(status);
+          }
+          FetchNextChunk(fetch);
+        });
+    // As in StartRTCall, cancel the call if the rendezvous was aborted before
+    // the call registered its cancellation.
+    bool aborted;
+    {
+      mutex_lock l(mu_);
+      aborted = !status_.ok();
+    }
+    if (aborted) {
+      fetch->opts.StartCancel();
+    }
+  }
+
+  void FinishChunks() {
+    {
+      mutex_lock l(mu_);
+      for (auto& fetch : chunk_fetches_) {
+        if (fetch->wi != wi_) {
+          worker_cache_->ReleaseWorker(src_worker_, fetch->wi);
+        }
+        fetch->wi = nullptr;
+      }
+    }
+    std::function<void()> done = std::move(chunks_done_);
+    chunks_done_ = nullptr;
+    done();
+  }
+
   string src_worker_;
   string src_rel_device_;
   WorkerInterface* wi_;  // Not owned.
@@ -174,11 +398,23 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   CallOptions opts_;
   RecvTensorRequest req_;
   TensorResponse resp_;
+  TensorTransport* transport_;  // Not owned.
+  Tensor pulled_tensor_;
+  bool has_pulled_tensor_ = false;
+  // State of chunked transfers, for which chunk_bytes_ is positive.
+  int64_t chunk_bytes_ = 0;
+  std::shared_ptr<WorkerCacheInterface> worker_cache_;
+  uint64 chunk_handle_ = 0;
+  int64_t num_chunks_ = 0;
+  std::function<void()> chunks_done_;
   Rendezvous::Args recv_args_;
   Rendezvous::DoneCallback done_;
 
   mutable mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<ChunkFetch>> chunk_fetches_ TF_GUARDED_BY(mu_);
+  int64_t next_chunk_ TF_GUARDED_BY(mu_) = 0;
+  int64_t pending_fetches_ TF_GUARDED_BY(mu_) = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorCall);
 };
@@ -268,7 +504,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   }
 
   call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
-             recv_args, std::move(done));
+             recv_args, std::move(done), env_->tensor_transport, worker_cache);
 
   // Record "call" in calls_ so that it can be aborted cleanly.
   RegisterCall(call, recv_args);
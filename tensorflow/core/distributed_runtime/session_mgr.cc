@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -34,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/tensorflow_server.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/ptr_util.h"
+#include "tensorflow/tsl/distributed_runtime/coordination/coordination_aggregator.h"
 #include "tensorflow/tsl/distributed_runtime/coordination/coordination_service.h"
 #include "tensorflow/tsl/distributed_runtime/coordination/coordination_service_agent.h"
 #include "tensorflow/tsl/protobuf/coordination_config.pb.h"
@@ -297,6 +299,23 @@ Status SessionMgr::CreateSession(
         coordination_config,
         agent_cache->GetOwnedClient(coordination_config.service_leader()),
         std::move(coordination_error_callback)));
+    if (coordination_config.aggregation_fanout() > 1) {
+      CoordinatedTask task;
+      task.set_job_name(server_def.job_name());
+      task.set_task_id(server_def.task_index());
+      std::optional<std::string> parent =
+          tsl::GetAggregationParent(coordination_config, task);
+      if (parent.has_value()) {
+        TF_RETURN_IF_ERROR(
+            coordination_service_agent_->SetAggregationParentClient(
+                agent_cache->GetOwnedClient(*parent)));
+      }
+      // The RPC handler hands the requests of the subtree to the agent.
+      if (coordination_handler_ != nullptr) {
+        coordination_handler_->SetAgentInstance(
+            coordination_service_agent_.get());
+      }
+    }
 
     activity_watcher::MaybeEnableMultiWorkersWatching(
         coordination_service_agent_.get());
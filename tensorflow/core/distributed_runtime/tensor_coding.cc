@@ -54,7 +54,7 @@ Status TensorResponse::InitFrom(RecvTensorResponse* response) {
   Status s;
   meta_.Swap(response);
   if (on_host_) {
-    if (!tensor_.FromProto(allocator_, meta_.tensor())) {
+    if (!tensor_.FromProto(allocator_, std::move(*meta_.mutable_tensor()))) {
       s = errors::InvalidArgument("Cannot parse tensor from response");
     }
   } else {
@@ -87,6 +87,11 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
+    if (!meta_.has_tensor()) {
+      // The contents are transferred out of band, see `transport_options`.
+      tensor_ = Tensor();
+      return OkStatus();
+    }
     Status s =
         device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
     // Reduce memory usage for big tensors.
@@ -279,9 +284,12 @@ bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
   }
+  if (!meta_.has_tensor()) {
+    return true;
+  }
 
   Tensor parsed(meta_.tensor().dtype());
-  if (!parsed.FromProto(allocator_, meta_.tensor())) {
+  if (!parsed.FromProto(allocator_, std::move(*meta_.mutable_tensor()))) {
     return false;
   }
   tensor_ = std::move(parsed);
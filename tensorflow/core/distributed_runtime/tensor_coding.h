@@ -79,7 +79,9 @@ class TensorResponse {
                    const AllocationAttributes& allocation_attr);
 
   // Return a reference to the parsed tensor.  The tensor will remain
-  // live only until *this is destroyed or modified.
+  // live only until *this is destroyed or modified.  The tensor is empty if
+  // the response carries no tensor because its contents are transferred out
+  // of band (see `RecvTensorResponse.transport_options`).
   const Tensor& tensor() const { return tensor_; }
 
   // Return a reference to the parsed tensor metadata (no contents).
@@ -0,0 +1,75 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+
+void RequestTensorTransport(const TensorTransport& transport,
+                            RecvTensorRequest* request) {
+  RecvTensorTransportRequest transport_request;
+  transport_request.set_transport(transport.name());
+  request->set_dma_ok(true);
+  request->mutable_transport_options()->PackFrom(transport_request);
+}
+
+bool AcceptsTensorTransport(const RecvTensorRequest& request,
+                            const TensorTransport& transport) {
+  if (!request.dma_ok() ||
+      !request.transport_options().Is<RecvTensorTransportRequest>()) {
+    return false;
+  }
+  RecvTensorTransportRequest transport_request;
+  return request.transport_options().UnpackTo(&transport_request) &&
+         transport_request.transport() == transport.name();
+}
+
+bool ShouldExportTensor(const TensorTransport& transport, const Tensor& tensor,
+                        bool is_dead) {
+  // Dead tensors have no contents, and tensors that cannot be memcpy-ed have
+  // no contiguous buffer to export.
+  return !is_dead && tensor.IsInitialized() && tensor.TotalBytes() > 0 &&
+         DataTypeCanUseMemcpy(tensor.dtype()) && transport.CanExport(tensor);
+}
+
+Status ExportTensor(TensorTransport* transport, int64_t step_id,
+                    const Tensor& tensor, RecvTensorResponse* response) {
+  RemoteTensorBuffer buffer;
+  TF_RETURN_IF_ERROR(transport->Export(step_id, tensor, &buffer));
+  buffer.set_transport(transport->name());
+  buffer.set_dtype(tensor.dtype());
+  tensor.shape().AsProto(buffer.mutable_tensor_shape());
+  if (buffer.length() != tensor.TotalBytes()) {
+    return errors::Internal("Transport ", transport->name(), " exported ",
+                            buffer.length(), " bytes for a tensor of ",
+                            tensor.TotalBytes(), " bytes.");
+  }
+  // The contents are pulled by the receiver, so the response only carries
+  // the description of the exported buffer.
+  response->clear_tensor();
+  response->set_is_dead(false);
+  response->mutable_transport_options()->PackFrom(buffer);
+  return OkStatus();
+}
+
+bool GetRemoteTensorBuffer(const RecvTensorResponse& response,
+                           RemoteTensorBuffer* buffer) {
+  return response.transport_options().Is<RemoteTensorBuffer>() &&
+         response.transport_options().UnpackTo(buffer);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,104 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_TRANSPORT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_TRANSPORT_H_
+
+#include <cstdint>
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+class Device;
+
+// A TensorTransport moves the contents of tensors received with RecvTensor
+// between workers outside of the RPC, e.g. with RDMA reads from memory
+// regions registered through a verbs or UCX style interface. The RPC remains
+// the control channel: the receiver offers the transport in its
+// RecvTensorRequest, and the sender replies with a RemoteTensorBuffer
+// describing an exported buffer instead of the tensor contents. The receiver
+// then pulls the buffer directly into memory of the destination device.
+//
+// Implementations must be thread-safe.
+class TensorTransport {
+ public:
+  virtual ~TensorTransport() {}
+
+  // Name of the transport. Tensors are only transferred through the
+  // transport if the sender and the receiver use transports of the same name.
+  virtual const std::string& name() const = 0;
+
+  // Returns true if tensors received on `device` into memory allocated with
+  // `attrs` can be pulled through this transport.
+  virtual bool CanImport(Device* device,
+                         const AllocatorAttributes& attrs) const = 0;
+
+  // Returns true if the buffer of `tensor`, which may reside in host or
+  // accelerator memory, should be exported. Transports typically decline
+  // small tensors, for which sending the contents in the RPC is cheaper.
+  // Must return the same result when called again for the same tensor.
+  virtual bool CanExport(const Tensor& tensor) const = 0;
+
+  // Registers the buffer of `tensor` for remote access by the receivers of
+  // step `step_id` and describes it in `buffer`. The transport keeps a
+  // reference to the buffer until it has been pulled or until
+  // `ReleaseStep(step_id)` is called.
+  virtual Status Export(int64_t step_id, const Tensor& tensor,
+                        RemoteTensorBuffer* buffer) = 0;
+
+  // Copies the contents of `buffer`, exported by the worker `src_task`, into
+  // `tensor` and then calls `done`. `tensor` is allocated on `device` with the
+  // dtype and shape of `buffer`.
+  virtual void PullAsync(const std::string& src_task,
+                         const RemoteTensorBuffer& buffer, Device* device,
+                         Tensor* tensor, StatusCallback done) = 0;
+
+  // Releases the buffers exported for `step_id` that have not been pulled,
+  // e.g. because the step was aborted.
+  virtual void ReleaseStep(int64_t step_id) = 0;
+};
+
+// Offers `transport` for the tensor requested by `request`.
+void RequestTensorTransport(const TensorTransport& transport,
+                            RecvTensorRequest* request);
+
+// Returns true if `request` offers a transport of the same name as
+// `transport`.
+bool AcceptsTensorTransport(const RecvTensorRequest& request,
+                            const TensorTransport& transport);
+
+// Returns true if `tensor` should be sent through `transport` to a receiver
+// that offered it.
+bool ShouldExportTensor(const TensorTransport& transport, const Tensor& tensor,
+                        bool is_dead);
+
+// Exports `tensor` through `transport` and fills `response` with everything
+// the receiver needs to pull it, except for the tensor contents.
+Status ExportTensor(TensorTransport* transport, int64_t step_id,
+                    const Tensor& tensor, RecvTensorResponse* response);
+
+// Returns true and fills `buffer` if the contents of the tensor in `response`
+// have to be pulled through a transport.
+bool GetRemoteTensorBuffer(const RecvTensorResponse& response,
+                           RemoteTensorBuffer* buffer);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_TRANSPORT_H_
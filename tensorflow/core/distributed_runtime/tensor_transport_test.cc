@@ -0,0 +1,191 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Exports tensors by address and pulls them with a memcpy, which works as
+// long as the sender and the receiver share the address space.
+class InProcessTransport : public TensorTransport {
+ public:
+  explicit InProcessTransport(const std::string& name) : name_(name) {}
+
+  const std::string& name() const override { return name_; }
+
+  bool CanImport(Device* device,
+                 const AllocatorAttributes& attrs) const override {
+    return true;
+  }
+
+  bool CanExport(const Tensor& tensor) const override {
+    return tensor.TotalBytes() >= kMinBytes;
+  }
+
+  Status Export(int64_t step_id, const Tensor& tensor,
+                RemoteTensorBuffer* buffer) override {
+    buffer->set_address(reinterpret_cast<uint64_t>(DMAHelper::base(&tensor)));
+    buffer->set_length(tensor.TotalBytes());
+    mutex_lock l(mu_);
+    exported_[buffer->address()] = tensor;
+    return OkStatus();
+  }
+
+  void PullAsync(const std::string& src_task, const RemoteTensorBuffer& buffer,
+                 Device* device, Tensor* tensor,
+                 StatusCallback done) override {
+    mutex_lock l(mu_);
+    if (exported_.erase(buffer.address()) == 0) {
+      done(errors::NotFound("Buffer was not exported."));
+      return;
+    }
+    std::memcpy(DMAHelper::base(tensor),
+                reinterpret_cast<const void*>(buffer.address()),
+                buffer.length());
+    done(OkStatus());
+  }
+
+  void ReleaseStep(int64_t step_id) override {
+    mutex_lock l(mu_);
+    exported_.clear();
+  }
+
+  int num_exported() {
+    mutex_lock l(mu_);
+    return exported_.size();
+  }
+
+ private:
+  static constexpr int64_t kMinBytes = 64;
+
+  const std::string name_;
+  mutex mu_;
+  std::map<uint64_t, Tensor> exported_ TF_GUARDED_BY(mu_);
+};
+
+class DummyDevice : public DeviceBase {
+ public:
+  explicit DummyDevice(Env* env) : DeviceBase(env) {
+    attr_.set_device_type("CPU");
+  }
+
+  const DeviceAttributes& attributes() const override { return attr_; }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+ private:
+  DeviceAttributes attr_;
+};
+
+class StringSource : public TensorResponse::Source {
+ public:
+  explicit StringSource(const std::string* s) : s_(s) {}
+
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    stream_ = std::make_unique<protobuf::io::ArrayInputStream>(s_->data(),
+                                                               s_->size());
+    return stream_.get();
+  }
+
+ private:
+  const std::string* s_;
+  std::unique_ptr<protobuf::io::ArrayInputStream> stream_;
+};
+
+TEST(TensorTransportTest, RequestsMatchingTransport) {
+  InProcessTransport transport("in_process");
+  RecvTensorRequest request;
+  EXPECT_FALSE(AcceptsTensorTransport(request, transport));
+
+  RequestTensorTransport(transport, &request);
+  EXPECT_TRUE(request.dma_ok());
+  EXPECT_TRUE(AcceptsTensorTransport(request, transport));
+  EXPECT_FALSE(
+      AcceptsTensorTransport(request, InProcessTransport("other_transport")));
+}
+
+TEST(TensorTransportTest, ExportsOnlyLargeMemcpyableTensors) {
+  InProcessTransport transport("in_process");
+  Tensor large(DT_FLOAT, TensorShape({64}));
+  EXPECT_TRUE(ShouldExportTensor(transport, large, /*is_dead=*/false));
+  EXPECT_FALSE(ShouldExportTensor(transport, large, /*is_dead=*/true));
+  EXPECT_FALSE(ShouldExportTensor(transport, Tensor(DT_FLOAT, TensorShape({2})),
+                                  /*is_dead=*/false));
+  EXPECT_FALSE(ShouldExportTensor(
+      transport, Tensor(DT_STRING, TensorShape({64})), /*is_dead=*/false));
+}
+
+TEST(TensorTransportTest, ReceiverPullsExportedTensor) {
+  InProcessTransport transport("in_process");
+  Tensor src(DT_INT32, TensorShape({4, 8}));
+  test::FillIota<int32>(&src, 1);
+
+  RecvTensorResponse proto;
+  TF_ASSERT_OK(ExportTensor(&transport, /*step_id=*/1, src, &proto));
+  EXPECT_FALSE(proto.has_tensor());
+  std::string encoded;
+  proto.AppendToString(&encoded);
+
+  // The response carries no contents, only the description of the buffer.
+  StringSource source(&encoded);
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_FALSE(response.tensor().IsInitialized());
+  RemoteTensorBuffer buffer;
+  ASSERT_TRUE(GetRemoteTensorBuffer(response.metadata(), &buffer));
+  EXPECT_EQ(buffer.transport(), "in_process");
+  EXPECT_EQ(buffer.dtype(), DT_INT32);
+  EXPECT_EQ(buffer.length(), src.TotalBytes());
+
+  Tensor dst(DT_INT32, TensorShape(buffer.tensor_shape()));
+  Status pull_status = errors::Unknown("Pull did not finish.");
+  transport.PullAsync("/job:worker/replica:0/task:0", buffer,
+                      /*device=*/nullptr, &dst,
+                      [&pull_status](const Status& s) { pull_status = s; });
+  TF_ASSERT_OK(pull_status);
+  test::ExpectTensorEqual<int32>(dst, src);
+  EXPECT_EQ(transport.num_exported(), 0);
+}
+
+TEST(TensorTransportTest, InlineResponseHasNoRemoteBuffer) {
+  RecvTensorResponse proto;
+  Tensor tensor(DT_FLOAT, TensorShape({2}));
+  tensor.AsProtoTensorContent(proto.mutable_tensor());
+  RemoteTensorBuffer buffer;
+  EXPECT_FALSE(GetRemoteTensorBuffer(proto, &buffer));
+}
+
+}  // namespace
+}  // namespace tensorflow
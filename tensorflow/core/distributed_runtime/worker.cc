@@ -23,6 +23,8 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/error_payloads.h"
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
+#include "tensorflow/core/distributed_runtime/worker_cache_logger.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -51,6 +53,7 @@ void Worker::GetStatusAsync(CallOptions* opts, const GetStatusRequest* request,
   for (auto& d : devices) {
     response->add_device_attributes()->Swap(&d);
   }
+  RpcLinkMetrics::GetAll(response->mutable_link_stats());
   done(OkStatus());
 }
 
@@ -359,6 +362,9 @@ void Worker::CleanupGraphAsync(const CleanupGraphRequest* request,
                                StatusCallback done) {
   const int64_t step_id = request->step_id();
   env_->rendezvous_mgr->Cleanup(step_id);
+  if (env_->tensor_transport != nullptr) {
+    env_->tensor_transport->ReleaseStep(step_id);
+  }
   if (env_->collective_executor_mgr) {
     env_->collective_executor_mgr->Cleanup(step_id);
   }
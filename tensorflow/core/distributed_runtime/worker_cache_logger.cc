@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/worker_cache_logger.h"
 
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/tensor_description.pb.h"
@@ -29,6 +34,53 @@ namespace {
 // Maximum number of step_ids for which RPC logs can be maintained.
 // TODO(mrry): Make this configurable if necessary.
 const int32_t kWorkerCacheLoggerLimit = 1 << 10;
+
+auto* rpc_calls = monitoring::Counter<2>::New(
+    "/tensorflow/core/rpc/client/calls",
+    "The number of completed data transfer calls to a peer.", "peer",
+    "method");
+
+auto* rpc_errors = monitoring::Counter<2>::New(
+    "/tensorflow/core/rpc/client/errors",
+    "The number of data transfer calls to a peer that failed.", "peer",
+    "method");
+
+auto* rpc_bytes_received = monitoring::Counter<2>::New(
+    "/tensorflow/core/rpc/client/bytes_received",
+    "The number of bytes of tensor data received from a peer.", "peer",
+    "method");
+
+auto* rpc_latency = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/rpc/client/latency_usecs",
+     "The latency of data transfer calls to a peer in microseconds.", "peer",
+     "method"},
+    // Power of 2 buckets from 1us to about 18 minutes.
+    monitoring::Buckets::Exponential(1, 2, 31));
+
+auto* rpc_bandwidth = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/rpc/client/bandwidth_bytes_per_second",
+     "The effective bandwidth of data transfer calls to a peer.", "peer",
+     "method"},
+    // Power of 2 buckets from 1KB/s to about 1TB/s.
+    monitoring::Buckets::Exponential(1024, 2, 31));
+
+auto* rpc_in_flight = monitoring::Gauge<int64_t, 2>::New(
+    "/tensorflow/core/rpc/client/in_flight_calls",
+    "The number of data transfer calls to a peer that have not completed.",
+    "peer", "method");
+
+// Process-wide registry of the RpcLinkMetrics.
+struct RpcLinkRegistry {
+  mutex mu;
+  absl::flat_hash_map<std::pair<string, string>,
+                      std::unique_ptr<RpcLinkMetrics>>
+      links TF_GUARDED_BY(mu);
+};
+
+RpcLinkRegistry* GetRpcLinkRegistry() {
+  static RpcLinkRegistry* registry = new RpcLinkRegistry;
+  return registry;
+}
 }  // namespace
 
 void WorkerCacheLogger::SetLogging(bool v) {
@@ -130,4 +182,79 @@ void WorkerCacheLogger::RecordDataTransfer(int64_t step_id, int64_t start_usecs,
   Save(dst_device, step_id, ns);
 }
 
+RpcLinkMetrics* RpcLinkMetrics::Get(const string& peer, const string& method) {
+  RpcLinkRegistry* registry = GetRpcLinkRegistry();
+  mutex_lock l(registry->mu);
+  std::unique_ptr<RpcLinkMetrics>& link =
+      registry->links[std::make_pair(peer, method)];
+  if (link == nullptr) {
+    link.reset(new RpcLinkMetrics(peer, method));
+  }
+  return link.get();
+}
+
+void RpcLinkMetrics::GetAll(protobuf::RepeatedPtrField<RpcLinkStats>* stats) {
+  RpcLinkRegistry* registry = GetRpcLinkRegistry();
+  mutex_lock l(registry->mu);
+  for (const auto& link : registry->links) {
+    link.second->GetStats(stats->Add());
+  }
+}
+
+RpcLinkMetrics::RpcLinkMetrics(const string& peer, const string& method)
+    : peer_(peer),
+      method_(method),
+      calls_cell_(rpc_calls->GetCell(peer, method)),
+      errors_cell_(rpc_errors->GetCell(peer, method)),
+      bytes_cell_(rpc_bytes_received->GetCell(peer, method)),
+      latency_cell_(rpc_latency->GetCell(peer, method)),
+      bandwidth_cell_(rpc_bandwidth->GetCell(peer, method)),
+      in_flight_cell_(rpc_in_flight->GetCell(peer, method)) {}
+
+void RpcLinkMetrics::CallStarted() {
+  mutex_lock l(in_flight_mu_);
+  in_flight_cell_->Set(++in_flight_calls_);
+}
+
+void RpcLinkMetrics::CallFinished(int64_t latency_usecs, int64_t bytes,
+                                  const Status& status) {
+  {
+    mutex_lock l(in_flight_mu_);
+    in_flight_cell_->Set(--in_flight_calls_);
+  }
+  latency_usecs = std::max<int64_t>(latency_usecs, 0);
+  num_calls_.fetch_add(1, std::memory_order_relaxed);
+  calls_cell_->IncrementBy(1);
+  if (!status.ok()) {
+    num_errors_.fetch_add(1, std::memory_order_relaxed);
+    errors_cell_->IncrementBy(1);
+  }
+  total_latency_micros_.fetch_add(latency_usecs, std::memory_order_relaxed);
+  int64_t max_latency = max_latency_micros_.load(std::memory_order_relaxed);
+  while (latency_usecs > max_latency &&
+         !max_latency_micros_.compare_exchange_weak(
+             max_latency, latency_usecs, std::memory_order_relaxed)) {
+  }
+  latency_cell_->Add(latency_usecs);
+  if (status.ok() && bytes > 0) {
+    bytes_received_.fetch_add(bytes, std::memory_order_relaxed);
+    bytes_cell_->IncrementBy(bytes);
+    bandwidth_cell_->Add(1e6 * bytes / std::max<int64_t>(latency_usecs, 1));
+  }
+}
+
+void RpcLinkMetrics::GetStats(RpcLinkStats* stats) const {
+  stats->set_peer(peer_);
+  stats->set_method(method_);
+  stats->set_num_calls(num_calls_.load(std::memory_order_relaxed));
+  stats->set_num_errors(num_errors_.load(std::memory_order_relaxed));
+  stats->set_bytes_received(bytes_received_.load(std::memory_order_relaxed));
+  stats->set_total_latency_micros(
+      total_latency_micros_.load(std::memory_order_relaxed));
+  stats->set_max_latency_micros(
+      max_latency_micros_.load(std::memory_order_relaxed));
+  mutex_lock l(in_flight_mu_);
+  stats->set_in_flight_calls(in_flight_calls_);
+}
+
 }  // namespace tensorflow
@@ -16,13 +16,20 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_CACHE_LOGGER_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_CACHE_LOGGER_H_
 
+#include <atomic>
 #include <string>
 #include <unordered_map>
 
 #include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
 class StepStatsCollector;
@@ -85,5 +92,60 @@ class WorkerCacheLogger {
 
   void ClearLogsWithLock() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 };
+
+// RpcLinkMetrics keeps always-on metrics of the data transfers a worker makes
+// from one peer with one RPC method, unlike WorkerCacheLogger which only
+// records individual transfers while step logging is on. The metrics are
+// exported through monitoring under /tensorflow/core/rpc/client/ and are
+// returned by GetStatus, so that slow links and stragglers can be found in
+// large jobs. Updating them costs a few atomic operations per call.
+//
+// This class is thread-safe.
+class RpcLinkMetrics {
+ public:
+  // Returns the metrics of the calls of `method` to `peer`. The returned
+  // object is owned by a process-wide registry and is never deleted.
+  static RpcLinkMetrics* Get(const string& peer, const string& method);
+
+  // Appends the metrics of every link that has been used to `stats`.
+  static void GetAll(protobuf::RepeatedPtrField<RpcLinkStats>* stats);
+
+  // Records that a call was issued.
+  void CallStarted();
+
+  // Records that a call completed with `status` after `latency_usecs`,
+  // having received `bytes` of tensor data.
+  void CallFinished(int64_t latency_usecs, int64_t bytes, const Status& status);
+
+  // Fills `stats` with the metrics of this link. Retries are counted by the
+  // RPC layer, which fills `num_retries`.
+  void GetStats(RpcLinkStats* stats) const;
+
+ private:
+  RpcLinkMetrics(const string& peer, const string& method);
+
+  const string peer_;
+  const string method_;
+
+  monitoring::CounterCell* const calls_cell_;
+  monitoring::CounterCell* const errors_cell_;
+  monitoring::CounterCell* const bytes_cell_;
+  monitoring::SamplerCell* const latency_cell_;
+  monitoring::SamplerCell* const bandwidth_cell_;
+  monitoring::GaugeCell<int64_t>* const in_flight_cell_;
+
+  std::atomic<int64_t> num_calls_{0};
+  std::atomic<int64_t> num_errors_{0};
+  std::atomic<int64_t> bytes_received_{0};
+  std::atomic<int64_t> total_latency_micros_{0};
+  std::atomic<int64_t> max_latency_micros_{0};
+
+  // Guards the update of the gauge along with the count, so that the exported
+  // value cannot get stuck at a stale count.
+  mutable mutex in_flight_mu_;
+  int64_t in_flight_calls_ TF_GUARDED_BY(in_flight_mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcLinkMetrics);
+};
 }  // namespace tensorflow
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_CACHE_LOGGER_H_
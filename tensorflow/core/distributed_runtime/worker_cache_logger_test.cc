@@ -0,0 +1,80 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/worker_cache_logger.h"
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+namespace {
+
+using monitoring::testing::CellReader;
+
+constexpr char kPeer[] = "/job:worker/replica:0/task:1";
+constexpr char kMethod[] = "/tensorflow.WorkerService/RecvTensor";
+
+TEST(RpcLinkMetricsTest, GetReturnsSameLink) {
+  EXPECT_EQ(RpcLinkMetrics::Get(kPeer, "same"),
+            RpcLinkMetrics::Get(kPeer, "same"));
+  EXPECT_NE(RpcLinkMetrics::Get(kPeer, "same"),
+            RpcLinkMetrics::Get(kPeer, "other"));
+}
+
+TEST(RpcLinkMetricsTest, RecordsCalls) {
+  CellReader<int64_t> calls("/tensorflow/core/rpc/client/calls");
+  CellReader<int64_t> bytes("/tensorflow/core/rpc/client/bytes_received");
+  CellReader<int64_t> in_flight("/tensorflow/core/rpc/client/in_flight_calls");
+  RpcLinkMetrics* link = RpcLinkMetrics::Get(kPeer, kMethod);
+
+  link->CallStarted();
+  link->CallStarted();
+  EXPECT_EQ(in_flight.Read(kPeer, kMethod), 2);
+  link->CallFinished(/*latency_usecs=*/100, /*bytes=*/4096, OkStatus());
+  link->CallFinished(/*latency_usecs=*/300, /*bytes=*/0,
+                     errors::Unavailable("Connection reset"));
+  EXPECT_EQ(calls.Delta(kPeer, kMethod), 2);
+  EXPECT_EQ(bytes.Delta(kPeer, kMethod), 4096);
+  EXPECT_EQ(in_flight.Read(kPeer, kMethod), 0);
+
+  RpcLinkStats stats;
+  link->GetStats(&stats);
+  EXPECT_EQ(stats.peer(), kPeer);
+  EXPECT_EQ(stats.method(), kMethod);
+  EXPECT_EQ(stats.num_calls(), 2);
+  EXPECT_EQ(stats.num_errors(), 1);
+  EXPECT_EQ(stats.bytes_received(), 4096);
+  EXPECT_EQ(stats.total_latency_micros(), 400);
+  EXPECT_EQ(stats.max_latency_micros(), 300);
+  EXPECT_EQ(stats.in_flight_calls(), 0);
+}
+
+TEST(RpcLinkMetricsTest, GetAllIncludesEveryLink) {
+  RpcLinkMetrics::Get("/job:worker/replica:0/task:2", kMethod)->CallStarted();
+  GetStatusResponse response;
+  RpcLinkMetrics::GetAll(response.mutable_link_stats());
+  bool found = false;
+  for (const RpcLinkStats& stats : response.link_stats()) {
+    if (stats.peer() == "/job:worker/replica:0/task:2") {
+      found = true;
+      EXPECT_EQ(stats.in_flight_calls(), 1);
+    }
+  }
+  EXPECT_TRUE(found);
+}
+
+}  // namespace
+}  // namespace tensorflow
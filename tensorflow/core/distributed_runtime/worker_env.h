@@ -38,6 +38,7 @@ class Device;
 class DeviceMgr;
 class RendezvousMgrInterface;
 class SessionMgr;
+class TensorTransport;
 
 // The worker environment class, which holds a bag of pointers to
 // per-worker singletons.
@@ -71,6 +72,10 @@ struct WorkerEnv {
   // A set of rendezvous keyed by step ids.
   RendezvousMgrInterface* rendezvous_mgr = nullptr;
 
+  // If set, transfers the contents of tensors received from or sent to other
+  // workers outside of the RecvTensor RPC, e.g. with RDMA.
+  TensorTransport* tensor_transport = nullptr;
+
   // Generates per-step CollectiveExecutors and has access to utilities
   // supporting collective operations.
   std::unique_ptr<CollectiveExecutorMgrInterface> collective_executor_mgr;
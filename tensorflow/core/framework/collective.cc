@@ -88,6 +88,9 @@ CollInstanceParams& CollInstanceParams::operator=(
         other.impl_details.subdiv_source_rank.begin(),
         other.impl_details.subdiv_source_rank.end());
     impl_details.dependencies = other.impl_details.dependencies;
+    impl_details.compression = other.impl_details.compression;
+    impl_details.topk_ratio = other.impl_details.topk_ratio;
+    impl_details.min_contributions = other.impl_details.min_contributions;
     devices.assign(other.devices.begin(), other.devices.end());
     permutation.assign(other.permutation.begin(), other.permutation.end());
   }
@@ -120,6 +123,16 @@ string CollInstanceParams::ToString() const {
     }
     strings::StrAppend(&v, "}");
   }  // all subdivs
+  if (impl_details.compression != COLLECTIVE_COMPRESSION_NONE) {
+    strings::StrAppend(&v, " compression=", impl_details.compression);
+    if (impl_details.compression == COLLECTIVE_COMPRESSION_TOP_K) {
+      strings::StrAppend(&v, " topk_ratio=", impl_details.topk_ratio);
+    }
+  }
+  if (impl_details.min_contributions > 0) {
+    strings::StrAppend(&v, " min_contributions=",
+                       impl_details.min_contributions);
+  }
   if (type == PERMUTE_COLLECTIVE) {
     strings::StrAppend(&v, "}, permute_devices {");
     for (const auto& d : devices) {
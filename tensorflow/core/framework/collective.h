@@ -51,6 +51,15 @@ enum CollectiveType {
   UNDEFINED_COLLECTIVE,
 };
 
+// Lossy compression applied to the tensors that a collective sends to devices
+// in other tasks.
+enum CollectiveCompression {
+  COLLECTIVE_COMPRESSION_NONE = 0,
+  COLLECTIVE_COMPRESSION_FLOAT16,   // cast to half precision
+  COLLECTIVE_COMPRESSION_BFLOAT16,  // cast to bfloat16
+  COLLECTIVE_COMPRESSION_TOP_K,     // top-k sparsification, reductions only
+};
+
 // Some collective op implementations require runtime group configuration from
 // the OpKernel.  Currently, this struct is used to set communicator key for
 // NCCL-based collective implementation.
@@ -115,6 +124,16 @@ struct CollImplDetails {
                               // e.g. ring or nccl
   float timeout_seconds;      // If non zero, set a completion timeout for the
                               // collective op to detect staleness.
+  // Wire compression for transfers between tasks. Must be the same for all
+  // members of the group.
+  CollectiveCompression compression = COLLECTIVE_COMPRESSION_NONE;
+  // Fraction of the elements of a chunk sent by COLLECTIVE_COMPRESSION_TOP_K.
+  float topk_ratio = 0.01;
+  // If positive, a reduction completes as soon as this many members of the
+  // group have contributed, within `timeout_seconds`. Late contributions are
+  // dropped and the result is rescaled to the number of contributions. Must
+  // be the same for all members of the group.
+  int32 min_contributions = 0;
 };
 
 // Data common to all members of a collective instance.
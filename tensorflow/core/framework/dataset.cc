@@ -924,6 +924,18 @@ string DatasetBaseIterator::BuildTraceMeName() {
   for (const auto& pair : metadata) {
     strings::StrAppend(&result, ",", pair.first, "=", pair.second);
   }
+  if (node_) {
+    // Exports what the autotuning model knows about the iterator, so that the
+    // profiler can tell which stage of the pipeline is the bottleneck. These
+    // are atomics, which are read without locking the node.
+    const int64_t num_elements = node_->num_elements();
+    if (num_elements > 0) {
+      strings::StrAppend(&result, ",model_processing_time_ns=",
+                         node_->processing_time() / num_elements);
+    }
+    strings::StrAppend(&result, ",model_buffered_elements=",
+                       node_->buffered_elements());
+  }
   strings::StrAppend(&result, "#");
   return result;
 }
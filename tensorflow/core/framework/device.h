@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/graph/types.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/device_name_utils.h"
@@ -158,6 +159,11 @@ class Device : public DeviceBase {
   // Returns the resource manager associated w/ this device.
   virtual ResourceMgr* resource_manager() { return rmgr_; }
 
+  // Returns an allocator that executors pass to kernels for the intermediate
+  // tensors of a step (see `OpKernelContext::Params::step_allocator`), or
+  // nullptr if kernels should use `GetAllocator()`.
+  virtual Allocator* GetStepArenaAllocator() { return nullptr; }
+
   // Summarizes the status of this Device, for debugging.
   std::string DebugString() const { return device_attributes_.DebugString(); }
 
@@ -180,6 +186,14 @@ class Device : public DeviceBase {
     device_attributes_.set_xla_global_id(id);
   }
 
+  // Updates `attributes()` with the position of this device's host in the
+  // cluster network. See `DeviceLocality.network_coordinates`.
+  void set_network_coordinates(
+      const protobuf::RepeatedField<int32>& coordinates) {
+    *device_attributes_.mutable_locality()->mutable_network_coordinates() =
+        coordinates;
+  }
+
   // Clears the resource manager associated with this device.
   void ClearResourceMgr() { rmgr_->Clear(); }
 
@@ -15,11 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/framework/metrics.h"
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 
 #include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/tsl/lib/monitoring/counter.h"
 #include "tensorflow/tsl/lib/monitoring/gauge.h"
 #include "tensorflow/tsl/lib/monitoring/sampler.h"
@@ -49,6 +54,14 @@ auto* graph_pending_queue_length_histogram = tsl::monitoring::Sampler<0>::New(
     // Power of 1.5 with bucket count 30 (> 191k)
     {tsl::monitoring::Buckets::Exponential(1, 1.5, 30)});
 
+auto* inter_op_schedule_delay_usecs_histogram =
+    tsl::monitoring::Sampler<0>::New(
+        {"/tensorflow/core/inter_op_schedule_delay_usecs_histogram",
+         "The sampled delay in microseconds between scheduling a closure on "
+         "an inter-op thread pool and a thread starting to run it."},
+        // Power of 2 with bucket count 20 (> 1 second)
+        {tsl::monitoring::Buckets::Exponential(1, 2, 20)});
+
 auto* graph_run_input_tensor_bytes = tsl::monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_input_tensor_bytes",
      "The size of input tensors in bytes."},
@@ -65,6 +78,32 @@ auto* graph_unused_outputs = tsl::monitoring::Counter<1>::New(
     "/tensorflow/core/graph_unused_outputs",
     "The number of unused outputs for ops of a given type.", "name");
 
+auto* op_kernel_executions = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/op_kernel_executions",
+    "The number of sampled kernel executions of ops of a given type, which "
+    "the other /tensorflow/core/op_kernel_* metrics are collected over.",
+    "op_type");
+
+auto* op_kernel_duration_nsecs_histogram = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/op_kernel_duration_nsecs_histogram",
+     "The wall-clock time of sampled kernel executions of ops of a given "
+     "type in nanoseconds.",
+     "op_type"},
+    // Power of 2 with bucket count 28 (> 13 seconds)
+    {tsl::monitoring::Buckets::Exponential(100, 2, 28)});
+
+auto* op_kernel_input_bytes = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/op_kernel_input_bytes",
+    "The total size in bytes of the inputs of sampled kernel executions of "
+    "ops of a given type.",
+    "op_type");
+
+auto* op_kernel_output_bytes = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/op_kernel_output_bytes",
+    "The total size in bytes of the outputs of sampled kernel executions of "
+    "ops of a given type.",
+    "op_type");
+
 auto* tf_data_fetch_op_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/fetch_op",
     "The number of times a tf.data operation that fetches output(s) of a "
@@ -93,6 +132,25 @@ auto* tf_data_bytes_fetched_counter = tsl::monitoring::Counter<0>::New(
 auto* tf_data_elements_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/elements", "tf.data elements", "name");
 
+auto* tf_data_processing_time_usecs_histogram =
+    tsl::monitoring::Sampler<1>::New(
+        {"/tensorflow/data/processing_time",
+         "Per-element processing time (in microseconds) of a tf.data "
+         "transformation, averaged over the period between two metric "
+         "updates.",
+         "name"},
+        // Power of 2 with bucket count 24 (from 1 usec to about 8 secs).
+        {tsl::monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* tf_data_buffer_utilization_histogram = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/data/buffer_utilization",
+     "Ratio of the number of elements buffered by an asynchronous tf.data "
+     "transformation over its buffer size.",
+     "name"},
+    // Uniform linear buckets with count 10 from 0 to 1
+    {tsl::monitoring::Buckets::Explicit(
+        {0.0, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0})});
+
 auto* tf_data_experiment_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/experiment",
     "The number of times tf.data experiment is applied to input pipelines.",
@@ -173,6 +231,13 @@ auto* tf_data_service_cross_trainer_cache_size_bytes =
         "/tensorflow/data/service/cross_trainer_cache_size_bytes",
         "tf.data service cross-trainer cache memory usage in bytes.");
 
+auto* tf_data_service_cross_trainer_cache_spill_bytes_counter =
+    tsl::monitoring::Counter<1>::New(
+        "/tensorflow/data/service/cross_trainer_cache_spill_bytes",
+        "tf.data service cross-trainer cache bytes spilled to disk and read "
+        "back from disk. The operation can be write or read.",
+        "operation");
+
 auto* tf_data_filename_counter = tsl::monitoring::Counter<2>::New(
     "/tensorflow/data/filename", "The file name read by a tf.data Dataset.",
     "name", "filename");
@@ -314,6 +379,16 @@ tsl::monitoring::CounterCell* GetTFDataElementsCounter(const string& name) {
   return tf_data_elements_counter->GetCell(name);
 }
 
+tsl::monitoring::SamplerCell* GetTFDataProcessingTimeHistogram(
+    const string& name) {
+  return tf_data_processing_time_usecs_histogram->GetCell(name);
+}
+
+tsl::monitoring::SamplerCell* GetTFDataBufferUtilizationHistogram(
+    const string& name) {
+  return tf_data_buffer_utilization_histogram->GetCell(name);
+}
+
 tsl::monitoring::GaugeCell<std::function<std::string()>>* GetTFDataModelGauge(
     const string& id) {
   return tf_data_model_gauge->GetCell(id);
@@ -416,6 +491,13 @@ void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes) {
       static_cast<int64_t>(bytes));
 }
 
+void RecordTFDataServiceCrossTrainerCacheSpillBytes(bool is_read,
+                                                    size_t bytes) {
+  tf_data_service_cross_trainer_cache_spill_bytes_counter
+      ->GetCell(is_read ? "read" : "write")
+      ->IncrementBy(static_cast<int64_t>(bytes));
+}
+
 void RecordTFDataFilename(const string& name, const string& filename) {
   tf_data_filename_counter->GetCell(name, filename)->IncrementBy(1);
 }
@@ -496,6 +578,12 @@ void UpdateGraphPendingQueueLength(uint64 len) {
   graph_pending_queue_length_cell->Add(len);
 }
 
+void UpdateInterOpScheduleDelay(uint64 delay_usecs) {
+  static auto* inter_op_schedule_delay_usecs_cell =
+      inter_op_schedule_delay_usecs_histogram->GetCell();
+  inter_op_schedule_delay_usecs_cell->Add(delay_usecs);
+}
+
 void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     static auto* build_graph_calls_cell = build_graph_calls->GetCell();
@@ -536,6 +624,54 @@ void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
 
+namespace {
+std::atomic<int64_t>* OpKernelExecutionSamplingPeriod() {
+  static std::atomic<int64_t>* sampling_period = [] {
+    int64_t period;
+    Status s = ReadInt64FromEnvVar("TF_OP_KERNEL_METRICS_SAMPLING_PERIOD",
+                                   /*default_val=*/0, &period);
+    if (!s.ok()) {
+      LOG(ERROR) << "Ignoring TF_OP_KERNEL_METRICS_SAMPLING_PERIOD: " << s;
+      period = 0;
+    }
+    return new std::atomic<int64_t>(period);
+  }();
+  return sampling_period;
+}
+}  // namespace
+
+void SetOpKernelExecutionSamplingPeriod(int64_t period) {
+  OpKernelExecutionSamplingPeriod()->store(period, std::memory_order_relaxed);
+}
+
+bool ShouldSampleOpKernelExecution() {
+  const int64_t sampling_period =
+      OpKernelExecutionSamplingPeriod()->load(std::memory_order_relaxed);
+  if (TF_PREDICT_TRUE(sampling_period <= 0)) return false;
+  static thread_local int64_t num_executions = 0;
+  return ++num_executions % sampling_period == 0;
+}
+
+void RecordOpKernelExecution(OpKernelContext* context, uint64 duration_nsecs) {
+  int64_t input_bytes = 0;
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (context->has_input(i) && !context->input_is_ref(i)) {
+      input_bytes += context->input(i).TotalBytes();
+    }
+  }
+  int64_t output_bytes = 0;
+  for (int i = 0; i < context->num_outputs(); ++i) {
+    if (const Tensor* output = context->mutable_output(i)) {
+      output_bytes += output->TotalBytes();
+    }
+  }
+  const string& op_type = context->op_kernel().type_string();
+  op_kernel_executions->GetCell(op_type)->IncrementBy(1);
+  op_kernel_duration_nsecs_histogram->GetCell(op_type)->Add(duration_nsecs);
+  op_kernel_input_bytes->GetCell(op_type)->IncrementBy(input_bytes);
+  op_kernel_output_bytes->GetCell(op_type)->IncrementBy(output_bytes);
+}
+
 void IncrementTestCounter(const string& name, const string& label) {
   test_counters->GetCell(name, label)->IncrementBy(1);
 }
@@ -574,6 +710,15 @@ void UpdateEagerClientErrorCounter(const string& error_source,
   eager_client_error_counter->GetCell(error_source, error_type)->IncrementBy(1);
 }
 
+void UpdateOneDnnCacheLookups(const string& cache, bool hit, int64_t count) {
+  static auto* onednn_cache_lookups = tsl::monitoring::Counter<2>::New(
+      "/tensorflow/core/onednn_cache_lookups",
+      "The number of lookups in the oneDNN primitive and weight caches.",
+      "cache", "result");
+  onednn_cache_lookups->GetCell(cache, hit ? "hit" : "miss")
+      ->IncrementBy(count);
+}
+
 void UpdateTfMlirBridgeGraphAnalysisPerOp(
     const std::string& op_name, const std::string& construction_context,
     bool is_single_core_inference_mode, const std::string& num_replicas,
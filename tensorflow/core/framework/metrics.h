@@ -20,12 +20,16 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
 
 namespace tensorflow {
+
+class OpKernelContext;
+
 namespace metrics {
 // Records when a data-fetching tf.data operation is executed.
 //
@@ -63,6 +67,21 @@ monitoring::CounterCell* GetTFDataBytesReadCounter(const string& name);
 // The `name` argument identifies the Dataset type (e.g. "Batch" or "Map").
 monitoring::CounterCell* GetTFDataElementsCounter(const string& name);
 
+// Returns a histogram that can be used to record the per-element processing
+// time (in microseconds) of a tf.data.Dataset, averaged over the period between
+// two metric updates.
+//
+// The `name` argument identifies the Dataset type (e.g. "Batch" or "Map").
+monitoring::SamplerCell* GetTFDataProcessingTimeHistogram(const string& name);
+
+// Returns a histogram that can be used to record the ratio of the number of
+// elements buffered by an asynchronous tf.data.Dataset over its buffer size.
+//
+// The `name` argument identifies the Dataset type (e.g. "Prefetch" or
+// "ParallelMapV2").
+monitoring::SamplerCell* GetTFDataBufferUtilizationHistogram(
+    const string& name);
+
 // Returns a gauge than can be used to record the performance model information.
 //
 // The `id` argument represents the (unique) model ID.
@@ -131,6 +150,10 @@ void RecordTFDataServiceCrossTrainerCacheQuery(bool cache_hit);
 // Records tf.data service cross-trainer cache memory usage in bytes.
 void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes);
 
+// Records bytes of tf.data service cross-trainer cache elements spilled to
+// disk (`is_read` is false) or read back from disk (`is_read` is true).
+void RecordTFDataServiceCrossTrainerCacheSpillBytes(bool is_read, size_t bytes);
+
 // Records the file name read by a tf.data Dataset.
 //
 // The `name` argument identifies the Dataset type (e.g. "TFRecordDataset").
@@ -176,9 +199,28 @@ void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica);
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
+// Records the delay between scheduling a closure on an inter-op thread pool
+// and a thread starting to run it.
+void UpdateInterOpScheduleDelay(uint64 delay_usecs);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
+// Returns whether the kernel about to run on this thread should have its
+// execution recorded with RecordOpKernelExecution. The sampling is off by
+// default; when TF_OP_KERNEL_METRICS_SAMPLING_PERIOD is set to N > 0, one in
+// every N kernel executions of a thread is sampled.
+bool ShouldSampleOpKernelExecution();
+
+// Overrides the sampling period read from TF_OP_KERNEL_METRICS_SAMPLING_PERIOD.
+// A period of 0 disables the sampling.
+void SetOpKernelExecutionSamplingPeriod(int64_t period);
+
+// Records the duration of a sampled execution of the kernel of `context`,
+// along with the bytes of its inputs and outputs, under its op type. Must be
+// called before the outputs are released from `context`.
+void RecordOpKernelExecution(OpKernelContext* context, uint64 duration_nsecs);
+
 // Updates the metrics stored about time spent building graphs.
 //
 // By "GraphBuild", we refer to building a client graph, which is a sub-graph of
@@ -337,6 +379,10 @@ void UpdateTpuErrorCounter(const string& op, const string& error_type);
 void UpdateEagerClientErrorCounter(const string& error_source,
                                    const string& error_type);
 
+// Records `count` lookups in the oneDNN cache `cache` ("primitive" or
+// "weight") that hit or missed.
+void UpdateOneDnnCacheLookups(const string& cache, bool hit, int64_t count);
+
 }  // namespace metrics
 }  // namespace tensorflow
 
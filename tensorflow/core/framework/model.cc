@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/statusor.h"
 
 namespace tensorflow {
@@ -1552,6 +1553,20 @@ void Node::FlushMetrics() {
   metrics_.record_bytes_consumed(bytes_consumed_);
   metrics_.record_bytes_produced(bytes_produced_);
   metrics_.record_num_elements(num_elements_);
+  metrics_.record_processing_time(processing_time_, num_elements_);
+  if (IsAsync()) {
+    tf_shared_lock l(mu_);
+    auto it = parameters_.find(kBufferSize);
+    if (it != parameters_.end()) {
+      const double buffer_size = it->second->state
+                                     ? it->second->state->value
+                                     : it->second->value;
+      if (buffer_size > 0) {
+        metrics_.record_buffer_utilization(
+            std::min(1.0, buffered_elements_ / buffer_size));
+      }
+    }
+  }
 }
 
 double Node::OutputTime(Node::NodeValues* input_times,
@@ -2201,6 +2216,9 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64_t cpu_budget,
     case AutotuneAlgorithm::STAGE_BASED:
       OptimizeStageBased(snapshot, optimization_params, cancellation_manager);
       break;
+    case AutotuneAlgorithm::WARM_START:
+      OptimizeWarmStart(snapshot, optimization_params, cancellation_manager);
+      break;
     default:
       VLOG(2) << "Autotuning algorithm was not recognized. Aborting "
                  "optimization.";
@@ -2211,6 +2229,11 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64_t cpu_budget,
   }
 }
 
+void Model::SetWarmStartProfile(const string& fname) {
+  mutex_lock l(mu_);
+  warm_start_profile_ = fname;
+}
+
 void Model::RemoveNode(std::shared_ptr<Node> node) {
   mutex_lock l(mu_);
   if (node) {
@@ -2405,7 +2428,8 @@ void Model::OptimizeGradientDescent(
 void Model::OptimizeHillClimbHelper(
     std::shared_ptr<Node> snapshot,
     const OptimizationParams& optimization_params,
-    CancellationManager* cancellation_manager, StopPredicate should_stop) {
+    CancellationManager* cancellation_manager, StopPredicate should_stop,
+    bool reset_parameters) {
   VLOG(2) << "Starting optimization of tunable parameters with Hill Climb.";
   const double processing_time = TotalProcessingTime(snapshot);
   auto parameters = CollectTunableParameters(snapshot);
@@ -2431,7 +2455,8 @@ void Model::OptimizeHillClimbHelper(
   }
   // Initialize the parameter values to minimal before tuning.
   for (auto& pair : parameters) {
-    if (skip_buffer_sizes && (pair.second->name == kBufferSize)) {
+    if (!reset_parameters ||
+        (skip_buffer_sizes && (pair.second->name == kBufferSize))) {
       continue;
     }
     pair.second->value = pair.second->min;
@@ -2711,6 +2736,141 @@ void Model::OptimizeMaxParallelism(
                           should_stop);
 }
 
+void Model::OptimizeWarmStart(std::shared_ptr<Node> snapshot,
+                              const OptimizationParams& optimization_params,
+                              CancellationManager* cancellation_manager) {
+  std::string fname;
+  {
+    tf_shared_lock l(mu_);
+    fname = warm_start_profile_;
+  }
+  if (!warm_start_profile_loaded_ && !fname.empty()) {
+    warm_start_profile_loaded_ = true;
+    auto profile = std::make_unique<ModelProfile>();
+    Status s = ReadBinaryProto(Env::Default(), fname, profile.get());
+    if (s.ok()) {
+      VLOG(2) << "Loaded autotuning profile with " << profile->nodes_size()
+              << " nodes from " << fname;
+      warm_start_profile_proto_ = std::move(profile);
+    } else if (!errors::IsNotFound(s)) {
+      LOG(WARNING) << "Failed to load autotuning profile from " << fname
+                   << ": " << s;
+    }
+  }
+  if (warm_start_profile_proto_ == nullptr) {
+    OptimizeHillClimb(snapshot, optimization_params, cancellation_manager);
+  } else {
+    auto parameters = CollectTunableParameters(snapshot);
+    const int64_t num_applied =
+        ApplyProfile(snapshot, *warm_start_profile_proto_, &parameters);
+    if (num_applied > 0) {
+      VLOG(2) << "Initialized " << num_applied
+              << " tunable parameters from the autotuning profile.";
+      UpdateStateValues(&parameters);
+    }
+    // Refine the predicted values. The climb starts from the current values
+    // so that the warm start is not discarded by later optimizations.
+    auto should_stop = [&optimization_params](const ModelParameters& parameters,
+                                              double processing_time,
+                                              double output_time,
+                                              double buffered_bytes) {
+      return AreAllParametersMax(parameters) ||
+             output_time < processing_time / optimization_params.cpu_budget() ||
+             buffered_bytes > optimization_params.ram_budget();
+    };
+    OptimizeHillClimbHelper(snapshot, optimization_params, cancellation_manager,
+                            should_stop, /*reset_parameters=*/false);
+  }
+  if (fname.empty()) {
+    return;
+  }
+  ModelProfile profile;
+  RecordProfile(snapshot, &profile);
+  // Write to a temporary file first so that concurrent jobs running the same
+  // pipeline never observe a partially written profile.
+  const std::string tmp_fname =
+      strings::StrCat(fname, ".tmp.", random::New64());
+  Status s = WriteBinaryProto(Env::Default(), tmp_fname, profile);
+  if (s.ok()) {
+    s = Env::Default()->RenameFile(tmp_fname, fname);
+  }
+  if (!s.ok()) {
+    LOG_EVERY_N_SEC(WARNING, 60)
+        << "Failed to save autotuning profile to " << fname << ": " << s;
+  }
+}
+
+int64_t Model::ApplyProfile(std::shared_ptr<Node> snapshot,
+                            const ModelProfile& profile,
+                            ModelParameters* parameters) {
+  absl::flat_hash_map<std::string, const ModelProfile::NodeProfile*>
+      node_profiles;
+  for (const auto& node_profile : profile.nodes()) {
+    node_profiles[node_profile.name()] = &node_profile;
+  }
+  absl::flat_hash_map<std::string, double> processing_times;
+  processing_times[snapshot->long_name()] = snapshot->SelfProcessingTime();
+  for (const auto& node : snapshot->CollectNodes(TraversalOrder::BFS,
+                                                 IsAnyNode)) {
+    processing_times[node->long_name()] = node->SelfProcessingTime();
+  }
+  int64_t num_applied = 0;
+  for (auto& pair : *parameters) {
+    Parameter* parameter = pair.second.get();
+    const std::string key = strings::StrCat(pair.first, "/", parameter->name);
+    if (warm_started_parameters_.contains(key)) {
+      continue;
+    }
+    auto node_profile = node_profiles.find(pair.first);
+    if (node_profile == node_profiles.end()) {
+      continue;
+    }
+    const auto& recorded_parameters = node_profile->second->parameters();
+    auto recorded_value = recorded_parameters.find(parameter->name);
+    if (recorded_value == recorded_parameters.end()) {
+      continue;
+    }
+    double value = recorded_value->second;
+    // Parallelism needed to keep up scales linearly with the per-element
+    // processing time, so adjust the recorded value if the node got faster
+    // or slower since the profile was recorded.
+    const double recorded_time = node_profile->second->processing_time();
+    const double current_time = processing_times[pair.first];
+    if (parameter->name == kParallelism && recorded_time > 0 &&
+        current_time > 0) {
+      value *= current_time / recorded_time;
+    }
+    parameter->value =
+        std::min(parameter->max, std::max(parameter->min, std::round(value)));
+    warm_started_parameters_.insert(key);
+    ++num_applied;
+  }
+  return num_applied;
+}
+
+void Model::RecordProfile(std::shared_ptr<Node> snapshot,
+                          ModelProfile* profile) {
+  absl::flat_hash_map<std::string, ModelProfile::NodeProfile*> node_profiles;
+  auto add_node = [&](const std::shared_ptr<Node>& node) {
+    ModelProfile::NodeProfile* node_profile = profile->add_nodes();
+    node_profile->set_name(node->long_name());
+    node_profile->set_processing_time(node->SelfProcessingTime());
+    node_profiles[node->long_name()] = node_profile;
+  };
+  add_node(snapshot);
+  for (const auto& node : snapshot->CollectNodes(TraversalOrder::BFS,
+                                                 IsAnyNode)) {
+    add_node(node);
+  }
+  for (const auto& pair : CollectTunableParameters(snapshot)) {
+    auto it = node_profiles.find(pair.first);
+    if (it != node_profiles.end()) {
+      (*it->second->mutable_parameters())[pair.second->name] =
+          pair.second->value;
+    }
+  }
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node, double model_input_time,
                          Model::ParameterGradients* gradients) {
   // To store the input time for each node.
@@ -25,6 +25,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.pb.h"
@@ -496,9 +497,15 @@ class Node {
         : bytes_consumed_counter_(metrics::GetTFDataBytesConsumedCounter(name)),
           bytes_produced_counter_(metrics::GetTFDataBytesProducedCounter(name)),
           num_elements_counter_(metrics::GetTFDataElementsCounter(name)),
+          processing_time_histogram_(
+              metrics::GetTFDataProcessingTimeHistogram(name)),
+          buffer_utilization_histogram_(
+              metrics::GetTFDataBufferUtilizationHistogram(name)),
           recorded_bytes_consumed_(0),
           recorded_bytes_produced_(0),
-          recorded_num_elements_(0) {}
+          recorded_num_elements_(0),
+          recorded_processing_time_(0),
+          recorded_processing_time_num_elements_(0) {}
 
     // Expects the total number of bytes consumed and records the delta since
     // last invocation.
@@ -524,13 +531,40 @@ class Node {
       num_elements_counter_->IncrementBy(delta);
     }
 
+    // Expects the total processing time (in nanoseconds) and the total number
+    // of elements produced, and records the average per-element processing
+    // time since the last invocation that observed new elements.
+    void record_processing_time(int64_t total_processing_time,
+                                int64_t total_elements) {
+      const int64_t num_elements =
+          total_elements - recorded_processing_time_num_elements_;
+      if (num_elements <= 0) {
+        return;
+      }
+      recorded_processing_time_num_elements_ = total_elements;
+      const int64_t processing_time =
+          total_processing_time -
+          recorded_processing_time_.exchange(total_processing_time);
+      processing_time_histogram_->Add(static_cast<double>(processing_time) /
+                                      num_elements / EnvTime::kMicrosToNanos);
+    }
+
+    // Records the fraction of the buffer that is currently in use.
+    void record_buffer_utilization(double ratio) {
+      buffer_utilization_histogram_->Add(ratio);
+    }
+
    private:
     monitoring::CounterCell* const bytes_consumed_counter_;
     monitoring::CounterCell* const bytes_produced_counter_;
     monitoring::CounterCell* const num_elements_counter_;
+    monitoring::SamplerCell* const processing_time_histogram_;
+    monitoring::SamplerCell* const buffer_utilization_histogram_;
     std::atomic<int64_t> recorded_bytes_consumed_;
     std::atomic<int64_t> recorded_bytes_produced_;
     std::atomic<int64_t> recorded_num_elements_;
+    std::atomic<int64_t> recorded_processing_time_;
+    std::atomic<int64_t> recorded_processing_time_num_elements_;
   };
 
   // Computes the exponential moving average of processing time per element.
@@ -785,6 +819,12 @@ class Model {
   // Set the experiment that this job is part of.
   void SetExperiment(const string& experiment) { experiment_ = experiment; }
 
+  // Sets the file in which the `WARM_START` algorithm persists the tunable
+  // parameter values and per-node processing times of this model. If the file
+  // exists when the first optimization runs, its contents are used to
+  // initialize the tunable parameters instead of their minimum values.
+  void SetWarmStartProfile(const string& fname) TF_LOCKS_EXCLUDED(mu_);
+
   // Adds a node with the given name and given parent.
   void AddNode(Node::Factory factory, const string& name,
                std::shared_ptr<Node> parent, std::shared_ptr<Node>* out_node)
@@ -895,11 +935,14 @@ class Model {
                                CancellationManager* cancellation_manager);
 
   // Helper method for implementing hill-climb optimization that can be
-  // parametrized by a predicate to use for stopping the optimization.
+  // parametrized by a predicate to use for stopping the optimization. If
+  // `reset_parameters` is false, the climb starts from the current parameter
+  // values instead of their minimum values.
   void OptimizeHillClimbHelper(std::shared_ptr<Node> snapshot,
                                const OptimizationParams& optimization_params,
                                CancellationManager* cancellation_manager,
-                               StopPredicate should_stop);
+                               StopPredicate should_stop,
+                               bool reset_parameters = true);
 
   // This optimization algorithm starts by setting all tunable parallelism
   // parameters to the minimum value. It then repeatedly identifies the
@@ -928,6 +971,27 @@ class Model {
                           const OptimizationParams& optimization_params,
                           CancellationManager* cancellation_manager);
 
+  // This optimization initializes the tunable parameters from the profile
+  // recorded by a previous run of the same pipeline (see
+  // `SetWarmStartProfile`). Parallelism values are scaled by the ratio of the
+  // currently observed and the recorded processing time of their node. The
+  // parameters are then refined with hill climbing starting from the
+  // initialized values, and the result is recorded for future runs. Without a
+  // profile, this behaves like `OptimizeHillClimb`.
+  void OptimizeWarmStart(std::shared_ptr<Node> snapshot,
+                         const OptimizationParams& optimization_params,
+                         CancellationManager* cancellation_manager);
+
+  // Initializes `parameters` from the given profile. Returns the number of
+  // parameters that were initialized.
+  int64_t ApplyProfile(std::shared_ptr<Node> snapshot,
+                       const ModelProfile& profile,
+                       ModelParameters* parameters);
+
+  // Records the tunable parameter values and processing times of the nodes
+  // rooted at `snapshot` into `profile`.
+  void RecordProfile(std::shared_ptr<Node> snapshot, ModelProfile* profile);
+
   // This is the first part of the stage-based optimization that optimizes
   // tunable parallelism parameters.
   void OptimizeStageBasedParallelism(
@@ -996,6 +1060,19 @@ class Model {
   std::deque<uint64_t> gap_times_usec_ TF_GUARDED_BY(gap_mu_);
   // The experiment that this job is part of.
   std::string experiment_ = "";
+  // File used by the `WARM_START` algorithm to persist the model profile.
+  std::string warm_start_profile_ TF_GUARDED_BY(mu_);
+  // The following members are only accessed by the optimization thread.
+  //
+  // Whether an attempt to load the persisted profile has been made.
+  bool warm_start_profile_loaded_ = false;
+  // The profile recorded by a previous run, if any.
+  std::unique_ptr<ModelProfile> warm_start_profile_proto_;
+  // Tunable parameters that have already been initialized from the profile,
+  // identified by node long name and parameter name. Nodes are added to the
+  // model as iterators get created, so a parameter is initialized by the first
+  // optimization that observes it.
+  absl::flat_hash_set<std::string> warm_started_parameters_;
 };
 
 // Class to compute timing information for a model.
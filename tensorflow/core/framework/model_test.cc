@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/lib/monitoring/test_utils.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -34,6 +35,7 @@ namespace model {
 namespace {
 
 using ::tensorflow::monitoring::testing::CellReader;
+using ::tensorflow::monitoring::testing::Histogram;
 using ::testing::AllOf;
 using ::testing::HasSubstr;
 
@@ -1319,7 +1321,101 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 }
 
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
-                         ::testing::Values(0, 1, 2, 3));
+                         ::testing::Values(0, 1, 2, 3, 5));
+
+// Builds a two node model with tunable parallelism. The nodes buffer one byte
+// each, so that a zero RAM budget stops hill climbing right away and the
+// parameter values reflect the warm start.
+void BuildWarmStartModel(model::Model* model, std::shared_ptr<Node>* node1,
+                         std::shared_ptr<Node>* node2) {
+  *node1 = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 2,
+      {model::MakeParameter(
+          kParallelism,
+          std::make_shared<SharedState>(
+              /*value=*/model::kAutotune, std::make_shared<mutex>(),
+              std::make_shared<condition_variable>()),
+          /*min=*/1, /*max=*/5)});
+  (*node1)->record_buffer_event(1, 1);
+  (*node1)->add_processing_time(200);
+  (*node1)->record_element();
+  *node2 = model::MakeAsyncKnownRatioNode(
+      {2, "2", *node1}, 5,
+      {model::MakeParameter(
+          kParallelism,
+          std::make_shared<SharedState>(
+              /*value=*/model::kAutotune, std::make_shared<mutex>(),
+              std::make_shared<condition_variable>()),
+          /*min=*/1, /*max=*/7)});
+  (*node2)->record_buffer_event(1, 1);
+  (*node2)->record_element();
+  model->AddNode([node1](model::Node::Args args) { return *node1; }, "1",
+                 nullptr, node1);
+  model->AddNode([node2](model::Node::Args args) { return *node2; }, "2",
+                 *node1, node2);
+}
+
+TEST(OptimizeWarmStartTest, InitializesParametersFromProfile) {
+  const string fname =
+      io::JoinPath(testing::TmpDir(), "warm_start_initializes.model_profile");
+  ModelProfile recorded;
+  auto* recorded_node1 = recorded.add_nodes();
+  recorded_node1->set_name("1(id:1)");
+  // The node is twice as slow as when the profile was recorded, so twice the
+  // recorded parallelism is needed.
+  recorded_node1->set_processing_time(100);
+  (*recorded_node1->mutable_parameters())[kParallelism] = 2;
+  auto* recorded_node2 = recorded.add_nodes();
+  recorded_node2->set_name("2(id:2)");
+  (*recorded_node2->mutable_parameters())[kParallelism] = 100;
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), fname, recorded));
+
+  model::Model model;
+  std::shared_ptr<Node> node1, node2;
+  BuildWarmStartModel(&model, &node1, &node2);
+  model.SetWarmStartProfile(fname);
+
+  CancellationManager cancellation_manager;
+  model.Optimize(AutotuneAlgorithm::WARM_START, /*cpu_budget=*/40,
+                 /*ram_budget=*/0, /*model_input_time=*/0,
+                 &cancellation_manager);
+  EXPECT_EQ(node1->parameter_value(kParallelism), 4);
+  // The recorded value is capped by the parameter maximum.
+  EXPECT_EQ(node2->parameter_value(kParallelism), 7);
+
+  // Later optimizations keep the warm-started values.
+  model.Optimize(AutotuneAlgorithm::WARM_START, /*cpu_budget=*/40,
+                 /*ram_budget=*/0, /*model_input_time=*/0,
+                 &cancellation_manager);
+  EXPECT_EQ(node1->parameter_value(kParallelism), 4);
+  EXPECT_EQ(node2->parameter_value(kParallelism), 7);
+}
+
+TEST(OptimizeWarmStartTest, RecordsProfile) {
+  const string fname =
+      io::JoinPath(testing::TmpDir(), "warm_start_records.model_profile");
+  model::Model model;
+  std::shared_ptr<Node> node1, node2;
+  BuildWarmStartModel(&model, &node1, &node2);
+  model.SetWarmStartProfile(fname);
+
+  // Without a profile, the parameters start from their minimum values.
+  CancellationManager cancellation_manager;
+  model.Optimize(AutotuneAlgorithm::WARM_START, /*cpu_budget=*/40,
+                 /*ram_budget=*/0, /*model_input_time=*/0,
+                 &cancellation_manager);
+  EXPECT_EQ(node1->parameter_value(kParallelism), 1);
+  EXPECT_EQ(node2->parameter_value(kParallelism), 1);
+
+  ModelProfile profile;
+  TF_ASSERT_OK(ReadBinaryProto(Env::Default(), fname, &profile));
+  ASSERT_EQ(profile.nodes_size(), 2);
+  EXPECT_EQ(profile.nodes(0).name(), "1(id:1)");
+  EXPECT_DOUBLE_EQ(profile.nodes(0).processing_time(), 200);
+  EXPECT_EQ(profile.nodes(0).parameters().at(kParallelism), 1);
+  EXPECT_EQ(profile.nodes(1).name(), "2(id:2)");
+  EXPECT_EQ(profile.nodes(1).parameters().at(kParallelism), 1);
+}
 
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
@@ -1342,6 +1438,36 @@ TEST(ModelTest, ModelMetrics) {
                     HasSubstr("autotune: true")));
 }
 
+TEST(ModelTest, StageMetrics) {
+  CellReader<Histogram> processing_time("/tensorflow/data/processing_time");
+  CellReader<Histogram> buffer_utilization(
+      "/tensorflow/data/buffer_utilization");
+  std::shared_ptr<Node> node = model::MakeAsyncKnownRatioNode(
+      {0, "stage_metrics", nullptr}, /*ratio=*/1,
+      {model::MakeParameter(kBufferSize,
+                            std::make_shared<SharedState>(/*value=*/4, nullptr,
+                                                          nullptr),
+                            /*min=*/1, /*max=*/8)});
+  node->add_processing_time(4000);
+  node->record_element();
+  node->record_element();
+  node->record_buffer_event(/*bytes_delta=*/100, /*elements_delta=*/2);
+  node->FlushMetrics();
+
+  // 4000 nanoseconds over 2 elements is 2 microseconds per element.
+  Histogram processing_time_histogram = processing_time.Delta("stage_metrics");
+  EXPECT_FLOAT_EQ(processing_time_histogram.num(), 1.0);
+  EXPECT_FLOAT_EQ(processing_time_histogram.sum(), 2.0);
+  Histogram buffer_utilization_histogram =
+      buffer_utilization.Delta("stage_metrics");
+  EXPECT_FLOAT_EQ(buffer_utilization_histogram.num(), 1.0);
+  EXPECT_FLOAT_EQ(buffer_utilization_histogram.sum(), 0.5);
+
+  // No processing time is recorded if no new elements have been produced.
+  node->FlushMetrics();
+  EXPECT_FLOAT_EQ(processing_time.Delta("stage_metrics").num(), 0.0);
+}
+
 TEST(ModelTest, ModelCollectAndDestroyRaceCondition) {
   CellReader<std::string> cell_reader("/tensorflow/data/model");
   auto* model = new model::Model();
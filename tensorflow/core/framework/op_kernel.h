@@ -588,6 +588,13 @@ class OpKernelContext {
     // The device on which the kernel is running.
     DeviceBase* device = nullptr;
 
+    // If set, the allocator for the outputs and temporary tensors that the
+    // kernel allocates through `get_allocator()` with attributes that do not
+    // require a GPU- or NIC-compatible allocator. It is valid for the
+    // duration of the step and is typically an arena for intermediate tensors
+    // (see `Device::GetStepArenaAllocator()`). Not owned.
+    Allocator* step_allocator = nullptr;
+
     // The Eigen GPU device wrapper, which may include a per-op
     // wrapped allocator. The concrete type of this object depends on
     // the type of this->device, so eigen_gpu_device can't be an
@@ -1034,6 +1034,80 @@ Tensor Tensor::SubSlice(int64_t index) const {
   return ret;
 }
 
+namespace {
+
+// Returns the bytes of the content of a TensorProto, or an empty piece if
+// they are not contiguous.
+StringPiece ContiguousContent(const std::string& content) { return content; }
+#if defined(TENSORFLOW_PROTOBUF_USES_CORD)
+StringPiece ContiguousContent(const absl::Cord& content) {
+  return content.TryFlat().value_or(StringPiece());
+}
+#endif  // defined(TENSORFLOW_PROTOBUF_USES_CORD)
+
+// A buffer backed by the content taken over from a TensorProto.
+template <typename Content>
+class ProtoContentBuffer : public TensorBuffer {
+ public:
+  // `data` are the contiguous bytes of `*content`.
+  ProtoContentBuffer(std::unique_ptr<Content> content, StringPiece data)
+      : TensorBuffer(const_cast<char*>(data.data())),
+        content_(std::move(content)),
+        size_(data.size()) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("ProtoContentBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+ private:
+  const std::unique_ptr<Content> content_;
+  const size_t size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ProtoContentBuffer);
+};
+
+// Smaller contents are cheap to copy, and may be stored inline in the proto.
+constexpr size_t kMinTakenContentBytes = 1 << 10;
+
+// Returns a buffer for the `n` elements of `proto` that takes over its
+// content, or nullptr if that content can't back a tensor in memory of `a`.
+// Leaves `proto` unchanged in the latter case.
+TensorBuffer* TakeTensorContent(Allocator* a, int64_t n, TensorProto* proto) {
+  const DataType dtype = proto->dtype();
+  // Booleans are validated while they are copied.
+  if (!DataTypeCanUseMemcpy(dtype) || dtype == DT_BOOL ||
+      a->GetMemoryType() != AllocatorMemoryType::kHostPageable) {
+    return nullptr;
+  }
+  const size_t num_bytes = proto->tensor_content().size();
+  if (num_bytes < kMinTakenContentBytes ||
+      num_bytes != n * DataTypeSize(dtype)) {
+    return nullptr;
+  }
+  using Content = std::decay_t<decltype(proto->tensor_content())>;
+  auto content =
+      std::make_unique<Content>(std::move(*proto->mutable_tensor_content()));
+  const StringPiece data = ContiguousContent(*content);
+  if (data.size() != num_bytes
+#if EIGEN_MAX_ALIGN_BYTES > 0
+      || reinterpret_cast<intptr_t>(data.data()) % EIGEN_MAX_ALIGN_BYTES != 0
+#endif
+  ) {
+    *proto->mutable_tensor_content() = std::move(*content);
+    return nullptr;
+  }
+  return new ProtoContentBuffer<Content>(std::move(content), data);
+}
+
+}  // namespace
+
 bool Tensor::FromProto(const TensorProto& proto) {
   return FromProto(get_default_cpu_allocator(), proto);
 }
@@ -1079,6 +1153,31 @@ bool Tensor::FromProto(Allocator* a, const TensorProto& proto) {
   return true;
 }
 
+bool Tensor::FromProto(TensorProto&& proto) {
+  return FromProto(get_default_cpu_allocator(), std::move(proto));
+}
+
+bool Tensor::FromProto(Allocator* a, TensorProto&& proto) {
+  CHECK_NOTNULL(a);
+  if (!TensorShape::IsValid(proto.tensor_shape())) return false;
+  TensorShape shape(proto.tensor_shape());
+  const int64_t N = shape.num_elements();
+  TensorBuffer* p = N > 0 ? TakeTensorContent(a, N, &proto) : nullptr;
+  if (p == nullptr) {
+    const TensorProto& unowned_proto = proto;
+    return FromProto(a, unowned_proto);
+  }
+  shape_ = shape;
+  set_dtype(proto.dtype());
+  UnrefIfNonNull(buf_);
+  buf_ = p;
+  if (MemoryLoggingEnabled()) {
+    LogMemory::RecordTensorAllocation("Unknown (from Proto)",
+                                      LogMemory::UNKNOWN_STEP_ID, *this);
+  }
+  return true;
+}
+
 void Tensor::AsProtoField(TensorProto* proto) const {
   proto->Clear();
   shape_.AsProto(proto->mutable_tensor_shape());
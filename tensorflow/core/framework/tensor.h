@@ -386,6 +386,14 @@ class Tensor {
   bool FromProto(const TensorProto& other) TF_MUST_USE_RESULT;
   bool FromProto(Allocator* a, const TensorProto& other) TF_MUST_USE_RESULT;
 
+  /// \brief Like the above, but `*this` may take over the large
+  /// `other.tensor_content()` of a simple type instead of copying it, when it
+  /// is contiguous and aligned and `a` allocates pageable host memory.
+  ///
+  /// On success, `other` is left in a valid but unspecified state.
+  bool FromProto(TensorProto&& other) TF_MUST_USE_RESULT;
+  bool FromProto(Allocator* a, TensorProto&& other) TF_MUST_USE_RESULT;
+
   /// \brief Fills in `proto` with `*this` tensor's content.
   ///
   /// `AsProtoField()` fills in the repeated field for `proto.dtype()`, while
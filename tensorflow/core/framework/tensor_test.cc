@@ -177,6 +177,13 @@ void TestCopies(const Tensor& t) {
     EXPECT_TRUE(t3.FromProto(proto));
     ExpectEqual<T>(t, t2);
   }
+  {
+    TensorProto proto;
+    t.AsProtoTensorContent(&proto);
+    Tensor t2(t.dtype());
+    EXPECT_TRUE(t2.FromProto(std::move(proto)));
+    ExpectEqual<T>(t, t2);
+  }
   {
     LOG(INFO) << "AsTensor";
     gtl::ArraySlice<T> values(t.flat<T>().data(), t.NumElements());
@@ -1232,6 +1239,34 @@ TEST(Tensor_Bool, SimpleWithHelper) {
   ExpectEqual<bool>(t1, t2);
 }
 
+TEST(Tensor_Float, FromProtoTakesLargeContent) {
+  Tensor t(DT_FLOAT, TensorShape({64, 64}));
+  test::FillIota<float>(&t, 0.0f);
+  TensorProto proto;
+  t.AsProtoTensorContent(&proto);
+  const char* content = proto.tensor_content().data();
+#if EIGEN_MAX_ALIGN_BYTES > 0
+  const bool aligned =
+      reinterpret_cast<intptr_t>(content) % EIGEN_MAX_ALIGN_BYTES == 0;
+#else
+  const bool aligned = true;
+#endif
+
+  Tensor t2;
+  EXPECT_TRUE(t2.FromProto(std::move(proto)));
+  test::ExpectTensorEqual<float>(t, t2);
+  EXPECT_TRUE(t2.IsAligned());
+  // The content is only shared when its alignment allows.
+  EXPECT_EQ(aligned, t2.tensor_data().data() == content);
+
+  // Small contents are always copied.
+  Tensor small = test::AsTensor<float>({1, 2, 3, 4});
+  small.AsProtoTensorContent(&proto);
+  Tensor t3;
+  EXPECT_TRUE(t3.FromProto(std::move(proto)));
+  test::ExpectTensorEqual<float>(small, t3);
+}
+
 TEST(Tensor_Bool, DecodeValidate) {
   TensorProto proto;
   proto.set_dtype(DT_BOOL);
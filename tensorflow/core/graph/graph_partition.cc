@@ -16,13 +16,17 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_partition.h"
 
 #include <deque>
+#include <map>
 #include <queue>
+#include <string>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/memory_types.h"
 #include "tensorflow/core/framework/node_def_builder.h"
@@ -978,6 +982,255 @@ void SetIncarnation(const PartitionOptions& opts, GraphDef* gdef) {
   }
 }
 
+namespace {
+
+// Returns true if sends fed by `ndef` or any of its descendants must not be
+// grouped: their inputs might be dead, belong to a non-root frame, or wait on
+// another partition.
+bool BlocksSendGrouping(const NodeDef& ndef) {
+  const string& op = ndef.op();
+  if (op == "Switch" || op == "RefSwitch" || op == "_SwitchN" ||
+      IsMerge(ndef) || op == "Enter" || op == "RefEnter" || op == "Exit" ||
+      op == "RefExit" || IsNextIteration(ndef) || op == "LoopCond" ||
+      op == "ControlTrigger") {
+    return true;
+  }
+  const OpDef* op_def = nullptr;
+  if (!OpRegistry::Global()->LookUpOpDef(op, &op_def).ok() ||
+      op_def->is_distributed_communication()) {
+    // Function calls and ops such as _Recv and collectives.
+    return true;
+  }
+  for (const auto& attr : ndef.attr()) {
+    if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the names of the nodes of `gdef` for which BlocksSendGrouping() is
+// true for the node itself or any of its ancestors.
+absl::flat_hash_set<string> FindNodesBlockingSendGrouping(
+    const GraphDef& gdef) {
+  absl::flat_hash_map<string, std::vector<const NodeDef*>> consumers;
+  std::vector<const NodeDef*> ready;
+  for (const NodeDef& ndef : gdef.node()) {
+    for (const string& input : ndef.input()) {
+      consumers[ParseTensorName(input).node()].push_back(&ndef);
+    }
+    if (BlocksSendGrouping(ndef)) {
+      ready.push_back(&ndef);
+    }
+  }
+  absl::flat_hash_set<string> blocked;
+  while (!ready.empty()) {
+    const NodeDef* ndef = ready.back();
+    ready.pop_back();
+    if (!blocked.insert(ndef->name()).second) continue;
+    auto it = consumers.find(ndef->name());
+    if (it == consumers.end()) continue;
+    for (const NodeDef* consumer : it->second) {
+      if (!blocked.contains(consumer->name())) {
+        ready.push_back(consumer);
+      }
+    }
+  }
+  return blocked;
+}
+
+bool IsGroupableTransfer(const NodeDef& ndef, StringPiece op) {
+  bool client_terminated = false;
+  if (ndef.op() != op ||
+      (TryGetNodeAttr(ndef, "client_terminated", &client_terminated) &&
+       client_terminated)) {
+    return false;
+  }
+  DataType dtype;
+  if (!TryGetNodeAttr(ndef, op == "_Send" ? "T" : "tensor_type", &dtype)) {
+    return false;
+  }
+  return !IsRefType(dtype) && DataTypeCanUseMemcpy(dtype);
+}
+
+// Rewrites the inputs of the nodes of `gdef`: data inputs from output 0 of a
+// node in `data_renames` and control inputs from a node in `control_renames`
+// are replaced by the mapped inputs.
+void RenameInputs(
+    const absl::flat_hash_map<string, string>& data_renames,
+    const absl::flat_hash_map<string, string>& control_renames,
+    GraphDef* gdef) {
+  for (NodeDef& ndef : *gdef->mutable_node()) {
+    absl::flat_hash_set<string> control_inputs;
+    int num_inputs = 0;
+    for (int i = 0; i < ndef.input_size(); ++i) {
+      string input = ndef.input(i);
+      const TensorId id = ParseTensorName(input);
+      if (id.index() == Graph::kControlSlot) {
+        auto it = control_renames.find(id.node());
+        if (it != control_renames.end()) {
+          input = strings::StrCat("^", it->second);
+        }
+        if (!control_inputs.insert(input).second) continue;
+      } else if (id.index() == 0) {
+        auto it = data_renames.find(id.node());
+        if (it != data_renames.end()) {
+          input = it->second;
+        }
+      }
+      *ndef.mutable_input(num_inputs++) = std::move(input);
+    }
+    ndef.mutable_input()->DeleteSubrange(num_inputs,
+                                         ndef.input_size() - num_inputs);
+  }
+}
+
+// Removes the nodes of `gdef` with the given indices.
+void RemoveNodes(const absl::flat_hash_set<int>& indices, GraphDef* gdef) {
+  int num_nodes = 0;
+  for (int i = 0; i < gdef->node_size(); ++i) {
+    if (indices.contains(i)) continue;
+    if (num_nodes != i) {
+      gdef->mutable_node()->SwapElements(num_nodes, i);
+    }
+    ++num_nodes;
+  }
+  gdef->mutable_node()->DeleteSubrange(num_nodes,
+                                       gdef->node_size() - num_nodes);
+}
+
+// See `PartitionOptions::group_send_recv`.
+void GroupSendRecv(const PartitionOptions& opts,
+                   std::unordered_map<string, GraphDef>* partitions) {
+  // Index the groupable recvs by tensor name, skipping ambiguous names.
+  struct RecvLocation {
+    const string* partition;
+    int index;
+  };
+  absl::flat_hash_map<string, RecvLocation> recvs;
+  absl::flat_hash_set<string> ambiguous_tensor_names;
+  for (const auto& it : *partitions) {
+    for (int i = 0; i < it.second.node_size(); ++i) {
+      const NodeDef& ndef = it.second.node(i);
+      if (ndef.op() != "_Recv") continue;
+      const string& tensor_name = GetNodeAttrString(ndef, "tensor_name");
+      if (!IsGroupableTransfer(ndef, "_Recv") || ndef.input_size() > 0 ||
+          !recvs.emplace(tensor_name, RecvLocation{&it.first, i}).second) {
+        ambiguous_tensor_names.insert(tensor_name);
+      }
+    }
+  }
+  for (const string& tensor_name : ambiguous_tensor_names) {
+    recvs.erase(tensor_name);
+  }
+
+  struct Member {
+    int send_index;
+    int recv_index;
+  };
+  // Keyed by (send partition, recv partition, send device, recv device).
+  std::map<std::tuple<string, string, string, string>, std::vector<Member>>
+      groups;
+  for (const auto& it : *partitions) {
+    const GraphDef& gdef = it.second;
+    absl::flat_hash_set<string> blocked;
+    bool blocked_computed = false;
+    for (int i = 0; i < gdef.node_size(); ++i) {
+      const NodeDef& send = gdef.node(i);
+      if (!IsGroupableTransfer(send, "_Send") || send.input_size() != 1 ||
+          ParseTensorName(send.input(0)).index() == Graph::kControlSlot) {
+        continue;
+      }
+      auto recv_it = recvs.find(GetNodeAttrString(send, "tensor_name"));
+      if (recv_it == recvs.end() || *recv_it->second.partition == it.first) {
+        continue;
+      }
+      const string& send_device = GetNodeAttrString(send, "send_device");
+      const string& recv_device = GetNodeAttrString(send, "recv_device");
+      if (!DeviceNameUtils::IsSameAddressSpace(send_device, recv_device)) {
+        continue;
+      }
+      if (!blocked_computed) {
+        blocked = FindNodesBlockingSendGrouping(gdef);
+        blocked_computed = true;
+      }
+      if (blocked.contains(ParseTensorName(send.input(0)).node())) continue;
+      groups[{it.first, *recv_it->second.partition, send_device, recv_device}]
+          .push_back({i, recv_it->second.index});
+    }
+  }
+
+  absl::flat_hash_map<string, absl::flat_hash_set<int>> removed_nodes;
+  absl::flat_hash_map<string, absl::flat_hash_map<string, string>>
+      data_renames, control_renames;
+  for (const auto& group : groups) {
+    const std::vector<Member>& members = group.second;
+    if (members.size() < 2) continue;
+    const string& send_partition = std::get<0>(group.first);
+    const string& recv_partition = std::get<1>(group.first);
+    GraphDef* send_gdef = &(*partitions)[send_partition];
+    GraphDef* recv_gdef = &(*partitions)[recv_partition];
+    const NodeDef& first_send = send_gdef->node(members[0].send_index);
+    const NodeDef& first_recv = recv_gdef->node(members[0].recv_index);
+    const string tensor_name = strings::StrCat(
+        GetNodeAttrString(first_send, "tensor_name"), "/group");
+
+    NodeDef pack;
+    pack.set_name(opts.new_name("grouped_send"));
+    pack.set_op("_PackTensorGroup");
+    pack.set_device(first_send.device());
+    NodeDef send = first_send;
+    send.set_name(opts.new_name("grouped_send"));
+    send.clear_input();
+    AddInput(&send, pack.name(), 0);
+    SetAttrValue(DT_VARIANT, &(*send.mutable_attr())["T"]);
+    SetAttrValue(tensor_name, &(*send.mutable_attr())["tensor_name"]);
+    NodeDef recv = first_recv;
+    recv.set_name(opts.new_name("grouped_recv"));
+    SetAttrValue(DT_VARIANT, &(*recv.mutable_attr())["tensor_type"]);
+    SetAttrValue(tensor_name, &(*recv.mutable_attr())["tensor_name"]);
+    NodeDef unpack;
+    unpack.set_name(opts.new_name("grouped_recv"));
+    unpack.set_op("_UnpackTensorGroup");
+    unpack.set_device(first_recv.device());
+    AddInput(&unpack, recv.name(), 0);
+
+    std::vector<DataType> dtypes;
+    for (int i = 0; i < members.size(); ++i) {
+      const NodeDef& member_send = send_gdef->node(members[i].send_index);
+      const NodeDef& member_recv = recv_gdef->node(members[i].recv_index);
+      pack.add_input(member_send.input(0));
+      DataType dtype;
+      TF_CHECK_OK(GetNodeAttr(member_send, "T", &dtype));
+      dtypes.push_back(dtype);
+      removed_nodes[send_partition].insert(members[i].send_index);
+      removed_nodes[recv_partition].insert(members[i].recv_index);
+      control_renames[send_partition][member_send.name()] = send.name();
+      control_renames[recv_partition][member_recv.name()] = unpack.name();
+      data_renames[recv_partition][member_recv.name()] =
+          strings::StrCat(unpack.name(), ":", i);
+    }
+    AddNodeAttr("T", dtypes, &pack);
+    AddNodeAttr("T", dtypes, &unpack);
+    VLOG(1) << "Grouped " << members.size() << " sends from "
+            << std::get<2>(group.first) << " to " << std::get<3>(group.first)
+            << " into " << send.name();
+
+    *send_gdef->add_node() = std::move(pack);
+    *send_gdef->add_node() = std::move(send);
+    *recv_gdef->add_node() = std::move(recv);
+    *recv_gdef->add_node() = std::move(unpack);
+  }
+
+  for (const auto& it : removed_nodes) {
+    GraphDef* gdef = &(*partitions)[it.first];
+    RemoveNodes(it.second, gdef);
+    RenameInputs(data_renames[it.first], control_renames[it.first], gdef);
+  }
+}
+
+}  // namespace
+
 Status Partition(const PartitionOptions& opts, Graph* g,
                  std::unordered_map<string, GraphDef>* partitions) {
   Status status;
@@ -1238,6 +1491,10 @@ Status Partition(const PartitionOptions& opts, Graph* g,
     SetIncarnation(opts, gdef);
   }
 
+  if (opts.group_send_recv && !opts.scheduling_for_recvs) {
+    GroupSendRecv(opts, partitions);
+  }
+
   // Set the start times for recvs at the very end.
   if (opts.scheduling_for_recvs) {
     for (auto& it : dup_recv) {
@@ -80,6 +80,15 @@ struct PartitionOptions {
   // Optional customized function to compute the "tensor_name" attr value of
   // Send/Recv ops inserted during partitioning.
   std::function<string(const Edge*)> get_tensor_name_attr = nullptr;
+
+  // If true, the data sends from one partition to a device in the same
+  // address space are coalesced into a single _Send/_Recv pair of a packed
+  // tensor group when it is safe to do so, so that they cross the
+  // rendezvous as one item. Only sends whose inputs are produced in the root
+  // frame, are never dead, and do not depend on receiving any tensor are
+  // grouped, so that waiting for the whole group cannot introduce deadlocks.
+  // Ignored if `scheduling_for_recvs` is true.
+  bool group_send_recv = false;
 };
 
 // Partition "input" graph into a set of graphs, one per location.
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/const_op.h"
@@ -75,7 +76,8 @@ string DeviceName(const Node* node) {
 }
 
 void Partition(const GraphDef& graph_def,
-               std::unordered_map<string, GraphDef>* partitions) {
+               std::unordered_map<string, GraphDef>* partitions,
+               bool group_send_recv = false) {
   Graph g(OpRegistry::Global());
   GraphConstructorOptions opts;
   TF_CHECK_OK(ConvertGraphDefToGraph(opts, graph_def, &g));
@@ -95,6 +97,7 @@ void Partition(const GraphDef& graph_def,
   popts.get_incarnation = [](const string& name) {
     return (name[0] - 'A') + 100;
   };
+  popts.group_send_recv = group_send_recv;
   Status s = Partition(popts, &g, partitions);
   CHECK(s.ok()) << s;
 
@@ -372,6 +375,68 @@ TEST_F(GraphPartitionTest, CrossDevice_DataControl) {
   ExpectMatchB();
 }
 
+// Returns the nodes of `gdef` with the given op.
+std::vector<const NodeDef*> NodesWithOp(const GraphDef& gdef,
+                                        const string& op) {
+  std::vector<const NodeDef*> nodes;
+  for (const NodeDef& ndef : gdef.node()) {
+    if (ndef.op() == op) nodes.push_back(&ndef);
+  }
+  return nodes;
+}
+
+TEST_F(GraphPartitionTest, GroupSendRecv) {
+  auto a1 = FloatInput(in_.WithOpName("A1"));
+  auto a2 = FloatInput(in_.WithOpName("A2"));
+  Combine(in_.WithOpName("B1"), a1, a2);
+
+  Partition(ToGraphDef(), &partitions_, /*group_send_recv=*/true);
+  EXPECT_EQ(2, partitions_.size());
+
+  const GraphDef& a = partitions_["/job:a/replica:0/task:0/cpu:0"];
+  std::vector<const NodeDef*> sends = NodesWithOp(a, "_Send");
+  std::vector<const NodeDef*> packs = NodesWithOp(a, "_PackTensorGroup");
+  ASSERT_EQ(sends.size(), 1);
+  ASSERT_EQ(packs.size(), 1);
+  EXPECT_THAT(packs[0]->input(), ::testing::UnorderedElementsAre("A1", "A2"));
+  EXPECT_EQ(sends[0]->input(0), packs[0]->name());
+  EXPECT_EQ(GetNodeAttrString(*sends[0], "send_device"),
+            "/job:a/replica:0/task:0/cpu:0");
+
+  const GraphDef& b = partitions_["/job:a/replica:0/task:0/cpu:1"];
+  std::vector<const NodeDef*> recvs = NodesWithOp(b, "_Recv");
+  std::vector<const NodeDef*> unpacks = NodesWithOp(b, "_UnpackTensorGroup");
+  ASSERT_EQ(recvs.size(), 1);
+  ASSERT_EQ(unpacks.size(), 1);
+  EXPECT_EQ(GetNodeAttrString(*recvs[0], "tensor_name"),
+            GetNodeAttrString(*sends[0], "tensor_name"));
+  EXPECT_EQ(unpacks[0]->input(0), recvs[0]->name());
+  std::vector<const NodeDef*> combines = NodesWithOp(b, "Combine");
+  ASSERT_EQ(combines.size(), 1);
+  EXPECT_THAT(combines[0]->input(),
+              ::testing::UnorderedElementsAre(
+                  strings::StrCat(unpacks[0]->name(), ":0"),
+                  strings::StrCat(unpacks[0]->name(), ":1")));
+}
+
+TEST_F(GraphPartitionTest, GroupSendRecvSkipsSendsAfterRecvs) {
+  auto b1 = FloatInput(in_.WithOpName("B1"));
+  auto a1 = FloatInput(in_.WithOpName("A1"));
+  // A2 waits on B1, so grouping its send with A1's could deadlock.
+  auto a2 = Combine(in_.WithOpName("A2"), a1, b1);
+  Combine(in_.WithOpName("B2"), a1, a2);
+
+  Partition(ToGraphDef(), &partitions_, /*group_send_recv=*/true);
+  EXPECT_EQ(2, partitions_.size());
+  for (const auto& it : partitions_) {
+    EXPECT_TRUE(NodesWithOp(it.second, "_PackTensorGroup").empty());
+    EXPECT_TRUE(NodesWithOp(it.second, "_UnpackTensorGroup").empty());
+  }
+  EXPECT_EQ(NodesWithOp(partitions_["/job:a/replica:0/task:0/cpu:0"], "_Send")
+                .size(),
+            2);
+}
+
 TEST_F(GraphPartitionTest, CrossDeviceLoopSimple) {
   auto a1 = BoolInput(in_.WithOpName("A1"));
   auto a2 = ::tensorflow::ops::internal::Enter(in_.WithOpName("A2"), a1, "foo");
@@ -44,7 +44,14 @@ VirtualCluster::VirtualCluster(
 }
 
 VirtualCluster::VirtualCluster(const DeviceSet* device_set)
-    : VirtualCluster(std::unordered_map<string, DeviceProperties>()) {
+    : VirtualCluster(device_set, std::make_unique<OpLevelCostEstimator>()) {}
+
+VirtualCluster::VirtualCluster(
+    const DeviceSet* device_set,
+    std::unique_ptr<OpLevelCostEstimator> node_estimator)
+    : VirtualCluster(std::unordered_map<string, DeviceProperties>(),
+                     std::move(node_estimator),
+                     ReadyNodeManagerFactory("FirstReady")) {
   device_set_ = device_set;
   for (const auto& device : device_set_->devices()) {
     DeviceProperties props = GetDeviceInfo(device->parsed_name());
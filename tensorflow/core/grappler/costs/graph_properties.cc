@@ -37,7 +37,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -2515,10 +2517,76 @@ Status GraphProperties::UpdateEnqueue(
   return OkStatus();
 }
 
+namespace {
+
+// The results of the most recent InferStatically() call on this thread while
+// a ScopedGraphPropertiesCache is alive.
+struct GraphPropertiesCache {
+  bool valid = false;
+  uint64 key = 0;
+  absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
+      input_properties;
+  absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
+      output_properties;
+  std::unordered_set<string> incompatible_shape_nodes;
+};
+
+thread_local GraphPropertiesCache* graph_properties_cache = nullptr;
+
+// Fingerprints everything the results of InferStatically() depend on.
+uint64 InferStaticallyCacheKey(const GrapplerItem& item,
+                               bool assume_valid_feeds,
+                               bool aggressive_shape_inference,
+                               bool include_input_tensor_values,
+                               bool include_output_tensor_values) {
+  uint64 key = DeterministicProtoHash64(item.graph);
+  key = FingerprintCat64(key, (assume_valid_feeds ? 1 : 0) |
+                                  (aggressive_shape_inference ? 2 : 0) |
+                                  (include_input_tensor_values ? 4 : 0) |
+                                  (include_output_tensor_values ? 8 : 0));
+  if (!assume_valid_feeds) {
+    for (const auto& feed : item.feed) {
+      key = FingerprintCat64(key, Fingerprint64(feed.first));
+    }
+  }
+  return key;
+}
+
+}  // namespace
+
+ScopedGraphPropertiesCache::ScopedGraphPropertiesCache()
+    : owns_cache_(graph_properties_cache == nullptr) {
+  if (owns_cache_) {
+    graph_properties_cache = new GraphPropertiesCache();
+  }
+}
+
+ScopedGraphPropertiesCache::~ScopedGraphPropertiesCache() {
+  if (owns_cache_) {
+    delete graph_properties_cache;
+    graph_properties_cache = nullptr;
+  }
+}
+
 Status GraphProperties::InferStatically(bool assume_valid_feeds,
                                         bool aggressive_shape_inference,
                                         bool include_input_tensor_values,
                                         bool include_output_tensor_values) {
+  GraphPropertiesCache* cache = graph_properties_cache;
+  uint64 cache_key = 0;
+  if (cache != nullptr) {
+    cache_key = InferStaticallyCacheKey(
+        item_, assume_valid_feeds, aggressive_shape_inference,
+        include_input_tensor_values, include_output_tensor_values);
+    if (cache->valid && cache->key == cache_key) {
+      VLOG(2) << "Reusing inferred shapes of an identical graph.";
+      input_properties_ = cache->input_properties;
+      output_properties_ = cache->output_properties;
+      incompatible_shape_nodes_ = cache->incompatible_shape_nodes;
+      return OkStatus();
+    }
+  }
+
   FunctionLibraryDefinition function_library(OpRegistry::Global(),
                                              item_.graph.library());
   absl::flat_hash_map<string, absl::flat_hash_set<int>> fed_ports;
@@ -2757,6 +2825,13 @@ Status GraphProperties::InferStatically(bool assume_valid_feeds,
   TF_RETURN_IF_ERROR(VerboseShapeInferenceLogging(item_.graph, refiner.get(),
                                                   shape_manager.get()));
 
+  if (cache != nullptr) {
+    cache->valid = true;
+    cache->key = cache_key;
+    cache->input_properties = input_properties_;
+    cache->output_properties = output_properties_;
+    cache->incompatible_shape_nodes = incompatible_shape_nodes_;
+  }
   return OkStatus();
 }
 
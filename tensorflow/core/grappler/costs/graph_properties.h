@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
 
@@ -78,6 +79,23 @@ class TopoQueue;
 // optimization pass. Nodes modified during optimization pass have to be
 // invalidated, to prevent further incorrect optimizations based on wrong shape
 // and data type properties.
+// Shares the results of GraphProperties::InferStatically() between the
+// GraphProperties objects created on the current thread while this object is
+// alive. Grappler optimizers that run one after another each build their own
+// GraphProperties; when a pass leaves the graph unchanged, the following ones
+// reuse its inferred shapes instead of running shape inference again. Scopes
+// may be nested, in which case the outermost one owns the cache.
+class ScopedGraphPropertiesCache {
+ public:
+  ScopedGraphPropertiesCache();
+  ~ScopedGraphPropertiesCache();
+
+ private:
+  const bool owns_cache_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedGraphPropertiesCache);
+};
+
 class GraphProperties {
  public:
   // The item must outlive the properties
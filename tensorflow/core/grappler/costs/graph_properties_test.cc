@@ -233,6 +233,41 @@ TEST_F(GraphPropertiesTest, Clear) {
   EXPECT_FALSE(properties.has_properties());
 }
 
+TEST_F(GraphPropertiesTest, ScopedCache) {
+  ScopedGraphPropertiesCache cache;
+  const auto make_item = [](int batch_size, GrapplerItem* item) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    Output x = ops::Placeholder(
+        s.WithOpName("x"), DT_FLOAT,
+        ops::Placeholder::Shape(PartialTensorShape({batch_size, 7})));
+    Output y = ops::Identity(s.WithOpName("y"), x);
+    TF_CHECK_OK(s.ToGraphDef(&item->graph));
+  };
+  GrapplerItem item;
+  make_item(3, &item);
+
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(false));
+  EXPECT_EQ("float: [3,7]",
+            PropToString(properties.GetOutputProperties("y")[0]));
+
+  // An identical graph reuses the cached results.
+  GrapplerItem same_item;
+  make_item(3, &same_item);
+  GraphProperties same_properties(same_item);
+  TF_ASSERT_OK(same_properties.InferStatically(false));
+  EXPECT_EQ("float: [3,7]",
+            PropToString(same_properties.GetOutputProperties("y")[0]));
+
+  // A modified graph is inferred again.
+  GrapplerItem other_item;
+  make_item(5, &other_item);
+  GraphProperties other_properties(other_item);
+  TF_ASSERT_OK(other_properties.InferStatically(false));
+  EXPECT_EQ("float: [5,7]",
+            PropToString(other_properties.GetOutputProperties("y")[0]));
+}
+
 TEST_F(GraphPropertiesTest, DynamicProperties) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false,
                                           cluster_->GetDeviceNames());
@@ -0,0 +1,102 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/profiled_op_level_cost_estimator.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+
+uint64 ProfiledOpSignature(const OpInfo& op_info) {
+  OpInfo signature;
+  signature.set_op(op_info.op());
+  signature.mutable_device()->set_type(op_info.device().type());
+  for (const auto& attr : op_info.attr()) {
+    if (!absl::StartsWith(attr.first, "_")) {
+      signature.mutable_attr()->insert(attr);
+    }
+  }
+  for (const OpInfo::TensorProperties& input : op_info.inputs()) {
+    OpInfo::TensorProperties* signature_input = signature.add_inputs();
+    signature_input->set_dtype(input.dtype());
+    *signature_input->mutable_shape() = input.shape();
+  }
+  return DeterministicProtoHash64(signature);
+}
+
+ProfiledOpLevelCostEstimator::ProfiledOpLevelCostEstimator(
+    const OpPerformanceList& profile) {
+  for (const OpPerformance& perf : profile.op_performance()) {
+    MeasuredCost& cost = measured_costs_[ProfiledOpSignature(perf.op())];
+    ++cost.num_measurements;
+    cost.compute_cost_ns += perf.compute_cost();
+    cost.temporary_memory += perf.op_memory().temp_memory();
+    cost.persistent_memory += perf.op_memory().persistent_memory();
+    for (int64_t output_memory : perf.op_memory().output_memory()) {
+      cost.output_memory += output_memory;
+    }
+  }
+  for (auto& it : measured_costs_) {
+    MeasuredCost& cost = it.second;
+    cost.compute_cost_ns /= cost.num_measurements;
+    cost.temporary_memory /= cost.num_measurements;
+    cost.persistent_memory /= cost.num_measurements;
+    cost.output_memory /= cost.num_measurements;
+  }
+}
+
+Costs ProfiledOpLevelCostEstimator::PredictCosts(
+    const OpContext& op_context) const {
+  auto it = measured_costs_.find(ProfiledOpSignature(op_context.op_info));
+  if (it == measured_costs_.end()) {
+    return OpLevelCostEstimator::PredictCosts(op_context);
+  }
+  const MeasuredCost& measured = it->second;
+  Costs costs = Costs::ZeroCosts();
+  costs.compute_time = Costs::NanoSeconds(measured.compute_cost_ns);
+  costs.execution_time = costs.compute_time;
+  costs.temporary_memory = measured.temporary_memory;
+  costs.persistent_memory = measured.persistent_memory;
+  costs.max_memory = measured.temporary_memory + measured.persistent_memory +
+                     measured.output_memory;
+  VLOG(1) << "Operation " << op_context.op_info.op() << " takes "
+          << costs.execution_time.count() << " ns according to the profile.";
+  return costs;
+}
+
+Status ReadOpPerformanceList(Env* env, const std::string& path,
+                             OpPerformanceList* profile) {
+  Status binary_status = ReadBinaryProto(env, path, profile);
+  if (binary_status.ok()) {
+    return OkStatus();
+  }
+  Status text_status = ReadTextProto(env, path, profile);
+  if (text_status.ok()) {
+    return OkStatus();
+  }
+  return errors::InvalidArgument("Failed to read cost profile ", path,
+                                 " as a binary (", binary_status.ToString(),
+                                 ") or text (", text_status.ToString(),
+                                 ") OpPerformanceList.");
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,73 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_PROFILED_OP_LEVEL_COST_ESTIMATOR_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_PROFILED_OP_LEVEL_COST_ESTIMATOR_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Predicts the costs of ops from measurements, e.g. collected by profiling
+// production steps and converted with `CostGraphToOpPerformanceData()`, and
+// falls back to the analytical model of `OpLevelCostEstimator` for ops without
+// a matching measurement.
+//
+// Ops are matched by signature: op type, device type, attributes (except
+// internal ones starting with '_') and input dtypes and shapes. Several
+// measurements of the same signature are averaged.
+class ProfiledOpLevelCostEstimator : public OpLevelCostEstimator {
+ public:
+  explicit ProfiledOpLevelCostEstimator(const OpPerformanceList& profile);
+  ~ProfiledOpLevelCostEstimator() override {}
+
+  Costs PredictCosts(const OpContext& op_context) const override;
+
+  // Returns the number of distinct op signatures in the profile.
+  int64_t num_signatures() const { return measured_costs_.size(); }
+
+ private:
+  struct MeasuredCost {
+    int64_t num_measurements = 0;
+    int64_t compute_cost_ns = 0;
+    int64_t temporary_memory = 0;
+    int64_t persistent_memory = 0;
+    int64_t output_memory = 0;
+  };
+
+  absl::flat_hash_map<uint64, MeasuredCost> measured_costs_;
+};
+
+// Returns the signature used to match `op_info` against a profile.
+uint64 ProfiledOpSignature(const OpInfo& op_info);
+
+// Reads a binary or text `OpPerformanceList` from `path`.
+Status ReadOpPerformanceList(Env* env, const std::string& path,
+                             OpPerformanceList* profile);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_PROFILED_OP_LEVEL_COST_ESTIMATOR_H_
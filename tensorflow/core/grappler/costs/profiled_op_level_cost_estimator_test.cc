@@ -0,0 +1,107 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/profiled_op_level_cost_estimator.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+OpContext MatMulContext(int64_t m, int64_t k, int64_t n) {
+  OpContext op_context;
+  op_context.name = "matmul";
+  OpInfo& op_info = op_context.op_info;
+  op_info.set_op("MatMul");
+  op_info.mutable_device()->set_type("CPU");
+  (*op_info.mutable_attr())["transpose_a"].set_b(false);
+  const std::vector<std::vector<int64_t>> input_shapes = {{m, k}, {k, n}};
+  for (const std::vector<int64_t>& dims : input_shapes) {
+    OpInfo::TensorProperties* input = op_info.add_inputs();
+    input->set_dtype(DT_FLOAT);
+    for (int64_t dim : dims) {
+      input->mutable_shape()->add_dim()->set_size(dim);
+    }
+  }
+  return op_context;
+}
+
+OpPerformanceList MatMulProfile() {
+  OpPerformanceList profile;
+  for (int64_t compute_cost : {1000, 3000}) {
+    OpPerformance* perf = profile.add_op_performance();
+    *perf->mutable_op() = MatMulContext(10, 20, 30).op_info;
+    perf->set_compute_cost(compute_cost);
+    perf->mutable_op_memory()->set_temp_memory(64);
+    perf->mutable_op_memory()->add_output_memory(1200);
+  }
+  return profile;
+}
+
+TEST(ProfiledOpLevelCostEstimatorTest, UsesMeasuredCosts) {
+  ProfiledOpLevelCostEstimator estimator(MatMulProfile());
+  EXPECT_EQ(estimator.num_signatures(), 1);
+
+  Costs costs = estimator.PredictCosts(MatMulContext(10, 20, 30));
+  EXPECT_EQ(costs.execution_time, Costs::NanoSeconds(2000));
+  EXPECT_EQ(costs.compute_time, Costs::NanoSeconds(2000));
+  EXPECT_EQ(costs.memory_time, Costs::Duration::zero());
+  EXPECT_EQ(costs.temporary_memory, 64);
+  EXPECT_EQ(costs.max_memory, 64 + 1200);
+  EXPECT_FALSE(costs.inaccurate);
+}
+
+TEST(ProfiledOpLevelCostEstimatorTest, IgnoresInternalAttrsAndValues) {
+  ProfiledOpLevelCostEstimator estimator(MatMulProfile());
+  OpContext op_context = MatMulContext(10, 20, 30);
+  (*op_context.op_info.mutable_attr())["_class"].set_s("loc:@foo");
+  op_context.op_info.mutable_inputs(0)->mutable_value()->set_dtype(DT_FLOAT);
+  op_context.op_info.mutable_device()->set_model("SomeCPU");
+  EXPECT_EQ(estimator.PredictCosts(op_context).execution_time,
+            Costs::NanoSeconds(2000));
+}
+
+TEST(ProfiledOpLevelCostEstimatorTest, FallsBackToAnalyticalCosts) {
+  ProfiledOpLevelCostEstimator estimator(MatMulProfile());
+  OpLevelCostEstimator analytical_estimator;
+  const OpContext op_context = MatMulContext(100, 200, 300);
+  EXPECT_EQ(estimator.PredictCosts(op_context).execution_time,
+            analytical_estimator.PredictCosts(op_context).execution_time);
+}
+
+TEST(ProfiledOpLevelCostEstimatorTest, ReadsTextProfile) {
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "cost_profile.pbtxt");
+  TF_ASSERT_OK(WriteTextProto(Env::Default(), path, MatMulProfile()));
+  OpPerformanceList profile;
+  TF_ASSERT_OK(ReadOpPerformanceList(Env::Default(), path, &profile));
+  EXPECT_EQ(profile.op_performance_size(), 2);
+
+  EXPECT_FALSE(ReadOpPerformanceList(Env::Default(),
+                                     io::JoinPath(testing::TmpDir(), "missing"),
+                                     &profile)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -46,13 +46,20 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/denormal.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/setround.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/bcast.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
+#include "tensorflow/core/util/memmapped_file_system_writer.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 
 namespace tensorflow {
@@ -189,21 +196,24 @@ float QuantizedTypeMaxAsFloat(DataType data_type) {
 ConstantFolding::ConstantFolding(RewriterConfig::Toggle opt_level,
                                  DeviceBase* cpu_device,
                                  bool disable_compressed_tensor_optimization,
-                                 bool fold_quantization_emulation)
+                                 bool fold_quantization_emulation,
+                                 const string& memmapped_dir)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
       disable_compressed_tensor_optimization_(
           disable_compressed_tensor_optimization),
-      fold_quantization_emulation_(fold_quantization_emulation) {
+      fold_quantization_emulation_(fold_quantization_emulation),
+      memmapped_dir_(memmapped_dir) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
 ConstantFolding::ConstantFolding(DeviceBase* cpu_device,
                                  bool disable_compressed_tensor_optimization,
-                                 bool fold_quantization_ops)
+                                 bool fold_quantization_ops,
+                                 const string& memmapped_dir)
     : ConstantFolding(RewriterConfig::ON, cpu_device,
                       disable_compressed_tensor_optimization,
-                      fold_quantization_ops) {}
+                      fold_quantization_ops, memmapped_dir) {}
 
 // static
 string ConstantFolding::AddControlDependency(const string& input_name,
@@ -1026,7 +1036,8 @@ bool ConstantFolding::IsFoldableUncached(
       if (output_shape.IsFullyDefined()) {
         const int64_t num_bytes =
             output_shape.num_elements() * DataTypeSize(output_prop.dtype());
-        if (num_bytes > input_size_bytes && num_bytes > kMaxConstantSize) {
+        if (num_bytes > input_size_bytes && num_bytes > kMaxConstantSize &&
+            !CanMemmapFoldedTensor(node, output_prop.dtype())) {
           // Do not fold nodes if the in-memory size of output is too large.
           // Notice that this is not exactly the same check used in
           // CreateNodeDef() where the actual encoded size is checked.
@@ -1323,6 +1334,63 @@ Status ConstantFolding::CreateNodeDef(const string& name,
   return OkStatus();
 }
 
+bool ConstantFolding::CanMemmapFoldedTensor(const NodeDef& node,
+                                            DataType dtype) const {
+  if (memmapped_dir_.empty() || !DataTypeCanUseMemcpy(dtype)) {
+    return false;
+  }
+  // ImmutableConst only has a CPU kernel.
+  DeviceNameUtils::ParsedName parsed_name;
+  return !DeviceNameUtils::ParseFullName(node.device(), &parsed_name) ||
+         !parsed_name.has_type || parsed_name.type == DEVICE_CPU;
+}
+
+Status ConstantFolding::CreateMemmappedNodeDef(const string& name,
+                                               const Tensor& tensor,
+                                               NodeDef* node) const {
+  Env* env = Env::Default();
+  const uint64 fingerprint = FingerprintCat64(
+      Fingerprint64(tensor.tensor_data()),
+      Fingerprint64(strings::StrCat(DataTypeString(tensor.dtype()),
+                                    tensor.shape().DebugString())));
+  const string element = strings::Printf("%016llx", fingerprint);
+  const string filename =
+      io::JoinPath(memmapped_dir_, strings::StrCat(element, ".tfmm"));
+  // Identical tensors are only written once, and the files are shared with
+  // other graphs folding the same values.
+  if (!env->FileExists(filename).ok()) {
+    const string tmp_filename = strings::StrCat(
+        filename, ".tmp.", env->NowMicros(), "_", random::New64());
+    MemmappedFileSystemWriter writer;
+    Status s = env->RecursivelyCreateDir(memmapped_dir_);
+    if (s.ok()) s = writer.InitializeToFile(env, tmp_filename);
+    if (s.ok()) {
+      s = writer.SaveTensor(
+          tensor,
+          strings::StrCat(MemmappedFileSystem::kMemmappedPackagePrefix,
+                          element));
+    }
+    if (s.ok()) s = writer.FlushAndClose();
+    if (s.ok()) s = env->RenameFile(tmp_filename, filename);
+    if (!s.ok()) {
+      env->DeleteFile(tmp_filename).IgnoreError();
+      return s;
+    }
+  }
+
+  // The tensor is the first region of the package, so it starts at the
+  // beginning of the file and can be memory-mapped through the default
+  // environment.
+  node->set_name(name);
+  node->set_op("ImmutableConst");
+  (*node->mutable_attr())["dtype"].set_type(tensor.dtype());
+  tensor.shape().AsProto((*node->mutable_attr())["shape"].mutable_shape());
+  (*node->mutable_attr())["memory_region_name"].set_s(filename);
+  VLOG(1) << "Folded " << name << " (" << tensor.TotalBytes()
+          << " bytes) into memmapped file " << filename;
+  return OkStatus();
+}
+
 Status ConstantFolding::EvaluateNode(const NodeDef& node,
                                      const TensorVector& inputs,
                                      TensorVector* output) const {
@@ -1398,6 +1466,12 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     if (output_tensors[i].tensor) {
       Status s = CreateNodeDef(node_name, output_tensors[i], &outputs->at(i),
                                total_inputs_size);
+      if (!s.ok() &&
+          CanMemmapFoldedTensor(node, output_tensors[i].tensor->dtype())) {
+        outputs->at(i).Clear();
+        s = CreateMemmappedNodeDef(node_name, *output_tensors[i].tensor,
+                                   &outputs->at(i));
+      }
       if (!s.ok()) {
         *result_too_large = true;
         return s;
@@ -1556,7 +1630,7 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
     // We rewrite the existing node if it only has a single output, and
     // create new nodes otherwise.
     if (const_nodes.size() == 1) {
-      node->set_op("Const");
+      node->set_op(const_node->op());
       // Note we need to clear the inputs in NodeMap before we clear the inputs
       // in the node, otherwise NodeMap would see empty inputs and effectively
       // does nothing.
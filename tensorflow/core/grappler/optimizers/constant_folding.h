@@ -45,12 +45,17 @@ class ConstantFolding : public GraphOptimizer {
   static string AddControlDependency(const string& input_name, GraphDef* graph,
                                      NodeMap* node_map);
 
+  // If `memmapped_dir` is non-empty, folded tensors too large to be encoded in
+  // the graph are written to memmapped files in that directory and read by
+  // ImmutableConst nodes. See RewriterConfig::constant_folding_memmapped_dir.
   explicit ConstantFolding(DeviceBase* cpu_device,
                            bool disable_compressed_tensor_optimization = false,
-                           bool fold_quantization_emulation = true);
+                           bool fold_quantization_emulation = true,
+                           const string& memmapped_dir = "");
   ConstantFolding(RewriterConfig::Toggle opt_level, DeviceBase* cpu_device,
                   bool disable_compressed_tensor_optimization = false,
-                  bool fold_quantization_emulation = true);
+                  bool fold_quantization_emulation = true,
+                  const string& memmapped_dir = "");
 
   ~ConstantFolding() override {}
 
@@ -68,6 +73,14 @@ class ConstantFolding : public GraphOptimizer {
 
   bool IsReallyConstant(const NodeDef& node) const;
 
+  // Returns true if an output of `node` of type `dtype` that is too large to
+  // be encoded in the graph can be written to a memmapped file instead.
+  bool CanMemmapFoldedTensor(const NodeDef& node, DataType dtype) const;
+  // Writes `tensor` to a memmapped package in `memmapped_dir_`, unless an
+  // identical one exists, and creates an ImmutableConst node that reads it.
+  Status CreateMemmappedNodeDef(const string& name, const Tensor& tensor,
+                                NodeDef* node) const;
+
   bool GetTensorFromConstNode(const string& node_name_or_input, Tensor* tensor);
 
   Status MaterializeShapes(const GraphProperties& properties);
@@ -340,6 +353,7 @@ class ConstantFolding : public GraphOptimizer {
   bool graph_contains_assign_or_inplace_op_;
   bool disable_compressed_tensor_optimization_;
   bool fold_quantization_emulation_;
+  string memmapped_dir_;
 };
 
 }  // end namespace grappler
@@ -29,6 +29,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 
 namespace tensorflow {
@@ -3236,6 +3238,49 @@ TEST_F(ConstantFoldingTest, LargeConstant) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(ConstantFoldingTest, LargeConstantMemmapped) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  // Generate a 512 by 512 constant, non-compressible matrix.
+  Output mat_diag =
+      ops::Const(scope.WithOpName("mat_diag"), 3.14f, TensorShape({512}));
+  Output mat = ops::Diag(scope.WithOpName("mat"), mat_diag);
+  Output out = ops::Identity(scope.WithOpName("out"), mat);
+
+  GrapplerItem item;
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+  item.fetch.push_back("out");
+
+  const string dir = io::JoinPath(testing::TmpDir(), "memmapped_constants");
+  ConstantFolding optimizer(/*cpu_device=*/nullptr,
+                            /*disable_compressed_tensor_optimization=*/false,
+                            /*fold_quantization_emulation=*/true, dir);
+  GraphDef output;
+  Status status = optimizer.Optimize(/*cluster=*/nullptr, item, &output);
+  TF_EXPECT_OK(status);
+
+  // The diag node is folded, but its value is stored outside of the graph.
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "mat") {
+      EXPECT_EQ(node.op(), "ImmutableConst");
+      EXPECT_EQ(node.input_size(), 0);
+      EXPECT_EQ(node.attr().at("dtype").type(), DT_FLOAT);
+      const string& filename = node.attr().at("memory_region_name").s();
+      EXPECT_EQ(io::Dirname(filename), dir);
+      TF_EXPECT_OK(Env::Default()->FileExists(filename));
+      ++found;
+    }
+  }
+  EXPECT_EQ(found, 1);
+  EXPECT_LT(output.ByteSizeLong(), sizeof(float) * 512 + 500);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+}
+
 TEST_F(ConstantFoldingTest, SwitchIdenticalInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output x = ops::Placeholder(s.WithOpName("x"), DT_BOOL,
@@ -70,6 +70,8 @@ const ConfigList& DefaultPluginConfigs() {
        {"pin_to_host_optimization", RewriterConfig::ON},
        {"layout_optimizer", RewriterConfig::ON},
        {"remapping", RewriterConfig::ON},
+       {"horizontal_fusion", RewriterConfig::ON},
+       {"weight_quantization", RewriterConfig::ON},
        {"loop_optimization", RewriterConfig::ON},
        {"dependency_optimization", RewriterConfig::ON},
        {"auto_parallel", RewriterConfig::ON},
@@ -0,0 +1,252 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/horizontal_fusion.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+enum class FusionKind { kNone, kMatMul, kBatchMatMul, kElementwise };
+
+// Element-wise ops that can run on stacked operands without broadcasting.
+bool IsFusibleElementwise(const NodeDef& node) {
+  static const auto* const kOps = new absl::flat_hash_set<string>{
+      "Abs", "Add", "AddV2", "Elu", "Exp", "Log", "Maximum",
+      "Minimum", "Mul", "Neg", "Relu", "Relu6", "Rsqrt", "Selu", "Sigmoid",
+      "Sqrt", "Square", "Sub", "Tanh"};
+  return kOps->contains(node.op());
+}
+
+bool IsFloatingPoint(DataType dtype) {
+  return dtype == DT_HALF || dtype == DT_BFLOAT16 || dtype == DT_FLOAT ||
+         dtype == DT_DOUBLE;
+}
+
+FusionKind GetFusionKind(const NodeDef& node) {
+  if (IsMatMul(node)) return FusionKind::kMatMul;
+  if (node.op() == "BatchMatMul" || node.op() == "BatchMatMulV2") {
+    return FusionKind::kBatchMatMul;
+  }
+  if (IsFusibleElementwise(node)) return FusionKind::kElementwise;
+  return FusionKind::kNone;
+}
+
+// Returns the key under which `node` may be grouped with other nodes, or an
+// empty string if it can't be fused. Nodes at the same depth of the graph
+// can't depend on each other.
+string FusionKey(const NodeDef& node, const GraphProperties& properties,
+                 int depth) {
+  const FusionKind kind = GetFusionKind(node);
+  if (kind == FusionKind::kNone || !NodeIsOnGpu(&node)) return "";
+  auto it = node.attr().find("T");
+  if (it == node.attr().end()) return "";
+  const DataType dtype = it->second.type();
+  if (kind != FusionKind::kElementwise && !IsFloatingPoint(dtype)) return "";
+
+  const std::vector<OpInfo::TensorProperties>& inputs =
+      properties.GetInputProperties(node.name());
+  if (static_cast<int>(inputs.size()) != NumNonControlInputs(node)) return "";
+
+  string key = strings::StrCat(node.op(), "@", node.device(), "@", depth);
+  for (const OpInfo::TensorProperties& input : inputs) {
+    const PartialTensorShape shape(input.shape());
+    if (!shape.IsFullyDefined()) return "";
+    // MatMuls of batched operands would broadcast over the batch dimensions.
+    if (kind == FusionKind::kMatMul && shape.dims() != 2) return "";
+    strings::StrAppend(&key, ";", DataTypeString(input.dtype()),
+                       shape.DebugString());
+  }
+  const std::map<string, AttrValue> attrs(node.attr().begin(),
+                                          node.attr().end());
+  for (const auto& attr : attrs) {
+    if (absl::StartsWith(attr.first, "_")) continue;
+    strings::StrAppend(&key, ";", attr.first, "=",
+                       SummarizeAttrValue(attr.second));
+  }
+  return key;
+}
+
+// Returns the length of the longest path from a source to each node. Nodes
+// with the same depth are independent of each other.
+Status ComputeNodeDepths(const GraphDef& graph,
+                         absl::flat_hash_map<string, int>* depths) {
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(graph, &topo_order));
+  for (const NodeDef* node : topo_order) {
+    int depth = 0;
+    for (const string& input : node->input()) {
+      auto it = depths->find(NodeName(input));
+      if (it != depths->end()) depth = std::max(depth, it->second + 1);
+    }
+    (*depths)[node->name()] = depth;
+  }
+  return OkStatus();
+}
+
+// Replaces the nodes of `group` by a single op on stacked operands.
+void FuseGroup(const std::vector<NodeDef*>& group, GraphDef* graph) {
+  const NodeDef& first = *group.front();
+  const FusionKind kind = GetFusionKind(first);
+  const DataType dtype = first.attr().at("T").type();
+  const int num_inputs = NumNonControlInputs(first);
+  const int group_size = group.size();
+  const string prefix = strings::StrCat(first.name(), "/horizontal_fusion");
+
+  NodeDef* fused = graph->add_node();
+  fused->set_name(strings::StrCat(prefix, "/fused"));
+  fused->set_device(first.device());
+  if (kind == FusionKind::kElementwise) {
+    fused->set_op(first.op());
+    for (const auto& attr : first.attr()) {
+      if (!absl::StartsWith(attr.first, "_")) {
+        (*fused->mutable_attr())[attr.first] = attr.second;
+      }
+    }
+  } else {
+    // The ops are restricted to real types, for which the adjoint is the
+    // transpose.
+    const bool matmul = kind == FusionKind::kMatMul;
+    fused->set_op("BatchMatMulV2");
+    SetAttrValue(dtype, &(*fused->mutable_attr())["T"]);
+    SetAttrValue(
+        first.attr().at(matmul ? "transpose_a" : "adj_x").b(),
+        &(*fused->mutable_attr())["adj_x"]);
+    SetAttrValue(
+        first.attr().at(matmul ? "transpose_b" : "adj_y").b(),
+        &(*fused->mutable_attr())["adj_y"]);
+  }
+
+  for (int i = 0; i < num_inputs; ++i) {
+    NodeDef* pack = graph->add_node();
+    pack->set_name(strings::StrCat(prefix, "/pack_", i));
+    pack->set_op("Pack");
+    pack->set_device(first.device());
+    for (const NodeDef* node : group) {
+      pack->add_input(node->input(i));
+    }
+    SetAttrValue(group_size, &(*pack->mutable_attr())["N"]);
+    SetAttrValue(dtype, &(*pack->mutable_attr())["T"]);
+    SetAttrValue(0, &(*pack->mutable_attr())["axis"]);
+    fused->add_input(pack->name());
+  }
+  // The fused op runs after all the control dependencies of the group.
+  absl::flat_hash_set<string> control_inputs;
+  for (const NodeDef* node : group) {
+    for (int i = num_inputs; i < node->input_size(); ++i) {
+      if (control_inputs.insert(node->input(i)).second) {
+        fused->add_input(node->input(i));
+      }
+    }
+  }
+
+  NodeDef* unpack = graph->add_node();
+  unpack->set_name(strings::StrCat(prefix, "/unpack"));
+  unpack->set_op("Unpack");
+  unpack->set_device(first.device());
+  unpack->add_input(fused->name());
+  SetAttrValue(group_size, &(*unpack->mutable_attr())["num"]);
+  SetAttrValue(dtype, &(*unpack->mutable_attr())["T"]);
+  SetAttrValue(0, &(*unpack->mutable_attr())["axis"]);
+
+  for (int k = 0; k < group_size; ++k) {
+    NodeDef* node = group[k];
+    VLOG(2) << "Fusing " << node->name() << " into " << fused->name();
+    node->set_op("Identity");
+    node->clear_input();
+    node->add_input(k == 0 ? unpack->name()
+                           : strings::StrCat(unpack->name(), ":", k));
+    std::vector<string> attrs_to_remove;
+    for (const auto& attr : node->attr()) {
+      if (!absl::StartsWith(attr.first, "_")) {
+        attrs_to_remove.push_back(attr.first);
+      }
+    }
+    for (const string& attr : attrs_to_remove) {
+      node->mutable_attr()->erase(attr);
+    }
+    SetAttrValue(dtype, &(*node->mutable_attr())["T"]);
+  }
+}
+
+}  // namespace
+
+Status HorizontalFusion::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                  GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(
+      properties.InferStatically(/*assume_valid_feeds=*/false,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_tensor_values=*/false));
+  FrameView frames;
+  TF_RETURN_IF_ERROR(frames.InferFromGraph(item.graph));
+  absl::flat_hash_map<string, int> depths;
+  TF_RETURN_IF_ERROR(ComputeNodeDepths(item.graph, &depths));
+  const absl::flat_hash_set<string> nodes_to_preserve =
+      item.NodesToPreserve();
+
+  absl::flat_hash_set<string> node_names;
+  std::map<string, std::vector<NodeDef*>> groups;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    node_names.insert(node.name());
+    if (nodes_to_preserve.contains(node.name()) || frames.IsInFrame(node)) {
+      continue;
+    }
+    const string key = FusionKey(node, properties, depths[node.name()]);
+    if (!key.empty()) groups[key].push_back(&node);
+  }
+
+  for (const auto& group : groups) {
+    const std::vector<NodeDef*>& nodes = group.second;
+    // The fused group launches a Pack for each input, the fused op and an
+    // Unpack, which only pays off for groups larger than that.
+    const int num_inputs = NumNonControlInputs(*nodes.front());
+    if (static_cast<int>(nodes.size()) <= num_inputs + 2) continue;
+    const string prefix =
+        strings::StrCat(nodes.front()->name(), "/horizontal_fusion");
+    if (node_names.contains(strings::StrCat(prefix, "/fused")) ||
+        node_names.contains(strings::StrCat(prefix, "/unpack")) ||
+        node_names.contains(strings::StrCat(prefix, "/pack_0"))) {
+      continue;
+    }
+    FuseGroup(nodes, optimized_graph);
+  }
+  return OkStatus();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,52 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_HORIZONTAL_FUSION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_HORIZONTAL_FUSION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Fuses independent ops of the same kind into a single batched op to reduce
+// the number of kernel launches on GPUs, e.g. the many small MatMuls of
+// multi-tower models.
+//
+// Ops are grouped if they have the same type, device and attributes, the same
+// fully defined input shapes, and none of them depends on another. The inputs
+// of a group are stacked with Pack, the op runs once on the stacked operands
+// (MatMuls and BatchMatMuls become a BatchMatMulV2), and the results are split
+// with Unpack. Every original node is replaced by an Identity of its slice of
+// the result, so the node names in the graph are unchanged.
+class HorizontalFusion : public GraphOptimizer {
+ public:
+  HorizontalFusion() {}
+  explicit HorizontalFusion(RewriterConfig::Toggle opt_level) {}
+
+  ~HorizontalFusion() override {}
+
+  string name() const override { return "horizontal_fusion"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_HORIZONTAL_FUSION_H_
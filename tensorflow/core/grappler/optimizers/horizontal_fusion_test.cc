@@ -0,0 +1,181 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/horizontal_fusion.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kGpuDevice[] = "/device:GPU:0";
+
+class HorizontalFusionTest : public GrapplerTest {
+ protected:
+  int CountOps(const GraphDef& graph, const string& op) {
+    int count = 0;
+    for (const NodeDef& node : graph.node()) {
+      if (node.op() == op) ++count;
+    }
+    return count;
+  }
+};
+
+TEST_F(HorizontalFusionTest, FuseIndependentMatMuls) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice(kGpuDevice);
+  std::vector<Output> matmuls;
+  std::vector<std::pair<string, Tensor>> feeds;
+  for (int i = 0; i < 5; ++i) {
+    const string x_name = strings::StrCat("x", i);
+    const string w_name = strings::StrCat("w", i);
+    Output x = ops::Placeholder(s.WithOpName(x_name), DT_FLOAT,
+                                ops::Placeholder::Shape({4, 8}));
+    Output w = ops::Placeholder(s.WithOpName(w_name), DT_FLOAT,
+                                ops::Placeholder::Shape({16, 8}));
+    matmuls.push_back(ops::MatMul(s.WithOpName(strings::StrCat("matmul", i)),
+                                  x, w, ops::MatMul::TransposeB(true)));
+    feeds.emplace_back(x_name, GenerateRandomTensor<DT_FLOAT>({4, 8}));
+    feeds.emplace_back(w_name, GenerateRandomTensor<DT_FLOAT>({16, 8}));
+  }
+  Output out = ops::AddN(s.WithOpName("out"), matmuls);
+
+  GrapplerItem item;
+  item.fetch = {"out"};
+  item.feed = feeds;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  HorizontalFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(0, CountOps(output, "MatMul"));
+  EXPECT_EQ(2, CountOps(output, "Pack"));
+  EXPECT_EQ(1, CountOps(output, "Unpack"));
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "BatchMatMulV2") {
+      ++found;
+      EXPECT_EQ("matmul0/horizontal_fusion/fused", node.name());
+      EXPECT_FALSE(node.attr().at("adj_x").b());
+      EXPECT_TRUE(node.attr().at("adj_y").b());
+      ASSERT_EQ(2, node.input_size());
+      EXPECT_EQ("matmul0/horizontal_fusion/pack_0", node.input(0));
+      EXPECT_EQ("matmul0/horizontal_fusion/pack_1", node.input(1));
+    } else if (node.name() == "matmul3") {
+      ++found;
+      EXPECT_EQ("Identity", node.op());
+      ASSERT_EQ(1, node.input_size());
+      EXPECT_EQ("matmul0/horizontal_fusion/unpack:3", node.input(0));
+    } else if (node.name() == "matmul0/horizontal_fusion/pack_1") {
+      ++found;
+      ASSERT_EQ(5, node.input_size());
+      EXPECT_EQ("w0", node.input(0));
+      EXPECT_EQ("w4", node.input(4));
+    }
+  }
+  EXPECT_EQ(3, found);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-5);
+#endif
+}
+
+TEST_F(HorizontalFusionTest, FuseIndependentElementwiseOps) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice(kGpuDevice);
+  std::vector<Output> relus;
+  for (int i = 0; i < 4; ++i) {
+    Output x = ops::Placeholder(s.WithOpName(strings::StrCat("x", i)),
+                                DT_FLOAT, ops::Placeholder::Shape({2, 3}));
+    relus.push_back(ops::Relu(s.WithOpName(strings::StrCat("relu", i)), x));
+  }
+  Output out = ops::AddN(s.WithOpName("out"), relus);
+
+  GrapplerItem item;
+  item.fetch = {"out"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  HorizontalFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(1, CountOps(output, "Relu"));
+  EXPECT_EQ(1, CountOps(output, "Pack"));
+  EXPECT_EQ(1, CountOps(output, "Unpack"));
+  EXPECT_EQ(4, CountOps(output, "Identity"));
+}
+
+TEST_F(HorizontalFusionTest, DependentOpsAreNotFused) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice(kGpuDevice);
+  Output w = ops::Placeholder(s.WithOpName("w"), DT_FLOAT,
+                              ops::Placeholder::Shape({8, 8}));
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({8, 8}));
+  for (int i = 0; i < 6; ++i) {
+    x = ops::MatMul(s.WithOpName(strings::StrCat("matmul", i)), x, w);
+  }
+
+  GrapplerItem item;
+  item.fetch = {"matmul5"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  HorizontalFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(6, CountOps(output, "MatMul"));
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+}
+
+TEST_F(HorizontalFusionTest, SmallOrMismatchedGroupsAreNotFused) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice(kGpuDevice);
+  std::vector<Output> matmuls;
+  for (int i = 0; i < 6; ++i) {
+    // Only every other MatMul has the same shapes.
+    const int k = i % 2 == 0 ? 8 : 16;
+    Output x = ops::Placeholder(s.WithOpName(strings::StrCat("x", i)),
+                                DT_FLOAT, ops::Placeholder::Shape({4, k}));
+    Output w = ops::Placeholder(s.WithOpName(strings::StrCat("w", i)),
+                                DT_FLOAT, ops::Placeholder::Shape({k, 4}));
+    matmuls.push_back(
+        ops::MatMul(s.WithOpName(strings::StrCat("matmul", i)), x, w));
+  }
+  Output out = ops::AddN(s.WithOpName("out"), matmuls);
+
+  GrapplerItem item;
+  item.fetch = {"out"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  HorizontalFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(6, CountOps(output, "MatMul"));
+  EXPECT_EQ(0, CountOps(output, "BatchMatMulV2"));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -440,6 +440,18 @@ void RecomputeSubgraph(
   }
 }
 
+// Nodes whose inputs we may want to recompute. This matches node names that
+// contain recomputation_targets_name_scope as a name scope, meaning it either
+// begins with or contains the name scope. Defaults to "gradients/" which will
+// match any node names that begins with "gradients/" or contains
+// "/gradients/".
+bool IsRecomputationTarget(const string& recomputation_targets_name_scope,
+                           const NodeDef& node) {
+  return absl::StartsWith(node.name(), recomputation_targets_name_scope) ||
+         static_cast<int>(
+             node.name().find("/" + recomputation_targets_name_scope)) != -1;
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
                                 GraphDef* graph, const GrapplerItem& item) {
@@ -461,15 +473,7 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
   }
   std::function<bool(const NodeDef&)> is_target =
       [&recomputation_targets_name_scope](const NodeDef& node) {
-        // Nodes whose inputs we may want to recompute. This matches node names
-        // that contain recomputation_targets_name_scope as a name scope,
-        // meaning it either begins with or contains the name scope.
-        // Defaults to "gradients/" which will match any node names that begins
-        // with "gradients/" or contains "/gradients/".
-        return absl::StartsWith(node.name(),
-                                recomputation_targets_name_scope) ||
-               static_cast<int>(node.name().find(
-                   "/" + recomputation_targets_name_scope)) != -1;
+        return IsRecomputationTarget(recomputation_targets_name_scope, node);
       };
 
   if (optimization_level == RewriterConfig::RECOMPUTATION_HEURISTICS ||
@@ -488,7 +492,9 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                   node.attr().count(kRecomputeHint) > 0);
         },
         is_target);
-  } else if (optimization_level == RewriterConfig::MANUAL) {
+  } else if (optimization_level == RewriterConfig::MANUAL ||
+             optimization_level == RewriterConfig::BUDGET_HEURISTICS) {
+    // The budget planner expresses its recomputation decisions as annotations.
     recomputed_subgraphs = GetOpGroupsToRecompute(
         graph, node_map,
         [&feeds, &is_target](const NodeDef& node) {
@@ -1270,6 +1276,245 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   return updated_graph;
 }
 
+// A way of reducing the memory used by an activation at the time of peak
+// memory usage.
+struct ActivationPlan {
+  MutableGraphView::OutputPort port;
+  int64_t memory_used;
+  // Estimated step time added by swapping or recomputing the activation,
+  // whichever is cheaper.
+  Costs::Duration added_time;
+  bool recompute = false;
+  // The uses of the activation after the peak, which read the swapped tensor
+  // back from the host.
+  std::vector<MutableGraphView::InputPort> uses_to_swap;
+
+  // Ranks the plans by added time per byte saved.
+  bool operator<(const ActivationPlan& other) const {
+    return static_cast<double>(added_time.count()) * other.memory_used <
+           static_cast<double>(other.added_time.count()) * memory_used;
+  }
+};
+
+// Adds `input_id` to the inputs of `node` to swap to the host.
+void AnnotateSwapToHost(int input_id, NodeDef* node) {
+  AttrValue& val = (*node->mutable_attr())["_swap_to_host"];
+  if (!val.has_list()) {
+    const bool has_input = val.value_case() == AttrValue::kI;
+    const int64_t existing_input = val.i();
+    val.mutable_list();
+    if (has_input) {
+      val.mutable_list()->add_i(existing_input);
+    }
+  }
+  for (int64_t id : val.list().i()) {
+    if (id == input_id) {
+      return;
+    }
+  }
+  val.mutable_list()->add_i(input_id);
+}
+
+// Simulates the memory usage of the graph and, for every GPU whose peak memory
+// usage exceeds the budget (or the device memory, if smaller), decides which of
+// the activations live at the peak to keep, swap to the host or recompute. The
+// activations that save the most memory per unit of added step time are picked
+// first, until the estimated peak fits the budget.
+//
+// The decisions are recorded as "_swap_to_host" and "_recompute_hint"
+// annotations, which are then implemented by the swapping and recomputation
+// passes.
+bool PlanMemoryBudget(Cluster* cluster, int64_t peak_memory_budget,
+                      const string& recomputation_targets_name_scope,
+                      GrapplerItem* item) {
+  GraphMemory memory(*item);
+  Status s = memory.InferStatically(cluster->GetDevices());
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+    return false;
+  }
+
+  std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+  std::unordered_map<string, Costs::NanoSeconds> op_run_times;
+  bool simulated = false;
+
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  const std::unordered_set<string> cheap_to_recompute_ops =
+      GetCheapToRecomputeOps();
+  MutableGraphView graph(&item->graph);
+  std::vector<ActivationPlan> chosen_plans;
+
+  for (const auto& device : cluster->GetDevices()) {
+    const string& name = device.first;
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU") {
+      continue;
+    }
+    int64_t limit = prop.memory_size();
+    if (peak_memory_budget > 0 && (limit <= 0 || peak_memory_budget < limit)) {
+      limit = peak_memory_budget;
+    }
+    if (limit <= 0) {
+      VLOG(1) << "Memory budget unknown for device " << name;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= limit) {
+      continue;
+    }
+    int64_t required_savings = mem_usage.used_memory - limit;
+
+    if (!simulated) {
+      // Simulate a step once to estimate when and for how long each op runs.
+      VirtualCluster vcluster(cluster->GetDevices());
+      if (!vcluster.Provision().ok() || !vcluster.Initialize(*item).ok()) {
+        return false;
+      }
+      RunMetadata metadata;
+      s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
+      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+        return false;
+      }
+      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+        for (const auto& node_stats : dev_stats.node_stats()) {
+          op_completion_times.emplace(
+              node_stats.node_name(),
+              Costs::NanoSeconds(1) +
+                  Costs::MicroSeconds(node_stats.all_start_micros() +
+                                      node_stats.op_end_rel_micros()));
+          op_run_times.emplace(
+              node_stats.node_name(),
+              Costs::NanoSeconds(1) +
+                  Costs::MicroSeconds(node_stats.op_end_rel_micros() -
+                                      node_stats.op_start_rel_micros()));
+        }
+      }
+      simulated = true;
+    }
+
+    Costs::Duration peak_time = -1;
+    std::unordered_set<string> live_at_peak;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      peak_time = std::max(peak_time, live_tensor.allocation_time);
+      live_at_peak.insert(
+          strings::StrCat(live_tensor.node, ":", live_tensor.output_id));
+    }
+
+    std::vector<ActivationPlan> plans;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      MutableGraphView::OutputPort port =
+          graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
+      if (port.node == nullptr) {
+        continue;
+      }
+      ActivationPlan plan;
+      plan.port = port;
+      plan.memory_used = live_tensor.memory_used;
+      plan.added_time = Costs::Duration::infinity();
+
+      // Swapping only pays off for the uses after the peak, and is only free
+      // if the copies overlap with the computation until the first of them.
+      bool can_swap = IsSwappable(graph, port);
+      bool can_recompute = true;
+      bool feeds_target = false;
+      Costs::Duration earliest_use(Costs::Duration::infinity());
+      for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
+        auto it = op_completion_times.find(input.node->name());
+        if (it == op_completion_times.end()) {
+          can_swap = false;
+          can_recompute = false;
+          break;
+        }
+        if (it->second <= peak_time) {
+          continue;
+        }
+        if (IsRecomputationTarget(recomputation_targets_name_scope,
+                                  *input.node)) {
+          feeds_target = true;
+        } else {
+          // Recomputations only feed the target nodes, so any other use
+          // would keep the original activation alive.
+          can_recompute = false;
+        }
+        if (!IsSwappable(input)) {
+          can_swap = false;
+          continue;
+        }
+        plan.uses_to_swap.emplace_back(input);
+        earliest_use = std::min(earliest_use, it->second);
+      }
+      if (can_swap && !plan.uses_to_swap.empty()) {
+        // Let's assume we're going to swap over PCIe running at 16 GBps, in
+        // both directions.
+        const Costs::Duration transfer_time(2 * live_tensor.memory_used / 16);
+        const Costs::Duration slack =
+            earliest_use - live_tensor.allocation_time;
+        plan.added_time = std::max(Costs::Duration(0),
+                                   Costs::Duration(transfer_time - slack));
+      }
+
+      // Recomputing only saves memory if the inputs of the recomputed node
+      // are kept alive anyway.
+      const NodeDef& producer = *port.node;
+      can_recompute =
+          can_recompute && feeds_target &&
+          !IsRecomputationTarget(recomputation_targets_name_scope, producer) &&
+          feeds.count(producer.name()) == 0 &&
+          (cheap_to_recompute_ops.count(producer.op()) > 0 ||
+           producer.attr().count(kRecomputeHint) > 0);
+      for (int i = 0; can_recompute && i < producer.input_size(); ++i) {
+        const TensorId input = ParseTensorName(producer.input(i));
+        if (input.index() < 0) {
+          continue;
+        }
+        can_recompute = live_at_peak.count(strings::StrCat(
+                            input.node(), ":", input.index())) > 0;
+      }
+      if (can_recompute) {
+        auto it = op_run_times.find(producer.name());
+        if (it != op_run_times.end() && it->second < plan.added_time) {
+          plan.added_time = it->second;
+          plan.recompute = true;
+        }
+      }
+      if (plan.added_time != Costs::Duration::infinity()) {
+        plans.push_back(std::move(plan));
+      }
+    }
+
+    std::sort(plans.begin(), plans.end());
+    for (ActivationPlan& plan : plans) {
+      if (required_savings <= 0) {
+        break;
+      }
+      required_savings -= plan.memory_used;
+      chosen_plans.push_back(std::move(plan));
+    }
+  }
+
+  for (const ActivationPlan& plan : chosen_plans) {
+    VLOG(1) << "Will " << (plan.recompute ? "recompute" : "swap")
+            << " tensor " << plan.port.node->name() << ":"
+            << plan.port.port_id << " of size " << plan.memory_used
+            << ", adding an estimated " << plan.added_time.count() << "ns";
+    if (plan.recompute) {
+      (*plan.port.node->mutable_attr())[kRecomputeHint].set_i(0);
+    } else {
+      for (const MutableGraphView::InputPort& use : plan.uses_to_swap) {
+        AnnotateSwapToHost(use.port_id, use.node);
+      }
+    }
+  }
+  return !chosen_plans.empty();
+}
+
 bool CrossesTaskOrCpuGpuBoundary(const NodeDef& node1, const NodeDef& node2) {
   string task1;
   string device1;
@@ -1386,7 +1631,8 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   bool run_recomputation_pass =
       (optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
        optimization_level_ == RewriterConfig::HEURISTICS ||
-       optimization_level_ == RewriterConfig::MANUAL);
+       optimization_level_ == RewriterConfig::MANUAL ||
+       optimization_level_ == RewriterConfig::BUDGET_HEURISTICS);
   if (!run_recomputation_pass && nodes_to_relax.empty() && item.fetch.empty()) {
     return errors::Aborted("Nothing to do.");
   }
@@ -1394,6 +1640,12 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   GrapplerItem optimized_item(item);
   RelaxAssignNodes(nodes_to_relax, &optimized_item.graph);
 
+  if (optimization_level_ == RewriterConfig::BUDGET_HEURISTICS &&
+      !item.fetch.empty() && cluster != nullptr) {
+    PlanMemoryBudget(cluster, peak_memory_budget_,
+                     recomputation_targets_name_scope_, &optimized_item);
+  }
+
   if (run_recomputation_pass) {
     RecomputationRewritingPass(optimization_level_,
                                recomputation_targets_name_scope_,
@@ -1426,7 +1678,8 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
-           optimization_level_ == RewriterConfig::MANUAL) &&
+           optimization_level_ == RewriterConfig::MANUAL ||
+           optimization_level_ == RewriterConfig::BUDGET_HEURISTICS) &&
           cluster != nullptr) {
         if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
                          &skip_list)) {
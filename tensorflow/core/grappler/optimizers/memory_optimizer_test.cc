@@ -346,6 +346,69 @@ TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, BudgetHeuristics) {
+  // Four activations of 128KB each fit in the 1MB of device memory, but not
+  // in the 256KB budget.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                           {128, 128, 2}, DT_FLOAT);
+  Output a = ops::Identity(s.WithOpName("a").WithDevice("/gpu:0"), v);
+  Output b = ops::Square(s.WithOpName("b").WithDevice("/gpu:0"), v);
+  Output c = ops::Sqrt(s.WithOpName("c").WithDevice("/gpu:0"), a);
+  Output d = ops::Identity(s.WithOpName("d").WithDevice("/gpu:0"), b);
+  Output axis = ops::Const(s.WithOpName("axis"), 0);
+  Output e =
+      ops::Concat(s.WithOpName("e").WithDevice("/gpu:0"), {a, b, c, d}, axis);
+  Output f = ops::Square(s.WithOpName("f").WithDevice("/gpu:0"), a);
+  Output g = ops::Sqrt(s.WithOpName("g").WithDevice("/gpu:0"), b);
+  Output h = ops::Exp(s.WithOpName("h").WithDevice("/gpu:0"), c);
+  Output i = ops::Log(s.WithOpName("i").WithDevice("/gpu:0"), d);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 2});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e", "f", "g", "h", "i"};
+  item.init_ops = {init.name()};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // Without a budget the graph fits in device memory and is left unchanged.
+  {
+    MemoryOptimizer optimizer(RewriterConfig::BUDGET_HEURISTICS);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+    EXPECT_EQ(item.graph.node_size(), output.node_size());
+  }
+
+  MemoryOptimizer optimizer(RewriterConfig::BUDGET_HEURISTICS, "gradients/",
+                            /*peak_memory_budget=*/256 * 1024);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  int num_swap_outs = 0;
+  int num_swap_ins = 0;
+  for (const auto& node : output.node()) {
+    if (node.op() == "_CopyFromGpuToHost") {
+      ++num_swap_outs;
+    } else if (node.op() == "_CopyFromHostToGpu") {
+      ++num_swap_ins;
+    }
+  }
+  EXPECT_GT(num_swap_outs, 0);
+  EXPECT_EQ(num_swap_outs, num_swap_ins);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+#endif
+}
+
 TEST_F(MemoryOptimizerTest, UnswappableInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
@@ -17,11 +17,13 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <map>
 #include <string>
 #include <utility>
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -33,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
@@ -43,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/dependency_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/function_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/horizontal_fusion.h"
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
@@ -51,6 +55,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/shape_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/weight_quantization.h"
 #include "tensorflow/core/grappler/utils/canonicalizer.h"
 #include "tensorflow/core/grappler/utils/colocation.h"
 #include "tensorflow/core/grappler/utils/functions.h"
@@ -59,7 +64,15 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/util.h"
@@ -184,6 +197,103 @@ Status GetGraphDevice(const GraphDef& g_def, std::set<std::string>* devices) {
   return OkStatus();
 }
 
+// Returns a fingerprint of everything the result of optimizing `item` with
+// `config` on `cluster` depends on: the TensorFlow version, the graph and its
+// function library, the item's feeds, fetches and options, the rewriter
+// configuration and the available devices.
+uint64 OptimizedGraphCacheKey(const GrapplerItem& item,
+                              const ConfigProto& config,
+                              const Cluster* cluster) {
+  uint64 key = Fingerprint64(TF_VERSION_STRING);
+  key = FingerprintCat64(key, TF_GRAPH_DEF_VERSION);
+  key = FingerprintCat64(key, DeterministicProtoHash64(item.graph));
+  for (const auto& feed : item.feed) {
+    key = FingerprintCat64(key, Fingerprint64(feed.first));
+    key = FingerprintCat64(key, feed.second.dtype());
+    key = FingerprintCat64(key,
+                           Fingerprint64(feed.second.shape().DebugString()));
+  }
+  const auto fingerprint_strings = [&key](const std::vector<string>& strings) {
+    key = FingerprintCat64(key, strings.size());
+    for (const string& s : strings) {
+      key = FingerprintCat64(key, Fingerprint64(s));
+    }
+  };
+  fingerprint_strings(item.fetch);
+  fingerprint_strings(item.init_ops);
+  fingerprint_strings(item.keep_ops);
+  fingerprint_strings({item.save_op, item.restore_op,
+                       item.save_restore_loc_tensor});
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  key = FingerprintCat64(key, options.allow_non_differentiable_rewrites);
+  key = FingerprintCat64(key, options.allow_pruning_stateful_and_dataset_ops);
+  key = FingerprintCat64(key, options.optimize_function_library);
+  key = FingerprintCat64(key, options.is_eager_mode);
+  fingerprint_strings(
+      std::vector<string>(item.devices().begin(), item.devices().end()));
+
+  ConfigProto key_config = config;
+  key_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->clear_optimized_graph_cache_dir();
+  key = FingerprintCat64(key, DeterministicProtoHash64(key_config));
+
+  if (cluster != nullptr) {
+    std::map<string, const DeviceProperties*> devices;
+    for (const auto& device : cluster->GetDevices()) {
+      devices.emplace(device.first, &device.second);
+    }
+    for (const auto& device : devices) {
+      key = FingerprintCat64(key, Fingerprint64(device.first));
+      key = FingerprintCat64(key, DeterministicProtoHash64(*device.second));
+    }
+  }
+  return key;
+}
+
+string OptimizedGraphCacheFilename(const string& cache_dir, uint64 key) {
+  return io::JoinPath(cache_dir, absl::StrFormat("%016x.graphdef", key));
+}
+
+// Reads the optimized graph stored under `key`. Returns false if there is no
+// usable cache entry.
+bool LookupOptimizedGraph(const string& cache_dir, uint64 key,
+                          GraphDef* optimized_graph) {
+  Env* env = Env::Default();
+  const string filename = OptimizedGraphCacheFilename(cache_dir, key);
+  if (!env->FileExists(filename).ok()) {
+    return false;
+  }
+  Status s = ReadBinaryProto(env, filename, optimized_graph);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring unreadable optimized graph cache entry "
+                 << filename << ": " << s;
+    optimized_graph->Clear();
+    return false;
+  }
+  return true;
+}
+
+// Stores `optimized_graph` under `key`. The entry is written to a temporary
+// file and renamed into place, so that concurrent readers never observe a
+// partially written graph.
+void StoreOptimizedGraph(const string& cache_dir, uint64 key,
+                         const GraphDef& optimized_graph) {
+  Env* env = Env::Default();
+  const string filename = OptimizedGraphCacheFilename(cache_dir, key);
+  const string tmp_filename = strings::StrCat(
+      filename, ".tmp.", env->NowMicros(), "_", random::New64());
+  Status s = env->RecursivelyCreateDir(cache_dir);
+  if (s.ok()) s = WriteBinaryProto(env, tmp_filename, optimized_graph);
+  if (s.ok()) s = env->RenameFile(tmp_filename, filename);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to write optimized graph cache entry " << filename
+                 << ": " << s;
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+}
+
 }  // namespace
 
 #define MK_OPT(NAME, CONFIG, VALUE)                                    \
@@ -216,11 +326,15 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
          new ConstantFolding(
              cpu_device_,
              cfg_.experimental_disable_compressed_tensor_optimization(),
-             !cfg_.experimental_disable_folding_quantization_emulation()));
+             !cfg_.experimental_disable_folding_quantization_emulation(),
+             cfg_.constant_folding_memmapped_dir()));
   MK_OPT("shape", "shape_optimization", new ShapeOptimizer());
   MK_OPT("remap", "remapping",
          new Remapper(cfg_.remapping(), cfg_.cpu_layout_conversion(),
                       xla_auto_clustering_on_));
+  MK_OPT("horizontal_fusion", "horizontal_fusion", new HorizontalFusion());
+  MK_OPT("weight_quantization", "weight_quantization",
+         new WeightQuantization());
   MK_OPT("layout", "layout_optimizer",
          new GenericLayoutOptimizer(
              /*optimization level*/ cfg_.layout_optimizer(),
@@ -356,7 +470,8 @@ Status MetaOptimizer::InitializeOptimizers(
       optimizers->push_back(MakeUnique<ConstantFolding>(
           cfg_.constant_folding(), cpu_device_,
           cfg_.experimental_disable_compressed_tensor_optimization(),
-          !cfg_.experimental_disable_folding_quantization_emulation()));
+          !cfg_.experimental_disable_folding_quantization_emulation(),
+          cfg_.constant_folding_memmapped_dir()));
     }
   }
   if (BOTH_NOT_OFF(shape_optimization)) {
@@ -412,6 +527,11 @@ Status MetaOptimizer::InitializeOptimizers(
           MakeUnique<ArithmeticOptimizer>(cfg_.arithmetic_optimization()));
     }
   }
+  if (BOTH_ARE_ON(weight_quantization))
+    optimizers->push_back(MakeUnique<WeightQuantization>());
+  else if (BOTH_ARE_EXPERIMENTAL_MLIR(weight_quantization) ||
+           BOTH_ARE_EXPERIMENTAL_BOTH(weight_quantization))
+    VLOG(2) << "weight_quantization is not implemented in TFG yet";
   if (BOTH_NOT_OFF(layout_optimizer)) {
     if (USER_IS_EXPERIMENTAL_MLIR(layout_optimizer) ||
         USER_IS_EXPERIMENTAL_BOTH(layout_optimizer)) {
@@ -442,6 +562,11 @@ Status MetaOptimizer::InitializeOptimizers(
                                                  xla_auto_clustering_on_));
     }
   }
+  if (BOTH_ARE_ON(horizontal_fusion))
+    optimizers->push_back(MakeUnique<HorizontalFusion>());
+  else if (BOTH_ARE_EXPERIMENTAL_MLIR(horizontal_fusion) ||
+           BOTH_ARE_EXPERIMENTAL_BOTH(horizontal_fusion))
+    VLOG(2) << "horizontal_fusion is not implemented in TFG yet";
   if (BOTH_NOT_OFF(loop_optimization)) {
     if (USER_IS_EXPERIMENTAL_MLIR(loop_optimization) ||
         USER_IS_EXPERIMENTAL_BOTH(loop_optimization)) {
@@ -466,11 +591,14 @@ Status MetaOptimizer::InitializeOptimizers(
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
       optimizers->push_back(
           // Use the default target node name prefix "gradients/"
-          MakeUnique<MemoryOptimizer>(cfg_.memory_optimization()));
+          MakeUnique<MemoryOptimizer>(
+              cfg_.memory_optimization(), "gradients/",
+              cfg_.memory_optimizer_peak_memory_budget()));
     } else {
       optimizers->push_back(MakeUnique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_optimizer_peak_memory_budget()));
     }
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
@@ -627,6 +755,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     PRINT_CFG(pin_to_host_optimization)
     PRINT_CFG(layout_optimizer)
     PRINT_CFG(remapping)
+    PRINT_CFG(horizontal_fusion)
+    PRINT_CFG(weight_quantization)
     PRINT_CFG(loop_optimization)
     PRINT_CFG(dependency_optimization)
     PRINT_CFG(scoped_allocator_optimization)
@@ -680,6 +810,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("pin_to_host", "pin_to_host_optimization")
       PRINT_CFG("layout", "layout_optimizer")
       PRINT_CFG("remap", "remapping")
+      PRINT_CFG("horizontal_fusion", "horizontal_fusion")
+      PRINT_CFG("weight_quantization", "weight_quantization")
       PRINT_CFG("loop", "loop_optimization")
       PRINT_CFG("dependency", "dependency_optimization")
       PRINT_CFG("memory", "memory_optimization")
@@ -719,6 +851,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         pair.first == "auto_mixed_precision_mkl" ||
         pair.first == "auto_mixed_precision_cpu" ||
         pair.first == "pin_to_host_optimization" ||
+        pair.first == "horizontal_fusion" ||
+        pair.first == "weight_quantization" ||
         pair.first == "scoped_allocator_optimization") {
       // These optimizers are turned off by default.
       // TODO(penporn): Remove the hard-coded length and change it to max length
@@ -877,7 +1011,10 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -1043,7 +1180,25 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       {kGrapplerCategory, "*"});
 
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.clear();
+  }
+
+  const string& cache_dir = cfg_.optimized_graph_cache_dir();
+  uint64 cache_key = 0;
+  if (!cache_dir.empty()) {
+    cache_key = OptimizedGraphCacheKey(item, config_proto_, cluster);
+    if (LookupOptimizedGraph(cache_dir, cache_key, optimized_graph)) {
+      VLOG(1) << "Loaded optimized graph for grappler item " << item.id
+              << " from cache " << cache_dir;
+      return OkStatus();
+    }
+  }
+
+  // Let the optimizers share inferred shapes while the graph is unchanged
+  // between passes.
+  ScopedGraphPropertiesCache graph_properties_cache;
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -1152,15 +1307,85 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // Builds the GrapplerItem for optimizing the body of `func`.
+  const auto make_function_item =
+      [&](const FunctionDef& func, GrapplerFunctionItem* func_item) -> Status {
+    const string& func_name = func.signature().name();
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(func, flib, producer, func_item));
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    func_item->optimization_options().allow_non_differentiable_rewrites =
+        !differentiable_functions.contains(func_name);
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item->devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item->optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+    return OkStatus();
+  };
+
+  // Optimizes the function body of `func_item`. Only reads shared state, so
+  // that several functions can be optimized concurrently.
+  const auto optimize_function =
+      [&](GrapplerFunctionItem* func_item,
+          GraphDef* optimized_func_graph) -> Status {
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item->graph.release_library());
+      *func_item->graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      return implementation_selector.Optimize(cluster, *func_item,
+                                              optimized_func_graph);
+    }
+    GrapplerFunctionItem func_item_copy = *func_item;
+    return OptimizeGraph(cluster, std::move(func_item_copy),
+                         optimized_func_graph);
+  };
+
+  // Independent functions are optimized concurrently if configured. They all
+  // share the deadline of the meta-optimizer.
+  const int parallelism = cfg_.function_optimization_parallelism();
+  std::unique_ptr<thread::ThreadPool> function_pool;
+  if (parallelism > 1) {
+    function_pool = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "grappler_function_optimizer", parallelism);
+  }
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    std::vector<const FunctionDef*> funcs;
     for (const FunctionDef& func : optimized_graph->library().function()) {
-      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-
       const string& func_name = func.signature().name();
 
       // Skip functions that are not reachable from the optimized graph.
@@ -1180,87 +1405,96 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // and in function instantiation.
       if (data::IsTFDataFunction(func)) continue;
 
-      VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
-              << optimized_graph->library().function_size() << "]";
+      funcs.push_back(&func);
+    }
 
-      // Function optimization might specialize nested function calls, so we
-      // have to reset the flag and do at least one more pass over the library.
-      optimize_function_library = true;
-      optimized_funcs.insert(func_name);
+    const int num_funcs = funcs.size();
+    for (int begin = 0; begin < num_funcs;) {
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+      // Functions are optimized in batches. A function only joins a batch if
+      // it doesn't (transitively) call any function already in it, so that
+      // it sees exactly the library it would see if the functions were
+      // optimized one at a time, and the result stays deterministic.
+      int end = begin + 1;
+      if (function_pool != nullptr) {
+        absl::flat_hash_set<string> batch_funcs = {
+            funcs[begin]->signature().name()};
+        while (end < num_funcs && end - begin < 4 * parallelism) {
+          bool calls_batch = false;
+          for (const string& callee :
+               flib.ReachableDefinitions(*funcs[end]).ListFunctionNames()) {
+            if (batch_funcs.contains(callee)) {
+              calls_batch = true;
+              break;
+            }
+          }
+          if (calls_batch) break;
+          batch_funcs.insert(funcs[end]->signature().name());
+          ++end;
+        }
       }
 
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+      const int batch_size = end - begin;
+      std::vector<GrapplerFunctionItem> func_items(batch_size);
+      for (int i = 0; i < batch_size; ++i) {
+        const FunctionDef& func = *funcs[begin + i];
+        const string& func_name = func.signature().name();
+        VLOG(3) << "Optimize function: function=" << func_name << " ["
+                << begin + i << " of " << num_funcs << "]";
+
+        // Function optimization might specialize nested function calls, so we
+        // have to reset the flag and do at least one more pass over the
+        // library.
+        optimize_function_library = true;
+        optimized_funcs.insert(func_name);
+
+        // Make a GrapplerItem from a FunctionDef.
+        TF_RETURN_IF_ERROR(make_function_item(func, &func_items[i]));
       }
 
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      // Optimize function body graphs.
+      std::vector<GraphDef> optimized_func_graphs(batch_size);
+      std::vector<Status> statuses(batch_size);
+      if (batch_size == 1) {
+        statuses[0] =
+            optimize_function(&func_items[0], &optimized_func_graphs[0]);
+      } else {
+        BlockingCounter counter(batch_size);
+        for (int i = 0; i < batch_size; ++i) {
+          function_pool->Schedule([&, i]() {
+            ScopedGraphPropertiesCache graph_properties_cache;
+            statuses[i] =
+                optimize_function(&func_items[i], &optimized_func_graphs[i]);
+            counter.DecrementCount();
+          });
         }
+        counter.Wait();
       }
 
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+      for (int i = 0; i < batch_size; ++i) {
+        TF_RETURN_IF_ERROR(statuses[i]);
+        const string& func_name = funcs[begin + i]->signature().name();
 
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+        // Function body optimization might have created new specialized
+        // functions for each instantiation context. Add them to the library.
+        for (const FunctionDef& func_def :
+             optimized_func_graphs[i].library().function()) {
+          if (flib.Find(func_def.signature().name()) == nullptr) {
+            TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+          }
+        }
+
+        // Convert optimized graph back to FunctionDef.
+        FunctionDef optimized_func;
+        func_items[i].SwapFunctionBody(std::move(optimized_func_graphs[i]));
+        TF_RETURN_IF_ERROR(
+            MakeFunctionDef(func_items[i], flib, &optimized_func));
+
+        // Replace optimized function with a new FunctionDef.
+        TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+      }
+      begin = end;
     }
 
     // If optimized at least one function, update the graph library.
@@ -1304,10 +1538,14 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
         *optimized_graph);
   }
 
+  if (!cache_dir.empty()) {
+    StoreOptimizedGraph(cache_dir, cache_key, *optimized_graph);
+  }
   return OkStatus();
 }
 
 string MetaOptimizer::GetResultString() const {
+  tf_shared_lock l(optimization_results_mu_);
   std::string result_string;
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     absl::StrAppend(&result_string,
@@ -1345,6 +1583,8 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
 #endif
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
+         rewrite_cfg.horizontal_fusion() == RewriterConfig::ON ||
+         rewrite_cfg.weight_quantization() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
          AutoMixedPrecisionEnabled(
              rewrite_cfg.auto_mixed_precision_onednn_bfloat16()) ||
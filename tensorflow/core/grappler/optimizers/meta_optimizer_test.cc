@@ -18,6 +18,7 @@ limitations under the License.
 #include <atomic>
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -150,6 +152,47 @@ TEST_F(MetaOptimizerTest, RunsCustomOptimizer) {
   EXPECT_TRUE(TestOptimizer::IsOptimized());
 }
 
+TEST_F(MetaOptimizerTest, ReusesCachedOptimizedGraph) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_optimized_graph_cache_dir(
+      io::JoinPath(testing::TmpDir(), "optimized_graph_cache"));
+
+  TestOptimizer::SetOptimized(false);
+  GraphDef output;
+  {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  }
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+
+  // The second run is served from the cache without running any optimizer.
+  TestOptimizer::SetOptimized(false);
+  GraphDef cached_output;
+  {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &cached_output));
+  }
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  CompareGraphs(output, cached_output);
+
+  // A different configuration misses the cache.
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+  GraphDef other_output;
+  {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &other_output));
+  }
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+}
+
 TEST_F(MetaOptimizerTest, RunsCustomOptimizerWithParams) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
   GrapplerItem item;
@@ -420,6 +463,66 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryInParallel) {
+  using test::function::NDef;
+
+  // Independent functions, each calling a shared function that gets inlined.
+  FunctionDef mul_func = FunctionDefHelper::Create(
+      "MyMul", {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+  std::vector<FunctionDef> funcs = {mul_func};
+  std::vector<NodeDef> nodes = {
+      NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  for (int i = 0; i < 8; ++i) {
+    const string name = absl::StrCat("MySquare", i);
+    FunctionDef square_func = FunctionDefHelper::Create(
+        name, {"x:T"}, {"z:T"}, {"T: {float, double}"},
+        {{{"my_mul"}, "MyMul", {"x", "x"}, {{"T", "$T"}}}},
+        /*ret_def=*/
+        {{"z", "my_mul:z:0"}});
+    (*square_func.mutable_attr())["_noinline"].set_b(true);
+    funcs.push_back(square_func);
+    nodes.push_back(NDef(absl::StrCat("square", i), name, {"a"},
+                         {{"T", DT_FLOAT}}, kDevice));
+  }
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(nodes, funcs);
+
+  const auto optimize = [&item](int parallelism, GraphDef* output) {
+    ConfigProto config_proto;
+    auto& rewriter_config =
+        *config_proto.mutable_graph_options()->mutable_rewrite_options();
+    rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+    rewriter_config.set_function_optimization(RewriterConfig::ON);
+    rewriter_config.add_optimizers("function");
+    rewriter_config.set_min_graph_nodes(-1);
+    rewriter_config.set_function_optimization_parallelism(parallelism);
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, output));
+  };
+  GraphDef sequential_output;
+  optimize(/*parallelism=*/1, &sequential_output);
+  GraphDef parallel_output;
+  optimize(/*parallelism=*/4, &parallel_output);
+
+  CompareGraphs(sequential_output, parallel_output);
+  FunctionLibraryDefinition sequential_flib(OpRegistry::Global(),
+                                            sequential_output.library());
+  FunctionLibraryDefinition parallel_flib(OpRegistry::Global(),
+                                          parallel_output.library());
+  ASSERT_EQ(sequential_flib.num_functions(), parallel_flib.num_functions());
+  for (const string& name : sequential_flib.ListFunctionNames()) {
+    const FunctionDef* parallel_func = parallel_flib.Find(name);
+    ASSERT_NE(parallel_func, nullptr) << name;
+    EXPECT_TRUE(
+        FunctionDefsEqual(*sequential_flib.Find(name), *parallel_func))
+        << name;
+  }
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   using test::function::NDef;
 
@@ -151,6 +151,35 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// SparseSegment{Sum,Mean,SqrtN}[WithNumSegments] reducing the rows of a Gather
+// of the Unique ids, as emitted by embedding_lookup_sparse. The reduction can
+// read the rows of the params at the original ids directly, without
+// materializing the gathered rows.
+struct SparseSegmentReductionWithGather {
+  SparseSegmentReductionWithGather() = default;
+
+  int reduction = kMissingIndex;
+  int gather = kMissingIndex;
+  int unique = kMissingIndex;
+  // Whether the Unique node is only used by the pattern and can be removed.
+  bool remove_unique = false;
+};
+
+// BatchMatMul+[Mul]+[AddV2]+Softmax+BatchMatMul computing the attention of
+// queries, keys and values, with an optional scale and additive mask.
+struct MultiHeadAttention {
+  MultiHeadAttention() = default;
+
+  int scores = kMissingIndex;
+  int scale = kMissingIndex;
+  int mask = kMissingIndex;
+  int softmax = kMissingIndex;
+  int output = kMissingIndex;
+  // The input of the AddV2 that is the mask.
+  int mask_port = 1;
+  float scale_value = 1.0f;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -2257,6 +2286,226 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+bool IsSparseSegmentReduction(const NodeDef& node) {
+  const auto& op = node.op();
+  return op == "SparseSegmentSum" || op == "SparseSegmentMean" ||
+         op == "SparseSegmentSqrtN" ||
+         op == "SparseSegmentSumWithNumSegments" ||
+         op == "SparseSegmentMeanWithNumSegments" ||
+         op == "SparseSegmentSqrtNWithNumSegments";
+}
+
+bool FindSparseSegmentReductionWithGather(
+    const RemapperContext& ctx, int node_index,
+    SparseSegmentReductionWithGather* matched) {
+  // Root of the pattern must be a sparse segment reduction.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsSparseSegmentReduction(*node_def) ||
+      node_view->NumRegularFanins() < 3) {
+    return false;
+  }
+
+  // The reduced data must be a Gather along the first axis.
+  const auto& data = node_view->GetRegularFanin(0);
+  const auto* gather_node_view = data.node_view();
+  const auto* gather_node_def = gather_node_view->node();
+  if (data.index() != 0 ||
+      (gather_node_def->op() != "Gather" &&
+       gather_node_def->op() != "GatherV2") ||
+      HasControlFaninOrFanout(*gather_node_view) ||
+      !HasAtMostOneFanoutAtPort0(*gather_node_view) ||
+      IsInPreserveSet(ctx, gather_node_def)) {
+    return false;
+  }
+  if (gather_node_def->op() == "GatherV2") {
+    int batch_dims = 0;
+    if (TryGetNodeAttr(*gather_node_def, "batch_dims", &batch_dims) &&
+        batch_dims != 0) {
+      return false;
+    }
+    if (gather_node_view->NumRegularFanins() < 3) return false;
+    const auto* axis_node_def =
+        gather_node_view->GetRegularFanin(2).node_view()->node();
+    Tensor axis;
+    if (!IsConstant(*axis_node_def) ||
+        !axis.FromProto(axis_node_def->attr().at("value").tensor()) ||
+        axis.NumElements() != 1) {
+      return false;
+    }
+    const int64_t axis_value = axis.dtype() == DT_INT32
+                                   ? axis.flat<int32>()(0)
+                                   : axis.flat<int64_t>()(0);
+    if (axis_value != 0) return false;
+  }
+
+  // The gathered ids and the reduction indices must be the outputs of the same
+  // Unique.
+  const auto& gather_indices = gather_node_view->GetRegularFanin(1);
+  const auto& indices = node_view->GetRegularFanin(1);
+  const auto* unique_node_view = gather_indices.node_view();
+  const auto* unique_node_def = unique_node_view->node();
+  if (!IsUnique(*unique_node_def) || gather_indices.index() != 0 ||
+      indices.node_view() != unique_node_view || indices.index() != 1) {
+    return false;
+  }
+  // The original ids become the reduction indices.
+  const DataType ids_dtype = GetDataTypeFromAttr(*unique_node_def, "T");
+  if (ids_dtype != DT_INT32 && ids_dtype != DT_INT64) return false;
+
+  matched->reduction = node_index;
+  matched->gather = gather_node_view->node_index();
+  matched->unique = unique_node_view->node_index();
+  matched->remove_unique = !IsInPreserveSet(ctx, unique_node_def) &&
+                           unique_node_view->NumControlledFanouts() == 0 &&
+                           unique_node_view->GetRegularFanout(0).size() == 1 &&
+                           unique_node_view->GetRegularFanout(1).size() == 1;
+  return true;
+}
+
+bool FindMultiHeadAttention(RemapperContext* ctx, int node_index,
+                            MultiHeadAttention* matched) {
+  const auto is_batch_matmul = [](const NodeDef& node, bool adj_y) -> bool {
+    if (node.op() != "BatchMatMul" && node.op() != "BatchMatMulV2") {
+      return false;
+    }
+    bool adj_x = false;
+    bool node_adj_y = false;
+    TryGetNodeAttr(node, "adj_x", &adj_x);
+    TryGetNodeAttr(node, "adj_y", &node_adj_y);
+    return !adj_x && node_adj_y == adj_y;
+  };
+  // The intermediate nodes of the pattern are removed with the fusion.
+  const auto is_removable = [&](const utils::MutableNodeView& node_view) {
+    return !HasControlFaninOrFanout(node_view) &&
+           HasAtMostOneFanoutAtPort0(node_view) &&
+           !IsInPreserveSet(*ctx, node_view.node());
+  };
+
+  // Root of the pattern must be the product of the probabilities and values,
+  // which only has a CPU kernel.
+  auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!is_batch_matmul(*node_def, /*adj_y=*/false) ||
+      !NodeIsOnCpu(node_def) || node_view->NumRegularFanins() != 2) {
+    return false;
+  }
+  const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+  if (dtype != DT_FLOAT && dtype != DT_BFLOAT16 && dtype != DT_HALF) {
+    return false;
+  }
+
+  auto* softmax_view = node_view->GetRegularFanin(0).node_view();
+  if (!IsSoftmax(*softmax_view->node()) || !is_removable(*softmax_view)) {
+    return false;
+  }
+  auto* logits_view = softmax_view->GetRegularFanin(0).node_view();
+
+  MultiHeadAttention pattern;
+  pattern.output = node_index;
+  pattern.softmax = softmax_view->node_index();
+  if (IsAdd(*logits_view->node()) && is_removable(*logits_view)) {
+    // The mask is the input that is not the (scaled) scores.
+    const auto is_scores = [&](const utils::MutableNodeView* view) {
+      return IsMul(*view->node()) || is_batch_matmul(*view->node(), true);
+    };
+    pattern.mask = logits_view->node_index();
+    if (is_scores(logits_view->GetRegularFanin(0).node_view())) {
+      pattern.mask_port = 1;
+    } else if (is_scores(logits_view->GetRegularFanin(1).node_view())) {
+      pattern.mask_port = 0;
+    } else {
+      return false;
+    }
+    logits_view =
+        logits_view->GetRegularFanin(1 - pattern.mask_port).node_view();
+  }
+  if (IsMul(*logits_view->node()) && is_removable(*logits_view)) {
+    // The scores must be scaled by a scalar constant.
+    pattern.scale = logits_view->node_index();
+    int scale_port = 0;
+    for (; scale_port < 2; ++scale_port) {
+      const auto* input = logits_view->GetRegularFanin(scale_port).node_view();
+      if (IsConstant(*input->node())) break;
+    }
+    if (scale_port == 2) return false;
+    const NodeDef* scale_node =
+        logits_view->GetRegularFanin(scale_port).node_view()->node();
+    Tensor scale;
+    if (!scale.FromProto(scale_node->attr().at("value").tensor()) ||
+        scale.NumElements() != 1) {
+      return false;
+    }
+    switch (scale.dtype()) {
+      case DT_FLOAT:
+        pattern.scale_value = scale.flat<float>()(0);
+        break;
+      case DT_BFLOAT16:
+        pattern.scale_value = static_cast<float>(scale.flat<bfloat16>()(0));
+        break;
+      case DT_HALF:
+        pattern.scale_value = static_cast<float>(scale.flat<Eigen::half>()(0));
+        break;
+      default:
+        return false;
+    }
+    logits_view = logits_view->GetRegularFanin(1 - scale_port).node_view();
+  }
+  if (!is_batch_matmul(*logits_view->node(), /*adj_y=*/true) ||
+      !is_removable(*logits_view)) {
+    return false;
+  }
+  pattern.scores = logits_view->node_index();
+
+  // The kernel does not broadcast the batch dimensions of the queries, keys
+  // and values, nor the scores to the shape of the mask.
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/false,
+        /*include_output_tensor_values=*/true);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+  const auto& scores_props =
+      ctx->graph_properties.GetInputProperties(logits_view->node()->name());
+  const auto& output_props =
+      ctx->graph_properties.GetInputProperties(node_def->name());
+  if (scores_props.size() != 2 || output_props.size() != 2) return false;
+  const TensorShapeProto& query_shape = scores_props[0].shape();
+  const TensorShapeProto& key_shape = scores_props[1].shape();
+  const TensorShapeProto& value_shape = output_props[1].shape();
+  const int rank = Rank(query_shape);
+  if (rank < 2 || Rank(key_shape) != rank || Rank(value_shape) != rank) {
+    return false;
+  }
+  for (int i = 0; i < rank - 2; ++i) {
+    const int64_t dim = query_shape.dim(i).size();
+    if (dim < 0 || key_shape.dim(i).size() != dim ||
+        value_shape.dim(i).size() != dim) {
+      return false;
+    }
+  }
+  if (pattern.mask != kMissingIndex) {
+    const NodeDef* mask_node = ctx->graph_view.GetNode(pattern.mask)->node();
+    const auto& mask_props =
+        ctx->graph_properties.GetInputProperties(mask_node->name());
+    const auto& logits_props =
+        ctx->graph_properties.GetOutputProperties(mask_node->name());
+    if (mask_props.size() != 2 || logits_props.empty() ||
+        Rank(mask_props[pattern.mask_port].shape()) > rank ||
+        !ShapesSymbolicallyEqual(
+            logits_props[0].shape(),
+            mask_props[1 - pattern.mask_port].shape())) {
+      return false;
+    }
+  }
+
+  *matched = pattern;
+  return true;
+}
+
 bool FindFusedBatchMatMul(RemapperContext* ctx, int node_index,
                           std::map<string, int>* matched_nodes_map,
                           std::set<int>* remove_node_indices) {
@@ -3481,6 +3730,88 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return OkStatus();
 }
 
+Status AddSparseSegmentReductionNode(
+    RemapperContext* ctx, const SparseSegmentReductionWithGather& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& reduction = graph->node(matched.reduction);
+  const NodeDef& gather = graph->node(matched.gather);
+  const NodeDef& unique = graph->node(matched.unique);
+  VLOG(2) << "Fuse " << gather.op() << " of " << unique.op() << " with "
+          << reduction.op() << ":"
+          << " reduction=" << reduction.name() << " gather=" << gather.name()
+          << " unique=" << unique.name();
+
+  NodeDef fused_op = reduction;
+  fused_op.set_input(0, gather.input(0));  // 0: params
+  fused_op.set_input(1, unique.input(0));  // 1: ids
+  (*fused_op.mutable_attr())["Tidx"] = unique.attr().at("T");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.reduction] = true;
+  (*nodes_to_delete)[matched.gather] = true;
+  if (matched.remove_unique) {
+    (*nodes_to_delete)[matched.unique] = true;
+  }
+
+  return OkStatus();
+}
+
+Status AddMultiHeadAttentionNode(RemapperContext* ctx,
+                                 const MultiHeadAttention& matched,
+                                 std::vector<bool>* invalidated_nodes,
+                                 std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& output = graph->node(matched.output);
+  const NodeDef& scores = graph->node(matched.scores);
+  VLOG(2) << "Fuse attention of " << scores.op() << " and " << output.op()
+          << ": scores=" << scores.name() << " output=" << output.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(output.name());
+  fused_op.set_op("_FusedMultiHeadAttention");
+  fused_op.set_device(output.device());
+  fused_op.add_input(scores.input(0));  // 0: query
+  fused_op.add_input(scores.input(1));  // 1: key
+  fused_op.add_input(output.input(1));  // 2: value
+  if (matched.mask != kMissingIndex) {
+    const NodeDef& mask = graph->node(matched.mask);
+    fused_op.add_input(mask.input(matched.mask_port));  // 3: mask
+  }
+  for (int i = 2; i < output.input_size(); ++i) {
+    fused_op.add_input(output.input(i));  // control dependencies
+  }
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = output.attr().at("T");
+  (*attr)["num_args"].set_i(matched.mask != kMissingIndex ? 1 : 0);
+  (*attr)["scale"].set_f(matched.scale_value);
+  (*attr)["is_causal"].set_b(false);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.output] = true;
+  (*nodes_to_delete)[matched.scores] = true;
+  (*nodes_to_delete)[matched.softmax] = true;
+  if (matched.scale != kMissingIndex) {
+    (*nodes_to_delete)[matched.scale] = true;
+  }
+  if (matched.mask != kMissingIndex) {
+    (*nodes_to_delete)[matched.mask] = true;
+  }
+
+  return OkStatus();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -4078,6 +4409,27 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap Unique+Gather+SparseSegment{Sum,Mean,SqrtN} into a
+    // SparseSegment{Sum,Mean,SqrtN} of the original ids.
+    SparseSegmentReductionWithGather sparse_segment_reduction;
+    if (FindSparseSegmentReductionWithGather(ctx, i,
+                                             &sparse_segment_reduction)) {
+      TF_RETURN_IF_ERROR(AddSparseSegmentReductionNode(
+          &ctx, sparse_segment_reduction, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
+    // Remap BatchMatMul+[Mul]+[AddV2]+Softmax+BatchMatMul into the
+    // _FusedMultiHeadAttention.
+    MultiHeadAttention multi_head_attention;
+    if (allow_non_differentiable_rewrites &&
+        FindMultiHeadAttention(&ctx, i, &multi_head_attention)) {
+      TF_RETURN_IF_ERROR(AddMultiHeadAttentionNode(
+          &ctx, multi_head_attention, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
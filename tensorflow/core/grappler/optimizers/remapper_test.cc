@@ -2442,6 +2442,224 @@ TEST_F(RemapperFusePadWithFusedConv3D, FusedConv3D_BF16) {
 }
 #endif
 
+class RemapperSparseSegmentReductionTest : public RemapperTest {
+ public:
+  template <typename Reduction>
+  void RunTest(const string& op) {
+    using ::tensorflow::ops::Placeholder;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto params = Placeholder(s.WithOpName("params"), DT_FLOAT,
+                              ops::Placeholder::Shape({10, 4}));
+    auto ids = ops::Const<int64_t>(s.WithOpName("ids"), {3, 7, 3, 0, 7}, {5});
+    auto segment_ids =
+        ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 2, 2}, {5});
+    auto unique = ops::Unique(s.WithOpName("unique"), ids);
+    auto axis = ops::Const(s.WithOpName("axis"), 0);
+    auto gather =
+        ops::GatherV2(s.WithOpName("gather"), params, unique.y, axis);
+    auto reduction =
+        Reduction(s.WithOpName("reduction"), gather, unique.idx, segment_ids);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), reduction);
+
+    auto params_t = GenerateRandomTensor<DT_FLOAT>({10, 4});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"params", params_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "gather");
+      EXPECT_NE(node.name(), "unique");
+      if (node.name() == "reduction") {
+        EXPECT_EQ(node.op(), op);
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "params");
+        EXPECT_EQ(node.input(1), "ids");
+        EXPECT_EQ(node.input(2), "segment_ids");
+        EXPECT_EQ(node.attr().at("Tidx").type(), DT_INT64);
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+  }
+};
+
+TEST_F(RemapperSparseSegmentReductionTest, Sum) {
+  RunTest<ops::SparseSegmentSum>("SparseSegmentSum");
+}
+
+TEST_F(RemapperSparseSegmentReductionTest, Mean) {
+  RunTest<ops::SparseSegmentMean>("SparseSegmentMean");
+}
+
+TEST_F(RemapperSparseSegmentReductionTest, SqrtN) {
+  RunTest<ops::SparseSegmentSqrtN>("SparseSegmentSqrtN");
+}
+
+TEST_F(RemapperSparseSegmentReductionTest, UniqueWithOtherUsesIsKept) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto params = ops::Placeholder(s.WithOpName("params"), DT_FLOAT,
+                                 ops::Placeholder::Shape({10, 4}));
+  auto ids = ops::Const(s.WithOpName("ids"), {3, 7, 3}, {3});
+  auto segment_ids = ops::Const(s.WithOpName("segment_ids"), {0, 1, 1}, {3});
+  auto unique = ops::Unique(s.WithOpName("unique"), ids);
+  auto axis = ops::Const(s.WithOpName("axis"), 0);
+  auto gather = ops::GatherV2(s.WithOpName("gather"), params, unique.y, axis);
+  auto reduction = ops::SparseSegmentSum(s.WithOpName("reduction"), gather,
+                                         unique.idx, segment_ids);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), reduction);
+  auto other = ops::Identity(s.WithOpName("other"), unique.y);
+
+  GrapplerItem item;
+  item.fetch = {"fetch", "other"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "gather");
+    if (node.name() == "unique") {
+      found++;
+    } else if (node.name() == "reduction") {
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "params");
+      EXPECT_EQ(node.input(1), "ids");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+}
+
+class RemapperMultiHeadAttentionTest : public RemapperTest {
+ public:
+  void RunTest(bool with_mask) {
+    using ::tensorflow::ops::Placeholder;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                             ops::Placeholder::Shape({2, 4, 40, 16}));
+    auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 4, 70, 16}));
+    auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                             ops::Placeholder::Shape({2, 4, 70, 8}));
+    auto mask = Placeholder(s.WithOpName("mask"), DT_FLOAT,
+                            ops::Placeholder::Shape({2, 1, 1, 70}));
+    auto scores =
+        ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                           ops::BatchMatMulV2::Attrs().AdjY(true));
+    auto scale = ops::Const(s.WithOpName("scale"), 0.25f);
+    Output logits = ops::Mul(s.WithOpName("scaled"), scores, scale);
+    if (with_mask) logits = ops::AddV2(s.WithOpName("masked"), mask, logits);
+    auto softmax = ops::Softmax(s.WithOpName("softmax"), logits);
+    auto attention =
+        ops::BatchMatMulV2(s.WithOpName("attention"), softmax, value);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"query", GenerateRandomTensor<DT_FLOAT>({2, 4, 40, 16})},
+                 {"key", GenerateRandomTensor<DT_FLOAT>({2, 4, 70, 16})},
+                 {"value", GenerateRandomTensor<DT_FLOAT>({2, 4, 70, 8})},
+                 {"mask", GenerateRandomTensor<DT_FLOAT>({2, 1, 1, 70})}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "scores");
+      EXPECT_NE(node.name(), "softmax");
+      if (node.name() == "attention") {
+        EXPECT_EQ(node.op(), "_FusedMultiHeadAttention");
+        ASSERT_EQ(node.input_size(), with_mask ? 4 : 3);
+        EXPECT_EQ(node.input(0), "query");
+        EXPECT_EQ(node.input(1), "key");
+        EXPECT_EQ(node.input(2), "value");
+        if (with_mask) EXPECT_EQ(node.input(3), "mask");
+        EXPECT_EQ(node.attr().at("num_args").i(), with_mask ? 1 : 0);
+        EXPECT_EQ(node.attr().at("scale").f(), 0.25f);
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+  }
+};
+
+TEST_F(RemapperMultiHeadAttentionTest, ScaledScores) { RunTest(false); }
+
+TEST_F(RemapperMultiHeadAttentionTest, ScaledAndMaskedScores) {
+  RunTest(true);
+}
+
+TEST_F(RemapperMultiHeadAttentionTest, BroadcastBatchIsNotFused) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto query = ops::Placeholder(s.WithOpName("query"), DT_FLOAT,
+                                ops::Placeholder::Shape({2, 40, 16}));
+  auto key = ops::Placeholder(s.WithOpName("key"), DT_FLOAT,
+                              ops::Placeholder::Shape({1, 70, 16}));
+  auto value = ops::Placeholder(s.WithOpName("value"), DT_FLOAT,
+                                ops::Placeholder::Shape({1, 70, 8}));
+  auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                                   ops::BatchMatMulV2::Attrs().AdjY(true));
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), scores);
+  auto attention =
+      ops::BatchMatMulV2(s.WithOpName("attention"), softmax, value);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedMultiHeadAttention");
+  }
+}
+
 class RemapperLeakyReluTest : public GrapplerTest {
  protected:
   template <DataType DTYPE>
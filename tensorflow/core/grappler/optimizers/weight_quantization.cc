@@ -0,0 +1,274 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/weight_quantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Weights with fewer elements are left in float: they don't contribute much to
+// the memory footprint, and the quantized kernels don't pay off on them.
+constexpr int64_t kMinNumWeightElements = 64 * 1024;
+
+constexpr float kMaxQuantizedValue = 127.0f;
+
+// Returns the dimension of the weights of `node` that holds the output
+// channels, or -1 if `node` can't use quantized weights.
+int OutputChannelDim(const NodeDef& node) {
+  if (GetDataTypeFromAttr(node, "T") != DT_FLOAT) return -1;
+  if (IsMatMul(node)) {
+    bool transpose_b = false;
+    if (!TryGetNodeAttr(node, "transpose_b", &transpose_b)) return -1;
+    return transpose_b ? 0 : 1;
+  }
+  if (IsConv2D(node)) {
+    // The quantized convolution only has a CPU kernel, which only supports
+    // NHWC.
+    string data_format = "NHWC";
+    TryGetNodeAttr(node, "data_format", &data_format);
+    return data_format == "NHWC" ? 3 : -1;
+  }
+  return -1;
+}
+
+// Returns the constant float weights of `node` if they are large enough to be
+// quantized.
+const NodeDef* GetQuantizableWeights(
+    const NodeDef& node,
+    const absl::flat_hash_map<string, const NodeDef*>& nodes_by_name,
+    const absl::flat_hash_set<string>& nodes_to_preserve) {
+  if (node.input_size() < 2 || IsControlInput(node.input(1))) return nullptr;
+  int position;
+  const string weights_name = ParseNodeName(node.input(1), &position);
+  if (position != 0) return nullptr;
+  auto it = nodes_by_name.find(weights_name);
+  if (it == nodes_by_name.end()) return nullptr;
+  const NodeDef* weights = it->second;
+  if (!IsConstant(*weights) || nodes_to_preserve.contains(weights_name) ||
+      GetDataTypeFromAttr(*weights, "dtype") != DT_FLOAT ||
+      weights->attr().count("value") == 0) {
+    return nullptr;
+  }
+  const TensorShapeProto& shape =
+      weights->attr().at("value").tensor().tensor_shape();
+  if (shape.dim_size() != (IsMatMul(node) ? 2 : 4)) return nullptr;
+  int64_t num_elements = 1;
+  for (const auto& dim : shape.dim()) num_elements *= dim.size();
+  return num_elements >= kMinNumWeightElements ? weights : nullptr;
+}
+
+// Quantizes `weights` to int8 with a symmetric scale for every index of
+// dimension `channel_dim`.
+void QuantizePerChannel(const Tensor& weights, int channel_dim,
+                        Tensor* values, Tensor* scales) {
+  const int64_t num_channels = weights.dim_size(channel_dim);
+  int64_t outer_size = 1;
+  for (int i = 0; i < channel_dim; ++i) outer_size *= weights.dim_size(i);
+  const int64_t inner_size =
+      weights.NumElements() / (outer_size * num_channels);
+  auto input =
+      weights.shaped<float, 3>({outer_size, num_channels, inner_size});
+
+  *scales = Tensor(DT_FLOAT, TensorShape({num_channels}));
+  auto scale = scales->vec<float>();
+  for (int64_t c = 0; c < num_channels; ++c) {
+    float max_abs = 0.0f;
+    for (int64_t i = 0; i < outer_size; ++i) {
+      for (int64_t j = 0; j < inner_size; ++j) {
+        max_abs = std::max(max_abs, std::abs(input(i, c, j)));
+      }
+    }
+    scale(c) = max_abs / kMaxQuantizedValue;
+  }
+
+  *values = Tensor(DT_INT8, weights.shape());
+  auto output = values->shaped<int8, 3>({outer_size, num_channels, inner_size});
+  for (int64_t i = 0; i < outer_size; ++i) {
+    for (int64_t c = 0; c < num_channels; ++c) {
+      for (int64_t j = 0; j < inner_size; ++j) {
+        const float quantized =
+            scale(c) == 0.0f ? 0.0f : std::round(input(i, c, j) / scale(c));
+        output(i, c, j) = static_cast<int8>(std::min(
+            kMaxQuantizedValue, std::max(-kMaxQuantizedValue, quantized)));
+      }
+    }
+  }
+}
+
+void MakeConstNode(const string& name, const string& device,
+                   const Tensor& value, NodeDef* node) {
+  node->set_name(name);
+  node->set_op("Const");
+  node->set_device(device);
+  SetAttrValue(value.dtype(), &(*node->mutable_attr())["dtype"]);
+  value.AsProtoTensorContent(
+      (*node->mutable_attr())["value"].mutable_tensor());
+}
+
+// Switches `node` to its quantized variant reading `values` and `scales`, and
+// drops the attributes the quantized op doesn't have.
+void RewriteToQuantizedOp(const string& values, const string& scales,
+                          NodeDef* node) {
+  static const auto* const kQuantizedMatMulAttrs =
+      new absl::flat_hash_set<string>{"T", "transpose_a", "transpose_b"};
+  static const auto* const kQuantizedConv2DAttrs =
+      new absl::flat_hash_set<string>{"T",           "strides",
+                                      "padding",     "explicit_paddings",
+                                      "data_format", "dilations"};
+  const absl::flat_hash_set<string>* attrs;
+  if (IsMatMul(*node)) {
+    node->set_op("_WeightOnlyQuantizedMatMul");
+    attrs = kQuantizedMatMulAttrs;
+  } else {
+    node->set_op("_WeightOnlyQuantizedConv2D");
+    attrs = kQuantizedConv2DAttrs;
+  }
+  std::vector<string> attrs_to_remove;
+  for (const auto& attr : node->attr()) {
+    if (!attrs->contains(attr.first) && attr.first[0] != '_') {
+      attrs_to_remove.push_back(attr.first);
+    }
+  }
+  for (const string& attr : attrs_to_remove) {
+    node->mutable_attr()->erase(attr);
+  }
+
+  node->set_input(1, values);
+  node->add_input(scales);
+  // Keep the control inputs after the regular ones.
+  for (int i = node->input_size() - 1; i > 2; --i) {
+    node->mutable_input()->SwapElements(i, i - 1);
+  }
+}
+
+}  // namespace
+
+Status WeightQuantization::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                    GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+
+  // Unplaced nodes can only be rewritten if they will end up on a CPU, as the
+  // quantized ops have no GPU kernels.
+  bool has_non_cpu_devices = false;
+  for (const string& device : item.devices()) {
+    DeviceNameUtils::ParsedName parsed_name;
+    if (DeviceNameUtils::ParseFullName(device, &parsed_name) &&
+        parsed_name.type != DEVICE_CPU) {
+      has_non_cpu_devices = true;
+    }
+  }
+
+  const absl::flat_hash_set<string> nodes_to_preserve =
+      item.NodesToPreserve();
+  absl::flat_hash_map<string, const NodeDef*> nodes_by_name;
+  absl::flat_hash_map<string, int> num_fanouts;
+  for (const NodeDef& node : optimized_graph->node()) {
+    nodes_by_name[node.name()] = &node;
+    for (const string& input : node.input()) {
+      ++num_fanouts[NodeName(input)];
+    }
+  }
+
+  // The int8 values and scales created for a weights node and channel
+  // dimension, which are shared by all the nodes using the same weights.
+  absl::flat_hash_map<std::pair<string, int>, std::pair<string, string>>
+      quantized_weights;
+  std::vector<NodeDef> new_nodes;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    if (nodes_to_preserve.contains(node.name())) continue;
+    if (!NodeIsOnCpu(&node) &&
+        !(node.device().empty() && !has_non_cpu_devices)) {
+      continue;
+    }
+    const int channel_dim = OutputChannelDim(node);
+    if (channel_dim < 0) continue;
+    const NodeDef* weights =
+        GetQuantizableWeights(node, nodes_by_name, nodes_to_preserve);
+    if (weights == nullptr) continue;
+
+    const auto key = std::make_pair(weights->name(), channel_dim);
+    auto it = quantized_weights.find(key);
+    if (it == quantized_weights.end()) {
+      Tensor value;
+      if (!value.FromProto(weights->attr().at("value").tensor())) continue;
+      const string prefix = strings::StrCat(
+          weights->name(), "/weight_quantization_", channel_dim);
+      const string values_name = strings::StrCat(prefix, "/values");
+      const string scales_name = strings::StrCat(prefix, "/scales");
+      if (nodes_by_name.contains(values_name) ||
+          nodes_by_name.contains(scales_name)) {
+        continue;
+      }
+      Tensor values, scales;
+      QuantizePerChannel(value, channel_dim, &values, &scales);
+      new_nodes.emplace_back();
+      MakeConstNode(values_name, weights->device(), values, &new_nodes.back());
+      new_nodes.emplace_back();
+      MakeConstNode(scales_name, weights->device(), scales, &new_nodes.back());
+      it = quantized_weights
+               .emplace(key, std::make_pair(values_name, scales_name))
+               .first;
+    }
+    VLOG(2) << "Quantizing the weights " << weights->name() << " of "
+            << node.name();
+    --num_fanouts[weights->name()];
+    RewriteToQuantizedOp(it->second.first, it->second.second, &node);
+  }
+  if (quantized_weights.empty()) return OkStatus();
+
+  // Remove the float weights that are no longer used.
+  absl::flat_hash_set<string> unused_weights;
+  for (const auto& quantized : quantized_weights) {
+    const string& name = quantized.first.first;
+    if (num_fanouts[name] == 0) unused_weights.insert(name);
+  }
+  std::set<int> nodes_to_delete;
+  for (int i = 0; i < optimized_graph->node_size(); ++i) {
+    if (unused_weights.contains(optimized_graph->node(i).name())) {
+      nodes_to_delete.insert(i);
+    }
+  }
+  EraseNodesFromGraph(nodes_to_delete, optimized_graph);
+  for (NodeDef& node : new_nodes) {
+    optimized_graph->add_node()->Swap(&node);
+  }
+  return OkStatus();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,51 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_WEIGHT_QUANTIZATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_WEIGHT_QUANTIZATION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Quantizes the large constant float weights of CPU MatMuls and Conv2Ds to
+// int8 with one symmetric scale per output channel, to reduce the memory
+// footprint and bandwidth of CPU inference graphs.
+//
+// MatMul and Conv2D are rewritten to _WeightOnlyQuantizedMatMul and
+// _WeightOnlyQuantizedConv2D, which take the int8 weights and the float
+// scales, and dequantize the weights inside the kernel. Activations stay in
+// float, so no calibration is needed. The original weights are removed from
+// the graph when no other node uses them.
+class WeightQuantization : public GraphOptimizer {
+ public:
+  WeightQuantization() {}
+  explicit WeightQuantization(RewriterConfig::Toggle opt_level) {}
+
+  ~WeightQuantization() override {}
+
+  string name() const override { return "weight_quantization"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_WEIGHT_QUANTIZATION_H_
@@ -0,0 +1,188 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/weight_quantization.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class WeightQuantizationTest : public GrapplerTest {
+ protected:
+  const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+};
+
+TEST_F(WeightQuantizationTest, QuantizeMatMulWeights) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({4, 256}));
+  Output w = ops::Const(s.WithOpName("w"), Input::Initializer(
+                            GenerateRandomTensor<DT_FLOAT>({256, 256})));
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), x, w);
+  Output out = ops::Identity(s.WithOpName("out"), matmul);
+
+  GrapplerItem item;
+  item.fetch = {"out"};
+  item.feed = {{"x", GenerateRandomTensor<DT_FLOAT>({4, 256})}};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  WeightQuantization optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(nullptr, FindNode(output, "w"));
+  const NodeDef* node = FindNode(output, "matmul");
+  ASSERT_NE(nullptr, node);
+  EXPECT_EQ("_WeightOnlyQuantizedMatMul", node->op());
+  ASSERT_EQ(3, node->input_size());
+  EXPECT_EQ("x", node->input(0));
+  EXPECT_EQ("w/weight_quantization_1/values", node->input(1));
+  EXPECT_EQ("w/weight_quantization_1/scales", node->input(2));
+  const NodeDef* values = FindNode(output, node->input(1));
+  ASSERT_NE(nullptr, values);
+  EXPECT_EQ(DT_INT8, values->attr().at("dtype").type());
+  const NodeDef* scales = FindNode(output, node->input(2));
+  ASSERT_NE(nullptr, scales);
+  const TensorShapeProto& scales_shape =
+      scales->attr().at("value").tensor().tensor_shape();
+  ASSERT_EQ(1, scales_shape.dim_size());
+  EXPECT_EQ(256, scales_shape.dim(0).size());
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(1, tensors_expected.size());
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 0.15);
+}
+
+TEST_F(WeightQuantizationTest, QuantizeSharedWeights) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({4, 256}));
+  Output w = ops::Const(s.WithOpName("w"), Input::Initializer(
+                            GenerateRandomTensor<DT_FLOAT>({256, 256})));
+  Output matmul1 = ops::MatMul(s.WithOpName("matmul1"), x, w);
+  Output matmul2 = ops::MatMul(s.WithOpName("matmul2"), x, w);
+  Output matmul3 = ops::MatMul(s.WithOpName("matmul3"), x, w,
+                               ops::MatMul::TransposeB(true));
+  Output w_norm = ops::L2Loss(s.WithOpName("w_norm"), w);
+  Output out = ops::AddN(s.WithOpName("out"), {matmul1, matmul2, matmul3});
+
+  GrapplerItem item;
+  item.fetch = {"out", "w_norm"};
+  item.feed = {{"x", GenerateRandomTensor<DT_FLOAT>({4, 256})}};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  WeightQuantization optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The float weights are still used by w_norm.
+  EXPECT_NE(nullptr, FindNode(output, "w"));
+  // The MatMuls with the same output channels share the quantized weights.
+  for (const string& name : {"matmul1", "matmul2", "matmul3"}) {
+    const NodeDef* node = FindNode(output, name);
+    ASSERT_NE(nullptr, node);
+    EXPECT_EQ("_WeightOnlyQuantizedMatMul", node->op());
+    ASSERT_EQ(3, node->input_size());
+    EXPECT_EQ(name == "matmul3" ? "w/weight_quantization_0/values"
+                                : "w/weight_quantization_1/values",
+              node->input(1));
+  }
+  EXPECT_EQ(item.graph.node_size() + 4, output.node_size());
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(2, tensors_expected.size());
+  ASSERT_EQ(2, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 0.3);
+  test::ExpectTensorEqual<float>(tensors_expected[1], tensors[1]);
+}
+
+TEST_F(WeightQuantizationTest, QuantizeConv2DWeights) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({1, 8, 8, 64}));
+  Output filter =
+      ops::Const(s.WithOpName("filter"),
+                 Input::Initializer(
+                     GenerateRandomTensor<DT_FLOAT>({3, 3, 64, 128})));
+  Output conv = ops::Conv2D(s.WithOpName("conv"), x, filter, {1, 1, 1, 1},
+                            "SAME");
+  Output out = ops::Identity(s.WithOpName("out"), conv);
+
+  GrapplerItem item;
+  item.fetch = {"out"};
+  item.feed = {{"x", GenerateRandomTensor<DT_FLOAT>({1, 8, 8, 64})}};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  WeightQuantization optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(nullptr, FindNode(output, "filter"));
+  const NodeDef* node = FindNode(output, "conv");
+  ASSERT_NE(nullptr, node);
+  EXPECT_EQ("_WeightOnlyQuantizedConv2D", node->op());
+  ASSERT_EQ(3, node->input_size());
+  EXPECT_EQ("filter/weight_quantization_3/values", node->input(1));
+  EXPECT_EQ("filter/weight_quantization_3/scales", node->input(2));
+  EXPECT_EQ(0, node->attr().count("use_cudnn_on_gpu"));
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(1, tensors_expected.size());
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 0.2);
+}
+
+TEST_F(WeightQuantizationTest, SkipSmallAndGpuWeights) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({4, 256}));
+  Output small_w = ops::Const(s.WithOpName("small_w"), 1.0f, {256, 16});
+  Output small = ops::MatMul(s.WithOpName("small"), x, small_w);
+  Output gpu_w = ops::Const(s.WithOpName("gpu_w"), 1.0f, {256, 256});
+  Output gpu =
+      ops::MatMul(s.WithOpName("gpu").WithDevice("/device:GPU:0"), x, gpu_w);
+  Output small_out = ops::Identity(s.WithOpName("small_out"), small);
+  Output gpu_out = ops::Identity(s.WithOpName("gpu_out"), gpu);
+
+  GrapplerItem item;
+  item.fetch = {"small_out", "gpu_out"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  WeightQuantization optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  CompareGraphs(item.graph, output);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
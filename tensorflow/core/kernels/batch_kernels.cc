@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/numbers.h"
 #include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace {
@@ -151,6 +152,7 @@ class BatchResource : public serving::BatchResourceBase {
                                allowed_batch_sizes,
                                enable_large_batch_splitting),
         allowed_batch_sizes));
+    TF_RETURN_IF_ERROR(MaybeEnableBatchSizeCostModel(resource->get()));
     return OkStatus();
   }
 
@@ -171,12 +173,27 @@ class BatchResource : public serving::BatchResourceBase {
             max_batch_size, batch_timeout_micros, max_enqueued_batches,
             true /* enable large batch split */, allowed_batch_sizes),
         allowed_batch_sizes));
+    TF_RETURN_IF_ERROR(MaybeEnableBatchSizeCostModel(resource->get()));
     return OkStatus();
   }
 
   string DebugString() const final { return "BatchResource"; }
 
  private:
+  // Enables the batch size cost model when
+  // TF_BATCHING_ENABLE_BATCH_SIZE_COST_MODEL is set.
+  static Status MaybeEnableBatchSizeCostModel(BatchResource* resource) {
+    bool enable_batch_size_cost_model = false;
+    TF_RETURN_IF_ERROR(
+        ReadBoolFromEnvVar("TF_BATCHING_ENABLE_BATCH_SIZE_COST_MODEL",
+                           /*default_val=*/false,
+                           &enable_batch_size_cost_model));
+    if (enable_batch_size_cost_model) {
+      resource->EnableBatchSizeCostModel();
+    }
+    return OkStatus();
+  }
+
   BatchResource(FunctionLibraryRuntime::Handle fhandle,
                 FunctionLibraryRuntime* flib, std::shared_ptr<BatcherT> batcher,
                 const BatcherT::QueueOptions& batcher_queue_options,
@@ -257,6 +274,10 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
     has_attribute_enable_large_batch_splitting_ = false;
   }
 
+  if (c->HasAttr("ragged_inputs")) {
+    OP_REQUIRES_OK(c, c->GetAttr("ragged_inputs", &ragged_inputs_));
+  }
+
   // Helper function `SetAdaptiveBatchSchedulerOptions` calls
   // `OP_REQUIRES_OK`, which exits the current function upon error.
   // So validate status of `op-kernel-construction`.
@@ -281,6 +302,7 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
   }
 
   OP_REQUIRES_OK(c, ValidateAllowedBatchSizes());
+  OP_REQUIRES_OK(c, ValidateRaggedInputs(c));
 }
 
 bool BatchFunctionKernel::IsExpensive() { return false; }
@@ -333,6 +355,7 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           adaptive_shared_batch_scheduler_options, max_batch_size_,
           batch_timeout_micros_, max_enqueued_batches_, allowed_batch_sizes_,
           handle, flib_, &new_resource));
+      new_resource->SetRaggedInputs(ragged_inputs_);
       *r = new_resource.release();
       return OkStatus();
     };
@@ -343,6 +366,7 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           num_batch_threads_, max_batch_size_, batch_timeout_micros_,
           max_enqueued_batches_, allowed_batch_sizes_, handle, flib_,
           enable_large_batch_splitting_, &new_resource));
+      new_resource->SetRaggedInputs(ragged_inputs_);
       *r = new_resource.release();
       return OkStatus();
     };
@@ -460,6 +484,35 @@ Status BatchFunctionKernel::ValidateAllowedBatchSizes() const {
   return OkStatus();
 }
 
+Status BatchFunctionKernel::ValidateRaggedInputs(
+    OpKernelConstruction* c) const {
+  if (ragged_inputs_.empty()) {
+    return OkStatus();
+  }
+  DataTypeVector input_types;
+  TF_RETURN_IF_ERROR(c->GetAttr("Tin", &input_types));
+  std::vector<bool> is_ragged(input_types.size(), false);
+  for (const int32_t index : ragged_inputs_) {
+    if (index < 0 || index >= static_cast<int>(input_types.size())) {
+      return errors::InvalidArgument(
+          "ragged_inputs entry ", index,
+          " is not the index of an input; there are ", input_types.size(),
+          " inputs");
+    }
+    if (input_types[index] != DT_VARIANT) {
+      return errors::InvalidArgument("ragged input ", index,
+                                     " must be a variant tensor; got ",
+                                     DataTypeString(input_types[index]));
+    }
+    if (is_ragged[index]) {
+      return errors::InvalidArgument("ragged_inputs entry ", index,
+                                     " is repeated");
+    }
+    is_ragged[index] = true;
+  }
+  return OkStatus();
+}
+
 // Initialize vars by reading from op-kernel-construction.
 // Vars
 // - enable_adaptive_batch_threads_
@@ -63,6 +63,9 @@ class BatchFunctionKernel : public AsyncOpKernel {
   // to `max_batch_size_`.
   Status ValidateAllowedBatchSizes() const;
 
+  // Validates that 'ragged_inputs_' are distinct indices of variant inputs.
+  Status ValidateRaggedInputs(OpKernelConstruction* c) const;
+
   // Creates the function handle if it isn't initialized yet; and re-use it
   // afterwards.
   Status GetOrCreateFunctionHandle(OpKernelContext* c,
@@ -95,6 +98,7 @@ class BatchFunctionKernel : public AsyncOpKernel {
   bool enable_large_batch_splitting_;
   bool has_attribute_enable_large_batch_splitting_;
   bool enable_adaptive_batch_threads_ = false;
+  std::vector<int32> ragged_inputs_;
 
   mutex mu_;
 
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
 
+#include <algorithm>
 #include <sstream>
 
 #include "absl/strings/str_cat.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/kernels/batching_util/concat_split_util.h"
+#include "tensorflow/core/kernels/ragged_tensor_variant.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
@@ -342,6 +344,15 @@ Status BatchResourceBase::RegisterInput(
   return batcher_queue->Schedule(&batch_components);
 }
 
+void BatchResourceBase::EnableBatchSizeCostModel() {
+  batch_size_cost_model_ =
+      std::make_unique<BatchSizeCostModel>(allowed_batch_sizes_);
+}
+
+void BatchResourceBase::SetRaggedInputs(std::vector<int32> ragged_inputs) {
+  ragged_inputs_ = std::move(ragged_inputs);
+}
+
 /*static*/ BatchResourceBase::BatcherT::QueueOptions
 BatchResourceBase::GetBatcherQueueOptions(
     int32_t num_batch_threads, int32_t max_batch_size,
@@ -465,6 +476,13 @@ Status BatchResourceBase::ConcatInputTensors(
 
   // Process each input one at a time (the typical case has just one).
   for (int i = 0; i < num_inputs; ++i) {
+    if (std::find(ragged_inputs_.begin(), ragged_inputs_.end(), i) !=
+        ragged_inputs_.end()) {
+      TF_RETURN_IF_ERROR(ConcatRaggedInput(batch, i, padded_batch_size,
+                                           context, concatenated_tensors));
+      continue;
+    }
+
     // Concatenate the tasks ith input tensors into a big output tensor.
     std::vector<Tensor> to_concatenate;
     to_concatenate.reserve(batch.num_tasks());
@@ -502,6 +520,55 @@ Status BatchResourceBase::ConcatInputTensors(
   return OkStatus();
 }
 
+/*static*/ Status BatchResourceBase::ConcatRaggedInput(
+    const BatchT& batch, int input_index, int padded_batch_size,
+    OpKernelContext* context, std::vector<Tensor>* concatenated_tensors) {
+  Tensor row_splits(DT_INT64, TensorShape({padded_batch_size + 1}));
+  auto row_splits_vec = row_splits.vec<int64_t>();
+  row_splits_vec(0) = 0;
+  int row = 0;
+  std::vector<Tensor> to_concatenate;
+  to_concatenate.reserve(batch.size());
+  for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
+    const Tensor& input = batch.task(task_idx).inputs.at(input_index);
+    if (input.dtype() != DT_VARIANT || input.dims() != 1) {
+      return errors::InvalidArgument(
+          "Ragged input ", input_index,
+          " must be a 1-D variant tensor with one RaggedTensorVariant per row; "
+          "got ",
+          DataTypeString(input.dtype()), " tensor of shape ",
+          input.shape().DebugString(), ".");
+    }
+    const auto encoded_rows = input.vec<Variant>();
+    for (int j = 0; j < encoded_rows.size(); ++j) {
+      const RaggedTensorVariant* decoded =
+          encoded_rows(j).get<RaggedTensorVariant>();
+      if (decoded == nullptr || decoded->ragged_rank() != 0 ||
+          decoded->values().dims() == 0) {
+        return errors::InvalidArgument(
+            "Rows of ragged input ", input_index,
+            " must hold a RaggedTensorVariant of ragged rank 0 with at least "
+            "one dimension; got ",
+            encoded_rows(j).DebugString());
+      }
+      to_concatenate.push_back(decoded->values());
+      row_splits_vec(row + 1) =
+          row_splits_vec(row) + decoded->values().dim_size(0);
+      ++row;
+    }
+  }
+  // Padding rows are empty.
+  for (; row < padded_batch_size; ++row) {
+    row_splits_vec(row + 1) = row_splits_vec(row);
+  }
+
+  Tensor values;
+  TF_RETURN_IF_ERROR(Concat(context, to_concatenate, &values));
+  concatenated_tensors->push_back(std::move(values));
+  concatenated_tensors->push_back(std::move(row_splits));
+  return OkStatus();
+}
+
 /*static*/ Status BatchResourceBase::SplitInputTask(
     std::unique_ptr<BatchTask>* input_task_ptr, int open_batch_remaining_slot,
     int max_batch_size, std::vector<std::unique_ptr<BatchTask>>* output_tasks) {
@@ -751,8 +818,14 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   // Releases the cleanup method here, because the callback of the function
   // library runtime will handle it now.
   finally.release();
+  const uint64 execution_start_time = EnvTime::NowNanos();
   ProcessFuncBatchImpl(
       last_task, args, &combined_outputs, [&](const Status& run_status) {
+        if (batch_size_cost_model_ != nullptr && run_status.ok()) {
+          batch_size_cost_model_->RecordLatency(
+              processed_size,
+              (EnvTime::NowNanos() - execution_start_time) / 1000);
+        }
         Status final_status;
         auto run_finally = gtl::MakeCleanup([&]() {
           // We do the cleanup here as an optimization, so that
@@ -771,6 +844,34 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
       });
 }
 
+std::vector<std::unique_ptr<BatchResourceBase::BatchT>>
+BatchResourceBase::PartitionBatch(std::unique_ptr<BatchT> batch) const {
+  std::vector<int> task_sizes;
+  task_sizes.reserve(batch->num_tasks());
+  for (int i = 0; i < batch->num_tasks(); ++i) {
+    task_sizes.push_back(batch->task(i).size());
+  }
+  const std::vector<int> num_tasks_per_batch =
+      batch_size_cost_model_->PartitionTasks(task_sizes);
+
+  std::vector<std::unique_ptr<BatchT>> batches;
+  if (num_tasks_per_batch.size() <= 1) {
+    batches.push_back(std::move(batch));
+    return batches;
+  }
+  std::vector<std::unique_ptr<BatchTask>> tasks = batch->RemoveAllTasks();
+  int task_index = 0;
+  for (int num_tasks : num_tasks_per_batch) {
+    auto sub_batch = std::make_unique<BatchT>(batch->traceme_context_id());
+    for (int i = 0; i < num_tasks; ++i) {
+      sub_batch->AddTask(std::move(tasks[task_index++]));
+    }
+    sub_batch->Close();
+    batches.push_back(std::move(sub_batch));
+  }
+  return batches;
+}
+
 // Processes a batch of one or more BatchTask entries.
 void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
   if (batch->empty()) {
@@ -891,6 +992,11 @@ Status BatchResourceBase::LookupOrCreateBatcherQueue(const string& queue_name,
   auto process_batch_callback = [this](std::unique_ptr<BatchT> batch) {
     if (!has_process_batch_function_) {
       ProcessBatch(std::move(batch));
+    } else if (batch_size_cost_model_ != nullptr && !batch->empty()) {
+      // The sub-batches run one after another on this batch thread.
+      for (auto& sub_batch : PartitionBatch(std::move(batch))) {
+        ProcessFuncBatch(std::move(sub_batch));
+      }
     } else {
       ProcessFuncBatch(std::move(batch));
     }
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/batching_util/adaptive_shared_batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/batch_size_cost_model.h"
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/threadsafe_status.h"
 #include "tensorflow/core/platform/context.h"
@@ -52,6 +53,24 @@ class BatchResourceBase : public ResourceBase {
                        const string& batcher_queue_name,
                        AsyncOpKernel::DoneCallback done_callback);
 
+  // Lets each batch either be padded to an allowed batch size, or run as
+  // several smaller batches when that is estimated to lower the latency per
+  // request, based on the batch latencies measured so far (see
+  // BatchSizeCostModel). Only applies to resources with a batch processing
+  // function. Must be called before the first call to RegisterInput().
+  void EnableBatchSizeCostModel();
+
+  // Marks the inputs at 'ragged_inputs' as ragged. Each of them must be a 1-D
+  // variant tensor with one RaggedTensorVariant of ragged rank 0 per row, as
+  // produced by RaggedTensorToVariant with batched_input=true from a ragged
+  // tensor of ragged rank 1. Rather than concatenated as is, a ragged input is
+  // passed to the batch function as two tensors: the values of all rows packed
+  // along the 0th dimension, and the int64 row splits of the batch. Padding
+  // rows are empty, so they add no values. Only applies to resources with a
+  // batch processing function. Must be called before the first call to
+  // RegisterInput().
+  void SetRaggedInputs(std::vector<int32> ragged_inputs);
+
  public:
   // One task to be batched, corresponds to a `slice` of input from one batch-op
   // invocation.
@@ -220,11 +239,24 @@ class BatchResourceBase : public ResourceBase {
   Status ConcatInputTensors(const BatchT& batch, OpKernelContext* context,
                             std::vector<Tensor>* concatenated_tensors) const;
 
+  // Appends the packed values and row splits of the ragged input at
+  // 'input_index' of the tasks in 'batch', followed by empty rows up to
+  // 'padded_batch_size', to 'concatenated_tensors'.
+  static Status ConcatRaggedInput(const BatchT& batch, int input_index,
+                                  int padded_batch_size,
+                                  OpKernelContext* context,
+                                  std::vector<Tensor>* concatenated_tensors);
+
   Status SplitOutputTensors(const std::vector<Tensor>& combined_outputs,
                             BatchT* batch) const;
 
   void ProcessFuncBatch(std::unique_ptr<BatchT> batch) const;
 
+  // Splits the closed 'batch' into the consecutive sub-batches chosen by
+  // 'batch_size_cost_model_'.
+  std::vector<std::unique_ptr<BatchT>> PartitionBatch(
+      std::unique_ptr<BatchT> batch) const;
+
   // Processes a batch of one or more BatchTask entries.
   void ProcessBatch(std::unique_ptr<BatchT> batch) const;
 
@@ -264,6 +296,13 @@ class BatchResourceBase : public ResourceBase {
   // A concatenated string of <allowed_batch_sizes_>, separated by ",". This is
   // used to record batching parameter.
   string allowed_batch_sizes_str_;
+
+  // Learns batch latencies to choose how to run batches, if enabled by
+  // EnableBatchSizeCostModel().
+  std::unique_ptr<BatchSizeCostModel> batch_size_cost_model_;
+
+  // The indices of the ragged inputs (see SetRaggedInputs()).
+  std::vector<int32> ragged_inputs_;
 };
 
 }  // namespace serving
@@ -46,6 +46,15 @@ limitations under the License.
 namespace tensorflow {
 namespace serving {
 
+// The priority classes of batch tasks.
+enum class BatchTaskPriority {
+  // Throughput-oriented work (e.g. bulk inference) that may wait for, and
+  // fill up the leftover room in, batches of high-priority tasks.
+  kLow,
+  // Latency-sensitive work. This is the default.
+  kHigh,
+};
+
 // The abstract superclass for a unit of work to be done as part of a batch.
 //
 // An implementing subclass typically contains (or points to):
@@ -64,6 +73,16 @@ class BatchTask {
   // Returns the size of the task, in terms of how much it contributes to the
   // size of a batch. (A batch's size is the sum of its task sizes.)
   virtual size_t size() const = 0;
+
+  // Returns the priority class of the task. Schedulers that support priorities
+  // batch high-priority tasks ahead of low-priority ones; others ignore it.
+  virtual BatchTaskPriority priority() const {
+    return BatchTaskPriority::kHigh;
+  }
+
+  // Returns the time, in the microseconds of Env::NowMicros(), after which the
+  // task is no longer worth processing, or 0 if the task has no deadline.
+  virtual uint64 deadline_micros() const { return 0; }
 };
 
 // A thread-safe collection of BatchTasks, to be executed together in some
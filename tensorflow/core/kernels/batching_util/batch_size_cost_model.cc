@@ -0,0 +1,117 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_size_cost_model.h"
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace tensorflow {
+namespace serving {
+
+BatchSizeCostModel::BatchSizeCostModel(std::vector<int32> allowed_batch_sizes,
+                                       double smoothing)
+    : allowed_batch_sizes_(std::move(allowed_batch_sizes)),
+      smoothing_(smoothing) {}
+
+int BatchSizeCostModel::RoundToAllowedBatchSize(int batch_size) const {
+  for (int allowed_size : allowed_batch_sizes_) {
+    if (allowed_size >= batch_size) {
+      return allowed_size;
+    }
+  }
+  return batch_size;
+}
+
+void BatchSizeCostModel::RecordLatency(int processed_batch_size,
+                                       int64_t latency_micros) {
+  mutex_lock l(mu_);
+  auto it = latency_micros_.find(processed_batch_size);
+  if (it == latency_micros_.end()) {
+    latency_micros_[processed_batch_size] = latency_micros;
+    return;
+  }
+  it->second += smoothing_ * (latency_micros - it->second);
+}
+
+double BatchSizeCostModel::EstimateLatencyMicros(int batch_size) const {
+  mutex_lock l(mu_);
+  return EstimateLatencyMicrosLocked(batch_size);
+}
+
+double BatchSizeCostModel::EstimateLatencyMicrosLocked(int batch_size) const {
+  // The measured latency of the padded size, or else of the next larger
+  // measured size.
+  auto it = latency_micros_.lower_bound(RoundToAllowedBatchSize(batch_size));
+  if (it == latency_micros_.end()) {
+    return -1;
+  }
+  return it->second;
+}
+
+std::vector<int> BatchSizeCostModel::PartitionTasks(
+    const std::vector<int>& task_sizes) const {
+  const int num_tasks = task_sizes.size();
+  std::vector<int> offsets(num_tasks + 1, 0);
+  for (int i = 0; i < num_tasks; ++i) {
+    offsets[i + 1] = offsets[i] + task_sizes[i];
+  }
+  const int batch_size = offsets[num_tasks];
+  const std::vector<int> single_batch = {num_tasks};
+
+  mutex_lock l(mu_);
+  const double batch_latency = EstimateLatencyMicrosLocked(batch_size);
+  if (num_tasks <= 1 || batch_latency < 0) {
+    return single_batch;
+  }
+
+  // A sub-batch of tasks [j, k) delays the completion of all the requests from
+  // task j on, so the total latency of a partition is the sum over sub-batches
+  // of their latency times the number of requests from their first task on.
+  // min_latency[k] is the smallest such sum for the partitions of tasks [0, k),
+  // and first_task[k] the first task of the last sub-batch of that partition.
+  std::vector<double> min_latency(num_tasks + 1,
+                                  std::numeric_limits<double>::infinity());
+  std::vector<int> first_task(num_tasks + 1, 0);
+  min_latency[0] = 0;
+  for (int k = 1; k <= num_tasks; ++k) {
+    for (int j = 0; j < k; ++j) {
+      if (min_latency[j] == std::numeric_limits<double>::infinity()) continue;
+      const double latency =
+          EstimateLatencyMicrosLocked(offsets[k] - offsets[j]);
+      if (latency < 0) continue;
+      const double total =
+          min_latency[j] + latency * (batch_size - offsets[j]);
+      if (total < min_latency[k]) {
+        min_latency[k] = total;
+        first_task[k] = j;
+      }
+    }
+  }
+  if (!(min_latency[num_tasks] < batch_latency * batch_size)) {
+    return single_batch;
+  }
+
+  std::vector<int> num_tasks_per_batch;
+  for (int k = num_tasks; k > 0; k = first_task[k]) {
+    num_tasks_per_batch.insert(num_tasks_per_batch.begin(),
+                               k - first_task[k]);
+  }
+  return num_tasks_per_batch;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,86 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_COST_MODEL_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_COST_MODEL_H_
+
+#include <map>
+#include <vector>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Learns the execution latency of batches per (padded) batch size, and uses it
+// to decide whether a batch is better run as several smaller batches than
+// padded up to the next allowed batch size. For example, with allowed batch
+// sizes {1, 16, 32}, 17 requests can run as batches of 16 and 1 instead of one
+// batch of 32 whose last 15 rows are padding.
+//
+// A batch is split into consecutive sub-batches, run one after another, so the
+// sub-batches are chosen to minimize the sum over requests of the time until
+// their sub-batch completes. The latencies of sizes that have not been
+// measured yet are bounded by the latency of the next larger measured size,
+// i.e. latency is assumed not to decrease with the batch size; sizes without
+// such a bound are never chosen.
+//
+// Thread-safe.
+class BatchSizeCostModel {
+ public:
+  // `allowed_batch_sizes` is the (increasing) list of sizes batches are padded
+  // to; if empty, batches are not padded. `smoothing` is the weight of a new
+  // measurement in the moving average of the latency of a batch size.
+  explicit BatchSizeCostModel(std::vector<int32> allowed_batch_sizes,
+                              double smoothing = 0.2);
+
+  // Records that a batch padded to `processed_batch_size` took
+  // `latency_micros` to execute.
+  void RecordLatency(int processed_batch_size, int64_t latency_micros)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the estimated latency of a batch of `batch_size` once padded, or
+  // a negative value if it can't be estimated yet.
+  double EstimateLatencyMicros(int batch_size) const TF_LOCKS_EXCLUDED(mu_);
+
+  // Given the sizes of the tasks of a batch, in order, returns the number of
+  // consecutive tasks in each of the sub-batches the batch should be run as.
+  // Returns a single sub-batch with all tasks unless splitting is estimated to
+  // lower the latency per request.
+  std::vector<int> PartitionTasks(const std::vector<int>& task_sizes) const
+      TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Returns the smallest allowed batch size that is >= `batch_size`, or
+  // `batch_size` if there is none.
+  int RoundToAllowedBatchSize(int batch_size) const;
+
+  double EstimateLatencyMicrosLocked(int batch_size) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::vector<int32> allowed_batch_sizes_;
+  const double smoothing_;
+
+  mutable mutex mu_;
+  // The moving average of the measured latencies, keyed by padded batch size.
+  std::map<int, double> latency_micros_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_COST_MODEL_H_
@@ -0,0 +1,92 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_size_cost_model.h"
+
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(BatchSizeCostModelTest, EstimateLatency) {
+  BatchSizeCostModel model({1, 16, 32}, /*smoothing=*/0.5);
+  EXPECT_LT(model.EstimateLatencyMicros(17), 0);
+
+  model.RecordLatency(32, 100);
+  EXPECT_EQ(model.EstimateLatencyMicros(17), 100);
+  // Unmeasured sizes are bounded by larger measured ones.
+  EXPECT_EQ(model.EstimateLatencyMicros(1), 100);
+  EXPECT_LT(model.EstimateLatencyMicros(33), 0);
+
+  model.RecordLatency(32, 200);
+  EXPECT_EQ(model.EstimateLatencyMicros(32), 150);
+  model.RecordLatency(1, 10);
+  EXPECT_EQ(model.EstimateLatencyMicros(1), 10);
+}
+
+TEST(BatchSizeCostModelTest, SplitsWhenPaddingIsExpensive) {
+  BatchSizeCostModel model({1, 16, 32});
+  model.RecordLatency(1, 10);
+  model.RecordLatency(16, 50);
+  model.RecordLatency(32, 100);
+
+  // 16 + 1: 17 * 50 + 1 * 10 = 860 < 17 * 100.
+  EXPECT_THAT(model.PartitionTasks({4, 4, 4, 4, 1}), ElementsAre(4, 1));
+  // Without padding the compute is the same, but half of the requests
+  // complete earlier.
+  EXPECT_THAT(model.PartitionTasks({16, 16}), ElementsAre(1, 1));
+  EXPECT_THAT(model.PartitionTasks({16}), ElementsAre(1));
+}
+
+TEST(BatchSizeCostModelTest, KeepsBatchWhenPaddingIsCheap) {
+  BatchSizeCostModel model({1, 16, 32});
+  model.RecordLatency(1, 10);
+  model.RecordLatency(16, 50);
+  model.RecordLatency(32, 50);
+
+  EXPECT_THAT(model.PartitionTasks({16, 1}), ElementsAre(2));
+}
+
+TEST(BatchSizeCostModelTest, KeepsBatchWithoutMeasurements) {
+  BatchSizeCostModel model({1, 16, 32});
+  EXPECT_THAT(model.PartitionTasks({16, 1}), ElementsAre(2));
+
+  // Without a measurement of 32, the cost of not splitting is unknown.
+  model.RecordLatency(1, 10);
+  model.RecordLatency(16, 50);
+  EXPECT_THAT(model.PartitionTasks({16, 1}), ElementsAre(2));
+}
+
+TEST(BatchSizeCostModelTest, SplitsAtTaskBoundaries) {
+  BatchSizeCostModel model({8, 16, 32});
+  model.RecordLatency(8, 30);
+  model.RecordLatency(16, 50);
+  model.RecordLatency(32, 100);
+
+  // 10 + 10 rows can't run as 16 + 4 without splitting tasks; 10 + 10 pads
+  // both halves to 16, which is still cheaper than 32.
+  EXPECT_THAT(model.PartitionTasks({10, 10}), ElementsAre(1, 1));
+  // 16 + 8 + 1: 25 * 50 + 9 * 30 + 1 * 30 = 1550 < 25 * 100.
+  EXPECT_THAT(model.PartitionTasks({16, 8, 1}), ElementsAre(1, 1, 1));
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -100,6 +100,14 @@ namespace serving {
 // For bulk processing jobs and throughput-oriented benchmarks, you may want to
 // set the maximum queue size to a large value.
 //
+// When interactive and bulk traffic share a queue, the queue can be configured
+// to honor the priority class and deadline of each task (see
+// BatchTask::priority() and BatchTask::deadline_micros()). Low-priority tasks
+// are then held in a separate FIFO, and only batched when no batch of
+// high-priority tasks is ready, or to fill the leftover room in such a batch.
+// Tasks that are past their deadline when their batch is about to be processed
+// are handed back to the caller instead of being processed.
+//
 // TODO(b/26539183): Support queue servicing policies other than round-robin.
 // E.g. let each queue specify a "share" (an int >= 1), so e.g. with queues A
 // and B having shares 1 and 2 respectively, the servicing pattern is ABBABB...
@@ -218,6 +226,34 @@ class SharedBatchScheduler
     // submit batches whose size is in a small set of allowed sizes, that can be
     // done by adding padding in the process-batch callback.
     size_t max_execution_batch_size = 1000;
+
+    // If true, tasks whose priority() is BatchTaskPriority::kLow are kept apart
+    // from high-priority tasks: they are formed into batches of their own only
+    // when the queue has no high-priority batch to schedule. Not supported
+    // together with `enable_lazy_split`.
+    bool enable_priority_queue = false;
+
+    // The counterpart of `batch_timeout_micros` for low-priority batches, which
+    // are formed from the oldest low-priority tasks once the oldest one has
+    // waited this long. Only used if `enable_priority_queue` is true.
+    int64_t low_priority_batch_timeout_micros = 0;
+
+    // The counterpart of `max_enqueued_batches` for low-priority tasks: at most
+    // this many batches worth (of `max_execution_batch_size`) of low-priority
+    // tasks are enqueued. Only used if `enable_priority_queue` is true, in
+    // which case it must be positive.
+    size_t max_enqueued_low_priority_batches = 10;
+
+    // If true, the room left in a batch of high-priority tasks is filled with
+    // enqueued low-priority tasks, oldest first. Only used if
+    // `enable_priority_queue` is true.
+    bool pad_with_low_priority_tasks = false;
+
+    // If set, tasks whose deadline_micros() has passed by the time their batch
+    // is about to be processed are removed from the batch and handed to this
+    // callback (on the batch thread) instead of being processed. Batches left
+    // without tasks are not processed at all.
+    std::function<void(std::unique_ptr<TaskType>)> expired_task_callback;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -328,6 +364,10 @@ class Queue {
   // dequeued (out of mutex-protected area).
   Status ScheduleWithLazySplit(std::unique_ptr<TaskType>* task);
 
+  // Enqueue a low-priority `task` (see `QueueOptions.enable_priority_queue`),
+  // splitting it into tasks of at most `max_execution_batch_size` if needed.
+  Status ScheduleLowPriorityTask(std::unique_ptr<TaskType>* task);
+
   // Returns the number of enqueued tasks, with the same semantics as
   // BatchScheduler::NumEnqueuedTasks().
   size_t NumEnqueuedTasks() const;
@@ -354,7 +394,8 @@ class Queue {
   // Batches are guaranteed to form at task enqueue time.
   std::unique_ptr<Batch<TaskType>> ScheduleBatchWithEagerSplit();
 
-  // Processes a batch that has been returned earlier by ScheduleBatch().
+  // Processes a batch that has been returned earlier by ScheduleBatch(), after
+  // removing its expired tasks if `QueueOptions.expired_task_callback` is set.
   void ProcessBatch(std::unique_ptr<Batch<TaskType>> batch);
 
   // Determines whether the queue is empty, i.e. has no tasks waiting or being
@@ -421,6 +462,25 @@ class Queue {
   // Returns the number of enqueued batches.
   int64 num_enqueued_batches() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Determines whether enough low-priority tasks have been enqueued, or the
+  // oldest one has waited long enough, to form a low-priority batch.
+  bool IsLowPriorityBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Moves the oldest low-priority tasks that fit into `batch`, which is
+  // expected to be open, until it reaches `max_execution_batch_size`.
+  void AddLowPriorityTasks(Batch<TaskType>* batch)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns a closed batch with the tasks of the closed `batch` followed by the
+  // low-priority tasks that fit into it.
+  std::unique_ptr<Batch<TaskType>> PadWithLowPriorityTasks(
+      std::unique_ptr<Batch<TaskType>> batch) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the closed `batch` without the tasks that are past their deadline,
+  // which are handed to `QueueOptions.expired_task_callback`.
+  std::unique_ptr<Batch<TaskType>> RemoveExpiredTasks(
+      std::unique_ptr<Batch<TaskType>> batch);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -462,6 +522,18 @@ class Queue {
   std::deque<std::unique_ptr<Batch<BatchInputTaskHandle<TaskType>>>>
       task_handle_batches_ TF_GUARDED_BY(mu_);
 
+  // A low-priority task, and the time at which it was enqueued.
+  struct LowPriorityTask {
+    std::unique_ptr<TaskType> task;
+    uint64 enqueue_time_micros;
+  };
+
+  // The enqueued low-priority tasks, oldest first, and the sum of their sizes.
+  //
+  // Used iff `QueueOptions.enable_priority_queue` is true.
+  std::deque<LowPriorityTask> low_priority_tasks_ TF_GUARDED_BY(mu_);
+  size_t low_priority_tasks_size_ TF_GUARDED_BY(mu_) = 0;
+
   // The counter of the TraceMe context ids.
   uint64 traceme_context_id_counter_ TF_GUARDED_BY(mu_) = 0;
 
@@ -613,6 +685,23 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         options.max_execution_batch_size);
   }
 
+  if (options.enable_priority_queue) {
+    if (options.enable_lazy_split) {
+      return errors::InvalidArgument(
+          "enable_priority_queue is not supported with enable_lazy_split.");
+    }
+    if (options.max_enqueued_low_priority_batches == 0) {
+      return errors::InvalidArgument(
+          "max_enqueued_low_priority_batches must be positive; was ",
+          options.max_enqueued_low_priority_batches);
+    }
+    if (options.low_priority_batch_timeout_micros < 0) {
+      return errors::InvalidArgument(
+          "low_priority_batch_timeout_micros must be non-negative; was ",
+          options.low_priority_batch_timeout_micros);
+    }
+  }
+
   auto schedulable_batch_callback = [this] {
     mutex_lock l(mu_);
     schedulable_batch_cv_.notify_one();
@@ -796,6 +885,10 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
                                    " is larger than maximum input batch size ",
                                    options_.input_batch_size_limit);
   }
+  if (options_.enable_priority_queue &&
+      (*task)->priority() == BatchTaskPriority::kLow) {
+    return ScheduleLowPriorityTask(task);
+  }
   if (options_.enable_lazy_split) {
     return ScheduleWithLazySplit(std::move(task));
   }
@@ -939,6 +1032,64 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
   return OkStatus();
 }
 
+template <typename TaskType>
+Status Queue<TaskType>::ScheduleLowPriorityTask(
+    std::unique_ptr<TaskType>* task) {
+  profiler::TraceMe trace_me([task] {
+    return profiler::TraceMeEncode(
+        "ScheduleLowPriorityTask",
+        {{"batching_input_task_size", (*task)->size()}});
+  });
+
+  bool notify_of_schedulable_batch = false;
+  {
+    mutex_lock l(mu_);
+
+    DCHECK(!closed_);
+
+    const size_t capacity =
+        options_.max_enqueued_low_priority_batches * max_execution_batch_size();
+    if (low_priority_tasks_size_ + (*task)->size() > capacity) {
+      return errors::Unavailable(
+          "The low priority tasks of the batch scheduling queue to which this "
+          "task was submitted are full; task size is ",
+          (*task)->size(), " but scheduling capacity is only ",
+          capacity - low_priority_tasks_size_,
+          " (max_enqueued_low_priority_batches=",
+          options_.max_enqueued_low_priority_batches,
+          ", max_execution_batch_size=", max_execution_batch_size(), ")");
+    }
+
+    std::vector<std::unique_ptr<TaskType>> output_tasks;
+    if ((*task)->size() <= max_execution_batch_size()) {
+      output_tasks.push_back(std::move(*task));
+    } else {
+      // Only reachable with `enable_large_batch_splitting`, since the maximum
+      // input size is the maximum execution batch size otherwise.
+      TF_RETURN_IF_ERROR(options_.split_input_task_func(
+          task, max_execution_batch_size(), max_execution_batch_size(),
+          &output_tasks));
+    }
+
+    const uint64 now_micros = env_->NowMicros();
+    for (auto& output_task : output_tasks) {
+      low_priority_tasks_size_ += output_task->size();
+      low_priority_tasks_.push_back({std::move(output_task), now_micros});
+    }
+
+    if (!schedulable_batch_ && IsLowPriorityBatchSchedulable()) {
+      schedulable_batch_ = true;
+      notify_of_schedulable_batch = true;
+    }
+  }
+
+  if (notify_of_schedulable_batch) {
+    schedulable_batch_callback_();
+  }
+
+  return OkStatus();
+}
+
 template <typename TaskType>
 size_t Queue<TaskType>::NumEnqueuedTasks() const {
   size_t num_enqueued_tasks = 0;
@@ -953,7 +1104,7 @@ size_t Queue<TaskType>::NumEnqueuedTasks() const {
   for (const auto& batch : batches_) {
     num_enqueued_tasks += batch->num_tasks();
   }
-  return num_enqueued_tasks;
+  return num_enqueued_tasks + low_priority_tasks_.size();
 }
 
 template <typename TaskType>
@@ -1037,6 +1188,18 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
       ++num_batches_being_processed_;
       batch_to_schedule = std::move(batches_.front());
       batches_.pop_front();
+      if (options_.pad_with_low_priority_tasks) {
+        batch_to_schedule =
+            PadWithLowPriorityTasks(std::move(batch_to_schedule));
+      }
+    } else if (IsLowPriorityBatchSchedulable()) {
+      // High-priority tasks take precedence, so low-priority tasks are only
+      // batched when no high-priority batch is ready.
+      ++num_batches_being_processed_;
+      batch_to_schedule =
+          std::make_unique<Batch<TaskType>>(++traceme_context_id_counter_);
+      AddLowPriorityTasks(batch_to_schedule.get());
+      batch_to_schedule->Close();
     } else {
       schedulable_batch_ = false;
     }
@@ -1079,15 +1242,20 @@ Queue<TaskType>::ScheduleBatch() {
 
 template <typename TaskType>
 void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
-  profiler::TraceMeConsumer trace_me(
-      [&] {
-        return profiler::TraceMeEncode(
-            "ProcessBatch", {{"batch_size_before_padding", batch->size()},
-                             {"_r", 2} /*root_event*/});
-      },
-      profiler::ContextType::kSharedBatchScheduler,
-      batch->traceme_context_id());
-  process_batch_callback_(std::move(batch));
+  if (options_.expired_task_callback) {
+    batch = RemoveExpiredTasks(std::move(batch));
+  }
+  if (!batch->empty()) {
+    profiler::TraceMeConsumer trace_me(
+        [&] {
+          return profiler::TraceMeEncode(
+              "ProcessBatch", {{"batch_size_before_padding", batch->size()},
+                               {"_r", 2} /*root_event*/});
+        },
+        profiler::ContextType::kSharedBatchScheduler,
+        batch->traceme_context_id());
+    process_batch_callback_(std::move(batch));
+  }
 
   {
     mutex_lock l(mu_);
@@ -1128,7 +1296,7 @@ bool Queue<TaskType>::IsEmptyInternal() const {
            task_handle_batches_.back()->empty();
   }
   return num_batches_being_processed_ == 0 && batches_.size() == 1 &&
-         batches_.back()->empty();
+         batches_.back()->empty() && low_priority_tasks_.empty();
 }
 
 template <typename TaskType>
@@ -1197,6 +1365,74 @@ int64 Queue<TaskType>::num_enqueued_batches() const {
   return batches_.size();
 }
 
+template <typename TaskType>
+bool Queue<TaskType>::IsLowPriorityBatchSchedulable() const {
+  if (low_priority_tasks_.empty()) {
+    return false;
+  }
+  return closed_ || low_priority_tasks_size_ >= max_execution_batch_size() ||
+         env_->NowMicros() >= low_priority_tasks_.front().enqueue_time_micros +
+                                  options_.low_priority_batch_timeout_micros;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::AddLowPriorityTasks(Batch<TaskType>* batch) {
+  while (!low_priority_tasks_.empty() &&
+         batch->size() + low_priority_tasks_.front().task->size() <=
+             max_execution_batch_size()) {
+    low_priority_tasks_size_ -= low_priority_tasks_.front().task->size();
+    batch->AddTask(std::move(low_priority_tasks_.front().task));
+    low_priority_tasks_.pop_front();
+  }
+}
+
+template <typename TaskType>
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::PadWithLowPriorityTasks(
+    std::unique_ptr<Batch<TaskType>> batch) {
+  if (low_priority_tasks_.empty() ||
+      batch->size() >= max_execution_batch_size()) {
+    return batch;
+  }
+  // A closed batch can't take more tasks, so move them to a new one under the
+  // same TraceMe context.
+  auto padded_batch =
+      std::make_unique<Batch<TaskType>>(batch->traceme_context_id());
+  for (auto& task : batch->RemoveAllTasks()) {
+    padded_batch->AddTask(std::move(task));
+  }
+  AddLowPriorityTasks(padded_batch.get());
+  padded_batch->Close();
+  return padded_batch;
+}
+
+template <typename TaskType>
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::RemoveExpiredTasks(
+    std::unique_ptr<Batch<TaskType>> batch) {
+  const uint64 now_micros = env_->NowMicros();
+  auto is_expired = [now_micros](const TaskType& task) {
+    return task.deadline_micros() != 0 && task.deadline_micros() <= now_micros;
+  };
+  bool has_expired_task = false;
+  for (int i = 0; i < batch->num_tasks() && !has_expired_task; ++i) {
+    has_expired_task = is_expired(batch->task(i));
+  }
+  if (!has_expired_task) {
+    return batch;
+  }
+
+  auto live_batch =
+      std::make_unique<Batch<TaskType>>(batch->traceme_context_id());
+  for (auto& task : batch->RemoveAllTasks()) {
+    if (is_expired(*task)) {
+      options_.expired_task_callback(std::move(task));
+    } else {
+      live_batch->AddTask(std::move(task));
+    }
+  }
+  live_batch->Close();
+  return live_batch;
+}
+
 template <typename TaskType>
 QueueHandle<TaskType>::QueueHandle(
     std::shared_ptr<SharedBatchScheduler<TaskType>> scheduler,
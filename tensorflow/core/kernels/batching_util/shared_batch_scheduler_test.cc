@@ -44,14 +44,23 @@ using ::testing::HasSubstr;
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size,
+                    BatchTaskPriority priority = BatchTaskPriority::kHigh,
+                    uint64 deadline_micros = 0)
+      : size_(size), priority_(priority), deadline_micros_(deadline_micros) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  BatchTaskPriority priority() const override { return priority_; }
+
+  uint64 deadline_micros() const override { return deadline_micros_; }
+
  private:
   const size_t size_;
+  const BatchTaskPriority priority_;
+  const uint64 deadline_micros_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
 };
@@ -74,6 +83,17 @@ Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler) {
   return status;
 }
 
+// Like ScheduleTask(), with the given priority and deadline.
+Status ScheduleTask(size_t task_size, BatchTaskPriority priority,
+                    uint64 deadline_micros,
+                    BatchScheduler<FakeTask>* scheduler) {
+  std::unique_ptr<FakeTask> task(
+      new FakeTask(task_size, priority, deadline_micros));
+  Status status = scheduler->Schedule(&task);
+  CHECK_EQ(status.ok(), task == nullptr);
+  return status;
+}
+
 // Creates a thread that waits on 'start' and then advances the fake clock in
 // 'env' in a loop until 'stop' is notified. Useful for allowing objects that
 // use the clock to be destroyed.
@@ -793,6 +813,208 @@ TEST_P(SharedBatchSchedulerTest, ZeroQueueRewrittenToOneQueue) {
   }
 }
 
+// Creates QueueOptions for a queue that honors task priorities, with timeouts
+// that are only reached when the (fake) clock is advanced.
+QueueOptions CreatePriorityQueueOptions(size_t max_execution_batch_size,
+                                        bool pad_with_low_priority_tasks) {
+  QueueOptions options = CreateQueueOptions(
+      max_execution_batch_size, max_execution_batch_size,
+      /*batch_timeout_micros=*/0, /*max_enqueued_batches=*/2,
+      /*enable_large_batch_splitting=*/false, /*enable_lazy_split=*/false,
+      /*split_func=*/nullptr);
+  options.enable_priority_queue = true;
+  options.low_priority_batch_timeout_micros = 100;
+  options.pad_with_low_priority_tasks = pad_with_low_priority_tasks;
+  return options;
+}
+
+// Records the task sizes of the processed batches.
+class BatchRecorder {
+ public:
+  internal::Queue<FakeTask>::ProcessBatchCallback Callback() {
+    return [this](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      std::vector<size_t> sizes;
+      for (int i = 0; i < batch->num_tasks(); ++i) {
+        sizes.push_back(batch->task(i).size());
+      }
+      mutex_lock l(mu_);
+      batches_.push_back(sizes);
+    };
+  }
+
+  // Blocks until `num_batches` batches have been processed.
+  void WaitForBatches(size_t num_batches) {
+    while (true) {
+      {
+        mutex_lock l(mu_);
+        if (batches_.size() >= num_batches) return;
+      }
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+  }
+
+  std::vector<std::vector<size_t>> batches() {
+    mutex_lock l(mu_);
+    return batches_;
+  }
+
+ private:
+  mutex mu_;
+  std::vector<std::vector<size_t>> batches_ TF_GUARDED_BY(mu_);
+};
+
+TEST(SharedBatchSchedulerPriorityTest, HighPriorityTasksFirst) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  BatchRecorder recorder;
+  {
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    auto queue = CreateQueue(scheduler,
+                             CreatePriorityQueueOptions(
+                                 10, /*pad_with_low_priority_tasks=*/false),
+                             recorder.Callback());
+
+    // The low-priority tasks wait for their timeout, while the high-priority
+    // task is batched right away.
+    TF_ASSERT_OK(ScheduleTask(1, BatchTaskPriority::kLow, 0, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(2, BatchTaskPriority::kLow, 0, queue.get()));
+    EXPECT_EQ(queue->NumEnqueuedTasks(), 2);
+    TF_ASSERT_OK(ScheduleTask(3, BatchTaskPriority::kHigh, 0, queue.get()));
+    recorder.WaitForBatches(1);
+    EXPECT_EQ(recorder.batches(), (std::vector<std::vector<size_t>>{{3}}));
+
+    env.AdvanceByMicroseconds(100);
+    recorder.WaitForBatches(2);
+    EXPECT_EQ(recorder.batches(),
+              (std::vector<std::vector<size_t>>{{3}, {1, 2}}));
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerPriorityTest, PadsWithLowPriorityTasks) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  BatchRecorder recorder;
+  {
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    auto queue = CreateQueue(scheduler,
+                             CreatePriorityQueueOptions(
+                                 4, /*pad_with_low_priority_tasks=*/true),
+                             recorder.Callback());
+
+    TF_ASSERT_OK(ScheduleTask(1, BatchTaskPriority::kLow, 0, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(2, BatchTaskPriority::kLow, 0, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(2, BatchTaskPriority::kLow, 0, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(1, BatchTaskPriority::kHigh, 0, queue.get()));
+    recorder.WaitForBatches(1);
+    // The oldest low-priority tasks fill the high-priority batch.
+    EXPECT_EQ(recorder.batches(),
+              (std::vector<std::vector<size_t>>{{1, 1, 2}}));
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+  // Closing the queue flushes the remaining low-priority task.
+  EXPECT_EQ(recorder.batches(),
+            (std::vector<std::vector<size_t>>{{1, 1, 2}, {2}}));
+}
+
+TEST(SharedBatchSchedulerPriorityTest, LowPriorityCapacity) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  BatchRecorder recorder;
+  {
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions options =
+        CreatePriorityQueueOptions(4, /*pad_with_low_priority_tasks=*/false);
+    options.max_enqueued_low_priority_batches = 1;
+    auto queue = CreateQueue(scheduler, options, recorder.Callback());
+
+    TF_ASSERT_OK(ScheduleTask(3, BatchTaskPriority::kLow, 0, queue.get()));
+    EXPECT_THAT(ScheduleTask(2, BatchTaskPriority::kLow, 0, queue.get()),
+                testing::StatusIs(error::UNAVAILABLE));
+    // High-priority tasks have their own capacity.
+    EXPECT_EQ(queue->SchedulingCapacity(), 8);
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+  EXPECT_EQ(recorder.batches(), (std::vector<std::vector<size_t>>{{3}}));
+}
+
+TEST(SharedBatchSchedulerPriorityTest, DropsExpiredTasks) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  BatchRecorder recorder;
+  mutex mu;
+  std::vector<size_t> expired_tasks;
+  {
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions options = CreateQueueOptions(
+        10, 10, /*batch_timeout_micros=*/10, /*max_enqueued_batches=*/2,
+        /*enable_large_batch_splitting=*/false, /*enable_lazy_split=*/false,
+        /*split_func=*/nullptr);
+    options.expired_task_callback = [&](std::unique_ptr<FakeTask> task) {
+      mutex_lock l(mu);
+      expired_tasks.push_back(task->size());
+    };
+    auto queue = CreateQueue(scheduler, options, recorder.Callback());
+
+    TF_ASSERT_OK(ScheduleTask(1, BatchTaskPriority::kHigh, 5, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(2, BatchTaskPriority::kHigh, 0, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(3, BatchTaskPriority::kHigh, 1000, queue.get()));
+    env.AdvanceByMicroseconds(10);
+    recorder.WaitForBatches(1);
+    EXPECT_EQ(recorder.batches(), (std::vector<std::vector<size_t>>{{2, 3}}));
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ(expired_tasks, std::vector<size_t>({1}));
+    }
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerPriorityTest, InvalidOptions) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {
+    // do nothing.
+  };
+  auto scheduler = CreateSharedBatchScheduler(2);
+  std::unique_ptr<Queue> queue;
+
+  QueueOptions options =
+      CreatePriorityQueueOptions(10, /*pad_with_low_priority_tasks=*/false);
+  options.max_enqueued_low_priority_batches = 0;
+  EXPECT_THAT(scheduler->AddQueue(options, callback, &queue),
+              testing::StatusIs(
+                  error::INVALID_ARGUMENT,
+                  "max_enqueued_low_priority_batches must be positive; was 0"));
+
+  options = tensorflow::serving::CreateQueueOptions(
+      10, 10, /*batch_timeout_micros=*/0, /*max_enqueued_batches=*/2,
+      /*enable_large_batch_splitting=*/true, /*enable_lazy_split=*/true,
+      [](std::unique_ptr<FakeTask>* input_task, int first_output_task_size,
+         int max_batch_size,
+         std::vector<std::unique_ptr<FakeTask>>* output_tasks) -> Status {
+        output_tasks->push_back(std::move(*input_task));
+        return OkStatus();
+      });
+  options.enable_priority_queue = true;
+  EXPECT_THAT(
+      scheduler->AddQueue(options, callback, &queue),
+      testing::StatusIs(
+          error::INVALID_ARGUMENT,
+          "enable_priority_queue is not supported with enable_lazy_split."));
+}
+
 // TODO(b/161857471):
 // Add test coverage when input-split and no-split returns differently.
 INSTANTIATE_TEST_SUITE_P(
@@ -697,6 +697,19 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
     OP_REQUIRES_OK(c, c->GetAttr("final_op", &final_op_name));
     OP_REQUIRES_OK(
         c, c->GetAttr("max_subdivs_per_device", &max_subdivs_per_device_));
+    string compression;
+    OP_REQUIRES_OK(c, c->GetAttr("compression", &compression));
+    if (compression == "float16") {
+      compression_ = COLLECTIVE_COMPRESSION_FLOAT16;
+    } else if (compression == "bfloat16") {
+      compression_ = COLLECTIVE_COMPRESSION_BFLOAT16;
+    } else if (compression == "top_k") {
+      compression_ = COLLECTIVE_COMPRESSION_TOP_K;
+    } else {
+      compression_ = COLLECTIVE_COMPRESSION_NONE;
+    }
+    OP_REQUIRES_OK(c, c->GetAttr("topk_ratio", &topk_ratio_));
+    OP_REQUIRES_OK(c, c->GetAttr("min_contributions", &min_contributions_));
     // Prepare OpKernels for reduction and final operations.
     // The merge_op takes two inputs
     NodeDef sub_node;
@@ -725,6 +738,9 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
                                               /*instance_key*/ c->input(3)),
                          done_with_cleanup);
     col_params->instance.shape = c->input(0).shape();
+    col_params->instance.impl_details.compression = compression_;
+    col_params->instance.impl_details.topk_ratio = topk_ratio_;
+    col_params->instance.impl_details.min_contributions = min_contributions_;
     col_params->merge_op = merge_op_.get();
     col_params->final_op = final_op_.get();
     VLOG(1) << "CollectiveReduceV2 group_size " << col_params->group.group_size
@@ -741,6 +757,9 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
 
  private:
   int max_subdivs_per_device_;
+  CollectiveCompression compression_;
+  float topk_ratio_;
+  int32 min_contributions_;
   std::unique_ptr<OpKernel> merge_op_;
   std::unique_ptr<OpKernel> final_op_;
 };
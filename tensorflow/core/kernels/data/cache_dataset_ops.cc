@@ -14,11 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
+#include "tensorflow/core/data/hash_utils.h"
+#include "tensorflow/core/data/mmap_cache.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -59,9 +63,14 @@ constexpr char kCurIndex[] = "cur_index";
 constexpr char kShardId[] = "shard_id";
 constexpr char kCreatedAt[] = "Created at";
 constexpr char kMemoryDatasetPrefix[] = "Memory";
+constexpr char kMmapDatasetPrefix[] = "Mmap";
+// Filenames with this prefix select the memory-mapped cache. The remainder of
+// the filename is the directory holding the cache files.
+constexpr char kMmapCachePrefix[] = "mmap://";
 constexpr char kMemoryCache[] = "MemoryCache";
 constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
+constexpr char kReading[] = "reading";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
 constexpr char kIncompleteCacheErrorMessage[] =
@@ -1110,6 +1119,217 @@ class CacheDatasetOp::MemoryDatasetV2
   ResourceMgr* const resource_mgr_;  // Not owned.
 };
 
+// A cache dataset that stores its elements in a memory-mapped arena file named
+// after the fingerprint of the input dataset. The first iteration writes the
+// file; later iterations (including those of other processes on the same host
+// sharing the directory) serve tensors aliasing the mapped pages, so the cache
+// is neither duplicated per process nor deserialized.
+class CacheDatasetOp::MmapDataset : public DatasetBase {
+ public:
+  MmapDataset(OpKernelContext* ctx, const DatasetBase* input, string filename,
+              string cache_filename, Env* env, const Tensor* resource_handle)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        filename_(std::move(filename)),
+        cache_filename_(std::move(cache_filename)),
+        env_(env),
+        has_resource_handle_(resource_handle != nullptr),
+        resource_handle_(resource_handle != nullptr ? *resource_handle
+                                                    : Tensor()) {
+    input_->Ref();
+  }
+
+  ~MmapDataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    name_utils::IteratorPrefixParams params;
+    params.dataset_prefix = kMmapDatasetPrefix;
+    return std::make_unique<MmapIterator>(MmapIterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix, params)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.dataset_prefix = kMmapDatasetPrefix;
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal() const override { return input_->Cardinality(); }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return input_->Cardinality(options);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
+    Node* filename_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
+    if (!has_resource_handle_) {
+      return b->AddDataset(this, {input_node, filename_node}, output);
+    }
+    Node* resource_handle_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddTensor(resource_handle_, &resource_handle_node));
+    return b->AddDataset(
+        this, {input_node, filename_node, resource_handle_node}, output);
+  }
+
+ private:
+  // Serves elements from the mapped cache if it exists. Otherwise passes
+  // through the input elements while writing them to the cache, which is only
+  // published once the input has been fully consumed.
+  class MmapIterator : public DatasetIterator<MmapDataset> {
+   public:
+    explicit MmapIterator(const Params& params)
+        : DatasetIterator<MmapDataset>(params) {}
+
+    ~MmapIterator() override {
+      mutex_lock l(mu_);
+      if (writer_ != nullptr && writer_->num_elements() > 0) {
+        LOG(WARNING) << kIncompleteCacheErrorMessage;
+      }
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      auto reader = MmapCacheReader::Open(dataset()->env_,
+                                          dataset()->cache_filename_);
+      if (reader.ok()) {
+        return InitializeReader(std::move(reader).value());
+      }
+      if (!errors::IsNotFound(reader.status())) {
+        return reader.status();
+      }
+      TF_ASSIGN_OR_RETURN(
+          writer_, MmapCacheWriter::Create(dataset()->env_,
+                                           dataset()->cache_filename_,
+                                           dataset()->output_dtypes().size()));
+      return dataset()->input_->MakeIterator(ctx, this, prefix(),
+                                             &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (reader_ != nullptr) {
+        *end_of_sequence = index_ >= reader_->size();
+        if (*end_of_sequence) {
+          return OkStatus();
+        }
+        return reader_->Get(index_++, out_tensors);
+      }
+      if (!input_impl_) {
+        *end_of_sequence = true;
+        return OkStatus();
+      }
+      TF_RETURN_IF_ERROR(
+          input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+      if (*end_of_sequence) {
+        input_impl_.reset();
+        if (writer_ != nullptr) {
+          VLOG(2) << "Finalizing the cache " << dataset()->cache_filename_
+                  << " because EOF has been reached.";
+          Status s = writer_->Finalize();
+          writer_.reset();
+          return s;
+        }
+        return OkStatus();
+      }
+      if (writer_ != nullptr) {
+        TF_RETURN_IF_ERROR(writer_->Write(*out_tensors));
+      }
+      return OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      if (reader_ != nullptr) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kReading), ""));
+        return writer->WriteScalar(full_name(kIndex), index_);
+      }
+      return SaveInput(ctx, writer, input_impl_);
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      writer_.reset();
+      reader_.reset();
+      input_impl_.reset();
+      if (reader->Contains(full_name(kReading))) {
+        TF_ASSIGN_OR_RETURN(auto cache_reader,
+                            MmapCacheReader::Open(dataset()->env_,
+                                                  dataset()->cache_filename_));
+        TF_RETURN_IF_ERROR(InitializeReader(std::move(cache_reader)));
+        return reader->ReadScalar(full_name(kIndex), &index_);
+      }
+      // Elements written before the checkpoint cannot be recovered, so the
+      // restored iterator passes through its input without caching. The cache
+      // will be written by the next iteration over the dataset.
+      TF_RETURN_IF_ERROR(
+          dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+      return RestoreInput(ctx, reader, input_impl_);
+    }
+
+   private:
+    Status InitializeReader(std::unique_ptr<MmapCacheReader> reader)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (reader->num_components() != dataset()->output_dtypes().size()) {
+        return errors::InvalidArgument(
+            "The cache at ", dataset()->cache_filename_, " has ",
+            reader->num_components(), " components per element but the ",
+            "dataset has ", dataset()->output_dtypes().size(), ".");
+      }
+      reader_ = std::move(reader);
+      index_ = 0;
+      return OkStatus();
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<MmapCacheWriter> writer_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<MmapCacheReader> reader_ TF_GUARDED_BY(mu_);
+    int64_t index_ TF_GUARDED_BY(mu_) = 0;
+  };  // MmapIterator
+
+  const DatasetBase* const input_;
+  const tstring filename_;
+  const string cache_filename_;
+  Env* const env_;
+  const bool has_resource_handle_;
+  const Tensor resource_handle_;
+};  // MmapDataset
+
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
       op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
@@ -1119,6 +1339,30 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
   // Parse out the filenames tensor.
   tstring filename;
   OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kFileName, &filename));
+  if (absl::StartsWith(filename, kMmapCachePrefix)) {
+    // The cache file is keyed by the fingerprint of the input dataset so that
+    // all pipelines producing the same elements share a single cache.
+    GraphDef graph_def;
+    SerializationContext::Params params(ctx);
+    std::vector<std::pair<string, Tensor>> input_list;
+    params.input_list = &input_list;
+    params.external_state_policy = ExternalStatePolicy::POLICY_IGNORE;
+    OP_REQUIRES_OK(ctx,
+                   AsGraphDef(input, SerializationContext(params), &graph_def));
+    uint64 fingerprint;
+    OP_REQUIRES_OK(ctx, HashGraph(graph_def, &fingerprint));
+    string directory(
+        absl::string_view(filename).substr(strlen(kMmapCachePrefix)));
+    OP_REQUIRES(ctx, !directory.empty(),
+                errors::InvalidArgument(
+                    "The memory-mapped cache requires a directory, e.g. `",
+                    kMmapCachePrefix, "/tmp/cache`."));
+    *output = new MmapDataset(ctx, input, filename,
+                              MmapCacheFilename(directory, fingerprint),
+                              ctx->env(),
+                              op_version_ == 2 ? &ctx->input(2) : nullptr);
+    return;
+  }
   if (filename.empty()) {
     static std::atomic<int64_t> resource_id_counter(0);
     const string& container = ctx->resource_manager()->default_container();
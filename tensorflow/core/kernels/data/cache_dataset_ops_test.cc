@@ -14,6 +14,7 @@ limitations under the License.
 #include <string>
 #include <utility>
 
+#include "absl/strings/strip.h"
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
@@ -26,6 +27,7 @@ namespace {
 constexpr char kNodeName[] = "cache_dataset";
 constexpr char kFileDatasetPrefix[] = "File";
 constexpr char kMemoryDatasetPrefix[] = "Memory";
+constexpr char kMmapCachePrefix[] = "mmap://";
 
 class CacheDatasetParams : public DatasetParams {
  public:
@@ -80,9 +82,15 @@ class CacheDatasetOpTest : public DatasetOpsTestBase {
 
   ~CacheDatasetOpTest() override {
     if (!cache_filename_.empty()) {
+      // The memory-mapped cache stores its files inside the given directory.
+      absl::string_view pattern = cache_filename_;
+      const bool is_mmap_cache =
+          absl::ConsumePrefix(&pattern, kMmapCachePrefix);
       std::vector<string> cache_files;
       Status s = device_->env()->GetMatchingPaths(
-          strings::StrCat(cache_filename_, "*"), &cache_files);
+          is_mmap_cache ? io::JoinPath(pattern, "*")
+                        : strings::StrCat(pattern, "*"),
+          &cache_files);
       if (!s.ok()) {
         LOG(WARNING) << "Failed to get matching files on " << cache_filename_
                      << "* : " << s.ToString();
@@ -150,6 +158,21 @@ CacheDatasetParams CacheDatasetParams4() {
                             kNodeName);
 }
 
+// Test case 5: cache data in a memory-mapped file.
+CacheDatasetParams CacheDatasetParams5() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{3, 3, 1},
+                                            {0, 1, 2, 3, 4, 5, 6, 7, 8})},
+      /*node_name=*/"tensor_slice");
+  return CacheDatasetParams(
+      std::move(tensor_slice_dataset_params),
+      /*filename=*/
+      strings::StrCat(kMmapCachePrefix,
+                      io::JoinPath(testing::TmpDir(), "mmap_cache_data")),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({3, 1})}, kNodeName);
+}
+
 std::vector<GetNextTestCase<CacheDatasetParams>> GetNextTestCases() {
   return {{/*dataset_params=*/CacheDatasetParams1(),
            /*expected_outputs=*/
@@ -162,7 +185,11 @@ std::vector<GetNextTestCase<CacheDatasetParams>> GetNextTestCases() {
            CreateTensors<int64_t>(TensorShape({3, 1}),
                                   {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})},
           {/*dataset_params=*/CacheDatasetParams4(),
-           /*expected_outputs=*/{}}};
+           /*expected_outputs=*/{}},
+          {/*dataset_params=*/CacheDatasetParams5(),
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({3, 1}),
+                                  {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})}};
 }
 
 class ParameterizedGetNextTest : public CacheDatasetOpTest,
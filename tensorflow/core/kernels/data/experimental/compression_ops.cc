@@ -25,7 +25,11 @@ namespace data {
 namespace experimental {
 
 CompressElementOp::CompressElementOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx) {}
+    : OpKernel(ctx) {
+  if (ctx->HasAttr(kAdaptiveCodecs)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kAdaptiveCodecs, &adaptive_codecs_));
+  }
+}
 
 void CompressElementOp::Compute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
@@ -33,7 +37,12 @@ void CompressElementOp::Compute(OpKernelContext* ctx) {
     components.push_back(ctx->input(i));
   }
   CompressedElement compressed;
-  OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  if (adaptive_codecs_) {
+    OP_REQUIRES_OK(ctx,
+                   CompressElementWithAdaptiveCodecs(components, &compressed));
+  } else {
+    OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  }
 
   Tensor* output;
   OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
@@ -23,9 +23,16 @@ namespace experimental {
 
 class CompressElementOp : public OpKernel {
  public:
+  static constexpr const char* const kAdaptiveCodecs = "adaptive_codecs";
+
   explicit CompressElementOp(OpKernelConstruction* ctx);
 
   void Compute(OpKernelContext* ctx) override;
+
+ private:
+  // Whether to compress each component with the codec chosen for it by
+  // `SelectCompressionCodec`, instead of snappy for the whole element.
+  bool adaptive_codecs_ = false;
 };
 
 class UncompressElementOp : public OpKernel {
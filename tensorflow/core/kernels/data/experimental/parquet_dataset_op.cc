@@ -0,0 +1,625 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/parquet_dataset_op.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/split_utils.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/experimental/parquet_reader.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const ParquetDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ParquetDatasetOp::kFileNames;
+/* static */ constexpr const char* const ParquetDatasetOp::kColumns;
+/* static */ constexpr const char* const ParquetDatasetOp::kBatchSize;
+/* static */ constexpr const char* const ParquetDatasetOp::kPredicateColumns;
+/* static */ constexpr const char* const
+    ParquetDatasetOp::kPredicateLowerBounds;
+/* static */ constexpr const char* const
+    ParquetDatasetOp::kPredicateUpperBounds;
+/* static */ constexpr const char* const ParquetDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const ParquetDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kNextFile[] = "next_file";
+constexpr char kNextRowGroup[] = "next_row_group";
+constexpr char kLoadedFile[] = "loaded_file";
+constexpr char kLoadedRowGroup[] = "loaded_row_group";
+constexpr char kRowOffset[] = "row_offset";
+constexpr char kSplitProvider[] = "split_provider";
+constexpr char kSlash[] = "/";
+
+bool IsNumeric(DataType dtype) {
+  return dtype == DT_BOOL || dtype == DT_INT32 || dtype == DT_INT64 ||
+         dtype == DT_FLOAT || dtype == DT_DOUBLE;
+}
+
+// Clears the elements of `*keep` whose value in `values` is not in
+// [lower, upper].
+template <typename T>
+void ApplyPredicate(const Tensor& values, double lower, double upper,
+                    std::vector<bool>* keep) {
+  const auto v = values.flat<T>();
+  for (int64_t i = 0; i < v.size(); ++i) {
+    const double value = static_cast<double>(v(i));
+    if (!(value >= lower && value <= upper)) (*keep)[i] = false;
+  }
+}
+
+template <typename T>
+void GatherRows(const Tensor& values, const std::vector<int64_t>& rows,
+                Tensor* out) {
+  const auto src = values.flat<T>();
+  auto dst = out->flat<T>();
+  for (size_t i = 0; i < rows.size(); ++i) dst(i) = src(rows[i]);
+}
+
+}  // namespace
+
+class ParquetDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+          std::vector<string> columns, int64_t batch_size,
+          std::vector<string> predicate_columns,
+          std::vector<double> predicate_lower_bounds,
+          std::vector<double> predicate_upper_bounds,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        columns_(std::move(columns)),
+        batch_size_(batch_size),
+        predicate_columns_(std::move(predicate_columns)),
+        predicate_lower_bounds_(std::move(predicate_lower_bounds)),
+        predicate_upper_bounds_(std::move(predicate_upper_bounds)),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  Status MakeSplitProviders(std::vector<std::unique_ptr<SplitProvider>>*
+                                split_providers) const override {
+    std::vector<int64_t> row_group_starts;
+    TF_RETURN_IF_ERROR(CountRowGroups(Env::Default(), &row_group_starts));
+    split_providers->push_back(
+        std::make_unique<IndexSplitProvider>(row_group_starts.back()));
+    return OkStatus();
+  }
+
+  const DataTypeVector& output_dtypes() const override { return output_types_; }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override { return OkStatus(); }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    Node* columns = nullptr;
+    Node* batch_size = nullptr;
+    Node* predicate_columns = nullptr;
+    Node* predicate_lower_bounds = nullptr;
+    Node* predicate_upper_bounds = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    TF_RETURN_IF_ERROR(b->AddVector(columns_, &columns));
+    TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+    TF_RETURN_IF_ERROR(b->AddVector(predicate_columns_, &predicate_columns));
+    TF_RETURN_IF_ERROR(
+        b->AddVector(predicate_lower_bounds_, &predicate_lower_bounds));
+    TF_RETURN_IF_ERROR(
+        b->AddVector(predicate_upper_bounds_, &predicate_upper_bounds));
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {filenames, columns, batch_size, predicate_columns,
+         predicate_lower_bounds, predicate_upper_bounds},
+        output));
+    return OkStatus();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    Status Initialize(IteratorContext* ctx) override {
+      if (!ctx->split_providers().empty()) {
+        TF_ASSIGN_OR_RETURN(split_provider_,
+                            GetSingleSplitProvider(ctx, dataset()));
+        // Splits number the row groups of all files.
+        TF_RETURN_IF_ERROR(
+            dataset()->CountRowGroups(ctx->env(), &row_group_starts_));
+      }
+      return OkStatus();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      const int64_t batch_size = dataset()->batch_size_;
+      const int num_columns = dataset()->columns_.size();
+      std::vector<Tensor> batch;
+      int64_t num_rows = 0;
+      while (num_rows < batch_size) {
+        if (row_offset_ == num_loaded_rows_) {
+          bool end_of_row_groups = false;
+          TF_RETURN_IF_ERROR(LoadNextRowGroup(ctx, &end_of_row_groups));
+          if (end_of_row_groups) break;
+        }
+        const int64_t n =
+            std::min(batch_size - num_rows, num_loaded_rows_ - row_offset_);
+        if (n == batch_size) {
+          // The batch lies within the row group, so it can share its buffers
+          // unless that would misalign them.
+          std::vector<Tensor> slices;
+          slices.reserve(num_columns);
+          bool aligned = true;
+          for (const Tensor& column : loaded_columns_) {
+            slices.push_back(column.Slice(row_offset_, row_offset_ + n));
+            aligned = aligned && slices.back().IsAligned();
+          }
+          if (aligned) {
+            row_offset_ += n;
+            *out_tensors = std::move(slices);
+            *end_of_sequence = false;
+            return OkStatus();
+          }
+        }
+        if (batch.empty()) {
+          batch.reserve(num_columns);
+          for (int i = 0; i < num_columns; ++i) {
+            batch.emplace_back(ctx->allocator({}), dataset()->output_types_[i],
+                               TensorShape({batch_size}));
+          }
+        }
+        for (int i = 0; i < num_columns; ++i) {
+          TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+              loaded_columns_[i], row_offset_, num_rows, n, &batch[i]));
+        }
+        row_offset_ += n;
+        num_rows += n;
+      }
+      if (num_rows == 0) {
+        *end_of_sequence = true;
+        return OkStatus();
+      }
+      out_tensors->reserve(num_columns);
+      for (Tensor& column : batch) {
+        out_tensors->push_back(num_rows == batch_size
+                                   ? std::move(column)
+                                   : column.Slice(0, num_rows));
+      }
+      *end_of_sequence = false;
+      return OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      if (split_provider_) {
+        TF_RETURN_IF_ERROR(split_provider_->Save(
+            [this](const std::string& key) {
+              return SplitProviderKeyNameFn(key);
+            },
+            writer));
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kNextFile), next_file_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kNextRowGroup), next_row_group_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kLoadedFile), loaded_file_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kLoadedRowGroup), loaded_row_group_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kRowOffset), row_offset_));
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      if (split_provider_) {
+        TF_RETURN_IF_ERROR(split_provider_->Restore(
+            [this](const std::string& key) {
+              return SplitProviderKeyNameFn(key);
+            },
+            reader));
+      }
+      int64_t loaded_file, loaded_row_group, row_offset;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kNextFile), &next_file_));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNextRowGroup), &next_row_group_));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kLoadedFile), &loaded_file));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kLoadedRowGroup), &loaded_row_group));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kRowOffset), &row_offset));
+      loaded_file_ = -1;
+      loaded_row_group_ = -1;
+      loaded_columns_.clear();
+      num_loaded_rows_ = 0;
+      row_offset_ = 0;
+      if (loaded_file < 0) return OkStatus();
+      if (loaded_file >= static_cast<int64_t>(dataset()->filenames_.size())) {
+        return errors::FailedPrecondition(
+            "Checkpoint refers to file ", loaded_file, " but the dataset has ",
+            dataset()->filenames_.size(), " files");
+      }
+      // Filtering is deterministic, so the row group is re-read and the rows
+      // of the batches produced before the checkpoint are skipped.
+      TF_RETURN_IF_ERROR(OpenFile(ctx, loaded_file));
+      TF_RETURN_IF_ERROR(ReadRowGroup(ctx, loaded_file, loaded_row_group));
+      if (row_offset > num_loaded_rows_) {
+        return errors::FailedPrecondition(
+            "Checkpoint refers to row ", row_offset, " of row group ",
+            loaded_row_group, " of ", dataset()->filenames_[loaded_file],
+            ", which has ", num_loaded_rows_, " matching rows");
+      }
+      row_offset_ = row_offset;
+      return OkStatus();
+    }
+
+   private:
+    std::string SplitProviderKeyNameFn(const std::string& key) {
+      return full_name(absl::StrCat(kSplitProvider, kSlash, key));
+    }
+
+    // Loads the next row group that has rows matching the predicates, or sets
+    // `*end_of_row_groups` if there is none.
+    Status LoadNextRowGroup(IteratorContext* ctx, bool* end_of_row_groups)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const std::vector<string>& filenames = dataset()->filenames_;
+      while (true) {
+        int64_t file, row_group;
+        if (split_provider_ != nullptr) {
+          Tensor split;
+          TF_RETURN_IF_ERROR(
+              split_provider_->GetNext(&split, end_of_row_groups));
+          if (*end_of_row_groups) return OkStatus();
+          const int64_t index = split.scalar<int64_t>()();
+          auto it = std::upper_bound(row_group_starts_.begin(),
+                                     row_group_starts_.end(), index);
+          if (index < 0 || it == row_group_starts_.end()) {
+            return errors::InvalidArgument("Split ", index,
+                                           " is not a row group of the "
+                                           "dataset");
+          }
+          file = it - row_group_starts_.begin() - 1;
+          row_group = index - row_group_starts_[file];
+          TF_RETURN_IF_ERROR(OpenFile(ctx, file));
+          if (row_group >= reader_->num_row_groups()) {
+            return errors::FailedPrecondition(
+                filenames[file], " has fewer row groups than when the splits ",
+                "were created");
+          }
+        } else {
+          if (next_file_ == static_cast<int64_t>(filenames.size())) {
+            *end_of_row_groups = true;
+            return OkStatus();
+          }
+          TF_RETURN_IF_ERROR(OpenFile(ctx, next_file_));
+          if (next_row_group_ == reader_->num_row_groups()) {
+            ++next_file_;
+            next_row_group_ = 0;
+            continue;
+          }
+          file = next_file_;
+          row_group = next_row_group_++;
+        }
+        if (!MayMatch(row_group)) continue;
+        TF_RETURN_IF_ERROR(ReadRowGroup(ctx, file, row_group));
+        if (num_loaded_rows_ > 0) return OkStatus();
+      }
+    }
+
+    // Opens file `file`, unless it is already open, and finds the columns the
+    // dataset reads.
+    Status OpenFile(IteratorContext* ctx, int64_t file)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (reader_file_ == file) return OkStatus();
+      reader_file_ = -1;
+      const string& filename = dataset()->filenames_[file];
+      TF_RETURN_IF_ERROR(ParquetReader::Open(ctx->env(), filename, &reader_));
+      const std::vector<ParquetColumn>& columns = reader_->columns();
+      column_indices_.clear();
+      for (int i = 0; i < dataset()->columns_.size(); ++i) {
+        const string& name = dataset()->columns_[i];
+        const int index = reader_->FindColumn(name);
+        if (index < 0) {
+          return errors::InvalidArgument("Column ", name, " is not in ",
+                                         filename);
+        }
+        if (columns[index].dtype != dataset()->output_types_[i]) {
+          return errors::InvalidArgument(
+              "Column ", name, " of ", filename, " is read as ",
+              DataTypeString(columns[index].dtype), " but the dataset expects ",
+              DataTypeString(dataset()->output_types_[i]));
+        }
+        column_indices_.push_back(index);
+      }
+      predicate_indices_.clear();
+      for (const string& name : dataset()->predicate_columns_) {
+        const int index = reader_->FindColumn(name);
+        if (index < 0) {
+          return errors::InvalidArgument("Predicate column ", name,
+                                         " is not in ", filename);
+        }
+        if (!IsNumeric(columns[index].dtype)) {
+          return errors::InvalidArgument("Predicate column ", name, " of ",
+                                         filename, " is not numeric");
+        }
+        predicate_indices_.push_back(index);
+      }
+      reader_file_ = file;
+      return OkStatus();
+    }
+
+    // Returns whether the column statistics of row group `row_group` of the
+    // open file allow rows matching all predicates.
+    bool MayMatch(int64_t row_group) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (int i = 0; i < predicate_indices_.size(); ++i) {
+        if (!reader_->MayContain(row_group, predicate_indices_[i],
+                                 dataset()->predicate_lower_bounds_[i],
+                                 dataset()->predicate_upper_bounds_[i])) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Reads the rows of row group `row_group` of the open file that match the
+    // predicates.
+    Status ReadRowGroup(IteratorContext* ctx, int64_t file, int64_t row_group)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t num_rows = reader_->row_group(row_group).num_rows;
+      // Columns may be both read and filtered on, and are decoded once.
+      std::map<int, Tensor> decoded;
+      auto read_column = [&](int index, Tensor** values) -> Status {
+        auto it = decoded.find(index);
+        if (it == decoded.end()) {
+          Tensor t(ctx->allocator({}), reader_->columns()[index].dtype,
+                   TensorShape({num_rows}));
+          TF_RETURN_IF_ERROR(reader_->ReadColumn(row_group, index, &t));
+          it = decoded.emplace(index, std::move(t)).first;
+        }
+        *values = &it->second;
+        return OkStatus();
+      };
+
+      // The predicates are evaluated first, so that the other columns are
+      // not read when no row matches.
+      std::vector<int64_t> rows;
+      if (!predicate_indices_.empty()) {
+        std::vector<bool> keep(num_rows, true);
+        for (int i = 0; i < predicate_indices_.size(); ++i) {
+          Tensor* values;
+          TF_RETURN_IF_ERROR(read_column(predicate_indices_[i], &values));
+          const double lower = dataset()->predicate_lower_bounds_[i];
+          const double upper = dataset()->predicate_upper_bounds_[i];
+          switch (values->dtype()) {
+#define HANDLE_TYPE(T)                               \
+  case DataTypeToEnum<T>::value:                     \
+    ApplyPredicate<T>(*values, lower, upper, &keep); \
+    break;
+            HANDLE_TYPE(bool);
+            HANDLE_TYPE(int32);
+            HANDLE_TYPE(int64_t);
+            HANDLE_TYPE(float);
+            HANDLE_TYPE(double);
+#undef HANDLE_TYPE
+            default:
+              return errors::Internal("unexpected predicate dtype");
+          }
+        }
+        for (int64_t i = 0; i < num_rows; ++i) {
+          if (keep[i]) rows.push_back(i);
+        }
+      }
+      const bool filtered = !predicate_indices_.empty() &&
+                            static_cast<int64_t>(rows.size()) < num_rows;
+
+      std::vector<Tensor> columns;
+      columns.reserve(column_indices_.size());
+      if (!filtered || !rows.empty()) {
+        for (int index : column_indices_) {
+          Tensor* values;
+          TF_RETURN_IF_ERROR(read_column(index, &values));
+          if (!filtered) {
+            columns.push_back(*values);
+            continue;
+          }
+          columns.emplace_back(ctx->allocator({}), values->dtype(),
+                               TensorShape({static_cast<int64_t>(rows.size())}));
+          switch (values->dtype()) {
+#define HANDLE_TYPE(T)                             \
+  case DataTypeToEnum<T>::value:                   \
+    GatherRows<T>(*values, rows, &columns.back()); \
+    break;
+            HANDLE_TYPE(bool);
+            HANDLE_TYPE(int32);
+            HANDLE_TYPE(int64_t);
+            HANDLE_TYPE(float);
+            HANDLE_TYPE(double);
+            HANDLE_TYPE(tstring);
+#undef HANDLE_TYPE
+            default:
+              return errors::Internal("unexpected column dtype");
+          }
+        }
+      }
+
+      loaded_file_ = file;
+      loaded_row_group_ = row_group;
+      loaded_columns_ = std::move(columns);
+      num_loaded_rows_ = filtered ? rows.size() : num_rows;
+      row_offset_ = 0;
+      return OkStatus();
+    }
+
+    mutex mu_;
+    std::shared_ptr<SplitProvider> split_provider_;
+    // Number of row groups in the files before each file, and in all files.
+    std::vector<int64_t> row_group_starts_;
+    // Next row group to read when there are no splits.
+    int64_t next_file_ TF_GUARDED_BY(mu_) = 0;
+    int64_t next_row_group_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<ParquetReader> reader_ TF_GUARDED_BY(mu_);
+    int64_t reader_file_ TF_GUARDED_BY(mu_) = -1;
+    // Indices in the open file of the columns that are read and of the
+    // predicate columns.
+    std::vector<int> column_indices_ TF_GUARDED_BY(mu_);
+    std::vector<int> predicate_indices_ TF_GUARDED_BY(mu_);
+    // Matching rows of the row group batches are taken from.
+    int64_t loaded_file_ TF_GUARDED_BY(mu_) = -1;
+    int64_t loaded_row_group_ TF_GUARDED_BY(mu_) = -1;
+    std::vector<Tensor> loaded_columns_ TF_GUARDED_BY(mu_);
+    int64_t num_loaded_rows_ TF_GUARDED_BY(mu_) = 0;
+    int64_t row_offset_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  // Sets `(*row_group_starts)[i]` to the number of row groups in the files
+  // before file `i`, for each file and the end of the last file.
+  Status CountRowGroups(Env* env,
+                        std::vector<int64_t>* row_group_starts) const {
+    row_group_starts->assign(1, 0);
+    for (const string& filename : filenames_) {
+      std::unique_ptr<ParquetReader> reader;
+      TF_RETURN_IF_ERROR(ParquetReader::Open(env, filename, &reader));
+      row_group_starts->push_back(row_group_starts->back() +
+                                  reader->num_row_groups());
+    }
+    return OkStatus();
+  }
+
+  const std::vector<string> filenames_;
+  const std::vector<string> columns_;
+  const int64_t batch_size_;
+  const std::vector<string> predicate_columns_;
+  const std::vector<double> predicate_lower_bounds_;
+  const std::vector<double> predicate_upper_bounds_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};
+
+ParquetDatasetOp::ParquetDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void ParquetDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                   DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+  std::vector<string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+  }
+
+  std::vector<tstring> column_names;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<tstring>(ctx, kColumns,
+                                                   &column_names));
+  OP_REQUIRES(ctx, column_names.size() == output_types_.size(),
+              errors::InvalidArgument("Expected ", output_types_.size(),
+                                      " columns but got ",
+                                      column_names.size()));
+  std::vector<string> columns(column_names.begin(), column_names.end());
+
+  int64_t batch_size;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kBatchSize, &batch_size));
+  OP_REQUIRES(ctx, batch_size > 0,
+              errors::InvalidArgument("`batch_size` must be positive."));
+
+  std::vector<tstring> predicate_column_names;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<tstring>(ctx, kPredicateColumns,
+                                                   &predicate_column_names));
+  std::vector<string> predicate_columns(predicate_column_names.begin(),
+                                        predicate_column_names.end());
+  std::vector<double> predicate_lower_bounds;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<double>(ctx, kPredicateLowerBounds,
+                                                  &predicate_lower_bounds));
+  std::vector<double> predicate_upper_bounds;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<double>(ctx, kPredicateUpperBounds,
+                                                  &predicate_upper_bounds));
+  OP_REQUIRES(
+      ctx,
+      predicate_lower_bounds.size() == predicate_columns.size() &&
+          predicate_upper_bounds.size() == predicate_columns.size(),
+      errors::InvalidArgument(
+          "Expected a lower and an upper bound for each of the ",
+          predicate_columns.size(), " predicate columns but got ",
+          predicate_lower_bounds.size(), " and ",
+          predicate_upper_bounds.size()));
+
+  *output = new Dataset(ctx, std::move(filenames), std::move(columns),
+                        batch_size, std::move(predicate_columns),
+                        std::move(predicate_lower_bounds),
+                        std::move(predicate_upper_bounds), output_types_,
+                        output_shapes_);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("ParquetDataset").Device(DEVICE_CPU),
+                        ParquetDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
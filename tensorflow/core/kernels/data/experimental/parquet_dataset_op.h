@@ -0,0 +1,63 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARQUET_DATASET_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARQUET_DATASET_OP_H_
+
+#include "tensorflow/core/framework/dataset.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Reads batches of the values of some columns of Parquet files.
+//
+// Only the chunks of the requested columns are read. Row groups whose column
+// statistics show that none of their rows match the predicates are skipped
+// without reading them, and the rows of the other row groups that do not
+// match are dropped before batching. A predicate keeps the rows whose value
+// of a numeric column is in [lower bound, upper bound].
+//
+// Each split of the dataset is a row group, numbered across all files.
+class ParquetDatasetOp : public DatasetOpKernel {
+ public:
+  static constexpr const char* const kDatasetType = "Parquet";
+  static constexpr const char* const kFileNames = "filenames";
+  static constexpr const char* const kColumns = "columns";
+  static constexpr const char* const kBatchSize = "batch_size";
+  static constexpr const char* const kPredicateColumns = "predicate_columns";
+  static constexpr const char* const kPredicateLowerBounds =
+      "predicate_lower_bounds";
+  static constexpr const char* const kPredicateUpperBounds =
+      "predicate_upper_bounds";
+  static constexpr const char* const kOutputTypes = "output_types";
+  static constexpr const char* const kOutputShapes = "output_shapes";
+
+  explicit ParquetDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override;
+
+ private:
+  class Dataset;
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARQUET_DATASET_OP_H_
@@ -0,0 +1,1066 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/parquet_reader.h"
+
+#include <zlib.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/raw_coding.h"
+#include "tensorflow/core/platform/snappy.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kMagic[] = "PAR1";
+constexpr size_t kMagicSize = 4;
+// A Parquet file ends with the size of its metadata and the magic number.
+constexpr size_t kTailSize = sizeof(uint32) + kMagicSize;
+
+// Field types of the Thrift compact protocol, in which Parquet metadata is
+// serialized.
+constexpr int kThriftStop = 0;
+constexpr int kThriftTrue = 1;
+constexpr int kThriftFalse = 2;
+constexpr int kThriftByte = 3;
+constexpr int kThriftI16 = 4;
+constexpr int kThriftI32 = 5;
+constexpr int kThriftI64 = 6;
+constexpr int kThriftDouble = 7;
+constexpr int kThriftBinary = 8;
+constexpr int kThriftList = 9;
+constexpr int kThriftSet = 10;
+constexpr int kThriftMap = 11;
+constexpr int kThriftStruct = 12;
+// Maximum nesting of Thrift values, to bound the recursion on corrupt data.
+constexpr int kMaxThriftDepth = 64;
+
+// Field repetition types, page types, encodings and compression codecs of the
+// Parquet format.
+constexpr int32 kRepeated = 2;
+constexpr int32 kOptional = 1;
+constexpr int32 kDataPage = 0;
+constexpr int32 kDictionaryPage = 2;
+constexpr int32 kDataPageV2 = 3;
+constexpr int32 kPlainEncoding = 0;
+constexpr int32 kPlainDictionaryEncoding = 2;
+constexpr int32 kRleDictionaryEncoding = 8;
+constexpr int32 kUncompressed = 0;
+constexpr int32 kSnappy = 1;
+constexpr int32 kGzip = 2;
+constexpr int32 kZstd = 6;
+
+// Decodes values in the Thrift compact protocol. Errors are sticky: after the
+// first one, reads return default values and ok() returns false.
+class ThriftDecoder {
+ public:
+  explicit ThriftDecoder(StringPiece data)
+      : p_(data.data()), limit_(data.data() + data.size()) {}
+
+  bool ok() const { return ok_; }
+
+  // Returns the first byte that has not been decoded.
+  const char* position() const { return p_; }
+
+  // Calls `fn(field_id, type)` for each field of a struct value of type
+  // `type`. `fn` must read or Skip() the value of each field.
+  template <typename Fn>
+  void ReadStruct(int type, Fn fn) {
+    if (type != kThriftStruct) {
+      Fail();
+      return;
+    }
+    if (++depth_ > kMaxThriftDepth) Fail();
+    int16 last_id = 0;
+    while (ok_) {
+      const uint8 header = ReadByte();
+      const int field_type = header & 0xf;
+      if (!ok_ || field_type == kThriftStop) break;
+      const int delta = header >> 4;
+      const int16 id =
+          delta != 0 ? last_id + delta : static_cast<int16>(ReadZigZag());
+      last_id = id;
+      fn(id, field_type);
+    }
+    --depth_;
+  }
+
+  bool ReadBool(int type) {
+    if (type != kThriftTrue && type != kThriftFalse) Fail();
+    return type == kThriftTrue;
+  }
+
+  int32 ReadI32(int type) {
+    if (type != kThriftI32) Fail();
+    return ok_ ? static_cast<int32>(ReadZigZag()) : 0;
+  }
+
+  int64_t ReadI64(int type) {
+    if (type != kThriftI64) Fail();
+    return ok_ ? ReadZigZag() : 0;
+  }
+
+  std::string ReadBinary(int type) {
+    if (type != kThriftBinary) Fail();
+    const uint64 size = ok_ ? ReadVarint() : 0;
+    if (size > static_cast<uint64>(limit_ - p_)) Fail();
+    if (!ok_) return std::string();
+    std::string value(p_, size);
+    p_ += size;
+    return value;
+  }
+
+  // Reads the header of a list or set, and returns its number of elements.
+  // Elements of type `*element_type` follow; booleans take one byte each.
+  int64_t ReadListHeader(int type, int* element_type) {
+    if (type != kThriftList && type != kThriftSet) Fail();
+    const uint8 header = ok_ ? ReadByte() : 0;
+    *element_type = header & 0xf;
+    uint64 size = header >> 4;
+    if (size == 15) size = ReadVarint();
+    // Every element takes at least one byte.
+    if (size > static_cast<uint64>(limit_ - p_)) Fail();
+    return ok_ ? size : 0;
+  }
+
+  void Skip(int type) {
+    if (++depth_ > kMaxThriftDepth) Fail();
+    switch (type) {
+      case kThriftTrue:
+      case kThriftFalse:
+        break;
+      case kThriftByte:
+        ReadByte();
+        break;
+      case kThriftI16:
+      case kThriftI32:
+      case kThriftI64:
+        ReadVarint();
+        break;
+      case kThriftDouble:
+        Advance(sizeof(double));
+        break;
+      case kThriftBinary:
+        Advance(ReadVarint());
+        break;
+      case kThriftList:
+      case kThriftSet: {
+        int element_type;
+        const int64_t size = ReadListHeader(type, &element_type);
+        for (int64_t i = 0; i < size && ok_; ++i) SkipElement(element_type);
+        break;
+      }
+      case kThriftMap: {
+        const uint64 size = ReadVarint();
+        if (size > static_cast<uint64>(limit_ - p_)) Fail();
+        if (size == 0 || !ok_) break;
+        const uint8 types = ReadByte();
+        for (uint64 i = 0; i < size && ok_; ++i) {
+          SkipElement(types >> 4);
+          SkipElement(types & 0xf);
+        }
+        break;
+      }
+      case kThriftStruct:
+        ReadStruct(type, [this](int16 id, int type) { Skip(type); });
+        break;
+      default:
+        Fail();
+    }
+    --depth_;
+  }
+
+ private:
+  void Fail() {
+    ok_ = false;
+    p_ = limit_;
+  }
+
+  uint8 ReadByte() {
+    if (p_ == limit_) {
+      Fail();
+      return 0;
+    }
+    return static_cast<uint8>(*p_++);
+  }
+
+  uint64 ReadVarint() {
+    uint64 value = 0;
+    const char* next = core::GetVarint64Ptr(p_, limit_, &value);
+    if (next == nullptr) {
+      Fail();
+      return 0;
+    }
+    p_ = next;
+    return value;
+  }
+
+  int64_t ReadZigZag() {
+    const uint64 value = ReadVarint();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  void Advance(uint64 n) {
+    if (n > static_cast<uint64>(limit_ - p_)) {
+      Fail();
+      return;
+    }
+    p_ += n;
+  }
+
+  // Booleans in lists, sets and maps are encoded as one byte.
+  void SkipElement(int type) {
+    if (type == kThriftTrue || type == kThriftFalse) {
+      ReadByte();
+    } else {
+      Skip(type);
+    }
+  }
+
+  const char* p_;
+  const char* const limit_;
+  int depth_ = 0;
+  bool ok_ = true;
+};
+
+// Reads a list of structs, calling `fn(element_type)` to read each of them.
+template <typename Fn>
+void ReadStructList(ThriftDecoder* d, int type, Fn fn) {
+  int element_type;
+  const int64_t size = d->ReadListHeader(type, &element_type);
+  for (int64_t i = 0; i < size && d->ok(); ++i) fn(element_type);
+}
+
+struct SchemaElement {
+  int32 type = -1;
+  int32 type_length = 0;
+  int32 repetition = 0;
+  std::string name;
+  int32 num_children = 0;
+};
+
+void ReadSchemaElement(ThriftDecoder* d, int type, SchemaElement* e) {
+  d->ReadStruct(type, [d, e](int16 id, int type) {
+    switch (id) {
+      case 1:
+        e->type = d->ReadI32(type);
+        break;
+      case 2:
+        e->type_length = d->ReadI32(type);
+        break;
+      case 3:
+        e->repetition = d->ReadI32(type);
+        break;
+      case 4:
+        e->name = d->ReadBinary(type);
+        break;
+      case 5:
+        e->num_children = d->ReadI32(type);
+        break;
+      default:
+        d->Skip(type);
+    }
+  });
+}
+
+void ReadStatistics(ThriftDecoder* d, int type, ParquetColumnChunk* chunk) {
+  std::string min, max, min_value, max_value;
+  d->ReadStruct(type, [&](int16 id, int type) {
+    switch (id) {
+      case 1:
+        max = d->ReadBinary(type);
+        break;
+      case 2:
+        min = d->ReadBinary(type);
+        break;
+      case 5:
+        max_value = d->ReadBinary(type);
+        break;
+      case 6:
+        min_value = d->ReadBinary(type);
+        break;
+      default:
+        d->Skip(type);
+    }
+  });
+  // `min_value` and `max_value` replace the deprecated `min` and `max`, which
+  // are still correct for the signed numeric types MayContain() looks at.
+  if (!min_value.empty() && !max_value.empty()) {
+    chunk->has_min_max = true;
+    chunk->min = std::move(min_value);
+    chunk->max = std::move(max_value);
+  } else if (!min.empty() && !max.empty()) {
+    chunk->has_min_max = true;
+    chunk->min = std::move(min);
+    chunk->max = std::move(max);
+  }
+}
+
+void ReadColumnMetaData(ThriftDecoder* d, int type, ParquetColumnChunk* chunk) {
+  int64_t data_page_offset = -1;
+  int64_t dictionary_page_offset = -1;
+  d->ReadStruct(type, [&](int16 id, int type) {
+    switch (id) {
+      case 4:
+        chunk->codec = d->ReadI32(type);
+        break;
+      case 5:
+        chunk->num_values = d->ReadI64(type);
+        break;
+      case 7:
+        chunk->size = d->ReadI64(type);
+        break;
+      case 9:
+        data_page_offset = d->ReadI64(type);
+        break;
+      case 11:
+        dictionary_page_offset = d->ReadI64(type);
+        break;
+      case 12:
+        ReadStatistics(d, type, chunk);
+        break;
+      default:
+        d->Skip(type);
+    }
+  });
+  // Some writers set `dictionary_page_offset` to 0 when there is no
+  // dictionary page.
+  chunk->offset = data_page_offset;
+  if (dictionary_page_offset > 0 && dictionary_page_offset < data_page_offset) {
+    chunk->offset = dictionary_page_offset;
+  }
+}
+
+void ReadColumnChunk(ThriftDecoder* d, int type, ParquetColumnChunk* chunk,
+                     bool* external) {
+  d->ReadStruct(type, [&](int16 id, int type) {
+    switch (id) {
+      case 1:
+        *external = !d->ReadBinary(type).empty();
+        break;
+      case 3:
+        ReadColumnMetaData(d, type, chunk);
+        break;
+      default:
+        d->Skip(type);
+    }
+  });
+}
+
+void ReadRowGroup(ThriftDecoder* d, int type, ParquetRowGroup* row_group,
+                  bool* external) {
+  d->ReadStruct(type, [&](int16 id, int type) {
+    switch (id) {
+      case 1:
+        ReadStructList(d, type, [&](int element_type) {
+          row_group->columns.emplace_back();
+          ReadColumnChunk(d, element_type, &row_group->columns.back(),
+                          external);
+        });
+        break;
+      case 3:
+        row_group->num_rows = d->ReadI64(type);
+        break;
+      default:
+        d->Skip(type);
+    }
+  });
+}
+
+DataType ToDataType(int32 type) {
+  switch (static_cast<ParquetType>(type)) {
+    case ParquetType::kBoolean:
+      return DT_BOOL;
+    case ParquetType::kInt32:
+      return DT_INT32;
+    case ParquetType::kInt64:
+      return DT_INT64;
+    case ParquetType::kFloat:
+      return DT_FLOAT;
+    case ParquetType::kDouble:
+      return DT_DOUBLE;
+    case ParquetType::kByteArray:
+    case ParquetType::kFixedLenByteArray:
+      return DT_STRING;
+    default:
+      return DT_INVALID;
+  }
+}
+
+// Lists the leaf columns of a schema in the order of their chunks in row
+// groups. Columns of nested groups are named by their dotted path.
+Status BuildColumns(const std::vector<SchemaElement>& schema,
+                    std::vector<ParquetColumn>* columns) {
+  if (schema.empty()) return errors::DataLoss("Parquet schema is empty");
+  // Groups being visited, with their number of children left to visit.
+  struct Group {
+    int32 remaining;
+    std::string path;
+  };
+  std::vector<Group> groups = {{schema[0].num_children, ""}};
+  for (size_t i = 1; i < schema.size(); ++i) {
+    while (!groups.empty() && groups.back().remaining <= 0) groups.pop_back();
+    if (groups.empty()) {
+      return errors::DataLoss("Parquet schema has more elements than its ",
+                              "groups have children");
+    }
+    --groups.back().remaining;
+    const SchemaElement& e = schema[i];
+    std::string path = groups.size() == 1
+                           ? e.name
+                           : strings::StrCat(groups.back().path, ".", e.name);
+    if (e.num_children > 0) {
+      groups.push_back({e.num_children, std::move(path)});
+      continue;
+    }
+    if (e.type < 0) {
+      return errors::DataLoss("Parquet column ", path, " has no type");
+    }
+    ParquetColumn column;
+    column.name = std::move(path);
+    column.type = static_cast<ParquetType>(e.type);
+    column.type_length = e.type_length;
+    column.optional = e.repetition == kOptional;
+    if (groups.size() == 1 && e.repetition != kRepeated) {
+      column.dtype = ToDataType(e.type);
+    }
+    if (column.type == ParquetType::kFixedLenByteArray &&
+        column.type_length <= 0) {
+      column.dtype = DT_INVALID;
+    }
+    columns->push_back(std::move(column));
+  }
+  return OkStatus();
+}
+
+struct PageHeader {
+  int32 type = -1;
+  int32 uncompressed_size = 0;
+  int32 compressed_size = 0;
+  int32 num_values = 0;
+  int32 encoding = 0;
+  // Only set for data pages v2, whose levels are never compressed.
+  int32 num_nulls = 0;
+  int32 definition_levels_size = 0;
+  int32 repetition_levels_size = 0;
+  bool is_compressed = true;
+};
+
+// Parses the page header at the start of `*data` and removes it.
+Status ReadPageHeader(StringPiece* data, PageHeader* header) {
+  ThriftDecoder d(*data);
+  auto read_values_header = [&](int struct_type, bool v2) {
+    d.ReadStruct(struct_type, [&](int16 id, int type) {
+      if (id == 1) {
+        header->num_values = d.ReadI32(type);
+      } else if (!v2 && id == 2) {
+        header->encoding = d.ReadI32(type);
+      } else if (v2 && id == 2) {
+        header->num_nulls = d.ReadI32(type);
+      } else if (v2 && id == 4) {
+        header->encoding = d.ReadI32(type);
+      } else if (v2 && id == 5) {
+        header->definition_levels_size = d.ReadI32(type);
+      } else if (v2 && id == 6) {
+        header->repetition_levels_size = d.ReadI32(type);
+      } else if (v2 && id == 7) {
+        header->is_compressed = d.ReadBool(type);
+      } else {
+        d.Skip(type);
+      }
+    });
+  };
+  d.ReadStruct(kThriftStruct, [&](int16 id, int type) {
+    switch (id) {
+      case 1:
+        header->type = d.ReadI32(type);
+        break;
+      case 2:
+        header->uncompressed_size = d.ReadI32(type);
+        break;
+      case 3:
+        header->compressed_size = d.ReadI32(type);
+        break;
+      case 5:  // DataPageHeader
+      case 7:  // DictionaryPageHeader
+        read_values_header(type, /*v2=*/false);
+        break;
+      case 8:  // DataPageHeaderV2
+        read_values_header(type, /*v2=*/true);
+        break;
+      default:
+        d.Skip(type);
+    }
+  });
+  if (!d.ok()) return errors::DataLoss("corrupted Parquet page header");
+  data->remove_prefix(d.position() - data->data());
+  if (header->compressed_size < 0 || header->uncompressed_size < 0 ||
+      header->num_values < 0 || header->definition_levels_size < 0 ||
+      header->repetition_levels_size < 0 ||
+      static_cast<size_t>(header->compressed_size) > data->size()) {
+    return errors::DataLoss("invalid Parquet page header");
+  }
+  return OkStatus();
+}
+
+// Decompresses `input` into `*output`, using `*buffer` if needed.
+Status Decompress(int32 codec, StringPiece input, size_t uncompressed_size,
+                  std::string* buffer, StringPiece* output) {
+  if (codec == kUncompressed) {
+    *output = input;
+    return OkStatus();
+  }
+  buffer->resize(uncompressed_size);
+  bool ok = false;
+  switch (codec) {
+    case kSnappy: {
+      size_t size;
+      ok = port::Snappy_GetUncompressedLength(input.data(), input.size(),
+                                              &size) &&
+           size == uncompressed_size &&
+           port::Snappy_Uncompress(input.data(), input.size(), &(*buffer)[0]);
+      break;
+    }
+    case kGzip: {
+      z_stream stream;
+      std::memset(&stream, 0, sizeof(stream));
+      // Accept zlib as well as gzip headers.
+      if (inflateInit2(&stream, MAX_WBITS + 32) != Z_OK) {
+        return errors::Internal("inflateInit2 failed");
+      }
+      stream.next_in =
+          reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+      stream.avail_in = input.size();
+      stream.next_out = reinterpret_cast<Bytef*>(&(*buffer)[0]);
+      stream.avail_out = uncompressed_size;
+      ok = inflate(&stream, Z_FINISH) == Z_STREAM_END &&
+           stream.total_out == uncompressed_size;
+      inflateEnd(&stream);
+      break;
+    }
+    case kZstd: {
+      const size_t size = ZSTD_decompress(&(*buffer)[0], uncompressed_size,
+                                          input.data(), input.size());
+      ok = !ZSTD_isError(size) && size == uncompressed_size;
+      break;
+    }
+    default:
+      return errors::Unimplemented("Parquet compression codec ", codec,
+                                   " is not supported");
+  }
+  if (!ok) return errors::DataLoss("corrupted compressed Parquet page");
+  *output = StringPiece(*buffer);
+  return OkStatus();
+}
+
+// Decodes the RLE/bit-packing hybrid encoding of Parquet levels and
+// dictionary indices.
+class RleDecoder {
+ public:
+  RleDecoder(StringPiece data, int bit_width)
+      : data_(data), bit_width_(bit_width) {}
+
+  // Decodes the next `n` values into `out`. Returns false if the data ends
+  // first.
+  bool Get(int64_t n, uint32* out) {
+    const uint32 mask =
+        bit_width_ == 32 ? ~uint32{0} : (uint32{1} << bit_width_) - 1;
+    while (n > 0) {
+      if (repeated_left_ == 0 && packed_left_ == 0 && !NextRun()) return false;
+      if (repeated_left_ > 0) {
+        const int64_t k = std::min(n, repeated_left_);
+        std::fill_n(out, k, repeated_value_);
+        out += k;
+        n -= k;
+        repeated_left_ -= k;
+        continue;
+      }
+      const int64_t k = std::min(n, packed_left_);
+      for (int64_t i = 0; i < k; ++i, ++packed_index_) {
+        const int64_t bit = packed_index_ * bit_width_;
+        const uint8* p = packed_ + (bit >> 3);
+        const int shift = bit & 7;
+        const int num_bytes = (shift + bit_width_ + 7) >> 3;
+        uint64 bits = 0;
+        for (int j = 0; j < num_bytes; ++j) bits |= uint64{p[j]} << (8 * j);
+        *out++ = static_cast<uint32>(bits >> shift) & mask;
+      }
+      n -= k;
+      packed_left_ -= k;
+    }
+    return true;
+  }
+
+ private:
+  bool NextRun() {
+    uint64 header;
+    if (!core::GetVarint64(&data_, &header)) return false;
+    if (header & 1) {
+      // Groups of 8 bit-packed values. The last run may be cut short.
+      const uint64 num_groups = std::min<uint64>(
+          header >> 1, std::numeric_limits<int64_t>::max() / 8);
+      size_t num_bytes = num_groups * bit_width_;
+      if (num_groups > data_.size() || num_bytes > data_.size()) {
+        num_bytes = data_.size();
+      }
+      packed_ = reinterpret_cast<const uint8*>(data_.data());
+      packed_index_ = 0;
+      packed_left_ = bit_width_ == 0 ? num_groups * 8
+                                     : std::min<uint64>(num_groups * 8,
+                                                        num_bytes * 8 /
+                                                            bit_width_);
+      data_.remove_prefix(num_bytes);
+      return packed_left_ > 0;
+    }
+    const size_t value_size = (bit_width_ + 7) / 8;
+    if (data_.size() < value_size) return false;
+    repeated_value_ = 0;
+    for (size_t i = 0; i < value_size; ++i) {
+      repeated_value_ |= uint32{static_cast<uint8>(data_[i])} << (8 * i);
+    }
+    data_.remove_prefix(value_size);
+    repeated_left_ = header >> 1;
+    return repeated_left_ > 0;
+  }
+
+  StringPiece data_;
+  const int bit_width_;
+  int64_t repeated_left_ = 0;
+  uint32 repeated_value_ = 0;
+  int64_t packed_left_ = 0;
+  int64_t packed_index_ = 0;
+  const uint8* packed_ = nullptr;
+};
+
+// Decodes `n` PLAIN encoded values of `column` from the start of `*data`, and
+// removes them.
+template <typename T>
+Status DecodePlain(const ParquetColumn& column, StringPiece* data, int64_t n,
+                   T* out) {
+  const size_t size = n * sizeof(T);
+  if (data->size() < size) {
+    return errors::DataLoss("Parquet page is missing values");
+  }
+  std::memcpy(out, data->data(), size);
+  data->remove_prefix(size);
+  return OkStatus();
+}
+
+template <>
+Status DecodePlain<bool>(const ParquetColumn& column, StringPiece* data,
+                         int64_t n, bool* out) {
+  const size_t size = (n + 7) / 8;
+  if (data->size() < size) {
+    return errors::DataLoss("Parquet page is missing values");
+  }
+  const uint8* bits = reinterpret_cast<const uint8*>(data->data());
+  for (int64_t i = 0; i < n; ++i) out[i] = (bits[i >> 3] >> (i & 7)) & 1;
+  data->remove_prefix(size);
+  return OkStatus();
+}
+
+template <>
+Status DecodePlain<tstring>(const ParquetColumn& column, StringPiece* data,
+                            int64_t n, tstring* out) {
+  const bool fixed = column.type == ParquetType::kFixedLenByteArray;
+  for (int64_t i = 0; i < n; ++i) {
+    size_t size = column.type_length;
+    if (!fixed) {
+      if (data->size() < sizeof(uint32)) {
+        return errors::DataLoss("Parquet page is missing values");
+      }
+      size = core::DecodeFixed32(data->data());
+      data->remove_prefix(sizeof(uint32));
+    }
+    if (data->size() < size) {
+      return errors::DataLoss("Parquet page is missing values");
+    }
+    out[i].assign(data->data(), size);
+    data->remove_prefix(size);
+  }
+  return OkStatus();
+}
+
+// Decodes the pages of a column chunk into a vector of values.
+class ColumnChunkDecoder {
+ public:
+  ColumnChunkDecoder(const ParquetColumn& column, int32 codec, Tensor* values)
+      : column_(column), codec_(codec), values_(values) {}
+
+  Status Decode(StringPiece chunk) {
+    const int64_t num_rows = values_->NumElements();
+    while (num_decoded_ < num_rows) {
+      if (chunk.empty()) break;
+      PageHeader header;
+      TF_RETURN_IF_ERROR(ReadPageHeader(&chunk, &header));
+      const StringPiece page(chunk.data(), header.compressed_size);
+      chunk.remove_prefix(header.compressed_size);
+      switch (header.type) {
+        case kDictionaryPage:
+          TF_RETURN_IF_ERROR(DecodeDictionaryPage(header, page));
+          break;
+        case kDataPage:
+        case kDataPageV2:
+          TF_RETURN_IF_ERROR(DecodeDataPage(header, page));
+          break;
+        default:
+          // Index pages are not needed to read the values.
+          break;
+      }
+    }
+    if (num_decoded_ != num_rows) {
+      return errors::DataLoss("Parquet column chunk of ", column_.name,
+                              " has ", num_decoded_, " values but its row ",
+                              "group has ", num_rows, " rows");
+    }
+    return OkStatus();
+  }
+
+ private:
+  Status DecodeDictionaryPage(const PageHeader& header, StringPiece page) {
+    if (header.encoding != kPlainEncoding &&
+        header.encoding != kPlainDictionaryEncoding) {
+      return errors::Unimplemented("Parquet dictionary encoding ",
+                                   header.encoding, " is not supported");
+    }
+    StringPiece data;
+    TF_RETURN_IF_ERROR(Decompress(codec_, page, header.uncompressed_size,
+                                  &buffer_, &data));
+    dictionary_ = Tensor(values_->dtype(), TensorShape({header.num_values}));
+    return CallForDtype([&](auto* out) {
+      using T = std::remove_pointer_t<decltype(out)>;
+      return DecodePlain(column_, &data, header.num_values,
+                         dictionary_.flat<T>().data());
+    });
+  }
+
+  Status DecodeDataPage(const PageHeader& header, StringPiece page) {
+    const int64_t n = header.num_values;
+    if (n > values_->NumElements() - num_decoded_) {
+      return errors::DataLoss("Parquet column chunk of ", column_.name,
+                              " has more values than its row group has rows");
+    }
+    StringPiece data;
+    StringPiece levels;
+    if (header.type == kDataPage) {
+      TF_RETURN_IF_ERROR(Decompress(codec_, page, header.uncompressed_size,
+                                    &buffer_, &data));
+      if (column_.optional) {
+        if (data.size() < sizeof(uint32)) {
+          return errors::DataLoss("Parquet page is missing its levels");
+        }
+        const uint32 size = core::DecodeFixed32(data.data());
+        data.remove_prefix(sizeof(uint32));
+        if (data.size() < size) {
+          return errors::DataLoss("Parquet page is missing its levels");
+        }
+        levels = StringPiece(data.data(), size);
+        data.remove_prefix(size);
+      }
+    } else {
+      const int64_t levels_size =
+          int64_t{header.repetition_levels_size} +
+          header.definition_levels_size;
+      if (levels_size > page.size() ||
+          levels_size > header.uncompressed_size) {
+        return errors::DataLoss("Parquet page is missing its levels");
+      }
+      if (header.num_nulls > 0) return NullsError();
+      levels = StringPiece(page.data() + header.repetition_levels_size,
+                           header.definition_levels_size);
+      page.remove_prefix(levels_size);
+      TF_RETURN_IF_ERROR(Decompress(
+          header.is_compressed ? codec_ : kUncompressed, page,
+          header.uncompressed_size - levels_size, &buffer_, &data));
+    }
+    if (column_.optional) {
+      // Nulls have definition level 0 and values definition level 1.
+      levels_.resize(n);
+      if (!RleDecoder(levels, /*bit_width=*/1).Get(n, levels_.data())) {
+        return errors::DataLoss("Parquet page is missing levels");
+      }
+      for (uint32 level : levels_) {
+        if (level == 0) return NullsError();
+      }
+    }
+
+    TF_RETURN_IF_ERROR(CallForDtype([&](auto* out) {
+      using T = std::remove_pointer_t<decltype(out)>;
+      return DecodeValues(header.encoding, data, n,
+                          values_->flat<T>().data() + num_decoded_);
+    }));
+    num_decoded_ += n;
+    return OkStatus();
+  }
+
+  template <typename T>
+  Status DecodeValues(int32 encoding, StringPiece data, int64_t n, T* out) {
+    if (encoding == kPlainEncoding) {
+      return DecodePlain(column_, &data, n, out);
+    }
+    if (encoding != kPlainDictionaryEncoding &&
+        encoding != kRleDictionaryEncoding) {
+      return errors::Unimplemented("Parquet encoding ", encoding,
+                                   " is not supported");
+    }
+    if (dictionary_.dtype() == DT_INVALID) {
+      return errors::DataLoss("Parquet column chunk of ", column_.name,
+                              " has no dictionary page");
+    }
+    if (data.empty() || static_cast<uint8>(data[0]) > 32) {
+      return errors::DataLoss("invalid Parquet dictionary indices");
+    }
+    const int bit_width = static_cast<uint8>(data[0]);
+    data.remove_prefix(1);
+    indices_.resize(n);
+    if (!RleDecoder(data, bit_width).Get(n, indices_.data())) {
+      return errors::DataLoss("Parquet page is missing values");
+    }
+    const auto dictionary = dictionary_.flat<T>();
+    const uint32 dictionary_size = dictionary.size();
+    for (int64_t i = 0; i < n; ++i) {
+      if (indices_[i] >= dictionary_size) {
+        return errors::DataLoss("Parquet dictionary index ", indices_[i],
+                                " is out of range");
+      }
+      out[i] = dictionary(indices_[i]);
+    }
+    return OkStatus();
+  }
+
+  // Calls `fn(T*)` with a null pointer of the C++ type of the values.
+  template <typename Fn>
+  Status CallForDtype(Fn fn) {
+    switch (values_->dtype()) {
+      case DT_BOOL:
+        return fn(static_cast<bool*>(nullptr));
+      case DT_INT32:
+        return fn(static_cast<int32*>(nullptr));
+      case DT_INT64:
+        return fn(static_cast<int64_t*>(nullptr));
+      case DT_FLOAT:
+        return fn(static_cast<float*>(nullptr));
+      case DT_DOUBLE:
+        return fn(static_cast<double*>(nullptr));
+      case DT_STRING:
+        return fn(static_cast<tstring*>(nullptr));
+      default:
+        return errors::Internal("unexpected dtype ",
+                                DataTypeString(values_->dtype()));
+    }
+  }
+
+  Status NullsError() const {
+    return errors::Unimplemented("Parquet column ", column_.name,
+                                 " contains nulls, which are not supported");
+  }
+
+  const ParquetColumn& column_;
+  const int32 codec_;
+  Tensor* const values_;
+  int64_t num_decoded_ = 0;
+  Tensor dictionary_;
+  std::string buffer_;
+  std::vector<uint32> levels_;
+  std::vector<uint32> indices_;
+};
+
+// Decodes a PLAIN encoded statistic of a numeric column.
+bool DecodeStatistic(const ParquetColumn& column, const std::string& value,
+                     double* out) {
+  switch (column.type) {
+    case ParquetType::kBoolean:
+      if (value.size() != 1) return false;
+      *out = value[0] != 0;
+      return true;
+    case ParquetType::kInt32:
+      if (value.size() != sizeof(int32)) return false;
+      *out = static_cast<int32>(core::DecodeFixed32(value.data()));
+      return true;
+    case ParquetType::kInt64:
+      if (value.size() != sizeof(int64_t)) return false;
+      *out = static_cast<int64_t>(core::DecodeFixed64(value.data()));
+      return true;
+    case ParquetType::kFloat: {
+      float f;
+      if (value.size() != sizeof(f)) return false;
+      std::memcpy(&f, value.data(), sizeof(f));
+      *out = f;
+      return true;
+    }
+    case ParquetType::kDouble:
+      if (value.size() != sizeof(double)) return false;
+      std::memcpy(out, value.data(), sizeof(double));
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+ParquetReader::ParquetReader(const std::string& filename,
+                             std::unique_ptr<RandomAccessFile> file)
+    : filename_(filename), file_(std::move(file)) {}
+
+Status ParquetReader::Open(Env* env, const std::string& filename,
+                           std::unique_ptr<ParquetReader>* reader) {
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  reader->reset(new ParquetReader(filename, std::move(file)));
+  return (*reader)->ReadFooter(file_size);
+}
+
+Status ParquetReader::ReadFooter(uint64 file_size) {
+  if (file_size < kMagicSize + kTailSize) {
+    return errors::DataLoss(filename_, " is too small to be a Parquet file");
+  }
+  char tail[kTailSize];
+  StringPiece result;
+  TF_RETURN_IF_ERROR(
+      file_->Read(file_size - kTailSize, kTailSize, &result, tail));
+  if (result.size() != kTailSize ||
+      std::memcmp(result.data() + sizeof(uint32), kMagic, kMagicSize) != 0) {
+    return errors::DataLoss(filename_, " is not a Parquet file");
+  }
+  const uint64 metadata_size = core::DecodeFixed32(result.data());
+  if (metadata_size > file_size - kTailSize - kMagicSize) {
+    return errors::DataLoss(filename_, " has an invalid footer size");
+  }
+  const uint64 metadata_offset = file_size - kTailSize - metadata_size;
+  std::string metadata(metadata_size, '\0');
+  TF_RETURN_IF_ERROR(
+      file_->Read(metadata_offset, metadata_size, &result, &metadata[0]));
+  if (result.size() != metadata_size) {
+    return errors::DataLoss(filename_, " is truncated");
+  }
+
+  ThriftDecoder d(result);
+  std::vector<SchemaElement> schema;
+  bool external = false;
+  d.ReadStruct(kThriftStruct, [&](int16 id, int type) {
+    switch (id) {
+      case 2:
+        ReadStructList(&d, type, [&](int element_type) {
+          schema.emplace_back();
+          ReadSchemaElement(&d, element_type, &schema.back());
+        });
+        break;
+      case 3:
+        num_rows_ = d.ReadI64(type);
+        break;
+      case 4:
+        ReadStructList(&d, type, [&](int element_type) {
+          row_groups_.emplace_back();
+          ReadRowGroup(&d, element_type, &row_groups_.back(), &external);
+        });
+        break;
+      default:
+        d.Skip(type);
+    }
+  });
+  if (!d.ok()) {
+    return errors::DataLoss(filename_, " has corrupted Parquet metadata");
+  }
+  if (external) {
+    return errors::Unimplemented(
+        filename_, " has column chunks in other files, which are not "
+        "supported");
+  }
+  TF_RETURN_IF_ERROR(BuildColumns(schema, &columns_));
+
+  for (const ParquetRowGroup& row_group : row_groups_) {
+    if (row_group.columns.size() != columns_.size()) {
+      return errors::DataLoss(filename_, " has a row group with ",
+                              row_group.columns.size(), " columns but ",
+                              columns_.size(), " columns in its schema");
+    }
+    if (row_group.num_rows < 0) {
+      return errors::DataLoss(filename_, " has a row group with ",
+                              row_group.num_rows, " rows");
+    }
+    for (const ParquetColumnChunk& chunk : row_group.columns) {
+      if (chunk.offset < static_cast<int64_t>(kMagicSize) || chunk.size < 0 ||
+          chunk.size > static_cast<int64_t>(metadata_offset) - chunk.offset) {
+        return errors::DataLoss(filename_,
+                                " has a column chunk outside of its data");
+      }
+    }
+  }
+  return OkStatus();
+}
+
+int ParquetReader::FindColumn(StringPiece name) const {
+  for (int i = 0; i < columns_.size(); ++i) {
+    if (columns_[i].name == name) return i;
+  }
+  return -1;
+}
+
+bool ParquetReader::MayContain(int row_group, int column, double lower,
+                               double upper) const {
+  const ParquetColumnChunk& chunk = row_groups_[row_group].columns[column];
+  double min, max;
+  if (!chunk.has_min_max || !DecodeStatistic(columns_[column], chunk.min, &min) ||
+      !DecodeStatistic(columns_[column], chunk.max, &max)) {
+    return true;
+  }
+  return !(max < lower || min > upper);
+}
+
+Status ParquetReader::ReadColumn(int row_group, int column,
+                                 Tensor* values) const {
+  const ParquetColumn& c = columns_[column];
+  if (c.dtype == DT_INVALID) {
+    return errors::Unimplemented(
+        "Column ", c.name, " of ", filename_, " cannot be read: only top-level ",
+        "columns of primitive types other than INT96 are supported");
+  }
+  const ParquetRowGroup& group = row_groups_[row_group];
+  if (values->dtype() != c.dtype || values->dims() != 1 ||
+      values->NumElements() != group.num_rows) {
+    return errors::InvalidArgument(
+        "Expected a vector of ", group.num_rows, " ", DataTypeString(c.dtype),
+        " values to read column ", c.name, " but got ",
+        DataTypeString(values->dtype()), values->shape().DebugString());
+  }
+  const ParquetColumnChunk& chunk = group.columns[column];
+  std::unique_ptr<char[]> scratch(new char[chunk.size]);
+  StringPiece data;
+  TF_RETURN_IF_ERROR(file_->Read(chunk.offset, chunk.size, &data, scratch.get()));
+  if (data.size() != chunk.size) {
+    return errors::DataLoss(filename_, " is truncated");
+  }
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(
+      ColumnChunkDecoder(c, chunk.codec, values).Decode(data),
+      "while reading row group ", row_group, " of ", filename_);
+  return OkStatus();
+}
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
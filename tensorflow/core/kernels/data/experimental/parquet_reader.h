@@ -0,0 +1,130 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARQUET_READER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARQUET_READER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Physical types of Parquet columns, with the values of the Parquet format.
+enum class ParquetType {
+  kBoolean = 0,
+  kInt32 = 1,
+  kInt64 = 2,
+  kInt96 = 3,
+  kFloat = 4,
+  kDouble = 5,
+  kByteArray = 6,
+  kFixedLenByteArray = 7,
+};
+
+// A leaf column of a Parquet schema.
+struct ParquetColumn {
+  std::string name;
+  ParquetType type = ParquetType::kBoolean;
+  // Length of the values of FIXED_LEN_BYTE_ARRAY columns.
+  int32 type_length = 0;
+  // Whether the column is OPTIONAL rather than REQUIRED.
+  bool optional = false;
+  // The dtype the values of the column are decoded to, or DT_INVALID if the
+  // column cannot be read.
+  DataType dtype = DT_INVALID;
+};
+
+// The chunk of a column in a row group.
+struct ParquetColumnChunk {
+  // Byte range of the pages of the chunk in the file.
+  int64_t offset = 0;
+  int64_t size = 0;
+  // Compression codec of the pages, with the values of the Parquet format.
+  int32 codec = 0;
+  int64_t num_values = 0;
+  // PLAIN encoded minimum and maximum values of the chunk, if the writer
+  // recorded them.
+  bool has_min_max = false;
+  std::string min;
+  std::string max;
+};
+
+struct ParquetRowGroup {
+  int64_t num_rows = 0;
+  std::vector<ParquetColumnChunk> columns;
+};
+
+// Reads the columns of the row groups of a Parquet file.
+//
+// Only flat schemas are supported, i.e. REQUIRED or OPTIONAL columns at the top
+// level of the schema. Nested and repeated columns are listed by columns() but
+// cannot be read. Data pages (v1 and v2) with PLAIN or dictionary encoded
+// values, compressed with SNAPPY, GZIP or ZSTD or not at all, can be read.
+// OPTIONAL columns can be read as long as they do not contain nulls.
+class ParquetReader {
+ public:
+  // Opens the Parquet file `filename` and reads its footer.
+  static Status Open(Env* env, const std::string& filename,
+                     std::unique_ptr<ParquetReader>* reader);
+
+  const std::vector<ParquetColumn>& columns() const { return columns_; }
+
+  // Returns the index of the column called `name`, or -1 if there is none.
+  int FindColumn(StringPiece name) const;
+
+  int64_t num_rows() const { return num_rows_; }
+
+  int num_row_groups() const { return row_groups_.size(); }
+
+  const ParquetRowGroup& row_group(int i) const { return row_groups_[i]; }
+
+  // Returns whether the statistics of column `column` in row group `row_group`
+  // allow values in [lower, upper]. Returns true if the chunk has no
+  // statistics or the column is not numeric.
+  bool MayContain(int row_group, int column, double lower,
+                  double upper) const;
+
+  // Reads the values of column `column` in row group `row_group` into
+  // `*values`, which must be a vector of `row_group(row_group).num_rows`
+  // elements of the dtype of the column.
+  Status ReadColumn(int row_group, int column, Tensor* values) const;
+
+ private:
+  ParquetReader(const std::string& filename,
+                std::unique_ptr<RandomAccessFile> file);
+
+  Status ReadFooter(uint64 file_size);
+
+  const std::string filename_;
+  const std::unique_ptr<RandomAccessFile> file_;
+  std::vector<ParquetColumn> columns_;
+  int64_t num_rows_ = 0;
+  std::vector<ParquetRowGroup> row_groups_;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARQUET_READER_H_
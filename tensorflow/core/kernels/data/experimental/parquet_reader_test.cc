@@ -0,0 +1,492 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/parquet_reader.h"
+
+#include <zstd.h>
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// Writes values in the Thrift compact protocol.
+class ThriftWriter {
+ public:
+  void I32(int16 id, int32 value) {
+    Field(id, 5);
+    ZigZag(value);
+  }
+
+  void I64(int16 id, int64_t value) {
+    Field(id, 6);
+    ZigZag(value);
+  }
+
+  void Bool(int16 id, bool value) { Field(id, value ? 1 : 2); }
+
+  void Binary(int16 id, const std::string& value) {
+    Field(id, 8);
+    core::PutVarint64(&out_, value.size());
+    out_.append(value);
+  }
+
+  void BeginStruct(int16 id) {
+    Field(id, 12);
+    BeginListElement();
+  }
+
+  // Starts a list of `size` elements of type `type`. Structs are written with
+  // BeginListElement() and End().
+  void List(int16 id, int type, int size) {
+    Field(id, 9);
+    if (size < 15) {
+      out_.push_back(static_cast<char>(size << 4 | type));
+    } else {
+      out_.push_back(static_cast<char>(0xf0 | type));
+      core::PutVarint64(&out_, size);
+    }
+  }
+
+  void ListBinary(const std::string& value) {
+    core::PutVarint64(&out_, value.size());
+    out_.append(value);
+  }
+
+  void ListI32(int32 value) { ZigZag(value); }
+
+  void BeginListElement() {
+    last_ids_.push_back(last_id_);
+    last_id_ = 0;
+  }
+
+  void End() {
+    out_.push_back(0);
+    last_id_ = last_ids_.back();
+    last_ids_.pop_back();
+  }
+
+  const std::string& data() const { return out_; }
+
+ private:
+  void Field(int16 id, int type) {
+    const int delta = id - last_id_;
+    if (delta > 0 && delta <= 15) {
+      out_.push_back(static_cast<char>(delta << 4 | type));
+    } else {
+      out_.push_back(static_cast<char>(type));
+      ZigZag(id);
+    }
+    last_id_ = id;
+  }
+
+  void ZigZag(int64_t value) {
+    core::PutVarint64(&out_, (static_cast<uint64>(value) << 1) ^
+                                 static_cast<uint64>(value >> 63));
+  }
+
+  std::string out_;
+  int16 last_id_ = 0;
+  std::vector<int16> last_ids_;
+};
+
+enum Codec { kUncompressed = 0, kZstd = 6 };
+
+struct TestColumn {
+  std::string name;
+  ParquetType type;
+  bool optional;
+  bool dictionary;
+};
+
+// Writes Parquet files with the columns of kColumns, whose values in row `row`
+// are Int64Value(row), DoubleValue(row) and so on.
+class TestFileWriter {
+ public:
+  TestFileWriter(Codec codec, bool page_v2) : codec_(codec), v2_(page_v2) {
+    out_ = "PAR1";
+  }
+
+  void AddRowGroup(int64_t first_row, int64_t num_rows) {
+    RowGroup group;
+    group.num_rows = num_rows;
+    for (int c = 0; c < kNumColumns; ++c) {
+      group.chunks.push_back(WriteChunk(c, first_row, num_rows));
+    }
+    row_groups_.push_back(group);
+  }
+
+  std::string Finish() {
+    ThriftWriter w;
+    w.BeginListElement();
+    w.I32(1, 1);
+    w.List(2, 12, kNumColumns + 1);
+    w.BeginListElement();
+    w.Binary(4, "schema");
+    w.I32(5, kNumColumns);
+    w.End();
+    for (const TestColumn& column : kColumns) {
+      w.BeginListElement();
+      w.I32(1, static_cast<int32>(column.type));
+      w.I32(3, column.optional ? 1 : 0);
+      w.Binary(4, column.name);
+      w.End();
+    }
+    int64_t num_rows = 0;
+    for (const RowGroup& group : row_groups_) num_rows += group.num_rows;
+    w.I64(3, num_rows);
+    w.List(4, 12, row_groups_.size());
+    for (const RowGroup& group : row_groups_) {
+      w.BeginListElement();
+      w.List(1, 12, kNumColumns);
+      for (int c = 0; c < kNumColumns; ++c) {
+        const Chunk& chunk = group.chunks[c];
+        w.BeginListElement();
+        w.I64(2, chunk.offset);
+        w.BeginStruct(3);
+        w.I32(1, static_cast<int32>(kColumns[c].type));
+        w.List(2, 5, 1);
+        w.ListI32(kColumns[c].dictionary ? 8 : 0);
+        w.List(3, 8, 1);
+        w.ListBinary(kColumns[c].name);
+        w.I32(4, codec_);
+        w.I64(5, group.num_rows);
+        w.I64(6, chunk.size);
+        w.I64(7, chunk.size);
+        w.I64(9, chunk.data_page_offset);
+        if (kColumns[c].dictionary) w.I64(11, chunk.offset);
+        if (kColumns[c].type == ParquetType::kInt64) {
+          w.BeginStruct(12);
+          w.Binary(5, Plain(c, chunk.first_row + group.num_rows - 1, 1));
+          w.Binary(6, Plain(c, chunk.first_row, 1));
+          w.End();
+        }
+        w.End();
+        w.End();
+      }
+      w.I64(3, group.num_rows);
+      w.End();
+    }
+    w.End();
+    out_.append(w.data());
+    core::PutFixed32(&out_, w.data().size());
+    out_.append("PAR1");
+    return out_;
+  }
+
+  static constexpr int kNumColumns = 5;
+  static const TestColumn kColumns[kNumColumns];
+
+  static int64_t Int64Value(int64_t row) { return row * 3 - 7; }
+  static double DoubleValue(int64_t row) { return row * 0.25; }
+  static bool BoolValue(int64_t row) { return row % 3 == 0; }
+  static std::string StringValue(int64_t row) {
+    return strings::StrCat("value", row % 4);
+  }
+  static float FloatValue(int64_t row) { return row * -1.5f; }
+
+ private:
+  struct Chunk {
+    int64_t first_row;
+    int64_t offset;
+    int64_t data_page_offset;
+    int64_t size;
+  };
+  struct RowGroup {
+    int64_t num_rows;
+    std::vector<Chunk> chunks;
+  };
+
+  // Returns the PLAIN encoding of `n` values of column `c` from row `row`.
+  static std::string Plain(int c, int64_t row, int64_t n) {
+    std::string out;
+    for (int64_t i = row; i < row + n; ++i) {
+      switch (kColumns[c].type) {
+        case ParquetType::kInt64:
+          core::PutFixed64(&out, Int64Value(i));
+          break;
+        case ParquetType::kDouble: {
+          const double v = DoubleValue(i);
+          out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+          break;
+        }
+        case ParquetType::kFloat: {
+          const float v = FloatValue(i);
+          out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+          break;
+        }
+        case ParquetType::kBoolean:
+          if ((i - row) % 8 == 0) out.push_back(0);
+          out.back() |= BoolValue(i) << ((i - row) % 8);
+          break;
+        case ParquetType::kByteArray:
+          core::PutFixed32(&out, StringValue(i).size());
+          out.append(StringValue(i));
+          break;
+        default:
+          LOG(FATAL) << "unexpected type";
+      }
+    }
+    return out;
+  }
+
+  std::string Compress(const std::string& data) {
+    if (codec_ == kUncompressed) return data;
+    std::string out(ZSTD_compressBound(data.size()), '\0');
+    out.resize(
+        ZSTD_compress(&out[0], out.size(), data.data(), data.size(), 1));
+    return out;
+  }
+
+  // Writes a page of type `type`: 0 for data pages, 2 for dictionary pages
+  // and 3 for data pages v2.
+  void WritePage(int type, int num_values, int encoding,
+                 const std::string& levels, const std::string& values) {
+    std::string body;
+    ThriftWriter w;
+    w.BeginListElement();
+    w.I32(1, type);
+    if (type == 3) {
+      body = levels + Compress(values);
+      w.I32(2, levels.size() + values.size());
+    } else {
+      std::string uncompressed;
+      if (!levels.empty()) core::PutFixed32(&uncompressed, levels.size());
+      uncompressed += levels + values;
+      body = Compress(uncompressed);
+      w.I32(2, uncompressed.size());
+    }
+    w.I32(3, body.size());
+    if (type == 0) {
+      w.BeginStruct(5);
+      w.I32(1, num_values);
+      w.I32(2, encoding);
+      w.I32(3, 3);
+      w.I32(4, 3);
+      w.End();
+    } else if (type == 2) {
+      w.BeginStruct(7);
+      w.I32(1, num_values);
+      w.I32(2, encoding);
+      w.End();
+    } else {
+      w.BeginStruct(8);
+      w.I32(1, num_values);
+      w.I32(2, 0);
+      w.I32(3, num_values);
+      w.I32(4, encoding);
+      w.I32(5, levels.size());
+      w.I32(6, 0);
+      w.Bool(7, codec_ != kUncompressed);
+      w.End();
+    }
+    w.End();
+    out_.append(w.data());
+    out_.append(body);
+  }
+
+  Chunk WriteChunk(int c, int64_t first_row, int64_t num_rows) {
+    const TestColumn& column = kColumns[c];
+    Chunk chunk;
+    chunk.first_row = first_row;
+    chunk.offset = out_.size();
+    // Optional columns are written without nulls: a single run of level 1.
+    auto levels = [&](int64_t n) {
+      std::string out;
+      if (column.optional) {
+        core::PutVarint64(&out, n << 1);
+        out.push_back(1);
+      }
+      return out;
+    };
+    // Values are split in two pages to check that pages are concatenated.
+    const int64_t split = num_rows / 2;
+    if (column.dictionary) {
+      // The dictionary holds the values of the first 4 rows, which repeat.
+      WritePage(2, 4, 0, "", Plain(c, 0, 4));
+      chunk.data_page_offset = out_.size();
+      for (int64_t begin : {int64_t{0}, split}) {
+        const int64_t end = begin == 0 ? split : num_rows;
+        // Indices are bit-packed with a width of 2.
+        std::string indices(1, 2);
+        core::PutVarint64(&indices, ((end - begin + 7) / 8) << 1 | 1);
+        std::string bits((end - begin + 3) / 4, '\0');
+        for (int64_t i = begin; i < end; ++i) {
+          bits[(i - begin) / 4] |= ((first_row + i) % 4)
+                                   << ((i - begin) % 4 * 2);
+        }
+        bits.resize((end - begin + 7) / 8 * 2, '\0');
+        indices.append(bits);
+        WritePage(v2_ ? 3 : 0, end - begin, 8, levels(end - begin), indices);
+      }
+    } else {
+      chunk.data_page_offset = out_.size();
+      WritePage(v2_ ? 3 : 0, split, 0, levels(split),
+                Plain(c, first_row, split));
+      WritePage(v2_ ? 3 : 0, num_rows - split, 0, levels(num_rows - split),
+                Plain(c, first_row + split, num_rows - split));
+    }
+    chunk.size = out_.size() - chunk.offset;
+    return chunk;
+  }
+
+  const Codec codec_;
+  const bool v2_;
+  std::string out_;
+  std::vector<RowGroup> row_groups_;
+};
+
+const TestColumn TestFileWriter::kColumns[TestFileWriter::kNumColumns] = {
+    {"id", ParquetType::kInt64, false, false},
+    {"score", ParquetType::kDouble, true, false},
+    {"flag", ParquetType::kBoolean, false, false},
+    {"label", ParquetType::kByteArray, true, true},
+    {"weight", ParquetType::kFloat, false, false},
+};
+
+std::string WriteTestFile(const std::string& name, Codec codec, bool page_v2) {
+  TestFileWriter writer(codec, page_v2);
+  writer.AddRowGroup(0, 13);
+  writer.AddRowGroup(13, 6);
+  const std::string filename = io::JoinPath(testing::TmpDir(), name);
+  TF_CHECK_OK(WriteStringToFile(Env::Default(), filename, writer.Finish()));
+  return filename;
+}
+
+void CheckRowGroup(const ParquetReader& reader, int row_group,
+                   int64_t first_row) {
+  const int64_t n = reader.row_group(row_group).num_rows;
+  Tensor ids(DT_INT64, TensorShape({n}));
+  Tensor scores(DT_DOUBLE, TensorShape({n}));
+  Tensor flags(DT_BOOL, TensorShape({n}));
+  Tensor labels(DT_STRING, TensorShape({n}));
+  Tensor weights(DT_FLOAT, TensorShape({n}));
+  TF_ASSERT_OK(reader.ReadColumn(row_group, 0, &ids));
+  TF_ASSERT_OK(reader.ReadColumn(row_group, 1, &scores));
+  TF_ASSERT_OK(reader.ReadColumn(row_group, 2, &flags));
+  TF_ASSERT_OK(reader.ReadColumn(row_group, 3, &labels));
+  TF_ASSERT_OK(reader.ReadColumn(row_group, 4, &weights));
+  for (int64_t i = 0; i < n; ++i) {
+    const int64_t row = first_row + i;
+    EXPECT_EQ(ids.vec<int64_t>()(i), TestFileWriter::Int64Value(row));
+    EXPECT_EQ(scores.vec<double>()(i), TestFileWriter::DoubleValue(row));
+    EXPECT_EQ(flags.vec<bool>()(i), TestFileWriter::BoolValue(row));
+    EXPECT_EQ(labels.vec<tstring>()(i), TestFileWriter::StringValue(row));
+    EXPECT_EQ(weights.vec<float>()(i), TestFileWriter::FloatValue(row));
+  }
+}
+
+TEST(ParquetReaderTest, ReadsColumns) {
+  const std::string filename =
+      WriteTestFile("plain.parquet", kUncompressed, /*page_v2=*/false);
+  std::unique_ptr<ParquetReader> reader;
+  TF_ASSERT_OK(ParquetReader::Open(Env::Default(), filename, &reader));
+
+  ASSERT_EQ(reader->columns().size(), 5);
+  EXPECT_EQ(reader->columns()[0].name, "id");
+  EXPECT_EQ(reader->columns()[0].dtype, DT_INT64);
+  EXPECT_TRUE(reader->columns()[1].optional);
+  EXPECT_EQ(reader->columns()[1].dtype, DT_DOUBLE);
+  EXPECT_EQ(reader->columns()[2].dtype, DT_BOOL);
+  EXPECT_EQ(reader->columns()[3].dtype, DT_STRING);
+  EXPECT_EQ(reader->columns()[4].dtype, DT_FLOAT);
+  EXPECT_EQ(reader->FindColumn("label"), 3);
+  EXPECT_EQ(reader->FindColumn("missing"), -1);
+  EXPECT_EQ(reader->num_rows(), 19);
+  ASSERT_EQ(reader->num_row_groups(), 2);
+  EXPECT_EQ(reader->row_group(0).num_rows, 13);
+  EXPECT_EQ(reader->row_group(1).num_rows, 6);
+
+  CheckRowGroup(*reader, 0, 0);
+  CheckRowGroup(*reader, 1, 13);
+}
+
+TEST(ParquetReaderTest, ReadsCompressedPagesV2) {
+  const std::string filename =
+      WriteTestFile("zstd_v2.parquet", kZstd, /*page_v2=*/true);
+  std::unique_ptr<ParquetReader> reader;
+  TF_ASSERT_OK(ParquetReader::Open(Env::Default(), filename, &reader));
+  ASSERT_EQ(reader->num_row_groups(), 2);
+  CheckRowGroup(*reader, 0, 0);
+  CheckRowGroup(*reader, 1, 13);
+}
+
+TEST(ParquetReaderTest, MayContain) {
+  const std::string filename =
+      WriteTestFile("stats.parquet", kUncompressed, /*page_v2=*/false);
+  std::unique_ptr<ParquetReader> reader;
+  TF_ASSERT_OK(ParquetReader::Open(Env::Default(), filename, &reader));
+  // Ids are -7, -4, ..., 29 in row group 0 and 32, ..., 47 in row group 1.
+  EXPECT_TRUE(reader->MayContain(0, 0, 0, 10));
+  EXPECT_FALSE(reader->MayContain(1, 0, 0, 10));
+  EXPECT_FALSE(reader->MayContain(0, 0, 30, 31));
+  EXPECT_TRUE(reader->MayContain(1, 0, 47, 100));
+  // Columns without statistics may contain anything.
+  EXPECT_TRUE(reader->MayContain(0, 1, 1000, 2000));
+}
+
+TEST(ParquetReaderTest, WrongDtype) {
+  const std::string filename =
+      WriteTestFile("dtype.parquet", kUncompressed, /*page_v2=*/false);
+  std::unique_ptr<ParquetReader> reader;
+  TF_ASSERT_OK(ParquetReader::Open(Env::Default(), filename, &reader));
+  Tensor values(DT_INT32, TensorShape({13}));
+  EXPECT_TRUE(errors::IsInvalidArgument(reader->ReadColumn(0, 0, &values)));
+}
+
+TEST(ParquetReaderTest, NotAParquetFile) {
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "not_parquet.txt");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 "this is not a Parquet file at all"));
+  std::unique_ptr<ParquetReader> reader;
+  EXPECT_TRUE(errors::IsDataLoss(
+      ParquetReader::Open(Env::Default(), filename, &reader)));
+}
+
+TEST(ParquetReaderTest, CorruptedFooter) {
+  TestFileWriter writer(kUncompressed, /*page_v2=*/false);
+  writer.AddRowGroup(0, 13);
+  std::string contents = writer.Finish();
+  // Overwrites the start of the metadata.
+  const uint32 metadata_size =
+      core::DecodeFixed32(contents.data() + contents.size() - 8);
+  const size_t metadata_offset = contents.size() - 8 - metadata_size;
+  for (size_t i = metadata_offset; i < metadata_offset + 4; ++i) {
+    contents[i] = '\xff';
+  }
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "corrupted.parquet");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+  std::unique_ptr<ParquetReader> reader;
+  EXPECT_TRUE(errors::IsDataLoss(
+      ParquetReader::Open(Env::Default(), filename, &reader)));
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -874,9 +874,10 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         ctx,
         compression_ == io::compression::kNone ||
             compression_ == io::compression::kGzip ||
-            compression_ == io::compression::kSnappy,
-        errors::InvalidArgument("compression must be either '', 'GZIP' or "
-                                "'SNAPPY'."));
+            compression_ == io::compression::kSnappy ||
+            compression_ == io::compression::kZstd,
+        errors::InvalidArgument("compression must be either '', 'GZIP', "
+                                "'SNAPPY' or 'ZSTD'."));
 
     OP_REQUIRES(
         ctx, pending_snapshot_expiry_seconds_ >= 1,
@@ -21,7 +21,10 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/stats_utils.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -49,6 +52,7 @@ namespace data {
 /* static */ constexpr const char* const PrefetchDatasetOp::kSlackPeriod;
 /* static */ constexpr const char* const PrefetchDatasetOp::kLegacyAutotune;
 /* static */ constexpr const char* const PrefetchDatasetOp::kBufferSizeMin;
+/* static */ constexpr const char* const PrefetchDatasetOp::kCopyToDevice;
 
 namespace {
 
@@ -65,17 +69,32 @@ constexpr char kErrorMessageSuffix[] = ".error_message";
 class PrefetchDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
-          int64_t slack_period, bool legacy_autotune, int64_t buffer_size_min)
+          int64_t slack_period, bool legacy_autotune, int64_t buffer_size_min,
+          bool copy_to_device)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         slack_period_(slack_period),
         legacy_autotune_(legacy_autotune),
-        buffer_size_min_(buffer_size_min) {
+        buffer_size_min_(buffer_size_min),
+        copy_to_device_(copy_to_device) {
     input_->Ref();
+    // Elements are only copied when the dataset is placed on an accelerator.
+    if (copy_to_device_ && ctx->device() != nullptr &&
+        ctx->device()->tensorflow_accelerator_device_info() != nullptr &&
+        ctx->op_device_context() != nullptr) {
+      device_ = static_cast<Device*>(ctx->device());
+      device_context_ = ctx->op_device_context();
+      device_context_->Ref();
+    }
   }
 
-  ~Dataset() override { input_->Unref(); }
+  ~Dataset() override {
+    input_->Unref();
+    if (device_context_ != nullptr) {
+      device_context_->Unref();
+    }
+  }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
@@ -129,12 +148,15 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     b->BuildAttrValue(legacy_autotune_, &legacy_autotune_attr);
     AttrValue buffer_size_min_attr;
     b->BuildAttrValue(buffer_size_min_, &buffer_size_min_attr);
+    AttrValue copy_to_device_attr;
+    b->BuildAttrValue(copy_to_device_, &copy_to_device_attr);
 
     TF_RETURN_IF_ERROR(
         b->AddDataset(this, {input_graph_node, buffer_size},
                       {std::make_pair(kSlackPeriod, slack_period_attr),
                        std::make_pair(kLegacyAutotune, legacy_autotune_attr),
-                       std::make_pair(kBufferSizeMin, buffer_size_min_attr)},
+                       std::make_pair(kBufferSizeMin, buffer_size_min_attr),
+                       std::make_pair(kCopyToDevice, copy_to_device_attr)},
                       output));
     return OkStatus();
   }
@@ -269,10 +291,13 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           TF_RETURN_IF_ERROR(writer->WriteScalar(
               absl::StrCat(prefix(), "::", i),
               absl::StrCat(kBuffer, kSizeSuffix), buffer_element.value.size()));
-          for (size_t j = 0; j < buffer_element.value.size(); j++) {
+          std::vector<Tensor> host_value;
+          TF_RETURN_IF_ERROR(
+              dataset()->CopyElementToHost(buffer_element.value, &host_value));
+          for (size_t j = 0; j < host_value.size(); j++) {
             TF_RETURN_IF_ERROR(writer->WriteTensor(
                 absl::StrCat(prefix(), "::", i),
-                absl::StrCat(kBuffer, "[", j, "]"), buffer_element.value[j]));
+                absl::StrCat(kBuffer, "[", j, "]"), host_value[j]));
           }
         }
       }
@@ -312,6 +337,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
                                    absl::StrCat(kBuffer, "[", j, "]"),
                                    &buffer_element.value.back()));
           }
+          TF_RETURN_IF_ERROR(
+              dataset()->CopyElementToDevice(&buffer_element.value));
         }
         RecordBufferEnqueue(ctx, buffer_element.value);
       }
@@ -519,6 +546,17 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
               ctx.get(), &buffer_element.value, &end_of_sequence);
           buffer_element.checkpoint = ctx->checkpoint();
         }
+        if (buffer_element.status.ok() && !end_of_sequence) {
+          profiler::TraceMe traceme(
+              [&] {
+                return profiler::TraceMeEncode(
+                    "PrefetchCopyToDevice",
+                    {{"element_id", buffer_element.uid}});
+              },
+              profiler::kInfo);
+          buffer_element.status =
+              dataset()->CopyElementToDevice(&buffer_element.value);
+        }
         if (buffer_element.status.ok() && end_of_sequence) {
           mutex_lock l(*mu_);
           prefetch_thread_finished_ = true;
@@ -613,6 +651,50 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     std::unique_ptr<Thread> prefetch_thread_ TF_GUARDED_BY(*mu_);
   };
 
+  // Copies the components of `element` that can be memcpy-ed into device
+  // memory. Other components are left in host memory. This is a no-op unless
+  // elements are copied to the device.
+  Status CopyElementToDevice(std::vector<Tensor>* element) const {
+    if (device_ == nullptr) {
+      return OkStatus();
+    }
+    Allocator* allocator = device_->GetAllocator(AllocatorAttributes());
+    for (Tensor& tensor : *element) {
+      if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+        continue;
+      }
+      // The copy is enqueued on the device's host-to-device stream, so that it
+      // overlaps with computation on the device.
+      Tensor device_tensor(allocator, tensor.dtype(), tensor.shape());
+      TF_RETURN_IF_ERROR(device_context_->CopyCPUTensorToDeviceSync(
+          &tensor, device_, &device_tensor));
+      tensor = std::move(device_tensor);
+    }
+    return OkStatus();
+  }
+
+  // Inverse of `CopyElementToDevice`, used for checkpointing the buffer.
+  Status CopyElementToHost(const std::vector<Tensor>& element,
+                           std::vector<Tensor>* host_element) const {
+    if (device_ == nullptr) {
+      *host_element = element;
+      return OkStatus();
+    }
+    host_element->clear();
+    host_element->reserve(element.size());
+    for (const Tensor& tensor : element) {
+      if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+        host_element->push_back(tensor);
+        continue;
+      }
+      Tensor host_tensor(cpu_allocator(), tensor.dtype(), tensor.shape());
+      TF_RETURN_IF_ERROR(device_context_->CopyDeviceTensorToCPUSync(
+          &tensor, /*tensor_name=*/"", device_, &host_tensor));
+      host_element->push_back(std::move(host_tensor));
+    }
+    return OkStatus();
+  }
+
   const DatasetBase* const input_;
   const int64_t buffer_size_;
 
@@ -627,6 +709,15 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
   // parameter.
   const int64_t buffer_size_min_ = 0;
 
+  // Determines whether buffered elements are copied to device memory when the
+  // dataset is placed on an accelerator.
+  const bool copy_to_device_ = false;
+
+  // The device and device context used to copy buffered elements, or nullptr
+  // if elements stay in host memory.
+  Device* device_ = nullptr;
+  DeviceContext* device_context_ = nullptr;
+
   TraceMeMetadata traceme_metadata_;
 };
 
@@ -641,6 +732,9 @@ PrefetchDatasetOp::PrefetchDatasetOp(OpKernelConstruction* ctx)
   if (ctx->HasAttr(kBufferSizeMin)) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr(kBufferSizeMin, &buffer_size_min_));
   }
+  if (ctx->HasAttr(kCopyToDevice)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCopyToDevice, &copy_to_device_));
+  }
   if (GetExperiments().contains("autotune_buffer_optimization")) {
     legacy_autotune_ = false;
     buffer_size_min_ = std::max(static_cast<int64_t>(1), buffer_size_min_);
@@ -662,7 +756,7 @@ void PrefetchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
   }
 
   *output = new Dataset(ctx, input, buffer_size, slack_period_,
-                        legacy_autotune_, buffer_size_min_);
+                        legacy_autotune_, buffer_size_min_, copy_to_device_);
 }
 
 namespace {
@@ -12,7 +12,14 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_dataset_op.h"
 
+#include <atomic>
+#include <cstring>
+
 #include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/refcount.h"
 
 namespace tensorflow {
 namespace data {
@@ -29,13 +36,15 @@ class PrefetchDatasetParams : public DatasetParams {
                         DataTypeVector output_dtypes,
                         std::vector<PartialTensorShape> output_shapes,
                         int64_t slack_period, bool legacy_autotune,
-                        int64_t buffer_size_min, string node_name)
+                        int64_t buffer_size_min, string node_name,
+                        bool copy_to_device = false)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         buffer_size_(buffer_size),
         slack_period_(slack_period),
         legacy_autotune_(legacy_autotune),
-        buffer_size_min_(buffer_size_min) {
+        buffer_size_min_(buffer_size_min),
+        copy_to_device_(copy_to_device) {
     input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -61,6 +70,7 @@ class PrefetchDatasetParams : public DatasetParams {
     attr_vector->emplace_back("legacy_autotune", legacy_autotune_);
     attr_vector->emplace_back("buffer_size_min", buffer_size_min_);
     attr_vector->emplace_back("metadata", "");
+    attr_vector->emplace_back("copy_to_device", copy_to_device_);
     return OkStatus();
   }
 
@@ -73,6 +83,7 @@ class PrefetchDatasetParams : public DatasetParams {
   int64_t slack_period_;
   bool legacy_autotune_;
   int64_t buffer_size_min_;
+  bool copy_to_device_;
 };
 
 // Test case 1: positive buffer size.
@@ -331,6 +342,157 @@ TEST_F(PrefetchDatasetOpTest, InvalidBufferSize) {
   EXPECT_EQ(Initialize(dataset_params).code(), error::INVALID_ARGUMENT);
 }
 
+// Device context of a fake accelerator whose memory is host memory. It counts
+// the copies between host and device.
+class FakeDeviceContext : public DeviceContext {
+ public:
+  void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
+                             Tensor* device_tensor, StatusCallback done,
+                             bool sync_dst_compute) const override {
+    ++num_host_to_device_copies_;
+    CopyTensorBytes(*cpu_tensor, device_tensor);
+    done(OkStatus());
+  }
+
+  void CopyDeviceTensorToCPU(const Tensor* device_tensor,
+                             StringPiece tensor_name, Device* device,
+                             Tensor* cpu_tensor, StatusCallback done) override {
+    ++num_device_to_host_copies_;
+    CopyTensorBytes(*device_tensor, cpu_tensor);
+    done(OkStatus());
+  }
+
+  int64_t num_host_to_device_copies() const {
+    return num_host_to_device_copies_;
+  }
+  int64_t num_device_to_host_copies() const {
+    return num_device_to_host_copies_;
+  }
+
+ private:
+  static void CopyTensorBytes(const Tensor& src, Tensor* dst) {
+    std::memcpy(const_cast<char*>(dst->tensor_data().data()),
+                src.tensor_data().data(), src.TotalBytes());
+  }
+
+  mutable std::atomic<int64_t> num_host_to_device_copies_{0};
+  std::atomic<int64_t> num_device_to_host_copies_{0};
+};
+
+// Runs the prefetch dataset on a device that pretends to be an accelerator.
+class PrefetchDatasetOpCopyToDeviceTest : public PrefetchDatasetOpTest {
+ protected:
+  void SetUp() override {
+    device_info_.default_context = device_context_.get();
+    device_->set_tensorflow_accelerator_device_info(&device_info_);
+  }
+
+  void TearDown() override {
+    device_->set_tensorflow_accelerator_device_info(nullptr);
+  }
+
+  // Returns a prefetch dataset with a buffer of 5 elements over the elements
+  // of `components`.
+  static PrefetchDatasetParams CopyToDeviceParams(
+      std::vector<Tensor> components, DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes, bool copy_to_device) {
+    return PrefetchDatasetParams(
+        TensorSliceDatasetParams(std::move(components),
+                                 /*node_name=*/"tensor_slice"),
+        /*buffer_size=*/5, std::move(output_dtypes), std::move(output_shapes),
+        /*slack_period=*/0,
+        /*legacy_autotune=*/true,
+        /*buffer_size_min=*/0,
+        /*node_name=*/kNodeName, copy_to_device);
+  }
+
+  core::RefCountPtr<FakeDeviceContext> device_context_{
+      new FakeDeviceContext()};
+  DeviceBase::AcceleratorDeviceInfo device_info_;
+};
+
+TEST_F(PrefetchDatasetOpCopyToDeviceTest, GetNext) {
+  const std::vector<tstring> strings = {"a", "b", "c", "d", "e",
+                                        "f", "g", "h", "i", "j"};
+  TF_ASSERT_OK(Initialize(CopyToDeviceParams(
+      {CreateTensor<int64_t>(TensorShape{10, 1},
+                             {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}),
+       CreateTensor<tstring>(TensorShape{10}, strings)},
+      {DT_INT64, DT_STRING}, {PartialTensorShape({1}), PartialTensorShape({})},
+      /*copy_to_device=*/true)));
+  std::vector<Tensor> expected_outputs;
+  for (int64_t i = 0; i < 10; ++i) {
+    expected_outputs.push_back(CreateTensor<int64_t>(TensorShape{1}, {i}));
+    expected_outputs.push_back(
+        CreateTensor<tstring>(TensorShape{}, {strings[i]}));
+  }
+  TF_ASSERT_OK(CheckIteratorGetNext(expected_outputs, /*compare_order=*/true));
+  // Only the components that can be memcpy-ed are copied to the device.
+  EXPECT_EQ(device_context_->num_host_to_device_copies(), 10);
+  EXPECT_EQ(device_context_->num_device_to_host_copies(), 0);
+}
+
+TEST_F(PrefetchDatasetOpCopyToDeviceTest, NoCopyByDefault) {
+  TF_ASSERT_OK(Initialize(CopyToDeviceParams(
+      {CreateTensor<int64_t>(TensorShape{10, 1},
+                             {0, 1, 2, 3, 4, 5, 6, 7, 8, 9})},
+      {DT_INT64}, {PartialTensorShape({1})}, /*copy_to_device=*/false)));
+  TF_ASSERT_OK(CheckIteratorGetNext(
+      CreateTensors<int64_t>(
+          TensorShape{1}, {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}}),
+      /*compare_order=*/true));
+  EXPECT_EQ(device_context_->num_host_to_device_copies(), 0);
+}
+
+TEST_F(PrefetchDatasetOpCopyToDeviceTest, SaveAndRestore) {
+  const std::vector<Tensor> expected_outputs = CreateTensors<int64_t>(
+      TensorShape{1}, {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}});
+  auto dataset_params = CopyToDeviceParams(
+      {CreateTensor<int64_t>(TensorShape{10, 1},
+                             {0, 1, 2, 3, 4, 5, 6, 7, 8, 9})},
+      {DT_INT64}, {PartialTensorShape({1})}, /*copy_to_device=*/true);
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  // Waits for the prefetch thread to fill the buffer, so that the checkpoint
+  // holds 5 elements in device memory.
+  while (device_context_->num_host_to_device_copies() < 8) {
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+  VariantTensorDataWriter writer;
+  TF_ASSERT_OK(iterator_->Save(serialization_ctx.get(), &writer));
+  EXPECT_EQ(device_context_->num_device_to_host_copies(), 5);
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+  VariantTensorDataReader reader(data);
+  TF_ASSERT_OK(RestoreIterator(iterator_ctx_.get(), &reader,
+                               dataset_params.iterator_prefix(), *dataset_,
+                               &iterator_));
+  // The restored buffer is copied to the device again.
+  EXPECT_EQ(device_context_->num_host_to_device_copies(), 13);
+
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                           /*compare_order=*/true));
+  EXPECT_EQ(device_context_->num_host_to_device_copies(), 15);
+  EXPECT_EQ(device_context_->num_device_to_host_copies(), 5);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
@@ -202,6 +203,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           params.dataset->buffer_size_);
     }
 
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
     Status Initialize(IteratorContext* ctx) override {
       mutex_lock l(mu_);
       seed_generator_->GenerateSeeds(&seed_, &seed2_);
@@ -232,6 +235,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       this->RecordBufferDequeue(ctx, *out_tensors);
       std::swap(buffer_->at(index),
                 buffer_->at(slices_.front()->start % buffer_->size()));
+      if (ctx->symbolic_checkpoint()) {
+        checkpoint_indices_.insert(index);
+        checkpoint_indices_.insert(slices_.front()->start % buffer_->size());
+      }
       slices_.front()->start++;
       num_elements_--;
       return OkStatus();
@@ -265,8 +272,13 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kSeed2), seed2_));
 
       // Save input iterator if it hasn't been exhausted else write
-      // "end_of_input_sequence".
-      if (!input_impl_) {
+      // "end_of_input_sequence". Symbolic checkpoints are merged across saves,
+      // so they record whether the input is exhausted as a value instead.
+      if (ctx->symbolic_checkpoint()) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(this->full_name(kEndOfInputSequence),
+                                static_cast<int64_t>(!input_impl_)));
+      } else if (!input_impl_) {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(this->full_name(kEndOfInputSequence), ""));
       } else {
@@ -277,7 +289,19 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kEpoch), epoch_));
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(this->full_name(kNumElements), num_elements_));
-      TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(writer, prefix(), *buffer_));
+      if (ctx->symbolic_checkpoint() && buffer_checkpointed_) {
+        // Only the buffer elements which changed since the last save need to
+        // be written, as symbolic checkpoints are merged across saves.
+        TF_RETURN_IF_ERROR(UpdateCheckpointElements(writer, prefix(), *buffer_,
+                                                    checkpoint_indices_));
+      } else {
+        TF_RETURN_IF_ERROR(
+            WriteElementsToCheckpoint(writer, prefix(), *buffer_));
+      }
+      if (ctx->symbolic_checkpoint()) {
+        buffer_checkpointed_ = true;
+        checkpoint_indices_.clear();
+      }
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(this->full_name(kSlicesSize), slices_.size()));
       for (size_t i = 0; i < slices_.size(); ++i) {
@@ -313,7 +337,17 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       ResetRngs();
 
       // Restore the input iterator if it wasn't already exhausted.
-      if (!reader->Contains(this->full_name(kEndOfInputSequence))) {
+      bool end_of_input_sequence;
+      if (ctx->symbolic_checkpoint()) {
+        int64_t temp;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(this->full_name(kEndOfInputSequence), &temp));
+        end_of_input_sequence = static_cast<bool>(temp);
+      } else {
+        end_of_input_sequence =
+            reader->Contains(this->full_name(kEndOfInputSequence));
+      }
+      if (!end_of_input_sequence) {
         TF_RETURN_IF_ERROR(this->dataset()->input_->MakeIterator(
             ctx, this, this->prefix(), &input_impl_));
         TF_RETURN_IF_ERROR(this->RestoreInput(ctx, reader, input_impl_));
@@ -339,6 +373,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         RecordBufferEnqueue(ctx, element);
       }
       buffer_->resize(dataset()->buffer_size_);
+      buffer_checkpointed_ = false;
+      checkpoint_indices_.clear();
       slices_.clear();
       for (size_t i = 0; i < slices_size; ++i) {
         int64_t start;
@@ -462,6 +498,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       this->RecordBufferEnqueue(ctx, element);
       size_t index = slices_.back()->end % buffer_->size();
       buffer_->at(index) = std::move(element);
+      if (ctx->symbolic_checkpoint()) {
+        checkpoint_indices_.insert(index);
+      }
       num_elements_++;
       slices_.back()->end++;
     }
@@ -500,6 +539,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         TF_GUARDED_BY(mu_);
     int64_t num_random_samples_ TF_GUARDED_BY(mu_) = 0;
     bool data_produced_ TF_GUARDED_BY(mu_) = false;
+    // Whether all of `buffer_` has been written to the symbolic checkpoint.
+    bool buffer_checkpointed_ TF_GUARDED_BY(mu_) = false;
+    // Indices of `buffer_` that changed since the last symbolic checkpoint.
+    absl::flat_hash_set<int64_t> checkpoint_indices_ TF_GUARDED_BY(mu_);
   };
 
   const DatasetBase* const input_;
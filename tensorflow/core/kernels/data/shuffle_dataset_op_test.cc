@@ -554,6 +554,86 @@ INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+// Restores an iterator from the symbolic checkpoint accumulated by `ctx`.
+Status RestoreFromSymbolicCheckpoint(const DatasetBase& dataset,
+                                     const std::string& prefix,
+                                     IteratorContext* ctx,
+                                     IteratorContext* restore_ctx,
+                                     std::unique_ptr<IteratorBase>* iterator) {
+  TF_RETURN_IF_ERROR(ctx->checkpoint().GetStatus());
+  VariantTensorDataWriter writer;
+  TF_RETURN_IF_ERROR(ctx->checkpoint().Save(&writer));
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+  VariantTensorDataReader reader(data);
+  return dataset.MakeIteratorFromCheckpoint(restore_ctx, prefix, &reader,
+                                            iterator);
+}
+
+// Returns the remaining outputs of `iterator`.
+Status GetRemainingOutputs(IteratorBase* iterator, IteratorContext* ctx,
+                           std::vector<Tensor>* outputs) {
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_RETURN_IF_ERROR(iterator->GetNext(ctx, &next, &end_of_sequence));
+    outputs->insert(outputs->end(), next.begin(), next.end());
+  }
+  return OkStatus();
+}
+
+TEST_F(ShuffleDatasetOpTest, SymbolicCheckpointRoundTrip) {
+  auto dataset_params = ShuffleDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  const std::string& prefix = dataset_params.iterator_prefix();
+  IteratorContext::Params params(iterator_ctx_.get());
+  params.symbolic_checkpoint = true;
+  std::vector<Tensor> expected_outputs;
+  {
+    IteratorContext ctx(params);
+    std::unique_ptr<IteratorBase> iterator;
+    TF_ASSERT_OK(dataset_->MakeIterator(&ctx, /*parent=*/nullptr, prefix,
+                                        &iterator));
+    TF_ASSERT_OK(GetRemainingOutputs(iterator.get(), &ctx, &expected_outputs));
+  }
+  ASSERT_EQ(expected_outputs.size(), 10);
+
+  // After the first GetNext, the checkpoint of `ctx` only receives the buffer
+  // elements which changed, merged into the full buffer written before.
+  IteratorContext ctx(params);
+  std::unique_ptr<IteratorBase> iterator;
+  TF_ASSERT_OK(
+      dataset_->MakeIterator(&ctx, /*parent=*/nullptr, prefix, &iterator));
+  for (int i = 0; i < expected_outputs.size(); ++i) {
+    IteratorContext restore_ctx(params);
+    std::unique_ptr<IteratorBase> restored;
+    TF_ASSERT_OK(RestoreFromSymbolicCheckpoint(*dataset_, prefix, &ctx,
+                                               &restore_ctx, &restored));
+    std::vector<Tensor> outputs;
+    bool end_of_sequence = false;
+    TF_ASSERT_OK(restored->GetNext(&restore_ctx, &outputs, &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+
+    // The restored iterator writes its whole buffer once, and then only the
+    // changes again.
+    IteratorContext second_restore_ctx(params);
+    TF_ASSERT_OK(RestoreFromSymbolicCheckpoint(
+        *dataset_, prefix, &restore_ctx, &second_restore_ctx, &restored));
+    TF_ASSERT_OK(
+        GetRemainingOutputs(restored.get(), &second_restore_ctx, &outputs));
+    TF_EXPECT_OK(ExpectEqual(outputs,
+                             std::vector<Tensor>(expected_outputs.begin() + i,
+                                                 expected_outputs.end()),
+                             /*compare_order=*/true));
+
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(iterator->GetNext(&ctx, &next, &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+    TF_EXPECT_OK(ExpectEqual(next, {expected_outputs[i]},
+                             /*compare_order=*/true));
+  }
+}
+
 TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   std::vector<ShuffleDatasetParams> dataset_params_vec(
       {ShuffleDatasetParamsWithInvalidBufferSize(),
@@ -14,6 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -25,6 +32,12 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -36,9 +49,28 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kFileNames;
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
+/* static */ constexpr const char* const TFRecordDatasetOp::kGlobalShuffle;
+/* static */ constexpr const char* const TFRecordDatasetOp::kSeed;
+/* static */ constexpr const char* const TFRecordDatasetOp::kSeed2;
+
+// Returns true if files are read with direct I/O, bypassing the page cache,
+// as set by the TF_DIRECT_IO_READS environment variable.
+static bool ReadFilesWithDirectIo() {
+  static const bool direct_io = [] {
+    bool direct_io;
+    if (!ReadBoolFromEnvVar("TF_DIRECT_IO_READS", false, &direct_io).ok()) {
+      direct_io = false;
+    }
+    return direct_io;
+  }();
+  return direct_io;
+}
 
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
+constexpr char kPosition[] = "position";
+constexpr char kShuffleSeed[] = "shuffle_seed";
+constexpr char kShuffleSeed2[] = "shuffle_seed2";
 constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
@@ -52,15 +84,81 @@ bool is_cloud_tpu_gcs_fs() {
   return false;
 }
 
+// 16M offsets, i.e. 128MB.
+constexpr int64_t kDefaultRecordOffsetsCacheMaxRecords = 16LL << 20;
+
+Status RecordOffsetsCache::Get(
+    Env* env, const string& filename,
+    std::shared_ptr<const std::vector<uint64>>* offsets) {
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  const string key = strings::StrCat(filename, ":", file_size);
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second);
+      *offsets = it->second->second;
+      return OkStatus();
+    }
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  // Only the record headers are read; the record data is skipped.
+  io::RecordReader reader(file.get());
+  auto record_offsets = std::make_shared<std::vector<uint64>>();
+  uint64 offset = 0;
+  while (offset < file_size) {
+    record_offsets->push_back(offset);
+    int num_skipped;
+    TF_RETURN_IF_ERROR(reader.SkipRecords(&offset, 1, &num_skipped));
+  }
+  const int64_t num_records = record_offsets->size();
+  *offsets = std::move(record_offsets);
+  mutex_lock l(mu_);
+  // Another reader may have cached the same file in the meantime.
+  if (num_records > max_records_ || entries_.contains(key)) {
+    return OkStatus();
+  }
+  lru_.emplace_front(key, *offsets);
+  entries_[key] = lru_.begin();
+  num_records_ += num_records;
+  while (num_records_ > max_records_) {
+    const Entry& entry = lru_.back();
+    num_records_ -= entry.second->size();
+    entries_.erase(entry.first);
+    lru_.pop_back();
+  }
+  return OkStatus();
+}
+
+/* static */ RecordOffsetsCache* RecordOffsetsCache::Global() {
+  static RecordOffsetsCache* cache = [] {
+    int64_t max_records;
+    if (!ReadInt64FromEnvVar("TF_TFRECORD_INDEX_CACHE_MAX_RECORDS",
+                             kDefaultRecordOffsetsCacheMaxRecords,
+                             &max_records)
+             .ok()) {
+      max_records = kDefaultRecordOffsetsCacheMaxRecords;
+    }
+    return new RecordOffsetsCache(max_records);
+  }();
+  return cache;
+}
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64_t buffer_size)
+                   const string& compression_type, int64_t buffer_size,
+                   bool global_shuffle, int64_t seed, int64_t seed2)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
-            compression_type)) {
+            compression_type)),
+        global_shuffle_(global_shuffle),
+        seed_(seed),
+        seed2_(seed2) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
@@ -68,6 +166,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
+    if (global_shuffle_) {
+      return std::make_unique<GlobalShuffleIterator>(
+          GlobalShuffleIterator::Params{
+              this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+    }
     return std::make_unique<Iterator>(Iterator::Params{
         this, name_utils::IteratorPrefix(kDatasetType, prefix)});
   }
@@ -103,8 +206,18 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+    AttrValue global_shuffle_attr;
+    b->BuildAttrValue(global_shuffle_, &global_shuffle_attr);
+    AttrValue seed_attr;
+    b->BuildAttrValue(seed_, &seed_attr);
+    AttrValue seed2_attr;
+    b->BuildAttrValue(seed2_, &seed2_attr);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {filenames, compression_type, buffer_size},
+                      {std::make_pair(kGlobalShuffle, global_shuffle_attr),
+                       std::make_pair(kSeed, seed_attr),
+                       std::make_pair(kSeed2, seed2_attr)},
+                      output));
     return OkStatus();
   }
 
@@ -246,10 +359,15 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
             " >= filenames_.size():", dataset()->filenames_.size());
       }
 
-      // Actually move on to next file.
-      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
-          TranslateFileName(dataset()->filenames_[current_file_index_]),
-          &file_));
+      // Actually move on to next file. Buffered readers stream each file
+      // once in large reads, which may bypass the page cache.
+      const string filename =
+          TranslateFileName(dataset()->filenames_[current_file_index_]);
+      if (dataset()->options_.buffer_size > 0 && ReadFilesWithDirectIo()) {
+        TF_RETURN_IF_ERROR(env->NewDirectIoRandomAccessFile(filename, &file_));
+      } else {
+        TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file_));
+      }
       reader_ = std::make_unique<io::SequentialRecordReader>(
           file_.get(), dataset()->options_);
       return OkStatus();
@@ -270,13 +388,177 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
   };
 
+  // Iterator that produces the records of all files in a seeded random
+  // permutation. It builds an index of the record offsets of every file and
+  // reads the records at random offsets, so its memory use is proportional to
+  // the number of records rather than to the size of a shuffle buffer.
+  class GlobalShuffleIterator : public DatasetIterator<Dataset> {
+   public:
+    explicit GlobalShuffleIterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(BuildIndexLocked(ctx->env()));
+      seed_ = dataset()->seed_;
+      seed2_ = dataset()->seed2_;
+      if (seed_ == 0 && seed2_ == 0) {
+        seed_ = random::New64();
+        seed2_ = random::New64();
+      }
+      ShuffleLocked();
+      return OkStatus();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (position_ >= permutation_.size()) {
+        *end_of_sequence = true;
+        return OkStatus();
+      }
+      const int64_t index = permutation_[position_++];
+      // `file_starts_` holds the global index of the first record of each
+      // file, followed by the total number of records.
+      const size_t file_index =
+          std::upper_bound(file_starts_.begin(), file_starts_.end(), index) -
+          file_starts_.begin() - 1;
+      TF_RETURN_IF_ERROR(EnsureReaderLocked(ctx->env(), file_index));
+      uint64 offset =
+          (*record_offsets_[file_index])[index - file_starts_[file_index]];
+      out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                TensorShape({}));
+      TF_RETURN_IF_ERROR(readers_[file_index]->ReadRecord(
+          &offset, &out_tensors->back().scalar<tstring>()()));
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      bytes_counter->IncrementBy(
+          out_tensors->back().scalar<tstring>()().size());
+      *end_of_sequence = false;
+      return OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kShuffleSeed), seed_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kShuffleSeed2), seed2_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          full_name(kPosition), static_cast<int64_t>(position_)));
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kShuffleSeed), &seed_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kShuffleSeed2), &seed2_));
+      int64_t position;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kPosition), &position));
+      ShuffleLocked();
+      if (position < 0 || position > permutation_.size()) {
+        return errors::FailedPrecondition(
+            "Failed to restore iterator: position ", position,
+            " is out of range; the files have ", permutation_.size(),
+            " records.");
+      }
+      position_ = position;
+      return OkStatus();
+    }
+
+   private:
+    // Builds the index of the record offsets of all files.
+    Status BuildIndexLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const size_t num_files = dataset()->filenames_.size();
+      record_offsets_.resize(num_files);
+      file_starts_.assign(1, 0);
+      for (size_t i = 0; i < num_files; ++i) {
+        TF_RETURN_IF_ERROR(RecordOffsetsCache::Global()->Get(
+            env, TranslateFileName(dataset()->filenames_[i]),
+            &record_offsets_[i]));
+        file_starts_.push_back(file_starts_.back() +
+                               record_offsets_[i]->size());
+      }
+      files_.resize(num_files);
+      readers_.resize(num_files);
+      return OkStatus();
+    }
+
+    // Draws the permutation of the record indices from the current seeds.
+    void ShuffleLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t num_records = file_starts_.back();
+      permutation_.resize(num_records);
+      std::iota(permutation_.begin(), permutation_.end(), 0);
+      random::PhiloxRandom parent_generator(seed_, seed2_);
+      random::SingleSampleAdapter<random::PhiloxRandom> generator(
+          &parent_generator);
+      for (int64_t i = num_records - 1; i > 0; --i) {
+        const uint64 high = generator();
+        const uint64 low = generator();
+        const int64_t j = ((high << 32) | low) % (i + 1);
+        std::swap(permutation_[i], permutation_[j]);
+      }
+    }
+
+    // Opens the file at `file_index` if it is not open yet. Records are read
+    // at random offsets, so the reader does not buffer its input.
+    Status EnsureReaderLocked(Env* env, size_t file_index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (readers_[file_index]) {
+        return OkStatus();
+      }
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
+          TranslateFileName(dataset()->filenames_[file_index]),
+          &files_[file_index]));
+      io::RecordReaderOptions options = dataset()->options_;
+      options.buffer_size = 0;
+      readers_[file_index] =
+          std::make_unique<io::RecordReader>(files_[file_index].get(), options);
+      return OkStatus();
+    }
+
+    mutex mu_;
+    int64_t seed_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed2_ TF_GUARDED_BY(mu_) = 0;
+    std::vector<std::shared_ptr<const std::vector<uint64>>> record_offsets_
+        TF_GUARDED_BY(mu_);
+    std::vector<int64_t> file_starts_ TF_GUARDED_BY(mu_);
+    std::vector<int64_t> permutation_ TF_GUARDED_BY(mu_);
+    size_t position_ TF_GUARDED_BY(mu_) = 0;
+
+    // `readers_` borrow the objects that `files_` point to, so they must be
+    // destroyed first.
+    std::vector<std::unique_ptr<RandomAccessFile>> files_ TF_GUARDED_BY(mu_);
+    std::vector<std::unique_ptr<io::RecordReader>> readers_ TF_GUARDED_BY(mu_);
+  };
+
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
+  const bool global_shuffle_;
+  const int64_t seed_;
+  const int64_t seed2_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx) {
+  if (ctx->HasAttr(kGlobalShuffle)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kGlobalShuffle, &global_shuffle_));
+  }
+  if (ctx->HasAttr(kSeed)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kSeed, &seed_));
+  }
+  if (ctx->HasAttr(kSeed2)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kSeed2, &seed2_));
+  }
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -324,8 +606,15 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  // Records can only be read at random offsets from uncompressed files.
+  OP_REQUIRES(ctx, !global_shuffle_ || compression_type.empty(),
+              errors::InvalidArgument(
+                  "`global_shuffle` is only supported for uncompressed "
+                  "TFRecord files, but the compression type is ",
+                  compression_type, "."));
+
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, global_shuffle_, seed_, seed2_);
 }
 
 namespace {
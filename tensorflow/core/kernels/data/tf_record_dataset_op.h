@@ -15,7 +15,17 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_TF_RECORD_DATASET_OP_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_TF_RECORD_DATASET_OP_H_
 
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 namespace data {
@@ -26,6 +36,9 @@ class TFRecordDatasetOp : public DatasetOpKernel {
   static constexpr const char* const kFileNames = "filenames";
   static constexpr const char* const kCompressionType = "compression_type";
   static constexpr const char* const kBufferSize = "buffer_size";
+  static constexpr const char* const kGlobalShuffle = "global_shuffle";
+  static constexpr const char* const kSeed = "seed";
+  static constexpr const char* const kSeed2 = "seed2";
 
   explicit TFRecordDatasetOp(OpKernelConstruction* ctx);
 
@@ -34,6 +47,45 @@ class TFRecordDatasetOp : public DatasetOpKernel {
 
  private:
   class Dataset;
+  bool global_shuffle_ = false;
+  int64_t seed_ = 0;
+  int64_t seed2_ = 0;
+};
+
+// Caches the offsets of the records in uncompressed TFRecord files, keyed by
+// file name and file size. The cache holds at most `max_records` offsets in
+// total; the least recently used files are evicted first.
+class RecordOffsetsCache {
+ public:
+  explicit RecordOffsetsCache(int64_t max_records)
+      : max_records_(max_records) {}
+
+  // Returns the offsets of the records in `filename`, reading the record
+  // headers of the file unless they are cached. Files with more than
+  // `max_records` records are not cached.
+  Status Get(Env* env, const string& filename,
+             std::shared_ptr<const std::vector<uint64>>* offsets);
+
+  // Returns the number of offsets held by the cache.
+  int64_t num_records() const {
+    tf_shared_lock l(mu_);
+    return num_records_;
+  }
+
+  // Returns the process-wide cache. Its size is read from the environment
+  // variable TF_TFRECORD_INDEX_CACHE_MAX_RECORDS.
+  static RecordOffsetsCache* Global();
+
+ private:
+  using Entry = std::pair<string, std::shared_ptr<const std::vector<uint64>>>;
+
+  const int64_t max_records_;
+  mutable mutex mu_;
+  // The cached files, from the most to the least recently used.
+  std::list<Entry> lru_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<string, std::list<Entry>::iterator> entries_
+      TF_GUARDED_BY(mu_);
+  int64_t num_records_ TF_GUARDED_BY(mu_) = 0;
 };
 
 }  // namespace data
@@ -23,12 +23,16 @@ class TFRecordDatasetParams : public DatasetParams {
  public:
   TFRecordDatasetParams(std::vector<tstring> filenames,
                         CompressionType compression_type, int64_t buffer_size,
-                        string node_name)
+                        string node_name, bool global_shuffle = false,
+                        int64_t seed = 0, int64_t seed2 = 0)
       : DatasetParams({DT_STRING}, {PartialTensorShape({})},
                       std::move(node_name)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
-        buffer_size_(buffer_size) {}
+        buffer_size_(buffer_size),
+        global_shuffle_(global_shuffle),
+        seed_(seed),
+        seed2_(seed2) {}
 
   std::vector<Tensor> GetInputTensors() const override {
     int num_files = filenames_.size();
@@ -51,6 +55,9 @@ class TFRecordDatasetParams : public DatasetParams {
   Status GetAttributes(AttributeVector* attr_vector) const override {
     attr_vector->clear();
     attr_vector->emplace_back("metadata", "");
+    attr_vector->emplace_back("global_shuffle", global_shuffle_);
+    attr_vector->emplace_back("seed", seed_);
+    attr_vector->emplace_back("seed2", seed2_);
     return OkStatus();
   }
 
@@ -62,6 +69,9 @@ class TFRecordDatasetParams : public DatasetParams {
   std::vector<tstring> filenames_;
   CompressionType compression_type_;
   int64_t buffer_size_;
+  bool global_shuffle_;
+  int64_t seed_;
+  int64_t seed2_;
 };
 
 class TFRecordDatasetOpTest : public DatasetOpsTestBase {};
@@ -138,6 +148,28 @@ TFRecordDatasetParams TFRecordDatasetParams3() {
                                /*node_name=*/kNodeName);
 }
 
+// Test case 4: multiple text files without compression, globally shuffled.
+TFRecordDatasetParams GlobalShuffleDatasetParams(
+    CompressionType compression_type = CompressionType::UNCOMPRESSED) {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_SHUFFLE_",
+                   ToString(compression_type), "_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_SHUFFLE_",
+                   ToString(compression_type), "_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333", "4444"},
+                                               {"a", "bb", "ccc"}};
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*node_name=*/kNodeName,
+                               /*global_shuffle=*/true, /*seed=*/7,
+                               /*seed2=*/11);
+}
+
 std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
   return {
       {/*dataset_params=*/TFRecordDatasetParams1(),
@@ -243,6 +275,92 @@ TEST_F(TFRecordDatasetOpTest, IteratorPrefix) {
       TFRecordDatasetOp::kDatasetType, dataset_params.iterator_prefix())));
 }
 
+TEST_F(TFRecordDatasetOpTest, GlobalShuffleProducesAllRecords) {
+  auto dataset_params = GlobalShuffleDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_EXPECT_OK(CheckIteratorGetNext(
+      CreateTensors<tstring>(TensorShape({}), {{"1"},
+                                               {"22"},
+                                               {"333"},
+                                               {"4444"},
+                                               {"a"},
+                                               {"bb"},
+                                               {"ccc"}}),
+      /*compare_order=*/false));
+}
+
+TEST_F(TFRecordDatasetOpTest, GlobalShuffleSaveAndRestore) {
+  auto dataset_params = GlobalShuffleDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_EXPECT_OK(CheckIteratorSaveAndRestore(
+      dataset_params.iterator_prefix(),
+      CreateTensors<tstring>(TensorShape({}), {{"1"},
+                                               {"22"},
+                                               {"333"},
+                                               {"4444"},
+                                               {"a"},
+                                               {"bb"},
+                                               {"ccc"}}),
+      /*breakpoints=*/{0, 3, 8}, /*compare_order=*/false));
+}
+
+TEST_F(TFRecordDatasetOpTest, GlobalShuffleRequiresUncompressedFiles) {
+  auto dataset_params = GlobalShuffleDatasetParams(CompressionType::GZIP);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+TEST(RecordOffsetsCacheTest, EvictsLeastRecentlyUsedFiles) {
+  const std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_CACHE_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_CACHE_2"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_CACHE_3")};
+  TF_ASSERT_OK(CreateTestFiles(
+      filenames,
+      {{"1", "22", "333"}, {"a", "bb", "ccc", "dddd"}, {"x", "yy"}},
+      CompressionType::UNCOMPRESSED));
+  Env* env = Env::Default();
+  RecordOffsetsCache cache(/*max_records=*/7);
+  std::vector<std::shared_ptr<const std::vector<uint64>>> offsets(3);
+  TF_ASSERT_OK(cache.Get(env, filenames[0], &offsets[0]));
+  TF_ASSERT_OK(cache.Get(env, filenames[1], &offsets[1]));
+  EXPECT_EQ(offsets[0]->size(), 3);
+  EXPECT_EQ(offsets[1]->size(), 4);
+  EXPECT_EQ(cache.num_records(), 7);
+
+  // Reading the first file again makes the second one the least recently
+  // used, which is evicted to make room for the third one.
+  std::shared_ptr<const std::vector<uint64>> cached;
+  TF_ASSERT_OK(cache.Get(env, filenames[0], &cached));
+  EXPECT_EQ(cached, offsets[0]);
+  TF_ASSERT_OK(cache.Get(env, filenames[2], &offsets[2]));
+  EXPECT_EQ(offsets[2]->size(), 2);
+  EXPECT_EQ(cache.num_records(), 5);
+  TF_ASSERT_OK(cache.Get(env, filenames[0], &cached));
+  EXPECT_EQ(cached, offsets[0]);
+  TF_ASSERT_OK(cache.Get(env, filenames[1], &cached));
+  EXPECT_NE(cached, offsets[1]);
+  EXPECT_EQ(*cached, *offsets[1]);
+  EXPECT_EQ(cache.num_records(), 7);
+}
+
+TEST(RecordOffsetsCacheTest, DoesNotCacheFilesLargerThanTheCache) {
+  const std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_CACHE_LARGE_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_CACHE_LARGE_2")};
+  TF_ASSERT_OK(CreateTestFiles(filenames, {{"1", "22"}, {"a", "bb", "ccc"}},
+                               CompressionType::UNCOMPRESSED));
+  Env* env = Env::Default();
+  RecordOffsetsCache cache(/*max_records=*/2);
+  std::shared_ptr<const std::vector<uint64>> small, large, cached;
+  TF_ASSERT_OK(cache.Get(env, filenames[0], &small));
+  TF_ASSERT_OK(cache.Get(env, filenames[1], &large));
+  EXPECT_EQ(large->size(), 3);
+  EXPECT_EQ(cache.num_records(), 2);
+  TF_ASSERT_OK(cache.Get(env, filenames[0], &cached));
+  EXPECT_EQ(cached, small);
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<TFRecordDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {
@@ -0,0 +1,294 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// The attention of a block of queries is computed one block of keys at a time,
+// so that only the scores of a pair of blocks are held in memory.
+constexpr int64_t kQueryBlockSize = 64;
+constexpr int64_t kKeyBlockSize = 256;
+
+using RowMajorMatrix =
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+template <typename T>
+using ConstRowMajorMap = Eigen::Map<
+    const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+
+}  // namespace
+
+template <typename Device, typename T>
+class FusedMultiHeadAttentionOp : public OpKernel {
+ public:
+  explicit FusedMultiHeadAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale_));
+    OP_REQUIRES_OK(context, context->GetAttr("is_causal", &is_causal_));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    OP_REQUIRES(context, num_args <= 1,
+                errors::InvalidArgument(
+                    "_FusedMultiHeadAttention supports at most one mask, got ",
+                    num_args));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+
+    const int rank = query.dims();
+    OP_REQUIRES(context, rank >= 2,
+                errors::InvalidArgument("query must be at least rank 2, got ",
+                                        query.shape().DebugString()));
+    OP_REQUIRES(
+        context, key.dims() == rank && value.dims() == rank,
+        errors::InvalidArgument(
+            "query, key and value must have the same rank, got ",
+            query.shape().DebugString(), ", ", key.shape().DebugString(),
+            " and ", value.shape().DebugString()));
+    for (int i = 0; i < rank - 2; ++i) {
+      OP_REQUIRES(
+          context,
+          key.dim_size(i) == query.dim_size(i) &&
+              value.dim_size(i) == query.dim_size(i),
+          errors::InvalidArgument(
+              "query, key and value must have the same batch dimensions, got ",
+              query.shape().DebugString(), ", ", key.shape().DebugString(),
+              " and ", value.shape().DebugString()));
+    }
+    const int64_t num_queries = query.dim_size(rank - 2);
+    const int64_t num_keys = key.dim_size(rank - 2);
+    const int64_t depth = query.dim_size(rank - 1);
+    const int64_t value_depth = value.dim_size(rank - 1);
+    OP_REQUIRES(context, key.dim_size(rank - 1) == depth,
+                errors::InvalidArgument(
+                    "query and key must have the same depth, got ",
+                    query.shape().DebugString(), " and ",
+                    key.shape().DebugString()));
+    OP_REQUIRES(context, value.dim_size(rank - 2) == num_keys,
+                errors::InvalidArgument(
+                    "key and value must have the same length, got ",
+                    key.shape().DebugString(), " and ",
+                    value.shape().DebugString()));
+
+    TensorShape output_shape = query.shape();
+    output_shape.set_dim(rank - 1, value_depth);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+    if (num_keys == 0) {
+      output->flat<T>().setZero();
+      return;
+    }
+    const int64_t batch_size = output_shape.num_elements() /
+                               (num_queries * value_depth);
+
+    // The mask is broadcast to the scores [..., num_queries, num_keys]: the
+    // offset of its first score in every batch, and its strides along the
+    // queries and keys (0 for a broadcast dimension).
+    const T* mask = nullptr;
+    std::vector<int64_t> mask_offsets;
+    int64_t mask_query_stride = 0;
+    int64_t mask_key_stride = 0;
+    if (context->num_inputs() > 3) {
+      const Tensor& mask_tensor = context->input(3);
+      const int mask_rank = mask_tensor.dims();
+      OP_REQUIRES(context, mask_rank <= rank,
+                  errors::InvalidArgument(
+                      "mask must be broadcastable to the scores, got ",
+                      mask_tensor.shape().DebugString()));
+      std::vector<int64_t> strides(rank, 0);
+      int64_t stride = 1;
+      for (int i = rank - 1; i >= rank - mask_rank; --i) {
+        const int64_t mask_dim = mask_tensor.dim_size(i - (rank - mask_rank));
+        const int64_t scores_dim =
+            i == rank - 1 ? num_keys
+                          : (i == rank - 2 ? num_queries : query.dim_size(i));
+        OP_REQUIRES(
+            context, mask_dim == 1 || mask_dim == scores_dim,
+            errors::InvalidArgument(
+                "mask must be broadcastable to the scores, got ",
+                mask_tensor.shape().DebugString(), " for scores of ",
+                num_queries, " queries and ", num_keys, " keys"));
+        if (mask_dim != 1) strides[i] = stride;
+        stride *= mask_dim;
+      }
+      mask = mask_tensor.flat<T>().data();
+      mask_query_stride = strides[rank - 2];
+      mask_key_stride = strides[rank - 1];
+      mask_offsets.resize(batch_size);
+      for (int64_t b = 0; b < batch_size; ++b) {
+        int64_t offset = 0;
+        int64_t index = b;
+        for (int i = rank - 3; i >= 0; --i) {
+          offset += (index % query.dim_size(i)) * strides[i];
+          index /= query.dim_size(i);
+        }
+        mask_offsets[b] = offset;
+      }
+    }
+
+    const T* query_data = query.flat<T>().data();
+    const T* key_data = key.flat<T>().data();
+    const T* value_data = value.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+    const float scale = scale_;
+    const bool is_causal = is_causal_;
+    const int64_t num_query_blocks =
+        (num_queries + kQueryBlockSize - 1) / kQueryBlockSize;
+
+    // Every task computes the output of a block of queries of a batch with a
+    // streaming softmax: the running maximum and sum of the exponentials of
+    // the scores of every query are kept along with its output, which are
+    // rescaled whenever a block of keys raises the maximum.
+    auto compute_blocks = [&](int64_t start, int64_t limit) {
+      RowMajorMatrix q(kQueryBlockSize, depth);
+      RowMajorMatrix k(kKeyBlockSize, depth);
+      RowMajorMatrix v(kKeyBlockSize, value_depth);
+      RowMajorMatrix scores(kQueryBlockSize, kKeyBlockSize);
+      RowMajorMatrix acc(kQueryBlockSize, value_depth);
+      Eigen::VectorXf row_max(kQueryBlockSize);
+      Eigen::VectorXf row_sum(kQueryBlockSize);
+      constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+      for (int64_t task = start; task < limit; ++task) {
+        const int64_t b = task / num_query_blocks;
+        const int64_t q_begin = (task % num_query_blocks) * kQueryBlockSize;
+        const int64_t q_rows =
+            std::min(kQueryBlockSize, num_queries - q_begin);
+        // With a causal mask, the queries of the block only attend to the
+        // keys up to the last query.
+        const int64_t k_end =
+            is_causal ? std::min(num_keys, q_begin + q_rows) : num_keys;
+
+        q.topRows(q_rows) =
+            ConstRowMajorMap<T>(
+                query_data + (b * num_queries + q_begin) * depth, q_rows,
+                depth)
+                .template cast<float>() *
+            scale;
+        acc.topRows(q_rows).setZero();
+        row_max.head(q_rows).setConstant(-kInfinity);
+        row_sum.head(q_rows).setZero();
+
+        for (int64_t k_begin = 0; k_begin < k_end; k_begin += kKeyBlockSize) {
+          const int64_t k_rows = std::min(kKeyBlockSize, k_end - k_begin);
+          k.topRows(k_rows) =
+              ConstRowMajorMap<T>(key_data + (b * num_keys + k_begin) * depth,
+                                  k_rows, depth)
+                  .template cast<float>();
+          v.topRows(k_rows) =
+              ConstRowMajorMap<T>(
+                  value_data + (b * num_keys + k_begin) * value_depth, k_rows,
+                  value_depth)
+                  .template cast<float>();
+          auto s = scores.topLeftCorner(q_rows, k_rows);
+          s.noalias() = q.topRows(q_rows) * k.topRows(k_rows).transpose();
+
+          if (mask != nullptr) {
+            for (int64_t i = 0; i < q_rows; ++i) {
+              const T* mask_row = mask + mask_offsets[b] +
+                                  (q_begin + i) * mask_query_stride +
+                                  k_begin * mask_key_stride;
+              for (int64_t j = 0; j < k_rows; ++j) {
+                s(i, j) += static_cast<float>(mask_row[j * mask_key_stride]);
+              }
+            }
+          }
+          if (is_causal && k_begin + k_rows > q_begin + 1) {
+            for (int64_t i = 0; i < q_rows; ++i) {
+              const int64_t first_masked = q_begin + i + 1 - k_begin;
+              if (first_masked < k_rows) {
+                s.row(i).tail(k_rows - std::max<int64_t>(first_masked, 0))
+                    .setConstant(-kInfinity);
+              }
+            }
+          }
+
+          for (int64_t i = 0; i < q_rows; ++i) {
+            const float new_max = std::max(row_max(i), s.row(i).maxCoeff());
+            if (new_max == -kInfinity) {
+              // All the keys so far are masked out.
+              s.row(i).setZero();
+              continue;
+            }
+            const float correction = std::exp(row_max(i) - new_max);
+            s.row(i) = (s.row(i).array() - new_max).exp();
+            row_sum(i) = row_sum(i) * correction + s.row(i).sum();
+            acc.row(i) *= correction;
+            row_max(i) = new_max;
+          }
+          acc.topRows(q_rows).noalias() += s * v.topRows(k_rows);
+        }
+
+        T* output_block =
+            output_data + (b * num_queries + q_begin) * value_depth;
+        for (int64_t i = 0; i < q_rows; ++i) {
+          const float inverse_sum = 1.0f / row_sum(i);
+          for (int64_t j = 0; j < value_depth; ++j) {
+            output_block[i * value_depth + j] =
+                static_cast<T>(acc(i, j) * inverse_sum);
+          }
+        }
+      }
+    };
+
+    const int64_t cost_per_task =
+        kQueryBlockSize * num_keys * (depth + value_depth) * 2;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          batch_size * num_query_blocks, cost_per_task, compute_blocks);
+  }
+
+ private:
+  float scale_;
+  bool is_causal_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedMultiHeadAttentionOp);
+};
+
+#define REGISTER_CPU(T)                                          \
+  REGISTER_KERNEL_BUILDER(Name("_FusedMultiHeadAttention")       \
+                              .Device(DEVICE_CPU)                \
+                              .TypeConstraint<T>("T"),           \
+                          FusedMultiHeadAttentionOp<CPUDevice, T>);
+
+TF_CALL_float(REGISTER_CPU);
+TF_CALL_bfloat16(REGISTER_CPU);
+TF_CALL_half(REGISTER_CPU);
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
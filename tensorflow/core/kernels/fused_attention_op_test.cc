@@ -0,0 +1,177 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedMultiHeadAttentionOpTest : public OpsTestBase {
+ protected:
+  // Runs the attention of `batch` matrices of queries, keys and values, with
+  // an optional mask of shape `mask_shape`, and compares it with the attention
+  // computed one score at a time.
+  void RunAndCompare(int64_t batch, int64_t num_queries, int64_t num_keys,
+                     int64_t depth, int64_t value_depth, bool is_causal,
+                     const TensorShape* mask_shape) {
+    const float scale = 1.0f / std::sqrt(static_cast<float>(depth));
+    TF_ASSERT_OK(NodeDefBuilder("attention", "_FusedMultiHeadAttention")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(mask_shape ? 1 : 0, DT_FLOAT))
+                     .Attr("scale", scale)
+                     .Attr("is_causal", is_causal)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    random::PhiloxRandom philox(17, 42);
+    random::SimplePhilox rnd(&philox);
+    auto random_tensor = [&rnd](const TensorShape& shape) {
+      Tensor t(DT_FLOAT, shape);
+      for (int64_t i = 0; i < t.NumElements(); ++i) {
+        t.flat<float>()(i) = rnd.RandFloat() * 2.0f - 1.0f;
+      }
+      return t;
+    };
+    auto add_input = [this](const Tensor& t) {
+      AddInputFromArray<float>(
+          t.shape(), gtl::ArraySlice<float>(t.flat<float>().data(),
+                                            t.NumElements()));
+    };
+    Tensor query = random_tensor({batch, num_queries, depth});
+    Tensor key = random_tensor({batch, num_keys, depth});
+    Tensor value = random_tensor({batch, num_keys, value_depth});
+    add_input(query);
+    add_input(key);
+    add_input(value);
+    Tensor mask;
+    if (mask_shape) {
+      mask = random_tensor(*mask_shape);
+      // Masks out some keys, as well as the first keys of all the queries.
+      for (int64_t i = 0; i < mask.NumElements(); ++i) {
+        const int64_t j = i % mask_shape->dim_size(mask_shape->dims() - 1);
+        if (j < 300 || i % 7 == 0) {
+          mask.flat<float>()(i) = -std::numeric_limits<float>::infinity();
+        }
+      }
+      add_input(mask);
+    }
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(DT_FLOAT, {batch, num_queries, value_depth});
+    auto q = query.tensor<float, 3>();
+    auto k = key.tensor<float, 3>();
+    auto v = value.tensor<float, 3>();
+    for (int64_t b = 0; b < batch; ++b) {
+      for (int64_t i = 0; i < num_queries; ++i) {
+        std::vector<float> scores(num_keys);
+        for (int64_t j = 0; j < num_keys; ++j) {
+          float dot = 0.0f;
+          for (int64_t d = 0; d < depth; ++d) dot += q(b, i, d) * k(b, j, d);
+          scores[j] = dot * scale;
+          if (mask_shape) {
+            // The masks are of shape [num_queries, num_keys] or
+            // [batch, 1, num_keys].
+            scores[j] += mask_shape->dims() == 2
+                             ? mask.matrix<float>()(i, j)
+                             : mask.tensor<float, 3>()(b, 0, j);
+          }
+          if (is_causal && j > i) {
+            scores[j] = -std::numeric_limits<float>::infinity();
+          }
+        }
+        const float max_score =
+            *std::max_element(scores.begin(), scores.end());
+        float sum = 0.0f;
+        for (float& s : scores) {
+          s = std::exp(s - max_score);
+          sum += s;
+        }
+        for (int64_t d = 0; d < value_depth; ++d) {
+          float out = 0.0f;
+          for (int64_t j = 0; j < num_keys; ++j) out += scores[j] * v(b, j, d);
+          expected.tensor<float, 3>()(b, i, d) = out / sum;
+        }
+      }
+    }
+    test::ExpectClose(expected, *GetOutput(0), /*atol=*/1e-5, /*rtol=*/1e-4);
+  }
+};
+
+TEST_F(FusedMultiHeadAttentionOpTest, NoMask) {
+  RunAndCompare(/*batch=*/3, /*num_queries=*/20, /*num_keys=*/30,
+                /*depth=*/8, /*value_depth=*/5, /*is_causal=*/false,
+                /*mask_shape=*/nullptr);
+}
+
+TEST_F(FusedMultiHeadAttentionOpTest, MultipleBlocks) {
+  RunAndCompare(/*batch=*/2, /*num_queries=*/130, /*num_keys=*/600,
+                /*depth=*/16, /*value_depth=*/24, /*is_causal=*/false,
+                /*mask_shape=*/nullptr);
+}
+
+TEST_F(FusedMultiHeadAttentionOpTest, Causal) {
+  RunAndCompare(/*batch=*/2, /*num_queries=*/300, /*num_keys=*/300,
+                /*depth=*/16, /*value_depth=*/16, /*is_causal=*/true,
+                /*mask_shape=*/nullptr);
+}
+
+TEST_F(FusedMultiHeadAttentionOpTest, BroadcastMask) {
+  const TensorShape mask_shape({130, 600});
+  RunAndCompare(/*batch=*/2, /*num_queries=*/130, /*num_keys=*/600,
+                /*depth=*/16, /*value_depth=*/8, /*is_causal=*/false,
+                &mask_shape);
+}
+
+TEST_F(FusedMultiHeadAttentionOpTest, BatchMask) {
+  const TensorShape mask_shape({2, 1, 600});
+  RunAndCompare(/*batch=*/2, /*num_queries=*/70, /*num_keys=*/600,
+                /*depth=*/16, /*value_depth=*/8, /*is_causal=*/false,
+                &mask_shape);
+}
+
+TEST_F(FusedMultiHeadAttentionOpTest, InvalidMask) {
+  TF_ASSERT_OK(NodeDefBuilder("attention", "_FusedMultiHeadAttention")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(1, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({1, 2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({1, 2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({1, 2, 1}), {1, 2});
+  AddInputFromArray<float>(TensorShape({3}), {0, 0, 0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.ToString(), "broadcastable to the scores"))
+      << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
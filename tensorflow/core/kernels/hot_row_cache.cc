@@ -0,0 +1,175 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/hot_row_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+
+namespace tensorflow {
+namespace {
+
+// One of every `kSamplePeriod` gathers has its ids counted.
+constexpr int64_t kSamplePeriod = 16;
+// At most this many ids of a sampled gather are counted.
+constexpr int64_t kMaxSampledIds = 1024;
+// The cached rows are rebuilt after this many sampled gathers.
+constexpr int64_t kRebuildPeriod = 64;
+
+}  // namespace
+
+HotRowCache::HotRowCache(int64_t max_rows) : max_rows_(max_rows) {}
+
+std::string HotRowCache::DebugString() const {
+  return absl::StrCat("HotRowCache with ", num_cached_rows(), " of ",
+                      max_rows_, " rows");
+}
+
+int64_t HotRowCache::num_cached_rows() const {
+  tf_shared_lock l(rows_mu_);
+  return rows_ == nullptr ? 0 : rows_->slots.size();
+}
+
+int64_t HotRowCache::Gather(const Tensor& params, const int32* indices,
+                            int64_t num_indices, char* out,
+                            thread::ThreadPool* workers) {
+  return GatherImpl(params, indices, num_indices, out, workers);
+}
+
+int64_t HotRowCache::Gather(const Tensor& params, const int64_t* indices,
+                            int64_t num_indices, char* out,
+                            thread::ThreadPool* workers) {
+  return GatherImpl(params, indices, num_indices, out, workers);
+}
+
+template <typename Index>
+int64_t HotRowCache::GatherImpl(const Tensor& params, const Index* indices,
+                                int64_t num_indices, char* out,
+                                thread::ThreadPool* workers) {
+  const int64_t num_params_rows = params.dim_size(0);
+  for (int64_t i = 0; i < num_indices; ++i) {
+    if (indices[i] < 0 || indices[i] >= num_params_rows) return i;
+  }
+  if (num_indices == 0 || num_params_rows == 0) return -1;
+
+  const int64_t row_bytes = params.TotalBytes() / num_params_rows;
+  const char* params_data = params.tensor_data().data();
+
+  MaybeSample(params, indices, num_indices);
+
+  std::shared_ptr<const Rows> rows;
+  {
+    tf_shared_lock l(rows_mu_);
+    rows = rows_;
+  }
+  if (rows != nullptr &&
+      (rows->params.tensor_data().data() != params_data ||
+       rows->params.shape() != params.shape() ||
+       rows->row_bytes != row_bytes)) {
+    // The variable was assigned or updated since the rows were cached.
+    rows = nullptr;
+  }
+
+  auto copy_rows = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const char* src = params_data + indices[i] * row_bytes;
+      if (rows != nullptr) {
+        auto it = rows->slots.find(indices[i]);
+        if (it != rows->slots.end()) {
+          src = rows->data.get() + it->second * row_bytes;
+        }
+      }
+      std::memcpy(out + i * row_bytes, src, row_bytes);
+    }
+  };
+  if (workers == nullptr) {
+    copy_rows(0, num_indices);
+  } else {
+    workers->ParallelFor(num_indices, /*cost_per_unit=*/row_bytes, copy_rows);
+  }
+  return -1;
+}
+
+template <typename Index>
+void HotRowCache::MaybeSample(const Tensor& params, const Index* indices,
+                              int64_t num_indices) {
+  if (num_gathers_.fetch_add(1, std::memory_order_relaxed) % kSamplePeriod !=
+      0) {
+    return;
+  }
+
+  mutex_lock l(mu_);
+  const int64_t num_sampled = std::min(num_indices, kMaxSampledIds);
+  for (int64_t i = 0; i < num_sampled; ++i) {
+    ++id_counts_[indices[i]];
+  }
+  if (++num_samples_since_rebuild_ >= kRebuildPeriod) {
+    Rebuild(params);
+    num_samples_since_rebuild_ = 0;
+  }
+}
+
+void HotRowCache::Rebuild(const Tensor& params) {
+  std::vector<std::pair<int64_t, int64_t>> counts(id_counts_.begin(),
+                                                  id_counts_.end());
+  const int64_t num_rows =
+      std::min<int64_t>(max_rows_, static_cast<int64_t>(counts.size()));
+  auto by_count_desc = [](const std::pair<int64_t, int64_t>& a,
+                          const std::pair<int64_t, int64_t>& b) {
+    return a.second > b.second;
+  };
+  std::nth_element(counts.begin(), counts.begin() + num_rows, counts.end(),
+                   by_count_desc);
+
+  auto rows = std::make_shared<Rows>();
+  // Holding a reference keeps the buffer from being freed and reused, and
+  // makes resource variable ops copy it before updating it.
+  rows->params = params;
+  const int64_t num_params_rows = params.dim_size(0);
+  rows->row_bytes = params.TotalBytes() / num_params_rows;
+  rows->data.reset(new char[num_rows * rows->row_bytes]);
+  rows->slots.reserve(num_rows);
+  const char* params_data = params.tensor_data().data();
+  for (int64_t slot = 0; slot < num_rows; ++slot) {
+    const int64_t id = counts[slot].first;
+    // Ids were range checked against the variable when they were sampled,
+    // but the variable may have been assigned a smaller value since.
+    if (id >= num_params_rows) continue;
+    const int64_t pos = rows->slots.size();
+    std::memcpy(rows->data.get() + pos * rows->row_bytes,
+                params_data + id * rows->row_bytes, rows->row_bytes);
+    rows->slots.emplace(id, pos);
+  }
+
+  {
+    mutex_lock l(rows_mu_);
+    rows_ = std::move(rows);
+  }
+
+  for (auto it = id_counts_.begin(); it != id_counts_.end();) {
+    it->second /= 2;
+    if (it->second == 0) {
+      id_counts_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_HOT_ROW_CACHE_H_
+#define TENSORFLOW_CORE_KERNELS_HOT_ROW_CACHE_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/resource_base.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+
+// Name of an optional int attr of ResourceGather nodes. If positive, CPU
+// gathers of memcpy-able variables keep up to this many of the most often
+// gathered rows of the variable in a HotRowCache.
+constexpr char kHotRowCacheRowsAttr[] = "_hot_row_cache_rows";
+
+// Keeps copies of the most often gathered rows of an embedding variable in one
+// contiguous buffer. When the ids gathered from a large variable are skewed, a
+// gather then reads most rows from a few pages instead of from all over the
+// variable, which cuts cache and TLB misses.
+//
+// The gathered ids are sampled, and the cached rows are periodically replaced
+// by the rows of the ids sampled most often recently. The cache holds a
+// reference to the buffer the rows were copied from and is only used while the
+// variable still holds that buffer. As resource variable ops copy a buffer
+// that is referenced elsewhere before updating it, the first update of the
+// variable after each rebuild copies the whole variable, so the cache is meant
+// for variables that are not updated, such as embeddings in serving.
+//
+// Thread-safe.
+class HotRowCache : public ResourceBase {
+ public:
+  explicit HotRowCache(int64_t max_rows);
+
+  std::string DebugString() const override;
+
+  // Copies the rows `indices[0, num_indices)` of `params`, a tensor of at
+  // least one dimension whose dtype can be memcpy'd, to `out`, which must have
+  // room for `num_indices` rows. The rows are copied in parallel on `workers`
+  // if it is not null. Returns the position of the first index that is out of
+  // range, in which case nothing is copied, or -1.
+  //
+  // `params` must not be modified during the call.
+  int64_t Gather(const Tensor& params, const int32* indices,
+                 int64_t num_indices, char* out, thread::ThreadPool* workers);
+  int64_t Gather(const Tensor& params, const int64_t* indices,
+                 int64_t num_indices, char* out, thread::ThreadPool* workers);
+
+  // Returns the number of rows currently cached.
+  int64_t num_cached_rows() const;
+
+ private:
+  // The cached rows, copied from `params`.
+  struct Rows {
+    Tensor params;
+    int64_t row_bytes = 0;
+    // Maps an id to the position of its row in `data`.
+    absl::flat_hash_map<int64_t, int64_t> slots;
+    std::unique_ptr<char[]> data;
+  };
+
+  template <typename Index>
+  int64_t GatherImpl(const Tensor& params, const Index* indices,
+                     int64_t num_indices, char* out,
+                     thread::ThreadPool* workers);
+
+  // Samples the ids of one gather, and rebuilds the cached rows from `params`
+  // once enough gathers have been sampled.
+  template <typename Index>
+  void MaybeSample(const Tensor& params, const Index* indices,
+                   int64_t num_indices);
+
+  void Rebuild(const Tensor& params) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t max_rows_;
+  std::atomic<int64_t> num_gathers_{0};
+
+  mutable mutex mu_;
+  // Sampled gather counts by id, halved at each rebuild so that the cache
+  // follows changes of the id distribution.
+  absl::flat_hash_map<int64_t, int64_t> id_counts_ TF_GUARDED_BY(mu_);
+  int64_t num_samples_since_rebuild_ TF_GUARDED_BY(mu_) = 0;
+
+  mutable mutex rows_mu_;
+  std::shared_ptr<const Rows> rows_ TF_GUARDED_BY(rows_mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_HOT_ROW_CACHE_H_
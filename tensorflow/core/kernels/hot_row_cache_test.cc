@@ -0,0 +1,87 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/hot_row_cache.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns a [num_rows, 2] float tensor whose row i is {i, -i} + offset.
+Tensor MakeParams(int64_t num_rows, float offset = 0) {
+  Tensor params(DT_FLOAT, TensorShape({num_rows, 2}));
+  auto matrix = params.matrix<float>();
+  for (int64_t i = 0; i < num_rows; ++i) {
+    matrix(i, 0) = i + offset;
+    matrix(i, 1) = -i + offset;
+  }
+  return params;
+}
+
+void ExpectGathered(const Tensor& params, const std::vector<int64_t>& ids,
+                    HotRowCache* cache, thread::ThreadPool* workers) {
+  Tensor out(DT_FLOAT, TensorShape({static_cast<int64_t>(ids.size()), 2}));
+  EXPECT_EQ(cache->Gather(params, ids.data(), ids.size(),
+                          reinterpret_cast<char*>(out.flat<float>().data()),
+                          workers),
+            -1);
+  Tensor expected(DT_FLOAT, out.shape());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    expected.matrix<float>()(i, 0) = params.matrix<float>()(ids[i], 0);
+    expected.matrix<float>()(i, 1) = params.matrix<float>()(ids[i], 1);
+  }
+  test::ExpectTensorEqual<float>(out, expected);
+}
+
+TEST(HotRowCacheTest, CachesMostGatheredRows) {
+  Tensor params = MakeParams(1000);
+  HotRowCache* cache = new HotRowCache(/*max_rows=*/2);
+  core::ScopedUnref unref(cache);
+  thread::ThreadPool workers(Env::Default(), "test", /*num_threads=*/2);
+
+  EXPECT_EQ(cache->num_cached_rows(), 0);
+  for (int i = 0; i < 2000; ++i) {
+    ExpectGathered(params, {3, 7, 3, i % 1000}, cache, &workers);
+  }
+  EXPECT_EQ(cache->num_cached_rows(), 2);
+  ExpectGathered(params, {7, 3, 999, 0}, cache, /*workers=*/nullptr);
+
+  // The cached rows are not used for a new value of the variable.
+  Tensor new_params = MakeParams(1000, /*offset=*/0.5);
+  ExpectGathered(new_params, {3, 7}, cache, &workers);
+}
+
+TEST(HotRowCacheTest, OutOfRange) {
+  Tensor params = MakeParams(10);
+  HotRowCache* cache = new HotRowCache(/*max_rows=*/2);
+  core::ScopedUnref unref(cache);
+
+  const std::vector<int32> ids = {1, 2, 10, -1};
+  Tensor out(DT_FLOAT, TensorShape({4, 2}));
+  EXPECT_EQ(cache->Gather(params, ids.data(), ids.size(),
+                          reinterpret_cast<char*>(out.flat<float>().data()),
+                          /*workers=*/nullptr),
+            2);
+}
+
+}  // namespace
+}  // namespace tensorflow
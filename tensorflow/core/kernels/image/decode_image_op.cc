@@ -15,8 +15,11 @@ limitations under the License.
 
 // See docs in ../ops/image_ops.cc
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/lib/gtl/cleanup.h"
 
@@ -673,6 +676,211 @@ class DecodeImageV2Op : public OpKernel {
   string op_type_;
 };
 
+// Decodes the crop window of a JPEG image and resizes it bilinearly, with
+// half pixel centers, to `size`. The image is decoded with the largest DCT
+// scaling that keeps the crop window at least as large as `size`, and only the
+// rows and columns of the crop window are decoded, so that the full resolution
+// image is never materialized.
+class DecodeAndCropAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndCropAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 0 || channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("`channels` must be 0, 1 or 3 but got ",
+                                        channels_));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("try_recover_truncated",
+                                    &flags_.try_recover_truncated_jpeg));
+    OP_REQUIRES_OK(context, context->GetAttr("acceptable_fraction",
+                                             &flags_.min_acceptable_fraction));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+    flags_.components = channels_;
+    flags_.crop = true;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(contents.shape()),
+        errors::InvalidArgument("`contents` must be scalar but got shape",
+                                contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<tstring>()();
+    OP_REQUIRES(context, !input.empty(),
+                errors::InvalidArgument("Input is empty."));
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument(
+                    "Input contents are too large for int: ", input.size()));
+    OP_REQUIRES(context, ClassifyFileFormat(input) == kJpgFormat,
+                errors::InvalidArgument(
+                    "DecodeAndCropAndResizeJpeg operation can run on JPEG "
+                    "only."));
+
+    const Tensor& crop_window = context->input(1);
+    OP_REQUIRES(context,
+                crop_window.dims() == 1 && crop_window.dim_size(0) == 4,
+                errors::InvalidArgument(
+                    "crop_window must be 1-D with four elements, got shape ",
+                    crop_window.shape().DebugString()));
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context, size.dims() == 1 && size.dim_size(0) == 2,
+                errors::InvalidArgument(
+                    "size must be 1-D with two elements, got shape ",
+                    size.shape().DebugString()));
+    const int crop_y = crop_window.vec<int32>()(0);
+    const int crop_x = crop_window.vec<int32>()(1);
+    const int crop_height = crop_window.vec<int32>()(2);
+    const int crop_width = crop_window.vec<int32>()(3);
+    const int out_height = size.vec<int32>()(0);
+    const int out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got [",
+                                        out_height, ", ", out_width, "]"));
+
+    int width;
+    int height;
+    OP_REQUIRES(context,
+                jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                                   nullptr),
+                errors::InvalidArgument("Invalid JPEG data."));
+    OP_REQUIRES(
+        context,
+        crop_y >= 0 && crop_x >= 0 && crop_height > 0 && crop_width > 0 &&
+            crop_height <= height - crop_y && crop_width <= width - crop_x,
+        errors::InvalidArgument("Invalid JPEG data or crop window: [", crop_y,
+                                ", ", crop_x, ", ", crop_height, ", ",
+                                crop_width, "] for an image of ", height, "x",
+                                width));
+
+    // Decode at 1/ratio of the resolution, the crop window rounded out to
+    // whole pixels of the scaled image.
+    jpeg::UncompressFlags flags = flags_;
+    for (const int ratio : {8, 4, 2}) {
+      if (crop_height >= int64_t{ratio} * out_height &&
+          crop_width >= int64_t{ratio} * out_width) {
+        flags.ratio = ratio;
+        break;
+      }
+    }
+    const int ratio = flags.ratio;
+    const int scaled_height = (height + ratio - 1) / ratio;
+    const int scaled_width = (width + ratio - 1) / ratio;
+    flags.crop_y = crop_y / ratio;
+    flags.crop_x = crop_x / ratio;
+    flags.crop_height =
+        std::min((crop_y + crop_height + ratio - 1) / ratio, scaled_height) -
+        flags.crop_y;
+    flags.crop_width =
+        std::min((crop_x + crop_width + ratio - 1) / ratio, scaled_width) -
+        flags.crop_x;
+
+    Tensor decoded;
+    uint8* buffer = jpeg::Uncompress(
+        input.data(), input.size(), flags, nullptr /* nwarn */,
+        [&](int decoded_width, int decoded_height,
+            int decoded_channels) -> uint8* {
+          Status status = context->allocate_temp(
+              DT_UINT8,
+              TensorShape({decoded_height, decoded_width, decoded_channels}),
+              &decoded);
+          if (!status.ok()) {
+            VLOG(1) << status;
+            context->SetStatus(status);
+            return nullptr;
+          }
+          return decoded.flat<uint8>().data();
+        });
+    OP_REQUIRES(
+        context, buffer,
+        errors::InvalidArgument(
+            "jpeg::Uncompress failed. Invalid JPEG data or crop window."));
+
+    const int64_t decoded_height = decoded.dim_size(0);
+    const int64_t decoded_width = decoded.dim_size(1);
+    const int64_t channels = decoded.dim_size(2);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({out_height, out_width, channels}),
+                       &output));
+
+    // The center of output pixel `i` in the pixels of the decoded window. For
+    // a ratio of 1, this is the source pixel of ResizeBilinear with
+    // half_pixel_centers.
+    struct Interpolation {
+      int64_t lower;
+      int64_t upper;
+      float lerp;
+    };
+    auto compute_interpolation = [ratio](int64_t out_size, int64_t crop_begin,
+                                         int64_t crop_size,
+                                         int64_t decoded_begin,
+                                         int64_t decoded_size) {
+      std::vector<Interpolation> interpolation(out_size);
+      const float scale = static_cast<float>(crop_size) / out_size;
+      const float offset =
+          static_cast<float>(crop_begin - decoded_begin * ratio);
+      for (int64_t i = 0; i < out_size; ++i) {
+        const float in =
+            ((static_cast<float>(i) + 0.5f) * scale + offset) / ratio - 0.5f;
+        const float in_f = std::floor(in);
+        interpolation[i].lower =
+            std::max(static_cast<int64_t>(in_f), static_cast<int64_t>(0));
+        interpolation[i].upper =
+            std::min(static_cast<int64_t>(std::ceil(in)), decoded_size - 1);
+        interpolation[i].lerp = in - in_f;
+      }
+      return interpolation;
+    };
+    const std::vector<Interpolation> ys = compute_interpolation(
+        out_height, crop_y, crop_height, flags.crop_y, decoded_height);
+    const std::vector<Interpolation> xs = compute_interpolation(
+        out_width, crop_x, crop_width, flags.crop_x, decoded_width);
+
+    // Every output row interpolates two decoded rows into a float row, which
+    // vectorizes, and then interpolates the columns of the float row.
+    const uint8* decoded_data = decoded.flat<uint8>().data();
+    float* output_data = output->flat<float>().data();
+    const int64_t row_size = decoded_width * channels;
+    std::vector<float> row(row_size);
+    for (int64_t y = 0; y < out_height; ++y) {
+      const uint8* top = decoded_data + ys[y].lower * row_size;
+      const uint8* bottom = decoded_data + ys[y].upper * row_size;
+      const float y_lerp = ys[y].lerp;
+      for (int64_t i = 0; i < row_size; ++i) {
+        const float top_value = top[i];
+        row[i] = top_value + (static_cast<float>(bottom[i]) - top_value) *
+                                 y_lerp;
+      }
+      float* output_row = output_data + y * out_width * channels;
+      for (int64_t x = 0; x < out_width; ++x) {
+        const float* left = row.data() + xs[x].lower * channels;
+        const float* right = row.data() + xs[x].upper * channels;
+        const float x_lerp = xs[x].lerp;
+        for (int64_t c = 0; c < channels; ++c) {
+          output_row[x * channels + c] =
+              left[c] + (right[c] - left[c]) * x_lerp;
+        }
+      }
+    }
+  }
+
+ private:
+  int channels_ = 0;
+  jpeg::UncompressFlags flags_;
+};
+
 REGISTER_KERNEL_BUILDER(Name("DecodeJpeg").Device(DEVICE_CPU), DecodeImageV2Op);
 REGISTER_KERNEL_BUILDER(Name("DecodePng").Device(DEVICE_CPU), DecodeImageV2Op);
 REGISTER_KERNEL_BUILDER(Name("DecodeGif").Device(DEVICE_CPU), DecodeImageV2Op);
@@ -681,6 +889,8 @@ REGISTER_KERNEL_BUILDER(Name("DecodeAndCropJpeg").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(Name("DecodeImage").Device(DEVICE_CPU),
                         DecodeImageV2Op);
 REGISTER_KERNEL_BUILDER(Name("DecodeBmp").Device(DEVICE_CPU), DecodeImageV2Op);
+REGISTER_KERNEL_BUILDER(Name("DecodeAndCropAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndCropAndResizeJpegOp);
 
 void DecodeImageV2Op::DecodeBMP(const uint8* input, const int row_size,
                                 uint8* const output, const int width,
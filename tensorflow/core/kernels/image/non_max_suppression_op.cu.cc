@@ -162,10 +162,11 @@ __global__ void NMSReduce(const int* bitmask, const int bit_mask_len,
 // coordinates such that for all boxes x1<x2 and y1<y2. Else boxes should have
 // x1<x2 and y1<y2.
 template <bool flip_box>
-__launch_bounds__(kNmsBlockDim* kNmsBlockDim, 4) __global__
-    void NMSKernel(const Box* d_desc_sorted_boxes, const int num_boxes,
-                   const float iou_threshold, const int bit_mask_len,
-                   int* d_delete_mask) {
+__device__ EIGEN_STRONG_INLINE void NMSMask(const Box* d_desc_sorted_boxes,
+                                            const int num_boxes,
+                                            const float iou_threshold,
+                                            const int bit_mask_len,
+                                            int* d_delete_mask) {
   // Storing boxes used by this CUDA block in the shared memory.
   __shared__ Box shared_i_boxes[kNmsBlockDim];
   // Same thing with areas
@@ -219,6 +220,87 @@ __launch_bounds__(kNmsBlockDim* kNmsBlockDim, 4) __global__
     __syncthreads();  // making sure everyone is done reading shared memory.
   }
 }
+
+template <bool flip_box>
+__launch_bounds__(kNmsBlockDim* kNmsBlockDim, 4) __global__
+    void NMSKernel(const Box* d_desc_sorted_boxes, const int num_boxes,
+                   const float iou_threshold, const int bit_mask_len,
+                   int* d_delete_mask) {
+  NMSMask<flip_box>(d_desc_sorted_boxes, num_boxes, iou_threshold,
+                    bit_mask_len, d_delete_mask);
+}
+
+// Same as NMSKernel for num_segments independent lists of num_boxes sorted
+// boxes each, one list per z index of the grid. The bitmask of each segment
+// is num_boxes * bit_mask_len ints.
+template <bool flip_box>
+__launch_bounds__(kNmsBlockDim* kNmsBlockDim, 4) __global__
+    void BatchedNMSKernel(const Box* d_desc_sorted_boxes, const int num_boxes,
+                          const int num_segments, const float iou_threshold,
+                          const int bit_mask_len, int* d_delete_mask) {
+  // The condition of the loop is common to all threads in the block.
+  for (int segment = blockIdx.z; segment < num_segments;
+       segment += gridDim.z) {
+    NMSMask<flip_box>(
+        d_desc_sorted_boxes + static_cast<int64_t>(segment) * num_boxes,
+        num_boxes, iou_threshold, bit_mask_len,
+        d_delete_mask + static_cast<int64_t>(segment) * num_boxes *
+                            bit_mask_len);
+  }
+}
+
+// Selects the boxes to keep in every segment of sorted boxes from the bitmask
+// generated by BatchedNMSKernel, with one block per segment. Only the boxes
+// with a score above score_threshold are candidates, and at most max_boxes
+// are selected per segment. Writes the scores and the original indices of the
+// selected boxes to selected_scores and selected_indices, which have
+// max_boxes entries per segment padded with -infinity and -1, and the number
+// of selected boxes to num_selected.
+__global__ void BatchedNMSReduce(const int* bitmask, const int bit_mask_len,
+                                 const int num_boxes, const int max_boxes,
+                                 const float* sorted_scores,
+                                 const int* sorted_indices,
+                                 const float score_threshold,
+                                 float* selected_scores, int* selected_indices,
+                                 int* num_selected) {
+  extern __shared__ int local[];
+  const int segment = blockIdx.x;
+  bitmask += static_cast<int64_t>(segment) * num_boxes * bit_mask_len;
+  sorted_scores += static_cast<int64_t>(segment) * num_boxes;
+  sorted_indices += static_cast<int64_t>(segment) * num_boxes;
+  selected_scores += static_cast<int64_t>(segment) * max_boxes;
+  selected_indices += static_cast<int64_t>(segment) * max_boxes;
+  for (int b = threadIdx.x; b < bit_mask_len; b += blockDim.x) {
+    local[b] = 0xFFFFFFFF;
+  }
+  __syncthreads();
+
+  int accepted_boxes = 0;
+  for (int box = 0; box < num_boxes && accepted_boxes < max_boxes; ++box) {
+    // Boxes are sorted by score, so all the remaining ones are below the
+    // threshold.
+    if (!(sorted_scores[box] > score_threshold)) break;
+    // If current box is masked by an earlier box, skip it.
+    if (!CheckBit(local, box)) continue;
+    if (threadIdx.x == 0) {
+      selected_scores[accepted_boxes] = sorted_scores[box];
+      selected_indices[accepted_boxes] = sorted_indices[box];
+    }
+    accepted_boxes += 1;
+    // Update the mask with the current box's mask, which only has bits set
+    // for later boxes.
+    const int* box_mask = bitmask + static_cast<int64_t>(box) * bit_mask_len;
+    for (int b = threadIdx.x; b < bit_mask_len; b += blockDim.x) {
+      local[b] &= ~box_mask[b];
+    }
+    __syncthreads();
+  }
+  for (int i = accepted_boxes + threadIdx.x; i < max_boxes; i += blockDim.x) {
+    selected_scores[i] = -Eigen::NumTraits<float>::infinity();
+    selected_indices[i] = -1;
+  }
+  if (threadIdx.x == 0) num_selected[segment] = accepted_boxes;
+}
 // Variadic template helpers for Index selecting multiple arrays at the same
 // time
 template <typename Index>
@@ -255,6 +337,118 @@ __global__ void Iota(const int num_elements, const T offset, T* to_fill) {
   }
 }
 
+// Fills offsets with the num_segments + 1 start offsets of contiguous
+// segments of segment_size elements.
+__global__ void SegmentOffsets(const int num_segments, const int segment_size,
+                               int* offsets) {
+  for (int idx : GpuGridRangeX(num_segments + 1)) {
+    offsets[idx] = idx * segment_size;
+  }
+}
+
+// Fills to_fill with the index of every element in its segment of
+// segment_size elements.
+__global__ void SegmentIota(const int num_elements, const int segment_size,
+                            int* to_fill) {
+  for (int idx : GpuGridRangeX(num_elements)) {
+    to_fill[idx] = idx % segment_size;
+  }
+}
+
+// Transposes the scores of CombinedNonMaxSuppression from
+// [batch_size, num_boxes, num_classes] to one segment of num_boxes scores per
+// image and class, and fills the box indices of every segment.
+__global__ void ScoresByClass(const int num_elements, const int num_boxes,
+                              const int num_classes, const float* scores,
+                              float* class_scores, int* box_indices) {
+  for (int idx : GpuGridRangeX(num_elements)) {
+    const int segment = idx / num_boxes;
+    const int box = idx % num_boxes;
+    const int batch = segment / num_classes;
+    const int class_idx = segment % num_classes;
+    class_scores[idx] =
+        scores[(static_cast<int64_t>(batch) * num_boxes + box) * num_classes +
+               class_idx];
+    box_indices[idx] = box;
+  }
+}
+
+// Gathers the boxes of every segment of CombinedNonMaxSuppression in the
+// order of sorted_indices. Boxes are [batch_size, num_boxes, q, 4], where q is
+// either 1 or num_classes.
+__global__ void GatherBoxesByClass(const int num_elements, const int num_boxes,
+                                   const int num_classes, const int q,
+                                   const float4* boxes,
+                                   const int* sorted_indices,
+                                   float4* sorted_boxes) {
+  for (int idx : GpuGridRangeX(num_elements)) {
+    const int segment = idx / num_boxes;
+    const int batch = segment / num_classes;
+    const int class_idx = q > 1 ? segment % num_classes : 0;
+    sorted_boxes[idx] =
+        boxes[(static_cast<int64_t>(batch) * num_boxes + sorted_indices[idx]) *
+                  q +
+              class_idx];
+  }
+}
+
+// Computes the number of valid detections of every image, from the number of
+// boxes selected for each of its classes.
+__global__ void CountValidDetections(const int num_batches,
+                                     const int num_classes,
+                                     const int* num_selected,
+                                     const int per_batch_size,
+                                     int* valid_detections) {
+  for (int batch : GpuGridRangeX(num_batches)) {
+    int count = 0;
+    for (int c = 0; c < num_classes; ++c) {
+      count += num_selected[batch * num_classes + c];
+    }
+    valid_detections[batch] = min(count, per_batch_size);
+  }
+}
+
+// Writes the outputs of CombinedNonMaxSuppression from the selected boxes of
+// every image sorted by score. The candidates of an image are the
+// size_per_class selected boxes of each of its classes, and sorted_candidates
+// holds their indices among the candidates of the image.
+__global__ void CombinedNMSOutputs(
+    const int num_elements, const int per_batch_size, const int num_boxes,
+    const int num_classes, const int q, const int size_per_class,
+    const bool clip_boxes, const float4* boxes, const int* selected_indices,
+    const float* sorted_scores, const int* sorted_candidates,
+    const int* valid_detections, float4* nmsed_boxes, float* nmsed_scores,
+    float* nmsed_classes) {
+  const int candidates_per_batch = num_classes * size_per_class;
+  for (int idx : GpuGridRangeX(num_elements)) {
+    const int batch = idx / per_batch_size;
+    const int j = idx % per_batch_size;
+    float4 box = make_float4(0.f, 0.f, 0.f, 0.f);
+    float score = 0.f;
+    float class_idx = 0.f;
+    if (j < valid_detections[batch]) {
+      const int64_t batch_offset =
+          static_cast<int64_t>(batch) * candidates_per_batch;
+      const int candidate = sorted_candidates[batch_offset + j];
+      const int c = candidate / size_per_class;
+      const int box_index = selected_indices[batch_offset + candidate];
+      box = boxes[(static_cast<int64_t>(batch) * num_boxes + box_index) * q +
+                  (q > 1 ? c : 0)];
+      if (clip_boxes) {
+        box.x = fminf(fmaxf(box.x, 0.f), 1.f);
+        box.y = fminf(fmaxf(box.y, 0.f), 1.f);
+        box.z = fminf(fmaxf(box.z, 0.f), 1.f);
+        box.w = fminf(fmaxf(box.w, 0.f), 1.f);
+      }
+      score = sorted_scores[batch_offset + j];
+      class_idx = c;
+    }
+    nmsed_boxes[idx] = box;
+    nmsed_scores[idx] = score;
+    nmsed_classes[idx] = class_idx;
+  }
+}
+
 // TensorFlow with nvcc doesn't build with --extended-lambda, so we have to use
 // an explicit functor instead of a device lambda.
 struct GreaterThanCubOp {
@@ -454,6 +648,241 @@ Status DoNMS(OpKernelContext* context, const Tensor& boxes,
   return OkStatus();
 }
 
+// Sorts the values of num_segments contiguous segments of segment_size keys
+// each in descending order of their keys.
+Status SegmentedSortDescending(OpKernelContext* context, const float* keys_in,
+                               float* keys_out, const int* values_in,
+                               int* values_out, const int num_segments,
+                               const int segment_size) {
+  auto device = context->eigen_gpu_device();
+  Tensor d_offsets;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_segments + 1}), &d_offsets));
+  int* offsets = d_offsets.flat<int>().data();
+  auto config = GetGpuLaunchConfig(num_segments + 1, device);
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(
+      SegmentOffsets, config.block_count, config.thread_per_block, 0,
+      device.stream(), num_segments, segment_size, offsets));
+  const int num_items = num_segments * segment_size;
+  size_t temp_storage_bytes = 0;
+  TF_RETURN_IF_CUDA_ERROR(
+      gpuprim::DeviceSegmentedRadixSort::SortPairsDescending(
+          nullptr, temp_storage_bytes, keys_in, keys_out, values_in,
+          values_out, num_items, num_segments, offsets, offsets + 1, 0,
+          8 * sizeof(float),  // sort all bits
+          device.stream()));
+  Tensor d_temp_storage;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT8, TensorShape({(int64)temp_storage_bytes}),
+      &d_temp_storage));
+  TF_RETURN_IF_CUDA_ERROR(
+      gpuprim::DeviceSegmentedRadixSort::SortPairsDescending(
+          d_temp_storage.flat<int8>().data(), temp_storage_bytes, keys_in,
+          keys_out, values_in, values_out, num_items, num_segments, offsets,
+          offsets + 1, 0,
+          8 * sizeof(float),  // sort all bits
+          device.stream()));
+  return OkStatus();
+}
+
+// The maximum number of ints of the NMS bitmasks computed at once by
+// CombinedNonMaxSuppression. Larger batches of images and classes are
+// processed in several rounds.
+constexpr int64_t kCombinedNmsMaxMaskSize = int64_t{1} << 26;
+
+// Runs CombinedNonMaxSuppression for all the images and classes at once:
+// - sorts the scores of every image and class with a segmented sort,
+// - computes the overlap bitmask of every image and class with
+//   BatchedNMSKernel and selects their boxes with BatchedNMSReduce,
+// - sorts the selected boxes of every image with a second segmented sort, and
+//   writes the best per_batch_size of them.
+Status DoCombinedNMS(OpKernelContext* context, const Tensor& boxes,
+                     const Tensor& scores, const int max_size_per_class,
+                     const int per_batch_size, const float iou_threshold,
+                     const float score_threshold, const bool clip_boxes) {
+  const int num_batches = boxes.dim_size(0);
+  const int num_boxes = boxes.dim_size(1);
+  const int q = boxes.dim_size(2);
+  const int num_classes = scores.dim_size(2);
+  const int size_per_class = std::min(max_size_per_class, num_boxes);
+  auto device = context->eigen_gpu_device();
+
+  Tensor* nmsed_boxes_t = nullptr;
+  TF_RETURN_IF_ERROR(context->allocate_output(
+      0, TensorShape({num_batches, per_batch_size, 4}), &nmsed_boxes_t));
+  Tensor* nmsed_scores_t = nullptr;
+  TF_RETURN_IF_ERROR(context->allocate_output(
+      1, TensorShape({num_batches, per_batch_size}), &nmsed_scores_t));
+  Tensor* nmsed_classes_t = nullptr;
+  TF_RETURN_IF_ERROR(context->allocate_output(
+      2, TensorShape({num_batches, per_batch_size}), &nmsed_classes_t));
+  Tensor* valid_detections_t = nullptr;
+  TF_RETURN_IF_ERROR(context->allocate_output(3, TensorShape({num_batches}),
+                                              &valid_detections_t));
+  if (num_batches == 0) return OkStatus();
+  if (size_per_class == 0 || num_classes == 0) {
+    // There is no box to select.
+    device.memset(nmsed_boxes_t->flat<float>().data(), 0,
+                  nmsed_boxes_t->TotalBytes());
+    device.memset(nmsed_scores_t->flat<float>().data(), 0,
+                  nmsed_scores_t->TotalBytes());
+    device.memset(nmsed_classes_t->flat<float>().data(), 0,
+                  nmsed_classes_t->TotalBytes());
+    device.memset(valid_detections_t->flat<int>().data(), 0,
+                  valid_detections_t->TotalBytes());
+    return OkStatus();
+  }
+
+  const int64_t num_segments_64 =
+      static_cast<int64_t>(num_batches) * num_classes;
+  if (num_segments_64 * num_boxes > std::numeric_limits<int>::max()) {
+    return errors::InvalidArgument(
+        "CombinedNonMaxSuppression on GPU supports at most ",
+        std::numeric_limits<int>::max(), " scores, got ",
+        num_segments_64 * num_boxes, ". Place the op on the CPU instead.");
+  }
+  const int bit_mask_len =
+      (num_boxes + kNmsBoxesPerThread - 1) / kNmsBoxesPerThread;
+  const int64_t mask_size_per_segment =
+      static_cast<int64_t>(num_boxes) * bit_mask_len;
+  if (mask_size_per_segment > kCombinedNmsMaxMaskSize) {
+    return errors::InvalidArgument(
+        "CombinedNonMaxSuppression on GPU supports at most ",
+        kCombinedNmsMaxMaskSize, " pairs of boxes per class, got ",
+        mask_size_per_segment * kNmsBoxesPerThread,
+        ". Place the op on the CPU instead.");
+  }
+  const int num_segments = num_segments_64;
+  const int num_scores = num_segments * num_boxes;
+
+  // Sorts the scores of every image and class, and gathers their boxes.
+  Tensor d_class_scores, d_box_indices, d_sorted_scores, d_sorted_indices;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_FLOAT, TensorShape({num_scores}), &d_class_scores));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_scores}), &d_box_indices));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_FLOAT, TensorShape({num_scores}), &d_sorted_scores));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_scores}), &d_sorted_indices));
+  auto config = GetGpuLaunchConfig(num_scores, device);
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(
+      ScoresByClass, config.block_count, config.thread_per_block, 0,
+      device.stream(), num_scores, num_boxes, num_classes,
+      scores.flat<float>().data(), d_class_scores.flat<float>().data(),
+      d_box_indices.flat<int>().data()));
+  TF_RETURN_IF_ERROR(SegmentedSortDescending(
+      context, d_class_scores.flat<float>().data(),
+      d_sorted_scores.flat<float>().data(), d_box_indices.flat<int>().data(),
+      d_sorted_indices.flat<int>().data(), num_segments, num_boxes));
+
+  Tensor d_sorted_boxes;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_FLOAT, TensorShape({num_scores, 4}), &d_sorted_boxes));
+  const float4* original_boxes =
+      reinterpret_cast<const float4*>(boxes.flat<float>().data());
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(
+      GatherBoxesByClass, config.block_count, config.thread_per_block, 0,
+      device.stream(), num_scores, num_boxes, num_classes, q, original_boxes,
+      d_sorted_indices.flat<int>().data(),
+      reinterpret_cast<float4*>(d_sorted_boxes.flat<float>().data())));
+
+  // Selects the boxes of every image and class, computing the bitmasks of as
+  // many of them at once as fit in kCombinedNmsMaxMaskSize.
+  const int num_candidates = num_segments * size_per_class;
+  Tensor d_selected_scores, d_selected_indices, d_num_selected;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_FLOAT, TensorShape({num_candidates}), &d_selected_scores));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_candidates}), &d_selected_indices));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_segments}), &d_num_selected));
+  const int segments_per_round = static_cast<int>(std::min<int64_t>(
+      kCombinedNmsMaxMaskSize / mask_size_per_segment, num_segments));
+  Tensor d_nms_mask;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32,
+      TensorShape({segments_per_round * mask_size_per_segment}), &d_nms_mask));
+  int* d_delete_mask = d_nms_mask.flat<int>().data();
+  const Box* d_boxes =
+      reinterpret_cast<const Box*>(d_sorted_boxes.flat<float>().data());
+  dim3 block_dim, thread_block;
+  block_dim.x = std::min((num_boxes + kNmsBlockDim - 1) / kNmsBlockDim,
+                         kNmsBlockDimMax);
+  block_dim.y = std::min(
+      (num_boxes + kNmsBoxesPerThread * kNmsBlockDim - 1) /
+          (kNmsBoxesPerThread * kNmsBlockDim),
+      kNmsBlockDimMax);
+  block_dim.z = std::min(segments_per_round, 65535);
+  thread_block.x = kNmsBlockDim;
+  thread_block.y = kNmsBlockDim;
+  thread_block.z = 1;
+  const int reduce_threads = std::min(1024, (bit_mask_len + 31) / 32 * 32);
+  const int reduce_shared_bytes = bit_mask_len * sizeof(int);
+  for (int begin = 0; begin < num_segments; begin += segments_per_round) {
+    const int round_segments =
+        std::min(segments_per_round, num_segments - begin);
+    const int64_t scores_offset = static_cast<int64_t>(begin) * num_boxes;
+    device.memset(d_delete_mask, 0,
+                  round_segments * mask_size_per_segment * sizeof(int));
+    // Boxes may have x1 > x2 or y1 > y2, so they are flipped if necessary.
+    TF_RETURN_IF_ERROR(GpuLaunchKernel(
+        BatchedNMSKernel<true>, block_dim, thread_block, 0, device.stream(),
+        d_boxes + scores_offset, num_boxes, round_segments, iou_threshold,
+        bit_mask_len, d_delete_mask));
+    TF_RETURN_IF_ERROR(GpuLaunchKernel(
+        BatchedNMSReduce, round_segments, reduce_threads, reduce_shared_bytes,
+        device.stream(), d_delete_mask, bit_mask_len, num_boxes,
+        size_per_class, d_sorted_scores.flat<float>().data() + scores_offset,
+        d_sorted_indices.flat<int>().data() + scores_offset, score_threshold,
+        d_selected_scores.flat<float>().data() + begin * size_per_class,
+        d_selected_indices.flat<int>().data() + begin * size_per_class,
+        d_num_selected.flat<int>().data() + begin));
+  }
+
+  // Sorts the selected boxes of every image, and writes the best of them.
+  const int candidates_per_batch = num_classes * size_per_class;
+  Tensor d_candidates, d_sorted_candidate_scores, d_sorted_candidates;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_candidates}), &d_candidates));
+  TF_RETURN_IF_ERROR(context->allocate_temp(DataType::DT_FLOAT,
+                                            TensorShape({num_candidates}),
+                                            &d_sorted_candidate_scores));
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataType::DT_INT32, TensorShape({num_candidates}), &d_sorted_candidates));
+  config = GetGpuLaunchConfig(num_candidates, device);
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(
+      SegmentIota, config.block_count, config.thread_per_block, 0,
+      device.stream(), num_candidates, candidates_per_batch,
+      d_candidates.flat<int>().data()));
+  TF_RETURN_IF_ERROR(SegmentedSortDescending(
+      context, d_selected_scores.flat<float>().data(),
+      d_sorted_candidate_scores.flat<float>().data(),
+      d_candidates.flat<int>().data(), d_sorted_candidates.flat<int>().data(),
+      num_batches, candidates_per_batch));
+
+  int* valid_detections = valid_detections_t->flat<int>().data();
+  config = GetGpuLaunchConfig(num_batches, device);
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(
+      CountValidDetections, config.block_count, config.thread_per_block, 0,
+      device.stream(), num_batches, num_classes,
+      d_num_selected.flat<int>().data(), per_batch_size, valid_detections));
+  const int num_outputs = num_batches * per_batch_size;
+  config = GetGpuLaunchConfig(num_outputs, device);
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(
+      CombinedNMSOutputs, config.block_count, config.thread_per_block, 0,
+      device.stream(), num_outputs, per_batch_size, num_boxes, num_classes, q,
+      size_per_class, clip_boxes, original_boxes,
+      d_selected_indices.flat<int>().data(),
+      d_sorted_candidate_scores.flat<float>().data(),
+      d_sorted_candidates.flat<int>().data(), valid_detections,
+      reinterpret_cast<float4*>(nmsed_boxes_t->flat<float>().data()),
+      nmsed_scores_t->flat<float>().data(),
+      nmsed_classes_t->flat<float>().data()));
+  TF_RETURN_IF_CUDA_ERROR(cudaGetLastError());
+  return OkStatus();
+}
+
 // Extracts a scalar of type T from a tensor, with correct type checking.
 // This is necessary because several of the kernels here assume
 // T == T_threshold.
@@ -662,6 +1091,91 @@ class NonMaxSuppressionV4GPUOp : public OpKernel {
   bool pad_to_max_output_size_;
 };
 
+class CombinedNonMaxSuppressionGPUOp : public OpKernel {
+ public:
+  explicit CombinedNonMaxSuppressionGPUOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("pad_per_class", &pad_per_class_));
+    OP_REQUIRES_OK(context, context->GetAttr("clip_boxes", &clip_boxes_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    // boxes: [batch_size, num_anchors, q, 4]
+    const Tensor& boxes = context->input(0);
+    // scores: [batch_size, num_anchors, num_classes]
+    const Tensor& scores = context->input(1);
+    OP_REQUIRES(context, boxes.dims() == 4,
+                errors::InvalidArgument("boxes must be 4-D",
+                                        boxes.shape().DebugString()));
+    OP_REQUIRES(context, scores.dims() == 3,
+                errors::InvalidArgument("scores must be 3-D",
+                                        scores.shape().DebugString()));
+    OP_REQUIRES(
+        context, (boxes.dim_size(0) == scores.dim_size(0)),
+        errors::InvalidArgument("boxes and scores must have same batch size"));
+    const int num_classes = scores.dim_size(2);
+    OP_REQUIRES(
+        context, boxes.dim_size(2) == 1 || boxes.dim_size(2) == num_classes,
+        errors::InvalidArgument(
+            "third dimension of boxes must be either 1 or num classes"));
+    OP_REQUIRES(context, boxes.dim_size(3) == 4,
+                errors::InvalidArgument("boxes must have 4 columns"));
+    OP_REQUIRES(context, scores.dim_size(1) == boxes.dim_size(1),
+                errors::InvalidArgument("scores has incompatible shape"));
+
+    // max_output_size: scalar
+    const Tensor& max_output_size = context->input(2);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(max_output_size.shape()),
+        errors::InvalidArgument("max_size_per_class must be 0-D, got shape ",
+                                max_output_size.shape().DebugString()));
+    const int max_size_per_class = max_output_size.scalar<int>()();
+    OP_REQUIRES(context, max_size_per_class > 0,
+                errors::InvalidArgument("max_size_per_class must be positive"));
+    // max_total_size: scalar
+    const Tensor& max_total_size = context->input(3);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(max_total_size.shape()),
+        errors::InvalidArgument("max_total_size must be 0-D, got shape ",
+                                max_total_size.shape().DebugString()));
+    const int max_total_size_per_batch = max_total_size.scalar<int>()();
+    OP_REQUIRES(context, max_total_size_per_batch > 0,
+                errors::InvalidArgument("max_total_size must be > 0"));
+    // iou_threshold: scalar
+    const Tensor& iou_threshold = context->input(4);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(iou_threshold.shape()),
+                errors::InvalidArgument("iou_threshold must be 0-D, got shape ",
+                                        iou_threshold.shape().DebugString()));
+    const float iou_threshold_val = iou_threshold.scalar<float>()();
+    OP_REQUIRES(context, iou_threshold_val >= 0 && iou_threshold_val <= 1,
+                errors::InvalidArgument("iou_threshold must be in [0, 1]"));
+    // score_threshold: scalar
+    const Tensor& score_threshold = context->input(5);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(score_threshold.shape()),
+        errors::InvalidArgument("score_threshold must be 0-D, got shape ",
+                                score_threshold.shape().DebugString()));
+    const float score_threshold_val = score_threshold.scalar<float>()();
+
+    int per_batch_size = max_total_size_per_batch;
+    if (pad_per_class_) {
+      // Avoid overflow.
+      const int max_total_size_per_class = static_cast<int>(
+          std::min(static_cast<int64_t>(std::numeric_limits<int>::max()),
+                   static_cast<int64_t>(max_size_per_class) * num_classes));
+      per_batch_size = std::min(per_batch_size, max_total_size_per_class);
+    }
+    OP_REQUIRES_OK(context,
+                   DoCombinedNMS(context, boxes, scores, max_size_per_class,
+                                 per_batch_size, iou_threshold_val,
+                                 score_threshold_val, clip_boxes_));
+  }
+
+ private:
+  bool pad_per_class_;
+  bool clip_boxes_;
+};
+
 }  // namespace
 
 Status NmsGpu(const float* d_sorted_boxes_float_ptr, const int num_boxes,
@@ -802,5 +1316,13 @@ REGISTER_KERNEL_BUILDER(Name("NonMaxSuppressionV4")
                             .HostMemory("score_threshold"),
                         NonMaxSuppressionV4GPUOp);
 
+REGISTER_KERNEL_BUILDER(Name("CombinedNonMaxSuppression")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("max_output_size_per_class")
+                            .HostMemory("max_total_size")
+                            .HostMemory("iou_threshold")
+                            .HostMemory("score_threshold"),
+                        CombinedNonMaxSuppressionGPUOp);
+
 }  // namespace tensorflow
 #endif
@@ -540,6 +540,108 @@ TEST_F(NonMaxSuppressionV4GPUOpTest, DifferentInputAndThresholdTypesWorks) {
   test::ExpectTensorEqual<int>(expected_num_valid, *GetOutput(1));
 }
 
+class CombinedNonMaxSuppressionGPUOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(bool pad_per_class = false, bool clip_boxes = true) {
+    SetDevice(DEVICE_GPU,
+              std::unique_ptr<tensorflow::Device>(DeviceFactory::NewDevice(
+                  "GPU", {}, "/job:a/replica:0/task:0")));
+
+    TF_EXPECT_OK(NodeDefBuilder("combined_non_max_suppression_op",
+                                "CombinedNonMaxSuppression")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("pad_per_class", pad_per_class)
+                     .Attr("clip_boxes", clip_boxes)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+};
+
+TEST_F(CombinedNonMaxSuppressionGPUOpTest, TestEmptyInput) {
+  MakeOp();
+  AddInputFromArray<float>(TensorShape({0, 0, 0, 4}), {});
+  AddInputFromArray<float>(TensorShape({0, 0, 0}), {});
+  AddInputFromArray<int>(TensorShape({}), {30});
+  AddInputFromArray<int>(TensorShape({}), {10});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  EXPECT_EQ(GetOutput(0)->shape(), TensorShape({0, 10, 4}));
+  EXPECT_EQ(GetOutput(1)->shape(), TensorShape({0, 10}));
+  EXPECT_EQ(GetOutput(2)->shape(), TensorShape({0, 10}));
+  EXPECT_EQ(GetOutput(3)->shape(), TensorShape({0}));
+}
+
+TEST_F(CombinedNonMaxSuppressionGPUOpTest, TestSelectFromThreeClusters) {
+  MakeOp();
+  AddInputFromArray<float>(
+      TensorShape({1, 6, 1, 4}),
+      {0, 0,    0.1, 0.1, 0, 0.01f, 0.1, 0.11f, 0, -0.01, 0.1, 0.09f,
+       0, 0.11, 0.1, 0.2, 0, 0.12f, 0.1, 0.21f, 0, 0.3,   1,   0.4});
+  AddInputFromArray<float>(TensorShape({1, 6, 1}),
+                           {.9f, .75f, .6f, .95f, .5f, .3f});
+  AddInputFromArray<int>(TensorShape({}), {3});
+  AddInputFromArray<int>(TensorShape({}), {3});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>(
+          {0, 0.11, 0.1, 0.2, 0, 0, 0.1, 0.1, 0, 0.3, 1, 0.4},
+          TensorShape({1, 3, 4})),
+      *GetOutput(0));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({0.95, 0.9, 0.3}, TensorShape({1, 3})),
+      *GetOutput(1));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({0, 0, 0}, TensorShape({1, 3})), *GetOutput(2));
+  test::ExpectTensorEqual<int>(test::AsTensor<int>({3}), *GetOutput(3));
+}
+
+TEST_F(CombinedNonMaxSuppressionGPUOpTest,
+       TestSelectFromTwoBatchesWithTwoClassesPadPerClass) {
+  MakeOp(/*pad_per_class=*/true, /*clip_boxes=*/false);
+  // Boxes are shared by the classes.
+  AddInputFromArray<float>(
+      TensorShape({2, 6, 1, 4}),
+      {0, 0,  10, 10, 0, 1,  10, 11, 0, 1,  10, 9,
+       0, 11, 10, 20, 0, 12, 10, 21, 0, 30, 100, 40,
+       0, 0,  10, 10, 0, 1,  10, 11, 0, 1,  10, 9,
+       0, 11, 10, 20, 0, 12, 10, 21, 0, 30, 100, 40});
+  AddInputFromArray<float>(
+      TensorShape({2, 6, 2}),
+      {0.1, 0.9,  0.75, 0.8, 0.6, 0.3, 0.95, 0.1, 0.5, 0.5, 0.3, 0.1,
+       0.1, 0.9,  0.75, 0.8, 0.6, 0.3, 0.95, 0.1, 0.5, 0.5, 0.3, 0.1});
+  AddInputFromArray<int>(TensorShape({}), {2});
+  AddInputFromArray<int>(TensorShape({}), {10});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The boxes of the second image are the same as the first one.
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>(
+          {0, 11, 10, 20, 0, 0, 10, 10, 0, 1, 10, 11, 0, 12, 10, 21,
+           0, 11, 10, 20, 0, 0, 10, 10, 0, 1, 10, 11, 0, 12, 10, 21},
+          TensorShape({2, 4, 4})),
+      *GetOutput(0));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({0.95, 0.9, 0.75, 0.5, 0.95, 0.9, 0.75, 0.5},
+                            TensorShape({2, 4})),
+      *GetOutput(1));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({0, 1, 0, 1, 0, 1, 0, 1}, TensorShape({2, 4})),
+      *GetOutput(2));
+  test::ExpectTensorEqual<int>(test::AsTensor<int>({4, 4}), *GetOutput(3));
+}
+
 #endif
 
 }  // namespace
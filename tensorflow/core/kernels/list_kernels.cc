@@ -41,6 +41,38 @@ namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+namespace {
+
+// Largest buffer, in bytes, preallocated for the elements of a list on CPU.
+constexpr int64_t kMaxTensorListBufferBytes = 16 << 20;
+
+// Preallocates the buffer of the empty list `l` for elements shaped like
+// `element`, if the list has a maximum size and the elements can be stored in
+// aligned rows of a buffer of reasonable size. Stacking such a list returns a
+// view of the buffer instead of copying its elements.
+Status MaybeAllocateBuffer(OpKernelContext* c, const Tensor& element,
+                           TensorList* l) {
+  if (c->device_type() != DEVICE_CPU || l->max_num_elements <= 0 ||
+      !l->tensors().empty() || l->HasBuffer() ||
+      !DataTypeCanUseMemcpy(element.dtype())) {
+    return OkStatus();
+  }
+  // Rows must be aligned for the view to be usable by Eigen.
+  const int64_t row_bytes = element.TotalBytes();
+  if (row_bytes == 0 || row_bytes % EIGEN_MAX_ALIGN_BYTES != 0 ||
+      row_bytes > kMaxTensorListBufferBytes / l->max_num_elements) {
+    return OkStatus();
+  }
+  TensorShape buffer_shape = element.shape();
+  buffer_shape.InsertDim(0, l->max_num_elements);
+  Tensor buffer;
+  TF_RETURN_IF_ERROR(c->allocate_temp(element.dtype(), buffer_shape, &buffer));
+  l->SetBuffer(std::move(buffer));
+  return OkStatus();
+}
+
+}  // namespace
+
 Status TensorShapeFromTensor(const Tensor& t, PartialTensorShape* out) {
   if (t.shape() == TensorShape({})) {
     if ((t.dtype() == DT_INT32 && t.scalar<int32>()() == -1) ||
@@ -220,7 +252,10 @@ class TensorListPushBack : public OpKernel {
 
     TensorList* output_list = nullptr;
     OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
-    output_list->tensors().push_back(input);
+    OP_REQUIRES_OK(c, MaybeAllocateBuffer(c, input, output_list));
+    if (!output_list->PushBackIntoBuffer(input)) {
+      output_list->tensors().push_back(input);
+    }
   }
 
  private:
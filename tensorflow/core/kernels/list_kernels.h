@@ -218,6 +218,15 @@ class TensorListStack : public OpKernel {
                     partial_element_shape.DebugString()));
     TensorShape output_shape = element_shape;
     output_shape.InsertDim(0, tensor_list->tensors().size());
+    // The elements of a list with a buffer may be stacked already.
+    Tensor buffer_view;
+    if (std::is_same<Device, CPUDevice>::value &&
+        tensor_list->GetBufferView(0, tensor_list->tensors().size(),
+                                   &buffer_view) &&
+        buffer_view.shape() == output_shape) {
+      c->set_output(0, buffer_view);
+      return;
+    }
     Tensor* output;
     OP_REQUIRES_OK(c, c->allocate_output(0, output_shape, &output));
     if (output->NumElements() == 0) {
@@ -709,6 +718,23 @@ class TensorListGather : public OpKernel {
                                 partial_element_shape.DebugString()));
     TensorShape output_shape = element_shape;
     output_shape.InsertDim(0, indices.NumElements());
+    // Consecutive elements of a list with a buffer may be gathered already.
+    Tensor buffer_view;
+    if (std::is_same<Device, CPUDevice>::value && indices.NumElements() > 0) {
+      const auto indices_flat = indices.flat<int32>();
+      const int64_t begin = indices_flat(0);
+      bool consecutive = true;
+      for (int index = 1; index < indices.NumElements(); ++index) {
+        consecutive &= indices_flat(index) == begin + index;
+      }
+      if (consecutive &&
+          tensor_list->GetBufferView(begin, begin + indices.NumElements(),
+                                     &buffer_view) &&
+          buffer_view.shape() == output_shape) {
+        c->set_output(0, buffer_view);
+        return;
+      }
+    }
     Tensor* output;
     OP_REQUIRES_OK(c, c->allocate_output(0, output_shape, &output));
     if (output->NumElements() == 0) {
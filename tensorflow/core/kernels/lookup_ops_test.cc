@@ -20,11 +20,17 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
+#include "tensorflow/core/kernels/lookup_util.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace {
@@ -100,5 +106,86 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+using VocabularyTable = lookup::HashTable<tstring, int64_t>;
+
+// Returns a table initialized from `filename`, in parallel on `thread_pool`
+// if it isn't null.
+StatusOr<core::RefCountPtr<VocabularyTable>> InitializeVocabularyTable(
+    const string& filename, int64_t vocab_size,
+    thread::ThreadPool* thread_pool) {
+  core::RefCountPtr<VocabularyTable> table(
+      new VocabularyTable(/*ctx=*/nullptr, /*kernel=*/nullptr));
+  TF_RETURN_IF_ERROR(lookup::InitializeTableFromTextFile(
+      filename, vocab_size, /*delimiter=*/'\t', /*key_index=*/0,
+      /*value_index=*/1, /*offset=*/0, Env::Default(), thread_pool,
+      /*serializer=*/nullptr, table.get()));
+  return table;
+}
+
+// Vocabularies of several megabytes are parsed in several byte ranges, which
+// must give the same tables as reading them line by line.
+TEST(LookupUtilTest, InitializeTableFromTextFileInParallel) {
+  constexpr int kNumLines = 300000;
+  string contents;
+  for (int i = 0; i < kNumLines; ++i) {
+    strings::StrAppend(&contents, "word", i, "\t", 2 * i, "\n");
+  }
+  const string filename = io::JoinPath(testing::TmpDir(), "vocabulary.txt");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+  thread::ThreadPool thread_pool(Env::Default(), "test", /*num_threads=*/4);
+
+  const Tensor keys =
+      test::AsTensor<tstring>({"word0", "word999", "word299999", "missing"});
+  const Tensor default_value = test::AsScalar<int64_t>(-1);
+  for (const int64_t vocab_size : {-1, kNumLines, 1000}) {
+    TF_ASSERT_OK_AND_ASSIGN(auto sequential,
+                            InitializeVocabularyTable(filename, vocab_size,
+                                                      /*thread_pool=*/nullptr));
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto parallel,
+        InitializeVocabularyTable(filename, vocab_size, &thread_pool));
+    EXPECT_EQ(parallel->size(), sequential->size());
+
+    Tensor sequential_values(DT_INT64, keys.shape());
+    Tensor parallel_values(DT_INT64, keys.shape());
+    TF_ASSERT_OK(
+        sequential->Find(nullptr, keys, &sequential_values, default_value));
+    TF_ASSERT_OK(
+        parallel->Find(nullptr, keys, &parallel_values, default_value));
+    test::ExpectTensorEqual<int64_t>(parallel_values, sequential_values);
+  }
+}
+
+TEST(LookupUtilTest, InitializeTableFromTextFileInParallelErrors) {
+  constexpr int kNumLines = 300000;
+  string contents;
+  for (int i = 0; i < kNumLines; ++i) {
+    // An empty line far into the file.
+    if (i == 250000) contents += "\n";
+    strings::StrAppend(&contents, "word", i, "\t", i, "\n");
+  }
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "invalid_vocabulary.txt");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+  thread::ThreadPool thread_pool(Env::Default(), "test", /*num_threads=*/4);
+
+  // The same errors are reported as when the file is read line by line.
+  for (const int64_t vocab_size : {-1, kNumLines + 10}) {
+    const Status sequential_status =
+        InitializeVocabularyTable(filename, vocab_size, /*thread_pool=*/nullptr)
+            .status();
+    const Status parallel_status =
+        InitializeVocabularyTable(filename, vocab_size, &thread_pool).status();
+    EXPECT_FALSE(parallel_status.ok());
+    EXPECT_EQ(parallel_status, sequential_status);
+  }
+
+  // Lines past the vocabulary size are ignored.
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto parallel,
+      InitializeVocabularyTable(filename, /*vocab_size=*/1000, &thread_pool));
+  EXPECT_EQ(parallel->size(), 1000);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -13,8 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
-#include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define EIGEN_USE_GPU
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include "tensorflow/core/kernels/lookup_table_op.h"
 
 #include <string>
 #include <type_traits>
@@ -24,10 +28,16 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/kernels/static_hash_table_image.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/random.h"
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/kernels/lookup_table_op_gpu.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 namespace tensorflow {
 namespace lookup {
 
@@ -878,6 +888,369 @@ class MutableDenseHashTable final : public LookupInterface {
   uint64 deleted_key_hash_;
 };
 
+// Immutable lookup table from strings to int64 ids that looks keys up in a
+// memory mapped StaticHashTableImage, generated offline from the vocabulary
+// with WriteStaticHashTableImage. Unlike HashTable, the table isn't copied to
+// the heap, and all the processes of a host share one copy of the image
+// through the page cache.
+class MappedHashTable final : public LookupInterface {
+ public:
+  MappedHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "filename", &filename_));
+    auto image = StaticHashTableImage::Open(ctx->env(), filename_);
+    OP_REQUIRES_OK(ctx, image.status());
+    image_ = std::move(image).value();
+  }
+
+  size_t size() const override { return image_->size(); }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const auto key_values = key.flat<tstring>();
+    auto value_values = value->flat<int64_t>();
+    const auto default_flat = default_value.flat<int64_t>();
+    const bool is_full_size_default =
+        (value_values.size() == default_flat.size());
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      if (!image_->Find(key_values(i), &value_values(i))) {
+        value_values(i) = is_full_size_default ? default_flat(i)
+                                               : default_flat(0);
+      }
+    }
+    return OkStatus();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    return errors::Unimplemented("MappedHashTable is immutable.");
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    return errors::Unimplemented("MappedHashTable is immutable.");
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    return errors::Unimplemented("MappedHashTable is immutable.");
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    const int64_t size = image_->size();
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("values", TensorShape({size}), &values));
+    auto keys_data = keys->flat<tstring>();
+    auto values_data = values->flat<int64_t>();
+    int64_t i = 0;
+    image_->ForEach([&](StringPiece key, int64_t value) {
+      keys_data(i) = tstring(key);
+      values_data(i) = value;
+      ++i;
+    });
+    return OkStatus();
+  }
+
+  DataType key_dtype() const override { return DT_STRING; }
+
+  DataType value_dtype() const override { return DT_INT64; }
+
+  TensorShape key_shape() const final { return TensorShape(); }
+
+  TensorShape value_shape() const override { return TensorShape(); }
+
+  // The image is not counted, as its pages are shared with other tables and
+  // processes mapping the same file.
+  int64_t MemoryUsed() const override { return sizeof(MappedHashTable); }
+
+  Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
+    *out = ops::SourceOp(
+        "MappedHashTable",
+        builder->opts()
+            .WithName(UniqueNodeName("MappedHashTableFromGraphDef"))
+            .WithAttr("filename", filename_)
+            .WithAttr("use_node_name_sharing", true)
+            .WithAttr("key_dtype", key_dtype())
+            .WithAttr("value_dtype", value_dtype()));
+    return OkStatus();
+  }
+
+ private:
+  string filename_;
+  std::unique_ptr<StaticHashTableImage> image_;
+};
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// MutableDenseHashTable with its buckets in GPU memory, so that the tables of
+// ids looked up by models on GPUs need no copies to and from the host. The
+// buckets are laid out, hashed and probed as on the CPU, and looked up,
+// inserted and removed in batches by kernels (see lookup_table_op_gpu.h).
+//
+// Only scalar keys are supported. Unlike on the CPU, the empty_key and the
+// deleted_key are ignored rather than rejected when used as table keys, and
+// deleted buckets are only reclaimed when the table is grown.
+//
+// The number of keys only lives on the device: it is copied to the host by
+// size(), and by Insert() when the buckets may be too few for the keys.
+template <class K, class V>
+class GpuMutableDenseHashTable final : public LookupInterface {
+ public:
+  typedef Eigen::GpuDevice GPUDevice;
+
+  GpuMutableDenseHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    OP_REQUIRES_OK(
+        ctx, GetNodeAttr(kernel->def(), "max_load_factor", &max_load_factor_));
+    OP_REQUIRES(ctx, max_load_factor_ > 0 && max_load_factor_ < 1,
+                errors::InvalidArgument(
+                    "max_load_factor must be between 0 and 1, got: ",
+                    max_load_factor_));
+
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "value_shape", &value_shape_));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(value_shape_) ||
+                    TensorShapeUtils::IsVector(value_shape_),
+                errors::InvalidArgument(
+                    "Empty value must be a scalar or a vector, got shape ",
+                    value_shape_.DebugString()));
+
+    const Tensor* empty_key_input;
+    OP_REQUIRES_OK(ctx, ctx->input("empty_key", &empty_key_input));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(empty_key_input->shape()),
+                errors::InvalidArgument(
+                    "MutableDenseHashTable only supports scalar keys on GPU, "
+                    "got empty key of shape ",
+                    empty_key_input->shape().DebugString()));
+    empty_key_ = empty_key_input->scalar<K>()();
+
+    const Tensor* deleted_key_input;
+    OP_REQUIRES_OK(ctx, ctx->input("deleted_key", &deleted_key_input));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(deleted_key_input->shape()),
+                errors::InvalidArgument(
+                    "Empty and deleted keys must have same shape, got shapes: ",
+                    empty_key_input->shape().DebugString(), " and ",
+                    deleted_key_input->shape().DebugString()));
+    deleted_key_ = deleted_key_input->scalar<K>()();
+    OP_REQUIRES(
+        ctx, empty_key_ != deleted_key_,
+        errors::InvalidArgument("Empty and deleted keys cannot be equal"));
+
+    stream_ = ctx->op_device_context()->stream();
+    OP_REQUIRES(ctx, stream_ != nullptr,
+                errors::Internal("No GPU stream available."));
+
+    int64_t initial_num_buckets;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "initial_num_buckets",
+                                    &initial_num_buckets));
+    OP_REQUIRES_OK(ctx, AllocateBuckets(ctx, initial_num_buckets));
+  }
+
+  size_t size() const override TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    int64_t counts[2];
+    Status s = ReadCounts(counts);
+    if (!s.ok()) {
+      LOG(ERROR) << "Failed to read the size of the table: " << s;
+      return 0;
+    }
+    return counts[1];
+  }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override TF_LOCKS_EXCLUDED(mu_) {
+    TF_RETURN_IF_ERROR(CheckKeyRank(key));
+    const int64_t num_elements = key.NumElements();
+    const int64_t value_size = value_shape_.num_elements();
+    const int64_t num_defaults =
+        default_value.shape() == value_shape_ ? 1 : num_elements;
+
+    tf_shared_lock l(mu_);
+    const Tensor& key_buckets = key_buckets_;
+    const Tensor& value_buckets = value_buckets_;
+    functor::DenseHashTableFind<GPUDevice, K, V>()(
+        ctx->eigen_device<GPUDevice>(), key.flat<K>(),
+        default_value.shaped<V, 2>({num_defaults, value_size}), empty_key_,
+        deleted_key_, key_buckets.flat<K>(), value_buckets.matrix<V>(),
+        value->shaped<V, 2>({num_elements, value_size}));
+    return OkStatus();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& key,
+                const Tensor& value) override TF_LOCKS_EXCLUDED(mu_) {
+    TF_RETURN_IF_ERROR(CheckKeyRank(key));
+    const int64_t batch_size = key.NumElements();
+    mutex_lock l(mu_);
+    // As on the CPU, all the keys are assumed to be new, but the number of
+    // occupied buckets is only read back from the device when that bound
+    // exceeds the maximum load, and the buckets grown when it actually does.
+    if (num_occupied_bound_ + batch_size > num_buckets_ * max_load_factor_) {
+      int64_t counts[2];
+      TF_RETURN_IF_ERROR(ReadCounts(counts));
+      num_occupied_bound_ = counts[0];
+      if (num_occupied_bound_ + batch_size > num_buckets_ * max_load_factor_) {
+        // Only drops the deleted keys if there is room for the batch.
+        int64_t new_num_buckets = num_buckets_;
+        while (counts[1] + batch_size > new_num_buckets * max_load_factor_) {
+          new_num_buckets <<= 1;
+        }
+        TF_RETURN_IF_ERROR(Rebucket(ctx, new_num_buckets));
+        num_occupied_bound_ = counts[1];
+      }
+    }
+    DoInsert(ctx, key, value);
+    num_occupied_bound_ += batch_size;
+    return OkStatus();
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& key) override
+      TF_LOCKS_EXCLUDED(mu_) {
+    TF_RETURN_IF_ERROR(CheckKeyRank(key));
+    mutex_lock l(mu_);
+    functor::DenseHashTableRemove<GPUDevice, K>()(
+        ctx->eigen_device<GPUDevice>(), key.flat<K>(), empty_key_,
+        deleted_key_, key_buckets_.flat<K>(), counts_.flat<int64_t>());
+    return OkStatus();
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    num_buckets_ = keys.dim_size(0);
+    key_buckets_ = keys;
+    value_buckets_ = values;
+    functor::DenseHashTableCount<GPUDevice, K>()(
+        ctx->eigen_device<GPUDevice>(), empty_key_, deleted_key_,
+        keys.flat<K>(), counts_.flat<int64_t>());
+    num_occupied_bound_ = num_buckets_;
+    return OkStatus();
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    TF_RETURN_IF_ERROR(ctx->set_output("keys", key_buckets_));
+    TF_RETURN_IF_ERROR(ctx->set_output("values", value_buckets_));
+    return OkStatus();
+  }
+
+  Status CheckKeyAndValueTensorsForImport(const Tensor& keys,
+                                          const Tensor& values) override {
+    TF_RETURN_IF_ERROR(CheckKeyAndValueTypes(keys, values));
+    TF_RETURN_IF_ERROR(CheckKeyShape(keys.shape()));
+    const int64_t num_buckets = keys.dims() > 0 ? keys.dim_size(0) : 0;
+    if (num_buckets < 4 || (num_buckets & (num_buckets - 1)) != 0) {
+      return errors::InvalidArgument(
+          "Number of buckets must be at least 4 and a power of 2, got: ",
+          num_buckets);
+    }
+    // The keys and values are stored as vectors, as on the CPU.
+    TensorShape expected_value_shape = keys.shape();
+    expected_value_shape.RemoveLastDims(1);
+    expected_value_shape.AppendShape(MaybeVectorizeShape(value_shape_));
+    if (values.shape() != expected_value_shape) {
+      return errors::InvalidArgument(
+          "Expected shape ", expected_value_shape.DebugString(),
+          " for value, got ", values.shape().DebugString());
+    }
+    return OkStatus();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const override { return TensorShape(); }
+
+  TensorShape value_shape() const override { return value_shape_; }
+
+  int64_t MemoryUsed() const override TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    return sizeof(GpuMutableDenseHashTable) + key_buckets_.AllocatedBytes() +
+           value_buckets_.AllocatedBytes() + counts_.AllocatedBytes();
+  }
+
+ private:
+  // Checks that `key` is a scalar or a vector of keys.
+  Status CheckKeyRank(const Tensor& key) const {
+    if (key.dims() > 1) {
+      return errors::InvalidArgument(
+          "Expected key shape ", TensorShape({key.dim_size(0)}).DebugString(),
+          " got ", key.shape().DebugString());
+    }
+    return OkStatus();
+  }
+
+  void DoInsert(OpKernelContext* ctx, const Tensor& key, const Tensor& value)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int64_t num_elements = key.NumElements();
+    functor::DenseHashTableInsert<GPUDevice, K, V>()(
+        ctx->eigen_device<GPUDevice>(), key.flat<K>(),
+        value.shaped<V, 2>({num_elements, value_shape_.num_elements()}),
+        empty_key_, deleted_key_, key_buckets_.flat<K>(),
+        value_buckets_.matrix<V>(), counts_.flat<int64_t>());
+  }
+
+  Status AllocateBuckets(OpKernelContext* ctx, int64_t new_num_buckets)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (new_num_buckets < 4 ||
+        ((new_num_buckets & (new_num_buckets - 1)) != 0)) {
+      return errors::InvalidArgument(
+          "Number of buckets must be at least 4 and a power of 2, got: ",
+          new_num_buckets);
+    }
+    num_buckets_ = new_num_buckets;
+    num_occupied_bound_ = 0;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        key_dtype(), TensorShape({num_buckets_, 1}), &key_buckets_));
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        value_dtype(), TensorShape({num_buckets_, value_shape_.num_elements()}),
+        &value_buckets_));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(DT_INT64, TensorShape({2}), &counts_));
+    functor::DenseHashTableInitialize<GPUDevice, K, V>()(
+        ctx->eigen_device<GPUDevice>(), empty_key_, key_buckets_.flat<K>(),
+        value_buckets_.matrix<V>(), counts_.flat<int64_t>());
+    return OkStatus();
+  }
+
+  Status Rebucket(OpKernelContext* ctx, int64_t num_new_buckets)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Tensor old_key_buckets = key_buckets_;
+    Tensor old_value_buckets = value_buckets_;
+    TF_RETURN_IF_ERROR(AllocateBuckets(ctx, num_new_buckets));
+    DoInsert(ctx, old_key_buckets, old_value_buckets);
+    return OkStatus();
+  }
+
+  // Copies the number of occupied buckets and the number of keys to `counts`.
+  Status ReadCounts(int64_t* counts) const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    se::DeviceMemoryBase counts_ptr(
+        const_cast<int64_t*>(counts_.flat<int64_t>().data()),
+        2 * sizeof(int64_t));
+    if (!stream_->ThenMemcpy(counts, counts_ptr, 2 * sizeof(int64_t)).ok()) {
+      return errors::Internal("Failed to copy the table size to host");
+    }
+    return stream_->BlockHostUntilDone();
+  }
+
+  TensorShape value_shape_;
+  float max_load_factor_;
+  K empty_key_;
+  K deleted_key_;
+  se::Stream* stream_;
+  mutable mutex mu_;
+  int64_t num_buckets_ TF_GUARDED_BY(mu_);
+  // An upper bound of the number of occupied buckets in counts_.
+  int64_t num_occupied_bound_ TF_GUARDED_BY(mu_);
+  Tensor key_buckets_ TF_GUARDED_BY(mu_);
+  Tensor value_buckets_ TF_GUARDED_BY(mu_);
+  Tensor counts_ TF_GUARDED_BY(mu_);
+};
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 }  // namespace lookup
 
 // Base class for kernels that take a LookupTable handle as the 0th input.
@@ -1244,4 +1617,94 @@ REGISTER_KERNEL(tstring, ResourceHandle);
 
 #undef REGISTER_KERNEL
 
+REGISTER_KERNEL_BUILDER(Name("MappedHashTable")
+                            .Device(DEVICE_CPU)
+                            .TypeConstraint<tstring>("key_dtype")
+                            .TypeConstraint<int64_t>("value_dtype"),
+                        LookupTableOp<lookup::MappedHashTable, tstring,
+                                      int64_t>);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+constexpr char kGpuDenseHashTableLabel[] = "gpu_dense_hash_table";
+
+// Register the GPU kernels of the MutableDenseHashTable op, and of the ops on
+// its tables. Unlike the CPU table, the GPU table only supports scalar keys
+// and ignores the empty and deleted keys instead of rejecting them, so these
+// kernels are only used for nodes labeled with kGpuDenseHashTableLabel.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                              \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("MutableDenseHashTableV2")                                        \
+          .Device(DEVICE_GPU)                                                \
+          .Label(kGpuDenseHashTableLabel)                                    \
+          .HostMemory("empty_key")                                           \
+          .HostMemory("deleted_key")                                         \
+          .HostMemory("table_handle")                                        \
+          .TypeConstraint<key_dtype>("key_dtype")                            \
+          .TypeConstraint<value_dtype>("value_dtype"),                       \
+      LookupTableOp<lookup::GpuMutableDenseHashTable<key_dtype, value_dtype>, \
+                    key_dtype, value_dtype>)                                 \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("AnonymousMutableDenseHashTable")                                 \
+          .Device(DEVICE_GPU)                                                \
+          .Label(kGpuDenseHashTableLabel)                                    \
+          .HostMemory("empty_key")                                           \
+          .HostMemory("deleted_key")                                         \
+          .HostMemory("table_handle")                                        \
+          .TypeConstraint<key_dtype>("key_dtype")                            \
+          .TypeConstraint<value_dtype>("value_dtype"),                       \
+      AnonymousLookupTableOp<                                                \
+          lookup::GpuMutableDenseHashTable<key_dtype, value_dtype>,          \
+          key_dtype, value_dtype>)                                           \
+  REGISTER_KERNEL_BUILDER(Name("LookupTableFindV2")                          \
+                              .Device(DEVICE_GPU)                            \
+                              .Label(kGpuDenseHashTableLabel)                \
+                              .HostMemory("table_handle")                    \
+                              .TypeConstraint<key_dtype>("Tin")              \
+                              .TypeConstraint<value_dtype>("Tout"),          \
+                          LookupTableFindOp);                                \
+  REGISTER_KERNEL_BUILDER(Name("LookupTableInsertV2")                        \
+                              .Device(DEVICE_GPU)                            \
+                              .Label(kGpuDenseHashTableLabel)                \
+                              .HostMemory("table_handle")                    \
+                              .TypeConstraint<key_dtype>("Tin")              \
+                              .TypeConstraint<value_dtype>("Tout"),          \
+                          LookupTableInsertOp);                              \
+  REGISTER_KERNEL_BUILDER(Name("LookupTableExportV2")                        \
+                              .Device(DEVICE_GPU)                            \
+                              .Label(kGpuDenseHashTableLabel)                \
+                              .HostMemory("table_handle")                    \
+                              .TypeConstraint<key_dtype>("Tkeys")            \
+                              .TypeConstraint<value_dtype>("Tvalues"),       \
+                          LookupTableExportOp);                              \
+  REGISTER_KERNEL_BUILDER(Name("LookupTableImportV2")                        \
+                              .Device(DEVICE_GPU)                            \
+                              .Label(kGpuDenseHashTableLabel)                \
+                              .HostMemory("table_handle")                    \
+                              .TypeConstraint<key_dtype>("Tin")              \
+                              .TypeConstraint<value_dtype>("Tout"),          \
+                          LookupTableImportOp);
+
+REGISTER_KERNEL(int64_t, bool);
+REGISTER_KERNEL(int64_t, double);
+REGISTER_KERNEL(int64_t, float);
+REGISTER_KERNEL(int64_t, int64_t);
+
+#undef REGISTER_KERNEL
+
+REGISTER_KERNEL_BUILDER(Name("LookupTableRemoveV2")
+                            .Device(DEVICE_GPU)
+                            .Label(kGpuDenseHashTableLabel)
+                            .HostMemory("table_handle")
+                            .TypeConstraint<int64_t>("Tin"),
+                        LookupTableRemoveOp);
+REGISTER_KERNEL_BUILDER(Name("LookupTableSizeV2")
+                            .Device(DEVICE_GPU)
+                            .Label(kGpuDenseHashTableLabel)
+                            .HostMemory("table_handle")
+                            .HostMemory("size"),
+                        LookupTableSizeOp);
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 }  // namespace tensorflow
@@ -0,0 +1,265 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/lookup_table_op_gpu.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+__device__ inline int64_t AtomicCasKey(int64_t* ptr, int64_t compare,
+                                       int64_t value) {
+  return static_cast<int64_t>(
+      atomicCAS(reinterpret_cast<unsigned long long*>(ptr),
+                static_cast<unsigned long long>(compare),
+                static_cast<unsigned long long>(value)));
+}
+
+template <typename K>
+__device__ inline int64_t FirstBucket(K key, int64_t bit_mask) {
+  return static_cast<int64_t>(static_cast<uint64>(key) & bit_mask);
+}
+
+}  // namespace
+
+template <typename K>
+__global__ void DenseHashTableInitializeKernel(int64_t num_buckets,
+                                               K empty_key,
+                                               K* __restrict__ key_buckets) {
+  GPU_1D_KERNEL_LOOP(i, num_buckets) { key_buckets[i] = empty_key; }
+}
+
+template <typename K, typename V>
+__global__ void DenseHashTableFindKernel(
+    int64_t num_keys, int64_t value_size, const K* __restrict__ keys,
+    const V* __restrict__ default_value, bool default_per_key, K empty_key,
+    K deleted_key, int64_t num_buckets, const K* __restrict__ key_buckets,
+    const V* __restrict__ value_buckets, V* __restrict__ values) {
+  const int64_t bit_mask = num_buckets - 1;
+  GPU_1D_KERNEL_LOOP(i, num_keys) {
+    const K key = ldg(keys + i);
+    const V* value = default_value + (default_per_key ? i * value_size : 0);
+    if (key != empty_key && key != deleted_key) {
+      int64_t bucket = FirstBucket(key, bit_mask);
+      for (int64_t num_probes = 1; num_probes <= num_buckets; ++num_probes) {
+        const K bucket_key = ldg(key_buckets + bucket);
+        if (bucket_key == key) {
+          value = value_buckets + bucket * value_size;
+          break;
+        }
+        if (bucket_key == empty_key) break;
+        bucket = (bucket + num_probes) & bit_mask;  // quadratic probing
+      }
+    }
+    for (int64_t j = 0; j < value_size; ++j) {
+      values[i * value_size + j] = value[j];
+    }
+  }
+}
+
+template <typename K, typename V>
+__global__ void DenseHashTableInsertKernel(
+    int64_t num_keys, int64_t value_size, const K* __restrict__ keys,
+    const V* __restrict__ values, K empty_key, K deleted_key,
+    int64_t num_buckets, K* __restrict__ key_buckets,
+    V* __restrict__ value_buckets, int64_t* __restrict__ counts) {
+  const int64_t bit_mask = num_buckets - 1;
+  GPU_1D_KERNEL_LOOP(i, num_keys) {
+    const K key = ldg(keys + i);
+    if (key == empty_key || key == deleted_key) continue;
+    int64_t bucket = FirstBucket(key, bit_mask);
+    for (int64_t num_probes = 1; num_probes <= num_buckets; ++num_probes) {
+      // Buckets are only claimed while inserting, so a bucket seen as
+      // occupied stays so, and only empty buckets need an atomic. Deleted
+      // buckets are not reused, as the key may be further along its probes;
+      // they are reclaimed when the buckets are grown.
+      K bucket_key = key_buckets[bucket];
+      if (bucket_key == empty_key) {
+        bucket_key = AtomicCasKey(key_buckets + bucket, empty_key, key);
+        if (bucket_key == empty_key) {
+          GpuAtomicAdd(counts, int64_t{1});
+          GpuAtomicAdd(counts + 1, int64_t{1});
+          bucket_key = key;
+        }
+      }
+      if (bucket_key == key) {
+        for (int64_t j = 0; j < value_size; ++j) {
+          value_buckets[bucket * value_size + j] = values[i * value_size + j];
+        }
+        break;
+      }
+      bucket = (bucket + num_probes) & bit_mask;  // quadratic probing
+    }
+  }
+}
+
+template <typename K>
+__global__ void DenseHashTableRemoveKernel(int64_t num_keys,
+                                           const K* __restrict__ keys,
+                                           K empty_key, K deleted_key,
+                                           int64_t num_buckets,
+                                           K* __restrict__ key_buckets,
+                                           int64_t* __restrict__ counts) {
+  const int64_t bit_mask = num_buckets - 1;
+  GPU_1D_KERNEL_LOOP(i, num_keys) {
+    const K key = ldg(keys + i);
+    if (key == empty_key || key == deleted_key) continue;
+    int64_t bucket = FirstBucket(key, bit_mask);
+    for (int64_t num_probes = 1; num_probes <= num_buckets; ++num_probes) {
+      const K bucket_key = key_buckets[bucket];
+      if (bucket_key == key) {
+        // Only one of the removals of a key repeated in `keys` succeeds.
+        if (AtomicCasKey(key_buckets + bucket, key, deleted_key) == key) {
+          GpuAtomicAdd(counts + 1, int64_t{-1});
+        }
+        break;
+      }
+      if (bucket_key == empty_key) break;
+      bucket = (bucket + num_probes) & bit_mask;  // quadratic probing
+    }
+  }
+}
+
+template <typename K>
+__global__ void DenseHashTableCountKernel(int64_t num_buckets, K empty_key,
+                                          K deleted_key,
+                                          const K* __restrict__ key_buckets,
+                                          int64_t* __restrict__ counts) {
+  GPU_1D_KERNEL_LOOP(i, num_buckets) {
+    const K bucket_key = ldg(key_buckets + i);
+    if (bucket_key != empty_key) {
+      GpuAtomicAdd(counts, int64_t{1});
+      if (bucket_key != deleted_key) GpuAtomicAdd(counts + 1, int64_t{1});
+    }
+  }
+}
+
+namespace functor {
+
+template <typename K, typename V>
+struct DenseHashTableInitialize<GPUDevice, K, V> {
+  void operator()(const GPUDevice& d, K empty_key,
+                  typename TTypes<K>::Flat key_buckets,
+                  typename TTypes<V>::Matrix value_buckets,
+                  typename TTypes<int64_t>::Flat counts) {
+    // The values are zeroed to avoid exporting uninitialized memory.
+    d.memset(value_buckets.data(), 0, value_buckets.size() * sizeof(V));
+    d.memset(counts.data(), 0, counts.size() * sizeof(int64_t));
+    GpuLaunchConfig config = GetGpuLaunchConfig(key_buckets.size(), d);
+    TF_CHECK_OK(GpuLaunchKernel(DenseHashTableInitializeKernel<K>,
+                                config.block_count, config.thread_per_block,
+                                0, d.stream(), key_buckets.size(), empty_key,
+                                key_buckets.data()));
+  }
+};
+
+template <typename K, typename V>
+struct DenseHashTableFind<GPUDevice, K, V> {
+  void operator()(const GPUDevice& d, typename TTypes<K>::ConstFlat keys,
+                  typename TTypes<V>::ConstMatrix default_value, K empty_key,
+                  K deleted_key, typename TTypes<K>::ConstFlat key_buckets,
+                  typename TTypes<V>::ConstMatrix value_buckets,
+                  typename TTypes<V>::Matrix values) {
+    if (keys.size() == 0) return;
+    GpuLaunchConfig config = GetGpuLaunchConfig(keys.size(), d);
+    TF_CHECK_OK(GpuLaunchKernel(
+        DenseHashTableFindKernel<K, V>, config.block_count,
+        config.thread_per_block, 0, d.stream(), keys.size(),
+        values.dimension(1), keys.data(), default_value.data(),
+        default_value.dimension(0) != 1, empty_key, deleted_key,
+        key_buckets.size(), key_buckets.data(), value_buckets.data(),
+        values.data()));
+  }
+};
+
+template <typename K, typename V>
+struct DenseHashTableInsert<GPUDevice, K, V> {
+  void operator()(const GPUDevice& d, typename TTypes<K>::ConstFlat keys,
+                  typename TTypes<V>::ConstMatrix values, K empty_key,
+                  K deleted_key, typename TTypes<K>::Flat key_buckets,
+                  typename TTypes<V>::Matrix value_buckets,
+                  typename TTypes<int64_t>::Flat counts) {
+    if (keys.size() == 0) return;
+    GpuLaunchConfig config = GetGpuLaunchConfig(keys.size(), d);
+    TF_CHECK_OK(GpuLaunchKernel(
+        DenseHashTableInsertKernel<K, V>, config.block_count,
+        config.thread_per_block, 0, d.stream(), keys.size(),
+        value_buckets.dimension(1), keys.data(), values.data(), empty_key,
+        deleted_key, key_buckets.size(), key_buckets.data(),
+        value_buckets.data(), counts.data()));
+  }
+};
+
+template <typename K>
+struct DenseHashTableRemove<GPUDevice, K> {
+  void operator()(const GPUDevice& d, typename TTypes<K>::ConstFlat keys,
+                  K empty_key, K deleted_key,
+                  typename TTypes<K>::Flat key_buckets,
+                  typename TTypes<int64_t>::Flat counts) {
+    if (keys.size() == 0) return;
+    GpuLaunchConfig config = GetGpuLaunchConfig(keys.size(), d);
+    TF_CHECK_OK(GpuLaunchKernel(
+        DenseHashTableRemoveKernel<K>, config.block_count,
+        config.thread_per_block, 0, d.stream(), keys.size(), keys.data(),
+        empty_key, deleted_key, key_buckets.size(), key_buckets.data(),
+        counts.data()));
+  }
+};
+
+template <typename K>
+struct DenseHashTableCount<GPUDevice, K> {
+  void operator()(const GPUDevice& d, K empty_key, K deleted_key,
+                  typename TTypes<K>::ConstFlat key_buckets,
+                  typename TTypes<int64_t>::Flat counts) {
+    d.memset(counts.data(), 0, counts.size() * sizeof(int64_t));
+    if (key_buckets.size() == 0) return;
+    GpuLaunchConfig config = GetGpuLaunchConfig(key_buckets.size(), d);
+    TF_CHECK_OK(GpuLaunchKernel(DenseHashTableCountKernel<K>,
+                                config.block_count, config.thread_per_block,
+                                0, d.stream(), key_buckets.size(), empty_key,
+                                deleted_key, key_buckets.data(),
+                                counts.data()));
+  }
+};
+
+}  // namespace functor
+
+#define DEFINE_GPU_SPECS(K, V)                                        \
+  template struct functor::DenseHashTableInitialize<GPUDevice, K, V>; \
+  template struct functor::DenseHashTableFind<GPUDevice, K, V>;       \
+  template struct functor::DenseHashTableInsert<GPUDevice, K, V>;
+
+DEFINE_GPU_SPECS(int64_t, bool);
+DEFINE_GPU_SPECS(int64_t, double);
+DEFINE_GPU_SPECS(int64_t, float);
+DEFINE_GPU_SPECS(int64_t, int64_t);
+#undef DEFINE_GPU_SPECS
+
+template struct functor::DenseHashTableRemove<GPUDevice, int64_t>;
+template struct functor::DenseHashTableCount<GPUDevice, int64_t>;
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
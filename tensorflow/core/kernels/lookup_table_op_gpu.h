@@ -0,0 +1,88 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_GPU_H_
+#define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_GPU_H_
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+namespace functor {
+
+// Functors over the buckets of a MutableDenseHashTable with scalar keys, laid
+// out as on the CPU: `key_buckets` holds a key per bucket, or `empty_key` or
+// `deleted_key`, and `value_buckets` the row of values of every bucket. Keys
+// are hashed with the identity and probed quadratically, so that tables can be
+// exported from and imported into either device.
+//
+// `counts` holds the number of occupied buckets, which includes the deleted
+// ones, followed by the number of keys in the table.
+
+// Fills the keys of all buckets with `empty_key`, zeroes their values and the
+// counts.
+template <typename Device, typename K, typename V>
+struct DenseHashTableInitialize {
+  void operator()(const Device& d, K empty_key,
+                  typename TTypes<K>::Flat key_buckets,
+                  typename TTypes<V>::Matrix value_buckets,
+                  typename TTypes<int64_t>::Flat counts);
+};
+
+// Looks up every key of `keys`, and writes the values of the keys that are not
+// found from `default_value`, which has either a single row or a row per key.
+template <typename Device, typename K, typename V>
+struct DenseHashTableFind {
+  void operator()(const Device& d, typename TTypes<K>::ConstFlat keys,
+                  typename TTypes<V>::ConstMatrix default_value, K empty_key,
+                  K deleted_key, typename TTypes<K>::ConstFlat key_buckets,
+                  typename TTypes<V>::ConstMatrix value_buckets,
+                  typename TTypes<V>::Matrix values);
+};
+
+// Inserts or updates the keys of `keys`, skipping `empty_key` and
+// `deleted_key`. The buckets must have room for all the keys. When a key
+// occurs several times, any of its values may be inserted.
+template <typename Device, typename K, typename V>
+struct DenseHashTableInsert {
+  void operator()(const Device& d, typename TTypes<K>::ConstFlat keys,
+                  typename TTypes<V>::ConstMatrix values, K empty_key,
+                  K deleted_key, typename TTypes<K>::Flat key_buckets,
+                  typename TTypes<V>::Matrix value_buckets,
+                  typename TTypes<int64_t>::Flat counts);
+};
+
+// Replaces the keys of `keys` that are in the buckets with `deleted_key`.
+template <typename Device, typename K>
+struct DenseHashTableRemove {
+  void operator()(const Device& d, typename TTypes<K>::ConstFlat keys,
+                  K empty_key, K deleted_key,
+                  typename TTypes<K>::Flat key_buckets,
+                  typename TTypes<int64_t>::Flat counts);
+};
+
+// Recomputes the counts of the buckets.
+template <typename Device, typename K>
+struct DenseHashTableCount {
+  void operator()(const Device& d, K empty_key, K deleted_key,
+                  typename TTypes<K>::ConstFlat key_buckets,
+                  typename TTypes<int64_t>::Flat counts);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_GPU_H_
@@ -15,6 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/lookup_util.h"
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/strip.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_requires.h"
@@ -23,7 +29,10 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -56,6 +65,61 @@ Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
   return OkStatus();
 }
 
+// Sets element `position` of `tensor` from `line` or its `tokens` based on
+// `index`, where `line` is the line `line_number` of the file. The value is
+// transformed to the data type of `tensor`.
+Status SetValue(StringPiece line, const std::vector<string>& tokens,
+                int64_t index, int64_t line_number, int64_t offset,
+                int64_t position, Tensor* tensor) {
+  if (index == kLineNumber) {
+    tensor->flat<int64_t>()(position) = line_number + offset;
+    return OkStatus();
+  }
+  const StringPiece token = (index == kWholeLine) ? line : tokens[index];
+  const DataType& dtype = tensor->dtype();
+  switch (dtype) {
+    case DT_INT32: {
+      int32_t value;
+      if (!strings::safe_strto32(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid int32.");
+      }
+      tensor->flat<int32>()(position) = value + offset;
+    } break;
+    case DT_INT64: {
+      int64_t value;
+      if (!strings::safe_strto64(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid int64.");
+      }
+      tensor->flat<int64_t>()(position) = value;
+    } break;
+    case DT_FLOAT: {
+      float value;
+      if (!strings::safe_strtof(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid float.");
+      }
+      tensor->flat<float>()(position) = value;
+    } break;
+    case DT_DOUBLE: {
+      double value;
+      if (!strings::safe_strtod(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid double.");
+      }
+      tensor->flat<double>()(position) = value;
+    } break;
+    case DT_STRING:
+      tensor->flat<tstring>()(position).assign(token.data(), token.size());
+      break;
+    default:
+      return errors::InvalidArgument("Data type ", DataTypeString(dtype),
+                                     " not supported.");
+  }
+  return OkStatus();
+}
+
 // Iterator that reads a text file. Each iteration process one line, it parses
 // the line and populates the keys and values tensors used for initialization
 // with a single key and corresponding value.
@@ -151,12 +215,14 @@ class TextFileLineIterator
       }
     }
 
-    status_ = SetValue(line, tokens, key_index_, &key_);
+    status_ = SetValue(line, tokens, key_index_, next_id_, offset_,
+                       /*position=*/0, &key_);
     if (!status_.ok()) {
       valid_ = false;
       return;
     }
-    status_ = SetValue(line, tokens, value_index_, &value_);
+    status_ = SetValue(line, tokens, value_index_, next_id_, offset_,
+                       /*position=*/0, &value_);
     if (!status_.ok()) {
       valid_ = false;
       return;
@@ -203,65 +269,197 @@ class TextFileLineIterator
   std::unique_ptr<RandomAccessFile> file_;  // must outlive input_buffer_
   std::unique_ptr<io::InputBuffer> input_buffer_;
 
-  // Set the corresponding value from line or tokens based on 'index' into the
-  // tensor 't'. The value is transformed to the given data type 'dtype'.
-  Status SetValue(const string& line, const std::vector<string>& tokens,
-                  int64_t index, Tensor* tensor) {
-    if (index == kLineNumber) {
-      tensor->flat<int64_t>()(0) = next_id_ + offset_;
-      return OkStatus();
+  TF_DISALLOW_COPY_AND_ASSIGN(TextFileLineIterator);
+};
+
+// Calls `fn(line, end)` for each line of `chunk`, where `end` is the offset in
+// `chunk` past the line and its newline. Lines are split as
+// io::InputBuffer::ReadLine does: a trailing '\r' is dropped, and a last line
+// without a newline is only a line if it isn't empty.
+template <typename Fn>
+void ForEachLine(StringPiece chunk, Fn fn) {
+  size_t begin = 0;
+  while (begin < chunk.size()) {
+    const char* newline = static_cast<const char*>(
+        memchr(chunk.data() + begin, '\n', chunk.size() - begin));
+    const size_t end =
+        newline != nullptr ? newline - chunk.data() : chunk.size();
+    StringPiece line = chunk.substr(begin, end - begin);
+    absl::ConsumeSuffix(&line, "\r");
+    if (newline == nullptr && line.empty()) break;
+    fn(line, std::min(end + 1, chunk.size()));
+    begin = end + 1;
+  }
+}
+
+// Iterator that parses a whole text file at once and returns all of its keys
+// and values in a single iteration, so that they are inserted into a table
+// presized to the number of lines in one batch. The lines are parsed exactly
+// as by TextFileLineIterator.
+//
+// The file is memory mapped if its file system supports it, and otherwise
+// read in full. It is split into byte ranges of whole lines, which are first
+// counted and then parsed in parallel on `thread_pool`.
+class ParallelTextFileIterator
+    : public InitializableLookupTable::InitTableIterator {
+ public:
+  ParallelTextFileIterator()
+      : valid_(false), status_(errors::FailedPrecondition("Not initialized")) {}
+
+  Status Init(const string& filename, int64_t vocab_size, char delimiter,
+              DataType key_dtype, int64_t key_index, DataType value_dtype,
+              int64_t value_index, int64_t offset, Env* env,
+              thread::ThreadPool* thread_pool) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    string buffer;
+    StringPiece contents;
+    if (env->NewReadOnlyMemoryRegionFromFile(filename, &region).ok()) {
+      contents = StringPiece(static_cast<const char*>(region->data()),
+                             region->length());
+    } else {
+      status_ = ReadFileToString(env, filename, &buffer);
+      if (!status_.ok()) return status_;
+      contents = buffer;
     }
-    const string& token = (index == kWholeLine) ? line : tokens[index];
-    const DataType& dtype = tensor->dtype();
-    switch (dtype) {
-      case DT_INT32: {
-        int32_t value;
-        if (!strings::safe_strto32(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid int32.");
-        }
-        tensor->flat<int32>()(0) = value + offset_;
-      } break;
-      case DT_INT64: {
-        int64_t value;
-        if (!strings::safe_strto64(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid int64.");
-        }
-        tensor->flat<int64_t>()(0) = value;
-      } break;
-      case DT_FLOAT: {
-        float value;
-        if (!strings::safe_strtof(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid float.");
-        }
-        tensor->flat<float>()(0) = value;
-      } break;
-      case DT_DOUBLE: {
-        double value;
-        if (!strings::safe_strtod(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid double.");
-        }
-        tensor->flat<double>()(0) = value;
-      } break;
-      case DT_STRING:
-        tensor->flat<tstring>()(0) = token;
-        break;
-      default:
-        valid_ = false;
-        return errors::InvalidArgument("Data type ", DataTypeString(dtype),
-                                       " not supported.");
+
+    const std::vector<StringPiece> chunks =
+        SplitIntoChunks(contents, thread_pool->NumThreads());
+    const int64_t num_chunks = chunks.size();
+    // The number of the first line of every chunk, and of lines in the file.
+    std::vector<int64_t> first_lines(num_chunks + 1, 0);
+    thread_pool->ParallelFor(
+        num_chunks, kChunkCost, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            ForEachLine(chunks[i], [&](StringPiece, size_t) {
+              ++first_lines[i + 1];
+            });
+          }
+        });
+    for (int64_t i = 0; i < num_chunks; ++i) {
+      first_lines[i + 1] += first_lines[i];
     }
-    return OkStatus();
+    const int64_t num_lines = first_lines[num_chunks];
+    int64_t num_entries = num_lines;
+    if (vocab_size != -1 && num_lines > vocab_size) {
+      LOG(WARNING) << "Truncated " << filename << " before its end at "
+                   << vocab_size << " records.";
+      num_entries = vocab_size;
+    }
+
+    keys_ = Tensor(key_dtype, TensorShape({num_entries}));
+    values_ = Tensor(value_dtype, TensorShape({num_entries}));
+    const bool ignore_split = std::max(key_index, value_index) < 0;
+    const auto expected_size =
+        static_cast<size_t>(std::max(key_index, value_index) + 1);
+    std::vector<Status> chunk_status(num_chunks);
+    thread_pool->ParallelFor(
+        num_chunks, kChunkCost, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            const size_t chunk_offset = chunks[i].data() - contents.data();
+            int64_t line_number = first_lines[i];
+            Status& status = chunk_status[i];
+            ForEachLine(chunks[i], [&](StringPiece line, size_t line_end) {
+              if (!status.ok() || line_number >= num_entries) return;
+              if (line.empty()) {
+                status = errors::InvalidArgument(
+                    "Invalid content in ", filename,
+                    ": empty line found at position ", chunk_offset + line_end,
+                    ".");
+                return;
+              }
+              std::vector<string> tokens;
+              if (!ignore_split) {
+                tokens = str_util::Split(line, delimiter);
+                if (tokens.size() < expected_size) {
+                  status = errors::InvalidArgument(
+                      "Invalid number of columns in ", filename, " line ",
+                      line_number, " (", line, ") : expected at least ",
+                      expected_size, " got ", tokens.size());
+                  return;
+                }
+              }
+              status.Update(SetValue(line, tokens, key_index, line_number,
+                                     offset, line_number, &keys_));
+              status.Update(SetValue(line, tokens, value_index, line_number,
+                                     offset, line_number, &values_));
+              ++line_number;
+            });
+          }
+        });
+
+    // Reports the error of the first invalid line, as reading the file line
+    // by line would.
+    for (const Status& s : chunk_status) {
+      if (!s.ok()) {
+        status_ = s;
+        return status_;
+      }
+    }
+    if (vocab_size != -1 && num_lines < vocab_size) {
+      status_ = errors::InvalidArgument("Invalid vocab_size in ", filename,
+                                        ": expected ", vocab_size,
+                                        " but got ", num_lines);
+    } else if (num_entries == 0) {
+      status_ = errors::OutOfRange("Reached the end of ", filename);
+    } else {
+      status_ = OkStatus();
+      valid_ = true;
+    }
+    return status_;
   }
 
-  TF_DISALLOW_COPY_AND_ASSIGN(TextFileLineIterator);
+  void Next() override {
+    if (!valid_) return;
+    valid_ = false;
+    status_ = errors::OutOfRange("Finished reading ", keys_.NumElements(),
+                                 " lines.");
+  }
+
+  bool Valid() const override { return valid_; }
+
+  const Tensor& keys() const override { return keys_; }
+
+  const Tensor& values() const override { return values_; }
+
+  Status status() const override { return status_; }
+
+  int64_t total_size() const override { return keys_.NumElements(); }
+
+ private:
+  // The minimum size of the byte ranges parsed in parallel.
+  static constexpr size_t kMinChunkBytes = 1 << 20;
+  // The cost of parsing a byte range, high enough for ParallelFor to parse
+  // every range on its own thread.
+  static constexpr int64_t kChunkCost = 1 << 30;
+
+  // Splits `contents` into ranges of whole lines, about as many as there are
+  // threads but at least kMinChunkBytes large.
+  static std::vector<StringPiece> SplitIntoChunks(StringPiece contents,
+                                                  int num_threads) {
+    const size_t num_chunks = std::max<size_t>(
+        1, std::min<size_t>(num_threads, contents.size() / kMinChunkBytes));
+    std::vector<StringPiece> chunks;
+    size_t begin = 0;
+    for (size_t i = 1; i <= num_chunks && begin < contents.size(); ++i) {
+      size_t end = contents.size();
+      if (i < num_chunks) {
+        const size_t target = std::max(begin, contents.size() * i / num_chunks);
+        const char* newline = static_cast<const char*>(memchr(
+            contents.data() + target, '\n', contents.size() - target));
+        if (newline != nullptr) end = newline - contents.data() + 1;
+      }
+      chunks.push_back(contents.substr(begin, end - begin));
+      begin = end;
+    }
+    return chunks;
+  }
+
+  Tensor keys_;
+  Tensor values_;
+  bool valid_;
+  Status status_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ParallelTextFileIterator);
 };
 
 Status GetTableHandle(StringPiece input_name, OpKernelContext* ctx,
@@ -373,6 +571,18 @@ Status InitializeTableFromTextFile(
     int32_t key_index, int32_t value_index, int64_t offset, Env* env,
     std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
     InitializableLookupTable* table) {
+  return InitializeTableFromTextFile(filename, vocab_size, delimiter, key_index,
+                                     value_index, offset, env,
+                                     /*thread_pool=*/nullptr,
+                                     std::move(serializer), table);
+}
+
+Status InitializeTableFromTextFile(
+    const string& filename, int64_t vocab_size, char delimiter,
+    int32_t key_index, int32_t value_index, int64_t offset, Env* env,
+    thread::ThreadPool* thread_pool,
+    std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
+    InitializableLookupTable* table) {
   if (key_index == kLineNumber && table->key_dtype() != DT_INT64) {
     return errors::InvalidArgument(
         "Key index for line number requires table key dtype of int64, got ",
@@ -399,15 +609,24 @@ Status InitializeTableFromTextFile(
         DataTypeString(table->value_dtype()));
   }
 
-  TextFileLineIterator iter;
-  TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
-                               key_index, value_dtype, value_index, offset,
-                               env));
+  Status s;
+  if (thread_pool != nullptr) {
+    ParallelTextFileIterator iter;
+    TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
+                                 key_index, value_dtype, value_index, offset,
+                                 env, thread_pool));
+    s = table->Initialize(iter, std::move(serializer));
+  } else {
+    TextFileLineIterator iter;
+    TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
+                                 key_index, value_dtype, value_index, offset,
+                                 env));
+    s = table->Initialize(iter, std::move(serializer));
+  }
   // For initialization from files, ignore if the table is already
   // initialized. The table shared name should contain the filename to
   // avoid trying to initialize the same table from the same file at the same
   // time.
-  Status s = table->Initialize(iter, std::move(serializer));
   if (errors::IsFailedPrecondition(s) && table->is_initialized()) {
     LOG(INFO) << "Table trying to initialize from file " << filename
               << " is already initialized.";
@@ -0,0 +1,423 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/matmul_op_amx.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+// The AMX kernels are compiled for their target whatever the flags of the
+// build, and only run after checking the CPU at runtime.
+#if defined(__x86_64__) && defined(__linux__) && \
+    (defined(__clang__) ? __clang_major__ >= 12 : __GNUC__ >= 11)
+#define TF_MATMUL_AMX_KERNELS 1
+#include <immintrin.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace tensorflow {
+
+bool AmxPackedOperandCache::Enabled() {
+  static const bool enabled = [] {
+    bool frozen_weights = false;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_ASSUME_FROZEN_WEIGHTS",
+                                   /*default_val=*/false, &frozen_weights));
+    return frozen_weights;
+  }();
+  return enabled;
+}
+
+bool AmxPackedOperandCache::Lookup(const Tensor& operand, bool trans,
+                                   Tensor* packed) {
+  tf_shared_lock lock(mu_);
+  if (!packed_.IsInitialized() || operand_.data() != operand.data() ||
+      operand_.dtype() != operand.dtype() ||
+      operand_.shape() != operand.shape() || trans_ != trans) {
+    return false;
+  }
+  *packed = packed_;
+  return true;
+}
+
+void AmxPackedOperandCache::Insert(const Tensor& operand, bool trans,
+                                   const Tensor& packed) {
+  mutex_lock lock(mu_);
+  operand_ = operand;
+  trans_ = trans;
+  packed_ = packed;
+}
+
+#ifdef TF_MATMUL_AMX_KERNELS
+
+#define TF_AMX_TARGET __attribute__((target("amx-tile,amx-int8,amx-bf16")))
+
+namespace {
+
+// All the tiles used have 16 rows of 64 bytes: 16 x 16 accumulators for the
+// result, and 16 rows of 64 bytes of each operand.
+constexpr int kTileRows = 16;
+constexpr int kTileBytes = 64;
+
+// Each task computes a block of 2 x 2 result tiles.
+constexpr int64_t kBlockRows = 2 * kTileRows;
+constexpr int64_t kBlockCols = 2 * kTileRows;
+
+// Linux only lets a process use the AMX tile data after it asks for it, which
+// it can do once for all its threads.
+bool RequestAmxPermission() {
+  constexpr int kArchReqXcompPerm = 0x1023;
+  constexpr int kXfeatureXtiledata = 18;
+  return syscall(SYS_arch_prctl, kArchReqXcompPerm, kXfeatureXtiledata) == 0;
+}
+
+bool HaveAmxTiles() {
+  static const bool have_amx_tiles =
+      port::TestCPUFeature(port::CPUFeature::AMX_TILE) &&
+      RequestAmxPermission();
+  return have_amx_tiles;
+}
+
+// The layout of the tile configuration loaded by _tile_loadconfig.
+struct alignas(64) AmxTileConfig {
+  uint8 palette_id;
+  uint8 start_row;
+  uint8 reserved[14];
+  uint16 colsb[16];
+  uint8 rows[16];
+};
+
+// Tiles 0 to 3 accumulate the results, tiles 4 and 5 hold rows of the left
+// operand, and tiles 6 and 7 columns of the right one.
+constexpr AmxTileConfig MakeAmxTileConfig() {
+  AmxTileConfig config = {};
+  config.palette_id = 1;
+  for (int t = 0; t < 8; ++t) {
+    config.colsb[t] = kTileBytes;
+    config.rows[t] = kTileRows;
+  }
+  return config;
+}
+
+// A constant, since compilers may drop the stores to a local configuration
+// only read by _tile_loadconfig.
+constexpr AmxTileConfig kAmxTileConfig = MakeAmxTileConfig();
+
+// Configures the tiles of the calling thread.
+TF_AMX_TARGET void ConfigureAmxTiles() { _tile_loadconfig(&kAmxTileConfig); }
+
+TF_AMX_TARGET void ReleaseAmxTiles() { _tile_release(); }
+
+// The dot products of tiles of Ta and Tb elements, into the 2 x 2 result
+// tiles. The tile numbers are part of the instructions, hence the literals.
+template <typename Ta, typename Tb>
+struct AmxDot;
+
+template <>
+struct AmxDot<bfloat16, bfloat16> {
+  using Accumulator = float;
+  TF_AMX_TARGET static void Run() {
+    _tile_dpbf16ps(0, 4, 6);
+    _tile_dpbf16ps(1, 4, 7);
+    _tile_dpbf16ps(2, 5, 6);
+    _tile_dpbf16ps(3, 5, 7);
+  }
+};
+
+template <>
+struct AmxDot<int8, int8> {
+  using Accumulator = int32;
+  TF_AMX_TARGET static void Run() {
+    _tile_dpbssd(0, 4, 6);
+    _tile_dpbssd(1, 4, 7);
+    _tile_dpbssd(2, 5, 6);
+    _tile_dpbssd(3, 5, 7);
+  }
+};
+
+template <>
+struct AmxDot<int8, uint8> {
+  using Accumulator = int32;
+  TF_AMX_TARGET static void Run() {
+    _tile_dpbsud(0, 4, 6);
+    _tile_dpbsud(1, 4, 7);
+    _tile_dpbsud(2, 5, 6);
+    _tile_dpbsud(3, 5, 7);
+  }
+};
+
+template <>
+struct AmxDot<uint8, int8> {
+  using Accumulator = int32;
+  TF_AMX_TARGET static void Run() {
+    _tile_dpbusd(0, 4, 6);
+    _tile_dpbusd(1, 4, 7);
+    _tile_dpbusd(2, 5, 6);
+    _tile_dpbusd(3, 5, 7);
+  }
+};
+
+template <>
+struct AmxDot<uint8, uint8> {
+  using Accumulator = int32;
+  TF_AMX_TARGET static void Run() {
+    _tile_dpbuud(0, 4, 6);
+    _tile_dpbuud(1, 4, 7);
+    _tile_dpbuud(2, 5, 6);
+    _tile_dpbuud(3, 5, 7);
+  }
+};
+
+// A row of a tile of the right operand holds the kPack consecutive elements
+// along the depth of each of its 16 columns, and a tile covers kDepth of the
+// depth.
+template <typename T>
+struct AmxOperand {
+  static constexpr int kPack = 4 / sizeof(T);
+  static constexpr int kDepth = kTileBytes / sizeof(T);
+};
+
+int64_t RoundUp(int64_t n, int64_t multiple) {
+  return (n + multiple - 1) / multiple * multiple;
+}
+
+// Copies the rows x depth matrix op(x) into `packed`, as a row-major
+// padded_rows x padded_depth matrix padded with zeros.
+template <typename T>
+void PackLhs(const T* x, bool trans, int64_t rows, int64_t depth,
+             int64_t padded_rows, int64_t padded_depth, T* packed) {
+  for (int64_t i = 0; i < padded_rows; ++i) {
+    T* out = packed + i * padded_depth;
+    if (i >= rows) {
+      std::fill(out, out + padded_depth, T(0));
+      continue;
+    }
+    if (trans) {
+      for (int64_t k = 0; k < depth; ++k) out[k] = x[k * rows + i];
+    } else {
+      std::copy(x + i * depth, x + (i + 1) * depth, out);
+    }
+    std::fill(out + depth, out + padded_depth, T(0));
+  }
+}
+
+// Copies the depth x cols matrix op(y) into `packed`, padded with zeros to
+// padded_depth x padded_cols, as the rows of tiles of its groups of 16
+// columns, one group after the other.
+template <typename T>
+void PackRhs(const T* y, bool trans, int64_t depth, int64_t cols,
+             int64_t padded_depth, int64_t padded_cols, T* packed) {
+  constexpr int kPack = AmxOperand<T>::kPack;
+  for (int64_t j0 = 0; j0 < padded_cols; j0 += kTileRows) {
+    T* out = packed + j0 * padded_depth;
+    for (int64_t k0 = 0; k0 < padded_depth; k0 += kPack) {
+      for (int64_t j = j0; j < j0 + kTileRows; ++j) {
+        for (int64_t k = k0; k < k0 + kPack; ++k) {
+          *out++ = k < depth && j < cols
+                       ? (trans ? y[j * depth + k] : y[k * cols + j])
+                       : T(0);
+        }
+      }
+    }
+  }
+}
+
+// Computes the kBlockRows x kBlockCols block of the product of the packed
+// rows at `lhs` and the packed columns at `rhs`, into the row-major `result`.
+template <typename Ta, typename Tb>
+TF_AMX_TARGET void AmxMultiplyBlock(
+    const Ta* lhs, const Tb* rhs, int64_t padded_depth,
+    typename AmxDot<Ta, Tb>::Accumulator* result) {
+  constexpr int kDepth = AmxOperand<Ta>::kDepth;
+  const Ta* lhs_bottom = lhs + kTileRows * padded_depth;
+  const Tb* rhs_right = rhs + kTileRows * padded_depth;
+  const int64_t lhs_stride = padded_depth * sizeof(Ta);
+  _tile_zero(0);
+  _tile_zero(1);
+  _tile_zero(2);
+  _tile_zero(3);
+  for (int64_t k = 0; k < padded_depth; k += kDepth) {
+    _tile_loadd(4, lhs + k, lhs_stride);
+    _tile_loadd(5, lhs_bottom + k, lhs_stride);
+    _tile_loadd(6, rhs + k * kTileRows, kTileBytes);
+    _tile_loadd(7, rhs_right + k * kTileRows, kTileBytes);
+    AmxDot<Ta, Tb>::Run();
+  }
+  constexpr int kResultStride =
+      kBlockCols * sizeof(typename AmxDot<Ta, Tb>::Accumulator);
+  _tile_stored(0, result, kResultStride);
+  _tile_stored(1, result + kTileRows, kResultStride);
+  _tile_stored(2, result + kTileRows * kBlockCols, kResultStride);
+  _tile_stored(3, result + kTileRows * kBlockCols + kTileRows, kResultStride);
+}
+
+template <typename Ta, typename Tb, typename Tout>
+void AmxBatchMatMul(OpKernelContext* context, const Tensor& in_x,
+                    const Tensor& in_y, bool trans_x, bool trans_y,
+                    const MatMulBCast& bcast, Tensor* out,
+                    AmxPackedOperandCache* cache) {
+  using Accumulator = typename AmxDot<Ta, Tb>::Accumulator;
+  const int64_t rows = out->dim_size(1);
+  const int64_t cols = out->dim_size(2);
+  const int64_t depth = in_x.dim_size(trans_x ? 1 : 2);
+  const int64_t padded_rows = RoundUp(rows, kBlockRows);
+  const int64_t padded_cols = RoundUp(cols, kBlockCols);
+  const int64_t padded_depth = RoundUp(depth, AmxOperand<Ta>::kDepth);
+
+  Tensor packed_x, packed_y;
+  OP_REQUIRES_OK(context, context->allocate_temp(
+                              DataTypeToEnum<Ta>::v(),
+                              TensorShape({in_x.dim_size(0), padded_rows,
+                                           padded_depth}),
+                              &packed_x));
+  const Ta* x = in_x.flat<Ta>().data();
+  Ta* x_packed = packed_x.flat<Ta>().data();
+  Tout* z = out->flat<Tout>().data();
+
+  auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, in_x.dim_size(0),
+        padded_rows * padded_depth, [&](int64_t start, int64_t limit) {
+          for (int64_t b = start; b < limit; ++b) {
+            PackLhs(x + b * rows * depth, trans_x, rows, depth, padded_rows,
+                    padded_depth, x_packed + b * padded_rows * padded_depth);
+          }
+        });
+  if (cache == nullptr || !cache->Lookup(in_y, trans_y, &packed_y)) {
+    OP_REQUIRES_OK(context, context->allocate_temp(
+                                DataTypeToEnum<Tb>::v(),
+                                TensorShape({in_y.dim_size(0), padded_cols,
+                                             padded_depth}),
+                                &packed_y));
+    const Tb* y = in_y.flat<Tb>().data();
+    Tb* y_packed = packed_y.flat<Tb>().data();
+    Shard(worker_threads.num_threads, worker_threads.workers, in_y.dim_size(0),
+          padded_cols * padded_depth, [&](int64_t start, int64_t limit) {
+            for (int64_t b = start; b < limit; ++b) {
+              PackRhs(y + b * depth * cols, trans_y, depth, cols, padded_depth,
+                      padded_cols, y_packed + b * padded_cols * padded_depth);
+            }
+          });
+    if (cache != nullptr) cache->Insert(in_y, trans_y, packed_y);
+  }
+  const Tb* y_packed = packed_y.flat<Tb>().data();
+
+  // Each task computes a block of the result of a matrix of the batch.
+  const bool should_bcast = bcast.IsBroadcastingRequired();
+  const auto& x_batch_indices = bcast.x_batch_indices();
+  const auto& y_batch_indices = bcast.y_batch_indices();
+  const int64_t row_blocks = padded_rows / kBlockRows;
+  const int64_t col_blocks = padded_cols / kBlockCols;
+  const int64_t blocks_per_matrix = row_blocks * col_blocks;
+  // A tile dot product takes about as long as 256 multiply-adds of Eigen.
+  const int64_t cost_per_block = kBlockRows * kBlockCols * padded_depth / 256;
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        bcast.output_batch_size() * blocks_per_matrix, cost_per_block,
+        [&](int64_t start, int64_t limit) {
+          ConfigureAmxTiles();
+          alignas(64) Accumulator result[kBlockRows * kBlockCols];
+          for (int64_t task = start; task < limit; ++task) {
+            const int64_t i = task / blocks_per_matrix;
+            const int64_t block = task % blocks_per_matrix;
+            const int64_t r0 = block / col_blocks * kBlockRows;
+            const int64_t c0 = block % col_blocks * kBlockCols;
+            const int64_t x_batch_index = should_bcast ? x_batch_indices[i] : i;
+            const int64_t y_batch_index = should_bcast ? y_batch_indices[i] : i;
+            AmxMultiplyBlock<Ta, Tb>(
+                x_packed + (x_batch_index * padded_rows + r0) * padded_depth,
+                y_packed + (y_batch_index * padded_cols + c0) * padded_depth,
+                padded_depth, result);
+            const int64_t block_rows = std::min(kBlockRows, rows - r0);
+            const int64_t block_cols = std::min(kBlockCols, cols - c0);
+            for (int64_t r = 0; r < block_rows; ++r) {
+              Tout* z_row = z + (i * rows + r0 + r) * cols + c0;
+              for (int64_t c = 0; c < block_cols; ++c) {
+                z_row[c] = static_cast<Tout>(result[r * kBlockCols + c]);
+              }
+            }
+          }
+          ReleaseAmxTiles();
+        });
+}
+
+}  // namespace
+
+bool CanUseAmxBatchMatMul(DataType type_x, DataType type_y, DataType type_out,
+                          int64_t rows, int64_t depth, int64_t cols) {
+  const auto is_8bit = [](DataType type) {
+    return type == DT_INT8 || type == DT_UINT8;
+  };
+  port::CPUFeature feature;
+  if (type_x == DT_BFLOAT16 && type_y == DT_BFLOAT16 &&
+      type_out == DT_BFLOAT16) {
+    feature = port::CPUFeature::AMX_BF16;
+  } else if (is_8bit(type_x) && is_8bit(type_y) && type_out == DT_INT32) {
+    feature = port::CPUFeature::AMX_INT8;
+  } else {
+    return false;
+  }
+  if (rows < kTileRows || cols < kTileRows ||
+      depth * DataTypeSize(type_x) < kTileBytes) {
+    return false;
+  }
+  return HaveAmxTiles() && port::TestCPUFeature(feature);
+}
+
+void LaunchAmxBatchMatMul(OpKernelContext* context, const Tensor& in_x,
+                          const Tensor& in_y, bool trans_x, bool trans_y,
+                          const MatMulBCast& bcast, Tensor* out,
+                          AmxPackedOperandCache* cache) {
+  if (in_x.dtype() == DT_BFLOAT16) {
+    AmxBatchMatMul<bfloat16, bfloat16, bfloat16>(context, in_x, in_y, trans_x,
+                                                 trans_y, bcast, out, cache);
+  } else if (in_x.dtype() == DT_INT8 && in_y.dtype() == DT_INT8) {
+    AmxBatchMatMul<int8, int8, int32>(context, in_x, in_y, trans_x, trans_y,
+                                      bcast, out, cache);
+  } else if (in_x.dtype() == DT_INT8) {
+    AmxBatchMatMul<int8, uint8, int32>(context, in_x, in_y, trans_x, trans_y,
+                                       bcast, out, cache);
+  } else if (in_y.dtype() == DT_INT8) {
+    AmxBatchMatMul<uint8, int8, int32>(context, in_x, in_y, trans_x, trans_y,
+                                       bcast, out, cache);
+  } else {
+    AmxBatchMatMul<uint8, uint8, int32>(context, in_x, in_y, trans_x, trans_y,
+                                        bcast, out, cache);
+  }
+}
+
+#undef TF_AMX_TARGET
+
+#else  // TF_MATMUL_AMX_KERNELS
+
+bool CanUseAmxBatchMatMul(DataType type_x, DataType type_y, DataType type_out,
+                          int64_t rows, int64_t depth, int64_t cols) {
+  return false;
+}
+
+void LaunchAmxBatchMatMul(OpKernelContext* context, const Tensor& in_x,
+                          const Tensor& in_y, bool trans_x, bool trans_y,
+                          const MatMulBCast& bcast, Tensor* out,
+                          AmxPackedOperandCache* cache) {
+  context->SetStatus(
+      errors::Unimplemented("AMX kernels are not built for this platform"));
+}
+
+#endif  // TF_MATMUL_AMX_KERNELS
+
+}  // namespace tensorflow
@@ -0,0 +1,76 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_MATMUL_OP_AMX_H_
+#define TENSORFLOW_CORE_KERNELS_MATMUL_OP_AMX_H_
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/matmul_bcast.h"
+
+namespace tensorflow {
+
+// Caches the right operand of the matmuls of a kernel, as packed by
+// LaunchAmxBatchMatMul, while the operand is the same tensor buffer. This is
+// only valid if the buffer is not updated in place, i.e. if the weights are
+// frozen, which the TF_ASSUME_FROZEN_WEIGHTS environment variable declares.
+class AmxPackedOperandCache {
+ public:
+  // Returns true if TF_ASSUME_FROZEN_WEIGHTS is set.
+  static bool Enabled();
+
+  // Sets `packed` to the packing of `operand`, transposed if `trans`, and
+  // returns true if it is cached.
+  bool Lookup(const Tensor& operand, bool trans, Tensor* packed)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Caches `packed` as the packing of `operand`, transposed if `trans`. The
+  // cache holds a reference to `operand`, so that its buffer is not reused.
+  void Insert(const Tensor& operand, bool trans, const Tensor& packed)
+      TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  mutex mu_;
+  Tensor operand_ TF_GUARDED_BY(mu_);
+  bool trans_ TF_GUARDED_BY(mu_) = false;
+  Tensor packed_ TF_GUARDED_BY(mu_);
+};
+
+// Returns true if LaunchAmxBatchMatMul can multiply matrices of these types
+// and sizes: bfloat16 matrices into bfloat16, or int8 and uint8 matrices into
+// int32, on a CPU with AMX tiles enabled by the OS. Matrices smaller than a
+// tile are left to Eigen.
+bool CanUseAmxBatchMatMul(DataType type_x, DataType type_y, DataType type_out,
+                          int64_t rows, int64_t depth, int64_t cols);
+
+// Computes the batch matmul `out` = op(in_x) * op(in_y) with the AMX tiles of
+// the CPU, where op transposes the matrices of in_x if `trans_x`, and those of
+// in_y if `trans_y`. The inputs and `out` are 3-D, and the batches of the
+// inputs are broadcast as in `bcast`. Products are accumulated in float for
+// bfloat16, and in int32 for 8-bit integers.
+//
+// The operands are packed into the layouts of the tiles, in_y only once if
+// it is found in `cache`, which may be null.
+void LaunchAmxBatchMatMul(OpKernelContext* context, const Tensor& in_x,
+                          const Tensor& in_y, bool trans_x, bool trans_y,
+                          const MatMulBCast& bcast, Tensor* out,
+                          AmxPackedOperandCache* cache);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_MATMUL_OP_AMX_H_
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/matmul_op_amx.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
@@ -741,8 +742,15 @@ class BaseBatchMatMulOp : public OpKernel {
                 out_reshaped.CopyFrom(*out, TensorShape({batch_size, d0, d3})),
                 errors::Internal("Failed to reshape output from ",
                                  out->shape().DebugString()));
-    if (std::is_same_v<Device, CPUDevice> && std::is_same_v<Ta, bfloat16> &&
-        std::is_same_v<Tb, bfloat16>) {
+    if (std::is_same_v<Device, CPUDevice> &&
+        CanUseAmxBatchMatMul(DataTypeToEnum<Ta>::v(), DataTypeToEnum<Tb>::v(),
+                             DataTypeToEnum<Tout>::v(), d0, d1, d3)) {
+      LaunchAmxBatchMatMul(
+          ctx, in0_reshaped, in1_reshaped, adj_x_ || trans_x_,
+          adj_y_ || trans_y_, bcast, &out_reshaped,
+          AmxPackedOperandCache::Enabled() ? &amx_weight_cache_ : nullptr);
+    } else if (std::is_same_v<Device, CPUDevice> &&
+               std::is_same_v<Ta, bfloat16> && std::is_same_v<Tb, bfloat16>) {
       Tensor in0_reshaped_float, in1_reshaped_float, out_reshaped_float;
       OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, in0_reshaped.shape(),
                                              &in0_reshaped_float));
@@ -790,6 +798,9 @@ class BaseBatchMatMulOp : public OpKernel {
   bool trans_x_ = false;
   bool trans_y_ = false;
 
+  // The packed right operand of the AMX kernels, if the weights are frozen.
+  AmxPackedOperandCache amx_weight_cache_;
+
   // Cast `t` from `SrcT` to `DstT`.
   template <typename SrcT, typename DstT>
   Tensor CastTensor(const Tensor& t) {
@@ -1239,7 +1239,13 @@ class MklConvOp : public OpKernel {
                                         filter_tf_shape, &cached_filter_data_));
 
     *filter_tensor = &cached_filter_data_;
+    AllocateFilterMdTensor(context, conv_prim_desc);
+  }
 
+  // Allocate the tensor for cached filter memory descriptor (data format)
+  void AllocateFilterMdTensor(OpKernelContext* context,
+                              const ConvFwdPd& conv_prim_desc)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     // There is no tensor format in DNNL 1.x. So we cache the complete filter
     // descriptor as flat byte array.
     TensorShape cached_filter_md_shape;
@@ -1313,6 +1319,19 @@ class MklConvOp : public OpKernel {
       return;
     }
 
+    // Reuse the filter if another kernel, e.g. of another session, already
+    // converted the same constant.
+    MklWeightCache* weight_cache = MklWeightCache::Global();
+    string weight_key;
+    if (weight_cache != nullptr) {
+      weight_key = MklWeightCache::Key(filter_tensor, filter_md,
+                                       conv_fwd_pd->weights_desc());
+      if (weight_cache->Lookup(weight_key, &cached_filter_data_)) {
+        AllocateFilterMdTensor(context, *conv_fwd_pd);
+        return;
+      }
+    }
+
     // Otherwise, cache filter
     filter.SetUsrMem(filter_md, &filter_tensor);
     filter.CheckReorderToOpMem(conv_fwd_pd.get()->weights_desc(),
@@ -1325,6 +1344,9 @@ class MklConvOp : public OpKernel {
     void* cached_filter_data = filter.GetTensorBuffer(filter_tensor_ptr);
     size_t cached_filter_data_size = filter.GetOpMem().get_desc().get_size();
     memcpy(cached_filter_data, filter_data, cached_filter_data_size);
+    if (weight_cache != nullptr) {
+      weight_cache->Insert(weight_key, cached_filter_data_);
+    }
   }
 
   bool AreMemoryDescriptorsEqual(const memory::desc& filter_md,
@@ -504,22 +504,36 @@ class MklDnnMatMulOpBase : public OpKernel {
       return;
     }
 
-    // reorder and cache the weight
-    weight.SetUsrMem(weight_md, &weight_tensor);
-    weight.CheckReorderToOpMem(matmul_fwd_pd.get()->weights_desc(), cpu_engine_,
-                               context);
-    weight_data = static_cast<Tweight*>(weight.GetOpMem().get_data_handle());
-
-    size_t weight_size = matmul_fwd_pd.get()->weights_desc().get_size();
-    TensorShape weight_tf_shape;
-    weight_tf_shape.AddDim(weight_size / sizeof(Tweight));
-
-    OP_REQUIRES_OK(context,
-                   context->allocate_temp(DataTypeToEnum<Tweight>::value,
-                                          weight_tf_shape, &weight_oi_));
-
-    void* weight_oi_t_data = weight.GetTensorBuffer(&weight_oi_);
-    memcpy(weight_oi_t_data, weight_data, weight_size);
+    // Reuse the weight if another kernel, e.g. of another session, already
+    // reordered the same constant.
+    MklWeightCache* weight_cache = MklWeightCache::Global();
+    string weight_key;
+    if (weight_cache != nullptr) {
+      weight_key = MklWeightCache::Key(weight_tensor, weight_md,
+                                       matmul_fwd_pd->weights_desc());
+    }
+    if (weight_cache == nullptr ||
+        !weight_cache->Lookup(weight_key, &weight_oi_)) {
+      // reorder and cache the weight
+      weight.SetUsrMem(weight_md, &weight_tensor);
+      weight.CheckReorderToOpMem(matmul_fwd_pd.get()->weights_desc(),
+                                 cpu_engine_, context);
+      weight_data = static_cast<Tweight*>(weight.GetOpMem().get_data_handle());
+
+      size_t weight_size = matmul_fwd_pd.get()->weights_desc().get_size();
+      TensorShape weight_tf_shape;
+      weight_tf_shape.AddDim(weight_size / sizeof(Tweight));
+
+      OP_REQUIRES_OK(context,
+                     context->allocate_temp(DataTypeToEnum<Tweight>::value,
+                                            weight_tf_shape, &weight_oi_));
+
+      void* weight_oi_t_data = weight.GetTensorBuffer(&weight_oi_);
+      memcpy(weight_oi_t_data, weight_data, weight_size);
+      if (weight_cache != nullptr) {
+        weight_cache->Insert(weight_key, weight_oi_);
+      }
+    }
 
     // cache the memory descriptor
     auto expected_md = matmul_fwd_pd->weights_desc();
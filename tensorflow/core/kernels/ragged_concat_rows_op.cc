@@ -0,0 +1,151 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/util/work_sharder.h"
+#include "tensorflow/tsl/platform/errors.h"
+
+namespace tensorflow {
+
+using errors::InvalidArgument;
+
+// Concatenates the rows of a batch of ragged tensors with the same number of
+// rows, i.e. concatenates them along axis 1. Every output row is copied from
+// the values of the inputs, in parallel over the rows.
+template <typename T, typename SPLITS_TYPE>
+class RaggedConcatRowsOp : public OpKernel {
+ public:
+  using OpKernel::OpKernel;
+
+  void Compute(OpKernelContext* context) override {
+    OpInputList values_in;
+    OpInputList row_splits_in;
+    OP_REQUIRES_OK(context, context->input_list("rt_values", &values_in));
+    OP_REQUIRES_OK(context,
+                   context->input_list("rt_row_splits", &row_splits_in));
+    const int num_inputs = values_in.size();
+
+    // Checks the inputs, and computes the splits of the output.
+    OP_REQUIRES(context, values_in[0].dims() > 0,
+                InvalidArgument("rt_values[0] must have rank at least 1"));
+    TensorShape row_shape = values_in[0].shape();
+    row_shape.RemoveDim(0);
+    const int64_t row_size = row_shape.num_elements();
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(row_splits_in[0].shape()) &&
+                    row_splits_in[0].NumElements() > 0,
+                InvalidArgument("rt_row_splits[0] must be a non-empty vector"));
+    const int64_t num_rows = row_splits_in[0].NumElements() - 1;
+    std::vector<int64_t> output_splits(num_rows + 1, 0);
+    for (int i = 0; i < num_inputs; ++i) {
+      const Tensor& values = values_in[i];
+      OP_REQUIRES(context, values.dims() > 0,
+                  InvalidArgument("rt_values[", i,
+                                  "] must have rank at least 1"));
+      TensorShape values_row_shape = values.shape();
+      values_row_shape.RemoveDim(0);
+      OP_REQUIRES(context, values_row_shape == row_shape,
+                  InvalidArgument("The values of all the inputs must have the "
+                                  "same inner shape, got ",
+                                  row_shape.DebugString(), " and ",
+                                  values_row_shape.DebugString()));
+      OP_REQUIRES(context,
+                  TensorShapeUtils::IsVector(row_splits_in[i].shape()) &&
+                      row_splits_in[i].NumElements() == num_rows + 1,
+                  InvalidArgument("rt_row_splits[", i, "] must be a vector of ",
+                                  num_rows + 1, " splits, got shape ",
+                                  row_splits_in[i].shape().DebugString()));
+      const auto row_splits = row_splits_in[i].vec<SPLITS_TYPE>();
+      OP_REQUIRES(context,
+                  row_splits(0) == 0 &&
+                      row_splits(num_rows) == values.dim_size(0),
+                  InvalidArgument("rt_row_splits[", i,
+                                  "] must start with 0 and end with the "
+                                  "number of values ",
+                                  values.dim_size(0)));
+      for (int64_t r = 0; r < num_rows; ++r) {
+        const int64_t row_length = row_splits(r + 1) - row_splits(r);
+        OP_REQUIRES(context, row_length >= 0,
+                    InvalidArgument("rt_row_splits[", i, "] must be sorted"));
+        output_splits[r + 1] += row_length;
+      }
+    }
+    for (int64_t r = 0; r < num_rows; ++r) {
+      output_splits[r + 1] += output_splits[r];
+    }
+    OP_REQUIRES(
+        context,
+        output_splits[num_rows] <= std::numeric_limits<SPLITS_TYPE>::max(),
+        InvalidArgument("The number of output values overflows the row "
+                        "splits. Consider using int64 row splits."));
+
+    Tensor* output_splits_out;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(1, TensorShape({num_rows + 1}),
+                                            &output_splits_out));
+    std::copy(output_splits.begin(), output_splits.end(),
+              output_splits_out->vec<SPLITS_TYPE>().data());
+    TensorShape output_values_shape = row_shape;
+    output_values_shape.InsertDim(0, output_splits[num_rows]);
+    Tensor* output_values_out;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_values_shape,
+                                                     &output_values_out));
+
+    // Copies the values of every output row from the inputs.
+    T* output_values = output_values_out->flat<T>().data();
+    const int64_t cost_per_row =
+        (output_splits[num_rows] / std::max<int64_t>(num_rows, 1) + 1) *
+        row_size;
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          cost_per_row, [&](int64_t begin, int64_t end) {
+            for (int64_t r = begin; r < end; ++r) {
+              T* output = output_values + output_splits[r] * row_size;
+              for (int i = 0; i < num_inputs; ++i) {
+                const T* values = values_in[i].flat<T>().data();
+                const auto row_splits = row_splits_in[i].vec<SPLITS_TYPE>();
+                output = std::copy(values + row_splits(r) * row_size,
+                                   values + row_splits(r + 1) * row_size,
+                                   output);
+              }
+            }
+          });
+  }
+};
+
+#define REGISTER_CPU_KERNEL(TYPE)                                  \
+  REGISTER_KERNEL_BUILDER(Name("RaggedConcatRows")                 \
+                              .Device(DEVICE_CPU)                  \
+                              .TypeConstraint<TYPE>("T")           \
+                              .TypeConstraint<int32>("Tsplits"),   \
+                          RaggedConcatRowsOp<TYPE, int32>);        \
+  REGISTER_KERNEL_BUILDER(Name("RaggedConcatRows")                 \
+                              .Device(DEVICE_CPU)                  \
+                              .TypeConstraint<TYPE>("T")           \
+                              .TypeConstraint<int64_t>("Tsplits"), \
+                          RaggedConcatRowsOp<TYPE, int64_t>);
+TF_CALL_POD_STRING_TYPES(REGISTER_CPU_KERNEL);
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
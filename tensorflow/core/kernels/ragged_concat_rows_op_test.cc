@@ -0,0 +1,114 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <gtest/gtest.h>
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class RaggedConcatRowsOpTest : public ::tensorflow::OpsTestBase {
+ protected:
+  // Builds the tensorflow test graph for the RaggedConcatRows op.
+  template <typename T, typename SPLITS_TYPE>
+  void BuildConcatRowsGraph(int num_inputs) {
+    const auto& dtype = DataTypeToEnum<T>::v();
+    const auto& splits_dtype = DataTypeToEnum<SPLITS_TYPE>::v();
+    TF_ASSERT_OK(NodeDefBuilder("tested_op", "RaggedConcatRows")
+                     .Input(FakeInput(num_inputs, dtype))  // rt_values
+                     .Input(FakeInput(num_inputs, splits_dtype))  // splits
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(RaggedConcatRowsOpTest, ConcatRows) {
+  BuildConcatRowsGraph<int32, int64_t>(3);
+  // rt_values[0] = [[1, 2], [], [3]]
+  // rt_values[1] = [[], [4], [5, 6]]
+  // rt_values[2] = [[7], [8], []]
+  AddInputFromArray<int32>(TensorShape({3}), {1, 2, 3});
+  AddInputFromArray<int32>(TensorShape({3}), {4, 5, 6});
+  AddInputFromArray<int32>(TensorShape({2}), {7, 8});
+  AddInputFromArray<int64_t>(TensorShape({4}), {0, 2, 2, 3});
+  AddInputFromArray<int64_t>(TensorShape({4}), {0, 0, 1, 3});
+  AddInputFromArray<int64_t>(TensorShape({4}), {0, 1, 2, 2});
+  TF_ASSERT_OK(RunOpKernel());
+  // output = [[1, 2, 7], [4, 8], [3, 5, 6]]
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(0), test::AsTensor<int32>({1, 2, 7, 4, 8, 3, 5, 6}));
+  test::ExpectTensorEqual<int64_t>(*GetOutput(1),
+                                   test::AsTensor<int64_t>({0, 3, 5, 8}));
+}
+
+TEST_F(RaggedConcatRowsOpTest, ConcatRowsOfInnerDimensions) {
+  BuildConcatRowsGraph<tstring, int32>(2);
+  AddInputFromArray<tstring>(TensorShape({2, 2}), {"a", "b", "c", "d"});
+  AddInputFromArray<tstring>(TensorShape({1, 2}), {"e", "f"});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 1, 2});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 1, 1});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<tstring>(
+      *GetOutput(0),
+      test::AsTensor<tstring>({"a", "b", "e", "f", "c", "d"},
+                              TensorShape({3, 2})));
+  test::ExpectTensorEqual<int32>(*GetOutput(1),
+                                 test::AsTensor<int32>({0, 2, 3}));
+}
+
+TEST_F(RaggedConcatRowsOpTest, DifferentNumberOfRows) {
+  BuildConcatRowsGraph<float, int64_t>(2);
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2}), {3, 4});
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 1, 2});
+  AddInputFromArray<int64_t>(TensorShape({2}), {0, 2});
+  EXPECT_TRUE(absl::StrContains(RunOpKernel().error_message(),
+                                "rt_row_splits[1] must be a vector of 3"));
+}
+
+TEST_F(RaggedConcatRowsOpTest, RowSplitsDontMatchValues) {
+  BuildConcatRowsGraph<float, int64_t>(2);
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2}), {3, 4});
+  AddInputFromArray<int64_t>(TensorShape({2}), {0, 2});
+  AddInputFromArray<int64_t>(TensorShape({2}), {0, 3});
+  EXPECT_TRUE(absl::StrContains(RunOpKernel().error_message(),
+                                "rt_row_splits[1] must start with 0 and end "
+                                "with the number of values 2"));
+}
+
+TEST_F(RaggedConcatRowsOpTest, ShapeFn) {
+  ShapeInferenceTestOp op("RaggedConcatRows");
+  TF_ASSERT_OK(NodeDefBuilder("test", "RaggedConcatRows")
+                   .Input(FakeInput(2, DT_FLOAT))
+                   .Input(FakeInput(2, DT_INT64))
+                   .Finalize(&op.node_def));
+  INFER_OK(op, "[?,3];[5,?];[?];[?]", "[?,d0_1];[?]");
+  INFER_OK(op, "[?];[?];[4];[?]", "[?];[d2_0]");
+  INFER_ERROR("Shape must be at least rank 1", op, "[];[?];[?];[?]");
+  INFER_ERROR("Dimensions must be equal", op, "[?,3];[?,4];[?];[?]");
+}
+
+}  // namespace
+}  // namespace tensorflow
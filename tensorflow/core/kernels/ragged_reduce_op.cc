@@ -0,0 +1,285 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Reductions of the rows of ragged tensors, computed directly from their
+// values and row_splits, without converting them to padded tensors or to
+// segment ids first.
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
+#include "tensorflow/tsl/platform/errors.h"
+
+namespace tensorflow {
+
+using errors::InvalidArgument;
+
+namespace {
+
+enum class Reduction { kSum, kProd, kMin, kMax, kMean };
+
+Status ParseReduction(const string& name, Reduction* reduction) {
+  if (name == "sum") {
+    *reduction = Reduction::kSum;
+  } else if (name == "prod") {
+    *reduction = Reduction::kProd;
+  } else if (name == "min") {
+    *reduction = Reduction::kMin;
+  } else if (name == "max") {
+    *reduction = Reduction::kMax;
+  } else if (name == "mean") {
+    *reduction = Reduction::kMean;
+  } else {
+    return InvalidArgument("Unknown reduction: ", name);
+  }
+  return OkStatus();
+}
+
+// Checks that `row_splits_in` are the row splits of `num_values` values.
+template <typename SPLITS_TYPE>
+Status ValidateRowSplits(const Tensor& row_splits_in, int64_t num_values) {
+  if (!TensorShapeUtils::IsVector(row_splits_in.shape()) ||
+      row_splits_in.NumElements() == 0) {
+    return InvalidArgument("row_splits must be a non-empty vector, got shape ",
+                           row_splits_in.shape().DebugString());
+  }
+  const auto row_splits = row_splits_in.vec<SPLITS_TYPE>();
+  if (row_splits(0) != 0) {
+    return InvalidArgument("row_splits must start with 0, got ",
+                           row_splits(0));
+  }
+  for (int64_t i = 1; i < row_splits.size(); ++i) {
+    if (row_splits(i) < row_splits(i - 1)) {
+      return InvalidArgument("row_splits must be sorted, got row_splits[", i,
+                             "] = ", row_splits(i), " < row_splits[", i - 1,
+                             "] = ", row_splits(i - 1));
+    }
+  }
+  if (row_splits(row_splits.size() - 1) != num_values) {
+    return InvalidArgument("row_splits must end with the number of values ",
+                           num_values, ", got ",
+                           row_splits(row_splits.size() - 1));
+  }
+  return OkStatus();
+}
+
+// Reduces the rows [begin, end) of a ragged tensor into `output`. The values
+// of row r are the rows value_row(j) of `data` for j in
+// [row_splits(r), row_splits(r + 1)), and every row of `data` and `output`
+// has `row_size` elements. Empty rows are set to the identity of the
+// reduction, or to zero for the mean.
+template <typename T, typename SPLITS_TYPE, typename ValueRow>
+void ReduceRows(Reduction reduction,
+                typename TTypes<SPLITS_TYPE>::ConstVec row_splits,
+                const T* data, int64_t row_size, ValueRow value_row,
+                int64_t begin, int64_t end, T* output) {
+  using ConstRow = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+  using Row = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+  for (int64_t r = begin; r < end; ++r) {
+    Row out(output + r * row_size, row_size);
+    switch (reduction) {
+      case Reduction::kSum:
+      case Reduction::kMean:
+        out.setZero();
+        break;
+      case Reduction::kProd:
+        out.setOnes();
+        break;
+      case Reduction::kMin:
+        out.setConstant(Eigen::NumTraits<T>::highest());
+        break;
+      case Reduction::kMax:
+        out.setConstant(Eigen::NumTraits<T>::lowest());
+        break;
+    }
+    const int64_t start = row_splits(r);
+    const int64_t limit = row_splits(r + 1);
+    for (int64_t j = start; j < limit; ++j) {
+      const ConstRow in(data + value_row(j) * row_size, row_size);
+      switch (reduction) {
+        case Reduction::kSum:
+        case Reduction::kMean:
+          out += in;
+          break;
+        case Reduction::kProd:
+          out *= in;
+          break;
+        case Reduction::kMin:
+          out = out.min(in);
+          break;
+        case Reduction::kMax:
+          out = out.max(in);
+          break;
+      }
+    }
+    if (reduction == Reduction::kMean && limit > start) {
+      out /= static_cast<T>(limit - start);
+    }
+  }
+}
+
+// Reduces all the rows of a ragged tensor, sharding them over the intra-op
+// threads. See ReduceRows.
+template <typename T, typename SPLITS_TYPE, typename ValueRow>
+void ReduceRowsInParallel(OpKernelContext* context, Reduction reduction,
+                          typename TTypes<SPLITS_TYPE>::ConstVec row_splits,
+                          const T* data, int64_t row_size, ValueRow value_row,
+                          T* output) {
+  const int64_t num_rows = row_splits.size() - 1;
+  const int64_t num_values = row_splits(num_rows);
+  const int64_t cost_per_row =
+      (num_values / std::max<int64_t>(num_rows, 1) + 1) * row_size;
+  const auto& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+        cost_per_row, [&](int64_t begin, int64_t end) {
+          ReduceRows<T, SPLITS_TYPE>(reduction, row_splits, data, row_size,
+                                     value_row, begin, end, output);
+        });
+}
+
+// Allocates the output of `num_rows` rows shaped as the rows of `data_in`.
+Status AllocateReducedOutput(OpKernelContext* context, const Tensor& data_in,
+                             int64_t num_rows, Tensor** output) {
+  TensorShape output_shape = data_in.shape();
+  output_shape.set_dim(0, num_rows);
+  return context->allocate_output(0, output_shape, output);
+}
+
+int64_t RowSize(const Tensor& data_in) {
+  TensorShape row_shape = data_in.shape();
+  row_shape.RemoveDim(0);
+  return row_shape.num_elements();
+}
+
+}  // namespace
+
+template <typename T, typename SPLITS_TYPE>
+class RaggedReduceOp : public OpKernel {
+ public:
+  explicit RaggedReduceOp(OpKernelConstruction* context) : OpKernel(context) {
+    string reduction;
+    OP_REQUIRES_OK(context, context->GetAttr("reduction", &reduction));
+    OP_REQUIRES_OK(context, ParseReduction(reduction, &reduction_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& values_in = context->input(0);
+    const Tensor& row_splits_in = context->input(1);
+    OP_REQUIRES(context, values_in.dims() > 0,
+                InvalidArgument("values must have rank at least 1"));
+    OP_REQUIRES_OK(context, ValidateRowSplits<SPLITS_TYPE>(
+                                row_splits_in, values_in.dim_size(0)));
+    const auto row_splits = row_splits_in.vec<SPLITS_TYPE>();
+
+    Tensor* output;
+    OP_REQUIRES_OK(context, AllocateReducedOutput(context, values_in,
+                                                  row_splits.size() - 1,
+                                                  &output));
+    ReduceRowsInParallel<T, SPLITS_TYPE>(
+        context, reduction_, row_splits, values_in.flat<T>().data(),
+        RowSize(values_in), [](int64_t j) { return j; },
+        output->flat<T>().data());
+  }
+
+ private:
+  Reduction reduction_;
+};
+
+template <typename T, typename INDEX_TYPE, typename SPLITS_TYPE>
+class RaggedGatherReduceOp : public OpKernel {
+ public:
+  explicit RaggedGatherReduceOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    string reduction;
+    OP_REQUIRES_OK(context, context->GetAttr("reduction", &reduction));
+    OP_REQUIRES_OK(context, ParseReduction(reduction, &reduction_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& params_in = context->input(0);
+    const Tensor& indices_in = context->input(1);
+    const Tensor& row_splits_in = context->input(2);
+    OP_REQUIRES(context, params_in.dims() > 0,
+                InvalidArgument("params must have rank at least 1"));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(indices_in.shape()),
+                InvalidArgument("indices must be a vector, got shape ",
+                                indices_in.shape().DebugString()));
+    OP_REQUIRES_OK(context, ValidateRowSplits<SPLITS_TYPE>(
+                                row_splits_in, indices_in.NumElements()));
+    const int64_t num_params = params_in.dim_size(0);
+    const auto indices = indices_in.vec<INDEX_TYPE>();
+    for (int64_t i = 0; i < indices.size(); ++i) {
+      const INDEX_TYPE index = indices(i);
+      OP_REQUIRES(context, index >= 0 && index < num_params,
+                  InvalidArgument("indices",
+                                  SliceDebugString(indices_in.shape(), i),
+                                  " = ", index, " is not in [0, ", num_params,
+                                  ")"));
+    }
+    const auto row_splits = row_splits_in.vec<SPLITS_TYPE>();
+
+    Tensor* output;
+    OP_REQUIRES_OK(context, AllocateReducedOutput(context, params_in,
+                                                  row_splits.size() - 1,
+                                                  &output));
+    ReduceRowsInParallel<T, SPLITS_TYPE>(
+        context, reduction_, row_splits, params_in.flat<T>().data(),
+        RowSize(params_in),
+        [&indices](int64_t j) { return static_cast<int64_t>(indices(j)); },
+        output->flat<T>().data());
+  }
+
+ private:
+  Reduction reduction_;
+};
+
+#define REGISTER_CPU_KERNELS_WITH_SPLITS(TYPE, SPLITS_TYPE)                \
+  REGISTER_KERNEL_BUILDER(Name("RaggedReduce")                             \
+                              .Device(DEVICE_CPU)                          \
+                              .TypeConstraint<TYPE>("T")                   \
+                              .TypeConstraint<SPLITS_TYPE>("Tsplits"),     \
+                          RaggedReduceOp<TYPE, SPLITS_TYPE>);              \
+  REGISTER_KERNEL_BUILDER(Name("RaggedGatherReduce")                       \
+                              .Device(DEVICE_CPU)                          \
+                              .TypeConstraint<TYPE>("T")                   \
+                              .TypeConstraint<int32>("Tindices")           \
+                              .TypeConstraint<SPLITS_TYPE>("Tsplits"),     \
+                          RaggedGatherReduceOp<TYPE, int32, SPLITS_TYPE>); \
+  REGISTER_KERNEL_BUILDER(Name("RaggedGatherReduce")                       \
+                              .Device(DEVICE_CPU)                          \
+                              .TypeConstraint<TYPE>("T")                   \
+                              .TypeConstraint<int64_t>("Tindices")         \
+                              .TypeConstraint<SPLITS_TYPE>("Tsplits"),     \
+                          RaggedGatherReduceOp<TYPE, int64_t, SPLITS_TYPE>);
+#define REGISTER_CPU_KERNELS(TYPE)               \
+  REGISTER_CPU_KERNELS_WITH_SPLITS(TYPE, int32); \
+  REGISTER_CPU_KERNELS_WITH_SPLITS(TYPE, int64_t);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+TF_CALL_int32(REGISTER_CPU_KERNELS);
+TF_CALL_int64(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_CPU_KERNELS_WITH_SPLITS
+
+}  // namespace tensorflow
@@ -0,0 +1,155 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <limits>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class RaggedReduceOpTest : public ::tensorflow::OpsTestBase {
+ protected:
+  // Builds the tensorflow test graph for the RaggedReduce op.
+  template <typename T>
+  void BuildRaggedReduceGraph(const string& reduction) {
+    const auto& dtype = DataTypeToEnum<T>::v();
+    TF_ASSERT_OK(NodeDefBuilder("tested_op", "RaggedReduce")
+                     .Input(FakeInput(dtype))     // values
+                     .Input(FakeInput(DT_INT64))  // row_splits
+                     .Attr("reduction", reduction)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Builds the tensorflow test graph for the RaggedGatherReduce op.
+  template <typename T>
+  void BuildRaggedGatherReduceGraph(const string& reduction) {
+    const auto& dtype = DataTypeToEnum<T>::v();
+    TF_ASSERT_OK(NodeDefBuilder("tested_op", "RaggedGatherReduce")
+                     .Input(FakeInput(dtype))     // params
+                     .Input(FakeInput(DT_INT32))  // indices
+                     .Input(FakeInput(DT_INT64))  // row_splits
+                     .Attr("reduction", reduction)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(RaggedReduceOpTest, Sum) {
+  BuildRaggedReduceGraph<float>("sum");
+  // values = [[1, 2, 3], [], [4, 5], [6]]
+  AddInputFromArray<float>(TensorShape({6}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int64_t>(TensorShape({5}), {0, 3, 3, 5, 6});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(*GetOutput(0),
+                                 test::AsTensor<float>({6, 0, 9, 6}));
+}
+
+TEST_F(RaggedReduceOpTest, MeanOfInnerDimensions) {
+  BuildRaggedReduceGraph<float>("mean");
+  // values = [[[1, 2], [3, 4]], [], [[5, 6]]]
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int64_t>(TensorShape({4}), {0, 2, 2, 3});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({2, 3, 0, 0, 5, 6}, TensorShape({3, 2})));
+}
+
+TEST_F(RaggedReduceOpTest, MinAndMaxOfEmptyRows) {
+  BuildRaggedReduceGraph<int32>("min");
+  AddInputFromArray<int32>(TensorShape({3}), {3, 1, 2});
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 3, 3});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(0),
+      test::AsTensor<int32>({1, std::numeric_limits<int32>::max()}));
+}
+
+TEST_F(RaggedReduceOpTest, InvalidRowSplits) {
+  BuildRaggedReduceGraph<float>("sum");
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 2, 1});
+  EXPECT_TRUE(absl::StrContains(RunOpKernel().error_message(),
+                                "row_splits must be sorted"));
+}
+
+TEST_F(RaggedReduceOpTest, RowSplitsDontMatchValues) {
+  BuildRaggedReduceGraph<float>("sum");
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 2, 4});
+  EXPECT_TRUE(absl::StrContains(
+      RunOpKernel().error_message(),
+      "row_splits must end with the number of values 3, got 4"));
+}
+
+TEST_F(RaggedReduceOpTest, GatherSum) {
+  BuildRaggedGatherReduceGraph<float>("sum");
+  // params = [[1, 2], [3, 4], [5, 6]]
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  // indices = [[2, 0, 2], [], [1]]
+  AddInputFromArray<int32>(TensorShape({4}), {2, 0, 2, 1});
+  AddInputFromArray<int64_t>(TensorShape({4}), {0, 3, 3, 4});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({11, 14, 0, 0, 3, 4}, TensorShape({3, 2})));
+}
+
+TEST_F(RaggedReduceOpTest, GatherMax) {
+  BuildRaggedGatherReduceGraph<int64_t>("max");
+  AddInputFromArray<int64_t>(TensorShape({3}), {7, -2, 5});
+  AddInputFromArray<int32>(TensorShape({3}), {1, 2, 1});
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 1, 3});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int64_t>(*GetOutput(0),
+                                   test::AsTensor<int64_t>({-2, 5}));
+}
+
+TEST_F(RaggedReduceOpTest, GatherIndexOutOfBounds) {
+  BuildRaggedGatherReduceGraph<float>("sum");
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 2});
+  AddInputFromArray<int64_t>(TensorShape({2}), {0, 2});
+  EXPECT_TRUE(absl::StrContains(RunOpKernel().error_message(),
+                                "indices[1] = 2 is not in [0, 2)"));
+}
+
+TEST_F(RaggedReduceOpTest, ShapeFn) {
+  ShapeInferenceTestOp op("RaggedReduce");
+  INFER_OK(op, "[?,2,3];[5]", "[4,d0_1,d0_2]");
+  INFER_OK(op, "[?];[?]", "[?]");
+  INFER_ERROR("Shape must be at least rank 1", op, "[];[5]");
+  INFER_ERROR("Shape must be rank 1", op, "[?];[5,1]");
+
+  ShapeInferenceTestOp gather_op("RaggedGatherReduce");
+  INFER_OK(gather_op, "[10,3];[?];[5]", "[4,d0_1]");
+  INFER_ERROR("Shape must be rank 1", gather_op, "[10,3];[2,2];[5]");
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/guarded_philox_random.h"
 #include "tensorflow/core/util/work_sharder.h"
+#include "tensorflow/tsl/lib/random/philox_random_batch.h"
 
 #if EIGEN_COMP_GNUC && __cplusplus > 199711L
 #define DISABLE_FLOAT_EQUALITY_WARNING \
@@ -86,12 +87,14 @@ struct FillPhiloxRandomTask<Distribution, false> {
     const int kGroupSize = Distribution::kResultElementCount;
 
     gen.Skip(start_group);
+    // Computes the same samples as `gen`, many at a time.
+    tsl::random::PhiloxRandomBatch batch_gen(gen);
     int64_t offset = start_group * kGroupSize;
 
     // First fill all the full-size groups
     int64_t limit_group_full = std::min(limit_group, size / kGroupSize);
     for (int64_t index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
+      auto samples = dist(&batch_gen);
       std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
       offset += kGroupSize;
     }
@@ -99,7 +102,7 @@ struct FillPhiloxRandomTask<Distribution, false> {
     // If there are any remaining elements that need to be filled, process them
     if (limit_group_full < limit_group) {
       int64_t remaining_size = size - limit_group_full * kGroupSize;
-      auto samples = dist(&gen);
+      auto samples = dist(&batch_gen);
       std::copy(&samples[0], &samples[0] + remaining_size, data + offset);
     }
   }
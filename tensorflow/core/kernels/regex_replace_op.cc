@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/ptr_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -49,17 +50,25 @@ Status InternalCompute(const RE2& regex, const string& rewrite,
     output_tensor->flat<tstring>() = input_tensor->flat<tstring>();
   }
   auto output_flat = output_tensor->flat<tstring>();
-  for (size_t i = 0; i < output_flat.size(); ++i) {
-    // TODO(dero): Mitigate copy; Global and GlobalReplace below currently only
-    // accept std::string.
-    string buf = output_flat(i);
-    if (replace_global) {
-      RE2::GlobalReplace(&buf, regex, rewrite);
-    } else {
-      RE2::Replace(&buf, regex, rewrite);
+  // RE2 objects are safe to use from several threads at once.
+  auto replace_range = [&](int64_t start, int64_t limit) {
+    for (int64_t i = start; i < limit; ++i) {
+      // TODO(dero): Mitigate copy; Global and GlobalReplace below currently
+      // only accept std::string.
+      string buf = output_flat(i);
+      if (replace_global) {
+        RE2::GlobalReplace(&buf, regex, rewrite);
+      } else {
+        RE2::Replace(&buf, regex, rewrite);
+      }
+      output_flat(i) = std::move(buf);
     }
-    output_flat(i) = std::move(buf);
-  }
+  };
+  // The cost of matching a string of a few dozen bytes.
+  constexpr int64_t kCostPerString = 1000;
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        output_flat.size(), kCostPerString, replace_range);
   return OkStatus();
 }
 }  // namespace
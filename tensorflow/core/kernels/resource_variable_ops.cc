@@ -69,6 +69,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/dense_update_functor.h"
 #include "tensorflow/core/kernels/gather_functor.h"
 #include "tensorflow/core/kernels/gather_nd_op.h"
+#include "tensorflow/core/kernels/hot_row_cache.h"
 #include "tensorflow/core/kernels/resource_variable_ops.h"
 #include "tensorflow/core/kernels/resource_variable_util.h"
 #include "tensorflow/core/kernels/scatter_functor.h"
@@ -675,6 +676,10 @@ class ResourceGatherOp : public OpKernel {
  public:
   explicit ResourceGatherOp(OpKernelConstruction* c) : OpKernel(c) {
     OP_REQUIRES_OK(c, c->GetAttr("batch_dims", &batch_dims_));
+    // Set on embedding lookups of serving graphs with skewed ids.
+    if (!c->GetAttr(kHotRowCacheRowsAttr, &hot_row_cache_rows_).ok()) {
+      hot_row_cache_rows_ = 0;
+    }
   }
 
   void Compute(OpKernelContext* c) override {
@@ -730,6 +735,13 @@ class ResourceGatherOp : public OpKernel {
       OP_REQUIRES_OK(c, c->allocate_output(0, result_shape, &out));
     }
 
+    if (N > 0 && hot_row_cache_rows_ > 0 && batch_dims_ == 0 &&
+        std::is_same<Device, CPUDevice>::value &&
+        DataTypeCanUseMemcpy(params.dtype())) {
+      GatherWithHotRowCache(c, params, indices, out);
+      return;
+    }
+
     if (N > 0) {
       Tensor tmp_indices;
 
@@ -771,6 +783,32 @@ class ResourceGatherOp : public OpKernel {
   }
 
  private:
+  // Gathers through the HotRowCache of the variable, which is kept in the
+  // resource manager next to it.
+  void GatherWithHotRowCache(OpKernelContext* c, const Tensor& params,
+                             const Tensor& indices, Tensor* out) {
+    const ResourceHandle& handle = HandleFromInput(c, 0);
+    HotRowCache* cache;
+    OP_REQUIRES_OK(c, c->resource_manager()->LookupOrCreate<HotRowCache>(
+                          handle.container(), handle.name(), &cache,
+                          [this](HotRowCache** cache) {
+                            *cache = new HotRowCache(hot_row_cache_rows_);
+                            return OkStatus();
+                          }));
+    core::ScopedUnref unref(cache);
+
+    const auto indices_flat = indices.flat<Index>();
+    const int64_t bad_i = cache->Gather(
+        params, indices_flat.data(), indices_flat.size(),
+        reinterpret_cast<char*>(out->flat<T>().data()),
+        c->device()->tensorflow_cpu_worker_threads()->workers);
+    OP_REQUIRES(
+        c, bad_i < 0,
+        errors::InvalidArgument(
+            "indices", SliceDebugString(indices.shape(), bad_i), " = ",
+            indices_flat(bad_i), " is not in [0, ", params.dim_size(0), ")"));
+  }
+
   // Add the batch offset derived from params to each batch of indices.
   // Example: batch_dims = 1, indices = [[0, 1, 2], [0, 1, 2]]
   // If indexing into a params dimension of size 4, then the indices will become
@@ -799,6 +837,7 @@ class ResourceGatherOp : public OpKernel {
   }
 
   int32 batch_dims_ = 0;
+  int64_t hot_row_cache_rows_ = 0;
 };
 
 #define REGISTER_GATHER_FULL(dev, type, index_type)                    \
@@ -31,9 +31,11 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace {
@@ -356,5 +358,49 @@ TEST_F(RestoreV2OpTest, RestoreAfterSaveV2) { RunTest("SaveV2"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveSlicesV1) { RunTest("SaveSlices"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveV1) { RunTest("Save"); }
 
+// Restores enough tensors below the thread-pool threshold that they are read
+// in several runs, from different threads.
+TEST_F(RestoreV2OpTest, RestoreManyTensors) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "many_tensors");
+  constexpr int kNumTensors = 8;
+  constexpr int kNumElements = 3 << 20;
+  std::vector<string> tensor_names;
+  {
+    BundleWriter writer(Env::Default(), prefix);
+    for (int i = 0; i < kNumTensors; ++i) {
+      tensor_names.push_back(strings::StrCat("tensor_", i));
+      Tensor tensor = MakeInput<float>(TensorShape({kNumElements}),
+                                       [i](int x) -> float { return x + i; });
+      TF_ASSERT_OK(writer.Add(tensor_names.back(), tensor));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  TF_ASSERT_OK(NodeDefBuilder("myop", "RestoreV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Attr("dtypes", DataTypeVector(kNumTensors, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<tstring>(TensorShape({}), {prefix});
+  AddInput<tstring>(TensorShape({kNumTensors}),
+                    [&tensor_names](int x) -> tstring {
+                      return tensor_names[x];
+                    });
+  AddInput<tstring>(TensorShape({kNumTensors}),
+                    [](int x) -> tstring { return ""; });
+  TF_ASSERT_OK(RunOpKernel());
+
+  for (int i = 0; i < kNumTensors; ++i) {
+    Tensor* output = GetOutput(i);
+    ASSERT_EQ(output->NumElements(), kNumElements);
+    const auto output_flat = output->flat<float>();
+    for (int x = 0; x < kNumElements; x += 4097) {
+      ASSERT_EQ(output_flat(x), x + i);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <numeric>
 #include <unordered_map>
@@ -31,7 +33,10 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
@@ -250,6 +255,15 @@ namespace {
 // Tensors larger than this threshold will be restored from a thread-pool.
 const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 
+// Smaller tensors are restored in runs of consecutive tensors (in file order)
+// of about this many bytes. The first run is restored from the op thread and
+// the others from the thread-pool, each with its own BundleReader, so that the
+// reads of different parts of a large checkpoint overlap.
+const int64_t kRestoreRunBytes = 64 << 20;  // 64MB
+
+// The number of threads of the thread-pool.
+const int kRestoreThreads = 8;
+
 // A restore operation for a single tensor.  Small tensors may be restored
 // directly from the op thread to improve read locality.  Large tensors can be
 // restored from a thread pool: this requires creating a separate BundleReader
@@ -257,13 +271,15 @@ const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 struct RestoreOp {
   RestoreOp(OpKernelContext* context, int idx, const string& tensor_name,
             const string& shape_and_slice, const string& reader_prefix,
-            DataType dtype)
+            DataType dtype, bool map_tensor, bool share_tensor)
       : context(context),
         idx(idx),
         tensor_name(tensor_name),
         shape_and_slice(shape_and_slice),
         reader_prefix(reader_prefix),
-        dtype(dtype) {}
+        dtype(dtype),
+        map_tensor(map_tensor),
+        share_tensor(share_tensor) {}
 
   // Move-only. It does not make sense to "run()" a copied RestoreOp.
   RestoreOp(const RestoreOp&) = delete;
@@ -282,6 +298,19 @@ struct RestoreOp {
     return restored_full_shape.num_elements() > kLargeShapeThreshold;
   }
 
+  // Returns an estimate of the number of bytes read by this restore.
+  int64_t estimated_bytes(BundleReader* reader) const {
+    TensorShape restored_full_shape;
+
+    // Ignore status here; we'll catch the error later.
+    if (!reader->LookupTensorShape(tensor_name, &restored_full_shape).ok()) {
+      return 0;
+    }
+
+    return restored_full_shape.num_elements() *
+           std::max(DataTypeSize(dtype), 1);
+  }
+
   // Run this restore operation using a new BundleReader.
   void run_with_new_reader() {
     BundleReader reader(Env::Default(), reader_prefix);
@@ -301,7 +330,19 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && map_tensor) {
+      // Lookup the full tensor, mapping its bytes if possible.
+      Tensor mapped_tensor;
+      TF_RETURN_IF_ERROR(reader->LookupMapped(tensor_name, &mapped_tensor));
+      context->set_output(idx, mapped_tensor);
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty() && share_tensor) {
+      // Lookup the full tensor, sharing it with identical restored tensors.
+      Tensor shared_tensor;
+      TF_RETURN_IF_ERROR(reader->LookupShared(tensor_name, &shared_tensor));
+      context->set_output(idx, shared_tensor);
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -355,17 +396,105 @@ struct RestoreOp {
   string shape_and_slice;
   string reader_prefix;
   DataType dtype;
+  bool map_tensor;
+  bool share_tensor;
 
   ::tensorflow::Status status;
 };
 
+// Runs `restore_ops`, in order, using a new BundleReader.
+Status RunWithNewReader(const string& reader_prefix,
+                        const std::vector<RestoreOp*>& restore_ops) {
+  BundleReader reader(Env::Default(), reader_prefix);
+  TF_RETURN_IF_ERROR(reader.status());
+  for (RestoreOp* op : restore_ops) {
+    TF_RETURN_IF_ERROR(op->run(&reader));
+  }
+  return OkStatus();
+}
+
+// The number of threads that write the checkpoints scheduled by ScheduleSave.
+const int kSaveThreads = 8;
+
+// The checkpoints written in the background by ScheduleSave.
+class PendingSaves {
+ public:
+  static PendingSaves* Global() {
+    static PendingSaves* pending_saves = new PendingSaves;
+    return pending_saves;
+  }
+
+  void Schedule(const string& prefix, std::function<Status()> save) {
+    auto pending = std::make_shared<Pending>();
+    {
+      mutex_lock l(mu_);
+      saves_.emplace(prefix, pending);
+    }
+    workers_.Schedule([this, prefix, pending, save = std::move(save)]() {
+      const Status status = save();
+      if (!status.ok()) {
+        LOG(ERROR) << "Failed to save checkpoint " << prefix << ": " << status;
+      }
+      mutex_lock l(mu_);
+      pending->done = true;
+      pending->status = status;
+      // Failures are kept until they are reported by Wait().
+      if (status.ok()) {
+        auto range = saves_.equal_range(prefix);
+        for (auto it = range.first; it != range.second; ++it) {
+          if (it->second == pending) {
+            saves_.erase(it);
+            break;
+          }
+        }
+      }
+      done_.notify_all();
+    });
+  }
+
+  Status Wait(const string& prefix) {
+    mutex_lock l(mu_);
+    auto all_done = [this, &prefix]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      auto range = saves_.equal_range(prefix);
+      return std::all_of(range.first, range.second, [](const auto& save) {
+        return save.second->done;
+      });
+    };
+    while (!all_done()) done_.wait(l);
+    Status status;
+    auto range = saves_.equal_range(prefix);
+    for (auto it = range.first; it != range.second; ++it) {
+      status.Update(it->second->status);
+    }
+    saves_.erase(prefix);
+    return status;
+  }
+
+ private:
+  struct Pending {
+    bool done = false;
+    Status status;
+  };
+
+  PendingSaves()
+      : workers_(Env::Default(), "save_checkpoint", kSaveThreads) {}
+
+  mutex mu_;
+  condition_variable done_;
+  std::unordered_multimap<string, std::shared_ptr<Pending>> saves_
+      TF_GUARDED_BY(mu_);
+  thread::ThreadPool workers_;
+};
+
 }  // namespace
 
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes) {
+                        gtl::ArraySlice<DataType> dtypes, bool map_tensors,
+                        bool share_tensors) {
   const string& prefix_string = prefix.scalar<tstring>()();
+  TF_RETURN_IF_ERROR(WaitForPendingSaves(prefix_string));
 
   const auto& tensor_names_flat = tensor_names.flat<tstring>();
   const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
@@ -374,7 +503,8 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   restore_ops.reserve(tensor_names_flat.size());
   for (int i = 0; i < tensor_names_flat.size(); ++i) {
     restore_ops.push_back({context, i, tensor_names_flat(i),
-                           shape_and_slices_flat(i), prefix_string, dtypes[i]});
+                           shape_and_slices_flat(i), prefix_string, dtypes[i],
+                           map_tensors, share_tensors});
   }
 
   BundleReader default_reader(Env::Default(), prefix_string);
@@ -402,35 +532,60 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     return errors::InvalidArgument(error_msg);
   }
 
+  // `restore_ops` is sorted by file offset, so each run of direct restores
+  // reads a contiguous part of a data file. Mapping a tensor reads none of its
+  // bytes, so when mapping all restores share the default reader and its
+  // mappings; the few tensors that can't be mapped are read serially.
   std::vector<RestoreOp*> pool_restore_ops;
-  std::vector<RestoreOp*> direct_restore_ops;
+  std::vector<std::vector<RestoreOp*>> direct_restore_runs(1);
+  int64_t run_bytes = 0;
   for (RestoreOp& restore_op : restore_ops) {
+    if (map_tensors) {
+      direct_restore_runs.back().push_back(&restore_op);
+      continue;
+    }
     if (restore_op.should_run_in_pool(&default_reader)) {
       pool_restore_ops.push_back(&restore_op);
-    } else {
-      direct_restore_ops.push_back(&restore_op);
+      continue;
+    }
+    if (run_bytes >= kRestoreRunBytes) {
+      direct_restore_runs.emplace_back();
+      run_bytes = 0;
     }
+    direct_restore_runs.back().push_back(&restore_op);
+    run_bytes += restore_op.estimated_bytes(&default_reader);
   }
+  std::vector<Status> run_statuses(direct_restore_runs.size());
 
   {
     // Schedule any threaded operations first, skipping thread pool creation if
     // we don't have any expensive operations.
     std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!pool_restore_ops.empty()) {
-      reader_pool.reset(
-          new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
+    if (!pool_restore_ops.empty() || direct_restore_runs.size() > 1) {
+      reader_pool.reset(new thread::ThreadPool(
+          Env::Default(), "restore_tensors", kRestoreThreads));
       for (auto* op : pool_restore_ops) {
         reader_pool->Schedule([op]() { op->run_with_new_reader(); });
       }
+      for (size_t i = 1; i < direct_restore_runs.size(); ++i) {
+        reader_pool->Schedule(
+            [&prefix_string, &direct_restore_runs, &run_statuses, i]() {
+              run_statuses[i] =
+                  RunWithNewReader(prefix_string, direct_restore_runs[i]);
+            });
+      }
     }
 
-    // Read small tensors from the op thread
-    for (auto* op : direct_restore_ops) {
+    // Read the first run of small tensors from the op thread
+    for (auto* op : direct_restore_runs[0]) {
       TF_RETURN_IF_ERROR(op->run(&default_reader));
     }
   }
 
   // Check status of pool ops; this must come after the pool shuts down.
+  for (const Status& status : run_statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
   for (auto* op : pool_restore_ops) {
     TF_RETURN_IF_ERROR(op->status);
   }
@@ -447,4 +602,12 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   return OkStatus();
 }
 
+void ScheduleSave(const string& prefix, std::function<Status()> save) {
+  PendingSaves::Global()->Schedule(prefix, std::move(save));
+}
+
+Status WaitForPendingSaves(const string& prefix) {
+  return PendingSaves::Global()->Wait(prefix);
+}
+
 }  // namespace tensorflow
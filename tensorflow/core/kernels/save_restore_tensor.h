@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
 #define TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
 
+#include <functional>
+
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_writer.h"
 
@@ -63,10 +65,30 @@ void RestoreTensor(OpKernelContext* context,
 //   * "prefix" has 1 element, DT_STRING.
 //   * "tensor_names" and "shape_and_slices" shaped {N}, both DT_STRING.
 //   * "dtypes" has N elements, the datatypes of the to-restore tensors.
+//
+// If "map_tensors" is true, full tensors are backed by read-only memory
+// mappings of the data files where possible (see BundleReader::LookupMapped),
+// so their bytes are only read when first touched.
+//
+// If "share_tensors" is true, full tensors that are not mapped are shared with
+// identical tensors restored elsewhere in the process where possible (see
+// BundleReader::LookupShared).
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes);
+                        gtl::ArraySlice<DataType> dtypes,
+                        bool map_tensors = false, bool share_tensors = false);
+
+// Runs `save`, which writes the V2 checkpoint `prefix`, on a background thread
+// pool and returns immediately. The caller must first wait for the pending
+// saves of `prefix` with WaitForPendingSaves(), as concurrent writers of the
+// same files would corrupt them.
+void ScheduleSave(const string& prefix, std::function<Status()> save);
+
+// Waits until the saves of `prefix` scheduled by ScheduleSave() are done, and
+// returns the error of the first one that failed since the last call, if any.
+// RestoreTensorsV2() waits for the saves of the checkpoint it reads.
+Status WaitForPendingSaves(const string& prefix);
 
 }  // namespace tensorflow
 
@@ -87,12 +87,76 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// Writes `tensors` to the checkpoint `prefix` under `tensor_names`. Tensors
+// with a non-empty entry in `shape_and_slices` are saved as slices.
+Status WriteTensors(const string& prefix,
+                    const std::vector<string>& tensor_names,
+                    const std::vector<string>& shape_and_slices,
+                    const std::vector<Tensor>& tensors) {
+  BundleWriter writer(Env::Default(), prefix);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix;
+
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const string& tensor_name = tensor_names[i];
+    const Tensor& tensor = tensors[i];
+    VLOG(2) << "Starting save of " << tensor_name;
+
+    if (!shape_and_slices[i].empty()) {
+      const string& shape_spec = shape_and_slices[i];
+      TensorShape shape;
+      TensorSlice slice(tensor.dims());
+      TensorShape slice_shape;
+
+      TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(shape_spec, &shape,
+                                                        &slice, &slice_shape));
+      if (!slice_shape.IsSameSize(tensor.shape())) {
+        return errors::InvalidArgument(
+            "Slice in shape_and_slice specification does not match the shape "
+            "of the tensor to  save: ",
+            shape_spec, ", tensor: ", tensor.shape().DebugString());
+      }
+
+      TF_RETURN_IF_ERROR(writer.AddSlice(tensor_name, shape, slice, tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(tensor_name, tensor));
+    }
+
+    if (VLOG_IS_ON(5)) {
+      if (tensor.dtype() == DT_FLOAT) {
+        const float* t_data = tensor.flat<float>().data();
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        double avg = 0.0;
+        for (int i = 0; i < tensor.NumElements(); ++i) {
+          if (t_data[i] < min) min = t_data[i];
+          if (t_data[i] > max) max = t_data[i];
+          avg += t_data[i];
+        }
+        VLOG(5) << " min " << min << " max " << max << " avg "
+                << avg / tensor.NumElements() << " total elts "
+                << tensor.NumElements();
+      }
+    }
+
+    VLOG(2) << "Done save of " << tensor_name;
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  VLOG(1) << "Done BundleWriter, prefix_string: " << prefix;
+  return OkStatus();
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    // Set by training loops that overlap checkpointing with the next steps.
+    if (!context->GetAttr(kAsyncSaveAttr, &async_save_).ok()) {
+      async_save_ = false;
+    }
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -104,81 +168,81 @@ class SaveV2 : public OpKernel {
 
     const int kFixedInputs = 3;  // Prefix, tensor names, shape_and_slices.
     const int num_tensors = static_cast<int>(tensor_names.NumElements());
-    const string& prefix_string = prefix.scalar<tstring>()();
+    const string prefix_string = prefix.scalar<tstring>()();
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
+    // Holding references to the inputs is enough to snapshot the values of
+    // resource variables, as their updates copy buffers referenced elsewhere.
+    std::vector<string> names(num_tensors);
+    std::vector<string> slice_specs(num_tensors);
+    std::vector<Tensor> tensors(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
-      const Tensor& tensor = context->input(i + kFixedInputs);
-      VLOG(2) << "Starting save of " << tensor_name;
-
-      if (!shape_and_slices_flat(i).empty()) {
-        const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
-        TensorShape slice_shape;
-
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
-        OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
-                    errors::InvalidArgument("Slice in shape_and_slice "
-                                            "specification does not match the "
-                                            "shape of the tensor to  save: ",
-                                            shape_spec, ", tensor: ",
-                                            tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
-      }
-
-      if (VLOG_IS_ON(5)) {
-        if (tensor.dtype() == DT_FLOAT) {
-          const float* t_data = tensor.flat<float>().data();
-          float min = std::numeric_limits<float>::infinity();
-          float max = -std::numeric_limits<float>::infinity();
-          double avg = 0.0;
-          for (int i = 0; i < tensor.NumElements(); ++i) {
-            if (t_data[i] < min) min = t_data[i];
-            if (t_data[i] > max) max = t_data[i];
-            avg += t_data[i];
-          }
-          VLOG(5) << " min " << min << " max " << max << " avg "
-                  << avg / tensor.NumElements() << " total elts "
-                  << tensor.NumElements();
-        }
-      }
+      names[i] = tensor_names_flat(i);
+      slice_specs[i] = shape_and_slices_flat(i);
+      tensors[i] = context->input(i + kFixedInputs);
+    }
 
-      VLOG(2) << "Done save of " << tensor_name;
+    // Reports the failure of a previous asynchronous save of the same
+    // checkpoint, and keeps two writers from writing the same files.
+    OP_REQUIRES_OK(context, WaitForPendingSaves(prefix_string));
+    if (!async_save_) {
+      OP_REQUIRES_OK(context,
+                     WriteTensors(prefix_string, names, slice_specs, tensors));
+      RunCheckpointCallbacks(context, prefix_string);
+      return;
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
 
+    checkpoint::CheckpointCallbackManager* checkpoint_callback_manager;
+    OP_REQUIRES_OK(context, LookupCheckpointCallbackManager(
+                                context, &checkpoint_callback_manager));
+    ScheduleSave(
+        prefix_string,
+        [prefix_string, names = std::move(names),
+         slice_specs = std::move(slice_specs), tensors = std::move(tensors),
+         checkpoint_callback_manager]() {
+          Status status =
+              WriteTensors(prefix_string, names, slice_specs, tensors);
+          if (checkpoint_callback_manager != nullptr) {
+            if (status.ok()) checkpoint_callback_manager->Save(prefix_string);
+            checkpoint_callback_manager->Unref();
+          }
+          return status;
+        });
+  }
+
+ private:
+  // Sets `*checkpoint_callback_manager` to a new reference to the callback
+  // manager of the op's resource manager, or to nullptr if there is none.
+  static Status LookupCheckpointCallbackManager(
+      OpKernelContext* context,
+      checkpoint::CheckpointCallbackManager** checkpoint_callback_manager) {
+    *checkpoint_callback_manager = nullptr;
     ResourceMgr* resource_manager = context->resource_manager();
-    if (resource_manager != nullptr) {
-      checkpoint::CheckpointCallbackManager* checkpoint_callback_manager;
-      OP_REQUIRES_OK(
-          context,
-          resource_manager
-              ->LookupOrCreate<checkpoint::CheckpointCallbackManager>(
-                  resource_manager->default_container(),
-                  std::string(
-                      checkpoint::kCheckpointCallbackManagerResourceName),
-                  &checkpoint_callback_manager,
-                  [](checkpoint::CheckpointCallbackManager** out) {
-                    *out = new checkpoint::CheckpointCallbackManager();
-                    return OkStatus();
-                  }));
-      checkpoint_callback_manager->Save(prefix_string);
+    if (resource_manager == nullptr) return OkStatus();
+    return resource_manager
+        ->LookupOrCreate<checkpoint::CheckpointCallbackManager>(
+            resource_manager->default_container(),
+            std::string(checkpoint::kCheckpointCallbackManagerResourceName),
+            checkpoint_callback_manager,
+            [](checkpoint::CheckpointCallbackManager** out) {
+              *out = new checkpoint::CheckpointCallbackManager();
+              return OkStatus();
+            });
+  }
+
+  static void RunCheckpointCallbacks(OpKernelContext* context,
+                                     const string& prefix) {
+    checkpoint::CheckpointCallbackManager* checkpoint_callback_manager;
+    OP_REQUIRES_OK(context, LookupCheckpointCallbackManager(
+                                context, &checkpoint_callback_manager));
+    if (checkpoint_callback_manager != nullptr) {
+      checkpoint_callback_manager->Save(prefix);
       checkpoint_callback_manager->Unref();
     }
   }
+
+  bool async_save_;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
@@ -187,6 +251,14 @@ class RestoreV2 : public OpKernel {
  public:
   explicit RestoreV2(OpKernelConstruction* context) : OpKernel(context) {
     OP_REQUIRES_OK(context, context->GetAttr("dtypes", &dtypes_));
+    // Set by the SavedModel loader when variables are loaded lazily.
+    if (!context->GetAttr(kMapRestoredTensorsAttr, &map_tensors_).ok()) {
+      map_tensors_ = false;
+    }
+    // Set by SavedModel loaders that share identical weights between models.
+    if (!context->GetAttr(kShareRestoredTensorsAttr, &share_tensors_).ok()) {
+      share_tensors_ = false;
+    }
   }
 
   void Compute(OpKernelContext* context) override {
@@ -202,6 +274,8 @@ class RestoreV2 : public OpKernel {
     if (!context->status().ok()) return;
 
     const string& prefix_string = prefix.scalar<tstring>()();
+    // The checkpoint may still be written by an asynchronous SaveV2.
+    OP_REQUIRES_OK(context, WaitForPendingSaves(prefix_string));
 
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
     // reader as we upgrade to the V2 format.  This allows transparent upgrade.
@@ -224,8 +298,10 @@ class RestoreV2 : public OpKernel {
       return;
     }
     // If found, invokes the V2 reader.
-    OP_REQUIRES_OK(context, RestoreTensorsV2(context, prefix, tensor_names,
-                                             shape_and_slices, dtypes_));
+    OP_REQUIRES_OK(context,
+                   RestoreTensorsV2(context, prefix, tensor_names,
+                                    shape_and_slices, dtypes_, map_tensors_,
+                                    share_tensors_));
 
     ResourceMgr* resource_manager = context->resource_manager();
     if (resource_manager != nullptr) {
@@ -250,6 +326,10 @@ class RestoreV2 : public OpKernel {
  private:
   // Expected dtypes of the to-restore tensors.
   std::vector<DataType> dtypes_;
+  // Whether to map (kMapRestoredTensorsAttr) or share
+  // (kShareRestoredTensorsAttr) the restored tensors.
+  bool map_tensors_;
+  bool share_tensors_;
 };
 REGISTER_KERNEL_BUILDER(Name("RestoreV2").Device(DEVICE_CPU), RestoreV2);
 
@@ -281,6 +361,10 @@ class MergeV2Checkpoints : public OpKernel {
         gtl::ArraySlice<tstring>(checkpoint_prefixes.flat<tstring>());
     Env* env = Env::Default();
     const string& merged_prefix = destination_prefix.scalar<tstring>()();
+    // The shards may still be written by asynchronous SaveV2 ops.
+    for (const tstring& input_prefix : input_prefixes) {
+      OP_REQUIRES_OK(context, WaitForPendingSaves(input_prefix));
+    }
     OP_REQUIRES_OK(context,
                    tensorflow::MergeBundles(env, input_prefixes, merged_prefix,
                                             allow_missing_files_));
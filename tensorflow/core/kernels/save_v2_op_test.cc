@@ -23,12 +23,15 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/save_restore_tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
@@ -340,5 +343,63 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+class AsyncSaveV2OpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                     .Input(FakeInput())  // prefix
+                     .Input(FakeInput())  // tensor_names
+                     .Input(FakeInput())  // shape_and_slices
+                     .Input(FakeInput({DT_FLOAT, DT_INT32}))  // tensors
+                     .Attr(kAsyncSaveAttr, true)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(AsyncSaveV2OpTest, WritesInBackground) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_async");
+
+  MakeOp();
+  AddInputFromArray<tstring>(TensorShape({}), {prefix});
+  AddInputFromArray<tstring>(TensorShape({2}),
+                             {"tensor_float", "tensor_slice"});
+  AddInputFromArray<tstring>(TensorShape({2}), {"", "4 0,2"});
+  AddInput<float>(TensorShape({2, 3}),
+                  [](int x) -> float { return static_cast<float>(x) / 10; });
+  AddInput<int32>(TensorShape({2}), [](int x) -> int32 { return x + 1; });
+  TF_ASSERT_OK(RunOpKernel());
+  TF_ASSERT_OK(WaitForPendingSaves(prefix));
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("tensor_float", &val));
+  ASSERT_EQ(val.NumElements(), 6);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(static_cast<float>(i) / 10, val.flat<float>()(i));
+  }
+  TensorShape shape;
+  TF_ASSERT_OK(reader.LookupTensorShape("tensor_slice", &shape));
+  EXPECT_EQ(shape, TensorShape({4}));
+}
+
+TEST_F(AsyncSaveV2OpTest, ReportsErrorOnWait) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_async_error");
+
+  MakeOp();
+  AddInputFromArray<tstring>(TensorShape({}), {prefix});
+  AddInputFromArray<tstring>(TensorShape({2}),
+                             {"tensor_float", "tensor_slice"});
+  // The slice does not match the shape of the tensor.
+  AddInputFromArray<tstring>(TensorShape({2}), {"", "4 0,3"});
+  AddInput<float>(TensorShape({2, 3}), [](int x) -> float { return x; });
+  AddInput<int32>(TensorShape({2}), [](int x) -> int32 { return x; });
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_TRUE(errors::IsInvalidArgument(WaitForPendingSaves(prefix)));
+  // The error is only reported once.
+  TF_EXPECT_OK(WaitForPendingSaves(prefix));
+}
+
 }  // namespace
 }  // namespace tensorflow
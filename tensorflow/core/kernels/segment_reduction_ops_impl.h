@@ -18,7 +18,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 #define TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <vector>
 
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/types.h"
@@ -40,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
 
@@ -76,6 +79,67 @@ Status ValidateSparseSegmentReduction(OpKernelContext* context,
                                       const Tensor& indices,
                                       const Tensor& segment_ids,
                                       bool has_num_segments);
+
+// Splits the sorted `segment_vec` into segments: the k-th segment has id
+// (*segment_ids)[k] and starts at offset (*segment_starts)[k]. Returns an error
+// if the segment ids are not increasing or not in [0, output_rows).
+template <typename SegmentId>
+Status FindSegments(typename TTypes<SegmentId>::ConstVec segment_vec,
+                    int64_t output_rows, std::vector<int64_t>* segment_starts,
+                    std::vector<SegmentId>* segment_ids) {
+  const int64_t num_indices = segment_vec.dimension(0);
+  segment_starts->clear();
+  segment_ids->clear();
+  if (num_indices == 0) return OkStatus();
+  SegmentId out_index = internal::SubtleMustCopy(segment_vec(0));
+  int64_t start = 0;
+  for (int64_t end = 1; end <= num_indices; ++end) {
+    SegmentId next_index = 0;
+    if (end < num_indices) {
+      next_index = internal::SubtleMustCopy(segment_vec(end));
+      if (out_index == next_index) continue;
+      // We have a new segment here.  Verify that the segment ids are growing.
+      if (!(out_index < next_index)) {
+        return errors::InvalidArgument("segment ids are not increasing");
+      }
+    }
+    if (!FastBoundsCheck(out_index, output_rows)) {
+      return errors::InvalidArgument(
+          "Segment id ", out_index, " out of range [0, ", output_rows,
+          "), possibly because 'segment_ids' input is not sorted.");
+    }
+    segment_starts->push_back(start);
+    segment_ids->push_back(out_index);
+    start = end;
+    out_index = next_index;
+  }
+  return OkStatus();
+}
+
+// Calls `fn(k, start, end)` for each segment k of `segment_starts`, covering
+// the offsets [start, end) of the `num_indices` indices. The segments are
+// split across the threads of `device` by their number of indices rather than
+// by number, so that many small segments are reduced in large contiguous
+// chunks. Each segment is reduced by a single thread, in order.
+template <typename Fn>
+void ParallelForEachSegment(const CPUDevice& device,
+                            const std::vector<int64_t>& segment_starts,
+                            int64_t num_indices,
+                            const Eigen::TensorOpCost& cost_per_index,
+                            const Fn& fn) {
+  const int64_t num_segments = segment_starts.size();
+  // A segment belongs to the block of indices its first index is in.
+  device.parallelFor(
+      num_indices, cost_per_index, [&](int64_t begin, int64_t end) {
+        for (int64_t k = std::lower_bound(segment_starts.begin(),
+                                          segment_starts.end(), begin) -
+                         segment_starts.begin();
+             k < num_segments && segment_starts[k] < end; ++k) {
+          fn(k, segment_starts[k],
+             k + 1 < num_segments ? segment_starts[k + 1] : num_indices);
+        }
+      });
+}
 }  // namespace internal
 
 // This operator handles reducing segments along the first dimension.
@@ -125,42 +189,18 @@ class SegmentReductionOp : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    Eigen::IndexList<Eigen::type2index<0> > dims_to_reduce;
-    Index start = 0, end = 1;
-
-    Index uninitialized_index = 0;  // Index from which the output is not set.
-    Index out_index = internal::SubtleMustCopy(segment_vec(start));
+    std::vector<int64_t> segment_starts;
+    std::vector<Index> out_indices;
+    OP_REQUIRES_OK(context, internal::FindSegments<Index>(
+                                segment_vec, output_rows, &segment_starts,
+                                &out_indices));
 
-    // TODO(agarwal): if this loop becomes a bottleneck, consider sharding it
-    // across threads.
+    Eigen::IndexList<Eigen::type2index<0> > dims_to_reduce;
     Eigen::DSizes<Eigen::DenseIndex, 1> out_slice_shape(num_col);
-    while (end <= num_indices) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      Index next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
-      }
-
-      // Process segment [start, end)
-      const T* in_slice_ptr = &input_flat(start, 0);
-      typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
-                               Eigen::Unaligned>
-          OutT;
-
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
+    auto reduce_segment = [&](int64_t k, int64_t start, int64_t end) {
+      const Index out_index = out_indices[k];
+      // Index from which the output is not set.
+      const Index uninitialized_index = k == 0 ? 0 : out_indices[k - 1] + 1;
 
       // If there is a gap between two indices, we need to set that gap to the
       // default value.
@@ -172,12 +212,18 @@ class SegmentReductionOp : public OpKernel {
         gap_slice.setConstant(T(default_value));
       }
 
+      // Process segment [start, end)
+      const T* in_slice_ptr = &input_flat(start, 0);
+      typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
+                               Eigen::Unaligned>
+          OutT;
       T* out_slice_ptr = &output_flat(out_index, 0);
       OutT out_slice(out_slice_ptr, out_slice_shape);
       // We don't use out_slice.device(context->eigen_device<Device>)
       // because these pieces of work are likely to be very small and
       // the context switching overhead dwarfs any benefit we get from
-      // using another thread to do this work.
+      // using another thread to do this work. The segments are sharded
+      // instead.
       if (start == end - 1) {
         typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
                                  Eigen::Unaligned>
@@ -194,12 +240,14 @@ class SegmentReductionOp : public OpKernel {
 
         out_slice = in_slice.reduce(dims_to_reduce, Reducer());
       }
-      if (end >= num_indices) break;
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-    }
+    };
+
+    const Eigen::TensorOpCost cost_per_row(
+        num_col * sizeof(T), num_col * sizeof(T),
+        num_col * Eigen::TensorOpCost::AddCost<T>());
+    internal::ParallelForEachSegment(context->eigen_device<Device>(),
+                                     segment_starts, num_indices, cost_per_row,
+                                     reduce_segment);
   }
 };
 
@@ -596,32 +644,20 @@ class SparseSegmentReductionOpBase : public OpKernel {
     }
     auto temp_flat = temp.flat_outer_dims<float>();
 
-    int64_t start = 0, end = 1;
-    // Index from which the output is not initialized.
-    SegmentId uninitialized_index = 0;
-    SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      SegmentId next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
-      }
-
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
+    std::vector<int64_t> segment_starts;
+    std::vector<SegmentId> out_indices;
+    OP_REQUIRES_OK(context, internal::FindSegments<SegmentId>(
+                                segment_vec, output_rows, &segment_starts,
+                                &out_indices));
+
+    // The smallest offset of an out of range index, if any.
+    mutex bad_offset_mu;
+    int64_t bad_offset = num_indices;
+    auto reduce_segment = [&](int64_t k, int64_t start, int64_t end) {
+      const SegmentId out_index = out_indices[k];
+      // Index from which the output is not initialized.
+      const SegmentId uninitialized_index =
+          k == 0 ? 0 : out_indices[k - 1] + 1;
 
       // If there is a gap between two indices, we need to set that gap to the
       // default value.
@@ -635,22 +671,28 @@ class SparseSegmentReductionOpBase : public OpKernel {
 
       auto out = output_flat.template chip<0>(out_index);
       auto temp = temp_flat.template chip<0>(out_index);
-      const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-      if (end > num_indices) break;
-    }
+      const int64_t segment_bad_offset = Reduce<T, Index>(
+          input_flat, indices_vec, start, end - start, out, temp);
+      if (segment_bad_offset >= 0) {
+        mutex_lock l(bad_offset_mu);
+        bad_offset = std::min(bad_offset, start + segment_bad_offset);
+      }
+    };
+
+    const Eigen::TensorOpCost cost_per_index(
+        num_col * sizeof(T), num_col * sizeof(T),
+        num_col * Eigen::TensorOpCost::AddCost<T>());
+    internal::ParallelForEachSegment(context->eigen_device<Device>(),
+                                     segment_starts, num_indices,
+                                     cost_per_index, reduce_segment);
+    OP_REQUIRES(context, bad_offset == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_offset, "] == ",
+                    indices_vec(bad_offset), " out of range [0, ",
+                    input_flat.dimension(0), ")"));
 
     // Fill the gap at the end with the default value.
+    const SegmentId uninitialized_index = out_indices.back() + 1;
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
           output_rows - uninitialized_index, num_col);
@@ -181,6 +181,45 @@ BM_Reduce_Arg(64, 32, 2);
 BM_Reduce_Arg(4096, 32, 2);
 BM_Reduce_Arg(4096, 128, 2);
 
+// Many small segments.
+BM_Reduce_Arg(65536, 64, 4);
+
+static void BM_SparseSegmentSum(::testing::benchmark::State& state) {
+  const int num_indices = state.range(0);
+  const int segment_size = state.range(1);
+  const int kNumRows = 100000;
+  const int kDim = 64;
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor input(DT_FLOAT, TensorShape({kNumRows, kDim}));
+  input.flat<float>().setRandom();
+  Tensor indices(DT_INT32, TensorShape({num_indices}));
+  Tensor segments(DT_INT32, TensorShape({num_indices}));
+  for (int i = 0; i < num_indices; ++i) {
+    indices.flat<int32>()(i) = (i * 7919) % kNumRows;
+    segments.flat<int32>()(i) = i / segment_size;
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, indices))
+                  .Input(test::graph::Constant(g, segments))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_indices * kDim * sizeof(float));
+}
+
+BENCHMARK(BM_SparseSegmentSum)
+    ->UseRealTime()
+    ->ArgPair(1 << 16, 1)
+    ->ArgPair(1 << 16, 4)
+    ->ArgPair(1 << 16, 64)
+    ->ArgPair(1 << 20, 4);
+
 template <DataType T>
 static void SparseSegmentMeanGradHelper(::testing::benchmark::State& state,
                                         float uniqueness, int size) {
@@ -16,11 +16,16 @@ limitations under the License.
 #include "tensorflow/core/kernels/sendrecv_ops.h"
 
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/framework/variant_encode_decode.h"
+#include "tensorflow/core/framework/variant_op_registry.h"
+#include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -234,6 +239,115 @@ REGISTER_KERNEL_BUILDER(Name("Recv").Device(DEVICE_DEFAULT), RecvOp);
 REGISTER_KERNEL_BUILDER(
     Name("_HostRecv").Device(DEVICE_DEFAULT).HostMemory("tensor"), RecvOp);
 
+namespace {
+
+// A group of tensors that crosses a pair of devices as a single rendezvous
+// item. See `PartitionOptions::group_send_recv`.
+struct TensorGroup {
+  static constexpr const char kTypeName[] = "tensorflow::TensorGroup";
+
+  string TypeName() const { return kTypeName; }
+
+  void Encode(VariantTensorData* data) const {
+    data->set_type_name(TypeName());
+    for (const Tensor& t : tensors) {
+      *data->add_tensors() = t;
+    }
+  }
+
+  bool Decode(const VariantTensorData& data) {
+    tensors = data.tensors();
+    return true;
+  }
+
+  string DebugString() const {
+    return strings::StrCat("TensorGroup(", tensors.size(), ")");
+  }
+
+  std::vector<Tensor> tensors;
+};
+
+constexpr const char TensorGroup::kTypeName[];
+
+Status TensorGroupDeviceCopy(
+    const TensorGroup& from, TensorGroup* to,
+    const UnaryVariantOpRegistry::AsyncTensorDeviceCopyFn& copy) {
+  to->tensors.resize(from.tensors.size());
+  for (int i = 0; i < from.tensors.size(); ++i) {
+    TF_RETURN_IF_ERROR(copy(from.tensors[i], &to->tensors[i]));
+  }
+  return OkStatus();
+}
+
+#define REGISTER_TENSOR_GROUP_COPY(DIRECTION)                                  \
+  INTERNAL_REGISTER_UNARY_VARIANT_DEVICE_COPY_FUNCTION(TensorGroup, DIRECTION, \
+                                                       TensorGroupDeviceCopy)
+
+REGISTER_TENSOR_GROUP_COPY(VariantDeviceCopyDirection::HOST_TO_DEVICE);
+REGISTER_TENSOR_GROUP_COPY(VariantDeviceCopyDirection::DEVICE_TO_HOST);
+REGISTER_TENSOR_GROUP_COPY(VariantDeviceCopyDirection::DEVICE_TO_DEVICE);
+
+#undef REGISTER_TENSOR_GROUP_COPY
+
+REGISTER_UNARY_VARIANT_DECODE_FUNCTION(TensorGroup, TensorGroup::kTypeName);
+
+class PackTensorGroupOp : public OpKernel {
+ public:
+  explicit PackTensorGroupOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    TensorGroup group;
+    group.tensors.reserve(ctx->num_inputs());
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      group.tensors.push_back(ctx->input(i));
+    }
+    Tensor* output;
+    AllocatorAttributes attr;
+    attr.set_on_host(true);
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, {}, &output, attr));
+    output->scalar<Variant>()() = std::move(group);
+  }
+};
+
+class UnpackTensorGroupOp : public OpKernel {
+ public:
+  explicit UnpackTensorGroupOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& input = ctx->input(0);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(input.shape()),
+                errors::InvalidArgument("Expected a scalar group but got ",
+                                        input.shape().DebugString()));
+    const TensorGroup* group = input.scalar<Variant>()().get<TensorGroup>();
+    OP_REQUIRES(ctx, group != nullptr,
+                errors::InvalidArgument("Expected a TensorGroup but got ",
+                                        input.scalar<Variant>()().TypeName()));
+    OP_REQUIRES(ctx, group->tensors.size() == ctx->num_outputs(),
+                errors::InvalidArgument("Expected a group of ",
+                                        ctx->num_outputs(), " tensors but got ",
+                                        group->tensors.size()));
+    for (int i = 0; i < ctx->num_outputs(); ++i) {
+      OP_REQUIRES(ctx, group->tensors[i].dtype() == output_type(i),
+                  errors::InvalidArgument(
+                      "Expected tensor ", i, " of the group to have type ",
+                      DataTypeString(output_type(i)), " but got ",
+                      DataTypeString(group->tensors[i].dtype())));
+      ctx->set_output(i, group->tensors[i]);
+    }
+  }
+};
+
+}  // namespace
+
+REGISTER_KERNEL_BUILDER(Name("_PackTensorGroup").Device(DEVICE_CPU),
+                        PackTensorGroupOp);
+REGISTER_KERNEL_BUILDER(Name("_PackTensorGroup").Device(DEVICE_DEFAULT),
+                        PackTensorGroupOp);
+REGISTER_KERNEL_BUILDER(Name("_UnpackTensorGroup").Device(DEVICE_CPU),
+                        UnpackTensorGroupOp);
+REGISTER_KERNEL_BUILDER(Name("_UnpackTensorGroup").Device(DEVICE_DEFAULT),
+                        UnpackTensorGroupOp);
+
 // Environment variable `DISABLE_HOST_SEND_RECV_REGISTRATION` is used to disable
 // hostSend and hostRecv registration on CPU device in the mock environment.
 static bool InitModule() {
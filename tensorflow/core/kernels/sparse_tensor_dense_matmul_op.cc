@@ -19,17 +19,119 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <memory>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+Status KOutOfBoundsError(int64_t k, std::size_t i, int rhs_index_a,
+                         std::size_t lhs_right) {
+  return errors::InvalidArgument("k (", k, ") from index[", i, ",", rhs_index_a,
+                                 "] out of bounds (>=", lhs_right, ")");
+}
+
+Status MOutOfBoundsError(int64_t m, std::size_t i, int lhs_index_a,
+                         int64_t out_dim0) {
+  return errors::InvalidArgument("m (", m, ") from index[", i, ",", lhs_index_a,
+                                 "] out of bounds (>=", out_dim0, ")");
+}
+
+// The nonzeros of the sparse operand (after adjoint_a) in compressed sparse
+// row form, so that every output row is computed from its own nonzeros.
+// Within a row, the nonzeros are in the order of a_indices.
+struct CsrIndex {
+  // The nonzeros of output row m are [row_offsets[m], row_offsets[m + 1]).
+  std::vector<int64_t> row_offsets;
+  // The row of b (after adjoint_b) that every nonzero multiplies.
+  std::vector<int64_t> cols;
+  // The index of every nonzero in a_values.
+  std::vector<int64_t> positions;
+};
+
+// Converts `a_indices` to the CSR index of an operand with `num_rows` rows
+// and `num_cols` columns, after adjoint_a.
+template <typename Tindices>
+Status BuildCsrIndex(typename TTypes<Tindices>::ConstMatrix a_indices,
+                     bool adjoint_a, int64_t num_rows, int64_t num_cols,
+                     CsrIndex* csr) {
+  const int64_t nnz = a_indices.dimension(0);
+  const int lhs_index_a = adjoint_a ? 1 : 0;
+  const int rhs_index_a = adjoint_a ? 0 : 1;
+  csr->row_offsets.assign(num_rows + 1, 0);
+  csr->cols.resize(nnz);
+  csr->positions.resize(nnz);
+  std::vector<int64_t> rows(nnz);
+  std::vector<int64_t> cols(nnz);
+  for (int64_t i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(k, num_cols)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, num_cols);
+    }
+    if (!FastBoundsCheck(m, num_rows)) {
+      return MOutOfBoundsError(m, i, lhs_index_a, num_rows);
+    }
+    ++csr->row_offsets[m + 1];
+    rows[i] = m;
+    cols[i] = k;
+  }
+  for (int64_t m = 0; m < num_rows; ++m) {
+    csr->row_offsets[m + 1] += csr->row_offsets[m];
+  }
+  // Places the nonzeros by counting sort, which keeps them in the order of
+  // a_indices within every row.
+  std::vector<int64_t> next(csr->row_offsets.begin(),
+                            csr->row_offsets.end() - 1);
+  for (int64_t i = 0; i < nnz; ++i) {
+    const int64_t p = next[rows[i]]++;
+    csr->cols[p] = cols[i];
+    csr->positions[p] = i;
+  }
+  return OkStatus();
+}
+
+// Computes the output rows [begin, end) of the product of the sparse operand
+// of `csr` and `a_values` with the row-major matrix `b` of `n` columns.
+// Every nonzero adds a scaled row of b to the row of the output, which Eigen
+// vectorizes.
+template <typename T>
+void CsrMatMulRows(const CsrIndex& csr, typename TTypes<T>::ConstVec a_values,
+                   bool adjoint_a, const T* b, int64_t n, int64_t begin,
+                   int64_t end, T* out) {
+  using Tsum = typename functor::SumType<T>::type;
+  using ConstRow = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+  using Row = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+  Eigen::Array<Tsum, Eigen::Dynamic, 1> sum(n);
+  for (int64_t m = begin; m < end; ++m) {
+    sum.setZero();
+    for (int64_t p = csr.row_offsets[m]; p < csr.row_offsets[m + 1]; ++p) {
+      const T a_value = a_values(csr.positions[p]);
+      const Tsum scale =
+          static_cast<Tsum>(adjoint_a ? functor::MaybeConj(a_value) : a_value);
+      sum += ConstRow(b + csr.cols[p] * n, n).template cast<Tsum>() * scale;
+    }
+    Row(out + m * n, n) = sum.template cast<T>();
+  }
+}
+
+}  // namespace
+
 template <typename Device, typename T, typename Tindices>
 class SparseTensorDenseMatMulOp : public OpKernel {
  public:
@@ -133,6 +235,10 @@ class SparseTensorDenseMatMulOp : public OpKernel {
       return;
     }
 
+    if constexpr (std::is_same<Device, CPUDevice>::value) {
+      OP_REQUIRES_OK(ctx, ComputeOnCpu(ctx, *a_indices, a_values->vec<T>(),
+                                       *b, out));
+    } else {
 #define MAYBE_ADJOINT(ADJ_A, ADJ_B)                                           \
   if (adjoint_a_ == ADJ_A && adjoint_b_ == ADJ_B) {                           \
     Status functor_status = functor::SparseTensorDenseMatMulFunctor<          \
@@ -142,17 +248,93 @@ class SparseTensorDenseMatMulOp : public OpKernel {
     OP_REQUIRES_OK(ctx, functor_status);                                      \
   }
 
-    MAYBE_ADJOINT(false, false);
-    MAYBE_ADJOINT(false, true);
-    MAYBE_ADJOINT(true, false);
-    MAYBE_ADJOINT(true, true);
+      MAYBE_ADJOINT(false, false);
+      MAYBE_ADJOINT(false, true);
+      MAYBE_ADJOINT(true, false);
+      MAYBE_ADJOINT(true, true);
 
 #undef MAYBE_ADJOINT
+    }
   }
 
  private:
+  // Multiplies in CSR form on the CPU, sharding the output rows over the
+  // intra-op threads.
+  Status ComputeOnCpu(OpKernelContext* ctx, const Tensor& a_indices,
+                      typename TTypes<T>::ConstVec a_values, const Tensor& b,
+                      Tensor* out) {
+    const int64_t num_rows = out->dim_size(0);
+    const int64_t n = out->dim_size(1);
+    const int64_t num_cols = adjoint_b_ ? b.dim_size(1) : b.dim_size(0);
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<const CsrIndex> csr,
+                        GetCsrIndex(a_indices, num_rows, num_cols));
+
+    // Multiplies by rows of b, so the adjoint of b is materialized once.
+    const T* b_rows = b.flat<T>().data();
+    Tensor b_adjoint;
+    if (adjoint_b_) {
+      TF_RETURN_IF_ERROR(ctx->allocate_temp(
+          DataTypeToEnum<T>::value, TensorShape({num_cols, n}), &b_adjoint));
+      b_adjoint.matrix<T>().device(ctx->eigen_device<CPUDevice>()) =
+          b.matrix<T>().shuffle(Eigen::array<int, 2>{1, 0}).conjugate();
+      b_rows = b_adjoint.flat<T>().data();
+    }
+
+    T* out_rows = out->flat<T>().data();
+    const int64_t nnz = a_values.size();
+    const int64_t cost_per_row =
+        (nnz / num_rows + 1) * n *
+        static_cast<int64_t>(Eigen::TensorOpCost::MulCost<T>() +
+                             Eigen::TensorOpCost::AddCost<T>());
+    const auto& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          cost_per_row, [&](int64_t begin, int64_t end) {
+            CsrMatMulRows<T>(*csr, a_values, adjoint_a_, b_rows, n, begin,
+                             end, out_rows);
+          });
+    return OkStatus();
+  }
+
+  // Returns the CSR index of `a_indices`. Models often multiply by the same
+  // sparse operand, e.g. a constant adjacency matrix, at every step, so the
+  // index of the previous call is reused while a_indices has the same
+  // contents and the shapes match. The contents are compared against a copy
+  // of the cached indices rather than by buffer, since a buffer may be
+  // updated in place between calls; the comparison is much cheaper than
+  // building the index.
+  StatusOr<std::shared_ptr<const CsrIndex>> GetCsrIndex(
+      const Tensor& a_indices, int64_t num_rows, int64_t num_cols) {
+    {
+      mutex_lock l(mu_);
+      if (cached_a_indices_.IsInitialized() &&
+          a_indices.shape() == cached_a_indices_.shape() &&
+          num_rows == cached_num_rows_ && num_cols == cached_num_cols_ &&
+          a_indices.tensor_data() == cached_a_indices_.tensor_data()) {
+        return cached_csr_;
+      }
+    }
+    auto csr = std::make_shared<CsrIndex>();
+    TF_RETURN_IF_ERROR(BuildCsrIndex<Tindices>(a_indices.matrix<Tindices>(),
+                                               adjoint_a_, num_rows, num_cols,
+                                               csr.get()));
+    Tensor a_indices_copy = tensor::DeepCopy(a_indices);
+    mutex_lock l(mu_);
+    cached_a_indices_ = std::move(a_indices_copy);
+    cached_num_rows_ = num_rows;
+    cached_num_cols_ = num_cols;
+    cached_csr_ = csr;
+    return std::shared_ptr<const CsrIndex>(std::move(csr));
+  }
+
   bool adjoint_a_;
   bool adjoint_b_;
+
+  mutex mu_;
+  Tensor cached_a_indices_ TF_GUARDED_BY(mu_);
+  int64_t cached_num_rows_ TF_GUARDED_BY(mu_) = 0;
+  int64_t cached_num_cols_ TF_GUARDED_BY(mu_) = 0;
+  std::shared_ptr<const CsrIndex> cached_csr_ TF_GUARDED_BY(mu_);
 };
 
 #define REGISTER_CPU(TypeT, TypeIndex)           \
@@ -235,126 +417,4 @@ REGISTER_KERNELS_GPU(complex128);
 #undef REGISTER_KERNELS_GPU
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
-namespace functor {
-
-namespace {
-Status KOutOfBoundsError(int64_t k, std::size_t i, int rhs_index_a,
-                         std::size_t lhs_right) {
-  return errors::InvalidArgument("k (", k, ") from index[", i, ",", rhs_index_a,
-                                 "] out of bounds (>=", lhs_right, ")");
-}
-
-Status MOutOfBoundsError(int64_t m, std::size_t i, int lhs_index_a,
-                         int64_t out_dim0) {
-  return errors::InvalidArgument("m (", m, ") from index[", i, ",", lhs_index_a,
-                                 "] out of bounds (>=", out_dim0, ")");
-}
-
-template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
-Status SparseTensorDenseMatMulImpl(
-    typename TTypes<Tsum>::Matrix out,
-    typename TTypes<Tindices>::ConstMatrix a_indices,
-    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
-  // Vectorize certain operations above this size.
-  static constexpr std::size_t kNumVectorize = 32;
-
-  const std::size_t nnz = a_values.size();
-  const std::size_t rhs_right = (ADJ_B ? b.dimension(0) : b.dimension(1));
-  const std::size_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
-  const int lhs_index_a = ADJ_A ? 1 : 0;
-  const int rhs_index_a = ADJ_A ? 0 : 1;
-
-  // TODO(ebrevdo): After many failed experiments, can't find a multi-threaded
-  // approach that achieves the performance of the single threaded
-  // one.  Perhaps Eigen threadpool implementation is just too slow?
-
-  if (rhs_right < kNumVectorize) {
-    // Disable vectorization if the RHS of output is too small
-    auto maybe_adjoint_b = MaybeAdjoint<decltype(b), ADJ_B>(b);
-
-    for (std::size_t i = 0; i < nnz; ++i) {
-      const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
-      const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
-      if (!FastBoundsCheck(k, lhs_right)) {
-        return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
-      }
-      if (!FastBoundsCheck(m, out.dimension(0))) {
-        return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));
-      }
-      const T a_value = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
-      for (std::size_t n = 0; n < rhs_right; ++n) {
-        const T b_value = maybe_adjoint_b(k, n);
-        out(m, n) += static_cast<Tsum>(a_value) * static_cast<Tsum>(b_value);
-      }
-    }
-  } else {
-    // Vectorization via Eigen.
-    const int b_chip_index = ADJ_B ? 1 : 0;
-
-#define LOOP_NNZ(b_passed)                                                  \
-  for (std::size_t i = 0; i < nnz; ++i) {                                   \
-    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a)); \
-    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a)); \
-    const T a_value = (ADJ_A) ? MaybeConj(a_values(i)) : a_values(i);       \
-    if (!FastBoundsCheck(k, lhs_right)) {                                   \
-      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);               \
-    }                                                                       \
-    if (!FastBoundsCheck(m, out.dimension(0))) {                            \
-      return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));        \
-    }                                                                       \
-    out.template chip<0>(m) +=                                              \
-        b_passed.template chip<b_chip_index>(k).template cast<Tsum>() *     \
-        static_cast<Tsum>(a_value);                                         \
-  }
-
-    if (ADJ_B) {
-      // Perform transpose and conjugation on B once, since we chip out B's
-      // columns in the nnz loop.
-      Eigen::array<int, 2> shuffle(1, 0);  // preserve dimension order
-      Eigen::Tensor<T, 2, Eigen::ColMajor> col_major_conj_b =
-          b.swap_layout().shuffle(shuffle).conjugate();
-      LOOP_NNZ(col_major_conj_b);
-    } else {
-      LOOP_NNZ(b);
-    }
-#undef LOOP_NNZ
-  }
-  return OkStatus();
-}
-}  // namespace
-
-template <typename T, typename Tindices, bool ADJ_A, bool ADJ_B>
-struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
-  static Status Compute(OpKernelContext* ctx, typename TTypes<T>::Matrix out,
-                        typename TTypes<Tindices>::ConstMatrix a_indices,
-                        typename TTypes<T>::ConstVec a_values,
-                        typename TTypes<T>::ConstMatrix b) {
-    using Tsum = typename SumType<T>::type;
-    Tensor temp_out_t;
-    if (!std::is_same<T, Tsum>::value) {
-      TF_RETURN_IF_ERROR(ctx->allocate_temp(
-          DataTypeToEnum<Tsum>::value,
-          TensorShape({out.dimension(0), out.dimension(1)}), &temp_out_t));
-      auto temp_out = temp_out_t.matrix<Tsum>();
-      temp_out.setZero();
-      TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              temp_out, a_indices, a_values, b));
-      out = temp_out.template cast<T>();
-    } else {
-      out.setZero();
-      // This reinterpret_cast is just to avoid a compilation error. The result
-      // is only used if Tsum == T.
-      auto out_workaround =
-          *reinterpret_cast<typename TTypes<Tsum>::Matrix*>(&out);
-      TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              out_workaround, a_indices, a_values, b));
-    }
-    return OkStatus();
-  }
-};
-
-}  // namespace functor
-
 }  // namespace tensorflow
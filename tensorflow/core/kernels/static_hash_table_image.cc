@@ -0,0 +1,267 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/static_hash_table_image.h"
+
+#include <cstring>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/numeric/bits.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/errors.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+constexpr char kMagic[] = "TFSHTBL1";
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kHeaderSize = 64;
+constexpr uint64_t kAlignment = 64;
+constexpr uint64_t kEntrySize = 16;
+constexpr int kKeyOffsetBits = 40;
+constexpr uint64_t kMaxKeyOffset = (uint64_t{1} << kKeyOffsetBits) - 1;
+constexpr uint64_t kMaxKeyLength = (uint64_t{1} << (64 - kKeyOffsetBits)) - 1;
+constexpr int kGroupSize = StaticHashTableImage::kGroupSize;
+
+// Offsets of the fields of the header.
+constexpr int kVersionOffset = 8;
+constexpr int kNumEntriesOffset = 16;
+constexpr int kNumGroupsOffset = 24;
+constexpr int kTagsOffset = 32;
+constexpr int kEntriesOffset = 40;
+constexpr int kStringsOffset = 48;
+constexpr int kStringsSizeOffset = 56;
+
+uint64_t AlignUp(uint64_t offset) {
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+uint8_t HashTag(uint64_t hash) { return 0x80 | (hash & 0x7f); }
+
+uint64_t HashGroup(uint64_t hash, uint64_t num_groups) {
+  return (hash >> 7) & (num_groups - 1);
+}
+
+// Returns a mask with bit i set if the tag of slot i of `group` is `tag`.
+uint32_t MatchTag(const uint8_t* group, uint8_t tag) {
+#ifdef __SSE2__
+  const __m128i tags =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  return _mm_movemask_epi8(
+      _mm_cmpeq_epi8(tags, _mm_set1_epi8(static_cast<char>(tag))));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < kGroupSize; ++i) {
+    mask |= static_cast<uint32_t>(group[i] == tag) << i;
+  }
+  return mask;
+#endif
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<StaticHashTableImage>> StaticHashTableImage::Open(
+    Env* env, const string& filename) {
+  std::unique_ptr<StaticHashTableImage> image(new StaticHashTableImage);
+  if (env->NewReadOnlyMemoryRegionFromFile(filename, &image->region_).ok()) {
+    image->image_ =
+        StringPiece(static_cast<const char*>(image->region_->data()),
+                    image->region_->length());
+  } else {
+    TF_RETURN_IF_ERROR(ReadFileToString(env, filename, &image->buffer_));
+    image->image_ = image->buffer_;
+  }
+  Status s = image->Init();
+  if (!s.ok()) {
+    return errors::DataLoss("Invalid static hash table image ", filename, ": ",
+                            s.error_message());
+  }
+  return image;
+}
+
+Status StaticHashTableImage::Init() {
+  if (image_.size() < kHeaderSize ||
+      memcmp(image_.data(), kMagic, kVersionOffset) != 0) {
+    return errors::InvalidArgument("bad magic number");
+  }
+  const char* header = image_.data();
+  const uint32_t version = core::DecodeFixed32(header + kVersionOffset);
+  if (version != kVersion) {
+    return errors::InvalidArgument("unsupported version ", version);
+  }
+  num_entries_ = core::DecodeFixed64(header + kNumEntriesOffset);
+  num_groups_ = core::DecodeFixed64(header + kNumGroupsOffset);
+  const uint64_t tags_offset = core::DecodeFixed64(header + kTagsOffset);
+  const uint64_t entries_offset = core::DecodeFixed64(header + kEntriesOffset);
+  const uint64_t strings_offset = core::DecodeFixed64(header + kStringsOffset);
+  const uint64_t strings_size =
+      core::DecodeFixed64(header + kStringsSizeOffset);
+
+  // Checks the regions against the size of the image without overflowing.
+  const uint64_t size = image_.size();
+  if (num_groups_ == 0 || (num_groups_ & (num_groups_ - 1)) != 0 ||
+      num_groups_ > size / (kGroupSize * kEntrySize)) {
+    return errors::InvalidArgument("bad number of groups ", num_groups_);
+  }
+  const uint64_t num_slots = num_groups_ * kGroupSize;
+  if (num_entries_ > num_slots) {
+    return errors::InvalidArgument("bad number of entries ", num_entries_);
+  }
+  if (tags_offset > size || size - tags_offset < num_slots ||
+      entries_offset > size ||
+      (size - entries_offset) / kEntrySize < num_slots ||
+      strings_offset > size || size - strings_offset < strings_size) {
+    return errors::InvalidArgument("region out of bounds");
+  }
+  tags_ = reinterpret_cast<const uint8_t*>(image_.data() + tags_offset);
+  entries_ = image_.data() + entries_offset;
+  strings_ = StringPiece(image_.data() + strings_offset, strings_size);
+  return OkStatus();
+}
+
+StringPiece StaticHashTableImage::Key(uint64_t slot) const {
+  const uint64_t packed = core::DecodeFixed64(entries_ + slot * kEntrySize);
+  const uint64_t offset = packed & kMaxKeyOffset;
+  const uint64_t length = packed >> kKeyOffsetBits;
+  // A corrupted entry matches no key rather than reading out of bounds.
+  if (offset > strings_.size() || strings_.size() - offset < length) {
+    return StringPiece();
+  }
+  return StringPiece(strings_.data() + offset, length);
+}
+
+int64_t StaticHashTableImage::Value(uint64_t slot) const {
+  return static_cast<int64_t>(
+      core::DecodeFixed64(entries_ + slot * kEntrySize + 8));
+}
+
+bool StaticHashTableImage::Find(StringPiece key, int64_t* value) const {
+  const uint64_t hash = Hash64(key.data(), key.size());
+  const uint8_t tag = HashTag(hash);
+  uint64_t group = HashGroup(hash, num_groups_);
+  for (uint64_t probe = 0; probe < num_groups_; ++probe) {
+    const uint8_t* group_tags = tags_ + group * kGroupSize;
+    for (uint32_t match = MatchTag(group_tags, tag); match != 0;
+         match &= match - 1) {
+      const uint64_t slot = group * kGroupSize + absl::countr_zero(match);
+      if (Key(slot) == key) {
+        *value = Value(slot);
+        return true;
+      }
+    }
+    // Keys are inserted in the first group with an empty slot on their probe
+    // sequence, so they can't be past a group with an empty slot.
+    if (MatchTag(group_tags, 0) != 0) return false;
+    group = (group + 1) & (num_groups_ - 1);
+  }
+  return false;
+}
+
+Status WriteStaticHashTableImage(Env* env, const string& filename,
+                                 const std::vector<StringPiece>& keys,
+                                 const std::vector<int64_t>& values) {
+  if (keys.size() != values.size()) {
+    return errors::InvalidArgument("Got ", keys.size(), " keys and ",
+                                   values.size(), " values.");
+  }
+  std::vector<std::pair<StringPiece, int64_t>> entries;
+  absl::flat_hash_map<StringPiece, int64_t> unique_keys;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto inserted = unique_keys.emplace(keys[i], values[i]);
+    if (inserted.second) {
+      entries.emplace_back(keys[i], values[i]);
+    } else if (inserted.first->second != values[i]) {
+      return errors::InvalidArgument("Key ", keys[i], " has values ",
+                                     inserted.first->second, " and ",
+                                     values[i], ".");
+    }
+  }
+
+  // Keeps the load factor at most 7/8, so that probe sequences stay short.
+  uint64_t num_groups = 1;
+  while (num_groups * kGroupSize * 7 / 8 < entries.size()) {
+    num_groups *= 2;
+  }
+  const uint64_t num_slots = num_groups * kGroupSize;
+  const uint64_t tags_offset = kHeaderSize;
+  const uint64_t entries_offset = AlignUp(tags_offset + num_slots);
+  const uint64_t strings_offset =
+      AlignUp(entries_offset + num_slots * kEntrySize);
+  uint64_t strings_size = 0;
+  for (const auto& entry : entries) {
+    strings_size += entry.first.size();
+  }
+  if (strings_size > kMaxKeyOffset) {
+    return errors::InvalidArgument("The keys are too large: ", strings_size,
+                                   " bytes.");
+  }
+
+  string image(strings_offset + strings_size, '\0');
+  char* header = &image[0];
+  memcpy(header, kMagic, kVersionOffset);
+  core::EncodeFixed32(header + kVersionOffset, kVersion);
+  core::EncodeFixed64(header + kNumEntriesOffset, entries.size());
+  core::EncodeFixed64(header + kNumGroupsOffset, num_groups);
+  core::EncodeFixed64(header + kTagsOffset, tags_offset);
+  core::EncodeFixed64(header + kEntriesOffset, entries_offset);
+  core::EncodeFixed64(header + kStringsOffset, strings_offset);
+  core::EncodeFixed64(header + kStringsSizeOffset, strings_size);
+
+  uint8_t* tags = reinterpret_cast<uint8_t*>(&image[tags_offset]);
+  uint64_t key_offset = 0;
+  for (const auto& entry : entries) {
+    const StringPiece key = entry.first;
+    if (key.size() > kMaxKeyLength) {
+      return errors::InvalidArgument("Key of ", key.size(),
+                                     " bytes is too long.");
+    }
+    const uint64_t hash = Hash64(key.data(), key.size());
+    uint64_t group = HashGroup(hash, num_groups);
+    uint32_t empty;
+    while ((empty = MatchTag(tags + group * kGroupSize, 0)) == 0) {
+      group = (group + 1) & (num_groups - 1);
+    }
+    const uint64_t slot = group * kGroupSize + absl::countr_zero(empty);
+    tags[slot] = HashTag(hash);
+    char* slot_entry = &image[entries_offset + slot * kEntrySize];
+    core::EncodeFixed64(slot_entry,
+                        key_offset | (key.size() << kKeyOffsetBits));
+    core::EncodeFixed64(slot_entry + 8, static_cast<uint64_t>(entry.second));
+    memcpy(&image[strings_offset + key_offset], key.data(), key.size());
+    key_offset += key.size();
+  }
+
+  string tmp_filename = filename;
+  if (!env->CreateUniqueFileName(&tmp_filename, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            filename);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_filename, image));
+  Status s = env->RenameFile(tmp_filename, filename);
+  if (!s.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return s;
+}
+
+}  // namespace lookup
+}  // namespace tensorflow
@@ -0,0 +1,113 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_STATIC_HASH_TABLE_IMAGE_H_
+#define TENSORFLOW_CORE_KERNELS_STATIC_HASH_TABLE_IMAGE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// A file image of an immutable hash table from strings to int64 values,
+// which is generated offline and memory mapped by the processes that look
+// keys up in it. All the processes of a host mapping the same image share its
+// pages through the page cache, instead of each building its own table.
+//
+// The image is an open addressing hash table. Its slots are divided in groups
+// of kGroupSize, and every slot has a one byte tag, which is zero for empty
+// slots and otherwise holds seven bits of the hash of the key. The tags of a
+// group fill a 16 byte block of a cache line, so that a lookup compares the
+// tags of a whole group at once with SIMD instructions, and only reads the
+// keys of the slots whose tags match.
+//
+// All the numbers are little-endian. The image starts with a 64 byte header
+// followed by the tags, the entries and the strings regions, each aligned to
+// 64 bytes:
+//   header:  "TFSHTBL1", version (uint32), unused (uint32), the number of
+//            entries and of groups, and the offsets of the tags, entries and
+//            strings regions and the size of the strings region (uint64).
+//   tags:    kGroupSize tags per group.
+//   entries: for every slot, the offset of its key in the strings region in
+//            the low 40 bits and its length in the high 24 bits (uint64),
+//            and its value (int64).
+//   strings: the keys.
+class StaticHashTableImage {
+ public:
+  static constexpr int kGroupSize = 16;
+
+  // Opens the image in `filename`. The file is memory mapped if its file
+  // system supports it, and otherwise read in full.
+  static StatusOr<std::unique_ptr<StaticHashTableImage>> Open(
+      Env* env, const string& filename);
+
+  // Sets `value` to the value of `key` and returns true if the table has
+  // `key`, and returns false otherwise.
+  bool Find(StringPiece key, int64_t* value) const;
+
+  // Returns the number of entries of the table.
+  int64_t size() const { return num_entries_; }
+
+  // Returns the size of the image in bytes.
+  uint64_t image_size() const { return image_.size(); }
+
+  // Calls `fn(key, value)` for every entry of the table.
+  template <typename Fn>
+  void ForEach(Fn fn) const {
+    for (uint64_t slot = 0; slot < num_groups_ * kGroupSize; ++slot) {
+      if (tags_[slot] != 0) fn(Key(slot), Value(slot));
+    }
+  }
+
+ private:
+  StaticHashTableImage() = default;
+
+  Status Init();
+  StringPiece Key(uint64_t slot) const;
+  int64_t Value(uint64_t slot) const;
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  // The contents of the file, if it is not memory mapped.
+  string buffer_;
+  StringPiece image_;
+  uint64_t num_entries_ = 0;
+  uint64_t num_groups_ = 0;
+  const uint8_t* tags_ = nullptr;
+  const char* entries_ = nullptr;
+  StringPiece strings_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticHashTableImage);
+};
+
+// Writes the image of the table mapping `keys[i]` to `values[i]` to
+// `filename`. The image is written to a temporary file and then renamed, so
+// processes never map a partial image. Returns InvalidArgument if a key has
+// several different values.
+Status WriteStaticHashTableImage(Env* env, const string& filename,
+                                 const std::vector<StringPiece>& keys,
+                                 const std::vector<int64_t>& values);
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_STATIC_HASH_TABLE_IMAGE_H_
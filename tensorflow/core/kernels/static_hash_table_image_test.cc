@@ -0,0 +1,114 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/static_hash_table_image.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+string ImageFilename(const string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+TEST(StaticHashTableImageTest, FindsAllKeys) {
+  constexpr int kNumKeys = 10000;
+  std::vector<string> key_strings;
+  std::vector<int64_t> values;
+  for (int i = 0; i < kNumKeys; ++i) {
+    key_strings.push_back(strings::StrCat("key_", i));
+    values.push_back(3 * i - 7);
+  }
+  // The empty string is a valid key.
+  key_strings.push_back("");
+  values.push_back(42);
+  const std::vector<StringPiece> keys(key_strings.begin(), key_strings.end());
+  const string filename = ImageFilename("find_all_keys.img");
+  TF_ASSERT_OK(
+      WriteStaticHashTableImage(Env::Default(), filename, keys, values));
+
+  auto image = StaticHashTableImage::Open(Env::Default(), filename);
+  TF_ASSERT_OK(image.status());
+  EXPECT_EQ((*image)->size(), kNumKeys + 1);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    int64_t value;
+    ASSERT_TRUE((*image)->Find(keys[i], &value)) << keys[i];
+    EXPECT_EQ(value, values[i]);
+  }
+  int64_t value;
+  EXPECT_FALSE((*image)->Find("key_-1", &value));
+  EXPECT_FALSE((*image)->Find(strings::StrCat("key_", kNumKeys), &value));
+
+  std::map<string, int64_t> entries;
+  (*image)->ForEach([&](StringPiece key, int64_t value) {
+    entries.emplace(string(key), value);
+  });
+  EXPECT_EQ(entries.size(), keys.size());
+  EXPECT_EQ(entries["key_5"], 8);
+}
+
+TEST(StaticHashTableImageTest, EmptyTable) {
+  const string filename = ImageFilename("empty.img");
+  TF_ASSERT_OK(WriteStaticHashTableImage(Env::Default(), filename, {}, {}));
+  auto image = StaticHashTableImage::Open(Env::Default(), filename);
+  TF_ASSERT_OK(image.status());
+  EXPECT_EQ((*image)->size(), 0);
+  int64_t value;
+  EXPECT_FALSE((*image)->Find("key", &value));
+}
+
+TEST(StaticHashTableImageTest, DuplicateKeys) {
+  const string filename = ImageFilename("duplicate_keys.img");
+  TF_EXPECT_OK(WriteStaticHashTableImage(Env::Default(), filename,
+                                         {"a", "b", "a"}, {1, 2, 1}));
+  Status s = WriteStaticHashTableImage(Env::Default(), filename,
+                                       {"a", "b", "a"}, {1, 2, 3});
+  EXPECT_EQ(s.code(), error::INVALID_ARGUMENT);
+}
+
+TEST(StaticHashTableImageTest, InvalidImage) {
+  const string filename = ImageFilename("invalid.img");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 string(128, 'x')));
+  EXPECT_EQ(StaticHashTableImage::Open(Env::Default(), filename)
+                .status()
+                .code(),
+            error::DATA_LOSS);
+
+  // Truncates a valid image.
+  TF_ASSERT_OK(WriteStaticHashTableImage(Env::Default(), filename,
+                                         {"a", "b"}, {1, 2}));
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 contents.substr(0, contents.size() / 2)));
+  EXPECT_EQ(StaticHashTableImage::Open(Env::Default(), filename)
+                .status()
+                .code(),
+            error::DATA_LOSS);
+}
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
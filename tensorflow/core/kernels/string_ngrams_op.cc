@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace text {
@@ -127,42 +128,6 @@ class StringNGramsOp : public tensorflow::OpKernel {
         num_ngrams += ngrams_or.value();
       }
       if (preserve_short_ && length > 0 && num_ngrams == 0) {
-        num_ngrams = 1;
-      }
-      ngrams_splits_data[i] = ngrams_splits_data[i - 1] + num_ngrams;
-    }
-
-    tensorflow::Tensor* ngrams;
-    OP_REQUIRES_OK(
-        context,
-        context->allocate_output(
-            0, TensorShape({ngrams_splits_data[num_batch_items]}), &ngrams));
-    auto ngrams_data = ngrams->flat<tstring>().data();
-
-    for (int i = 0; i < num_batch_items; ++i) {
-      auto data_start = &input_data[splits_vec(i)];
-      int output_start_idx = ngrams_splits_data[i];
-      for (int ngram_width : ngram_widths_) {
-        auto output_start = &ngrams_data[output_start_idx];
-        int length = splits_vec(i + 1) - splits_vec(i);
-        auto ngrams_or = get_num_ngrams(length, ngram_width);
-        OP_REQUIRES_OK(context, ngrams_or.status());
-        int num_ngrams = ngrams_or.value();
-        CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
-        output_start_idx += num_ngrams;
-      }
-      // If we're preserving short sequences, check to see if no sequence was
-      // generated by comparing the current output start idx to the original
-      // one (ngram_splits_data). If no ngrams were generated, then they will
-      // be equal (since we increment output_start_idx by num_ngrams every
-      // time we create a set of ngrams.)
-      if (preserve_short_ && output_start_idx == ngrams_splits_data[i]) {
-        int data_length = splits_vec(i + 1) - splits_vec(i);
-        // One legitimate reason to not have any ngrams when preserve_short_
-        // is true is if the sequence itself is empty. In that case, move on.
-        if (data_length == 0) {
-          continue;
-        }
         // We don't have to worry about dynamic padding sizes here: if padding
         // was dynamic, every sequence would have had sufficient padding to
         // generate at least one ngram.
@@ -176,12 +141,61 @@ class StringNGramsOp : public tensorflow::OpKernel {
                                     "preserve_short_sequences is True and "
                                     "ngram_widths are not provided, got ",
                                     pad_width_));
-        int ngram_width = data_length + 2 * pad_width_;
-        auto output_start = &ngrams_data[output_start_idx];
-        int num_ngrams = 1;
-        CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
+        num_ngrams = 1;
+      }
+      ngrams_splits_data[i] = ngrams_splits_data[i - 1] + num_ngrams;
+    }
+
+    tensorflow::Tensor* ngrams;
+    OP_REQUIRES_OK(
+        context,
+        context->allocate_output(
+            0, TensorShape({ngrams_splits_data[num_batch_items]}), &ngrams));
+    auto ngrams_data = ngrams->flat<tstring>().data();
+
+    // The ngrams of every batch item are created independently, and so are
+    // sharded over the batch items. The lengths and ngram widths have been
+    // validated above.
+    auto create_ngrams = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        auto data_start = &input_data[splits_vec(i)];
+        int output_start_idx = ngrams_splits_data[i];
+        const int length = splits_vec(i + 1) - splits_vec(i);
+        for (int ngram_width : ngram_widths_) {
+          auto output_start = &ngrams_data[output_start_idx];
+          int num_ngrams = get_num_ngrams(length, ngram_width).value();
+          CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
+          output_start_idx += num_ngrams;
+        }
+        // If we're preserving short sequences, check to see if no sequence was
+        // generated by comparing the current output start idx to the original
+        // one (ngram_splits_data). If no ngrams were generated, then they will
+        // be equal (since we increment output_start_idx by num_ngrams every
+        // time we create a set of ngrams.)
+        if (preserve_short_ && output_start_idx == ngrams_splits_data[i]) {
+          // One legitimate reason to not have any ngrams when preserve_short_
+          // is true is if the sequence itself is empty. In that case, move on.
+          if (length == 0) {
+            continue;
+          }
+          int ngram_width = length + 2 * pad_width_;
+          auto output_start = &ngrams_data[output_start_idx];
+          int num_ngrams = 1;
+          CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
+        }
       }
+    };
+    const int64_t num_ngrams = ngrams_splits_data[num_batch_items];
+    int max_ngram_width = 1;
+    for (int ngram_width : ngram_widths_) {
+      max_ngram_width = std::max(max_ngram_width, ngram_width);
     }
+    // Appending a token of a few bytes to an ngram costs about 10 cycles.
+    const int64_t cost_per_item =
+        (num_ngrams / num_batch_items + 1) * max_ngram_width * 10;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          num_batch_items, cost_per_item, create_ngrams);
   }
 
   void CreateNgrams(const tstring* data, tstring* output, int num_ngrams,
@@ -15,8 +15,10 @@ limitations under the License.
 
 // See docs in ../ops/string_ops.cc.
 
+#include <cstring>
 #include <string>
 
+#include "absl/strings/ascii.h"
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -24,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -99,8 +102,27 @@ std::vector<StringPiece> Split(const tstring& str, const tstring& delimiter,
   return SplitOnCharSet(str, delimiter, predicate);
 }
 
-std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
-                                 int maxsplit) {
+// Returns the length of the longest prefix of `text` without ASCII whitespace.
+// As whitespace characters are all below 0x21, the text is first skipped 8
+// bytes at a time while none of them is.
+size_t NonWhitespacePrefixLength(StringPiece text) {
+  constexpr uint64 kOnes = 0x0101010101010101ULL;
+  size_t i = 0;
+  for (; i + sizeof(uint64) <= text.size(); i += sizeof(uint64)) {
+    uint64 word;
+    memcpy(&word, text.data() + i, sizeof(word));
+    // Nonzero iff a byte of the word is below 0x21.
+    if (((word - 0x21 * kOnes) & ~word & (0x80 * kOnes)) != 0) break;
+  }
+  while (i < text.size() && !absl::ascii_isspace(text[i])) ++i;
+  return i;
+}
+
+// Calls `callback` with every token of `str`, in order. The tokens are valid as
+// long as `str` is.
+template <typename Callback>
+void SplitV2(const tstring& str, StringPiece sep, int maxsplit,
+             Callback callback) {
   // This SplitV2 method matches the behavior of python's str.split:
   //   If sep is given, consecutive delimiters are not grouped together
   //   and are deemed to delimit empty strings (for example, '1,,2'.split(',')
@@ -115,46 +137,44 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
   //   splitting an empty string or a string consisting of just whitespace
   //   with a None separator returns [].
 
-  std::vector<StringPiece> result;
-
   StringPiece text(str);
   if (maxsplit == 0) {
-    result.emplace_back(text);
-    return result;
+    callback(text);
+    return;
   }
 
   if (sep.empty()) {
-    StringPiece token;
     // Remove leading whitespaces.
     str_util::RemoveLeadingWhitespace(&text);
     int split = 0;
-    while (str_util::ConsumeNonWhitespace(&text, &token)) {
-      result.push_back(token);
+    while (!text.empty()) {
+      const size_t token_size = NonWhitespacePrefixLength(text);
+      callback(text.substr(0, token_size));
+      text.remove_prefix(token_size);
       str_util::RemoveLeadingWhitespace(&text);
       ++split;
       if (maxsplit > 0 && split == maxsplit) {
-        result.push_back(text);
-        return result;
+        callback(text);
+        return;
       }
     }
-    return result;
+    return;
   }
   auto p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
   int split = 0;
   while (p != text.end()) {
     StringPiece token = text.substr(0, p - text.begin());
-    result.push_back(token);
+    callback(token);
     text.remove_prefix(token.size());
     text.remove_prefix(sep.size());
     ++split;
     if (maxsplit > 0 && split == maxsplit) {
-      result.push_back(StringPiece(text));
-      return result;
+      callback(StringPiece(text));
+      return;
     }
     p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
   }
-  result.push_back(text);
-  return result;
+  callback(text);
 }
 
 }  // namespace
@@ -263,21 +283,29 @@ class StringSplitV2Op : public OpKernel {
                                         sep_tensor->shape().DebugString()));
     const auto sep_vec = sep_tensor->flat<tstring>();
     StringPiece sep(sep_vec(0));
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
+
+    // The strings are split twice, in parallel: first to count their tokens,
+    // and then to copy the tokens to the outputs.
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    std::vector<int64_t> num_indices(batch_size);
+    auto count_tokens = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        int64_t n_entries = 0;
+        SplitV2(input_vec(i), sep, maxsplit_,
+                [&n_entries](StringPiece) { ++n_entries; });
+        num_indices[i] = n_entries;
+      }
+    };
+    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+          kCostPerString, count_tokens);
 
     int64_t output_size = 0;
     int64_t max_num_entries = 0;
-    std::vector<int64_t> num_indices(batch_size);
+    std::vector<int64_t> first_indices(batch_size);
     for (int64_t i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64_t n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
-      max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
+      first_indices[i] = output_size;
+      output_size += num_indices[i];
+      max_num_entries = std::max(max_num_entries, num_indices[i]);
     }
 
     Tensor* sp_indices_t;
@@ -294,18 +322,25 @@ class StringSplitV2Op : public OpKernel {
     auto sp_shape = sp_shape_t->vec<int64_t>();
     sp_shape(0) = batch_size;
     sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
+    auto copy_tokens = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        int64_t c = first_indices[i];
+        int64_t j = 0;
+        SplitV2(input_vec(i), sep, maxsplit_, [&](StringPiece token) {
+          sp_indices(c, 0) = i;
+          sp_indices(c, 1) = j++;
+          sp_tokens(c++).assign(token.data(), token.size());
+        });
       }
-    }
+    };
+    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+          2 * kCostPerString, copy_tokens);
   }
 
  private:
+  // The cost of splitting a string of a few dozen bytes.
+  static constexpr int64_t kCostPerString = 200;
+
   int maxsplit_;
 };
 
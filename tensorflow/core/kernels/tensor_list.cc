@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/tensor_list.h"
 
+#include <cstring>
+
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
@@ -96,6 +98,45 @@ bool TensorList::Decode(const VariantTensorData& data) {
   return true;
 }
 
+bool TensorList::PushBackIntoBuffer(const Tensor& t) {
+  Tensor& buffer = tensors_->buffer_;
+  const int64_t row = tensors().size();
+  if (!buffer.IsInitialized() || row != tensors_->num_buffer_rows_written_ ||
+      row >= buffer.dim_size(0) || t.dtype() != buffer.dtype()) {
+    return false;
+  }
+  Tensor element = buffer.SubSlice(row);
+  if (element.shape() != t.shape()) {
+    return false;
+  }
+  const StringPiece data = t.tensor_data();
+  std::memcpy(const_cast<char*>(element.tensor_data().data()), data.data(),
+              data.size());
+  tensors().push_back(std::move(element));
+  ++tensors_->num_buffer_rows_written_;
+  return true;
+}
+
+bool TensorList::GetBufferView(int64_t begin, int64_t end,
+                               Tensor* view) const {
+  const Tensor& buffer = tensors_->buffer_;
+  if (!buffer.IsInitialized() || begin < 0 || begin >= end ||
+      end > tensors().size() || end > tensors_->num_buffer_rows_written_) {
+    return false;
+  }
+  const char* base = buffer.tensor_data().data();
+  const size_t row_bytes = buffer.TotalBytes() / buffer.dim_size(0);
+  for (int64_t i = begin; i < end; ++i) {
+    const Tensor& t = tensors()[i];
+    if (t.dtype() != buffer.dtype() ||
+        t.tensor_data().data() != base + i * row_bytes) {
+      return false;
+    }
+  }
+  *view = buffer.Slice(begin, end);
+  return true;
+}
+
 const char TensorList::kTypeName[] = "tensorflow::TensorList";
 
 }  // namespace tensorflow
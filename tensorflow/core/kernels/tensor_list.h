@@ -48,6 +48,11 @@ namespace tensorflow {
 // in the original.  To truly perform a deep copy, Device and Type-specific
 // code needs to be applied to the underlying tensors as usual.
 //
+// A list may store its elements in the rows of a contiguous host buffer,
+// written in place by PushBackIntoBuffer, so that stacking the list doesn't
+// copy them. Each row is written at most once, so the elements and the views
+// of the buffer handed out never change. Copies don't share the buffer.
+//
 // The most important implication of RefCounted TLs is that OpKernels
 // wishing to reuse TensorList inputs as outputs via context->forward_input()
 // need to perform an additional check on the refcount of the TensorList,
@@ -141,10 +146,34 @@ class TensorList {
   // container?
   bool RefCountIsOne() const { return tensors_->RefCountIsOne(); }
 
+  // Sets the buffer the elements are pushed into, of shape
+  // [max_num_elements] + element shape. The rows must be aligned and the dtype
+  // must be copyable with memcpy.
+  void SetBuffer(Tensor buffer) {
+    tensors_->buffer_ = std::move(buffer);
+    tensors_->num_buffer_rows_written_ = 0;
+  }
+
+  bool HasBuffer() const { return tensors_->buffer_.IsInitialized(); }
+
+  // Appends a copy of `t` written into the next row of the buffer. Returns
+  // false without modifying the list if there is no such row, e.g. because
+  // it was written before elements were popped, or if `t` doesn't fit it.
+  bool PushBackIntoBuffer(const Tensor& t);
+
+  // Returns in `view` the rows of the buffer holding the elements in
+  // [begin, end), if that range is not empty and the elements are the rows of
+  // the buffer with the same indices.
+  bool GetBufferView(int64_t begin, int64_t end, Tensor* view) const;
+
  private:
   class Tensors : public core::RefCounted {
    public:
     std::vector<Tensor> values_;
+    // Optional contiguous storage of the elements.
+    Tensor buffer_;
+    // Number of rows of `buffer_` written so far.
+    int64_t num_buffer_rows_written_ = 0;
   };
   Tensors* tensors_;
 };
@@ -20,8 +20,12 @@ limitations under the License.
 #include "tensorflow/core/kernels/topk_op.h"
 
 #include <algorithm>
+#include <functional>
 #include <numeric>
+#include <type_traits>
+#include <utility>
 #include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -29,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/gtl/top_n.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
@@ -36,6 +41,228 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Rows of at least this many columns are handled by radix selection (or radix
+// sort if k == num_cols) rather than a TopN heap, when they are too few to
+// keep the threads busy, or when k is at least 1 / kRadixTopKMaxColsPerK of
+// the columns. With a smaller k, the heap mostly compares values to its
+// smallest one, which is faster than the passes of radix selection.
+constexpr int64_t kRadixTopKMinCols = 1 << 14;
+constexpr int64_t kRadixTopKMaxColsPerK = 512;
+
+// Maps values of T to unsigned keys of the same order, with RadixKey<T>::Get.
+template <typename T, typename Enable = void>
+struct RadixKey;
+
+template <typename T>
+struct RadixKey<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+  using type = typename std::make_unsigned<T>::type;
+  static type Get(T value) {
+    // Flips the sign bit, so that the negative values come first.
+    constexpr type kSignBit =
+        std::is_signed<T>::value ? type(type(1) << (8 * sizeof(T) - 1)) : 0;
+    return static_cast<type>(value) ^ kSignBit;
+  }
+};
+
+template <typename T, typename Bits>
+struct FloatRadixKey {
+  using type = Bits;
+  static type Get(T value) {
+    // -0 and 0 compare equal, so they get the same key.
+    if (value == T(0)) value = T(0);
+    const Bits bits = Eigen::numext::bit_cast<Bits>(value);
+    constexpr int kSignShift = 8 * sizeof(Bits) - 1;
+    // Sets the sign bit of positive values, and flips all the bits of
+    // negative ones to order them by decreasing magnitude.
+    const Bits flip = Bits(Bits(0) - Bits(bits >> kSignShift)) |
+                      Bits(Bits(1) << kSignShift);
+    return bits ^ flip;
+  }
+};
+
+template <>
+struct RadixKey<float> : FloatRadixKey<float, uint32> {};
+template <>
+struct RadixKey<double> : FloatRadixKey<double, uint64> {};
+template <>
+struct RadixKey<Eigen::half> : FloatRadixKey<Eigen::half, uint16> {};
+template <>
+struct RadixKey<bfloat16> : FloatRadixKey<bfloat16, uint16> {};
+
+constexpr int kRadixDigitBits = 8;
+constexpr int kRadixNumDigits = 1 << kRadixDigitBits;
+
+// Writes to `indices` the indices of the k < num_cols largest values of
+// `input`, in increasing order of index, or by decreasing value if `sorted`.
+// As with the TopN heap, equal values are taken and ordered by increasing
+// index. The passes over the whole row are split into `num_chunks` chunks,
+// which `for_each_chunk(fn)` runs as fn(0) ... fn(num_chunks - 1).
+template <typename T, typename ForEachChunk>
+void RadixTopKRow(const T* input, int64_t num_cols, int k, bool sorted,
+                  int num_chunks, const ForEachChunk& for_each_chunk,
+                  int32* indices) {
+  using Key = typename RadixKey<T>::type;
+  constexpr int kKeyBits = 8 * sizeof(Key);
+  const auto chunk_begin = [num_cols, num_chunks](int c) {
+    return num_cols * c / num_chunks;
+  };
+
+  // Counts the most significant digits of the keys.
+  int shift = kKeyBits - kRadixDigitBits;
+  std::vector<int64_t> chunk_counts(num_chunks * kRadixNumDigits);
+  for_each_chunk([&](int c) {
+    int64_t* counts = &chunk_counts[c * kRadixNumDigits];
+    const int64_t end = chunk_begin(c + 1);
+    for (int64_t i = chunk_begin(c); i < end; ++i) {
+      ++counts[RadixKey<T>::Get(input[i]) >> shift];
+    }
+  });
+  std::vector<int64_t> counts(kRadixNumDigits);
+  for (int c = 0; c < num_chunks; ++c) {
+    for (int d = 0; d < kRadixNumDigits; ++d) {
+      counts[d] += chunk_counts[c * kRadixNumDigits + d];
+    }
+  }
+
+  // Finds the most significant digit of the k-th largest key. `remaining` is
+  // the number of the k largest keys among those with the digits found so
+  // far, the others having larger digits.
+  int64_t remaining = k;
+  int digit = kRadixNumDigits - 1;
+  for (; counts[digit] < remaining; --digit) remaining -= counts[digit];
+
+  // Gathers the keys with this digit or a larger one, in order of index. Each
+  // chunk writes its keys after those counted for the chunks before it.
+  std::vector<int64_t> chunk_offsets(num_chunks + 1);
+  for (int c = 0; c < num_chunks; ++c) {
+    int64_t count = 0;
+    for (int d = digit; d < kRadixNumDigits; ++d) {
+      count += chunk_counts[c * kRadixNumDigits + d];
+    }
+    chunk_offsets[c + 1] = chunk_offsets[c] + count;
+  }
+  const int64_t num_candidates = chunk_offsets[num_chunks];
+  std::vector<int32> candidates(num_candidates);
+  std::vector<Key> candidate_keys(num_candidates);
+  for_each_chunk([&](int c) {
+    int64_t j = chunk_offsets[c];
+    const int64_t end = chunk_begin(c + 1);
+    for (int64_t i = chunk_begin(c); i < end; ++i) {
+      const Key key = RadixKey<T>::Get(input[i]);
+      if ((key >> shift) >= digit) {
+        candidates[j] = i;
+        candidate_keys[j] = key;
+        ++j;
+      }
+    }
+  });
+
+  // Finds the other digits of the k-th largest key among the candidates.
+  Key threshold = Key(Key(digit) << shift);
+  while (shift > 0) {
+    const Key mask = Key(Key(~Key(0)) << shift);
+    shift -= kRadixDigitBits;
+    std::fill(counts.begin(), counts.end(), 0);
+    for (const Key key : candidate_keys) {
+      if ((key & mask) == threshold) {
+        ++counts[(key >> shift) & (kRadixNumDigits - 1)];
+      }
+    }
+    digit = kRadixNumDigits - 1;
+    for (; counts[digit] < remaining; --digit) remaining -= counts[digit];
+    threshold |= Key(Key(digit) << shift);
+  }
+
+  // Takes the candidates above the k-th largest key, and the first
+  // `remaining` ones equal to it.
+  std::vector<std::pair<Key, int32>> top_k;
+  top_k.reserve(k);
+  for (int64_t j = 0; j < num_candidates; ++j) {
+    const Key key = candidate_keys[j];
+    if (key > threshold || (key == threshold && remaining-- > 0)) {
+      top_k.emplace_back(key, candidates[j]);
+    }
+  }
+  if (sorted) {
+    std::sort(top_k.begin(), top_k.end(),
+              [](const std::pair<Key, int32>& a,
+                 const std::pair<Key, int32>& b) {
+                return a.first > b.first ||
+                       (a.first == b.first && a.second < b.second);
+              });
+  }
+  for (int i = 0; i < k; ++i) indices[i] = top_k[i].second;
+}
+
+// Writes to `indices` the indices of all the values of `input`, by decreasing
+// value and then increasing index, with a least significant digit radix sort.
+// The chunks are as in RadixTopKRow.
+template <typename T, typename ForEachChunk>
+void RadixSortRow(const T* input, int64_t num_cols, int num_chunks,
+                  const ForEachChunk& for_each_chunk, int32* indices) {
+  using Key = typename RadixKey<T>::type;
+  constexpr int kKeyBits = 8 * sizeof(Key);
+  const auto chunk_begin = [num_cols, num_chunks](int c) {
+    return num_cols * c / num_chunks;
+  };
+
+  // Sorts the complemented keys in increasing order, which is stable.
+  std::vector<Key> keys(num_cols), next_keys(num_cols);
+  std::vector<int32> next_indices(num_cols);
+  for_each_chunk([&](int c) {
+    const int64_t end = chunk_begin(c + 1);
+    for (int64_t i = chunk_begin(c); i < end; ++i) {
+      keys[i] = ~RadixKey<T>::Get(input[i]);
+      indices[i] = i;
+    }
+  });
+  int32* from = indices;
+  int32* to = next_indices.data();
+  std::vector<int64_t> offsets(num_chunks * kRadixNumDigits);
+  for (int shift = 0; shift < kKeyBits; shift += kRadixDigitBits) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+    for_each_chunk([&](int c) {
+      int64_t* counts = &offsets[c * kRadixNumDigits];
+      const int64_t end = chunk_begin(c + 1);
+      for (int64_t i = chunk_begin(c); i < end; ++i) {
+        ++counts[(keys[i] >> shift) & (kRadixNumDigits - 1)];
+      }
+    });
+    // Each chunk scatters its keys of a digit after those of the chunks
+    // before it. A pass where all the keys have the same digit is skipped.
+    bool all_same_digit = false;
+    int64_t offset = 0;
+    for (int d = 0; d < kRadixNumDigits; ++d) {
+      for (int c = 0; c < num_chunks; ++c) {
+        const int64_t count = offsets[c * kRadixNumDigits + d];
+        offsets[c * kRadixNumDigits + d] = offset;
+        offset += count;
+      }
+      if (offset == num_cols && offsets[d] == 0) {
+        all_same_digit = true;
+        break;
+      }
+    }
+    if (all_same_digit) continue;
+    for_each_chunk([&](int c) {
+      int64_t* next = &offsets[c * kRadixNumDigits];
+      const int64_t end = chunk_begin(c + 1);
+      for (int64_t i = chunk_begin(c); i < end; ++i) {
+        const int64_t j = next[(keys[i] >> shift) & (kRadixNumDigits - 1)]++;
+        next_keys[j] = keys[i];
+        to[j] = from[i];
+      }
+    });
+    keys.swap(next_keys);
+    std::swap(from, to);
+  }
+  if (from != indices) std::copy(from, from + num_cols, indices);
+}
+
+}  // namespace
+
 template <typename Device, typename T>
 class TopK : public OpKernel {
  public:
@@ -141,6 +368,63 @@ struct TopKFunctor<CPUDevice, T> {
       return OkStatus();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    if (num_cols >= kRadixTopKMinCols &&
+        (num_rows < worker_threads.num_threads ||
+         k * kRadixTopKMaxColsPerK >= num_cols)) {
+      auto RadixTopKIndices = [&](int64_t start_batch, int64_t limit_batch,
+                                  int num_chunks, const auto& for_each_chunk) {
+        for (int64_t b = start_batch; b < limit_batch; ++b) {
+          if (k == num_cols) {
+            RadixSortRow(&input(b, 0), num_cols, num_chunks, for_each_chunk,
+                         &indices(b, 0));
+          } else {
+            RadixTopKRow(&input(b, 0), num_cols, k, sorted, num_chunks,
+                         for_each_chunk, &indices(b, 0));
+          }
+          std::transform(
+              &indices(b, 0), &indices(b, k), &values(b, 0),
+              [b, &input](const int32_t loc) { return input(b, loc); });
+        }
+      };
+      if (num_rows < worker_threads.num_threads) {
+        // Too few rows to keep the threads busy, so each row is split into
+        // chunks of at least kRadixTopKMinCols columns instead.
+        const int num_chunks = static_cast<int>(std::min<int64_t>(
+            worker_threads.num_threads, num_cols / kRadixTopKMinCols));
+        auto for_each_chunk = [&worker_threads, num_chunks](
+                                  const std::function<void(int)>& fn) {
+          worker_threads.workers->ParallelFor(
+              num_chunks,
+              thread::ThreadPool::SchedulingParams(
+                  thread::ThreadPool::SchedulingStrategy::kFixedBlockSize,
+                  absl::nullopt /* cost_per_unit */, 1 /* block_size */),
+              [&fn](int64_t begin, int64_t end) {
+                for (int64_t c = begin; c < end; ++c) {
+                  fn(static_cast<int>(c));
+                }
+              });
+        };
+        RadixTopKIndices(0, num_rows, num_chunks, for_each_chunk);
+      } else {
+        auto for_each_chunk = [](const std::function<void(int)>& fn) {
+          fn(0);
+        };
+        // A few passes over the row, each of a few operations per column.
+        const double radix_cost =
+            static_cast<double>(num_cols) * (2 + sizeof(T)) *
+                (3 * Eigen::TensorOpCost::AddCost<int32>() +
+                 Eigen::TensorOpCost::AddCost<T>()) +
+            2 * k * Eigen::TensorOpCost::AddCost<T>();
+        Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+              static_cast<int64_t>(radix_cost),
+              [&](int64_t start_batch, int64_t limit_batch) {
+                RadixTopKIndices(start_batch, limit_batch, 1, for_each_chunk);
+              });
+      }
+      return OkStatus();
+    }
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
@@ -228,7 +512,6 @@ struct TopKFunctor<CPUDevice, T> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
@@ -17,7 +17,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -847,6 +849,105 @@ struct ApplyAdamNonCuda {
 template <typename T>
 struct ApplyAdam<CPUDevice, T> : ApplyAdamNonCuda<CPUDevice, T> {};
 
+template <typename T, typename Tindex>
+struct SparseApplyAdam<CPUDevice, T, Tindex> {
+  Status operator()(const CPUDevice& d, typename TTypes<T>::Matrix var,
+                    typename TTypes<T>::Matrix m, typename TTypes<T>::Matrix v,
+                    typename TTypes<T>::ConstScalar beta1_power,
+                    typename TTypes<T>::ConstScalar beta2_power,
+                    typename TTypes<T>::ConstScalar lr,
+                    typename TTypes<T>::ConstScalar beta1,
+                    typename TTypes<T>::ConstScalar beta2,
+                    typename TTypes<T>::ConstScalar epsilon,
+                    typename TTypes<T>::ConstMatrix grad,
+                    typename TTypes<Tindex>::ConstVec indices,
+                    bool use_nesterov) {
+    const Tindex N = static_cast<Tindex>(indices.dimension(0));
+    if (N == 0) return OkStatus();
+    const Tindex first_dim_size = static_cast<Tindex>(var.dimension(0));
+    const Index inner_dim = var.dimension(1);
+
+    // Numbers the unique indices in order of first occurrence.
+    absl::flat_hash_map<Tindex, Tindex> unique_ids;
+    unique_ids.reserve(N);
+    std::vector<Tindex> unique_indices;
+    std::vector<Tindex> unique_id_of_row(N);
+    for (Tindex i = 0; i < N; ++i) {
+      const Tindex index = internal::SubtleMustCopy(indices(i));
+      if (!FastBoundsCheck(index, first_dim_size)) {
+        return errors::InvalidArgument(
+            strings::StrCat("Index ", index, " at offset ", i,
+                            " in indices is out of range"));
+      }
+      auto it = unique_ids.emplace(index, unique_indices.size());
+      if (it.second) unique_indices.push_back(index);
+      unique_id_of_row[i] = it.first->second;
+    }
+    const Tindex num_unique = static_cast<Tindex>(unique_indices.size());
+
+    // Groups the rows of grad by unique index: the rows of the u-th unique
+    // index are rows[row_begin[u]] to rows[row_begin[u + 1] - 1].
+    std::vector<Tindex> row_begin(num_unique + 1, 0);
+    for (Tindex i = 0; i < N; ++i) ++row_begin[unique_id_of_row[i] + 1];
+    for (Tindex u = 0; u < num_unique; ++u) row_begin[u + 1] += row_begin[u];
+    std::vector<Tindex> rows(N);
+    {
+      std::vector<Tindex> next(row_begin.begin(), row_begin.end() - 1);
+      for (Tindex i = 0; i < N; ++i) rows[next[unique_id_of_row[i]]++] = i;
+    }
+
+    const T alpha = lr() * Eigen::numext::sqrt(T(1) - beta2_power()) /
+                    (T(1) - beta1_power());
+    const T beta1_scalar = beta1();
+    const T one_minus_beta1 = T(1) - beta1();
+    const T one_minus_beta2 = T(1) - beta2();
+    const T epsilon_scalar = epsilon();
+
+    // Sums the gradient of each unique index and updates its rows of var, m
+    // and v in the same pass.
+    auto shard = [&](Index start, Index end) {
+      std::vector<T> grad_sum;
+      for (Index u = start; u < end; ++u) {
+        const T* g = grad.data() + rows[row_begin[u]] * inner_dim;
+        if (row_begin[u + 1] - row_begin[u] > 1) {
+          grad_sum.assign(g, g + inner_dim);
+          for (Tindex k = row_begin[u] + 1; k < row_begin[u + 1]; ++k) {
+            const T* g_k = grad.data() + rows[k] * inner_dim;
+            for (Index j = 0; j < inner_dim; ++j) grad_sum[j] += g_k[j];
+          }
+          g = grad_sum.data();
+        }
+        const Index offset = unique_indices[u] * inner_dim;
+        T* var_row = var.data() + offset;
+        T* m_row = m.data() + offset;
+        T* v_row = v.data() + offset;
+        for (Index j = 0; j < inner_dim; ++j) {
+          m_row[j] += (g[j] - m_row[j]) * one_minus_beta1;
+          v_row[j] += (g[j] * g[j] - v_row[j]) * one_minus_beta2;
+          const T denom = Eigen::numext::sqrt(v_row[j]) + epsilon_scalar;
+          if (use_nesterov) {
+            var_row[j] -=
+                (g[j] * one_minus_beta1 + beta1_scalar * m_row[j]) * alpha /
+                denom;
+          } else {
+            var_row[j] -= m_row[j] * alpha / denom;
+          }
+        }
+      }
+    };
+
+    // Input data: var, m, v, grad. Output data: var, m, v.
+    const Eigen::TensorOpCost cost(
+        inner_dim * sizeof(T) * 4, inner_dim * sizeof(T) * 3,
+        inner_dim * (Eigen::TensorOpCost::AddCost<T>() * 7 +
+                     Eigen::TensorOpCost::MulCost<T>() * 5 +
+                     Eigen::TensorOpCost::DivCost<T>() * 2));
+    d.parallelFor(num_unique, cost, shard);
+
+    return OkStatus();
+  }
+};
+
 template <typename T>
 struct ApplyAdamWithAmsgrad<CPUDevice, T> {
   void operator()(const CPUDevice& d, typename TTypes<T>::Flat var,
@@ -3654,6 +3755,137 @@ REGISTER_KERNELS(GPU, complex128);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+// Note, this op works on cpu only.
+template <typename T, typename Tindex>
+class SparseApplyAdamOp : public OpKernel {
+ public:
+  explicit SparseApplyAdamOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
+    const bool sparse = true;
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        ctx, use_exclusive_lock_, sparse, {0, 1, 2});
+
+    Tensor var;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 0, use_exclusive_lock_, sparse, &var));
+    Tensor m;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 1, use_exclusive_lock_, sparse, &m));
+    Tensor v;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 2, use_exclusive_lock_, sparse, &v));
+    OP_REQUIRES(
+        ctx, var.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(0)));
+    OP_REQUIRES(
+        ctx, m.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(1)));
+    OP_REQUIRES(
+        ctx, v.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(2)));
+    OP_REQUIRES(ctx, var.shape().IsSameSize(m.shape()),
+                errors::InvalidArgument("var and m do not have the same shape",
+                                        var.shape().DebugString(), " ",
+                                        m.shape().DebugString()));
+    OP_REQUIRES(ctx, var.shape().IsSameSize(v.shape()),
+                errors::InvalidArgument("var and v do not have the same shape",
+                                        var.shape().DebugString(), " ",
+                                        v.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVectorOrHigher(var.shape()),
+                errors::InvalidArgument("var must be at least 1 dimensional"));
+
+    const Tensor& beta1_power = ctx->input(3);
+    const Tensor& beta2_power = ctx->input(4);
+    const Tensor& lr = ctx->input(5);
+    const Tensor& beta1 = ctx->input(6);
+    const Tensor& beta2 = ctx->input(7);
+    const Tensor& epsilon = ctx->input(8);
+
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1_power.shape()),
+                errors::InvalidArgument("beta1_power is not a scalar: ",
+                                        beta1_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2_power.shape()),
+                errors::InvalidArgument("beta2_power is not a scalar: ",
+                                        beta2_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar : ",
+                                        lr.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1.shape()),
+                errors::InvalidArgument("beta1 is not a scalar: ",
+                                        beta1.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2.shape()),
+                errors::InvalidArgument("beta2 is not a scalar: ",
+                                        beta2.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(epsilon.shape()),
+                errors::InvalidArgument("epsilon is not a scalar: ",
+                                        epsilon.shape().DebugString()));
+
+    const Tensor& grad = ctx->input(9);
+    const Tensor& indices = ctx->input(10);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices must be one-dimensional"));
+    OP_REQUIRES(ctx, grad.dims() == var.dims(),
+                errors::InvalidArgument(
+                    "var and grad must have the same rank: ",
+                    var.shape().DebugString(), " ", grad.shape().DebugString()));
+    for (int d = 1; d < var.dims(); d++) {
+      OP_REQUIRES(ctx, var.dim_size(d) == grad.dim_size(d),
+                  errors::InvalidArgument(strings::StrCat(
+                      "var and grad must match in dimension ", d)));
+    }
+    const Tindex N = indices.dim_size(0);
+    OP_REQUIRES(
+        ctx, grad.dim_size(0) == N,
+        errors::InvalidArgument(
+            "grad must be the same size as indices in the first dimension."));
+
+    if (N > 0 && var.NumElements() > 0) {
+      OP_REQUIRES_OK(
+          ctx, functor::SparseApplyAdam<CPUDevice, T, Tindex>()(
+                   ctx->eigen_device<CPUDevice>(), var.flat_outer_dims<T>(),
+                   m.flat_outer_dims<T>(), v.flat_outer_dims<T>(),
+                   beta1_power.scalar<T>(), beta2_power.scalar<T>(),
+                   lr.scalar<T>(), beta1.scalar<T>(), beta2.scalar<T>(),
+                   epsilon.scalar<T>(), grad.flat_outer_dims<T>(),
+                   indices.vec<Tindex>(), use_nesterov_));
+    }
+
+    MaybeForwardRefInputToRefOutput(ctx, 0, 0);
+  }
+
+ private:
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+#define REGISTER_KERNELS(T, Tindices)                                \
+  REGISTER_KERNEL_BUILDER(Name("SparseApplyAdam")                    \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("T")                \
+                              .TypeConstraint<Tindices>("Tindices"), \
+                          SparseApplyAdamOp<T, Tindices>);           \
+  REGISTER_KERNEL_BUILDER(Name("ResourceSparseApplyAdam")            \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("T")                \
+                              .TypeConstraint<Tindices>("Tindices"), \
+                          SparseApplyAdamOp<T, Tindices>);
+#define REGISTER_CPU_KERNELS(T) \
+  REGISTER_KERNELS(T, int32);   \
+  REGISTER_KERNELS(T, int64_t);
+
+TF_CALL_FLOAT_TYPES(REGISTER_CPU_KERNELS);
+TF_CALL_COMPLEX_TYPES(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 template <typename Device, typename T>
 class ApplyAdamWithAmsgradOp : public OpKernel {
  public:
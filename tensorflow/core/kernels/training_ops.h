@@ -245,6 +245,24 @@ struct ApplyAdam {
                   typename TTypes<T>::ConstFlat grad, bool use_nesterov);
 };
 
+template <typename Device, typename T, typename Tindex>
+struct SparseApplyAdam {
+  // Updates the rows of var, m and v at `indices`, summing the rows of `grad`
+  // of duplicate indices first. Returns an error if an index is out of range,
+  // before updating any row.
+  Status operator()(const Device& d, typename TTypes<T>::Matrix var,
+                    typename TTypes<T>::Matrix m, typename TTypes<T>::Matrix v,
+                    typename TTypes<T>::ConstScalar beta1_power,
+                    typename TTypes<T>::ConstScalar beta2_power,
+                    typename TTypes<T>::ConstScalar lr,
+                    typename TTypes<T>::ConstScalar beta1,
+                    typename TTypes<T>::ConstScalar beta2,
+                    typename TTypes<T>::ConstScalar epsilon,
+                    typename TTypes<T>::ConstMatrix grad,
+                    typename TTypes<Tindex>::ConstVec indices,
+                    bool use_nesterov);
+};
+
 template <typename Device, typename T>
 struct ApplyAdamWithAmsgrad {
   void operator()(const Device& d, typename TTypes<T>::Flat var,
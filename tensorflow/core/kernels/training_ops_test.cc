@@ -293,6 +293,60 @@ static void BM_Adam(::testing::benchmark::State& state) {
 BENCHMARK(BM_Adam)->ArgPair(128 << 10, 0)->ArgPair(256 << 10, 0);
 BENCHMARK(BM_Adam)->ArgPair(256 << 5, 1)->ArgPair(256 << 16, 1);
 
+static void SparseAdam(int32_t m, int32_t n, Graph** init_g,
+                       Graph** train_g) {
+  {
+    Graph* g = new Graph(OpRegistry::Global());
+    auto var = Var(g, m, n);
+    auto m_slot = Var(g, m, n);
+    auto v_slot = Var(g, m, n);
+    auto zero = Zeros(g, m, n);
+    test::graph::Assign(g, var, zero);
+    test::graph::Assign(g, m_slot, zero);
+    test::graph::Assign(g, v_slot, zero);
+    *init_g = g;
+  }
+  {
+    Graph* g = new Graph(OpRegistry::Global());
+    auto var = Var(g, m, n);
+    auto m_slot = Var(g, m, n);
+    auto v_slot = Var(g, m, n);
+    auto beta1_power = Scalar(g, 0.9);
+    auto beta2_power = Scalar(g, 0.99);
+    auto lr = Scalar(g, 0.01);
+    auto beta1 = Scalar(g, 0.9);
+    auto beta2 = Scalar(g, 0.99);
+    auto epsilon = Scalar(g, 1e-8);
+    auto grad = Random(g, m, n);
+    auto indices = Iota(g, m);
+    test::graph::Multi(g, "SparseApplyAdam",
+                       {var, m_slot, v_slot, beta1_power, beta2_power, lr,
+                        beta1, beta2, epsilon, grad, indices});
+    *train_g = g;
+  }
+}
+static void BM_SparseAdam(::testing::benchmark::State& state) {
+  const int m = state.range(0);
+  const int n = state.range(1);
+
+  Graph* init;
+  Graph* train;
+  SparseAdam(m, n, &init, &train);
+  test::Benchmark("cpu", train, GetMultiThreadedOptions(), init, nullptr, "",
+                  /*old_benchmark_api*/ false)
+      .Run(state);
+  const int64_t tot = static_cast<int64_t>(state.iterations()) * m * n;
+  state.SetItemsProcessed(tot);
+  state.SetBytesProcessed(tot * sizeof(float));
+}
+BENCHMARK(BM_SparseAdam)
+    ->UseRealTime()
+    ->ArgPair(128, 1 << 10)
+    ->ArgPair(128, 4 << 10)
+    ->ArgPair(128, 8 << 10)
+    ->ArgPair(128, 32 << 10)
+    ->ArgPair(128, 128 << 10);
+
 static void RMSProp(int32_t n, Graph** init_g, Graph** train_g) {
   TensorShape shape({n});
   {
@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,12 +28,20 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+// Inputs of single elements with at least this many elements are uniquified
+// in parallel, when the device has more than one worker thread.
+constexpr int64_t kParallelUniqueMinSize = 1 << 17;
+
+// The maximum number of hash shards of the parallel implementation.
+constexpr int kMaxParallelUniqueShards = 64;
+
 // `UniqueOpHashMap` defines the map type that is used when elements of type
 // `T` are to be uniquified. By default, we use `absl::flat_hash_map<T, TIndex>`
 // as the map type. Subsequent specializations are provided for
@@ -150,6 +160,13 @@ class UniqueOp : public OpKernel {
       auto Tin = input.flat<T>();
       const int64_t N = static_cast<int64_t>(Tin.size());
 
+      const DeviceBase::CpuWorkerThreads* worker_threads =
+          context->device()->tensorflow_cpu_worker_threads();
+      if (N >= kParallelUniqueMinSize && worker_threads->num_threads > 1) {
+        ComputeParallel(context, input, axis, *worker_threads, idx_vec);
+        return;
+      }
+
       typename UniqueOpHashMap<T, TIndex>::map_type uniq;
       uniq.reserve(2 * N);
       for (Eigen::Index i = 0, j = 0; i < N; ++i) {
@@ -237,6 +254,157 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  // Computes the outputs when unique is run over single elements, using the
+  // worker threads. The input is split into `num_shards` contiguous chunks,
+  // and its elements are partitioned by hash into `num_shards` shards, so that
+  // equal elements fall into the same shard. Each shard is uniquified with its
+  // own map, and the unique elements are then numbered in order of first
+  // occurrence with a prefix sum over the chunks, which gives the same outputs
+  // as the serial implementation.
+  void ComputeParallel(OpKernelContext* context, const Tensor& input,
+                       int64_t axis,
+                       const DeviceBase::CpuWorkerThreads& worker_threads,
+                       typename TTypes<TIndex>::Vec idx_vec) {
+    using Map = typename UniqueOpHashMap<T, TIndex>::map_type;
+    auto Tin = input.flat<T>();
+    const int64_t N = static_cast<int64_t>(Tin.size());
+    const int num_shards =
+        std::min(worker_threads.num_threads, kMaxParallelUniqueShards);
+    const bool compute_counts = num_outputs() > 2;
+
+    // Runs `fn(s)` for each shard (or chunk) `s`, one per task.
+    auto parallel_for = [&worker_threads,
+                         num_shards](const std::function<void(int)>& fn) {
+      worker_threads.workers->ParallelFor(
+          num_shards,
+          thread::ThreadPool::SchedulingParams(
+              thread::ThreadPool::SchedulingStrategy::kFixedBlockSize,
+              absl::nullopt /* cost_per_unit */, 1 /* block_size */),
+          [&fn](int64_t begin, int64_t end) {
+            for (int64_t s = begin; s < end; ++s) {
+              fn(static_cast<int>(s));
+            }
+          });
+    };
+    auto chunk_begin = [N, num_shards](int c) { return N * c / num_shards; };
+
+    // The shard of each element, or'ed with kFirstOccurrence for the first
+    // occurrence of each unique element.
+    constexpr uint8 kFirstOccurrence = 0x80;
+    std::vector<uint8> shard_of(N);
+    // offsets[c * num_shards + s] is first the number of elements of chunk `c`
+    // in shard `s`, then their position in `order`.
+    std::vector<int64_t> offsets(num_shards * num_shards);
+    parallel_for([&](int c) {
+      const typename Map::hasher hasher;
+      int64_t* counts = &offsets[c * num_shards];
+      for (int64_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+        const uint64 h =
+            static_cast<uint64>(hasher(typename Map::key_type(Tin(i))));
+        // Mixes the hash, since `std::hash` is the identity for some types.
+        const int s = ((h * 0x9E3779B97F4A7C15ULL) >> 32) % num_shards;
+        shard_of[i] = s;
+        ++counts[s];
+      }
+    });
+
+    std::vector<int64_t> shard_begin(num_shards + 1);
+    int64_t total = 0;
+    for (int s = 0; s < num_shards; ++s) {
+      shard_begin[s] = total;
+      for (int c = 0; c < num_shards; ++c) {
+        const int64_t count = offsets[c * num_shards + s];
+        offsets[c * num_shards + s] = total;
+        total += count;
+      }
+    }
+    shard_begin[num_shards] = total;
+
+    // The indices of the elements of each shard, in input order.
+    std::vector<int32> order(N);
+    parallel_for([&](int c) {
+      int64_t* next = &offsets[c * num_shards];
+      for (int64_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+        order[next[shard_of[i]]++] = static_cast<int32>(i);
+      }
+    });
+
+    // Uniquifies each shard, leaving in `idx_vec` the index of each element
+    // among the unique elements of its shard. `local_to_global[s]` is sized to
+    // the number of unique elements of shard `s`.
+    std::vector<std::vector<TIndex>> local_to_global(num_shards);
+    std::vector<std::vector<TIndex>> local_counts(num_shards);
+    parallel_for([&](int s) {
+      Map uniq;
+      uniq.reserve(2 * (shard_begin[s + 1] - shard_begin[s]));
+      std::vector<TIndex>& counts = local_counts[s];
+      TIndex j = 0;
+      for (int64_t k = shard_begin[s]; k < shard_begin[s + 1]; ++k) {
+        const int32 i = order[k];
+        auto it = uniq.emplace(Tin(i), j);
+        idx_vec(i) = it.first->second;
+        if (it.second) {
+          shard_of[i] |= kFirstOccurrence;
+          ++j;
+          if (compute_counts) counts.push_back(0);
+        }
+        if (compute_counts) ++counts[it.first->second];
+      }
+      local_to_global[s].resize(j);
+    });
+
+    // The unique elements of chunk `c` are numbered from chunk_uniq_begin[c].
+    std::vector<int64_t> chunk_uniq_begin(num_shards + 1);
+    parallel_for([&](int c) {
+      int64_t n = 0;
+      for (int64_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+        if (shard_of[i] & kFirstOccurrence) ++n;
+      }
+      chunk_uniq_begin[c + 1] = n;
+    });
+    for (int c = 0; c < num_shards; ++c) {
+      chunk_uniq_begin[c + 1] += chunk_uniq_begin[c];
+    }
+
+    const int64_t uniq_size = chunk_uniq_begin[num_shards];
+    TensorShape output_shape(input.shape());
+    output_shape.set_dim(axis, uniq_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+
+    parallel_for([&](int c) {
+      int64_t j = chunk_uniq_begin[c];
+      for (int64_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+        if (shard_of[i] & kFirstOccurrence) {
+          local_to_global[shard_of[i] & ~kFirstOccurrence][idx_vec(i)] = j;
+          Tout(j) = Tin(i);
+          ++j;
+        }
+      }
+    });
+    parallel_for([&](int c) {
+      for (int64_t i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+        idx_vec(i) =
+            local_to_global[shard_of[i] & ~kFirstOccurrence][idx_vec(i)];
+      }
+    });
+
+    if (compute_counts) {
+      Tensor* count_output = nullptr;
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(2, TensorShape({uniq_size}),
+                                              &count_output));
+      auto count_output_vec = count_output->template vec<TIndex>();
+      parallel_for([&](int s) {
+        for (size_t u = 0; u < local_to_global[s].size(); ++u) {
+          count_output_vec(local_to_global[s][u]) = local_counts[s][u];
+        }
+      });
+    }
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                      \
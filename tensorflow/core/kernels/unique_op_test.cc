@@ -166,7 +166,8 @@ BENCHMARK(BM_Unique_INT32)
     ->ArgPair(16 * 1024, 64 * 1024 * 1024)
     ->ArgPair(64 * 1024, 64 * 1024 * 1024)
     ->ArgPair(1024 * 1024, 64 * 1024 * 1024)
-    ->ArgPair(4 * 1024 * 1024, 64 * 1024 * 1024);
+    ->ArgPair(4 * 1024 * 1024, 64 * 1024 * 1024)
+    ->ArgPair(16 * 1024 * 1024, 64 * 1024 * 1024);
 
 BENCHMARK(BM_Unique_INT32_Repeat)
     ->UseRealTime()
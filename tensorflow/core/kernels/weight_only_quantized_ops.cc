@@ -0,0 +1,231 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements MatMul and Conv2D with per-channel int8 quantized weights and
+// float activations, as created by the weight_quantization Grappler pass.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/conv_ops.h"
+#include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/tensor_format.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// Maximum number of float elements of `b` dequantized at a time.
+constexpr int64_t kMaxDequantizedBlockElements = 1 << 18;
+
+}  // namespace
+
+class WeightOnlyQuantizedMatMulOp : public OpKernel {
+ public:
+  explicit WeightOnlyQuantizedMatMulOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& b = context->input(1);
+    const Tensor& b_scales = context->input(2);
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("a must be a matrix, got shape ",
+                                        a.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("b must be a matrix, got shape ",
+                                        b.shape().DebugString()));
+
+    const int64_t m = a.dim_size(transpose_a_ ? 1 : 0);
+    const int64_t k = a.dim_size(transpose_a_ ? 0 : 1);
+    const int64_t n = b.dim_size(transpose_b_ ? 0 : 1);
+    OP_REQUIRES(context, b.dim_size(transpose_b_ ? 1 : 0) == k,
+                errors::InvalidArgument(
+                    "Matrix size-incompatible: In[0]: ",
+                    a.shape().DebugString(), ", In[1]: ",
+                    b.shape().DebugString()));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(b_scales.shape()) &&
+                    b_scales.NumElements() == n,
+                errors::InvalidArgument("b_scales must be a vector of ", n,
+                                        " elements, got shape ",
+                                        b_scales.shape().DebugString()));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, TensorShape({m, n}), &output));
+    if (output->NumElements() == 0) {
+      return;
+    }
+    const CPUDevice& d = context->eigen_device<CPUDevice>();
+    if (k == 0) {
+      functor::SetZeroFunctor<CPUDevice, float>()(d, output->flat<float>());
+      return;
+    }
+
+    // Dequantizes `b` one block of columns at a time, and multiplies `a` with
+    // each block, which bounds the temporary memory and keeps the dequantized
+    // block in cache for the contraction.
+    const int64_t block_size =
+        std::min(n, std::max<int64_t>(1, kMaxDequantizedBlockElements / k));
+    Tensor dequantized;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(
+                       DT_FLOAT, TensorShape({block_size * k}), &dequantized));
+    Tensor product;
+    if (block_size < n) {
+      OP_REQUIRES_OK(context,
+                     context->allocate_temp(
+                         DT_FLOAT, TensorShape({m, block_size}), &product));
+    }
+
+    auto a_matrix = a.matrix<float>();
+    auto b_matrix = b.matrix<int8>();
+    auto scales = b_scales.vec<float>();
+    auto out = output->matrix<float>();
+    const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> contract_dims = {
+        Eigen::IndexPair<Eigen::DenseIndex>(transpose_a_ ? 0 : 1,
+                                            transpose_b_ ? 1 : 0)};
+    for (int64_t start = 0; start < n; start += block_size) {
+      const int64_t size = std::min(block_size, n - start);
+      TTypes<float>::Matrix block(dequantized.flat<float>().data(),
+                                  transpose_b_ ? size : k,
+                                  transpose_b_ ? k : size);
+      if (transpose_b_) {
+        block.device(d) =
+            b_matrix.slice(Eigen::DSizes<Eigen::DenseIndex, 2>(start, 0),
+                           Eigen::DSizes<Eigen::DenseIndex, 2>(size, k))
+                .cast<float>() *
+            scales.slice(Eigen::DSizes<Eigen::DenseIndex, 1>(start),
+                         Eigen::DSizes<Eigen::DenseIndex, 1>(size))
+                .reshape(Eigen::DSizes<Eigen::DenseIndex, 2>(size, 1))
+                .broadcast(Eigen::DSizes<Eigen::DenseIndex, 2>(1, k));
+      } else {
+        block.device(d) =
+            b_matrix.slice(Eigen::DSizes<Eigen::DenseIndex, 2>(0, start),
+                           Eigen::DSizes<Eigen::DenseIndex, 2>(k, size))
+                .cast<float>() *
+            scales.slice(Eigen::DSizes<Eigen::DenseIndex, 1>(start),
+                         Eigen::DSizes<Eigen::DenseIndex, 1>(size))
+                .reshape(Eigen::DSizes<Eigen::DenseIndex, 2>(1, size))
+                .broadcast(Eigen::DSizes<Eigen::DenseIndex, 2>(k, 1));
+      }
+      if (size == n) {
+        out.device(d) = a_matrix.contract(block, contract_dims);
+        continue;
+      }
+      TTypes<float>::Matrix block_product(
+          product.flat<float>().data(), m, size);
+      block_product.device(d) = a_matrix.contract(block, contract_dims);
+      out.slice(Eigen::DSizes<Eigen::DenseIndex, 2>(0, start),
+                Eigen::DSizes<Eigen::DenseIndex, 2>(m, size))
+          .device(d) = block_product;
+    }
+  }
+
+ private:
+  bool transpose_a_;
+  bool transpose_b_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("_WeightOnlyQuantizedMatMul")
+                            .Device(DEVICE_CPU)
+                            .TypeConstraint<float>("T"),
+                        WeightOnlyQuantizedMatMulOp);
+
+class WeightOnlyQuantizedConv2DOp : public OpKernel {
+ public:
+  explicit WeightOnlyQuantizedConv2DOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, InitConv2DParameters(context, &params_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    const Tensor& filter = context->input(1);
+    const Tensor& filter_scales = context->input(2);
+    OP_REQUIRES(context, filter.dims() == 4,
+                errors::InvalidArgument("filter must be 4-dimensional: ",
+                                        filter.shape().DebugString()));
+    const int64_t out_depth = filter.dim_size(3);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(filter_scales.shape()) &&
+                    filter_scales.NumElements() == out_depth,
+                errors::InvalidArgument(
+                    "filter_scales must be a vector of ", out_depth,
+                    " elements, got shape ",
+                    filter_scales.shape().DebugString()));
+
+    // Unlike MatMul, the convolution needs the whole filter at once, so it is
+    // dequantized into a temporary tensor that only lives for this step.
+    Tensor dequantized;
+    OP_REQUIRES_OK(context, context->allocate_temp(DT_FLOAT, filter.shape(),
+                                                   &dequantized));
+    const CPUDevice& d = context->eigen_device<CPUDevice>();
+    if (filter.NumElements() > 0) {
+      const int64_t patch_size = filter.NumElements() / out_depth;
+      dequantized.flat_inner_dims<float, 2>().device(d) =
+          filter.flat_inner_dims<int8, 2>().cast<float>() *
+          filter_scales.vec<float>()
+              .reshape(Eigen::DSizes<Eigen::DenseIndex, 2>(1, out_depth))
+              .broadcast(Eigen::DSizes<Eigen::DenseIndex, 2>(patch_size, 1));
+    }
+
+    Conv2DDimensions dimensions;
+    OP_REQUIRES_OK(context, ComputeConv2DDimension(params_, input, dequantized,
+                                                   &dimensions));
+    TensorShape out_shape;
+    OP_REQUIRES_OK(
+        context, ShapeFromFormatWithStatus(
+                     params_.data_format, dimensions.batch, dimensions.out_rows,
+                     dimensions.out_cols, dimensions.out_depth, &out_shape));
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, out_shape, &output));
+    if (out_shape.num_elements() == 0) {
+      return;
+    }
+    if (input.NumElements() == 0) {
+      functor::SetZeroFunctor<CPUDevice, float>()(d, output->flat<float>());
+      return;
+    }
+    LaunchConv2DOp<CPUDevice, float>()(
+        context, /*use_cudnn=*/false, /*cudnn_use_autotune=*/false, input,
+        dequantized, dimensions.dilation_rows, dimensions.dilation_cols,
+        dimensions.stride_rows, dimensions.stride_cols, params_.padding,
+        params_.explicit_paddings, output, params_.data_format);
+  }
+
+ private:
+  Conv2DParameters params_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("_WeightOnlyQuantizedConv2D")
+                            .Device(DEVICE_CPU)
+                            .TypeConstraint<float>("T"),
+                        WeightOnlyQuantizedConv2DOp);
+
+}  // namespace tensorflow
@@ -0,0 +1,130 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+class WeightOnlyQuantizedMatMulTest : public OpsTestBase {
+ protected:
+  void MakeOp(bool transpose_a, bool transpose_b) {
+    TF_ASSERT_OK(NodeDefBuilder("matmul", "_WeightOnlyQuantizedMatMul")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT8))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("transpose_a", transpose_a)
+                     .Attr("transpose_b", transpose_b)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(WeightOnlyQuantizedMatMulTest, Small) {
+  MakeOp(/*transpose_a=*/false, /*transpose_b=*/false);
+  // a = |  1 |  2 |  3 |
+  //     |  4 |  5 |  6 |
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  // b = |  1 | -2 |
+  //     |  3 |  4 |
+  //     | -5 |  6 |
+  AddInputFromArray<int8>(TensorShape({3, 2}), {1, -2, 3, 4, -5, 6});
+  AddInputFromArray<float>(TensorShape({2}), {0.5, 2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {-4, 48, -5.5, 96});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(WeightOnlyQuantizedMatMulTest, Transposed) {
+  MakeOp(/*transpose_a=*/true, /*transpose_b=*/true);
+  // The transposes of the inputs of the Small test.
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 4, 2, 5, 3, 6});
+  AddInputFromArray<int8>(TensorShape({2, 3}), {1, 3, -5, -2, 4, 6});
+  AddInputFromArray<float>(TensorShape({2}), {0.5, 2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {-4, 48, -5.5, 96});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(WeightOnlyQuantizedMatMulTest, MultipleBlocks) {
+  MakeOp(/*transpose_a=*/false, /*transpose_b=*/false);
+  // With this depth, `b` is dequantized two columns at a time.
+  const int64_t k = 1 << 17;
+  const int64_t n = 5;
+  AddInput<float>(TensorShape({2, k}),
+                  [](int i) -> float { return i % 2 == 0 ? 1 : -1; });
+  AddInput<int8>(TensorShape({k, n}),
+                 [](int i) -> int8 { return (i / n) % 2 == 0 ? i % n : 0; });
+  AddInputFromArray<float>(TensorShape({n}), {1, 2, 3, 4, 5});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Even rows of `b` hold the column index and odd rows are zero, while both
+  // rows of `a` are 1 on even columns.
+  Tensor expected(DT_FLOAT, TensorShape({2, n}));
+  std::vector<float> values;
+  for (int row = 0; row < 2; ++row) {
+    for (int col = 0; col < n; ++col) {
+      values.push_back((k / 2) * col * (col + 1));
+    }
+  }
+  test::FillValues<float>(&expected, values);
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(WeightOnlyQuantizedMatMulTest, InvalidScales) {
+  MakeOp(/*transpose_a=*/false, /*transpose_b=*/false);
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<int8>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({3}), {1, 1, 1});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+class WeightOnlyQuantizedConv2DTest : public OpsTestBase {};
+
+TEST_F(WeightOnlyQuantizedConv2DTest, PointwiseFilter) {
+  TF_ASSERT_OK(NodeDefBuilder("conv", "_WeightOnlyQuantizedConv2D")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_INT8))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("strides", {1, 1, 1, 1})
+                   .Attr("padding", "VALID")
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  // A 1x4 image with 3 channels, i.e. the `a` matrix of the MatMul tests
+  // repeated twice.
+  AddInputFromArray<float>(TensorShape({1, 1, 4, 3}),
+                           {1, 2, 3, 4, 5, 6, 1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int8>(TensorShape({1, 1, 3, 2}), {1, -2, 3, 4, -5, 6});
+  AddInputFromArray<float>(TensorShape({2}), {0.5, 2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({1, 1, 4, 2}));
+  test::FillValues<float>(&expected, {-4, 48, -5.5, 96, -4, 48, -5.5, 96});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+}  // namespace tensorflow
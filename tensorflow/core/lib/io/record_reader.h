@@ -30,6 +30,7 @@ limitations under the License.
 namespace tensorflow {
 namespace io {
 // NOLINTBEGIN(misc-unused-using-decls)
+using tsl::io::RandomAccessRecordReader;
 using tsl::io::RecordReader;
 using tsl::io::RecordReaderOptions;
 using tsl::io::SequentialRecordReader;
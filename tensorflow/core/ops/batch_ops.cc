@@ -54,6 +54,9 @@ REGISTER_OP("BatchFunction")
     // NOTE: Support for `enable_large_batch_splitting == true` is still
     // developed in progress.
     .Attr("enable_large_batch_splitting: bool = false")
+    // Indices of 'in_tensors' holding ragged inputs, each of which is passed
+    // to 'f' as packed values plus row splits instead of being padded.
+    .Attr("ragged_inputs: list(int) = []")
     // TODO(apassos): Fix this shape inference function. It requires shape
     // inference of function calls.
     .SetShapeFn(shape_inference::UnknownShape)
@@ -138,6 +138,9 @@ REGISTER_OP("CollectiveReduceV2")
     .Attr("timeout_seconds: float = 0")
     .Attr("Nordering_token: int >= 0 = 0")
     .Attr("max_subdivs_per_device: int = -1")
+    .Attr("compression: {'none', 'float16', 'bfloat16', 'top_k'} = 'none'")
+    .Attr("topk_ratio: float = 0.01")
+    .Attr("min_contributions: int >= 0 = 0")
     .SetIsStateful()
     .SetIsDistributedCommunication()
     .SetShapeFn(shape_inference::UnchangedShape);
@@ -220,6 +220,7 @@ REGISTER_OP("PrefetchDataset")
     .Attr("legacy_autotune: bool = true")
     .Attr("buffer_size_min: int = 0")
     .Attr("metadata: string = ''")
+    .Attr("copy_to_device: bool = false")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -833,6 +834,9 @@ REGISTER_OP("TFRecordDataset")
     .Input("compression_type: string")
     .Input("buffer_size: int64")
     .Attr("metadata: string = ''")
+    .Attr("global_shuffle: bool = false")
+    .Attr("seed: int = 0")
+    .Attr("seed2: int = 0")
     .Output("handle: variant")
     .SetDoNotOptimize()  // TODO(b/123753214): See comment in dataset_ops.cc.
     .SetTypeConstructor(full_type::UnaryTensorContainer(TFT_DATASET,
@@ -175,6 +175,7 @@ REGISTER_OP("CompressElement")
     .Input("components: input_types")
     .Output("compressed: variant")
     .Attr("input_types: list(type) >= 1")
+    .Attr("adaptive_codecs: bool = false")
     .SetShapeFn(shape_inference::ScalarShape);
 
 REGISTER_OP("UncompressElement")
@@ -777,6 +778,34 @@ REGISTER_OP("ExperimentalParallelInterleaveDataset")
                                                            "output_types"))
     .SetShapeFn(shape_inference::ScalarShape);
 
+REGISTER_OP("ParquetDataset")
+    .Input("filenames: string")
+    .Input("columns: string")
+    .Input("batch_size: int64")
+    .Input("predicate_columns: string")
+    .Input("predicate_lower_bounds: double")
+    .Input("predicate_upper_bounds: double")
+    .Output("handle: variant")
+    .Attr("output_types: list({bool,int32,int64,float,double,string}) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetDoNotOptimize()  // TODO(b/123753214): See comment in dataset_ops.cc.
+    .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
+                                                           "output_types"))
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // `filenames` must be a scalar or a vector.
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(0), 1, &unused));
+      // `columns` must be a vector.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      // `batch_size` must be a scalar.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      // The predicate inputs must be vectors.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(5), 1, &unused));
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("ParseExampleDataset")
     .Input("input_dataset: variant")
     .Input("num_parallel_calls: int64")
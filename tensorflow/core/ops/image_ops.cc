@@ -516,6 +516,52 @@ REGISTER_OP("DecodeAndCropJpeg")
       return OkStatus();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("DecodeAndCropAndResizeJpeg")
+    .Input("contents: string")
+    .Input("crop_window: int32")
+    .Input("size: int32")
+    .Attr("channels: int = 0")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("try_recover_truncated: bool = false")
+    .Attr("acceptable_fraction: float = 1.0")
+    .Attr("dct_method: string = ''")
+    .Output("image: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      DimensionHandle channels_dim = c->UnknownDim();
+
+      int32_t channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels != 0) {
+        if (channels < 0) {
+          return errors::InvalidArgument("channels must be non-negative, got ",
+                                         channels);
+        }
+        channels_dim = c->MakeDim(channels);
+      }
+
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(unused, 0), 4, &unused_dim));
+
+      ShapeHandle size;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &size));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(size, 0), 2, &unused_dim));
+
+      DimensionHandle h = c->UnknownDim();
+      DimensionHandle w = c->UnknownDim();
+      const Tensor* size_tensor = c->input_tensor(2);
+      if (size_tensor != nullptr) {
+        auto size_vec = size_tensor->vec<int32>();
+        h = c->MakeDim(size_vec(0));
+        w = c->MakeDim(size_vec(1));
+      }
+      c->set_output(0, c->MakeShape({h, w, channels_dim}));
+      return OkStatus();
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
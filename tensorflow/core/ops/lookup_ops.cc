@@ -383,6 +383,17 @@ REGISTER_OP("AnonymousHashTable")
     .SetIsStateful()
     .SetShapeFn(ScalarOutput);
 
+REGISTER_OP("MappedHashTable")
+    .Output("table_handle: resource")
+    .Attr("filename: string")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("use_node_name_sharing: bool = false")
+    .Attr("key_dtype: type")
+    .Attr("value_dtype: type")
+    .SetIsStateful()
+    .SetShapeFn(ScalarOutput);
+
 REGISTER_OP("MutableHashTable")
     .Output("table_handle: Ref(string)")
     .Attr("container: string = ''")
@@ -1015,6 +1015,31 @@ _FusedConv2D output.
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_WeightOnlyQuantizedMatMul")
+    .Input("a: T")
+    .Input("b: int8")
+    .Input("b_scales: T")
+    .Output("product: T")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("T: {float}")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(shape_inference::MatMulShape(c));
+      ShapeHandle unused;
+      return c->WithRank(c->input(2), 1, &unused);
+    })
+    .Doc(R"doc(
+Performs a MatMul with a per-channel int8 quantized `b`.
+
+`b_scales` holds a scale for every column of the (possibly transposed) `b`, and
+the product is computed as if `b` was the float matrix `b[k, n] * b_scales[n]`.
+`b` is dequantized block by block inside the kernel, so the float matrix is
+never materialized as a whole.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 
 // For operations where the output is a reduction function along some
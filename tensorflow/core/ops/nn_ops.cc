@@ -500,6 +500,70 @@ output.
 create these operators.
 )doc");
 
+REGISTER_OP("_WeightOnlyQuantizedConv2D")
+    .Input("input: T")
+    .Input("filter: int8")
+    .Input("filter_scales: T")
+    .Output("output: T")
+    .Attr("T: {float}")
+    .Attr("strides: list(int)")
+    .Attr(GetPaddingAttrStringWithExplicit())
+    .Attr(GetExplicitPaddingsAttrString())
+    .Attr("data_format: {'NHWC'} = 'NHWC'")
+    .Attr("dilations: list(int) = [1, 1, 1, 1]")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(shape_inference::Conv2DShapeWithExplicitPadding(c));
+      ShapeHandle unused;
+      return c->WithRank(c->input(2), 1, &unused);
+    })
+    .Doc(R"doc(
+Performs a Conv2D with a per-output-channel int8 quantized `filter`.
+
+`filter_scales` holds a scale for every output channel, and the convolution is
+computed as if the filter was the float tensor
+`filter[h, w, i, o] * filter_scales[o]`.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is expected to
+create these operators.
+)doc");
+
+REGISTER_OP("_FusedMultiHeadAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Input("args: num_args * T")
+    .Output("output: T")
+    .Attr("T: {bfloat16, half, float}")
+    .Attr("num_args: int >= 0 = 0")
+    .Attr("scale: float = 1.0")
+    .Attr("is_causal: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle query;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 2, &query));
+      ShapeHandle value;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(2), 2, &value));
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->Subshape(query, 0, -1, &output));
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          output, c->Vector(c->Dim(value, -1)), &output));
+      c->set_output(0, output);
+      return OkStatus();
+    })
+    .Doc(R"doc(
+Computes the attention `softmax(query * key^T * scale + mask) * value`.
+
+`query`, `key` and `value` have the shapes `[..., Lq, D]`, `[..., Lk, D]` and
+`[..., Lk, Dv]` with the same batch dimensions. The optional additive mask in
+`args` is broadcastable to the scores `[..., Lq, Lk]`. If `is_causal` is set,
+the query `i` only attends to the keys `j <= i`.
+
+The scores are computed a block of keys at a time with a streaming softmax, so
+that the `[..., Lq, Lk]` scores are never materialized.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is expected to
+create these operators.
+)doc");
+
 namespace {
 
 Status CommonFusedConvCalculations(InferenceContext* c, bool has_resize) {
@@ -41,6 +41,35 @@ REGISTER_OP("RaggedGather")
     .Attr("OUTPUT_RAGGED_RANK: int >= 0")
     .SetShapeFn(RaggedGatherShapeFn);
 
+REGISTER_OP("RaggedConcatRows")
+    .Input("rt_values: N * T")
+    .Input("rt_row_splits: N * Tsplits")
+    .Output("output_values: T")
+    .Output("output_row_splits: Tsplits")
+    .Attr("N: int >= 1")
+    .Attr("T: type")
+    .Attr("Tsplits: {int32, int64} = DT_INT64")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      ShapeHandle values;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &values));
+      ShapeHandle row_splits;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(n), 1, &row_splits));
+      for (int i = 1; i < n; ++i) {
+        ShapeHandle values_i;
+        TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(i), 1, &values_i));
+        TF_RETURN_IF_ERROR(c->ReplaceDim(values_i, 0, c->Dim(values, 0),
+                                         &values_i));
+        TF_RETURN_IF_ERROR(c->Merge(values, values_i, &values));
+        TF_RETURN_IF_ERROR(c->Merge(row_splits, c->input(n + i), &row_splits));
+      }
+      TF_RETURN_IF_ERROR(c->ReplaceDim(values, 0, c->UnknownDim(), &values));
+      c->set_output(0, values);
+      c->set_output(1, row_splits);
+      return OkStatus();
+    });
+
 REGISTER_OP("RaggedCross")
     .Input("ragged_values: ragged_values_types")
     .Input("ragged_row_splits: ragged_splits_types")
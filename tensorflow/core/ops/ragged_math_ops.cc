@@ -23,6 +23,7 @@ using shape_inference::InferenceContext;
 using shape_inference::ShapeHandle;
 
 Status RaggedRangeShapeFn(InferenceContext* c);
+Status RaggedReduceShapeFn(InferenceContext* c);
 
 //==============================================================================
 // Registered Ops
@@ -38,6 +39,30 @@ REGISTER_OP("RaggedRange")
     .Attr("Tsplits: {int32, int64} = DT_INT64")
     .SetShapeFn(RaggedRangeShapeFn);
 
+REGISTER_OP("RaggedReduce")
+    .Input("values: T")
+    .Input("row_splits: Tsplits")
+    .Output("output: T")
+    .Attr("reduction: {'sum', 'prod', 'min', 'max', 'mean'}")
+    .Attr("T: {float, double, int32, int64}")
+    .Attr("Tsplits: {int32, int64} = DT_INT64")
+    .SetShapeFn(RaggedReduceShapeFn);
+
+REGISTER_OP("RaggedGatherReduce")
+    .Input("params: T")
+    .Input("indices: Tindices")
+    .Input("row_splits: Tsplits")
+    .Output("output: T")
+    .Attr("reduction: {'sum', 'prod', 'min', 'max', 'mean'}")
+    .Attr("T: {float, double, int32, int64}")
+    .Attr("Tindices: {int32, int64}")
+    .Attr("Tsplits: {int32, int64} = DT_INT64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      return RaggedReduceShapeFn(c);
+    });
+
 //==============================================================================
 // Shape Functions
 //==============================================================================
@@ -78,4 +103,22 @@ Status RaggedRangeShapeFn(InferenceContext* c) {
   return OkStatus();
 }
 
+// The shape function of the reductions of the rows of a ragged tensor, whose
+// first input holds the rows of values and last input the row splits.
+Status RaggedReduceShapeFn(InferenceContext* c) {
+  ShapeHandle data;
+  TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &data));
+  ShapeHandle row_splits;
+  TF_RETURN_IF_ERROR(
+      c->WithRank(c->input(c->num_inputs() - 1), 1, &row_splits));
+  DimensionHandle num_rows = c->UnknownDim();
+  if (c->ValueKnown(c->Dim(row_splits, 0))) {
+    TF_RETURN_IF_ERROR(c->Subtract(c->Dim(row_splits, 0), 1, &num_rows));
+  }
+  ShapeHandle output;
+  TF_RETURN_IF_ERROR(c->ReplaceDim(data, 0, num_rows, &output));
+  c->set_output(0, output);
+  return OkStatus();
+}
+
 }  // namespace tensorflow
@@ -145,4 +145,29 @@ client_terminated: If set to true, this indicates that the node was added
   locally by the caller.
 )doc");
 
+REGISTER_OP("_PackTensorGroup")
+    .Input("tensors: T")
+    .Output("group: variant")
+    .Attr("T: list(type)")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Packs a group of tensors into a single variant so that they can be sent
+to another device as one rendezvous item.
+
+tensors: The tensors to pack.
+group: A scalar variant holding the tensors.
+)doc");
+
+REGISTER_OP("_UnpackTensorGroup")
+    .Input("group: variant")
+    .Output("tensors: T")
+    .Attr("T: list(type)")
+    .SetShapeFn(shape_inference::UnknownShape)
+    .Doc(R"doc(
+Unpacks a group of tensors packed by _PackTensorGroup.
+
+group: A scalar variant holding the tensors.
+tensors: The unpacked tensors.
+)doc");
+
 }  // end namespace tensorflow
@@ -18,6 +18,8 @@ limitations under the License.
 #include <sys/stat.h>
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -92,6 +94,36 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, DirectIoRandomAccessFile) {
+  const string filename = io::JoinPath(BaseDir(), "direct_io");
+  const int length = (2 << 20) + 100;
+  const string input = CreateTestFile(env_, filename, length);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_ASSERT_OK(env_->NewDirectIoRandomAccessFile(filename, &f));
+
+  std::vector<char> scratch(length + 8192);
+  // Aligned and unaligned offsets, sizes and buffers.
+  for (const auto& offset_and_size :
+       std::vector<std::pair<int, int>>{{0, 4096},
+                                        {1, 10},
+                                        {4095, 3},
+                                        {100, 1 << 20},
+                                        {0, length},
+                                        {4096, (1 << 20) + 5000}}) {
+    StringPiece result;
+    TF_EXPECT_OK(f->Read(offset_and_size.first, offset_and_size.second,
+                         &result, scratch.data() + 1));
+    EXPECT_EQ(input.substr(offset_and_size.first, offset_and_size.second),
+              result);
+  }
+
+  // Reading past EOF gives an OUT_OF_RANGE error.
+  StringPiece result;
+  EXPECT_EQ(error::OUT_OF_RANGE,
+            f->Read(length - 10, 4096, &result, scratch.data()).code());
+  EXPECT_EQ(input.substr(length - 10), result);
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
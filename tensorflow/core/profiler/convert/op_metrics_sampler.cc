@@ -0,0 +1,176 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/op_metrics_sampler.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
+#include "tensorflow/core/profiler/convert/xplane_to_op_stats.h"
+#include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/protobuf/op_stats.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// Number of ops listed per database by the Monitor rpc.
+constexpr int kNumMonitoredOps = 10;
+
+OpMetricsSampler::Options WithDefaults(OpMetricsSampler::Options options) {
+  if (options.sample_duration_ms <= 0) {
+    options.sample_duration_ms =
+        std::max<int64_t>(options.sample_interval_ms / 100, 1);
+  }
+  options.max_samples = std::max(options.max_samples, 1);
+  return options;
+}
+
+void AppendTopOps(const OpMetricsDb& db, absl::string_view title,
+                  std::string* out) {
+  std::vector<const OpMetrics*> ops;
+  ops.reserve(db.metrics_db_size());
+  for (const OpMetrics& metrics : db.metrics_db()) ops.push_back(&metrics);
+  const int num_ops = std::min<int>(ops.size(), kNumMonitoredOps);
+  std::partial_sort(ops.begin(), ops.begin() + num_ops, ops.end(),
+                    [](const OpMetrics* a, const OpMetrics* b) {
+                      return a->self_time_ps() > b->self_time_ps();
+                    });
+  absl::StrAppendFormat(out, "%s: %d ops, %.3f ms in total\n", title,
+                        db.metrics_db_size(), db.total_time_ps() / 1e9);
+  for (int i = 0; i < num_ops; ++i) {
+    absl::StrAppendFormat(out, "  %12.3f ms self %10u x  %s (%s)\n",
+                          ops[i]->self_time_ps() / 1e9, ops[i]->occurrences(),
+                          ops[i]->name(), ops[i]->category());
+  }
+}
+
+}  // namespace
+
+OpMetricsSampler::OpMetricsSampler(const Options& options)
+    : options_(WithDefaults(options)) {}
+
+OpMetricsSampler::~OpMetricsSampler() {
+  {
+    mutex_lock lock(mu_);
+    stop_ = true;
+  }
+  stop_cv_.notify_all();
+  // Joins the sampling thread.
+  thread_.reset();
+}
+
+void OpMetricsSampler::Start() {
+  CHECK(thread_ == nullptr) << "OpMetricsSampler already started";
+  thread_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "op_metrics_sampler", [this] { SamplingLoop(); }));
+}
+
+void OpMetricsSampler::SamplingLoop() {
+  const int64_t wait_ms = std::max<int64_t>(
+      options_.sample_interval_ms - options_.sample_duration_ms, 0);
+  while (true) {
+    {
+      mutex_lock lock(mu_);
+      if (!stop_) WaitForMilliseconds(&lock, &stop_cv_, wait_ms);
+      if (stop_) return;
+    }
+    TakeSample();
+  }
+}
+
+void OpMetricsSampler::TakeSample() {
+  std::unique_ptr<ProfilerSession> session =
+      ProfilerSession::Create(options_.profile_options);
+  if (!session->Status().ok()) {
+    VLOG(1) << "Skipping op metrics sample: " << session->Status();
+    return;
+  }
+  {
+    // Stopping ends the sample early; what was collected is still added.
+    mutex_lock lock(mu_);
+    if (!stop_) {
+      WaitForMilliseconds(&lock, &stop_cv_, options_.sample_duration_ms);
+    }
+  }
+  XSpace space;
+  Status status = session->CollectData(&space);
+  if (!status.ok()) {
+    VLOG(1) << "Dropping op metrics sample: " << status;
+    return;
+  }
+  AddSample(space);
+}
+
+void OpMetricsSampler::AddSample(const XSpace& space) {
+  OpStatsOptions options;
+  options.generate_op_metrics_db = true;
+  OpStats op_stats = ConvertXSpaceToOpStats(space, options);
+  AddSample(std::move(*op_stats.mutable_host_op_metrics_db()),
+            std::move(*op_stats.mutable_device_op_metrics_db()));
+}
+
+void OpMetricsSampler::AddSample(OpMetricsDb host_op_metrics_db,
+                                 OpMetricsDb device_op_metrics_db) {
+  mutex_lock lock(mu_);
+  samples_.push_back(
+      {std::move(host_op_metrics_db), std::move(device_op_metrics_db)});
+  if (samples_.size() > static_cast<size_t>(options_.max_samples)) {
+    samples_.pop_front();
+  }
+}
+
+int OpMetricsSampler::num_samples() const {
+  mutex_lock lock(mu_);
+  return samples_.size();
+}
+
+OpMetricsDb OpMetricsSampler::HostOpMetricsDb() const {
+  OpMetricsDb db;
+  OpMetricsDbCombiner combiner(&db);
+  mutex_lock lock(mu_);
+  for (const Sample& sample : samples_) {
+    combiner.Combine(sample.host_op_metrics_db, /*update_num_cores=*/false);
+  }
+  return db;
+}
+
+OpMetricsDb OpMetricsSampler::DeviceOpMetricsDb() const {
+  OpMetricsDb db;
+  OpMetricsDbCombiner combiner(&db);
+  mutex_lock lock(mu_);
+  for (const Sample& sample : samples_) {
+    combiner.Combine(sample.device_op_metrics_db, /*update_num_cores=*/false);
+  }
+  return db;
+}
+
+Status OpMetricsSampler::Monitor(const MonitorRequest& request,
+                                 MonitorResponse* response) {
+  std::string data = absl::StrFormat(
+      "Op metrics of the last %d samples of %d ms every %d ms\n",
+      num_samples(), options_.sample_duration_ms, options_.sample_interval_ms);
+  AppendTopOps(HostOpMetricsDb(), "Host", &data);
+  AppendTopOps(DeviceOpMetricsDb(), "Device", &data);
+  response->set_data(std::move(data));
+  return OkStatus();
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,109 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_CONVERT_OP_METRICS_SAMPLER_H_
+#define TENSORFLOW_CORE_PROFILER_CONVERT_OP_METRICS_SAMPLER_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/tsl/profiler/protobuf/profiler_options.pb.h"
+#include "tensorflow/tsl/profiler/protobuf/profiler_service.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// Profiles the process for a small fraction of the time, so that it can be
+// left on in production, and keeps the op metrics of the latest samples.
+//
+// Every `sample_interval_ms`, a profiler session is run for
+// `sample_duration_ms` and its XSpace converted to host and device op metrics
+// databases. The databases of the last `max_samples` samples are kept, and
+// combined into rolling summaries on request. A sample is skipped when another
+// profiler session is active, e.g. one started by the profiler service.
+class OpMetricsSampler {
+ public:
+  struct Options {
+    // Time between the starts of consecutive samples.
+    int64_t sample_interval_ms = 60000;
+    // Time each sample profiles for. Defaults to 1% of the interval.
+    int64_t sample_duration_ms = 0;
+    // Number of samples kept for the rolling summaries.
+    int max_samples = 60;
+    // Options of the profiler sessions of the samples.
+    ProfileOptions profile_options;
+  };
+
+  // Creates a sampler that does not sample until started.
+  explicit OpMetricsSampler(const Options& options);
+
+  // Stops the sampling thread, waiting for the current sample to finish.
+  ~OpMetricsSampler();
+
+  // Starts sampling in a background thread.
+  void Start();
+
+  // Adds the op metrics of `space` as the latest sample.
+  void AddSample(const XSpace& space);
+
+  // Adds the given op metrics databases as the latest sample, dropping the
+  // oldest sample once there are `max_samples`.
+  void AddSample(OpMetricsDb host_op_metrics_db,
+                 OpMetricsDb device_op_metrics_db);
+
+  // Returns the number of samples kept.
+  int num_samples() const;
+
+  // Returns the op metrics combined over the samples kept.
+  OpMetricsDb HostOpMetricsDb() const;
+  OpMetricsDb DeviceOpMetricsDb() const;
+
+  // Serves the Monitor rpc of the profiler service with a summary of the ops
+  // taking the most time in the samples kept.
+  Status Monitor(const MonitorRequest& request, MonitorResponse* response);
+
+ private:
+  struct Sample {
+    OpMetricsDb host_op_metrics_db;
+    OpMetricsDb device_op_metrics_db;
+  };
+
+  // Runs a profiler session for a sample, and adds its op metrics.
+  void TakeSample();
+
+  void SamplingLoop();
+
+  const Options options_;
+
+  mutable mutex mu_;
+  condition_variable stop_cv_;
+  bool stop_ TF_GUARDED_BY(mu_) = false;
+  std::deque<Sample> samples_ TF_GUARDED_BY(mu_);
+
+  std::unique_ptr<Thread> thread_;
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_CONVERT_OP_METRICS_SAMPLER_H_
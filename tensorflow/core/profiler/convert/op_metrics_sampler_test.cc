@@ -0,0 +1,82 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/op_metrics_sampler.h"
+
+#include <string>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+OpMetricsDb MakeOpMetricsDb(absl::string_view name, uint64_t self_time_ps) {
+  OpMetricsDb db;
+  OpMetrics* metrics = db.add_metrics_db();
+  metrics->set_name(std::string(name));
+  metrics->set_category("MatMul");
+  metrics->set_occurrences(1);
+  metrics->set_time_ps(self_time_ps);
+  metrics->set_self_time_ps(self_time_ps);
+  db.set_total_op_time_ps(self_time_ps);
+  db.set_total_time_ps(self_time_ps);
+  return db;
+}
+
+TEST(OpMetricsSamplerTest, CombinesLatestSamples) {
+  OpMetricsSampler::Options options;
+  options.max_samples = 2;
+  OpMetricsSampler sampler(options);
+
+  sampler.AddSample(MakeOpMetricsDb("a", 1000), MakeOpMetricsDb("d", 10));
+  sampler.AddSample(MakeOpMetricsDb("a", 2000), MakeOpMetricsDb("d", 20));
+  sampler.AddSample(MakeOpMetricsDb("b", 4000), MakeOpMetricsDb("d", 40));
+  EXPECT_EQ(sampler.num_samples(), 2);
+
+  // The first sample was dropped.
+  OpMetricsDb host_db = sampler.HostOpMetricsDb();
+  ASSERT_EQ(host_db.metrics_db_size(), 2);
+  EXPECT_EQ(host_db.total_time_ps(), 6000);
+  for (const OpMetrics& metrics : host_db.metrics_db()) {
+    EXPECT_EQ(metrics.occurrences(), 1);
+    EXPECT_EQ(metrics.self_time_ps(), metrics.name() == "a" ? 2000 : 4000);
+  }
+
+  OpMetricsDb device_db = sampler.DeviceOpMetricsDb();
+  ASSERT_EQ(device_db.metrics_db_size(), 1);
+  EXPECT_EQ(device_db.metrics_db(0).occurrences(), 2);
+  EXPECT_EQ(device_db.metrics_db(0).self_time_ps(), 60);
+}
+
+TEST(OpMetricsSamplerTest, MonitorListsOpsBySelfTime) {
+  OpMetricsSampler sampler(OpMetricsSampler::Options{});
+  OpMetricsDb host_db = MakeOpMetricsDb("fast_op", 1000);
+  *host_db.add_metrics_db() = MakeOpMetricsDb("slow_op", 5000).metrics_db(0);
+  sampler.AddSample(host_db, OpMetricsDb());
+
+  MonitorResponse response;
+  TF_ASSERT_OK(sampler.Monitor(MonitorRequest(), &response));
+  const std::string& data = response.data();
+  ASSERT_TRUE(absl::StrContains(data, "fast_op"));
+  EXPECT_LT(data.find("slow_op"), data.find("fast_op"));
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
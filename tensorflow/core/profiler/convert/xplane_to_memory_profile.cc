@@ -231,6 +231,77 @@ void UpdateDeallocation(PerAllocatorMemoryProfile* memory_profile) {
           << addr_metadata_map.size();
 }
 
+// Attribute the memory allocated within the profiling window to the TF Ops
+// that allocated it, both at the peak memory usage and over time. Allocations
+// made before the profiling window are not attributed, as their ops are not
+// known.
+void ProcessOpMemoryUsage(PerAllocatorMemoryProfile* memory_profile) {
+  const MemoryProfileSummary& summary = memory_profile->profile_summary();
+  struct LiveAllocation {
+    std::string tf_op_name;
+    int64_t bytes;
+  };
+  absl::flat_hash_map<std::string /*tf_op_name*/, OpMemoryUsage> op_usages;
+  absl::flat_hash_map<std::string /*tf_op_name*/, int64_t> op_live_bytes;
+  absl::flat_hash_map<std::string /*tf_op_name*/, int64_t> op_live_allocations;
+  absl::flat_hash_map<uint64 /*address*/, LiveAllocation> live_allocations;
+  bool peak_reached = false;
+  // Snapshots are already sorted in time.
+  for (const auto& snapshot : memory_profile->memory_profile_snapshots()) {
+    const MemoryActivityMetadata& metadata = snapshot.activity_metadata();
+    if (metadata.memory_activity() == ALLOCATION) {
+      const std::string& op_name = metadata.tf_op_name();
+      OpMemoryUsage& usage = op_usages[op_name];
+      usage.set_tf_op_name(op_name);
+      usage.set_total_allocated_bytes(usage.total_allocated_bytes() +
+                                      metadata.allocation_bytes());
+      usage.set_num_allocations(usage.num_allocations() + 1);
+      int64_t& live_bytes = op_live_bytes[op_name];
+      live_bytes += metadata.allocation_bytes();
+      ++op_live_allocations[op_name];
+      if (live_bytes > usage.max_live_bytes()) {
+        usage.set_max_live_bytes(live_bytes);
+        usage.set_max_live_bytes_step_id(metadata.step_id());
+      }
+      live_allocations[metadata.address()] = {op_name,
+                                              metadata.allocation_bytes()};
+    } else if (metadata.memory_activity() == DEALLOCATION) {
+      auto it = live_allocations.find(metadata.address());
+      if (it != live_allocations.end()) {
+        op_live_bytes[it->second.tf_op_name] -= it->second.bytes;
+        --op_live_allocations[it->second.tf_op_name];
+        live_allocations.erase(it);
+      }
+    }
+    // The first snapshot at the peak memory usage holds the peak allocations.
+    if (!peak_reached &&
+        snapshot.time_offset_ps() == summary.peak_stats_time_ps() &&
+        snapshot.aggregation_stats().heap_allocated_bytes() +
+                snapshot.aggregation_stats().stack_reserved_bytes() ==
+            summary.peak_stats().peak_bytes_in_use()) {
+      peak_reached = true;
+      for (auto& [op_name, usage] : op_usages) {
+        usage.set_peak_bytes(op_live_bytes[op_name]);
+        usage.set_num_allocations_at_peak(op_live_allocations[op_name]);
+      }
+    }
+  }
+
+  protobuf::RepeatedPtrField<OpMemoryUsage>* op_memory_usage =
+      memory_profile->mutable_op_memory_usage();
+  op_memory_usage->Reserve(op_usages.size());
+  for (auto& [op_name, usage] : op_usages) {
+    *op_memory_usage->Add() = std::move(usage);
+  }
+  absl::c_sort(*op_memory_usage,
+               [](const OpMemoryUsage& a, const OpMemoryUsage& b) {
+                 return std::make_tuple(-a.peak_bytes(), -a.max_live_bytes(),
+                                        a.tf_op_name()) <
+                        std::make_tuple(-b.peak_bytes(), -b.max_live_bytes(),
+                                        b.tf_op_name());
+               });
+}
+
 // Return the step id for the peak memory usage data point.
 int64_t GetPeakMemoryStep(int64_t peak_bytes_profile,
                           const PerAllocatorMemoryProfile* memory_profile) {
@@ -510,6 +581,7 @@ void ProcessMemoryProfileProto(int64_t max_num_snapshots,
 
     UpdateStepId(allocator_memory_profile);
     UpdateDeallocation(allocator_memory_profile);
+    ProcessOpMemoryUsage(allocator_memory_profile);
 
     // Sample a subset of MemoryProfileSnapshots to display in the frontend
     // memory timeline graph.
@@ -565,5 +637,17 @@ Status ConvertXSpaceToMemoryProfileJson(const XSpace& xspace,
   return OkStatus();
 }
 
+Status ConvertXSpaceToMemoryProfileProto(const XSpace& xspace,
+                                         std::string* proto_output) {
+  if (const XPlane* host_plane =
+          FindPlaneWithName(xspace, kHostThreadsPlaneName)) {
+    MemoryProfile memory_profile = ConvertXPlaneToMemoryProfile(*host_plane);
+    if (!memory_profile.SerializeToString(proto_output)) {
+      return errors::Internal("Could not serialize the memory profile.");
+    }
+  }
+  return OkStatus();
+}
+
 }  // namespace profiler
 }  // namespace tensorflow
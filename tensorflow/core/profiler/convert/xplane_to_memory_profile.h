@@ -32,6 +32,12 @@ MemoryProfile ConvertXPlaneToMemoryProfile(const XPlane& host_plane,
 
 Status ConvertXSpaceToMemoryProfileJson(const XSpace& xspace,
                                         std::string* json_output);
+
+// Same as above, but outputs the MemoryProfile as a serialized proto, which is
+// much more compact than JSON for tools outside of TensorBoard.
+Status ConvertXSpaceToMemoryProfileProto(const XSpace& xspace,
+                                         std::string* proto_output);
+
 }  // namespace profiler
 }  // namespace tensorflow
 
@@ -120,6 +120,20 @@ TEST(ConvertXPlaneToMemoryProfile, OneAllocatorMultiActivitiesTest) {
   EXPECT_EQ(
       allocator_memory_profile.special_allocations().at(1).allocation_bytes(),
       2000);
+  // Only the allocation of "mul_grad/Sum" is live at the peak.
+  ASSERT_EQ(allocator_memory_profile.op_memory_usage_size(), 2);
+  const OpMemoryUsage& peak_op = allocator_memory_profile.op_memory_usage(0);
+  EXPECT_EQ(peak_op.tf_op_name(), "mul_grad/Sum");
+  EXPECT_EQ(peak_op.peak_bytes(), 300);
+  EXPECT_EQ(peak_op.num_allocations_at_peak(), 1);
+  EXPECT_EQ(peak_op.max_live_bytes(), 300);
+  const OpMemoryUsage& freed_op = allocator_memory_profile.op_memory_usage(1);
+  EXPECT_EQ(freed_op.tf_op_name(), "foo/bar");
+  EXPECT_EQ(freed_op.peak_bytes(), 0);
+  EXPECT_EQ(freed_op.num_allocations_at_peak(), 0);
+  EXPECT_EQ(freed_op.max_live_bytes(), 256);
+  EXPECT_EQ(freed_op.total_allocated_bytes(), 256);
+  EXPECT_EQ(freed_op.num_allocations(), 1);
 }
 
 }  // namespace
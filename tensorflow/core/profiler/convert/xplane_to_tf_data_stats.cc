@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/xplane_to_tf_data_stats.h"
 
+#include <algorithm>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
@@ -27,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/protobuf/tf_data_stats.pb.h"
 #include "tensorflow/core/profiler/utils/group_events.h"
 #include "tensorflow/core/profiler/utils/html_utils.h"
+#include "tensorflow/core/profiler/utils/math_utils.h"
 #include "tensorflow/core/profiler/utils/tf_op_utils.h"
 #include "tensorflow/core/profiler/utils/tf_xplane_visitor.h"
 #include "tensorflow/core/profiler/utils/timespan.h"
@@ -41,6 +45,12 @@ const int64_t kSlowCallThresholdPs = 50 * 1000000;
 
 namespace {
 
+// Value of the iterator parameters that could not be read without blocking.
+constexpr absl::string_view kParamUnavailable = "unavailable";
+
+// A consumer buffer filled below this fraction is starved by its input.
+constexpr double kLowBufferUtilization = 0.5;
+
 // Returns true if the given iterator event is for a root iterator.
 bool IsRootIteratorEvent(const XEventVisitor& iterator_event) {
   std::vector<absl::string_view> split_result =
@@ -69,7 +79,27 @@ void SetIteratorMetadata(int64_t id, const XEventVisitor& event,
   metadata->set_name(IteratorName(event.Name()));
   metadata->set_long_name(event.Name().data(), event.Name().size());
   metadata->set_is_async(IsAsyncIterator(metadata->name()));
-  // TODO(b/161831651): Set params.
+}
+
+// Sets the parameters of the iterator (e.g., parallelism) from the stats of
+// the event that are not known stat types. Parameters change as the iterator
+// is autotuned, so they are updated with every event of the iterator.
+void SetIteratorParams(const XEventVisitor& event,
+                       IteratorMetadata* metadata) {
+  event.ForEachStat([&](const XStatVisitor& stat) {
+    if (stat.Type().has_value()) return;
+    std::string value = stat.ToString();
+    if (value == kParamUnavailable) return;
+    (*metadata->mutable_params())[std::string(stat.Name())] = std::move(value);
+  });
+}
+
+// Returns the integer value of the iterator parameter `name`, or 0.
+int64_t GetIntParam(const IteratorMetadata& metadata, absl::string_view name) {
+  int64_t value = 0;
+  auto* param = gtl::FindOrNull(metadata.params(), std::string(name));
+  if (param == nullptr || !absl::SimpleAtoi(*param, &value)) return 0;
+  return value;
 }
 
 // Returns the parent iterator's id if it is a root of a device input
@@ -109,6 +139,7 @@ void ProcessEventForest(
       // First time processing this iterator.
       SetIteratorMetadata(iterator_id, iterator_event_visitor, &metadata);
     }
+    SetIteratorParams(iterator_event_visitor, &metadata);
     if (IsRootIteratorEvent(iterator_event_visitor)) {
       // Record root iterator events.
       (*root_iterator_event_map)[iterator_id].push_back(&iterator_event);
@@ -188,6 +219,15 @@ void ProcessIteratorEvent(const EventNode& iterator_event,
   iterator_stat.set_self_time_ps(iterator_stat.self_time_ps() + self_time_ps);
   iterator_stat.set_is_blocking(iterator_stat.is_blocking() || is_blocking);
   iterator_stat.set_num_calls(iterator_stat.num_calls() + 1);
+  if (auto stat = visitor.GetStat(StatType::kModelProcessingTimeNs)) {
+    iterator_stat.set_model_processing_time_ps(
+        NanoToPico(stat->IntOrUintValue()));
+  }
+  if (auto stat = visitor.GetStat(StatType::kModelBufferedElements)) {
+    iterator_stat.set_model_buffered_elements(
+        std::max(iterator_stat.model_buffered_elements(),
+                 static_cast<int64_t>(stat->IntOrUintValue())));
+  }
 }
 
 void SetBottleneckIteratorId(InputPipelineStat* input_pipeline_stat) {
@@ -257,25 +297,74 @@ void ProcessInputPipelines(
   }
 }
 
+// Sets what the tf.data autotuning model recorded about the bottleneck
+// iterator of `input_pipeline_stat` and the buffer consuming it.
+void SetModelStats(const TfDataStats& tf_data_stats,
+                   const InputPipelineStat& input_pipeline_stat,
+                   TfDataBottleneckAnalysis* bottleneck_analysis) {
+  const int64_t iterator_id = input_pipeline_stat.bottleneck_iterator_id();
+  const IteratorMetadata& metadata =
+      tf_data_stats.iterator_metadata().at(iterator_id);
+  if (const IteratorStat* iterator_stat =
+          gtl::FindOrNull(input_pipeline_stat.iterator_stats(), iterator_id)) {
+    bottleneck_analysis->set_iterator_processing_time_ps(
+        iterator_stat->model_processing_time_ps());
+  }
+  bottleneck_analysis->set_iterator_parallelism(
+      GetIntParam(metadata, "parallelism"));
+  auto* autotune = gtl::FindOrNull(metadata.params(), "autotune");
+  bottleneck_analysis->set_iterator_autotuned(autotune != nullptr &&
+                                              *autotune == "true");
+  // Finds the closest asynchronous iterator consuming the bottleneck.
+  int64_t parent_id = metadata.parent_id();
+  for (int depth = 0; parent_id != 0 && depth < 100; ++depth) {
+    const IteratorMetadata* parent_metadata =
+        gtl::FindOrNull(tf_data_stats.iterator_metadata(), parent_id);
+    if (parent_metadata == nullptr) return;
+    if (parent_metadata->is_async()) {
+      const IteratorStat* parent_stat =
+          gtl::FindOrNull(input_pipeline_stat.iterator_stats(), parent_id);
+      if (parent_stat == nullptr) return;
+      // Prefetch buffers up to its buffer limit, and parallel transformations
+      // up to their parallelism.
+      int64_t capacity = GetIntParam(*parent_metadata, "buffer_limit");
+      if (capacity == 0) {
+        capacity = GetIntParam(*parent_metadata, "parallelism");
+      }
+      bottleneck_analysis->set_consumer_buffered_elements(
+          parent_stat->model_buffered_elements());
+      bottleneck_analysis->set_consumer_buffer_capacity(capacity);
+      return;
+    }
+    parent_id = parent_metadata->parent_id();
+  }
+}
+
 void SetBottleneckAnalysis(CombinedTfDataStats* combined_tf_data_stats) {
   struct InputPipeline {
     InputPipeline(absl::string_view host_name,
                   absl::string_view input_pipeline_name, int64_t max_latency_ps,
                   absl::string_view iterator_name,
                   absl::string_view iterator_long_name,
-                  int64_t iterator_latency_ps)
+                  int64_t iterator_latency_ps,
+                  const TfDataStats* tf_data_stats,
+                  const InputPipelineStat* input_pipeline_stat)
         : host_name(host_name),
           input_pipeline_name(input_pipeline_name),
           max_latency_ps(max_latency_ps),
           iterator_name(iterator_name),
           iterator_long_name(iterator_long_name),
-          iterator_latency_ps(iterator_latency_ps) {}
+          iterator_latency_ps(iterator_latency_ps),
+          tf_data_stats(tf_data_stats),
+          input_pipeline_stat(input_pipeline_stat) {}
     absl::string_view host_name;
     absl::string_view input_pipeline_name;
     int64_t max_latency_ps;
     absl::string_view iterator_name;
     absl::string_view iterator_long_name;
     int64_t iterator_latency_ps;
+    const TfDataStats* tf_data_stats;
+    const InputPipelineStat* input_pipeline_stat;
 
     bool operator<(const InputPipeline& rhs) const {
       return max_latency_ps > rhs.max_latency_ps;
@@ -303,7 +392,8 @@ void SetBottleneckAnalysis(CombinedTfDataStats* combined_tf_data_stats) {
           host_name, input_pipeline_stats.metadata().name(),
           input_pipeline_stats.max_latency_ps(), metadata.name(),
           metadata.long_name(),
-          input_pipeline_stat.bottleneck_iterator_latency_ps());
+          input_pipeline_stat.bottleneck_iterator_latency_ps(), &tf_data_stats,
+          &input_pipeline_stat);
     }
   }
   std::sort(slow_input_pipelines.begin(), slow_input_pipelines.end());
@@ -323,6 +413,8 @@ void SetBottleneckAnalysis(CombinedTfDataStats* combined_tf_data_stats) {
         input_pipeline.iterator_long_name.size());
     bottleneck_analysis->set_iterator_latency_ps(
         input_pipeline.iterator_latency_ps);
+    SetModelStats(*input_pipeline.tf_data_stats,
+                  *input_pipeline.input_pipeline_stat, bottleneck_analysis);
   }
 }
 
@@ -406,11 +498,55 @@ std::string GetSuggestion(BottleneckType type) {
   }
 }
 
+// Returns what the tf.data autotuning model tells about the bottleneck, or an
+// empty string if it was not modeled.
+std::string GetModelSuggestion(
+    const TfDataBottleneckAnalysis& bottleneck_analysis) {
+  std::string suggestion;
+  if (bottleneck_analysis.iterator_processing_time_ps() > 0) {
+    absl::StrAppendFormat(
+        &suggestion, "This iterator takes %.1f us to produce an element.<br/>",
+        PicoToMicro(bottleneck_analysis.iterator_processing_time_ps()));
+  }
+  if (bottleneck_analysis.iterator_parallelism() > 0) {
+    if (bottleneck_analysis.iterator_autotuned()) {
+      absl::StrAppendFormat(
+          &suggestion,
+          "Its parallelism is autotuned to %d. If the host has idle cores, "
+          "raise the autotuning CPU budget; otherwise <code>cache</code> its "
+          "output or move the transformation offline.<br/>",
+          bottleneck_analysis.iterator_parallelism());
+    } else {
+      absl::StrAppendFormat(
+          &suggestion,
+          "Its parallelism is fixed to %d. Set "
+          "<code>num_parallel_calls=tf.data.AUTOTUNE</code> to let tf.data "
+          "tune it.<br/>",
+          bottleneck_analysis.iterator_parallelism());
+    }
+  }
+  if (bottleneck_analysis.consumer_buffer_capacity() > 0) {
+    const double utilization =
+        static_cast<double>(bottleneck_analysis.consumer_buffered_elements()) /
+        bottleneck_analysis.consumer_buffer_capacity();
+    if (utilization < kLowBufferUtilization) {
+      absl::StrAppendFormat(
+          &suggestion,
+          "The buffer consuming this iterator held at most %d of %d elements, "
+          "so the downstream pipeline waits on it.<br/>",
+          bottleneck_analysis.consumer_buffered_elements(),
+          bottleneck_analysis.consumer_buffer_capacity());
+    }
+  }
+  return suggestion;
+}
+
 void SetSuggestion(CombinedTfDataStats* combined_tf_data_stats) {
   for (TfDataBottleneckAnalysis& bottleneck_analysis :
        *combined_tf_data_stats->mutable_bottleneck_analysis()) {
-    bottleneck_analysis.set_suggestion(
-        GetSuggestion(GetBottleneckType(bottleneck_analysis.iterator_name())));
+    bottleneck_analysis.set_suggestion(absl::StrCat(
+        GetModelSuggestion(bottleneck_analysis),
+        GetSuggestion(GetBottleneckType(bottleneck_analysis.iterator_name()))));
   }
 }
 
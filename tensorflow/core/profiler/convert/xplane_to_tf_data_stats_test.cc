@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/xplane_to_tf_data_stats.h"
 
+#include <cstdint>
+#include <utility>
+
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/profiler/protobuf/tf_data_stats.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
@@ -27,6 +31,27 @@ namespace profiler {
 namespace {
 
 using ::testing::EqualsProto;
+using ::testing::HasSubstr;
+
+// Adds an iterator event with the given stats, and the given parameters as
+// stats of unknown types, like the iterator's TraceMe metadata.
+void AddIteratorEvent(
+    XPlaneBuilder* plane, XLineBuilder* line, absl::string_view name,
+    int64_t offset_ps, int64_t duration_ps,
+    std::initializer_list<std::pair<StatType, int64_t>> stats,
+    std::initializer_list<std::pair<absl::string_view, absl::string_view>>
+        params = {}) {
+  XEventBuilder event = line->AddEvent(*plane->GetOrCreateEventMetadata(name));
+  event.SetOffsetPs(offset_ps);
+  event.SetDurationPs(duration_ps);
+  for (const auto& [type, value] : stats) {
+    event.AddStatValue(*plane->GetOrCreateStatMetadata(GetStatTypeStr(type)),
+                       value);
+  }
+  for (const auto& [key, value] : params) {
+    event.AddStatValue(*plane->GetOrCreateStatMetadata(key), value);
+  }
+}
 
 // Test with the following example dataset:
 // dataset = tf.data.Dataset.range(8)
@@ -411,6 +436,86 @@ TEST(XPlaneToTfDataStatsTest, MapAndBatch) {
       )pb"));
 }
 
+// Test with the following example dataset:
+// dataset = tf.data.Dataset.range(8)
+// dataset = dataset.map(f, num_parallel_calls=2)
+// dataset = dataset.prefetch(4)
+// for _ in dataset:
+//   pass
+TEST(XPlaneToTfDataStatsTest, ModelStats) {
+  constexpr int64_t kPrefetchIteratorId = 123;
+  constexpr int64_t kParallelMapIteratorId = 456;
+  constexpr int64_t kFirstElementId = 100;
+  constexpr int64_t kSecondElementId = 200;
+
+  XPlane host_plane;
+  XPlaneBuilder host_plane_builder(&host_plane);
+  host_plane_builder.ReserveLines(2);
+
+  XLineBuilder consumer_thread = host_plane_builder.GetOrCreateLine(0);
+  AddIteratorEvent(&host_plane_builder, &consumer_thread, "Iterator::Prefetch",
+                   0, 100000000,
+                   {{StatType::kStepId, kPrefetchIteratorId},
+                    {StatType::kModelBufferedElements, 1}},
+                   {{"buffer_limit", "4"}});
+  CreateXEvent(&host_plane_builder, &consumer_thread,
+               HostEventType::kPrefetchConsume, 80000000, 20000000,
+               {{StatType::kElementId, kFirstElementId}});
+  AddIteratorEvent(&host_plane_builder, &consumer_thread, "Iterator::Prefetch",
+                   200000000, 20000000,
+                   {{StatType::kStepId, kPrefetchIteratorId},
+                    {StatType::kModelBufferedElements, 0}},
+                   {{"buffer_limit", "4"}});
+  CreateXEvent(&host_plane_builder, &consumer_thread,
+               HostEventType::kPrefetchConsume, 210000000, 10000000,
+               {{StatType::kElementId, kSecondElementId}});
+
+  XLineBuilder producer_thread = host_plane_builder.GetOrCreateLine(1);
+  CreateXEvent(&host_plane_builder, &producer_thread,
+               HostEventType::kPrefetchProduce, 0, 80000000,
+               {{StatType::kElementId, kFirstElementId}});
+  AddIteratorEvent(&host_plane_builder, &producer_thread,
+                   "Iterator::Prefetch::ParallelMap", 0, 80000000,
+                   {{StatType::kStepId, kParallelMapIteratorId},
+                    {StatType::kParentId, kPrefetchIteratorId},
+                    {StatType::kModelProcessingTimeNs, 80000}},
+                   {{"autotune", "false"}, {"parallelism", "2"}});
+  CreateXEvent(&host_plane_builder, &producer_thread,
+               HostEventType::kPrefetchProduce, 100000000, 80000000,
+               {{StatType::kElementId, kSecondElementId}});
+  AddIteratorEvent(&host_plane_builder, &producer_thread,
+                   "Iterator::Prefetch::ParallelMap", 100000000, 80000000,
+                   {{StatType::kStepId, kParallelMapIteratorId},
+                    {StatType::kParentId, kPrefetchIteratorId},
+                    {StatType::kModelProcessingTimeNs, 80000}},
+                   {{"autotune", "false"}, {"parallelism", "unavailable"}});
+
+  CombinedTfDataStats combined_tf_data_stats;
+  CombinedTfDataStatsBuilder builder(&combined_tf_data_stats);
+  builder.Add("host1", &host_plane);
+  builder.Finalize();
+
+  const IteratorMetadata& metadata =
+      combined_tf_data_stats.tf_data_stats().at("host1").iterator_metadata().at(
+          kParallelMapIteratorId);
+  EXPECT_EQ(metadata.params().at("parallelism"), "2");
+  EXPECT_EQ(metadata.params().at("autotune"), "false");
+
+  ASSERT_EQ(combined_tf_data_stats.bottleneck_analysis_size(), 1);
+  const TfDataBottleneckAnalysis& bottleneck_analysis =
+      combined_tf_data_stats.bottleneck_analysis(0);
+  EXPECT_EQ(bottleneck_analysis.iterator_name(), "ParallelMap");
+  EXPECT_EQ(bottleneck_analysis.iterator_processing_time_ps(), 80000000);
+  EXPECT_EQ(bottleneck_analysis.iterator_parallelism(), 2);
+  EXPECT_FALSE(bottleneck_analysis.iterator_autotuned());
+  EXPECT_EQ(bottleneck_analysis.consumer_buffered_elements(), 1);
+  EXPECT_EQ(bottleneck_analysis.consumer_buffer_capacity(), 4);
+  EXPECT_THAT(bottleneck_analysis.suggestion(),
+              HasSubstr("num_parallel_calls=tf.data.AUTOTUNE"));
+  EXPECT_THAT(bottleneck_analysis.suggestion(),
+              HasSubstr("held at most 1 of 4 elements"));
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -120,20 +120,25 @@ StatusOr<std::string> ConvertMultiXSpacesToKernelStats(
 }
 
 StatusOr<std::string> ConvertXSpaceToMemoryProfile(
-    const SessionSnapshot& session_snapshot) {
+    const SessionSnapshot& session_snapshot, const ToolOptions& options) {
   if (session_snapshot.XSpaceSize() != 1) {
     return errors::InvalidArgument(
         "Memory profile tool expects only 1 XSpace path but gets ",
         session_snapshot.XSpaceSize());
   }
 
-  std::string json_output;
+  std::string output;
   TF_ASSIGN_OR_RETURN(std::unique_ptr<XSpace> xspace,
                       session_snapshot.GetXSpace(0));
   PreprocessSingleHostXSpace(xspace.get(), /*step_grouping=*/true,
                              /*derived_timeline=*/false);
-  TF_RETURN_IF_ERROR(ConvertXSpaceToMemoryProfileJson(*xspace, &json_output));
-  return json_output;
+  // The "proto" format outputs the serialized MemoryProfile instead of JSON.
+  if (GetParamWithDefault<std::string>(options, "format", "json") == "proto") {
+    TF_RETURN_IF_ERROR(ConvertXSpaceToMemoryProfileProto(*xspace, &output));
+  } else {
+    TF_RETURN_IF_ERROR(ConvertXSpaceToMemoryProfileJson(*xspace, &output));
+  }
+  return output;
 }
 
 StatusOr<std::string> ConvertMultiXSpacesToPodViewer(
@@ -245,7 +250,7 @@ StatusOr<std::string> ConvertMultiXSpacesToToolData(
   } else if (tool_name == "kernel_stats") {
     return ConvertMultiXSpacesToKernelStats(session_snapshot);
   } else if (tool_name == "memory_profile") {
-    return ConvertXSpaceToMemoryProfile(session_snapshot);
+    return ConvertXSpaceToMemoryProfile(session_snapshot, options);
   } else if (tool_name == "pod_viewer") {
     return ConvertMultiXSpacesToPodViewer(session_snapshot);
   } else if (tool_name == "tf_data_bottleneck_analysis") {
@@ -24,6 +24,7 @@ namespace tensorflow {
 namespace profiler {
 
 using tsl::profiler::CreateProfilerService;  // NOLINT
+using tsl::profiler::MonitorFunction;        // NOLINT
 
 }  // namespace profiler
 }  // namespace tensorflow
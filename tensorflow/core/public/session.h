@@ -279,6 +279,39 @@ class Session {
         "RunCallable with threadpool is not supported for this session.");
   }
 
+  /// \brief Invokes the subgraph named by `handle` like `RunCallable()`, but
+  /// takes ownership of `feed_tensors`.
+  ///
+  /// The session may move the fed tensors into the subgraph, so that the
+  /// kernels reading them can forward their buffers to their outputs instead
+  /// of allocating new ones. The buffers of fed tensors are only reused if
+  /// no other tensor refers to them. After the call, `feed_tensors` is left
+  /// in a valid but unspecified state.
+  ///
+  /// The default implementation runs the callable without consuming the
+  /// feeds.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status RunCallable(CallableHandle handle,
+                             std::vector<Tensor>&& feed_tensors,
+                             std::vector<Tensor>* fetch_tensors,
+                             RunMetadata* run_metadata) {
+    const std::vector<Tensor>& unowned_feed_tensors = feed_tensors;
+    return RunCallable(handle, unowned_feed_tensors, fetch_tensors,
+                       run_metadata);
+  }
+
+  /// \brief Like the above, with a custom threadpool implementation provided
+  /// via `threadpool_options`.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status RunCallable(
+      CallableHandle handle, std::vector<Tensor>&& feed_tensors,
+      std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options) {
+    const std::vector<Tensor>& unowned_feed_tensors = feed_tensors;
+    return RunCallable(handle, unowned_feed_tensors, fetch_tensors,
+                       run_metadata, threadpool_options);
+  }
+
   /// \brief Releases resources associated with the given `handle` in this
   /// session.
   /// NOTE: This API is still experimental and may change.
@@ -15,7 +15,10 @@ limitations under the License.
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
 
 #include <string>
+#include <utility>
 
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
 
 namespace tensorflow {
@@ -163,6 +166,15 @@ void OpKernelRunner::Run(OpKernelContext* context) const {
            << op_kernel_->def().DebugString()
            << ", on Device: " << context->device()->name();
 
+  if (TF_PREDICT_FALSE(metrics::ShouldSampleOpKernelExecution())) {
+    const uint64_t start_nsecs = EnvTime::NowNanos();
+    static_cast<tensorflow::Device*>(context->device())
+        ->Compute(op_kernel_.get(), context);
+    metrics::RecordOpKernelExecution(context,
+                                     EnvTime::NowNanos() - start_nsecs);
+    return;
+  }
+
   static_cast<tensorflow::Device*>(context->device())
       ->Compute(op_kernel_.get(), context);
 }
@@ -176,6 +188,15 @@ void OpKernelRunner::RunAsync(OpKernelContext* context,
   AsyncOpKernel* async = op_kernel_->AsAsync();
   DCHECK(async);
 
+  if (TF_PREDICT_FALSE(metrics::ShouldSampleOpKernelExecution())) {
+    done_callback = [context, start_nsecs = EnvTime::NowNanos(),
+                     done_callback = std::move(done_callback)]() {
+      metrics::RecordOpKernelExecution(context,
+                                       EnvTime::NowNanos() - start_nsecs);
+      done_callback();
+    };
+  }
+
   static_cast<tensorflow::Device*>(context->device())
       ->ComputeAsync(async, context, std::move(done_callback));
 }
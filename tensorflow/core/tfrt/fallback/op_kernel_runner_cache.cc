@@ -18,11 +18,31 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/casts.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
+namespace {
+
+// Returns the registered OpDef of `op_name`, or nullptr for function calls
+// and unknown ops.
+const OpDef* LookUpRegisteredOpDef(absl::string_view op_name) {
+  const OpDef* op_def = nullptr;
+  if (!OpRegistry::Global()->LookUpOpDef(std::string(op_name), &op_def).ok())
+    return nullptr;
+  return op_def;
+}
+
+}  // namespace
 
 StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     tfrt::Location loc, absl::string_view op_name,
@@ -55,12 +75,17 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
   std::string node_name = absl::StrCat(
       op_name, "_", loc.data, "_", absl::bit_cast<uintptr_t>(loc.GetHandler()));
 
-  TF_ASSIGN_OR_RETURN(
-      auto runner, OpKernelRunner::Create(
-                       op_name, node_name, device_name, num_args, attr_builder,
-                       device_manager, process_function_library_runtime));
-
-  auto runner_uptr = std::make_unique<OpKernelRunner>(std::move(runner));
+  auto runner_uptr =
+      TakePrewarmed(loc, op_name, device_name, num_args, attr_builder);
+  if (runner_uptr == nullptr) {
+    TF_ASSIGN_OR_RETURN(
+        auto runner, OpKernelRunner::Create(
+                         op_name, node_name, device_name, num_args,
+                         attr_builder, device_manager,
+                         process_function_library_runtime));
+    runner_uptr = std::make_unique<OpKernelRunner>(std::move(runner));
+  }
+  RecordManifestEntry(loc, device_name, num_args, *runner_uptr);
 
   auto* runner_ptr = runner_uptr.get();
   auto r = map_.emplace(key, std::move(runner_uptr)).second;
@@ -69,5 +94,112 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
   return runner_ptr;
 }
 
+std::unique_ptr<OpKernelRunner> OpKernelRunnerCache::TakePrewarmed(
+    tfrt::Location loc, absl::string_view op_name,
+    absl::string_view device_name, int num_args,
+    const std::function<Status(tensorflow::AttrValueMap*)>& attr_builder) {
+  auto it = prewarmed_.find(loc.data);
+  if (it == prewarmed_.end()) return nullptr;
+  PrewarmedRunner prewarmed = std::move(it->second);
+  prewarmed_.erase(it);
+
+  const auto& entry = prewarmed.entry;
+  if (entry.op_name() != op_name || entry.device_name() != device_name ||
+      entry.num_args() != num_args) {
+    return nullptr;
+  }
+
+  const OpDef* op_def = LookUpRegisteredOpDef(op_name);
+  if (op_def == nullptr) return nullptr;
+
+  NodeDef node_def;
+  node_def.set_op(std::string(op_name));
+  if (!attr_builder(node_def.mutable_attr()).ok()) return nullptr;
+  AddDefaultsToNodeDef(*op_def, &node_def);
+
+  if (node_def.attr_size() != entry.attr_size()) return nullptr;
+  for (const auto& [name, value] : node_def.attr()) {
+    auto attr_it = entry.attr().find(name);
+    if (attr_it == entry.attr().end() ||
+        !AreAttrValuesEqual(attr_it->second, value)) {
+      return nullptr;
+    }
+  }
+
+  VLOG(1) << "KernelFallbackExecuteCompat using pre-warmed op " << op_name
+          << " at location " << loc.data;
+  return std::move(prewarmed.runner);
+}
+
+void OpKernelRunnerCache::RecordManifestEntry(tfrt::Location loc,
+                                              absl::string_view device_name,
+                                              int num_args,
+                                              const OpKernelRunner& runner) {
+  const NodeDef& node_def = runner.op_kernel()->def();
+  const OpDef* op_def = LookUpRegisteredOpDef(node_def.op());
+  if (op_def == nullptr || op_def->is_stateful()) return;
+
+  auto* entry = manifest_.add_entries();
+  entry->set_location(loc.data);
+  entry->set_op_name(node_def.op());
+  entry->set_device_name(std::string(device_name));
+  entry->set_num_args(num_args);
+  *entry->mutable_attr() = node_def.attr();
+}
+
+OpKernelRunnerManifestProto OpKernelRunnerCache::ExportManifest() const {
+  tf_shared_lock lock(mu_);
+  return manifest_;
+}
+
+void OpKernelRunnerCache::Prewarm(
+    const OpKernelRunnerManifestProto& manifest,
+    const tensorflow::DeviceMgr& device_manager,
+    const tensorflow::ProcessFunctionLibraryRuntime&
+        process_function_library_runtime,
+    thread::ThreadPool* thread_pool) {
+  std::vector<std::unique_ptr<OpKernelRunner>> runners(
+      manifest.entries_size());
+
+  auto create = [&](int i) {
+    const auto& entry = manifest.entries(i);
+    auto runner = OpKernelRunner::Create(
+        entry.op_name(),
+        absl::StrCat(entry.op_name(), "_", entry.location(), "_prewarmed"),
+        entry.device_name(), entry.num_args(),
+        [&entry](tensorflow::AttrValueMap* attr_value_map) {
+          attr_value_map->insert(entry.attr().begin(), entry.attr().end());
+          return OkStatus();
+        },
+        device_manager, process_function_library_runtime);
+    if (!runner.ok()) {
+      VLOG(1) << "Failed to pre-warm op " << entry.op_name() << " at location "
+              << entry.location() << ": " << runner.status();
+      return;
+    }
+    runners[i] = std::make_unique<OpKernelRunner>(std::move(runner).value());
+  };
+
+  if (thread_pool == nullptr) {
+    for (int i = 0; i < manifest.entries_size(); ++i) create(i);
+  } else {
+    BlockingCounter counter(manifest.entries_size());
+    for (int i = 0; i < manifest.entries_size(); ++i) {
+      thread_pool->Schedule([&, i]() {
+        create(i);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+
+  mutex_lock lock(mu_);
+  for (int i = 0; i < manifest.entries_size(); ++i) {
+    if (runners[i] == nullptr) continue;
+    const auto& entry = manifest.entries(i);
+    prewarmed_[entry.location()] = {entry, std::move(runners[i])};
+  }
+}
+
 }  // namespace tfrt_stub
 }  // namespace tensorflow
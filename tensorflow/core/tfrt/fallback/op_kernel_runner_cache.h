@@ -18,8 +18,11 @@ limitations under the License.
 #include <functional>
 #include <memory>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
+#include "tensorflow/core/tfrt/fallback/op_kernel_runner_manifest.pb.h"
 #include "tfrt/host_context/location.h"  // from @tf_runtime
 
 namespace tensorflow {
@@ -47,6 +50,10 @@ class OpLocationKey {
 };
 
 // OpKernelRunnerCache is similar to OpKernelRunnerTable but thread-safe.
+//
+// The kernels created by a cache can be exported as a manifest, which can be
+// used to pre-warm the cache of a later load of the same BEF file, so that
+// kernel creation does not happen on the first requests.
 class OpKernelRunnerCache {
  public:
   OpKernelRunnerCache() = default;
@@ -59,10 +66,46 @@ class OpKernelRunnerCache {
       const tensorflow::ProcessFunctionLibraryRuntime&
           process_function_library_runtime);
 
+  // Returns the kernels created by this cache so far. Stateful ops are not
+  // included, as their kernels may depend on the node name, which includes
+  // the per-load LocationHandler.
+  OpKernelRunnerManifestProto ExportManifest() const;
+
+  // Creates the kernels in `manifest` ahead of their first use, in parallel on
+  // `thread_pool` if it is not null. A pre-warmed kernel is only used by
+  // GetOrCreate() when the op at the same location has the same op name,
+  // device name, number of arguments and attributes, so a manifest from a
+  // different model version only costs the time to create unused kernels.
+  // Kernels that fail to be created are skipped.
+  void Prewarm(const OpKernelRunnerManifestProto& manifest,
+               const tensorflow::DeviceMgr& device_manager,
+               const tensorflow::ProcessFunctionLibraryRuntime&
+                   process_function_library_runtime,
+               thread::ThreadPool* thread_pool = nullptr);
+
  private:
+  struct PrewarmedRunner {
+    OpKernelRunnerManifestProto::Entry entry;
+    std::unique_ptr<OpKernelRunner> runner;
+  };
+
+  // Returns the pre-warmed kernel for `loc` if it matches the op, or nullptr.
+  std::unique_ptr<OpKernelRunner> TakePrewarmed(
+      tfrt::Location loc, absl::string_view op_name,
+      absl::string_view device_name, int num_args,
+      const std::function<Status(tensorflow::AttrValueMap*)>& attr_builder)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  void RecordManifestEntry(tfrt::Location loc, absl::string_view device_name,
+                           int num_args, const OpKernelRunner& runner)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   mutable mutex mu_;
   absl::flat_hash_map<OpLocationKey, std::unique_ptr<OpKernelRunner>> map_
       TF_GUARDED_BY(mu_);
+  // Keyed by the `data` of the BEF location.
+  absl::flat_hash_map<int64_t, PrewarmedRunner> prewarmed_ TF_GUARDED_BY(mu_);
+  OpKernelRunnerManifestProto manifest_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tfrt_stub
@@ -23,10 +23,13 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
+#include "tensorflow/core/tfrt/fallback/op_kernel_runner_manifest.pb.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
@@ -120,6 +123,64 @@ TEST(OpKernelRunnerTest, OpKernelRunnerCache) {
   EXPECT_EQ(runner->op_kernel()->name(), "TestOp_100_0");
 }
 
+TEST(OpKernelRunnerTest, OpKernelRunnerCachePrewarm) {
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state,
+                          FallbackState::Create(session_options, fdef_lib));
+
+  constexpr char kDeviceName[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+  auto get_or_create = [&](OpKernelRunnerCache& cache, tfrt::Location loc,
+                           absl::string_view device_name) {
+    return cache.GetOrCreate(
+        loc,
+        /*op_name=*/"TestOp", device_name,
+        /*num_args=*/1,
+        /*attr_builder=*/[](tensorflow::AttrValueMap*) { return OkStatus(); },
+        fallback_state->device_manager(),
+        fallback_state->process_function_library_runtime());
+  };
+
+  OpKernelRunnerCache cache;
+  TF_ASSERT_OK(
+      get_or_create(cache, tfrt::Location(/*handler=*/nullptr, /*data=*/100),
+                    kDeviceName)
+          .status());
+  TF_ASSERT_OK(
+      get_or_create(cache, tfrt::Location(/*handler=*/nullptr, /*data=*/200),
+                    kDeviceName)
+          .status());
+
+  auto manifest = cache.ExportManifest();
+  ASSERT_THAT(manifest.entries(), SizeIs(2));
+  EXPECT_EQ(manifest.entries(0).location(), 100);
+  EXPECT_EQ(manifest.entries(0).op_name(), "TestOp");
+  EXPECT_EQ(manifest.entries(0).device_name(), kDeviceName);
+  EXPECT_EQ(manifest.entries(0).num_args(), 1);
+
+  thread::ThreadPool thread_pool(Env::Default(), "test", /*num_threads=*/2);
+  OpKernelRunnerCache prewarmed_cache;
+  prewarmed_cache.Prewarm(manifest, fallback_state->device_manager(),
+                          fallback_state->process_function_library_runtime(),
+                          &thread_pool);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto* runner,
+      get_or_create(prewarmed_cache,
+                    tfrt::Location(/*handler=*/nullptr, /*data=*/100),
+                    kDeviceName));
+  EXPECT_EQ(runner->op_kernel()->name(), "TestOp_100_prewarmed");
+
+  // A pre-warmed kernel for a different device is not used.
+  TF_ASSERT_OK_AND_ASSIGN(
+      runner, get_or_create(prewarmed_cache,
+                            tfrt::Location(/*handler=*/nullptr, /*data=*/200),
+                            "/device:CPU:0"));
+  EXPECT_EQ(runner->op_kernel()->name(), "TestOp_200_0");
+
+  EXPECT_THAT(prewarmed_cache.ExportManifest().entries(), SizeIs(2));
+}
+
 TEST(OpKernelRunnerTest, OpKernelRunState) {
   SessionOptions options;
   auto* device_count = options.config.mutable_device_count();
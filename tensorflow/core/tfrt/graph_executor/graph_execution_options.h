@@ -15,9 +15,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTION_OPTIONS_H_
 #define TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTION_OPTIONS_H_
 
+#include <functional>
 #include <optional>
 #include <ostream>
 
+#include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "tensorflow/compiler/mlir/tfrt/translate/tfrt_compile_options.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -27,6 +29,19 @@ limitations under the License.
 namespace tensorflow {
 namespace tfrt_stub {
 
+// The time spent in each phase of a GraphExecutor::Run() call.
+struct GraphExecutionRunPhaseTimes {
+  // Sorting the input and output names and arranging the inputs.
+  absl::Duration input_conversion;
+  // Looking up the client graph, including importing, compiling and
+  // initializing it if it is not cached yet.
+  absl::Duration client_graph_lookup;
+  // Executing the compiled graph.
+  absl::Duration execution;
+  // Arranging the outputs in the requested order.
+  absl::Duration output_conversion;
+};
+
 // General options for graph execution.
 struct GraphExecutionOptions {
   explicit GraphExecutionOptions(const tensorflow::tfrt_stub::Runtime* rt)
@@ -53,6 +68,10 @@ struct GraphExecutionOptions {
   tensorflow::SessionMetadata model_metadata;
 
   tensorflow::TfrtCompileOptions compile_options;
+
+  // If set, called with the phase times of every successful
+  // GraphExecutor::Run(). It runs on the request thread, so it should be cheap.
+  std::function<void(const GraphExecutionRunPhaseTimes&)> run_phase_times_sink;
 };
 
 std::ostream& operator<<(std::ostream& os,
@@ -81,6 +100,10 @@ struct GraphExecutionRunOptions {
   // If true, just-in-time host compilation is disabled, and then if the
   // specified graph is not compiled, the execution will return an error.
   bool disable_compilation = false;
+
+  // If not nullptr, set to the time spent in each phase of a successful
+  // GraphExecutor::Run().
+  GraphExecutionRunPhaseTimes* phase_times = nullptr;
 };
 
 // Creates the default `SessionOptions` from a `GraphExecutionOptions`.
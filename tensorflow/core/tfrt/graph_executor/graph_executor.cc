@@ -43,12 +43,14 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tfrt/translate/import_model.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/threadpool_interface.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_execute_compat.h"
@@ -88,6 +90,33 @@ constexpr char kArgumentTypeJoiningDelimiter[] = "^";
 constexpr char kFallbackInitFunction[] = "_tfrt_fallback_init";
 constexpr char kResourceInitFunction[] = "_tfrt_resource_init";
 
+auto* graph_executor_run_phase_time_us =
+    tensorflow::monitoring::Sampler<2>::New(
+        {"/tensorflow/tfrt/graph_executor/run_phase_time",
+         "Record the time spent in each phase of GraphExecutor::Run(), in "
+         "microseconds.",
+         "model_name", "phase"},
+        // Buckets from 10us to ~3 minutes.
+        tensorflow::monitoring::Buckets::Exponential(10, 2, 25));
+
+void RecordRunPhaseTimes(const GraphExecutionOptions& options,
+                         const GraphExecutionRunOptions& run_options,
+                         const GraphExecutionRunPhaseTimes& phase_times) {
+  const std::string& model_name = options.model_metadata.name();
+  const std::pair<const char*, absl::Duration> phases[] = {
+      {"input_conversion", phase_times.input_conversion},
+      {"client_graph_lookup", phase_times.client_graph_lookup},
+      {"execution", phase_times.execution},
+      {"output_conversion", phase_times.output_conversion}};
+  for (const auto& [phase, duration] : phases) {
+    graph_executor_run_phase_time_us->GetCell(model_name, phase)
+        ->Add(absl::ToDoubleMicroseconds(duration));
+  }
+
+  if (options.run_phase_times_sink) options.run_phase_times_sink(phase_times);
+  if (run_options.phase_times != nullptr) *run_options.phase_times = phase_times;
+}
+
 }  // namespace
 
 StatusOr<std::unique_ptr<RequestInfo>> CreateRequestInfo(
@@ -354,6 +383,10 @@ tensorflow::Status GraphExecutor::Run(
     absl::Span<const std::string> target_tensor_names,
     std::vector<tensorflow::Tensor>* outputs) {
   // TODO(b/192498110): Validate input type.
+  const absl::Time run_start_time = absl::Now();
+  GraphExecutionRunPhaseTimes phase_times;
+  std::optional<tensorflow::profiler::TraceMe> phase_traceme;
+  phase_traceme.emplace("GraphExecutor::Run::InputConversion");
 
   // Sort the input/output names to have a stable order, so that the
   // `joined_name`, which is used as the cache key, will be the same as long as
@@ -384,6 +417,18 @@ tensorflow::Status GraphExecutor::Run(
                                                     target_tensor_names.end());
   std::sort(sorted_target_node_names.begin(), sorted_target_node_names.end());
 
+  // Create the actual arguments to the compiled function, which are sorted
+  // according to the input tensor names.
+  std::vector<tensorflow::Tensor> flat_inputs;
+  flat_inputs.reserve(inputs.size());
+  for (int original_index : input_original_indices) {
+    flat_inputs.push_back(inputs.at(original_index).second);
+  }
+
+  const absl::Time lookup_start_time = absl::Now();
+  phase_times.input_conversion = lookup_start_time - run_start_time;
+  phase_traceme.emplace("GraphExecutor::Run::ClientGraphLookup");
+
   // Load the client graph.
   TF_ASSIGN_OR_RETURN(const LoadedClientGraph& loaded_client_graph,
                       GetOrCreateLoadedClientGraph(
@@ -395,13 +440,9 @@ tensorflow::Status GraphExecutor::Run(
       tensorflow::kImportModelDefaultGraphFuncName);
   DCHECK(func);
 
-  // Create the actual arguments to the compiled function, which are sorted
-  // according to the input tensor names.
-  std::vector<tensorflow::Tensor> flat_inputs;
-  flat_inputs.reserve(inputs.size());
-  for (int original_index : input_original_indices) {
-    flat_inputs.push_back(inputs.at(original_index).second);
-  }
+  const absl::Time execution_start_time = absl::Now();
+  phase_times.client_graph_lookup = execution_start_time - lookup_start_time;
+  phase_traceme.reset();
 
   std::vector<tensorflow::Tensor> flat_outputs;
   TF_RETURN_IF_ERROR(GraphExecutionRunOnFunction(
@@ -409,6 +450,10 @@ tensorflow::Status GraphExecutor::Run(
       &flat_outputs, loaded_client_graph.resource_context.get(), runtime(),
       fallback_state_, &req_deadline_tracker_));
 
+  const absl::Time output_start_time = absl::Now();
+  phase_times.execution = output_start_time - execution_start_time;
+  phase_traceme.emplace("GraphExecutor::Run::OutputConversion");
+
   // Create the outputs from the actual function results, which are sorted
   // according to the output tensor names.
   auto flat_output_iter = flat_outputs.begin();
@@ -418,6 +463,10 @@ tensorflow::Status GraphExecutor::Run(
     ++flat_output_iter;
   }
 
+  phase_traceme.reset();
+  phase_times.output_conversion = absl::Now() - output_start_time;
+  RecordRunPhaseTimes(options_, run_options, phase_times);
+
   return OkStatus();
 }
 
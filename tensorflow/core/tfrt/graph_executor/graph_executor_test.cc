@@ -26,6 +26,7 @@ limitations under the License.
 #include "learning/infra/mira/mlrt/interpreter/value.h"
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/time/time.h"
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/const_op.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -201,6 +202,52 @@ TEST_F(GraphExecutorTest, DisableCompilation) {
               ::testing::ElementsAreArray({2}));
 }
 
+TEST_F(GraphExecutorTest, RunPhaseTimes) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  GraphExecutor::Options options(runtime.get());
+  int num_sink_calls = 0;
+  options.run_phase_times_sink =
+      [&num_sink_calls](const GraphExecutionRunPhaseTimes&) {
+        ++num_sink_calls;
+      };
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto fallback_state,
+      tensorflow::tfrt_stub::FallbackState::Create(
+          CreateDefaultSessionOptions(options), graph_def.library()));
+  tfrt::tpu::TpuModelResource tpu_model_resource;
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto graph_executor,
+      GraphExecutor::Create(std::move(options), *fallback_state,
+                            &tpu_model_resource, graph_def,
+                            GetKernelRegistry()));
+
+  std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+  inputs.push_back({"input", CreateTfTensor<int32_t>(
+                                 /*shape=*/{1, 3}, /*data=*/{1, 1, 1})});
+
+  std::vector<tensorflow::Tensor> outputs;
+
+  GraphExecutionRunPhaseTimes phase_times;
+  GraphExecutor::RunOptions run_options;
+  run_options.phase_times = &phase_times;
+  TF_ASSERT_OK(graph_executor->Run(run_options, inputs,
+                                   /*output_tensor_names=*/{"rank"},
+                                   /*target_tensor_names=*/{}, &outputs));
+
+  // The first run compiles the client graph.
+  EXPECT_GT(phase_times.client_graph_lookup, absl::ZeroDuration());
+  EXPECT_GT(phase_times.execution, absl::ZeroDuration());
+  EXPECT_EQ(num_sink_calls, 1);
+
+  TF_ASSERT_OK(graph_executor->Run(run_options, inputs,
+                                   /*output_tensor_names=*/{"rank"},
+                                   /*target_tensor_names=*/{}, &outputs));
+  EXPECT_EQ(num_sink_calls, 2);
+}
+
 TEST_F(GraphExecutorTest, SyncExecute) {
   GraphDef graph_def;
   TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
@@ -13,9 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <atomic>
+#include <limits>
+#include <vector>
 #define EIGEN_USE_THREADS
 
+#include "absl/time/time.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -40,6 +44,19 @@ namespace {
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+// The thread time used by the requests of a model with a CPU quota in the
+// current quota window.
+struct ModelCpuUsage {
+  explicit ModelCpuUsage(int64_t budget_us) : budget_us(budget_us) {}
+
+  bool over_quota() const {
+    return consumed_us.load(std::memory_order_relaxed) >= budget_us;
+  }
+
+  const int64_t budget_us;
+  std::atomic<int64_t> consumed_us{0};
+};
+
 }  // namespace
 
 namespace internal {
@@ -132,6 +149,8 @@ ThreadWorkSource::ThreadWorkSource()
       blocking_inflight_(0),
       non_blocking_inflight_(0),
       pending_tasks_(0),
+      consumed_time_us_(0),
+      model_consumed_time_us_(nullptr),
       traceme_id_(0),
       version_(0),
       sub_thread_pool_waiter_(nullptr) {
@@ -319,6 +338,26 @@ void ThreadWorkSource::DecrementPendingTaskCount() {
   pending_tasks_.fetch_sub(1, std::memory_order_release);
 }
 
+int64_t ThreadWorkSource::GetConsumedTimeMicros() {
+  return consumed_time_us_.load(std::memory_order_relaxed);
+}
+
+void ThreadWorkSource::AddConsumedTimeMicros(int64_t micros) {
+  consumed_time_us_.fetch_add(micros, std::memory_order_relaxed);
+  std::atomic<int64_t>* model_consumed_time_us =
+      model_consumed_time_us_.load(std::memory_order_relaxed);
+  if (model_consumed_time_us != nullptr) {
+    model_consumed_time_us->fetch_add(micros, std::memory_order_relaxed);
+  }
+}
+
+void ThreadWorkSource::ResetConsumedTime(
+    std::atomic<int64_t>* model_consumed_time_us) {
+  consumed_time_us_.store(0, std::memory_order_relaxed);
+  model_consumed_time_us_.store(model_consumed_time_us,
+                                std::memory_order_relaxed);
+}
+
 unsigned ThreadWorkSource::NonBlockingWorkShardingFactor() {
   return non_blocking_work_sharding_factor_;
 }
@@ -348,6 +387,7 @@ RunHandlerThreadPool::RunHandlerThreadPool(
       blocking_thread_max_waiting_time_(
           options.blocking_threads_max_sleep_time_micro_sec),
       enable_wake_up_(options.enable_wake_up),
+      take_work_in_order_(options.take_work_in_order),
       thread_data_(num_threads_),
       env_(env, thread_options, name),
       name_(name),
@@ -416,7 +456,9 @@ void RunHandlerThreadPool::AddWorkToQueue(ThreadWorkSource* tws,
   if (t.f) {
     VLOG(3) << "Running " << (is_blocking ? "inter" : "intra") << " work for "
             << tws->GetTracemeId();
+    const uint64_t start_us = tensorflow::EnvTime::NowMicros();
     env_.ExecuteTask(t);
+    tws->AddConsumedTimeMicros(tensorflow::EnvTime::NowMicros() - start_us);
   }
 }
 
@@ -476,7 +518,11 @@ Task RunHandlerThreadPool::FindTask(
     const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
     bool* task_from_blocking_queue, ThreadWorkSource** tws) {
   Task t;
-  int current_index = thread_data_[thread_id].current_index;
+  // The requests are sorted by precedence; searching them in order makes
+  // threads always serve the most important request that has work.
+  int current_index = take_work_in_order_
+                          ? searching_range_start
+                          : thread_data_[thread_id].current_index;
   *task_from_blocking_queue = false;
 
   for (int i = 0; i < searching_range_end - searching_range_start; ++i) {
@@ -574,7 +620,9 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
       VLOG(2) << "Running " << (task_from_blocking_queue ? "inter" : "intra")
               << " work from " << tws->GetTracemeId();
       tws->IncrementInflightTaskCount(task_from_blocking_queue);
+      const uint64_t start_us = tensorflow::EnvTime::NowMicros();
       env_.ExecuteTask(t);
+      tws->AddConsumedTimeMicros(tensorflow::EnvTime::NowMicros() - start_us);
       tws->DecrementInflightTaskCount(task_from_blocking_queue);
       tws->DecrementPendingTaskCount();
     } else {
@@ -665,7 +713,8 @@ class RunHandler::Impl {
   void ScheduleInterOpClosure(TaskFunction fn);
   void ScheduleIntraOpClosure(TaskFunction fn);
 
-  void Reset(int64_t step_id, const RunHandlerOptions& options);
+  void Reset(int64_t step_id, const RunHandlerOptions& options,
+             ModelCpuUsage* model_cpu_usage);
 
   RunHandlerPool::Impl* pool_impl() { return pool_impl_; }
 
@@ -677,6 +726,16 @@ class RunHandler::Impl {
 
   int64_t priority() const { return options_.priority; }
 
+  int64_t deadline_us() const { return options_.deadline_us; }
+
+  tensorflow::RequestCost* request_cost() const {
+    return options_.request_cost;
+  }
+
+  // The usage of the model the request is charged to, or nullptr if the model
+  // has no CPU quota.
+  const ModelCpuUsage* model_cpu_usage() const { return model_cpu_usage_; }
+
  private:
   class RunHandlerEigenThreadPool
       : public tensorflow::thread::ThreadPoolInterface {
@@ -704,8 +763,29 @@ class RunHandler::Impl {
   int64_t step_id_;
   internal::ThreadWorkSource tws_;
   RunHandlerOptions options_;
+  ModelCpuUsage* model_cpu_usage_;  // NOT OWNED.
 };
 
+namespace {
+
+internal::RunHandlerThreadPool::Options ThreadPoolOptions(
+    const RunHandlerPool::Options& options) {
+  internal::RunHandlerThreadPool::Options thread_pool_options(
+      options.num_inter_op_threads, options.num_intra_op_threads,
+      options.wait_if_no_active_request,
+      options.non_blocking_threads_sleep_time_micro_sec,
+      options.blocking_threads_max_sleep_time_micro_sec,
+      options.use_adaptive_waiting_time, options.enable_wake_up,
+      options.max_concurrent_handler, options.num_threads_in_sub_thread_pool,
+      options.sub_thread_request_percentage);
+  thread_pool_options.take_work_in_order =
+      options.scheduling_policy !=
+      RunHandlerPool::Options::SchedulingPolicy::kArrivalOrder;
+  return thread_pool_options;
+}
+
+}  // namespace
+
 // Contains shared state across all run handlers present in the pool. Also
 // responsible for pool management decisions.
 // This class is thread safe.
@@ -716,23 +796,27 @@ class RunHandlerPool::Impl {
         waiters_mu_(options.num_sub_thread_pool),
         queue_waiters_(options.num_sub_thread_pool),
         run_handler_thread_pool_(new internal::RunHandlerThreadPool(
-            internal::RunHandlerThreadPool::Options(
-                options.num_inter_op_threads, options.num_intra_op_threads,
-                options.wait_if_no_active_request,
-                options.non_blocking_threads_sleep_time_micro_sec,
-                options.blocking_threads_max_sleep_time_micro_sec,
-                options.use_adaptive_waiting_time, options.enable_wake_up,
-                options.max_concurrent_handler,
-                options.num_threads_in_sub_thread_pool,
-                options.sub_thread_request_percentage),
-            tensorflow::Env::Default(), tensorflow::ThreadOptions(),
-            "tf_run_handler_pool", &waiters_mu_, &queue_waiters_)),
+            ThreadPoolOptions(options), tensorflow::Env::Default(),
+            tensorflow::ThreadOptions(), "tf_run_handler_pool", &waiters_mu_,
+            &queue_waiters_)),
         iterations_(0),
         version_(0),
         wait_if_no_active_request_(options.wait_if_no_active_request),
         sub_thread_pool_end_request_percentage_(
-            options.sub_thread_request_percentage) {
+            options.sub_thread_request_percentage),
+        scheduling_policy_(options.scheduling_policy),
+        sort_active_handlers_(options.scheduling_policy !=
+                                  Options::SchedulingPolicy::kArrivalOrder ||
+                              !options.model_cpu_quota.empty()),
+        quota_window_us_(options.model_cpu_quota_window_micro_sec),
+        quota_window_start_us_(tensorflow::EnvTime::NowMicros()) {
     VLOG(1) << "Creating a RunHandlerPool with max handlers: " << max_handlers_;
+    const int num_threads =
+        options.num_inter_op_threads + options.num_intra_op_threads;
+    for (const auto& quota : options.model_cpu_quota) {
+      model_cpu_usage_[quota.first] = std::make_unique<ModelCpuUsage>(
+          static_cast<int64_t>(quota.second * quota_window_us_ * num_threads));
+    }
     free_handlers_.reserve(max_handlers_);
     handlers_.reserve(max_handlers_);
     for (int i = 0; i < max_handlers_; ++i) {
@@ -801,24 +885,37 @@ class RunHandlerPool::Impl {
       // Remove the last entry from free_handlers_ and add to the end of
       // sorted_active_handlers_.
       handler_impl = free_handlers_.back();
-      handler_impl->Reset(step_id, options);
+      auto usage = model_cpu_usage_.find(options.model_name);
+      handler_impl->Reset(step_id, options,
+                          usage == model_cpu_usage_.end()
+                              ? nullptr
+                              : usage->second.get());
       free_handlers_.pop_back();
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority;
-      auto it = sorted_active_handlers_.cbegin();
-      bool new_handler_inserted = false;
-      for (int i = 0; i < num_active_requests; ++i) {
-        if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
-          sorted_active_handlers_.insert(it, handler_impl);
-          new_handler_inserted = true;
-          // Point to the newly added handler.
-          --it;
+      if (sort_active_handlers_) {
+        sorted_active_handlers_.push_back(handler_impl);
+        SortActiveHandlers();
+        int i = 0;
+        for (RunHandler::Impl* impl : sorted_active_handlers_) {
+          (*thread_work_sources)[i++] = impl->tws();
+        }
+      } else {
+        int priority = options.priority;
+        auto it = sorted_active_handlers_.cbegin();
+        bool new_handler_inserted = false;
+        for (int i = 0; i < num_active_requests; ++i) {
+          if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
+                                        priority > (*it)->priority())) {
+            sorted_active_handlers_.insert(it, handler_impl);
+            new_handler_inserted = true;
+            // Point to the newly added handler.
+            --it;
+          }
+          (*thread_work_sources)[i] = (*it)->tws();
+          ++it;
         }
-        (*thread_work_sources)[i] = (*it)->tws();
-        ++it;
       }
       version = ++version_;
     }
@@ -827,6 +924,11 @@ class RunHandlerPool::Impl {
   }
 
   void ReleaseHandler(RunHandler::Impl* handler) TF_LOCKS_EXCLUDED(mu_) {
+    if (handler->request_cost() != nullptr) {
+      handler->request_cost()->RecordCost(
+          {{kRunHandlerCostType,
+            absl::Microseconds(handler->tws()->GetConsumedTimeMicros())}});
+    }
     tensorflow::mutex_lock l(mu_);
     DCHECK_GT(sorted_active_handlers_.size(), 0);
 
@@ -862,6 +964,20 @@ class RunHandlerPool::Impl {
       thread_work_sources->resize(0);
       auto version = ++version_;
       RecomputePoolStats(0, version, *thread_work_sources);
+    } else if (sort_active_handlers_ && !sorted_active_handlers_.empty()) {
+      // The precedence of the remaining requests may have changed while this
+      // one ran, so reorder them now rather than at the next request.
+      thread_local auto thread_work_sources =
+          std::make_unique<Eigen::MaxSizeVector<internal::ThreadWorkSource*>>(
+              max_handlers_);
+      SortActiveHandlers();
+      thread_work_sources->resize(0);
+      for (RunHandler::Impl* impl : sorted_active_handlers_) {
+        thread_work_sources->push_back(impl->tws());
+      }
+      auto version = ++version_;
+      RecomputePoolStats(sorted_active_handlers_.size(), version,
+                         *thread_work_sources);
     }
   }
 
@@ -875,6 +991,16 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting()
+      TF_LOCKS_EXCLUDED(mu_) {
+    tensorflow::mutex_lock l(mu_);
+    std::vector<int64_t> ret;
+    for (const auto& handler_impl : sorted_active_handlers_) {
+      ret.push_back(handler_impl->step_id());
+    }
+    return ret;
+  }
+
   void Quiesce() TF_LOCKS_EXCLUDED(mu_) {
     while (true) {
       {
@@ -904,6 +1030,10 @@ class RunHandlerPool::Impl {
 
   void LogInfo() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Sorts sorted_active_handlers_ by the scheduling policy and CPU quotas,
+  // starting a new quota window first if the current one is over.
+  void SortActiveHandlers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Maximum number of handlers pre-created during pool construction time. The
   // number has been chosen expecting each handler might at least want 1
   // inter-op thread for execution (during compute intensive workloads like
@@ -932,6 +1062,16 @@ class RunHandlerPool::Impl {
   int64_t version_ TF_GUARDED_BY(mu_);
   bool wait_if_no_active_request_;
   const std::vector<double> sub_thread_pool_end_request_percentage_;
+
+  const Options::SchedulingPolicy scheduling_policy_;
+  // If false, sorted_active_handlers_ is only ordered by priority and arrival,
+  // and new handlers are inserted in place instead of sorting.
+  const bool sort_active_handlers_;
+  // The usage of each model with a CPU quota. Not modified after construction.
+  absl::flat_hash_map<std::string, std::unique_ptr<ModelCpuUsage>>
+      model_cpu_usage_;
+  const int64_t quota_window_us_;
+  uint64_t quota_window_start_us_ TF_GUARDED_BY(mu_);
 };
 
 void RunHandlerPool::Impl::RecomputePoolStats(
@@ -962,6 +1102,57 @@ void RunHandlerPool::Impl::RecomputePoolStats(
   }
 }
 
+void RunHandlerPool::Impl::SortActiveHandlers() {
+  const uint64_t now = tensorflow::EnvTime::NowMicros();
+  if (static_cast<int64_t>(now - quota_window_start_us_) >= quota_window_us_) {
+    quota_window_start_us_ = now;
+    for (auto& usage : model_cpu_usage_) {
+      usage.second->consumed_us.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // Snapshot the sort keys, since the consumed times change while sorting.
+  struct SortKey {
+    bool over_quota;
+    int64_t priority;
+    int64_t policy_key;
+    RunHandler::Impl* handler;
+  };
+  std::vector<SortKey> keys;
+  keys.reserve(sorted_active_handlers_.size());
+  for (RunHandler::Impl* handler : sorted_active_handlers_) {
+    int64_t policy_key = 0;
+    switch (scheduling_policy_) {
+      case Options::SchedulingPolicy::kArrivalOrder:
+        break;
+      case Options::SchedulingPolicy::kFairShare:
+        policy_key = handler->tws()->GetConsumedTimeMicros();
+        break;
+      case Options::SchedulingPolicy::kEarliestDeadline:
+        policy_key = handler->deadline_us() > 0
+                         ? handler->deadline_us()
+                         : std::numeric_limits<int64_t>::max();
+        break;
+    }
+    keys.push_back({handler->model_cpu_usage() != nullptr &&
+                        handler->model_cpu_usage()->over_quota(),
+                    handler->priority(), policy_key, handler});
+  }
+  // A stable sort keeps requests with equal keys in arrival order.
+  std::stable_sort(keys.begin(), keys.end(),
+                   [](const SortKey& a, const SortKey& b) {
+                     if (a.over_quota != b.over_quota) return !a.over_quota;
+                     if (a.priority != b.priority) {
+                       return a.priority > b.priority;
+                     }
+                     return a.policy_key < b.policy_key;
+                   });
+  auto it = sorted_active_handlers_.begin();
+  for (const SortKey& key : keys) {
+    *it++ = key.handler;
+  }
+}
+
 void RunHandlerPool::Impl::LogInfo() {
   if (iterations_++ % 50000 == 10 && VLOG_IS_ON(1)) {
     int num_active_requests = sorted_active_handlers_.size();
@@ -989,7 +1180,7 @@ void RunHandlerPool::Impl::LogInfo() {
 
 RunHandler::Impl::Impl(RunHandlerPool::Impl* pool_impl)
     : pool_impl_(pool_impl), eigen_thread_pool_(this) {
-  Reset(0, RunHandlerOptions());
+  Reset(0, RunHandlerOptions(), /*model_cpu_usage=*/nullptr);
 }
 
 void RunHandler::Impl::ScheduleInterOpClosure(TaskFunction fn) {
@@ -1004,12 +1195,16 @@ void RunHandler::Impl::ScheduleIntraOpClosure(TaskFunction fn) {
                                                         std::move(fn));
 }
 
-void RunHandler::Impl::Reset(int64_t step_id,
-                             const RunHandlerOptions& options) {
+void RunHandler::Impl::Reset(int64_t step_id, const RunHandlerOptions& options,
+                             ModelCpuUsage* model_cpu_usage) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
   step_id_ = step_id;
   options_ = options;
+  model_cpu_usage_ = model_cpu_usage;
   tws_.SetTracemeId(step_id);
+  tws_.ResetConsumedTime(model_cpu_usage == nullptr
+                             ? nullptr
+                             : &model_cpu_usage->consumed_us);
 }
 
 int RunHandler::Impl::RunHandlerEigenThreadPool::NumThreads() const {
@@ -1034,6 +1229,10 @@ std::vector<int64_t> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+std::vector<int64_t> RunHandlerPool::GetActiveHandlerStepIdsForTesting() const {
+  return impl_->GetActiveHandlerStepIdsForTesting();
+}
+
 void RunHandlerPool::Quiesce() const { impl_->Quiesce(); }
 
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
@@ -1052,6 +1251,10 @@ int RunHandler::NumThreads() const {
 
 int64_t RunHandler::step_id() const { return impl_->step_id(); }
 
+int64_t RunHandler::ConsumedTimeMicros() const {
+  return impl_->tws()->GetConsumedTimeMicros();
+}
+
 tensorflow::thread::ThreadPoolInterface*
 RunHandler::AsIntraThreadPoolInterface() const {
   return impl_->thread_pool_interface();
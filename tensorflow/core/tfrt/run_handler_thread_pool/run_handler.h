@@ -16,9 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_RUN_HANDLER_THREAD_POOL_RUN_HANDLER_H_
 #define TENSORFLOW_CORE_TFRT_RUN_HANDLER_THREAD_POOL_RUN_HANDLER_H_
 
+#include <atomic>
 #include <cstddef>
+#include <string>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/platform/context.h"
@@ -42,8 +46,25 @@ struct RunHandlerOptions {
 
   // Request priority.
   int priority;
+
+  // Deadline of the request, in microseconds since the epoch. Used by the
+  // kEarliestDeadline scheduling policy. 0 means no deadline.
+  int64_t deadline_us = 0;
+
+  // Name of the model the request runs. Requests of a model with a CPU quota
+  // (see RunHandlerPool::Options::model_cpu_quota) are scheduled after all
+  // other requests while the model is over its quota.
+  std::string model_name;
+
+  // If not null, the thread time spent running the request's closures is
+  // recorded in it under kRunHandlerCostType when the handler is released.
+  // NOT OWNED. Must outlive the handler.
+  tensorflow::RequestCost* request_cost = nullptr;
 };
 
+// The cost type under which a RunHandler records the thread time of a request.
+constexpr char kRunHandlerCostType[] = "run_handler_thread_time";
+
 // RunHandlerPool is a fixed size pool of pre-allocated RunHandlers
 // that can be used for tracking op work for a given inference request.
 // RunHandler(s) in the pool are initially 'inactive'. A RunHandler becomes
@@ -102,6 +123,32 @@ class RunHandlerPool {
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    enum class SchedulingPolicy {
+      // Requests are ordered by priority, then by arrival. Threads take work
+      // from the requests of their sub thread pool round-robin.
+      kArrivalOrder,
+      // Requests of the same priority are ordered by the thread time spent
+      // running their closures so far, least first. Threads take work from
+      // the first request that has any, so cheap requests are not starved by
+      // expensive ones.
+      kFairShare,
+      // Requests of the same priority are ordered by deadline, earliest first.
+      // Requests without a deadline come last. Threads take work from the
+      // first request that has any.
+      kEarliestDeadline,
+    };
+    SchedulingPolicy scheduling_policy = SchedulingPolicy::kArrivalOrder;
+
+    // Maps model names to the fraction of the pool's thread time their
+    // requests may use in each quota window, e.g. 0.25 for a quarter of all
+    // threads. Once a model has used up its quota for the current window, its
+    // requests are scheduled after those of all other models until the window
+    // ends. Idle threads still run them, so quotas never leave threads idle.
+    absl::flat_hash_map<std::string, double> model_cpu_quota;
+
+    // The length of a quota window.
+    int64_t model_cpu_quota_window_micro_sec = 1000000;
   };
   explicit RunHandlerPool(Options options);
   ~RunHandlerPool();
@@ -122,6 +169,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64_t> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the step ids of the active handlers, in the order of the active handler
+  // list.
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting() const;
+
   // Block until the system is quiescent (no pending work and no inflight work).
   void Quiesce() const;
 
@@ -155,6 +206,10 @@ class RunHandler {
 
   int64_t step_id() const;
 
+  // Returns the thread time spent running the closures of this request so
+  // far, in microseconds.
+  int64_t ConsumedTimeMicros() const;
+
   ~RunHandler();
 
  private:
@@ -247,6 +302,17 @@ class ThreadWorkSource {
 
   void DecrementPendingTaskCount();
 
+  // Thread time spent running the tasks of this work source, in microseconds.
+  int64_t GetConsumedTimeMicros();
+
+  // Adds `micros` to the consumed time of this work source and, if set, to the
+  // model counter.
+  void AddConsumedTimeMicros(int64_t micros);
+
+  // Resets the consumed time and sets the counter of the model the tasks are
+  // charged to, or nullptr.
+  void ResetConsumedTime(std::atomic<int64_t>* model_consumed_time_us);
+
   unsigned NonBlockingWorkShardingFactor();
 
   std::string ToString();
@@ -268,6 +334,9 @@ class ThreadWorkSource {
   // The number of tasks that are enqueued and not finished.
   std::atomic<int64_t> pending_tasks_;
 
+  std::atomic<int64_t> consumed_time_us_;
+  std::atomic<std::atomic<int64_t>*> model_consumed_time_us_;
+
   Queue blocking_work_queue_;
   tensorflow::mutex blocking_queue_op_mu_;
   char pad_[128];
@@ -295,6 +364,9 @@ class RunHandlerThreadPool {
     int max_concurrent_handler;
     std::vector<int> num_threads_in_sub_thread_pool;
     std::vector<double> sub_thread_request_percentage;
+    // If true, threads search the requests of a range in order for work,
+    // instead of round-robin.
+    bool take_work_in_order = false;
     Options(int num_blocking_threads, int num_non_blocking_threads,
             bool wait_if_no_active_request,
             int non_blocking_threads_sleep_time_micro_sec,
@@ -393,6 +465,7 @@ class RunHandlerThreadPool {
   const int non_blocking_thread_sleep_time_;
   const int blocking_thread_max_waiting_time_;
   const bool enable_wake_up_;
+  const bool take_work_in_order_;
   Eigen::MaxSizeVector<ThreadData> thread_data_;
   internal::RunHandlerEnvironment env_;
   std::atomic<bool> cancelled_;
@@ -77,6 +77,10 @@ class RunHandlerThreadWorkQueue
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // How requests are prioritized, see RunHandlerPool::Options.
+    RunHandlerPool::Options::SchedulingPolicy scheduling_policy =
+        RunHandlerPool::Options::SchedulingPolicy::kArrivalOrder;
   };
 
   explicit RunHandlerThreadWorkQueue(const Options& options);
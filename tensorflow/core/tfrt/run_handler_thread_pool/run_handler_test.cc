@@ -117,6 +117,99 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, EarliestDeadlineSchedulingTest) {
+  RunHandlerPool::Options pool_options;
+  pool_options.num_intra_op_threads = 1;
+  pool_options.num_inter_op_threads = 1;
+  pool_options.scheduling_policy =
+      RunHandlerPool::Options::SchedulingPolicy::kEarliestDeadline;
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(pool_options));
+
+  RunHandlerOptions options = RunHandlerOptions();
+  options.deadline_us = 300;
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  options.deadline_us = 100;
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  options.deadline_us = 0;
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+  options.deadline_us = 200;
+  auto handler4 = pool->Get(/*step_id=*/4, /*timeout_in_ms=*/0, options);
+  EXPECT_EQ(pool->GetActiveHandlerStepIdsForTesting(),
+            std::vector<int64_t>({2, 4, 1, 3}));
+
+  // Priorities still take precedence over deadlines.
+  options.priority = 1;
+  options.deadline_us = 400;
+  auto handler5 = pool->Get(/*step_id=*/5, /*timeout_in_ms=*/0, options);
+  EXPECT_EQ(pool->GetActiveHandlerStepIdsForTesting(),
+            std::vector<int64_t>({5, 2, 4, 1, 3}));
+}
+
+TEST(RunHandlerUtilTest, FairShareSchedulingTest) {
+  RunHandlerPool::Options pool_options;
+  pool_options.num_intra_op_threads = 1;
+  pool_options.num_inter_op_threads = 1;
+  pool_options.scheduling_policy =
+      RunHandlerPool::Options::SchedulingPolicy::kFairShare;
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(pool_options));
+
+  tensorflow::RequestCost request_cost;
+  RunHandlerOptions options = RunHandlerOptions();
+  options.request_cost = &request_cost;
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  EXPECT_EQ(pool->GetActiveHandlerStepIdsForTesting(),
+            std::vector<int64_t>({1, 2}));
+
+  absl::Notification notification;
+  handler1->ScheduleInterOpClosure(TaskFunction([&notification]() {
+    tensorflow::Env::Default()->SleepForMicroseconds(10000);
+    notification.Notify();
+  }));
+  notification.WaitForNotification();
+  pool->Quiesce();
+  EXPECT_GE(handler1->ConsumedTimeMicros(), 10000);
+  EXPECT_EQ(handler2->ConsumedTimeMicros(), 0);
+
+  // The request that used the least thread time so far comes first.
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+  EXPECT_EQ(pool->GetActiveHandlerStepIdsForTesting(),
+            std::vector<int64_t>({2, 3, 1}));
+
+  const int64_t consumed_time_us = handler1->ConsumedTimeMicros();
+  handler1.reset();
+  EXPECT_EQ(request_cost.GetCosts().at(kRunHandlerCostType),
+            absl::Microseconds(consumed_time_us));
+}
+
+TEST(RunHandlerUtilTest, ModelCpuQuotaTest) {
+  RunHandlerPool::Options pool_options;
+  pool_options.num_intra_op_threads = 1;
+  pool_options.num_inter_op_threads = 1;
+  // Model "a" is always over its quota.
+  pool_options.model_cpu_quota = {{"a", 0.0}, {"b", 1.0}};
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(pool_options));
+
+  RunHandlerOptions options = RunHandlerOptions();
+  options.model_name = "a";
+  options.priority = 2;
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  options.model_name = "b";
+  options.priority = 1;
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  options.model_name = "c";
+  options.priority = 0;
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+  EXPECT_EQ(pool->GetActiveHandlerStepIdsForTesting(),
+            std::vector<int64_t>({2, 3, 1}));
+
+  // Requests over quota still run.
+  absl::Notification notification;
+  handler1->ScheduleInterOpClosure(
+      TaskFunction([&notification]() { notification.Notify(); }));
+  notification.WaitForNotification();
+}
+
 TEST(RunHandlerUtilTest, IntraOpThreadPool) {
   int num_threads = 2;
   RunHandlerPool::Options pool_options;
@@ -42,18 +42,26 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tfrt/translate/import_model.h"
 #include "tensorflow/compiler/mlir/tfrt/translate/tfrt_compile_options.h"
 #include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_execute_compat.h"
+#include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
+#include "tensorflow/core/tfrt/fallback/op_kernel_runner_manifest.pb.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_executor.h"
 #include "tensorflow/core/tfrt/mla/mla_utils.h"
@@ -63,6 +71,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/utils/error_util.h"
 #include "tensorflow/core/tfrt/utils/fallback_tensor.h"
 #include "tensorflow/core/tfrt/utils/utils.h"
+#include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/tsl/platform/statusor.h"
 #include "tfrt/bef_executor/bef_file.h"  // from @tf_runtime
 #include "tfrt/core_runtime/core_runtime.h"  // from @tf_runtime
@@ -356,11 +365,45 @@ StatusOr<mlir::OwningOpRef<mlir::ModuleOp>> ImportSavedModel(
   return module;
 }
 
+// Creates the fallback op kernels listed in the manifest at
+// `options.op_kernel_runner_manifest_path` in parallel. A missing or corrupt
+// manifest only disables the pre-warming.
+void PrewarmOpKernelRunnerCache(const SavedModel::Options& options,
+                                tfrt::ResourceContext* resource_context,
+                                const FallbackState& fallback_state) {
+  OpKernelRunnerManifestProto manifest;
+  auto status = tensorflow::ReadBinaryProto(
+      tensorflow::Env::Default(), options.op_kernel_runner_manifest_path,
+      &manifest);
+  if (!status.ok()) {
+    LOG(WARNING) << "Not pre-warming fallback op kernels: " << status;
+    return;
+  }
+
+  auto* runner_cache =
+      resource_context->GetOrCreateResource<OpKernelRunnerCache>(
+          tensorflow::tfd::kOpKernelRunnerCacheResourceName);
+  tensorflow::thread::ThreadPool thread_pool(
+      tensorflow::Env::Default(), "tfrt_prewarm_op_kernels",
+      tensorflow::port::MaxParallelism());
+  runner_cache->Prewarm(manifest, fallback_state.device_manager(),
+                        fallback_state.process_function_library_runtime(),
+                        &thread_pool);
+  LOG(INFO) << "TFRT pre-warmed " << manifest.entries_size()
+            << " fallback op kernels.";
+}
+
 tensorflow::Status InitSavedModel(
     const InitializersAndSignatures& initializers_and_signatures,
     tfrt::BEFFile* bef_file, const SavedModel::Options& options,
     tfrt::ResourceContext* resource_context,
     const FallbackState& fallback_state) {
+  // Pre-warm before running the initializers so that they can use the kernels
+  // too.
+  if (!options.op_kernel_runner_manifest_path.empty()) {
+    PrewarmOpKernelRunnerCache(options, resource_context, fallback_state);
+  }
+
   TF_RETURN_IF_ERROR(
       RunInitializers(initializers_and_signatures,
                       options.graph_execution_options.model_metadata, bef_file,
@@ -539,6 +582,16 @@ void UpdateCompileOptions(SavedModel::Options& options) {
   }
 }
 
+// Makes the RestoreV2 ops of `graph_def` share the tensors they restore with
+// identical tensors restored by other models loaded in this process.
+void MarkRestoreOpsForSharing(tensorflow::GraphDef* graph_def) {
+  for (tensorflow::NodeDef& node : *graph_def->mutable_node()) {
+    if (node.op() == "RestoreV2") {
+      (*node.mutable_attr())[tensorflow::kShareRestoredTensorsAttr].set_b(true);
+    }
+  }
+}
+
 StatusOr<tensorflow::MetaGraphDef> ReadSavedModel(
     absl::string_view saved_model_dir,
     const std::unordered_set<std::string>& tags) {
@@ -601,6 +654,9 @@ SavedModelImpl::LoadSavedModel(Options options,
   UpdateTpuTargetByBridgeCompatibility(options.graph_execution_options,
                                        meta_graph_def.graph_def());
   UpdateCompileOptions(options);
+  if (options.share_identical_variables) {
+    MarkRestoreOpsForSharing(meta_graph_def.mutable_graph_def());
+  }
 
   mlir::MLIRContext context;
 
@@ -918,6 +974,16 @@ tensorflow::Status SavedModelImpl::RunByTensorNames(
                               target_node_names, outputs);
 }
 
+tensorflow::Status SavedModelImpl::SaveOpKernelRunnerManifest(
+    absl::string_view path) const {
+  auto* runner_cache =
+      resource_context_->GetOrCreateResource<OpKernelRunnerCache>(
+          tensorflow::tfd::kOpKernelRunnerCacheResourceName);
+  return tensorflow::WriteBinaryProto(
+      tensorflow::Env::Default(), std::string(path),
+      runner_cache->ExportManifest());
+}
+
 namespace {
 
 using JoinedSignature = SavedModelImpl::JoinedSignature;
@@ -127,6 +127,19 @@ class SavedModel {
     // TODO(b/216379787): Remove this option once b/239749833 is unblocked.
     bool lazy_loading_use_graph_executor = false;
 
+    // If not empty, the path of a manifest written by
+    // SavedModelImpl::SaveOpKernelRunnerManifest() for an earlier load of this
+    // model. The fallback op kernels listed there are created in parallel
+    // during loading instead of on the first requests. Not used with lazy
+    // loading.
+    std::string op_kernel_runner_manifest_path;
+
+    // If true, each restored variable value is shared with any identical value
+    // (same dtype, shape and bytes) restored by an earlier load in this
+    // process, so models fine-tuned from one base model hold their common
+    // weights in memory once. See BundleReader::LookupShared().
+    bool share_identical_variables = false;
+
     GraphExecutionOptions graph_execution_options;
   };
 
@@ -253,6 +266,11 @@ class SavedModelImpl final : public SavedModel {
       absl::Span<const std::string> target_node_names,
       std::vector<tensorflow::Tensor>* outputs) override;
 
+  // Writes the fallback op kernels created so far to `path`, to be used as
+  // `Options::op_kernel_runner_manifest_path` of a later load. Only the ops
+  // of the signatures loaded along with the saved model are included.
+  tensorflow::Status SaveOpKernelRunnerManifest(absl::string_view path) const;
+
  private:
   // The result of loading signature(s).
   struct LoadingResult {
@@ -0,0 +1,106 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/async_record_queue.h"
+
+#include <utility>
+
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+auto* dropped_records_counter = monitoring::Counter<1>::New(
+    "/tensorflow/core/util/async_record_queue/dropped_records",
+    "The number of records dropped because the queue of an asynchronous "
+    "writer was full.",
+    "name");
+
+}  // namespace
+
+AsyncRecordQueue::AsyncRecordQueue(Env* env, const std::string& name,
+                                   int64_t max_queued_records,
+                                   WriteFn write_fn)
+    : name_(name),
+      max_queued_records_(max_queued_records),
+      write_fn_(std::move(write_fn)) {
+  thread_.reset(env->StartThread(ThreadOptions(),
+                                 strings::StrCat("tf_async_", name),
+                                 [this]() { WriteLoop(); }));
+}
+
+AsyncRecordQueue::~AsyncRecordQueue() {
+  {
+    mutex_lock l(mu_);
+    stopping_ = true;
+  }
+  records_available_.notify_one();
+  // Joins the background thread, once it has written the queued records.
+  thread_.reset();
+}
+
+bool AsyncRecordQueue::Enqueue(StringPiece record) {
+  std::string copy(record);
+  {
+    mutex_lock l(mu_);
+    if (static_cast<int64_t>(queue_.size()) >= max_queued_records_) {
+      if (num_dropped_records_.fetch_add(1) == 0) {
+        LOG(WARNING) << "The queue of the asynchronous writer " << name_
+                     << " is full, dropping records.";
+      }
+      dropped_records_counter->GetCell(name_)->IncrementBy(1);
+      return false;
+    }
+    queue_.push_back(std::move(copy));
+    ++num_enqueued_records_;
+  }
+  records_available_.notify_one();
+  return true;
+}
+
+void AsyncRecordQueue::Drain() {
+  mutex_lock l(mu_);
+  const int64_t num_records = num_enqueued_records_;
+  while (num_written_records_ < num_records) {
+    records_written_.wait(l);
+  }
+}
+
+void AsyncRecordQueue::WriteLoop() {
+  std::vector<std::string> batch;
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      while (queue_.empty() && !stopping_) {
+        records_available_.wait(l);
+      }
+      if (queue_.empty()) return;
+      // Takes all the queued records, so that producers can enqueue new ones
+      // while the batch is written.
+      batch.swap(queue_);
+    }
+    write_fn_(batch);
+    {
+      mutex_lock l(mu_);
+      num_written_records_ += batch.size();
+    }
+    records_written_.notify_all();
+    batch.clear();
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,88 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_UTIL_ASYNC_RECORD_QUEUE_H_
+#define TENSORFLOW_CORE_UTIL_ASYNC_RECORD_QUEUE_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A bounded queue of records that a background thread writes in batches, so
+// that the threads producing the records never block on the file system.
+//
+// When the queue is full, new records are dropped instead of waiting for the
+// writes to catch up. Dropped records are counted in num_dropped_records()
+// and in the /tensorflow/core/util/async_record_queue/dropped_records metric.
+class AsyncRecordQueue {
+ public:
+  // Writes a batch of records, in the order in which they were enqueued.
+  // Called from the background thread only.
+  using WriteFn = std::function<void(const std::vector<std::string>& records)>;
+
+  // Starts a background thread writing the records with `write_fn`. At most
+  // `max_queued_records` records wait to be written at any time. `name`
+  // identifies the queue in the thread name and the metrics.
+  AsyncRecordQueue(Env* env, const std::string& name,
+                   int64_t max_queued_records, WriteFn write_fn);
+
+  // Writes the records still in the queue and stops the background thread.
+  ~AsyncRecordQueue();
+
+  // Enqueues `record` to be written. Never blocks on the writes: returns false
+  // if the queue is full, in which case the record is dropped.
+  bool Enqueue(StringPiece record);
+
+  // Blocks until all the records enqueued before the call are written. Must
+  // not be called from `write_fn`.
+  void Drain();
+
+  int64_t num_dropped_records() const { return num_dropped_records_.load(); }
+
+ private:
+  void WriteLoop();
+
+  const std::string name_;
+  const int64_t max_queued_records_;
+  const WriteFn write_fn_;
+
+  mutex mu_;
+  condition_variable records_available_;
+  condition_variable records_written_;
+  std::vector<std::string> queue_ TF_GUARDED_BY(mu_);
+  int64_t num_enqueued_records_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_written_records_ TF_GUARDED_BY(mu_) = 0;
+  bool stopping_ TF_GUARDED_BY(mu_) = false;
+  std::atomic<int64_t> num_dropped_records_{0};
+
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AsyncRecordQueue);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_ASYNC_RECORD_QUEUE_H_
@@ -0,0 +1,95 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/async_record_queue.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(AsyncRecordQueueTest, WritesRecordsInOrder) {
+  mutex mu;
+  std::vector<std::string> written;
+  AsyncRecordQueue queue(Env::Default(), "test", /*max_queued_records=*/100,
+                         [&](const std::vector<std::string>& records) {
+                           mutex_lock l(mu);
+                           written.insert(written.end(), records.begin(),
+                                          records.end());
+                         });
+  std::vector<std::string> expected;
+  for (int i = 0; i < 50; ++i) {
+    expected.push_back(strings::StrCat("record_", i));
+    EXPECT_TRUE(queue.Enqueue(expected.back()));
+  }
+  queue.Drain();
+  mutex_lock l(mu);
+  EXPECT_EQ(written, expected);
+  EXPECT_EQ(queue.num_dropped_records(), 0);
+}
+
+TEST(AsyncRecordQueueTest, DropsRecordsWhenFull) {
+  Notification write_started;
+  Notification unblock_writes;
+  mutex mu;
+  std::vector<std::string> written;
+  AsyncRecordQueue queue(Env::Default(), "test", /*max_queued_records=*/2,
+                         [&](const std::vector<std::string>& records) {
+                           if (!write_started.HasBeenNotified()) {
+                             write_started.Notify();
+                           }
+                           unblock_writes.WaitForNotification();
+                           mutex_lock l(mu);
+                           written.insert(written.end(), records.begin(),
+                                          records.end());
+                         });
+  // Blocks the background thread in the write of the first record.
+  EXPECT_TRUE(queue.Enqueue("a"));
+  write_started.WaitForNotification();
+
+  EXPECT_TRUE(queue.Enqueue("b"));
+  EXPECT_TRUE(queue.Enqueue("c"));
+  EXPECT_FALSE(queue.Enqueue("d"));
+  EXPECT_EQ(queue.num_dropped_records(), 1);
+
+  unblock_writes.Notify();
+  queue.Drain();
+  mutex_lock l(mu);
+  EXPECT_EQ(written, std::vector<std::string>({"a", "b", "c"}));
+}
+
+TEST(AsyncRecordQueueTest, WritesQueuedRecordsOnDestruction) {
+  std::vector<std::string> written;
+  {
+    AsyncRecordQueue queue(Env::Default(), "test", /*max_queued_records=*/10,
+                           [&](const std::vector<std::string>& records) {
+                             written.insert(written.end(), records.begin(),
+                                            records.end());
+                           });
+    EXPECT_TRUE(queue.Enqueue("a"));
+    EXPECT_TRUE(queue.Enqueue("b"));
+  }
+  EXPECT_EQ(written, std::vector<std::string>({"a", "b"}));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/util/debug_events_writer.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -32,11 +36,20 @@ void MaybeSetDebugEventTimestamp(DebugEvent* debug_event, Env* env) {
 }
 }  // namespace
 
-SingleDebugEventFileWriter::SingleDebugEventFileWriter(const string& file_path)
+SingleDebugEventFileWriter::SingleDebugEventFileWriter(
+    const string& file_path, int64_t max_queued_events)
     : env_(Env::Default()),
       file_path_(file_path),
       num_outstanding_events_(0),
-      writer_mu_() {}
+      writer_mu_() {
+  if (max_queued_events > 0) {
+    async_writes_ = std::make_unique<AsyncRecordQueue>(
+        env_, "debug_events_writer", max_queued_events,
+        [this](const std::vector<string>& debug_events) {
+          WriteSerializedDebugEvents(debug_events);
+        });
+  }
+}
 
 Status SingleDebugEventFileWriter::Init() {
   if (record_writer_ != nullptr) {
@@ -70,6 +83,12 @@ void SingleDebugEventFileWriter::WriteSerializedDebugEvent(
       return;
     }
   }
+  if (async_writes_ != nullptr) {
+    if (async_writes_->Enqueue(debug_event_str)) {
+      num_outstanding_events_.fetch_add(1);
+    }
+    return;
+  }
   num_outstanding_events_.fetch_add(1);
   {
     mutex_lock l(writer_mu_);
@@ -77,7 +96,30 @@ void SingleDebugEventFileWriter::WriteSerializedDebugEvent(
   }
 }
 
+void SingleDebugEventFileWriter::WriteSerializedDebugEvents(
+    const std::vector<string>& debug_events) {
+  mutex_lock l(writer_mu_);
+  if (record_writer_ == nullptr) {
+    LOG(ERROR) << "Dropping " << debug_events.size()
+               << " debug events written after closing " << file_path_;
+    return;
+  }
+  for (const string& debug_event : debug_events) {
+    record_writer_->WriteRecord(debug_event).IgnoreError();
+  }
+  // Pushes the batch to the file from the background thread, so that Flush()
+  // only has to sync it.
+  record_writer_->Flush().IgnoreError();
+}
+
+int64_t SingleDebugEventFileWriter::num_dropped_events() const {
+  return async_writes_ == nullptr ? 0 : async_writes_->num_dropped_records();
+}
+
 Status SingleDebugEventFileWriter::Flush() {
+  if (async_writes_ != nullptr) {
+    async_writes_->Drain();
+  }
   const int num_outstanding = num_outstanding_events_.load();
   if (num_outstanding == 0) {
     return OkStatus();
@@ -123,13 +165,13 @@ DebugEventsWriter::~DebugEventsWriter() { Close().IgnoreError(); }
 // static
 DebugEventsWriter* DebugEventsWriter::GetDebugEventsWriter(
     const string& dump_root, const string& tfdbg_run_id,
-    int64_t circular_buffer_size) {
+    int64_t circular_buffer_size, int64_t max_queued_events) {
   mutex_lock l(DebugEventsWriter::factory_mu_);
   std::unordered_map<string, std::unique_ptr<DebugEventsWriter>>* writer_pool =
       DebugEventsWriter::GetDebugEventsWriterMap();
   if (writer_pool->find(dump_root) == writer_pool->end()) {
-    std::unique_ptr<DebugEventsWriter> writer(
-        new DebugEventsWriter(dump_root, tfdbg_run_id, circular_buffer_size));
+    std::unique_ptr<DebugEventsWriter> writer(new DebugEventsWriter(
+        dump_root, tfdbg_run_id, circular_buffer_size, max_queued_events));
     writer_pool->insert(std::make_pair(dump_root, std::move(writer)));
   }
   return (*writer_pool)[dump_root].get();
@@ -474,13 +516,15 @@ DebugEventsWriter::GetDebugEventsWriterMap() {
 
 DebugEventsWriter::DebugEventsWriter(const string& dump_root,
                                      const string& tfdbg_run_id,
-                                     int64_t circular_buffer_size)
+                                     int64_t circular_buffer_size,
+                                     int64_t max_queued_events)
     : env_(Env::Default()),
       dump_root_(dump_root),
       tfdbg_run_id_(tfdbg_run_id),
       is_initialized_(false),
       initialization_mu_(),
       circular_buffer_size_(circular_buffer_size),
+      max_queued_events_(max_queued_events),
       execution_buffer_(),
       execution_buffer_mu_(),
       graph_execution_trace_buffer_(),
@@ -494,7 +538,13 @@ Status DebugEventsWriter::InitNonMetadataFile(DebugEventFileType type) {
   const string filename = GetFileNameInternal(type);
   writer->reset();
 
-  writer->reset(new SingleDebugEventFileWriter(filename));
+  int64_t max_queued_events = max_queued_events_;
+  if (max_queued_events > 0 &&
+      (type == EXECUTION || type == GRAPH_EXECUTION_TRACES)) {
+    // FlushExecutionFiles() enqueues whole circular buffers at once.
+    max_queued_events = std::max(max_queued_events, circular_buffer_size_);
+  }
+  writer->reset(new SingleDebugEventFileWriter(filename, max_queued_events));
   if (*writer == nullptr) {
     return errors::Unknown("Could not create debug event file writer for ",
                            filename);
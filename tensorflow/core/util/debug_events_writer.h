@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/debug_event.pb.h"
+#include "tensorflow/core/util/async_record_queue.h"
 
 namespace tensorflow {
 namespace tfdbg {
@@ -44,9 +45,14 @@ enum DebugEventFileType {
 // This class manages the writing of data to a single TFRecord file.
 // Each object of the DebugEventsWriter class below involves multiple
 // TFRecord files, and hence utilizes multiple objects of this helper class.
+//
+// If max_queued_events > 0, the events are written from a background thread,
+// with at most max_queued_events of them waiting to be written. Further events
+// are dropped until the queue drains.
 class SingleDebugEventFileWriter {
  public:
-  explicit SingleDebugEventFileWriter(const string& file_path);
+  explicit SingleDebugEventFileWriter(const string& file_path,
+                                      int64_t max_queued_events = 0);
 
   Status Init();
 
@@ -57,7 +63,13 @@ class SingleDebugEventFileWriter {
 
   const string FileName();
 
+  // The number of events dropped because the queue of asynchronous writes was
+  // full.
+  int64_t num_dropped_events() const;
+
  private:
+  void WriteSerializedDebugEvents(const std::vector<string>& debug_events);
+
   Env* env_;
   const string file_path_;
   std::atomic_int_fast32_t num_outstanding_events_;
@@ -65,6 +77,9 @@ class SingleDebugEventFileWriter {
   std::unique_ptr<WritableFile> writable_file_;
   std::unique_ptr<io::RecordWriter> record_writer_ TF_PT_GUARDED_BY(writer_mu_);
   mutex writer_mu_;
+
+  // Destroyed first, while the members its thread uses are still alive.
+  std::unique_ptr<AsyncRecordQueue> async_writes_;
 };
 
 // The DebugEvents writer class.
@@ -103,11 +118,16 @@ class DebugEventsWriter {
   //   circular_buffer_size: Circular buffer size (in number of DebugEvent
   //     protos). If set to a value <=0, will abolish the circular-buffer
   //     behavior.
+  //   max_queued_events: If > 0, the debug events are written to the files
+  //     from background threads, so that the Write*() methods never block on
+  //     the file system. At most max_queued_events events per file wait to be
+  //     written, and further events are dropped until the queue drains. The
+  //     Flush*() and Close() methods wait for the queued events.
   // Returns:
   //   A pointer to a DebugEventsWriter object: a per-dump_root singleton.
-  static DebugEventsWriter* GetDebugEventsWriter(const string& dump_root,
-                                                 const string& tfdbg_run_id,
-                                                 int64_t circular_buffer_size);
+  static DebugEventsWriter* GetDebugEventsWriter(
+      const string& dump_root, const string& tfdbg_run_id,
+      int64_t circular_buffer_size, int64_t max_queued_events = 0);
   // Look up existing events writer by dump_root.
   // If no DebugEventsWriter has been created at the dump_root, a non-OK
   // Status will be returned. Else an OK status will be returned, with
@@ -218,7 +238,7 @@ class DebugEventsWriter {
   static mutex factory_mu_;
 
   DebugEventsWriter(const string& dump_root, const string& tfdbg_run_id,
-                    int64_t circular_buffer_size);
+                    int64_t circular_buffer_size, int64_t max_queued_events);
 
   // Get the path prefix. The same for all files, which differ only in the
   // suffix.
@@ -244,6 +264,7 @@ class DebugEventsWriter {
   mutex initialization_mu_;
 
   const int64_t circular_buffer_size_;
+  const int64_t max_queued_events_;
   std::deque<string> execution_buffer_ TF_GUARDED_BY(execution_buffer_mu_);
   mutex execution_buffer_mu_;
   std::deque<string> graph_execution_trace_buffer_
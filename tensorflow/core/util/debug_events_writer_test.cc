@@ -462,6 +462,45 @@ TEST_F(DebugEventsWriterTest, ConcurrentWriteCallsToTheSameFile) {
   }
 }
 
+TEST_F(DebugEventsWriterTest, ConcurrentAsyncWriteCallsToTheSameFile) {
+  const size_t kConcurrentWrites = 100;
+  DebugEventsWriter* writer = DebugEventsWriter::GetDebugEventsWriter(
+      dump_root_, tfdbg_run_id_, DebugEventsWriter::kDefaultCyclicBufferSize,
+      /*max_queued_events=*/kConcurrentWrites);
+  TF_ASSERT_OK(writer->Init());
+
+  thread::ThreadPool* thread_pool =
+      new thread::ThreadPool(Env::Default(), "test_pool", 8);
+  std::atomic_int_fast64_t counter(0);
+  auto fn = [&writer, &counter]() {
+    const string file_path = strings::Printf(
+        "/home/tf_programs/program_%.3ld.py", counter.fetch_add(1));
+    SourceFile* source_file = new SourceFile();
+    source_file->set_file_path(file_path);
+    source_file->set_host_name("localhost.localdomain");
+    TF_ASSERT_OK(writer->WriteSourceFile(source_file));
+  };
+  for (size_t i = 0; i < kConcurrentWrites; ++i) {
+    thread_pool->Schedule(fn);
+  }
+  delete thread_pool;
+
+  TF_ASSERT_OK(writer->Close());
+
+  std::vector<DebugEvent> actuals;
+  ReadDebugEventProtos(writer, DebugEventFileType::SOURCE_FILES, &actuals);
+  EXPECT_EQ(actuals.size(), kConcurrentWrites);
+  std::vector<string> file_paths;
+  for (size_t i = 0; i < actuals.size(); ++i) {
+    file_paths.push_back(actuals[i].source_file().file_path());
+  }
+  std::sort(file_paths.begin(), file_paths.end());
+  for (size_t i = 0; i < file_paths.size(); ++i) {
+    EXPECT_EQ(file_paths[i],
+              strings::Printf("/home/tf_programs/program_%.3ld.py", i));
+  }
+}
+
 TEST_F(DebugEventsWriterTest, ConcurrentWriteAndFlushCallsToTheSameFile) {
   const size_t kConcurrentWrites = 100;
   DebugEventsWriter* writer = DebugEventsWriter::GetDebugEventsWriter(
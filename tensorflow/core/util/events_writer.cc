@@ -17,6 +17,9 @@ limitations under the License.
 
 #include <stddef.h>  // for NULL
 
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -43,10 +46,36 @@ EventsWriter::~EventsWriter() {
 Status EventsWriter::Init() { return InitWithSuffix(""); }
 
 Status EventsWriter::InitWithSuffix(const string& suffix) {
+  DrainAsyncWrites();
   file_suffix_ = suffix;
   return InitIfNeeded();
 }
 
+void EventsWriter::EnableAsyncWrites(int64_t max_queued_events) {
+  async_writes_ = std::make_unique<AsyncRecordQueue>(
+      env_, "events_writer", max_queued_events,
+      [this](const std::vector<string>& events) {
+        for (const string& event : events) {
+          WriteSerializedEventNow(event);
+        }
+        // Pushes the batch to the file from the background thread, so that
+        // Flush() only has to sync it.
+        if (recordio_writer_ != nullptr) {
+          recordio_writer_->Flush().IgnoreError();
+        }
+      });
+}
+
+int64_t EventsWriter::num_dropped_events() const {
+  return async_writes_ == nullptr ? 0 : async_writes_->num_dropped_records();
+}
+
+void EventsWriter::DrainAsyncWrites() {
+  if (async_writes_ != nullptr) {
+    async_writes_->Drain();
+  }
+}
+
 Status EventsWriter::InitIfNeeded() {
   if (recordio_writer_ != nullptr) {
     CHECK(!filename_.empty());
@@ -91,13 +120,17 @@ Status EventsWriter::InitIfNeeded() {
     event.set_file_version(strings::StrCat(kVersionPrefix, kCurrentVersion));
     SourceMetadata* source_metadata = event.mutable_source_metadata();
     source_metadata->set_writer(kWriterSourceMetadata);
-    WriteEvent(event);
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(Flush(), "Flushing first event.");
+    string record;
+    event.AppendToString(&record);
+    WriteSerializedEventNow(record);
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(FlushWrittenEvents(),
+                                    "Flushing first event.");
   }
   return OkStatus();
 }
 
 string EventsWriter::FileName() {
+  DrainAsyncWrites();
   if (filename_.empty()) {
     InitIfNeeded().IgnoreError();
   }
@@ -105,6 +138,14 @@ string EventsWriter::FileName() {
 }
 
 void EventsWriter::WriteSerializedEvent(StringPiece event_str) {
+  if (async_writes_ != nullptr) {
+    async_writes_->Enqueue(event_str);
+    return;
+  }
+  WriteSerializedEventNow(event_str);
+}
+
+void EventsWriter::WriteSerializedEventNow(StringPiece event_str) {
   if (recordio_writer_ == nullptr) {
     if (!InitIfNeeded().ok()) {
       LOG(ERROR) << "Write failed because file could not be opened.";
@@ -124,6 +165,11 @@ void EventsWriter::WriteEvent(const Event& event) {
 }
 
 Status EventsWriter::Flush() {
+  DrainAsyncWrites();
+  return FlushWrittenEvents();
+}
+
+Status EventsWriter::FlushWrittenEvents() {
   if (num_outstanding_events_ == 0) return OkStatus();
   CHECK(recordio_file_ != nullptr) << "Unexpected NULL file";
 
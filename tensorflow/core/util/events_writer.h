@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/async_record_queue.h"
 #include "tensorflow/core/util/event.pb.h"
 
 namespace tensorflow {
@@ -58,6 +59,18 @@ class EventsWriter {
   Status Init();
   Status InitWithSuffix(const std::string& suffix);
 
+  // Writes the events from a background thread instead of the calling one,
+  // so that Write*() never block on the file system. At most
+  // `max_queued_events` events wait to be written, and further events are
+  // dropped until the queue drains, see num_dropped_events(). Flush() and
+  // Close() wait for the queued events to be written. Must be called before
+  // any event is written.
+  void EnableAsyncWrites(int64_t max_queued_events);
+
+  // The number of events dropped because the queue of asynchronous writes was
+  // full.
+  int64_t num_dropped_events() const;
+
   // Returns the filename for the current events file:
   // filename_ = [file_prefix_].out.events.[timestamp].[hostname][suffix]
   std::string FileName();
@@ -84,6 +97,12 @@ class EventsWriter {
  private:
   Status FileStillExists();  // OK if event_file_path_ exists.
   Status InitIfNeeded();
+  // Waits for the queued asynchronous writes, if any.
+  void DrainAsyncWrites();
+  // Writes "event_str" to the file from the calling thread.
+  void WriteSerializedEventNow(tensorflow::StringPiece event_str);
+  // Flushes the written events, without waiting for the queued ones.
+  Status FlushWrittenEvents();
 
   Env* env_;
   const std::string file_prefix_;
@@ -92,6 +111,9 @@ class EventsWriter {
   std::unique_ptr<WritableFile> recordio_file_;
   std::unique_ptr<io::RecordWriter> recordio_writer_;
   int num_outstanding_events_;
+  // Writes the events in the background if EnableAsyncWrites() was called.
+  // Destroyed first, while the members its thread uses are still alive.
+  std::unique_ptr<AsyncRecordQueue> async_writes_;
   TF_DISALLOW_COPY_AND_ASSIGN(EventsWriter);
 };
 
@@ -206,5 +206,26 @@ TEST(EventWriter, FileDeletionBeforeWriting) {
   VerifyFile(filename1);
 }
 
+TEST(EventWriter, AsyncWriteFlush) {
+  string file_prefix = GetDirName("/asyncwriteflush_test");
+  EventsWriter writer(file_prefix);
+  writer.EnableAsyncWrites(/*max_queued_events=*/10);
+  WriteFile(&writer);
+  TF_EXPECT_OK(writer.Flush());
+  EXPECT_EQ(writer.num_dropped_events(), 0);
+  string filename = writer.FileName();
+  VerifyFile(filename);
+}
+
+TEST(EventWriter, AsyncWriteDelete) {
+  string file_prefix = GetDirName("/asyncwritedelete_test");
+  EventsWriter* writer = new EventsWriter(file_prefix);
+  writer->EnableAsyncWrites(/*max_queued_events=*/10);
+  WriteFile(writer);
+  string filename = writer->FileName();
+  delete writer;
+  VerifyFile(filename);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <limits>
 #include <utility>
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
@@ -170,6 +171,27 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedMultiByteVarints) {
+  Example example;
+  auto* int64_list = (*example.mutable_features()->mutable_feature())["ids"]
+                         .mutable_int64_list();
+  for (int64_t value : {int64_t{0}, int64_t{1}, int64_t{127}, int64_t{128},
+                        int64_t{300}, int64_t{1} << 40, int64_t{-1},
+                        std::numeric_limits<int64_t>::min(),
+                        std::numeric_limits<int64_t>::max()}) {
+    int64_list->add_value(value);
+  }
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, PackedTruncatedVarint) {
+  // The last byte of the packed values has the continuation bit set.
+  Example example;
+  EXPECT_FALSE(TestFastParse(
+      "\x0a\x0e\x0a\x0c\x0a\x03\x61\x67\x65\x12\x05\x1a\x03\x0a\x01\x8d",
+      &example));
+}
+
 TEST(FastParse, ValueBeforeKeyInMap) {
   TestCorrectness("\x0a\x12\x0a\x10\x12\x09\x0a\x07\x0a\x05value\x0a\x03key");
 }
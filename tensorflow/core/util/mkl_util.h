@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_MKL_UTIL_H_
 #ifdef INTEL_MKL
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <string>
@@ -25,6 +26,7 @@ limitations under the License.
 #include <vector>
 
 #include "dnnl.hpp"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -32,16 +34,16 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/mkl_threadpool.h"
 #include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
-#ifdef DNNL_AARCH64_USE_ACL
-#include "tensorflow/core/platform/mutex.h"
-#endif
 
 using dnnl::engine;
 using dnnl::memory;
@@ -1759,14 +1761,25 @@ const dnnl::memory::dims NONE_DIMS = {};
 // cached items. When the cache reaches its capacity, the LRU item will
 // be removed and replaced by a new one from SetOp call.
 //
+// Several caches, e.g. the thread local caches of all the threads, can also
+// share a bound: if `num_cached_in_process` is not null, it counts the items
+// of all the caches sharing it, and SetOp evicts the LRU items of this cache
+// while it is at least `process_capacity`.
+//
 template <typename T>
 class LRUCache {
  public:
-  explicit LRUCache(size_t capacity) {
+  explicit LRUCache(size_t capacity,
+                    std::atomic<int64_t>* num_cached_in_process = nullptr,
+                    int64_t process_capacity = 0)
+      : num_cached_in_process_(num_cached_in_process),
+        process_capacity_(process_capacity) {
     capacity_ = capacity;
     Clear();
   }
 
+  ~LRUCache() { Clear(); }
+
   T* GetOp(const string& key) {
 #ifdef DNNL_AARCH64_USE_ACL
     mutex_lock lock(lru_mu_);
@@ -1790,11 +1803,16 @@ class LRUCache {
     if (lru_list_.size() >= capacity_) {
       Delete();
     }
+    if (num_cached_in_process_ != nullptr && process_capacity_ > 0) {
+      while (*num_cached_in_process_ >= process_capacity_ && Delete()) {
+      }
+    }
 
     // Insert an entry to the front of the LRU list
     lru_list_.push_front(key);
     Entry entry(op, lru_list_.begin());
     cache_.emplace(std::make_pair(key, std::move(entry)));
+    if (num_cached_in_process_ != nullptr) ++*num_cached_in_process_;
 #ifdef DNNL_AARCH64_USE_ACL
     FinishedAllocation(key);
 #endif
@@ -1803,6 +1821,9 @@ class LRUCache {
   void Clear() {
     if (lru_list_.empty()) return;
 
+    if (num_cached_in_process_ != nullptr) {
+      *num_cached_in_process_ -= lru_list_.size();
+    }
     // Clean up the cache
     cache_.clear();
     lru_list_.clear();
@@ -1859,12 +1880,17 @@ class LRUCache {
     string key = lru_list_.back();
     lru_list_.pop_back();
     cache_.erase(key);
+    if (num_cached_in_process_ != nullptr) --*num_cached_in_process_;
     return true;
   }
 
   // Cache capacity
   size_t capacity_;
 
+  // The number of items of all the caches sharing the process capacity.
+  std::atomic<int64_t>* const num_cached_in_process_;
+  const int64_t process_capacity_;
+
   // The cache, a map from string key to a LRU entry.
   std::unordered_map<string, Entry> cache_;
 
@@ -1884,6 +1910,36 @@ class LRUCache {
 #endif
 };
 
+// Reads the capacity of a oneDNN cache from the environment variable
+// `env_var`.
+inline int64_t ReadMklCacheCapacity(StringPiece env_var,
+                                    int64_t default_value) {
+  int64_t value = default_value;
+  TF_CHECK_OK(ReadInt64FromEnvVar(env_var, default_value, &value));
+  return value;
+}
+
+// The number of oneDNN primitives cached by all the threads of the process.
+inline std::atomic<int64_t>* NumCachedMklPrimitives() {
+  static std::atomic<int64_t> num_cached_primitives{0};
+  return &num_cached_primitives;
+}
+
+// Records a lookup in the oneDNN primitive caches. Hits happen on every
+// execution of a kernel, so each thread records them in batches.
+inline void RecordMklPrimitiveCacheLookup(bool hit) {
+  if (!hit) {
+    metrics::UpdateOneDnnCacheLookups("primitive", /*hit=*/false, 1);
+    return;
+  }
+  constexpr int64_t kHitsPerUpdate = 256;
+  static thread_local int64_t num_hits = 0;
+  if (++num_hits == kHitsPerUpdate) {
+    metrics::UpdateOneDnnCacheLookups("primitive", /*hit=*/true, num_hits);
+    num_hits = 0;
+  }
+}
+
 template <typename T>
 class MklPrimitiveFactory {
  public:
@@ -1894,7 +1950,9 @@ class MklPrimitiveFactory {
   MklPrimitive* GetOp(const string& key) {
 #ifndef DNNL_AARCH64_USE_ACL
     auto& lru_cache = MklPrimitiveFactory<T>::GetLRUCache();
-    return lru_cache.GetOp(key);
+    MklPrimitive* primitive = lru_cache.GetOp(key);
+    RecordMklPrimitiveCacheLookup(primitive != nullptr);
+    return primitive;
 #else
     while (true) {
       // TODO(milpuz01): Consider if it is possible to narrow scope to be
@@ -1905,6 +1963,7 @@ class MklPrimitiveFactory {
       // Check to see whether primitive already exists.
       MklPrimitive* primitive = lru_cache.GetOp(key);
       if (primitive != nullptr) {
+        RecordMklPrimitiveCacheLookup(/*hit=*/true);
         return primitive;
       }
 
@@ -1912,6 +1971,7 @@ class MklPrimitiveFactory {
       if (!lru_cache.IsAllocating(key)) {
         // This thread is going to pick it up and create the primitive.
         lru_cache.Allocate(key);
+        RecordMklPrimitiveCacheLookup(/*hit=*/false);
         return nullptr;
         // Now we release lock as primitive creation might take long time.
       }
@@ -1972,12 +2032,22 @@ class MklPrimitiveFactory {
 #endif
 
  private:
+  // The primitives are cached per thread, since they hold the memory objects
+  // of their executions. TF_ONEDNN_PRIMITIVE_CACHE_CAPACITY bounds the
+  // number of primitives of each factory in each thread, and
+  // TF_ONEDNN_PROCESS_PRIMITIVE_CACHE_CAPACITY, if positive, the number of
+  // primitives of all the factories in all the threads.
   static inline LRUCache<MklPrimitive>& GetLRUCache() {
-    static const int kCapacity = 1024;  // cache capacity
+    static const int64_t kCapacity =
+        ReadMklCacheCapacity("TF_ONEDNN_PRIMITIVE_CACHE_CAPACITY", 1024);
+    static const int64_t kProcessCapacity =
+        ReadMklCacheCapacity("TF_ONEDNN_PROCESS_PRIMITIVE_CACHE_CAPACITY", 0);
 #ifndef DNNL_AARCH64_USE_ACL
-    static thread_local LRUCache<MklPrimitive> lru_cache_(kCapacity);
+    static thread_local LRUCache<MklPrimitive> lru_cache_(
+        kCapacity, NumCachedMklPrimitives(), kProcessCapacity);
 #else
-    static LRUCache<MklPrimitive> lru_cache_(kCapacity);
+    static LRUCache<MklPrimitive> lru_cache_(
+        kCapacity, NumCachedMklPrimitives(), kProcessCapacity);
 #endif
     return lru_cache_;
   }
@@ -2167,6 +2237,105 @@ inline MklReorderPrimitive* FindOrCreateReorder(const memory* from,
   return reorder_prim;
 }
 
+// A process wide cache of the weights reordered to the layouts of oneDNN
+// primitives, keyed by the content of the weights and by the layouts, so
+// that the kernels of all the sessions and functions sharing constant
+// weights reorder them once. The cached tensors are read-only. Their total
+// size is bounded by TF_ONEDNN_WEIGHT_CACHE_CAPACITY_MB, and a capacity of 0
+// disables the cache.
+class MklWeightCache {
+ public:
+  // Returns the cache of the process, or nullptr if it is disabled.
+  static MklWeightCache* Global() {
+    static MklWeightCache* cache = []() -> MklWeightCache* {
+      const int64_t capacity_mb =
+          ReadMklCacheCapacity("TF_ONEDNN_WEIGHT_CACHE_CAPACITY_MB", 1024);
+      if (capacity_mb <= 0) return nullptr;
+      return new MklWeightCache(capacity_mb << 20);
+    }();
+    return cache;
+  }
+
+  explicit MklWeightCache(int64_t capacity_bytes)
+      : capacity_bytes_(capacity_bytes) {}
+
+  // The key of `weights` reordered from `src_md` to `dst_md`. Descriptors
+  // with different bytes only cause misses.
+  static string Key(const Tensor& weights, const memory::desc& src_md,
+                    const memory::desc& dst_md) {
+    const StringPiece data = weights.tensor_data();
+    const Fprint128 data_fp = Fingerprint128(data);
+    const Fprint128 md_fp = Fingerprint128(strings::StrCat(
+        StringPiece(reinterpret_cast<const char*>(&src_md.data),
+                    sizeof(src_md.data)),
+        StringPiece(reinterpret_cast<const char*>(&dst_md.data),
+                    sizeof(dst_md.data))));
+    return strings::StrCat(weights.dtype(), "_", data.size(), "_",
+                           data_fp.low64, "_", data_fp.high64, "_",
+                           md_fp.low64, "_", md_fp.high64);
+  }
+
+  // Sets `*weights` to the cached weights of `key`, if any.
+  bool Lookup(const string& key, Tensor* weights) TF_LOCKS_EXCLUDED(mu_) {
+    bool hit = false;
+    {
+      mutex_lock l(mu_);
+      auto it = entries_.find(key);
+      if (it != entries_.end()) {
+        lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_iterator);
+        *weights = it->second.weights;
+        hit = true;
+      }
+    }
+    metrics::UpdateOneDnnCacheLookups("weight", hit, 1);
+    return hit;
+  }
+
+  // Caches `weights` as the weights of `key`. Weights that no kernel uses
+  // any more are evicted first, then the least recently used ones.
+  void Insert(const string& key, const Tensor& weights)
+      TF_LOCKS_EXCLUDED(mu_) {
+    const int64_t bytes = weights.TotalBytes();
+    if (bytes > capacity_bytes_) return;
+    mutex_lock l(mu_);
+    if (entries_.count(key) > 0) return;
+    if (size_bytes_ + bytes > capacity_bytes_) {
+      for (auto it = lru_list_.begin(); it != lru_list_.end();) {
+        const string unused_key = *it++;
+        if (entries_.at(unused_key).weights.RefCountIsOne()) {
+          Erase(unused_key);
+        }
+      }
+    }
+    while (size_bytes_ + bytes > capacity_bytes_ && !lru_list_.empty()) {
+      Erase(lru_list_.back());
+    }
+    lru_list_.push_front(key);
+    entries_[key] = {weights, lru_list_.begin()};
+    size_bytes_ += bytes;
+  }
+
+ private:
+  struct Entry {
+    Tensor weights;
+    std::list<string>::iterator lru_iterator;
+  };
+
+  void Erase(string key) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto it = entries_.find(key);
+    size_bytes_ -= it->second.weights.TotalBytes();
+    lru_list_.erase(it->second.lru_iterator);
+    entries_.erase(it);
+  }
+
+  const int64_t capacity_bytes_;
+  mutex mu_;
+  int64_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // The keys, from the most to the least recently used.
+  std::list<string> lru_list_ TF_GUARDED_BY(mu_);
+  std::unordered_map<string, Entry> entries_ TF_GUARDED_BY(mu_);
+};
+
 // utility function to determine if it is conv 1x1 and stride != 1
 // for purpose of temporarily disabling primitive reuse
 inline bool IsConv1x1StrideNot1(memory::dims filter_dims,
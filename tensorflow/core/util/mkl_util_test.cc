@@ -115,6 +115,68 @@ TEST(MklUtilTest, LRUCacheTest) {
   }
 }
 
+TEST(MklUtilTest, LRUCacheProcessCapacityTest) {
+  std::atomic<int64_t> num_cached{0};
+  const int64_t process_capacity = 4;
+  {
+    LRUCache<int> cache_a(/*capacity=*/10, &num_cached, process_capacity);
+    LRUCache<int> cache_b(/*capacity=*/10, &num_cached, process_capacity);
+    for (int k = 0; k < 3; ++k) {
+      cache_a.SetOp(std::to_string(k), new int(k));
+    }
+    EXPECT_EQ(num_cached, 3);
+
+    // Once the caches together hold process_capacity objects, the least
+    // recently accessed objects of the inserting cache are evicted.
+    for (int k = 0; k < 3; ++k) {
+      cache_b.SetOp(std::to_string(k), new int(k));
+    }
+    EXPECT_EQ(num_cached, 4);
+    EXPECT_NE(nullptr, cache_a.GetOp("2"));
+    EXPECT_EQ(nullptr, cache_b.GetOp("0"));
+    EXPECT_EQ(nullptr, cache_b.GetOp("1"));
+    EXPECT_NE(nullptr, cache_b.GetOp("2"));
+
+    cache_a.Clear();
+    EXPECT_EQ(num_cached, 1);
+  }
+  EXPECT_EQ(num_cached, 0);
+}
+
+TEST(MklUtilTest, WeightCacheTest) {
+  memory::desc src_md({2, 2}, memory::data_type::f32, memory::format_tag::ab);
+  memory::desc dst_md({2, 2}, memory::data_type::f32, memory::format_tag::ba);
+  Tensor weights(DT_FLOAT, TensorShape({2, 2}));
+  weights.flat<float>().setConstant(1.0f);
+  Tensor other_weights(DT_FLOAT, TensorShape({2, 2}));
+  other_weights.flat<float>().setConstant(2.0f);
+  const string key = MklWeightCache::Key(weights, src_md, dst_md);
+  EXPECT_EQ(key, MklWeightCache::Key(weights, src_md, dst_md));
+  EXPECT_NE(key, MklWeightCache::Key(other_weights, src_md, dst_md));
+  EXPECT_NE(key, MklWeightCache::Key(weights, src_md, src_md));
+
+  // Room for two reordered weights of 16 bytes.
+  MklWeightCache cache(/*capacity_bytes=*/32);
+  Tensor cached;
+  EXPECT_FALSE(cache.Lookup(key, &cached));
+  {
+    Tensor reordered(DT_FLOAT, TensorShape({4}));
+    cache.Insert(key, reordered);
+  }
+  Tensor in_use(DT_FLOAT, TensorShape({4}));
+  cache.Insert("in_use", in_use);
+  EXPECT_TRUE(cache.Lookup(key, &cached));
+  EXPECT_EQ(cached.NumElements(), 4);
+
+  // The weights that no kernel uses are evicted first, even if they were
+  // used more recently.
+  cached = Tensor();
+  cache.Insert("new", Tensor(DT_FLOAT, TensorShape({4})));
+  EXPECT_FALSE(cache.Lookup(key, &cached));
+  EXPECT_TRUE(cache.Lookup("in_use", &cached));
+  EXPECT_TRUE(cache.Lookup("new", &cached));
+}
+
 }  // namespace
 }  // namespace tensorflow
 
@@ -42,6 +42,25 @@ namespace tensorflow {
 string MetaFilename(StringPiece prefix);
 string DataFilename(StringPiece prefix, int32_t shard_id, int32_t num_shards);
 
+// Name of an optional bool attr of RestoreV2 nodes. If true, the op backs the
+// full tensors it restores by memory mappings of the data files where possible
+// (see BundleReader::LookupMapped) instead of reading them.
+constexpr char kMapRestoredTensorsAttr[] = "_map_restored_tensors";
+
+// Name of an optional bool attr of RestoreV2 nodes. If true, the op shares the
+// full tensors it restores with identical tensors restored elsewhere in the
+// process (see BundleReader::LookupShared).
+constexpr char kShareRestoredTensorsAttr[] = "_share_restored_tensors";
+
+// Name of an optional bool attr of SaveV2 nodes. If true, the op returns once
+// it holds references to the tensors to save, and writes them on a background
+// thread pool (see ScheduleSave in core/kernels/save_restore_tensor.h).
+// MergeV2Checkpoints, RestoreV2 and later saves of the same checkpoint wait for
+// the write. Resource variables copy their buffer before updating it while it
+// is referenced, so the saved values are those of the step that ran the op;
+// reference variables are updated in place and must not be saved this way.
+constexpr char kAsyncSaveAttr[] = "_async_save";
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_NAMING_H_
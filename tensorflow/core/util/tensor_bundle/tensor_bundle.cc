@@ -19,8 +19,11 @@ limitations under the License.
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <unordered_map>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -34,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -45,6 +49,8 @@ limitations under the License.
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
@@ -60,11 +66,49 @@ namespace tensorflow {
 // Versioning of the tensor bundle format.
 const int kTensorBundleMinProducer = 0;
 const int kTensorBundleMinConsumer = 0;
-const int kTensorBundleVersion = 1;
+const int kTensorBundleVersion = 2;
+// The minimum consumer version of bundles written with compression enabled.
+static const int kCompressedTensorBundleMinConsumer = 2;
 
 // Size of our input buffer for streaming reads
 static const int kBufferSize = 1024 * 1024;
 
+// Returns true if data files are read with direct I/O, bypassing the page
+// cache, as set by the TF_DIRECT_IO_READS environment variable.
+static bool ReadDataFilesWithDirectIo() {
+  static const bool direct_io = [] {
+    bool direct_io;
+    if (!ReadBoolFromEnvVar("TF_DIRECT_IO_READS", false, &direct_io).ok()) {
+      direct_io = false;
+    }
+    return direct_io;
+  }();
+  return direct_io;
+}
+
+// Returns the default of BundleReader::set_read_partial_slices(), as set by the
+// TF_PARTIAL_SLICE_RESTORE environment variable.
+static bool ReadPartialSlices() {
+  static const bool partial = [] {
+    bool partial;
+    if (!ReadBoolFromEnvVar("TF_PARTIAL_SLICE_RESTORE", false, &partial)
+             .ok()) {
+      partial = false;
+    }
+    return partial;
+  }();
+  return partial;
+}
+
+// Opens a data file for the reads of GetValue().
+static Status NewDataFile(Env* env, const string& filename,
+                          std::unique_ptr<RandomAccessFile>* file) {
+  if (ReadDataFilesWithDirectIo()) {
+    return env->NewDirectIoRandomAccessFile(filename, file);
+  }
+  return env->NewRandomAccessFile(filename, file);
+}
+
 // Key to the special BundleHeaderProto entry.  Do not change this, as clients
 // can make the assumption that the header is always the first entry in the
 // bundle.
@@ -76,6 +120,9 @@ const int64_t kLargeTensorThreshold = static_cast<int64_t>(1) << 32;
 const int kMaxFileReadThreads = 8;
 // Minimum size of a file section handled by each thread.
 const int64_t kMinSectionSize = static_cast<int64_t>(1) << 31;
+// Partial slice reads merge the byte ranges of a slice that are at most this
+// far apart into a single read.
+const int64_t kMaxPartialReadGap = 64 << 10;
 
 namespace {
 
@@ -218,6 +265,82 @@ Status ReadVariantTensor(io::InputBuffer* buffered_file, Tensor* ret,
   return OkStatus();
 }
 
+// Reads the tensor bytes described by the compressed entry "entry" from "file"
+// and decompresses them into the "size" bytes at "destination". Decompresses
+// the chunks in parallel.
+Status ReadCompressedTensor(RandomAccessFile* file,
+                            const BundleEntryProto& entry, char* destination,
+                            int64_t size) {
+  if (entry.compression() != BundleEntryProto::SNAPPY) {
+    return errors::Unimplemented("Unsupported compression of bundle entry: ",
+                                 entry.compression());
+  }
+  const int64_t chunk_size = entry.chunk_size();
+  const int num_chunks = entry.compressed_chunk_sizes_size();
+  if (chunk_size <= 0 || num_chunks != (size + chunk_size - 1) / chunk_size) {
+    return errors::DataLoss("Invalid chunks in compressed bundle entry: ",
+                            num_chunks, " chunks of ", chunk_size,
+                            " bytes for ", size, " bytes");
+  }
+  std::vector<int64_t> chunk_offsets(num_chunks + 1, 0);
+  for (int i = 0; i < num_chunks; ++i) {
+    if (entry.compressed_chunk_sizes(i) <= 0) {
+      return errors::DataLoss("Invalid size of compressed chunk ", i, ": ",
+                              entry.compressed_chunk_sizes(i));
+    }
+    chunk_offsets[i + 1] = chunk_offsets[i] + entry.compressed_chunk_sizes(i);
+  }
+  if (chunk_offsets[num_chunks] != entry.size()) {
+    return errors::DataLoss("Invalid size of compressed bundle entry: ",
+                            entry.size(), "; size of the chunks ",
+                            chunk_offsets[num_chunks]);
+  }
+
+  std::unique_ptr<char[]> scratch(new char[entry.size()]);
+  StringPiece compressed;
+  TF_RETURN_IF_ERROR(
+      file->Read(entry.offset(), entry.size(), &compressed, scratch.get()));
+  const auto decompress_chunk = [&](int i) -> Status {
+    const char* input = compressed.data() + chunk_offsets[i];
+    const size_t input_size = chunk_offsets[i + 1] - chunk_offsets[i];
+    char* output = destination + i * chunk_size;
+    const size_t output_size = std::min(chunk_size, size - i * chunk_size);
+    if (input_size == output_size) {
+      // The chunk did not shrink, and is stored as is.
+      memcpy(output, input, output_size);
+      return OkStatus();
+    }
+    size_t uncompressed_size = 0;
+    if (!port::Snappy_GetUncompressedLength(input, input_size,
+                                            &uncompressed_size) ||
+        uncompressed_size != output_size ||
+        !port::Snappy_Uncompress(input, input_size, output)) {
+      return errors::DataLoss("Unable to decompress chunk ", i,
+                              " of the bundle entry at offset ",
+                              entry.offset());
+    }
+    return OkStatus();
+  };
+
+  std::vector<Status> statuses(num_chunks);
+  if (num_chunks == 1) {
+    statuses[0] = decompress_chunk(0);
+  } else if (num_chunks > 1) {
+    thread::ThreadPool pool(Env::Default(), "decompress_tensor",
+                            std::min(kMaxFileReadThreads, num_chunks));
+    pool.ParallelFor(num_chunks, /*cost_per_unit=*/chunk_size,
+                     [&](int64_t begin, int64_t end) {
+                       for (int64_t i = begin; i < end; ++i) {
+                         statuses[i] = decompress_chunk(i);
+                       }
+                     });
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return OkStatus();
+}
+
 char* GetBackingBuffer(const Tensor& val) {
   CHECK(DataTypeCanUseMemcpy(val.dtype())) << val.dtype();
   return const_cast<char*>(val.tensor_data().data());
@@ -250,6 +373,44 @@ Status WriteTensor(const Tensor& val, FileOutputBuffer* out,
   return out->Append(StringPiece(buf, *bytes_written));
 }
 
+// Like WriteTensor(), but compresses the bytes of "val" as set by "options",
+// and records the compression in "entry". A chunk that does not shrink is
+// written as is.
+Status WriteCompressedTensor(const Tensor& val,
+                             const BundleWriter::Options& options,
+                             FileOutputBuffer* out, BundleEntryProto* entry,
+                             size_t* bytes_written) {
+  if (options.compression != BundleEntryProto::SNAPPY) {
+    return errors::Unimplemented("Unsupported compression of bundle entries: ",
+                                 options.compression);
+  }
+  const int64_t chunk_size = options.compression_chunk_bytes;
+  if (chunk_size <= 0) {
+    return errors::InvalidArgument("Invalid compression chunk size: ",
+                                   chunk_size);
+  }
+  entry->set_compression(options.compression);
+  entry->set_chunk_size(chunk_size);
+  const char* buf = GetBackingBuffer(val);
+  const int64_t size = val.TotalBytes();
+  *bytes_written = 0;
+  string compressed;
+  for (int64_t offset = 0; offset < size; offset += chunk_size) {
+    StringPiece chunk(buf + offset, std::min(chunk_size, size - offset));
+    if (!port::Snappy_Compress(chunk.data(), chunk.size(), &compressed)) {
+      return errors::Unimplemented(
+          "Snappy compression is not supported on this platform");
+    }
+    if (compressed.size() < chunk.size()) chunk = compressed;
+    TF_RETURN_IF_ERROR(out->Append(chunk));
+    entry->add_compressed_chunk_sizes(chunk.size());
+    *bytes_written += chunk.size();
+  }
+  VLOG(1) << "Appended " << *bytes_written << " bytes compressed from "
+          << size << " bytes to file";
+  return OkStatus();
+}
+
 // Serializes string tensor "val".  "bytes_written" is treated in the same
 // fashion as WriteTensor().
 //
@@ -418,6 +579,90 @@ Status PadAlignment(FileOutputBuffer* out, int alignment, int64_t* size) {
   return status;
 }
 
+// A tensor buffer that aliases the bytes of a tensor in a memory-mapped data
+// file. Holds a reference to the mapping so the pages stay valid while the
+// tensor is alive.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     uint64 offset, uint64 length)
+      : TensorBuffer(const_cast<char*>(
+            static_cast<const char*>(region->data()) + offset)),
+        region_(std::move(region)),
+        length_(length) {}
+
+  size_t size() const override { return length_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64_t>(length_));
+    proto->set_allocator_name("MappedTensorBundle");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // The mapping is read-only, so the buffer must never be forwarded to a
+  // kernel that writes its output in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const uint64 length_;
+};
+
+// The process-wide set of tensors restored by BundleReader::LookupShared(),
+// bucketed by the checksum stored in their bundle entries. An entry expires
+// once no tensor outside the set refers to its buffer.
+class SharedRestoredTensors {
+ public:
+  static SharedRestoredTensors* Global() {
+    static SharedRestoredTensors* global = new SharedRestoredTensors;
+    return global;
+  }
+
+  // Returns a previously added tensor with the same dtype, shape and bytes as
+  // "tensor", or adds "tensor" and returns it.
+  Tensor Intern(uint32 crc32c, const Tensor& tensor) {
+    mutex_lock l(mu_);
+    auto range = tensors_.equal_range(crc32c);
+    for (auto it = range.first; it != range.second;) {
+      const Tensor& shared = it->second;
+      if (shared.RefCountIsOne()) {
+        it = tensors_.erase(it);
+        continue;
+      }
+      if (shared.dtype() == tensor.dtype() &&
+          shared.shape() == tensor.shape() &&
+          shared.tensor_data() == tensor.tensor_data()) {
+        return shared;
+      }
+      ++it;
+    }
+
+    if (tensors_.size() >= next_sweep_size_) {
+      for (auto it = tensors_.begin(); it != tensors_.end();) {
+        if (it->second.RefCountIsOne()) {
+          it = tensors_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      next_sweep_size_ = std::max<size_t>(kMinSweepSize, 2 * tensors_.size());
+    }
+    tensors_.emplace(crc32c, tensor);
+    return tensor;
+  }
+
+ private:
+  static constexpr size_t kMinSweepSize = 1024;
+
+  mutex mu_;
+  std::unordered_multimap<uint32, Tensor> tensors_ TF_GUARDED_BY(mu_);
+  // Expired entries outside the looked up bucket are removed when the set
+  // grows to this size.
+  size_t next_sweep_size_ TF_GUARDED_BY(mu_) = kMinSweepSize;
+};
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
@@ -470,6 +715,11 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
     status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
   } else if (val.dtype() == DT_VARIANT) {
     status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
+  } else if (options_.compression != BundleEntryProto::NONE &&
+             val.TotalBytes() >= options_.min_compressed_tensor_bytes) {
+    status_ = WriteCompressedTensor(val, options_, out_.get(), entry,
+                                    &data_bytes_written);
+    crc32c = crc32c::Value(GetBackingBuffer(val), val.TotalBytes());
   } else {
     status_ = WriteTensor(val, out_.get(), &data_bytes_written);
     crc32c = out_->crc32c();
@@ -558,7 +808,9 @@ Status BundleWriter::Finish() {
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
     version->set_producer(kTensorBundleVersion);
-    version->set_min_consumer(kTensorBundleMinConsumer);
+    version->set_min_consumer(options_.compression != BundleEntryProto::NONE
+                                  ? kCompressedTensorBundleMinConsumer
+                                  : kTensorBundleMinConsumer);
 
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
 
@@ -773,7 +1025,8 @@ BundleReader::BundleReader(
       index_cache_(nullptr),
       iter_(nullptr),
       need_to_swap_bytes_(false),
-      enable_multi_threading_for_testing_(enable_multi_threading_for_testing) {
+      enable_multi_threading_for_testing_(enable_multi_threading_for_testing),
+      read_partial_slices_(ReadPartialSlices()) {
   const string filename = MetaFilename(prefix_);
   uint64 file_size;
   status_ = env_->GetFileSize(filename, &file_size);
@@ -872,8 +1125,14 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     ret = new Tensor(entry.dtype(), stored_shape);
   }
 
-  // Validates the "size" field.
-  if (entry.dtype() != DT_STRING && entry.dtype() != DT_VARIANT) {
+  // Validates the "size" field. The stored size of compressed entries is
+  // validated against their chunks when reading them.
+  if (entry.compression() != BundleEntryProto::NONE) {
+    if (!DataTypeCanUseMemcpy(entry.dtype())) {
+      return errors::DataLoss("Compressed bundle entry of dtype ",
+                              DataTypeString(entry.dtype()), ": key ", key());
+    }
+  } else if (entry.dtype() != DT_STRING && entry.dtype() != DT_VARIANT) {
     if (entry.size() != ret->TotalBytes()) {
       return errors::DataLoss("Invalid size in bundle entry: key ", key(),
                               "; stored size ", entry.size(),
@@ -898,8 +1157,8 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   io::InputBuffer* buffered_file = data_[entry.shard_id()];
   if (buffered_file == nullptr) {
     std::unique_ptr<RandomAccessFile> file = nullptr;
-    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
+    TF_RETURN_IF_ERROR(NewDataFile(
+        env_, DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
     buffered_file = new io::InputBuffer(file.release(), kBufferSize);
     // The InputBuffer and RandomAccessFile objects are both released in dtor.
     data_[entry.shard_id()] = buffered_file;
@@ -912,7 +1171,11 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   if (DataTypeCanUseMemcpy(entry.dtype())) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
     size_t unused_bytes_read;
-    if (entry.size() > kBufferSize) {
+    if (entry.compression() != BundleEntryProto::NONE) {
+      TF_RETURN_IF_ERROR(ReadCompressedTensor(buffered_file->file(), entry,
+                                              backing_buffer,
+                                              ret->TotalBytes()));
+    } else if (entry.size() > kBufferSize) {
       StringPiece sp;
       if (!enable_multi_threading_for_testing_ &&
           entry.size() < kLargeTensorThreshold) {
@@ -943,8 +1206,8 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
                                                      : section_size;
             std::unique_ptr<RandomAccessFile> section_reader = nullptr;
             StringPiece sp;
-            if (auto file_status = env_->NewRandomAccessFile(
-                    DataFilename(prefix_, entry.shard_id(), num_shards_),
+            if (auto file_status = NewDataFile(
+                    env_, DataFilename(prefix_, entry.shard_id(), num_shards_),
                     &section_reader);
                 !file_status.ok()) {
               statuses[i] = file_status;
@@ -970,7 +1233,7 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
     // Note that we compute the checksum *before* byte-swapping. The checksum
     // should be on the bytes in the order they appear in the file.
-    actual_crc32c = crc32c::Value(backing_buffer, entry.size());
+    actual_crc32c = crc32c::Value(backing_buffer, ret->TotalBytes());
     if (need_to_swap_bytes_) {
       TF_RETURN_IF_ERROR(ByteSwapTensor(ret));
     }
@@ -1020,6 +1283,74 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+
+  const TensorShape stored_shape(entry.shape());
+  if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype()) ||
+      entry.compression() != BundleEntryProto::NONE || need_to_swap_bytes_ ||
+      stored_shape.num_elements() == 0 ||
+      entry.offset() % Allocator::kAllocatorAlignment != 0) {
+    *val = Tensor(entry.dtype(), stored_shape);
+    return Lookup(key, val);
+  }
+
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    if (!env_->NewReadOnlyMemoryRegionFromFile(
+                  DataFilename(prefix_, entry.shard_id(), num_shards_), &region)
+             .ok()) {
+      // Not every file system can map files; fall back to reading.
+      region.reset();
+    }
+    it = mapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+  if (region == nullptr) {
+    *val = Tensor(entry.dtype(), stored_shape);
+    return Lookup(key, val);
+  }
+
+  const int64_t expected_size =
+      stored_shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != expected_size) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(),
+                            "; expected size ", expected_size);
+  }
+  if (entry.offset() < 0 ||
+      static_cast<uint64>(entry.offset() + entry.size()) > region->length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), ": entry ", key, " at offset ",
+                            entry.offset(), " (", entry.size(),
+                            " bytes) runs past the end of the data file (",
+                            region->length(), " bytes)");
+  }
+
+  auto* buf = new MappedTensorBuffer(region, entry.offset(), entry.size());
+  *val = Tensor(entry.dtype(), stored_shape, buf);
+  buf->Unref();
+  return OkStatus();
+}
+
+Status BundleReader::LookupShared(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+
+  *val = Tensor(entry.dtype(), TensorShape(entry.shape()));
+  TF_RETURN_IF_ERROR(Lookup(key, val));
+  if (entry.slices().empty() && DataTypeCanUseMemcpy(entry.dtype()) &&
+      val->NumElements() > 0) {
+    // Lookup() has verified that the bytes read match the stored checksum.
+    *val = SharedRestoredTensors::Global()->Intern(entry.crc32c(), *val);
+  }
+  return OkStatus();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1058,6 +1389,42 @@ Status BundleReader::LookupSlice(StringPiece full_tensor_key,
   return GetSliceValue(full_tensor_key, entry, slice_spec, val);
 }
 
+// Copies the intersection of `src_slice` and `dst_slice` of a tensor of shape
+// `full_shape` from `src`, which holds `src_slice`, to `dst`, which holds
+// `dst_slice`.
+static Status CopySliceData(const TensorShape& full_shape,
+                            const TensorSlice& src_slice, const Tensor& src,
+                            const TensorSlice& dst_slice, Tensor* dst) {
+  switch (src.dtype()) {
+#define HANDLE_COPY(T)                                            \
+  case DataTypeToEnum<T>::value:                                  \
+    CHECK(CopyDataFromTensorSliceToTensorSlice(                   \
+        full_shape, src_slice, dst_slice, src.flat<T>().data(),   \
+        dst->flat<T>().data()));                                  \
+    break;
+
+    HANDLE_COPY(float)
+    HANDLE_COPY(double)
+    HANDLE_COPY(int32)
+    HANDLE_COPY(uint8)
+    HANDLE_COPY(int16)
+    HANDLE_COPY(int8)
+    HANDLE_COPY(complex64)
+    HANDLE_COPY(complex128)
+    HANDLE_COPY(int64_t)
+    HANDLE_COPY(bool)
+    HANDLE_COPY(qint32)
+    HANDLE_COPY(quint8)
+    HANDLE_COPY(qint8)
+    HANDLE_COPY(bfloat16)
+    default:
+      return errors::InvalidArgument("Dtype ", DataTypeString(src.dtype()),
+                                     " not supported.");
+#undef HANDLE_COPY
+  }
+  return OkStatus();
+}
+
 Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
                                    const BundleEntryProto& full_tensor_entry,
                                    const TensorSlice& slice_spec, Tensor* val) {
@@ -1136,39 +1503,158 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
       return status_;
     }
 
+    // Reads only the part of the stored slice that is requested, if it is
+    // smaller than the stored slice.
+    TensorSlice intersection;
+    TensorShape intersection_shape;
+    if (read_partial_slices_ &&
+        DataTypeCanUseMemcpy(stored_slice_entry.dtype()) &&
+        stored_slice_entry.compression() == BundleEntryProto::NONE &&
+        stored_slice.Intersect(slice_spec, &intersection) &&
+        intersection.SliceTensorShape(full_shape, &intersection_shape).ok() &&
+        intersection_shape.num_elements() <
+            stored_slice_shape.num_elements()) {
+      Tensor intersection_tensor;
+      status_ = GetPartialSliceValue(full_shape, stored_slice,
+                                     stored_slice_entry, intersection,
+                                     &intersection_tensor);
+      if (!status_.ok()) return status_;
+      status_ = CopySliceData(full_shape, intersection, intersection_tensor,
+                              slice_spec, val);
+      if (!status_.ok()) return status_;
+      continue;
+    }
+
     Tensor stored_slice_tensor(stored_slice_entry.dtype(), stored_slice_shape);
     status_ = GetValue(stored_slice_entry, &stored_slice_tensor);
     if (!status_.ok()) return status_;
 
     // Copies the intersection over.
-    const DataType common_dtype = full_tensor_entry.dtype();
-    switch (common_dtype) {
-#define HANDLE_COPY(T)                                                 \
-  case DataTypeToEnum<T>::value:                                       \
-    CHECK(CopyDataFromTensorSliceToTensorSlice(                        \
-        full_shape, stored_slice, slice_spec,                          \
-        stored_slice_tensor.flat<T>().data(), val->flat<T>().data())); \
-    break;
+    status_ = CopySliceData(full_shape, stored_slice, stored_slice_tensor,
+                            slice_spec, val);
+    if (!status_.ok()) return status_;
+  }
+  return OkStatus();
+}
 
-      HANDLE_COPY(float)
-      HANDLE_COPY(double)
-      HANDLE_COPY(int32)
-      HANDLE_COPY(uint8)
-      HANDLE_COPY(int16)
-      HANDLE_COPY(int8)
-      HANDLE_COPY(complex64)
-      HANDLE_COPY(complex128)
-      HANDLE_COPY(int64_t)
-      HANDLE_COPY(bool)
-      HANDLE_COPY(qint32)
-      HANDLE_COPY(quint8)
-      HANDLE_COPY(qint8)
-      HANDLE_COPY(bfloat16)
-      default:
-        return errors::InvalidArgument("Dtype ", DataTypeString(common_dtype),
-                                       " not supported.");
+Status BundleReader::GetPartialSliceValue(const TensorShape& full_shape,
+                                          const TensorSlice& stored_slice,
+                                          const BundleEntryProto& entry,
+                                          const TensorSlice& part,
+                                          Tensor* val) {
+  TensorShape stored_shape;
+  TF_RETURN_IF_ERROR(stored_slice.SliceTensorShape(full_shape, &stored_shape));
+  TensorShape part_shape;
+  TF_RETURN_IF_ERROR(part.SliceTensorShape(full_shape, &part_shape));
+  const int64_t element_size = DataTypeSize(entry.dtype());
+  if (entry.size() != stored_shape.num_elements() * element_size) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key(),
+                            "; stored size ", entry.size(), "; expected size ",
+                            stored_shape.num_elements() * element_size);
+  }
+  *val = Tensor(entry.dtype(), part_shape);
+  if (part_shape.num_elements() == 0) return OkStatus();
+
+  // The stored slice is laid out in row-major order, so `part` is made of runs
+  // spanning the innermost dimension that `part` does not fully cover and all
+  // the dimensions after it. The runs are contiguous in `val` as well.
+  const int rank = full_shape.dims();
+  int run_dim = rank - 1;
+  while (run_dim > 0 &&
+         part_shape.dim_size(run_dim) == stored_shape.dim_size(run_dim)) {
+    --run_dim;
+  }
+  gtl::InlinedVector<int64_t, 8> strides(rank, 1);
+  for (int d = rank - 2; d >= 0; --d) {
+    strides[d] = strides[d + 1] * stored_shape.dim_size(d + 1);
+  }
+  gtl::InlinedVector<int64_t, 8> part_start(rank);
+  for (int d = 0; d < rank; ++d) {
+    part_start[d] = (part.IsFullAt(d) ? 0 : part.start(d)) -
+                    (stored_slice.IsFullAt(d) ? 0 : stored_slice.start(d));
+  }
+  const int64_t run_bytes =
+      part_shape.dim_size(run_dim) * strides[run_dim] * element_size;
+  const int64_t num_runs =
+      part_shape.num_elements() / (part_shape.dim_size(run_dim) *
+                                   strides[run_dim]);
+
+  // Groups the runs into reads, merging runs that are close in the file.
+  struct Read {
+    int64_t offset;
+    int64_t size;
+    int64_t first_run;
+    int64_t num_runs;
+  };
+  std::vector<Read> reads;
+  std::vector<int64_t> run_offsets(num_runs);
+  gtl::InlinedVector<int64_t, 8> index(run_dim, 0);
+  for (int64_t r = 0; r < num_runs; ++r) {
+    int64_t offset = part_start[run_dim] * strides[run_dim];
+    for (int d = 0; d < run_dim; ++d) {
+      offset += (part_start[d] + index[d]) * strides[d];
     }
-#undef HANDLE_COPY
+    run_offsets[r] = entry.offset() + offset * element_size;
+    for (int d = run_dim - 1; d >= 0 && ++index[d] == part_shape.dim_size(d);
+         --d) {
+      index[d] = 0;
+    }
+
+    if (!reads.empty() &&
+        run_offsets[r] - (reads.back().offset + reads.back().size) <=
+            kMaxPartialReadGap) {
+      reads.back().size = run_offsets[r] + run_bytes - reads.back().offset;
+      ++reads.back().num_runs;
+    } else {
+      reads.push_back({run_offsets[r], run_bytes, r, 1});
+    }
+  }
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(NewDataFile(
+      env_, DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
+  char* backing_buffer = const_cast<char*>(val->tensor_data().data());
+  std::vector<Status> statuses(reads.size());
+  auto read_runs = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const Read& read = reads[i];
+      char* dest = backing_buffer + read.first_run * run_bytes;
+      std::unique_ptr<char[]> scratch;
+      if (read.num_runs > 1) {
+        scratch.reset(new char[read.size]);
+      }
+      char* buffer = read.num_runs > 1 ? scratch.get() : dest;
+      StringPiece sp;
+      Status s = file->Read(read.offset, read.size, &sp, buffer);
+      if (sp.size() != read.size) {
+        statuses[i] = s.ok() || errors::IsOutOfRange(s)
+                          ? errors::DataLoss("Truncated data file of ",
+                                             prefix_, " at ", read.offset)
+                          : s;
+        continue;
+      }
+      for (int64_t r = read.first_run; r < read.first_run + read.num_runs;
+           ++r) {
+        memmove(backing_buffer + r * run_bytes,
+                sp.data() + (run_offsets[r] - read.offset), run_bytes);
+      }
+    }
+  };
+  const int64_t part_bytes = part_shape.num_elements() * element_size;
+  if (reads.size() > 1 && part_bytes > kBufferSize) {
+    thread::ThreadPool reader_pool(
+        Env::Default(), "restore_partial_slice",
+        std::min<int64_t>(kMaxFileReadThreads, reads.size()));
+    reader_pool.ParallelFor(reads.size(), part_bytes / reads.size(),
+                            read_runs);
+  } else {
+    read_runs(0, reads.size());
+  }
+  for (const auto& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  if (need_to_swap_bytes_) {
+    TF_RETURN_IF_ERROR(ByteSwapTensor(val));
   }
   return OkStatus();
 }
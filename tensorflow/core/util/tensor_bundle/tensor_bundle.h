@@ -62,6 +62,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -95,6 +96,8 @@ class FileOutputBuffer;
 // History:
 // 0. Any tensor bundles produced before this field was added.
 // 1. Added this field (2016-09-14).
+// 2. Compressed tensors (BundleEntryProto::compression). Bundles written with
+//    compression enabled require consumers of version 2 or later.
 extern const int kTensorBundleMinProducer;
 extern const int kTensorBundleMinConsumer;
 extern const int kTensorBundleVersion;
@@ -114,8 +117,17 @@ class BundleWriter {
   struct Options {
     Options() {}
     // Alignment, in bytes, for tensor data.
-    // Must be >= 1. The default size of 1 densely packs tensors.
+    // Must be >= 1. The default size of 1 densely packs tensors. An alignment
+    // of the page size (e.g. 4096) lets BundleReader::LookupMapped() map every
+    // uncompressed tensor whose dtype can be memcpy'd.
     int data_alignment{1};
+    // If not NONE, compresses the bytes of the tensors whose dtype can be
+    // memcpy'd and that take at least `min_compressed_tensor_bytes`, in
+    // independent chunks of `compression_chunk_bytes` that readers decompress
+    // in parallel. Compressed tensors cannot be memory mapped.
+    BundleEntryProto::Compression compression{BundleEntryProto::NONE};
+    int64_t compression_chunk_bytes{1 << 20};
+    int64_t min_compressed_tensor_bytes{64 << 10};
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
@@ -246,6 +258,32 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like Lookup(), but allocates "val" itself and, for a tensor that is not
+  // partitioned and whose dtype can be memcpy'd, backs it by a read-only memory
+  // mapping of the data file if the file system supports it and the stored
+  // bytes are suitably aligned (see BundleWriter::Options::data_alignment).
+  // The tensor's data is then only read from the file when first touched.
+  // Otherwise, reads the tensor like Lookup().
+  //
+  // The stored crc32c checksum is not validated for mapped tensors, since that
+  // would read all of their bytes. Mapped tensors do not own their memory, so
+  // kernels that update a tensor in place copy it first. The mapping outlives
+  // this reader for as long as the tensor is alive.
+  // REQUIRES: status().ok()
+  Status LookupMapped(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
+  // Like Lookup(), but allocates "val" itself and, for a tensor that is not
+  // partitioned and whose dtype can be memcpy'd, returns a tensor shared with
+  // earlier LookupShared() calls in this process, from any bundle, that read
+  // the same dtype, shape and bytes. Identical weights of several loaded
+  // models are then held in memory once.
+  //
+  // Shared tensors must not be modified: while they are shared their buffers
+  // are referenced more than once, so kernels that update a tensor in place
+  // copy it first.
+  // REQUIRES: status().ok()
+  Status LookupShared(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -271,6 +309,15 @@ class BundleReader {
   Status LookupSlice(StringPiece full_tensor_key, const TensorSlice& slice_spec,
                      Tensor* val) TF_MUST_USE_RESULT;
 
+  // Sets whether LookupSlice() reads only the byte ranges of the stored slices
+  // that overlap "slice_spec", in parallel, instead of whole stored slices.
+  // This makes restoring into a different partitioning cheaper, but the
+  // checksums of partially read slices are not verified. Defaults to the value
+  // of the TF_PARTIAL_SLICE_RESTORE environment variable.
+  void set_read_partial_slices(bool read_partial_slices) {
+    read_partial_slices_ = read_partial_slices;
+  }
+
   // Seeks to the first position in the bundle whose key is no less than "key".
   // REQUIRES: status().ok()
   void Seek(StringPiece key) { return iter_->Seek(key); }
@@ -310,6 +357,14 @@ class BundleReader {
                        const TensorSlice& slice_spec,
                        Tensor* val) TF_MUST_USE_RESULT;
 
+  // Reads the part "part" of the stored slice "stored_slice" with metadata
+  // proto "entry" into a new tensor "val". Only reads the bytes of "part".
+  Status GetPartialSliceValue(const TensorShape& full_shape,
+                              const TensorSlice& stored_slice,
+                              const BundleEntryProto& entry,
+                              const TensorSlice& part,
+                              Tensor* val) TF_MUST_USE_RESULT;
+
   Env* env_;  // Not owned.
   const string prefix_;
 
@@ -320,6 +375,10 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // The memory mappings of the data files used by LookupMapped(), or nullptr
+  // for those the file system can't map. Populated on-demand.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -337,6 +396,8 @@ class BundleReader {
 
   bool enable_multi_threading_for_testing_ = false;
 
+  bool read_partial_slices_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(BundleReader);
 };
 
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap_tensor.h"
+#include "tensorflow/core/util/tensor_slice_util.h"
 
 namespace tensorflow {
 using ::testing::ElementsAre;
@@ -648,6 +649,45 @@ TEST(TensorBundleTest, PartitionedVariables) {
   }
 }
 
+TEST(TensorBundleTest, PartialSliceReads) {
+  const TensorShape kFullShape({6, 5, 40000});
+  Tensor full(DT_FLOAT, kFullShape);
+  test::FillFn<float>(&full, [](int offset) -> float { return offset; });
+  // Saves the tensor as two slices along the first dimension.
+  const TensorSlice slice1 = TensorSlice::ParseOrDie("0,4:-:-");
+  const TensorSlice slice2 = TensorSlice::ParseOrDie("4,2:-:-");
+  {
+    BundleWriter writer(Env::Default(), Prefix("foo"));
+    for (const TensorSlice& slice : {slice1, slice2}) {
+      Tensor part(DT_FLOAT, TensorShape({slice.length(0), 5, 40000}));
+      CHECK(CopyDataFromTensorSliceToTensorSlice(
+          kFullShape, TensorSlice(3), slice, full.flat<float>().data(),
+          part.flat<float>().data()));
+      TF_ASSERT_OK(writer.AddSlice("foo", kFullShape, slice, part));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader reader(Env::Default(), Prefix("foo"));
+  TF_ASSERT_OK(reader.status());
+  reader.set_read_partial_slices(true);
+  // Slices that cut both stored slices, with contiguous runs over one, two
+  // and three dimensions, close and far apart in the data file.
+  for (const char* spec : {"3,2:-:-", "1,4:1,3:-", "0,6:2,1:10,100",
+                           "2,3:-:0,1", "5,1:4,1:39999,1"}) {
+    const TensorSlice slice = TensorSlice::ParseOrDie(spec);
+    TensorShape shape;
+    TF_ASSERT_OK(slice.SliceTensorShape(kFullShape, &shape));
+    Tensor expected(DT_FLOAT, shape);
+    CHECK(CopyDataFromTensorSliceToTensorSlice(
+        kFullShape, TensorSlice(3), slice, full.flat<float>().data(),
+        expected.flat<float>().data()));
+    Tensor val(DT_FLOAT, shape);
+    TF_ASSERT_OK(reader.LookupSlice("foo", slice, &val));
+    test::ExpectTensorEqual<float>(val, expected);
+  }
+}
+
 TEST(TensorBundleTest, EquivalentSliceTest) {
   const TensorShape kFullShape({5, 10});
   const Tensor kExpected(Constant<float>(1., kFullShape));
@@ -1201,6 +1241,135 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST(TensorBundleTest, LookupMapped) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = Allocator::kAllocatorAlignment;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<int64_t>(1)));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<tstring>("2")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor mapped_float;
+  Tensor mapped_int;
+  Tensor read_string;
+  {
+    BundleReader reader(Env::Default(), Prefix("foo"));
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.LookupMapped("foo_000", &mapped_float));
+    TF_ASSERT_OK(reader.LookupMapped("foo_001", &mapped_int));
+    TF_ASSERT_OK(reader.LookupMapped("foo_002", &read_string));
+    EXPECT_TRUE(errors::IsNotFound(reader.LookupMapped("bar", &mapped_int)));
+  }
+  // The mapped tensors stay valid after the reader is gone, and are never
+  // forwarded for in-place updates.
+  test::ExpectTensorEqual<float>(mapped_float, Constant_2x3<float>(0));
+  test::ExpectTensorEqual<int64_t>(mapped_int, Constant_2x3<int64_t>(1));
+  test::ExpectTensorEqual<tstring>(read_string, Constant_2x3<tstring>("2"));
+  EXPECT_FALSE(mapped_float.RefCountIsOne());
+  EXPECT_FALSE(mapped_int.RefCountIsOne());
+  EXPECT_TRUE(read_string.RefCountIsOne());
+}
+
+TEST(TensorBundleTest, LookupMappedUnaligned) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("foo"));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<int8>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("foo"));
+  TF_ASSERT_OK(reader.status());
+  // "foo_001" is stored at offset 6, so it is read instead of mapped.
+  Tensor val;
+  TF_ASSERT_OK(reader.LookupMapped("foo_001", &val));
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(1));
+  EXPECT_TRUE(val.RefCountIsOne());
+}
+
+TEST(TensorBundleTest, LookupShared) {
+  for (const string& name : {"foo", "bar"}) {
+    BundleWriter writer(Env::Default(), Prefix(name));
+    TF_EXPECT_OK(writer.Add("weights", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("bias", Constant_2x3<float>(name == "foo")));
+    TF_EXPECT_OK(writer.Add("vocab", Constant_2x3<tstring>("v")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader foo_reader(Env::Default(), Prefix("foo"));
+  BundleReader bar_reader(Env::Default(), Prefix("bar"));
+  TF_ASSERT_OK(foo_reader.status());
+  TF_ASSERT_OK(bar_reader.status());
+
+  Tensor foo_weights, bar_weights, foo_bias, bar_bias, foo_vocab, bar_vocab;
+  TF_ASSERT_OK(foo_reader.LookupShared("weights", &foo_weights));
+  TF_ASSERT_OK(bar_reader.LookupShared("weights", &bar_weights));
+  TF_ASSERT_OK(foo_reader.LookupShared("bias", &foo_bias));
+  TF_ASSERT_OK(bar_reader.LookupShared("bias", &bar_bias));
+  TF_ASSERT_OK(foo_reader.LookupShared("vocab", &foo_vocab));
+  TF_ASSERT_OK(bar_reader.LookupShared("vocab", &bar_vocab));
+
+  // Identical tensors share one buffer, which is never forwarded for in-place
+  // updates.
+  test::ExpectTensorEqual<float>(bar_weights, Constant_2x3<float>(0));
+  EXPECT_TRUE(foo_weights.SharesBufferWith(bar_weights));
+  EXPECT_FALSE(foo_weights.RefCountIsOne());
+  test::ExpectTensorEqual<float>(foo_bias, Constant_2x3<float>(1));
+  test::ExpectTensorEqual<float>(bar_bias, Constant_2x3<float>(0));
+  EXPECT_FALSE(foo_bias.SharesBufferWith(bar_bias));
+  // Strings are not shared.
+  test::ExpectTensorEqual<tstring>(bar_vocab, Constant_2x3<tstring>("v"));
+  EXPECT_FALSE(foo_vocab.SharesBufferWith(bar_vocab));
+}
+
+TEST(TensorBundleTest, CompressedTensors) {
+  // Random bytes do not shrink, so their chunks are stored as is.
+  Tensor noise(DT_INT64, TensorShape({1000}));
+  std::mt19937_64 rng(42);
+  for (int i = 0; i < noise.NumElements(); ++i) {
+    noise.flat<int64_t>()(i) = rng();
+  }
+  {
+    BundleWriter::Options opts;
+    opts.compression = BundleEntryProto::SNAPPY;
+    opts.compression_chunk_bytes = 3000;
+    opts.min_compressed_tensor_bytes = 1000;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_100x100<float>(1)));
+    TF_EXPECT_OK(writer.Add("foo_001", noise));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<float>(2)));
+    TF_EXPECT_OK(writer.Add("foo_003", Constant_2x3<tstring>("3")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("foo"));
+  TF_ASSERT_OK(reader.status());
+  reader.Seek(kHeaderEntryKey);
+  ASSERT_TRUE(reader.Valid());
+  BundleHeaderProto header;
+  ASSERT_TRUE(ParseProtoUnlimited(&header, reader.value().data(),
+                                  reader.value().size()));
+  EXPECT_EQ(2, header.version().min_consumer());
+
+  reader.Seek("foo_000");
+  ASSERT_TRUE(reader.Valid());
+  BundleEntryProto entry;
+  ASSERT_TRUE(ParseProtoUnlimited(&entry, reader.value().data(),
+                                  reader.value().size()));
+  EXPECT_EQ(BundleEntryProto::SNAPPY, entry.compression());
+  EXPECT_EQ(14, entry.compressed_chunk_sizes_size());
+  EXPECT_LT(entry.size(), 100 * 100 * 4);
+
+  Expect<float>(&reader, "foo_000", Constant_100x100<float>(1));
+  Expect<int64_t>(&reader, "foo_001", noise);
+  Expect<float>(&reader, "foo_002", Constant_2x3<float>(2));
+  Expect<tstring>(&reader, "foo_003", Constant_2x3<tstring>("3"));
+  // Compressed tensors are read instead of mapped.
+  Tensor val;
+  TF_ASSERT_OK(reader.LookupMapped("foo_000", &val));
+  test::ExpectTensorEqual<float>(val, Constant_100x100<float>(1));
+  EXPECT_TRUE(val.RefCountIsOne());
+}
+
 static void BM_BundleAlignment(::testing::benchmark::State& state) {
   {
     const int alignment = state.range(0);
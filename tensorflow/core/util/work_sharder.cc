@@ -15,10 +15,42 @@ limitations under the License.
 
 #include "tensorflow/core/util/work_sharder.h"
 
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
+namespace {
+
+// Weight of the latest measurement in the moving average of the measured cost
+// per unit of a Shard() call site.
+constexpr double kMeasuredCostWeight = 0.25;
+
+// Returns the measured cost per unit of the call site "key", which is -1 until
+// a call has completed.
+std::atomic<int64_t>* GetMeasuredCost(absl::string_view key) {
+  static mutex* mu = new mutex;
+  static auto* costs =
+      new absl::flat_hash_map<std::string,
+                              std::unique_ptr<std::atomic<int64_t>>>;
+  mutex_lock l(*mu);
+  auto it = costs->find(key);
+  if (it == costs->end()) {
+    it = costs
+             ->emplace(std::string(key),
+                       std::make_unique<std::atomic<int64_t>>(-1))
+             .first;
+  }
+  return it->second.get();
+}
+
+}  // namespace
 
 /* ABSL_CONST_INIT */ thread_local int per_thread_max_parallelism = 1000000;
 
@@ -51,6 +83,41 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64_t total,
       max_parallelism);
 }
 
+void Shard(absl::string_view key, int max_parallelism,
+           thread::ThreadPool* workers, int64_t total, int64_t cost_per_unit,
+           std::function<void(int64_t, int64_t)> work) {
+  CHECK_GE(total, 0);
+  if (total == 0) {
+    return;
+  }
+  std::atomic<int64_t>* measured_cost = GetMeasuredCost(key);
+  const int64_t previous_cost = measured_cost->load(std::memory_order_relaxed);
+  if (previous_cost >= 0) {
+    cost_per_unit = previous_cost;
+  }
+
+  std::atomic<uint64> work_nanos(0);
+  Shard(max_parallelism, workers, total, cost_per_unit,
+        [&work, &work_nanos](int64_t start, int64_t limit) {
+          const uint64 start_nanos = EnvTime::NowNanos();
+          work(start, limit);
+          work_nanos.fetch_add(EnvTime::NowNanos() - start_nanos,
+                               std::memory_order_relaxed);
+        });
+
+  const double cost = static_cast<double>(work_nanos.load()) / total;
+  const double smoothed_cost =
+      previous_cost < 0
+          ? cost
+          : previous_cost + kMeasuredCostWeight * (cost - previous_cost);
+  measured_cost->store(static_cast<int64_t>(smoothed_cost + 0.5),
+                       std::memory_order_relaxed);
+}
+
+int64_t GetMeasuredShardCostPerUnit(absl::string_view key) {
+  return GetMeasuredCost(key)->load(std::memory_order_relaxed);
+}
+
 // DEPRECATED: Prefer threadpool->ParallelFor with SchedulingStrategy, which
 // allows you to specify the strategy for choosing shard sizes, including using
 // a fixed shard size.
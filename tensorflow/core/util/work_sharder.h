@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <functional>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -59,6 +60,21 @@ namespace tensorflow {
 void Shard(int max_parallelism, thread::ThreadPool* workers, int64_t total,
            int64_t cost_per_unit, std::function<void(int64_t, int64_t)> work);
 
+// Like Shard(), but measures the cost of the work instead of trusting
+// "cost_per_unit", which is only used until a first call with the same "key"
+// has completed. "key" identifies the call site, e.g. the kernel name. Each
+// call measures the nanoseconds its shards take per unit of work, and later
+// calls use an exponentially weighted moving average of these measurements,
+// so that cheap work is not over-sharded and expensive work is not
+// under-sharded when the cost estimate is off.
+void Shard(absl::string_view key, int max_parallelism,
+           thread::ThreadPool* workers, int64_t total, int64_t cost_per_unit,
+           std::function<void(int64_t, int64_t)> work);
+
+// Returns the measured cost per unit that Shard() uses for "key", or -1 if no
+// call with "key" has completed yet.
+int64_t GetMeasuredShardCostPerUnit(absl::string_view key);
+
 // Each thread has an associated option to express the desired maximum
 // parallelism. Its default is a very large quantity.
 //
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/util/work_sharder.h"
 
 #include <atomic>
+#include <string>
 #include <vector>
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/logging.h"
@@ -90,6 +91,24 @@ TEST(Shard, OverflowTest) {
   }
 }
 
+TEST(Shard, MeasuresCostPerUnit) {
+  thread::ThreadPool threads(Env::Default(), "test", 4);
+  const std::string key = "Shard.MeasuresCostPerUnit";
+  EXPECT_EQ(GetMeasuredShardCostPerUnit(key), -1);
+  for (int i = 0; i < 2; ++i) {
+    std::atomic<int64_t> num_elements(0);
+    // The work takes at least 100us per unit, although the caller claims it
+    // is cheap.
+    Shard(key, 4, &threads, 16, /*cost_per_unit=*/1,
+          [&num_elements](int64_t start, int64_t limit) {
+            Env::Default()->SleepForMicroseconds(100 * (limit - start));
+            num_elements += limit - start;
+          });
+    EXPECT_EQ(num_elements.load(), 16);
+    EXPECT_GE(GetMeasuredShardCostPerUnit(key), 100 * 1000);
+  }
+}
+
 void BM_Sharding(::testing::benchmark::State& state) {
   const int arg = state.range(0);
 
@@ -0,0 +1,191 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/dtensor/cc/pipeline_schedule.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace dtensor {
+namespace {
+
+// Returns the `index`-th forward or backward task of `stage` in the
+// interleaved schedule. Stages go through their chunks in groups of
+// `num_stages` microbatches, forward passes in the order of the chunks and
+// backward passes in the reverse order.
+PipelineTask GetInterleavedTask(PipelineTask::Type type, int index, int stage,
+                                int num_stages, int num_chunks_per_stage) {
+  const int group_size = num_stages * num_chunks_per_stage;
+  int local_chunk = (index % group_size) / num_stages;
+  if (type == PipelineTask::Type::kBackward) {
+    local_chunk = num_chunks_per_stage - 1 - local_chunk;
+  }
+  const int microbatch =
+      (index / group_size) * num_stages + index % num_stages;
+  return {type, microbatch, local_chunk * num_stages + stage};
+}
+
+}  // namespace
+
+std::string PipelineTask::ToString() const {
+  return absl::StrCat(type == Type::kForward ? "F" : "B", microbatch, "@",
+                      chunk);
+}
+
+StatusOr<PipelineSchedule> CreatePipelineSchedule(int num_stages,
+                                                  int num_microbatches,
+                                                  int num_chunks_per_stage) {
+  if (num_stages < 1 || num_microbatches < 1 || num_chunks_per_stage < 1) {
+    return errors::InvalidArgument(
+        "Pipeline schedules need at least one stage, microbatch and chunk per "
+        "stage, got ",
+        num_stages, ", ", num_microbatches, " and ", num_chunks_per_stage, ".");
+  }
+  if (num_chunks_per_stage > 1 && num_microbatches % num_stages != 0) {
+    return errors::InvalidArgument(
+        "Interleaved pipeline schedules need a number of microbatches that is "
+        "a multiple of the number of stages, got ",
+        num_microbatches, " microbatches for ", num_stages, " stages.");
+  }
+
+  const int num_tasks = num_microbatches * num_chunks_per_stage;
+  PipelineSchedule schedule(num_stages);
+  for (int stage = 0; stage < num_stages; ++stage) {
+    // The first stage starts the most forward passes before its first backward
+    // pass, as the last chunk needs to run before any backward pass can.
+    int num_warmup_tasks = num_stages - stage - 1;
+    if (num_chunks_per_stage > 1) {
+      num_warmup_tasks =
+          2 * num_warmup_tasks + (num_chunks_per_stage - 1) * num_stages;
+    }
+    num_warmup_tasks = std::min(num_warmup_tasks, num_tasks);
+
+    std::vector<PipelineTask>& tasks = schedule[stage];
+    tasks.reserve(2 * num_tasks);
+    int num_forwards = 0;
+    int num_backwards = 0;
+    auto add_task = [&](PipelineTask::Type type) {
+      int& index = type == PipelineTask::Type::kForward ? num_forwards
+                                                        : num_backwards;
+      tasks.push_back(GetInterleavedTask(type, index++, stage, num_stages,
+                                         num_chunks_per_stage));
+    };
+    while (num_forwards < num_warmup_tasks) {
+      add_task(PipelineTask::Type::kForward);
+    }
+    while (num_forwards < num_tasks) {
+      add_task(PipelineTask::Type::kForward);
+      add_task(PipelineTask::Type::kBackward);
+    }
+    while (num_backwards < num_tasks) {
+      add_task(PipelineTask::Type::kBackward);
+    }
+  }
+  return schedule;
+}
+
+StatusOr<double> SimulatePipelineSchedule(const PipelineSchedule& schedule,
+                                          int num_microbatches,
+                                          double forward_time,
+                                          double backward_time,
+                                          double transfer_time) {
+  const int num_stages = schedule.size();
+  if (num_stages == 0 || num_microbatches < 1) {
+    return errors::InvalidArgument("Empty pipeline schedule.");
+  }
+  const int num_tasks_per_stage = schedule[0].size();
+  if (num_tasks_per_stage % (2 * num_microbatches) != 0) {
+    return errors::InvalidArgument(
+        "Pipeline stages need to run a forward and a backward pass of every "
+        "microbatch through each of their chunks.");
+  }
+  const int num_chunks =
+      num_stages * num_tasks_per_stage / (2 * num_microbatches);
+
+  // Time at which each pass of each microbatch through each chunk ended, or -1
+  // if it didn't run yet.
+  std::vector<std::vector<double>> forward_end(
+      num_microbatches, std::vector<double>(num_chunks, -1));
+  std::vector<std::vector<double>> backward_end = forward_end;
+  std::vector<int> next_task(num_stages, 0);
+  std::vector<double> stage_end(num_stages, 0);
+
+  int num_remaining_tasks = num_stages * num_tasks_per_stage;
+  while (num_remaining_tasks > 0) {
+    bool progress = false;
+    for (int stage = 0; stage < num_stages; ++stage) {
+      if (schedule[stage].size() != schedule[0].size()) {
+        return errors::InvalidArgument(
+            "Pipeline stages run different numbers of tasks.");
+      }
+      while (next_task[stage] < num_tasks_per_stage) {
+        const PipelineTask& task = schedule[stage][next_task[stage]];
+        if (task.microbatch < 0 || task.microbatch >= num_microbatches ||
+            task.chunk < 0 || task.chunk >= num_chunks ||
+            task.chunk % num_stages != stage) {
+          return errors::InvalidArgument("Invalid pipeline task ",
+                                         task.ToString(), " on stage ", stage,
+                                         ".");
+        }
+        const bool is_forward = task.type == PipelineTask::Type::kForward;
+        std::vector<double>& ends = is_forward
+                                        ? forward_end[task.microbatch]
+                                        : backward_end[task.microbatch];
+        if (ends[task.chunk] >= 0) {
+          return errors::InvalidArgument("Pipeline task ", task.ToString(),
+                                         " runs more than once.");
+        }
+
+        // The input of the task, and the stage that produced it.
+        double input_end;
+        int input_chunk;
+        if (is_forward) {
+          input_chunk = task.chunk - 1;
+          input_end =
+              input_chunk < 0 ? 0 : forward_end[task.microbatch][input_chunk];
+        } else if (task.chunk == num_chunks - 1) {
+          input_chunk = task.chunk;
+          input_end = forward_end[task.microbatch][input_chunk];
+        } else {
+          input_chunk = task.chunk + 1;
+          input_end = backward_end[task.microbatch][input_chunk];
+        }
+        if (input_end < 0) break;
+        if (input_chunk >= 0 && input_chunk % num_stages != stage) {
+          input_end += transfer_time;
+        }
+
+        ends[task.chunk] = std::max(stage_end[stage], input_end) +
+                           (is_forward ? forward_time : backward_time);
+        stage_end[stage] = ends[task.chunk];
+        ++next_task[stage];
+        --num_remaining_tasks;
+        progress = true;
+      }
+    }
+    if (!progress) {
+      return errors::InvalidArgument("Pipeline schedule deadlocks.");
+    }
+  }
+  return *std::max_element(stage_end.begin(), stage_end.end());
+}
+
+}  // namespace dtensor
+}  // namespace tensorflow
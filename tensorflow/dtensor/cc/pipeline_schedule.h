@@ -0,0 +1,79 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_DTENSOR_CC_PIPELINE_SCHEDULE_H_
+#define TENSORFLOW_DTENSOR_CC_PIPELINE_SCHEDULE_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/dtensor/cc/dstatus.h"
+
+namespace tensorflow {
+namespace dtensor {
+
+// One step of a pipeline-parallel schedule: the forward or backward pass of a
+// microbatch through one chunk of the model.
+struct PipelineTask {
+  enum class Type { kForward, kBackward };
+
+  Type type;
+  int microbatch;
+  // The model is split into num_stages * num_chunks_per_stage consecutive
+  // chunks, and stage `s` holds chunks s, s + num_stages, s + 2 * num_stages...
+  int chunk;
+
+  bool operator==(const PipelineTask& other) const {
+    return type == other.type && microbatch == other.microbatch &&
+           chunk == other.chunk;
+  }
+
+  std::string ToString() const;
+};
+
+// The tasks each stage of a pipeline runs, in order.
+using PipelineSchedule = std::vector<std::vector<PipelineTask>>;
+
+// Returns the one-forward-one-backward (1F1B) schedule of `num_microbatches`
+// microbatches over `num_stages` stages, which meshes of the pipeline run
+// concurrently. After a warm-up of forward passes, each stage alternates
+// between forward and backward passes, so that it holds the activations of
+// at most num_stages microbatches at a time instead of all of them.
+//
+// With `num_chunks_per_stage` > 1, returns the interleaved 1F1B schedule,
+// where each stage holds several non-consecutive chunks of the model. This
+// divides the pipeline bubble by the number of chunks per stage, at the cost
+// of as many more transfers between stages. It requires the number of
+// microbatches to be a multiple of the number of stages.
+StatusOr<PipelineSchedule> CreatePipelineSchedule(int num_stages,
+                                                  int num_microbatches,
+                                                  int num_chunks_per_stage = 1);
+
+// Returns the time the stages take to run `schedule` when a forward and a
+// backward pass of a microbatch through one chunk take `forward_time` and
+// `backward_time`, and the output of a chunk reaches the next stage
+// `transfer_time` later. A task starts once the stage finished its previous
+// task and the inputs it depends on arrived. Returns an error if the schedule
+// misses tasks or deadlocks.
+StatusOr<double> SimulatePipelineSchedule(const PipelineSchedule& schedule,
+                                          int num_microbatches,
+                                          double forward_time,
+                                          double backward_time,
+                                          double transfer_time = 0);
+
+}  // namespace dtensor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_DTENSOR_CC_PIPELINE_SCHEDULE_H_
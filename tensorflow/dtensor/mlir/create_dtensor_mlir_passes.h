@@ -42,6 +42,9 @@ CreateDTensorUndoMergeConstAcrossMesh();
 std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
 CreateDTensorElideIdentityBeforeCopyToMesh();
 
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateDTensorRelayoutFusion();
+
 std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
 CreateDTensorConstantFolding();
 
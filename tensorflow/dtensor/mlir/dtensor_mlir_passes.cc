@@ -85,6 +85,11 @@ void CreateDTensorMLIRPass(const mlir::TF::StandardPipelineOptions &options,
   // dynamic shapes, shape information may still be missing.
   pm->addPass(mlir::TF::CreateTFShapeInferencePass());
 
+  // Only the last Relayout of a chain of Relayouts determines the layout of
+  // its output. Skip the intermediate ones before they are expanded into
+  // collectives.
+  pm->addNestedPass<mlir::func::FuncOp>(CreateDTensorRelayoutFusion());
+
   // If V2 layout propagation algorithm, layouts are expressed as DTensorLayout
   // op and Canonicalize and Inliner passes will not lose layout information.
   pm->addNestedPass<mlir::func::FuncOp>(CreateDTensorPropagateDefaultLayout());
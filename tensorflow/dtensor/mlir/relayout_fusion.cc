@@ -0,0 +1,76 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/Operation.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "tensorflow/dtensor/cc/tensor_layout.h"
+#include "tensorflow/dtensor/mlir/ir/tf_dtensor.h"
+
+namespace tensorflow {
+namespace dtensor {
+
+namespace {
+#define GEN_PASS_DEF_DTENSORRELAYOUTFUSION
+#include "tensorflow/dtensor/mlir/dtensor_passes.h.inc"
+
+// Returns whether the output layout of `relayout` is fully specified, i.e.
+// doesn't keep the layout of the input on any dimension.
+bool HasFixedLayout(mlir::TF::RelayoutOp relayout) {
+  StatusOr<Layout> layout = Layout::FromString(relayout.getLayout().str());
+  if (!layout.ok()) return false;
+  for (const std::string& sharding_spec : layout->sharding_spec_strs())
+    if (sharding_spec == Layout::kMatch) return false;
+  return true;
+}
+
+// MLIR pass that merges chains of Relayout ops. A Relayout to a fully
+// specified layout produces the same tensor whatever the layout of its input,
+// so it can read the input of a producing Relayout directly. The producer is
+// removed once it has no other users, which saves the collectives its
+// expansion would emit.
+struct DTensorRelayoutFusion
+    : public impl::DTensorRelayoutFusionBase<DTensorRelayoutFusion> {
+  void runOnOperation() override {
+    // Producers come before their consumers, so a Relayout erased while
+    // visiting a consumer has already been visited.
+    llvm::SmallVector<mlir::TF::RelayoutOp, 4> relayouts;
+    getOperation().walk(
+        [&](mlir::TF::RelayoutOp relayout) { relayouts.push_back(relayout); });
+
+    for (mlir::TF::RelayoutOp relayout : relayouts) {
+      if (!HasFixedLayout(relayout)) continue;
+      while (auto producer = relayout.getInput()
+                                 .getDefiningOp<mlir::TF::RelayoutOp>()) {
+        relayout.getInputMutable().assign(producer.getInput());
+        if (producer->use_empty()) producer->erase();
+      }
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateDTensorRelayoutFusion() {
+  return std::make_unique<DTensorRelayoutFusion>();
+}
+
+}  // namespace dtensor
+}  // namespace tensorflow
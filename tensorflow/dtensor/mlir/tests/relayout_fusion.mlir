@@ -0,0 +1,39 @@
+// RUN: dtensor-opt %s -split-input-file -dtensor-relayout-fusion | FileCheck %s
+
+// Check that a chain of relayouts is merged into the last one.
+// CHECK-LABEL: func @check_relayout_chain
+func.func @check_relayout_chain(%arg0: tensor<4x4xf32>) -> tensor<4x4xf32> {
+    // CHECK-NEXT: %[[RELAYOUT:.*]] = "tf.Relayout"(%arg0) {layout = "sharding_specs:unsharded,x,
+    // CHECK-NEXT: return %[[RELAYOUT]]
+    %0 = "tf.Relayout"(%arg0) {layout = "sharding_specs:x,unsharded, mesh:|x=2|0,1|0,1|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1"} : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    %1 = "tf.Relayout"(%0) {layout = "sharding_specs:unsharded,unsharded, mesh:|x=2|0,1|0,1|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1"} : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    %2 = "tf.Relayout"(%1) {layout = "sharding_specs:unsharded,x, mesh:|x=2|0,1|0,1|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1"} : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    func.return %2 : tensor<4x4xf32>
+}
+
+// -----
+
+// Check that relayouts with other users are kept.
+// CHECK-LABEL: func @check_relayout_with_other_users
+func.func @check_relayout_with_other_users(%arg0: tensor<4x4xf32>) -> (tensor<4x4xf32>, tensor<4x4xf32>) {
+    // CHECK-NEXT: %[[RELAYOUT_0:.*]] = "tf.Relayout"(%arg0) {layout = "sharding_specs:x,unsharded,
+    // CHECK-NEXT: %[[RELAYOUT_1:.*]] = "tf.Relayout"(%arg0) {layout = "sharding_specs:unsharded,x,
+    // CHECK-NEXT: return %[[RELAYOUT_0]], %[[RELAYOUT_1]]
+    %0 = "tf.Relayout"(%arg0) {layout = "sharding_specs:x,unsharded, mesh:|x=2|0,1|0,1|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1"} : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    %1 = "tf.Relayout"(%0) {layout = "sharding_specs:unsharded,x, mesh:|x=2|0,1|0,1|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1"} : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    func.return %0, %1 : tensor<4x4xf32>, tensor<4x4xf32>
+}
+
+// -----
+
+// Check that a relayout keeping the layout of its input on some dimension
+// isn't merged.
+// CHECK-LABEL: func @check_relayout_with_match
+func.func @check_relayout_with_match(%arg0: tensor<4x4xf32>) -> tensor<4x4xf32> {
+    // CHECK-NEXT: %[[RELAYOUT_0:.*]] = "tf.Relayout"(%arg0)
+    // CHECK-NEXT: %[[RELAYOUT_1:.*]] = "tf.Relayout"(%[[RELAYOUT_0]])
+    // CHECK-NEXT: return %[[RELAYOUT_1]]
+    %0 = "tf.Relayout"(%arg0) {layout = "sharding_specs:x,unsharded, mesh:|x=2|0,1|0,1|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1"} : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    %1 = "tf.Relayout"(%0) {layout = "sharding_specs:match,unsharded, mesh:|x=2|0,1|0,1|/job:localhost/replica:0/task:0/device:CPU:0,/job:localhost/replica:0/task:0/device:CPU:1"} : (tensor<4x4xf32>) -> tensor<4x4xf32>
+    func.return %1 : tensor<4x4xf32>
+}
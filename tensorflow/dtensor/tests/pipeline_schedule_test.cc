@@ -0,0 +1,114 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/dtensor/cc/pipeline_schedule.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace dtensor {
+namespace {
+
+using ::testing::ElementsAre;
+
+std::vector<std::string> TaskNames(const std::vector<PipelineTask>& tasks) {
+  std::vector<std::string> names;
+  for (const PipelineTask& task : tasks) names.push_back(task.ToString());
+  return names;
+}
+
+TEST(PipelineScheduleTest, OneForwardOneBackward) {
+  PipelineSchedule schedule = CreatePipelineSchedule(3, 4).value();
+  ASSERT_EQ(schedule.size(), 3);
+  EXPECT_THAT(TaskNames(schedule[0]),
+              ElementsAre("F0@0", "F1@0", "F2@0", "B0@0", "F3@0", "B1@0",
+                          "B2@0", "B3@0"));
+  EXPECT_THAT(TaskNames(schedule[1]),
+              ElementsAre("F0@1", "F1@1", "B0@1", "F2@1", "B1@1", "F3@1",
+                          "B2@1", "B3@1"));
+  EXPECT_THAT(TaskNames(schedule[2]),
+              ElementsAre("F0@2", "B0@2", "F1@2", "B1@2", "F2@2", "B2@2",
+                          "F3@2", "B3@2"));
+}
+
+TEST(PipelineScheduleTest, OneForwardOneBackwardBubble) {
+  PipelineSchedule schedule = CreatePipelineSchedule(4, 8).value();
+  // The pipeline takes num_stages - 1 steps to fill and drain.
+  EXPECT_DOUBLE_EQ(SimulatePipelineSchedule(schedule, 8, 1, 2).value(),
+                   (8 + 4 - 1) * 3);
+}
+
+TEST(PipelineScheduleTest, FewerMicrobatchesThanStages) {
+  PipelineSchedule schedule = CreatePipelineSchedule(4, 2).value();
+  EXPECT_THAT(TaskNames(schedule[0]),
+              ElementsAre("F0@0", "F1@0", "B0@0", "B1@0"));
+  EXPECT_DOUBLE_EQ(SimulatePipelineSchedule(schedule, 2, 1, 2).value(),
+                   (2 + 4 - 1) * 3);
+}
+
+TEST(PipelineScheduleTest, Interleaved) {
+  PipelineSchedule schedule = CreatePipelineSchedule(2, 4, 2).value();
+  ASSERT_EQ(schedule.size(), 2);
+  EXPECT_THAT(TaskNames(schedule[0]),
+              ElementsAre("F0@0", "F1@0", "F0@2", "F1@2", "F2@0", "B0@2",
+                          "F3@0", "B1@2", "F2@2", "B0@0", "F3@2", "B1@0",
+                          "B2@2", "B3@2", "B2@0", "B3@0"));
+  EXPECT_THAT(TaskNames(schedule[1]),
+              ElementsAre("F0@1", "F1@1", "F0@3", "B0@3", "F1@3", "B1@3",
+                          "F2@1", "B0@1", "F3@1", "B1@1", "F2@3", "B2@3",
+                          "F3@3", "B3@3", "B2@1", "B3@1"));
+}
+
+TEST(PipelineScheduleTest, InterleavingShrinksBubble) {
+  // Each stage holds half as much of the model with two chunks per stage.
+  const double one_chunk_time =
+      SimulatePipelineSchedule(CreatePipelineSchedule(4, 8).value(), 8, 2, 4)
+          .value();
+  const double two_chunks_time =
+      SimulatePipelineSchedule(CreatePipelineSchedule(4, 8, 2).value(), 8, 1,
+                               2)
+          .value();
+  EXPECT_DOUBLE_EQ(one_chunk_time, (8 + 4 - 1) * 6);
+  EXPECT_LT(two_chunks_time, one_chunk_time);
+}
+
+TEST(PipelineScheduleTest, TransferTime) {
+  PipelineSchedule schedule = CreatePipelineSchedule(2, 1).value();
+  // Activations go to the second stage and gradients back to the first.
+  EXPECT_DOUBLE_EQ(SimulatePipelineSchedule(schedule, 1, 1, 2, 5).value(),
+                   1 + 5 + 1 + 2 + 5 + 2);
+}
+
+TEST(PipelineScheduleTest, InvalidArguments) {
+  EXPECT_FALSE(CreatePipelineSchedule(0, 4).ok());
+  EXPECT_FALSE(CreatePipelineSchedule(2, 0).ok());
+  EXPECT_FALSE(CreatePipelineSchedule(2, 3, 2).ok());
+}
+
+TEST(PipelineScheduleTest, DetectsDeadlocks) {
+  PipelineSchedule schedule = CreatePipelineSchedule(2, 2).value();
+  // The first stage can't run the backward pass of a microbatch before its
+  // forward pass.
+  std::swap(schedule[0][0], schedule[0][2]);
+  EXPECT_FALSE(SimulatePipelineSchedule(schedule, 2, 1, 2).ok());
+}
+
+}  // namespace
+}  // namespace dtensor
+}  // namespace tensorflow
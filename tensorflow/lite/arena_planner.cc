@@ -18,8 +18,11 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -34,6 +37,28 @@ namespace {
 constexpr int32_t kLastActiveNodeUndefined =
     std::numeric_limits<int32_t>::max();
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
+// Number of plans ArenaPlanner keeps for reuse.
+constexpr size_t kPlanCacheSize = 8;
+// Number of entries per tensor in the keys of cached plans.
+constexpr size_t kPlanKeyEntriesPerTensor = 7;
+// Size of an ArenaAllocWithUsageInterval serialized by SerializePlans.
+constexpr size_t kSerializedAllocSize =
+    2 * sizeof(uint64_t) + 3 * sizeof(int32_t);
+
+template <typename T>
+void AppendValue(T value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Reads a `T` from `*data` and advances it. Returns false if fewer bytes than
+// that are left before `end`.
+template <typename T>
+bool ReadValue(const char** data, const char* end, T* value) {
+  if (static_cast<size_t>(end - *data) < sizeof(T)) return false;
+  std::memcpy(value, *data, sizeof(T));
+  *data += sizeof(T);
+  return true;
+}
 
 bool ShareFirstInputWithFirstOutputForNode(const TfLiteRegistration& node_reg) {
   // TODO (b/254230751): add support for more ops which support forwarding.
@@ -363,6 +388,19 @@ void ArenaPlanner::GetAllocInfo(size_t* arena_size,
   *arena_persist_size = persistent_arena_.GetBufferSize();
 }
 
+void ArenaPlanner::GetAllocations(
+    std::vector<MemoryPlannerAllocation>* allocations) const {
+  allocations->clear();
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  for (const ArenaAllocWithUsageInterval& alloc : allocs_) {
+    if (alloc.size == 0) continue;
+    allocations->push_back(
+        {alloc.tensor,
+         tensors[alloc.tensor].allocation_type == kTfLiteArenaRwPersistent,
+         alloc.offset, alloc.size, alloc.first_node, alloc.last_node});
+  }
+}
+
 TfLiteStatus ArenaPlanner::Commit(bool* reallocated) {
   bool arena_reallocated, persistent_arena_reallocated;
   TF_LITE_ENSURE_STATUS(arena_.Commit(context_, &arena_reallocated));
@@ -443,6 +481,10 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     last_active_node_ = last_node;
     return kTfLiteOk;
   }
+  // Only plans made from scratch are cached: their offsets depend on nothing
+  // but the tensors being allocated.
+  const bool cacheable =
+      first_node == 0 && last_active_node_ == kLastActiveNodeUndefined;
   if (first_node < last_active_node_) {
     arena_.ResetAllocs();
     last_active_node_ = first_node;
@@ -451,7 +493,27 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     // exection faster.
     arena_.PurgeActiveAllocs(first_node);
   }
+
+  std::vector<int64_t> plan_key;
+  const CachedPlan* cached_plan = nullptr;
+  if (cacheable) {
+    plan_key = PlanCacheKey(*tensors_allocated);
+    for (auto it = plan_cache_.begin(); it != plan_cache_.end(); ++it) {
+      if (it->key == plan_key) {
+        plan_cache_.splice(plan_cache_.begin(), plan_cache_, it);
+        cached_plan = &plan_cache_.front();
+        break;
+      }
+    }
+  }
+  if (cached_plan != nullptr) {
+    for (const ArenaAllocWithUsageInterval& alloc : cached_plan->allocs) {
+      allocs_[alloc.tensor] = alloc;
+    }
+    arena_.RestoreAllocs(cached_plan->allocs, cached_plan->high_water_mark);
+  }
   CreateTensorAllocationVector(tensors_allocated);
+  std::vector<ArenaAllocWithUsageInterval> new_plan_allocs;
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : *tensors_allocated) {
     TfLiteTensor& tensor = tensors[tensor_index];
@@ -472,11 +534,14 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
         continue;
       }
     }
-    if (tensor.allocation_type == kTfLiteArenaRw) {
+    if (tensor.allocation_type == kTfLiteArenaRw && cached_plan == nullptr) {
       TF_LITE_ENSURE_STATUS(
           arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
                           tensor_index, alloc_node_[tensor_index],
                           dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      if (cacheable) {
+        new_plan_allocs.push_back(allocs_[tensor_index]);
+      }
     }
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     // Only allocate ArenaRwPersistent tensors which own their buffer.
@@ -491,10 +556,166 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
   }
+  if (cacheable && cached_plan == nullptr) {
+    CachedPlan plan;
+    plan.key = std::move(plan_key);
+    plan.allocs = std::move(new_plan_allocs);
+    plan.high_water_mark = arena_.high_water_mark();
+    plan_cache_.push_front(std::move(plan));
+    if (plan_cache_.size() > kPlanCacheSize) {
+      plan_cache_.pop_back();
+    }
+  }
   last_active_node_ = last_node;
   return kTfLiteOk;
 }
 
+std::vector<int64_t> ArenaPlanner::PlanCacheKey(std::vector<int32_t> tensors) {
+  std::sort(tensors.begin(), tensors.end());
+  const TfLiteTensor* graph_tensors = graph_info_->tensors();
+  std::vector<int64_t> key;
+  key.reserve(tensors.size() * kPlanKeyEntriesPerTensor);
+  for (int32_t tensor_index : tensors) {
+    const int32_t root_tensor_index = FindSharedTensor(tensor_index);
+    key.push_back(tensor_index);
+    key.push_back(graph_tensors[tensor_index].bytes);
+    key.push_back(graph_tensors[tensor_index].allocation_type);
+    key.push_back(alloc_node_[tensor_index]);
+    key.push_back(dealloc_node_[tensor_index]);
+    key.push_back(root_tensor_index);
+    key.push_back(graph_tensors[root_tensor_index].allocation_type);
+  }
+  return key;
+}
+
+bool ArenaPlanner::IsValidPlan(const CachedPlan& plan) const {
+  if (plan.key.size() % kPlanKeyEntriesPerTensor != 0) return false;
+  // The key entries of the tensors CalculateAllocations places in `arena_`,
+  // which are those not sharing the buffer of a tensor of the arenas.
+  std::unordered_map<int64_t, const int64_t*> arena_tensors;
+  for (size_t i = 0; i < plan.key.size(); i += kPlanKeyEntriesPerTensor) {
+    const int64_t* entry = &plan.key[i];
+    const int64_t tensor_index = entry[0];
+    if (tensor_index < 0 ||
+        tensor_index >= static_cast<int64_t>(graph_info_->num_tensors())) {
+      return false;
+    }
+    const bool owns_buffer = entry[5] == tensor_index ||
+                             (entry[6] != kTfLiteArenaRw &&
+                              entry[6] != kTfLiteArenaRwPersistent);
+    if (entry[2] == kTfLiteArenaRw && owns_buffer) {
+      arena_tensors.emplace(tensor_index, entry);
+    }
+  }
+  if (plan.allocs.size() != arena_tensors.size()) return false;
+
+  std::vector<ArenaAllocWithUsageInterval> allocs = plan.allocs;
+  std::sort(allocs.begin(), allocs.end());
+  for (const ArenaAllocWithUsageInterval& alloc : allocs) {
+    auto it = arena_tensors.find(alloc.tensor);
+    if (it == arena_tensors.end()) return false;
+    const int64_t* entry = it->second;
+    if (alloc.size != static_cast<size_t>(entry[1]) ||
+        alloc.first_node != entry[3] || alloc.last_node != entry[4] ||
+        alloc.offset % tensor_alignment_ != 0 ||
+        alloc.offset > plan.high_water_mark ||
+        alloc.size > plan.high_water_mark - alloc.offset) {
+      return false;
+    }
+    // Every tensor is placed once.
+    arena_tensors.erase(it);
+  }
+  for (size_t i = 0; i < allocs.size(); ++i) {
+    const size_t end = allocs[i].offset + allocs[i].size;
+    // Buffers overlapping in memory must not be live at the same time.
+    for (size_t j = i + 1; j < allocs.size() && allocs[j].offset < end; ++j) {
+      if (allocs[j].size != 0 && allocs[i].first_node <= allocs[j].last_node &&
+          allocs[j].first_node <= allocs[i].last_node) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void ArenaPlanner::SerializePlans(std::string* plans) const {
+  AppendValue<uint32_t>(plan_cache_.size(), plans);
+  for (const CachedPlan& plan : plan_cache_) {
+    AppendValue<uint64_t>(plan.key.size(), plans);
+    for (int64_t entry : plan.key) AppendValue<int64_t>(entry, plans);
+    AppendValue<uint64_t>(plan.high_water_mark, plans);
+    AppendValue<uint64_t>(plan.allocs.size(), plans);
+    for (const ArenaAllocWithUsageInterval& alloc : plan.allocs) {
+      AppendValue<uint64_t>(alloc.offset, plans);
+      AppendValue<uint64_t>(alloc.size, plans);
+      AppendValue<int32_t>(alloc.tensor, plans);
+      AppendValue<int32_t>(alloc.first_node, plans);
+      AppendValue<int32_t>(alloc.last_node, plans);
+    }
+  }
+}
+
+TfLiteStatus ArenaPlanner::RestorePlans(const std::string& plans) {
+  const char* data = plans.data();
+  const char* end = data + plans.size();
+  uint32_t num_plans = 0;
+  if (!ReadValue(&data, end, &num_plans) || num_plans > kPlanCacheSize) {
+    return kTfLiteError;
+  }
+  std::vector<CachedPlan> restored_plans;
+  for (uint32_t i = 0; i < num_plans; ++i) {
+    CachedPlan plan;
+    uint64_t key_size = 0;
+    if (!ReadValue(&data, end, &key_size) ||
+        key_size > (end - data) / sizeof(int64_t)) {
+      return kTfLiteError;
+    }
+    plan.key.resize(key_size);
+    for (int64_t& entry : plan.key) ReadValue(&data, end, &entry);
+
+    uint64_t high_water_mark = 0;
+    uint64_t num_allocs = 0;
+    if (!ReadValue(&data, end, &high_water_mark) ||
+        high_water_mark > std::numeric_limits<size_t>::max() ||
+        !ReadValue(&data, end, &num_allocs) ||
+        num_allocs > (end - data) / kSerializedAllocSize) {
+      return kTfLiteError;
+    }
+    plan.high_water_mark = high_water_mark;
+    plan.allocs.resize(num_allocs);
+    for (ArenaAllocWithUsageInterval& alloc : plan.allocs) {
+      uint64_t offset = 0;
+      uint64_t size = 0;
+      ReadValue(&data, end, &offset);
+      ReadValue(&data, end, &size);
+      ReadValue(&data, end, &alloc.tensor);
+      ReadValue(&data, end, &alloc.first_node);
+      ReadValue(&data, end, &alloc.last_node);
+      // Bounded by the high water mark, so that they fit in a size_t.
+      if (offset > high_water_mark || size > high_water_mark) {
+        return kTfLiteError;
+      }
+      alloc.offset = offset;
+      alloc.size = size;
+    }
+    // Plans made for other graphs or tensor alignments can't be trusted.
+    if (IsValidPlan(plan)) restored_plans.push_back(std::move(plan));
+  }
+  if (data != end) return kTfLiteError;
+
+  // Plans computed by this planner are more recent, so they stay first.
+  for (CachedPlan& plan : restored_plans) {
+    if (plan_cache_.size() >= kPlanCacheSize) break;
+    if (std::none_of(plan_cache_.begin(), plan_cache_.end(),
+                     [&](const CachedPlan& cached_plan) {
+                       return cached_plan.key == plan.key;
+                     })) {
+      plan_cache_.push_back(std::move(plan));
+    }
+  }
+  return kTfLiteOk;
+}
+
 bool AreTensorsAllocatedInSameArena(int32_t root_tensor_index,
                                     int32_t tensor_index,
                                     const TfLiteTensor* tensors) {
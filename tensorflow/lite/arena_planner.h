@@ -16,7 +16,9 @@ limitations under the License.
 #define TENSORFLOW_LITE_ARENA_PLANNER_H_
 
 #include <cstdint>
+#include <list>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -68,6 +70,10 @@ class ArenaPlanner : public MemoryPlanner {
   void DumpDebugInfo(const std::vector<int>& execution_plan) const override;
   void GetAllocInfo(size_t* arena_size,
                     size_t* arena_persist_size) const override;
+  void GetAllocations(
+      std::vector<MemoryPlannerAllocation>* allocations) const override;
+  void SerializePlans(std::string* plans) const override;
+  TfLiteStatus RestorePlans(const std::string& plans) override;
 
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
@@ -112,6 +118,24 @@ class ArenaPlanner : public MemoryPlanner {
   // Return the index of the tensor owing `tensor_index's` buffer.
   int FindSharedTensor(int tensor_index);
 
+  // Returns everything that determines the offsets CalculateAllocations
+  // assigns to `tensors` when planning from scratch: their sizes, allocation
+  // types, usage intervals and buffer sharing.
+  std::vector<int64_t> PlanCacheKey(std::vector<int32_t> tensors);
+
+  // Offsets assigned to the kTfLiteArenaRw tensors by a planning pass from
+  // scratch, and the size of `arena_` they need.
+  struct CachedPlan {
+    std::vector<int64_t> key;
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    size_t high_water_mark = 0;
+  };
+
+  // Returns whether `plan` places exactly the tensors its key says are
+  // allocated in `arena_`, aligned, within its high water mark and without
+  // overlapping tensors that are live at the same time.
+  bool IsValidPlan(const CachedPlan& plan) const;
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -153,6 +177,12 @@ class ArenaPlanner : public MemoryPlanner {
   // data with another tensor.
   // NOLINTNEXTLINE - absl::flat_hash_map increases binary size by 106kB.
   std::unordered_map<int32_t, int32_t> actual_tensor_id_;
+
+  // Plans for the most recently seen tensor sizes, most recent first. Models
+  // whose inputs alternate between a few shapes reuse the offsets computed for
+  // each shape instead of replanning on every `AllocateTensors`. The arena
+  // buffer only ever grows, so it ends up sized for the largest of them.
+  std::list<CachedPlan> plan_cache_;
 };
 
 }  // namespace tflite
@@ -18,9 +18,11 @@ limitations under the License.
 #include <cstdarg>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <initializer_list>
 #include <memory>
 #include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -366,6 +368,125 @@ TEST_F(ArenaPlannerTest, AllocsCorrectlyReset) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, RepeatedSizesReuseOffsets) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  std::vector<std::ptrdiff_t> offsets;
+  std::vector<size_t> bytes;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    offsets.push_back(GetOffset(i));
+    bytes.push_back(tensors[i].bytes);
+  }
+
+  // Alternate between a larger and the original set of sizes, as a model
+  // whose inputs are resized back and forth would. Every pass must lay out the
+  // tensors exactly like the first pass with the same sizes did.
+  for (int pass = 0; pass < 3; ++pass) {
+    ResetAllocations();
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      tensors[i].bytes = bytes[i] * 10;
+    }
+    Execute(0, graph.nodes().size() - 1);
+    EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+    EXPECT_EQ(GetOffset(3), GetOffsetAfter(4));
+    EXPECT_EQ(GetOffset(2), GetOffsetAfter(4));
+
+    ResetAllocations();
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      tensors[i].bytes = bytes[i];
+    }
+    Execute(0, graph.nodes().size() - 1);
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      EXPECT_EQ(GetOffset(i), offsets[i]) << "tensor " << i;
+    }
+  }
+}
+
+
+TEST_F(ArenaPlannerTest, RestoredPlansReuseOffsets) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> offsets;
+  for (size_t i = 0; i < graph.tensors()->size(); ++i) {
+    offsets.push_back(GetOffset(i));
+  }
+  std::string plans;
+  planner_->SerializePlans(&plans);
+
+  // A new planner for the same graph keeps the restored plan and lays out the
+  // tensors the same way.
+  SetGraph(&graph);
+  ASSERT_EQ(planner_->RestorePlans(plans), kTfLiteOk);
+  std::string restored_plans;
+  planner_->SerializePlans(&restored_plans);
+  EXPECT_EQ(restored_plans, plans);
+  Execute(0, graph.nodes().size() - 1);
+  for (size_t i = 0; i < graph.tensors()->size(); ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]) << "tensor " << i;
+  }
+}
+
+TEST_F(ArenaPlannerTest, InvalidRestoredPlansAreDropped) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},  // First op
+                      {{2, 0}, {3}, {}}   // Second op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  std::string plans;
+  planner_->SerializePlans(&plans);
+
+  SetGraph(&graph);
+  // Truncated plans are malformed.
+  EXPECT_EQ(planner_->RestorePlans(plans.substr(0, plans.size() - 1)),
+            kTfLiteError);
+
+  // Plans placing every tensor at the same offset are well formed, but would
+  // overlap tensors live at the same time.
+  std::string overlapping_plans = plans;
+  const size_t alloc_size = 2 * sizeof(uint64_t) + 3 * sizeof(int32_t);
+  const size_t num_allocs_offset =
+      overlapping_plans.size() - graph.tensors()->size() * alloc_size -
+      sizeof(uint64_t);
+  uint64_t num_allocs = 0;
+  std::memcpy(&num_allocs, &overlapping_plans[num_allocs_offset],
+              sizeof(num_allocs));
+  ASSERT_EQ(num_allocs, graph.tensors()->size());
+  for (uint64_t i = 0; i < num_allocs; ++i) {
+    const uint64_t offset = 0;
+    std::memcpy(&overlapping_plans[num_allocs_offset + sizeof(uint64_t) +
+                                   i * alloc_size],
+                &offset, sizeof(offset));
+  }
+  ASSERT_EQ(planner_->RestorePlans(overlapping_plans), kTfLiteOk);
+  std::string restored_plans;
+  planner_->SerializePlans(&restored_plans);
+  const uint32_t no_plans = 0;
+  EXPECT_EQ(restored_plans,
+            std::string(reinterpret_cast<const char*>(&no_plans),
+                        sizeof(no_plans)));
+}
 TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   TestGraph graph({0, 1},
                   {
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_CORE_ASYNC_ASYNC_SUBGRAPH_H_
 
 #include <atomic>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/lite/core/c/c_api_types.h"
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/core/async/async_kernel_internal.h"
 #include "tensorflow/lite/core/async/common.h"
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
 #include "tensorflow/lite/core/async/interop/c/types.h"
 
 namespace tflite {
@@ -32,7 +34,8 @@ namespace async {
 class AsyncSubgraphTestPeer;
 
 // AsyncSubgraph class manages to dispatch I/O information and
-// schedule executions to underlying delegate kernels.
+// schedule executions to underlying delegate kernels. Subgraphs that are not
+// fully delegated by 1 backend are executed by a `CpuAsyncKernel`.
 // TODO(b/191883048): Currently we require either `AllocateTensors` or
 // `EnsureTensorAllocation` called to ensure the backend kernels are prepared.
 // However, we don't need to allocate the CPU memory for input / output tensors.
@@ -166,6 +169,9 @@ class AsyncSubgraph {
   // Not owned.
   mutable TfLiteAsyncKernel* async_kernel_ = nullptr;
   TfLiteOpaqueNode* opaque_node_ = nullptr;
+
+  // Runs the subgraph when it's not fully delegated.
+  std::unique_ptr<CpuAsyncKernel> cpu_kernel_;
 };
 
 }  // namespace async
@@ -0,0 +1,364 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/async/interop/attribute_keys.h"
+#include "tensorflow/lite/core/async/interop/c/attribute_map.h"
+#include "tensorflow/lite/core/async/interop/c/constants.h"
+#include "tensorflow/lite/core/async/interop/c/types.h"
+#include "tensorflow/lite/core/async/task_internal.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace async {
+
+namespace {
+
+constexpr uint32_t kResourceTypeName =
+    static_cast<uint32_t>(TfLiteBufferAttributeKey::kBufferResourceTypeName);
+constexpr uint32_t kAlignment =
+    static_cast<uint32_t>(TfLiteBufferAttributeKey::kAlignment);
+constexpr uint32_t kOffset =
+    static_cast<uint32_t>(TfLiteBufferAttributeKey::kOffset);
+constexpr uint32_t kSize =
+    static_cast<uint32_t>(TfLiteBufferAttributeKey::kSize);
+constexpr uint32_t kSyncObjectTypeName =
+    static_cast<uint32_t>(TfLiteSyncAttributeKey::kSyncObjectTypeName);
+
+// Returns true if the string attribute `key` is either absent from `attrs`
+// or equal to `expected`.
+bool HasCompatibleTypeName(const TfLiteAttributeMap* attrs, uint32_t key,
+                           const char* expected) {
+  const char* name = nullptr;
+  if (!TfLiteAttributeMapGetStringAttr(attrs, key, &name)) return true;
+  return name != nullptr && std::strcmp(name, expected) == 0;
+}
+
+bool IsAligned(const void* data) {
+  return reinterpret_cast<uintptr_t>(data) % kDefaultTensorAlignment == 0;
+}
+
+}  // namespace
+
+CpuAsyncKernel::CpuAsyncKernel(Subgraph* subgraph) : subgraph_(subgraph) {}
+
+CpuAsyncKernel::~CpuAsyncKernel() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  queue_cv_.notify_all();
+  if (worker_.joinable()) worker_.join();
+}
+
+TfLiteStatus CpuAsyncKernel::RegisterBuffer(TfLiteOpaqueContext* context,
+                                            TfLiteIoType io_type,
+                                            const TfLiteBackendBuffer* buffer,
+                                            const TfLiteAttributeMap* attrs,
+                                            TfLiteBufferHandle handle) {
+  const char* type_name = nullptr;
+  if (!TfLiteAttributeMapGetStringAttr(attrs, kResourceTypeName, &type_name) ||
+      type_name == nullptr ||
+      std::strcmp(type_name, kTfLiteBufferTypeCpuMemory) != 0) {
+    subgraph_->ReportError("CPU async kernel only supports %s buffers.",
+                           kTfLiteBufferTypeCpuMemory);
+    return kTfLiteError;
+  }
+  Buffer registered;
+  if (!TfLiteAttributeMapGetSizeTAttr(attrs, kSize, &registered.size)) {
+    subgraph_->ReportError("Buffer size is required.");
+    return kTfLiteError;
+  }
+  size_t offset = 0;
+  TfLiteAttributeMapGetSizeTAttr(attrs, kOffset, &offset);
+  auto* data = static_cast<char*>(TfLiteBackendBufferGetPtr(buffer));
+  if (data == nullptr) return kTfLiteError;
+  registered.data = data + offset;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffers_[handle] = registered;
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::RegisterBufferSlice(
+    TfLiteOpaqueContext* context, TfLiteBufferHandle buffer_pool,
+    const TfLiteAttributeMap* attrs, TfLiteBufferHandle handle) {
+  if (!HasCompatibleTypeName(attrs, kResourceTypeName,
+                             kTfLiteBufferTypeCpuMemory)) {
+    return kTfLiteError;
+  }
+  size_t offset = 0;
+  size_t size = 0;
+  if (!TfLiteAttributeMapGetSizeTAttr(attrs, kOffset, &offset) ||
+      !TfLiteAttributeMapGetSizeTAttr(attrs, kSize, &size)) {
+    subgraph_->ReportError("Buffer slice offset and size are required.");
+    return kTfLiteError;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = buffers_.find(buffer_pool);
+  if (it == buffers_.end()) {
+    subgraph_->ReportError("Unknown buffer pool %d.", buffer_pool);
+    return kTfLiteError;
+  }
+  if (offset > it->second.size || size > it->second.size - offset) {
+    subgraph_->ReportError("Buffer slice is out of the buffer pool bounds.");
+    return kTfLiteError;
+  }
+  buffers_[handle] = {it->second.data + offset, size};
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::UnregisterBuffer(TfLiteOpaqueContext* context,
+                                              TfLiteBufferHandle handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return buffers_.erase(handle) == 1 ? kTfLiteOk : kTfLiteError;
+}
+
+std::vector<const char*> CpuAsyncKernel::SupportedBufferTypes(
+    TfLiteIoType io_type) const {
+  return {kTfLiteBufferTypeCpuMemory};
+}
+
+std::vector<const char*> CpuAsyncKernel::SupportedSynchronizations(
+    TfLiteIoType io_type) const {
+  return {kTfLiteSyncTypeNoSyncObj};
+}
+
+bool CpuAsyncKernel::ReconcileRestrictions(
+    TfLiteOpaqueContext* context, TfLiteOpaqueNode* node, int tensor_index,
+    const TfLiteAttributeMap* user_provided_attributes,
+    TfLiteAttributeMap* merged, TfLiteAttributeMap* conflict) const {
+  TfLiteAttributeMapCopy(user_provided_attributes, merged);
+  if (TfLiteAttributeMapIsBufferAttributeMap(user_provided_attributes)) {
+    const bool compatible =
+        HasCompatibleTypeName(user_provided_attributes, kResourceTypeName,
+                              kTfLiteBufferTypeCpuMemory);
+    if (!compatible && conflict != nullptr) {
+      TfLiteAttributeMapSetStringAttr(conflict, kResourceTypeName,
+                                      kTfLiteBufferTypeCpuMemory);
+    }
+    TfLiteAttributeMapSetStringAttr(merged, kResourceTypeName,
+                                    kTfLiteBufferTypeCpuMemory);
+    // Aligned buffers can be used without copies.
+    size_t alignment = 0;
+    TfLiteAttributeMapGetSizeTAttr(user_provided_attributes, kAlignment,
+                                   &alignment);
+    TfLiteAttributeMapSetSizeTAttr(
+        merged, kAlignment,
+        std::max(alignment, static_cast<size_t>(kDefaultTensorAlignment)));
+    size_t size = 0;
+    TfLiteAttributeMapGetSizeTAttr(user_provided_attributes, kSize, &size);
+    TfLiteAttributeMapSetSizeTAttr(
+        merged, kSize, std::max(size, subgraph_->tensor(tensor_index)->bytes));
+    return compatible;
+  }
+  if (TfLiteAttributeMapIsSyncAttributeMap(user_provided_attributes)) {
+    const bool compatible =
+        HasCompatibleTypeName(user_provided_attributes, kSyncObjectTypeName,
+                              kTfLiteSyncTypeNoSyncObj);
+    if (!compatible && conflict != nullptr) {
+      TfLiteAttributeMapSetStringAttr(conflict, kSyncObjectTypeName,
+                                      kTfLiteSyncTypeNoSyncObj);
+    }
+    TfLiteAttributeMapSetStringAttr(merged, kSyncObjectTypeName,
+                                    kTfLiteSyncTypeNoSyncObj);
+    return compatible;
+  }
+  return false;
+}
+
+TfLiteStatus CpuAsyncKernel::SetAttributes(TfLiteOpaqueContext* context,
+                                           TfLiteOpaqueNode* node,
+                                           int tensor_index,
+                                           const TfLiteAttributeMap* attrs) {
+  if (TfLiteAttributeMapIsBufferAttributeMap(attrs)) {
+    return HasCompatibleTypeName(attrs, kResourceTypeName,
+                                 kTfLiteBufferTypeCpuMemory)
+               ? kTfLiteOk
+               : kTfLiteError;
+  }
+  if (TfLiteAttributeMapIsSyncAttributeMap(attrs)) {
+    return HasCompatibleTypeName(attrs, kSyncObjectTypeName,
+                                 kTfLiteSyncTypeNoSyncObj)
+               ? kTfLiteOk
+               : kTfLiteError;
+  }
+  return kTfLiteError;
+}
+
+TfLiteStatus CpuAsyncKernel::Prepare(TfLiteOpaqueContext* context,
+                                     TfLiteOpaqueNode* node) {
+  // The subgraph kernels are prepared by `AllocateTensors`.
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::Eval(TfLiteOpaqueContext* context,
+                                  TfLiteOpaqueNode* node,
+                                  TfLiteExecutionTask* task) {
+  auto* execution =
+      static_cast<Execution*>(task->task->GetDelegateExecutionData(kernel()));
+  if (execution == nullptr) {
+    execution = new Execution;
+    task->task->SetDelegateExecutionData(kernel(), execution);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto find_buffers = [this, task](const std::vector<int>& tensors,
+                                   std::vector<Buffer>* buffers) {
+    buffers->clear();
+    for (int tensor_index : tensors) {
+      auto it = buffers_.find(task->task->GetBufferHandle(tensor_index));
+      if (it == buffers_.end()) {
+        subgraph_->ReportError("No buffer is bound to tensor %d.",
+                               tensor_index);
+        return false;
+      }
+      buffers->push_back(it->second);
+    }
+    return true;
+  };
+  if (!find_buffers(subgraph_->inputs(), &execution->inputs) ||
+      !find_buffers(subgraph_->outputs(), &execution->outputs)) {
+    return kTfLiteError;
+  }
+  execution->done = false;
+  queue_.push_back(execution);
+  if (!worker_.joinable()) {
+    worker_ = std::thread(&CpuAsyncKernel::WorkerLoop, this);
+  }
+  queue_cv_.notify_one();
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::Wait(TfLiteOpaqueContext* context,
+                                  TfLiteExecutionTask* task) {
+  auto* execution =
+      static_cast<Execution*>(task->task->GetDelegateExecutionData(kernel()));
+  if (execution == nullptr) return kTfLiteOk;
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [execution] { return execution->done; });
+  return execution->status;
+}
+
+TfLiteStatus CpuAsyncKernel::Finish(TfLiteOpaqueContext* context,
+                                    TfLiteExecutionTask* task) {
+  const TfLiteStatus status = Wait(context, task);
+  delete static_cast<Execution*>(
+      task->task->GetDelegateExecutionData(kernel()));
+  task->task->SetDelegateExecutionData(kernel(), nullptr);
+  return status;
+}
+
+void CpuAsyncKernel::WorkerLoop() {
+  while (true) {
+    Execution* execution = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      queue_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) return;
+      execution = queue_.front();
+      queue_.pop_front();
+    }
+    const TfLiteStatus status = Run(*execution);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      execution->status = status;
+      execution->done = true;
+    }
+    done_cv_.notify_all();
+  }
+}
+
+TfLiteStatus CpuAsyncKernel::Run(const Execution& execution) {
+  const std::vector<int>& inputs = subgraph_->inputs();
+  for (int i = 0; i < inputs.size(); ++i) {
+    bool zero_copy = false;
+    TF_LITE_ENSURE_STATUS(
+        BindTensor(inputs[i], execution.inputs[i], &zero_copy));
+    if (!zero_copy) {
+      const TfLiteTensor* tensor = subgraph_->tensor(inputs[i]);
+      std::memcpy(tensor->data.raw, execution.inputs[i].data, tensor->bytes);
+    }
+  }
+  const std::vector<int>& outputs = subgraph_->outputs();
+  std::vector<bool> copy_outputs(outputs.size());
+  for (int i = 0; i < outputs.size(); ++i) {
+    bool zero_copy = false;
+    TF_LITE_ENSURE_STATUS(
+        BindTensor(outputs[i], execution.outputs[i], &zero_copy));
+    copy_outputs[i] = !zero_copy;
+  }
+
+  TF_LITE_ENSURE_STATUS(subgraph_->Invoke());
+
+  for (int i = 0; i < outputs.size(); ++i) {
+    if (!copy_outputs[i]) continue;
+    const TfLiteTensor* tensor = subgraph_->tensor(outputs[i]);
+    // Dynamic outputs only know their size once invoked.
+    if (tensor->bytes > execution.outputs[i].size) {
+      subgraph_->ReportError("Buffer of output tensor %d is too small.",
+                             outputs[i]);
+      return kTfLiteError;
+    }
+    std::memcpy(execution.outputs[i].data, tensor->data.raw, tensor->bytes);
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::BindTensor(int tensor_index, const Buffer& buffer,
+                                        bool* zero_copy) {
+  const TfLiteTensor* tensor = subgraph_->tensor(tensor_index);
+  const bool bound = bound_tensors_.count(tensor_index) != 0;
+  const bool bindable = tensor->allocation_type == kTfLiteArenaRw || bound;
+  if (bindable && IsAligned(buffer.data) && buffer.size >= tensor->bytes) {
+    TF_LITE_ENSURE_STATUS(subgraph_->SetCustomAllocationForTensor(
+        tensor_index, {buffer.data, buffer.size}));
+    bound_tensors_.insert(tensor_index);
+    *zero_copy = true;
+    return kTfLiteOk;
+  }
+
+  *zero_copy = false;
+  if (tensor->allocation_type != kTfLiteDynamic &&
+      buffer.size < tensor->bytes) {
+    subgraph_->ReportError("Buffer of tensor %d is too small.", tensor_index);
+    return kTfLiteError;
+  }
+  if (bound) {
+    // The tensor still points to the buffer of a previous task, which may since
+    // have been unregistered.
+    std::vector<char>& staging = staging_buffers_[tensor_index];
+    staging.resize(tensor->bytes + kDefaultTensorAlignment);
+    char* data = staging.data();
+    data += (kDefaultTensorAlignment -
+             reinterpret_cast<uintptr_t>(data) % kDefaultTensorAlignment) %
+            kDefaultTensorAlignment;
+    TF_LITE_ENSURE_STATUS(subgraph_->SetCustomAllocationForTensor(
+        tensor_index, {data, tensor->bytes}));
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace async
+}  // namespace tflite
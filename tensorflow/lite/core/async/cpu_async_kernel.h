@@ -0,0 +1,145 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
+#define TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <mutex>   // NOLINT(build/c++11)
+#include <set>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/async/backend_async_kernel_interface.h"
+#include "tensorflow/lite/core/async/common.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+
+namespace tflite {
+namespace async {
+
+// WARNING: Experimental interface, subject to change
+//
+// An async kernel that runs a whole subgraph with its regular (CPU) kernels.
+// AsyncSubgraph uses it for subgraphs that no async backend fully delegates.
+//
+// Scheduled tasks are queued and run one after the other by a worker thread,
+// in the order they were scheduled, so an application can keep several tasks
+// in flight: while one task is invoked, it prepares the inputs of the next
+// ones and consumes the outputs of the previous ones. `Wait` blocks until the
+// outputs of the task are written.
+//
+// Buffers must be of the `kTfLiteBufferTypeCpuMemory` type and have a size
+// attribute. Buffers aligned to `kDefaultTensorAlignment` (which reconciled
+// attributes request) are used as the tensor memory directly; others are
+// copied from and to. Every input and output tensor of the subgraph must be
+// bound to a buffer in a task. Only `kTfLiteSyncTypeNoSyncObj` is supported:
+// inputs must be ready when a task is scheduled.
+//
+// The subgraph must have been allocated, and must not be invoked directly or
+// resized while tasks are in flight.
+class CpuAsyncKernel : public delegates::BackendAsyncKernelInterface {
+ public:
+  explicit CpuAsyncKernel(Subgraph* subgraph);
+  ~CpuAsyncKernel() override;
+
+  TfLiteStatus RegisterBuffer(TfLiteOpaqueContext* context,
+                              TfLiteIoType io_type,
+                              const TfLiteBackendBuffer* buffer,
+                              const TfLiteAttributeMap* attrs,
+                              TfLiteBufferHandle handle) override;
+  TfLiteStatus RegisterBufferSlice(TfLiteOpaqueContext* context,
+                                   TfLiteBufferHandle buffer_pool,
+                                   const TfLiteAttributeMap* attrs,
+                                   TfLiteBufferHandle handle) override;
+  TfLiteStatus UnregisterBuffer(TfLiteOpaqueContext* context,
+                                TfLiteBufferHandle handle) override;
+
+  std::vector<const char*> SupportedBufferTypes(
+      TfLiteIoType io_type) const override;
+  std::vector<const char*> SupportedSynchronizations(
+      TfLiteIoType io_type) const override;
+  bool ReconcileRestrictions(TfLiteOpaqueContext* context,
+                             TfLiteOpaqueNode* node, int tensor_index,
+                             const TfLiteAttributeMap* user_provided_attributes,
+                             TfLiteAttributeMap* merged,
+                             TfLiteAttributeMap* conflict) const override;
+  TfLiteStatus SetAttributes(TfLiteOpaqueContext* context,
+                             TfLiteOpaqueNode* node, int tensor_index,
+                             const TfLiteAttributeMap* attrs) override;
+  TfLiteStatus Prepare(TfLiteOpaqueContext* context,
+                       TfLiteOpaqueNode* node) override;
+
+  TfLiteStatus Eval(TfLiteOpaqueContext* context, TfLiteOpaqueNode* node,
+                    TfLiteExecutionTask* task) override;
+  TfLiteStatus Wait(TfLiteOpaqueContext* context,
+                    TfLiteExecutionTask* task) override;
+  TfLiteStatus Finish(TfLiteOpaqueContext* context,
+                      TfLiteExecutionTask* task) override;
+
+ private:
+  struct Buffer {
+    char* data = nullptr;
+    size_t size = 0;
+  };
+
+  // A scheduled task, with the buffers bound to the subgraph inputs and
+  // outputs when it was scheduled.
+  struct Execution {
+    std::vector<Buffer> inputs;
+    std::vector<Buffer> outputs;
+    bool done = true;
+    TfLiteStatus status = kTfLiteOk;
+  };
+
+  // Runs the queued executions until the kernel is destroyed.
+  void WorkerLoop();
+
+  // Binds the buffers of `execution` to the subgraph and invokes it.
+  TfLiteStatus Run(const Execution& execution);
+
+  // Makes `buffer` the memory of tensor `tensor_index` when possible. Sets
+  // `zero_copy` to false if the tensor data must instead be copied from or to
+  // `buffer`.
+  TfLiteStatus BindTensor(int tensor_index, const Buffer& buffer,
+                          bool* zero_copy);
+
+  // Not owned.
+  Subgraph* const subgraph_;
+
+  // Guards `buffers_`, `queue_`, `stop_` and the state of the executions.
+  std::mutex mutex_;
+  std::condition_variable queue_cv_;
+  std::condition_variable done_cv_;
+  std::map<TfLiteBufferHandle, Buffer> buffers_;
+  std::deque<Execution*> queue_;
+  bool stop_ = false;
+  // Started by the first scheduled task.
+  std::thread worker_;
+
+  // Only accessed by the worker thread.
+  // Tensors this kernel set a custom allocation for.
+  std::set<int> bound_tensors_;
+  // Aligned memory for bound tensors whose buffer can't be used directly.
+  std::map<int, std::vector<char>> staging_buffers_;
+};
+
+}  // namespace async
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
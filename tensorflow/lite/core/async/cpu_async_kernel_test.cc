@@ -0,0 +1,229 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/task.h"
+#include "tensorflow/lite/core/async/interop/attribute_keys.h"
+#include "tensorflow/lite/core/async/interop/c/attribute_map.h"
+#include "tensorflow/lite/core/async/interop/c/constants.h"
+#include "tensorflow/lite/core/async/interop/c/types.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/kernels/subgraph_test_util.h"
+
+namespace tflite {
+namespace async {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+constexpr uint32_t kResourceTypeName =
+    static_cast<uint32_t>(TfLiteBufferAttributeKey::kBufferResourceTypeName);
+constexpr uint32_t kAlignment =
+    static_cast<uint32_t>(TfLiteBufferAttributeKey::kAlignment);
+constexpr uint32_t kSize =
+    static_cast<uint32_t>(TfLiteBufferAttributeKey::kSize);
+
+constexpr int kNumElements = 4;
+
+// Holds the aligned memory of the I/O buffers of one task. `offset` bytes are
+// skipped to test unaligned buffers.
+struct TaskBuffers {
+  alignas(64) char x[64 + sizeof(int32_t) * kNumElements];
+  alignas(64) char y[64 + sizeof(int32_t) * kNumElements];
+  alignas(64) char z[64 + sizeof(int32_t) * kNumElements];
+};
+
+class CpuAsyncKernelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    interpreter_ = std::make_unique<Interpreter>();
+    subgraph_test_util::SubgraphBuilder builder;
+    builder.BuildAddSubgraph(&interpreter_->primary_subgraph());
+    interpreter_->ResizeInputTensor(interpreter_->inputs()[0], {kNumElements});
+    interpreter_->ResizeInputTensor(interpreter_->inputs()[1], {kNumElements});
+    ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+
+    signature_def_.signature_key = "serving_default";
+    signature_def_.inputs["x"] = 0;
+    signature_def_.inputs["y"] = 1;
+    signature_def_.outputs["z"] = 2;
+    signature_def_.subgraph_index = 0;
+    runner_ = std::make_unique<AsyncSignatureRunner>(
+        &signature_def_, &interpreter_->primary_subgraph());
+  }
+
+  void TearDown() override {
+    for (TfLiteBackendBuffer* buffer : backend_buffers_) {
+      TfLiteBackendBufferDelete(buffer);
+    }
+  }
+
+  TfLiteBufferHandle Register(TfLiteIoType io_type, char* data) {
+    TfLiteBackendBuffer* buffer = TfLiteBackendBufferCreate();
+    backend_buffers_.push_back(buffer);
+    TfLiteBackendBufferSetPtr(buffer, data);
+    TfLiteAttributeMap* attrs = TfLiteAttributeMapCreate(kTfLiteBufferAttrMap);
+    TfLiteAttributeMapSetStringAttr(attrs, kResourceTypeName,
+                                    kTfLiteBufferTypeCpuMemory);
+    TfLiteAttributeMapSetSizeTAttr(attrs, kSize,
+                                   sizeof(int32_t) * kNumElements);
+    TfLiteBufferHandle handle = kTfLiteNullBufferHandle;
+    EXPECT_EQ(runner_->RegisterBuffer(io_type, buffer, attrs, &handle),
+              kTfLiteOk);
+    TfLiteAttributeMapDelete(attrs);
+    return handle;
+  }
+
+  // Creates a task computing `x + y` in `buffers`.
+  TfLiteExecutionTask* CreateTask(TaskBuffers* buffers, int offset,
+                                  const std::vector<int32_t>& x,
+                                  const std::vector<int32_t>& y) {
+    std::memcpy(buffers->x + offset, x.data(), sizeof(int32_t) * x.size());
+    std::memcpy(buffers->y + offset, y.data(), sizeof(int32_t) * y.size());
+    TfLiteExecutionTask* task = runner_->CreateTask();
+    TfLiteExecutionTaskSetBuffer(task, kTfLiteIoInput, "x",
+                                 Register(kTfLiteIoInput, buffers->x + offset));
+    TfLiteExecutionTaskSetBuffer(task, kTfLiteIoInput, "y",
+                                 Register(kTfLiteIoInput, buffers->y + offset));
+    TfLiteExecutionTaskSetBuffer(
+        task, kTfLiteIoOutput, "z",
+        Register(kTfLiteIoOutput, buffers->z + offset));
+    return task;
+  }
+
+  std::vector<int32_t> Output(const TaskBuffers& buffers, int offset) {
+    std::vector<int32_t> output(kNumElements);
+    std::memcpy(output.data(), buffers.z + offset,
+                sizeof(int32_t) * kNumElements);
+    return output;
+  }
+
+  std::unique_ptr<Interpreter> interpreter_;
+  internal::SignatureDef signature_def_;
+  std::unique_ptr<AsyncSignatureRunner> runner_;
+  std::vector<TfLiteBackendBuffer*> backend_buffers_;
+};
+
+TEST_F(CpuAsyncKernelTest, SupportedTypes) {
+  EXPECT_THAT(runner_->SupportedBufferTypes(kTfLiteIoInput),
+              ElementsAre(kTfLiteBufferTypeCpuMemory));
+  EXPECT_THAT(runner_->SupportedSynchronizations(kTfLiteIoOutput),
+              ElementsAre(kTfLiteSyncTypeNoSyncObj));
+}
+
+TEST_F(CpuAsyncKernelTest, ReconcileRequestsAlignment) {
+  TfLiteAttributeMap* attrs = TfLiteAttributeMapCreate(kTfLiteBufferAttrMap);
+  TfLiteAttributeMap* merged = TfLiteAttributeMapCreate(kTfLiteBufferAttrMap);
+  EXPECT_TRUE(
+      runner_->ReconcileRestrictions(kTfLiteIoInput, "x", attrs, merged,
+                                     /*conflict=*/nullptr));
+  size_t alignment = 0;
+  size_t size = 0;
+  const char* type_name = nullptr;
+  EXPECT_TRUE(TfLiteAttributeMapGetSizeTAttr(merged, kAlignment, &alignment));
+  EXPECT_EQ(alignment, 64);
+  EXPECT_TRUE(TfLiteAttributeMapGetSizeTAttr(merged, kSize, &size));
+  EXPECT_EQ(size, sizeof(int32_t) * kNumElements);
+  EXPECT_TRUE(
+      TfLiteAttributeMapGetStringAttr(merged, kResourceTypeName, &type_name));
+  EXPECT_STREQ(type_name, kTfLiteBufferTypeCpuMemory);
+
+  TfLiteAttributeMapSetStringAttr(attrs, kResourceTypeName, "AHardwareBuffer");
+  EXPECT_FALSE(
+      runner_->ReconcileRestrictions(kTfLiteIoInput, "x", attrs, merged,
+                                     /*conflict=*/nullptr));
+  TfLiteAttributeMapDelete(merged);
+  TfLiteAttributeMapDelete(attrs);
+}
+
+TEST_F(CpuAsyncKernelTest, RejectsOtherBufferTypes) {
+  TfLiteBackendBuffer* buffer = TfLiteBackendBufferCreate();
+  TfLiteAttributeMap* attrs = TfLiteAttributeMapCreate(kTfLiteBufferAttrMap);
+  TfLiteAttributeMapSetStringAttr(attrs, kResourceTypeName, "AHardwareBuffer");
+  TfLiteBufferHandle handle = kTfLiteNullBufferHandle;
+  EXPECT_EQ(runner_->RegisterBuffer(kTfLiteIoInput, buffer, attrs, &handle),
+            kTfLiteError);
+  TfLiteAttributeMapDelete(attrs);
+  TfLiteBackendBufferDelete(buffer);
+}
+
+TEST_F(CpuAsyncKernelTest, PipelinesTasks) {
+  constexpr int kNumTasks = 3;
+  std::vector<TaskBuffers> buffers(kNumTasks);
+  std::vector<TfLiteExecutionTask*> tasks;
+  for (int i = 0; i < kNumTasks; ++i) {
+    tasks.push_back(CreateTask(&buffers[i], /*offset=*/0, {i, i, i, i},
+                               {1, 2, 3, 4}));
+  }
+  // All tasks are in flight before the first one is waited on.
+  for (TfLiteExecutionTask* task : tasks) {
+    EXPECT_EQ(runner_->InvokeAsync(task), kTfLiteOk);
+  }
+  for (int i = 0; i < kNumTasks; ++i) {
+    EXPECT_EQ(runner_->Wait(tasks[i]), kTfLiteOk);
+    EXPECT_THAT(Output(buffers[i], /*offset=*/0),
+                ElementsAreArray({i + 1, i + 2, i + 3, i + 4}));
+  }
+  for (TfLiteExecutionTask* task : tasks) {
+    EXPECT_EQ(runner_->Finish(task), kTfLiteOk);
+  }
+}
+
+TEST_F(CpuAsyncKernelTest, AlignedAndUnalignedBuffers) {
+  TaskBuffers aligned, unaligned;
+  TfLiteExecutionTask* aligned_task =
+      CreateTask(&aligned, /*offset=*/0, {1, 2, 3, 4}, {10, 20, 30, 40});
+  TfLiteExecutionTask* unaligned_task = CreateTask(
+      &unaligned, /*offset=*/sizeof(int32_t), {5, 6, 7, 8}, {1, 1, 1, 1});
+
+  EXPECT_EQ(runner_->InvokeAsync(aligned_task), kTfLiteOk);
+  EXPECT_EQ(runner_->InvokeAsync(unaligned_task), kTfLiteOk);
+  EXPECT_EQ(runner_->Wait(aligned_task), kTfLiteOk);
+  EXPECT_EQ(runner_->Wait(unaligned_task), kTfLiteOk);
+  EXPECT_THAT(Output(aligned, /*offset=*/0), ElementsAre(11, 22, 33, 44));
+  EXPECT_THAT(Output(unaligned, /*offset=*/sizeof(int32_t)),
+              ElementsAre(6, 7, 8, 9));
+
+  // Tasks can be scheduled again once waited on.
+  std::memcpy(aligned.x, unaligned.z + sizeof(int32_t),
+              sizeof(int32_t) * kNumElements);
+  EXPECT_EQ(runner_->InvokeAsync(aligned_task), kTfLiteOk);
+  EXPECT_EQ(runner_->Wait(aligned_task), kTfLiteOk);
+  EXPECT_THAT(Output(aligned, /*offset=*/0), ElementsAre(16, 27, 38, 49));
+
+  EXPECT_EQ(runner_->Finish(aligned_task), kTfLiteOk);
+  EXPECT_EQ(runner_->Finish(unaligned_task), kTfLiteOk);
+}
+
+TEST_F(CpuAsyncKernelTest, MissingBuffer) {
+  TfLiteExecutionTask* task = runner_->CreateTask();
+  EXPECT_EQ(runner_->InvokeAsync(task), kTfLiteError);
+  EXPECT_EQ(runner_->Finish(task), kTfLiteOk);
+}
+
+}  // namespace
+}  // namespace async
+}  // namespace tflite
@@ -17,5 +17,6 @@ limitations under the License.
 extern "C" {
 
 const char kTfLiteSyncTypeNoSyncObj[] = "no_sync_obj";
+const char kTfLiteBufferTypeCpuMemory[] = "cpu_memory";
 
 }  // extern "C"
@@ -38,6 +38,12 @@ extern "C" {
 /// output tensor must be ready when AsyncSignatureRunner::Wait returns.
 TFL_CAPI_EXPORT extern const char kTfLiteSyncTypeNoSyncObj[];  // "no_sync_obj"
 
+/// Buffer type name of plain host memory.
+///
+/// The pointer stored in the TfLiteBackendBuffer is the address of the data.
+/// The buffer attributes must include its size.
+TFL_CAPI_EXPORT extern const char kTfLiteBufferTypeCpuMemory[];  // "cpu_memory"
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
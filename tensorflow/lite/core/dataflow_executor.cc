@@ -0,0 +1,201 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/dataflow_executor.h"
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+namespace {
+
+// CPU backend context of the executor worker running on this thread.
+thread_local TfLiteExternalContext* current_thread_cpu_backend_context =
+    nullptr;
+
+bool Overlap(const std::vector<DataflowNodeAccess::Range>& a,
+             const std::vector<DataflowNodeAccess::Range>& b) {
+  for (const DataflowNodeAccess::Range& x : a) {
+    for (const DataflowNodeAccess::Range& y : b) {
+      if (x.begin < y.end && y.begin < x.end) return true;
+    }
+  }
+  return false;
+}
+
+bool MustBeOrdered(const DataflowNodeAccess& a, const DataflowNodeAccess& b) {
+  return a.barrier || b.barrier || Overlap(a.writes, b.reads) ||
+         Overlap(a.writes, b.writes) || Overlap(a.reads, b.writes);
+}
+
+}  // namespace
+
+DataflowPlan DataflowPlan::Build(const std::vector<DataflowNodeAccess>& nodes) {
+  DataflowPlan plan;
+  plan.successors_.resize(nodes.size());
+  plan.num_predecessors_.resize(nodes.size(), 0);
+  for (int j = 0; j < static_cast<int>(nodes.size()); ++j) {
+    for (int i = 0; i < j; ++i) {
+      if (MustBeOrdered(nodes[i], nodes[j])) {
+        plan.successors_[i].push_back(j);
+        ++plan.num_predecessors_[j];
+      }
+    }
+  }
+  return plan;
+}
+
+struct DataflowExecutor::Worker {
+  std::thread thread;
+  ExternalCpuBackendContext cpu_backend_context;
+};
+
+struct DataflowExecutor::RunState {
+  std::mutex mutex;
+  // Signalled whenever a node becomes ready or finishes.
+  std::condition_variable cv;
+  bool shutdown = false;
+
+  // The run in progress, if any.
+  const DataflowPlan* plan = nullptr;
+  const std::function<TfLiteStatus(int)>* run_node = nullptr;
+  const std::function<TfLiteStatus()>* should_stop = nullptr;
+  std::vector<int> pending_predecessors;
+  std::deque<int> ready;
+  int running = 0;
+  size_t finished = 0;
+  TfLiteStatus status = kTfLiteOk;
+};
+
+DataflowExecutor::DataflowExecutor(int num_threads)
+    : state_(std::make_unique<RunState>()) {
+  for (int i = 1; i < num_threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    worker->thread = std::thread(&DataflowExecutor::WorkerLoop, this,
+                                 worker.get());
+  }
+}
+
+DataflowExecutor::~DataflowExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->shutdown = true;
+  }
+  state_->cv.notify_all();
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+TfLiteExternalContext* DataflowExecutor::CurrentThreadCpuBackendContext() {
+  return current_thread_cpu_backend_context;
+}
+
+void DataflowExecutor::WorkerLoop(Worker* worker) {
+  current_thread_cpu_backend_context = &worker->cpu_backend_context;
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  while (true) {
+    state_->cv.wait(lock, [this] {
+      return state_->shutdown ||
+             (state_->plan != nullptr && state_->status == kTfLiteOk &&
+              !state_->ready.empty());
+    });
+    if (state_->shutdown) return;
+    lock.unlock();
+    Drain();
+    lock.lock();
+  }
+}
+
+void DataflowExecutor::Drain() {
+  RunState& state = *state_;
+  std::unique_lock<std::mutex> lock(state.mutex);
+  while (state.status == kTfLiteOk && !state.ready.empty()) {
+    if (TfLiteStatus s = (*state.should_stop)(); s != kTfLiteOk) {
+      state.status = s;
+      break;
+    }
+    const int node = state.ready.front();
+    state.ready.pop_front();
+    ++state.running;
+    lock.unlock();
+    const TfLiteStatus s = (*state.run_node)(node);
+    lock.lock();
+    --state.running;
+    ++state.finished;
+    if (s != kTfLiteOk) {
+      if (state.status == kTfLiteOk) state.status = s;
+    } else {
+      for (int successor : state.plan->successors(node)) {
+        if (--state.pending_predecessors[successor] == 0) {
+          state.ready.push_back(successor);
+        }
+      }
+    }
+    state.cv.notify_all();
+  }
+}
+
+TfLiteStatus DataflowExecutor::Run(
+    const DataflowPlan& plan, const std::function<TfLiteStatus(int)>& run_node,
+    const std::function<TfLiteStatus()>& should_stop) {
+  RunState& state = *state_;
+  std::unique_lock<std::mutex> lock(state.mutex);
+  state.run_node = &run_node;
+  state.should_stop = &should_stop;
+  state.pending_predecessors.resize(plan.size());
+  state.ready.clear();
+  for (int i = 0; i < static_cast<int>(plan.size()); ++i) {
+    state.pending_predecessors[i] = plan.num_predecessors(i);
+    if (state.pending_predecessors[i] == 0) state.ready.push_back(i);
+  }
+  state.running = 0;
+  state.finished = 0;
+  state.status = kTfLiteOk;
+  state.plan = &plan;
+  state.cv.notify_all();
+
+  while (true) {
+    lock.unlock();
+    Drain();
+    lock.lock();
+    if (state.running == 0 &&
+        (state.status != kTfLiteOk || state.finished == plan.size())) {
+      break;
+    }
+    state.cv.wait(lock, [&state, &plan] {
+      return (state.status == kTfLiteOk && !state.ready.empty()) ||
+             (state.running == 0 && (state.status != kTfLiteOk ||
+                                     state.finished == plan.size()));
+    });
+  }
+  state.plan = nullptr;
+  state.run_node = nullptr;
+  state.should_stop = nullptr;
+  state.ready.clear();
+  return state.status;
+}
+
+}  // namespace tflite
@@ -0,0 +1,115 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_DATAFLOW_EXECUTOR_H_
+#define TENSORFLOW_LITE_CORE_DATAFLOW_EXECUTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+
+// The memory a node of the execution plan touches while it runs.
+struct DataflowNodeAccess {
+  // Half-open address range [begin, end) of a tensor buffer.
+  struct Range {
+    std::uintptr_t begin;
+    std::uintptr_t end;
+    bool operator==(const Range& other) const {
+      return begin == other.begin && end == other.end;
+    }
+  };
+
+  std::vector<Range> reads;
+  std::vector<Range> writes;
+  // A barrier may have side effects outside of its tensors (resources,
+  // subgraphs, unknown custom state) and is ordered against every other node.
+  bool barrier = false;
+
+  bool operator==(const DataflowNodeAccess& other) const {
+    return barrier == other.barrier && reads == other.reads &&
+           writes == other.writes;
+  }
+};
+
+// Dependency DAG of an execution plan. Node `j` depends on an earlier node `i`
+// when they touch overlapping memory and at least one of them writes it, so
+// the DAG also orders nodes whose tensors the memory planner placed in the
+// same arena bytes.
+class DataflowPlan {
+ public:
+  DataflowPlan() = default;
+
+  // `nodes` is in execution plan order.
+  static DataflowPlan Build(const std::vector<DataflowNodeAccess>& nodes);
+
+  size_t size() const { return num_predecessors_.size(); }
+  // Nodes that can only start once node `i` has finished.
+  const std::vector<int>& successors(int i) const { return successors_[i]; }
+  // Number of nodes node `i` waits for.
+  int num_predecessors(int i) const { return num_predecessors_[i]; }
+
+ private:
+  std::vector<std::vector<int>> successors_;
+  std::vector<int> num_predecessors_;
+};
+
+// Runs the nodes of a `DataflowPlan` on a fixed set of threads: the calling
+// thread plus `num_threads - 1` workers owned by the executor. Each worker has
+// its own CPU backend context, because kernels on different threads must not
+// share one; the calling thread keeps the interpreter's.
+class DataflowExecutor {
+ public:
+  explicit DataflowExecutor(int num_threads);
+  ~DataflowExecutor();
+
+  DataflowExecutor(const DataflowExecutor&) = delete;
+  DataflowExecutor& operator=(const DataflowExecutor&) = delete;
+
+  int num_threads() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // Calls `run_node(i)` once for every node of `plan`, each after all of its
+  // predecessors returned. `should_stop` is polled before starting each node,
+  // one call at a time. No new node starts once `run_node` fails or
+  // `should_stop` returns a status other than kTfLiteOk; the first such status
+  // is returned after the nodes already running have finished.
+  TfLiteStatus Run(const DataflowPlan& plan,
+                   const std::function<TfLiteStatus(int)>& run_node,
+                   const std::function<TfLiteStatus()>& should_stop);
+
+  // The CPU backend context kernels running on the current thread must use
+  // instead of the interpreter's, or nullptr outside of executor workers.
+  static TfLiteExternalContext* CurrentThreadCpuBackendContext();
+
+ private:
+  struct Worker;
+  struct RunState;
+
+  void WorkerLoop(Worker* worker);
+  // Runs ready nodes of the current run until none are left.
+  void Drain();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::unique_ptr<RunState> state_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_DATAFLOW_EXECUTOR_H_
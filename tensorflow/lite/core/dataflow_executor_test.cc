@@ -0,0 +1,237 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/dataflow_executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+DataflowNodeAccess Access(std::vector<DataflowNodeAccess::Range> reads,
+                          std::vector<DataflowNodeAccess::Range> writes) {
+  DataflowNodeAccess access;
+  access.reads = std::move(reads);
+  access.writes = std::move(writes);
+  return access;
+}
+
+TfLiteStatus Continue() { return kTfLiteOk; }
+
+TEST(DataflowPlanTest, OrdersProducersBeforeConsumers) {
+  const DataflowPlan plan = DataflowPlan::Build({
+      Access({}, {{0, 8}}),
+      Access({{0, 8}}, {{8, 16}}),
+      Access({}, {{16, 24}}),
+      Access({{8, 16}, {16, 24}}, {{24, 32}}),
+  });
+  ASSERT_EQ(plan.size(), 4);
+  EXPECT_THAT(plan.successors(0), ElementsAre(1));
+  EXPECT_THAT(plan.successors(1), ElementsAre(3));
+  EXPECT_THAT(plan.successors(2), ElementsAre(3));
+  EXPECT_THAT(plan.successors(3), IsEmpty());
+  EXPECT_EQ(plan.num_predecessors(0), 0);
+  EXPECT_EQ(plan.num_predecessors(2), 0);
+  EXPECT_EQ(plan.num_predecessors(3), 2);
+}
+
+TEST(DataflowPlanTest, OrdersReuseOfArenaBytes) {
+  // Node 1 overwrites bytes node 0 still reads, as happens once the memory
+  // planner reuses a freed buffer.
+  const DataflowPlan plan = DataflowPlan::Build({
+      Access({{0, 8}}, {{8, 16}}),
+      Access({}, {{4, 12}}),
+  });
+  EXPECT_THAT(plan.successors(0), ElementsAre(1));
+}
+
+TEST(DataflowPlanTest, SharedReadsAreNotOrdered) {
+  const DataflowPlan plan = DataflowPlan::Build({
+      Access({{0, 8}}, {{8, 16}}),
+      Access({{0, 8}}, {{16, 24}}),
+  });
+  EXPECT_THAT(plan.successors(0), IsEmpty());
+  EXPECT_EQ(plan.num_predecessors(1), 0);
+}
+
+TEST(DataflowPlanTest, BarrierIsOrderedAgainstEveryNode) {
+  DataflowNodeAccess barrier;
+  barrier.barrier = true;
+  const DataflowPlan plan = DataflowPlan::Build({
+      Access({}, {{0, 8}}),
+      barrier,
+      Access({}, {{8, 16}}),
+  });
+  EXPECT_THAT(plan.successors(0), ElementsAre(1));
+  EXPECT_THAT(plan.successors(1), ElementsAre(2));
+  EXPECT_EQ(plan.num_predecessors(2), 1);
+}
+
+TEST(DataflowExecutorTest, RunsNodesAfterTheirPredecessors) {
+  const DataflowPlan plan = DataflowPlan::Build({
+      Access({}, {{0, 8}}),
+      Access({{0, 8}}, {{8, 16}}),
+      Access({}, {{16, 24}}),
+      Access({{8, 16}, {16, 24}}, {{24, 32}}),
+  });
+  DataflowExecutor executor(/*num_threads=*/3);
+  for (int run = 0; run < 10; ++run) {
+    std::mutex mutex;
+    std::vector<int> order;
+    ASSERT_EQ(executor.Run(
+                  plan,
+                  [&](int node) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    order.push_back(node);
+                    return kTfLiteOk;
+                  },
+                  Continue),
+              kTfLiteOk);
+    ASSERT_EQ(order.size(), 4);
+    auto position = [&order](int node) {
+      return std::find(order.begin(), order.end(), node) - order.begin();
+    };
+    EXPECT_LT(position(0), position(1));
+    EXPECT_LT(position(1), position(3));
+    EXPECT_LT(position(2), position(3));
+  }
+}
+
+TEST(DataflowExecutorTest, RunsIndependentNodesConcurrently) {
+  const DataflowPlan plan = DataflowPlan::Build({
+      Access({}, {{0, 8}}),
+      Access({}, {{8, 16}}),
+  });
+  DataflowExecutor executor(/*num_threads=*/2);
+  std::atomic<int> started{0};
+  // Each node waits for the other one to start, which only succeeds if both
+  // are running at the same time.
+  EXPECT_EQ(executor.Run(
+                plan,
+                [&started](int node) {
+                  ++started;
+                  const auto deadline = std::chrono::steady_clock::now() +
+                                        std::chrono::seconds(10);
+                  while (started < 2) {
+                    if (std::chrono::steady_clock::now() > deadline) {
+                      return kTfLiteError;
+                    }
+                    std::this_thread::yield();
+                  }
+                  return kTfLiteOk;
+                },
+                Continue),
+            kTfLiteOk);
+}
+
+TEST(DataflowExecutorTest, WorkersUseTheirOwnCpuBackendContext) {
+  std::vector<DataflowNodeAccess> nodes;
+  for (std::uintptr_t i = 0; i < 16; ++i) {
+    nodes.push_back(Access({}, {{8 * i, 8 * i + 8}}));
+  }
+  const DataflowPlan plan = DataflowPlan::Build(nodes);
+  DataflowExecutor executor(/*num_threads=*/4);
+  std::mutex mutex;
+  std::vector<std::pair<std::thread::id, TfLiteExternalContext*>> contexts;
+  ASSERT_EQ(executor.Run(
+                plan,
+                [&](int node) {
+                  std::lock_guard<std::mutex> lock(mutex);
+                  contexts.push_back(
+                      {std::this_thread::get_id(),
+                       DataflowExecutor::CurrentThreadCpuBackendContext()});
+                  return kTfLiteOk;
+                },
+                Continue),
+            kTfLiteOk);
+  const std::thread::id caller = std::this_thread::get_id();
+  for (const auto& [thread, context] : contexts) {
+    if (thread == caller) {
+      EXPECT_EQ(context, nullptr);
+      continue;
+    }
+    ASSERT_NE(context, nullptr);
+    EXPECT_EQ(context->type, kTfLiteCpuBackendContext);
+    for (const auto& [other_thread, other_context] : contexts) {
+      EXPECT_EQ(thread == other_thread, context == other_context);
+    }
+  }
+  EXPECT_EQ(DataflowExecutor::CurrentThreadCpuBackendContext(), nullptr);
+}
+
+TEST(DataflowExecutorTest, StopsAfterAFailure) {
+  const DataflowPlan plan = DataflowPlan::Build({
+      Access({}, {{0, 8}}),
+      Access({{0, 8}}, {{8, 16}}),
+      Access({{8, 16}}, {{16, 24}}),
+  });
+  DataflowExecutor executor(/*num_threads=*/2);
+  std::atomic<int> runs{0};
+  EXPECT_EQ(executor.Run(
+                plan,
+                [&runs](int node) {
+                  ++runs;
+                  return node == 1 ? kTfLiteError : kTfLiteOk;
+                },
+                Continue),
+            kTfLiteError);
+  EXPECT_EQ(runs, 2);
+
+  // The executor can be reused after a failed run.
+  runs = 0;
+  EXPECT_EQ(executor.Run(
+                plan,
+                [&runs](int node) {
+                  ++runs;
+                  return kTfLiteOk;
+                },
+                Continue),
+            kTfLiteOk);
+  EXPECT_EQ(runs, 3);
+}
+
+TEST(DataflowExecutorTest, StopsWhenCancelled) {
+  const DataflowPlan plan = DataflowPlan::Build({
+      Access({}, {{0, 8}}),
+      Access({{0, 8}}, {{8, 16}}),
+  });
+  DataflowExecutor executor(/*num_threads=*/2);
+  int runs = 0;
+  EXPECT_EQ(executor.Run(
+                plan,
+                [&runs](int node) {
+                  ++runs;
+                  return kTfLiteOk;
+                },
+                [&runs]() { return runs > 0 ? kTfLiteCancelled : kTfLiteOk; }),
+            kTfLiteCancelled);
+  EXPECT_EQ(runs, 1);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -685,6 +685,22 @@ class Interpreter {
   /// to the value of the buffer.
   TfLiteStatus ResetVariableTensors();
 
+  /// \warning This is an experimental API and subject to change. \n
+  /// \brief Returns the arena plans of all subgraphs, to restore with
+  /// `RestoreArenaPlanSnapshot` into later interpreters of the same model so
+  /// that their first `AllocateTensors` skips planning tensor offsets. Call it
+  /// after `AllocateTensors`. The snapshot is only meant for the same build of
+  /// TF Lite on the same device, e.g. as a cache file across process starts.
+  std::string GetArenaPlanSnapshot() const;
+
+  /// \warning This is an experimental API and subject to change. \n
+  /// \brief Restores a snapshot returned by `GetArenaPlanSnapshot`. Call it
+  /// before `AllocateTensors`. Every plan is validated against its subgraph,
+  /// and plans that don't match the tensors being allocated are never used.
+  /// Returns an error if `snapshot` isn't a snapshot of this model's
+  /// subgraphs.
+  TfLiteStatus RestoreArenaPlanSnapshot(const std::string& snapshot);
+
   /// Retrieve an operator's description of its work, for profiling purposes.
   const char* OpProfilingString(const TfLiteRegistration& op_reg,
                                 const TfLiteNode* node) const {
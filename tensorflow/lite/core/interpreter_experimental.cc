@@ -17,8 +17,10 @@ limitations under the License.
 #include <stdlib.h>
 
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -58,6 +60,65 @@ TfLiteStatus Interpreter::ResetVariableTensors() {
   return kTfLiteOk;
 }
 
+namespace {
+
+// Identifies arena plan snapshots, and their format version.
+constexpr uint32_t kArenaPlanSnapshotMagic = 0x31504154;  // "TAP1"
+
+template <typename T>
+bool ReadSnapshotValue(const char** data, const char* end, T* value) {
+  if (static_cast<size_t>(end - *data) < sizeof(T)) return false;
+  std::memcpy(value, *data, sizeof(T));
+  *data += sizeof(T);
+  return true;
+}
+
+}  // namespace
+
+std::string Interpreter::GetArenaPlanSnapshot() const {
+  std::string snapshot;
+  const uint32_t header[] = {kArenaPlanSnapshotMagic,
+                             static_cast<uint32_t>(subgraphs_.size())};
+  snapshot.append(reinterpret_cast<const char*>(header), sizeof(header));
+  for (const auto& subgraph : subgraphs_) {
+    std::string plans;
+    subgraph->SerializeMemoryPlans(&plans);
+    const uint64_t size = plans.size();
+    snapshot.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    snapshot.append(plans);
+  }
+  return snapshot;
+}
+
+TfLiteStatus Interpreter::RestoreArenaPlanSnapshot(
+    const std::string& snapshot) {
+  const char* data = snapshot.data();
+  const char* end = data + snapshot.size();
+  uint32_t magic = 0;
+  uint32_t num_subgraphs = 0;
+  if (!ReadSnapshotValue(&data, end, &magic) ||
+      magic != kArenaPlanSnapshotMagic ||
+      !ReadSnapshotValue(&data, end, &num_subgraphs) ||
+      num_subgraphs != subgraphs_.size()) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Arena plan snapshot doesn't match the model.");
+    return kTfLiteError;
+  }
+  for (auto& subgraph : subgraphs_) {
+    uint64_t size = 0;
+    if (!ReadSnapshotValue(&data, end, &size) ||
+        size > static_cast<size_t>(end - data)) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Arena plan snapshot is truncated.");
+      return kTfLiteError;
+    }
+    TF_LITE_ENSURE_STATUS(
+        subgraph->RestoreMemoryPlans(std::string(data, size)));
+    data += size;
+  }
+  return kTfLiteOk;
+}
+
 void Interpreter::SetAllowFp16PrecisionForFp32(bool allow) {
   for (auto& subgraph : subgraphs_) {
     subgraph->context()->allow_fp32_relax_to_fp16 = allow;
@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/dataflow_executor.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/remat/metadata_util.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
@@ -559,6 +560,13 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext) {
+    // Kernels run by a dataflow executor worker use the worker's context.
+    if (TfLiteExternalContext* worker_context =
+            DataflowExecutor::CurrentThreadCpuBackendContext()) {
+      return worker_context;
+    }
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -1228,6 +1236,15 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
         kDefaultTensorAlignment, subgraph_index_);
 #endif
     memory_planner_->PlanAllocations();
+    if (!pending_memory_plans_.empty()) {
+      // The plans only save planning time, so malformed ones aren't fatal.
+      if (memory_planner_->RestorePlans(pending_memory_plans_) != kTfLiteOk) {
+        TFLITE_LOG(tflite::TFLITE_LOG_WARNING,
+                   "Ignoring malformed memory plans of subgraph %d.",
+                   subgraph_index_);
+      }
+      pending_memory_plans_.clear();
+    }
   }
 
   // Prepare original execution plan if any applied delegate wants it.
@@ -1344,6 +1361,11 @@ TfLiteStatus Subgraph::Invoke() {
     ReportError("Non-persistent memory is not available.");
     return kTfLiteError;
   }
+  if (GetDataflowExecutionThreads() > 1) {
+    bool invoked = false;
+    TF_LITE_ENSURE_STATUS(InvokeDataflow(&invoked));
+    if (invoked) return kTfLiteOk;
+  }
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "Invoke");
 #ifdef TF_LITE_TENSORFLOW_PROFILER
   tensorflow::profiler::TraceMe* trace_subgraph =
@@ -1471,6 +1493,138 @@ TfLiteStatus Subgraph::Invoke() {
   return status;
 }
 
+bool Subgraph::GetDataflowNodeAccesses(
+    std::vector<DataflowNodeAccess>* accesses) {
+  accesses->clear();
+  accesses->resize(execution_plan_.size());
+  auto add_range = [this](int tensor_index,
+                          std::vector<DataflowNodeAccess::Range>* ranges) {
+    if (tensor_index == kTfLiteOptionalTensor) return true;
+    const TfLiteTensor& tensor = tensors_[tensor_index];
+    // Dynamic tensors may be reallocated while their producer runs, and
+    // buffer handles are synced by the delegate on first read.
+    if (tensor.allocation_type == kTfLiteDynamic ||
+        tensor.buffer_handle != kTfLiteNullBufferHandle) {
+      return false;
+    }
+    // Read-only constants can't conflict with anything.
+    if (tensor.allocation_type == kTfLiteMmapRo || tensor.data.raw == nullptr ||
+        tensor.bytes == 0) {
+      return true;
+    }
+    const auto begin = reinterpret_cast<std::uintptr_t>(tensor.data.raw);
+    ranges->push_back({begin, begin + tensor.bytes});
+    return true;
+  };
+  for (int i = 0; i < execution_plan_.size(); ++i) {
+    const TfLiteNode& node = nodes_and_registration_[execution_plan_[i]].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[execution_plan_[i]].second;
+    DataflowNodeAccess& access = (*accesses)[i];
+    // Control flow runs other subgraphs and custom ops may keep state that
+    // isn't visible in their tensors.
+    access.barrier = registration.builtin_code == kTfLiteBuiltinCustom ||
+                     registration.builtin_code == kTfLiteBuiltinWhile ||
+                     registration.builtin_code == kTfLiteBuiltinIf ||
+                     registration.builtin_code == kTfLiteBuiltinCallOnce;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      // Resource and variant tensors refer to state shared across nodes.
+      if (tensor.type == kTfLiteResource || tensor.type == kTfLiteVariant) {
+        access.barrier = true;
+      }
+      // Stateful kernels update variable inputs in place.
+      if (!add_range(tensor_index,
+                     tensor.is_variable ? &access.writes : &access.reads)) {
+        return false;
+      }
+    }
+    for (const TfLiteIntArray* tensors :
+         {node.outputs, node.temporaries, node.intermediates}) {
+      if (tensors == nullptr) continue;
+      for (int tensor_index : TfLiteIntArrayView(tensors)) {
+        if (tensor_index != kTfLiteOptionalTensor &&
+            (tensors_[tensor_index].type == kTfLiteResource ||
+             tensors_[tensor_index].type == kTfLiteVariant)) {
+          access.barrier = true;
+        }
+        if (!add_range(tensor_index, &access.writes)) return false;
+      }
+    }
+  }
+  return true;
+}
+
+TfLiteStatus Subgraph::InvokeDataflow(bool* invoked) {
+  *invoked = false;
+  if (profiler_ || ShouldOptimizeMemoryForLargeTensors() ||
+      ShouldReleaseDynamicTensors() ||
+      (control_edges_ && !control_edges_->empty())) {
+    return kTfLiteOk;
+  }
+  if (next_execution_plan_index_to_prepare_ == 0) {
+    TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
+  }
+  // Ops with dynamic outputs stop preparation; the sequential path prepares
+  // the rest once those outputs are known.
+  if (next_execution_plan_index_to_prepare_ < execution_plan_.size() ||
+      has_dynamic_tensors_) {
+    return kTfLiteOk;
+  }
+
+  std::vector<DataflowNodeAccess> accesses;
+  if (!GetDataflowNodeAccesses(&accesses)) return kTfLiteOk;
+  if (accesses != dataflow_accesses_ ||
+      dataflow_plan_.size() != execution_plan_.size()) {
+    dataflow_plan_ = DataflowPlan::Build(accesses);
+    dataflow_accesses_ = std::move(accesses);
+  }
+  const int num_threads = GetDataflowExecutionThreads();
+  if (!dataflow_executor_ || dataflow_executor_->num_threads() != num_threads) {
+    dataflow_executor_ = std::make_unique<DataflowExecutor>(num_threads);
+  }
+
+  // Kernels may add tensors while running; make room for them upfront since
+  // growing `tensors_` would move tensors other nodes are using.
+  EnsureTensorsVectorCapacity();
+  auto run_node = [this](int execution_plan_index) {
+    const int node_index = execution_plan_[execution_plan_index];
+    TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[node_index].second;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      if (tensor.data.raw == nullptr && tensor.bytes > 0 &&
+          registration.builtin_code != kTfLiteBuiltinReshape) {
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+    if (TfLiteStatus s = OpInvoke(registration, &node); s != kTfLiteOk) {
+      TfLiteStatus err = ReportOpError(&context_, node, registration,
+                                       node_index, "failed to invoke");
+      return s == kTfLiteCancelled ? s : err;
+    }
+    return kTfLiteOk;
+  };
+  auto should_stop = [this]() {
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+    if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteCancelled;
+    }
+    return kTfLiteOk;
+  };
+  *invoked = true;
+  return dataflow_executor_->Run(dataflow_plan_, run_node, should_stop);
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -2083,6 +2237,30 @@ void Subgraph::GetMemoryAllocInfo(SubgraphAllocInfo* alloc_info) const {
   }
 }
 
+void Subgraph::GetMemoryPlannerAllocations(
+    std::vector<MemoryPlannerAllocation>* allocations) const {
+  allocations->clear();
+  if (memory_planner_ == nullptr) return;
+  memory_planner_->GetAllocations(allocations);
+}
+
+void Subgraph::SerializeMemoryPlans(std::string* plans) const {
+  if (memory_planner_ == nullptr) return;
+  memory_planner_->SerializePlans(plans);
+}
+
+TfLiteStatus Subgraph::RestoreMemoryPlans(const std::string& plans) {
+  if (memory_planner_ == nullptr) {
+    pending_memory_plans_ = plans;
+    return kTfLiteOk;
+  }
+  if (memory_planner_->RestorePlans(plans) != kTfLiteOk) {
+    ReportError("Malformed memory plans for subgraph %d.", subgraph_index_);
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
 std::unique_ptr<GraphInfo> Subgraph::CreateGraphInfo() {
   return std::unique_ptr<GraphInfo>(new InterpreterInfo(this));
 }
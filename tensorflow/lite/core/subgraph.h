@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/dataflow_executor.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
@@ -399,6 +400,25 @@ class Subgraph {
   // Returns memory allocation status.
   void GetMemoryAllocInfo(SubgraphAllocInfo* alloc_info) const;
 
+  // WARNING: This is an experimental API and subject to change.
+  // Returns where the memory planner placed each arena-allocated tensor and
+  // the range of execution plan indices it is live for. Empty before
+  // `AllocateTensors`.
+  void GetMemoryPlannerAllocations(
+      std::vector<MemoryPlannerAllocation>* allocations) const;
+
+  // WARNING: This is an experimental API and subject to change.
+  // Appends the arena plans the memory planner keeps for reuse to `plans`.
+  // Nothing is appended before `AllocateTensors`.
+  void SerializeMemoryPlans(std::string* plans) const;
+
+  // WARNING: This is an experimental API and subject to change.
+  // Restores plans appended by `SerializeMemoryPlans` of a subgraph of the
+  // same model, so that `AllocateTensors` skips planning the tensor offsets
+  // when the tensor sizes match. Plans restored before the first
+  // `AllocateTensors` are validated by it, and ignored if malformed.
+  TfLiteStatus RestoreMemoryPlans(const std::string& plans);
+
   // WARNING: This is an experimental API and subject to change.
   // Set the given `InterpreterOptions` object.
   void SetOptions(InterpreterOptions* options) { options_ = options; }
@@ -445,6 +465,13 @@ class Subgraph {
     return (options_ && options_->GetDisableDelegateClustering());
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Number of threads `Invoke` may run independent nodes on, see
+  // `InterpreterOptions::SetDataflowExecutionThreads`.
+  int GetDataflowExecutionThreads() const {
+    return options_ ? options_->GetDataflowExecutionThreads() : 0;
+  }
+
  private:
 #ifndef DOXYGEN_SKIP
   friend class InterpreterBuilder;
@@ -714,6 +741,15 @@ class Subgraph {
   // Returns true if the subgraph has been fully delegated.
   bool IsFullyDelegated() const;
 
+  // Runs the execution plan with `dataflow_executor_` if the graph allows it,
+  // setting `invoked` accordingly. Leaves `invoked` false, without running
+  // any node, when the graph must be run sequentially.
+  TfLiteStatus InvokeDataflow(bool* invoked);
+
+  // Fills `accesses` with the memory every node of the execution plan touches.
+  // Returns false if some node's accesses can't be known ahead of running it.
+  bool GetDataflowNodeAccesses(std::vector<DataflowNodeAccess>* accesses);
+
   // Cleanups up data reserved for the given node. Does not remove the {node,
   // registration} pair from nodes_and_registrations_.
   void CleanupNode(int node_index);
@@ -873,6 +909,15 @@ class Subgraph {
   std::vector<TfLiteDelegateParams> partitioning_preview_cache_;
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
+  // Plans passed to `RestoreMemoryPlans` before `memory_planner_` is created.
+  std::string pending_memory_plans_;
+
+  // Runs nodes concurrently when `GetDataflowExecutionThreads` is above 1.
+  // `dataflow_plan_` was built from `dataflow_accesses_` and is rebuilt
+  // whenever the execution plan or the tensor buffers change.
+  std::unique_ptr<DataflowExecutor> dataflow_executor_;
+  std::vector<DataflowNodeAccess> dataflow_accesses_;
+  DataflowPlan dataflow_plan_;
 
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
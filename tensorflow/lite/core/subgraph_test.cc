@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/lite/core/subgraph.h"
 
 #include <algorithm>
+#include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -71,5 +73,41 @@ TEST(RemoveUnusedInputs, BypassInputsWithoutOp) {
   ASSERT_EQ(subgraph.inputs(), std::vector<int>({0, -1, 2}));
 }
 
+TEST(DataflowExecution, RunsIndependentBranches) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetDataflowExecutionThreads(2);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  ASSERT_EQ(interpreter.AddTensors(6), kTfLiteOk);
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {4}, TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  ASSERT_EQ(interpreter.SetInputs({0, 1}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({4, 5}), kTfLiteOk);
+  // Two towers of two NEG ops each, which only meet at the outputs.
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  for (const auto& [input, output] :
+       std::vector<std::pair<int, int>>{{0, 2}, {1, 3}, {2, 4}, {3, 5}}) {
+    ASSERT_EQ(interpreter.AddNodeWithParameters({input}, {output}, nullptr, 0,
+                                                nullptr, neg_op),
+              kTfLiteOk);
+  }
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  for (int run = 0; run < 3; ++run) {
+    for (int i = 0; i < 4; ++i) {
+      interpreter.typed_tensor<float>(0)[i] = run + i;
+      interpreter.typed_tensor<float>(1)[i] = -run - i;
+    }
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(interpreter.typed_tensor<float>(4)[i], run + i);
+      EXPECT_EQ(interpreter.typed_tensor<float>(5)[i], -run - i);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace tflite
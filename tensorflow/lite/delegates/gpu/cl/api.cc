@@ -689,6 +689,9 @@ class InferenceBuilderImpl : public InferenceBuilder {
     context_ = std::make_unique<InferenceContext>();
     CreateGpuModelInfo create_info = GetCreateInfo(*environment_, options);
     RETURN_IF_ERROR(context_->InitFromGraph(create_info, graph, environment_));
+    if (env_options.shared_buffer_pool) {
+      RETURN_IF_ERROR(env_options.shared_buffer_pool->Add(context_.get()));
+    }
 
 #ifdef CL_DELEGATE_ALLOW_GL
     if (env_options.IsGlAware() &&
@@ -713,6 +716,9 @@ class InferenceBuilderImpl : public InferenceBuilder {
     context_ = std::make_unique<InferenceContext>();
     RETURN_IF_ERROR(
         context_->RestoreDeserialized(serialized_model, environment_));
+    if (env_options.shared_buffer_pool) {
+      RETURN_IF_ERROR(env_options.shared_buffer_pool->Add(context_.get()));
+    }
 
 #ifdef CL_DELEGATE_ALLOW_GL
     if (env_options.IsGlAware() &&
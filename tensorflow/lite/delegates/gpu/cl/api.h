@@ -53,6 +53,8 @@ namespace tflite {
 namespace gpu {
 namespace cl {
 
+class SharedBufferPool;
+
 struct InferenceOptions : public tflite::gpu::InferenceOptions {};
 
 // Indicates environment
@@ -129,6 +131,12 @@ struct InferenceEnvironmentOptions {
   // incompatible when GPU driver is updated.
   absl::Span<const uint8_t> serialized_binary_cache;
 
+  // If set, the intermediate tensors of the models built in this environment
+  // are held in the pool, which is shared with the other environments using
+  // it. Models sharing a pool must not run concurrently, and the environments
+  // must use the OpenCL context and command queue the pool was created for.
+  SharedBufferPool* shared_buffer_pool = nullptr;
+
   bool IsGlAware() const {
     return egl_context != EGL_NO_CONTEXT && egl_display != EGL_NO_DISPLAY;
   }
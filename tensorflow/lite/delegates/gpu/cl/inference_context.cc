@@ -217,8 +217,35 @@ absl::Status GetBufferAsignment(
   return absl::OkStatus();
 }
 
+absl::Status CreateSharedBufferTensor(const CLContext& context,
+                                      const GpuInfo& gpu_info, cl_mem memory,
+                                      const TensorDescriptor& tensor_desc,
+                                      Tensor* result) {
+  if (tensor_desc.GetStorageType() == TensorStorageType::TEXTURE_2D ||
+      tensor_desc.GetStorageType() == TensorStorageType::SINGLE_TEXTURE_2D) {
+    const size_t bytes_per_pixel =
+        SizeOf(tensor_desc.GetDataType()) *
+        (tensor_desc.GetStorageType() == TensorStorageType::TEXTURE_2D
+             ? 4
+             : tensor_desc.GetBHWCShape().c);
+    size_t width_pixel_alignment = gpu_info.opencl_info.image_pitch_alignment;
+    if (gpu_info.IsAdreno() && width_pixel_alignment % bytes_per_pixel == 0) {
+      width_pixel_alignment /= bytes_per_pixel;
+    }
+    return CreateTensorSharedImage2DBuffer(context, memory, tensor_desc,
+                                           width_pixel_alignment, result);
+  }
+  return CreateTensorShared(context, memory, tensor_desc, result);
+}
+
 }  // namespace
 
+InferenceContext::~InferenceContext() {
+  if (shared_buffer_pool_) {
+    shared_buffer_pool_->Remove(this);
+  }
+}
+
 void InferenceContext::ExecutionHints::Init(const GpuInfo& gpu_info) {
   if (gpu_info.IsMali()) {
     need_flush = true;
@@ -510,6 +537,8 @@ absl::Status InferenceContext::AllocateBufferBasedTensors(
       return absl::FailedPreconditionError(
           "Externally provided buffer not big enough.");
     }
+    shared_buffers_parent_size_ = offset_assignment.total_size;
+    shared_buffers_offsets_ = offset_assignment.offsets;
     shared_buffers_.resize(offset_assignment.offsets.size());
     for (int i = 0; i < offset_assignment.offsets.size(); ++i) {
       RETURN_IF_ERROR(CreateReadWriteSubBuffer(
@@ -533,6 +562,7 @@ absl::Status InferenceContext::AllocateBufferBasedTensors(
             "Externally provided buffer not big enough.");
       }
 
+      shared_buffers_parent_size_ = total_size;
       shared_buffers_.resize(buffer_assignment.object_sizes.size());
       size_t offset = 0;
       for (int i = 0; i < buffer_assignment.object_sizes.size(); ++i) {
@@ -541,6 +571,7 @@ absl::Status InferenceContext::AllocateBufferBasedTensors(
         RETURN_IF_ERROR(CreateReadWriteSubBuffer(*shared_buffers_parent_ptr_,
                                                  offset, aligned_size, context,
                                                  &shared_buffers_[i]));
+        shared_buffers_offsets_.push_back(offset);
         offset += aligned_size;
       }
     } else {
@@ -554,6 +585,7 @@ absl::Status InferenceContext::AllocateBufferBasedTensors(
 
   std::vector<bool> created_tensors(buffer_usage_records.size(), false);
   shared_buffer_tensors_.resize(buffer_usage_records.size());
+  shared_buffer_tensors_buffer_ids_.resize(buffer_usage_records.size());
   for (auto& node : gpu_model.nodes) {
     std::vector<ValueId> node_tensor_ids = node.inputs;
     node_tensor_ids.insert(node_tensor_ids.end(), node.outputs.begin(),
@@ -572,28 +604,10 @@ absl::Status InferenceContext::AllocateBufferBasedTensors(
       const int buffer_index = use_offset_assignment
                                    ? tensor_index
                                    : buffer_assignment.object_ids[tensor_index];
-      if (tensor_desc.GetStorageType() == TensorStorageType::TEXTURE_2D ||
-          tensor_desc.GetStorageType() ==
-              TensorStorageType::SINGLE_TEXTURE_2D) {
-        const size_t bytes_per_pixel =
-            SizeOf(tensor_desc.GetDataType()) *
-            (tensor_desc.GetStorageType() == TensorStorageType::TEXTURE_2D
-                 ? 4
-                 : tensor_desc.GetBHWCShape().c);
-        size_t width_pixel_alignment =
-            gpu_info.opencl_info.image_pitch_alignment;
-        if (gpu_info.IsAdreno() &&
-            width_pixel_alignment % bytes_per_pixel == 0) {
-          width_pixel_alignment /= bytes_per_pixel;
-        }
-        RETURN_IF_ERROR(CreateTensorSharedImage2DBuffer(
-            *context, shared_buffers_[buffer_index].GetMemoryPtr(), tensor_desc,
-            width_pixel_alignment, &shared_buffer_tensors_[tensor_index]));
-      } else {
-        RETURN_IF_ERROR(CreateTensorShared(
-            *context, shared_buffers_[buffer_index].GetMemoryPtr(), tensor_desc,
-            &shared_buffer_tensors_[tensor_index]));
-      }
+      RETURN_IF_ERROR(CreateSharedBufferTensor(
+          *context, gpu_info, shared_buffers_[buffer_index].GetMemoryPtr(),
+          tensor_desc, &shared_buffer_tensors_[tensor_index]));
+      shared_buffer_tensors_buffer_ids_[tensor_index] = buffer_index;
       created_tensors[tensor_index] = true;
     }
   }
@@ -746,6 +760,58 @@ absl::Status InferenceContext::SetTensor(const ValueId& tensor_id,
   return absl::OkStatus();
 }
 
+absl::Status InferenceContext::SetSharedBuffer(Buffer* shared_buffer,
+                                               Environment* env) {
+  if (shared_buffers_parent_size_ == 0) {
+    return absl::FailedPreconditionError(
+        "Intermediate tensors are not allocated in a single buffer.");
+  }
+  if (shared_buffer->GetMemorySizeInBytes() < shared_buffers_parent_size_) {
+    return absl::FailedPreconditionError(
+        "Externally provided buffer not big enough.");
+  }
+  for (int i = 0; i < shared_buffers_.size(); ++i) {
+    Buffer sub_buffer;
+    RETURN_IF_ERROR(CreateReadWriteSubBuffer(
+        *shared_buffer, shared_buffers_offsets_[i],
+        shared_buffers_[i].GetMemorySizeInBytes(), &env->context(),
+        &sub_buffer));
+    shared_buffers_[i] = std::move(sub_buffer);
+  }
+  for (int i = 0; i < shared_buffer_tensors_.size(); ++i) {
+    const TensorDescriptor tensor_desc =
+        shared_buffer_tensors_[i].GetDescriptor();
+    const int buffer_index = shared_buffer_tensors_buffer_ids_[i];
+    RETURN_IF_ERROR(CreateSharedBufferTensor(
+        env->context(), env->device().GetInfo(),
+        shared_buffers_[buffer_index].GetMemoryPtr(), tensor_desc,
+        &shared_buffer_tensors_[i]));
+  }
+  for (auto& node : nodes_) {
+    for (int i = 0; i < node.inputs.size(); ++i) {
+      auto it = graph_ids_to_shared_buffer_tensors_.find(node.inputs[i]);
+      if (it != graph_ids_to_shared_buffer_tensors_.end()) {
+        RETURN_IF_ERROR(node.cl_operation.SetSrcTensor(
+            i, &shared_buffer_tensors_[it->second]));
+      }
+    }
+    for (int i = 0; i < node.outputs.size(); ++i) {
+      auto it = graph_ids_to_shared_buffer_tensors_.find(node.outputs[i]);
+      if (it != graph_ids_to_shared_buffer_tensors_.end()) {
+        RETURN_IF_ERROR(node.cl_operation.SetDstTensor(
+            i, &shared_buffer_tensors_[it->second]));
+      }
+    }
+  }
+  // The previous parent buffer is released once no sub-buffer refers to it.
+  shared_buffers_parent_.reset();
+  shared_buffers_parent_ptr_ = shared_buffer;
+  if (recordable_queue_) {
+    InitRecordableQueue(env);
+  }
+  return absl::OkStatus();
+}
+
 void InferenceContext::PrepareExternal() {
   for (auto& external : external_mutable_tensors_) {
     for (int i = 0; i < nodes_.size(); ++i) {
@@ -1042,6 +1108,41 @@ absl::Status GetTotalBufferSizeForTensors(const GpuModel& gpu_model,
   return absl::OkStatus();
 }
 
+SharedBufferPool::~SharedBufferPool() {
+  // Sub-buffers keep their parent buffer alive, so the contexts stay usable.
+  for (InferenceContext* context : contexts_) {
+    context->shared_buffer_pool_ = nullptr;
+  }
+}
+
+absl::Status SharedBufferPool::Add(InferenceContext* context) {
+  const uint64_t size = context->GetSharedBufferSize();
+  if (size == 0) {
+    return absl::OkStatus();
+  }
+  if (!buffer_ || buffer_->GetMemorySizeInBytes() < size) {
+    Buffer buffer;
+    RETURN_IF_ERROR(CreateReadWriteBuffer(size, &env_->context(), &buffer));
+    auto new_buffer = std::make_unique<Buffer>(std::move(buffer));
+    for (InferenceContext* added_context : contexts_) {
+      RETURN_IF_ERROR(added_context->SetSharedBuffer(new_buffer.get(), env_));
+    }
+    buffer_ = std::move(new_buffer);
+  }
+  RETURN_IF_ERROR(context->SetSharedBuffer(buffer_.get(), env_));
+  context->shared_buffer_pool_ = this;
+  contexts_.push_back(context);
+  return absl::OkStatus();
+}
+
+void SharedBufferPool::Remove(InferenceContext* context) {
+  contexts_.erase(std::remove(contexts_.begin(), contexts_.end(), context),
+                  contexts_.end());
+  if (contexts_.empty()) {
+    buffer_.reset();
+  }
+}
+
 }  // namespace cl
 }  // namespace gpu
 }  // namespace tflite
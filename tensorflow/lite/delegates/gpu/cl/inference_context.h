@@ -63,8 +63,13 @@ struct CLNode {
 
 enum class TensorType { kVariable, kConst, kExternal, kRuntime };
 
+class SharedBufferPool;
+
 class InferenceContext {
  public:
+  InferenceContext() = default;
+  ~InferenceContext();
+
   absl::Status InitFromGraph(const CreateGpuModelInfo& create_info,
                              const GraphFloat32& graph, Environment* env,
                              std::vector<uint8_t>* serialized_model = nullptr);
@@ -110,7 +115,18 @@ class InferenceContext {
   // Must be called after initialization and before execution
   absl::Status SetTensor(const ValueId& tensor_id, Tensor* tensor_ptr);
 
+  // Size of the buffer the intermediate tensors are sub-buffers of, or 0 if
+  // they are not allocated in a single buffer.
+  uint64_t GetSharedBufferSize() const { return shared_buffers_parent_size_; }
+
+  // Moves the intermediate tensors into `shared_buffer`, which must be created
+  // in the context of `env` and hold at least GetSharedBufferSize() bytes.
+  // Must be called after initialization and not during execution.
+  absl::Status SetSharedBuffer(Buffer* shared_buffer, Environment* env);
+
  private:
+  friend class SharedBufferPool;
+
   flatbuffers::Offset<data::InferenceContext> Encode(
       const CLDevice& device, const ProgramCache& program_cache,
       flatbuffers::Offset<tflite::gpu::data::GpuModel> gpu_model_fb,
@@ -184,10 +200,16 @@ class InferenceContext {
 
   std::unique_ptr<Buffer> shared_buffers_parent_;
   Buffer* shared_buffers_parent_ptr_ = nullptr;
+  uint64_t shared_buffers_parent_size_ = 0;
+  // Offsets of shared_buffers_ in the parent buffer, if they have one.
+  std::vector<size_t> shared_buffers_offsets_;
   std::vector<Buffer> shared_buffers_;
   std::vector<Tensor>
       shared_buffer_tensors_;  // use references to memory from shared_buffers_
+  // Index in shared_buffers_ of every tensor of shared_buffer_tensors_.
+  std::vector<int> shared_buffer_tensors_buffer_ids_;
   std::map<ValueId, int> graph_ids_to_shared_buffer_tensors_;
+  SharedBufferPool* shared_buffer_pool_ = nullptr;
 
   std::map<ValueId, Tensor> strong_shape_tensors_;
   std::map<ValueId, ValueId> graph_ids_to_strong_shape_tensors_;
@@ -209,6 +231,39 @@ absl::Status GetTotalBufferSizeForTensors(const GpuModel& gpu_model,
                                           const GpuInfo& gpu_info,
                                           uint64_t* result);
 
+// Holds the intermediate tensors of inference contexts that are run one after
+// another, never concurrently, in a single buffer. The buffer is as large as
+// the largest of the contexts needs instead of the sum of them; when a larger
+// context is added, the buffer grows and the contexts added before are moved
+// into it.
+class SharedBufferPool {
+ public:
+  // `env` must share the OpenCL context and queue of the inference contexts.
+  explicit SharedBufferPool(Environment* env) : env_(env) {}
+  ~SharedBufferPool();
+
+  SharedBufferPool(const SharedBufferPool&) = delete;
+  SharedBufferPool& operator=(const SharedBufferPool&) = delete;
+
+  // Moves the intermediate tensors of an initialized `context` into the pool.
+  // Contexts that do not allocate them in a single buffer are left as is.
+  absl::Status Add(InferenceContext* context);
+
+  uint64_t GetSizeInBytes() const {
+    return buffer_ ? buffer_->GetMemorySizeInBytes() : 0;
+  }
+
+ private:
+  friend class InferenceContext;
+
+  // Called by the context when it is destroyed.
+  void Remove(InferenceContext* context);
+
+  Environment* env_;
+  std::unique_ptr<Buffer> buffer_;
+  std::vector<InferenceContext*> contexts_;
+};
+
 }  // namespace cl
 }  // namespace gpu
 }  // namespace tflite
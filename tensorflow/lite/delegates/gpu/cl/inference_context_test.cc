@@ -0,0 +1,169 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/cl/inference_context.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/delegates/gpu/cl/cl_test.h"
+#include "tensorflow/lite/delegates/gpu/common/gpu_model.h"
+#include "tensorflow/lite/delegates/gpu/common/model.h"
+#include "tensorflow/lite/delegates/gpu/common/operations.h"
+#include "tensorflow/lite/delegates/gpu/common/precision.h"
+#include "tensorflow/lite/delegates/gpu/common/shape.h"
+#include "tensorflow/lite/delegates/gpu/common/status.h"
+#include "tensorflow/lite/delegates/gpu/common/tensor.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+constexpr int kChannels = 4;
+
+// Builds a graph of two 2x2 max poolings of a `size` x `size` input, so that
+// the output of the first one is an intermediate tensor.
+absl::Status BuildPoolingGraph(int size, GraphFloat32* graph) {
+  Pooling2DAttributes attr;
+  attr.type = PoolingType::MAX;
+  attr.kernel = HW(2, 2);
+  attr.strides = HW(2, 2);
+  attr.padding.prepended = HW(0, 0);
+  attr.padding.appended = HW(0, 0);
+
+  Value* input = graph->NewValue();
+  input->tensor.type = DataType::FLOAT32;
+  input->tensor.shape = BHWC(1, size, size, kChannels);
+  Node* first = graph->NewNode();
+  first->operation.type = ToString(OperationType::POOLING_2D);
+  first->operation.attributes = attr;
+  RETURN_IF_ERROR(graph->AddConsumer(first->id, input->id));
+  Node* second = graph->NewNode();
+  second->operation.type = ToString(OperationType::POOLING_2D);
+  second->operation.attributes = attr;
+  Value* intermediate = nullptr;
+  RETURN_IF_ERROR(ConnectTwoNodes(graph, first, second, &intermediate));
+  intermediate->tensor.type = DataType::FLOAT32;
+  intermediate->tensor.shape = BHWC(1, size / 2, size / 2, kChannels);
+  Value* output = nullptr;
+  RETURN_IF_ERROR(AddOutput(graph, second, &output));
+  output->tensor.type = DataType::FLOAT32;
+  output->tensor.shape = BHWC(1, size / 4, size / 4, kChannels);
+  return absl::OkStatus();
+}
+
+class PoolingModel {
+ public:
+  explicit PoolingModel(int size) : size_(size) {}
+
+  absl::Status Init(Environment* env) {
+    RETURN_IF_ERROR(BuildPoolingGraph(size_, &graph_));
+    CreateGpuModelInfo create_info;
+    create_info.precision = CalculationsPrecision::F32;
+    create_info.storage_type = TensorStorageType::BUFFER;
+    return context_.InitFromGraph(create_info, graph_, env);
+  }
+
+  // Runs the model on an input holding its own element indices, and checks
+  // that every output element is the largest of its 4x4 input window.
+  void RunAndCheck(Environment* env) {
+    TensorFloat32 input;
+    input.id = graph_.inputs()[0]->id;
+    input.shape = BHWC(1, size_, size_, kChannels);
+    input.data.resize(input.shape.DimensionsProduct());
+    for (int i = 0; i < input.data.size(); ++i) {
+      input.data[i] = i;
+    }
+    ASSERT_OK(context_.SetInputTensor(input.id, input, env->queue()));
+    ASSERT_OK(context_.AddToQueue(env->queue()));
+    TensorFloat32 output;
+    ASSERT_OK(context_.GetOutputTensor(graph_.outputs()[0]->id, env->queue(),
+                                       &output));
+    const int output_size = size_ / 4;
+    ASSERT_EQ(output.data.size(),
+              static_cast<size_t>(output_size * output_size * kChannels));
+    for (int y = 0; y < output_size; ++y) {
+      for (int x = 0; x < output_size; ++x) {
+        for (int c = 0; c < kChannels; ++c) {
+          const int index = (y * output_size + x) * kChannels + c;
+          EXPECT_EQ(output.data[index],
+                    static_cast<float>(
+                        ((y * 4 + 3) * size_ + x * 4 + 3) * kChannels + c))
+              << "size " << size_ << ", element " << index;
+        }
+      }
+    }
+  }
+
+  InferenceContext* context() { return &context_; }
+
+ private:
+  const int size_;
+  GraphFloat32 graph_;
+  InferenceContext context_;
+};
+
+TEST_F(OpenCLTest, SharedBufferPoolGrowsToLargestContext) {
+  PoolingModel small_model(/*size=*/8);
+  ASSERT_OK(small_model.Init(&env_));
+  const uint64_t small_size = small_model.context()->GetSharedBufferSize();
+  if (small_size == 0) {
+    GTEST_SKIP() << "Intermediate tensors are not in a single buffer.";
+  }
+  auto large_model = std::make_unique<PoolingModel>(/*size=*/32);
+  ASSERT_OK(large_model->Init(&env_));
+  const uint64_t large_size = large_model->context()->GetSharedBufferSize();
+  ASSERT_GT(large_size, small_size);
+
+  SharedBufferPool pool(&env_);
+  ASSERT_OK(pool.Add(small_model.context()));
+  EXPECT_EQ(pool.GetSizeInBytes(), small_size);
+  small_model.RunAndCheck(&env_);
+
+  // The small context is moved into the grown buffer, which is not the sum
+  // of both.
+  ASSERT_OK(pool.Add(large_model->context()));
+  EXPECT_EQ(pool.GetSizeInBytes(), large_size);
+  large_model->RunAndCheck(&env_);
+  small_model.RunAndCheck(&env_);
+  large_model->RunAndCheck(&env_);
+
+  // A destroyed context leaves the pool, which keeps its buffer for the
+  // others.
+  large_model.reset();
+  small_model.RunAndCheck(&env_);
+  EXPECT_EQ(pool.GetSizeInBytes(), large_size);
+}
+
+TEST_F(OpenCLTest, SharedBufferPoolOutlivedByContext) {
+  PoolingModel model(/*size=*/16);
+  ASSERT_OK(model.Init(&env_));
+  if (model.context()->GetSharedBufferSize() == 0) {
+    GTEST_SKIP() << "Intermediate tensors are not in a single buffer.";
+  }
+  {
+    SharedBufferPool pool(&env_);
+    ASSERT_OK(pool.Add(model.context()));
+  }
+  // The sub-buffers keep the buffer of the destroyed pool alive.
+  model.RunAndCheck(&env_);
+}
+
+}  // namespace
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
@@ -22,6 +22,7 @@ limitations under the License.
 #include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/types/span.h"
@@ -29,6 +30,9 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/delegates/gpu/api.h"
 #include "tensorflow/lite/delegates/gpu/cl/api.h"
+#include "tensorflow/lite/delegates/gpu/cl/buffer.h"
+#include "tensorflow/lite/delegates/gpu/cl/environment.h"
+#include "tensorflow/lite/delegates/gpu/cl/inference_context.h"
 #include "tensorflow/lite/delegates/gpu/cl/util.h"
 #include "tensorflow/lite/delegates/gpu/common/model_builder.h"
 #include "tensorflow/lite/delegates/gpu/common/model_builder_helper.h"
@@ -77,8 +81,52 @@ InferenceUsage ToUsage(int32_t usage) {
   return InferenceUsage::UNKNOWN;
 }
 
+// Returns the float tensors that are produced by a node in `nodes` and
+// consumed by another one.
+absl::flat_hash_set<int> GetTensorsBetweenNodes(TfLiteContext* context,
+                                                const TfLiteIntArray* nodes) {
+  absl::flat_hash_set<int> produced_tensors;
+  absl::flat_hash_set<int> tensors;
+  for (int i = 0; i < nodes->size; ++i) {
+    TfLiteNode* node;
+    TfLiteRegistration* registration;
+    if (context->GetNodeAndRegistration(context, nodes->data[i], &node,
+                                        &registration) != kTfLiteOk) {
+      continue;
+    }
+    for (int j = 0; j < node->outputs->size; ++j) {
+      produced_tensors.insert(node->outputs->data[j]);
+    }
+  }
+  for (int i = 0; i < nodes->size; ++i) {
+    TfLiteNode* node;
+    TfLiteRegistration* registration;
+    if (context->GetNodeAndRegistration(context, nodes->data[i], &node,
+                                        &registration) != kTfLiteOk) {
+      continue;
+    }
+    for (int j = 0; j < node->inputs->size; ++j) {
+      const int tensor_index = node->inputs->data[j];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = context->tensors[tensor_index];
+      if (produced_tensors.contains(tensor_index) &&
+          tensor.type == kTfLiteFloat32 && !tensor.is_variable) {
+        tensors.insert(tensor_index);
+      }
+    }
+  }
+  return tensors;
+}
+
 // Forward declarations.
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate);
+TfLiteStatus DelegateCopyFromBufferHandle(TfLiteContext* context,
+                                          TfLiteDelegate* delegate,
+                                          TfLiteBufferHandle buffer_handle,
+                                          TfLiteTensor* tensor);
+void DelegateFreeBufferHandle(TfLiteContext* context,
+                              TfLiteDelegate* delegate,
+                              TfLiteBufferHandle* handle);
 
 class Delegate {
  public:
@@ -94,18 +142,32 @@ class Delegate {
     if (options_.max_delegated_partitions <= 0) {
       options_.max_delegated_partitions = 1;
     }
-    if (options_.experimental_flags &
-            TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION &&
-        options_.model_token && options_.serialization_dir) {
-      SerializationParams params;
-      params.model_token = options_.model_token;
-      params.cache_dir = options_.serialization_dir;
-      serialization_ = std::make_unique<Serialization>(params);
+    if (SharesPartitionTensors()) {
+      delegate_.CopyFromBufferHandle = DelegateCopyFromBufferHandle;
+      delegate_.FreeBufferHandle = DelegateFreeBufferHandle;
+    }
+    // Without a model token, serialization is initialized once the model is
+    // known in DelegatePrepare.
+    if (IsSerializationEnabled() && options_.model_token) {
+      InitializeSerialization(options_.model_token);
     }
   }
 
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
   Serialization* serialization() { return serialization_.get(); }
+
+  bool IsSerializationEnabled() const {
+    return (options_.experimental_flags &
+            TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION) &&
+           options_.serialization_dir;
+  }
+  void InitializeSerialization(const std::string& model_token) {
+    SerializationParams params;
+    params.model_token = model_token.c_str();
+    params.cache_dir = options_.serialization_dir;
+    params.max_cache_bytes = options_.serialization_max_cache_bytes;
+    serialization_ = std::make_unique<Serialization>(params);
+  }
   const TfLiteGpuDelegateOptionsV2& options() const { return options_; }
 
   bool IsQuantOpsAllowed() const {
@@ -117,6 +179,91 @@ class Delegate {
   }
   int num_delegate_kernels() const { return num_delegate_kernels_; }
 
+  bool SharesPartitionTensors() const {
+    return options_.experimental_flags &
+           TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_PARTITION_TENSORS;
+  }
+  bool SharesIntermediateMemory() const {
+    return options_.experimental_flags &
+           TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_INTERMEDIATE_MEMORY;
+  }
+  // Creates the OpenCL environment that the partitions share, and the pool of
+  // their intermediate tensors if they share it too.
+  absl::Status InitializeSharedClEnvironment() {
+    if (!shared_cl_environment_) {
+      auto environment = std::make_unique<cl::Environment>();
+      RETURN_IF_ERROR(cl::CreateEnvironment(environment.get()));
+      shared_cl_environment_ = std::move(environment);
+    }
+    if (SharesIntermediateMemory() && !shared_buffer_pool_) {
+      shared_buffer_pool_ =
+          std::make_unique<cl::SharedBufferPool>(shared_cl_environment_.get());
+    }
+    return absl::OkStatus();
+  }
+  // Picks the tensors between the `nodes` to be delegated that are kept in
+  // the shared OpenCL environment.
+  absl::Status InitializeSharedTensors(TfLiteContext* context,
+                                       const TfLiteIntArray* nodes) {
+    shared_tensors_.clear();
+    RETURN_IF_ERROR(InitializeSharedClEnvironment());
+    shared_tensors_ = GetTensorsBetweenNodes(context, nodes);
+    return absl::OkStatus();
+  }
+  cl::Environment* shared_cl_environment() {
+    return shared_cl_environment_.get();
+  }
+  cl::SharedBufferPool* shared_buffer_pool() {
+    return shared_buffer_pool_.get();
+  }
+  bool IsSharedTensor(int tensor_index) const {
+    return shared_tensors_.contains(tensor_index);
+  }
+
+  // Returns the OpenCL buffer of a shared tensor, creating it on first use.
+  // The tensor refers to the buffer through its buffer handle.
+  absl::Status GetSharedTensorBuffer(TfLiteContext* context, int tensor_index,
+                                     cl_mem* memory) {
+    TfLiteTensor& tensor = context->tensors[tensor_index];
+    if (tensor.delegate == &delegate_ &&
+        tensor.buffer_handle != kTfLiteNullBufferHandle) {
+      auto it = shared_buffers_.find(tensor.buffer_handle);
+      if (it != shared_buffers_.end() &&
+          it->second.GetMemorySizeInBytes() == tensor.bytes) {
+        *memory = it->second.GetMemoryPtr();
+        return absl::OkStatus();
+      }
+      // The tensor was resized.
+      shared_buffers_.erase(tensor.buffer_handle);
+    }
+    cl::Buffer buffer;
+    RETURN_IF_ERROR(cl::CreateReadWriteBuffer(
+        tensor.bytes, &shared_cl_environment_->context(), &buffer));
+    *memory = buffer.GetMemoryPtr();
+    tensor.buffer_handle = next_buffer_handle_++;
+    tensor.delegate = &delegate_;
+    shared_buffers_.emplace(tensor.buffer_handle, std::move(buffer));
+    return absl::OkStatus();
+  }
+
+  // Reads the OpenCL buffer of a shared tensor back into its CPU memory.
+  absl::Status ReadSharedTensorBuffer(TfLiteBufferHandle buffer_handle,
+                                      TfLiteTensor* tensor) {
+    auto it = shared_buffers_.find(buffer_handle);
+    if (it == shared_buffers_.end()) {
+      return absl::NotFoundError("Unknown buffer handle");
+    }
+    if (it->second.GetMemorySizeInBytes() != tensor->bytes) {
+      return absl::InvalidArgumentError("Buffer and tensor sizes differ");
+    }
+    return shared_cl_environment_->queue()->EnqueueReadBuffer(
+        it->second.GetMemoryPtr(), tensor->bytes, tensor->data.raw);
+  }
+
+  void FreeSharedTensorBuffer(TfLiteBufferHandle buffer_handle) {
+    shared_buffers_.erase(buffer_handle);
+  }
+
  private:
   TfLiteDelegate delegate_;
   TfLiteGpuDelegateOptionsV2 options_;
@@ -124,6 +271,15 @@ class Delegate {
 
   std::unique_ptr<Serialization> serialization_;
 
+  // Only used with TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_PARTITION_TENSORS or
+  // TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_INTERMEDIATE_MEMORY. The environment
+  // must outlive the kernels, which run on its command queue.
+  std::unique_ptr<cl::Environment> shared_cl_environment_;
+  std::unique_ptr<cl::SharedBufferPool> shared_buffer_pool_;
+  absl::flat_hash_set<int> shared_tensors_;
+  absl::flat_hash_map<TfLiteBufferHandle, cl::Buffer> shared_buffers_;
+  TfLiteBufferHandle next_buffer_handle_ = 0;
+
   friend class DelegateKernel;
 };
 
@@ -162,6 +318,10 @@ class DelegateKernel {
           InitializeOpenClApi(&graph, &builder, &graph_is_destroyed, context,
                               delegate_params, delegate_->serialization());
       if (!status.ok()) {
+        // The OpenCL buffers of shared tensors can't be used with OpenGL.
+        if (UsesSharedTensors(input_refs) || UsesSharedTensors(output_refs)) {
+          return status;
+        }
         TF_LITE_KERNEL_LOG(context, std::string(status.message()).c_str());
         TF_LITE_KERNEL_LOG(context, "Falling back to OpenGL");
 
@@ -242,6 +402,12 @@ class DelegateKernel {
     }
     RETURN_IF_ERROR(SetInputsAndOutputs(context));
     RETURN_IF_ERROR(runner_->Run());
+    // Shared outputs are only up to date in their OpenCL buffers.
+    for (int index : output_indices_) {
+      if (delegate_->IsSharedTensor(index)) {
+        context->tensors[index].data_is_stale = true;
+      }
+    }
     if (is_dequant_required) {
       RETURN_IF_ERROR(
           QuantizeOutputs(context, output_indices_, quant_conversion_map_));
@@ -252,12 +418,14 @@ class DelegateKernel {
  private:
   absl::Status SetInputsAndOutputs(TfLiteContext* context) {
     for (int i = 0; i < input_indices_.size(); ++i) {
-      RETURN_IF_ERROR(runner_->SetInputObject(
-          i, GetTensorObject(input_indices_[i], context)));
+      TensorObject object;
+      RETURN_IF_ERROR(GetTensorObject(input_indices_[i], context, &object));
+      RETURN_IF_ERROR(runner_->SetInputObject(i, object));
     }
     for (int i = 0; i < output_indices_.size(); ++i) {
-      RETURN_IF_ERROR(runner_->SetOutputObject(
-          i, GetTensorObject(output_indices_[i], context)));
+      TensorObject object;
+      RETURN_IF_ERROR(GetTensorObject(output_indices_[i], context, &object));
+      RETURN_IF_ERROR(runner_->SetOutputObject(i, object));
     }
     return absl::OkStatus();
   }
@@ -267,14 +435,31 @@ class DelegateKernel {
     ObjectDef default_object_def;
     default_object_def.data_type = data_type;
     default_object_def.data_layout = DataLayout::BHWC;
-    default_object_def.object_type = ObjectType::CPU_MEMORY;
+    default_object_def.object_type = delegate_->IsSharedTensor(index)
+                                         ? ObjectType::OPENCL_BUFFER
+                                         : ObjectType::CPU_MEMORY;
     default_object_def.user_provided = true;
     return default_object_def;
   }
 
-  TensorObject GetTensorObject(int index, TfLiteContext* context) const {
+  absl::Status GetTensorObject(int index, TfLiteContext* context,
+                               TensorObject* object) const {
     auto& tensor = context->tensors[index];
-    return MakeCpuMemory(absl::MakeSpan(tensor.data.raw, tensor.bytes));
+    if (delegate_->IsSharedTensor(index)) {
+      cl_mem memory;
+      RETURN_IF_ERROR(
+          delegate_->GetSharedTensorBuffer(context, index, &memory));
+      *object = OpenClBuffer(memory);
+      return absl::OkStatus();
+    }
+    *object = MakeCpuMemory(absl::MakeSpan(tensor.data.raw, tensor.bytes));
+    return absl::OkStatus();
+  }
+
+  bool UsesSharedTensors(const std::vector<uint32_t>& tensor_indices) const {
+    return absl::c_any_of(tensor_indices, [this](uint32_t index) {
+      return delegate_->IsSharedTensor(index);
+    });
   }
 
  private:
@@ -347,6 +532,15 @@ class DelegateKernel {
     *graph_is_destroyed = false;
     cl::InferenceEnvironmentOptions env_options;
     cl::InferenceEnvironmentProperties properties;
+    // Partitions that share tensors run in the same OpenCL context, and in
+    // order on the same command queue.
+    if (cl::Environment* shared_environment =
+            delegate_->shared_cl_environment()) {
+      env_options.device = shared_environment->device().id();
+      env_options.context = shared_environment->context().context();
+      env_options.command_queue = shared_environment->queue()->queue();
+      env_options.shared_buffer_pool = delegate_->shared_buffer_pool();
+    }
 
     // OpenCL initialization is parameterized by these InferenceOptions.
     auto delegate_options = delegate_->options();
@@ -568,6 +762,10 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
   };
 
   auto* gpu_delegate = GetDelegate(delegate);
+  if (gpu_delegate->IsSerializationEnabled() &&
+      !gpu_delegate->options().model_token) {
+    gpu_delegate->InitializeSerialization(delegates::GetModelToken(context));
+  }
   absl::flat_hash_set<TfLiteBuiltinOperator> excluded_ops;
   if (!cl::OpenCLSupported()) {
     excluded_ops.insert(kTfLiteBuiltinSplit);
@@ -576,6 +774,19 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
   TfLiteIntArray* ops_to_replace =
       GetOpsToReplace(context, gpu_delegate->IsQuantOpsAllowed(),
                       gpu_delegate->MaxDelegatedPartitions(), &excluded_ops);
+  if (gpu_delegate->SharesPartitionTensors() ||
+      gpu_delegate->SharesIntermediateMemory()) {
+    const auto status =
+        gpu_delegate->SharesPartitionTensors()
+            ? gpu_delegate->InitializeSharedTensors(context, ops_to_replace)
+            : gpu_delegate->InitializeSharedClEnvironment();
+    if (!status.ok()) {
+      TF_LITE_KERNEL_LOG(context, "TfLiteGpuDelegate Prepare: %s",
+                         std::string(status.message()).c_str());
+      TfLiteIntArrayFree(ops_to_replace);
+      return kTfLiteError;
+    }
+  }
   const auto status = context->ReplaceNodeSubsetsWithDelegateKernels(
       context, kRegistration, ops_to_replace, delegate);
   TFLITE_LOG_PROD(TFLITE_LOG_INFO, "Created %d GPU delegate kernels.",
@@ -584,6 +795,27 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
   return status;
 }
 
+TfLiteStatus DelegateCopyFromBufferHandle(TfLiteContext* context,
+                                          TfLiteDelegate* delegate,
+                                          TfLiteBufferHandle buffer_handle,
+                                          TfLiteTensor* tensor) {
+  const auto status = GetDelegate(delegate)->ReadSharedTensorBuffer(
+      buffer_handle, tensor);
+  if (!status.ok()) {
+    TF_LITE_KERNEL_LOG(context, "TfLiteGpuDelegate CopyFromBufferHandle: %s",
+                       std::string(status.message()).c_str());
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+void DelegateFreeBufferHandle(TfLiteContext* context,
+                              TfLiteDelegate* delegate,
+                              TfLiteBufferHandle* handle) {
+  GetDelegate(delegate)->FreeSharedTensorBuffer(*handle);
+  *handle = kTfLiteNullBufferHandle;
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace tflite
@@ -28,5 +28,6 @@ TfLiteGpuDelegateOptionsV2 TfLiteGpuDelegateOptionsV2Default() {
   options.max_delegated_partitions = 1;
   options.model_token = nullptr;
   options.serialization_dir = nullptr;
+  options.serialization_max_cache_bytes = int64_t{128} << 20;
   return options;
 }
@@ -67,10 +67,28 @@ enum TfLiteGpuExperimentalFlags {
   // model or inference params. Later initializations are fast.
   // ModifyGraphWithDelegate will fail if data cannot be serialized.
   //
-  // NOTE: User also needs to set serialization_dir & model_token in
-  // TfLiteGpuDelegateOptionsV2.
+  // NOTE: User also needs to set serialization_dir in
+  // TfLiteGpuDelegateOptionsV2, and may set model_token.
   // Currently works only if CL backend is used.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
+  // Keeps the float tensors produced by one delegated partition and consumed
+  // by another in OpenCL buffers, instead of reading them back to the CPU
+  // after the first partition and uploading them again for the next one.
+  // They are read back only when the CPU needs them, e.g. for ops that run
+  // on the CPU or for the model outputs. All the partitions then share one
+  // OpenCL context and command queue.
+  //
+  // NOTE: Currently works only if CL backend is used. Partitions with such
+  // tensors fail to initialize instead of falling back to OpenGL.
+  TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_PARTITION_TENSORS = 1 << 4,
+  // Holds the intermediate tensors of all the delegated partitions in one
+  // OpenCL buffer, sized for the partition that needs the most memory instead
+  // of one buffer per partition. The partitions run one after another on one
+  // OpenCL context and command queue, so none of them overwrites the tensors
+  // of another that is still running.
+  //
+  // NOTE: Currently works only if CL backend is used.
+  TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_INTERMEDIATE_MEMORY = 1 << 5,
 };
 
 // IMPORTANT: Always use TfLiteGpuDelegateOptionsV2Default() method to create
@@ -134,8 +152,15 @@ typedef struct {
   // StrFingerprint() in lite/delegates/serialization.h.
   //
   // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(), which implies the
-  // delegate will not try serialization.
+  // delegate derives the token from the shapes of the model tensors and the
+  // data of its constant tensors when it is applied.
   const char* model_token;
+
+  // The most bytes that the serialized data in serialization_dir may take.
+  // When more is stored, the least recently used data is deleted, including
+  // that of other models. Set to 0 for no limit.
+  // Set to 128 MiB in TfLiteGpuDelegateOptionsV2Default().
+  int64_t serialization_max_cache_bytes;
 } TfLiteGpuDelegateOptionsV2;
 
 // Populates TfLiteGpuDelegateOptionsV2 as follows:
@@ -146,6 +171,7 @@ typedef struct {
 //   priority3 = TFLITE_GPU_INFERENCE_PRIORITY_AUTO
 //   experimental_flags = TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_QUANT
 //   max_delegated_partitions = 1
+//   serialization_max_cache_bytes = 128 MiB
 TFL_CAPI_EXPORT TfLiteGpuDelegateOptionsV2 TfLiteGpuDelegateOptionsV2Default();
 
 #ifdef __cplusplus
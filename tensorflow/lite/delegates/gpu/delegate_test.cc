@@ -0,0 +1,157 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/delegate.h"
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/register.h"
+
+namespace tflite {
+namespace gpu {
+namespace {
+
+constexpr int kNumElements = 4;
+
+// A CPU-only custom op multiplying its input by 10, which splits the graph
+// into two delegated partitions.
+TfLiteRegistration* GetScaleByTenRegistration() {
+  static TfLiteRegistration registration = [] {
+    TfLiteRegistration r{};
+    r.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor& input = context->tensors[node->inputs->data[0]];
+      TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+      return context->ResizeTensor(context, output,
+                                   TfLiteIntArrayCopy(input.dims));
+    };
+    r.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor& input = context->tensors[node->inputs->data[0]];
+      TfLiteTensor& output = context->tensors[node->outputs->data[0]];
+      for (int i = 0; i < NumElements(&input); ++i) {
+        output.data.f[i] = 10 * input.data.f[i];
+      }
+      return kTfLiteOk;
+    };
+    r.builtin_code = kTfLiteBuiltinCustom;
+    r.custom_name = "ScaleByTen";
+    r.version = 1;
+    return r;
+  }();
+  return &registration;
+}
+
+void* NewAddParams() {
+  auto* params =
+      reinterpret_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+  params->activation = kTfLiteActNone;
+  params->pot_scale_int16 = false;
+  return params;
+}
+
+// Builds
+//   t = x + y
+//   u = ScaleByTen(t)
+//   z = t + u
+// so that t is produced by the first delegated partition, consumed by the
+// second one, and also read by the CPU.
+std::unique_ptr<Interpreter> BuildInterpreter() {
+  auto interpreter = std::make_unique<Interpreter>();
+  EXPECT_EQ(interpreter->AddTensors(5), kTfLiteOk);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(interpreter->SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {1, 2, 2, 1},
+                  TfLiteQuantizationParams()),
+              kTfLiteOk);
+  }
+  EXPECT_EQ(interpreter->SetInputs({0, 1}), kTfLiteOk);
+  EXPECT_EQ(interpreter->SetOutputs({4}), kTfLiteOk);
+  ops::builtin::BuiltinOpResolver resolver;
+  const TfLiteRegistration* add = resolver.FindOp(BuiltinOperator_ADD, 1);
+  EXPECT_EQ(interpreter->AddNodeWithParameters({0, 1}, {2}, nullptr, 0,
+                                               NewAddParams(), add),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter->AddNodeWithParameters({2}, {3}, nullptr, 0, nullptr,
+                                               GetScaleByTenRegistration()),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter->AddNodeWithParameters({2, 3}, {4}, nullptr, 0,
+                                               NewAddParams(), add),
+            kTfLiteOk);
+  return interpreter;
+}
+
+void InvokeAndCheck(Interpreter* interpreter, float offset) {
+  for (int i = 0; i < kNumElements; ++i) {
+    interpreter->typed_tensor<float>(0)[i] = i + offset;
+    interpreter->typed_tensor<float>(1)[i] = 2 * i;
+  }
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  for (int i = 0; i < kNumElements; ++i) {
+    EXPECT_EQ(interpreter->typed_tensor<float>(4)[i], 11 * (3 * i + offset))
+        << i;
+  }
+}
+
+TEST(DelegateTest, SharePartitionTensors) {
+  std::unique_ptr<Interpreter> interpreter = BuildInterpreter();
+  TfLiteGpuDelegateOptionsV2 options = TfLiteGpuDelegateOptionsV2Default();
+  options.experimental_flags |=
+      TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY |
+      TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_PARTITION_TENSORS;
+  options.max_delegated_partitions = 2;
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteGpuDelegateV2Delete)>
+      delegate(TfLiteGpuDelegateV2Create(&options), TfLiteGpuDelegateV2Delete);
+  ASSERT_EQ(interpreter->ModifyGraphWithDelegate(delegate.get()), kTfLiteOk);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  // Both additions are delegated, each in its own partition.
+  ASSERT_EQ(interpreter->execution_plan().size(), 3);
+
+  // Runs twice, so that the CPU reads t again once it is stale.
+  InvokeAndCheck(interpreter.get(), /*offset=*/1);
+  InvokeAndCheck(interpreter.get(), /*offset=*/5);
+
+  // Only t stays in an OpenCL buffer of the delegate.
+  const TfLiteTensor* shared = interpreter->tensor(2);
+  EXPECT_EQ(shared->delegate, delegate.get());
+  EXPECT_NE(shared->buffer_handle, kTfLiteNullBufferHandle);
+  for (int i : {0, 1, 3, 4}) {
+    EXPECT_EQ(interpreter->tensor(i)->buffer_handle, kTfLiteNullBufferHandle)
+        << i;
+  }
+}
+
+TEST(DelegateTest, PartitionTensorsAreNotSharedByDefault) {
+  std::unique_ptr<Interpreter> interpreter = BuildInterpreter();
+  TfLiteGpuDelegateOptionsV2 options = TfLiteGpuDelegateOptionsV2Default();
+  options.max_delegated_partitions = 2;
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteGpuDelegateV2Delete)>
+      delegate(TfLiteGpuDelegateV2Create(&options), TfLiteGpuDelegateV2Delete);
+  ASSERT_EQ(interpreter->ModifyGraphWithDelegate(delegate.get()), kTfLiteOk);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(interpreter->execution_plan().size(), 3);
+
+  InvokeAndCheck(interpreter.get(), /*offset=*/1);
+  EXPECT_EQ(interpreter->tensor(2)->buffer_handle, kTfLiteNullBufferHandle);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace tflite
@@ -134,7 +134,8 @@ JNIEXPORT jlong JNICALL Java_org_tensorflow_lite_gpu_GpuDelegate_createDelegate(
     options.model_token =
         env->GetStringUTFChars(model_token, /*isCopy=*/nullptr);
   }
-  if (options.serialization_dir && options.model_token) {
+  // Without a model token, the delegate derives one from the model.
+  if (options.serialization_dir) {
     options.experimental_flags |=
         TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION;
   }
@@ -30,6 +30,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <tuple>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -4612,10 +4613,36 @@ TfLiteStatus NNAPIDelegateKernel::Prepare(TfLiteContext* context,
 
   const auto delegate_options =
       StatefulNnApiDelegate::GetOptions(node->delegate);
+  if (delegate_options.compile_in_background) {
+    if (compilation_done_.load(std::memory_order_acquire)) {
+      return kTfLiteOk;
+    }
+    TF_LITE_ENSURE_STATUS(PrepareTfLiteKernels(context, node));
+    if (!compilation_thread_.joinable()) {
+      compilation_thread_ = std::thread([this, context, delegate_options]() {
+        int compilation_errno = ANEURALNETWORKS_NO_ERROR;
+        if (Compile(context, delegate_options, &compilation_errno) !=
+            kTfLiteOk) {
+          TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                          "NNAPI background compilation failed with error "
+                          "%d, running the nodes on TFLite kernels.",
+                          compilation_errno);
+          return;
+        }
+        compilation_done_.store(true, std::memory_order_release);
+      });
+    }
+    return kTfLiteOk;
+  }
   if (nn_compilation_) {
     return kTfLiteOk;
   }
+  return Compile(context, delegate_options, nnapi_errno);
+}
 
+TfLiteStatus NNAPIDelegateKernel::Compile(
+    TfLiteContext* context,
+    const StatefulNnApiDelegate::Options& delegate_options, int* nnapi_errno) {
   ANeuralNetworksCompilation* compilation = nullptr;
   if (!nnapi_devices_.empty()) {
     // Compile for the selected accelerator.
@@ -4728,6 +4755,68 @@ TfLiteStatus NNAPIDelegateKernel::Prepare(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+TfLiteStatus NNAPIDelegateKernel::PrepareTfLiteKernels(TfLiteContext* context,
+                                                       TfLiteNode* node) {
+  const std::unordered_set<int> delegate_outputs(
+      node->outputs->data, node->outputs->data + node->outputs->size);
+  for (int node_index : nodes_) {
+    TfLiteNode* tflite_node;
+    TfLiteRegistration* registration;
+    TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+        context, node_index, &tflite_node, &registration));
+    if (registration->prepare) {
+      TF_LITE_ENSURE_STATUS(registration->prepare(context, tflite_node));
+    }
+    // The outputs of the delegate node are the only tensors of the nodes that
+    // TFLite allocates, besides their inputs.
+    for (const TfLiteIntArray* tensors :
+         {tflite_node->outputs, tflite_node->temporaries}) {
+      if (!tensors) continue;
+      for (int tensor_index : TfLiteIntArrayView(tensors)) {
+        if (tensor_index == kTfLiteOptionalTensor ||
+            delegate_outputs.count(tensor_index)) {
+          continue;
+        }
+        TfLiteTensor* tensor = &context->tensors[tensor_index];
+        if (tensor->allocation_type != kTfLiteArenaRw &&
+            tensor->allocation_type != kTfLiteArenaRwPersistent) {
+          continue;
+        }
+        // The data may point into the arena from before delegation.
+        tensor->data.raw = nullptr;
+        tensor->allocation_type = kTfLiteDynamic;
+        TfLiteTensorRealloc(tensor->bytes, tensor);
+        tflite_kernel_tensors_.push_back(tensor_index);
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus NNAPIDelegateKernel::InvokeTfLiteKernels(TfLiteContext* context,
+                                                      TfLiteNode* node) {
+  for (const TfLiteIntArray* tensors : {node->inputs, node->outputs}) {
+    for (int tensor_index : TfLiteIntArrayView(tensors)) {
+      if (tensor_index != kTfLiteOptionalTensor &&
+          context->tensors[tensor_index].buffer_handle !=
+              kTfLiteNullBufferHandle) {
+        TF_LITE_KERNEL_LOG(context,
+                           "NNAPI memory can't be used before the NNAPI "
+                           "compilation completes.");
+        return kTfLiteError;
+      }
+    }
+  }
+  for (int node_index : nodes_) {
+    TfLiteNode* tflite_node;
+    TfLiteRegistration* registration;
+    TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+        context, node_index, &tflite_node, &registration));
+    TF_LITE_ENSURE_STATUS(registration->invoke(context, tflite_node));
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus NNAPIDelegateKernel::GetOperationsSupportedByTargetNnApiDevices(
     TfLiteContext* context, std::vector<int>* supported_nodes,
     int* nnapi_errno) {
@@ -4789,6 +4878,16 @@ TfLiteStatus NNAPIDelegateKernel::GetOperationsSupportedByTargetNnApiDevices(
 
 TfLiteStatus NNAPIDelegateKernel::Invoke(TfLiteContext* context,
                                          TfLiteNode* node, int* nnapi_errno) {
+  if (compilation_thread_.joinable()) {
+    if (!compilation_done_.load(std::memory_order_acquire)) {
+      return InvokeTfLiteKernels(context, node);
+    }
+    // The nodes no longer run on their TFLite kernels.
+    for (int tensor_index : tflite_kernel_tensors_) {
+      TfLiteTensorDataFree(&context->tensors[tensor_index]);
+    }
+    tflite_kernel_tensors_.clear();
+  }
   const bool allow_padding =
       nnapi_->nnapi_runtime_feature_level > kMinSdkVersionForNNAPI13 &&
       nnapi_->ANeuralNetworksExecution_enableInputAndOutputPadding != nullptr;
@@ -6434,6 +6533,7 @@ void StatefulNnApiDelegate::StatefulNnApiDelegateConstructorImpl(
     delegate_data_.allow_dynamic_dimensions = options.allow_dynamic_dimensions;
   }
   delegate_data_.use_burst_computation = options.use_burst_computation;
+  delegate_data_.compile_in_background = options.compile_in_background;
   delegate_data_.vendor_compilation_hints = options.vendor_compilation_hints;
   delegate_data_.vendor_execution_hints = options.vendor_execution_hints;
   delegate_data_.vendor_plugin = options.vendor_plugin;
@@ -6508,6 +6608,7 @@ const StatefulNnApiDelegate::Options StatefulNnApiDelegate::GetOptions(
       delegate_data->max_execution_loop_timeout_duration_ns;
   options.allow_dynamic_dimensions = delegate_data->allow_dynamic_dimensions;
   options.use_burst_computation = delegate_data->use_burst_computation;
+  options.compile_in_background = delegate_data->compile_in_background;
   options.vendor_compilation_hints = delegate_data->vendor_compilation_hints;
   options.vendor_execution_hints = delegate_data->vendor_execution_hints;
   options.vendor_plugin = delegate_data->vendor_plugin;
@@ -6880,10 +6981,11 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
 
   // Initialize caching, if applicable, from Options.
   const char* cache_dir = delegate_options.cache_dir;
-  const char* model_token = delegate_options.model_token;
-  delegates::SerializationParams params = {model_token, cache_dir};
-  if (nnapi->android_sdk_version >= kMinSdkVersionForNNAPI12 && cache_dir &&
-      model_token) {
+  if (nnapi->android_sdk_version >= kMinSdkVersionForNNAPI12 && cache_dir) {
+    const std::string model_token = delegate_options.model_token
+                                        ? delegate_options.model_token
+                                        : delegates::GetModelToken(context);
+    delegates::SerializationParams params = {model_token.c_str(), cache_dir};
     delegate_data->cache = std::make_unique<delegates::Serialization>(params);
   }
 
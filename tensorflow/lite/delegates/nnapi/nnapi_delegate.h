@@ -71,9 +71,10 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     const char* cache_dir = nullptr;
 
     // The unique nul-terminated token string for NNAPI model.
-    // Default to nullptr, which implies the NNAPI will not try caching the
-    // compilation. It is the caller's responsibility to ensure there is no
-    // clash of the tokens.
+    // Default to nullptr, which implies that a token is derived from the type
+    // and shape of every tensor and the data of the constant ones when
+    // cache_dir is set. It is the caller's responsibility to ensure there is
+    // no clash of the tokens it sets.
     // NOTE: when using compilation caching, it is not recommended to use the
     // same delegate instance for multiple models.
     const char* model_token = nullptr;
@@ -139,6 +140,13 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     // Default: Disabled for devices with NNAPI feature level 4 or lower.
     bool use_burst_computation = false;
 
+    // Whether to compile the NNAPI model in a background thread instead of
+    // when the delegate is applied. Until the compilation completes, the
+    // delegated nodes run on their TFLite kernels; they switch to NNAPI once it
+    // does, or stay on TFLite kernels if it fails. Tensors bound to NNAPI
+    // memory through buffer handles can't be used before the switch.
+    bool compile_in_background = false;
+
     // Specifies the max number of NNAPI reusable executions to cache. An
     // execution can be reused if the input and output tensors are using the
     // same buffer handles, and all dynamic dimensions are unchanged. Setting
@@ -280,7 +288,7 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
       TfLiteDelegate* delegate);
 
   // Returns ptr to delegates::Serialization, if caching is enabled by user via
-  // cache_dir & model_token.
+  // cache_dir.
   static delegates::Serialization* GetCache(TfLiteDelegate* delegate);
 
   // Returns the int value of the ResultCode returned by the latest
@@ -343,6 +351,8 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     bool allow_dynamic_dimensions = false;
     // Whether to use NNAPI Burst mode.
     bool use_burst_computation = false;
+    // Whether to compile the NNAPI model in a background thread.
+    bool compile_in_background = false;
     // Specifies the max number of NNAPI reusable executions to cache.
     uint32_t max_execution_cache_size = 4;
     // Provides hints about the max size of tensors with dynamic shapes.
@@ -16,10 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_DELEGATES_NNAPI_NNAPI_DELEGATE_KERNEL_H_
 #define TENSORFLOW_LITE_DELEGATES_NNAPI_NNAPI_DELEGATE_KERNEL_H_
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_map>
 
 #include "tensorflow/lite/allocation.h"
@@ -268,6 +270,9 @@ class NNAPIDelegateKernel {
         vendor_plugin_(vendor_plugin) {}
   NNAPIDelegateKernel() : NNAPIDelegateKernel(NnApiImplementation()) {}
   ~NNAPIDelegateKernel() {
+    if (compilation_thread_.joinable()) {
+      compilation_thread_.join();
+    }
     for (auto content : allocation_memory_mapping_) {
       nnapi_->ANeuralNetworksMemory_free(content.second);
     }
@@ -304,8 +309,9 @@ class NNAPIDelegateKernel {
   TfLiteStatus Init(TfLiteContext* context, const TfLiteDelegateParams* params,
                     int* nnapi_errno);
 
-  // Creates the NNAPI Compilation for the NN model. It assumes that Init has
-  // been called and completed successfully.
+  // Creates the NNAPI Compilation for the NN model, or starts creating it in
+  // the background with the compile_in_background option. It assumes that
+  // Init has been called and completed successfully.
   // Any NNAPI Related error causing this method to fail will have the
   // associated error number stored in nnapi_errno
   TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node,
@@ -374,6 +380,15 @@ class NNAPIDelegateKernel {
 
   std::vector<uint8_t> nn_compilation_cache_token_;
 
+  // With the compile_in_background option, the compilation runs in
+  // compilation_thread_, which sets compilation_done_ once nn_compilation_ and
+  // nn_burst_ can be used. Until then the nodes run on their TFLite kernels.
+  std::thread compilation_thread_;
+  std::atomic<bool> compilation_done_{false};
+  // Tensors of the nodes that TFLite no longer allocates, as they are not in
+  // its execution plan, and that are allocated to run the TFLite kernels.
+  std::vector<int> tflite_kernel_tensors_;
+
   // Map of DENSIFY output tensor id to node id.
   std::vector<int> densify_output_to_node_mapping_;
   // Map of DEQUANTIZE output tensor id to node id.
@@ -397,6 +412,17 @@ class NNAPIDelegateKernel {
   TfLiteStatus AddOpsAndTensors(TfLiteContext* context, int* nnapi_errno,
                                 bool allow_dynamic_dimensions);
 
+  // Creates nn_compilation_, and nn_burst_ if it is used.
+  TfLiteStatus Compile(TfLiteContext* context,
+                       const StatefulNnApiDelegate::Options& delegate_options,
+                       int* nnapi_errno);
+
+  // Prepares the delegated nodes to run on their TFLite kernels.
+  TfLiteStatus PrepareTfLiteKernels(TfLiteContext* context, TfLiteNode* node);
+
+  // Runs the delegated nodes on their TFLite kernels.
+  TfLiteStatus InvokeTfLiteKernels(TfLiteContext* context, TfLiteNode* node);
+
   TfLiteStatus BuildGraph(TfLiteContext* context,
                           const StatefulNnApiDelegate::Options& options,
                           const TfLiteIntArray* input_tensors,
@@ -58,10 +58,12 @@ class AddSubOpsAcceleratedModel : public MultiOpModel {
                             ActivationFunctionType activation_type,
                             const NnApi* nnapi,
                             const std::string& accelerator_name,
-                            bool allow_fp32_relax_to_fp16 = false)
+                            bool allow_fp32_relax_to_fp16 = false,
+                            bool compile_in_background = false)
       : MultiOpModel() {
     StatefulNnApiDelegate::Options options;
     options.accelerator_name = accelerator_name.c_str();
+    options.compile_in_background = compile_in_background;
     stateful_delegate_ =
         std::make_unique<StatefulNnApiDelegate>(nnapi, options);
     SetDelegate(stateful_delegate_.get());
@@ -134,5 +136,28 @@ TEST_F(NnApiFailureHandlingTest, DelegateShouldFailImmediatelyIfUnableToAddOp) {
   EXPECT_EQ(add_op_invocation_count, 1);
 }
 
+TEST_F(NnApiFailureHandlingTest,
+       BackgroundCompilationFailureKeepsRunningTfLiteKernels) {
+  nnapi_mock_->SetNnapiSupportedDevice("test-device");
+  nnapi_mock_->CompilationFinishReturns<ANEURALNETWORKS_OP_FAILED>();
+
+  AddSubOpsAcceleratedModel m(
+      {TensorType_FLOAT32, {1, 2, 2, 1}}, {TensorType_FLOAT32, {1, 2, 2, 1}},
+      {TensorType_FLOAT32, {1, 2, 2, 1}}, {TensorType_FLOAT32, {}},
+      ActivationFunctionType_NONE, nnapi_mock_->GetNnApi(),
+      /*accelerator_name=*/"test-device", /*allow_fp32_relax_to_fp16=*/false,
+      /*compile_in_background=*/true);
+  m.PopulateTensor<float>(m.input1(), {-2.0, 0.2, 0.7, 0.9});
+  m.PopulateTensor<float>(m.input2(), {0.1, 0.2, 0.3, 0.5});
+  m.PopulateTensor<float>(m.input3(), {0.1, 0.1, 0.1, 0.1});
+  // The delegated ADD and SUB run on their TFLite kernels, before and after
+  // the compilation fails.
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+    EXPECT_THAT(m.GetOutput(), ArrayFloatNear({-2.0, 0.3, 0.9, 1.3}));
+  }
+  EXPECT_EQ(m.CountOpsExecutedByCpuKernel(), 0);
+}
+
 }  // namespace
 }  // namespace tflite
@@ -18,9 +18,11 @@ limitations under the License.
 #include <fstream>
 #include <iostream>
 #else
+#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <sys/file.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <cstring>
@@ -43,6 +45,7 @@ namespace delegates {
 namespace {
 
 static const char kDelegatedNodesSuffix[] = "_dnodes";
+static const char kEntryFileSuffix[] = ".bin";
 
 // Farmhash Fingerprint
 inline uint64_t CombineFingerprints(uint64_t l, uint64_t h) {
@@ -66,10 +69,65 @@ inline std::string JoinPath(const std::string& path1,
 inline std::string GetFilePath(const std::string& cache_dir,
                                const std::string& model_token,
                                const uint64_t fingerprint) {
-  auto file_name = (model_token + "_" + std::to_string(fingerprint) + ".bin");
+  auto file_name =
+      (model_token + "_" + std::to_string(fingerprint) + kEntryFileSuffix);
   return JoinPath(cache_dir, file_name);
 }
 
+#if !defined(_WIN32)
+// Deletes the least recently used entries in `cache_dir` until all the entries
+// take at most `max_cache_bytes`. The entry at `keep_filepath` is never
+// deleted.
+void EvictLeastRecentlyUsedEntries(const std::string& cache_dir,
+                                   const int64_t max_cache_bytes,
+                                   const std::string& keep_filepath) {
+  DIR* dir = opendir(cache_dir.c_str());
+  if (!dir) return;
+  struct EntryFile {
+    time_t last_used;
+    int64_t bytes;
+    std::string filepath;
+  };
+  std::vector<EntryFile> entry_files;
+  int64_t total_bytes = 0;
+  const size_t suffix_length = strlen(kEntryFileSuffix);
+  while (struct dirent* dir_entry = readdir(dir)) {
+    const std::string file_name = dir_entry->d_name;
+    if (file_name.size() <= suffix_length ||
+        file_name.compare(file_name.size() - suffix_length, suffix_length,
+                          kEntryFileSuffix) != 0) {
+      continue;
+    }
+    std::string filepath = JoinPath(cache_dir, file_name);
+    struct stat file_stat;
+    if (stat(filepath.c_str(), &file_stat) < 0 ||
+        !S_ISREG(file_stat.st_mode)) {
+      continue;
+    }
+    total_bytes += file_stat.st_size;
+    if (filepath != keep_filepath) {
+      entry_files.push_back(
+          {file_stat.st_mtime, file_stat.st_size, std::move(filepath)});
+    }
+  }
+  closedir(dir);
+  if (total_bytes <= max_cache_bytes) return;
+
+  std::sort(entry_files.begin(), entry_files.end(),
+            [](const EntryFile& a, const EntryFile& b) {
+              return a.last_used < b.last_used;
+            });
+  for (const EntryFile& entry_file : entry_files) {
+    if (total_bytes <= max_cache_bytes) break;
+    if (unlink(entry_file.filepath.c_str()) == 0) {
+      total_bytes -= entry_file.bytes;
+      TFLITE_LOG(TFLITE_LOG_INFO, "Evicted serialized data at %s",
+                 entry_file.filepath.c_str());
+    }
+  }
+}
+#endif  // !defined(_WIN32)
+
 }  // namespace
 
 std::string StrFingerprint(const void* data, const size_t num_bytes) {
@@ -77,12 +135,32 @@ std::string StrFingerprint(const void* data, const size_t num_bytes) {
       ::util::Fingerprint64(reinterpret_cast<const char*>(data), num_bytes));
 }
 
+std::string GetModelToken(TfLiteContext* context) {
+  std::string model_data;
+  for (int i = 0; i < context->tensors_size; ++i) {
+    const TfLiteTensor& tensor = context->tensors[i];
+    const int32_t header[] = {tensor.type, tensor.allocation_type,
+                              tensor.dims ? tensor.dims->size : 0};
+    model_data.append(reinterpret_cast<const char*>(header), sizeof(header));
+    if (tensor.dims) {
+      model_data.append(reinterpret_cast<const char*>(tensor.dims->data),
+                        tensor.dims->size * sizeof(int));
+    }
+    if (tensor.allocation_type == kTfLiteMmapRo && tensor.data.raw) {
+      model_data += StrFingerprint(tensor.data.raw, tensor.bytes);
+    }
+  }
+  return StrFingerprint(model_data.data(), model_data.size());
+}
+
 SerializationEntry::SerializationEntry(const std::string& cache_dir,
                                        const std::string& model_token,
-                                       const uint64_t fingerprint)
+                                       const uint64_t fingerprint,
+                                       const int64_t max_cache_bytes)
     : cache_dir_(cache_dir),
       model_token_(model_token),
-      fingerprint_(fingerprint) {}
+      fingerprint_(fingerprint),
+      max_cache_bytes_(max_cache_bytes) {}
 
 TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
                                          const char* data,
@@ -149,6 +227,9 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
                        filepath.c_str(), std::strerror(errno));
     return kTfLiteDelegateDataWriteError;
   }
+  if (max_cache_bytes_ > 0) {
+    EvictLeastRecentlyUsedEntries(cache_dir_, max_cache_bytes_, filepath);
+  }
 #endif  // defined(_WIN32)
 
   TFLITE_LOG(TFLITE_LOG_INFO, "Wrote serialized data for model %s (%d B) to %s",
@@ -198,6 +279,8 @@ TfLiteStatus SerializationEntry::GetData(TfLiteContext* context,
     int bytes_read = read(fd, buffer, 512);
     if (bytes_read == 0) {
       // EOF
+      // Marks the entry as used, so that it is evicted last.
+      if (max_cache_bytes_ > 0) futimens(fd, nullptr);
       close(fd);
       return kTfLiteOk;
     } else if (bytes_read < 0) {
@@ -288,7 +371,8 @@ SerializationEntry Serialization::GetEntryImpl(
 
   // Get a fingerprint-specific lock that is passed to the SerializationKey, to
   // ensure noone else gets access to an equivalent SerializationKey.
-  return SerializationEntry(cache_dir_, model_token_, fingerprint);
+  return SerializationEntry(cache_dir_, model_token_, fingerprint,
+                            max_cache_bytes_);
 }
 
 TfLiteStatus SaveDelegatedNodes(TfLiteContext* context,
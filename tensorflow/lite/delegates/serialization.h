@@ -80,6 +80,11 @@ namespace delegates {
 //    model_token.
 std::string StrFingerprint(const void* data, const size_t num_bytes);
 
+// Returns a model_token unique to the model in `context`, for delegates that
+// enable serialization without one from the client. It fingerprints the type
+// and shape of every tensor, and the data of the constant ones.
+std::string GetModelToken(TfLiteContext* context);
+
 // Encapsulates a unique blob of data serialized by a delegate.
 // Needs to be initialized with a Serialization instance.
 // Any data set with this entry is 'keyed' by a 64-bit fingerprint unique to the
@@ -127,7 +132,8 @@ class SerializationEntry {
  protected:
   SerializationEntry(const std::string& cache_dir,
                      const std::string& model_token,
-                     const uint64_t fingerprint_64);
+                     const uint64_t fingerprint_64,
+                     const int64_t max_cache_bytes = 0);
 
   // Caching directory.
   const std::string cache_dir_;
@@ -135,6 +141,8 @@ class SerializationEntry {
   const std::string model_token_;
   // For most applications, 64-bit fingerprints are enough.
   const uint64_t fingerprint_ = 0;
+  // See SerializationParams::max_cache_bytes.
+  const int64_t max_cache_bytes_ = 0;
 };
 
 // Encapsulates all the data that clients can use to parametrize a Serialization
@@ -154,6 +162,13 @@ typedef struct SerializationParams {
   // On Android, `getCodeCacheDir()` is recommended.
   // Required.
   const char* cache_dir;
+  // The most bytes that the entries in `cache_dir` may take in total. When
+  // data is stored and the entries take more, the least recently used entries
+  // are deleted until they fit. Entries are used when their data is stored or
+  // read back. Entries of all the models in `cache_dir` count towards this.
+  // Only supported on unix/POSIX systems.
+  // Optional, 0 (the default) means no limit.
+  int64_t max_cache_bytes = 0;
 } SerializationParams;
 
 // Utility to enable caching abilities for delegates.
@@ -164,7 +179,9 @@ class Serialization {
  public:
   // Initialize a Serialization interface for applicable delegates.
   explicit Serialization(const SerializationParams& params)
-      : cache_dir_(params.cache_dir), model_token_(params.model_token) {}
+      : cache_dir_(params.cache_dir),
+        model_token_(params.model_token),
+        max_cache_bytes_(params.max_cache_bytes) {}
 
   // Generate a SerializationEntry that incorporates both `custom_key` &
   // `context` into its unique fingerprint.
@@ -199,6 +216,7 @@ class Serialization {
 
   const std::string cache_dir_;
   const std::string model_token_;
+  const int64_t max_cache_bytes_;
 };
 
 // Helper for delegates to save their delegation decisions (which nodes to
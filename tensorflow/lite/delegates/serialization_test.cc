@@ -14,6 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/delegates/serialization.h"
 
+#if !defined(_WIN32)
+#include <stdlib.h>
+#include <utime.h>
+#endif  // !defined(_WIN32)
+
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -108,6 +113,28 @@ TEST_F(SerializationTest, StrFingerprint) {
   EXPECT_NE(fingerprint_1, fingerprint_2);
 }
 
+TEST_F(SerializationTest, GetModelToken) {
+  TfLiteContext context = GenerateTfLiteContext(/*num_tensors*/ 20);
+  TfLiteContext equivalent_context = GenerateTfLiteContext(/*num_tensors*/ 20);
+  TfLiteContext other_context = GenerateTfLiteContext(/*num_tensors*/ 30);
+  const std::string token = GetModelToken(&context);
+  EXPECT_EQ(token, GetModelToken(&equivalent_context));
+  EXPECT_NE(token, GetModelToken(&other_context));
+
+  // The type of any tensor changes the token.
+  equivalent_context.tensors[3].type = kTfLiteFloat32;
+  EXPECT_NE(token, GetModelToken(&equivalent_context));
+
+  // So does the data of constant tensors.
+  std::vector<float> weights = {1, 2, 3, 4};
+  context.tensors[0].allocation_type = kTfLiteMmapRo;
+  context.tensors[0].data.raw = reinterpret_cast<char*>(weights.data());
+  context.tensors[0].bytes = weights.size() * sizeof(float);
+  const std::string weights_token = GetModelToken(&context);
+  weights[2] = 5;
+  EXPECT_NE(weights_token, GetModelToken(&context));
+}
+
 TEST_F(SerializationTest, DelegateEntryFingerprint) {
   const std::string model_token = "mobilenet";
   const std::string dir = "/test/dir";
@@ -310,6 +337,51 @@ TEST_F(SerializationTest, SerializationData) {
   }
 }
 
+#if !defined(_WIN32)
+TEST_F(SerializationTest, EvictsLeastRecentlyUsedEntries) {
+  float value = 456.24;
+  std::string model_token = "model1";
+  // A new directory, so that there are no entries from other tests or runs.
+  std::string test_dir = getSerializationDir() + "/lru_cache_XXXXXX";
+  ASSERT_NE(mkdtemp(&test_dir[0]), nullptr);
+  TfLiteContext context = GenerateTfLiteContext(/*num_tensors*/ 30);
+
+  // Only two entries fit into the cache.
+  SerializationParams serialization_params = {
+      model_token.c_str(), test_dir.c_str(),
+      /*max_cache_bytes=*/2 * sizeof(value)};
+  Serialization serialization(serialization_params);
+  auto entry1 = serialization.GetEntryForDelegate("entry1", &context);
+  auto entry2 = serialization.GetEntryForDelegate("entry2", &context);
+  auto entry3 = serialization.GetEntryForDelegate("entry3", &context);
+  ASSERT_EQ(entry1.SetData(&context, reinterpret_cast<const char*>(&value),
+                           sizeof(value)),
+            kTfLiteOk);
+  ASSERT_EQ(entry2.SetData(&context, reinterpret_cast<const char*>(&value),
+                           sizeof(value)),
+            kTfLiteOk);
+
+  // Backdates both entries, then uses entry1 so that entry2 is the least
+  // recently used one.
+  for (const auto* entry : {&entry1, &entry2}) {
+    const std::string filepath = test_dir + "/" + model_token + "_" +
+                                 std::to_string(entry->GetFingerprint()) +
+                                 ".bin";
+    struct utimbuf times = {1000, 1000};
+    ASSERT_EQ(utime(filepath.c_str(), &times), 0);
+  }
+  std::string read_back;
+  ASSERT_EQ(entry1.GetData(&context, &read_back), kTfLiteOk);
+
+  ASSERT_EQ(entry3.SetData(&context, reinterpret_cast<const char*>(&value),
+                           sizeof(value)),
+            kTfLiteOk);
+  EXPECT_EQ(entry1.GetData(&context, &read_back), kTfLiteOk);
+  EXPECT_EQ(entry2.GetData(&context, &read_back), kTfLiteDelegateDataNotFound);
+  EXPECT_EQ(entry3.GetData(&context, &read_back), kTfLiteOk);
+}
+#endif  // !defined(_WIN32)
+
 TEST_F(SerializationTest, CachingDelegatedNodes) {
   std::string model_token = "model1";
   std::string test_dir = getSerializationDir();
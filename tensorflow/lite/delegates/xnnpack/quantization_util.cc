@@ -24,6 +24,23 @@ limitations under the License.
 
 namespace tflite {
 namespace xnnpack {
+namespace {
+
+template <typename IndexT>
+bool UnpackPalettized(const IndexT* indices, const float* palette,
+                      size_t palette_size, float* unpacked_fp32_data,
+                      size_t tensor_elements) {
+  for (size_t i = 0; i < tensor_elements; ++i) {
+    const int64_t index = indices[i];
+    if (index < 0 || index >= static_cast<int64_t>(palette_size)) {
+      return false;
+    }
+    unpacked_fp32_data[i] = palette[index];
+  }
+  return true;
+}
+
+}  // namespace
 
 void DequantizeFloat16(const uint16_t *packed_fp16_data,
                        float *unpacked_fp32_data, size_t tensor_elements) {
@@ -54,5 +71,19 @@ void PerChannelDequantizeInt8(const int8_t* packed_s8_data,
                                       tensor_shape, unpacked_fp32_data);
 }
 
+bool UnpackPalettizedFloat32(const uint8_t* indices, const float* palette,
+                             size_t palette_size, float* unpacked_fp32_data,
+                             size_t tensor_elements) {
+  return UnpackPalettized(indices, palette, palette_size, unpacked_fp32_data,
+                          tensor_elements);
+}
+
+bool UnpackPalettizedFloat32(const int16_t* indices, const float* palette,
+                             size_t palette_size, float* unpacked_fp32_data,
+                             size_t tensor_elements) {
+  return UnpackPalettized(indices, palette, palette_size, unpacked_fp32_data,
+                          tensor_elements);
+}
+
 }  // namespace xnnpack
 }  // namespace tflite
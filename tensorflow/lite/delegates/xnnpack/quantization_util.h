@@ -49,6 +49,17 @@ void PerChannelDequantizeInt8(const int8_t* packed_s8_data,
 void DequantizeFloat16(const uint16_t* packed_fp16_data,
                        float* unpacked_fp32_data, size_t tensor_elements);
 
+// Unpacks palettized FP32 values by replacing every index with the palette
+// value it refers to. indices should have tensor_elements size.
+// unpacked_fp32_data should be preallocated to have the same size. Returns
+// false if an index is outside of the palette of palette_size values.
+bool UnpackPalettizedFloat32(const uint8_t* indices, const float* palette,
+                             size_t palette_size, float* unpacked_fp32_data,
+                             size_t tensor_elements);
+bool UnpackPalettizedFloat32(const int16_t* indices, const float* palette,
+                             size_t palette_size, float* unpacked_fp32_data,
+                             size_t tensor_elements);
+
 }  // namespace xnnpack
 }  // namespace tflite
 
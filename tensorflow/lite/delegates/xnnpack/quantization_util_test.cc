@@ -97,6 +97,32 @@ TEST(Dequantize, Float16) {
               Pointwise(FloatNear(1e-6), {0.125, 0.25, 0.5, 1., 2., 4.}));
 }
 
+TEST(UnpackPalettized, Uint8) {
+  const std::vector<float> palette = {-1.5f, 0.0f, 2.25f};
+  const std::vector<uint8_t> indices = {2, 0, 1, 1, 0, 2};
+  std::vector<float> unpacked_data(indices.size());
+
+  EXPECT_TRUE(UnpackPalettizedFloat32(indices.data(), palette.data(),
+                                      palette.size(), unpacked_data.data(),
+                                      indices.size()));
+  EXPECT_THAT(unpacked_data,
+              Pointwise(FloatNear(1e-6), {2.25, -1.5, 0., 0., -1.5, 2.25}));
+}
+
+TEST(UnpackPalettized, Int16OutOfPalette) {
+  const std::vector<float> palette = {-1.5f, 0.0f, 2.25f};
+  std::vector<float> unpacked_data(2);
+
+  const std::vector<int16_t> too_large = {1, 3};
+  EXPECT_FALSE(UnpackPalettizedFloat32(too_large.data(), palette.data(),
+                                       palette.size(), unpacked_data.data(),
+                                       too_large.size()));
+  const std::vector<int16_t> negative = {-1, 0};
+  EXPECT_FALSE(UnpackPalettizedFloat32(negative.data(), palette.data(),
+                                       palette.size(), unpacked_data.data(),
+                                       negative.size()));
+}
+
 }  // namespace
 }  // namespace xnnpack
 }  // namespace tflite
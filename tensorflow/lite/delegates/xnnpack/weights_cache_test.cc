@@ -164,6 +164,61 @@ TEST(XNNPACK_WEIGHTS_CACHE, SoftFinalization) {
   ASSERT_EQ(kTfLiteOk, interpreter2->Invoke());
 }
 
+TEST(XNNPACK_WEIGHTS_CACHE, SharedCacheIsFinalizedOnFirstInvoke) {
+  std::vector<char> buffer = Conv2DTester().CreateTfLiteModel();
+  const Model* model = GetModel(buffer.data());
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+
+  std::unique_ptr<TfLiteXNNPackDelegateWeightsCache,
+                  decltype(&TfLiteXNNPackDelegateWeightsCacheReleaseShared)>
+      weights_cache1(TfLiteXNNPackDelegateWeightsCacheAcquireShared("model"),
+                     TfLiteXNNPackDelegateWeightsCacheReleaseShared);
+  std::unique_ptr<TfLiteXNNPackDelegateWeightsCache,
+                  decltype(&TfLiteXNNPackDelegateWeightsCacheReleaseShared)>
+      weights_cache2(TfLiteXNNPackDelegateWeightsCacheAcquireShared("model"),
+                     TfLiteXNNPackDelegateWeightsCacheReleaseShared);
+  std::unique_ptr<TfLiteXNNPackDelegateWeightsCache,
+                  decltype(&TfLiteXNNPackDelegateWeightsCacheReleaseShared)>
+      other_weights_cache(
+          TfLiteXNNPackDelegateWeightsCacheAcquireShared("other_model"),
+          TfLiteXNNPackDelegateWeightsCacheReleaseShared);
+  ASSERT_NE(weights_cache1.get(), nullptr);
+  ASSERT_EQ(weights_cache1.get(), weights_cache2.get());
+  ASSERT_NE(weights_cache1.get(), other_weights_cache.get());
+
+  TfLiteXNNPackDelegateOptions delegate_options1 =
+      TfLiteXNNPackDelegateOptionsDefault();
+  delegate_options1.weights_cache = weights_cache1.get();
+  TfLiteXNNPackDelegateOptions delegate_options2 =
+      TfLiteXNNPackDelegateOptionsDefault();
+  delegate_options2.weights_cache = weights_cache2.get();
+
+  std::unique_ptr<Interpreter> interpreter1;
+  ASSERT_EQ(kTfLiteOk, InterpreterBuilder(model, resolver)(&interpreter1));
+  ASSERT_EQ(kTfLiteOk, interpreter1->AllocateTensors());
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      delegate1(TfLiteXNNPackDelegateCreate(&delegate_options1),
+                TfLiteXNNPackDelegateDelete);
+  ASSERT_EQ(kTfLiteOk, interpreter1->ModifyGraphWithDelegate(delegate1.get()));
+
+  // No explicit finalization: the first Invoke soft-finalizes the cache.
+  ASSERT_EQ(kTfLiteOk, interpreter1->Invoke());
+
+  // An interpreter created afterwards reuses the packed weights.
+  std::unique_ptr<Interpreter> interpreter2;
+  ASSERT_EQ(kTfLiteOk, InterpreterBuilder(model, resolver)(&interpreter2));
+  ASSERT_EQ(kTfLiteOk, interpreter2->AllocateTensors());
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      delegate2(TfLiteXNNPackDelegateCreate(&delegate_options2),
+                TfLiteXNNPackDelegateDelete);
+  ASSERT_EQ(kTfLiteOk, interpreter2->ModifyGraphWithDelegate(delegate2.get()));
+  ASSERT_EQ(kTfLiteOk, interpreter2->Invoke());
+
+  // Interpreters and delegates go first, caches are released afterwards.
+  interpreter1.reset();
+  interpreter2.reset();
+}
+
 // Dummy class to use with parameterized test.
 class WeightsCacheTest : public testing::TestWithParam<size_t> {};
 
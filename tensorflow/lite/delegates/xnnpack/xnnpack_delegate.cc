@@ -24,6 +24,7 @@ limitations under the License.
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -459,6 +460,78 @@ class VariableHolder {
   std::map<uint32_t, DimsAndType> global_id_to_dims_and_type_;
 };
 
+// Process-wide weights caches handed out by
+// TfLiteXNNPackDelegateWeightsCacheAcquireShared, one per model key. Each cache
+// is reference counted and soft-finalized by the first delegate kernel that
+// sets up its runtime, so that interpreters created later only look up the
+// weights packed by the first one.
+class SharedWeightsCaches {
+ public:
+  static SharedWeightsCaches& Get() {
+    static SharedWeightsCaches* caches = new SharedWeightsCaches();
+    return *caches;
+  }
+
+  TfLiteXNNPackDelegateWeightsCache* Acquire(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = by_key_.find(key);
+    if (it != by_key_.end()) {
+      entries_[it->second].refcount++;
+      return it->second;
+    }
+    TfLiteXNNPackDelegateWeightsCache* cache =
+        TfLiteXNNPackDelegateWeightsCacheCreate();
+    if (cache == nullptr) {
+      return nullptr;
+    }
+    by_key_[key] = cache;
+    entries_[cache] = Entry{key, /*refcount=*/1, /*finalized=*/false};
+    return cache;
+  }
+
+  // Returns false if `cache` was not acquired from this registry.
+  bool Release(TfLiteXNNPackDelegateWeightsCache* cache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(cache);
+    if (it == entries_.end()) {
+      return false;
+    }
+    if (--it->second.refcount == 0) {
+      by_key_.erase(it->second.key);
+      entries_.erase(it);
+      TfLiteXNNPackDelegateWeightsCacheDelete(cache);
+    }
+    return true;
+  }
+
+  // Soft-finalizes `cache` if it is a shared cache that has not been finalized
+  // yet. Caches that do not come from this registry are finalized by their
+  // owner and are left alone. Returns false if finalization fails.
+  bool MaybeFinalize(TfLiteXNNPackDelegateWeightsCache* cache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(cache);
+    if (it == entries_.end() || it->second.finalized) {
+      return true;
+    }
+    if (!TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(cache)) {
+      return false;
+    }
+    it->second.finalized = true;
+    return true;
+  }
+
+ private:
+  struct Entry {
+    std::string key;
+    int refcount;
+    bool finalized;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, TfLiteXNNPackDelegateWeightsCache*> by_key_;
+  std::unordered_map<TfLiteXNNPackDelegateWeightsCache*, Entry> entries_;
+};
+
 class Delegate {
   friend class Subgraph;
 
@@ -1009,6 +1082,18 @@ class Subgraph {
         external_values.push_back(value);
       }
 
+      // Shared weights caches are finalized here rather than by the caller:
+      // by now every delegate kernel of this interpreter has packed its
+      // weights into the cache.
+      if (!weights_cache_finalized_) {
+        if (!SharedWeightsCaches::Get().MaybeFinalize(weights_cache_)) {
+          TF_LITE_KERNEL_LOG(context,
+                             "failed to finalize shared XNNPACK weights cache");
+          return kTfLiteError;
+        }
+        weights_cache_finalized_ = true;
+      }
+
       const xnn_status status = xnn_setup_runtime(
           runtime_.get(), external_values.size(), external_values.data());
       if (status != xnn_status_success) {
@@ -5501,7 +5586,8 @@ class Subgraph {
  private:
   Subgraph(const Delegate& delegate, xnn_runtime_t runtime,
            const std::unordered_set<int>& externals)
-      : runtime_(runtime, &xnn_delete_runtime) {
+      : runtime_(runtime, &xnn_delete_runtime),
+        weights_cache_(delegate.options_.weights_cache) {
     for (int t : externals) {
       externals_[t] = nullptr;
     }
@@ -5523,6 +5609,9 @@ class Subgraph {
   // calls.
   bool has_variables_ = false;
   bool variables_set_up_ = false;
+  // Weights cache the runtime was created with, if any.
+  TfLiteXNNPackDelegateWeightsCache* weights_cache_ = nullptr;
+  bool weights_cache_finalized_ = false;
 };
 
 TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
@@ -5604,6 +5693,37 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
       }
     }
 
+    // Prepare to unpack palettized FP32 tensors, stored as static indices into
+    // a static 1D palette.
+    if (registration->builtin_code == kTfLiteBuiltinGather &&
+        node->inputs->size == 2 && node->outputs->size == 1) {
+      const TfLiteTensor& palette_tensor =
+          context->tensors[node->inputs->data[0]];
+      const TfLiteTensor& indices_tensor =
+          context->tensors[node->inputs->data[1]];
+      const TfLiteTensor& output_tensor =
+          context->tensors[node->outputs->data[0]];
+
+      // Gathering from a 1D palette implies axis 0 and no batch dimensions.
+      if (palette_tensor.allocation_type == kTfLiteMmapRo &&
+          indices_tensor.allocation_type == kTfLiteMmapRo &&
+          palette_tensor.sparsity == nullptr &&
+          indices_tensor.sparsity == nullptr &&
+          palette_tensor.type == kTfLiteFloat32 &&
+          NumDimensions(&palette_tensor) == 1 &&
+          (indices_tensor.type == kTfLiteUInt8 ||
+           indices_tensor.type == kTfLiteInt16) &&
+          output_tensor.type == kTfLiteFloat32) {
+        static_unpack_nodes_.insert(node_index);
+        quasi_static_tensors_producers[node->outputs->data[0]] = node_index;
+        quasi_static_tensors.insert(node->outputs->data[0]);
+
+        // Skip this node for now. If output of the node is consumed only by
+        // delegated nodes, it will be added to nodes_to_delegate in the end.
+        continue;
+      }
+    }
+
     // Prepare to unpack sparse tensors.
     // TODO(b/157729695): In the future, we also need to handle the case where a
     // sparse tensor is fed to a TFLite op directly, and no Densify() op is
@@ -5689,7 +5809,11 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
       return nullptr;  // Hard error.
     }
 
-    if (node->inputs->size != 1) {
+    // Palettized tensors are unpacked from a palette and indices, other
+    // tensors from their packed data only.
+    const int expected_inputs =
+        registration->builtin_code == kTfLiteBuiltinGather ? 2 : 1;
+    if (node->inputs->size != expected_inputs) {
       TF_LITE_KERNEL_LOG(context, "unexpected number of inputs (%d) in node %d",
                          node->inputs->size, producer_index);
       TfLiteIntArrayFree(nodes_to_delegate);
@@ -5852,6 +5976,41 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
         }
         break;
       }
+      case kTfLiteBuiltinGather: {
+        // Such conditions have been checked when preparing to unpack
+        // palettized tensors.
+        TFLITE_DCHECK(input_tensor.type == kTfLiteFloat32);
+        const TfLiteTensor& indices_tensor =
+            context->tensors[node->inputs->data[1]];
+        const size_t palette_size = NumElements(&input_tensor);
+        const float* palette = reinterpret_cast<const float*>(packed_data);
+        float* unpacked_fp32_data = reinterpret_cast<float*>(unpacked_data);
+        bool unpacked = false;
+        switch (indices_tensor.type) {
+          case kTfLiteUInt8:
+            unpacked = UnpackPalettizedFloat32(
+                static_cast<const uint8_t*>(indices_tensor.data.data), palette,
+                palette_size, unpacked_fp32_data, tensor_elements);
+            break;
+          case kTfLiteInt16:
+            unpacked = UnpackPalettizedFloat32(
+                static_cast<const int16_t*>(indices_tensor.data.data), palette,
+                palette_size, unpacked_fp32_data, tensor_elements);
+            break;
+          default:
+            // This should not happen as we only allow UINT8/INT16 indices
+            // when preparing the unpacking.
+            TFLITE_DCHECK(false);
+        }
+        if (!unpacked) {
+          TF_LITE_KERNEL_LOG(context,
+                             "index out of palette of %zu values in node %d",
+                             palette_size, producer_index);
+          TfLiteIntArrayFree(nodes_to_delegate);
+          return nullptr;  // Hard error.
+        }
+        break;
+      }
       default:
         TF_LITE_KERNEL_LOG(context, "unexpected op registration %d at node %d",
                            registration->builtin_code, producer_index);
@@ -6003,6 +6162,26 @@ void TfLiteXNNPackDelegateWeightsCacheDelete(
   xnn_deinitialize();
 }
 
+TfLiteXNNPackDelegateWeightsCache*
+TfLiteXNNPackDelegateWeightsCacheAcquireShared(const char* key) {
+  if (key == nullptr) {
+    return nullptr;
+  }
+  return tflite::xnnpack::SharedWeightsCaches::Get().Acquire(key);
+}
+
+void TfLiteXNNPackDelegateWeightsCacheReleaseShared(
+    TfLiteXNNPackDelegateWeightsCache* cache) {
+  if (cache == nullptr) {
+    return;
+  }
+  if (!tflite::xnnpack::SharedWeightsCaches::Get().Release(cache)) {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR,
+                    "Released an XNNPACK weights cache that was not acquired "
+                    "with TfLiteXNNPackDelegateWeightsCacheAcquireShared.");
+  }
+}
+
 TfLiteXNNPackDelegateOptions TfLiteXNNPackDelegateOptionsDefault() {
   TfLiteXNNPackDelegateOptions options = {0};
 
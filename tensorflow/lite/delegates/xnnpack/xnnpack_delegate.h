@@ -108,6 +108,23 @@ TFL_CAPI_EXPORT bool TfLiteXNNPackDelegateWeightsCacheFinalizeHard(
 TFL_CAPI_EXPORT void TfLiteXNNPackDelegateWeightsCacheDelete(
     struct TfLiteXNNPackDelegateWeightsCache* cache);
 
+// Returns the process-wide weights cache for `key`, creating it on first use.
+// Interpreters of the same model, e.g. one per thread in a server, can share
+// one copy of the packed weights by passing the same key, such as the path of
+// the model file. The first interpreter packs the weights; interpreters
+// created later only look them up. Different models must use different keys.
+// The cache is soft-finalized automatically on the first Invoke of an
+// interpreter using it, so it must not be finalized by the caller. Every
+// successful call must be balanced by a call to
+// `TfLiteXNNPackDelegateWeightsCacheReleaseShared` once the delegates using
+// the cache are destroyed. Returns NULL on error.
+TFL_CAPI_EXPORT struct TfLiteXNNPackDelegateWeightsCache*
+TfLiteXNNPackDelegateWeightsCacheAcquireShared(const char* key);
+// Drops a reference taken by `TfLiteXNNPackDelegateWeightsCacheAcquireShared`.
+// The cache is destroyed when the last reference is dropped.
+TFL_CAPI_EXPORT void TfLiteXNNPackDelegateWeightsCacheReleaseShared(
+    struct TfLiteXNNPackDelegateWeightsCache* cache);
+
 #ifdef __cplusplus
 }
 #endif  // __cplusplus
@@ -90,12 +90,14 @@ GpuPlugin::GpuPlugin(const TFLiteSettings& tflite_settings)
     options_.experimental_flags |= TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY;
   }
   if (gpu_settings->cache_directory() &&
-      gpu_settings->cache_directory()->size() > 0 &&
-      gpu_settings->model_token() && gpu_settings->model_token()->size()) {
+      gpu_settings->cache_directory()->size() > 0) {
     cache_dir_ = gpu_settings->cache_directory()->str();
-    model_token_ = gpu_settings->model_token()->str();
     options_.serialization_dir = cache_dir_.c_str();
-    options_.model_token = model_token_.c_str();
+    // Without a model token, the delegate derives one from the model.
+    if (gpu_settings->model_token() && gpu_settings->model_token()->size()) {
+      model_token_ = gpu_settings->model_token()->str();
+      options_.model_token = model_token_.c_str();
+    }
     options_.experimental_flags |=
         TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION;
   }
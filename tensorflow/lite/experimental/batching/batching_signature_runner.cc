@@ -0,0 +1,244 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/batching/batching_signature_runner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace experimental {
+namespace {
+
+// Returns the bytes per row of `tensor` outside of the batch dimension, or 0
+// if `tensor` cannot be batched.
+size_t RowBytes(const TfLiteTensor* tensor) {
+  if (tensor == nullptr || tensor->dims == nullptr ||
+      tensor->dims->size < 1) {
+    return 0;
+  }
+  size_t bytes;
+  if (GetSizeOfType(/*context=*/nullptr, tensor->type, &bytes) != kTfLiteOk) {
+    return 0;
+  }
+  for (int i = 1; i < tensor->dims->size; ++i) {
+    bytes *= tensor->dims->data[i];
+  }
+  return bytes;
+}
+
+}  // namespace
+
+std::unique_ptr<BatchingSignatureRunner> BatchingSignatureRunner::Create(
+    SignatureRunner* runner, const Options& options) {
+  if (runner == nullptr || options.max_batch_size <= 0 ||
+      options.batch_timeout_micros < 0) {
+    return nullptr;
+  }
+  const std::vector<int>& sizes = options.allowed_batch_sizes;
+  for (int i = 0; i < sizes.size(); ++i) {
+    if (sizes[i] <= 0 || (i > 0 && sizes[i] <= sizes[i - 1])) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Allowed batch sizes must be increasing and positive.");
+      return nullptr;
+    }
+  }
+  if (!sizes.empty() && sizes.back() != options.max_batch_size) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "The last allowed batch size must be max_batch_size.");
+    return nullptr;
+  }
+
+  std::vector<size_t> input_row_bytes;
+  for (const char* name : runner->input_names()) {
+    const size_t row_bytes = RowBytes(runner->input_tensor(name));
+    if (row_bytes == 0) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "Input %s cannot be batched.", name);
+      return nullptr;
+    }
+    input_row_bytes.push_back(row_bytes);
+  }
+  return std::unique_ptr<BatchingSignatureRunner>(new BatchingSignatureRunner(
+      runner, options, std::move(input_row_bytes)));
+}
+
+BatchingSignatureRunner::BatchingSignatureRunner(
+    SignatureRunner* runner, const Options& options,
+    std::vector<size_t> input_row_bytes)
+    : runner_(runner),
+      options_(options),
+      input_row_bytes_(std::move(input_row_bytes)),
+      thread_([this] { BatchLoop(); }) {}
+
+BatchingSignatureRunner::~BatchingSignatureRunner() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  queue_cv_.notify_all();
+  thread_.join();
+}
+
+TfLiteStatus BatchingSignatureRunner::Invoke(int batch_size,
+                                             const std::vector<Buffer>& inputs,
+                                             std::vector<Buffer>* outputs) {
+  if (batch_size <= 0 || batch_size > options_.max_batch_size ||
+      inputs.size() != input_row_bytes_.size() || outputs == nullptr) {
+    return kTfLiteError;
+  }
+  for (int i = 0; i < inputs.size(); ++i) {
+    if (inputs[i].size() != batch_size * input_row_bytes_[i]) {
+      return kTfLiteError;
+    }
+  }
+
+  Request request;
+  request.batch_size = batch_size;
+  request.inputs = &inputs;
+  request.outputs = outputs;
+  request.enqueue_time = std::chrono::steady_clock::now();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  queue_.push_back(&request);
+  queued_rows_ += batch_size;
+  queue_cv_.notify_one();
+  done_cv_.wait(lock, [&request] { return request.done; });
+  return request.status;
+}
+
+void BatchingSignatureRunner::BatchLoop() {
+  const auto timeout =
+      std::chrono::microseconds(options_.batch_timeout_micros);
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      // Stopping, and every request has been answered.
+      return;
+    }
+    // Wait for a full batch, unless the oldest request would time out first
+    // or the runner is shutting down.
+    const auto deadline = queue_.front()->enqueue_time + timeout;
+    queue_cv_.wait_until(lock, deadline, [this] {
+      return stopping_ || queued_rows_ >= options_.max_batch_size;
+    });
+
+    std::vector<Request*> batch;
+    int batch_rows = 0;
+    while (!queue_.empty() &&
+           batch_rows + queue_.front()->batch_size <=
+               options_.max_batch_size) {
+      Request* request = queue_.front();
+      queue_.pop_front();
+      batch_rows += request->batch_size;
+      queued_rows_ -= request->batch_size;
+      batch.push_back(request);
+    }
+
+    lock.unlock();
+    RunBatch(batch);
+    lock.lock();
+    for (Request* request : batch) {
+      request->done = true;
+    }
+    done_cv_.notify_all();
+  }
+}
+
+void BatchingSignatureRunner::RunBatch(const std::vector<Request*>& batch) {
+  const TfLiteStatus status = RunBatchInternal(batch);
+  for (Request* request : batch) {
+    request->status = status;
+  }
+}
+
+TfLiteStatus BatchingSignatureRunner::RunBatchInternal(
+    const std::vector<Request*>& batch) {
+  int batch_rows = 0;
+  for (const Request* request : batch) {
+    batch_rows += request->batch_size;
+  }
+  const int padded_rows = PaddedBatchSize(batch_rows);
+  TF_LITE_ENSURE_STATUS(EnsureBatchSize(padded_rows));
+
+  // Gather the rows of every request into the inputs, and zero the padding.
+  const std::vector<const char*>& input_names = runner_->input_names();
+  for (int i = 0; i < input_names.size(); ++i) {
+    TfLiteTensor* tensor = runner_->input_tensor(input_names[i]);
+    char* dst = tensor->data.raw;
+    for (const Request* request : batch) {
+      const Buffer& src = (*request->inputs)[i];
+      std::memcpy(dst, src.data(), src.size());
+      dst += src.size();
+    }
+    std::memset(dst, 0, (padded_rows - batch_rows) * input_row_bytes_[i]);
+  }
+
+  TF_LITE_ENSURE_STATUS(runner_->Invoke());
+
+  // Scatter the output rows back to the requests they belong to.
+  const std::vector<const char*>& output_names = runner_->output_names();
+  for (Request* request : batch) {
+    request->outputs->resize(output_names.size());
+  }
+  for (int i = 0; i < output_names.size(); ++i) {
+    const TfLiteTensor* tensor = runner_->output_tensor(output_names[i]);
+    const size_t row_bytes = RowBytes(tensor);
+    if (row_bytes == 0 || tensor->dims->data[0] != padded_rows) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Output %s does not have the batch as its first "
+                      "dimension.",
+                      output_names[i]);
+      return kTfLiteError;
+    }
+    const char* src = tensor->data.raw;
+    for (Request* request : batch) {
+      const size_t size = request->batch_size * row_bytes;
+      (*request->outputs)[i].assign(src, src + size);
+      src += size;
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BatchingSignatureRunner::EnsureBatchSize(int batch_size) {
+  if (batch_size == allocated_batch_size_) {
+    return kTfLiteOk;
+  }
+  for (const char* name : runner_->input_names()) {
+    const TfLiteTensor* tensor = runner_->input_tensor(name);
+    std::vector<int> dims(tensor->dims->data,
+                          tensor->dims->data + tensor->dims->size);
+    dims[0] = batch_size;
+    TF_LITE_ENSURE_STATUS(runner_->ResizeInputTensor(name, dims));
+  }
+  // Tensors that are not resized keep their memory. The arena only grows, so
+  // returning to a batch size seen before does not allocate.
+  TF_LITE_ENSURE_STATUS(runner_->AllocateTensors());
+  allocated_batch_size_ = batch_size;
+  return kTfLiteOk;
+}
+
+int BatchingSignatureRunner::PaddedBatchSize(int batch_size) const {
+  const std::vector<int>& sizes = options_.allowed_batch_sizes;
+  auto it = std::lower_bound(sizes.begin(), sizes.end(), batch_size);
+  return it == sizes.end() ? batch_size : *it;
+}
+
+}  // namespace experimental
+}  // namespace tflite
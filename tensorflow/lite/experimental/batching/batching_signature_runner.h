@@ -0,0 +1,130 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHING_SIGNATURE_RUNNER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHING_SIGNATURE_RUNNER_H_
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/signature_runner.h"
+
+namespace tflite {
+namespace experimental {
+
+/// WARNING: Experimental interface, subject to change
+///
+/// Runs concurrent requests against a `SignatureRunner` in batches.
+///
+/// Every input and output of the signature must have the batch as its first
+/// dimension. Each call to `Invoke` carries the rows of one request. Requests
+/// are queued until `max_batch_size` rows are waiting or the oldest request
+/// has waited for `batch_timeout_micros`. They are then concatenated along the
+/// batch dimension, run with a single `SignatureRunner::Invoke`, and every
+/// request gets back the output rows that belong to it.
+///
+/// Batches are padded with zero rows up to the next of
+/// `allowed_batch_sizes`. The inputs are only resized, and the tensors only
+/// reallocated, when the padded batch size changes. With a few allowed sizes
+/// a server switches between a few shapes and the arena keeps its high water
+/// mark rather than being replanned for every request count.
+///
+/// The wrapped runner is used from a dedicated thread. It must outlive this
+/// object, and must not be used by anything else while this object exists.
+class BatchingSignatureRunner {
+ public:
+  struct Options {
+    /// Upper bound on the number of rows run in one batch.
+    int max_batch_size = 32;
+    /// How long the oldest queued request waits for more requests before a
+    /// batch smaller than `max_batch_size` is run.
+    int64_t batch_timeout_micros = 1000;
+    /// Increasing batch sizes that batches are padded to. The last one must
+    /// equal `max_batch_size`. If empty, batches run with their exact size.
+    std::vector<int> allowed_batch_sizes;
+  };
+
+  /// Raw bytes of one input or output of a request, row-major, with the
+  /// request's rows along the first dimension.
+  using Buffer = std::vector<char>;
+
+  /// Returns nullptr if `options` are invalid or an input or output of the
+  /// signature is not a fixed-size tensor with a batch dimension.
+  static std::unique_ptr<BatchingSignatureRunner> Create(
+      SignatureRunner* runner, const Options& options);
+
+  /// Waits for queued requests to finish.
+  ~BatchingSignatureRunner();
+
+  /// Runs `batch_size` rows. `inputs` holds the signature inputs in the order
+  /// of `SignatureRunner::input_names()`. On success, `outputs` holds the
+  /// signature outputs in the order of `SignatureRunner::output_names()`.
+  /// Blocks until the batch holding the request has run. Thread-safe.
+  TfLiteStatus Invoke(int batch_size, const std::vector<Buffer>& inputs,
+                      std::vector<Buffer>* outputs);
+
+ private:
+  struct Request {
+    int batch_size;
+    const std::vector<Buffer>* inputs;
+    std::vector<Buffer>* outputs;
+    std::chrono::steady_clock::time_point enqueue_time;
+    TfLiteStatus status = kTfLiteOk;
+    bool done = false;
+  };
+
+  BatchingSignatureRunner(SignatureRunner* runner, const Options& options,
+                          std::vector<size_t> input_row_bytes);
+
+  // Body of the batching thread.
+  void BatchLoop();
+  // Runs `batch` as one invocation of the signature and sets the status of
+  // every request in it.
+  void RunBatch(const std::vector<Request*>& batch);
+  TfLiteStatus RunBatchInternal(const std::vector<Request*>& batch);
+  // Resizes the inputs for `batch_size` rows unless they already have it.
+  TfLiteStatus EnsureBatchSize(int batch_size);
+  int PaddedBatchSize(int batch_size) const;
+
+  SignatureRunner* const runner_;
+  const Options options_;
+  // Bytes per row of every input, outside of the batch dimension.
+  const std::vector<size_t> input_row_bytes_;
+  // Batch size that the inputs were last allocated for, only accessed by the
+  // batching thread.
+  int allocated_batch_size_ = -1;
+
+  std::mutex mutex_;
+  // Signals the batching thread that requests were queued or that it should
+  // stop.
+  std::condition_variable queue_cv_;
+  // Signals callers of Invoke that their requests are done.
+  std::condition_variable done_cv_;
+  std::deque<Request*> queue_;
+  int queued_rows_ = 0;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace experimental
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHING_SIGNATURE_RUNNER_H_
@@ -0,0 +1,135 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/batching/batching_signature_runner.h"
+
+#include <cstring>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace experimental {
+namespace {
+
+using Buffer = BatchingSignatureRunner::Buffer;
+
+Buffer ToBuffer(const std::vector<float>& values) {
+  Buffer buffer(values.size() * sizeof(float));
+  std::memcpy(buffer.data(), values.data(), buffer.size());
+  return buffer;
+}
+
+std::vector<float> FromBuffer(const Buffer& buffer) {
+  std::vector<float> values(buffer.size() / sizeof(float));
+  std::memcpy(values.data(), buffer.data(), buffer.size());
+  return values;
+}
+
+class BatchingSignatureRunnerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ = FlatBufferModel::BuildFromFile(
+        "tensorflow/lite/testdata/multi_signatures.bin", &reporter_);
+    ASSERT_TRUE(model_);
+    ops::builtin::BuiltinOpResolver resolver;
+    ASSERT_EQ(InterpreterBuilder(*model_, resolver)(&interpreter_), kTfLiteOk);
+    // The "add" signature computes x + 2 for an input x of shape [batch].
+    runner_ = interpreter_->GetSignatureRunner("add");
+    ASSERT_NE(runner_, nullptr);
+    ASSERT_EQ(runner_->AllocateTensors(), kTfLiteOk);
+  }
+
+  TestErrorReporter reporter_;
+  std::unique_ptr<FlatBufferModel> model_;
+  std::unique_ptr<Interpreter> interpreter_;
+  SignatureRunner* runner_ = nullptr;
+};
+
+TEST_F(BatchingSignatureRunnerTest, RejectsInvalidOptions) {
+  BatchingSignatureRunner::Options options;
+  options.max_batch_size = 0;
+  EXPECT_EQ(BatchingSignatureRunner::Create(runner_, options), nullptr);
+
+  options.max_batch_size = 8;
+  options.allowed_batch_sizes = {4, 2, 8};
+  EXPECT_EQ(BatchingSignatureRunner::Create(runner_, options), nullptr);
+
+  options.allowed_batch_sizes = {2, 4};
+  EXPECT_EQ(BatchingSignatureRunner::Create(runner_, options), nullptr);
+}
+
+TEST_F(BatchingSignatureRunnerTest, RunsSingleRequest) {
+  BatchingSignatureRunner::Options options;
+  options.max_batch_size = 4;
+  options.allowed_batch_sizes = {2, 4};
+  options.batch_timeout_micros = 0;
+  auto batcher = BatchingSignatureRunner::Create(runner_, options);
+  ASSERT_NE(batcher, nullptr);
+
+  std::vector<Buffer> outputs;
+  ASSERT_EQ(batcher->Invoke(3, {ToBuffer({1, 2, 3})}, &outputs), kTfLiteOk);
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_EQ(FromBuffer(outputs[0]), std::vector<float>({3, 4, 5}));
+  // The batch was padded to the next allowed size.
+  EXPECT_EQ(runner_->input_tensor("x")->dims->data[0], 4);
+
+  // Requests that are too large or malformed are rejected.
+  EXPECT_NE(batcher->Invoke(5, {ToBuffer({1, 2, 3, 4, 5})}, &outputs),
+            kTfLiteOk);
+  EXPECT_NE(batcher->Invoke(2, {ToBuffer({1})}, &outputs), kTfLiteOk);
+}
+
+TEST_F(BatchingSignatureRunnerTest, ScattersConcurrentRequests) {
+  BatchingSignatureRunner::Options options;
+  options.max_batch_size = 8;
+  options.batch_timeout_micros = 10000;
+  auto batcher = BatchingSignatureRunner::Create(runner_, options);
+  ASSERT_NE(batcher, nullptr);
+
+  constexpr int kNumThreads = 16;
+  std::vector<std::thread> threads;
+  std::vector<TfLiteStatus> statuses(kNumThreads, kTfLiteError);
+  std::vector<std::vector<float>> results(kNumThreads);
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&, i] {
+      std::vector<Buffer> outputs;
+      const int batch_size = 1 + i % 2;
+      std::vector<float> input(batch_size, static_cast<float>(10 * i));
+      statuses[i] = batcher->Invoke(batch_size, {ToBuffer(input)}, &outputs);
+      if (statuses[i] == kTfLiteOk) {
+        results[i] = FromBuffer(outputs[0]);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumThreads; ++i) {
+    ASSERT_EQ(statuses[i], kTfLiteOk);
+    EXPECT_EQ(results[i],
+              std::vector<float>(1 + i % 2, static_cast<float>(10 * i + 2)));
+  }
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace tflite
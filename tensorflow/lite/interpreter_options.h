@@ -29,7 +29,8 @@ class InterpreterOptions {
       : experimental_preserve_all_tensors_(false),
         experimental_ensure_dynamic_tensors_are_released_(false),
         experimental_optimize_memory_for_large_tensors_(0),
-        experimental_disable_delegate_clustering_(false) {}
+        experimental_disable_delegate_clustering_(false),
+        experimental_dataflow_execution_threads_(0) {}
 
   /// Preserving all intermediates tensors for debugging.
   /// WARNING: This is an experimental API and subject to change.
@@ -93,11 +94,31 @@ class InterpreterOptions {
     experimental_disable_delegate_clustering_ = value;
   }
 
+  // Runs independent nodes of the execution plan concurrently on `value`
+  // threads, the calling thread included. Nodes are ordered by the tensors
+  // they read and write, including tensors the memory planner placed in the
+  // same arena bytes. Each concurrently running node may still use up to the
+  // interpreter's `SetNumThreads` threads itself. Values below 2 disable the
+  // feature. Graphs with dynamic tensors, tensors backed by delegate buffer
+  // handles, control edges or an installed profiler are always run
+  // sequentially.
+  // WARNING: This is an experimental API and subject to change.
+  void SetDataflowExecutionThreads(int value) {
+    experimental_dataflow_execution_threads_ = value;
+  }
+
+  // Returns the number of threads set by `SetDataflowExecutionThreads`.
+  // WARNING: This is an experimental API and subject to change.
+  int GetDataflowExecutionThreads() {
+    return experimental_dataflow_execution_threads_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_;
   bool experimental_ensure_dynamic_tensors_are_released_;
   int experimental_optimize_memory_for_large_tensors_;
   bool experimental_disable_delegate_clustering_;
+  int experimental_dataflow_execution_threads_;
 };
 
 }  // namespace tflite
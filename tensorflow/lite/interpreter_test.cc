@@ -751,6 +751,47 @@ TEST(BasicInterpreter, ReleaseNonPersistentMemory) {
 // Forcefully divides tensor allocation in three steps: one before invocation
 // and two more at invocation time. This happens because we use string tensors
 // and their sizes can't be determined until invocation time.
+
+TEST(BasicInterpreter, ArenaPlanSnapshot) {
+  TfLiteRegistration reg = GetPassthroughOpRegistration();
+  auto build_interpreter = [&](Interpreter* interpreter) {
+    ASSERT_EQ(interpreter->AddTensors(2), kTfLiteOk);
+    ASSERT_EQ(interpreter->SetInputs({0}), kTfLiteOk);
+    ASSERT_EQ(interpreter->SetOutputs({1}), kTfLiteOk);
+    TfLiteQuantizationParams quantized;
+    ASSERT_EQ(interpreter->SetTensorParametersReadWrite(
+                  0, kTfLiteFloat32, "in1", {3}, quantized),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter->SetTensorParametersReadWrite(
+                  1, kTfLiteFloat32, "out0", {3}, quantized),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter->AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                                 &reg),
+              kTfLiteOk);
+  };
+
+  Interpreter interpreter;
+  build_interpreter(&interpreter);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  const std::string snapshot = interpreter.GetArenaPlanSnapshot();
+
+  Interpreter restored_interpreter;
+  build_interpreter(&restored_interpreter);
+  EXPECT_EQ(restored_interpreter.RestoreArenaPlanSnapshot("not a snapshot"),
+            kTfLiteError);
+  ASSERT_EQ(restored_interpreter.RestoreArenaPlanSnapshot(snapshot),
+            kTfLiteOk);
+  ASSERT_EQ(restored_interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(restored_interpreter.GetArenaPlanSnapshot(), snapshot);
+
+  restored_interpreter.typed_tensor<float>(0)[0] = 1.0f;
+  restored_interpreter.typed_tensor<float>(0)[1] = 2.0f;
+  restored_interpreter.typed_tensor<float>(0)[2] = 3.0f;
+  ASSERT_EQ(restored_interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(restored_interpreter.typed_tensor<float>(1)[0], 1.0f);
+  EXPECT_EQ(restored_interpreter.typed_tensor<float>(1)[1], 2.0f);
+  EXPECT_EQ(restored_interpreter.typed_tensor<float>(1)[2], 3.0f);
+}
 TEST(BasicInterpreter, ThreeStepAllocate) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(5), kTfLiteOk);
@@ -81,6 +81,8 @@ struct OpData {
   int accum_scratch_id = kTensorNotAllocated;
   // Row sums are used to cache filter sums for hybrid zero-point calculations.
   int row_sums_id = kTensorNotAllocated;
+  // Int4 filters are unpacked into this int8 tensor before every invocation.
+  int unpacked_filter_id = kTensorNotAllocated;
 
   TfLitePaddingValues padding;
   // The scaling factor from input to output (aka the 'real multiplier') can
@@ -105,6 +107,7 @@ struct OpData {
   int32_t accum_scratch_index;
   int32_t input_offset_index;
   int32_t row_sums_index;
+  int32_t unpacked_filter_index;
 
   bool need_hwcn_weights = false;
   bool have_weights_been_transposed = false;
@@ -259,6 +262,8 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(
     data->need_im2col = false;
     data->im2col_oversized = true;
   }
+  // Read before `context->AddTensors` invalidates `filter`.
+  const bool need_unpacked_filter = filter->type == kTfLiteInt4;
   int temporaries_count = 0;
   if (data->need_im2col) {
     data->im2col_index = temporaries_count;
@@ -274,6 +279,14 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(
     }
     ++temporaries_count;
   }
+  if (need_unpacked_filter) {
+    data->unpacked_filter_index = temporaries_count;
+    if (data->unpacked_filter_id == kTensorNotAllocated) {
+      TF_LITE_ENSURE_OK(context, context->AddTensors(
+                                     context, 1, &data->unpacked_filter_id));
+    }
+    ++temporaries_count;
+  }
 
   if (is_hybrid) {
     // Allocate tensor to store the on-the-fly quantized inputs.
@@ -419,12 +432,16 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
 
   // The multi-threaded kernel supports neither dilation nor hybrid kernels, and
   // is incompatible with mutable input filters that might change between evals.
+  // It also needs a transposed copy of the filter, which is not allowed when
+  // constant weights must be kept in place.
   data->supports_multithreaded_kernel =
       (kernel_type == kMultithreadOptimized) &&
       (context->recommended_num_threads != 1) && !is_hybrid &&
       (params->dilation_width_factor == 1) &&
       (params->dilation_height_factor == 1) &&
-      (filter->allocation_type != kTfLiteArenaRw) && !IsDynamicTensor(filter);
+      (filter->allocation_type != kTfLiteArenaRw) && !IsDynamicTensor(filter) &&
+      !CpuBackendContext::GetFromContext(context)
+           ->keep_constant_weights_in_place();
 
   int channels_in = filter->dims->data[3];
   int channels_out = filter->dims->data[0];
@@ -538,6 +555,20 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     data->have_weights_been_transposed = false;
   }
 
+  if (filter->type == kTfLiteInt4) {
+    node->temporaries->data[data->unpacked_filter_index] =
+        data->unpacked_filter_id;
+    TfLiteTensor* unpacked_filter;
+    TF_LITE_ENSURE_OK(
+        context, GetTemporarySafe(context, node, data->unpacked_filter_index,
+                                  &unpacked_filter));
+    unpacked_filter->type = kTfLiteInt8;
+    unpacked_filter->allocation_type = kTfLiteArenaRw;
+    TF_LITE_ENSURE_OK(context,
+                      context->ResizeTensor(context, unpacked_filter,
+                                            TfLiteIntArrayCopy(filter->dims)));
+  }
+
   if (is_hybrid) {
     node->temporaries->data[data->input_quantized_index] =
         data->input_quantized_id;
@@ -748,8 +779,16 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
     effective_kernel_type = kReference;
   }
 
+  // Int4 filters are unpacked once into a temporary, after which every kernel
+  // can use them as int8 filters.
+  const int8_t* filter_data = GetTensorData<int8>(filter);
   if (filter->type == kTfLiteInt4) {
-    effective_kernel_type = kReference;
+    TfLiteTensor* unpacked_filter =
+        &context->tensors[node->temporaries->data[data->unpacked_filter_index]];
+    tensor_utils::UnpackDenseInt4IntoInt8(
+        GetTensorData<int8>(filter), GetTensorShape(filter).FlatSize(),
+        GetTensorData<int8>(unpacked_filter));
+    filter_data = GetTensorData<int8>(unpacked_filter);
   }
   // Grouped convolution is right now only supported on reference kernel.
   if (data->groups != 1) {
@@ -759,30 +798,14 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
   switch (effective_kernel_type) {
     case kReference: {
       switch (filter->type) {
-        case kTfLiteInt4: {
-          const size_t bytes_unpacked = filter->bytes * 2;
-          // container variable packed filter data is unpacked into in
-          // ConvPerChannelWithPackedInt4Weights before op is used on the data
-          int8_t* unpacked_filter_data =
-              new int8_t[bytes_unpacked / sizeof(int8_t)];
-          reference_integer_ops::ConvPerChannelWithPackedInt4Weights(
-              op_params, data->per_channel_output_multiplier.data(),
-              data->per_channel_output_shift.data(), GetTensorShape(input),
-              GetTensorData<int8>(input), GetTensorShape(filter),
-              GetTensorData<int8>(filter), unpacked_filter_data,
-              GetTensorShape(bias), GetTensorData<int32>(bias),
-              GetTensorShape(output), GetTensorData<int8>(output));
-          delete[] unpacked_filter_data;
-          break;
-        }
+        case kTfLiteInt4:
         case kTfLiteInt8: {
           reference_integer_ops::ConvPerChannel(
               op_params, data->per_channel_output_multiplier.data(),
               data->per_channel_output_shift.data(), GetTensorShape(input),
-              GetTensorData<int8>(input), GetTensorShape(filter),
-              GetTensorData<int8>(filter), GetTensorShape(bias),
-              GetTensorData<int32>(bias), GetTensorShape(output),
-              GetTensorData<int8>(output));
+              GetTensorData<int8>(input), GetTensorShape(filter), filter_data,
+              GetTensorShape(bias), GetTensorData<int32>(bias),
+              GetTensorShape(output), GetTensorData<int8>(output));
           break;
         }
 
@@ -800,11 +823,10 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
       optimized_integer_ops::ConvPerChannel(
           op_params, data->per_channel_output_multiplier.data(),
           data->per_channel_output_shift.data(), GetTensorShape(input),
-          GetTensorData<int8>(input), GetTensorShape(filter),
-          GetTensorData<int8>(filter), GetTensorShape(bias),
-          GetTensorData<int32>(bias), GetTensorShape(output),
-          GetTensorData<int8>(output), GetTensorShape(im2col),
-          GetTensorData<int8>(im2col),
+          GetTensorData<int8>(input), GetTensorShape(filter), filter_data,
+          GetTensorShape(bias), GetTensorData<int32>(bias),
+          GetTensorShape(output), GetTensorData<int8>(output),
+          GetTensorShape(im2col), GetTensorData<int8>(im2col),
           CpuBackendContext::GetFromContext(context));
       break;
     }
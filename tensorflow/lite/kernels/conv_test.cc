@@ -25,6 +25,8 @@ limitations under the License.
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
 #include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/test_util.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/string_type.h"
@@ -2099,6 +2101,100 @@ TEST_P(QuantizedConvolutionOpTest, SimpleTestExplicitQuantizedOp) {
                              }));
 }
 
+#ifndef TFLITE_WITH_RUY
+// Runs the multi-threaded kernel on a constant filter, with or without
+// requiring constant weights to be kept in place.
+class ConstFilterConvolutionOpModel : public SingleOpModel {
+ public:
+  explicit ConstFilterConvolutionOpModel(bool keep_constant_weights_in_place) {
+    input_ = AddInput({TensorType_FLOAT32, {2, 2, 4, 1}});
+    AddConstInput<float>({TensorType_FLOAT32, {3, 2, 2, 1}},
+                         {
+                             1, 2, 3, 4,    // first 2x2 filter
+                             -1, 1, -1, 1,  // second 2x2 filter
+                             -1, -1, 1, 1,  // third 2x2 filter
+                         });
+    bias_ = AddInput({TensorType_FLOAT32, {3}});
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, Padding_VALID, 2, 2,
+                                     ActivationFunctionType_NONE, 1, 1)
+                     .Union());
+    resolver_ = std::make_unique<SingleOpResolver>(
+        BuiltinOperator_CONV_2D,
+        ops::builtin::Register_CONVOLUTION_MULTITHREADED_OPT());
+    BuildInterpreter({GetShape(input_), {3, 2, 2, 1}, GetShape(bias_)},
+                     /*num_threads=*/2, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false, /*allocate_and_delegate=*/false);
+
+    auto cpu_backend_context = std::make_unique<CpuBackendContext>();
+    cpu_backend_context->SetMaxNumThreads(2);
+    cpu_backend_context->SetKeepConstantWeightsInPlace(
+        keep_constant_weights_in_place);
+    external_context_.set_internal_backend_context(
+        std::move(cpu_backend_context));
+    interpreter_->SetExternalContext(kTfLiteCpuBackendContext,
+                                     &external_context_);
+    AllocateAndDelegate(/*apply_delegate=*/false);
+  }
+
+  // The interpreter uses `external_context_` until it is destroyed.
+  ~ConstFilterConvolutionOpModel() { interpreter_.reset(); }
+
+  void SetInput(std::initializer_list<float> data) {
+    PopulateTensor(input_, data);
+  }
+  void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+  bool HasTransposedFilter() {
+    for (int i = 0; i < interpreter_->tensors_size(); ++i) {
+      const char* name = interpreter_->tensor(i)->name;
+      if (name != nullptr && std::string(name) == "Conv_hwcn_weights") {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  ExternalCpuBackendContext external_context_;
+  int input_;
+  int bias_;
+  int output_;
+};
+
+void TestConstFilterConvolution(bool keep_constant_weights_in_place) {
+  ConstFilterConvolutionOpModel m(keep_constant_weights_in_place);
+  EXPECT_EQ(m.HasTransposedFilter(), !keep_constant_weights_in_place);
+
+  m.SetInput({
+      // First batch
+      1, 1, 1, 1,  // row = 1
+      2, 2, 2, 2,  // row = 2
+      // Second batch
+      1, 2, 3, 4,  // row = 1
+      1, 2, 3, 4,  // row = 2
+  });
+  m.SetBias({1, 2, 3});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                 18, 2, 5,  // first batch, left
+                                 18, 2, 5,  // first batch, right
+                                 17, 4, 3,  // second batch, left
+                                 37, 4, 3,  // second batch, right
+                             }));
+}
+
+TEST(ConstFilterConvolutionOpTest, TransposesConstantFilter) {
+  TestConstFilterConvolution(/*keep_constant_weights_in_place=*/false);
+}
+
+TEST(ConstFilterConvolutionOpTest, KeepsConstantFilterInPlace) {
+  TestConstFilterConvolution(/*keep_constant_weights_in_place=*/true);
+}
+#endif
+
 INSTANTIATE_TEST_SUITE_P(
     ConvolutionOpTest, ConvolutionOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
@@ -150,6 +150,27 @@ void CpuBackendContext::SetMaxNumThreads(int max_num_threads) {
 
 void CpuBackendContext::SetUseCaching(bool flag) { use_caching_ = flag; }
 
+void CpuBackendContext::SetKeepConstantWeightsInPlace(bool flag) {
+  keep_constant_weights_in_place_ = flag;
+}
+
+void CpuBackendContext::SetGemmBackend(const GemmShape& shape,
+                                       GemmBackend backend) {
+  gemm_backends_[shape] = backend;
+}
+
+bool CpuBackendContext::GetGemmBackend(const GemmShape& shape,
+                                       GemmBackend* backend) const {
+  const auto it = gemm_backends_.find(shape);
+  if (it == gemm_backends_.end()) return false;
+  *backend = it->second;
+  return true;
+}
+
+void CpuBackendContext::SetTuneGemmBackends(bool flag) {
+  tune_gemm_backends_ = flag;
+}
+
 pthreadpool_t CpuBackendContext::get_xnnpack_threadpool() {
   if (!xnnpack_threadpool_ && max_num_threads_ > 1) {
     xnnpack_threadpool_.reset(
@@ -21,7 +21,9 @@ limitations under the License.
 #define TFLITE_X86_PLATFORM
 #endif
 
+#include <map>
 #include <memory>
+#include <tuple>
 
 #include "public/gemmlowp.h"
 #include "pthreadpool.h"  // from @pthreadpool
@@ -52,7 +54,58 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
 
   void SetUseCaching(bool flag);
 
-  bool use_caching() const { return use_caching_; }
+  // Caching is never used while constant weights are kept in place.
+  bool use_caching() const {
+    return use_caching_ && !keep_constant_weights_in_place_;
+  }
+
+  // Sets whether kernels must consume constant weights in their stored layout,
+  // directly from the tensor buffer, rather than keeping transformed copies of
+  // them (see `keep_constant_weights_in_place_`).
+  void SetKeepConstantWeightsInPlace(bool flag);
+
+  bool keep_constant_weights_in_place() const {
+    return keep_constant_weights_in_place_;
+  }
+
+  // GEMM backends that cpu_backend_gemm can pick at runtime. kDefault is the
+  // backend the build selects for the types of the GEMM (see the table in
+  // cpu_backend_gemm.h).
+  enum class GemmBackend { kDefault, kRuy };
+
+  // GEMMs of the same shape are expected to perform the same, so backends are
+  // chosen per shape.
+  struct GemmShape {
+    TfLiteType lhs_type;
+    TfLiteType rhs_type;
+    TfLiteType dst_type;
+    int rows;
+    int depth;
+    int cols;
+
+    bool operator<(const GemmShape& other) const {
+      return std::tie(lhs_type, rhs_type, dst_type, rows, depth, cols) <
+             std::tie(other.lhs_type, other.rhs_type, other.dst_type,
+                      other.rows, other.depth, other.cols);
+    }
+  };
+
+  // Sets the backend cpu_backend_gemm uses for GEMMs of `shape`. Settings are
+  // ignored where a GEMM must use ruy (e.g. with caching).
+  void SetGemmBackend(const GemmShape& shape, GemmBackend backend);
+
+  // Returns false if no backend was set or tuned for `shape`.
+  bool GetGemmBackend(const GemmShape& shape, GemmBackend* backend) const;
+
+  const std::map<GemmShape, GemmBackend>& gemm_backends() const {
+    return gemm_backends_;
+  }
+
+  // When set, the first GEMM of each shape without a backend is timed with
+  // every backend, and the fastest backend is recorded for the shape.
+  void SetTuneGemmBackends(bool flag);
+
+  bool tune_gemm_backends() const { return tune_gemm_backends_; }
 
   pthreadpool_t get_xnnpack_threadpool();
 
@@ -118,6 +171,20 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
   // (currently the Ruy library only).
   bool use_caching_;
 
+  // Some kernels transform constant weights once into buffers of the same size
+  // (e.g. the transposed filter of the multi-threaded conv kernel, or the
+  // prepacked matrices of the caching above) to run faster. When weights are
+  // backed by a memory-mapped model file, those copies double their resident
+  // memory. This flag makes such kernels pick a path that reads the weights
+  // from their tensors, so that only the pages in use need to be resident.
+  bool keep_constant_weights_in_place_ = false;
+
+  // Which backend performs best depends on the hardware and on the shape of
+  // the GEMM, so clients can choose backends per shape, e.g. by tuning them
+  // once and storing the choices.
+  std::map<GemmShape, GemmBackend> gemm_backends_;
+  bool tune_gemm_backends_ = false;
+
   // A smart pointer for the xnnpack threadpool. Is created by a call from the
   // interpreter, and then consumed by xnnpack, possibly via a TFLite kernel.
   std::unique_ptr<pthreadpool, decltype(&pthreadpool_destroy)>
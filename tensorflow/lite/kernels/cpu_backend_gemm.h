@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_H_
 #define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_H_
 
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
 #include <cstdint>
 
 #include "ruy/profiler/instrumentation.h"  // from @ruy
@@ -23,6 +25,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_gemm_custom_gemv.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_ruy.h"
+#include "tensorflow/lite/portable_type_to_tflitetype.h"
 
 #ifndef TFLITE_WITH_RUY
 #include "tensorflow/lite/kernels/cpu_backend_gemm_eigen.h"
@@ -109,6 +112,55 @@ struct GemmImpl<float, float, float, float, QuantizationFlavor::kFloatingPoint>
 
 #endif  // not TFLITE_WITH_RUY and TFLITE_X86_PLATFORM
 
+namespace detail {
+
+template <typename LhsScalar, typename RhsScalar, typename DstScalar>
+CpuBackendContext::GemmShape GetGemmShape(
+    const MatrixParams<LhsScalar>& lhs_params,
+    const MatrixParams<RhsScalar>& rhs_params,
+    const MatrixParams<DstScalar>& dst_params) {
+  return {typeToTfLiteType<LhsScalar>(),
+          typeToTfLiteType<RhsScalar>(),
+          typeToTfLiteType<DstScalar>(),
+          lhs_params.rows,
+          lhs_params.cols,
+          dst_params.cols};
+}
+
+// Runs a GEMM a few times with each backend and returns the fastest backend.
+// The last run uses the returned backend, so that its result is the one left
+// in the destination.
+template <typename RunRuy, typename RunDefault>
+CpuBackendContext::GemmBackend TuneGemmBackend(const RunRuy& run_ruy,
+                                               const RunDefault& run_default) {
+  using GemmBackend = CpuBackendContext::GemmBackend;
+#ifdef TFLITE_WITH_RUY
+  // The default backend is ruy.
+  run_default();
+  return GemmBackend::kDefault;
+#else
+  constexpr int kRuns = 3;
+  const auto min_duration = [](const auto& run) {
+    auto best = std::chrono::steady_clock::duration::max();
+    for (int i = 0; i < kRuns; ++i) {
+      const auto start = std::chrono::steady_clock::now();
+      run();
+      best = std::min(best, std::chrono::steady_clock::now() - start);
+    }
+    return best;
+  };
+  const auto ruy_duration = min_duration(run_ruy);
+  const auto default_duration = min_duration(run_default);
+  if (ruy_duration < default_duration) {
+    run_ruy();
+    return GemmBackend::kRuy;
+  }
+  return GemmBackend::kDefault;
+#endif  // TFLITE_WITH_RUY
+}
+
+}  // namespace detail
+
 /* Public entry point */
 
 template <typename LhsScalar, typename RhsScalar, typename AccumScalar,
@@ -146,29 +198,55 @@ void Gemm(const MatrixParams<LhsScalar>& lhs_params, const LhsScalar* lhs_data,
     // prefer to force usage of ruy in these cases.
     must_use_ruy = true;
   }
-  if (must_use_ruy) {
+  const auto run_ruy = [&]() {
     detail::GemmImplUsingRuy<LhsScalar, RhsScalar, AccumScalar, DstScalar,
                              quantization_flavor>::Run(lhs_params, lhs_data,
                                                        rhs_params, rhs_data,
                                                        dst_params, dst_data,
                                                        params, context);
+  };
+  if (must_use_ruy) {
+    run_ruy();
     return;
   }
-  // If we did not choose to force usage of ruy above, then we may now consider
-  // using custom GEMV code for the matrix*vector cases.
-  const bool try_custom_gemv = (dst_params.cols == 1);
-  if (try_custom_gemv) {
-    // GEMV case: try a custom fast GEMV path. It will return true if it
-    // actually handled it.
-    if (detail::CustomGemv(lhs_params, lhs_data, rhs_params, rhs_data,
-                           dst_params, dst_data, params, context)) {
+  const auto run_default = [&]() {
+    // If we did not choose to force usage of ruy above, then we may now
+    // consider using custom GEMV code for the matrix*vector cases.
+    const bool try_custom_gemv = (dst_params.cols == 1);
+    if (try_custom_gemv) {
+      // GEMV case: try a custom fast GEMV path. It will return true if it
+      // actually handled it.
+      if (detail::CustomGemv(lhs_params, lhs_data, rhs_params, rhs_data,
+                             dst_params, dst_data, params, context)) {
+        return;
+      }
+    }
+    // Generic case: dispatch to any backend as a general GEMM.
+    GemmImpl<LhsScalar, RhsScalar, AccumScalar, DstScalar,
+             quantization_flavor>::Run(lhs_params, lhs_data, rhs_params,
+                                       rhs_data, dst_params, dst_data, params,
+                                       context);
+  };
+  // Clients may have chosen a backend for GEMMs of this shape, or ask for the
+  // fastest one to be found.
+  if (context->tune_gemm_backends() || !context->gemm_backends().empty()) {
+    using GemmBackend = CpuBackendContext::GemmBackend;
+    const CpuBackendContext::GemmShape shape =
+        detail::GetGemmShape(lhs_params, rhs_params, dst_params);
+    GemmBackend backend = GemmBackend::kDefault;
+    if (!context->GetGemmBackend(shape, &backend) &&
+        context->tune_gemm_backends()) {
+      ruy::profiler::ScopeLabel tune_label("cpu_backend_gemm::Gemm: tuning");
+      context->SetGemmBackend(shape,
+                              detail::TuneGemmBackend(run_ruy, run_default));
+      return;
+    }
+    if (backend == GemmBackend::kRuy) {
+      run_ruy();
       return;
     }
   }
-  // Generic case: dispatch to any backend as a general GEMM.
-  GemmImpl<LhsScalar, RhsScalar, AccumScalar, DstScalar,
-           quantization_flavor>::Run(lhs_params, lhs_data, rhs_params, rhs_data,
-                                     dst_params, dst_data, params, context);
+  run_default();
 }
 
 // Special path for 16x8 quant gemm.
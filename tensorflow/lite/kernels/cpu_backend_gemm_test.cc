@@ -615,6 +615,52 @@ TEST(CpuBackendGemmSimpleTestAgainstGolden, Int8) {
       2, 6, 3, {13, 32, 31, 81, 50, 127});
 }
 
+TEST(CpuBackendGemmBackendSelectionTest, TunesOncePerShape) {
+  MatrixParams<float> lhs_params;
+  lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.rows = 2;
+  lhs_params.cols = 3;
+  MatrixParams<float> rhs_params;
+  rhs_params.order = cpu_backend_gemm::Order::kColMajor;
+  rhs_params.rows = 3;
+  rhs_params.cols = 4;
+  MatrixParams<float> dst_params;
+  dst_params.order = cpu_backend_gemm::Order::kColMajor;
+  dst_params.rows = 2;
+  dst_params.cols = 4;
+  const std::vector<float> lhs_data = {1, 2, 3, 4, 5, 6};
+  const std::vector<float> rhs_data = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+  const std::vector<float> bias_data = {1, 2};
+  GemmParams<float, float> params;
+  params.bias = bias_data.data();
+  const std::vector<float> golden = {15, 34, 33, 79, 51, 124, 69, 169};
+
+  CpuBackendContext cpu_backend_context;
+  cpu_backend_context.SetTuneGemmBackends(true);
+  std::vector<float> dst_data(8);
+  Gemm(lhs_params, lhs_data.data(), rhs_params, rhs_data.data(), dst_params,
+       dst_data.data(), params, &cpu_backend_context);
+  EXPECT_EQ(dst_data, golden);
+  ASSERT_EQ(cpu_backend_context.gemm_backends().size(), 1);
+  const CpuBackendContext::GemmShape& shape =
+      cpu_backend_context.gemm_backends().begin()->first;
+  EXPECT_EQ(shape.lhs_type, kTfLiteFloat32);
+  EXPECT_EQ(shape.rows, 2);
+  EXPECT_EQ(shape.depth, 3);
+  EXPECT_EQ(shape.cols, 4);
+
+  // The recorded backend is used from now on, and can be overridden.
+  for (const auto backend : {CpuBackendContext::GemmBackend::kRuy,
+                             CpuBackendContext::GemmBackend::kDefault}) {
+    cpu_backend_context.SetGemmBackend(shape, backend);
+    std::fill(dst_data.begin(), dst_data.end(), 0);
+    Gemm(lhs_params, lhs_data.data(), rhs_params, rhs_data.data(), dst_params,
+         dst_data.data(), params, &cpu_backend_context);
+    EXPECT_EQ(dst_data, golden);
+    EXPECT_EQ(cpu_backend_context.gemm_backends().size(), 1);
+  }
+}
+
 TEST(CpuBackendGemmInvalidGemmTest, Float) {
   // A standard Gemm operation.
   TestMaybeValidGemm<float, float, float, float>(2, 3, 3, 4, 2, 4);
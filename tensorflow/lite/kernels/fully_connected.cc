@@ -135,7 +135,8 @@ inline TfLiteStatus CheckTypes(TfLiteContext* context,
                                const TfLiteTensor* bias, TfLiteTensor* output,
                                TfLiteFullyConnectedParams* params) {
   const bool is_quantized =
-      ((filter->type == kTfLiteUInt8) || (filter->type == kTfLiteInt8));
+      ((filter->type == kTfLiteUInt8) || (filter->type == kTfLiteInt8) ||
+       (filter->type == kTfLiteInt4));
   const bool is_hybrid = is_quantized && (input->type == kTfLiteFloat32);
   const bool is_shuffled =
       is_quantized && (params->weights_format ==
@@ -147,7 +148,15 @@ inline TfLiteStatus CheckTypes(TfLiteContext* context,
       !bias || (bias->type == kTfLiteInt32) || (bias->type == kTfLiteInt64);
 
   if (is_quantized) {
-    if (is_shuffled) {
+    if (filter->type == kTfLiteInt4) {
+      // Int4 weights are only supported with int8 activations.
+      TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt8);
+      TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteInt8);
+      TF_LITE_ENSURE_EQ(context, params->weights_format,
+                        kTfLiteFullyConnectedWeightsFormatDefault);
+      TF_LITE_ENSURE(context, filter->sparsity == nullptr);
+      TF_LITE_ENSURE_EQ(context, is_optional_bias_int, true);
+    } else if (is_shuffled) {
       TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteUInt8);
       TF_LITE_ENSURE_TYPES_EQ(context, filter->type, kTfLiteUInt8);
       TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteInt16);
@@ -190,7 +199,8 @@ void Free(TfLiteContext* context, void* buffer) {
   delete reinterpret_cast<OpData*>(buffer);
 }
 
-TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node) {
+TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
+                         KernelType kernel_type) {
   auto* params =
       reinterpret_cast<TfLiteFullyConnectedParams*>(node->builtin_data);
   OpData* data = reinterpret_cast<OpData*>(node->user_data);
@@ -287,7 +297,8 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node) {
       //  Currently only Int8/Int16 is supported for per channel quantization.
       TF_LITE_ENSURE(context,
                      input->type == kTfLiteInt8 || input->type == kTfLiteInt16);
-      TF_LITE_ENSURE_EQ(context, filter->type, kTfLiteInt8);
+      TF_LITE_ENSURE(context, filter->type == kTfLiteInt8 ||
+                                  filter->type == kTfLiteInt4);
       TF_LITE_ENSURE_EQ(context, affine_quantization->scale->size,
                         per_channel_quantization_size);
       TF_LITE_ENSURE_EQ(
@@ -424,6 +435,23 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node) {
     }
   }
 
+  // The reference kernel unpacks int4 weights into a temporary buffer before
+  // using them, the optimized one unpacks them row by row as it goes.
+  if (filter->type == kTfLiteInt4 && kernel_type == kReference) {
+    TfLiteIntArrayFree(node->temporaries);
+    node->temporaries = TfLiteIntArrayCreate(1);
+    node->temporaries->data[0] = data->scratch_tensor_index;
+
+    TfLiteTensor* unpacked_filter;
+    TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/0,
+                                                &unpacked_filter));
+    unpacked_filter->type = kTfLiteInt8;
+    unpacked_filter->allocation_type = kTfLiteArenaRw;
+    TF_LITE_ENSURE_OK(context,
+                      context->ResizeTensor(context, unpacked_filter,
+                                            TfLiteIntArrayCopy(filter->dims)));
+  }
+
   // Resize output.
   TfLiteIntArray* output_size_array = nullptr;
   if (params->keep_num_dims) {
@@ -470,7 +498,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                 params->activation == kTfLiteActReluN1To1 ||
                                 params->activation == kTfLiteActRelu6);
   }
-  return PrepareImpl(context, node);
+  return PrepareImpl(context, node, kernel_type);
 }
 
 TfLiteStatus EvalPie(TfLiteContext* context, TfLiteNode* node,
@@ -819,6 +847,58 @@ void FullyConnectedInt8(const OpData* data, const TfLiteTensor* input,
   }
 }
 
+template <KernelType kernel_type>
+TfLiteStatus FullyConnectedPackedInt4(TfLiteContext* context, TfLiteNode* node,
+                                      const OpData* data,
+                                      const TfLiteTensor* input,
+                                      const TfLiteTensor* filter,
+                                      const TfLiteTensor* bias,
+                                      TfLiteTensor* output) {
+  const bool is_per_channel = data->per_channel_output_multiplier.size() > 1;
+  FullyConnectedParams op_params;
+  op_params.input_offset = -input->params.zero_point;
+  op_params.weights_offset = is_per_channel ? 0 : -filter->params.zero_point;
+  op_params.output_offset = output->params.zero_point;
+  op_params.output_multiplier = data->output_multiplier;
+  op_params.output_shift = data->output_shift;
+  op_params.quantized_activation_min = data->output_activation_min;
+  op_params.quantized_activation_max = data->output_activation_max;
+  if (kernel_type == kReference) {
+    TfLiteTensor* unpacked_filter;
+    TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/0,
+                                                &unpacked_filter));
+    tensor_utils::UnpackDenseInt4IntoInt8(
+        GetTensorData<int8_t>(filter), GetTensorShape(filter).FlatSize(),
+        GetTensorData<int8_t>(unpacked_filter));
+    if (is_per_channel) {
+      reference_integer_ops::FullyConnectedPerChannel(
+          op_params, data->per_channel_output_multiplier.data(),
+          data->per_channel_output_shift.data(), GetTensorShape(input),
+          GetTensorData<int8_t>(input), GetTensorShape(filter),
+          GetTensorData<int8_t>(unpacked_filter), GetTensorShape(bias),
+          GetTensorData<int32_t>(bias), GetTensorShape(output),
+          GetTensorData<int8_t>(output));
+    } else {
+      reference_integer_ops::FullyConnected(
+          op_params, GetTensorShape(input), GetTensorData<int8_t>(input),
+          GetTensorShape(filter), GetTensorData<int8_t>(unpacked_filter),
+          GetTensorShape(bias), GetTensorData<int32_t>(bias),
+          GetTensorShape(output), GetTensorData<int8_t>(output));
+    }
+  } else {
+    optimized_integer_ops::FullyConnectedWithPackedInt4Weights(
+        op_params,
+        is_per_channel ? data->per_channel_output_multiplier.data() : nullptr,
+        is_per_channel ? data->per_channel_output_shift.data() : nullptr,
+        GetTensorShape(input), GetTensorData<int8_t>(input),
+        GetTensorShape(filter), GetTensorData<int8_t>(filter),
+        GetTensorShape(bias), GetTensorData<int32_t>(bias),
+        GetTensorShape(output), GetTensorData<int8_t>(output),
+        CpuBackendContext::GetFromContext(context));
+  }
+  return kTfLiteOk;
+}
+
 template <KernelType kernel_type>
 void FullyConnectedInt16(const OpData* data, const TfLiteTensor* input,
                          const TfLiteTensor* filter, const TfLiteTensor* bias,
@@ -1001,7 +1081,10 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
         }
         break;
       case kTfLiteInt8:
-        if (filter->sparsity != nullptr) {
+        if (filter->type == kTfLiteInt4) {
+          return FullyConnectedPackedInt4<kernel_type>(
+              context, node, data, input, filter, bias, output);
+        } else if (filter->sparsity != nullptr) {
           const TfLiteSparsity& sparsity = *filter->sparsity;
           const auto input_shape = GetTensorShape(input);
           const auto filter_shape = GetTensorShape(filter);
@@ -1022,7 +1105,28 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
             return kTfLiteError;
           }
           if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
-              sparsity.dim_metadata[2].dense_size == 16) {
+              sparsity.dim_metadata[2].dense_size == 4) {
+            // Block sparse with block size of 1x4.
+            optimized_ops::FullyConnectedSparseWeight1x4(
+                sparsity, op_params,
+                is_per_channel ? data->per_channel_output_multiplier.data()
+                               : nullptr,
+                is_per_channel ? data->per_channel_output_shift.data()
+                               : nullptr,
+                input_shape, GetTensorData<int8_t>(input), filter_shape,
+                GetTensorData<int8_t>(filter), bias_shape,
+                GetTensorData<int32_t>(bias), output_shape,
+                GetTensorData<int8_t>(output),
+                CpuBackendContext::GetFromContext(context));
+          } else if (is_per_channel) {
+            TF_LITE_KERNEL_LOG(context,
+                               "Per-channel quantized and sparse "
+                               "fully-connected format supports 1x4 blocks "
+                               "only.");
+            return kTfLiteError;
+          } else if (sparsity.dim_metadata_size ==
+                         kDimMetadataSizeBlockSparse &&
+                     sparsity.dim_metadata[2].dense_size == 16) {
             // Block sparse with block size of 1x16.
             optimized_ops::FullyConnectedSparseWeight1x16(
                 sparsity, op_params, input_shape, GetTensorData<int8_t>(input),
@@ -1293,6 +1397,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
         return kTfLiteError;
       }
     case kTfLiteInt8:
+    case kTfLiteInt4:
       if (params->weights_format == kTfLiteFullyConnectedWeightsFormatDefault) {
         return EvalQuantized<kernel_type>(context, node, params, data, input,
                                           filter, bias, output);
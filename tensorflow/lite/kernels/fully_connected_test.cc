@@ -143,7 +143,8 @@ class BaseFullyConnectedOpModel : public SingleOpModel {
       FullyConnectedOptionsWeightsFormat weights_format =
           FullyConnectedOptionsWeightsFormat_DEFAULT,
       int input_size = -1, bool weights_per_channel_quantized = false,
-      std::vector<float> per_channel_quantization_scales = {})
+      std::vector<float> per_channel_quantization_scales = {},
+      const TensorType& per_channel_weights_type = TensorType_INT8)
       : batches_(batches),
         units_(units),
         input_size_(input_size),
@@ -161,29 +162,16 @@ class BaseFullyConnectedOpModel : public SingleOpModel {
     if (weights_per_channel_quantized) {
       std::vector<int64_t> per_channel_quantization_offsets(
           per_channel_quantization_scales.size(), 0);
-      if (input.type == TensorType_INT16) {
-        weights_ = AddInput({TensorType_INT8,
-                             {units_, input_size_},
-                             0,
-                             0,
-                             0,
-                             0,
-                             true,
-                             per_channel_quantization_scales,
-                             per_channel_quantization_offsets,
-                             0});
-      } else {
-        weights_ = AddInput({input.type,
-                             {units_, input_size_},
-                             0,
-                             0,
-                             0,
-                             0,
-                             true,
-                             per_channel_quantization_scales,
-                             per_channel_quantization_offsets,
-                             0});
-      }
+      weights_ = AddInput({per_channel_weights_type,
+                           {units_, input_size_},
+                           0,
+                           0,
+                           0,
+                           0,
+                           true,
+                           per_channel_quantization_scales,
+                           per_channel_quantization_offsets,
+                           0});
     } else {
       if (input.type == TensorType_INT16) {
         // Set min and max values that are used to calculate per-tensor scale
@@ -364,12 +352,14 @@ class PerChannelQuantizedFullyConnectedOpModel
       ActivationFunctionType activation_func = ActivationFunctionType_RELU,
       FullyConnectedOptionsWeightsFormat weights_format =
           FullyConnectedOptionsWeightsFormat_DEFAULT,
-      int input_size = -1)
-      : BaseFullyConnectedOpModel(
-            registration, units, batches, input, output, bias_type,
-            keep_num_dims, bias_tensor_optional, activation_func,
-            weights_format, input_size, true, per_channel_quantization_scales) {
-  }
+      int input_size = -1,
+      const TensorType& weights_type = TensorType_INT8)
+      : BaseFullyConnectedOpModel(registration, units, batches, input, output,
+                                  bias_type, keep_num_dims,
+                                  bias_tensor_optional, activation_func,
+                                  weights_format, input_size, true,
+                                  per_channel_quantization_scales,
+                                  weights_type) {}
 
   void SetBias(const std::vector<float>& data) {
     PerChannelQuantizeBias(bias_, data);
@@ -753,6 +743,38 @@ TEST_P(QuantizedFullyConnectedOpTest, SimpleTestPerChannelQuantizedInt8) {
   EXPECT_THAT(m.GetOutput<int8_t>(), ElementsAre(23, 24, 25, 57, 58, 59));
 }
 
+TEST_P(QuantizedFullyConnectedOpTest, SimpleTestPerChannelQuantizedInt4) {
+  PerChannelQuantizedFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3, /*batches*/ 2,
+      /*input=*/{TensorType_INT8, {2, 5}, -63.5, 64},
+      /*per_channel_quantization_scales=*/{0.5, 1, 2},
+      /*output=*/{TensorType_INT8, {}, -127, 128},
+      /*bias_type=*/TensorType_INT32, /*keep_num_dims=*/false,
+      /*bias_tensor_optional=*/false, ActivationFunctionType_NONE,
+      FullyConnectedOptionsWeightsFormat_DEFAULT, /*input_size=*/-1,
+      /*weights_type=*/TensorType_INT4);
+
+  // The rows of the packed weights have an odd number of values, so every
+  // other row starts in the middle of a byte.
+  m.SetWeights<int8_t>({
+      0.5, 1, 1.5, -2, 2.5,  // u = 0
+      -1, 2, -3, 4, -5,      // u = 1
+      14, -14, 2, 0, 4,      // u = 2
+  });
+  m.SetBias({1, 2, 3});
+
+  m.SetInput<int8_t>({
+      2, 2, 3, 4, 5,     // b = 0
+      -2, -2, 3, -4, 5,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetDequantizedOutput<int8_t>(),
+              ElementsAreArray(ArrayFloatNear({13, -14, 29, 23, -50, 29})));
+  EXPECT_THAT(m.GetOutput<int8_t>(), ElementsAre(12, -15, 28, 22, -51, 28));
+}
+
 TEST_P(QuantizedFullyConnectedOpTest, SimpleTestQuantizedInt16Bias32) {
   const float scale = 128.0 / 65536;
   QuantizedFullyConnectedOpModel m(
@@ -2099,6 +2121,35 @@ TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x16TestNoBias) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(10, 0, 22, 0, 0, 18));
 }
 
+TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x4Test) {
+  std::vector<float> weight_data = {
+      1,  2,  3,  4,  -1, -2, -3, -4, 0, 0, 0, 0, -4, -3, -2, -1,  // u = 0
+      0,  0,  0,  0,  0,  0,  0,  0,  0, 0, 0, 0, 0,  0,  0,  0,   // u = 1
+      -1, -2, -3, -4, 4,  3,  2,  1,  0, 0, 0, 0, 1,  2,  3,  4,   // u = 2
+  };
+  TensorData weight = {TensorType_INT8, {3, 16}, 0, 0, 1};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {1};
+  weight.block_size = {4};
+  SparseQuantizedFullyConnectedOpModel m(
+      GetRegistration(),
+      /*units=*/3, /*batches=*/2,
+      /*input=*/{TensorType_INT8, {2, 16}, 0, 0, 1}, weight, weight_data,
+      /*output=*/{TensorType_INT8, {}, 0, 0, 1});
+
+  m.SetBias({1, 2, 3});
+  m.SetInput({
+      1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4,  // b = 0
+      4, 3, 2, 1, 4, 3, 2, 1, 4, 3, 2, 1, 4, 3, 2, 1,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(0, 2, 23, 0, 2, 33));
+}
+
 TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x16TestScaledInputOutput) {
   std::initializer_list<float> weight_data = {
       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
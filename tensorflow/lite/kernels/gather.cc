@@ -32,6 +32,30 @@ constexpr int kInputTensor = 0;
 constexpr int kInputPositions = 1;
 constexpr int kOutputTensor = 0;
 
+struct OpData {
+  // Whether the output was computed already. Only used when the input and the
+  // positions are constant, e.g. for palettized weights.
+  bool constant_output_initialized;
+};
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  auto* op_data = new OpData();
+  op_data->constant_output_initialized = false;
+  return op_data;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+// Returns whether the output only depends on constant tensors, so that it can
+// be computed once and persisted.
+bool HasConstantOutput(const TfLiteTensor* input,
+                       const TfLiteTensor* positions) {
+  return input->type != kTfLiteString && IsConstantTensor(input) &&
+         IsConstantTensor(positions);
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 2);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
@@ -50,6 +74,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   switch (positions->type) {
     case kTfLiteInt64:
     case kTfLiteInt32:
+    case kTfLiteInt16:
+    case kTfLiteUInt8:
       break;
     default:
       TF_LITE_KERNEL_LOG(context,
@@ -113,6 +139,12 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   for (int i = axis + 1; i < input->dims->size; ++i) {
     output_shape->data[output_index++] = input->dims->data[i];
   }
+  // If the input and the positions are constant, the gathered values are
+  // persisted in the output, so that weights stored as indices into a palette
+  // are only expanded once.
+  if (HasConstantOutput(input, positions)) {
+    output->allocation_type = kTfLiteArenaRwPersistent;
+  }
   return context->ResizeTensor(context, output, output_shape);
 }
 
@@ -157,7 +189,7 @@ TfLiteStatus GatherStrings(TfLiteContext* context, const TfLiteTensor* input,
   }
   TF_LITE_ENSURE(context, indices_has_only_positive_elements);
 
-  const PositionT num_strings = GetStringCount(input);
+  const int num_strings = GetStringCount(input);
   const int num_indexes = NumElements(positions);
 
   for (int i = 0; i < num_indexes; ++i) {
@@ -170,7 +202,43 @@ TfLiteStatus GatherStrings(TfLiteContext* context, const TfLiteTensor* input,
   return kTfLiteOk;
 }
 
+template <typename PositionsT>
+TfLiteStatus EvalImpl(TfLiteContext* context, const TfLiteGatherParams& params,
+                      const TfLiteTensor* input, const TfLiteTensor* positions,
+                      TfLiteTensor* output) {
+  switch (input->type) {
+    case kTfLiteFloat32:
+      return Gather<float, PositionsT>(context, params, input, positions,
+                                       output);
+    case kTfLiteUInt8:
+      return Gather<uint8_t, PositionsT>(context, params, input, positions,
+                                         output);
+    case kTfLiteInt8:
+      return Gather<int8_t, PositionsT>(context, params, input, positions,
+                                        output);
+    case kTfLiteInt16:
+      return Gather<int16_t, PositionsT>(context, params, input, positions,
+                                         output);
+    case kTfLiteInt32:
+      return Gather<int32_t, PositionsT>(context, params, input, positions,
+                                         output);
+    case kTfLiteInt64:
+      return Gather<int64_t, PositionsT>(context, params, input, positions,
+                                         output);
+    case kTfLiteBool:
+      return Gather<bool, PositionsT>(context, params, input, positions,
+                                      output);
+    case kTfLiteString:
+      return GatherStrings<PositionsT>(context, input, positions, output);
+    default:
+      TF_LITE_KERNEL_LOG(context, "Type '%s' is not supported by gather.",
+                         TfLiteTypeGetName(input->type));
+      return kTfLiteError;
+  }
+}
+
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
   const auto* params =
       reinterpret_cast<const TfLiteGatherParams*>(node->builtin_data);
   const TfLiteTensor* input;
@@ -182,98 +250,44 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context,
                     GetOutputSafe(context, node, kOutputTensor, &output));
 
-  TfLiteStatus status = kTfLiteError;
-  if (positions->type == kTfLiteInt32) {
-    switch (input->type) {
-      case kTfLiteFloat32:
-        status =
-            Gather<float, int32_t>(context, *params, input, positions, output);
-        break;
-      case kTfLiteUInt8:
-        status = Gather<uint8_t, int32_t>(context, *params, input, positions,
-                                          output);
-        break;
-      case kTfLiteInt8:
-        status =
-            Gather<int8_t, int32_t>(context, *params, input, positions, output);
-        break;
-      case kTfLiteInt16:
-        status = Gather<int16_t, int32_t>(context, *params, input, positions,
-                                          output);
-        break;
-      case kTfLiteInt32:
-        status = Gather<int32_t, int32_t>(context, *params, input, positions,
-                                          output);
-        break;
-      case kTfLiteInt64:
-        status = Gather<int64_t, int32_t>(context, *params, input, positions,
-                                          output);
-        break;
-      case kTfLiteBool:
-        status =
-            Gather<bool, int32_t>(context, *params, input, positions, output);
-        break;
-      case kTfLiteString:
-        status = GatherStrings<int32_t>(context, input, positions, output);
-        break;
-      default:
-        TF_LITE_KERNEL_LOG(context, "Type '%s' is not supported by gather.",
-                           TfLiteTypeGetName(input->type));
-        return kTfLiteError;
-    }
+  const bool has_constant_output = HasConstantOutput(input, positions);
+  if (has_constant_output && op_data->constant_output_initialized) {
+    return kTfLiteOk;
   }
-  if (positions->type == kTfLiteInt64) {
-    switch (input->type) {
-      case kTfLiteFloat32:
-        status =
-            Gather<float, int64_t>(context, *params, input, positions, output);
-        break;
-      case kTfLiteUInt8:
-        status = Gather<uint8_t, int64_t>(context, *params, input, positions,
-                                          output);
-        break;
-      case kTfLiteInt8:
-        status =
-            Gather<int8_t, int64_t>(context, *params, input, positions, output);
-        break;
-      case kTfLiteInt16:
-        status = Gather<int16_t, int64_t>(context, *params, input, positions,
-                                          output);
-        break;
-      case kTfLiteInt32:
-        status = Gather<int32_t, int64_t>(context, *params, input, positions,
-                                          output);
-        break;
-      case kTfLiteInt64:
-        status = Gather<int64_t, int64_t>(context, *params, input, positions,
-                                          output);
-        break;
-      case kTfLiteBool:
-        status =
-            Gather<bool, int64_t>(context, *params, input, positions, output);
-        break;
-      case kTfLiteString:
-        status = GatherStrings<int64_t>(context, input, positions, output);
-        break;
-      default:
-        TF_LITE_KERNEL_LOG(context, "Type '%s' is not supported by gather.",
-                           TfLiteTypeGetName(input->type));
-        return kTfLiteError;
-    }
+
+  TfLiteStatus status = kTfLiteError;
+  switch (positions->type) {
+    case kTfLiteInt32:
+      status = EvalImpl<int32_t>(context, *params, input, positions, output);
+      break;
+    case kTfLiteInt64:
+      status = EvalImpl<int64_t>(context, *params, input, positions, output);
+      break;
+    case kTfLiteInt16:
+      status = EvalImpl<int16_t>(context, *params, input, positions, output);
+      break;
+    case kTfLiteUInt8:
+      status = EvalImpl<uint8_t>(context, *params, input, positions, output);
+      break;
+    default:
+      TF_LITE_KERNEL_LOG(context,
+                         "Positions of type '%s' are not supported by gather.",
+                         TfLiteTypeGetName(positions->type));
+      return kTfLiteError;
   }
   if (status != kTfLiteOk) {
     TF_LITE_KERNEL_LOG(context, "gather index out of bounds");
+    return status;
   }
-  return status;
-  TF_LITE_KERNEL_LOG(context,
-                     "Positions of type '%s' are not supported by gather.",
-                     TfLiteTypeGetName(positions->type));
-  return kTfLiteError;
+  if (has_constant_output) {
+    op_data->constant_output_initialized = true;
+  }
+  return kTfLiteOk;
 }
 }  // namespace gather
 
 TfLiteRegistration* Register_GATHER() {
-  static TfLiteRegistration r = {nullptr, nullptr, gather::Prepare,
+  static TfLiteRegistration r = {gather::Init, gather::Free, gather::Prepare,
                                  gather::Eval};
   return &r;
 }
@@ -216,6 +216,24 @@ TEST(TypesGatherOpTest, Float32Int64) {
   EXPECT_THAT(m.GetOutput<float>(), ElementsAreArray({-1.4, 1.5, 13.3, -13.4}));
 }
 
+TEST(TypesGatherOpTest, Float32Uint8) {
+  GatherOpModel m({TensorType_FLOAT32, {2, 2}}, {TensorType_UINT8, {2}});
+  m.SetInput<float>({13.3, -13.4, -1.4, 1.5});
+  m.SetPositions<uint8_t>({1, 0});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput<float>(), ElementsAreArray({-1.4, 1.5, 13.3, -13.4}));
+}
+
+TEST(TypesGatherOpTest, Float32Int16) {
+  GatherOpModel m({TensorType_FLOAT32, {2, 2}}, {TensorType_INT16, {2}});
+  m.SetInput<float>({13.3, -13.4, -1.4, 1.5});
+  m.SetPositions<int16_t>({1, 0});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput<float>(), ElementsAreArray({-1.4, 1.5, 13.3, -13.4}));
+}
+
 TEST(TypesGatherOpTest, Int32Int32) {
   GatherOpModel m({TensorType_INT32, {2, 2}}, {TensorType_INT32, {2}});
   m.SetInput<int32_t>({-1330, 1340, 140, -150});
@@ -408,6 +426,45 @@ TEST(TypesGatherOpTest, BatchDimsEqualIndiceDims) {
               ElementsAreArray({1, 5, 10, 16, 21, 25, 30, 36}));
 }
 
+// Gathers from a constant palette with constant indices, as palettized
+// weights are stored.
+class ConstGatherOpModel : public SingleOpModel {
+ public:
+  ConstGatherOpModel(const std::vector<float>& palette,
+                     const std::vector<int>& indices_shape,
+                     const std::vector<uint8_t>& indices) {
+    const int palette_tensor = AddConstInput(
+        {TensorType_FLOAT32, {static_cast<int>(palette.size())}}, palette);
+    const int indices_tensor =
+        AddConstInput({TensorType_UINT8, indices_shape}, indices);
+    output_ = AddOutput(TensorType_FLOAT32);
+    SetBuiltinOp(BuiltinOperator_GATHER, BuiltinOptions_GatherOptions,
+                 CreateGatherOptions(builder_, /*axis=*/0).Union());
+    BuildInterpreter({GetShape(palette_tensor), GetShape(indices_tensor)});
+  }
+
+  TfLiteTensor* GetOutputTensor() { return interpreter_->tensor(output_); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  int output_;
+};
+
+TEST(GatherOpTest, ConstantPaletteIsPersisted) {
+  ConstGatherOpModel m({-1.0, 0.5, 2.0}, {2, 3}, {2, 0, 1, 1, 2, 0});
+  EXPECT_EQ(m.GetOutputTensor()->allocation_type, kTfLiteArenaRwPersistent);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 3}));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                {2.0, -1.0, 0.5, 0.5, 2.0, -1.0})));
+
+  // The output is only computed on the first invocation.
+  m.GetOutputTensor()->data.f[0] = 0.0;
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_FLOAT_EQ(m.GetOutput()[0], 0.0);
+}
+
 TEST(GatherOpTest, ErrorOnOutOfBoundsTooLarge) {
   GatherOpModel m({TensorType_FLOAT32, {2, 2}}, {TensorType_INT32, {2}});
   m.SetInput<float>({
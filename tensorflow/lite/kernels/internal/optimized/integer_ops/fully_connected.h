@@ -15,13 +15,18 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_FULLY_CONNECTED_H_
 #define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_FULLY_CONNECTED_H_
 
+#include <algorithm>
+#include <vector>
+
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/internal/types.h"
 
 namespace tflite {
@@ -166,6 +171,159 @@ inline void FullyConnected(
                          cpu_backend_context);
 }
 
+// Computes the output rows [row_start, row_end) of a fully-connected layer
+// whose int8 weights are densely packed as int4, two per byte. Every row of
+// weights is unpacked into `unpacked_row`, which holds at least
+// `accum_depth + 1` values, right before it is multiplied with all the
+// batches, so the weights are only ever read from memory in their packed
+// form. `output_multiplier` and `output_shift` are per output row, or null
+// for the per-tensor parameters of `params`.
+inline void FullyConnectedWithPackedInt4WeightsImpl(
+    const FullyConnectedParams& params, const int32* output_multiplier,
+    const int* output_shift, const int8* input_data, const int8* filter_data,
+    const int32* bias_data, int batches, int output_depth, int accum_depth,
+    int row_start, int row_end, int8* unpacked_row, int8* output_data) {
+  const int32 input_offset = params.input_offset;
+  const int32 filter_offset = params.weights_offset;
+  const int32 output_offset = params.output_offset;
+  const int32 output_activation_min = params.quantized_activation_min;
+  const int32 output_activation_max = params.quantized_activation_max;
+  for (int out_c = row_start; out_c < row_end; ++out_c) {
+    // Rows start in the middle of a byte when `accum_depth` is odd.
+    const int row_offset = out_c * accum_depth;
+    const int skipped = row_offset % 2;
+    tensor_utils::UnpackDenseInt4IntoInt8(filter_data + row_offset / 2,
+                                          accum_depth + skipped, unpacked_row);
+    const int8* row = unpacked_row + skipped;
+    int32 row_sum = 0;
+    for (int d = 0; d < accum_depth; ++d) {
+      row_sum += row[d];
+    }
+    const int32 multiplier =
+        output_multiplier ? output_multiplier[out_c] : params.output_multiplier;
+    const int shift = output_shift ? output_shift[out_c] : params.output_shift;
+    for (int b = 0; b < batches; ++b) {
+      const int8* input = input_data + b * accum_depth;
+      int32 acc = 0;
+      int32 input_sum = 0;
+      for (int d = 0; d < accum_depth; ++d) {
+        acc += static_cast<int32>(row[d]) * static_cast<int32>(input[d]);
+        input_sum += input[d];
+      }
+      acc += input_offset * row_sum + filter_offset * input_sum +
+             accum_depth * input_offset * filter_offset;
+      if (bias_data) {
+        acc += bias_data[out_c];
+      }
+      acc = MultiplyByQuantizedMultiplier(acc, multiplier, shift);
+      acc += output_offset;
+      acc = std::max(acc, output_activation_min);
+      acc = std::min(acc, output_activation_max);
+      output_data[out_c + output_depth * b] = static_cast<int8>(acc);
+    }
+  }
+}
+
+struct FullyConnectedWithPackedInt4WeightsTask : cpu_backend_threadpool::Task {
+  FullyConnectedWithPackedInt4WeightsTask(
+      const FullyConnectedParams& params, const int32* output_multiplier,
+      const int* output_shift, const int8* input_data,
+      const int8* filter_data, const int32* bias_data, int batches,
+      int output_depth, int accum_depth, int row_start, int row_end,
+      int8* output_data)
+      : params_(params),
+        output_multiplier_(output_multiplier),
+        output_shift_(output_shift),
+        input_data_(input_data),
+        filter_data_(filter_data),
+        bias_data_(bias_data),
+        batches_(batches),
+        output_depth_(output_depth),
+        accum_depth_(accum_depth),
+        row_start_(row_start),
+        row_end_(row_end),
+        output_data_(output_data) {}
+
+  void Run() override {
+    std::vector<int8> unpacked_row(accum_depth_ + 1);
+    FullyConnectedWithPackedInt4WeightsImpl(
+        params_, output_multiplier_, output_shift_, input_data_, filter_data_,
+        bias_data_, batches_, output_depth_, accum_depth_, row_start_,
+        row_end_, unpacked_row.data(), output_data_);
+  }
+
+  const FullyConnectedParams& params_;
+  const int32* output_multiplier_;
+  const int* output_shift_;
+  const int8* input_data_;
+  const int8* filter_data_;
+  const int32* bias_data_;
+  int batches_;
+  int output_depth_;
+  int accum_depth_;
+  int row_start_;
+  int row_end_;
+  int8* output_data_;
+};
+
+// Fully-connected layer with int8 inputs and outputs and int4 weights packed
+// two per byte, as stored in the model. Unlike the reference kernel, it never
+// unpacks the whole weights tensor, and shards the output rows over the
+// threads of `cpu_backend_context`. Per-channel quantization is used when
+// `output_multiplier` and `output_shift` are not null.
+inline void FullyConnectedWithPackedInt4Weights(
+    const FullyConnectedParams& params, const int32* output_multiplier,
+    const int* output_shift, const RuntimeShape& input_shape,
+    const int8* input_data, const RuntimeShape& filter_shape,
+    const int8* filter_data, const RuntimeShape& bias_shape,
+    const int32* bias_data, const RuntimeShape& output_shape,
+    int8* output_data, CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("FullyConnectedInt8/4bitWeights");
+
+  TFLITE_DCHECK_GE(filter_shape.DimensionsCount(), 2);
+  TFLITE_DCHECK_GE(output_shape.DimensionsCount(), 1);
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  const int output_dim_count = output_shape.DimensionsCount();
+  const int filter_dim_count = filter_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dim_count - 1);
+  const int output_depth = MatchingDim(filter_shape, filter_dim_count - 2,
+                                       output_shape, output_dim_count - 1);
+  const int accum_depth = filter_shape.Dims(filter_dim_count - 1);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+  }
+
+  static constexpr int kKernelRows = 4;
+  const int thread_count = LegacyHowManyThreads<kKernelRows>(
+      cpu_backend_context->max_num_threads(), output_depth, batches,
+      accum_depth);
+  if (thread_count == 1) {
+    std::vector<int8> unpacked_row(accum_depth + 1);
+    FullyConnectedWithPackedInt4WeightsImpl(
+        params, output_multiplier, output_shift, input_data, filter_data,
+        bias_data, batches, output_depth, accum_depth, /*row_start=*/0,
+        /*row_end=*/output_depth, unpacked_row.data(), output_data);
+    return;
+  }
+
+  std::vector<FullyConnectedWithPackedInt4WeightsTask> tasks;
+  tasks.reserve(thread_count);
+  const int rows_per_thread =
+      RoundUp<kKernelRows>(CeilQuotient(output_depth, thread_count));
+  int row_start = 0;
+  for (int i = 0; i < thread_count && row_start < output_depth; ++i) {
+    const int row_end = std::min(output_depth, row_start + rows_per_thread);
+    tasks.emplace_back(params, output_multiplier, output_shift, input_data,
+                       filter_data, bias_data, batches, output_depth,
+                       accum_depth, row_start, row_end, output_data);
+    row_start = row_end;
+  }
+  TFLITE_DCHECK_EQ(row_start, output_depth);
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
 }  // namespace optimized_integer_ops
 }  // namespace tflite
 
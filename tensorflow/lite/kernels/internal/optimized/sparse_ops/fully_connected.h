@@ -112,6 +112,40 @@ inline void FullyConnectedSparseWeight1x16Impl(
       output_data + thread_start * output_depth);
 }
 
+// `per_channel_multiplier` and `per_channel_shift` are null for per-tensor
+// quantized weights.
+inline void FullyConnectedSparseWeight1x4Impl(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const int32_t* per_channel_multiplier, const int32_t* per_channel_shift,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const RuntimeShape& weights_shape, const int8_t* weights_data,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data, int thread_start,
+    int thread_end, const CpuBackendContext& cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("1x4 Block Sparse");
+
+  const int input_dims_count = input_shape.DimensionsCount();
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int weights_dims_count = weights_shape.DimensionsCount();
+  const int batches = thread_end - thread_start;
+  const int input_depth = MatchingDim(weights_shape, weights_dims_count - 1,
+                                      input_shape, input_dims_count - 1);
+  const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
+                                       output_shape, output_dims_count - 1);
+  const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
+  const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
+
+  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
+      weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
+      weights_shape.Dims(1), input_data + thread_start * input_depth, bias_data,
+      batches, params.input_offset, params.output_multiplier,
+      params.output_shift, per_channel_multiplier, per_channel_shift,
+      params.output_offset, params.quantized_activation_min,
+      params.quantized_activation_max,
+      output_data + thread_start * output_depth);
+}
+
 inline void FullyConnectedSparseWeight1x4Impl(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const float* input_data,
@@ -216,6 +250,24 @@ inline void FullyConnectedSparseWeight1x16(
       *cpu_backend_context);
 }
 
+inline void FullyConnectedSparseWeight1x4(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const int32_t* per_channel_multiplier, const int32_t* per_channel_shift,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const RuntimeShape& weights_shape, const int8_t* weights_data,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  const int batches =
+      FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
+
+  // TODO(b/220851507): Add multi-thread support for quantized sparse kernel.
+  return FullyConnectedSparseWeight1x4Impl(
+      sparsity, params, per_channel_multiplier, per_channel_shift, input_shape,
+      input_data, weights_shape, weights_data, bias_shape, bias_data,
+      output_shape, output_data, 0, batches, *cpu_backend_context);
+}
+
 // The multi-threaded kernel slices the workload along the batch dimension. If
 // there's not enough batches of data, the number of threads used is equal to
 // the batch size. We can improve this later with slicing along the row
@@ -17,6 +17,7 @@ limitations under the License.
 #ifdef __SSSE3__
 
 #include <emmintrin.h>  // SSE2
+#include <pmmintrin.h>  // SSE3
 #include <tmmintrin.h>  // SSSE3
 #ifdef __SSE4_1__
 #include <smmintrin.h>  // SSE4.1
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
+#include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 
 namespace tflite {
@@ -86,7 +88,6 @@ static inline int32_t ReduceInt32x4(__m128i acc) {
   return _mm_cvtsi128_si32(acc);
 }
 
-#ifdef __AVX2__
 // Horizontally add 4 float values stored in a single XMM register to float.
 static inline float ReduceFloat32x4(__m128 acc) {
   __m128 shuffle = _mm_movehdup_ps(acc);
@@ -96,6 +97,7 @@ static inline float ReduceFloat32x4(__m128 acc) {
   return _mm_cvtss_f32(acc);
 }
 
+#ifdef __AVX2__
 // Horizontally add 8 float values stored in a single XMM register to float.
 static inline float ReduceFloat32x8(__m256 acc) {
   __m128 low = _mm256_extractf128_ps(acc, 0);
@@ -617,6 +619,143 @@ void SseSparseMatrixBatchVectorMultiplyAccumulate(
   }  // for batch
 }
 
+void SseSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  static constexpr std::intptr_t kBlockSize = 4;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+  for (std::intptr_t batch = 0; batch < n_batch; ++batch) {
+    const float* __restrict__ matrix_ptr = matrix;
+    const float* __restrict__ vector_in_batch = vector + batch * m_cols;
+    for (std::intptr_t row = 0; row < m_rows; ++row) {
+      __m128 acc_fx4 = _mm_setzero_ps();
+      std::intptr_t i = segments[row];
+      const std::intptr_t end = segments[row + 1];
+#ifdef __AVX2__
+      // Two blocks per iteration: the blocks of the matrix are contiguous, the
+      // matching parts of the vector are loaded into both halves of a YMM
+      // register.
+      __m256 acc_fx8 = _mm256_setzero_ps();
+      for (; i + 1 < end; i += 2) {
+        const __m256 vec_fx8 = _mm256_insertf128_ps(
+            _mm256_castps128_ps256(
+                _mm_loadu_ps(vector_in_batch + indices[i] * kBlockSize)),
+            _mm_loadu_ps(vector_in_batch + indices[i + 1] * kBlockSize), 1);
+        const __m256 row_fx8 = _mm256_loadu_ps(matrix_ptr);
+        acc_fx8 = _mm256_add_ps(acc_fx8, _mm256_mul_ps(vec_fx8, row_fx8));
+        matrix_ptr += 2 * kBlockSize;
+      }
+      acc_fx4 = _mm_add_ps(_mm256_castps256_ps128(acc_fx8),
+                           _mm256_extractf128_ps(acc_fx8, 1));
+#endif  // __AVX2__
+      for (; i < end; ++i) {
+        const __m128 vec_fx4 =
+            _mm_loadu_ps(vector_in_batch + indices[i] * kBlockSize);
+        const __m128 row_fx4 = _mm_loadu_ps(matrix_ptr);
+        acc_fx4 = _mm_add_ps(acc_fx4, _mm_mul_ps(vec_fx4, row_fx4));
+        matrix_ptr += kBlockSize;
+      }
+      result[batch * m_rows + row] += ReduceFloat32x4(acc_fx4);
+    }  // for row
+  }  // for batch
+}
+
+void SseSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  static constexpr std::intptr_t kBlockSize = 4;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+  const __m128i ones_8x16 = _mm_set1_epi8(1);
+#ifdef __AVX2__
+  const __m256i ones_8x32 = _mm256_set1_epi8(1);
+#endif  // __AVX2__
+  for (std::intptr_t batch = 0; batch < n_batch; ++batch) {
+    const int8_t* __restrict__ matrix_ptr = matrix;
+    const int8_t* __restrict__ vector_in_batch = vector + batch * m_cols;
+    for (std::intptr_t row = 0; row < m_rows; ++row) {
+      // The dot product of the row and the vector, and the sum of the row
+      // (for the input offset).
+      __m128i dotprod_32x4 = _mm_setzero_si128();
+      __m128i row_sum_32x4 = _mm_setzero_si128();
+      std::intptr_t i = segments[row];
+      const std::intptr_t end = segments[row + 1];
+#ifdef __AVX2__
+      // Eight blocks per iteration: the blocks of the matrix are contiguous,
+      // the matching parts of the vector are gathered.
+      __m256i dotprod_32x8 = _mm256_setzero_si256();
+      __m256i row_sum_32x8 = _mm256_setzero_si256();
+      for (; i + 7 < end; i += 8) {
+        const __m256i offsets_32x8 = _mm256_slli_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i)),
+            2);
+        const __m256i vec_8x32 = _mm256_i32gather_epi32(
+            reinterpret_cast<const int*>(vector_in_batch), offsets_32x8, 1);
+        const __m256i row_8x32 =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(matrix_ptr));
+        dotprod_32x8 =
+            _mm256_add_epi32(dotprod_32x8, DotProdInt8x4x8(vec_8x32, row_8x32));
+        row_sum_32x8 = _mm256_add_epi32(row_sum_32x8,
+                                        DotProdInt8x4x8(ones_8x32, row_8x32));
+        matrix_ptr += 8 * kBlockSize;
+      }
+      dotprod_32x4 = _mm_add_epi32(_mm256_castsi256_si128(dotprod_32x8),
+                                   _mm256_extracti128_si256(dotprod_32x8, 1));
+      row_sum_32x4 = _mm_add_epi32(_mm256_castsi256_si128(row_sum_32x8),
+                                   _mm256_extracti128_si256(row_sum_32x8, 1));
+#endif  // __AVX2__
+      // Four blocks per iteration.
+      for (; i + 3 < end; i += 4) {
+        const __m128i vec0_8x4 =
+            _mm_loadu_si32(vector_in_batch + indices[i] * kBlockSize);
+        const __m128i vec1_8x4 =
+            _mm_loadu_si32(vector_in_batch + indices[i + 1] * kBlockSize);
+        const __m128i vec2_8x4 =
+            _mm_loadu_si32(vector_in_batch + indices[i + 2] * kBlockSize);
+        const __m128i vec3_8x4 =
+            _mm_loadu_si32(vector_in_batch + indices[i + 3] * kBlockSize);
+        const __m128i vec_8x16 =
+            _mm_unpacklo_epi64(_mm_unpacklo_epi32(vec0_8x4, vec1_8x4),
+                               _mm_unpacklo_epi32(vec2_8x4, vec3_8x4));
+        const __m128i row_8x16 =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(matrix_ptr));
+        dotprod_32x4 =
+            _mm_add_epi32(dotprod_32x4, DotProdInt8x4x4(vec_8x16, row_8x16));
+        row_sum_32x4 =
+            _mm_add_epi32(row_sum_32x4, DotProdInt8x4x4(ones_8x16, row_8x16));
+        matrix_ptr += 4 * kBlockSize;
+      }
+      // Postamble for the remaining blocks, one block at a time.
+      for (; i < end; ++i) {
+        const __m128i vec_8x4 =
+            _mm_loadu_si32(vector_in_batch + indices[i] * kBlockSize);
+        const __m128i row_8x4 = _mm_loadu_si32(matrix_ptr);
+        dotprod_32x4 =
+            _mm_add_epi32(dotprod_32x4, DotProdInt8x4x4(vec_8x4, row_8x4));
+        row_sum_32x4 =
+            _mm_add_epi32(row_sum_32x4, DotProdInt8x4x4(ones_8x16, row_8x4));
+        matrix_ptr += kBlockSize;
+      }
+      int32_t acc = ReduceInt32x4(dotprod_32x4) +
+                    input_offset * ReduceInt32x4(row_sum_32x4);
+      if (bias_vector != nullptr) acc += bias_vector[row];
+      acc = MultiplyByQuantizedMultiplier(
+          acc, per_channel_scale ? per_channel_scale[row] : output_multiplier,
+          per_channel_shift ? per_channel_shift[row] : output_shift);
+      acc += output_offset;
+      result[batch * m_rows + row] =
+          static_cast<int8_t>(ActivationFunctionWithMinMax(
+              acc, output_activation_min, output_activation_max));
+    }  // for row
+  }  // for batch
+}
+
 void SseReductionSumVector(const int8_t* input_vector, int32_t* output_vector,
                            const int output_size, const int reduction_size) {
   static constexpr std::intptr_t kBlockSize = 16;
@@ -16,8 +16,9 @@ limitations under the License.
 #define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SSE_TENSOR_UTILS_H_
 
 // Note: This file is a copy-paste version of neon_tensor_utils.h, only
-// difference is in MatrixBatchVectorMultiplyAccumulate and
-// SparseMatrixBatchVectorMultiplyAccumulate (other functions do not have SSE
+// difference is in MatrixBatchVectorMultiplyAccumulate,
+// SparseMatrixBatchVectorMultiplyAccumulate and
+// SparseMatrixBatchVectorMultiplyAccumulate1x4 (other functions do not have SSE
 // implementation yet).
 
 // Note: Most of the functions below use NEON_OR_PORTABLE, through the Intel
@@ -80,8 +81,8 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x4(
     const float* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
     const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
-  NEON_OR_PORTABLE(SparseMatrixBatchVectorMultiplyAccumulate1x4, matrix,
-                   segments, indices, m_rows, m_cols, vector, n_batch, result);
+  SSE_OR_PORTABLE(SparseMatrixBatchVectorMultiplyAccumulate1x4, matrix,
+                  segments, indices, m_rows, m_cols, vector, n_batch, result);
 }
 
 void SparseMatrixBatchVectorMultiplyAccumulate1x16(
@@ -99,6 +100,22 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x16(
                    result);
 }
 
+void SparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  SSE_OR_PORTABLE(SparseMatrixBatchVectorMultiplyAccumulate1x4, matrix,
+                  segments, indices, m_rows, m_cols, vector, bias_vector,
+                  n_batch, input_offset, output_multiplier, output_shift,
+                  per_channel_scale, per_channel_shift, output_offset,
+                  output_activation_min, output_activation_max, result);
+}
+
 void SparseMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ matrix, const uint8_t* __restrict__ ledger,
     int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
@@ -245,6 +245,24 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int32_t output_activation_min, const int32_t output_activation_max,
     int8_t* __restrict__ result);
 
+// Same as the function above, but the matrix is a sparse tensor with block
+// pattern 1x4, and the matrix may be quantized per row: when
+// `per_channel_scale` and `per_channel_shift` are not null, they hold the
+// output multiplier and shift of each row and override `output_multiplier` and
+// `output_shift`.
+// This function assumes that m_cols is a multiple of the block size (4 in this
+// case) so that there's no incomplete block, and that the matrix is quantized
+// symmetrically.
+void SparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result);
+
 // Same as the function above, but the matrix is stored in block compressed
 // sparse row format with block pattern 1x16 which consists of two arrays:
 //   1. A matrix array stores non-zero blocks of the matrix in row major.
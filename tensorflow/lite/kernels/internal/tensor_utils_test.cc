@@ -1554,6 +1554,113 @@ TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulateTest) {
               ElementsAreArray(ArrayFloatNear(dense_output, 1e-4)));
 }
 
+TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulate1x4Test) {
+  const int kRow = 3;
+  const int kCol = 40;
+  const int kBatch = 2;
+  const int kBlockSize = 4;
+  // Row 0 has more blocks than the widest vectorized loop handles at once, so
+  // that all of the loops of vectorized implementations run.
+  const int32_t segments[] = {0, 9, 9, 12};
+  const int32_t indices[] = {0, 1, 2, 3, 4, 5, 6, 7, 9,  // 1st row
+                             /* 2nd row is empty */
+                             1, 4, 8};  // 3rd row
+  const int num_blocks = segments[kRow];
+
+  std::vector<float> matrix_values(num_blocks * kBlockSize);
+  std::vector<float> dense_matrix(kRow * kCol, 0.0f);
+  for (int row = 0; row < kRow; ++row) {
+    for (int i = segments[row]; i < segments[row + 1]; ++i) {
+      for (int c = 0; c < kBlockSize; ++c) {
+        const float value = 0.5f * ((i * kBlockSize + c) % 7) - 1.5f;
+        matrix_values[i * kBlockSize + c] = value;
+        dense_matrix[row * kCol + indices[i] * kBlockSize + c] = value;
+      }
+    }
+  }
+  std::vector<float> vector(kBatch * kCol);
+  for (int i = 0; i < kBatch * kCol; ++i) {
+    vector[i] = 0.25f * (i % 9) - 1.0f;
+  }
+
+  std::vector<float> dense_output(kRow * kBatch, 1.0f);
+  MatrixBatchVectorMultiplyAccumulate(dense_matrix.data(), kRow, kCol,
+                                      vector.data(), kBatch,
+                                      dense_output.data());
+  std::vector<float> sparse_output(kRow * kBatch, 1.0f);
+  SparseMatrixBatchVectorMultiplyAccumulate1x4(
+      matrix_values.data(), segments, indices, kRow, kCol, vector.data(),
+      kBatch, sparse_output.data());
+
+  EXPECT_THAT(sparse_output,
+              ElementsAreArray(ArrayFloatNear(dense_output, 1e-4)));
+}
+
+TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulate1x4Int8Test) {
+  const int kRow = 3;
+  const int kCol = 40;
+  const int kBatch = 2;
+  const int kBlockSize = 4;
+  const int32_t segments[] = {0, 9, 9, 12};
+  const int32_t indices[] = {0, 1, 2, 3, 4, 5, 6, 7, 9,  // 1st row
+                             /* 2nd row is empty */
+                             1, 4, 8};  // 3rd row
+  const int num_blocks = segments[kRow];
+
+  std::vector<int8_t> matrix_values(num_blocks * kBlockSize);
+  std::vector<int32_t> dense_matrix(kRow * kCol, 0);
+  for (int row = 0; row < kRow; ++row) {
+    for (int i = segments[row]; i < segments[row + 1]; ++i) {
+      for (int c = 0; c < kBlockSize; ++c) {
+        // Covers the whole range of symmetrically quantized values.
+        const int8_t value = ((i * kBlockSize + c) * 37) % 255 - 127;
+        matrix_values[i * kBlockSize + c] = value;
+        dense_matrix[row * kCol + indices[i] * kBlockSize + c] = value;
+      }
+    }
+  }
+  std::vector<int8_t> vector(kBatch * kCol);
+  for (int i = 0; i < kBatch * kCol; ++i) {
+    vector[i] = (i * 53) % 256 - 128;
+  }
+  const int32_t bias[kRow] = {100, -200, 300};
+  const int32_t input_offset = 3;
+  const int32_t output_offset = -5;
+  const double scales[kRow] = {0.0003, 0.00007, 0.0005};
+  int32_t multipliers[kRow];
+  int shifts[kRow];
+  for (int row = 0; row < kRow; ++row) {
+    QuantizeMultiplier(scales[row], &multipliers[row], &shifts[row]);
+  }
+
+  for (const bool per_channel : {false, true}) {
+    std::vector<int8_t> expected(kRow * kBatch);
+    for (int batch = 0; batch < kBatch; ++batch) {
+      for (int row = 0; row < kRow; ++row) {
+        int32_t acc = bias[row];
+        for (int col = 0; col < kCol; ++col) {
+          acc += dense_matrix[row * kCol + col] *
+                 (vector[batch * kCol + col] + input_offset);
+        }
+        acc = MultiplyByQuantizedMultiplier(
+                  acc, multipliers[per_channel ? row : 0],
+                  shifts[per_channel ? row : 0]) +
+              output_offset;
+        expected[batch * kRow + row] = std::min(std::max(acc, -128), 127);
+      }
+    }
+
+    std::vector<int8_t> result(kRow * kBatch);
+    SparseMatrixBatchVectorMultiplyAccumulate1x4(
+        matrix_values.data(), segments, indices, kRow, kCol, vector.data(),
+        bias, kBatch, input_offset, multipliers[0], shifts[0],
+        per_channel ? multipliers : nullptr, per_channel ? shifts : nullptr,
+        output_offset, -128, 127, result.data());
+
+    EXPECT_THAT(result, ElementsAreArray(expected));
+  }
+}
+
 #ifdef __ANDROID__
 TEST(uKernels,
      SparseMatrixBatchVectorMultiplyAccumulateSymmetricQuantizedTest) {
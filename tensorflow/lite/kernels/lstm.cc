@@ -2115,7 +2115,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
             projection_bias, params, /*forward_sequence=*/true,
             /*time_major=*/true, &op_data->integer_lstm_param, output_state,
             cell_state, output, scratch0, scratch1, scratch2, scratch3,
-            scratch4, scratch5, CpuBackendContext::GetFromContext(context));
+            scratch4, scratch5, /*input_projection=*/nullptr,
+            /*gate_scratch=*/nullptr,
+            CpuBackendContext::GetFromContext(context));
       }
       TfLiteTensor* scratch6;
       TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, 6, &scratch6));
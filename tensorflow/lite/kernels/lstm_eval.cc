@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/kernel_utils.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
@@ -556,6 +557,8 @@ void CalculateLstmGateInteger8x8_16(
     const int8_t* input, const int8_t* input_to_gate_weights,
     const int32_t* input_to_gate_bias, const int32_t input_to_gate_scale_a,
     const int32_t input_to_gate_scale_b,
+    // input_weight * input computed ahead for the whole sequence, if not null
+    const int16_t* input_projection,
     // Output state and weights
     const int8_t* output_state, const int8_t* recurrent_to_gate_weights,
     const int32_t* recurrent_to_gate_bias,
@@ -581,14 +584,18 @@ void CalculateLstmGateInteger8x8_16(
   const bool use_peephole = (cell_to_gate_weights != nullptr);
   const bool use_layer_norm = (layer_norm_coefficients != nullptr);
 
-  // Initialize scratch buffers with zeros. Note that unlike float and hybrid
-  // versions, bias is only used in layer normalization.
-  std::fill_n(gate, n_batch * n_cell, 0);
-  // For each batch and cell: compute input_weight * input.
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      input, input_to_gate_bias, input_to_gate_weights, input_to_gate_scale_a,
-      input_to_gate_scale_b, n_batch, n_input, n_cell, 0, scratch5, gate,
-      context);
+  if (input_projection != nullptr) {
+    std::copy_n(input_projection, n_batch * n_cell, gate);
+  } else {
+    // Initialize scratch buffers with zeros. Note that unlike float and hybrid
+    // versions, bias is only used in layer normalization.
+    std::fill_n(gate, n_batch * n_cell, 0);
+    // For each batch and cell: compute input_weight * input.
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input, input_to_gate_bias, input_to_gate_weights,
+        input_to_gate_scale_a, input_to_gate_scale_b, n_batch, n_input, n_cell,
+        0, scratch5, gate, context);
+  }
   // Note: no aux_input.
 
   // For each batch and cell: compute recurrent_weight * output_state.
@@ -623,6 +630,92 @@ void CalculateLstmGateInteger8x8_16(
   }
 }
 
+// Calculates some of the gates of an integer LSTM step on one thread. See
+// CalculateLstmGatesConcurrently.
+template <typename CalculateGate>
+class LstmGateTask : public cpu_backend_threadpool::Task {
+ public:
+  LstmGateTask(const CalculateGate* calculate_gate, int32_t* gate_scratch,
+               int gate_scratch_size)
+      : calculate_gate_(calculate_gate),
+        gate_scratch_(gate_scratch),
+        gate_scratch_size_(gate_scratch_size) {}
+
+  void AddGate(int gate) { gates_[num_gates_++] = gate; }
+
+  void Run() override {
+    for (int i = 0; i < num_gates_; ++i) {
+      const int gate = gates_[i];
+      (*calculate_gate_)(gate, gate_scratch_ + gate * gate_scratch_size_,
+                         /*gate_context=*/nullptr);
+    }
+  }
+
+ private:
+  const CalculateGate* calculate_gate_;
+  int32_t* gate_scratch_;
+  int gate_scratch_size_;
+  int gates_[4];
+  int num_gates_ = 0;
+};
+
+// Calculates the independent 'gates' of an integer LSTM step, spread over up
+// to one thread of 'context' per gate. Gate 'i' uses the 'gate_scratch_size'
+// elements of 'gate_scratch' at 'i * gate_scratch_size' as accumulators. The
+// gates are calculated without a context, so that they don't use the GEMM
+// backends of 'context' concurrently.
+template <typename CalculateGate>
+void CalculateLstmGatesConcurrently(const CalculateGate& calculate_gate,
+                                    const int* gates, int num_gates,
+                                    int32_t* gate_scratch,
+                                    int gate_scratch_size,
+                                    CpuBackendContext* context) {
+  const int thread_count =
+      std::max(1, std::min(num_gates, context->max_num_threads()));
+  std::vector<LstmGateTask<CalculateGate>> tasks;
+  tasks.reserve(thread_count);
+  for (int i = 0; i < thread_count; ++i) {
+    tasks.emplace_back(&calculate_gate, gate_scratch, gate_scratch_size);
+  }
+  for (int i = 0; i < num_gates; ++i) {
+    tasks[i % thread_count].AddGate(gates[i]);
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(), context);
+}
+
+// Calculates input_weight * input of the integer LSTM gates for all the
+// 'n_rows' time steps and batches of 'input' at once, so that the steps only
+// have to add the recurrent part, and the input weights are streamed once per
+// sequence instead of once per step. The result is the same as the one of the
+// first MatrixBatchVectorMultiplyAccumulate of CalculateLstmGateInteger8x8_16.
+//
+// Parameters:
+//  - input: size n_rows * n_input.
+//  - input_to_gate_weights, input_to_gate_biases, input_to_gate_scales_[a|b]:
+//      of the input, forget, cell and output gates. The input gate weights are
+//      null with CIFG.
+//  - input_projection: output, size 4 * n_rows * n_cell, with the gates in
+//      the same order.
+//  - scratch: scratch area of size n_rows * n_cell.
+void PrecomputeInputProjectionInteger8x8_16(
+    const int8_t* input, const int8_t* const input_to_gate_weights[4],
+    const int32_t* const input_to_gate_biases[4],
+    const int32_t input_to_gate_scales_a[4],
+    const int32_t input_to_gate_scales_b[4], int n_rows, int n_input,
+    int n_cell, int16_t* input_projection, int32_t* scratch,
+    CpuBackendContext* context) {
+  ruy::profiler::ScopeLabel label("PrecomputeInputProjectionInteger8x8_16");
+  for (int gate = 0; gate < 4; ++gate) {
+    if (input_to_gate_weights[gate] == nullptr) continue;
+    int16_t* gate_projection = input_projection + gate * n_rows * n_cell;
+    std::fill_n(gate_projection, n_rows * n_cell, 0);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input, input_to_gate_biases[gate], input_to_gate_weights[gate],
+        input_to_gate_scales_a[gate], input_to_gate_scales_b[gate], n_rows,
+        n_input, n_cell, 0, scratch, gate_projection, context);
+  }
+}
+
 // Updates the LSTM cell state, used by both integer LSTM versions.
 // Also see UpdateLstmCellFloat.
 //
@@ -1410,6 +1503,15 @@ inline void LstmStepHybrid(
 //   scratch5: this scratch buffer is created purely for optimizing the
 //              MatrixBatchVectorMultiplyAccumulate.
 //
+// Optional storage for performance optimizations:
+//   input_projection_ptr: input_weight * input of the step for each gate, as
+//     computed for the whole sequence by
+//     PrecomputeInputProjectionInteger8x8_16. The input, forget, cell and
+//     output gates are 'input_projection_stride' apart.
+//   gate_scratch: size 4 * n_batch * n_cell. If set, the gates that don't
+//     depend on each other are calculated concurrently on the threads of
+//     'context'.
+//
 // Outputs:
 //   output_state_ptr - size 'n_batch * n_output'
 //   cell_state_ptr   - size 'n_batch * n_cell'
@@ -1478,7 +1580,9 @@ inline void LstmStepInteger8x8_16(
     int n_input, int n_output, int8_t* output_state_ptr,
     int32_t output_state_zp, int16_t* cell_state_ptr, int8_t* output_ptr,
     int16_t* scratch0, int16_t* scratch1, int16_t* scratch2, int16_t* scratch3,
-    int8_t* scratch4, int32_t* scratch5, CpuBackendContext* context) {
+    int8_t* scratch4, int32_t* scratch5, const int16_t* input_projection_ptr,
+    int input_projection_stride, int32_t* gate_scratch,
+    CpuBackendContext* context) {
   ruy::profiler::ScopeLabel label("LstmStepInteger8x8_16");
   // Make named scratch buffers for the different gates.
   int16_t* input_gate_scratch = scratch0;
@@ -1505,62 +1609,108 @@ inline void LstmStepInteger8x8_16(
   if (use_projection) {
     TFLITE_DCHECK(projection_effective_bias);
   }
-  if (!use_cifg) {
+  auto input_projection = [&](int gate) -> const int16_t* {
+    return input_projection_ptr == nullptr
+               ? nullptr
+               : input_projection_ptr + gate * input_projection_stride;
+  };
+  // Calculates the input (0), forget (1), cell (2) or output (3) gate.
+  auto calculate_gate = [&](int gate, int32_t* accum_scratch,
+                            CpuBackendContext* gate_context) {
+    switch (gate) {
+      case 0:
+        CalculateLstmGateInteger8x8_16(
+            input_ptr, input_to_input_weight_ptr,
+            input_to_input_effective_bias, effective_input_to_input_scale_a,
+            effective_input_to_input_scale_b, input_projection(0),
+            output_state_ptr, recurrent_to_input_weight_ptr,
+            recurrent_to_input_effective_bias,
+            effective_recurrent_to_input_scale_a,
+            effective_recurrent_to_input_scale_b, cell_state_ptr,
+            cell_to_input_weight_ptr, effective_cell_to_input_scale_a,
+            effective_cell_to_input_scale_b, layer_norm_input_weight_ptr,
+            input_gate_bias_ptr, layer_norm_input_scale_a,
+            layer_norm_input_scale_b, input_variance_guard, n_batch, n_input,
+            n_output, n_cell, kTfLiteActSigmoid, input_gate_scratch,
+            gate_context, accum_scratch);
+        break;
+      case 1:
+        CalculateLstmGateInteger8x8_16(
+            input_ptr, input_to_forget_weight_ptr,
+            input_to_forget_effective_bias, effective_input_to_forget_scale_a,
+            effective_input_to_forget_scale_b, input_projection(1),
+            output_state_ptr, recurrent_to_forget_weight_ptr,
+            recurrent_to_forget_effective_bias,
+            effective_recurrent_to_forget_scale_a,
+            effective_recurrent_to_forget_scale_b, cell_state_ptr,
+            cell_to_forget_weight_ptr, effective_cell_to_forget_scale_a,
+            effective_cell_to_forget_scale_b, layer_norm_forget_weight_ptr,
+            forget_gate_bias_ptr, layer_norm_forget_scale_a,
+            layer_norm_forget_scale_b, forget_variance_guard, n_batch, n_input,
+            n_output, n_cell, kTfLiteActSigmoid, forget_gate_scratch,
+            gate_context, accum_scratch);
+        break;
+      case 2:
+        CalculateLstmGateInteger8x8_16(
+            input_ptr, input_to_cell_weight_ptr, input_to_cell_effective_bias,
+            effective_input_to_cell_scale_a, effective_input_to_cell_scale_b,
+            input_projection(2), output_state_ptr,
+            recurrent_to_cell_weight_ptr, recurrent_to_cell_effective_bias,
+            effective_recurrent_to_cell_scale_a,
+            effective_recurrent_to_cell_scale_b, cell_state_ptr,
+            /*cell_to_gate_weights=*/nullptr, /*cell_to_gate_scale_a=*/0,
+            /*cell_to_gate_scale_b=*/0, layer_norm_cell_weight_ptr,
+            cell_gate_bias_ptr, layer_norm_cell_scale_a,
+            layer_norm_cell_scale_b, cell_variance_guard, n_batch, n_input,
+            n_output, n_cell, kTfLiteActTanh, cell_gate_scratch, gate_context,
+            accum_scratch);
+        break;
+      case 3:
+        CalculateLstmGateInteger8x8_16(
+            input_ptr, input_to_output_weight_ptr,
+            input_to_output_effective_bias, effective_input_to_output_scale_a,
+            effective_input_to_output_scale_b, input_projection(3),
+            output_state_ptr, recurrent_to_output_weight_ptr,
+            recurrent_to_output_effective_bias,
+            effective_recurrent_to_output_scale_a,
+            effective_recurrent_to_output_scale_b, cell_state_ptr,
+            cell_to_output_weight_ptr, effective_cell_to_output_scale_a,
+            effective_cell_to_output_scale_b, layer_norm_output_weight_ptr,
+            output_gate_bias_ptr, layer_norm_output_scale_a,
+            layer_norm_output_scale_b, output_variance_guard, n_batch, n_input,
+            n_output, n_cell, kTfLiteActSigmoid, output_gate_scratch,
+            gate_context, accum_scratch);
+        break;
+    }
+  };
+
+  // The output gate reads the updated cell state with peephole connections.
+  const bool output_gate_after_update = (cell_to_output_weight_ptr != nullptr);
+  if (gate_scratch != nullptr) {
+    int gates[4];
+    int num_gates = 0;
+    if (!use_cifg) gates[num_gates++] = 0;
+    gates[num_gates++] = 1;
+    gates[num_gates++] = 2;
+    if (!output_gate_after_update) gates[num_gates++] = 3;
+    CalculateLstmGatesConcurrently(calculate_gate, gates, num_gates,
+                                   gate_scratch, n_batch * n_cell, context);
+  } else {
     // Calculate the input gate. (If not CIFG.)
-    CalculateLstmGateInteger8x8_16(
-        input_ptr, input_to_input_weight_ptr, input_to_input_effective_bias,
-        effective_input_to_input_scale_a, effective_input_to_input_scale_b,
-        output_state_ptr, recurrent_to_input_weight_ptr,
-        recurrent_to_input_effective_bias, effective_recurrent_to_input_scale_a,
-        effective_recurrent_to_input_scale_b, cell_state_ptr,
-        cell_to_input_weight_ptr, effective_cell_to_input_scale_a,
-        effective_cell_to_input_scale_b, layer_norm_input_weight_ptr,
-        input_gate_bias_ptr, layer_norm_input_scale_a, layer_norm_input_scale_b,
-        input_variance_guard, n_batch, n_input, n_output, n_cell,
-        kTfLiteActSigmoid, input_gate_scratch, context, scratch5);
+    if (!use_cifg) calculate_gate(0, scratch5, context);
+    // Calculate the forget gate.
+    calculate_gate(1, scratch5, context);
+    // Calculate the cell update gate.
+    calculate_gate(2, scratch5, context);
   }
-  // Calculate the forget gate.
-  CalculateLstmGateInteger8x8_16(
-      input_ptr, input_to_forget_weight_ptr, input_to_forget_effective_bias,
-      effective_input_to_forget_scale_a, effective_input_to_forget_scale_b,
-      output_state_ptr, recurrent_to_forget_weight_ptr,
-      recurrent_to_forget_effective_bias, effective_recurrent_to_forget_scale_a,
-      effective_recurrent_to_forget_scale_b, cell_state_ptr,
-      cell_to_forget_weight_ptr, effective_cell_to_forget_scale_a,
-      effective_cell_to_forget_scale_b, layer_norm_forget_weight_ptr,
-      forget_gate_bias_ptr, layer_norm_forget_scale_a,
-      layer_norm_forget_scale_b, forget_variance_guard, n_batch, n_input,
-      n_output, n_cell, kTfLiteActSigmoid, forget_gate_scratch, context,
-      scratch5);
-  // Calculate the cell update gate.
-  CalculateLstmGateInteger8x8_16(
-      input_ptr, input_to_cell_weight_ptr, input_to_cell_effective_bias,
-      effective_input_to_cell_scale_a, effective_input_to_cell_scale_b,
-      output_state_ptr, recurrent_to_cell_weight_ptr,
-      recurrent_to_cell_effective_bias, effective_recurrent_to_cell_scale_a,
-      effective_recurrent_to_cell_scale_b, cell_state_ptr,
-      /*cell_to_gate_weights=*/nullptr, /*cell_to_gate_scale_a=*/0,
-      /*cell_to_gate_scale_b=*/0, layer_norm_cell_weight_ptr,
-      cell_gate_bias_ptr, layer_norm_cell_scale_a, layer_norm_cell_scale_b,
-      cell_variance_guard, n_batch, n_input, n_output, n_cell, kTfLiteActTanh,
-      cell_gate_scratch, context, scratch5);
   // Update the cell state.
   UpdateLstmCellInteger(n_batch, n_cell, cell_state_ptr, cell_state_scale,
                         input_gate_scratch, forget_gate_scratch,
                         cell_gate_scratch, use_cifg, quantized_cell_clip);
   // Calculate the output gate.
-  CalculateLstmGateInteger8x8_16(
-      input_ptr, input_to_output_weight_ptr, input_to_output_effective_bias,
-      effective_input_to_output_scale_a, effective_input_to_output_scale_b,
-      output_state_ptr, recurrent_to_output_weight_ptr,
-      recurrent_to_output_effective_bias, effective_recurrent_to_output_scale_a,
-      effective_recurrent_to_output_scale_b, cell_state_ptr,
-      cell_to_output_weight_ptr, effective_cell_to_output_scale_a,
-      effective_cell_to_output_scale_b, layer_norm_output_weight_ptr,
-      output_gate_bias_ptr, layer_norm_output_scale_a,
-      layer_norm_output_scale_b, output_variance_guard, n_batch, n_input,
-      n_output, n_cell, kTfLiteActSigmoid, output_gate_scratch, context,
-      scratch5);
+  if (gate_scratch == nullptr || output_gate_after_update) {
+    calculate_gate(3, scratch5, context);
+  }
   // Update the output state.
   CalculateLstmOutputInteger8x8_16(
       n_batch, n_cell, n_output, cell_state_ptr, cell_state_scale,
@@ -2303,6 +2453,7 @@ TfLiteStatus EvalInteger8x8_16(
     TfLiteTensor* output_state, TfLiteTensor* cell_state, TfLiteTensor* output,
     TfLiteTensor* scratch0, TfLiteTensor* scratch1, TfLiteTensor* scratch2,
     TfLiteTensor* scratch3, TfLiteTensor* scratch4, TfLiteTensor* scratch5,
+    TfLiteTensor* input_projection, TfLiteTensor* gate_scratch,
     CpuBackendContext* context) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
   const int n_input = input->dims->data[input->dims->size - 1];
@@ -2326,6 +2477,53 @@ TfLiteStatus EvalInteger8x8_16(
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
 
+  // Compute the input part of the gates for the whole sequence ahead, if
+  // there's storage for it. Both layouts keep the steps of the input rows
+  // contiguous.
+  int16_t* input_projection_ptr =
+      gate_scratch == nullptr ? nullptr
+                              : GetTensorData<int16_t>(input_projection);
+  const int input_projection_stride = max_time * n_batch * n_cell;
+  if (input_projection_ptr != nullptr) {
+    const int8_t* input_to_gate_weights[4] = {
+        GetTensorData<int8_t>(input_to_input_weights),
+        GetTensorData<int8_t>(input_to_forget_weights),
+        GetTensorData<int8_t>(input_to_cell_weights),
+        GetTensorData<int8_t>(input_to_output_weights)};
+    const int32_t* input_to_gate_biases[4] = {
+        integer_lstm_param->input_to_input_effective_bias.get(),
+        integer_lstm_param->input_to_forget_effective_bias.get(),
+        integer_lstm_param->input_to_cell_effective_bias.get(),
+        integer_lstm_param->input_to_output_effective_bias.get()};
+    const int32_t input_to_gate_scales_a[4] = {
+        integer_lstm_param->effective_input_to_input_scale_a,
+        integer_lstm_param->effective_input_to_forget_scale_a,
+        integer_lstm_param->effective_input_to_cell_scale_a,
+        integer_lstm_param->effective_input_to_output_scale_a};
+    const int32_t input_to_gate_scales_b[4] = {
+        integer_lstm_param->effective_input_to_input_scale_b,
+        integer_lstm_param->effective_input_to_forget_scale_b,
+        integer_lstm_param->effective_input_to_cell_scale_b,
+        integer_lstm_param->effective_input_to_output_scale_b};
+    PrecomputeInputProjectionInteger8x8_16(
+        GetTensorData<int8_t>(input), input_to_gate_weights,
+        input_to_gate_biases, input_to_gate_scales_a, input_to_gate_scales_b,
+        max_time * n_batch, n_input, n_cell, input_projection_ptr,
+        GetTensorData<int32_t>(gate_scratch), context);
+  }
+
+  // Calculate the gates of each step concurrently if there are threads for
+  // it.
+#ifdef TFLITE_WITH_RUY_GEMV
+  // The gate GEMVs already run on the threads of the context.
+  int32_t* concurrent_gate_scratch = nullptr;
+#else
+  int32_t* concurrent_gate_scratch =
+      (context != nullptr && context->max_num_threads() > 1)
+          ? GetTensorData<int32_t>(gate_scratch)
+          : nullptr;
+#endif
+
   if (time_major) {
     const int input_step = n_batch * n_input;
     const int output_step = n_batch * output_batch_leading_dim;
@@ -2411,7 +2609,10 @@ TfLiteStatus EvalInteger8x8_16(
           GetTensorData<int16_t>(scratch0), GetTensorData<int16_t>(scratch1),
           GetTensorData<int16_t>(scratch2), GetTensorData<int16_t>(scratch3),
           GetTensorData<int8_t>(scratch4), GetTensorData<int32_t>(scratch5),
-          context);
+          input_projection_ptr == nullptr
+              ? nullptr
+              : input_projection_ptr + t_rel * n_batch * n_cell,
+          input_projection_stride, concurrent_gate_scratch, context);
     }
   } else {
     for (int b = 0; b < n_batch; b++) {
@@ -2509,7 +2710,11 @@ TfLiteStatus EvalInteger8x8_16(
             cell_state_ptr, output_ptr, GetTensorData<int16_t>(scratch0),
             GetTensorData<int16_t>(scratch1), GetTensorData<int16_t>(scratch2),
             GetTensorData<int16_t>(scratch3), GetTensorData<int8_t>(scratch4),
-            GetTensorData<int32_t>(scratch5), context);
+            GetTensorData<int32_t>(scratch5),
+            input_projection_ptr == nullptr
+                ? nullptr
+                : input_projection_ptr + time_offset * n_cell,
+            input_projection_stride, concurrent_gate_scratch, context);
       }
     }
   }
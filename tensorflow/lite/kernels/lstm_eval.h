@@ -174,6 +174,15 @@ TfLiteStatus EvalHybrid(
     bool recurrent_to_forget_is_diag, bool recurrent_to_cell_is_diag,
     bool recurrent_to_output_is_diag, CpuBackendContext* context);
 
+// `input_projection` and `gate_scratch` are optional and speed up the
+// evaluation:
+//  - With both, the input part of the gates is computed for all the time steps
+//    at once ahead of the recurrence. `input_projection` is an int16 tensor of
+//    size 4 * max_time * n_batch * n_cell.
+//  - With `gate_scratch`, the gates of each step are computed concurrently
+//    when `context` has more than one thread.
+// `gate_scratch` is an int32 tensor of size
+// max(4, max_time) * n_batch * n_cell.
 TfLiteStatus EvalInteger8x8_16(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -198,6 +207,7 @@ TfLiteStatus EvalInteger8x8_16(
     TfLiteTensor* output_state, TfLiteTensor* cell_state, TfLiteTensor* output,
     TfLiteTensor* scratch0, TfLiteTensor* scratch1, TfLiteTensor* scratch2,
     TfLiteTensor* scratch3, TfLiteTensor* scratch4, TfLiteTensor* scratch5,
+    TfLiteTensor* input_projection, TfLiteTensor* gate_scratch,
     CpuBackendContext* context);
 
 TfLiteStatus EvalInteger8x8_8(
@@ -493,6 +493,18 @@ class QuantizedLstmParam : public BaseLstmParam {
     scratch5_tensor_.data.i32 = scratch5_.data();
     return &scratch5_tensor_;
   }
+  TfLiteTensor* GetInputProjection() {
+    PackWeightToTensor(&input_projection_tensor_, input_projection_,
+                       input_projection_size_);
+    input_projection_tensor_.data.i16 = input_projection_.data();
+    return &input_projection_tensor_;
+  }
+  TfLiteTensor* GetGateScratch() {
+    PackWeightToTensor(&gate_scratch_tensor_, gate_scratch_,
+                       gate_scratch_size_);
+    gate_scratch_tensor_.data.i32 = gate_scratch_.data();
+    return &gate_scratch_tensor_;
+  }
   TfLiteTensor* GetActivation() {
     PackWeightToTensor(&activation_tensor_, activation_, activation_size_);
     activation_tensor_.data.int8 = activation_.data();
@@ -516,6 +528,8 @@ class QuantizedLstmParam : public BaseLstmParam {
     TfLiteIntArrayFree(scratch3_tensor_.dims);
     TfLiteIntArrayFree(scratch4_tensor_.dims);
     TfLiteIntArrayFree(scratch5_tensor_.dims);
+    TfLiteIntArrayFree(input_projection_tensor_.dims);
+    TfLiteIntArrayFree(gate_scratch_tensor_.dims);
   }
 
  private:
@@ -599,10 +613,17 @@ class QuantizedLstmParam : public BaseLstmParam {
   std::vector<int32_t> scratch5_;
   std::vector<int32_t> scratch5_size_ = {n_batch_, n_cell_};
   TfLiteTensor scratch5_tensor_;
+  std::vector<int16_t> input_projection_;
+  std::vector<int32_t> input_projection_size_ = {4, n_batch_, n_cell_};
+  TfLiteTensor input_projection_tensor_ = {};
+  std::vector<int32_t> gate_scratch_;
+  std::vector<int32_t> gate_scratch_size_ = {4 * n_batch_, n_cell_};
+  TfLiteTensor gate_scratch_tensor_ = {};
 };
 
-void TestOneFullyQuantizedLSTM() {
+void TestOneFullyQuantizedLSTM(bool use_input_projection, int num_threads) {
   CpuBackendContext context;
+  context.SetMaxNumThreads(num_threads);
   QuantizedLstmParam one_parameter;
   auto activation = one_parameter.GetActivation();
   auto output = one_parameter.GetOutput();
@@ -621,7 +642,10 @@ void TestOneFullyQuantizedLSTM() {
       /*time_major=*/true, param, activation, cell, output,
       one_parameter.GetScratch0(), one_parameter.GetScratch1(),
       one_parameter.GetScratch2(), one_parameter.GetScratch3(),
-      one_parameter.GetScratch4(), one_parameter.GetScratch5(), &context);
+      one_parameter.GetScratch4(), one_parameter.GetScratch5(),
+      use_input_projection ? one_parameter.GetInputProjection() : nullptr,
+      use_input_projection ? one_parameter.GetGateScratch() : nullptr,
+      &context);
 
   // Verify results.
   const std::vector<int16_t> expected_cell = {
@@ -636,7 +660,15 @@ void TestOneFullyQuantizedLSTM() {
 }
 
 TEST(TestOneFullyQuantizedLSTM, TestOneFullyQuantizedLSTM) {
-  TestOneFullyQuantizedLSTM();
+  TestOneFullyQuantizedLSTM(/*use_input_projection=*/false, /*num_threads=*/1);
+}
+
+TEST(TestOneFullyQuantizedLSTM, PrecomputedInputProjection) {
+  TestOneFullyQuantizedLSTM(/*use_input_projection=*/true, /*num_threads=*/1);
+}
+
+TEST(TestOneFullyQuantizedLSTM, ConcurrentGates) {
+  TestOneFullyQuantizedLSTM(/*use_input_projection=*/true, /*num_threads=*/4);
 }
 
 class HybridLstmParam : public BaseLstmParam {
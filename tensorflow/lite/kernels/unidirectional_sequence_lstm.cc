@@ -988,7 +988,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   if (IsHybridOp(input, input_to_output_weights)) {
     node->temporaries = TfLiteIntArrayCreate(kNumTemporaryTensors);
   } else if (is_integer) {
-    node->temporaries = TfLiteIntArrayCreate(6);
+    node->temporaries = TfLiteIntArrayCreate(8);
   } else {
     node->temporaries = TfLiteIntArrayCreate(1);
   }
@@ -1243,6 +1243,36 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       }
     }
 
+    // Allocate the buffers that let the input part of the gates be computed
+    // for the whole sequence at once, and the gates of a step be computed
+    // concurrently: an int16 buffer of size 4 * max_time * n_batch * n_cell
+    // for the input projections of the gates, and an int32 buffer of size
+    // max(4, max_time) * n_batch * n_cell for their accumulators.
+    const int max_time =
+        time_major ? input->dims->data[0] : input->dims->data[1];
+    const int input_projection_dimension[3] = {4, max_time * n_batch, n_cell};
+    const int gate_scratch_dimension[2] = {std::max(4, max_time) * n_batch,
+                                           n_cell};
+    for (int scratch_index = 6; scratch_index < 8; ++scratch_index) {
+      node->temporaries->data[scratch_index] =
+          op_data->scratch_tensor_index + scratch_index;
+      TfLiteTensor* scratch_tensor;
+      TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, scratch_index,
+                                                  &scratch_tensor));
+      scratch_tensor->type = scratch_index == 6 ? kTfLiteInt16 : kTfLiteInt32;
+      scratch_tensor->allocation_type = kTfLiteArenaRw;
+      const int num_dims = scratch_index == 6 ? 3 : 2;
+      const int* dims = scratch_index == 6 ? input_projection_dimension
+                                           : gate_scratch_dimension;
+      if (!TfLiteIntArrayEqualsArray(scratch_tensor->dims, num_dims, dims)) {
+        TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(num_dims);
+        std::copy_n(dims, num_dims, scratch_buffer_size->data);
+        TF_LITE_ENSURE_OK(context,
+                          context->ResizeTensor(context, scratch_tensor,
+                                                scratch_buffer_size));
+      }
+    }
+
     // Populate precomputed zp * weight.
     TF_LITE_ENSURE_OK(context, PopulatePrecomputedZPTimesWeightsWithBias(
                                    context, op_data, node));
@@ -1479,6 +1509,12 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
         TfLiteTensor* scratch5;
         TF_LITE_ENSURE_OK(context,
                           GetTemporarySafe(context, node, 5, &scratch5));
+        TfLiteTensor* input_projection;
+        TF_LITE_ENSURE_OK(
+            context, GetTemporarySafe(context, node, 6, &input_projection));
+        TfLiteTensor* gate_scratch;
+        TF_LITE_ENSURE_OK(context,
+                          GetTemporarySafe(context, node, 7, &gate_scratch));
         return lstm_eval::EvalInteger8x8_16(
             input, input_to_input_weights, input_to_forget_weights,
             input_to_cell_weights, input_to_output_weights,
@@ -1492,6 +1528,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
             projection_bias, &lstm_params, /*forward_sequence=*/true,
             time_major, &op_data->integer_lstm_param, output_state, cell_state,
             output, scratch0, scratch1, scratch2, scratch3, scratch4, scratch5,
+            input_projection, gate_scratch,
             CpuBackendContext::GetFromContext(context));
       }
     }
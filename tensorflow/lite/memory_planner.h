@@ -15,12 +15,29 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_MEMORY_PLANNER_H_
 #define TENSORFLOW_LITE_MEMORY_PLANNER_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
 
 namespace tflite {
 
+// The placement of a tensor buffer in one of a memory planner's arenas.
+struct MemoryPlannerAllocation {
+  // Index of the tensor that owns the buffer.
+  int32_t tensor;
+  // True for the persistent arena, false for the non-persistent one.
+  bool persistent;
+  // Offset of the buffer from the start of its arena, and its size in bytes.
+  size_t offset;
+  size_t size;
+  // Range of execution plan indices during which the buffer is in use.
+  int32_t first_node;
+  int32_t last_node;
+};
+
 // A MemoryPlanner is responsible for planning and executing a number of
 // memory-related operations that are necessary in TF Lite.
 class MemoryPlanner {
@@ -69,6 +86,23 @@ class MemoryPlanner {
   // Returns a map of allocation information. It's only used for debugging.
   virtual void GetAllocInfo(size_t *arena_size,
                             size_t *arena_persist_size) const = 0;
+
+  // Returns the arena placement of every tensor buffer allocated so far. It's
+  // only used for memory profiling; planners that don't place tensors in
+  // arenas return nothing.
+  virtual void GetAllocations(
+      std::vector<MemoryPlannerAllocation>* allocations) const = 0;
+
+  // Appends the plans the planner keeps for reuse to `plans`, in a form that
+  // only the same kind of planner for the same graph can restore. Planners that
+  // don't keep plans append nothing.
+  virtual void SerializePlans(std::string* plans) const = 0;
+
+  // Restores plans appended by `SerializePlans`, so that allocations of
+  // tensors of the same sizes skip planning. Every plan is validated against
+  // the graph, and plans that don't apply to it are never used. Returns an
+  // error if `plans` is malformed.
+  virtual TfLiteStatus RestorePlans(const std::string& plans) = 0;
 };
 
 }  // namespace tflite
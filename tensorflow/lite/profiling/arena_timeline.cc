@@ -0,0 +1,230 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/arena_timeline.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/memory_planner.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace profiling {
+namespace memory {
+namespace {
+
+std::string JsonString(const std::string& value) {
+  std::string result = "\"";
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          result += escaped;
+        } else {
+          result += c;
+        }
+    }
+  }
+  return result + "\"";
+}
+
+// Assigns the buffers of one arena to as few tracks as possible such that the
+// slices on a track don't overlap in time, which the trace format requires.
+std::vector<int> AssignTracks(const ArenaTimeline& timeline, bool persistent,
+                              int last_step) {
+  std::vector<int> buffers;
+  for (int i = 0; i < timeline.buffers.size(); ++i) {
+    if (timeline.buffers[i].allocation.persistent == persistent) {
+      buffers.push_back(i);
+    }
+  }
+  std::stable_sort(buffers.begin(), buffers.end(), [&timeline](int a, int b) {
+    return timeline.buffers[a].allocation.first_node <
+           timeline.buffers[b].allocation.first_node;
+  });
+  std::vector<int> tracks(timeline.buffers.size(), -1);
+  std::vector<int> track_ends;
+  for (int buffer : buffers) {
+    const MemoryPlannerAllocation& allocation =
+        timeline.buffers[buffer].allocation;
+    const int end = std::min(allocation.last_node, last_step);
+    int track = 0;
+    while (track < track_ends.size() &&
+           track_ends[track] >= allocation.first_node) {
+      ++track;
+    }
+    if (track == track_ends.size()) track_ends.push_back(end);
+    track_ends[track] = end;
+    tracks[buffer] = track;
+  }
+  return tracks;
+}
+
+}  // namespace
+
+ArenaTimeline GetArenaTimeline(const Subgraph& subgraph) {
+  ArenaTimeline timeline;
+  timeline.subgraph_name = subgraph.GetName();
+  Subgraph::SubgraphAllocInfo alloc_info;
+  subgraph.GetMemoryAllocInfo(&alloc_info);
+  timeline.arena_size = alloc_info.arena_size;
+  timeline.persistent_arena_size = alloc_info.arena_persist_size;
+
+  std::vector<MemoryPlannerAllocation> allocations;
+  subgraph.GetMemoryPlannerAllocations(&allocations);
+  for (const MemoryPlannerAllocation& allocation : allocations) {
+    const TfLiteTensor* tensor = subgraph.tensor(allocation.tensor);
+    timeline.buffers.push_back(
+        {allocation, tensor && tensor->name ? tensor->name : ""});
+  }
+
+  const std::vector<int>& execution_plan = subgraph.execution_plan();
+  timeline.steps.resize(execution_plan.size());
+  for (int i = 0; i < execution_plan.size(); ++i) {
+    ArenaTimeline::Step& step = timeline.steps[i];
+    step.node_index = execution_plan[i];
+    const auto* node_and_registration =
+        subgraph.node_and_registration(step.node_index);
+    if (node_and_registration != nullptr) {
+      step.op_name = GetOpNameByRegistration(node_and_registration->second);
+    }
+  }
+  for (int b = 0; b < timeline.buffers.size(); ++b) {
+    const MemoryPlannerAllocation& allocation = timeline.buffers[b].allocation;
+    if (allocation.persistent) continue;
+    const int first = std::max(allocation.first_node, 0);
+    const int last = std::min<int64_t>(allocation.last_node,
+                                       timeline.steps.size() - 1);
+    for (int i = first; i <= last; ++i) {
+      ArenaTimeline::Step& step = timeline.steps[i];
+      step.live_bytes += allocation.size;
+      step.high_water_mark =
+          std::max(step.high_water_mark, allocation.offset + allocation.size);
+      step.live_buffers.push_back(b);
+    }
+  }
+  for (int i = 0; i < timeline.steps.size(); ++i) {
+    if (timeline.peak_step == -1 ||
+        timeline.steps[i].high_water_mark >
+            timeline.steps[timeline.peak_step].high_water_mark) {
+      timeline.peak_step = i;
+    }
+  }
+  return timeline;
+}
+
+std::string ArenaTimelinesToChromeTrace(
+    const std::vector<ArenaTimeline>& timelines, int step_duration_us) {
+  // Track ids within each subgraph's process.
+  constexpr int kOpsTrack = 0;
+  constexpr int kFirstArenaTrack = 1;
+  constexpr int kFirstPersistentArenaTrack = 100000;
+
+  std::ostringstream out;
+  bool first_event = true;
+  auto begin_event = [&out, &first_event]() -> std::ostringstream& {
+    out << (first_event ? "\n" : ",\n");
+    first_event = false;
+    return out;
+  };
+  auto name_track = [&begin_event](int pid, int tid, const std::string& name) {
+    begin_event() << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid
+                  << ",\"tid\":" << tid
+                  << ",\"args\":{\"name\":" << JsonString(name) << "}}";
+  };
+
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  for (int pid = 0; pid < timelines.size(); ++pid) {
+    const ArenaTimeline& timeline = timelines[pid];
+    const int last_step = static_cast<int>(timeline.steps.size()) - 1;
+    begin_event() << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << pid
+                  << ",\"args\":{\"name\":"
+                  << JsonString("Subgraph " + std::to_string(pid) + " " +
+                                timeline.subgraph_name)
+                  << "}}";
+    name_track(pid, kOpsTrack, "Ops");
+
+    for (int i = 0; i < timeline.steps.size(); ++i) {
+      const ArenaTimeline::Step& step = timeline.steps[i];
+      begin_event() << "{\"ph\":\"X\",\"pid\":" << pid
+                    << ",\"tid\":" << kOpsTrack
+                    << ",\"name\":" << JsonString(step.op_name)
+                    << ",\"ts\":" << int64_t{i} * step_duration_us
+                    << ",\"dur\":" << step_duration_us
+                    << ",\"args\":{\"node_index\":" << step.node_index
+                    << ",\"live_bytes\":" << step.live_bytes
+                    << ",\"high_water_mark\":" << step.high_water_mark
+                    << ",\"peak\":" << (i == timeline.peak_step ? "true" : "false")
+                    << "}}";
+      begin_event() << "{\"ph\":\"C\",\"pid\":" << pid
+                    << ",\"name\":\"Arena\",\"ts\":"
+                    << int64_t{i} * step_duration_us
+                    << ",\"args\":{\"live_bytes\":" << step.live_bytes
+                    << ",\"high_water_mark\":" << step.high_water_mark << "}}";
+    }
+
+    for (const bool persistent : {false, true}) {
+      const std::vector<int> tracks =
+          AssignTracks(timeline, persistent, last_step);
+      const int first_track =
+          persistent ? kFirstPersistentArenaTrack : kFirstArenaTrack;
+      int num_tracks = 0;
+      for (int b = 0; b < timeline.buffers.size(); ++b) {
+        if (tracks[b] < 0) continue;
+        num_tracks = std::max(num_tracks, tracks[b] + 1);
+        const ArenaTimeline::Buffer& buffer = timeline.buffers[b];
+        const MemoryPlannerAllocation& allocation = buffer.allocation;
+        const int first = std::max(allocation.first_node, 0);
+        const int last = std::max(first, std::min(allocation.last_node,
+                                                  last_step));
+        begin_event() << "{\"ph\":\"X\",\"pid\":" << pid
+                      << ",\"tid\":" << first_track + tracks[b]
+                      << ",\"name\":" << JsonString(buffer.tensor_name)
+                      << ",\"ts\":" << int64_t{first} * step_duration_us
+                      << ",\"dur\":"
+                      << int64_t{last - first + 1} * step_duration_us
+                      << ",\"args\":{\"tensor\":" << allocation.tensor
+                      << ",\"offset\":" << allocation.offset
+                      << ",\"size\":" << allocation.size << "}}";
+      }
+      for (int t = 0; t < num_tracks; ++t) {
+        name_track(pid, first_track + t,
+                   std::string(persistent ? "Persistent arena " : "Arena ") +
+                       std::to_string(t));
+      }
+    }
+  }
+  out << "\n]}\n";
+  return out.str();
+}
+
+}  // namespace memory
+}  // namespace profiling
+}  // namespace tflite
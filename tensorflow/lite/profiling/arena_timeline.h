@@ -0,0 +1,79 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_ARENA_TIMELINE_H_
+#define TENSORFLOW_LITE_PROFILING_ARENA_TIMELINE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/memory_planner.h"
+
+namespace tflite {
+namespace profiling {
+namespace memory {
+
+// How a subgraph's tensors occupy its memory arenas over the execution plan,
+// as planned by the memory planner after `AllocateTensors`.
+struct ArenaTimeline {
+  struct Buffer {
+    MemoryPlannerAllocation allocation;
+    std::string tensor_name;
+  };
+
+  // One entry per execution plan index.
+  struct Step {
+    int node_index = 0;
+    std::string op_name;
+    // Bytes of the non-persistent arena buffers live during the step.
+    size_t live_bytes = 0;
+    // End of the highest of those buffers, i.e. the arena size the step needs
+    // with the planned offsets. The largest value across steps is what drives
+    // the arena size.
+    size_t high_water_mark = 0;
+    // Indices into `buffers` of the non-persistent buffers live during the
+    // step.
+    std::vector<int> live_buffers;
+  };
+
+  std::string subgraph_name;
+  std::vector<Buffer> buffers;
+  std::vector<Step> steps;
+  size_t arena_size = 0;
+  size_t persistent_arena_size = 0;
+  // Index into `steps` of the first step reaching the highest high water mark,
+  // or -1 if there are no steps.
+  int peak_step = -1;
+};
+
+// Collects the arena timeline of `subgraph`, whose tensors must have been
+// allocated.
+ArenaTimeline GetArenaTimeline(const Subgraph& subgraph);
+
+// Serializes `timelines` in the Chrome trace event format, which chrome's
+// about://tracing and Perfetto's UI load. Each execution plan step spans
+// `step_duration_us` of trace time. A trace process per subgraph shows:
+// - one track with a slice per op;
+// - counters for the live bytes and the high water mark of each step;
+// - tracks with a slice per buffer, annotated with its offset and size.
+std::string ArenaTimelinesToChromeTrace(
+    const std::vector<ArenaTimeline>& timelines, int step_duration_us = 1000);
+
+}  // namespace memory
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_ARENA_TIMELINE_H_
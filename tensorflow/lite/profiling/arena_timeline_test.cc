@@ -0,0 +1,82 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/arena_timeline.h"
+
+#include <memory>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/kernels/subgraph_test_util.h"
+
+namespace tflite {
+namespace profiling {
+namespace memory {
+namespace {
+
+using ::testing::HasSubstr;
+
+class ArenaTimelineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    interpreter_ = std::make_unique<Interpreter>();
+    subgraph_test_util::SubgraphBuilder builder;
+    builder.BuildAddSubgraph(&interpreter_->primary_subgraph());
+    interpreter_->ResizeInputTensor(interpreter_->inputs()[0], {2});
+    interpreter_->ResizeInputTensor(interpreter_->inputs()[1], {1, 2});
+    ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  }
+
+  std::unique_ptr<Interpreter> interpreter_;
+};
+
+TEST_F(ArenaTimelineTest, AttributesPeakToOp) {
+  ArenaTimeline timeline = GetArenaTimeline(interpreter_->primary_subgraph());
+
+  ASSERT_EQ(timeline.steps.size(), 1);
+  EXPECT_EQ(timeline.steps[0].op_name, "ADD");
+  EXPECT_EQ(timeline.peak_step, 0);
+  EXPECT_FALSE(timeline.buffers.empty());
+  // Two int32 inputs of 2 elements and an int32 output of 2 elements.
+  EXPECT_GE(timeline.steps[0].live_bytes, 3 * 2 * sizeof(int32_t));
+  EXPECT_GT(timeline.steps[0].high_water_mark, 0);
+  EXPECT_LE(timeline.steps[0].high_water_mark, timeline.arena_size);
+  EXPECT_EQ(timeline.steps[0].live_buffers.size(), timeline.buffers.size());
+}
+
+TEST_F(ArenaTimelineTest, ChromeTrace) {
+  std::string trace = ArenaTimelinesToChromeTrace(
+      {GetArenaTimeline(interpreter_->primary_subgraph())});
+
+  EXPECT_THAT(trace, HasSubstr("\"traceEvents\":["));
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"ADD\""));
+  EXPECT_THAT(trace, HasSubstr("\"peak\":true"));
+  EXPECT_THAT(trace, HasSubstr("\"offset\":"));
+}
+
+TEST(ArenaTimelineEmptyTest, NoSteps) {
+  Interpreter interpreter;
+  ArenaTimeline timeline = GetArenaTimeline(interpreter.primary_subgraph());
+
+  EXPECT_TRUE(timeline.steps.empty());
+  EXPECT_TRUE(timeline.buffers.empty());
+  EXPECT_EQ(timeline.peak_step, -1);
+}
+
+}  // namespace
+}  // namespace memory
+}  // namespace profiling
+}  // namespace tflite
@@ -87,6 +87,20 @@ void SimpleMemoryArena::CalculateActiveAllocs(
 
 void SimpleMemoryArena::ResetAllocs() { active_allocs_.clear(); }
 
+void SimpleMemoryArena::RestoreAllocs(
+    const std::vector<ArenaAllocWithUsageInterval>& allocs,
+    size_t high_water_mark) {
+  active_allocs_.clear();
+  for (const ArenaAllocWithUsageInterval& alloc : allocs) {
+    // Zero-sized allocations are never active, see Allocate.
+    if (alloc.size != 0) {
+      active_allocs_.push_back(alloc);
+    }
+  }
+  std::sort(active_allocs_.begin(), active_allocs_.end());
+  high_water_mark_ = std::max(high_water_mark_, high_water_mark);
+}
+
 TfLiteStatus SimpleMemoryArena::Allocate(
     TfLiteContext* context, size_t alignment, size_t size, int32_t tensor,
     int32_t first_node, int32_t last_node,
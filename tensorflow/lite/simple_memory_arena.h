@@ -99,6 +99,15 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Replaces the active allocs with `allocs`, which must have been produced by
+  // Allocate for the same tensors and usage intervals, e.g. by an earlier
+  // planning pass. The required buffer size grows to `high_water_mark`.
+  void RestoreAllocs(const std::vector<ArenaAllocWithUsageInterval>& allocs,
+                     size_t high_water_mark);
+
+  // Returns the end of the highest allocation made since the plan was cleared.
+  size_t high_water_mark() const { return high_water_mark_; }
+
   inline size_t RequiredBufferSize() {
     // Add in a small amount of padding to reduce the chance of resize events
     // for small allocations.
@@ -18,6 +18,7 @@ limitations under the License.
 #include <cassert>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
@@ -93,6 +94,14 @@ class SimplePlanner : public MemoryPlanner {
   void DumpDebugInfo(const std::vector<int>& execution_plan) const override{};
   void GetAllocInfo(size_t* arena_size,
                     size_t* arena_persist_size) const override{};
+  void GetAllocations(std::vector<MemoryPlannerAllocation>* allocations)
+      const override {
+    allocations->clear();
+  }
+  void SerializePlans(std::string* plans) const override {}
+  TfLiteStatus RestorePlans(const std::string& plans) override {
+    return kTfLiteOk;
+  }
 
  private:
   // Free all the all allocations.
@@ -0,0 +1,476 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_per_op.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Returns the parameter enabling the delegate of `backend`, or an empty string
+// for the CPU kernels.
+std::string GetDelegateParam(const std::string& backend) {
+  if (backend == "xnnpack") return "use_xnnpack";
+  if (backend == "gpu") return "use_gpu";
+  if (backend == "nnapi") return "use_nnapi";
+  return "";
+}
+
+bool IsConstant(const ModelT& model, const TensorT& tensor) {
+  return tensor.buffer != 0 && tensor.buffer < model.buffers.size() &&
+         !model.buffers[tensor.buffer]->data.empty();
+}
+
+std::string GetOpName(const ModelT& model, const OperatorT& op) {
+  const OperatorCodeT* code = model.operator_codes[op.opcode_index].get();
+  const BuiltinOperator builtin_code = GetBuiltinCode(code);
+  if (builtin_code == BuiltinOperator_CUSTOM) return code->custom_code;
+  return EnumNameBuiltinOperator(builtin_code);
+}
+
+std::string FormatLatency(double latency_us) {
+  if (latency_us < 0) return "n/a";
+  std::stringstream stream;
+  stream << std::fixed << std::setprecision(1) << latency_us;
+  return stream.str();
+}
+
+}  // namespace
+
+std::string ExtractOpModel(const ModelT& model, const Interpreter& interpreter,
+                           int op_index) {
+  const SubGraphT& subgraph = *model.subgraphs[0];
+  const OperatorT& op = *subgraph.operators[op_index];
+  switch (GetBuiltinCode(model.operator_codes[op.opcode_index].get())) {
+    case BuiltinOperator_CALL_ONCE:
+    case BuiltinOperator_IF:
+    case BuiltinOperator_WHILE:
+      return "";
+    default:
+      break;
+  }
+
+  ModelT op_model;
+  op_model.version = model.version;
+  op_model.description = GetOpName(model, op);
+  // Buffer 0 is the empty buffer of tensors without constant data.
+  op_model.buffers.push_back(std::make_unique<BufferT>());
+  op_model.operator_codes.push_back(std::make_unique<OperatorCodeT>(
+      *model.operator_codes[op.opcode_index]));
+  auto op_subgraph = std::make_unique<SubGraphT>();
+  auto new_op = std::make_unique<OperatorT>(op);
+  new_op->opcode_index = 0;
+
+  // Maps the tensors of `model` to the tensors of `op_model`. The operands
+  // read by the op that aren't constant or variable become the model inputs.
+  std::map<int32_t, int32_t> tensor_map;
+  auto map_tensor = [&](int32_t tensor_index, bool is_read) -> int32_t {
+    if (tensor_index < 0) return tensor_index;
+    auto [it, inserted] =
+        tensor_map.try_emplace(tensor_index, op_subgraph->tensors.size());
+    if (!inserted) return it->second;
+
+    const TensorT& tensor = *subgraph.tensors[tensor_index];
+    auto new_tensor = std::make_unique<TensorT>(tensor);
+    const TfLiteTensor* runtime_tensor = interpreter.tensor(tensor_index);
+    if (runtime_tensor != nullptr && runtime_tensor->dims != nullptr) {
+      new_tensor->shape.assign(
+          runtime_tensor->dims->data,
+          runtime_tensor->dims->data + runtime_tensor->dims->size);
+      new_tensor->shape_signature.clear();
+    }
+    new_tensor->buffer = 0;
+    if (is_read && IsConstant(model, tensor)) {
+      new_tensor->buffer = op_model.buffers.size();
+      op_model.buffers.push_back(
+          std::make_unique<BufferT>(*model.buffers[tensor.buffer]));
+    } else if (is_read && !tensor.is_variable) {
+      op_subgraph->inputs.push_back(it->second);
+    }
+    op_subgraph->tensors.push_back(std::move(new_tensor));
+    return it->second;
+  };
+
+  for (int32_t input : op.inputs) {
+    // Resources and variants can't be fed from random data.
+    if (input >= 0 &&
+        (subgraph.tensors[input]->type == TensorType_RESOURCE ||
+         subgraph.tensors[input]->type == TensorType_VARIANT)) {
+      return "";
+    }
+  }
+  for (int32_t& input : new_op->inputs) {
+    input = map_tensor(input, /*is_read=*/true);
+  }
+  for (int32_t& intermediate : new_op->intermediates) {
+    intermediate = map_tensor(intermediate, /*is_read=*/false);
+  }
+  for (int32_t& output : new_op->outputs) {
+    output = map_tensor(output, /*is_read=*/false);
+    op_subgraph->outputs.push_back(output);
+  }
+
+  op_subgraph->operators.push_back(std::move(new_op));
+  op_model.subgraphs.push_back(std::move(op_subgraph));
+
+  flatbuffers::FlatBufferBuilder builder;
+  builder.Finish(Model::Pack(builder, &op_model), ModelIdentifier());
+  return std::string(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+                     builder.GetSize());
+}
+
+std::vector<int> SuggestPartitioning(
+    const std::vector<std::vector<double>>& latencies_us,
+    double switch_cost_us, double* total_us) {
+  constexpr double kInfinity = std::numeric_limits<double>::infinity();
+  const int num_ops = latencies_us.size();
+  std::vector<int> partitioning(num_ops, -1);
+
+  // The lowest latency of the ops up to the current one, when the current one
+  // runs on each backend.
+  std::vector<double> costs;
+  // The backend of the previous supported op on the path reaching each op on
+  // each backend, or -1 for the first supported op. Empty for unsupported ops.
+  std::vector<std::vector<int>> previous_backends(num_ops);
+  int last_op = -1;
+  for (int i = 0; i < num_ops; ++i) {
+    const std::vector<double>& latencies = latencies_us[i];
+    const int num_backends = latencies.size();
+    if (std::none_of(latencies.begin(), latencies.end(),
+                     [](double latency) { return latency >= 0; })) {
+      continue;
+    }
+    std::vector<double> next_costs(num_backends, kInfinity);
+    previous_backends[i].assign(num_backends, -1);
+    for (int backend = 0; backend < num_backends; ++backend) {
+      if (latencies[backend] < 0) continue;
+      if (last_op < 0) {
+        next_costs[backend] = latencies[backend];
+        continue;
+      }
+      for (int previous = 0; previous < static_cast<int>(costs.size());
+           ++previous) {
+        const double cost =
+            costs[previous] + (previous == backend ? 0 : switch_cost_us);
+        if (cost < next_costs[backend]) {
+          next_costs[backend] = cost;
+          previous_backends[i][backend] = previous;
+        }
+      }
+      next_costs[backend] += latencies[backend];
+    }
+    costs = std::move(next_costs);
+    last_op = i;
+  }
+
+  if (total_us != nullptr) *total_us = 0;
+  if (last_op < 0) return partitioning;
+  int backend = std::min_element(costs.begin(), costs.end()) - costs.begin();
+  if (total_us != nullptr) *total_us = costs[backend];
+  for (int i = last_op; i >= 0 && backend >= 0; --i) {
+    if (previous_backends[i].empty()) continue;
+    partitioning[i] = backend;
+    backend = previous_backends[i][backend];
+  }
+  return partitioning;
+}
+
+BenchmarkPerOp::BenchmarkPerOp(BenchmarkTfLiteModel* single_op_run)
+    : params_(DefaultParams()),
+      single_op_run_(single_op_run),
+      single_op_run_params_(single_op_run->mutable_params()) {
+  single_op_run_->AddListener(&latency_recorder_);
+}
+
+BenchmarkParams BenchmarkPerOp::DefaultParams() {
+  BenchmarkParams params;
+  params.AddParam("per_op_backends",
+                  BenchmarkParam::Create<std::string>("cpu,xnnpack,gpu,nnapi"));
+  params.AddParam("per_op_num_runs", BenchmarkParam::Create<int32_t>(20));
+  params.AddParam("partition_switch_cost_us",
+                  BenchmarkParam::Create<float>(100.0f));
+#if defined(__ANDROID__)
+  params.AddParam("per_op_model_dir",
+                  BenchmarkParam::Create<std::string>("/data/local/tmp"));
+#else
+  params.AddParam("per_op_model_dir",
+                  BenchmarkParam::Create<std::string>("/tmp"));
+#endif
+  params.AddParam("per_op_output_csv_file",
+                  BenchmarkParam::Create<std::string>(""));
+  return params;
+}
+
+std::vector<Flag> BenchmarkPerOp::GetFlags() {
+  return {
+      CreateFlag<std::string>(
+          "per_op_backends", &params_,
+          "A comma-separated list of the backends to benchmark every op on, "
+          "out of cpu, xnnpack, gpu and nnapi. Backends not built into the "
+          "binary are skipped."),
+      CreateFlag<int32_t>("per_op_num_runs", &params_,
+                          "The number of runs of every op on every backend."),
+      CreateFlag<float>(
+          "partition_switch_cost_us", &params_,
+          "The estimated cost in microseconds of passing tensors between two "
+          "backends, used to suggest the partitioning of the model."),
+      CreateFlag<std::string>(
+          "per_op_model_dir", &params_,
+          "A writable directory to store the models of single ops in while "
+          "they're benchmarked."),
+      CreateFlag<std::string>(
+          "per_op_output_csv_file", &params_,
+          "File path to export the per-op latency matrix to as CSV."),
+  };
+}
+
+TfLiteStatus BenchmarkPerOp::ParseBackends() {
+  const auto& backends = params_.Get<std::string>("per_op_backends");
+  std::vector<std::string> requested_backends;
+  if (!util::SplitAndParse(backends, ',', &requested_backends)) {
+    TFLITE_LOG(ERROR) << "Cannot parse --per_op_backends: '" << backends
+                      << "'. Please double-check its value.";
+    return kTfLiteError;
+  }
+
+  backends_.clear();
+  for (const auto& backend : requested_backends) {
+    if (backend != "cpu" && GetDelegateParam(backend).empty()) {
+      TFLITE_LOG(ERROR) << "Invalid backend in --per_op_backends: '"
+                        << backend
+                        << "'. Valid backends are: [cpu, xnnpack, gpu, nnapi]";
+      return kTfLiteError;
+    }
+    if (backend != "cpu" &&
+        !single_op_run_params_->HasParam(GetDelegateParam(backend))) {
+      TFLITE_LOG(WARN) << "Skipping the " << backend
+                       << " backend, which isn't supported by this binary.";
+      continue;
+    }
+    backends_.push_back(backend);
+  }
+  if (backends_.empty()) {
+    TFLITE_LOG(ERROR) << "No backend to benchmark in --per_op_backends.";
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+bool BenchmarkPerOp::SetBackendParams(const std::string& backend) {
+  for (const char* param : {"use_xnnpack", "use_gpu", "use_nnapi"}) {
+    if (single_op_run_params_->HasParam(param)) {
+      single_op_run_params_->Set<bool>(param, false);
+    }
+  }
+  const std::string param = GetDelegateParam(backend);
+  // Ops the delegate doesn't support would silently fall back to the CPU.
+  single_op_run_params_->Set<bool>("require_full_delegation", !param.empty());
+  if (param.empty()) return true;
+  if (!single_op_run_params_->HasParam(param)) return false;
+  single_op_run_params_->Set<bool>(param, true);
+  return true;
+}
+
+double BenchmarkPerOp::RunModel(const std::string& graph) {
+  single_op_run_params_->Set<std::string>("graph", graph);
+  latency_recorder_.MarkBenchmarkStart();
+  if (single_op_run_->Run() != kTfLiteOk) return -1;
+  return latency_recorder_.latency_us();
+}
+
+void BenchmarkPerOp::OutputStats(
+    const std::vector<std::string>& op_names,
+    const std::vector<std::vector<double>>& latencies_us) const {
+  std::stringstream matrix;
+  matrix << "Per-op latency (us):\n";
+  matrix << std::setw(6) << "node" << std::setw(24) << "op";
+  for (const auto& backend : backends_) matrix << std::setw(12) << backend;
+  matrix << "\n";
+  const int num_ops = op_names.size();
+  for (int i = 0; i < num_ops; ++i) {
+    matrix << std::setw(6) << i << std::setw(24) << op_names[i];
+    for (double latency_us : latencies_us[i]) {
+      matrix << std::setw(12) << FormatLatency(latency_us);
+    }
+    matrix << "\n";
+  }
+  TFLITE_LOG(INFO) << matrix.str();
+
+  const std::string csv_file =
+      params_.Get<std::string>("per_op_output_csv_file");
+  if (!csv_file.empty()) {
+    std::ofstream csv(csv_file, std::ofstream::out | std::ofstream::trunc);
+    if (!csv) {
+      TFLITE_LOG(ERROR) << "Failed to open " << csv_file << " for writing.";
+    } else {
+      csv << "node,op";
+      for (const auto& backend : backends_) csv << "," << backend;
+      csv << "\n";
+      for (int i = 0; i < num_ops; ++i) {
+        csv << i << "," << op_names[i];
+        for (double latency_us : latencies_us[i]) {
+          csv << "," << FormatLatency(latency_us);
+        }
+        csv << "\n";
+      }
+    }
+  }
+
+  double total_us = 0;
+  const std::vector<int> partitioning = SuggestPartitioning(
+      latencies_us, params_.Get<float>("partition_switch_cost_us"), &total_us);
+  std::stringstream suggestion;
+  suggestion << "Suggested partitioning:\n";
+  for (int begin = 0; begin < num_ops;) {
+    int end = begin + 1;
+    while (end < num_ops &&
+           partitioning[end] == partitioning[begin]) {
+      ++end;
+    }
+    suggestion << "  nodes [" << begin << ", " << end - 1 << "]: "
+               << (partitioning[begin] < 0 ? "unsupported"
+                                           : backends_[partitioning[begin]])
+               << "\n";
+    begin = end;
+  }
+  suggestion << "Estimated latency (us): " << FormatLatency(total_us);
+  TFLITE_LOG(INFO) << suggestion.str();
+}
+
+TfLiteStatus BenchmarkPerOp::Run(int argc, char** argv) {
+  // Parse flags that are supported by this particular binary first.
+  auto flag_list = GetFlags();
+  if (!Flags::Parse(&argc, const_cast<const char**>(argv), flag_list)) {
+    TFLITE_LOG(ERROR) << Flags::Usage(argv[0], flag_list);
+    return kTfLiteError;
+  }
+
+  // Then parse flags for single-op runs to get information like the input
+  // model and the delegates available.
+  if (TfLiteStatus status = single_op_run_->ParseFlags(&argc, argv);
+      status != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Error while parsing the flags for single-op runs: "
+                      << status;
+    return status;
+  }
+  for (int i = 1; i < argc; ++i) {
+    TFLITE_LOG(WARN) << "WARNING: unrecognized commandline flag: " << argv[i];
+  }
+  TF_LITE_ENSURE_STATUS(ParseBackends());
+
+  // Runs the model on the CPU kernels once to get the shapes of the tensors.
+  const std::string graph = single_op_run_params_->Get<std::string>("graph");
+  std::unique_ptr<FlatBufferModel> model =
+      FlatBufferModel::BuildFromFile(graph.c_str());
+  if (model == nullptr) {
+    TFLITE_LOG(ERROR) << "Failed to load the model " << graph;
+    return kTfLiteError;
+  }
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  if (InterpreterBuilder(*model, resolver)(&interpreter) != kTfLiteOk ||
+      interpreter->AllocateTensors() != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to create an interpreter for " << graph;
+    return kTfLiteError;
+  }
+  // Outputs of dynamic size only get their shape when the model runs.
+  if (interpreter->Invoke() != kTfLiteOk) {
+    TFLITE_LOG(WARN) << "Failed to run " << graph
+                     << ", ops on tensors of dynamic size may be skipped.";
+  }
+  std::unique_ptr<ModelT> model_t(model->GetModel()->UnPack());
+
+  // The inputs of the single-op models are generated from their tensors.
+  for (const char* param : {"input_layer", "input_layer_shape",
+                            "input_layer_value_range",
+                            "input_layer_value_files"}) {
+    single_op_run_params_->Set<std::string>(param, "");
+  }
+  single_op_run_params_->Set<bool>("enable_op_profiling", false);
+  single_op_run_params_->Set<std::string>("output_filepath", "");
+  single_op_run_params_->Set<std::string>("arena_timeline_file", "");
+  single_op_run_params_->Set<std::string>("gemm_backend_cache_file", "");
+  single_op_run_params_->Set<int32_t>("num_runs",
+                                      params_.Get<int32_t>("per_op_num_runs"));
+  single_op_run_params_->Set<float>("min_secs", 0.0f);
+
+  // Internally created listeners, like the profiling listener, may become
+  // invalid in the next run, so only the external ones are kept.
+  const int num_external_listeners = single_op_run_->NumListeners();
+  const std::string op_model_path =
+      params_.Get<std::string>("per_op_model_dir") + "/per_op_model.tflite";
+  const int num_ops = model_t->subgraphs[0]->operators.size();
+  std::vector<std::string> op_names(num_ops);
+  std::vector<std::vector<double>> latencies_us(
+      num_ops, std::vector<double>(backends_.size(), -1));
+  for (int i = 0; i < num_ops; ++i) {
+    op_names[i] = GetOpName(*model_t, *model_t->subgraphs[0]->operators[i]);
+    const std::string op_model = ExtractOpModel(*model_t, *interpreter, i);
+    if (op_model.empty()) {
+      TFLITE_LOG(WARN) << "Skipping node " << i << " (" << op_names[i]
+                       << "), which can't run on its own.";
+      continue;
+    }
+    {
+      std::ofstream file(op_model_path, std::ofstream::out |
+                                            std::ofstream::trunc |
+                                            std::ofstream::binary);
+      file.write(op_model.data(), op_model.size());
+      if (!file) {
+        TFLITE_LOG(ERROR) << "Failed to write " << op_model_path;
+        return kTfLiteError;
+      }
+    }
+    for (int backend = 0; backend < static_cast<int>(backends_.size());
+         ++backend) {
+      if (!SetBackendParams(backends_[backend])) continue;
+      single_op_run_->RemoveListeners(num_external_listeners);
+      latencies_us[i][backend] = RunModel(op_model_path);
+    }
+  }
+  std::remove(op_model_path.c_str());
+
+  OutputStats(op_names, latencies_us);
+  return kTfLiteOk;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
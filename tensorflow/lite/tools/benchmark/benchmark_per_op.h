@@ -0,0 +1,104 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_PER_OP_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_PER_OP_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
+
+namespace tflite {
+namespace benchmark {
+
+// Returns a model running only the operator at `op_index` of the primary
+// subgraph of `model`, serialized as a flatbuffer. The inputs of the operator
+// that aren't constant become the model inputs, and its outputs the model
+// outputs. Tensors get the shapes they have in `interpreter`, which runs
+// `model` without delegates, so that the operator runs on the shapes it sees
+// in the full model. Returns an empty string if the operator can't run on its
+// own, e.g. because it calls other subgraphs.
+std::string ExtractOpModel(const ModelT& model, const Interpreter& interpreter,
+                           int op_index);
+
+// Returns the backend each op should run on to minimize the estimated end to
+// end latency, given the latency of every op on every backend in
+// `latencies_us`, negative where the op isn't supported. Switching backends
+// between consecutive ops costs `switch_cost_us`. Ops supported by no backend
+// are assigned -1 and don't add to the latency. `total_us`, if not null, is
+// set to the estimated latency.
+std::vector<int> SuggestPartitioning(
+    const std::vector<std::vector<double>>& latencies_us,
+    double switch_cost_us, double* total_us);
+
+// Benchmarks every op of a model in isolation on every backend, by repeatedly
+// invoking the passed-in 'BenchmarkTfLiteModel' object on models of single
+// ops, then prints the per-op latency matrix and the partitioning of the
+// model across backends with the lowest estimated latency.
+class BenchmarkPerOp {
+ public:
+  // Doesn't own the memory of 'single_op_run'.
+  explicit BenchmarkPerOp(BenchmarkTfLiteModel* single_op_run);
+
+  TfLiteStatus Run(int argc, char** argv);
+
+ private:
+  // Records the average latency of each run, or -1 if the run failed.
+  class LatencyRecorder : public BenchmarkListener {
+   public:
+    void MarkBenchmarkStart() { latency_us_ = -1; }
+    void OnBenchmarkEnd(const BenchmarkResults& results) override {
+      latency_us_ = results.inference_time_us().avg();
+    }
+    double latency_us() const { return latency_us_; }
+
+   private:
+    double latency_us_ = -1;
+  };
+
+  static BenchmarkParams DefaultParams();
+  std::vector<Flag> GetFlags();
+  TfLiteStatus ParseBackends();
+
+  // Sets the parameters of the single-op runs for `backend`. Returns false if
+  // the backend isn't available in this binary.
+  bool SetBackendParams(const std::string& backend);
+
+  // Runs the model at `graph` and returns its average latency, or -1 if it
+  // failed to run.
+  double RunModel(const std::string& graph);
+
+  void OutputStats(const std::vector<std::string>& op_names,
+                   const std::vector<std::vector<double>>& latencies_us) const;
+
+  BenchmarkParams params_;
+  std::vector<std::string> backends_;
+
+  // The object that drives a single-op run.
+  BenchmarkTfLiteModel* const single_op_run_;   // Doesn't own the memory.
+  BenchmarkParams* const single_op_run_params_;  // Doesn't own the memory.
+  LatencyRecorder latency_recorder_;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_PER_OP_H_
@@ -0,0 +1,164 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_per_op.h"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace {
+const std::string* g_model_path = nullptr;
+}  // namespace
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+std::unique_ptr<Interpreter> CreateInterpreter(const FlatBufferModel& model) {
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  if (InterpreterBuilder(model, resolver)(&interpreter) != kTfLiteOk ||
+      interpreter->AllocateTensors() != kTfLiteOk) {
+    return nullptr;
+  }
+  return interpreter;
+}
+
+TEST(SuggestPartitioningTest, SingleBackend) {
+  double total_us = 0;
+  EXPECT_THAT(SuggestPartitioning({{1}, {2}, {3}}, 100, &total_us),
+              ElementsAre(0, 0, 0));
+  EXPECT_DOUBLE_EQ(total_us, 6);
+}
+
+TEST(SuggestPartitioningTest, SwitchesWhenCheaper) {
+  const std::vector<std::vector<double>> latencies_us = {
+      {10, 1}, {10, 1}, {1, 10}};
+  double total_us = 0;
+  EXPECT_THAT(SuggestPartitioning(latencies_us, 5, &total_us),
+              ElementsAre(1, 1, 0));
+  EXPECT_DOUBLE_EQ(total_us, 8);
+
+  EXPECT_THAT(SuggestPartitioning(latencies_us, 100, &total_us),
+              ElementsAre(1, 1, 1));
+  EXPECT_DOUBLE_EQ(total_us, 12);
+}
+
+TEST(SuggestPartitioningTest, UnsupportedOps) {
+  double total_us = 0;
+  EXPECT_THAT(SuggestPartitioning({{-1, 2}, {-1, -1}, {3, -1}}, 10, &total_us),
+              ElementsAre(1, -1, 0));
+  EXPECT_DOUBLE_EQ(total_us, 15);
+}
+
+TEST(ExtractOpModelTest, KeepsRuntimeShapes) {
+  std::unique_ptr<FlatBufferModel> model =
+      FlatBufferModel::BuildFromFile(g_model_path->c_str());
+  ASSERT_NE(model, nullptr);
+  std::unique_ptr<Interpreter> interpreter = CreateInterpreter(*model);
+  ASSERT_NE(interpreter, nullptr);
+  std::unique_ptr<ModelT> model_t(model->GetModel()->UnPack());
+
+  // The second add reads a model input and the output of the first add.
+  const std::string op_model_buffer = ExtractOpModel(*model_t, *interpreter, 1);
+  ASSERT_FALSE(op_model_buffer.empty());
+  std::unique_ptr<FlatBufferModel> op_model = FlatBufferModel::BuildFromBuffer(
+      op_model_buffer.data(), op_model_buffer.size());
+  ASSERT_NE(op_model, nullptr);
+  std::unique_ptr<Interpreter> op_interpreter = CreateInterpreter(*op_model);
+  ASSERT_NE(op_interpreter, nullptr);
+
+  EXPECT_EQ(op_interpreter->nodes_size(), 1);
+  ASSERT_EQ(op_interpreter->inputs().size(), 2);
+  ASSERT_EQ(op_interpreter->outputs().size(), 1);
+  EXPECT_EQ(op_interpreter->input_tensor(0)->name, std::string("a"));
+  EXPECT_EQ(op_interpreter->input_tensor(1)->name, std::string("i"));
+  EXPECT_EQ(op_interpreter->output_tensor(0)->name, std::string("x"));
+  const TfLiteIntArray* dims = op_interpreter->output_tensor(0)->dims;
+  ASSERT_EQ(dims->size, 4);
+  EXPECT_THAT(std::vector<int>(dims->data, dims->data + dims->size),
+              ElementsAre(1, 8, 8, 3));
+  EXPECT_EQ(op_interpreter->Invoke(), kTfLiteOk);
+}
+
+TEST(BenchmarkPerOpTest, OutputsLatencyMatrix) {
+  const std::string csv_file = ::testing::TempDir() + "/per_op.csv";
+  std::vector<std::string> args = {
+      "benchmark",
+      "--graph=" + *g_model_path,
+      "--per_op_backends=cpu",
+      "--per_op_num_runs=2",
+      "--per_op_model_dir=" + ::testing::TempDir(),
+      "--per_op_output_csv_file=" + csv_file,
+  };
+  std::vector<char*> argv;
+  for (std::string& arg : args) argv.push_back(arg.data());
+
+  BenchmarkTfLiteModel benchmark;
+  BenchmarkPerOp per_op_benchmark(&benchmark);
+  ASSERT_EQ(per_op_benchmark.Run(argv.size(), argv.data()), kTfLiteOk);
+
+  std::ifstream csv(csv_file);
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(csv, line);) lines.push_back(line);
+  ASSERT_EQ(lines.size(), 4);
+  EXPECT_EQ(lines[0], "node,op,cpu");
+  for (int i = 1; i < 4; ++i) {
+    EXPECT_THAT(lines[i], HasSubstr(",ADD,"));
+    EXPECT_THAT(lines[i], ::testing::Not(HasSubstr("n/a")));
+  }
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  std::string model_path;
+  std::vector<tflite::Flag> flags = {
+      tflite::Flag::CreateFlag("graph", &model_path,
+                               "Path to a fp32 model file."),
+  };
+  g_model_path = &model_path;
+
+  const bool parse_result =
+      tflite::Flags::Parse(&argc, const_cast<const char**>(argv), flags);
+  if (!parse_result) {
+    std::cerr << tflite::Flags::Usage(argv[0], flags);
+    return 1;
+  }
+
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
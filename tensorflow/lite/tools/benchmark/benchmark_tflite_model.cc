@@ -21,6 +21,7 @@ limitations under the License.
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <random>
 #include <sstream>
@@ -44,9 +45,11 @@ limitations under the License.
 #include "tensorflow/lite/kernels/register.h"
 #include "tensorflow/lite/op_resolver.h"
 #include "tensorflow/lite/optional_debug_tools.h"
+#include "tensorflow/lite/profiling/arena_timeline.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/benchmark/gemm_backend_cache.h"
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
 #include "tensorflow/lite/tools/delegates/delegate_provider.h"
 #include "tensorflow/lite/tools/logging.h"
@@ -151,6 +154,79 @@ class OutputSaver : public BenchmarkListener {
   const BenchmarkParams* params_ = nullptr;
 };
 
+// Exports how tensors are laid out in the memory arenas over the execution
+// plan as a Chrome trace, once the benchmark has run and the arena plan is
+// final.
+class ArenaTimelineSaver : public BenchmarkListener {
+ public:
+  explicit ArenaTimelineSaver(Interpreter* interpreter)
+      : interpreter_(interpreter) {}
+
+  void OnBenchmarkStart(const BenchmarkParams& params) override {
+    params_ = &params;
+  }
+
+  void OnBenchmarkEnd(const BenchmarkResults& results) override {
+    std::string path = params_->Get<std::string>("arena_timeline_file");
+    if (path.empty()) return;
+
+    std::vector<profiling::memory::ArenaTimeline> timelines;
+    for (int i = 0; i < interpreter_->subgraphs_size(); ++i) {
+      timelines.push_back(
+          profiling::memory::GetArenaTimeline(*interpreter_->subgraph(i)));
+      const profiling::memory::ArenaTimeline& timeline = timelines.back();
+      if (timeline.peak_step < 0) continue;
+      const auto& peak = timeline.steps[timeline.peak_step];
+      TFLITE_LOG(INFO) << "Subgraph " << i << " arena size "
+                       << timeline.arena_size << " bytes is driven by node "
+                       << peak.node_index << " (" << peak.op_name << ") with "
+                       << peak.live_bytes << " live bytes";
+    }
+
+    std::ofstream ofs(path, std::ofstream::out);
+    if (!ofs.good()) {
+      TFLITE_LOG(ERROR) << "Failed to open arena timeline file " << path;
+      return;
+    }
+    ofs << profiling::memory::ArenaTimelinesToChromeTrace(timelines);
+    ofs.close();
+  }
+
+ private:
+  Interpreter* const interpreter_ = nullptr;
+  const BenchmarkParams* params_ = nullptr;
+};
+
+// Stores the GEMM backends picked while the benchmark ran, if they were tuned
+// because the cache file had no entry for the model on this CPU.
+class GemmBackendCacheSaver : public BenchmarkListener {
+ public:
+  GemmBackendCacheSaver(const CpuBackendContext* context,
+                        const std::string& key)
+      : context_(context), key_(key) {}
+
+  void OnBenchmarkStart(const BenchmarkParams& params) override {
+    params_ = &params;
+  }
+
+  void OnBenchmarkEnd(const BenchmarkResults& results) override {
+    if (!context_->tune_gemm_backends()) return;
+    std::string path = params_->Get<std::string>("gemm_backend_cache_file");
+    if (!SaveGemmBackends(path, key_, *context_)) {
+      TFLITE_LOG(ERROR) << "Failed to write GEMM backend cache file " << path;
+      return;
+    }
+    TFLITE_LOG(INFO) << "Saved the backends of "
+                     << context_->gemm_backends().size()
+                     << " GEMM shapes to " << path;
+  }
+
+ private:
+  const CpuBackendContext* const context_ = nullptr;
+  const std::string key_;
+  const BenchmarkParams* params_ = nullptr;
+};
+
 std::vector<std::string> Split(const std::string& str, const char delim) {
   if (str.empty()) {
     return {};
@@ -368,12 +444,20 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("print_postinvoke_state",
                           BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("arena_timeline_file",
+                          BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("release_dynamic_tensors",
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("optimize_memory_for_large_tensors",
                           BenchmarkParam::Create<int32_t>(0));
   default_params.AddParam("disable_delegate_clustering",
                           BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("keep_constant_weights_in_place",
+                          BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("gemm_backend_cache_file",
+                          BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("arena_plan_snapshot_file",
+                          BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("output_filepath",
                           BenchmarkParam::Create<std::string>(""));
 
@@ -447,6 +531,10 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "print out the interpreter internals just before benchmark completes "
           "(i.e. after all repeated Invoke calls complete). The internals will "
           "include allocated memory size of each tensor etc."),
+      CreateFlag<std::string>(
+          "arena_timeline_file", &params_,
+          "File path to export the per-tensor arena allocation timeline to, "
+          "in the Chrome trace format."),
       CreateFlag<bool>("release_dynamic_tensors", &params_,
                        "Ensure dynamic tensor's memory is released when they "
                        "are not used."),
@@ -455,6 +543,21 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "Optimize memory usage for large tensors with sacrificing latency."),
       CreateFlag<bool>("disable_delegate_clustering", &params_,
                        "Disable delegate clustering."),
+      CreateFlag<bool>(
+          "keep_constant_weights_in_place", &params_,
+          "Require CPU kernels to read constant weights from the model buffer "
+          "instead of keeping transformed copies of them. Overrides "
+          "use_caching."),
+      CreateFlag<std::string>(
+          "gemm_backend_cache_file", &params_,
+          "File caching the fastest GEMM backend of each GEMM shape of the "
+          "model on this CPU. Backends are tuned during the first run and "
+          "saved if the file has no entry for the model yet."),
+      CreateFlag<std::string>(
+          "arena_plan_snapshot_file", &params_,
+          "File caching the arena plans of the model, to skip planning tensor "
+          "offsets when allocating tensors. Plans are saved if the file "
+          "doesn't exist or doesn't match the model."),
       CreateFlag<std::string>(
           "output_filepath", &params_,
           "File path to export outputs layer as binary data.")};
@@ -496,12 +599,20 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Print pre-invoke interpreter state", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_postinvoke_state",
                       "Print post-invoke interpreter state", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "arena_timeline_file",
+                      "File path to export arena timeline to", verbose);
   LOG_BENCHMARK_PARAM(bool, "release_dynamic_tensors",
                       "Release dynamic tensor memory", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "optimize_memory_for_large_tensors",
                       "Optimize memory usage for large tensors", verbose);
   LOG_BENCHMARK_PARAM(bool, "disable_delegate_clustering",
                       "Disable delegate clustering", verbose);
+  LOG_BENCHMARK_PARAM(bool, "keep_constant_weights_in_place",
+                      "Keep constant weights in place", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "gemm_backend_cache_file",
+                      "GEMM backend cache file", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "arena_plan_snapshot_file",
+                      "Arena plan snapshot file", verbose);
   LOG_BENCHMARK_PARAM(std::string, "output_filepath",
                       "File path to export outputs layer to", verbose);
 
@@ -672,6 +783,10 @@ TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
   auto resolver = GetOpResolver();
   const int32_t num_threads = params_.Get<int32_t>("num_threads");
   const bool use_caching = params_.Get<bool>("use_caching");
+  const bool keep_constant_weights_in_place =
+      params_.Get<bool>("keep_constant_weights_in_place");
+  const std::string gemm_backend_cache_file =
+      params_.Get<std::string>("gemm_backend_cache_file");
 
   InterpreterOptions options;
   options.SetEnsureDynamicTensorsAreReleased(
@@ -692,13 +807,35 @@ TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
     TFLITE_LOG(ERROR) << "Failed to initialize the interpreter";
     return kTfLiteError;
   }
-  // Manually enable caching behavior in TF Lite interpreter.
-  if (use_caching) {
+  // Manually enable caching behavior, in-place weights or GEMM backend
+  // selection in TF Lite interpreter.
+  if (use_caching || keep_constant_weights_in_place ||
+      !gemm_backend_cache_file.empty()) {
     external_context_ = std::make_unique<tflite::ExternalCpuBackendContext>();
     std::unique_ptr<tflite::CpuBackendContext> cpu_backend_context(
         new tflite::CpuBackendContext());
-    cpu_backend_context->SetUseCaching(true);
+    cpu_backend_context->SetUseCaching(use_caching);
+    cpu_backend_context->SetKeepConstantWeightsInPlace(
+        keep_constant_weights_in_place);
     cpu_backend_context->SetMaxNumThreads(num_threads);
+    if (!gemm_backend_cache_file.empty()) {
+      const Allocation* allocation = model_->allocation();
+      gemm_backend_cache_key_ =
+          allocation ? GetGemmBackendCacheKey(allocation->base(),
+                                              allocation->bytes())
+                     : GetGemmBackendCacheKey(nullptr, 0);
+      if (LoadGemmBackends(gemm_backend_cache_file, gemm_backend_cache_key_,
+                           cpu_backend_context.get())) {
+        TFLITE_LOG(INFO) << "Loaded the backends of "
+                         << cpu_backend_context->gemm_backends().size()
+                         << " GEMM shapes from " << gemm_backend_cache_file;
+      } else {
+        TFLITE_LOG(INFO) << "No GEMM backends cached for this model and CPU, "
+                            "tuning them during the first run";
+        cpu_backend_context->SetTuneGemmBackends(true);
+      }
+    }
+    cpu_backend_context_ = cpu_backend_context.get();
     external_context_->set_internal_backend_context(
         std::move(cpu_backend_context));
     interpreter_->SetExternalContext(kTfLiteCpuBackendContext,
@@ -851,15 +988,52 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
     }
   }
 
+  const std::string arena_plan_snapshot_file =
+      params_.Get<std::string>("arena_plan_snapshot_file");
+  bool arena_plans_restored = false;
+  if (!arena_plan_snapshot_file.empty()) {
+    std::ifstream file(arena_plan_snapshot_file, std::ifstream::binary);
+    if (file) {
+      const std::string snapshot((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+      arena_plans_restored =
+          interpreter_->RestoreArenaPlanSnapshot(snapshot) == kTfLiteOk;
+      if (!arena_plans_restored) {
+        TFLITE_LOG(WARN) << "Ignoring the arena plans in "
+                         << arena_plan_snapshot_file
+                         << ", which don't match the model.";
+      }
+    }
+  }
+
   if (interpreter_->AllocateTensors() != kTfLiteOk) {
     TFLITE_LOG(ERROR) << "Failed to allocate tensors!";
     return kTfLiteError;
   }
 
+  if (!arena_plan_snapshot_file.empty() && !arena_plans_restored) {
+    const std::string snapshot = interpreter_->GetArenaPlanSnapshot();
+    std::ofstream file(arena_plan_snapshot_file,
+                       std::ofstream::out | std::ofstream::trunc |
+                           std::ofstream::binary);
+    file.write(snapshot.data(), snapshot.size());
+    if (!file) {
+      TFLITE_LOG(WARN) << "Failed to save the arena plans to "
+                       << arena_plan_snapshot_file;
+    }
+  }
+
   AddOwnedListener(
       std::unique_ptr<BenchmarkListener>(new RuyProfileListener()));
   AddOwnedListener(
       std::unique_ptr<BenchmarkListener>(new OutputSaver(interpreter_.get())));
+  AddOwnedListener(std::unique_ptr<BenchmarkListener>(
+      new ArenaTimelineSaver(interpreter_.get())));
+  if (!params_.Get<std::string>("gemm_backend_cache_file").empty()) {
+    AddOwnedListener(std::unique_ptr<BenchmarkListener>(
+        new GemmBackendCacheSaver(cpu_backend_context_,
+                                  gemm_backend_cache_key_)));
+  }
 
   return kTfLiteOk;
 }
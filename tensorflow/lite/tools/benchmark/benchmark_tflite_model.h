@@ -25,6 +25,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/core/model.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/profiling/profiler.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
 #include "tensorflow/lite/tools/model_loader.h"
@@ -113,6 +114,10 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   std::unique_ptr<tflite::FlatBufferModel> model_;
   std::unique_ptr<tflite::Interpreter> interpreter_;
   std::unique_ptr<tflite::ExternalCpuBackendContext> external_context_;
+  // Owned by `external_context_`, if any.
+  tflite::CpuBackendContext* cpu_backend_context_ = nullptr;
+  // The key of the model in the GEMM backend cache file, if any.
+  std::string gemm_backend_cache_key_;
 
  private:
   utils::InputTensorData CreateRandomTensorData(
@@ -0,0 +1,157 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/gemm_backend_cache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+constexpr char kKeyPrefix[] = "model ";
+constexpr char kGemmPrefix[] = "gemm ";
+
+bool StartsWith(const std::string& str, const char* prefix) {
+  return str.rfind(prefix, 0) == 0;
+}
+
+// FNV-1a, which is enough to tell models apart.
+uint64_t HashBytes(const void* data, size_t size) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Returns the name of the CPU model, as reported by the kernel on Linux.
+std::string GetCpuModel() {
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string hardware;
+  for (std::string line; std::getline(cpuinfo, line);) {
+    const size_t colon = line.find(':');
+    if (colon == std::string::npos || colon + 2 > line.size()) continue;
+    const std::string value = line.substr(colon + 2);
+    // x86 reports a model name per core, ARM a hardware name per SoC.
+    if (StartsWith(line, "model name")) return value;
+    if (StartsWith(line, "Hardware")) hardware = value;
+  }
+  return hardware.empty() ? "unknown" : hardware;
+}
+
+const char* BackendName(CpuBackendContext::GemmBackend backend) {
+  switch (backend) {
+    case CpuBackendContext::GemmBackend::kRuy:
+      return "ruy";
+    case CpuBackendContext::GemmBackend::kDefault:
+      return "default";
+  }
+  return "default";
+}
+
+bool ParseGemmLine(const std::string& line,
+                   CpuBackendContext::GemmShape* shape,
+                   CpuBackendContext::GemmBackend* backend) {
+  std::istringstream stream(line.substr(sizeof(kGemmPrefix) - 1));
+  int lhs_type, rhs_type, dst_type;
+  std::string name;
+  if (!(stream >> lhs_type >> rhs_type >> dst_type >> shape->rows >>
+        shape->depth >> shape->cols >> name)) {
+    return false;
+  }
+  shape->lhs_type = static_cast<TfLiteType>(lhs_type);
+  shape->rhs_type = static_cast<TfLiteType>(rhs_type);
+  shape->dst_type = static_cast<TfLiteType>(dst_type);
+  if (name == "ruy") {
+    *backend = CpuBackendContext::GemmBackend::kRuy;
+  } else if (name == "default") {
+    *backend = CpuBackendContext::GemmBackend::kDefault;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+std::string GetGemmBackendCacheKey(const void* model_data, size_t model_size) {
+  char hash[17];
+  snprintf(hash, sizeof(hash), "%016llx",
+           static_cast<unsigned long long>(  // NOLINT(runtime/int)
+               HashBytes(model_data, model_size)));
+  return std::string(kKeyPrefix) + hash + " cpu " + GetCpuModel();
+}
+
+bool LoadGemmBackends(const std::string& path, const std::string& key,
+                      CpuBackendContext* context) {
+  std::ifstream file(path);
+  bool found = false;
+  bool in_entry = false;
+  for (std::string line; std::getline(file, line);) {
+    if (StartsWith(line, kKeyPrefix)) {
+      in_entry = line == key;
+      found |= in_entry;
+      continue;
+    }
+    if (!in_entry || !StartsWith(line, kGemmPrefix)) continue;
+    CpuBackendContext::GemmShape shape;
+    CpuBackendContext::GemmBackend backend;
+    if (ParseGemmLine(line, &shape, &backend)) {
+      context->SetGemmBackend(shape, backend);
+    }
+  }
+  return found;
+}
+
+bool SaveGemmBackends(const std::string& path, const std::string& key,
+                      const CpuBackendContext& context) {
+  // Keep the entries of other models and CPUs.
+  std::vector<std::string> lines;
+  {
+    std::ifstream file(path);
+    bool in_entry = false;
+    for (std::string line; std::getline(file, line);) {
+      if (StartsWith(line, kKeyPrefix)) in_entry = line == key;
+      if (!in_entry) lines.push_back(line);
+    }
+  }
+
+  std::ofstream file(path, std::ofstream::out | std::ofstream::trunc);
+  if (!file.good()) return false;
+  for (const std::string& line : lines) file << line << "\n";
+  file << key << "\n";
+  for (const auto& it : context.gemm_backends()) {
+    const CpuBackendContext::GemmShape& shape = it.first;
+    file << kGemmPrefix << shape.lhs_type << " " << shape.rhs_type << " "
+         << shape.dst_type << " " << shape.rows << " " << shape.depth << " "
+         << shape.cols << " " << BackendName(it.second) << "\n";
+  }
+  file.close();
+  return file.good();
+}
+
+}  // namespace benchmark
+}  // namespace tflite
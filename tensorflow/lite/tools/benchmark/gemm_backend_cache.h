@@ -0,0 +1,51 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_GEMM_BACKEND_CACHE_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_GEMM_BACKEND_CACHE_H_
+
+#include <cstddef>
+#include <string>
+
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+
+namespace tflite {
+namespace benchmark {
+
+// A text file that stores the GEMM backends chosen for models, per model and
+// CPU. Each entry starts with a key line
+//   model <hash of the model> cpu <CPU model name>
+// followed by one line per GEMM shape
+//   gemm <lhs type> <rhs type> <dst type> <rows> <depth> <cols> <backend>
+// where types are TfLiteType values and backend is "default" or "ruy".
+
+// Returns the key under which the choices for the model in `model_data` on
+// this CPU are stored.
+std::string GetGemmBackendCacheKey(const void* model_data, size_t model_size);
+
+// Sets the backends stored under `key` in the file at `path` on `context`.
+// Returns false if the file has no entry for `key`.
+bool LoadGemmBackends(const std::string& path, const std::string& key,
+                      CpuBackendContext* context);
+
+// Stores the backends of `context` under `key` in the file at `path`,
+// replacing a previous entry for `key` and keeping the other ones.
+bool SaveGemmBackends(const std::string& path, const std::string& key,
+                      const CpuBackendContext& context);
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_GEMM_BACKEND_CACHE_H_
@@ -0,0 +1,103 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/benchmark/gemm_backend_cache.h"
+
+#include <cstdio>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+using GemmBackend = CpuBackendContext::GemmBackend;
+using GemmShape = CpuBackendContext::GemmShape;
+
+constexpr GemmShape kFloatShape = {kTfLiteFloat32, kTfLiteFloat32,
+                                   kTfLiteFloat32, 16, 64, 1};
+constexpr GemmShape kInt8Shape = {kTfLiteInt8, kTfLiteInt8, kTfLiteInt8,
+                                  32, 128, 49};
+
+GemmBackend Backend(const CpuBackendContext& context, const GemmShape& shape) {
+  GemmBackend backend = GemmBackend::kDefault;
+  EXPECT_TRUE(context.GetGemmBackend(shape, &backend));
+  return backend;
+}
+
+std::string CachePath() {
+  std::string path = testing::TempDir() + "/gemm_backend_cache.txt";
+  std::remove(path.c_str());
+  return path;
+}
+
+TEST(GemmBackendCacheTest, KeyDependsOnModel) {
+  const char model_a[] = "model a";
+  const char model_b[] = "model b";
+  EXPECT_EQ(GetGemmBackendCacheKey(model_a, sizeof(model_a)),
+            GetGemmBackendCacheKey(model_a, sizeof(model_a)));
+  EXPECT_NE(GetGemmBackendCacheKey(model_a, sizeof(model_a)),
+            GetGemmBackendCacheKey(model_b, sizeof(model_b)));
+}
+
+TEST(GemmBackendCacheTest, MissingFile) {
+  CpuBackendContext context;
+  EXPECT_FALSE(LoadGemmBackends(CachePath(), "model 0 cpu x", &context));
+  EXPECT_TRUE(context.gemm_backends().empty());
+}
+
+TEST(GemmBackendCacheTest, SaveAndLoad) {
+  const std::string path = CachePath();
+  CpuBackendContext saved_a, saved_b;
+  saved_a.SetGemmBackend(kFloatShape, GemmBackend::kRuy);
+  saved_a.SetGemmBackend(kInt8Shape, GemmBackend::kDefault);
+  saved_b.SetGemmBackend(kFloatShape, GemmBackend::kDefault);
+  ASSERT_TRUE(SaveGemmBackends(path, "model a cpu x", saved_a));
+  ASSERT_TRUE(SaveGemmBackends(path, "model b cpu x", saved_b));
+
+  CpuBackendContext loaded;
+  ASSERT_TRUE(LoadGemmBackends(path, "model a cpu x", &loaded));
+  EXPECT_EQ(loaded.gemm_backends().size(), 2);
+  EXPECT_EQ(Backend(loaded, kFloatShape), GemmBackend::kRuy);
+  EXPECT_EQ(Backend(loaded, kInt8Shape), GemmBackend::kDefault);
+
+  EXPECT_FALSE(LoadGemmBackends(path, "model c cpu x", &loaded));
+}
+
+TEST(GemmBackendCacheTest, SaveReplacesEntry) {
+  const std::string path = CachePath();
+  CpuBackendContext first, second, other;
+  first.SetGemmBackend(kFloatShape, GemmBackend::kRuy);
+  first.SetGemmBackend(kInt8Shape, GemmBackend::kRuy);
+  second.SetGemmBackend(kFloatShape, GemmBackend::kDefault);
+  other.SetGemmBackend(kInt8Shape, GemmBackend::kDefault);
+  ASSERT_TRUE(SaveGemmBackends(path, "model a cpu x", first));
+  ASSERT_TRUE(SaveGemmBackends(path, "model b cpu x", other));
+  ASSERT_TRUE(SaveGemmBackends(path, "model a cpu x", second));
+
+  CpuBackendContext loaded_a, loaded_b;
+  ASSERT_TRUE(LoadGemmBackends(path, "model a cpu x", &loaded_a));
+  EXPECT_EQ(loaded_a.gemm_backends().size(), 1);
+  EXPECT_EQ(Backend(loaded_a, kFloatShape), GemmBackend::kDefault);
+  ASSERT_TRUE(LoadGemmBackends(path, "model b cpu x", &loaded_b));
+  EXPECT_EQ(loaded_b.gemm_backends().size(), 1);
+  EXPECT_EQ(Backend(loaded_b, kInt8Shape), GemmBackend::kDefault);
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
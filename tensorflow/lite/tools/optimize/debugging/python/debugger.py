@@ -231,18 +231,23 @@ class QuantizationDebugger:
     self._metrics = metrics_stub.TFLiteMetrics()
     self._metrics.increase_counter_debugger_creation()
 
-  def _get_quantized_model(self, is_debug: bool) -> bytes:
+  def _get_quantized_model(
+      self,
+      is_debug: bool,
+      denylisted_nodes: Optional[List[str]] = None) -> bytes:
     if not self.converter:
       raise ValueError('No converter found, use this function with the '
                        'converter option in the constructor.')
 
+    if denylisted_nodes is None:
+      denylisted_nodes = self._debug_options.denylisted_nodes
     return convert.mlir_quantize(
         self.calibrated_model,
         disable_per_channel=self.converter._experimental_disable_per_channel,  # pylint: disable=protected-access
         fully_quantize=self._debug_options.fully_quantize,
         enable_numeric_verify=is_debug,
         denylisted_ops=self._debug_options.denylisted_ops,
-        denylisted_nodes=self._debug_options.denylisted_nodes)
+        denylisted_nodes=denylisted_nodes)
 
   def get_nondebug_quantized_model(self) -> bytes:
     """Returns a non-instrumented quantized model.
@@ -272,6 +277,75 @@ class QuantizationDebugger:
     """
     return self._get_quantized_model(is_debug=True)
 
+  def get_sensitive_nodes(self,
+                          metric_name: str = 'mean_squared_error',
+                          error_budget: float = 0.0) -> List[str]:
+    """Returns the nodes to keep in float to stay within an error budget.
+
+    Ranks the layers by `metric_name` from the layer statistics collected on
+    the debug dataset, and picks the most sensitive ones until the metric summed
+    over the layers left quantized is at most `error_budget`. Runs the debugger
+    first if it has not run yet.
+
+    Args:
+      metric_name: name of the layer debug metric measuring the sensitivity of a
+        layer to quantization. Larger values are more sensitive.
+      error_budget: largest sum of `metric_name` over the quantized layers.
+
+    Returns:
+      Names of the output tensors of the nodes to keep in float, most sensitive
+      first.
+    Raises:
+      ValueError: if `metric_name` is not a layer debug metric.
+    """
+    if self.layer_statistics is None:
+      self.run()
+    if self.layer_statistics and not all(
+        metric_name in metrics for metrics in self.layer_statistics.values()):
+      raise ValueError('Unknown layer debug metric: {}'.format(metric_name))
+
+    sensitivities = sorted(
+        ((metrics[metric_name], name)
+         for name, metrics in self.layer_statistics.items()
+         if not np.isnan(metrics[metric_name])),
+        reverse=True)
+    total_error = sum(sensitivity for sensitivity, _ in sensitivities)
+    sensitive_nodes = []
+    for sensitivity, name in sensitivities:
+      if total_error <= error_budget:
+        break
+      total_error -= sensitivity
+      sensitive_nodes.append(self._get_operand_name_and_index(name)[0])
+    return sensitive_nodes
+
+  def get_mixed_precision_quantized_model(
+      self,
+      metric_name: str = 'mean_squared_error',
+      error_budget: float = 0.0) -> bytes:
+    """Returns a quantized model with its most sensitive nodes kept in float.
+
+    The nodes returned by `get_sensitive_nodes` are added to the denylisted
+    nodes of the debug options, and the model is quantized without
+    instrumentation.
+
+    Args:
+      metric_name: name of the layer debug metric measuring the sensitivity of a
+        layer to quantization.
+      error_budget: largest sum of `metric_name` over the quantized layers.
+
+    Returns:
+      Model bytes corresponding to the model.
+    Raises:
+      ValueError: if converter is not passed to the debugger.
+    """
+    if not self.converter:
+      raise ValueError('No converter found, use this function with the '
+                       'converter option in the constructor.')
+    denylisted_nodes = list(self._debug_options.denylisted_nodes or [])
+    denylisted_nodes.extend(self.get_sensitive_nodes(metric_name, error_budget))
+    return self._get_quantized_model(
+        is_debug=False, denylisted_nodes=denylisted_nodes)
+
   def _init_from_converter(self,
                            options: QuantizationDebugOptions,
                            converter: TFLiteConverter,
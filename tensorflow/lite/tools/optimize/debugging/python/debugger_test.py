@@ -424,6 +424,29 @@ class QuantizationDebuggerTest(test_util.TensorFlowTestCase,
           debug_dataset=_calibration_gen,
           debug_options=options)
 
+  @test_util.run_v2_only
+  def test_mixed_precision_quantized_model(self):
+    quant_debugger = debugger.QuantizationDebugger(
+        converter=_quantize_converter(self.tf_model_root, self.tf_model,
+                                      _calibration_gen),
+        debug_dataset=_calibration_gen)
+
+    # Without error budget every layer with quantization error stays in float.
+    sensitive_nodes = quant_debugger.get_sensitive_nodes(error_budget=0.0)
+    num_erroneous_layers = sum(
+        metrics['mean_squared_error'] > 0
+        for metrics in quant_debugger.layer_statistics.values())
+    self.assertLen(sensitive_nodes, num_erroneous_layers)
+    self.assertEmpty(
+        quant_debugger.get_sensitive_nodes(error_budget=float('inf')))
+    with self.assertRaisesRegex(ValueError, 'Unknown layer debug metric'):
+      quant_debugger.get_sensitive_nodes(metric_name='unknown')
+
+    mixed_precision_model = quant_debugger.get_mixed_precision_quantized_model(
+        error_budget=float('inf'))
+    self.assertEqual(mixed_precision_model,
+                     quant_debugger.get_nondebug_quantized_model())
+
   @mock.patch.object(metrics.TFLiteMetrics,
                      'increase_counter_debugger_creation')
   def test_creation_counter(self, increase_call):
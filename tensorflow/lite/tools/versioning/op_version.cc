@@ -216,6 +216,12 @@ int GetBuiltinOperatorVersion(const OpSignature& op_sig) {
     }
 
     case BuiltinOperator_GATHER: {
+      // If the op takes uint8 or int16 positions, e.g. indices into the
+      // palette of palettized weights, it is version 6.
+      if (op_sig.inputs.at(1).type == kTfLiteUInt8 ||
+          op_sig.inputs.at(1).type == kTfLiteInt16) {
+        return 6;
+      }
       auto gather_params =
           reinterpret_cast<TfLiteGatherParams*>(op_sig.builtin_data);
       if (gather_params && gather_params->batch_dims != 0) {
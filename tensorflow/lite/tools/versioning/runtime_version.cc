@@ -122,11 +122,13 @@ std::string FindMinimumRuntimeVersionForOp(tflite::BuiltinOperator op_code,
            {{BuiltinOperator_FULLY_CONNECTED, 7}, "2.3.0"},
            {{BuiltinOperator_FULLY_CONNECTED, 8}, "2.3.0"},
            {{BuiltinOperator_FULLY_CONNECTED, 9}, "2.3.0"},
+           {{BuiltinOperator_FULLY_CONNECTED, 10}, "2.13.0"},
            {{BuiltinOperator_GATHER, 1}, "1.6.0"},
            {{BuiltinOperator_GATHER, 2}, "1.14.0"},
            {{BuiltinOperator_GATHER, 3}, "1.15.0"},
            {{BuiltinOperator_GATHER, 4}, "2.4.0"},
            {{BuiltinOperator_GATHER, 5}, "2.5.0"},
+           {{BuiltinOperator_GATHER, 6}, "2.13.0"},
            {{BuiltinOperator_GATHER_ND, 1}, "1.14.0"},
            {{BuiltinOperator_GATHER_ND, 2}, "2.3.0"},
            {{BuiltinOperator_GATHER_ND, 3}, "2.5.0"},
@@ -22,8 +22,12 @@ from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.util import structure
 from tensorflow.python.eager import context
 from tensorflow.python.framework import combinations
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
 from tensorflow.python.framework import sparse_tensor
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
 from tensorflow.python.ops.ragged import ragged_factory_ops
 from tensorflow.python.platform import test
 
@@ -80,15 +84,20 @@ def _test_v2_eager_only_objects():
 class CompressionOpsTest(test_base.DatasetTestBase, parameterized.TestCase):
 
   @combinations.generate(
-      combinations.times(test_base.default_test_combinations(),
-                         combinations.combine(element=_test_objects())) +
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(
+              element=_test_objects(), adaptive_codecs=[False, True])) +
       combinations.times(
           test_base.v2_eager_only_combinations(),
-          combinations.combine(element=_test_v2_eager_only_objects())))
-  def testCompression(self, element):
+          combinations.combine(
+              element=_test_v2_eager_only_objects(),
+              adaptive_codecs=[False, True])))
+  def testCompression(self, element, adaptive_codecs):
     element = element._obj
 
-    compressed = compression_ops.compress(element)
+    compressed = compression_ops.compress(
+        element, adaptive_codecs=adaptive_codecs)
     uncompressed = compression_ops.uncompress(
         compressed, structure.type_spec_from_value(element))
     self.assertValuesEqual(element, self.evaluate(uncompressed))
@@ -109,6 +118,20 @@ class CompressionOpsTest(test_base.DatasetTestBase, parameterized.TestCase):
     dataset = dataset.map(lambda x: compression_ops.uncompress(x, element_spec))
     self.assertDatasetProduces(dataset, [element])
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testDatasetAdaptiveCompression(self):
+    # Sorted integers, repetitive floats and strings pick different codecs.
+    element = (math_ops.range(1000, dtype=dtypes.int64),
+               array_ops.fill([1000], 1.5), constant_op.constant(["a"] * 100))
+
+    dataset = dataset_ops.Dataset.from_tensors(element)
+    element_spec = dataset.element_spec
+
+    dataset = dataset.map(
+        lambda *x: compression_ops.compress(x, adaptive_codecs=True))
+    dataset = dataset.map(lambda x: compression_ops.uncompress(x, element_spec))
+    self.assertDatasetProduces(dataset, [self.evaluate(element)])
+
   @combinations.generate(
       combinations.times(test_base.default_test_combinations()))
   def testCompressionOutputDTypeMismatch(self):
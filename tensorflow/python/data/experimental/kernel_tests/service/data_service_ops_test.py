@@ -1355,8 +1355,9 @@ class DataServiceOpsGrpcDataTransferTest(data_service_test_base.TestBase,
     self.assertDatasetProduces(ds, list(range(10)))
 
   @combinations.generate(
-      combinations.times(test_base.default_test_combinations(),
-                         combinations.combine(compression=[None, "AUTO"])))
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(compression=[None, "AUTO", "ADAPTIVE"])))
   def testDistributeCompression(self, compression):
     cluster = data_service_test_base.TestCluster(num_workers=1)
     num_elements = 10
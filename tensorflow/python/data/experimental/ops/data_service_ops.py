@@ -38,6 +38,7 @@ from tensorflow.python.util import lazy_loader
 from tensorflow.python.util.tf_export import tf_export
 
 COMPRESSION_AUTO = "AUTO"
+COMPRESSION_ADAPTIVE = "ADAPTIVE"
 COMPRESSION_NONE = None
 _PARALLEL_EPOCHS = "parallel_epochs"
 _DISTRIBUTED_EPOCH = "distributed_epoch"
@@ -188,7 +189,8 @@ def _validate_job_name(job_name):
 
 
 def _validate_compression(compression):
-  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_NONE]
+  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_ADAPTIVE,
+                        COMPRESSION_NONE]
   if compression not in valid_compressions:
     raise ValueError(f"Invalid `compression` argument: {compression}. "
                      f"Must be one of {valid_compressions}.")
@@ -197,10 +199,14 @@ def _validate_compression(compression):
 def _get_compression_proto(compression):
   if compression == COMPRESSION_AUTO:
     return data_service_pb2.DataServiceMetadata.COMPRESSION_SNAPPY
+  if compression == COMPRESSION_ADAPTIVE:
+    return data_service_pb2.DataServiceMetadata.COMPRESSION_ADAPTIVE
   if compression == COMPRESSION_NONE:
     return data_service_pb2.DataServiceMetadata.COMPRESSION_OFF
+  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_ADAPTIVE,
+                        COMPRESSION_NONE]
   raise ValueError(f"Invalid `compression` argument: {compression}. "
-                   f"Must be one of {[COMPRESSION_AUTO, COMPRESSION_NONE]}.")
+                   f"Must be one of {valid_compressions}.")
 
 
 def _to_tensor(dataset_id):
@@ -493,7 +499,9 @@ def _distribute(processing_mode,
       data with the tf.data service. By default, data is transferred using gRPC.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "ADAPTIVE" compresses each component with a
+      codec chosen from its dtype and contents. `None` indicates not to
+      compress.
     cross_trainer_cache: (Optional.) If a `CrossTrainerCache` object is
       provided, dataset iteration will be shared across concurrently running
       trainers. See
@@ -750,7 +758,9 @@ def distribute(processing_mode,
       data with the tf.data service. By default, data is transferred using gRPC.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "ADAPTIVE" compresses each component with a
+      codec chosen from its dtype and contents. `None` indicates not to
+      compress.
     cross_trainer_cache: (Optional.) If a `CrossTrainerCache` object is
       provided, dataset iteration will be shared across concurrently running
       trainers. See
@@ -797,7 +807,9 @@ def _register_dataset(service, dataset, compression, dataset_id=None):
     dataset: A `tf.data.Dataset` to register with the tf.data service.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "ADAPTIVE" compresses each component with a
+      codec chosen from its dtype and contents. `None` indicates not to
+      compress.
     dataset_id: (Optional.) By default, tf.data service generates a unique
       (string) ID for each registered dataset. If a `dataset_id` is provided, it
       will use the specified ID. If a dataset with a matching ID already exists,
@@ -822,9 +834,11 @@ def _register_dataset(service, dataset, compression, dataset_id=None):
     encoded_spec = nested_structure_coder.encode_structure(
         dataset.element_spec).SerializeToString()
 
-  if compression == COMPRESSION_AUTO:
+  if compression in (COMPRESSION_AUTO, COMPRESSION_ADAPTIVE):
+    adaptive_codecs = compression == COMPRESSION_ADAPTIVE
     dataset = dataset.map(
-        lambda *x: compression_ops.compress(x),
+        lambda *x: compression_ops.compress(
+            x, adaptive_codecs=adaptive_codecs),
         num_parallel_calls=dataset_ops.AUTOTUNE)
   dataset = dataset.prefetch(dataset_ops.AUTOTUNE)
   dataset = dataset._apply_debug_options()  # pylint: disable=protected-access
@@ -882,8 +896,9 @@ def register_dataset(service, dataset, compression="AUTO", dataset_id=None):
     dataset: A `tf.data.Dataset` to register with the tf.data service.
     compression: (Optional.) How to compress the dataset's elements before
       transferring them over the network. "AUTO" leaves the decision of how to
-      compress up to the tf.data service runtime. `None` indicates not to
-      compress.
+      compress up to the tf.data service runtime. "ADAPTIVE" compresses each
+      component with a codec chosen from its dtype and contents. `None`
+      indicates not to compress.
     dataset_id: (Optional.) By default, tf.data service generates a unique
       (string) ID for each registered dataset. If a `dataset_id` is provided, it
       will use the specified ID. If a dataset with a matching ID already exists,
@@ -152,6 +152,7 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.experimental_slack = True
     options.threading.max_intra_op_parallelism = 30
     options.threading.private_threadpool_size = 40
+    options.threading.numa_node = 1
     pb = options._to_proto()
     result = options_lib.Options()
     result._from_proto(pb)
@@ -189,6 +190,16 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     opts.experimental_threading.private_threadpool_size = 80
     self.assertEqual(opts.threading.private_threadpool_size, 80)
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testNumaNode(self):
+    dataset = dataset_ops.Dataset.range(10).map(
+        lambda x: x * 2, num_parallel_calls=2)
+    options = options_lib.Options()
+    # The option is ignored if NUMA is not supported by the platform.
+    options.threading.numa_node = 0
+    dataset = dataset.with_options(options)
+    self.assertDatasetProduces(dataset, [x * 2 for x in range(10)])
+
   @combinations.generate(test_base.default_test_combinations())
   def testExperimentalThreadingOptionsOverride(self):
     options = options_lib.Options()
@@ -43,12 +43,19 @@ class AutotuneAlgorithm(enum.Enum):
 
   STAGE_BASED: In each optimization step, this algorithm chooses the worst
   bottleneck parameter and increases its value by 1.
+
+  WARM_START: Initializes the parameters from a profile recorded by a previous
+  run of the same input pipeline and refines them similarly to HILL_CLIMB. The
+  profiles are stored in the directory given by the
+  `TF_DATA_AUTOTUNE_PROFILE_DIR` environment variable, or in a subdirectory of
+  the local temporary directory if it is not set.
   """
   DEFAULT = 0
   HILL_CLIMB = 1
   GRADIENT_DESCENT = 2
   MAX_PARALLELISM = 3
   STAGE_BASED = 4
+  WARM_START = 5
 
   @classmethod
   def _to_proto(cls, obj):
@@ -62,9 +69,11 @@ class AutotuneAlgorithm(enum.Enum):
       return model_pb2.AutotuneAlgorithm.MAX_PARALLELISM
     if obj == cls.STAGE_BASED:
       return model_pb2.AutotuneAlgorithm.STAGE_BASED
+    if obj == cls.WARM_START:
+      return model_pb2.AutotuneAlgorithm.WARM_START
     raise ValueError(
         f"Invalid `obj.` Supported values include `DEFAULT`, `HILL_CLIMB` "
-        f"`GRADIENT_DESCENT`, and `STAGE_BASED`. Got {obj.name}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED` and `WARM_START`. Got {obj.name}.")
 
   @classmethod
   def _from_proto(cls, pb):
@@ -78,9 +87,11 @@ class AutotuneAlgorithm(enum.Enum):
       return cls.MAX_PARALLELISM
     if pb == model_pb2.AutotuneAlgorithm.STAGE_BASED:
       return cls.STAGE_BASED
+    if pb == model_pb2.AutotuneAlgorithm.WARM_START:
+      return cls.WARM_START
     raise ValueError(
         f"Invalid `pb.` Supported values include `DEFAULT`, `HILL_CLIMB`, "
-        f"`GRADIENT_DESCENT` and `STAGE_BASED`. Got {pb}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED` and `WARM_START`. Got {pb}.")
 
 
 @tf_export("data.experimental.AutoShardPolicy")
@@ -473,12 +484,23 @@ class ThreadingOptions(options_lib.OptionsBase):
       "The value 0 can be used to indicate that the threadpool size should be "
       "determined at runtime based on the number of available CPU cores.")
 
+  numa_node = options_lib.create_option(
+      name="numa_node",
+      ty=int,
+      docstring=
+      "If set, the threads that produce the elements of the dataset and the "
+      "memory of the elements they produce are placed on the given NUMA node. "
+      "This should be the node of the device that consumes the elements. The "
+      "option is ignored if NUMA is not supported or the node does not exist.")
+
   def _to_proto(self):
     pb = dataset_options_pb2.ThreadingOptions()
     if self.max_intra_op_parallelism is not None:
       pb.max_intra_op_parallelism = self.max_intra_op_parallelism
     if self.private_threadpool_size is not None:
       pb.private_threadpool_size = self.private_threadpool_size
+    if self.numa_node is not None:
+      pb.numa_node = self.numa_node
     return pb
 
   def _from_proto(self, pb):
@@ -486,6 +508,8 @@ class ThreadingOptions(options_lib.OptionsBase):
       self.max_intra_op_parallelism = pb.max_intra_op_parallelism
     if pb.WhichOneof("optional_private_threadpool_size") is not None:
       self.private_threadpool_size = pb.private_threadpool_size
+    if pb.WhichOneof("optional_numa_node") is not None:
+      self.numa_node = pb.numa_node
 
 
 @tf_export("data.Options")
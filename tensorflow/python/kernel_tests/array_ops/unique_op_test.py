@@ -166,6 +166,17 @@ class UniqueTest(test.TestCase):
     self.assertAllEqual(tf_y, true_y)
     self.assertAllEqual(tf_idx, true_idx)
 
+  def testLarge(self):
+    # Large enough to be uniquified in parallel.
+    x = np.random.randint(1000, size=1 << 18)
+    _, first, true_idx = np.unique(x, return_index=True, return_inverse=True)
+    order = np.argsort(first)
+    rank = np.argsort(order)
+    y, idx = array_ops.unique(x)
+    tf_y, tf_idx = self.evaluate([y, idx])
+    self.assertAllEqual(tf_y, x[np.sort(first)])
+    self.assertAllEqual(tf_idx, rank[true_idx])
+
 
 class UniqueWithCountsTest(test.TestCase):
 
@@ -313,6 +324,19 @@ class UniqueWithCountsTest(test.TestCase):
     self.assertAllEqual(tf_idx, true_idx)
     self.assertAllEqual(tf_count, true_count)
 
+  def testLarge(self):
+    # Large enough to be uniquified in parallel.
+    x = np.random.randint(1000, size=1 << 18)
+    _, first, true_idx, true_count = np.unique(
+        x, return_index=True, return_inverse=True, return_counts=True)
+    order = np.argsort(first)
+    rank = np.argsort(order)
+    y, idx, count = array_ops.unique_with_counts(x)
+    tf_y, tf_idx, tf_count = self.evaluate([y, idx, count])
+    self.assertAllEqual(tf_y, x[np.sort(first)])
+    self.assertAllEqual(tf_idx, rank[true_idx])
+    self.assertAllEqual(tf_count, true_count[order])
+
 
 if __name__ == '__main__':
   test.main()
@@ -323,5 +323,35 @@ class AbortCollectiveOpsTest(test.TestCase, parameterized.TestCase):
                                       group_key, instance_key)
 
 
+@combinations.generate(
+    combinations.combine(
+        mode="eager", num_workers=2, runner=two_worker_pool_runner))
+class CompressionTest(test.TestCase, parameterized.TestCase):
+
+  def testBfloat16Compression(self):
+    cluster_resolver = cluster_resolver_lib.TFConfigClusterResolver()
+    enable_collective_ops_with_barrier(cluster_resolver)
+    group_size = 2
+    group_key = 200
+    instance_key = 200
+    # 1 + 2**-10 is not representable in bfloat16, so the sum is rounded to
+    # 1 on both workers when the transfers between them are compressed.
+    if cluster_resolver.task_id == 0:
+      in_tensor = constant_op.constant([1. + 2.**-10] * 4)
+    else:
+      in_tensor = constant_op.constant([0.] * 4)
+    with ops.device("/device:CPU:0"):
+      uncompressed = collective_ops.all_reduce_v2(in_tensor, group_size,
+                                                  group_key, instance_key)
+      compressed = collective_ops.all_reduce_v2(
+          in_tensor,
+          group_size,
+          group_key,
+          instance_key + 1,
+          compression="bfloat16")
+    self.assertAllEqual(uncompressed, [1. + 2.**-10] * 4)
+    self.assertAllEqual(compressed, [1.] * 4)
+
+
 if __name__ == "__main__":
   multi_process_runner.test_main()
@@ -1799,6 +1799,121 @@ class CollectiveOpsV3Test(test.TestCase, parameterized.TestCase):
     self.assertAllClose(result[0], [3.0, 1.0], rtol=1e-5, atol=1e-5)
 
 
+class CompressionTest(test.TestCase, parameterized.TestCase):
+
+  def setUp(self):
+    _setup_context()
+    super().setUp()
+
+  def _all_reduce(self, inputs, **kwargs):
+    devices = ['/device:CPU:0', '/device:CPU:1']
+
+    @def_function.function
+    def run():
+      results = []
+      for device, t in zip(devices, inputs):
+        with ops.device(device):
+          results.append(
+              CollectiveOpsV2.all_reduce(
+                  t, group_size=2, group_key=1, instance_key=1, **kwargs))
+      return results
+
+    return run()
+
+  @combinations.generate(
+      combinations.combine(
+          compression=['float16', 'bfloat16', 'top_k'], mode='eager'))
+  def testCompressionWithinTask(self, compression):
+    # Only transfers between tasks are compressed, so the sum is exact.
+    inputs = [
+        constant_op.constant([1. + 2.**-10, 2.]),
+        constant_op.constant([3., 4.])
+    ]
+    for result in self._all_reduce(
+        inputs, compression=compression, topk_ratio=0.5):
+      self.assertAllEqual(result, [4. + 2.**-10, 6.])
+
+  @combinations.generate(combinations.combine(mode='eager'))
+  def testCompressionRequiresFloatingPoint(self):
+    inputs = [constant_op.constant([1, 2]), constant_op.constant([3, 4])]
+    with self.assertRaisesRegex(errors.InvalidArgumentError,
+                                'requires float or double'):
+      self._all_reduce(inputs, compression='bfloat16')
+
+  @combinations.generate(combinations.combine(mode='eager'))
+  def testTopKCompressionRequiresAdd(self):
+    inputs = [constant_op.constant([1., 2.]), constant_op.constant([3., 4.])]
+    with self.assertRaisesRegex(errors.InvalidArgumentError,
+                                'requires an Add reduction'):
+      self._all_reduce(inputs, merge_op='Max', compression='top_k')
+
+
+class PartialReduceTest(test.TestCase, parameterized.TestCase):
+
+  def setUp(self):
+    _setup_context()
+    super().setUp()
+
+  @combinations.generate(combinations.combine(mode='eager'))
+  def testStragglerIsNotWaitedFor(self):
+    devices = ['/device:CPU:0', '/device:CPU:1', '/device:CPU:2']
+    group_size = 3
+    group_key = 1
+
+    def all_reduce(device, t, instance_key, **kwargs):
+      with ops.device(device):
+        return CollectiveOpsV2.all_reduce(
+            t,
+            group_size=group_size,
+            group_key=group_key,
+            instance_key=instance_key,
+            merge_op='Add',
+            final_op='Div',
+            **kwargs)
+
+    # The group is resolved once every member has joined it.
+    @def_function.function
+    def complete_group():
+      return [
+          all_reduce(device, constant_op.constant([1.]), instance_key=1)
+          for device in devices
+      ]
+
+    complete_group()
+
+    # The member on CPU:2 never runs, and the leader on CPU:0 completes the
+    # reduction with its own contribution and the one from CPU:1.
+    results = [None] * 2
+
+    def run(i):
+      results[i] = all_reduce(
+          devices[i],
+          constant_op.constant([i + 1.]),
+          instance_key=2,
+          min_contributions=2)
+
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(2)]
+    for t in threads:
+      t.start()
+    for t in threads:
+      t.join()
+    for result in results:
+      self.assertAllClose(result, [1.5])
+
+  @combinations.generate(combinations.combine(mode='eager'))
+  def testPartialReduceRequiresMean(self):
+    with self.assertRaisesRegex(errors.InvalidArgumentError, 'Div'):
+      with ops.device('/device:CPU:0'):
+        CollectiveOpsV2.all_reduce(
+            constant_op.constant([1.]),
+            group_size=1,
+            group_key=1,
+            instance_key=1,
+            merge_op='Add',
+            final_op='Id',
+            min_contributions=1)
+
+
 def _setup_context(num_devices=4):
   context._reset_context()
   test_util.set_logical_devices_to_at_least('CPU', num_devices)
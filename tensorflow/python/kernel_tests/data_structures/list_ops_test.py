@@ -183,6 +183,25 @@ class ListOpsTest(test_util.TensorFlowTestCase, parameterized.TestCase):
     with context.device("gpu:0"):
       self._testStack(max_num_elements)
 
+  def testStackAndGatherPreallocatedList(self):
+    # Lists of a known size with aligned elements are pushed into a buffer on
+    # CPU, which stacking and gathering consecutive elements return a view of.
+    with context.device("cpu:0"):
+      l = list_ops.empty_tensor_list(
+          element_dtype=dtypes.float32, element_shape=[16], max_num_elements=4)
+      for i in range(3):
+        l = list_ops.tensor_list_push_back(l, array_ops.fill([16], float(i)))
+      t = list_ops.tensor_list_stack(l, element_dtype=dtypes.float32)
+      g = list_ops.tensor_list_gather(l, [1, 2], element_dtype=dtypes.float32)
+      # Rows popped and pushed again are not overwritten.
+      l, _ = gen_list_ops.tensor_list_pop_back(
+          l, element_dtype=dtypes.float32, element_shape=[16])
+      l = list_ops.tensor_list_push_back(l, array_ops.fill([16], 5.))
+      t2 = list_ops.tensor_list_stack(l, element_dtype=dtypes.float32)
+      self.assertAllEqual(t, [[0.] * 16, [1.] * 16, [2.] * 16])
+      self.assertAllEqual(g, [[1.] * 16, [2.] * 16])
+      self.assertAllEqual(t2, [[0.] * 16, [1.] * 16, [5.] * 16])
+
   @parameterized.named_parameters(("NoMaxNumElements", None),
                                   ("WithMaxNumElements", 3))
   @test_util.run_deprecated_v1
@@ -41,6 +41,7 @@ from tensorflow.python.framework import test_ops
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import control_flow_ops
+from tensorflow.python.ops import gen_lookup_ops
 from tensorflow.python.ops import lookup_ops
 from tensorflow.python.ops import map_fn
 from tensorflow.python.ops import variables
@@ -2414,6 +2415,142 @@ class DenseHashTableOpTest(test.TestCase):
     self.assertTrue(inferred_shapes[1].is_compatible_with(actual_shapes[1]))
 
 
+class GpuDenseHashTableOpTest(test.TestCase):
+  """Tests the GPU kernels, which are only used for labeled nodes."""
+
+  _GPU_KERNEL_LABELS = {
+      op_type: "gpu_dense_hash_table" for op_type in (
+          "MutableDenseHashTableV2", "LookupTableFindV2",
+          "LookupTableInsertV2", "LookupTableRemoveV2", "LookupTableSizeV2",
+          "LookupTableExportV2", "LookupTableImportV2")
+  }
+
+  @test_util.run_gpu_only
+  def testInsertFindRemove(self):
+    with ops.Graph().as_default() as g, self.session(graph=g):
+      with g._kernel_label_map(self._GPU_KERNEL_LABELS), ops.device(
+          "/device:GPU:0"):
+        table = lookup_ops.DenseHashTable(
+            dtypes.int64,
+            dtypes.float32,
+            default_value=-1.0,
+            empty_key=0,
+            deleted_key=-1,
+            initial_num_buckets=4)
+        # Grows the table from 4 buckets.
+        keys = np.arange(1, 1001, dtype=np.int64)
+        self.evaluate(table.insert(keys, (keys * 0.5).astype(np.float32)))
+        self.assertAllEqual(1000, self.evaluate(table.size()))
+
+        self.evaluate(
+            table.insert(
+                constant_op.constant([3, 3000], dtypes.int64),
+                constant_op.constant([7.0, 8.0], dtypes.float32)))
+        self.evaluate(
+            table.remove(constant_op.constant([2, 4, 4, 5000], dtypes.int64)))
+        self.assertAllEqual(999, self.evaluate(table.size()))
+
+        # The empty and deleted keys are never found.
+        output = table.lookup(
+            constant_op.constant([1, 2, 3, 1000, 3000, 4000, 0, -1],
+                                 dtypes.int64))
+        self.assertAllEqual([0.5, -1.0, 7.0, 500.0, 8.0, -1.0, -1.0, -1.0],
+                            self.evaluate(output))
+
+        # Deleted buckets are reclaimed when the table grows.
+        exported_keys, _ = table.export()
+        num_buckets = self.evaluate(exported_keys).shape[0]
+        self.evaluate(table.remove(keys))
+        self.evaluate(
+            table.insert(keys + 10000, (keys * 2.0).astype(np.float32)))
+        self.assertAllEqual(1001, self.evaluate(table.size()))
+        self.assertAllEqual(keys * 2.0,
+                            self.evaluate(table.lookup(keys + 10000)))
+        self.assertAllEqual([-1.0] * 1000, self.evaluate(table.lookup(keys)))
+        exported_keys, _ = table.export()
+        self.assertAllEqual(num_buckets, self.evaluate(exported_keys).shape[0])
+
+  @test_util.run_gpu_only
+  def testVectorValuesAndDefaults(self):
+    with ops.Graph().as_default() as g, self.session(graph=g):
+      with g._kernel_label_map(self._GPU_KERNEL_LABELS), ops.device(
+          "/device:GPU:0"):
+        table = lookup_ops.DenseHashTable(
+            dtypes.int64,
+            dtypes.int64,
+            default_value=[-1, -2],
+            empty_key=0,
+            deleted_key=-1,
+            initial_num_buckets=8)
+        self.evaluate(
+            table.insert(
+                constant_op.constant([11, 12], dtypes.int64),
+                constant_op.constant([[1, 2], [3, 4]], dtypes.int64)))
+        output = table.lookup(constant_op.constant([12, 13], dtypes.int64))
+        self.assertAllEqual([[3, 4], [-1, -2]], self.evaluate(output))
+
+        output = gen_lookup_ops.lookup_table_find_v2(
+            table.resource_handle, constant_op.constant([11, 13],
+                                                        dtypes.int64),
+            constant_op.constant([[5, 6], [7, 8]], dtypes.int64))
+        self.assertAllEqual([[1, 2], [7, 8]], self.evaluate(output))
+
+  @test_util.run_gpu_only
+  def testExportImport(self):
+    with ops.Graph().as_default() as g, self.session(graph=g):
+      with ops.device("/device:CPU:0"):
+        cpu_table = lookup_ops.DenseHashTable(
+            dtypes.int64,
+            dtypes.int64,
+            default_value=-1,
+            empty_key=0,
+            deleted_key=-1,
+            initial_num_buckets=16)
+        keys = constant_op.constant([11, 12, 13, 14], dtypes.int64)
+        values = constant_op.constant([1, 2, 3, 4], dtypes.int64)
+        self.evaluate(cpu_table.insert(keys, values))
+        self.evaluate(cpu_table.remove(constant_op.constant([12],
+                                                            dtypes.int64)))
+        exported_keys, exported_values = cpu_table.export()
+
+      with g._kernel_label_map(self._GPU_KERNEL_LABELS), ops.device(
+          "/device:GPU:0"):
+        gpu_table = lookup_ops.DenseHashTable(
+            dtypes.int64,
+            dtypes.int64,
+            default_value=-1,
+            empty_key=0,
+            deleted_key=-1,
+            initial_num_buckets=4)
+        # Both devices lay out their buckets the same.
+        self.evaluate(
+            gen_lookup_ops.lookup_table_import_v2(gpu_table.resource_handle,
+                                                  exported_keys,
+                                                  exported_values))
+        self.assertAllEqual(3, self.evaluate(gpu_table.size()))
+        self.assertAllEqual([1, -1, 3, 4],
+                            self.evaluate(gpu_table.lookup(keys)))
+
+  @test_util.run_gpu_only
+  def testUnlabeledTableKeepsCpuBehavior(self):
+    with ops.Graph().as_default() as g, self.session(graph=g):
+      with ops.device("/device:GPU:0"):
+        table = lookup_ops.DenseHashTable(
+            dtypes.int64,
+            dtypes.int64,
+            default_value=-1,
+            empty_key=0,
+            deleted_key=-1)
+        insert = table.insert(
+            constant_op.constant([11, 0], dtypes.int64),
+            constant_op.constant([1, 2], dtypes.int64))
+      # Without the kernel label, soft placement falls back to the CPU
+      # kernels, which reject the empty key.
+      with self.assertRaisesRegex(errors_impl.InvalidArgumentError,
+                                  "Using the empty_key as a table key"):
+        self.evaluate(insert)
+
+
 class IndexTableFromFile(test.TestCase):
 
   def _createVocabFile(self, basename, values=("brain", "salad", "surgery")):
@@ -98,6 +98,7 @@ class BatchMatmulOpTest(test.TestCase):
     CompareNonEmpty(self, [7, 2, 3], [7, 3, 5])
     CompareNonEmpty(self, [10, 64, 75], [10, 75, 30])
     CompareNonEmpty(self, [5, 7, 2, 3], [5, 7, 3, 5])
+    CompareNonEmpty(self, [3, 33, 70], [3, 70, 47])
 
   def _testBroadcasting(self, dtype, adjoint_a, adjoint_b, use_static_shape):
 
@@ -116,6 +117,7 @@ class BatchMatmulOpTest(test.TestCase):
     CompareNonEmpty(self, [2, 3], [5, 2, 3, 5])
     CompareNonEmpty(self, [4, 5, 1, 2, 3], [1, 1, 3, 5])
     CompareNonEmpty(self, [1, 2, 1, 4, 2, 1, 3, 4], [3, 2, 1, 1, 1, 2, 4, 2])
+    CompareNonEmpty(self, [2, 1, 40, 66], [3, 66, 35])
 
   def _testEmpty(self, dtype, adjoint_a, adjoint_b, use_static_shape):
 
@@ -47,6 +47,22 @@ class MatMulMixedType(test_lib.TestCase):
       self.assertAllEqual((2, 2), c.shape)
       self.assertAllEqual([[5, 11], [11, 25]], c)
 
+  def testBatchMatMulV3OutputTypeLarge(self):
+    # Large enough for the AMX kernels, with sizes that are not multiples of
+    # their tiles.
+    np.random.seed(0)
+    for a_dtype in [np.int8, np.uint8]:
+      for b_dtype in [np.int8, np.uint8]:
+        low_a = 0 if a_dtype == np.uint8 else -128
+        low_b = 0 if b_dtype == np.uint8 else -128
+        a = np.random.randint(low_a, 128, size=(3, 37, 70)).astype(a_dtype)
+        b = np.random.randint(low_b, 128, size=(3, 45, 70)).astype(b_dtype)
+        c = math_ops.batch_mat_mul_v3(a, b, adj_y=True, Tout=np.int32)
+        self.assertAllEqual(
+            np.matmul(
+                a.astype(np.int32), np.swapaxes(b, -1, -2).astype(np.int32)),
+            c)
+
   def testBatchMatMulV3MixedPrec(self):
     # TODO(shivaniagrawal): uint8 is not supported for mixed matmul type in XLA.
     np_bf16 = dtypes.bfloat16.as_numpy_dtype
@@ -178,6 +178,18 @@ class SegmentReductionOpTest(SegmentReductionHelper, parameterized.TestCase):
         tf_ans = self.evaluate(s)
         self.assertAllClose(np_ans, tf_ans)
 
+  def testManySmallSegmentsWithHoles(self):
+    # Large enough for the segments to be reduced by several threads.
+    num_rows = 20000
+    segment_ids = np.cumsum(np.random.randint(0, 3, num_rows))
+    np_x = np.random.rand(num_rows, 16).astype(np.float32)
+    np_ans = np.zeros([segment_ids[-1] + 1, 16], np.float32)
+    np.add.at(np_ans, segment_ids, np_x)
+    with self.cached_session(use_gpu=False):
+      tf_ans = self.evaluate(
+          math_ops.segment_sum(data=np_x, segment_ids=segment_ids))
+    self.assertAllClose(np_ans, tf_ans)
+
   @test_util.run_deprecated_v1
   def testSegmentIdsInvalid1(self):
     shape = [4, 4]
@@ -670,6 +682,33 @@ class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
         tf_ans = self.evaluate(s)
         self.assertAllClose(np_ans, tf_ans)
 
+  def testManySmallSegmentsWithHoles(self):
+    # Large enough for the segments to be reduced by several threads.
+    num_indices = 20000
+    num_segments = num_indices * 2 + 1
+    segment_ids = np.cumsum(np.random.randint(0, 3, num_indices))
+    np_x = np.random.rand(1000, 16).astype(np.float32)
+    indices = np.random.randint(0, 1000, num_indices)
+    np_sum = np.zeros([num_segments, 16], np.float32)
+    np.add.at(np_sum, segment_ids, np_x[indices])
+    np_count = np.zeros([num_segments, 1], np.float32)
+    np.add.at(np_count, segment_ids, 1)
+    with self.cached_session(use_gpu=False):
+      tf_sum, tf_mean = self.evaluate([
+          math_ops.sparse_segment_sum_with_num_segments(
+              data=np_x,
+              indices=indices,
+              segment_ids=segment_ids,
+              num_segments=num_segments),
+          math_ops.sparse_segment_mean_with_num_segments(
+              data=np_x,
+              indices=indices,
+              segment_ids=segment_ids,
+              num_segments=num_segments)
+      ])
+    self.assertAllClose(np_sum, tf_sum)
+    self.assertAllClose(np_sum / np.maximum(np_count, 1), tf_mean)
+
   def testWithEmptySegments(self):
     tf_x = constant_op.constant([], shape=[0, 4], dtype=dtypes_lib.float32)
     ops_list = [
@@ -155,6 +155,24 @@ class TopKTest(test.TestCase):
     self._testMediumTopK(np.float16)
     self._testMediumTopK(dtypes.bfloat16.as_numpy_dtype)
 
+  def _testRadixTopK(self, dtype):
+    # Rows long enough to be handled by radix selection, with many ties.
+    b = 2
+    n = 1 << 15
+    inputs = np.random.randint(-100, 100, size=(b, n)).astype(dtype)
+    for k in [100, 1000, n // 2, n]:
+      indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+      values = -np.sort(-inputs, axis=1)[:, :k]
+      self._validateTopK(inputs, k, values, indices)
+    self._validateTopK(inputs, 100, values[:, :100], indices[:, :100],
+                       sorted=False)
+
+  def testRadixTopK(self):
+    self._testRadixTopK(np.int32)
+    self._testRadixTopK(np.float32)
+    self._testRadixTopK(np.float16)
+    self._testRadixTopK(dtypes.bfloat16.as_numpy_dtype)
+
   def testStableSort(self):
     b = 5
     n = 500
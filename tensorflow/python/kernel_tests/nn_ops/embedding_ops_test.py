@@ -355,6 +355,29 @@ class EmbeddingLookupTest(test.TestCase):
     self.assertAllEqual(np_result, tf_result)
     self.assertShapeEqual(np_result, embedding)
 
+  @test_util.run_deprecated_v1
+  def testShardedLookupGathersDistinctIds(self):
+    with self.cached_session():
+      p = [
+          constant_op.constant([[0.], [2.]]),
+          constant_op.constant([[1.], [3.]])
+      ]
+      ids = constant_op.constant([1, 3, 1, 1, 3], dtype=dtypes.int32)
+      embedding = embedding_ops.embedding_lookup(p, ids)
+
+      # With "mod" partitioning, ids 1 and 3 are rows 0 and 1 of the second
+      # shard, which must be gathered once each.
+      shard_names = [t.name for t in p]
+      shard_ids = {}
+      for op in ops.get_default_graph().get_operations():
+        if op.type == "GatherV2" and op.inputs[0].name in shard_names:
+          shard_ids[op.inputs[0].name] = op.inputs[1]
+      self.assertLen(shard_ids, 2)
+      self.assertAllEqual([], self.evaluate(shard_ids[p[0].name]))
+      self.assertAllEqual([0, 1], self.evaluate(shard_ids[p[1].name]))
+      self.assertAllEqual([[1.], [3.], [1.], [1.], [3.]],
+                          self.evaluate(embedding))
+
   @test_util.run_deprecated_v1
   def testShardedModPartitioningInt64Ids(self):
     with self.cached_session():
@@ -32,6 +32,8 @@ from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import control_flow_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import sparse_ops
+from tensorflow.python.ops import state_ops
+from tensorflow.python.ops import variables
 from tensorflow.python.platform import test
 
 
@@ -174,6 +176,53 @@ class SparseTensorDenseMatMulTest(test.TestCase):
     self.assertAllClose(
         expected_t, sparse_ops.sparse_tensor_dense_matmul(sparse_t, dense_t))
 
+  @test_util.run_deprecated_v1
+  def testConstantIndicesWithChangingValuesAndShape(self):
+    # The kernel reuses the CSR form of constant indices across steps, which
+    # must not reuse stale values or bounds.
+    indices = constant_op.constant([[0, 1], [2, 0], [0, 0]], dtype=np.int64)
+    values = array_ops.placeholder(dtypes.float32, shape=[3])
+    shape = array_ops.placeholder(dtypes.int64, shape=[2])
+    dense = array_ops.placeholder(dtypes.float32, shape=[None, 4])
+    result = sparse_ops.sparse_tensor_dense_matmul(
+        sparse_tensor.SparseTensor(indices, values, shape), dense)
+    dense_t = np.arange(8, dtype=np.float32).reshape([2, 4])
+    with self.session(use_gpu=False) as sess:
+      for step in range(3):
+        values_t = np.array([1, 2, 3], dtype=np.float32) * (step + 1)
+        x = np.zeros([3, 2], dtype=np.float32)
+        x[0, 1], x[2, 0], x[0, 0] = values_t
+        self.assertAllClose(
+            x.dot(dense_t),
+            sess.run(result, {values: values_t, shape: [3, 2],
+                              dense: dense_t}))
+      with self.assertRaisesOpError("k .1. from index.0,1. out of bounds"):
+        sess.run(result, {values: [1, 2, 3], shape: [3, 1],
+                          dense: dense_t[:1]})
+      with self.assertRaisesOpError("m .2. from index.1,0. out of bounds"):
+        sess.run(result, {values: [1, 2, 3], shape: [2, 2],
+                          dense: dense_t})
+
+  @test_util.run_deprecated_v1
+  def testIndicesUpdatedInPlace(self):
+    # A reference variable hands the kernel the same buffer at every step, so
+    # the cached CSR form must follow the contents of the indices.
+    indices = variables.VariableV1(
+        [[0, 1], [2, 0]], dtype=dtypes.int64, use_resource=False)
+    new_indices = array_ops.placeholder(dtypes.int64, shape=[2, 2])
+    update = state_ops.assign(indices, new_indices)
+    dense_t = np.arange(8, dtype=np.float32).reshape([2, 4])
+    result = sparse_ops.sparse_tensor_dense_matmul(
+        sparse_tensor.SparseTensor(indices, [1., 2.], [3, 2]), dense_t)
+    with self.session(use_gpu=False) as sess:
+      self.evaluate(indices.initializer)
+      for indices_t in ([[0, 1], [2, 0]], [[1, 0], [2, 1]], [[0, 0], [0, 1]]):
+        sess.run(update, {new_indices: indices_t})
+        x = np.zeros([3, 2], dtype=np.float32)
+        x[indices_t[0][0], indices_t[0][1]] += 1.
+        x[indices_t[1][0], indices_t[1][1]] += 2.
+        self.assertAllClose(x.dot(dense_t), self.evaluate(result))
+
   @test_util.run_gpu_only
   def testInvalidIndicesForSparseTensorDenseMatmulOnGPU(self):
     indices = np.array([[1, 10]]).astype(np.int64)
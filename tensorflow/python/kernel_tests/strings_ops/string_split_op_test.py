@@ -249,6 +249,14 @@ class StringSplitV2OpTest(test_util.TensorFlowTestCase, parameterized.TestCase):
        "input": [b"1 2 3", b"  4  5    6  "],
        "expected": [[b"1", b"2", b"3"], [b"4", b"5", b"6"]]},
 
+      {"testcase_name": "EmptySeparatorLongTokens",
+       "input": [b"\tsupercalifragilistic  expialidocious\n\x0bword\x0c",
+                 b"\xe4\xbd\xa0\xe5\xa5\xbd\xe4\xb8\x96\xe7\x95\x8c "
+                 b"\xe4\xbd\xa0\xe5\xa5\xbd"],
+       "expected": [[b"supercalifragilistic", b"expialidocious", b"word"],
+                    [b"\xe4\xbd\xa0\xe5\xa5\xbd\xe4\xb8\x96\xe7\x95\x8c",
+                     b"\xe4\xbd\xa0\xe5\xa5\xbd"]]},
+
       {"testcase_name": "EmptySeparatorEmptyInputString",
        "input": [b""],
        "expected": [[]]},
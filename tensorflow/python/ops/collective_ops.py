@@ -102,6 +102,9 @@ def all_reduce_v2(t,
                   timeout=0,
                   ordering_token=None,
                   max_subdivs_per_device=-1,
+                  compression='none',
+                  topk_ratio=0.01,
+                  min_contributions=0,
                   name=None):
   """Reduces tensors collectively, across devices.
 
@@ -132,6 +135,21 @@ def all_reduce_v2(t,
       parallelize processing of each per-device tensor. Setting to -1 disables
       subdivision and reverts to previous behavior of not sub-dividing tensor.
       Setting to 0 uses sytem defaults.
+    compression: lossy compression of the values sent between tasks. One of
+      `none`, `float16`, `bfloat16` and `top_k`. `top_k` sends the `topk_ratio`
+      fraction of the values with the largest magnitude and carries the others
+      over to the next reduction with the same instance key. Only supported for
+      float and double values on CPU devices, and `top_k` only with the `Add`
+      merge op. All members of the group must use the same compression. This
+      feature is experimental.
+    topk_ratio: a float in (0, 1]. The fraction of the values sent with `top_k`
+      compression.
+    min_contributions: if positive, the reduction completes as soon as this
+      many members of the group, including the member with rank 0, have
+      contributed. The other contributions are dropped, the mean is taken over
+      the contributions that were used, and every member receives the same
+      result. Requires `merge_op='Add'` and `final_op='Div'`. All members of the
+      group must use the same value. This feature is experimental.
     name: name of the Op.
 
   Returns:
@@ -153,6 +171,9 @@ def all_reduce_v2(t,
       timeout_seconds=timeout,
       ordering_token=ordering_token,
       max_subdivs_per_device=max_subdivs_per_device,
+      compression=compression,
+      topk_ratio=topk_ratio,
+      min_contributions=min_contributions,
       name=name)
 
 
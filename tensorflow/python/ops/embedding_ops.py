@@ -155,6 +155,11 @@ def _embedding_lookup_and_transform(params,
       #   We must flatten in this case because transform_fn expects a flat
       #   tensor of embeddings.
       flat_ids = array_ops.reshape(ids, [-1])
+      if np > 1:
+        # Look up every distinct id once, so that each shard (e.g. on a
+        # parameter server) only receives and sends back its rows once per
+        # lookup however often the ids repeat.
+        flat_ids, unique_idx = array_ops.unique(flat_ids)
       original_indices = math_ops.range(array_ops.size(flat_ids))
 
       # Create p_assignments and set new_ids depending on the strategy.
@@ -223,6 +228,8 @@ def _embedding_lookup_and_transform(params,
       # Stitch these back together
       ret = data_flow_ops.parallel_dynamic_stitch(
           pindices, partitioned_result, name=name)
+      if np > 1:
+        ret = array_ops.gather(ret, unique_idx)
 
       # Determine the static element shape.
       if transform_fn is None:
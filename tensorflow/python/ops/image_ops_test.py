@@ -4520,6 +4520,44 @@ class JpegTest(test_util.TensorFlowTestCase):
         image1_crop, image2 = self.evaluate([image1_crop, image2])
         self.assertAllEqual(image1_crop, image2)
 
+  def testDecodeAndCropAndResizeJpeg(self):
+    with self.cached_session():
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+
+      h, w, _ = 256, 128, 3
+      # Crop windows less than twice as large as the size are decoded at full
+      # resolution.
+      for crop_window, size in [([0, 0, h, w], [200, 100]),
+                                ([6, 5, 15, 10], [20, 7]),
+                                ([h - 40, w - 30, 40, 30], [21, 16])]:
+        image1 = image_ops.decode_and_crop_jpeg(jpeg0, crop_window, channels=3)
+        image1 = image_ops.resize_bilinear(
+            array_ops.expand_dims(image1, 0), size, half_pixel_centers=True)[0]
+        image2 = gen_image_ops.decode_and_crop_and_resize_jpeg(
+            jpeg0, crop_window, size, channels=3)
+        self.assertEqual(image2.get_shape().as_list(), size + [3])
+        image1, image2 = self.evaluate([image1, image2])
+        self.assertAllClose(image1, image2, atol=1e-3)
+
+      # Larger crop windows are downscaled while decoded.
+      for crop_window, size in [([0, 0, h, w], [32, 16]),
+                                ([10, 20, 200, 100], [50, 25])]:
+        image1 = image_ops.decode_and_crop_jpeg(jpeg0, crop_window, channels=3)
+        image1 = image_ops.resize_area(
+            array_ops.expand_dims(image1, 0), size)[0]
+        image2 = gen_image_ops.decode_and_crop_and_resize_jpeg(
+            jpeg0, crop_window, size, channels=3)
+        image1, image2 = self.evaluate([image1, image2])
+        self.assertEqual(image2.shape, tuple(size) + (3,))
+        self.assertLess(self.averageError(image1, image2), 6)
+
+      with self.assertRaisesRegex((ValueError, errors.InvalidArgumentError),
+                                  "Invalid JPEG data or crop window"):
+        self.evaluate(
+            gen_image_ops.decode_and_crop_and_resize_jpeg(
+                jpeg0, [0, 0, h + 1, w], [10, 10]))
+
   def testCropAndDecodeJpegWithInvalidCropWindow(self):
     with self.cached_session() as sess:
       # Encode it, then decode it, then encode it
@@ -442,6 +442,57 @@ class TrainingOpsTest(TensorFlowTestCase):
       self.assertShapeEqual(out, apply_adam)
       self.assertAllCloseAccordingToType(new_var, out)
 
+  @test_util.run_v1_only("SparseApplyAdam op returns a ref, so it is not "
+                         "supported in eager mode.")
+  def testSparseApplyAdam(self):
+    for dtype, index_type in itertools.product(
+        [np.float16, np.float32, np.float64], [np.int32, np.int64]):
+      var = np.arange(40).reshape([4, 10]).astype(dtype)
+      m = np.arange(1, 41).reshape([4, 10]).astype(dtype) / 40
+      v = np.arange(41, 81).reshape([4, 10]).astype(dtype) / 40
+      grad = np.arange(30).reshape([3, 10]).astype(dtype) / 30
+      # Index 3 occurs twice, index 1 and 2 do not occur.
+      indices = np.array([3, 0, 3]).astype(index_type)
+      self._testTypesForSparseAdam(var, m, v, grad, indices)
+      # Empty sparse gradients.
+      empty_grad = np.zeros([0, 10], dtype=dtype)
+      empty_indices = np.zeros([0], dtype=index_type)
+      self._testTypesForSparseAdam(var, m, v, empty_grad, empty_indices)
+
+  def _testTypesForSparseAdam(self, var, m, v, grad, indices):
+    self.setUp()
+    with self.session(use_gpu=False):
+      var_t = variables.VariableV1(var)
+      m_t = variables.VariableV1(m)
+      v_t = variables.VariableV1(v)
+
+      t = 2
+      beta1 = np.array(0.9, dtype=var.dtype)
+      beta2 = np.array(0.999, dtype=var.dtype)
+      beta1_power = beta1**t
+      beta2_power = beta2**t
+      lr = np.array(0.001, dtype=var.dtype)
+      epsilon = np.array(1e-8, dtype=var.dtype)
+      self.evaluate(variables.global_variables_initializer())
+
+      apply_adam = training_ops.sparse_apply_adam(
+          var_t, m_t, v_t, beta1_power, beta2_power, lr, beta1, beta2,
+          epsilon, grad, constant_op.constant(indices,
+                                              self._toType(indices.dtype)))
+      out = self.evaluate(apply_adam)
+      self.assertShapeEqual(out, apply_adam)
+
+      # The gradients of duplicate indices are summed, and the rows without
+      # gradient are left unchanged.
+      new_var, new_m, new_v = np.copy(var), np.copy(m), np.copy(v)
+      for index in np.unique(indices):
+        g = np.sum(grad[indices == index], axis=0)
+        new_var[index], new_m[index], new_v[index] = self._adamUpdateNumpy(
+            var[index], g, t, m[index], v[index], lr, beta1, beta2, epsilon)
+      self.assertAllCloseAccordingToType(new_var, out)
+      self.assertAllCloseAccordingToType(new_m, self.evaluate(m_t))
+      self.assertAllCloseAccordingToType(new_v, self.evaluate(v_t))
+
   def _adamUpdateNumpy(self, param, g_t, t, m, v, alpha, beta1, beta2, epsilon):
     alpha_t = alpha * np.sqrt(1 - beta2**t) / (1 - beta1**t)
 
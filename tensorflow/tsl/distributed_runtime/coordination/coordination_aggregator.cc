@@ -0,0 +1,400 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/tsl/distributed_runtime/coordination/coordination_aggregator.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorflow/tsl/distributed_runtime/coordination/coordination_service_error_util.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/util/device_name_utils.h"
+
+namespace tsl {
+namespace {
+using tensorflow::BarrierRequest;
+using tensorflow::BarrierResponse;
+using tensorflow::CoordinatedTask;
+using tensorflow::CoordinationServiceConfig;
+using tensorflow::ForwardedHeartbeatError;
+using tensorflow::HeartbeatRequest;
+using tensorflow::HeartbeatResponse;
+
+constexpr char kFlushThread[] = "CoordinationAggregatorFlushLoop";
+
+std::string GetTaskName(const CoordinatedTask& task) {
+  return absl::StrCat("/job:", task.job_name(), "/replica:0/task:",
+                      task.task_id());
+}
+
+// Returns the tasks of the aggregation tree in order, the leader first.
+std::vector<CoordinatedTask> GetTreeTasks(
+    const CoordinationServiceConfig& config) {
+  DeviceNameUtils::ParsedName leader;
+  DeviceNameUtils::ParseFullName(config.service_leader(), &leader);
+  std::vector<CoordinatedTask> tasks(1);
+  tasks[0].set_job_name(leader.job);
+  tasks[0].set_task_id(leader.task);
+  for (const auto& job : config.coordinated_job_list()) {
+    for (int i = 0; i < job.num_tasks(); ++i) {
+      if (job.name() == leader.job && i == leader.task) {
+        continue;
+      }
+      CoordinatedTask task;
+      task.set_job_name(job.name());
+      task.set_task_id(i);
+      tasks.push_back(std::move(task));
+    }
+  }
+  return tasks;
+}
+
+// Returns the position of `task` in `tasks`, or -1 if it is not found.
+int GetTreeIndex(const std::vector<CoordinatedTask>& tasks,
+                 const CoordinatedTask& task) {
+  for (int i = 0; i < tasks.size(); ++i) {
+    if (tasks[i].job_name() == task.job_name() &&
+        tasks[i].task_id() == task.task_id()) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool SameTasks(
+    const ::google::protobuf::RepeatedPtrField<CoordinatedTask>& a,
+    const ::google::protobuf::RepeatedPtrField<CoordinatedTask>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (int i = 0; i < a.size(); ++i) {
+    if (a[i].job_name() != b[i].job_name() ||
+        a[i].task_id() != b[i].task_id()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+absl::flat_hash_set<std::string> GetSubtree(
+    const CoordinatedTask& task,
+    const std::vector<CoordinatedTask>& descendants) {
+  absl::flat_hash_set<std::string> subtree = {GetTaskName(task)};
+  for (const CoordinatedTask& descendant : descendants) {
+    subtree.insert(GetTaskName(descendant));
+  }
+  return subtree;
+}
+
+}  // namespace
+
+std::optional<std::string> GetAggregationParent(
+    const CoordinationServiceConfig& config, const CoordinatedTask& task) {
+  const int fanout = config.aggregation_fanout();
+  if (fanout <= 1) {
+    return std::nullopt;
+  }
+  const std::vector<CoordinatedTask> tasks = GetTreeTasks(config);
+  const int index = GetTreeIndex(tasks, task);
+  if (index <= 0) {
+    return std::nullopt;
+  }
+  const int parent = (index - 1) / fanout;
+  if (parent == 0) {
+    return std::nullopt;
+  }
+  return GetTaskName(tasks[parent]);
+}
+
+std::vector<CoordinatedTask> GetAggregationDescendants(
+    const CoordinationServiceConfig& config, const CoordinatedTask& task) {
+  const int fanout = config.aggregation_fanout();
+  if (fanout <= 1) {
+    return {};
+  }
+  const std::vector<CoordinatedTask> tasks = GetTreeTasks(config);
+  const int index = GetTreeIndex(tasks, task);
+  // The leader hands the requests of its children to the service directly.
+  if (index <= 0) {
+    return {};
+  }
+  // The descendants at each level of a complete tree are contiguous.
+  std::vector<CoordinatedTask> descendants;
+  const int64_t num_tasks = tasks.size();
+  int64_t first = index;
+  int64_t last = index;
+  while (true) {
+    first = first * fanout + 1;
+    last = last * fanout + fanout;
+    if (first >= num_tasks) {
+      break;
+    }
+    for (int64_t i = first; i <= std::min(last, num_tasks - 1); ++i) {
+      descendants.push_back(tasks[i]);
+    }
+  }
+  return descendants;
+}
+
+int GetAggregationHeight(const CoordinationServiceConfig& config,
+                         const CoordinatedTask& task) {
+  const int fanout = config.aggregation_fanout();
+  if (fanout <= 1) {
+    return 0;
+  }
+  const std::vector<CoordinatedTask> tasks = GetTreeTasks(config);
+  const int index = GetTreeIndex(tasks, task);
+  if (index <= 0) {
+    return 0;
+  }
+  // The leftmost path of a complete tree is the longest one.
+  int height = 0;
+  for (int64_t child = static_cast<int64_t>(index) * fanout + 1;
+       child < tasks.size(); child = child * fanout + 1) {
+    ++height;
+  }
+  return height;
+}
+
+CoordinationAggregator::CoordinationAggregator(
+    Env* env, const CoordinatedTask& task,
+    std::vector<CoordinatedTask> descendants, uint64_t leader_incarnation,
+    absl::Duration flush_interval, CoordinationClient* parent_client)
+    : env_(env),
+      task_(task),
+      subtree_(GetSubtree(task, descendants)),
+      flush_interval_(flush_interval),
+      parent_client_(parent_client),
+      leader_incarnation_(leader_incarnation) {
+  flush_thread_.reset(env_->StartThread(ThreadOptions(), kFlushThread,
+                                        [this]() { FlushLoop(); }));
+}
+
+CoordinationAggregator::~CoordinationAggregator() {
+  std::vector<StatusCallback> callbacks;
+  {
+    mutex_lock l(mu_);
+    shutting_down_ = true;
+    flush_cv_.notify_all();
+    for (auto& [barrier_id, barrier] : barriers_) {
+      for (StatusCallback& callback : barrier.unsent_callbacks) {
+        callbacks.push_back(std::move(callback));
+      }
+    }
+    barriers_.clear();
+  }
+  flush_thread_.reset();
+  const Status error = MakeCoordinationError(errors::Aborted(
+      "Coordination aggregator on ", GetTaskName(task_), " shut down."));
+  for (const StatusCallback& callback : callbacks) {
+    callback(error);
+  }
+}
+
+void CoordinationAggregator::SetLeaderIncarnation(
+    uint64_t leader_incarnation) {
+  mutex_lock l(mu_);
+  leader_incarnation_ = leader_incarnation;
+}
+
+Status CoordinationAggregator::RecordHeartbeat(const HeartbeatRequest& request,
+                                               HeartbeatResponse* response) {
+  mutex_lock l(mu_);
+  const std::string task_name = GetTaskName(request.source_task());
+  if (!subtree_.contains(task_name)) {
+    return MakeCoordinationError(errors::InvalidArgument(
+        "Unexpected heartbeat from ", task_name,
+        ", which is not aggregated by ", GetTaskName(task_), "."));
+  }
+  auto error = heartbeat_errors_.find(task_name);
+  if (error != heartbeat_errors_.end()) {
+    Status s = error->second;
+    heartbeat_errors_.erase(error);
+    return s;
+  }
+  HeartbeatRequest& heartbeat = heartbeats_[task_name];
+  *heartbeat.mutable_source_task() = request.source_task();
+  heartbeat.set_incarnation(request.incarnation());
+  for (const HeartbeatRequest& forwarded : request.forwarded_heartbeats()) {
+    const std::string forwarded_name = GetTaskName(forwarded.source_task());
+    auto forwarded_error = heartbeat_errors_.find(forwarded_name);
+    if (forwarded_error != heartbeat_errors_.end()) {
+      ForwardedHeartbeatError* e = response->add_forwarded_errors();
+      *e->mutable_task() = forwarded.source_task();
+      e->set_error_code(forwarded_error->second.code());
+      e->set_error_message(forwarded_error->second.error_message());
+      heartbeat_errors_.erase(forwarded_error);
+      continue;
+    }
+    heartbeats_[forwarded_name] = forwarded;
+  }
+  response->set_leader_incarnation(leader_incarnation_);
+  return OkStatus();
+}
+
+void CoordinationAggregator::TakeHeartbeats(
+    ::google::protobuf::RepeatedPtrField<HeartbeatRequest>* forwarded) {
+  mutex_lock l(mu_);
+  for (auto& [task_name, heartbeat] : heartbeats_) {
+    *forwarded->Add() = std::move(heartbeat);
+  }
+  heartbeats_.clear();
+}
+
+void CoordinationAggregator::ProcessHeartbeatResponse(
+    const HeartbeatResponse& response) {
+  mutex_lock l(mu_);
+  for (const ForwardedHeartbeatError& forwarded_error :
+       response.forwarded_errors()) {
+    heartbeat_errors_[GetTaskName(forwarded_error.task())] =
+        MakeCoordinationError(
+            Status(static_cast<error::Code>(forwarded_error.error_code()),
+                   forwarded_error.error_message()));
+  }
+}
+
+void CoordinationAggregator::BarrierAsync(const BarrierRequest& request,
+                                          StatusCallback done) {
+  std::vector<CoordinatedTask> arrivals;
+  if (request.arrived_tasks().empty()) {
+    arrivals.push_back(request.source_task());
+  } else {
+    arrivals.assign(request.arrived_tasks().begin(),
+                    request.arrived_tasks().end());
+  }
+  Batch batch;
+  {
+    mutex_lock l(mu_);
+    if (shutting_down_) {
+      batch.callbacks.push_back(std::move(done));
+    } else {
+      auto [it, inserted] = barriers_.try_emplace(request.barrier_id());
+      PendingBarrier& barrier = it->second;
+      if (inserted) {
+        barrier.request.set_barrier_id(request.barrier_id());
+        barrier.request.set_barrier_timeout_in_ms(
+            request.barrier_timeout_in_ms());
+        *barrier.request.mutable_tasks() = request.tasks();
+        *barrier.request.mutable_source_task() = task_;
+        if (request.tasks().empty()) {
+          barrier.expected_tasks = subtree_;
+        } else {
+          for (const CoordinatedTask& task : request.tasks()) {
+            const std::string task_name = GetTaskName(task);
+            if (subtree_.contains(task_name)) {
+              barrier.expected_tasks.insert(task_name);
+            }
+          }
+        }
+      }
+      if (!SameTasks(barrier.request.tasks(), request.tasks())) {
+        // Forward the arrivals right away so that the service fails the
+        // barrier for the conflicting set of participating tasks.
+        batch.request = std::make_shared<BarrierRequest>(barrier.request);
+        *batch.request->mutable_tasks() = request.tasks();
+        *batch.request->mutable_arrived_tasks() = {arrivals.begin(),
+                                                   arrivals.end()};
+        batch.callbacks.push_back(std::move(done));
+      } else {
+        if (barrier.unsent_tasks.empty()) {
+          barrier.first_unsent_time = absl::Now();
+        }
+        for (CoordinatedTask& task : arrivals) {
+          barrier.arrived_tasks.insert(GetTaskName(task));
+          barrier.unsent_tasks.push_back(std::move(task));
+        }
+        barrier.unsent_callbacks.push_back(std::move(done));
+        const bool subtree_arrived = std::all_of(
+            barrier.expected_tasks.begin(), barrier.expected_tasks.end(),
+            [&barrier](const std::string& task_name) {
+              return barrier.arrived_tasks.contains(task_name);
+            });
+        if (subtree_arrived) {
+          batch = TakeArrivals(&barrier);
+          barriers_.erase(it);
+        }
+      }
+    }
+  }
+  if (batch.request == nullptr) {
+    // Either the aggregator is shutting down, or the arrivals are pending.
+    for (const StatusCallback& callback : batch.callbacks) {
+      callback(MakeCoordinationError(errors::Aborted(
+          "Coordination aggregator on ", GetTaskName(task_), " shut down.")));
+    }
+    return;
+  }
+  Forward(std::move(batch));
+}
+
+CoordinationAggregator::Batch CoordinationAggregator::TakeArrivals(
+    PendingBarrier* barrier) {
+  Batch batch;
+  batch.request = std::make_shared<BarrierRequest>(barrier->request);
+  *batch.request->mutable_arrived_tasks() = {barrier->unsent_tasks.begin(),
+                                             barrier->unsent_tasks.end()};
+  batch.callbacks = std::move(barrier->unsent_callbacks);
+  barrier->unsent_tasks.clear();
+  barrier->unsent_callbacks.clear();
+  return batch;
+}
+
+void CoordinationAggregator::Forward(Batch batch) {
+  VLOG(3) << "Forwarding " << batch.request->arrived_tasks_size()
+          << " arrivals at barrier " << batch.request->barrier_id();
+  auto response = std::make_shared<BarrierResponse>();
+  parent_client_->BarrierAsync(
+      batch.request.get(), response.get(),
+      [request = batch.request, response,
+       callbacks = std::move(batch.callbacks)](const Status& s) {
+        for (const StatusCallback& callback : callbacks) {
+          callback(s);
+        }
+      });
+}
+
+void CoordinationAggregator::FlushLoop() {
+  const int64_t tick_ms =
+      std::max<int64_t>(1, absl::ToInt64Milliseconds(flush_interval_) / 2);
+  while (true) {
+    std::vector<Batch> batches;
+    {
+      mutex_lock l(mu_);
+      flush_cv_.wait_for(l, std::chrono::milliseconds(tick_ms));
+      if (shutting_down_) {
+        return;
+      }
+      const absl::Time now = absl::Now();
+      for (auto& [barrier_id, barrier] : barriers_) {
+        if (!barrier.unsent_tasks.empty() &&
+            now - barrier.first_unsent_time >= flush_interval_) {
+          batches.push_back(TakeArrivals(&barrier));
+        }
+      }
+    }
+    for (Batch& batch : batches) {
+      Forward(std::move(batch));
+    }
+  }
+}
+
+}  // namespace tsl
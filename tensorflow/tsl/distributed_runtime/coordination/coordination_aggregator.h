@@ -0,0 +1,157 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_TSL_DISTRIBUTED_RUNTIME_COORDINATION_COORDINATION_AGGREGATOR_H_
+#define TENSORFLOW_TSL_DISTRIBUTED_RUNTIME_COORDINATION_COORDINATION_AGGREGATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
+#include "tensorflow/tsl/distributed_runtime/coordination/coordination_client.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/thread_annotations.h"
+#include "tensorflow/tsl/protobuf/coordination_config.pb.h"
+#include "tensorflow/tsl/protobuf/coordination_service.pb.h"
+
+namespace tsl {
+
+// The aggregation tree is built from `config.aggregation_fanout()`. It is
+// rooted at the leader, followed by the remaining tasks of
+// `config.coordinated_job_list()` in order, laid out as a complete tree in
+// which the children of the i-th task are the tasks at [i * fanout + 1,
+// i * fanout + fanout]. All functions below return empty results if
+// aggregation is disabled.
+
+// Returns the name of the task, e.g. "/job:worker/replica:0/task:1", that
+// `task` sends its heartbeats and barrier arrivals to. Returns nullopt if
+// they are sent to the leader directly.
+std::optional<std::string> GetAggregationParent(
+    const tensorflow::CoordinationServiceConfig& config,
+    const tensorflow::CoordinatedTask& task);
+
+// Returns the tasks in the subtree of `task`, excluding `task` itself.
+std::vector<tensorflow::CoordinatedTask> GetAggregationDescendants(
+    const tensorflow::CoordinationServiceConfig& config,
+    const tensorflow::CoordinatedTask& task);
+
+// Returns the height of the subtree of `task`, i.e. 0 for tasks without
+// children.
+int GetAggregationHeight(const tensorflow::CoordinationServiceConfig& config,
+                         const tensorflow::CoordinatedTask& task);
+
+// CoordinationAggregator runs on a task with children in the aggregation
+// tree. It receives the heartbeats and barrier arrivals of the subtree and
+// forwards them to the task's parent in batches:
+//   - Heartbeats are buffered until the agent of the task sends its own
+//     heartbeat, which carries them in `forwarded_heartbeats`. Errors
+//     recording them are returned to the tasks on their next heartbeat.
+//   - Barrier arrivals are forwarded as a single request once every
+//     participating task of the subtree has arrived, or once the oldest
+//     pending arrival has waited for the flush interval, so that the leader
+//     still observes stragglers and enforces the barrier timeout. All tasks
+//     of a forwarded batch complete together with the forwarded request.
+class CoordinationAggregator {
+ public:
+  // `parent_client` is not owned and must outlive the aggregator.
+  CoordinationAggregator(Env* env, const tensorflow::CoordinatedTask& task,
+                         std::vector<tensorflow::CoordinatedTask> descendants,
+                         uint64_t leader_incarnation,
+                         absl::Duration flush_interval,
+                         CoordinationClient* parent_client);
+  // Fails the barrier arrivals that have not been forwarded yet.
+  ~CoordinationAggregator();
+
+  // Updates the leader incarnation reported to the subtree, e.g. after the
+  // agent of the task reconnected.
+  void SetLeaderIncarnation(uint64_t leader_incarnation);
+
+  // Buffers the heartbeat of a descendant, including the heartbeats it
+  // forwards itself. Returns the error that the leader reported for an
+  // earlier heartbeat of `request.source_task()`, if any.
+  Status RecordHeartbeat(const tensorflow::HeartbeatRequest& request,
+                         tensorflow::HeartbeatResponse* response);
+
+  // Moves the heartbeats buffered since the last call into `forwarded`.
+  void TakeHeartbeats(
+      ::google::protobuf::RepeatedPtrField<tensorflow::HeartbeatRequest>*
+          forwarded);
+
+  // Keeps the errors for the forwarded heartbeats in `response` until they
+  // are returned to the tasks.
+  void ProcessHeartbeatResponse(const tensorflow::HeartbeatResponse& response);
+
+  // Records the arrival of `request.source_task()`, or of
+  // `request.arrived_tasks()` if set, at the barrier. `done` is called once
+  // the parent completes the forwarded request.
+  void BarrierAsync(const tensorflow::BarrierRequest& request,
+                    StatusCallback done);
+
+ private:
+  struct PendingBarrier {
+    // Request forwarded to the parent, without the arrived tasks.
+    tensorflow::BarrierRequest request;
+    // Participating tasks of the subtree, including the task itself.
+    absl::flat_hash_set<std::string> expected_tasks;
+    absl::flat_hash_set<std::string> arrived_tasks;
+    std::vector<tensorflow::CoordinatedTask> unsent_tasks;
+    std::vector<StatusCallback> unsent_callbacks;
+    absl::Time first_unsent_time;
+  };
+
+  struct Batch {
+    std::shared_ptr<tensorflow::BarrierRequest> request;
+    std::vector<StatusCallback> callbacks;
+  };
+
+  // Moves the pending arrivals of `barrier` into a request to the parent.
+  Batch TakeArrivals(PendingBarrier* barrier) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Sends `batch` to the parent. Must be called without holding `mu_`, as
+  // the callbacks may run inline.
+  void Forward(Batch batch);
+  void FlushLoop();
+
+  Env* const env_;  // Not owned.
+  const tensorflow::CoordinatedTask task_;
+  const absl::flat_hash_set<std::string> subtree_;
+  const absl::Duration flush_interval_;
+  CoordinationClient* const parent_client_;  // Not owned.
+
+  mutex mu_;
+  condition_variable flush_cv_;
+  bool shutting_down_ TF_GUARDED_BY(mu_) = false;
+  uint64_t leader_incarnation_ TF_GUARDED_BY(mu_);
+  // Latest heartbeat of each task, by task name.
+  absl::flat_hash_map<std::string, tensorflow::HeartbeatRequest> heartbeats_
+      TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, Status> heartbeat_errors_
+      TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, PendingBarrier> barriers_
+      TF_GUARDED_BY(mu_);
+  std::unique_ptr<Thread> flush_thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CoordinationAggregator);
+};
+
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_DISTRIBUTED_RUNTIME_COORDINATION_COORDINATION_AGGREGATOR_H_
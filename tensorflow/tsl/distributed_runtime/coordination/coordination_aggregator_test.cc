@@ -0,0 +1,311 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/tsl/distributed_runtime/coordination/coordination_aggregator.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorflow/tsl/distributed_runtime/call_options.h"
+#include "tensorflow/tsl/distributed_runtime/coordination/coordination_client.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/protobuf/coordination_config.pb.h"
+#include "tensorflow/tsl/protobuf/coordination_service.pb.h"
+
+namespace tsl {
+namespace {
+using tensorflow::CoordinatedJob;
+using tensorflow::CoordinatedTask;
+using tensorflow::CoordinationServiceConfig;
+
+constexpr uint64_t kLeaderIncarnation = 42;
+
+// Records the barrier requests it receives, which are completed by the test.
+class TestCoordinationClient : public CoordinationClient {
+ public:
+  void BarrierAsync(const BarrierRequest* request, BarrierResponse* response,
+                    StatusCallback done) override {
+    mutex_lock l(mu_);
+    barrier_requests_.push_back(*request);
+    barrier_callbacks_.push_back(std::move(done));
+  }
+
+  int num_barrier_requests() {
+    mutex_lock l(mu_);
+    return barrier_requests_.size();
+  }
+
+  BarrierRequest barrier_request(int i) {
+    mutex_lock l(mu_);
+    return barrier_requests_[i];
+  }
+
+  void CompleteBarrier(int i, const Status& s) {
+    StatusCallback done;
+    {
+      mutex_lock l(mu_);
+      done = std::move(barrier_callbacks_[i]);
+    }
+    done(s);
+  }
+
+#define UNIMPLEMENTED(method)                                         \
+  void method##Async(const method##Request* request,                  \
+                     method##Response* response, StatusCallback done) \
+      override {                                                      \
+    done(errors::Unimplemented(#method "Async"));                     \
+  }
+
+  UNIMPLEMENTED(WaitForAllTasks);
+  UNIMPLEMENTED(ResetTask);
+  UNIMPLEMENTED(ReportErrorToService);
+  UNIMPLEMENTED(GetTaskState);
+  UNIMPLEMENTED(InsertKeyValue);
+  UNIMPLEMENTED(TryGetKeyValue);
+  UNIMPLEMENTED(GetKeyValueDir);
+  UNIMPLEMENTED(DeleteKeyValue);
+  UNIMPLEMENTED(BatchInsertKeyValues);
+  UNIMPLEMENTED(CancelBarrier);
+  UNIMPLEMENTED(GetAliveTasks);
+#undef UNIMPLEMENTED
+
+#define UNIMPLEMENTED_WITH_CALL_OPTS(method)                                 \
+  void method##Async(CallOptions* call_opts, const method##Request* request, \
+                     method##Response* response, StatusCallback done)        \
+      override {                                                             \
+    done(errors::Unimplemented(#method "Async"));                            \
+  }
+
+  UNIMPLEMENTED_WITH_CALL_OPTS(RegisterTask);
+  UNIMPLEMENTED_WITH_CALL_OPTS(Heartbeat);
+  UNIMPLEMENTED_WITH_CALL_OPTS(ShutdownTask);
+  UNIMPLEMENTED_WITH_CALL_OPTS(ReportErrorToTask);
+  UNIMPLEMENTED_WITH_CALL_OPTS(GetKeyValue);
+  UNIMPLEMENTED_WITH_CALL_OPTS(BatchGetKeyValues);
+  UNIMPLEMENTED_WITH_CALL_OPTS(WatchKeyValueDir);
+#undef UNIMPLEMENTED_WITH_CALL_OPTS
+
+ private:
+  mutex mu_;
+  std::vector<BarrierRequest> barrier_requests_ TF_GUARDED_BY(mu_);
+  std::vector<StatusCallback> barrier_callbacks_ TF_GUARDED_BY(mu_);
+};
+
+CoordinatedTask GetTask(int task_id) {
+  CoordinatedTask task;
+  task.set_job_name("worker");
+  task.set_task_id(task_id);
+  return task;
+}
+
+// Ten workers with a fanout of three: task 0 is the leader, tasks 1 to 3 are
+// its children, and tasks 1 and 2 aggregate tasks 4 to 6 and 7 to 9.
+CoordinationServiceConfig GetConfig() {
+  CoordinationServiceConfig config;
+  config.set_service_leader("/job:worker/replica:0/task:0");
+  CoordinatedJob* job = config.add_coordinated_job_list();
+  job->set_name("worker");
+  job->set_num_tasks(10);
+  config.set_aggregation_fanout(3);
+  return config;
+}
+
+std::vector<int> GetTaskIds(const std::vector<CoordinatedTask>& tasks) {
+  std::vector<int> ids;
+  for (const CoordinatedTask& task : tasks) {
+    ids.push_back(task.task_id());
+  }
+  return ids;
+}
+
+TEST(CoordinationAggregationTreeTest, Parents) {
+  const CoordinationServiceConfig config = GetConfig();
+  EXPECT_EQ(GetAggregationParent(config, GetTask(0)), std::nullopt);
+  EXPECT_EQ(GetAggregationParent(config, GetTask(3)), std::nullopt);
+  EXPECT_EQ(GetAggregationParent(config, GetTask(4)),
+            "/job:worker/replica:0/task:1");
+  EXPECT_EQ(GetAggregationParent(config, GetTask(9)),
+            "/job:worker/replica:0/task:2");
+}
+
+TEST(CoordinationAggregationTreeTest, DescendantsAndHeight) {
+  const CoordinationServiceConfig config = GetConfig();
+  EXPECT_TRUE(GetAggregationDescendants(config, GetTask(0)).empty());
+  EXPECT_EQ(GetTaskIds(GetAggregationDescendants(config, GetTask(1))),
+            std::vector<int>({4, 5, 6}));
+  EXPECT_TRUE(GetAggregationDescendants(config, GetTask(3)).empty());
+  EXPECT_TRUE(GetAggregationDescendants(config, GetTask(4)).empty());
+  EXPECT_EQ(GetAggregationHeight(config, GetTask(1)), 1);
+  EXPECT_EQ(GetAggregationHeight(config, GetTask(4)), 0);
+}
+
+TEST(CoordinationAggregationTreeTest, LeaderIsMovedToTheRoot) {
+  CoordinationServiceConfig config = GetConfig();
+  config.set_service_leader("/job:worker/replica:0/task:5");
+  // The tree is [5, 0, 1, 2, 3, 4, 6, ...], so task 0 aggregates 3, 4, 6.
+  EXPECT_EQ(GetTaskIds(GetAggregationDescendants(config, GetTask(0))),
+            std::vector<int>({3, 4, 6}));
+  EXPECT_TRUE(GetAggregationDescendants(config, GetTask(5)).empty());
+}
+
+TEST(CoordinationAggregationTreeTest, DisabledWithoutFanout) {
+  CoordinationServiceConfig config = GetConfig();
+  config.set_aggregation_fanout(0);
+  EXPECT_EQ(GetAggregationParent(config, GetTask(4)), std::nullopt);
+  EXPECT_TRUE(GetAggregationDescendants(config, GetTask(1)).empty());
+}
+
+class CoordinationAggregatorTest : public ::testing::Test {
+ protected:
+  void CreateAggregator(absl::Duration flush_interval) {
+    aggregator_ = std::make_unique<CoordinationAggregator>(
+        Env::Default(), GetTask(1),
+        GetAggregationDescendants(GetConfig(), GetTask(1)),
+        kLeaderIncarnation, flush_interval, &client_);
+  }
+
+  BarrierRequest GetBarrierRequest(int task_id) {
+    BarrierRequest request;
+    request.set_barrier_id("barrier");
+    request.set_barrier_timeout_in_ms(1000);
+    *request.mutable_source_task() = GetTask(task_id);
+    return request;
+  }
+
+  TestCoordinationClient client_;
+  std::unique_ptr<CoordinationAggregator> aggregator_;
+};
+
+TEST_F(CoordinationAggregatorTest, BuffersHeartbeats) {
+  CreateAggregator(absl::Hours(1));
+  HeartbeatRequest request;
+  *request.mutable_source_task() = GetTask(4);
+  request.set_incarnation(7);
+  HeartbeatResponse response;
+  TF_ASSERT_OK(aggregator_->RecordHeartbeat(request, &response));
+  EXPECT_EQ(response.leader_incarnation(), kLeaderIncarnation);
+  TF_ASSERT_OK(aggregator_->RecordHeartbeat(request, &response));
+
+  HeartbeatRequest forwarded;
+  aggregator_->TakeHeartbeats(forwarded.mutable_forwarded_heartbeats());
+  ASSERT_EQ(forwarded.forwarded_heartbeats_size(), 1);
+  EXPECT_EQ(forwarded.forwarded_heartbeats(0).source_task().task_id(), 4);
+  EXPECT_EQ(forwarded.forwarded_heartbeats(0).incarnation(), 7);
+
+  forwarded.clear_forwarded_heartbeats();
+  aggregator_->TakeHeartbeats(forwarded.mutable_forwarded_heartbeats());
+  EXPECT_EQ(forwarded.forwarded_heartbeats_size(), 0);
+}
+
+TEST_F(CoordinationAggregatorTest, ReturnsForwardedHeartbeatErrors) {
+  CreateAggregator(absl::Hours(1));
+  HeartbeatResponse leader_response;
+  tensorflow::ForwardedHeartbeatError* error =
+      leader_response.add_forwarded_errors();
+  *error->mutable_task() = GetTask(5);
+  error->set_error_code(error::ABORTED);
+  error->set_error_message("Incarnation mismatch");
+  aggregator_->ProcessHeartbeatResponse(leader_response);
+
+  HeartbeatRequest request;
+  *request.mutable_source_task() = GetTask(5);
+  HeartbeatResponse response;
+  EXPECT_TRUE(
+      errors::IsAborted(aggregator_->RecordHeartbeat(request, &response)));
+  // The error is only reported once.
+  TF_EXPECT_OK(aggregator_->RecordHeartbeat(request, &response));
+}
+
+TEST_F(CoordinationAggregatorTest, RejectsHeartbeatsOutsideTheSubtree) {
+  CreateAggregator(absl::Hours(1));
+  HeartbeatRequest request;
+  *request.mutable_source_task() = GetTask(7);
+  HeartbeatResponse response;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      aggregator_->RecordHeartbeat(request, &response)));
+}
+
+TEST_F(CoordinationAggregatorTest, ForwardsCompleteSubtreeOnce) {
+  CreateAggregator(absl::Hours(1));
+  std::vector<Status> statuses(4, errors::Unknown("Not done"));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(client_.num_barrier_requests(), 0);
+    aggregator_->BarrierAsync(GetBarrierRequest(i == 0 ? 1 : i + 3),
+                              [&statuses, i](Status s) { statuses[i] = s; });
+  }
+  ASSERT_EQ(client_.num_barrier_requests(), 1);
+  const BarrierRequest forwarded = client_.barrier_request(0);
+  EXPECT_EQ(forwarded.barrier_id(), "barrier");
+  EXPECT_EQ(forwarded.barrier_timeout_in_ms(), 1000);
+  EXPECT_EQ(forwarded.source_task().task_id(), 1);
+  EXPECT_EQ(GetTaskIds({forwarded.arrived_tasks().begin(),
+                        forwarded.arrived_tasks().end()}),
+            std::vector<int>({1, 4, 5, 6}));
+
+  client_.CompleteBarrier(0, OkStatus());
+  for (const Status& s : statuses) {
+    TF_EXPECT_OK(s);
+  }
+}
+
+TEST_F(CoordinationAggregatorTest, FlushesPartialSubtree) {
+  CreateAggregator(absl::Milliseconds(10));
+  Status status = errors::Unknown("Not done");
+  aggregator_->BarrierAsync(GetBarrierRequest(4),
+                            [&status](Status s) { status = s; });
+  for (int i = 0; i < 1000 && client_.num_barrier_requests() == 0; ++i) {
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+  ASSERT_EQ(client_.num_barrier_requests(), 1);
+  EXPECT_EQ(client_.barrier_request(0).arrived_tasks_size(), 1);
+
+  client_.CompleteBarrier(0, errors::DeadlineExceeded("Barrier timed out"));
+  EXPECT_TRUE(errors::IsDeadlineExceeded(status));
+}
+
+TEST_F(CoordinationAggregatorTest, ForwardsConflictingTasksRightAway) {
+  CreateAggregator(absl::Hours(1));
+  aggregator_->BarrierAsync(GetBarrierRequest(4), [](Status s) {});
+  BarrierRequest conflicting = GetBarrierRequest(5);
+  *conflicting.add_tasks() = GetTask(5);
+  Status status = errors::Unknown("Not done");
+  aggregator_->BarrierAsync(conflicting, [&status](Status s) { status = s; });
+  ASSERT_EQ(client_.num_barrier_requests(), 1);
+  EXPECT_EQ(client_.barrier_request(0).tasks_size(), 1);
+
+  client_.CompleteBarrier(0, errors::InvalidArgument("Conflicting tasks"));
+  EXPECT_TRUE(errors::IsInvalidArgument(status));
+}
+
+TEST_F(CoordinationAggregatorTest, FailsPendingArrivalsOnDestruction) {
+  CreateAggregator(absl::Hours(1));
+  Status status;
+  aggregator_->BarrierAsync(GetBarrierRequest(4),
+                            [&status](Status s) { status = s; });
+  aggregator_.reset();
+  EXPECT_TRUE(errors::IsAborted(status));
+}
+
+}  // namespace
+}  // namespace tsl
@@ -26,10 +26,16 @@ limitations under the License.
 namespace tsl {
 using tensorflow::BarrierRequest;
 using tensorflow::BarrierResponse;
+using tensorflow::BatchGetKeyValuesRequest;
+using tensorflow::BatchGetKeyValuesResponse;
+using tensorflow::BatchInsertKeyValuesRequest;
+using tensorflow::BatchInsertKeyValuesResponse;
 using tensorflow::CancelBarrierRequest;
 using tensorflow::CancelBarrierResponse;
 using tensorflow::DeleteKeyValueRequest;
 using tensorflow::DeleteKeyValueResponse;
+using tensorflow::GetAliveTasksRequest;
+using tensorflow::GetAliveTasksResponse;
 using tensorflow::GetKeyValueDirRequest;
 using tensorflow::GetKeyValueDirResponse;
 using tensorflow::GetKeyValueRequest;
@@ -54,6 +60,8 @@ using tensorflow::TryGetKeyValueRequest;
 using tensorflow::TryGetKeyValueResponse;
 using tensorflow::WaitForAllTasksRequest;
 using tensorflow::WaitForAllTasksResponse;
+using tensorflow::WatchKeyValueDirRequest;
+using tensorflow::WatchKeyValueDirResponse;
 
 // Base class of client interface for communicating with coordination service.
 // Can be implemented by a variety of transports such as gRPC.
@@ -118,12 +126,30 @@ class CoordinationClient {
                                    DeleteKeyValueResponse* response,
                                    StatusCallback done) = 0;
 
+  virtual void BatchInsertKeyValuesAsync(
+      const BatchInsertKeyValuesRequest* request,
+      BatchInsertKeyValuesResponse* response, StatusCallback done) = 0;
+
+  virtual void BatchGetKeyValuesAsync(CallOptions* call_opts,
+                                      const BatchGetKeyValuesRequest* request,
+                                      BatchGetKeyValuesResponse* response,
+                                      StatusCallback done) = 0;
+
+  virtual void WatchKeyValueDirAsync(CallOptions* call_opts,
+                                     const WatchKeyValueDirRequest* request,
+                                     WatchKeyValueDirResponse* response,
+                                     StatusCallback done) = 0;
+
   virtual void BarrierAsync(const BarrierRequest* request,
                             BarrierResponse* response, StatusCallback done) = 0;
 
   virtual void CancelBarrierAsync(const CancelBarrierRequest* request,
                                   CancelBarrierResponse* response,
                                   StatusCallback done) = 0;
+
+  virtual void GetAliveTasksAsync(const GetAliveTasksRequest* request,
+                                  GetAliveTasksResponse* response,
+                                  StatusCallback done) = 0;
 };
 
 // Simple wrapper class that can be used to retrieve CoordinationClients.
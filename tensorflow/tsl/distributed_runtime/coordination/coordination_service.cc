@@ -26,8 +26,10 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/notification.h"
@@ -124,12 +126,21 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
   std::vector<KeyValueEntry> GetKeyValueDir(
       absl::string_view directory_key) override;
   Status DeleteKeyValue(const std::string& key) override;
+  Status InsertKeyValues(const std::vector<KeyValueEntry>& kvs) override;
+  void GetKeyValuesAsync(const std::vector<std::string>& keys,
+                         StatusOrKeyValuesCallback done) override;
+  void WatchKeyValueDirAsync(absl::string_view directory_key,
+                             int64_t min_entries,
+                             StatusOrKeyValuesCallback done) override;
   void BarrierAsync(const std::string& barrier_id, absl::Duration timeout,
                     const CoordinatedTask& task,
                     const std::vector<CoordinatedTask>& participating_tasks,
                     StatusCallback done) override;
   Status CancelBarrier(const std::string& barrier_id,
                        const CoordinatedTask& task) override;
+  void GetAliveTasksAsync(const CoordinatedTask& requesting_task,
+                          const std::vector<CoordinatedTask>& tasks,
+                          AliveTasksCallback done) override;
 
  private:
   const DeviceInfo& ListClusterDevices() override
@@ -175,6 +186,18 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
       int64_t cluster_size);
   bool isRecoverableJob(const absl::string_view task_name) const;
 
+  // Pending GetAliveTasksAsync() calls for the same set of tasks.
+  struct AlivenessState {
+    absl::flat_hash_set<std::string> tasks;
+    // Tasks that have called GetAliveTasksAsync() so far.
+    absl::flat_hash_set<std::string> tasks_in_call;
+    std::vector<AliveTasksCallback> done_callbacks;
+  };
+  // Responds to the pending GetAliveTasksAsync() calls for which all alive
+  // tasks have called. Must be called whenever a task connects, fails or
+  // disconnects.
+  void RefreshAliveness() TF_EXCLUSIVE_LOCKS_REQUIRED(state_mu_);
+
   class TaskState {
    public:
     // Task state maintained on the coordination service side.
@@ -245,11 +268,32 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
       TF_GUARDED_BY(state_mu_);
   DeviceInfo cluster_devices_ TF_GUARDED_BY(state_mu_);
 
+  // A pending WatchKeyValueDirAsync() call.
+  struct DirWatch {
+    // The normalized directory key, followed by a slash.
+    std::string dir;
+    int64_t min_entries;
+    // The number of key-values currently in the directory.
+    int64_t num_entries;
+    StatusOrKeyValuesCallback done;
+  };
+
+  // Inserts a key-value whose key does not exist yet, and invokes the
+  // callbacks waiting for it.
+  void InsertNormalizedKeyValueLocked(const std::string& norm_key,
+                                      const std::string& value)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(kv_mu_);
+  std::vector<KeyValueEntry> GetKeyValueDirLocked(const std::string& dir)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(kv_mu_);
+  int64_t CountKeyValuesInDirLocked(const std::string& dir)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(kv_mu_);
+
   mutex kv_mu_;
   // Ordered map to store config key-values
   std::map<std::string, std::string> kv_store_ TF_GUARDED_BY(kv_mu_);
   absl::flat_hash_map<std::string, std::vector<StatusOrValueCallback>> get_cb_
       TF_GUARDED_BY(kv_mu_);
+  std::vector<DirWatch> dir_watches_ TF_GUARDED_BY(kv_mu_);
 
   mutex check_staleness_thread_shutdown_mu_;
   condition_variable check_staleness_thread_cv_;
@@ -265,6 +309,8 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
 
   absl::flat_hash_set<std::string> recoverable_jobs_;
 
+  std::vector<AlivenessState> aliveness_states_ TF_GUARDED_BY(state_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(CoordinationServiceStandaloneImpl);
 };
 
@@ -469,6 +515,13 @@ void CoordinationServiceStandaloneImpl::Stop(bool shut_staleness_thread) {
       }
     }
     get_cb_.clear();
+    for (const DirWatch& watch : dir_watches_) {
+      watch.done(errors::Cancelled(
+          absl::StrCat("Coordination service is shutting down. Cancelling "
+                       "WatchKeyValueDir() for directory: ",
+                       watch.dir)));
+    }
+    dir_watches_.clear();
   }
   {
     mutex_lock l(state_mu_);
@@ -481,6 +534,15 @@ void CoordinationServiceStandaloneImpl::Stop(bool shut_staleness_thread) {
       }
     }
     barriers_.clear();
+    for (AlivenessState& aliveness : aliveness_states_) {
+      for (const AliveTasksCallback& callback : aliveness.done_callbacks) {
+        callback(MakeCoordinationError(errors::Aborted(
+                     "GetAliveTasks() failed because service is shutting "
+                     "down.")),
+                 {});
+      }
+    }
+    aliveness_states_.clear();
     // Cluster state is used in `PassBarrier` and it needs to be cleared after
     // it.
     cluster_state_.clear();
@@ -626,6 +688,7 @@ Status CoordinationServiceStandaloneImpl::DisconnectTask(
         ", Task: ", task_name)));
     PassBarrier(barrier_id, error, &barriers_[barrier_id]);
   }
+  RefreshAliveness();
 
   LOG(INFO) << task_name << " has disconnected from coordination service.";
   return OkStatus();
@@ -855,6 +918,12 @@ Status CoordinationServiceStandaloneImpl::InsertKeyValue(
     return MakeCoordinationError(
         errors::AlreadyExists("Config key ", key, " already exists."));
   }
+  InsertNormalizedKeyValueLocked(norm_key, value);
+  return OkStatus();
+}
+
+void CoordinationServiceStandaloneImpl::InsertNormalizedKeyValueLocked(
+    const std::string& norm_key, const std::string& value) {
   kv_store_.emplace(norm_key, value);
   auto iter = get_cb_.find(norm_key);
   if (iter != get_cb_.end()) {
@@ -863,7 +932,15 @@ Status CoordinationServiceStandaloneImpl::InsertKeyValue(
     }
     get_cb_.erase(iter);
   }
-  return OkStatus();
+  for (auto watch = dir_watches_.begin(); watch != dir_watches_.end();) {
+    if (absl::StartsWith(norm_key, watch->dir) &&
+        ++watch->num_entries >= watch->min_entries) {
+      watch->done(GetKeyValueDirLocked(watch->dir));
+      watch = dir_watches_.erase(watch);
+    } else {
+      ++watch;
+    }
+  }
 }
 
 void CoordinationServiceStandaloneImpl::GetKeyValueAsync(
@@ -896,11 +973,15 @@ StatusOr<std::string> CoordinationServiceStandaloneImpl::TryGetKeyValue(
 
 std::vector<KeyValueEntry> CoordinationServiceStandaloneImpl::GetKeyValueDir(
     absl::string_view directory_key) {
-  std::vector<KeyValueEntry> kvs_in_directory;
   const std::string norm_key = NormalizeKey(directory_key);
-  const std::string dir = absl::StrCat(norm_key, "/");
-
   mutex_lock l(kv_mu_);
+  return GetKeyValueDirLocked(absl::StrCat(norm_key, "/"));
+}
+
+std::vector<KeyValueEntry>
+CoordinationServiceStandaloneImpl::GetKeyValueDirLocked(
+    const std::string& dir) {
+  std::vector<KeyValueEntry> kvs_in_directory;
   // Find first key in ordered map that has the directory prefix.
   auto begin = kv_store_.lower_bound(dir);
   std::map<std::string, std::string>::iterator it;
@@ -939,9 +1020,102 @@ Status CoordinationServiceStandaloneImpl::DeleteKeyValue(
   if (iter != kv_store_.end()) {
     kv_store_.erase(iter);
   }
+  for (DirWatch& watch : dir_watches_) {
+    watch.num_entries = CountKeyValuesInDirLocked(watch.dir);
+  }
+  return OkStatus();
+}
+
+int64_t CoordinationServiceStandaloneImpl::CountKeyValuesInDirLocked(
+    const std::string& dir) {
+  int64_t num_entries = 0;
+  for (auto it = kv_store_.lower_bound(dir);
+       it != kv_store_.end() && absl::StartsWith(it->first, dir); ++it) {
+    ++num_entries;
+  }
+  return num_entries;
+}
+
+Status CoordinationServiceStandaloneImpl::InsertKeyValues(
+    const std::vector<KeyValueEntry>& kvs) {
+  std::vector<std::string> norm_keys;
+  norm_keys.reserve(kvs.size());
+  for (const KeyValueEntry& kv : kvs) {
+    norm_keys.push_back(NormalizeKey(kv.key()));
+  }
+  mutex_lock l(kv_mu_);
+  absl::flat_hash_set<absl::string_view> inserted_keys;
+  for (int i = 0; i < kvs.size(); ++i) {
+    if (kv_store_.find(norm_keys[i]) != kv_store_.end() ||
+        !inserted_keys.insert(norm_keys[i]).second) {
+      return MakeCoordinationError(errors::AlreadyExists(
+          "Config key ", kvs[i].key(), " already exists."));
+    }
+  }
+  for (int i = 0; i < kvs.size(); ++i) {
+    InsertNormalizedKeyValueLocked(norm_keys[i], kvs[i].value());
+  }
   return OkStatus();
 }
 
+void CoordinationServiceStandaloneImpl::GetKeyValuesAsync(
+    const std::vector<std::string>& keys, StatusOrKeyValuesCallback done) {
+  if (keys.empty()) {
+    done(std::vector<KeyValueEntry>());
+    return;
+  }
+  // Collects the values of the keys as they become available, and invokes
+  // `done` once with all of them or with the first error.
+  struct State {
+    mutex mu;
+    int num_pending TF_GUARDED_BY(mu);
+    std::vector<KeyValueEntry> kvs TF_GUARDED_BY(mu);
+    StatusOrKeyValuesCallback done TF_GUARDED_BY(mu);
+  };
+  auto state = std::make_shared<State>();
+  {
+    mutex_lock l(state->mu);
+    state->num_pending = keys.size();
+    state->kvs.resize(keys.size());
+    state->done = std::move(done);
+  }
+  for (int i = 0; i < keys.size(); ++i) {
+    GetKeyValueAsync(keys[i], [state, i, key = keys[i]](
+                                  const StatusOr<std::string>& value) {
+      StatusOrKeyValuesCallback done;
+      StatusOr<std::vector<KeyValueEntry>> result;
+      {
+        mutex_lock l(state->mu);
+        if (state->done == nullptr) return;
+        if (!value.ok()) {
+          result = value.status();
+        } else {
+          state->kvs[i].set_key(key);
+          state->kvs[i].set_value(value.value());
+          if (--state->num_pending > 0) return;
+          result = std::move(state->kvs);
+        }
+        done = std::move(state->done);
+        state->done = nullptr;
+      }
+      done(result);
+    });
+  }
+}
+
+void CoordinationServiceStandaloneImpl::WatchKeyValueDirAsync(
+    absl::string_view directory_key, int64_t min_entries,
+    StatusOrKeyValuesCallback done) {
+  const std::string dir = absl::StrCat(NormalizeKey(directory_key), "/");
+  mutex_lock l(kv_mu_);
+  const int64_t num_entries = CountKeyValuesInDirLocked(dir);
+  if (num_entries >= min_entries) {
+    done(GetKeyValueDirLocked(dir));
+    return;
+  }
+  dir_watches_.push_back({dir, min_entries, num_entries, std::move(done)});
+}
+
 void CoordinationServiceStandaloneImpl::SetTaskError(
     absl::string_view task_name, Status error) {
   cluster_state_[task_name]->SetError(error);
@@ -952,6 +1126,7 @@ void CoordinationServiceStandaloneImpl::SetTaskError(
         ", Task: ", task_name)));
     PassBarrier(barrier_id, error, &barriers_[barrier_id]);
   }
+  RefreshAliveness();
 
   LOG(ERROR) << task_name
              << " has been set to ERROR in coordination service: " << error;
@@ -1161,6 +1336,94 @@ void CoordinationServiceStandaloneImpl::PassBarrier(
   barrier->done_callbacks.clear();
 }
 
+void CoordinationServiceStandaloneImpl::GetAliveTasksAsync(
+    const CoordinatedTask& requesting_task,
+    const std::vector<CoordinatedTask>& tasks, AliveTasksCallback done) {
+  mutex_lock l(state_mu_);
+  absl::flat_hash_set<std::string> task_names;
+  for (const CoordinatedTask& task : tasks) {
+    std::string task_name = GetTaskName(task);
+    if (!cluster_state_.contains(task_name)) {
+      done(MakeCoordinationError(errors::InvalidArgument(
+               "Unexpected task (", task_name,
+               ") that is not in the cluster in GetAliveTasks().")),
+           {});
+      return;
+    }
+    task_names.insert(std::move(task_name));
+  }
+  const std::string requesting_task_name = GetTaskName(requesting_task);
+  if (!task_names.contains(requesting_task_name)) {
+    done(MakeCoordinationError(errors::InvalidArgument(
+             "Task (", requesting_task_name,
+             ") called GetAliveTasks() for a set of tasks without itself.")),
+         {});
+    return;
+  }
+  if (cluster_state_[requesting_task_name]->GetState() !=
+      CoordinatedTaskState::TASKSTATE_CONNECTED) {
+    done(MakeCoordinationError(errors::FailedPrecondition(
+             "Task (", requesting_task_name,
+             ") called GetAliveTasks() while it is not connected.")),
+         {});
+    return;
+  }
+
+  auto it = absl::c_find_if(aliveness_states_,
+                            [&](const AlivenessState& aliveness) {
+                              return aliveness.tasks == task_names;
+                            });
+  if (it == aliveness_states_.end()) {
+    AlivenessState aliveness;
+    aliveness.tasks = std::move(task_names);
+    aliveness_states_.push_back(std::move(aliveness));
+    it = std::prev(aliveness_states_.end());
+  }
+  it->tasks_in_call.insert(requesting_task_name);
+  it->done_callbacks.push_back(std::move(done));
+  RefreshAliveness();
+}
+
+void CoordinationServiceStandaloneImpl::RefreshAliveness() {
+  std::vector<AlivenessState> pending_states;
+  std::vector<AlivenessState> done_states;
+  for (AlivenessState& aliveness : aliveness_states_) {
+    const bool all_alive_in_call =
+        absl::c_all_of(aliveness.tasks, [&](const std::string& task_name) {
+          return cluster_state_[task_name]->GetState() !=
+                     CoordinatedTaskState::TASKSTATE_CONNECTED ||
+                 aliveness.tasks_in_call.contains(task_name);
+        });
+    if (all_alive_in_call) {
+      done_states.push_back(std::move(aliveness));
+    } else {
+      pending_states.push_back(std::move(aliveness));
+    }
+  }
+  aliveness_states_ = std::move(pending_states);
+
+  for (const AlivenessState& aliveness : done_states) {
+    std::vector<CoordinatedTask> alive_tasks;
+    for (const std::string& task_name : aliveness.tasks) {
+      if (cluster_state_[task_name]->GetState() ==
+          CoordinatedTaskState::TASKSTATE_CONNECTED) {
+        alive_tasks.push_back(GetTaskFromName(task_name));
+      }
+    }
+    // Sort by task name so that all callers see the same order.
+    std::sort(alive_tasks.begin(), alive_tasks.end(),
+              [](const CoordinatedTask& task1, const CoordinatedTask& task2) {
+                if (task1.job_name() != task2.job_name()) {
+                  return task1.job_name() < task2.job_name();
+                }
+                return task1.task_id() < task2.task_id();
+              });
+    for (const AliveTasksCallback& callback : aliveness.done_callbacks) {
+      callback(OkStatus(), alive_tasks);
+    }
+  }
+}
+
 bool CoordinationServiceStandaloneImpl::ValidateTaskArgs(
 
     const std::vector<CoordinatedTask>& tasks_args,
@@ -71,6 +71,10 @@ class CoordinationServiceInterface {
 
   using StatusOrValueCallback =
       std::function<void(const StatusOr<std::string>&)>;
+  using StatusOrKeyValuesCallback = std::function<void(
+      const StatusOr<std::vector<tensorflow::KeyValueEntry>>&)>;
+  using AliveTasksCallback = std::function<void(
+      const Status&, const std::vector<tensorflow::CoordinatedTask>&)>;
 
   virtual ~CoordinationServiceInterface() = default;
 
@@ -182,6 +186,25 @@ class CoordinationServiceInterface {
   // up all key-values under the directory.
   virtual Status DeleteKeyValue(const std::string& key) = 0;
 
+  // Insert a batch of configuration key-values. Either all or none of them
+  // are inserted.
+  // Possible service errors:
+  //   - AlreadyExists: One of the keys already exists, or is repeated.
+  virtual Status InsertKeyValues(
+      const std::vector<tensorflow::KeyValueEntry>& kvs) = 0;
+
+  // Get a batch of configuration key-values, in the order of `keys`. The
+  // `done` callback is invoked when all the key-values become available.
+  virtual void GetKeyValuesAsync(const std::vector<std::string>& keys,
+                                 StatusOrKeyValuesCallback done) = 0;
+
+  // Gets all values under a directory (key), like GetKeyValueDir(), once the
+  // directory holds at least `min_entries` key-values. The `done` callback is
+  // invoked when enough key-values are inserted.
+  virtual void WatchKeyValueDirAsync(absl::string_view directory_key,
+                                     int64_t min_entries,
+                                     StatusOrKeyValuesCallback done) = 0;
+
   // Blocks until all (or a subset of) tasks are at the barrier or the barrier
   // fails.
   //
@@ -225,6 +248,21 @@ class CoordinationServiceInterface {
   virtual Status CancelBarrier(const std::string& barrier_id,
                                const tensorflow::CoordinatedTask& task) = 0;
 
+  // Returns the tasks of `tasks` that are alive, i.e. connected, once every
+  // alive task of `tasks` has called GetAliveTasksAsync() with the same
+  // `tasks`. Tasks that fail or disconnect in the meantime are no longer
+  // waited for, so all callers agree on the same set of surviving tasks, e.g.
+  // to re-form their collective groups after a task was preempted.
+  // Possible service errors:
+  //   - InvalidArgument: Unexpected task request, or `requesting_task` is not
+  //       one of `tasks`.
+  //   - FailedPrecondition: `requesting_task` is not connected.
+  //   - Aborted: Service is shutting down.
+  virtual void GetAliveTasksAsync(
+      const tensorflow::CoordinatedTask& requesting_task,
+      const std::vector<tensorflow::CoordinatedTask>& tasks,
+      AliveTasksCallback done) = 0;
+
  private:
   friend class CoordinationServiceRpcHandler;
   friend class CoordinationServiceTest_ListClusterDevices_TfDevice_Test;
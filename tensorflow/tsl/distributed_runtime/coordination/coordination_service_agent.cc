@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/tsl/distributed_runtime/coordination/coordination_service_agent.h"
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
 #include <map>
 #include <memory>
@@ -26,12 +27,14 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/notification.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "tensorflow/tsl/distributed_runtime/call_options.h"
+#include "tensorflow/tsl/distributed_runtime/coordination/coordination_aggregator.h"
 #include "tensorflow/tsl/distributed_runtime/coordination/coordination_client.h"
 #include "tensorflow/tsl/distributed_runtime/coordination/coordination_service_error_util.h"
 #include "tensorflow/tsl/framework/cancellation.h"
@@ -40,6 +43,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/mutex.h"
 #include "tensorflow/tsl/platform/random.h"
+#include "tensorflow/tsl/platform/statusor.h"
 #include "tensorflow/tsl/platform/thread_annotations.h"
 #include "tensorflow/tsl/protobuf/coordination_config.pb.h"
 #include "tensorflow/tsl/protobuf/coordination_service.pb.h"
@@ -60,7 +64,13 @@ auto* enabled_usage_metric =
 constexpr absl::Duration kDefaultClusterRegisterTimeout = absl::Hours(1);
 constexpr absl::Duration kDefaultHeartbeatTimeout = absl::Seconds(10);
 constexpr absl::Duration kDefaultShutdownTimeout = absl::Seconds(10);
+constexpr absl::Duration kDefaultAggregationFlushInterval =
+    absl::Milliseconds(100);
 constexpr char kHeartbeatThread[] = "CoordinationServiceHeartbeatLoop";
+// Large key-values are split into chunks below the default 4MB message size
+// limit of gRPC, and a few chunks are inserted or fetched per RPC.
+constexpr int64_t kKeyValueChunkBytes = 1 << 20;
+constexpr int64_t kKeyValueChunksPerRpc = 3;
 
 class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
  public:
@@ -77,6 +87,8 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
                     const CoordinationServiceConfig& configs,
                     std::unique_ptr<CoordinationClient> leader_client,
                     StatusCallback error_fn) override;
+  Status SetAggregationParentClient(
+      std::unique_ptr<CoordinationClient> parent_client) override;
   bool IsInitialized() override;
   bool IsConnected() override;
   bool IsError() override;
@@ -106,6 +118,16 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
   Status DeleteKeyValue(const std::string& key) override;
   Status UpdateKeyValue(const std::string& key,
                         const std::string& value) override;
+  Status InsertKeyValues(const std::vector<KeyValueEntry>& kvs) override;
+  StatusOr<std::vector<std::string>> GetKeyValues(
+      const std::vector<std::string>& keys, absl::Duration timeout) override;
+  StatusOr<std::vector<KeyValueEntry>> WatchKeyValueDir(
+      const std::string& key, int64_t min_entries,
+      absl::Duration timeout) override;
+  Status InsertLargeKeyValue(const std::string& key,
+                             const std::string& value) override;
+  StatusOr<std::string> GetLargeKeyValue(const std::string& key,
+                                         absl::Duration timeout) override;
 
   Status StartWatchKey(const std::string& key,
                        ChangedKeyValuesCallback on_change) override;
@@ -118,6 +140,8 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
   Status CancelBarrier(const std::string& barrier_id) override;
   void CancelBarrierAsync(const std::string& barrier_id,
                           StatusCallback done) override;
+  StatusOr<std::vector<CoordinatedTask>> GetAliveTasks(
+      const std::vector<CoordinatedTask>& tasks) override;
 
   StatusOr<Env*> GetEnv() override;
 
@@ -125,10 +149,17 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
   void SetError(const Status& error) override;
   Status ActivateWatch(const std::string& key,
                        const std::map<std::string, std::string>&) override;
+  CoordinationAggregator* GetAggregator() override;
   // Returns an error if agent is not running. If `allow_disconnected` is true,
   // returns OK even if the agent is in DISCONNECTED state.
   Status ValidateRunningAgent(bool allow_disconnected = false);
   void StopHeartbeat();
+  // Issues a key-value RPC that may block on the service with `rpc`, and
+  // waits at most `timeout` for it. The RPC is cancelled when the agent shuts
+  // down.
+  Status CallBlockingKeyValueRpc(
+      absl::string_view method, absl::Duration timeout,
+      std::function<void(CallOptions*, StatusCallback)> rpc);
 
  private:
   Env* env_ = nullptr;  // Not owned.
@@ -157,6 +188,14 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
   // GetKeyValueAsync() callbacks.
   CancellationManager cancellation_manager_;
   std::unique_ptr<CoordinationClient> leader_client_;
+  // Set if heartbeats and barrier arrivals are sent to an aggregating task
+  // instead of the leader.
+  std::unique_ptr<CoordinationClient> parent_client_;
+  // Set if this task aggregates the heartbeats and barrier arrivals of its
+  // subtree. Created on the first successful Connect() and never reset, as
+  // the RPC handler may be using it.
+  std::unique_ptr<CoordinationAggregator> aggregator_
+      TF_GUARDED_BY(state_mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(CoordinationServiceAgentImpl);
 };
@@ -201,6 +240,18 @@ Status CoordinationServiceAgentImpl::Initialize(
   return OkStatus();
 }
 
+Status CoordinationServiceAgentImpl::SetAggregationParentClient(
+    std::unique_ptr<CoordinationClient> parent_client) {
+  mutex_lock l(state_mu_);
+  if (state_ != CoordinatedTaskState::TASKSTATE_DISCONNECTED) {
+    return MakeCoordinationError(errors::FailedPrecondition(
+        "The aggregation parent must be set after the agent is initialized "
+        "and before it connects to the coordination service."));
+  }
+  parent_client_ = std::move(parent_client);
+  return OkStatus();
+}
+
 bool CoordinationServiceAgentImpl::IsInitialized() {
   mutex_lock l(state_mu_);
   return state_ != CoordinatedTaskState::TASKSTATE_UNINITIALIZED;
@@ -295,29 +346,65 @@ Status CoordinationServiceAgentImpl::Connect() {
   }
 
   LOG(INFO) << "Coordination agent has successfully connected.";
-  heartbeat_thread_.reset(
-      env_->StartThread(ThreadOptions(), kHeartbeatThread, [this]() -> void {
+  CoordinationAggregator* aggregator = nullptr;
+  if (configs_.aggregation_fanout() > 1) {
+    std::vector<CoordinatedTask> descendants =
+        GetAggregationDescendants(configs_, task_);
+    mutex_lock l(state_mu_);
+    if (aggregator_ != nullptr) {
+      aggregator_->SetLeaderIncarnation(leader_incarnation_);
+    } else if (!descendants.empty()) {
+      const absl::Duration flush_interval =
+          configs_.aggregation_flush_interval_in_ms() > 0
+              ? absl::Milliseconds(configs_.aggregation_flush_interval_in_ms())
+              : kDefaultAggregationFlushInterval;
+      aggregator_ = std::make_unique<CoordinationAggregator>(
+          env_, task_, std::move(descendants), leader_incarnation_,
+          flush_interval,
+          parent_client_ != nullptr ? parent_client_.get()
+                                    : leader_client_.get());
+    }
+    aggregator = aggregator_.get();
+  }
+  heartbeat_thread_.reset(env_->StartThread(
+      ThreadOptions(), kHeartbeatThread, [this, aggregator]() -> void {
         HeartbeatRequest request;
         *request.mutable_source_task() = task_;
         request.set_incarnation(incarnation_id_);
         HeartbeatResponse response;
-        const int64_t heartbeat_interval_ms =
+        int64_t heartbeat_interval_ms =
             configs_.heartbeat_timeout_in_ms() > 0
                 ? configs_.heartbeat_timeout_in_ms() / 2
                 : absl::ToInt64Milliseconds(kDefaultHeartbeatTimeout) / 2;
+        if (aggregator != nullptr) {
+          // Forwarded heartbeats are delayed by up to one interval at every
+          // aggregating ancestor. Shortening the interval at every level of
+          // the tree keeps the total delay within the heartbeat timeout.
+          heartbeat_interval_ms = std::max<int64_t>(
+              1, heartbeat_interval_ms >>
+                     (GetAggregationHeight(configs_, task_) + 1));
+        }
+        CoordinationClient* heartbeat_client = parent_client_ != nullptr
+                                                   ? parent_client_.get()
+                                                   : leader_client_.get();
         CallOptions call_opts;
         call_opts.SetTimeout(heartbeat_interval_ms);
 
         while (true) {
           Status status;
           absl::Notification n;
+          request.clear_forwarded_heartbeats();
+          if (aggregator != nullptr) {
+            aggregator->TakeHeartbeats(request.mutable_forwarded_heartbeats());
+          }
+          response.Clear();
           // Heartbeat RPC implementation automatically retries to tolerate
           // transient network failures.
-          leader_client_->HeartbeatAsync(&call_opts, &request, &response,
-                                         [&](Status s) {
-                                           status = s;
-                                           n.Notify();
-                                         });
+          heartbeat_client->HeartbeatAsync(&call_opts, &request, &response,
+                                           [&](Status s) {
+                                             status = s;
+                                             n.Notify();
+                                           });
           n.WaitForNotification();
           {
             mutex_lock l(heartbeat_thread_shutdown_mu_);
@@ -329,6 +416,9 @@ Status CoordinationServiceAgentImpl::Connect() {
               return;
             }
           }
+          if (status.ok() && aggregator != nullptr) {
+            aggregator->ProcessHeartbeatResponse(response);
+          }
           if (!status.ok()) {
             SetError(status);
           } else if (response.leader_incarnation() != leader_incarnation_) {
@@ -692,6 +782,142 @@ Status CoordinationServiceAgentImpl::UpdateKeyValue(const std::string& key,
       "CoordinationServiceAgent::UpdateKeyValue is not implemented."));
 }
 
+Status CoordinationServiceAgentImpl::InsertKeyValues(
+    const std::vector<KeyValueEntry>& kvs) {
+  BatchInsertKeyValuesRequest request;
+  *request.mutable_kvs() = {kvs.begin(), kvs.end()};
+  BatchInsertKeyValuesResponse response;
+
+  Status status;
+  absl::Notification n;
+  leader_client_->BatchInsertKeyValuesAsync(&request, &response,
+                                            [&](Status s) {
+                                              status = s;
+                                              n.Notify();
+                                            });
+  n.WaitForNotification();
+  return status;
+}
+
+StatusOr<std::vector<std::string>> CoordinationServiceAgentImpl::GetKeyValues(
+    const std::vector<std::string>& keys, absl::Duration timeout) {
+  auto request = std::make_shared<BatchGetKeyValuesRequest>();
+  *request->mutable_keys() = {keys.begin(), keys.end()};
+  auto response = std::make_shared<BatchGetKeyValuesResponse>();
+  TF_RETURN_IF_ERROR(CallBlockingKeyValueRpc(
+      "GetKeyValues", timeout,
+      [this, request, response](CallOptions* call_opts, StatusCallback done) {
+        leader_client_->BatchGetKeyValuesAsync(
+            call_opts, request.get(), response.get(),
+            [request, response, done = std::move(done)](const Status& s) {
+              done(s);
+            });
+      }));
+  std::vector<std::string> values;
+  values.reserve(response->kvs_size());
+  for (KeyValueEntry& kv : *response->mutable_kvs()) {
+    values.push_back(std::move(*kv.mutable_value()));
+  }
+  return values;
+}
+
+StatusOr<std::vector<KeyValueEntry>>
+CoordinationServiceAgentImpl::WatchKeyValueDir(const std::string& key,
+                                               int64_t min_entries,
+                                               absl::Duration timeout) {
+  auto request = std::make_shared<WatchKeyValueDirRequest>();
+  request->set_directory_key(key);
+  request->set_min_entries(min_entries);
+  auto response = std::make_shared<WatchKeyValueDirResponse>();
+  TF_RETURN_IF_ERROR(CallBlockingKeyValueRpc(
+      "WatchKeyValueDir", timeout,
+      [this, request, response](CallOptions* call_opts, StatusCallback done) {
+        leader_client_->WatchKeyValueDirAsync(
+            call_opts, request.get(), response.get(),
+            [request, response, done = std::move(done)](const Status& s) {
+              done(s);
+            });
+      }));
+  return std::vector<KeyValueEntry>(
+      std::make_move_iterator(response->mutable_kv()->begin()),
+      std::make_move_iterator(response->mutable_kv()->end()));
+}
+
+Status CoordinationServiceAgentImpl::InsertLargeKeyValue(
+    const std::string& key, const std::string& value) {
+  const int64_t num_chunks =
+      (value.size() + kKeyValueChunkBytes - 1) / kKeyValueChunkBytes;
+  // The chunks are inserted first, so that the key only becomes available
+  // once its whole value is.
+  for (int64_t begin = 0; begin < num_chunks; begin += kKeyValueChunksPerRpc) {
+    const int64_t end = std::min(begin + kKeyValueChunksPerRpc, num_chunks);
+    std::vector<KeyValueEntry> chunks(end - begin);
+    for (int64_t i = begin; i < end; ++i) {
+      chunks[i - begin].set_key(absl::StrCat(key, "/", i));
+      chunks[i - begin].set_value(
+          value.substr(i * kKeyValueChunkBytes, kKeyValueChunkBytes));
+    }
+    TF_RETURN_IF_ERROR(InsertKeyValues(chunks));
+  }
+  return InsertKeyValue(key, absl::StrCat(num_chunks));
+}
+
+StatusOr<std::string> CoordinationServiceAgentImpl::GetLargeKeyValue(
+    const std::string& key, absl::Duration timeout) {
+  const absl::Time deadline = absl::Now() + timeout;
+  TF_ASSIGN_OR_RETURN(const std::string num_chunks_str,
+                      GetKeyValue(key, timeout));
+  int64_t num_chunks;
+  if (!absl::SimpleAtoi(num_chunks_str, &num_chunks) || num_chunks < 0) {
+    return MakeCoordinationError(errors::InvalidArgument(
+        "Config key ", key, " was not inserted by InsertLargeKeyValue()."));
+  }
+  std::string value;
+  for (int64_t begin = 0; begin < num_chunks; begin += kKeyValueChunksPerRpc) {
+    const int64_t end = std::min(begin + kKeyValueChunksPerRpc, num_chunks);
+    std::vector<std::string> chunk_keys;
+    for (int64_t i = begin; i < end; ++i) {
+      chunk_keys.push_back(absl::StrCat(key, "/", i));
+    }
+    TF_ASSIGN_OR_RETURN(std::vector<std::string> chunks,
+                        GetKeyValues(chunk_keys, deadline - absl::Now()));
+    for (const std::string& chunk : chunks) {
+      value.append(chunk);
+    }
+  }
+  return value;
+}
+
+Status CoordinationServiceAgentImpl::CallBlockingKeyValueRpc(
+    absl::string_view method, absl::Duration timeout,
+    std::function<void(CallOptions*, StatusCallback)> rpc) {
+  auto n = std::make_shared<absl::Notification>();
+  auto status = std::make_shared<Status>();
+  auto call_opts = std::make_shared<CallOptions>();
+
+  const CancellationToken token =
+      cancellation_manager_.get_cancellation_token();
+  const bool already_cancelled = !cancellation_manager_.RegisterCallback(
+      token, [call_opts]() { call_opts->StartCancel(); });
+  if (already_cancelled) {
+    return errors::Cancelled(method, "() was cancelled.");
+  }
+  rpc(call_opts.get(), [n, status, call_opts, &cm = cancellation_manager_,
+                        token](const Status& s) {
+    // RPC call has completed (no longer needs to be cancelled if agent is
+    // destroyed).
+    cm.TryDeregisterCallback(token);
+    *status = s;
+    n->Notify();
+  });
+  if (!n->WaitForNotificationWithTimeout(timeout)) {
+    return MakeCoordinationError(errors::DeadlineExceeded(
+        absl::Substitute("$0() timed out with duration: $1", method,
+                         absl::FormatDuration(timeout))));
+  }
+  return *status;
+}
+
 Status CoordinationServiceAgentImpl::StartWatchKey(
     const std::string& key,
     CoordinationServiceAgentImpl::ChangedKeyValuesCallback on_change) {
@@ -721,6 +947,11 @@ Status CoordinationServiceAgentImpl::ActivateWatch(
       "CoordinationServiceAgent::ActivateWatch is not implemented."));
 }
 
+CoordinationAggregator* CoordinationServiceAgentImpl::GetAggregator() {
+  mutex_lock l(state_mu_);
+  return aggregator_.get();
+}
+
 Status CoordinationServiceAgentImpl::WaitAtBarrier(
     const std::string& barrier_id, absl::Duration timeout,
     const std::vector<CoordinatedTask>& tasks) {
@@ -743,6 +974,7 @@ void CoordinationServiceAgentImpl::WaitAtBarrierAsync(
     done(agent_running_status);
     return;
   }
+  CoordinationAggregator* aggregator = nullptr;
   {
     mutex_lock l(state_mu_);
     auto [it, inserted] = used_barrier_ids_.insert(barrier_id);
@@ -753,6 +985,7 @@ void CoordinationServiceAgentImpl::WaitAtBarrierAsync(
           barrier_id));
       return;
     }
+    aggregator = aggregator_.get();
   }
   auto request = std::make_shared<BarrierRequest>();
   auto response = std::make_shared<BarrierResponse>();
@@ -760,7 +993,14 @@ void CoordinationServiceAgentImpl::WaitAtBarrierAsync(
   request->set_barrier_timeout_in_ms(timeout / absl::Milliseconds(1));
   *request->mutable_source_task() = task_;
   *request->mutable_tasks() = {tasks.begin(), tasks.end()};
-  leader_client_->BarrierAsync(request.get(), response.get(),
+  if (aggregator != nullptr) {
+    aggregator->BarrierAsync(*request, std::move(done));
+    return;
+  }
+  CoordinationClient* barrier_client = parent_client_ != nullptr
+                                           ? parent_client_.get()
+                                           : leader_client_.get();
+  barrier_client->BarrierAsync(request.get(), response.get(),
                                [request, response, done = std::move(done)](
                                    const Status& s) { done(s); });
 }
@@ -796,6 +1036,30 @@ void CoordinationServiceAgentImpl::CancelBarrierAsync(
       });
 }
 
+StatusOr<std::vector<CoordinatedTask>>
+CoordinationServiceAgentImpl::GetAliveTasks(
+    const std::vector<CoordinatedTask>& tasks) {
+  TF_RETURN_IF_ERROR(ValidateRunningAgent());
+  GetAliveTasksRequest request;
+  *request.mutable_source_task() = task_;
+  *request.mutable_tasks() = {tasks.begin(), tasks.end()};
+  GetAliveTasksResponse response;
+  absl::Notification n;
+  StatusOr<std::vector<CoordinatedTask>> result;
+  leader_client_->GetAliveTasksAsync(&request, &response, [&](const Status& s) {
+    if (s.ok()) {
+      result = std::vector<CoordinatedTask>(
+          std::make_move_iterator(response.alive_tasks().begin()),
+          std::make_move_iterator(response.alive_tasks().end()));
+    } else {
+      result = s;
+    }
+    n.Notify();
+  });
+  n.WaitForNotification();
+  return result;
+}
+
 // Returns an error if agent is not running.
 Status CoordinationServiceAgentImpl::ValidateRunningAgent(
     bool allow_disconnected) {
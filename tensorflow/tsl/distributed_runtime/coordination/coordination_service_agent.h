@@ -35,6 +35,7 @@ class CoordinationServiceConfig;
 };  // namespace tensorflow
 
 namespace tsl {
+class CoordinationAggregator;
 class Env;
 
 // CoordinationServiceAgent defines the interface for tasks to communicate with
@@ -85,6 +86,14 @@ class CoordinationServiceAgent {
       std::unique_ptr<CoordinationClient> leader_client,
       StatusCallback error_fn) = 0;
 
+  // Send heartbeats and barrier arrivals to the aggregating parent of this
+  // task through `parent_client` instead of to the leader. Only used if
+  // `aggregation_fanout` is set in the config, see GetAggregationParent().
+  // Must be called after Initialize() and before Connect().
+  //   - FailedPrecondition: Agent is not in DISCONNECTED state.
+  virtual Status SetAggregationParentClient(
+      std::unique_ptr<CoordinationClient> parent_client) = 0;
+
   // Return true if the coordination service agent has been initialized.
   virtual bool IsInitialized() = 0;
 
@@ -202,6 +211,44 @@ class CoordinationServiceAgent {
   virtual Status UpdateKeyValue(const std::string& key,
                                 const std::string& value) = 0;
 
+  // Batched key-value API, to exchange the metadata of many tasks, e.g.
+  // collective ids or device topologies, in few RPCs.
+
+  // Insert config key-values to the service in one RPC. Either all or none of
+  // them are inserted.
+  //   - errors::AlreadyExists: one of the keys is already set, or repeated.
+  virtual Status InsertKeyValues(
+      const std::vector<tensorflow::KeyValueEntry>& kvs) = 0;
+
+  // Get the values of `keys` from the service in one RPC, in the order of
+  // `keys`. This is a blocking call that waits until all the keys are
+  // inserted.
+  //   - errors::DeadlineExceeded: timed out waiting for the keys.
+  virtual StatusOr<std::vector<std::string>> GetKeyValues(
+      const std::vector<std::string>& keys, absl::Duration timeout) = 0;
+
+  // Get all values under a directory (key), like GetKeyValueDir(), once the
+  // directory holds at least `min_entries` values. E.g. every task of a job
+  // inserts its value under the directory, then waits for the values of all
+  // the tasks.
+  //   - errors::DeadlineExceeded: timed out waiting for the values.
+  virtual StatusOr<std::vector<tensorflow::KeyValueEntry>> WatchKeyValueDir(
+      const std::string& key, int64_t min_entries, absl::Duration timeout) = 0;
+
+  // Insert a config key-value whose value may exceed the message size limit
+  // of the RPCs. The value is split into chunks stored under the directory
+  // `key`, and must be read with GetLargeKeyValue(). DeleteKeyValue(key)
+  // deletes the chunks too.
+  //   - errors::AlreadyExists: key is already set.
+  virtual Status InsertLargeKeyValue(const std::string& key,
+                                     const std::string& value) = 0;
+
+  // Get a config key-value inserted with InsertLargeKeyValue(). This is a
+  // blocking call that waits until the key is inserted.
+  //   - errors::DeadlineExceeded: timed out waiting for key.
+  virtual StatusOr<std::string> GetLargeKeyValue(const std::string& key,
+                                                 absl::Duration timeout) = 0;
+
   // Register a callback that will be invoked when the key or keys under the key
   // directory are changed (inserted, deleted, or updated).
   virtual Status StartWatchKey(const std::string& key,
@@ -258,6 +305,20 @@ class CoordinationServiceAgent {
   virtual void CancelBarrierAsync(const std::string& barrier_id,
                                   StatusCallback done) = 0;
 
+  // Returns the tasks of `tasks` that are alive, once all alive tasks of
+  // `tasks` have called GetAliveTasks() with the same `tasks`. Tasks that
+  // fail or disconnect in the meantime are not waited for, so every caller
+  // gets the same set of surviving tasks, e.g. to re-form collective groups
+  // after a task was preempted without restarting the job. `tasks` must
+  // include the task of this agent.
+  // Possible service errors:
+  //   - InvalidArgument: Unexpected task request, or this task is not one of
+  //       `tasks`.
+  //   - FailedPrecondition: This task is not connected.
+  //   - Aborted: Service is shutting down.
+  virtual StatusOr<std::vector<tensorflow::CoordinatedTask>> GetAliveTasks(
+      const std::vector<tensorflow::CoordinatedTask>& tasks) = 0;
+
   // Get unowned Env* that the agent was initialized with.
   virtual StatusOr<tsl::Env*> GetEnv() = 0;
 
@@ -271,6 +332,10 @@ class CoordinationServiceAgent {
   virtual Status ActivateWatch(const std::string& key,
                                const std::map<std::string, std::string>&) = 0;
 
+  // Get the aggregator of the heartbeats and barrier arrivals of the subtree
+  // of this task, or nullptr if this task does not aggregate any.
+  virtual CoordinationAggregator* GetAggregator() = 0;
+
  private:
   friend class CoordinationServiceRpcHandler;
 };
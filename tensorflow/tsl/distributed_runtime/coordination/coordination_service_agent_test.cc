@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/tsl/distributed_runtime/coordination/coordination_service_agent.h"
 
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -41,6 +42,7 @@ using tensorflow::KeyValueEntry;
 
 using ::testing::_;
 using ::testing::DoAll;
+using ::testing::Invoke;
 using ::testing::InvokeArgument;
 using ::testing::SetArgPointee;
 using ::testing::UnorderedPointwise;
@@ -73,6 +75,15 @@ class TestCoordinationClient : public CoordinationClient {
   MOCK_METHOD3(GetKeyValueDirAsync,
                void(const GetKeyValueDirRequest*, GetKeyValueDirResponse*,
                     StatusCallback));
+  MOCK_METHOD3(InsertKeyValueAsync,
+               void(const InsertKeyValueRequest*, InsertKeyValueResponse*,
+                    StatusCallback));
+  MOCK_METHOD3(BatchInsertKeyValuesAsync,
+               void(const BatchInsertKeyValuesRequest*,
+                    BatchInsertKeyValuesResponse*, StatusCallback));
+  MOCK_METHOD4(BatchGetKeyValuesAsync,
+               void(CallOptions*, const BatchGetKeyValuesRequest*,
+                    BatchGetKeyValuesResponse*, StatusCallback));
   MOCK_METHOD4(RegisterTaskAsync, void(CallOptions*, const RegisterTaskRequest*,
                                        RegisterTaskResponse*, StatusCallback));
   MOCK_METHOD4(ShutdownTaskAsync, void(CallOptions*, const ShutdownTaskRequest*,
@@ -98,9 +109,9 @@ class TestCoordinationClient : public CoordinationClient {
   }
 
   UNIMPLEMENTED(WaitForAllTasks);
-  UNIMPLEMENTED(InsertKeyValue);
   UNIMPLEMENTED(DeleteKeyValue);
   UNIMPLEMENTED(CancelBarrier);
+  UNIMPLEMENTED(GetAliveTasks);
 #undef UNIMPLEMENTED
   void ReportErrorToTaskAsync(CallOptions* call_opts,
                               const ReportErrorToTaskRequest* request,
@@ -108,6 +119,12 @@ class TestCoordinationClient : public CoordinationClient {
                               StatusCallback done) override {
     done(errors::Unimplemented("ReportErrorToTaskAsync"));
   }
+  void WatchKeyValueDirAsync(CallOptions* call_opts,
+                             const WatchKeyValueDirRequest* request,
+                             WatchKeyValueDirResponse* response,
+                             StatusCallback done) override {
+    done(errors::Unimplemented("WatchKeyValueDirAsync"));
+  }
 };
 
 class CoordinationServiceAgentTest : public ::testing::Test {
@@ -345,6 +362,60 @@ TEST_F(CoordinationServiceAgentTest, GetKeyValueDir_Simple_Success) {
   EXPECT_THAT(*result, UnorderedPointwise(KvEq(), test_values));
 }
 
+TEST_F(CoordinationServiceAgentTest, LargeKeyValue_SplitIntoChunks) {
+  // Mock the key-value store of the service.
+  std::map<std::string, std::string> store;
+  ON_CALL(*GetClient(), InsertKeyValueAsync(_, _, _))
+      .WillByDefault(Invoke([&store](const InsertKeyValueRequest* request,
+                                     InsertKeyValueResponse* response,
+                                     StatusCallback done) {
+        store[request->kv().key()] = request->kv().value();
+        done(OkStatus());
+      }));
+  ON_CALL(*GetClient(), BatchInsertKeyValuesAsync(_, _, _))
+      .WillByDefault(
+          Invoke([&store](const BatchInsertKeyValuesRequest* request,
+                          BatchInsertKeyValuesResponse* response,
+                          StatusCallback done) {
+            for (const KeyValueEntry& kv : request->kvs()) {
+              store[kv.key()] = kv.value();
+            }
+            done(OkStatus());
+          }));
+  ON_CALL(*GetClient(), GetKeyValueAsync(_, _, _, _))
+      .WillByDefault(Invoke([&store](CallOptions* call_opts,
+                                     const GetKeyValueRequest* request,
+                                     GetKeyValueResponse* response,
+                                     StatusCallback done) {
+        response->mutable_kv()->set_value(store.at(request->key()));
+        done(OkStatus());
+      }));
+  ON_CALL(*GetClient(), BatchGetKeyValuesAsync(_, _, _, _))
+      .WillByDefault(Invoke([&store](CallOptions* call_opts,
+                                     const BatchGetKeyValuesRequest* request,
+                                     BatchGetKeyValuesResponse* response,
+                                     StatusCallback done) {
+        for (const std::string& key : request->keys()) {
+          *response->add_kvs() = CreateKv(key, store.at(key));
+        }
+        done(OkStatus());
+      }));
+  InitializeAgent();
+  // Larger than 7 chunks of 1MB.
+  std::string value(7 * 1024 * 1024 + 5, 'a');
+  for (int i = 0; i < value.size(); i += 1000) {
+    value[i] = 'a' + (i / 1000) % 26;
+  }
+
+  TF_ASSERT_OK(agent_->InsertLargeKeyValue("large_key", value));
+  auto result = agent_->GetLargeKeyValue("large_key", absl::Seconds(10));
+
+  EXPECT_EQ(store.size(), 9);
+  EXPECT_EQ(store["large_key"], "8");
+  TF_ASSERT_OK(result.status());
+  EXPECT_EQ(*result, value);
+}
+
 TEST_F(CoordinationServiceAgentTest, ShutdownInErrorShouldReturnError) {
   // Connect coordination agent and set it to error.
   InitializeAgent();
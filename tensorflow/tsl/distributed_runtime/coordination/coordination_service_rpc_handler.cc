@@ -16,12 +16,14 @@ limitations under the License.
 #include "tensorflow/tsl/distributed_runtime/coordination/coordination_service_rpc_handler.h"
 
 #include <iterator>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/time/time.h"
+#include "tensorflow/tsl/distributed_runtime/coordination/coordination_aggregator.h"
 #include "tensorflow/tsl/distributed_runtime/coordination/coordination_service.h"
 #include "tensorflow/tsl/distributed_runtime/coordination/coordination_service_agent.h"
 #include "tensorflow/tsl/distributed_runtime/coordination/coordination_service_error_util.h"
@@ -35,6 +37,7 @@ namespace tsl {
 namespace {
 using tensorflow::CoordinatedTask;
 using tensorflow::CoordinationServiceError;
+using tensorflow::ForwardedHeartbeatError;
 using tensorflow::KeyValueEntry;
 }  // namespace
 
@@ -71,6 +74,12 @@ void CoordinationServiceRpcHandler::HeartbeatAsync(
     StatusCallback done) {
   tf_shared_lock l(mu_);
   if (service_ == nullptr) {
+    CoordinationAggregator* aggregator =
+        agent_ != nullptr ? agent_->GetAggregator() : nullptr;
+    if (aggregator != nullptr) {
+      done(aggregator->RecordHeartbeat(*request, response));
+      return;
+    }
     done(MakeCoordinationError(
         errors::Internal("Coordination service is not enabled.")));
     return;
@@ -78,6 +87,16 @@ void CoordinationServiceRpcHandler::HeartbeatAsync(
   const CoordinatedTask& task = request->source_task();
   const uint64_t incarnation = request->incarnation();
   const uint64_t leader_incarnation = service_->GetServiceIncarnation();
+  for (const HeartbeatRequest& forwarded : request->forwarded_heartbeats()) {
+    Status forwarded_status = service_->RecordHeartbeat(
+        forwarded.source_task(), forwarded.incarnation());
+    if (!forwarded_status.ok()) {
+      ForwardedHeartbeatError* error = response->add_forwarded_errors();
+      *error->mutable_task() = forwarded.source_task();
+      error->set_error_code(forwarded_status.code());
+      error->set_error_message(forwarded_status.error_message());
+    }
+  }
   Status s = service_->RecordHeartbeat(task, incarnation);
   if (!s.ok()) {
     done(s);
@@ -264,22 +283,116 @@ void CoordinationServiceRpcHandler::DeleteKeyValueAsync(
   done(service_->DeleteKeyValue(request->key()));
 }
 
+void CoordinationServiceRpcHandler::BatchInsertKeyValuesAsync(
+    const BatchInsertKeyValuesRequest* request,
+    BatchInsertKeyValuesResponse* response, StatusCallback done) {
+  tf_shared_lock l(mu_);
+  if (service_ == nullptr) {
+    done(MakeCoordinationError(
+        errors::Internal("Coordination service is not enabled.")));
+    return;
+  }
+  done(service_->InsertKeyValues(
+      {request->kvs().begin(), request->kvs().end()}));
+}
+
+void CoordinationServiceRpcHandler::BatchGetKeyValuesAsync(
+    const BatchGetKeyValuesRequest* request,
+    BatchGetKeyValuesResponse* response, StatusCallback done) {
+  tf_shared_lock l(mu_);
+  if (service_ == nullptr) {
+    done(MakeCoordinationError(
+        errors::Internal("Coordination service is not enabled.")));
+    return;
+  }
+  service_->GetKeyValuesAsync(
+      {request->keys().begin(), request->keys().end()},
+      [response, done = std::move(done)](
+          const StatusOr<std::vector<KeyValueEntry>>& kvs) {
+        if (kvs.ok()) {
+          *response->mutable_kvs() = {kvs.value().begin(), kvs.value().end()};
+        }
+        done(kvs.status());
+      });
+}
+
+void CoordinationServiceRpcHandler::WatchKeyValueDirAsync(
+    const WatchKeyValueDirRequest* request, WatchKeyValueDirResponse* response,
+    StatusCallback done) {
+  tf_shared_lock l(mu_);
+  if (service_ == nullptr) {
+    done(MakeCoordinationError(
+        errors::Internal("Coordination service is not enabled.")));
+    return;
+  }
+  response->set_directory_key(request->directory_key());
+  service_->WatchKeyValueDirAsync(
+      request->directory_key(), request->min_entries(),
+      [response, done = std::move(done)](
+          const StatusOr<std::vector<KeyValueEntry>>& kvs) {
+        if (kvs.ok()) {
+          *response->mutable_kv() = {kvs.value().begin(), kvs.value().end()};
+        }
+        done(kvs.status());
+      });
+}
+
 void CoordinationServiceRpcHandler::BarrierAsync(const BarrierRequest* request,
                                                  BarrierResponse* response,
                                                  StatusCallback done) {
   tf_shared_lock l(mu_);
   if (service_ == nullptr) {
+    CoordinationAggregator* aggregator =
+        agent_ != nullptr ? agent_->GetAggregator() : nullptr;
+    if (aggregator != nullptr) {
+      aggregator->BarrierAsync(*request, std::move(done));
+      return;
+    }
     done(MakeCoordinationError(
         errors::Internal("Coordination service is not enabled.")));
     return;
   }
   std::vector<CoordinatedTask> tasks = {request->tasks().begin(),
                                         request->tasks().end()};
-  service_->BarrierAsync(
-      request->barrier_id(),
-      absl::Milliseconds(request->barrier_timeout_in_ms()),
-      request->source_task(), tasks,
-      [done = std::move(done)](const Status& status) { done(status); });
+  if (request->arrived_tasks().empty()) {
+    service_->BarrierAsync(
+        request->barrier_id(),
+        absl::Milliseconds(request->barrier_timeout_in_ms()),
+        request->source_task(), tasks,
+        [done = std::move(done)](const Status& status) { done(status); });
+    return;
+  }
+  // Arrivals forwarded by an aggregating task complete together, with the
+  // first error reported for any of them.
+  struct ForwardedBarrier {
+    mutex mu;
+    int pending TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+    StatusCallback done;
+  };
+  auto forwarded = std::make_shared<ForwardedBarrier>();
+  {
+    mutex_lock forwarded_lock(forwarded->mu);
+    forwarded->pending = request->arrived_tasks_size();
+  }
+  forwarded->done = std::move(done);
+  for (const CoordinatedTask& task : request->arrived_tasks()) {
+    service_->BarrierAsync(
+        request->barrier_id(),
+        absl::Milliseconds(request->barrier_timeout_in_ms()), task, tasks,
+        [forwarded](const Status& status) {
+          Status result;
+          {
+            mutex_lock forwarded_lock(forwarded->mu);
+            forwarded->status.Update(status);
+            if (--forwarded->pending > 0) {
+              return;
+            }
+            result = forwarded->status;
+          }
+          forwarded->done(result);
+        });
+  }
 }
 
 void CoordinationServiceRpcHandler::CancelBarrierAsync(
@@ -294,4 +407,26 @@ void CoordinationServiceRpcHandler::CancelBarrierAsync(
   done(service_->CancelBarrier(request->barrier_id(), request->source_task()));
 }
 
+void CoordinationServiceRpcHandler::GetAliveTasksAsync(
+    const GetAliveTasksRequest* request, GetAliveTasksResponse* response,
+    StatusCallback done) {
+  tf_shared_lock l(mu_);
+  if (service_ == nullptr) {
+    done(MakeCoordinationError(
+        errors::Internal("Coordination service is not enabled.")));
+    return;
+  }
+  service_->GetAliveTasksAsync(
+      request->source_task(),
+      {request->tasks().begin(), request->tasks().end()},
+      [response, done = std::move(done)](
+          const Status& s, const std::vector<CoordinatedTask>& alive_tasks) {
+        if (s.ok()) {
+          *response->mutable_alive_tasks() = {alive_tasks.begin(),
+                                              alive_tasks.end()};
+        }
+        done(s);
+      });
+}
+
 }  // namespace tsl
@@ -84,6 +84,18 @@ class CoordinationServiceRpcHandler {
                            tensorflow::DeleteKeyValueResponse* response,
                            StatusCallback done);
 
+  void BatchInsertKeyValuesAsync(
+      const tensorflow::BatchInsertKeyValuesRequest* request,
+      tensorflow::BatchInsertKeyValuesResponse* response, StatusCallback done);
+
+  void BatchGetKeyValuesAsync(
+      const tensorflow::BatchGetKeyValuesRequest* request,
+      tensorflow::BatchGetKeyValuesResponse* response, StatusCallback done);
+
+  void WatchKeyValueDirAsync(const tensorflow::WatchKeyValueDirRequest* request,
+                             tensorflow::WatchKeyValueDirResponse* response,
+                             StatusCallback done);
+
   void BarrierAsync(const tensorflow::BarrierRequest* request,
                     tensorflow::BarrierResponse* response, StatusCallback done);
 
@@ -91,6 +103,10 @@ class CoordinationServiceRpcHandler {
                           tensorflow::CancelBarrierResponse* response,
                           StatusCallback done);
 
+  void GetAliveTasksAsync(const tensorflow::GetAliveTasksRequest* request,
+                          tensorflow::GetAliveTasksResponse* response,
+                          StatusCallback done);
+
  private:
   mutex mu_;
   CoordinationServiceAgent* agent_ TF_GUARDED_BY(mu_) = nullptr;
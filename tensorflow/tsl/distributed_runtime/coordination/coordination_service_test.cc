@@ -41,6 +41,7 @@ limitations under the License.
 
 namespace tsl {
 namespace {
+using ::testing::ElementsAre;
 using ::testing::EqualsProto;
 using ::testing::IsEmpty;
 using ::testing::UnorderedElementsAre;
@@ -113,8 +114,10 @@ class TestCoordinationClient : public CoordinationClient {
   UNIMPLEMENTED(TryGetKeyValue);
   UNIMPLEMENTED(GetKeyValueDir);
   UNIMPLEMENTED(DeleteKeyValue);
+  UNIMPLEMENTED(BatchInsertKeyValues);
   UNIMPLEMENTED(Barrier);
   UNIMPLEMENTED(CancelBarrier);
+  UNIMPLEMENTED(GetAliveTasks);
 #undef UNIMPLEMENTED
 
 #define UNIMPLEMENTED_WITH_CALL_OPTS(method)                                 \
@@ -125,6 +128,8 @@ class TestCoordinationClient : public CoordinationClient {
   }
 
   UNIMPLEMENTED_WITH_CALL_OPTS(GetKeyValue);
+  UNIMPLEMENTED_WITH_CALL_OPTS(BatchGetKeyValues);
+  UNIMPLEMENTED_WITH_CALL_OPTS(WatchKeyValueDir);
   UNIMPLEMENTED_WITH_CALL_OPTS(Heartbeat);
   UNIMPLEMENTED_WITH_CALL_OPTS(ShutdownTask);
 #undef UNIMPLEMENTED_WITH_CALL_OPTS
@@ -631,6 +636,87 @@ TEST_F(CoordinateTwoTasksTest,
   EXPECT_THAT(result, IsEmpty());
 }
 
+TEST_F(CoordinateTwoTasksTest, InsertAndGetKeyValues) {
+  EnableCoordinationService();
+  absl::Notification n;
+  StatusOr<std::vector<KeyValueEntry>> result;
+  coord_service_->GetKeyValuesAsync(
+      {"dir/key1", "key0"},
+      [&](const StatusOr<std::vector<KeyValueEntry>>& status_or_kvs) {
+        result = status_or_kvs;
+        n.Notify();
+      });
+  // Blocks until all the keys are inserted.
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("key0", "value0"));
+  EXPECT_FALSE(n.HasBeenNotified());
+
+  TF_ASSERT_OK(coord_service_->InsertKeyValues(
+      {CreateKv("dir/key1", "value1"), CreateKv("dir/key2", "value2")}));
+
+  n.WaitForNotification();
+  TF_ASSERT_OK(result.status());
+  EXPECT_THAT(result.value(),
+              ElementsAre(EqualsProto(CreateKv("dir/key1", "value1")),
+                          EqualsProto(CreateKv("key0", "value0"))));
+  EXPECT_EQ(coord_service_->TryGetKeyValue("dir/key2").value(), "value2");
+}
+
+TEST_F(CoordinateTwoTasksTest, InsertKeyValues_ExistingKey_InsertsNothing) {
+  EnableCoordinationService();
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("key0", "value0"));
+
+  Status s = coord_service_->InsertKeyValues(
+      {CreateKv("key1", "value1"), CreateKv("/key0/", "value0_new")});
+
+  EXPECT_TRUE(errors::IsAlreadyExists(s)) << s;
+  EXPECT_TRUE(errors::IsNotFound(
+      coord_service_->TryGetKeyValue("key1").status()));
+  EXPECT_TRUE(errors::IsAlreadyExists(coord_service_->InsertKeyValues(
+      {CreateKv("key2", "value2"), CreateKv("key2", "value2")})));
+}
+
+TEST_F(CoordinateTwoTasksTest, WatchKeyValueDir_WaitsForMinEntries) {
+  EnableCoordinationService();
+  KeyValueEntry kv0 = CreateKv("dir/task_0", "0");
+  KeyValueEntry kv1 = CreateKv("dir/task_1", "1");
+  TF_ASSERT_OK(coord_service_->InsertKeyValue(kv0.key(), kv0.value()));
+  absl::Notification n;
+  StatusOr<std::vector<KeyValueEntry>> result;
+  coord_service_->WatchKeyValueDirAsync(
+      "dir", /*min_entries=*/2,
+      [&](const StatusOr<std::vector<KeyValueEntry>>& status_or_kvs) {
+        result = status_or_kvs;
+        n.Notify();
+      });
+  // Keys outside of the directory are not counted.
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("dir_task_1", "1"));
+  EXPECT_FALSE(n.HasBeenNotified());
+
+  TF_ASSERT_OK(coord_service_->InsertKeyValue(kv1.key(), kv1.value()));
+
+  n.WaitForNotification();
+  TF_ASSERT_OK(result.status());
+  EXPECT_THAT(result.value(),
+              UnorderedElementsAre(EqualsProto(kv0), EqualsProto(kv1)));
+}
+
+TEST_F(CoordinateTwoTasksTest, WatchKeyValueDir_CountsDeletedKeys) {
+  EnableCoordinationService();
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("dir/task_0", "0"));
+  auto n = std::make_shared<absl::Notification>();
+  coord_service_->WatchKeyValueDirAsync(
+      "dir", /*min_entries=*/2,
+      // Pending until the service shuts down, see TestSetGetValues.
+      [n](const StatusOr<std::vector<KeyValueEntry>>& status_or_kvs) {
+        n->Notify();
+      });
+  TF_ASSERT_OK(coord_service_->DeleteKeyValue("dir/task_0"));
+
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("dir/task_1", "1"));
+
+  EXPECT_FALSE(n->HasBeenNotified());
+}
+
 }  // namespace
 
 // Verify that coordination service can gather each task's device info and
@@ -1195,6 +1281,75 @@ TEST_F(CoordinationBarrierTest,
   TF_EXPECT_OK(barrier_status_2);
 }
 
+TEST_F(CoordinationBarrierTest, GetAliveTasks_WaitsForAllAliveTasks) {
+  const std::vector<CoordinatedTask> tasks = {GetTask(0), GetTask(1),
+                                              GetTask(2)};
+  std::vector<Status> statuses(tasks.size());
+  std::vector<std::vector<CoordinatedTask>> alive_tasks(tasks.size());
+  std::vector<absl::Notification> n(tasks.size());
+
+  for (int i = 0; i < tasks.size(); ++i) {
+    GetCoordinationService()->GetAliveTasksAsync(
+        GetTask(i), tasks,
+        [&, i](const Status& s, const std::vector<CoordinatedTask>& alive) {
+          statuses[i] = s;
+          alive_tasks[i] = alive;
+          n[i].Notify();
+        });
+    // Nobody is answered before every task has called.
+    if (i < 2) EXPECT_FALSE(n[0].HasBeenNotified());
+  }
+
+  for (int i = 0; i < tasks.size(); ++i) {
+    n[i].WaitForNotification();
+    TF_EXPECT_OK(statuses[i]);
+    EXPECT_THAT(alive_tasks[i],
+                ElementsAre(EqualsProto(GetTask(0)), EqualsProto(GetTask(1)),
+                            EqualsProto(GetTask(2))));
+  }
+}
+
+TEST_F(CoordinationBarrierTest, GetAliveTasks_DoesNotWaitForFailedTask) {
+  const std::vector<CoordinatedTask> tasks = {GetTask(0), GetTask(1),
+                                              GetTask(2)};
+  std::vector<Status> statuses(2);
+  std::vector<std::vector<CoordinatedTask>> alive_tasks(2);
+  std::vector<absl::Notification> n(2);
+
+  for (int i = 0; i < 2; ++i) {
+    GetCoordinationService()->GetAliveTasksAsync(
+        GetTask(i), tasks,
+        [&, i](const Status& s, const std::vector<CoordinatedTask>& alive) {
+          statuses[i] = s;
+          alive_tasks[i] = alive;
+          n[i].Notify();
+        });
+  }
+  EXPECT_FALSE(n[0].HasBeenNotified());
+  // Task 2 fails, e.g. because it got preempted, so the surviving tasks agree
+  // on continuing without it.
+  TF_ASSERT_OK(GetCoordinationService()->ReportTaskError(
+      GetTask(2), errors::Unavailable("preempted")));
+
+  for (int i = 0; i < 2; ++i) {
+    n[i].WaitForNotification();
+    TF_EXPECT_OK(statuses[i]);
+    EXPECT_THAT(alive_tasks[i], ElementsAre(EqualsProto(GetTask(0)),
+                                            EqualsProto(GetTask(1))));
+  }
+}
+
+TEST_F(CoordinationBarrierTest, GetAliveTasks_FailsWithoutRequestingTask) {
+  Status status;
+  GetCoordinationService()->GetAliveTasksAsync(
+      GetTask(0), {GetTask(1), GetTask(2)},
+      [&](const Status& s, const std::vector<CoordinatedTask>&) {
+        status = s;
+      });
+
+  EXPECT_TRUE(errors::IsInvalidArgument(status));
+}
+
 TEST_F(CoordinateTwoTasksTest, ResetAndRegisterAgain) {
   EnableCoordinationService();
   TF_EXPECT_OK(coord_service_->RegisterTask(task_0_, incarnation_0_));
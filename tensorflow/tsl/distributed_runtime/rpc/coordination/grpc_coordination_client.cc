@@ -37,10 +37,16 @@ namespace tsl {
 namespace {
 using tensorflow::BarrierRequest;
 using tensorflow::BarrierResponse;
+using tensorflow::BatchGetKeyValuesRequest;
+using tensorflow::BatchGetKeyValuesResponse;
+using tensorflow::BatchInsertKeyValuesRequest;
+using tensorflow::BatchInsertKeyValuesResponse;
 using tensorflow::CancelBarrierRequest;
 using tensorflow::CancelBarrierResponse;
 using tensorflow::DeleteKeyValueRequest;
 using tensorflow::DeleteKeyValueResponse;
+using tensorflow::GetAliveTasksRequest;
+using tensorflow::GetAliveTasksResponse;
 using tensorflow::GetKeyValueDirRequest;
 using tensorflow::GetKeyValueDirResponse;
 using tensorflow::GetKeyValueRequest;
@@ -65,6 +71,8 @@ using tensorflow::TryGetKeyValueRequest;
 using tensorflow::TryGetKeyValueResponse;
 using tensorflow::WaitForAllTasksRequest;
 using tensorflow::WaitForAllTasksResponse;
+using tensorflow::WatchKeyValueDirRequest;
+using tensorflow::WatchKeyValueDirResponse;
 
 class GrpcCoordinationClientThread {
  public:
@@ -244,6 +252,38 @@ class GrpcCoordinationClient : public CoordinationClient {
         &target_);
   }
 
+  void BatchInsertKeyValuesAsync(const BatchInsertKeyValuesRequest* request,
+                                 BatchInsertKeyValuesResponse* response,
+                                 StatusCallback done) override {
+    new RPCState<protobuf::Message>(
+        &stub_, cq_, "/tensorflow.CoordinationService/BatchInsertKeyValues",
+        *request, response, std::move(done), /*call_opts=*/nullptr,
+        /*threadpool=*/nullptr, /*max_retries=*/0, /*fail_fast=*/true,
+        &target_);
+  }
+
+  void BatchGetKeyValuesAsync(CallOptions* call_opts,
+                              const BatchGetKeyValuesRequest* request,
+                              BatchGetKeyValuesResponse* response,
+                              StatusCallback done) override {
+    new RPCState<protobuf::Message>(
+        &stub_, cq_, "/tensorflow.CoordinationService/BatchGetKeyValues",
+        *request, response, std::move(done), call_opts,
+        /*threadpool=*/nullptr, /*max_retries=*/0, /*fail_fast=*/true,
+        &target_);
+  }
+
+  void WatchKeyValueDirAsync(CallOptions* call_opts,
+                             const WatchKeyValueDirRequest* request,
+                             WatchKeyValueDirResponse* response,
+                             StatusCallback done) override {
+    new RPCState<protobuf::Message>(
+        &stub_, cq_, "/tensorflow.CoordinationService/WatchKeyValueDir",
+        *request, response, std::move(done), call_opts,
+        /*threadpool=*/nullptr, /*max_retries=*/0, /*fail_fast=*/true,
+        &target_);
+  }
+
   void BarrierAsync(const BarrierRequest* request, BarrierResponse* response,
                     StatusCallback done) override {
     new RPCState<protobuf::Message>(
@@ -263,6 +303,16 @@ class GrpcCoordinationClient : public CoordinationClient {
         &target_);
   }
 
+  void GetAliveTasksAsync(const GetAliveTasksRequest* request,
+                          GetAliveTasksResponse* response,
+                          StatusCallback done) override {
+    new RPCState<protobuf::Message>(
+        &stub_, cq_, "/tensorflow.CoordinationService/GetAliveTasks", *request,
+        response, std::move(done), /*call_opts=*/nullptr,
+        /*threadpool=*/nullptr, /*max_retries=*/0, /*fail_fast=*/true,
+        &target_);
+  }
+
  private:
   ::grpc::GenericStub stub_;
   ::grpc::CompletionQueue* cq_;
@@ -55,8 +55,12 @@ void GrpcCoordinationServiceImpl::HandleRPCsLoop() {
   ENQUEUE_REQUEST(TryGetKeyValue);
   ENQUEUE_REQUEST(GetKeyValueDir);
   ENQUEUE_REQUEST(DeleteKeyValue);
+  ENQUEUE_REQUEST(BatchInsertKeyValues);
+  ENQUEUE_REQUEST(BatchGetKeyValues);
+  ENQUEUE_REQUEST(WatchKeyValueDir);
   ENQUEUE_REQUEST(Barrier);
   ENQUEUE_REQUEST(CancelBarrier);
+  ENQUEUE_REQUEST(GetAliveTasks);
 #undef ENQUEUE_REQUEST
 
   void* tag;  // Matches the operation started against this cq_.
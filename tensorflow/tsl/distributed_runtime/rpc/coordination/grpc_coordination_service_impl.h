@@ -94,8 +94,12 @@ class GrpcCoordinationServiceImpl : public AsyncServiceInterface {
   HANDLER(TryGetKeyValue);
   HANDLER(GetKeyValueDir);
   HANDLER(DeleteKeyValue);
+  HANDLER(BatchInsertKeyValues);
+  HANDLER(BatchGetKeyValues);
+  HANDLER(WatchKeyValueDir);
   HANDLER(Barrier);
   HANDLER(CancelBarrier);
+  HANDLER(GetAliveTasks);
 #undef HANDLER
 
   thread::ThreadPool& compute_pool_;
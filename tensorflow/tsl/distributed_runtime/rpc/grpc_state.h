@@ -176,6 +176,7 @@ class RPCState : public GrpcClientCQTag {
       response_buf_.Clear();
       VLOG(1) << "Retrying call for " << method_ << "Retry: " << num_retries_
               << " of " << max_retries_;
+      RecordRpcRetry(target_ != nullptr ? *target_ : "", method_);
 
       ComputeRetryBackoffMs(/*min_backoff_ms=*/1, /*max_backoff_ms=*/10000);
       int64_t backoff_us = retry_backoff_ms_ * 1000;
@@ -20,6 +20,7 @@ limitations under the License.
 #include <vector>
 
 #include "grpcpp/impl/codegen/proto_utils.h"
+#include "tensorflow/tsl/lib/monitoring/counter.h"
 #include "tensorflow/tsl/platform/protobuf.h"
 #include "tensorflow/tsl/platform/random.h"
 
@@ -27,6 +28,11 @@ namespace tsl {
 
 namespace {
 
+auto* rpc_retries = monitoring::Counter<2>::New(
+    "/tensorflow/rpc/client/retries",
+    "The number of RPC attempts that failed transiently and were retried.",
+    "target", "method");
+
 double GenerateUniformRandomNumber() {
   return random::New64() * (1.0 / std::numeric_limits<uint64>::max());
 }
@@ -39,6 +45,14 @@ double GenerateUniformRandomNumberBetween(double a, double b) {
 
 }  // namespace
 
+void RecordRpcRetry(const string& target, const string& method) {
+  rpc_retries->GetCell(target, method)->IncrementBy(1);
+}
+
+int64_t GetRpcRetries(const string& target, const string& method) {
+  return rpc_retries->GetCell(target, method)->value();
+}
+
 int64_t ComputeBackoffMicroseconds(int current_retry_attempt, int64_t min_delay,
                                    int64_t max_delay) {
   DCHECK_GE(current_retry_attempt, 0);
@@ -44,6 +44,13 @@ int64_t ComputeBackoffMicroseconds(int current_retry_attempt,
                                    int64_t min_delay = 1000,
                                    int64_t max_delay = 10000000);
 
+// Records that an RPC of `method` to `target` failed transiently and is being
+// retried, in the /tensorflow/rpc/client/retries counter.
+void RecordRpcRetry(const string& target, const string& method);
+
+// Returns the number of retries recorded for RPCs of `method` to `target`.
+int64_t GetRpcRetries(const string& target, const string& method);
+
 constexpr char kStreamRemovedMessage[] = "Stream removed";
 
 // Identify if the given grpc::Status corresponds to an HTTP stream removed
@@ -404,6 +404,11 @@ class SubAllocator {
   // returned by this allocator.
   virtual bool SupportsCoalescing() const = 0;
 
+  // If non-zero, any range of memory returned by Alloc() whose address and
+  // size are multiples of this granularity may be passed to Free() on its
+  // own. Returns 0 if only whole allocations can be freed.
+  virtual size_t PartialFreeGranularity() const { return 0; }
+
   // Returns the type of the memory allocated by this SubAllocator.
   virtual AllocatorMemoryType GetMemoryType() const {
     return AllocatorMemoryType::kUnknown;
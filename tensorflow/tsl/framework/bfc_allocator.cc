@@ -17,7 +17,9 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <functional>
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 
 #include "absl/strings/string_view.h"
@@ -84,6 +86,11 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+  static_assert(kMaxCachedChunkBytes == 256 << (kNumCachedBins - 1),
+                "kNumCachedBins must cover kMaxCachedChunkBytes");
+  if (opts.small_chunk_cache) {
+    chunk_cache_shards_.reset(new ChunkCacheShard[kNumChunkCacheShards]);
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -427,6 +434,14 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // so all memory addresses are nicely byte aligned.
   size_t rounded_bytes = RoundedBytes(num_bytes);
 
+  if (chunk_cache_shards_ != nullptr && freed_before == 0 &&
+      rounded_bytes <= kMaxCachedChunkBytes) {
+    void* ptr = AllocateFromChunkCache(rounded_bytes, num_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
@@ -438,6 +453,7 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
   if (ptr != nullptr) {
     AddTraceMe("MemoryAllocation", ptr);
+    MaybeTrackCacheableChunk(ptr);
     return ptr;
   }
 
@@ -446,6 +462,7 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
     if (ptr != nullptr) {
       AddTraceMe("MemoryAllocation", ptr);
+      MaybeTrackCacheableChunk(ptr);
       return ptr;
     }
   }
@@ -459,11 +476,23 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
       ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
       if (ptr != nullptr) {
         AddTraceMe("MemoryAllocation", ptr);
+        MaybeTrackCacheableChunk(ptr);
         return ptr;
       }
     }
   }
 
+  // Chunks parked in the small chunk caches can't be coalesced, so return them
+  // to the bins before trying anything more drastic.
+  if (ReleaseCachedChunks()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      MaybeTrackCacheableChunk(ptr);
+      return ptr;
+    }
+  }
+
   // Reaching this point means that no chunks can satisfy the request. Also,
   // the unallocated bytes cannot satisfy the request. Before giving up, let's
   // try deallocating free regions so that suballocator can combine them with
@@ -473,6 +502,7 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
     if (ptr != nullptr) {
       AddTraceMe("MemoryAllocation", ptr);
+      MaybeTrackCacheableChunk(ptr);
       return ptr;
     }
   }
@@ -515,6 +545,124 @@ double BFCAllocator::GetFragmentation() {
          bytes_available;
 }
 
+double BFCAllocator::FragmentationMetric() {
+  mutex_lock l(lock_);
+  if (*stats_.pool_bytes <= stats_.bytes_in_use) {
+    return 0;
+  }
+  return GetFragmentation();
+}
+
+size_t BFCAllocator::MaybeCompact(const std::function<bool()>& sync) {
+  if (opts_.compaction_threshold <= 0 ||
+      sub_allocator_->PartialFreeGranularity() == 0 ||
+      FragmentationMetric() < opts_.compaction_threshold) {
+    return 0;
+  }
+  return Compact(sync);
+}
+
+size_t BFCAllocator::Compact(const std::function<bool()>& sync) {
+  const size_t granularity = sub_allocator_->PartialFreeGranularity();
+  if (granularity == 0) {
+    return 0;
+  }
+  std::vector<ChunkHandle> reserved;
+  {
+    mutex_lock l(lock_);
+    ReleaseCachedChunks();
+    if (!timestamped_chunks_.empty()) {
+      MergeTimestampedChunks(0);
+    }
+    reserved = ReserveFreePages(granularity);
+  }
+  if (reserved.empty()) {
+    return 0;
+  }
+  // Kernels enqueued before the chunks were freed may still be using them.
+  const bool synced = sync();
+  size_t released_bytes = 0;
+  mutex_lock l(lock_);
+  for (ChunkHandle h : reserved) {
+    if (synced) {
+      released_bytes += ChunkFromHandle(h)->size;
+      ReleaseChunkToSubAllocator(h);
+    } else {
+      ChunkFromHandle(h)->allocation_id = -1;
+      InsertFreeChunkIntoBin(TryToCoalesce(h, /*ignore_freed_at=*/false));
+    }
+  }
+  VLOG(1) << "Compaction of " << Name() << " released "
+          << strings::HumanReadableNumBytes(released_bytes);
+  return released_bytes;
+}
+
+std::vector<BFCAllocator::ChunkHandle> BFCAllocator::ReserveFreePages(
+    size_t granularity) {
+  std::vector<ChunkHandle> candidates;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    for (ChunkHandle h = region_manager_.get_handle(region.ptr());
+         h != kInvalidChunkHandle; h = ChunkFromHandle(h)->next) {
+      const Chunk* c = ChunkFromHandle(h);
+      if (!c->in_use() && c->freed_at_count == 0 && c->size >= granularity) {
+        candidates.push_back(h);
+      }
+    }
+  }
+  // Splitting chunks below only creates chunks outside the ones collected
+  // here, so the handles stay valid.
+  std::vector<ChunkHandle> reserved;
+  for (ChunkHandle h : candidates) {
+    Chunk* c = ChunkFromHandle(h);
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(c->ptr);
+    const uintptr_t end = begin + c->size;
+    const uintptr_t page_begin =
+        (begin + granularity - 1) / granularity * granularity;
+    const uintptr_t page_end = end / granularity * granularity;
+    if (page_end <= page_begin) {
+      continue;
+    }
+    RemoveFreeChunkFromBin(h);
+    if (page_begin > begin) {
+      SplitChunk(h, page_begin - begin);
+      ChunkHandle head = h;
+      h = ChunkFromHandle(head)->next;
+      RemoveFreeChunkFromBin(h);
+      InsertFreeChunkIntoBin(head);
+    }
+    if (page_end < end) {
+      SplitChunk(h, page_end - page_begin);
+    }
+    // Not counted in stats_: the chunk only looks in use to keep it from
+    // being allocated or coalesced until it is released.
+    ChunkFromHandle(h)->allocation_id = next_allocation_id_++;
+    reserved.push_back(h);
+  }
+  return reserved;
+}
+
+void BFCAllocator::ReleaseChunkToSubAllocator(ChunkHandle h) {
+  Chunk* c = ChunkFromHandle(h);
+  void* ptr = c->ptr;
+  const size_t size = c->size;
+  const ChunkHandle prev = c->prev;
+  const ChunkHandle next = c->next;
+  if (prev != kInvalidChunkHandle) {
+    ChunkFromHandle(prev)->next = kInvalidChunkHandle;
+  }
+  if (next != kInvalidChunkHandle) {
+    ChunkFromHandle(next)->prev = kInvalidChunkHandle;
+  }
+  DeleteChunk(h);
+  region_manager_.RemoveRange(ptr, size);
+  for (ChunkHandle n = next; n != kInvalidChunkHandle;
+       n = ChunkFromHandle(n)->next) {
+    region_manager_.set_handle(ChunkFromHandle(n)->ptr, n);
+  }
+  sub_allocator_->Free(ptr, size);
+  *stats_.pool_bytes -= size;
+}
+
 void BFCAllocator::AddTraceMe(absl::string_view traceme_name, const void* ptr) {
   BFCAllocator::Chunk* chunk = ChunkFromHandle(region_manager_.get_handle(ptr));
   AddTraceMe(traceme_name, chunk->ptr, chunk->requested_size, chunk->size);
@@ -693,8 +841,14 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     VLOG(2) << "tried to deallocate nullptr";
     return;
   }
+  if (chunk_cache_shards_ != nullptr && DeallocateToChunkCache(ptr)) {
+    return;
+  }
   mutex_lock l(lock_);
+  FreeChunkPtr(ptr);
+}
 
+void BFCAllocator::FreeChunkPtr(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -723,6 +877,135 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   }
 }
 
+BFCAllocator::ChunkCacheShard& BFCAllocator::ThreadChunkCacheShard() {
+  static thread_local const size_t thread_hash =
+      std::hash<std::thread::id>()(std::this_thread::get_id());
+  return chunk_cache_shards_[thread_hash % kNumChunkCacheShards];
+}
+
+BFCAllocator::ChunkCacheShard& BFCAllocator::ChunkCacheShardForPtr(
+    const void* ptr) const {
+  // Chunks are at least kMinAllocationSize aligned, so drop the low bits.
+  return chunk_cache_shards_[(reinterpret_cast<uintptr_t>(ptr) >>
+                              kMinAllocationBits) %
+                             kNumChunkCacheShards];
+}
+
+void* BFCAllocator::AllocateFromChunkCache(size_t rounded_bytes,
+                                           size_t num_bytes) {
+  CachedChunk chunk = {nullptr, 0};
+  {
+    ChunkCacheShard& shard = ThreadChunkCacheShard();
+    mutex_lock l(shard.mu);
+    std::vector<CachedChunk>& chunks =
+        shard.free_chunks[BinNumForSize(rounded_bytes)];
+    // Like FindChunkPtr, accept a chunk that would not have been split for
+    // this request. Search from the most recently freed chunk.
+    for (auto it = chunks.rbegin(); it != chunks.rend(); ++it) {
+      if (it->size >= rounded_bytes && it->size < rounded_bytes * 2) {
+        chunk = *it;
+        chunks.erase(std::next(it).base());
+        break;
+      }
+    }
+  }
+  if (chunk.ptr == nullptr) {
+    return nullptr;
+  }
+  cached_bytes_.fetch_sub(chunk.size, std::memory_order_relaxed);
+  num_cached_allocs_.fetch_add(1, std::memory_order_relaxed);
+  ChunkCacheShard& shard = ChunkCacheShardForPtr(chunk.ptr);
+  mutex_lock l(shard.mu);
+  shard.in_use_chunks[chunk.ptr] = {chunk.size, num_bytes};
+  return chunk.ptr;
+}
+
+bool BFCAllocator::DeallocateToChunkCache(void* ptr) {
+  CacheableChunk chunk;
+  {
+    ChunkCacheShard& shard = ChunkCacheShardForPtr(ptr);
+    mutex_lock l(shard.mu);
+    auto it = shard.in_use_chunks.find(ptr);
+    if (it == shard.in_use_chunks.end()) {
+      return false;
+    }
+    chunk = it->second;
+    shard.in_use_chunks.erase(it);
+  }
+  if (timing_counter_) {
+    return false;
+  }
+  std::vector<CachedChunk> evicted;
+  {
+    ChunkCacheShard& shard = ThreadChunkCacheShard();
+    mutex_lock l(shard.mu);
+    std::vector<CachedChunk>& chunks =
+        shard.free_chunks[BinNumForSize(chunk.size)];
+    chunks.push_back({ptr, chunk.size});
+    if (chunks.size() > kMaxCachedChunksPerBin) {
+      // Hand the older half back to the bins under a single acquisition of
+      // lock_.
+      auto end = chunks.begin() + kMaxCachedChunksPerBin / 2;
+      evicted.assign(chunks.begin(), end);
+      chunks.erase(chunks.begin(), end);
+    }
+  }
+  cached_bytes_.fetch_add(chunk.size, std::memory_order_relaxed);
+  if (!evicted.empty()) {
+    mutex_lock l(lock_);
+    for (const CachedChunk& c : evicted) {
+      cached_bytes_.fetch_sub(c.size, std::memory_order_relaxed);
+      FreeChunkPtr(c.ptr);
+    }
+  }
+  return true;
+}
+
+void BFCAllocator::MaybeTrackCacheableChunk(void* ptr) {
+  if (chunk_cache_shards_ == nullptr || timing_counter_) {
+    return;
+  }
+  const Chunk* c = ChunkFromHandle(region_manager_.get_handle(ptr));
+  if (c->size > kMaxCachedChunkBytes) {
+    return;
+  }
+  ChunkCacheShard& shard = ChunkCacheShardForPtr(ptr);
+  mutex_lock l(shard.mu);
+  shard.in_use_chunks[ptr] = {c->size, c->requested_size};
+}
+
+size_t BFCAllocator::CachedRequestedSize(const void* ptr) const {
+  if (chunk_cache_shards_ == nullptr) {
+    return 0;
+  }
+  ChunkCacheShard& shard = ChunkCacheShardForPtr(ptr);
+  mutex_lock l(shard.mu);
+  auto it = shard.in_use_chunks.find(ptr);
+  return it == shard.in_use_chunks.end() ? 0 : it->second.requested_size;
+}
+
+bool BFCAllocator::ReleaseCachedChunks() {
+  if (chunk_cache_shards_ == nullptr) {
+    return false;
+  }
+  bool released = false;
+  for (int i = 0; i < kNumChunkCacheShards; ++i) {
+    std::array<std::vector<CachedChunk>, kNumCachedBins> free_chunks;
+    {
+      mutex_lock l(chunk_cache_shards_[i].mu);
+      free_chunks.swap(chunk_cache_shards_[i].free_chunks);
+    }
+    for (const std::vector<CachedChunk>& chunks : free_chunks) {
+      for (const CachedChunk& c : chunks) {
+        cached_bytes_.fetch_sub(c.size, std::memory_order_relaxed);
+        FreeChunkPtr(c.ptr);
+        released = true;
+      }
+    }
+  }
+  return released;
+}
+
 // Merges h1 and h2 when Chunk(h1)->next is h2 and Chunk(h2)->prev is c1.
 // We merge Chunk(h2) into Chunk(h1).
 void BFCAllocator::Merge(BFCAllocator::ChunkHandle h1,
@@ -937,6 +1220,11 @@ bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
+  // Chunks handed out by the small chunk caches don't update the chunk.
+  size_t cached_requested_size = CachedRequestedSize(ptr);
+  if (cached_requested_size > 0) {
+    return cached_requested_size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -1207,11 +1495,17 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  // Chunks parked in the small chunk caches are in use as far as stats_ is
+  // concerned. peak_bytes_in_use is not corrected and is thus an upper bound.
+  AllocatorStats stats = stats_;
+  stats.bytes_in_use -= cached_bytes_.load(std::memory_order_relaxed);
+  stats.num_allocs += num_cached_allocs_.load(std::memory_order_relaxed);
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
+  num_cached_allocs_.store(0, std::memory_order_relaxed);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
@@ -18,11 +18,13 @@ limitations under the License.
 
 #include <array>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/tsl/framework/allocator.h"
 #include "tensorflow/tsl/framework/allocator_retry.h"
@@ -68,6 +70,22 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If true, freed chunks of up to kMaxCachedChunkBytes are parked in small
+    // per-thread caches and handed back to later allocations of a similar
+    // size without taking the allocator lock. Cached chunks stay in use from
+    // the point of view of the bins, so they are not coalesced until they are
+    // returned to the allocator, either in batches when a cache fills up or
+    // all at once when an allocation would otherwise fail.
+    //
+    // The cache is bypassed while a timing counter is set, since cached
+    // chunks don't carry a freed_at_count.
+    bool small_chunk_cache = false;
+
+    // If positive, MaybeCompact() returns the memory under free chunks to the
+    // sub-allocator once GetFragmentation() reaches this value. Only has an
+    // effect if the sub-allocator supports partial frees.
+    double compaction_threshold = 0;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -107,6 +125,24 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Returns the fragmentation of the free memory as reported in MemoryDump:
+  // the fraction of free bytes outside the largest free chunk.
+  double FragmentationMetric();
+
+  // Returns the device memory under free chunks to the sub-allocator, in
+  // units of SubAllocator::PartialFreeGranularity(), and returns the number
+  // of bytes released. Later allocations can then be satisfied by fresh,
+  // contiguous regions even though the free memory was fragmented.
+  //
+  // The released ranges are taken off the free lists before `sync` is called
+  // without holding the allocator lock. `sync` must block until all device
+  // work that may still access memory freed before the call has completed,
+  // and return false if that failed, in which case nothing is released.
+  size_t Compact(const std::function<bool()>& sync);
+
+  // Calls Compact() if Options::compaction_threshold is set and reached.
+  size_t MaybeCompact(const std::function<bool()>& sync);
+
  private:
   struct Bin;
 
@@ -120,6 +156,69 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Returns the chunk at `ptr` to the bins, coalescing it with its neighbors
+  // if possible.
+  void FreeChunkPtr(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Small chunk caches (see Options::small_chunk_cache).
+  //
+  // Lock ordering: lock_ may be held while acquiring a ChunkCacheShard::mu,
+  // but never the other way around.
+  static constexpr size_t kMaxCachedChunkBytes = 64 << 10;
+  static constexpr int kNumCachedBins = 9;
+  static constexpr int kMaxCachedChunksPerBin = 16;
+  static constexpr int kNumChunkCacheShards = 16;
+
+  struct CachedChunk {
+    void* ptr;
+    size_t size;
+  };
+
+  // The sizes of a chunk that is in use and may be cached once it is freed.
+  struct CacheableChunk {
+    size_t size;
+    size_t requested_size;
+  };
+
+  struct ChunkCacheShard {
+    mutex mu;
+    // Freed chunks by the bin of their size. Indexed by the freeing thread.
+    std::array<std::vector<CachedChunk>, kNumCachedBins> free_chunks
+        TF_GUARDED_BY(mu);
+    // Chunks in use that are eligible for caching. Indexed by pointer.
+    absl::flat_hash_map<const void*, CacheableChunk> in_use_chunks
+        TF_GUARDED_BY(mu);
+  };
+
+  ChunkCacheShard& ThreadChunkCacheShard();
+  ChunkCacheShard& ChunkCacheShardForPtr(const void* ptr) const;
+
+  // Returns a cached chunk fitting `rounded_bytes`, or nullptr.
+  void* AllocateFromChunkCache(size_t rounded_bytes, size_t num_bytes);
+
+  // Parks the chunk at `ptr` in the calling thread's cache. Returns false if
+  // the chunk must be returned to the bins instead.
+  bool DeallocateToChunkCache(void* ptr);
+
+  // Records a chunk just handed out from the bins as eligible for caching.
+  void MaybeTrackCacheableChunk(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the requested size of a cacheable chunk in use, or 0.
+  size_t CachedRequestedSize(const void* ptr) const;
+
+  // Returns all cached chunks to the bins. Returns true if any were cached.
+  bool ReleaseCachedChunks() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Takes the granularity-aligned interiors of free chunks off the free lists
+  // for Compact(), marking them in use so that they are not coalesced.
+  std::vector<ChunkHandle> ReserveFreePages(size_t granularity)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns a chunk reserved by ReserveFreePages() to the sub-allocator,
+  // splitting its region.
+  void ReleaseChunkToSubAllocator(ChunkHandle h)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -311,6 +410,13 @@ class BFCAllocator : public Allocator {
     void* ptr() const { return ptr_; }
     void* end_ptr() const { return end_ptr_; }
     size_t memory_size() const { return memory_size_; }
+    void truncate(size_t size) {
+      DCHECK_LT(size, memory_size_);
+      DCHECK_EQ(0, size % kMinAllocationSize);
+      memory_size_ = size;
+      end_ptr_ = static_cast<void*>(static_cast<char*>(ptr_) + memory_size_);
+      handles_.resize(memory_size_ / kMinAllocationSize);
+    }
     void extend(size_t size) {
       memory_size_ += size;
       DCHECK_EQ(0, memory_size_ % kMinAllocationSize);
@@ -408,6 +514,30 @@ class BFCAllocator : public Allocator {
       return regions_.erase(it);
     }
 
+    // Removes [ptr, ptr + size) from the region containing it, splitting the
+    // region in two if the range is in its interior. Chunk handles in the
+    // part after the range must be set again by the caller.
+    void RemoveRange(void* ptr, size_t size) {
+      auto it =
+          std::upper_bound(regions_.begin(), regions_.end(), ptr, &Comparator);
+      CHECK(it != regions_.end() && it->ptr() <= ptr);
+      char* range_end = static_cast<char*>(ptr) + size;
+      char* region_end = static_cast<char*>(it->end_ptr());
+      DCHECK_LE(range_end, region_end);
+      const size_t head_size = static_cast<char*>(ptr) -
+                               static_cast<char*>(it->ptr());
+      if (range_end < region_end) {
+        it = regions_.insert(it + 1, AllocationRegion(range_end,
+                                                      region_end - range_end));
+        --it;
+      }
+      if (head_size > 0) {
+        it->truncate(head_size);
+      } else {
+        regions_.erase(it);
+      }
+    }
+
     ChunkHandle get_handle(const void* p) const {
       return RegionFor(p)->get_handle(p);
     }
@@ -596,6 +726,13 @@ class BFCAllocator : public Allocator {
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // Null unless opts_.small_chunk_cache is set.
+  std::unique_ptr<ChunkCacheShard[]> chunk_cache_shards_;
+  // Bytes of the chunks parked in the caches, which stats_ counts as in use.
+  std::atomic<int64_t> cached_bytes_{0};
+  // Allocations served from the caches since the stats were last cleared.
+  std::atomic<int64_t> num_cached_allocs_{0};
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ TF_GUARDED_BY(lock_);
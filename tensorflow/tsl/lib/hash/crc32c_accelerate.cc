@@ -15,6 +15,9 @@ limitations under the License.
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
 
 // SSE4.2 accelerated CRC32c.
 
@@ -51,6 +54,10 @@ uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
   // Should not be called.
   return 0;
 }
+void AcceleratedValues(int n, const char *const *data, const size_t *sizes,
+                       uint32_t *crcs) {
+  // Should not be called.
+}
 
 #else
 
@@ -93,6 +100,47 @@ uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
   return l ^ 0xffffffffu;
 }
 
+// The crc32 instruction has a latency of several cycles but a throughput of
+// one per cycle, so the crcs of kStreams buffers are computed in an
+// interleaved loop over their common length, and then finished one at a time.
+void AcceleratedValues(int n, const char *const *data, const size_t *sizes,
+                       uint32_t *crcs) {
+  constexpr int kStreams = 4;
+  int i = 0;
+  for (; i + kStreams <= n; i += kStreams) {
+    size_t common_size = sizes[i];
+    for (int k = 1; k < kStreams; ++k) {
+      common_size = std::min(common_size, sizes[i + k]);
+    }
+    const size_t num_words = common_size / 8;
+    const char *p[kStreams];
+    uint64_t l[kStreams];
+    for (int k = 0; k < kStreams; ++k) {
+      p[k] = data[i + k];
+      l[k] = 0xffffffffu;
+    }
+    for (size_t w = 0; w < num_words; ++w) {
+      uint64_t v[kStreams];
+      for (int k = 0; k < kStreams; ++k) {
+        memcpy(&v[k], p[k] + 8 * w, sizeof(uint64_t));
+      }
+      l[0] = _mm_crc32_u64(l[0], v[0]);
+      l[1] = _mm_crc32_u64(l[1], v[1]);
+      l[2] = _mm_crc32_u64(l[2], v[2]);
+      l[3] = _mm_crc32_u64(l[3], v[3]);
+    }
+    for (int k = 0; k < kStreams; ++k) {
+      // AcceleratedExtend takes and returns the finalized crc.
+      crcs[i + k] = AcceleratedExtend(static_cast<uint32_t>(l[k]) ^ 0xffffffffu,
+                                      p[k] + 8 * num_words,
+                                      sizes[i + k] - 8 * num_words);
+    }
+  }
+  for (; i < n; ++i) {
+    crcs[i] = AcceleratedExtend(0, data[i], sizes[i]);
+  }
+}
+
 #endif
 
 }  // namespace crc32c
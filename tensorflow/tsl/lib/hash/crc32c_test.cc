@@ -14,6 +14,10 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/tsl/lib/hash/crc32c.h"
+
+#include <string>
+#include <vector>
+
 #include "tensorflow/tsl/platform/logging.h"
 #include "tensorflow/tsl/platform/test.h"
 #include "tensorflow/tsl/platform/test_benchmark.h"
@@ -62,6 +66,25 @@ TEST(CRC, Extend) {
   ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, ValuesOfSeveralBuffers) {
+  std::string input;
+  for (int i = 0; i < 1000; ++i) {
+    input.push_back(static_cast<char>(i * 31));
+  }
+  // Buffers of various sizes and alignments, in groups of different lengths.
+  std::vector<const char*> data;
+  std::vector<size_t> sizes;
+  for (int i = 0; i < 11; ++i) {
+    data.push_back(input.data() + i * 13);
+    sizes.push_back((i * 37) % 101);
+  }
+  std::vector<uint32> crcs(data.size());
+  Values(data.size(), data.data(), sizes.data(), crcs.data());
+  for (int i = 0; i < data.size(); ++i) {
+    EXPECT_EQ(crcs[i], Value(data[i], sizes[i])) << "buffer " << i;
+  }
+}
+
 TEST(CRC, Mask) {
   uint32 crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
@@ -93,5 +116,23 @@ static void BM_CRC(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_CRC)->Range(1, 256 * 1024);
 
+static void BM_CRCValues(::testing::benchmark::State& state) {
+  const int len = state.range(0);
+  constexpr int kNumBuffers = 64;
+  std::string input(kNumBuffers * len, 'x');
+  std::vector<const char*> data;
+  std::vector<size_t> sizes(kNumBuffers, len);
+  for (int i = 0; i < kNumBuffers; ++i) {
+    data.push_back(input.data() + i * len);
+  }
+  std::vector<uint32> crcs(kNumBuffers);
+  for (auto s : state) {
+    Values(kNumBuffers, data.data(), sizes.data(), crcs.data());
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+  VLOG(1) << crcs[0];
+}
+BENCHMARK(BM_CRCValues)->Range(16, 4096);
+
 }  // namespace crc32c
 }  // namespace tsl
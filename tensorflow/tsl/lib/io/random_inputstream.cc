@@ -16,25 +16,82 @@ limitations under the License.
 #include "tensorflow/tsl/lib/io/random_inputstream.h"
 
 #include <memory>
+#include <utility>
+
+#include "tensorflow/tsl/platform/notification.h"
 
 namespace tsl {
 namespace io {
 
+// Reads smaller than this do not start a read ahead, as the reads of record
+// readers without a buffer alternate between small headers and records.
+static constexpr int64_t kMinReadAheadBytes = 64 * 1024;
+
+// A read of the bytes that follow the last read, in flight or done.
+struct RandomAccessInputStream::ReadAhead {
+  int64_t offset;
+  tstring buffer;
+  size_t bytes_read = 0;
+  Status status;
+  Notification done;
+};
+
 RandomAccessInputStream::RandomAccessInputStream(RandomAccessFile* file,
                                                  bool owns_file)
-    : file_(file), owns_file_(owns_file) {}
+    : file_(file),
+      owns_file_(owns_file),
+      read_ahead_enabled_(file->SupportsAsyncRead()) {}
 
 RandomAccessInputStream::~RandomAccessInputStream() {
+  // The file must outlive the read in flight.
+  DropReadAhead();
   if (owns_file_) {
     delete file_;
   }
 }
 
+void RandomAccessInputStream::StartReadAhead(int64_t bytes_to_read) {
+  auto read_ahead = std::make_shared<ReadAhead>();
+  read_ahead->offset = pos_;
+  read_ahead->buffer.resize_uninitialized(bytes_to_read);
+  char* buffer = &read_ahead->buffer[0];
+  read_ahead_ = read_ahead;
+  file_->ReadAsync(pos_, bytes_to_read, buffer,
+                   [read_ahead, buffer](const Status& s, StringPiece data) {
+                     if (data.data() != buffer) {
+                       memmove(buffer, data.data(), data.size());
+                     }
+                     read_ahead->bytes_read = data.size();
+                     read_ahead->status = s;
+                     read_ahead->done.Notify();
+                   });
+}
+
+void RandomAccessInputStream::DropReadAhead() {
+  if (read_ahead_ != nullptr) {
+    read_ahead_->done.WaitForNotification();
+    read_ahead_ = nullptr;
+  }
+}
+
 Status RandomAccessInputStream::ReadNBytes(int64_t bytes_to_read,
                                            tstring* result) {
   if (bytes_to_read < 0) {
     return errors::InvalidArgument("Cannot read negative number of bytes");
   }
+  if (read_ahead_ != nullptr && read_ahead_->offset == pos_ &&
+      static_cast<int64_t>(read_ahead_->buffer.size()) == bytes_to_read) {
+    read_ahead_->done.WaitForNotification();
+    // A short read ahead is read again, as the file may have grown since.
+    if (read_ahead_->status.ok()) {
+      std::swap(*result, read_ahead_->buffer);
+      read_ahead_ = nullptr;
+      pos_ += bytes_to_read;
+      StartReadAhead(bytes_to_read);
+      return OkStatus();
+    }
+  }
+  DropReadAhead();
   result->clear();
   result->resize_uninitialized(bytes_to_read);
   char* result_buffer = &(*result)[0];
@@ -47,6 +104,9 @@ Status RandomAccessInputStream::ReadNBytes(int64_t bytes_to_read,
   if (s.ok() || errors::IsOutOfRange(s)) {
     pos_ += data.size();
   }
+  if (s.ok() && read_ahead_enabled_ && bytes_to_read >= kMinReadAheadBytes) {
+    StartReadAhead(bytes_to_read);
+  }
   return s;
 }
 
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_RANDOM_INPUTSTREAM_H_
 #define TENSORFLOW_TSL_LIB_IO_RANDOM_INPUTSTREAM_H_
 
+#include <memory>
+
 #include "tensorflow/tsl/lib/io/inputstream_interface.h"
 #include "tensorflow/tsl/platform/cord.h"
 #include "tensorflow/tsl/platform/file_system.h"
@@ -25,6 +27,11 @@ namespace io {
 
 // Wraps a RandomAccessFile in an InputStreamInterface. A given instance of
 // RandomAccessInputStream is NOT safe for concurrent use by multiple threads.
+//
+// If the file supports asynchronous reads (see
+// RandomAccessFile::SupportsAsyncRead), each large read into a tstring starts
+// reading the same number of bytes that follow it, so that sequential readers
+// such as BufferedInputStream find the data ready on their next read.
 class RandomAccessInputStream : public InputStreamInterface {
  public:
   // Does not take ownership of 'file' unless owns_file is set to true. 'file'
@@ -51,9 +58,19 @@ class RandomAccessInputStream : public InputStreamInterface {
   Status Reset() override { return Seek(0); }
 
  private:
+  struct ReadAhead;
+
+  // Starts reading `bytes_to_read` bytes at pos_ into read_ahead_.
+  void StartReadAhead(int64_t bytes_to_read);
+
+  // Waits for the read ahead in flight, if any, and drops it.
+  void DropReadAhead();
+
   RandomAccessFile* file_;  // Not owned.
   int64_t pos_ = 0;         // Tracks where we are in the file.
   bool owns_file_ = false;
+  const bool read_ahead_enabled_;
+  std::shared_ptr<ReadAhead> read_ahead_;
 };
 
 }  // namespace io
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/tsl/lib/io/random_inputstream.h"
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+
 #include "tensorflow/tsl/lib/core/status_test_util.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/test.h"
@@ -142,6 +147,70 @@ TEST(RandomInputStream, Seek) {
   EXPECT_EQ(5, in.Tell());
 }
 
+// Reads asynchronously on the threads of Env::Default().
+class AsyncReadFile : public RandomAccessFile {
+ public:
+  explicit AsyncReadFile(std::unique_ptr<RandomAccessFile> file)
+      : file_(std::move(file)) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    return file_->Read(offset, n, result, scratch);
+  }
+
+  void ReadAsync(
+      uint64 offset, size_t n, char* scratch,
+      std::function<void(const Status&, StringPiece)> done) const override {
+    ++num_async_reads_;
+    Env::Default()->SchedClosure([this, offset, n, scratch, done]() {
+      StringPiece result;
+      Status s = file_->Read(offset, n, &result, scratch);
+      done(s, result);
+    });
+  }
+
+  bool SupportsAsyncRead() const override { return true; }
+
+  int num_async_reads() const { return num_async_reads_; }
+
+ private:
+  std::unique_ptr<RandomAccessFile> file_;
+  mutable std::atomic<int> num_async_reads_{0};
+};
+
+TEST(RandomInputStream, ReadAhead) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/random_inputbuffer_read_ahead_test";
+  const int64_t kChunk = 64 * 1024;
+  string contents(3 * kChunk + 10, ' ');
+  for (size_t i = 0; i < contents.size(); ++i) contents[i] = 'a' + i % 26;
+  TF_ASSERT_OK(WriteStringToFile(env, fname, contents));
+
+  std::unique_ptr<RandomAccessFile> base_file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &base_file));
+  AsyncReadFile file(std::move(base_file));
+  tstring read;
+  RandomAccessInputStream in(&file);
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(in.ReadNBytes(kChunk, &read));
+    EXPECT_EQ(read, contents.substr(i * kChunk, kChunk));
+    EXPECT_EQ((i + 1) * kChunk, in.Tell());
+  }
+  EXPECT_EQ(3, file.num_async_reads());
+
+  // The short read ahead at the end of the file is read again.
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(kChunk, &read)));
+  EXPECT_EQ(read, contents.substr(3 * kChunk));
+  EXPECT_EQ(static_cast<int64_t>(contents.size()), in.Tell());
+
+  // Reads elsewhere drop the read ahead.
+  TF_ASSERT_OK(in.Seek(1));
+  TF_ASSERT_OK(in.ReadNBytes(kChunk, &read));
+  EXPECT_EQ(read, contents.substr(1, kChunk));
+  TF_ASSERT_OK(in.ReadNBytes(3, &read));
+  EXPECT_EQ(read, contents.substr(kChunk + 1, 3));
+}
+
 }  // anonymous namespace
 }  // namespace io
 }  // namespace tsl
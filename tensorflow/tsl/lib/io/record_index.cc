@@ -0,0 +1,102 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/record_index.h"
+
+#include "tensorflow/tsl/lib/hash/crc32c.h"
+#include "tensorflow/tsl/platform/coding.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/platform/raw_coding.h"
+#include "tensorflow/tsl/platform/strcat.h"
+
+namespace tsl {
+namespace io {
+
+void RecordIndex::AddRecord(uint64 offset, uint64 end, uint32 masked_crc) {
+  DCHECK_GE(offset, file_size_);
+  DCHECK_GT(end, offset);
+  offsets_.push_back(offset);
+  masked_crcs_.push_back(masked_crc);
+  file_size_ = end;
+}
+
+void RecordIndex::GetRecordRange(int64_t i, uint64* start, uint64* end) const {
+  DCHECK_GE(i, 0);
+  DCHECK_LT(i, num_records());
+  *start = offsets_[i];
+  *end = i + 1 < num_records() ? offsets_[i + 1] : file_size_;
+}
+
+void RecordIndex::Encode(string* output) const {
+  output->clear();
+  output->reserve(offsets_.size() * kEntrySize + kFooterSize);
+  for (size_t i = 0; i < offsets_.size(); ++i) {
+    core::PutFixed64(output, offsets_[i]);
+    core::PutFixed32(output, masked_crcs_[i]);
+  }
+  core::PutFixed64(output, file_size_);
+  core::PutFixed64(output, offsets_.size());
+  core::PutFixed32(output,
+                   crc32c::Mask(crc32c::Value(output->data(), output->size())));
+  core::PutFixed64(output, kMagic);
+}
+
+Status RecordIndex::Decode(StringPiece input) {
+  if (input.size() < kFooterSize) {
+    return errors::DataLoss("record index too short: ", input.size());
+  }
+  const char* footer = input.data() + input.size() - kFooterSize;
+  if (core::DecodeFixed64(footer + 20) != kMagic) {
+    return errors::DataLoss("not a record index");
+  }
+  const uint64 file_size = core::DecodeFixed64(footer);
+  const uint64 num_records = core::DecodeFixed64(footer + 8);
+  if (num_records != (input.size() - kFooterSize) / kEntrySize ||
+      (input.size() - kFooterSize) % kEntrySize != 0) {
+    return errors::DataLoss("record index has an invalid size: ", input.size(),
+                            " bytes for ", num_records, " records");
+  }
+  const uint32 masked_crc = core::DecodeFixed32(footer + 16);
+  if (crc32c::Unmask(masked_crc) !=
+      crc32c::Value(input.data(), input.size() - sizeof(uint32) -
+                                      sizeof(uint64))) {
+    return errors::DataLoss("corrupted record index");
+  }
+
+  offsets_.resize(num_records);
+  masked_crcs_.resize(num_records);
+  const char* p = input.data();
+  for (uint64 i = 0; i < num_records; ++i, p += kEntrySize) {
+    offsets_[i] = core::DecodeFixed64(p);
+    masked_crcs_[i] = core::DecodeFixed32(p + sizeof(uint64));
+    const uint64 end = i + 1 < num_records ? core::DecodeFixed64(p + kEntrySize)
+                                           : file_size;
+    if (end <= offsets_[i]) {
+      offsets_.clear();
+      masked_crcs_.clear();
+      return errors::DataLoss("record index has unordered offsets");
+    }
+  }
+  file_size_ = file_size;
+  return OkStatus();
+}
+
+string RecordIndexFilename(const string& filename) {
+  return strings::StrCat(filename, ".index");
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,83 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_RECORD_INDEX_H_
+#define TENSORFLOW_TSL_LIB_IO_RECORD_INDEX_H_
+
+#include <vector>
+
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/stringpiece.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// Index of the records of an uncompressed TFRecord file, which allows reading
+// the record at any position without scanning the file. It is stored in a
+// sidecar file next to the TFRecord file, see RecordIndexFilename().
+//
+// Format of an index file:
+//  for each record:
+//    uint64  offset of the record in the TFRecord file
+//    uint32  masked crc of the record data
+//  uint64    size of the indexed TFRecord file
+//  uint64    number of records
+//  uint32    masked crc of all the preceding bytes
+//  uint64    magic number
+class RecordIndex {
+ public:
+  static constexpr size_t kEntrySize = sizeof(uint64) + sizeof(uint32);
+  static constexpr size_t kFooterSize =
+      sizeof(uint64) + sizeof(uint64) + sizeof(uint32) + sizeof(uint64);
+  static constexpr uint64 kMagic = 0x7466726563696478ull;  // "tfrecidx"
+
+  RecordIndex() = default;
+
+  // Records that a record whose data has masked crc `masked_crc` starts at
+  // `offset` and ends at `end`. Records must be added in file order.
+  void AddRecord(uint64 offset, uint64 end, uint32 masked_crc);
+
+  int64_t num_records() const { return offsets_.size(); }
+
+  // Size of the indexed file, i.e. the end of its last record.
+  uint64 file_size() const { return file_size_; }
+
+  // Returns the byte range [*start, *end) of record `i`, including its header
+  // and footer. Requires 0 <= i < num_records().
+  void GetRecordRange(int64_t i, uint64* start, uint64* end) const;
+
+  // Returns the masked crc of the data of record `i`.
+  uint32 masked_crc(int64_t i) const { return masked_crcs_[i]; }
+
+  // Serializes the index in the index file format to `*output`.
+  void Encode(string* output) const;
+
+  // Parses an index file. Returns DATA_LOSS if `input` is not a valid index.
+  Status Decode(StringPiece input);
+
+ private:
+  std::vector<uint64> offsets_;
+  std::vector<uint32> masked_crcs_;
+  uint64 file_size_ = 0;
+};
+
+// Returns the name of the index file of the TFRecord file `filename`.
+string RecordIndexFilename(const string& filename);
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_RECORD_INDEX_H_
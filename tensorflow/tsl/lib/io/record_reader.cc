@@ -16,6 +16,10 @@ limitations under the License.
 #include "tensorflow/tsl/lib/io/record_reader.h"
 
 #include <limits.h>
+#include <string.h>
+
+#include <utility>
+#include <vector>
 
 #include "tensorflow/tsl/lib/hash/crc32c.h"
 #include "tensorflow/tsl/lib/io/buffered_inputstream.h"
@@ -46,6 +50,8 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordReaderOptions::ZSTD_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -77,6 +83,10 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(
         new SnappyInputStream(input_stream_.release(),
                               options.snappy_options.output_buffer_size, true));
+  } else if (options.compression_type ==
+             RecordReaderOptions::ZSTD_COMPRESSION) {
+    input_stream_.reset(new ZstdInputStream(input_stream_.release(),
+                                            options.zstd_options, true));
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
   } else {
@@ -255,9 +265,178 @@ Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
   return OkStatus();
 }
 
+Status RecordReader::ReadRecords(uint64* offset, int max_records,
+                                 tstring* buffer,
+                                 std::vector<StringPiece>* records) {
+  if (max_records <= 0) {
+    return errors::InvalidArgument("max_records must be positive, got ",
+                                   max_records);
+  }
+  buffer->clear();
+  records->clear();
+  TF_RETURN_IF_ERROR(PositionInputStream(*offset));
+
+  // The data and footer of the records are appended to *buffer, and their
+  // checksums validated once all of them are read. Positions in *buffer are
+  // recorded instead of pointers, as *buffer moves while it grows.
+  std::vector<size_t> positions;
+  std::vector<size_t> lengths;
+  tstring chunk;
+  uint64 record_offset = *offset;
+  Status s;
+  while (static_cast<int>(lengths.size()) < max_records) {
+    // Read header data.
+    s = ReadChecksummed(record_offset, sizeof(uint64), &chunk);
+    if (!s.ok()) break;
+    const uint64 length = core::DecodeFixed64(chunk.data());
+    if (length >= SIZE_MAX - kFooterSize) {
+      s = errors::DataLoss("record size too large at ", record_offset);
+      break;
+    }
+
+    // Read data and footer.
+    s = input_stream_->ReadNBytes(length + kFooterSize, &chunk);
+    if (errors::IsOutOfRange(s)) {
+      s = errors::DataLoss("truncated record at ", record_offset,
+                           "' failed with ", s.error_message());
+    }
+    if (!s.ok()) break;
+    positions.push_back(buffer->size());
+    lengths.push_back(length);
+    buffer->append(chunk.data(), chunk.size());
+    record_offset += kHeaderSize + length + kFooterSize;
+  }
+
+  const int num_read = lengths.size();
+  std::vector<const char*> data(num_read);
+  for (int i = 0; i < num_read; ++i) {
+    data[i] = buffer->data() + positions[i];
+  }
+  std::vector<uint32> crcs(num_read);
+  crc32c::Values(num_read, data.data(), lengths.data(), crcs.data());
+  records->reserve(num_read);
+  for (int i = 0; i < num_read; ++i) {
+    const uint32 masked_crc = core::DecodeFixed32(data[i] + lengths[i]);
+    if (crc32c::Unmask(masked_crc) != crcs[i]) {
+      s = errors::DataLoss("corrupted record at ", *offset + kHeaderSize);
+      break;
+    }
+    records->emplace_back(data[i], lengths[i]);
+    *offset += kHeaderSize + lengths[i] + kFooterSize;
+  }
+
+  if (!s.ok()) {
+    // The input stream is repositioned by the next read.
+    last_read_failed_ = true;
+    if (records->empty()) return s;
+  }
+  return OkStatus();
+}
+
 SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+Status RandomAccessRecordReader::Open(
+    Env* env, const string& filename, bool write_index,
+    std::unique_ptr<RandomAccessRecordReader>* reader) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+
+  RecordIndex index;
+  const string index_filename = RecordIndexFilename(filename);
+  string encoded;
+  Status s = env->FileExists(index_filename);
+  if (s.ok()) s = ReadFileToString(env, index_filename, &encoded);
+  if (s.ok()) s = index.Decode(encoded);
+  if (s.ok() && index.file_size() != file_size) {
+    s = errors::FailedPrecondition("index of ", index.file_size(),
+                                   " bytes does not match file of ",
+                                   file_size, " bytes");
+  }
+  if (!s.ok()) {
+    VLOG(1) << "Indexing " << filename << " as its index cannot be used: "
+            << s;
+    TF_RETURN_IF_ERROR(BuildIndex(file.get(), &index));
+    if (write_index) {
+      index.Encode(&encoded);
+      s = WriteStringToFile(env, index_filename, encoded);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to write index of " << filename << ": " << s;
+      }
+    }
+  }
+  reader->reset(new RandomAccessRecordReader(std::move(file), std::move(index)));
+  return OkStatus();
+}
+
+Status RandomAccessRecordReader::BuildIndex(RandomAccessFile* file,
+                                            RecordIndex* index) {
+  RecordReaderOptions options;
+  options.buffer_size = 256 << 10;
+  RecordReader reader(file, options);
+  *index = RecordIndex();
+  uint64 offset = 0;
+  tstring record;
+  while (true) {
+    const uint64 start = offset;
+    Status s = reader.ReadRecord(&offset, &record);
+    if (errors::IsOutOfRange(s)) break;
+    TF_RETURN_IF_ERROR(s);
+    index->AddRecord(start, offset,
+                     crc32c::Mask(crc32c::Value(record.data(), record.size())));
+  }
+  return OkStatus();
+}
+
+RandomAccessRecordReader::RandomAccessRecordReader(
+    std::unique_ptr<RandomAccessFile> file, RecordIndex index)
+    : file_(std::move(file)), index_(std::move(index)) {}
+
+Status RandomAccessRecordReader::ReadRecord(int64_t i, tstring* record) const {
+  if (i < 0 || i >= index_.num_records()) {
+    return errors::OutOfRange("record ", i, " is out of range [0, ",
+                              index_.num_records(), ")");
+  }
+  uint64 start, end;
+  index_.GetRecordRange(i, &start, &end);
+  const size_t n = end - start;
+  if (n < RecordReader::kHeaderSize + RecordReader::kFooterSize) {
+    return errors::DataLoss("record ", i, " at ", start, " is too short");
+  }
+
+  // Reads the header, data and footer at once, then moves the data to the
+  // front of the buffer.
+  record->resize_uninitialized(n);
+  StringPiece result;
+  Status s = file_->Read(start, n, &result, record->mdata());
+  if (result.size() != n) {
+    if (!s.ok() && !errors::IsOutOfRange(s)) return s;
+    return errors::DataLoss("truncated record at ", start);
+  }
+  if (result.data() != record->data()) {
+    memmove(record->mdata(), result.data(), n);
+  }
+
+  const char* header = record->data();
+  const uint64 length = core::DecodeFixed64(header);
+  if (crc32c::Unmask(core::DecodeFixed32(header + sizeof(uint64))) !=
+          crc32c::Value(header, sizeof(uint64)) ||
+      length != n - RecordReader::kHeaderSize - RecordReader::kFooterSize) {
+    return errors::DataLoss("corrupted record header at ", start);
+  }
+  const char* data = header + RecordReader::kHeaderSize;
+  const uint32 masked_crc = core::DecodeFixed32(data + length);
+  if (masked_crc != index_.masked_crc(i) ||
+      crc32c::Unmask(masked_crc) != crc32c::Value(data, length)) {
+    return errors::DataLoss("corrupted record at ", start);
+  }
+  memmove(record->mdata(), data, length);
+  record->resize(length);
+  return OkStatus();
+}
+
 }  // namespace io
 }  // namespace tsl
@@ -16,7 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 
+#include <memory>
+#include <vector>
+
 #include "tensorflow/tsl/lib/io/inputstream_interface.h"
+#include "tensorflow/tsl/lib/io/record_index.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
 #if !defined(IS_SLIM_BUILD)
@@ -24,11 +28,14 @@ limitations under the License.
 #include "tensorflow/tsl/lib/io/snappy/snappy_inputstream.h"
 #include "tensorflow/tsl/lib/io/zlib_compression_options.h"
 #include "tensorflow/tsl/lib/io/zlib_inputstream.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_inputstream.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/tsl/platform/macros.h"
 #include "tensorflow/tsl/platform/types.h"
 
 namespace tsl {
+class Env;
 class RandomAccessFile;
 
 namespace io {
@@ -37,7 +44,8 @@ struct RecordReaderOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    ZSTD_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
@@ -53,6 +61,7 @@ struct RecordReaderOptions {
   // Options specific to compression.
   ZlibCompressionOptions zlib_options;
   SnappyCompressionOptions snappy_options;
+  ZstdCompressionOptions zstd_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -103,6 +112,19 @@ class RecordReader {
   // are actually skipped. It should be equal to num_to_skip on success.
   Status SkipRecords(uint64* offset, int num_to_skip, int* num_skipped);
 
+  // Read up to max_records records starting at "*offset" into *buffer, set
+  // *records to the data of the records, which are slices of *buffer, and
+  // update *offset to point to the offset of the next record. The checksums
+  // of the data of the records are validated together, which is faster than
+  // ReadRecord() for small records, and records are not allocated one by one.
+  //
+  // Returns OK if at least one record was read. Reading stops before an error
+  // if records were read before it, so that the next call returns it. Returns
+  // OUT_OF_RANGE for end of file, or something else for an error, if no record
+  // was read.
+  Status ReadRecords(uint64* offset, int max_records, tstring* buffer,
+                     std::vector<StringPiece>* records);
+
   // Return the metadata of the Record file.
   //
   // The current implementation scans the file to completion,
@@ -154,6 +176,13 @@ class SequentialRecordReader {
     return underlying_.SkipRecords(&offset_, num_to_skip, num_skipped);
   }
 
+  // Read up to max_records next records of the file into *buffer, and set
+  // *records to their data. See RecordReader::ReadRecords().
+  Status ReadRecords(int max_records, tstring* buffer,
+                     std::vector<StringPiece>* records) {
+    return underlying_.ReadRecords(&offset_, max_records, buffer, records);
+  }
+
   // Return the current offset in the file.
   uint64 TellOffset() { return offset_; }
 
@@ -173,6 +202,40 @@ class SequentialRecordReader {
   uint64 offset_ = 0;
 };
 
+// Reads the records of an uncompressed TFRecord file by position, using a
+// RecordIndex of the file. Reading a record costs a single read of the file.
+//
+// Thread-safe.
+class RandomAccessRecordReader {
+ public:
+  // Opens the TFRecord file `filename` for random access. Uses the index in
+  // RecordIndexFilename(filename) if there is a valid one for the current
+  // contents of the file, and otherwise indexes the file by scanning it. In
+  // the latter case the index is also written to RecordIndexFilename(filename)
+  // if `write_index` is true, so that the next Open() does not scan the file.
+  static Status Open(Env* env, const string& filename, bool write_index,
+                     std::unique_ptr<RandomAccessRecordReader>* reader);
+
+  // Indexes the records of `file` by scanning it.
+  static Status BuildIndex(RandomAccessFile* file, RecordIndex* index);
+
+  // Creates a reader of `file` with index `index`.
+  RandomAccessRecordReader(std::unique_ptr<RandomAccessFile> file,
+                           RecordIndex index);
+
+  int64_t num_records() const { return index_.num_records(); }
+
+  // Reads the record at position `i` into *record. Returns OK on success,
+  // OUT_OF_RANGE if there is no such record, or something else for an error.
+  Status ReadRecord(int64_t i, tstring* record) const;
+
+ private:
+  const std::unique_ptr<RandomAccessFile> file_;
+  const RecordIndex index_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RandomAccessRecordReader);
+};
+
 }  // namespace io
 }  // namespace tsl
 
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <zlib.h>
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -233,6 +234,89 @@ TEST(RecordReaderWriterTest, TestSkipOutOfRange) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestReadRecords) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_read_records_test";
+  std::vector<string> records;
+  for (int i = 0; i < 10; ++i) {
+    records.push_back(string(i * 7, 'a' + i));
+  }
+
+  for (auto buf_size : BufferSizes()) {
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+      io::RecordWriter writer(file.get());
+      for (const string& record : records) {
+        TF_EXPECT_OK(writer.WriteRecord(record));
+      }
+      TF_CHECK_OK(writer.Flush());
+    }
+
+    {
+      std::unique_ptr<RandomAccessFile> read_file;
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReaderOptions options;
+      options.buffer_size = buf_size;
+      io::SequentialRecordReader reader(read_file.get(), options);
+      tstring buffer;
+      std::vector<StringPiece> got;
+      for (int i = 0; i < records.size(); i += 3) {
+        TF_ASSERT_OK(reader.ReadRecords(3, &buffer, &got));
+        ASSERT_EQ(got.size(), std::min<int>(3, records.size() - i));
+        for (int j = 0; j < got.size(); ++j) {
+          EXPECT_EQ(got[j], records[i + j]);
+        }
+      }
+      EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecords(3, &buffer, &got)));
+      EXPECT_TRUE(got.empty());
+    }
+  }
+}
+
+TEST(RecordReaderWriterTest, TestReadRecordsStopsAtCorruptedRecord) {
+  Env* env = Env::Default();
+  string fname =
+      testing::TmpDir() + "/record_reader_writer_read_corrupted_records_test";
+  string contents;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (int i = 0; i < 4; ++i) {
+      TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record", i)));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+  TF_CHECK_OK(ReadFileToString(env, fname, &contents));
+  // Flips a byte of the data of the third record.
+  const size_t record_size = io::RecordReader::kHeaderSize + 7 +
+                             io::RecordReader::kFooterSize;
+  contents[2 * record_size + io::RecordReader::kHeaderSize] ^= 1;
+  TF_CHECK_OK(WriteStringToFile(env, fname, contents));
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  uint64 offset = 0;
+  tstring buffer;
+  std::vector<StringPiece> got;
+  TF_ASSERT_OK(reader.ReadRecords(&offset, 10, &buffer, &got));
+  ASSERT_EQ(got.size(), 2);
+  EXPECT_EQ(got[0], "record0");
+  EXPECT_EQ(got[1], "record1");
+  EXPECT_EQ(offset, 2 * record_size);
+  Status s = reader.ReadRecords(&offset, 10, &buffer, &got);
+  EXPECT_EQ(error::DATA_LOSS, s.code()) << s;
+  EXPECT_EQ(offset, 2 * record_size);
+  // The records after the corrupted one can still be read.
+  offset += record_size;
+  TF_ASSERT_OK(reader.ReadRecords(&offset, 10, &buffer, &got));
+  ASSERT_EQ(got.size(), 1);
+  EXPECT_EQ(got[0], "record3");
+}
+
 TEST(RecordReaderWriterTest, TestMalformedInput) {
   Env* env = Env::Default();
   string fname =
@@ -343,6 +427,47 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestZstd) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_zstd_test";
+  const string dictionary = "abcdefg0123456789";
+
+  for (auto buf_size : BufferSizes()) {
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+      io::RecordWriterOptions options =
+          io::RecordWriterOptions::CreateRecordWriterOptions("ZSTD");
+      options.zstd_options.output_buffer_size = buf_size;
+      options.zstd_options.compression_level = 9;
+      options.zstd_options.dictionary = dictionary;
+      io::RecordWriter writer(file.get(), options);
+      TF_EXPECT_OK(writer.WriteRecord("abc"));
+      TF_EXPECT_OK(writer.WriteRecord("defg"));
+      TF_CHECK_OK(writer.Close());
+    }
+
+    {
+      std::unique_ptr<RandomAccessFile> read_file;
+      // Read it back with the RecordReader.
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReaderOptions options =
+          io::RecordReaderOptions::CreateRecordReaderOptions("ZSTD");
+      options.zstd_options.input_buffer_size = buf_size;
+      options.zstd_options.dictionary = dictionary;
+      io::RecordReader reader(read_file.get(), options);
+      uint64 offset = 0;
+      tstring record;
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("abc", record);
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("defg", record);
+      EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+    }
+  }
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
@@ -366,4 +491,62 @@ TEST(RecordReaderWriterTest, TestUseAfterClose) {
   }
 }
 
+TEST(RecordReaderWriterTest, RandomAccess) {
+  Env* env = Env::Default();
+  const string fname = testing::TmpDir() + "/random_access_test";
+  const string index_fname = io::RecordIndexFilename(fname);
+  std::vector<string> records;
+  for (int i = 0; i < 100; ++i) records.push_back(string(i * 7, 'a' + i % 26));
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_ASSERT_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriterOptions options;
+    options.build_index = true;
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_ASSERT_OK(writer.WriteRecord(record));
+    }
+    TF_ASSERT_OK(writer.Close());
+    TF_ASSERT_OK(file->Close());
+
+    std::unique_ptr<WritableFile> index_file;
+    TF_ASSERT_OK(env->NewWritableFile(index_fname, &index_file));
+    TF_ASSERT_OK(writer.WriteIndex(index_file.get()));
+    TF_ASSERT_OK(index_file->Close());
+  }
+
+  auto verify = [&]() {
+    std::unique_ptr<io::RandomAccessRecordReader> reader;
+    TF_ASSERT_OK(io::RandomAccessRecordReader::Open(env, fname,
+                                                    /*write_index=*/true,
+                                                    &reader));
+    ASSERT_EQ(reader->num_records(), records.size());
+    tstring record;
+    for (int i : {99, 0, 50, 1, 98, 13}) {
+      TF_ASSERT_OK(reader->ReadRecord(i, &record));
+      EXPECT_EQ(records[i], string(record));
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader->ReadRecord(100, &record)));
+  };
+
+  // With the index written by the writer.
+  verify();
+  string written_index;
+  TF_ASSERT_OK(ReadFileToString(env, index_fname, &written_index));
+
+  // Without an index, the file is scanned and the same index written.
+  TF_ASSERT_OK(env->DeleteFile(index_fname));
+  verify();
+  string built_index;
+  TF_ASSERT_OK(ReadFileToString(env, index_fname, &built_index));
+  EXPECT_EQ(written_index, built_index);
+
+  // A corrupted index is not used.
+  TF_ASSERT_OK(WriteStringToFile(env, index_fname,
+                                 written_index.substr(
+                                     io::RecordIndex::kEntrySize)));
+  verify();
+}
+
 }  // namespace tsl
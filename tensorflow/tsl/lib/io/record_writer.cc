@@ -19,6 +19,8 @@ limitations under the License.
 #include "tensorflow/tsl/lib/io/compression.h"
 #include "tensorflow/tsl/platform/coding.h"
 #include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/raw_coding.h"
 
 namespace tsl {
 namespace io {
@@ -30,6 +32,10 @@ bool IsZlibCompressed(const RecordWriterOptions& options) {
 bool IsSnappyCompressed(const RecordWriterOptions& options) {
   return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
 }
+
+bool IsZstdCompressed(const RecordWriterOptions& options) {
+  return options.compression_type == RecordWriterOptions::ZSTD_COMPRESSION;
+}
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
@@ -49,6 +55,8 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordWriterOptions::ZSTD_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -79,12 +87,25 @@ RecordWriter::RecordWriter(WritableFile* dest,
     dest_ =
         new SnappyOutputBuffer(dest, options.snappy_options.input_buffer_size,
                                options.snappy_options.output_buffer_size);
+  } else if (IsZstdCompressed(options)) {
+    ZstdOutputBuffer* zstd_output_buffer =
+        new ZstdOutputBuffer(dest, options.zstd_options);
+    Status s = zstd_output_buffer->Init();
+    if (!s.ok()) {
+      LOG(FATAL) << "Failed to initialize Zstd outputbuffer. Error: "
+                 << s.ToString();
+    }
+    dest_ = zstd_output_buffer;
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
   } else {
     LOG(FATAL) << "Unspecified compression type :" << options.compression_type;
   }
 #endif
+  if (options.build_index &&
+      options.compression_type != RecordWriterOptions::NONE) {
+    LOG(FATAL) << "Records of compressed files cannot be indexed.";
+  }
 }
 
 RecordWriter::~RecordWriter() {
@@ -112,7 +133,9 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  RecordWritten(data.size(), footer);
+  return OkStatus();
 }
 
 #if defined(TF_CORD_SUPPORT)
@@ -132,13 +155,16 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  RecordWritten(data.size(), footer);
+  return OkStatus();
 }
 #endif
 
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return OkStatus();
-  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
+  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_) ||
+      IsZstdCompressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
@@ -147,6 +173,24 @@ Status RecordWriter::Close() {
   return OkStatus();
 }
 
+Status RecordWriter::WriteIndex(WritableFile* index_file) {
+  if (!options_.build_index) {
+    return errors::FailedPrecondition(
+        "Writer was not created with the build_index option");
+  }
+  string encoded;
+  index_.Encode(&encoded);
+  return index_file->Append(encoded);
+}
+
+void RecordWriter::RecordWritten(size_t n, const char* footer) {
+  const uint64 end = offset_ + kHeaderSize + n + kFooterSize;
+  if (options_.build_index) {
+    index_.AddRecord(offset_, end, core::DecodeFixed32(footer));
+  }
+  offset_ = end;
+}
+
 Status RecordWriter::Flush() {
   if (dest_ == nullptr) {
     return Status(::tensorflow::error::FAILED_PRECONDITION,
@@ -20,11 +20,14 @@ limitations under the License.
 #include "tensorflow/tsl/platform/coding.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
+#include "tensorflow/tsl/lib/io/record_index.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/tsl/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/tsl/lib/io/snappy/snappy_outputbuffer.h"
 #include "tensorflow/tsl/lib/io/zlib_compression_options.h"
 #include "tensorflow/tsl/lib/io/zlib_outputbuffer.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_outputbuffer.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/tsl/platform/cord.h"
 #include "tensorflow/tsl/platform/macros.h"
@@ -41,10 +44,15 @@ struct RecordWriterOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    ZSTD_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
+  // If true, the writer indexes the records it writes so that the index can
+  // be written with RecordWriter::WriteIndex(). Requires NONE compression.
+  bool build_index = false;
+
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
@@ -52,6 +60,7 @@ struct RecordWriterOptions {
   // Options specific to compression.
   io::ZlibCompressionOptions zlib_options;
   io::SnappyCompressionOptions snappy_options;
+  io::ZstdCompressionOptions zstd_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -94,6 +103,12 @@ class RecordWriter {
   // are invalid.
   Status Close();
 
+  // Writes the index of the records written so far to `index_file`, which is
+  // usually the file named RecordIndexFilename() of the TFRecord file. The
+  // index lets RandomAccessRecordReader read the file without scanning it.
+  // Requires the `build_index` option. Does *not* close `index_file`.
+  Status WriteIndex(WritableFile* index_file);
+
   // Utility method to populate TFRecord headers.  Populates record-header in
   // "header[0,kHeaderSize-1]".  The record-header is based on data[0, n-1].
   inline static void PopulateHeader(char* header, const char* data, size_t n);
@@ -111,8 +126,16 @@ class RecordWriter {
 #endif
 
  private:
+  // Advances `offset_` past a record of `n` bytes with footer `footer` that
+  // was just written, and indexes it if requested.
+  void RecordWritten(size_t n, const char* footer);
+
   WritableFile* dest_;
   RecordWriterOptions options_;
+  // Offset of the next record, and the index of the records written so far
+  // if `options_.build_index` is set.
+  uint64 offset_ = 0;
+  RecordIndex index_;
 
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
@@ -0,0 +1,157 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/zstd/zstd_inputstream.h"
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/tsl/platform/errors.h"
+
+namespace tsl {
+namespace io {
+
+void ZstdInputStream::DCtxDeleter::operator()(ZSTD_DCtx* dctx) const {
+  ZSTD_freeDCtx(dctx);
+}
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 const ZstdCompressionOptions& zstd_options,
+                                 bool owns_input_stream)
+    : input_stream_(input_stream),
+      zstd_options_(zstd_options),
+      owns_input_stream_(owns_input_stream),
+      input_buffer_(new char[zstd_options.input_buffer_size]),
+      output_buffer_(new char[zstd_options.output_buffer_size]),
+      dctx_(ZSTD_createDCtx()) {
+  if (!dctx_) {
+    init_status_ = errors::ResourceExhausted("Failed to create a zstd context");
+  } else if (!zstd_options_.dictionary.empty()) {
+    const size_t result =
+        ZSTD_DCtx_loadDictionary(dctx_.get(), zstd_options_.dictionary.data(),
+                                 zstd_options_.dictionary.size());
+    if (ZSTD_isError(result)) {
+      init_status_ = errors::InvalidArgument("Failed to load zstd dictionary: ",
+                                             ZSTD_getErrorName(result));
+    }
+  }
+}
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 const ZstdCompressionOptions& zstd_options)
+    : ZstdInputStream(input_stream, zstd_options, false) {}
+
+ZstdInputStream::~ZstdInputStream() {
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status ZstdInputStream::ReadFromStream() {
+  tstring data;
+  Status s =
+      input_stream_->ReadNBytes(zstd_options_.input_buffer_size, &data);
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  // Only OUT_OF_RANGE if no new data has been read.
+  if (data.empty()) {
+    if (!at_frame_end_) {
+      return errors::DataLoss("Truncated zstd data");
+    }
+    return errors::OutOfRange("EOF reached");
+  }
+  memcpy(input_buffer_.get(), data.data(), data.size());
+  input_pos_ = 0;
+  input_size_ = data.size();
+  return OkStatus();
+}
+
+Status ZstdInputStream::Decompress() {
+  ZSTD_inBuffer input = {input_buffer_.get(), input_size_, input_pos_};
+  ZSTD_outBuffer output = {output_buffer_.get(),
+                           static_cast<size_t>(zstd_options_.output_buffer_size),
+                           0};
+  const size_t result = ZSTD_decompressStream(dctx_.get(), &output, &input);
+  if (ZSTD_isError(result)) {
+    return errors::DataLoss("ZSTD_decompressStream() failed: ",
+                            ZSTD_getErrorName(result));
+  }
+  input_pos_ = input.pos;
+  output_pos_ = 0;
+  output_size_ = output.pos;
+  output_buffer_filled_ = output.pos == output.size;
+  at_frame_end_ = result == 0;
+  return OkStatus();
+}
+
+size_t ZstdInputStream::ReadBytesFromCache(size_t bytes_to_read,
+                                           tstring* result) {
+  const size_t can_read_bytes =
+      std::min(bytes_to_read, output_size_ - output_pos_);
+  if (can_read_bytes > 0) {
+    result->append(output_buffer_.get() + output_pos_, can_read_bytes);
+    output_pos_ += can_read_bytes;
+  }
+  bytes_read_ += can_read_bytes;
+  return can_read_bytes;
+}
+
+Status ZstdInputStream::ReadNBytes(int64_t bytes_to_read, tstring* result) {
+  TF_RETURN_IF_ERROR(init_status_);
+  result->clear();
+  // Read as many bytes as possible from cache.
+  bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+
+  while (bytes_to_read > 0) {
+    // The cache is empty, so decompress more data, reading more compressed
+    // data first unless zstd still has buffered input or output.
+    if (input_pos_ == input_size_ && !output_buffer_filled_) {
+      TF_RETURN_IF_ERROR(ReadFromStream());
+    }
+    TF_RETURN_IF_ERROR(Decompress());
+    bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+  }
+  return OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZstdInputStream::ReadNBytes(int64_t bytes_to_read, absl::Cord* result) {
+  tstring buf;
+  TF_RETURN_IF_ERROR(ReadNBytes(bytes_to_read, &buf));
+  result->Clear();
+  result->Append(absl::string_view(buf.data(), buf.size()));
+  return OkStatus();
+}
+#endif
+
+int64_t ZstdInputStream::Tell() const { return bytes_read_; }
+
+Status ZstdInputStream::Reset() {
+  TF_RETURN_IF_ERROR(init_status_);
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  ZSTD_DCtx_reset(dctx_.get(), ZSTD_reset_session_only);
+  input_pos_ = input_size_ = 0;
+  output_pos_ = output_size_ = 0;
+  output_buffer_filled_ = false;
+  at_frame_end_ = true;
+  bytes_read_ = 0;
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,118 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
+
+#include <memory>
+
+#include "tensorflow/tsl/lib/io/inputstream_interface.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/types.h"
+
+struct ZSTD_DCtx_s;
+
+namespace tsl {
+namespace io {
+
+// An InputStreamInterface that decompresses zstd data read from another
+// InputStreamInterface. The data may consist of several zstd frames.
+class ZstdInputStream : public InputStreamInterface {
+ public:
+  // Creates a ZstdInputStream for `input_stream` that reads compressed data
+  // in chunks of `zstd_options.input_buffer_size` bytes and caches up to
+  // `zstd_options.output_buffer_size` bytes of decompressed data.
+  //
+  // Takes ownership of `input_stream` iff `owns_input_stream` is true.
+  ZstdInputStream(InputStreamInterface* input_stream,
+                  const ZstdCompressionOptions& zstd_options,
+                  bool owns_input_stream);
+
+  // Equivalent to the previous constructor with owns_input_stream = false.
+  ZstdInputStream(InputStreamInterface* input_stream,
+                  const ZstdCompressionOptions& zstd_options);
+
+  ~ZstdInputStream() override;
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:           If successful.
+  // OUT_OF_RANGE: If there are not enough bytes to read before
+  //               the end of the stream.
+  // DATA_LOSS:    If the data is not valid zstd data or ends within a frame.
+  // others:       If reading from stream failed.
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status ReadNBytes(int64_t bytes_to_read, absl::Cord* result) override;
+#endif
+
+  int64_t Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // Reads the next chunk of compressed data from `input_stream_`. Returns
+  // OUT_OF_RANGE at the end of the stream.
+  Status ReadFromStream();
+
+  // Decompresses buffered input into the emptied output buffer.
+  Status Decompress();
+
+  // Appends up to `bytes_to_read` bytes of the decompressed data cache to
+  // `result`. Returns the number of bytes appended.
+  size_t ReadBytesFromCache(size_t bytes_to_read, tstring* result);
+
+  InputStreamInterface* input_stream_;
+  const ZstdCompressionOptions zstd_options_;
+  const bool owns_input_stream_;
+  Status init_status_;
+
+  // Compressed data read from `input_stream_`, of which the bytes
+  // [input_pos_, input_size_) are not yet decompressed.
+  std::unique_ptr<char[]> input_buffer_;
+  size_t input_pos_ = 0;
+  size_t input_size_ = 0;
+
+  // Decompressed data, of which the bytes [output_pos_, output_size_) are not
+  // yet read by the client.
+  std::unique_ptr<char[]> output_buffer_;
+  size_t output_pos_ = 0;
+  size_t output_size_ = 0;
+
+  // Whether the last decompression filled the output buffer, in which case
+  // zstd may have more output without further input.
+  bool output_buffer_filled_ = false;
+  // Whether the data decompressed so far ends at the end of a frame.
+  bool at_frame_end_ = true;
+
+  // Specifies the number of decompressed bytes currently read.
+  int64_t bytes_read_ = 0;
+
+  struct DCtxDeleter {
+    void operator()(ZSTD_DCtx_s* dctx) const;
+  };
+  std::unique_ptr<ZSTD_DCtx_s, DCtxDeleter> dctx_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdInputStream);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
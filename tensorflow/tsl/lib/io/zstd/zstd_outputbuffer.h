@@ -0,0 +1,108 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+#define TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+
+#include <memory>
+
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/stringpiece.h"
+#include "tensorflow/tsl/platform/types.h"
+
+struct ZSTD_CCtx_s;
+
+namespace tsl {
+namespace io {
+
+// Provides support for writing compressed output to file using zstd
+// (https://facebook.github.io/zstd/). The output is a single zstd frame.
+// A given instance of a ZstdOutputBuffer is NOT safe for concurrent use
+// by multiple threads.
+class ZstdOutputBuffer : public WritableFile {
+ public:
+  // Creates a ZstdOutputBuffer for `file` that caches up to
+  // `zstd_options.output_buffer_size` bytes of compressed output.
+  // Does not take ownership of `file`.
+  ZstdOutputBuffer(WritableFile* file,
+                   const ZstdCompressionOptions& zstd_options);
+
+  ~ZstdOutputBuffer() override;
+
+  // Initializes the compression context. This call is required before any
+  // other operation on the buffer.
+  Status Init();
+
+  // Adds `data` to the compression pipeline. zstd buffers the input it needs
+  // to compress a block, and the compressed output is written to file when
+  // the output buffer gets full.
+  Status Append(StringPiece data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses any input buffered by zstd and writes all output to file.
+  Status Flush() override;
+
+  // Ends the zstd frame and writes all output to file. This must be called
+  // before the destructor to avoid any data loss. Does not close the
+  // underlying file.
+  //
+  // After calling this, any further calls to `Append()` or `Flush()` will
+  // fail.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Flushes, then syncs the underlying file.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64_t* position) override;
+
+ private:
+  // Runs the compressor on `data` with end directive `end_op` until all of
+  // `data` is consumed and, unless `end_op` is ZSTD_e_continue, all
+  // compressed output is in the output buffer or the file.
+  Status Compress(StringPiece data, int end_op);
+
+  // Appends the contents of `output_buffer_` to `file_`.
+  Status FlushOutputBufferToFile();
+
+  WritableFile* file_;  // Not owned
+  const ZstdCompressionOptions zstd_options_;
+  std::unique_ptr<char[]> output_buffer_;
+  size_t output_buffer_size_;
+  // Number of bytes of compressed output in `output_buffer_`.
+  size_t output_pos_ = 0;
+
+  struct CCtxDeleter {
+    void operator()(ZSTD_CCtx_s* cctx) const;
+  };
+  std::unique_ptr<ZSTD_CCtx_s, CCtxDeleter> cctx_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdOutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
@@ -0,0 +1,154 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <memory>
+
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/lib/io/random_inputstream.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_inputstream.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_outputbuffer.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/strcat.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+string GenTestString(int copies) {
+  string result;
+  for (int i = 0; i < copies; ++i) {
+    strings::StrAppend(&result, "Lorem ipsum dolor sit amet, record ", i,
+                       ", consectetur adipiscing elit. ");
+  }
+  return result;
+}
+
+// Writes `num_writes` copies of `data` to `fname` and returns what was
+// written, uncompressed.
+string WriteFile(const string& fname, const string& data, int num_writes,
+                 bool with_flush, const ZstdCompressionOptions& options) {
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(Env::Default()->NewWritableFile(fname, &file));
+  ZstdOutputBuffer out(file.get(), options);
+  TF_CHECK_OK(out.Init());
+  string expected;
+  for (int i = 0; i < num_writes; ++i) {
+    TF_CHECK_OK(out.Append(data));
+    if (with_flush) TF_CHECK_OK(out.Flush());
+    expected += data;
+  }
+  TF_CHECK_OK(out.Close());
+  TF_CHECK_OK(file->Close());
+  return expected;
+}
+
+void TestRoundTrip(int64_t input_buffer_size, int64_t output_buffer_size,
+                   int num_writes, bool with_flush, int num_copies) {
+  const string fname = testing::TmpDir() + "/zstd_test";
+  ZstdCompressionOptions options;
+  options.input_buffer_size = input_buffer_size;
+  options.output_buffer_size = output_buffer_size;
+  const string expected = WriteFile(fname, GenTestString(num_copies),
+                                    num_writes, with_flush, options);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  RandomAccessInputStream input_stream(file.get());
+  ZstdInputStream in(&input_stream, options);
+  // Reads the data twice to test Reset().
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    tstring result;
+    size_t pos = 0;
+    while (pos < expected.size()) {
+      const size_t n = std::min<size_t>(1000, expected.size() - pos);
+      TF_ASSERT_OK(in.ReadNBytes(n, &result));
+      ASSERT_EQ(expected.substr(pos, n), string(result));
+      pos += n;
+      EXPECT_EQ(pos, in.Tell());
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+    TF_ASSERT_OK(in.Reset());
+  }
+}
+
+TEST(ZstdBuffers, RoundTrip) {
+  TestRoundTrip(256 << 10, 256 << 10, /*num_writes=*/10, /*with_flush=*/false,
+                /*num_copies=*/100);
+}
+
+TEST(ZstdBuffers, SmallBuffers) {
+  TestRoundTrip(10, 10, /*num_writes=*/10, /*with_flush=*/false,
+                /*num_copies=*/100);
+}
+
+TEST(ZstdBuffers, WithFlush) {
+  TestRoundTrip(100, 200, /*num_writes=*/10, /*with_flush=*/true,
+                /*num_copies=*/10);
+}
+
+TEST(ZstdBuffers, Dictionary) {
+  const string fname = testing::TmpDir() + "/zstd_dictionary_test";
+  ZstdCompressionOptions options;
+  options.dictionary = GenTestString(10);
+  const string expected =
+      WriteFile(fname, GenTestString(3), /*num_writes=*/1,
+                /*with_flush=*/false, options);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  tstring result;
+  {
+    RandomAccessInputStream input_stream(file.get());
+    ZstdInputStream in(&input_stream, options);
+    TF_ASSERT_OK(in.ReadNBytes(expected.size(), &result));
+    EXPECT_EQ(expected, string(result));
+  }
+  {
+    // The data cannot be decompressed without the dictionary.
+    RandomAccessInputStream input_stream(file.get());
+    ZstdInputStream in(&input_stream, ZstdCompressionOptions());
+    EXPECT_TRUE(errors::IsDataLoss(in.ReadNBytes(expected.size(), &result)));
+  }
+}
+
+TEST(ZstdBuffers, Truncated) {
+  const string fname = testing::TmpDir() + "/zstd_truncated_test";
+  const string expected =
+      WriteFile(fname, GenTestString(100), /*num_writes=*/1,
+                /*with_flush=*/false, ZstdCompressionOptions());
+  string compressed;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), fname, &compressed));
+  compressed.pop_back();
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), fname, compressed));
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  RandomAccessInputStream input_stream(file.get());
+  ZstdInputStream in(&input_stream, ZstdCompressionOptions());
+  // Depending on where the data ends, the last bytes may be returned before
+  // the truncation is detected.
+  tstring result;
+  Status s = in.ReadNBytes(expected.size(), &result);
+  if (s.ok()) s = in.ReadNBytes(1, &result);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
@@ -191,6 +191,9 @@ class PhiloxRandom {
   }
 
  private:
+  // Computes the same rounds on many counters at once.
+  friend class PhiloxRandomBatch;
+
   // We use the same constants as recommended by the original paper.
   static constexpr uint32_t kPhiloxW32A = 0x9E3779B9;
   static constexpr uint32_t kPhiloxW32B = 0xBB67AE85;
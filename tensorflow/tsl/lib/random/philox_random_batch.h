@@ -0,0 +1,218 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Computes the Philox stream for many counters at once with SIMD instructions,
+// for filling large buffers with randoms on CPU.
+
+#ifndef TENSORFLOW_TSL_LIB_RANDOM_PHILOX_RANDOM_BATCH_H_
+#define TENSORFLOW_TSL_LIB_RANDOM_PHILOX_RANDOM_BATCH_H_
+
+#include <cstdint>
+
+#include "tensorflow/tsl/lib/random/philox_random.h"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace tsl {
+namespace random {
+
+namespace internal {
+
+// Operations on vectors of uint32_t, one lane per Philox counter. Every
+// implementation defines the vector type V, its number of lanes kLanes, and
+// MulHiLo, which returns the low and high halves of the 64-bit products of
+// the lanes of `a` and `m`.
+
+#if defined(__AVX512F__)
+struct PhiloxLaneOps {
+  using V = __m512i;
+  static constexpr int kLanes = 16;
+  static V Load(const uint32_t* p) { return _mm512_loadu_si512(p); }
+  static void Store(uint32_t* p, V v) { _mm512_storeu_si512(p, v); }
+  static V Set1(uint32_t x) { return _mm512_set1_epi32(static_cast<int>(x)); }
+  static V Xor(V a, V b) { return _mm512_xor_si512(a, b); }
+  static void MulHiLo(V a, V m, V* lo, V* hi) {
+    // _mm512_mul_epu32 multiplies the even lanes into 64-bit products.
+    const V even = _mm512_mul_epu32(a, m);
+    const V odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), m);
+    *lo = _mm512_mullo_epi32(a, m);
+    *hi = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+  }
+};
+#elif defined(__AVX2__)
+struct PhiloxLaneOps {
+  using V = __m256i;
+  static constexpr int kLanes = 8;
+  static V Load(const uint32_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  static void Store(uint32_t* p, V v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+  }
+  static V Set1(uint32_t x) { return _mm256_set1_epi32(static_cast<int>(x)); }
+  static V Xor(V a, V b) { return _mm256_xor_si256(a, b); }
+  static void MulHiLo(V a, V m, V* lo, V* hi) {
+    // _mm256_mul_epu32 multiplies the even lanes into 64-bit products.
+    const V even = _mm256_mul_epu32(a, m);
+    const V odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    *lo = _mm256_mullo_epi32(a, m);
+    *hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+  }
+};
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+struct PhiloxLaneOps {
+  using V = uint32x4_t;
+  static constexpr int kLanes = 4;
+  static V Load(const uint32_t* p) { return vld1q_u32(p); }
+  static void Store(uint32_t* p, V v) { vst1q_u32(p, v); }
+  static V Set1(uint32_t x) { return vdupq_n_u32(x); }
+  static V Xor(V a, V b) { return veorq_u32(a, b); }
+  static void MulHiLo(V a, V m, V* lo, V* hi) {
+    const uint64x2_t low_products = vmull_u32(vget_low_u32(a), vget_low_u32(m));
+    const uint64x2_t high_products =
+        vmull_u32(vget_high_u32(a), vget_high_u32(m));
+    *lo = vmulq_u32(a, m);
+    *hi = vuzp2q_u32(vreinterpretq_u32_u64(low_products),
+                     vreinterpretq_u32_u64(high_products));
+  }
+};
+#else
+// Portable lanes, which compilers can vectorize for other targets.
+struct PhiloxLaneOps {
+  static constexpr int kLanes = 4;
+  struct V {
+    uint32_t lanes[kLanes];
+  };
+  static V Load(const uint32_t* p) {
+    V v;
+    for (int i = 0; i < kLanes; ++i) v.lanes[i] = p[i];
+    return v;
+  }
+  static void Store(uint32_t* p, V v) {
+    for (int i = 0; i < kLanes; ++i) p[i] = v.lanes[i];
+  }
+  static V Set1(uint32_t x) {
+    V v;
+    for (int i = 0; i < kLanes; ++i) v.lanes[i] = x;
+    return v;
+  }
+  static V Xor(V a, V b) {
+    for (int i = 0; i < kLanes; ++i) a.lanes[i] ^= b.lanes[i];
+    return a;
+  }
+  static void MulHiLo(V a, V m, V* lo, V* hi) {
+    for (int i = 0; i < kLanes; ++i) {
+      const uint64_t product = static_cast<uint64_t>(a.lanes[i]) * m.lanes[i];
+      lo->lanes[i] = static_cast<uint32_t>(product);
+      hi->lanes[i] = static_cast<uint32_t>(product >> 32);
+    }
+  }
+};
+#endif
+
+}  // namespace internal
+
+// A generator returning the same stream of samples as the PhiloxRandom it is
+// constructed from, computed kBatchSize samples at a time with SIMD
+// instructions where available. Outputs therefore don't depend on whether, or
+// on which CPU, the batched implementation is used.
+//
+// It computes up to kBatchSize - 1 samples ahead of what is consumed, so it
+// only pays off when many samples are drawn from it.
+class PhiloxRandomBatch {
+ public:
+  using ResultType = PhiloxRandom::ResultType;
+  using ResultElementType = PhiloxRandom::ResultElementType;
+  static constexpr int kResultElementCount = PhiloxRandom::kResultElementCount;
+  static constexpr int kElementCost = PhiloxRandom::kElementCost;
+  // The number of samples computed at a time.
+  static constexpr int kBatchSize = 16;
+  static_assert(kBatchSize % internal::PhiloxLaneOps::kLanes == 0,
+                "kBatchSize must be a multiple of the number of lanes");
+
+  explicit PhiloxRandomBatch(const PhiloxRandom& gen) : gen_(gen) {}
+
+  // Returns the next group of four random numbers, as PhiloxRandom does.
+  ResultType operator()() {
+    if (next_ == kBatchSize) {
+      Generate(&gen_, samples_, kBatchSize);
+      next_ = 0;
+    }
+    return samples_[next_++];
+  }
+
+  // Writes the next `count` samples of `gen` to `output` and skips them, as
+  // `count` calls to `gen` would. `count` must be a multiple of the number of
+  // lanes, which divides kBatchSize.
+  static void Generate(PhiloxRandom* gen, ResultType* output, int count) {
+    using Ops = internal::PhiloxLaneOps;
+    using V = Ops::V;
+    constexpr int kLanes = Ops::kLanes;
+    uint32_t words[4][kLanes];
+    for (int begin = 0; begin < count; begin += kLanes) {
+      // Lays out the counters of the next kLanes samples one word per vector.
+      for (int i = 0; i < kLanes; ++i) {
+        const ResultType& counter = gen->counter();
+        for (int j = 0; j < 4; ++j) {
+          words[j][i] = counter[j];
+        }
+        gen->Skip(1);
+      }
+      V c0 = Ops::Load(words[0]);
+      V c1 = Ops::Load(words[1]);
+      V c2 = Ops::Load(words[2]);
+      V c3 = Ops::Load(words[3]);
+      const V ma = Ops::Set1(PhiloxRandom::kPhiloxM4x32A);
+      const V mb = Ops::Set1(PhiloxRandom::kPhiloxM4x32B);
+      uint32_t k0 = gen->key()[0];
+      uint32_t k1 = gen->key()[1];
+      // The ten rounds of PhiloxRandom::operator(), on every lane.
+      for (int round = 0; round < 10; ++round) {
+        V lo0, hi0, lo1, hi1;
+        Ops::MulHiLo(c0, ma, &lo0, &hi0);
+        Ops::MulHiLo(c2, mb, &lo1, &hi1);
+        c0 = Ops::Xor(Ops::Xor(hi1, c1), Ops::Set1(k0));
+        c1 = lo1;
+        c2 = Ops::Xor(Ops::Xor(hi0, c3), Ops::Set1(k1));
+        c3 = lo0;
+        k0 += PhiloxRandom::kPhiloxW32A;
+        k1 += PhiloxRandom::kPhiloxW32B;
+      }
+      Ops::Store(words[0], c0);
+      Ops::Store(words[1], c1);
+      Ops::Store(words[2], c2);
+      Ops::Store(words[3], c3);
+      for (int i = 0; i < kLanes; ++i) {
+        for (int j = 0; j < 4; ++j) {
+          output[begin + i][j] = words[j][i];
+        }
+      }
+    }
+  }
+
+ private:
+  PhiloxRandom gen_;
+  ResultType samples_[kBatchSize];
+  int next_ = kBatchSize;
+};
+
+}  // namespace random
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_RANDOM_PHILOX_RANDOM_BATCH_H_
@@ -22,6 +22,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "tensorflow/tsl/lib/random/philox_random_batch.h"
 #include "tensorflow/tsl/lib/random/philox_random_test_utils.h"
 #include "tensorflow/tsl/lib/random/random_distributions.h"
 #include "tensorflow/tsl/platform/logging.h"
@@ -69,6 +70,23 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that PhiloxRandomBatch returns the same samples as
+// PhiloxRandom, including across carries between the words of the counter.
+TEST(PhiloxRandomTest, BatchMatchTest) {
+  constexpr int count = 1024;
+
+  PhiloxRandom gen(GetTestSeed(), GetTestSeed());
+  gen.Skip(0xFFFFFFFFull - count / 2);
+  PhiloxRandomBatch batch_gen(gen);
+  for (int i = 0; i < count; ++i) {
+    const PhiloxRandom::ResultType expected = gen();
+    const PhiloxRandom::ResultType actual = batch_gen();
+    for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+      ASSERT_EQ(expected[j], actual[j]) << "sample " << i << ", element " << j;
+    }
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tsl
@@ -56,6 +56,9 @@ PHILOX_DEVICE_INLINE Int SignedAdd(Int a,
 //              actual returned sample type.
 //   RealType: the data type of the real numbers that will be returned by the
 //             distribution. This could be either float or double for now.
+// Samples may also be drawn from any generator returning the same samples as
+// Generator, such as PhiloxRandomBatch for PhiloxRandom. The same holds for
+// UniformFullIntDistribution and NormalDistribution.
 // This class is meant to be implemented through specialization. The default
 // is not defined by design.
 template <class Generator, typename RealType>
@@ -74,8 +77,8 @@ class UniformDistribution<Generator, Eigen::half> {
   typedef Array<Eigen::half, kResultElementCount> ResultType;
   typedef Eigen::half ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -98,8 +101,8 @@ class UniformDistribution<Generator, bfloat16> {
   typedef Array<bfloat16, kResultElementCount> ResultType;
   typedef bfloat16 ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -122,8 +125,8 @@ class UniformDistribution<Generator, float> {
   typedef Array<float, kResultElementCount> ResultType;
   typedef float ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -146,8 +149,8 @@ class UniformDistribution<Generator, double> {
   typedef Array<double, kResultElementCount> ResultType;
   typedef double ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -174,8 +177,8 @@ class UniformDistribution<Generator, int32> {
   UniformDistribution(int32_t lo, int32_t hi)
       : lo_(lo), range_(static_cast<uint32>(hi) - static_cast<uint32>(lo)) {}
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -209,8 +212,8 @@ class UniformDistribution<Generator, int64_t> {
   UniformDistribution(int64_t lo, int64_t hi)
       : lo_(lo), range_(static_cast<uint64>(hi) - static_cast<uint64>(lo)) {}
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -247,8 +250,8 @@ class UniformFullIntDistribution32 {
   typedef Array<IntType, kResultElementCount> ResultType;
   typedef IntType ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -271,8 +274,8 @@ class UniformFullIntDistribution64 {
   typedef Array<IntType, kResultElementCount> ResultType;
   typedef IntType ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -391,8 +394,8 @@ class NormalDistribution<Generator, Eigen::half> {
   typedef Array<Eigen::half, kResultElementCount> ResultType;
   typedef Eigen::half ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
@@ -418,8 +421,8 @@ class NormalDistribution<Generator, bfloat16> {
   typedef Array<bfloat16, kResultElementCount> ResultType;
   typedef bfloat16 ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     static_assert(kResultElementCount % 2 == 0,
@@ -448,8 +451,8 @@ class NormalDistribution<Generator, float> {
   typedef Array<float, kResultElementCount> ResultType;
   typedef float ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
@@ -472,8 +475,8 @@ class NormalDistribution<Generator, double> {
   typedef Array<double, kResultElementCount> ResultType;
   typedef double ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
@@ -0,0 +1,518 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/platform/cloud/disk_file_block_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/tsl/platform/coding.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/hash.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/platform/path.h"
+#include "tensorflow/tsl/platform/raw_coding.h"
+#include "tensorflow/tsl/platform/strcat.h"
+
+namespace tsl {
+namespace {
+
+constexpr char kIndexFileName[] = "index";
+constexpr char kBlockFileSuffix[] = ".blk";
+// Identifies the format of the index file.
+constexpr uint32 kIndexMagic = 0x44464243;
+// The index is saved after this many blocks are added or removed.
+constexpr size_t kIndexSaveInterval = 16;
+
+bool GetFixed64(StringPiece* input, uint64* value) {
+  if (input->size() < sizeof(uint64)) return false;
+  *value = core::DecodeFixed64(input->data());
+  input->remove_prefix(sizeof(uint64));
+  return true;
+}
+
+bool GetString(StringPiece* input, string* value) {
+  uint64 size;
+  if (!core::GetVarint64(input, &size) || input->size() < size) return false;
+  value->assign(input->data(), size);
+  input->remove_prefix(size);
+  return true;
+}
+
+}  // namespace
+
+DiskFileBlockCache::DiskFileBlockCache(size_t block_size, size_t max_bytes,
+                                       const string& cache_dir,
+                                       BlockFetcher block_fetcher, Env* env)
+    : block_size_(block_size),
+      max_bytes_(max_bytes),
+      cache_dir_(cache_dir),
+      block_fetcher_(std::move(block_fetcher)),
+      env_(env) {
+  if (IsCacheEnabled()) {
+    LoadIndex();
+  }
+  VLOG(1) << "GCS file block cache on disk is "
+          << (IsCacheEnabled() ? "enabled" : "disabled");
+}
+
+DiskFileBlockCache::~DiskFileBlockCache() {
+  if (!IsCacheEnabled()) return;
+  Status status = SaveIndex();
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to save the index of the block cache in "
+                 << cache_dir_ << ": " << status;
+  }
+}
+
+string DiskFileBlockCache::BlockPath(uint64 id) const {
+  return io::JoinPath(cache_dir_, strings::StrCat(id, kBlockFileSuffix));
+}
+
+string DiskFileBlockCache::IndexPath() const {
+  return io::JoinPath(cache_dir_, kIndexFileName);
+}
+
+Status DiskFileBlockCache::Read(const string& filename, size_t offset,
+                                size_t n, char* buffer,
+                                size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  if (n == 0) {
+    return OkStatus();
+  }
+  if (!IsCacheEnabled()) {
+    return block_fetcher_(filename, offset, n, buffer, bytes_transferred);
+  }
+  // Calculate the block-aligned start and end of the read.
+  size_t start = block_size_ * (offset / block_size_);
+  size_t finish = block_size_ * ((offset + n) / block_size_);
+  if (finish < offset + n) {
+    finish += block_size_;
+  }
+  size_t total_bytes_transferred = 0;
+  std::vector<char> scratch;
+  for (size_t pos = start; pos < finish; pos += block_size_) {
+    // The blocks inside the range are read into the result buffer directly,
+    // which is the case of all the reads of a RamFileBlockCache.
+    const bool in_range = pos >= offset && pos + block_size_ <= offset + n;
+    char* block_buffer;
+    if (in_range) {
+      block_buffer = buffer + total_bytes_transferred;
+    } else {
+      scratch.resize(block_size_);
+      block_buffer = scratch.data();
+    }
+    size_t block_bytes = 0;
+    TF_RETURN_IF_ERROR(ReadBlock(filename, pos, block_buffer, &block_bytes));
+    if (offset >= pos + block_bytes) {
+      // The requested offset is at or beyond the end of the file.
+      *bytes_transferred = total_bytes_transferred;
+      return errors::OutOfRange("EOF at offset ", offset, " in file ", filename,
+                                " at position ", pos, " with data size ",
+                                block_bytes);
+    }
+    if (in_range) {
+      total_bytes_transferred += block_bytes;
+    } else {
+      const size_t begin = std::max(offset, pos);
+      const size_t end = std::min(offset + n, pos + block_bytes);
+      memcpy(buffer + total_bytes_transferred, block_buffer + (begin - pos),
+             end - begin);
+      total_bytes_transferred += end - begin;
+    }
+    if (block_bytes < block_size_) {
+      // The block was a partial block and thus signals EOF at its upper bound.
+      break;
+    }
+  }
+  *bytes_transferred = total_bytes_transferred;
+  return OkStatus();
+}
+
+Status DiskFileBlockCache::ReadBlock(const string& filename, size_t offset,
+                                     char* buffer, size_t* bytes_transferred) {
+  int64_t signature = 0;
+  bool has_signature;
+  {
+    mutex_lock lock(mu_);
+    auto it = file_signature_map_.find(filename);
+    has_signature = it != file_signature_map_.end();
+    if (has_signature) signature = it->second;
+  }
+  if (!has_signature) {
+    // The contents of the file could not be validated when read back.
+    return block_fetcher_(filename, offset, block_size_, buffer,
+                          bytes_transferred);
+  }
+  const Key key = std::make_pair(filename, offset);
+  if (LookupBlock(key, signature, buffer, bytes_transferred)) {
+    if (cache_stats_ != nullptr) {
+      cache_stats_->RecordCacheHitBlockSize(*bytes_transferred);
+    }
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(block_fetcher_(filename, offset, block_size_, buffer,
+                                    bytes_transferred));
+  if (cache_stats_ != nullptr) {
+    cache_stats_->RecordCacheMissBlockSize(*bytes_transferred);
+  }
+  if (*bytes_transferred > 0 && *bytes_transferred <= max_bytes_) {
+    InsertBlock(key, signature, buffer, *bytes_transferred);
+  }
+  return OkStatus();
+}
+
+bool DiskFileBlockCache::LookupBlock(const Key& key, int64_t signature,
+                                     char* buffer, size_t* size) {
+  Block block;
+  {
+    mutex_lock lock(mu_);
+    auto entry = block_map_.find(key);
+    if (entry == block_map_.end() || entry->second.signature != signature) {
+      return false;
+    }
+    block = entry->second;
+    if (block.lru_iterator != lru_list_.begin()) {
+      lru_list_.erase(block.lru_iterator);
+      lru_list_.push_front(key);
+      entry->second.lru_iterator = lru_list_.begin();
+    }
+  }
+  // The block file is read without holding mu_. Block files are never
+  // rewritten, so the file is either the block or missing if the block was
+  // evicted in the meantime.
+  std::unique_ptr<RandomAccessFile> file;
+  Status status = env_->NewRandomAccessFile(BlockPath(block.id), &file);
+  StringPiece data;
+  if (status.ok()) {
+    status = file->Read(0, block.size, &data, buffer);
+  }
+  if (status.ok() && data.size() != block.size) {
+    status = errors::DataLoss("Truncated block file");
+  }
+  if (status.ok() && data.data() != buffer) {
+    memmove(buffer, data.data(), data.size());
+  }
+  if (status.ok() && Hash64(buffer, block.size) != block.hash) {
+    status = errors::DataLoss("Block contents do not match their hash");
+  }
+  if (status.ok()) {
+    *size = block.size;
+    return true;
+  }
+  VLOG(1) << "Failed to read the cached block of " << key.first << " @ "
+          << key.second << " from " << BlockPath(block.id) << ": " << status;
+  std::vector<string> removed_paths;
+  {
+    mutex_lock lock(mu_);
+    auto entry = block_map_.find(key);
+    if (entry != block_map_.end() && entry->second.id == block.id) {
+      RemoveBlock(entry, &removed_paths);
+    }
+  }
+  DeleteBlockFiles(removed_paths);
+  return false;
+}
+
+void DiskFileBlockCache::InsertBlock(const Key& key, int64_t signature,
+                                     const char* data, size_t size) {
+  uint64 id;
+  {
+    mutex_lock lock(mu_);
+    id = next_id_++;
+  }
+  // The block file is written before the block is added to the index, so that
+  // the index only lists complete block files.
+  const string path = BlockPath(id);
+  Status status = WriteStringToFile(env_, path, StringPiece(data, size));
+  if (!status.ok()) {
+    LOG_EVERY_N(WARNING, 100)
+        << "Failed to write the block of " << key.first << " @ " << key.second
+        << " to " << path << ": " << status;
+    env_->DeleteFile(path).IgnoreError();
+    return;
+  }
+  std::vector<string> removed_paths;
+  {
+    mutex_lock lock(mu_);
+    auto it = file_signature_map_.find(key.first);
+    if (it == file_signature_map_.end() || it->second != signature) {
+      // The file changed while the block was fetched.
+      removed_paths.push_back(path);
+    } else {
+      auto entry = block_map_.find(key);
+      if (entry != block_map_.end()) {
+        // Another read fetched the block at the same time.
+        RemoveBlock(entry, &removed_paths);
+      }
+      Block block;
+      block.signature = signature;
+      block.size = size;
+      block.hash = Hash64(data, size);
+      block.id = id;
+      lru_list_.push_front(key);
+      block.lru_iterator = lru_list_.begin();
+      block_map_.emplace(key, block);
+      cache_size_ += size;
+      ++unsaved_changes_;
+      Trim(&removed_paths);
+    }
+  }
+  DeleteBlockFiles(removed_paths);
+  MaybeSaveIndex();
+}
+
+bool DiskFileBlockCache::ValidateAndUpdateFileSignature(
+    const string& filename, int64_t file_signature) {
+  bool unchanged = true;
+  std::vector<string> removed_paths;
+  {
+    mutex_lock lock(mu_);
+    auto it = file_signature_map_.find(filename);
+    if (it != file_signature_map_.end() && it->second == file_signature) {
+      return true;
+    }
+    unchanged = it == file_signature_map_.end();
+    file_signature_map_[filename] = file_signature;
+    Key begin = std::make_pair(filename, 0);
+    auto entry = block_map_.lower_bound(begin);
+    while (entry != block_map_.end() && entry->first.first == filename) {
+      auto next = std::next(entry);
+      if (entry->second.signature != file_signature) {
+        RemoveBlock(entry, &removed_paths);
+      }
+      entry = next;
+    }
+  }
+  DeleteBlockFiles(removed_paths);
+  MaybeSaveIndex();
+  return unchanged;
+}
+
+void DiskFileBlockCache::RemoveFile(const string& filename) {
+  std::vector<string> removed_paths;
+  {
+    mutex_lock lock(mu_);
+    RemoveFile_Locked(filename, &removed_paths);
+  }
+  DeleteBlockFiles(removed_paths);
+  MaybeSaveIndex();
+}
+
+void DiskFileBlockCache::Flush() {
+  std::vector<string> removed_paths;
+  {
+    mutex_lock lock(mu_);
+    while (!block_map_.empty()) {
+      RemoveBlock(block_map_.begin(), &removed_paths);
+    }
+  }
+  DeleteBlockFiles(removed_paths);
+  if (IsCacheEnabled()) {
+    SaveIndex().IgnoreError();
+  }
+}
+
+size_t DiskFileBlockCache::CacheSize() const {
+  mutex_lock lock(mu_);
+  return cache_size_;
+}
+
+// Remove blocks from the cache until we do not exceed our maximum size.
+void DiskFileBlockCache::Trim(std::vector<string>* removed_paths) {
+  while (!lru_list_.empty() && cache_size_ > max_bytes_) {
+    RemoveBlock(block_map_.find(lru_list_.back()), removed_paths);
+  }
+}
+
+void DiskFileBlockCache::RemoveFile_Locked(const string& filename,
+                                           std::vector<string>* removed_paths) {
+  Key begin = std::make_pair(filename, 0);
+  auto it = block_map_.lower_bound(begin);
+  while (it != block_map_.end() && it->first.first == filename) {
+    auto next = std::next(it);
+    RemoveBlock(it, removed_paths);
+    it = next;
+  }
+}
+
+void DiskFileBlockCache::RemoveBlock(BlockMap::iterator entry,
+                                     std::vector<string>* removed_paths) {
+  removed_paths->push_back(BlockPath(entry->second.id));
+  lru_list_.erase(entry->second.lru_iterator);
+  cache_size_ -= entry->second.size;
+  ++unsaved_changes_;
+  block_map_.erase(entry);
+}
+
+void DiskFileBlockCache::DeleteBlockFiles(const std::vector<string>& paths) {
+  for (const string& path : paths) {
+    Status status = env_->DeleteFile(path);
+    if (!status.ok() && !errors::IsNotFound(status)) {
+      VLOG(1) << "Failed to delete " << path << ": " << status;
+    }
+  }
+}
+
+void DiskFileBlockCache::MaybeSaveIndex() {
+  {
+    mutex_lock lock(mu_);
+    if (unsaved_changes_ < kIndexSaveInterval) return;
+  }
+  Status status = SaveIndex();
+  if (!status.ok()) {
+    LOG_EVERY_N(WARNING, 100)
+        << "Failed to save the index of the block cache in " << cache_dir_
+        << ": " << status;
+  }
+}
+
+// The index consists of a header of the magic number, the block size and the
+// next block id, followed by the blocks from the most to the least recently
+// used, and the Hash64 of all of the above.
+Status DiskFileBlockCache::SaveIndex() {
+  mutex_lock save_lock(save_mu_);
+  string contents;
+  {
+    mutex_lock lock(mu_);
+    core::PutFixed32(&contents, kIndexMagic);
+    core::PutVarint64(&contents, block_size_);
+    core::PutVarint64(&contents, next_id_);
+    core::PutVarint64(&contents, block_map_.size());
+    for (const Key& key : lru_list_) {
+      const Block& block = block_map_.find(key)->second;
+      core::PutVarint64(&contents, key.first.size());
+      contents.append(key.first);
+      core::PutVarint64(&contents, key.second);
+      core::PutFixed64(&contents, block.signature);
+      core::PutVarint64(&contents, block.size);
+      core::PutFixed64(&contents, block.hash);
+      core::PutVarint64(&contents, block.id);
+    }
+    unsaved_changes_ = 0;
+  }
+  core::PutFixed64(&contents, Hash64(contents));
+  // The index is replaced atomically, so that a crash leaves either index.
+  const string tmp_path = strings::StrCat(IndexPath(), ".tmp");
+  TF_RETURN_IF_ERROR(WriteStringToFile(env_, tmp_path, contents));
+  return env_->RenameFile(tmp_path, IndexPath());
+}
+
+void DiskFileBlockCache::LoadIndex() {
+  Status status = env_->RecursivelyCreateDir(cache_dir_);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to create the directory of the block cache "
+                 << cache_dir_ << ": " << status;
+    return;
+  }
+  string contents;
+  status = ReadFileToString(env_, IndexPath(), &contents);
+  std::vector<string> removed_paths;
+  {
+    mutex_lock lock(mu_);
+    if (status.ok() && !ParseIndex(contents)) {
+      LOG(WARNING) << "Ignoring the index of the block cache in " << cache_dir_
+                   << ", which is corrupted or for another block size.";
+      while (!block_map_.empty()) {
+        RemoveBlock(block_map_.begin(), &removed_paths);
+      }
+      removed_paths.clear();
+    }
+    // The blocks written after the index was last saved are not listed, and
+    // the blocks whose files are missing are dropped.
+    std::vector<string> children;
+    status = env_->GetChildren(cache_dir_, &children);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to list the block cache in " << cache_dir_
+                   << ": " << status;
+      children.clear();
+    }
+    std::unordered_set<string> block_files;
+    for (const string& child : children) {
+      if (child != kIndexFileName) {
+        block_files.insert(child);
+      }
+    }
+    for (auto entry = block_map_.begin(); entry != block_map_.end();) {
+      auto next = std::next(entry);
+      const string name = strings::StrCat(entry->second.id, kBlockFileSuffix);
+      if (block_files.erase(name) == 0) {
+        RemoveBlock(entry, &removed_paths);
+      }
+      entry = next;
+    }
+    for (const string& name : block_files) {
+      removed_paths.push_back(io::JoinPath(cache_dir_, name));
+    }
+    Trim(&removed_paths);
+    VLOG(1) << "Loaded " << block_map_.size() << " blocks (" << cache_size_
+            << " bytes) of the block cache in " << cache_dir_;
+  }
+  DeleteBlockFiles(removed_paths);
+}
+
+bool DiskFileBlockCache::ParseIndex(StringPiece contents) {
+  if (contents.size() < sizeof(uint64)) return false;
+  StringPiece checksum = contents.substr(contents.size() - sizeof(uint64));
+  contents.remove_suffix(sizeof(uint64));
+  if (core::DecodeFixed64(checksum.data()) !=
+      Hash64(contents.data(), contents.size())) {
+    return false;
+  }
+  uint64 block_size, next_id, num_blocks;
+  if (contents.size() < sizeof(uint32) ||
+      core::DecodeFixed32(contents.data()) != kIndexMagic) {
+    return false;
+  }
+  contents.remove_prefix(sizeof(uint32));
+  if (!core::GetVarint64(&contents, &block_size) ||
+      !core::GetVarint64(&contents, &next_id) ||
+      !core::GetVarint64(&contents, &num_blocks) ||
+      block_size != block_size_) {
+    return false;
+  }
+  next_id_ = next_id;
+  for (uint64 i = 0; i < num_blocks; ++i) {
+    Key key;
+    uint64 offset, signature, size, hash, id;
+    if (!GetString(&contents, &key.first) ||
+        !core::GetVarint64(&contents, &offset) ||
+        !GetFixed64(&contents, &signature) ||
+        !core::GetVarint64(&contents, &size) ||
+        !GetFixed64(&contents, &hash) || !core::GetVarint64(&contents, &id) ||
+        id >= next_id_ || block_map_.count(std::make_pair(key.first, offset))) {
+      return false;
+    }
+    key.second = offset;
+    Block block;
+    block.signature = static_cast<int64_t>(signature);
+    block.size = size;
+    block.hash = hash;
+    block.id = id;
+    // The blocks are listed from the most to the least recently used.
+    lru_list_.push_back(key);
+    block.lru_iterator = std::prev(lru_list_.end());
+    block_map_.emplace(std::move(key), block);
+    cache_size_ += size;
+  }
+  unsaved_changes_ = 0;
+  return contents.empty();
+}
+
+}  // namespace tsl
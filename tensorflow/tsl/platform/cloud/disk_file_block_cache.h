@@ -0,0 +1,197 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+#define TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/tsl/platform/cloud/file_block_cache.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/thread_annotations.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+
+/// \brief An LRU block cache of file contents on a local disk, keyed by
+/// {filename, offset}.
+///
+/// The blocks are stored as files in a directory of the local disk (e.g. an
+/// SSD), along with an index of the cached blocks. The index is saved when the
+/// cache is destroyed and every few blocks, so that a new cache of the same
+/// directory (e.g. in a restarted job) reads the blocks cached by the previous
+/// one.
+///
+/// The blocks of a file are only cached once its signature (e.g. the GCS
+/// object generation) has been given to ValidateAndUpdateFileSignature, and
+/// are only read back while the signature of the file is the same. The contents
+/// of the blocks are checked against their hash when they are read back, and
+/// the blocks that do not match are fetched again.
+///
+/// To be used as a second tier under a RamFileBlockCache, the cache is the
+/// BlockFetcher of the RamFileBlockCache, with the same block size.
+///
+/// A directory must not be used by several caches at the same time.
+class DiskFileBlockCache : public FileBlockCache {
+ public:
+  /// Loads the index of the blocks cached in `cache_dir`, which is created if
+  /// it does not exist.
+  DiskFileBlockCache(size_t block_size, size_t max_bytes,
+                     const string& cache_dir, BlockFetcher block_fetcher,
+                     Env* env = Env::Default());
+
+  /// Saves the index of the cached blocks.
+  ~DiskFileBlockCache() override;
+
+  Status Read(const string& filename, size_t offset, size_t n, char* buffer,
+              size_t* bytes_transferred) override;
+
+  /// Also removes the blocks of `filename` cached with other signatures, e.g.
+  /// by a previous cache of the directory.
+  bool ValidateAndUpdateFileSignature(const string& filename,
+                                      int64_t file_signature) override
+      TF_LOCKS_EXCLUDED(mu_);
+
+  void RemoveFile(const string& filename) override TF_LOCKS_EXCLUDED(mu_);
+
+  void Flush() override TF_LOCKS_EXCLUDED(mu_);
+
+  size_t block_size() const override { return block_size_; }
+  size_t max_bytes() const override { return max_bytes_; }
+  /// The blocks are validated by the signatures of their files instead.
+  uint64 max_staleness() const override { return 0; }
+
+  size_t CacheSize() const override TF_LOCKS_EXCLUDED(mu_);
+
+  bool IsCacheEnabled() const override {
+    return block_size_ > 0 && max_bytes_ > 0 && !cache_dir_.empty();
+  }
+
+  /// Writes the index of the cached blocks to the cache directory.
+  Status SaveIndex() TF_LOCKS_EXCLUDED(mu_, save_mu_);
+
+ private:
+  /// The key type for the file block cache, a {filename, offset} pair.
+  typedef std::pair<string, size_t> Key;
+
+  /// \brief A block of a file stored in the cache directory.
+  struct Block {
+    /// The signature of the file the block was read from.
+    int64_t signature;
+    /// The number of bytes of the block, less than block_size_ for the last
+    /// block of a file.
+    size_t size;
+    /// Hash64 of the contents of the block.
+    uint64 hash;
+    /// The block is stored in the file BlockPath(id).
+    uint64 id;
+    /// A list iterator pointing to the block's position in the LRU list.
+    std::list<Key>::iterator lru_iterator;
+  };
+
+  typedef std::map<Key, Block> BlockMap;
+
+  /// Reads the block of `filename` at `offset`, which is block-aligned, into
+  /// `buffer`, which has room for block_size_ bytes.
+  Status ReadBlock(const string& filename, size_t offset, char* buffer,
+                   size_t* bytes_transferred) TF_LOCKS_EXCLUDED(mu_);
+
+  /// Reads the cached block `key` of signature `signature` into `buffer`.
+  /// Returns false if it is not cached or cannot be read back.
+  bool LookupBlock(const Key& key, int64_t signature, char* buffer,
+                   size_t* size) TF_LOCKS_EXCLUDED(mu_);
+
+  /// Stores the block `key`, fetched for the signature `signature`.
+  void InsertBlock(const Key& key, int64_t signature, const char* data,
+                   size_t size) TF_LOCKS_EXCLUDED(mu_);
+
+  string BlockPath(uint64 id) const;
+  string IndexPath() const;
+
+  /// Loads the index of the cache directory, and deletes the blocks it does
+  /// not list.
+  void LoadIndex() TF_LOCKS_EXCLUDED(mu_);
+
+  /// Parses the index `contents` into the cache, and returns false if it is
+  /// corrupted or was written for another block size.
+  bool ParseIndex(StringPiece contents) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Trim the block cache to make room for another entry.
+  void Trim(std::vector<string>* removed_paths)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Remove all blocks of a file, with mu_ already held.
+  void RemoveFile_Locked(const string& filename,
+                         std::vector<string>* removed_paths)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Remove the block `entry` from the block map and LRU list, and add the
+  /// path of its file to `removed_paths`.
+  void RemoveBlock(BlockMap::iterator entry, std::vector<string>* removed_paths)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Deletes the files of removed blocks, without holding mu_.
+  void DeleteBlockFiles(const std::vector<string>& paths)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Saves the index if enough blocks were added or removed since it was
+  /// last saved.
+  void MaybeSaveIndex() TF_LOCKS_EXCLUDED(mu_);
+
+  /// The size of the blocks stored in the cache, as well as the size of the
+  /// reads from the underlying filesystem.
+  const size_t block_size_;
+  /// The maximum number of bytes (sum of block sizes) allowed in the cache.
+  const size_t max_bytes_;
+  /// The directory of the block files and the index.
+  const string cache_dir_;
+  /// The callback to read a block from the underlying filesystem.
+  const BlockFetcher block_fetcher_;
+  Env* const env_;  // not owned
+
+  /// Guards access to the block map, LRU list, and cached byte count.
+  mutable mutex mu_;
+
+  /// Serializes the writes of the index.
+  mutex save_mu_ TF_ACQUIRED_BEFORE(mu_);
+
+  BlockMap block_map_ TF_GUARDED_BY(mu_);
+
+  /// The LRU list of block keys. The front of the list identifies the most
+  /// recently accessed block.
+  std::list<Key> lru_list_ TF_GUARDED_BY(mu_);
+
+  /// The combined number of bytes in all of the cached blocks.
+  size_t cache_size_ TF_GUARDED_BY(mu_) = 0;
+
+  /// The id of the next block file.
+  uint64 next_id_ TF_GUARDED_BY(mu_) = 0;
+
+  /// The number of blocks added or removed since the index was last saved.
+  size_t unsaved_changes_ TF_GUARDED_BY(mu_) = 0;
+
+  // A filename->file_signature map.
+  std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
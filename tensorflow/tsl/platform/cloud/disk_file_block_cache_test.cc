@@ -0,0 +1,306 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/platform/cloud/disk_file_block_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/cloud/ram_file_block_cache.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/path.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace tsl {
+namespace {
+
+Status ReadCache(FileBlockCache* cache, const string& filename, size_t offset,
+                 size_t n, std::vector<char>* out) {
+  out->clear();
+  out->resize(n, 0);
+  size_t bytes_transferred = 0;
+  Status status =
+      cache->Read(filename, offset, n, out->data(), &bytes_transferred);
+  EXPECT_LE(bytes_transferred, n);
+  out->resize(bytes_transferred, n);
+  return status;
+}
+
+// A file of `size` bytes, whose reads are counted.
+class FakeFile {
+ public:
+  explicit FakeFile(size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      contents_.push_back(static_cast<char>(i * 7));
+    }
+  }
+
+  FileBlockCache::BlockFetcher fetcher() {
+    return [this](const string& filename, size_t offset, size_t n,
+                  char* buffer, size_t* bytes_transferred) {
+      ++calls_;
+      *bytes_transferred = 0;
+      if (offset < contents_.size()) {
+        *bytes_transferred = std::min(contents_.size() - offset, n);
+        memcpy(buffer, contents_.data() + offset, *bytes_transferred);
+      }
+      return OkStatus();
+    };
+  }
+
+  std::vector<char> Slice(size_t offset, size_t n) const {
+    offset = std::min(offset, contents_.size());
+    n = std::min(n, contents_.size() - offset);
+    return std::vector<char>(contents_.begin() + offset,
+                             contents_.begin() + offset + n);
+  }
+
+  int calls() const { return calls_; }
+
+ private:
+  std::vector<char> contents_;
+  int calls_ = 0;
+};
+
+string MakeCacheDir(const string& name) {
+  string dir = io::JoinPath(testing::TmpDir(), name);
+  int64_t undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  return dir;
+}
+
+std::vector<string> BlockFiles(const string& dir) {
+  std::vector<string> children;
+  TF_CHECK_OK(Env::Default()->GetChildren(dir, &children));
+  std::vector<string> block_files;
+  for (const string& child : children) {
+    if (child != "index") block_files.push_back(child);
+  }
+  return block_files;
+}
+
+TEST(DiskFileBlockCacheTest, IsCacheEnabled) {
+  FakeFile file(0);
+  const string dir = MakeCacheDir("is_cache_enabled");
+  EXPECT_FALSE(DiskFileBlockCache(0, 32, dir, file.fetcher()).IsCacheEnabled());
+  EXPECT_FALSE(DiskFileBlockCache(16, 0, dir, file.fetcher()).IsCacheEnabled());
+  EXPECT_FALSE(DiskFileBlockCache(16, 32, "", file.fetcher()).IsCacheEnabled());
+  EXPECT_TRUE(DiskFileBlockCache(16, 32, dir, file.fetcher()).IsCacheEnabled());
+}
+
+TEST(DiskFileBlockCacheTest, PassThroughWithoutSignature) {
+  FakeFile file(64);
+  DiskFileBlockCache cache(16, 1024, MakeCacheDir("pass_through"),
+                           file.fetcher());
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_EQ(out, file.Slice(0, 16));
+  EXPECT_EQ(file.calls(), 2);
+  EXPECT_EQ(cache.CacheSize(), 0);
+}
+
+TEST(DiskFileBlockCacheTest, BlockAlignment) {
+  const size_t size = 100;
+  FakeFile file(size);
+  DiskFileBlockCache cache(16, 1024, MakeCacheDir("block_alignment"),
+                           file.fetcher());
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 1));
+  for (size_t offset = 0; offset < size + 10; offset += 5) {
+    for (size_t n = 1; n <= 40; n += 13) {
+      std::vector<char> got;
+      Status status = ReadCache(&cache, "file", offset, n, &got);
+      if (offset >= size) {
+        EXPECT_TRUE(errors::IsOutOfRange(status)) << status;
+      } else {
+        TF_EXPECT_OK(status);
+      }
+      EXPECT_EQ(got, file.Slice(offset, n))
+          << "offset = " << offset << ", n = " << n;
+    }
+  }
+  // Each of the 7 blocks of the file was fetched once.
+  EXPECT_EQ(file.calls(), 7);
+  EXPECT_EQ(cache.CacheSize(), size);
+}
+
+TEST(DiskFileBlockCacheTest, ValidateAndUpdateFileSignature) {
+  FakeFile file(64);
+  DiskFileBlockCache cache(16, 1024, MakeCacheDir("signature"),
+                           file.fetcher());
+  std::vector<char> out;
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 123));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_EQ(file.calls(), 1);
+
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 123));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_EQ(file.calls(), 1);
+
+  EXPECT_FALSE(cache.ValidateAndUpdateFileSignature("file", 321));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_EQ(file.calls(), 2);
+  EXPECT_EQ(out, file.Slice(0, 16));
+}
+
+TEST(DiskFileBlockCacheTest, LRU) {
+  FakeFile file(64);
+  const string dir = MakeCacheDir("lru");
+  DiskFileBlockCache cache(16, 32, dir, file.fetcher());
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 1));
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 16, 16, &out));
+  // Block 0 becomes the most recently used, so block 16 is evicted.
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 32, 16, &out));
+  EXPECT_EQ(file.calls(), 3);
+  EXPECT_EQ(cache.CacheSize(), 32);
+  EXPECT_EQ(BlockFiles(dir).size(), 2);
+
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_EQ(file.calls(), 3);
+  TF_EXPECT_OK(ReadCache(&cache, "file", 16, 16, &out));
+  EXPECT_EQ(file.calls(), 4);
+  EXPECT_EQ(out, file.Slice(16, 16));
+}
+
+TEST(DiskFileBlockCacheTest, PersistsAcrossInstances) {
+  FakeFile file(40);
+  const string dir = MakeCacheDir("persists");
+  std::vector<char> out;
+  {
+    DiskFileBlockCache cache(16, 1024, dir, file.fetcher());
+    EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 7));
+    TF_EXPECT_OK(ReadCache(&cache, "file", 0, 40, &out));
+    EXPECT_EQ(file.calls(), 3);
+  }
+  {
+    DiskFileBlockCache cache(16, 1024, dir, file.fetcher());
+    EXPECT_EQ(cache.CacheSize(), 40);
+    EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 7));
+    TF_EXPECT_OK(ReadCache(&cache, "file", 0, 40, &out));
+    EXPECT_EQ(file.calls(), 3);
+    EXPECT_EQ(out, file.Slice(0, 40));
+  }
+  {
+    // The file changed since it was cached.
+    DiskFileBlockCache cache(16, 1024, dir, file.fetcher());
+    EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 8));
+    EXPECT_EQ(cache.CacheSize(), 0);
+    TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+    EXPECT_EQ(file.calls(), 4);
+  }
+  {
+    // The blocks of another block size are dropped.
+    DiskFileBlockCache cache(8, 1024, dir, file.fetcher());
+    EXPECT_EQ(cache.CacheSize(), 0);
+    EXPECT_TRUE(BlockFiles(dir).empty());
+  }
+}
+
+TEST(DiskFileBlockCacheTest, DropsUnlistedBlockFiles) {
+  FakeFile file(64);
+  const string dir = MakeCacheDir("unlisted");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  TF_ASSERT_OK(
+      WriteStringToFile(Env::Default(), io::JoinPath(dir, "5.blk"), "x"));
+  DiskFileBlockCache cache(16, 1024, dir, file.fetcher());
+  EXPECT_EQ(cache.CacheSize(), 0);
+  EXPECT_TRUE(BlockFiles(dir).empty());
+}
+
+TEST(DiskFileBlockCacheTest, CorruptedIndex) {
+  FakeFile file(64);
+  const string dir = MakeCacheDir("corrupted_index");
+  std::vector<char> out;
+  {
+    DiskFileBlockCache cache(16, 1024, dir, file.fetcher());
+    EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 1));
+    TF_EXPECT_OK(ReadCache(&cache, "file", 0, 32, &out));
+  }
+  string index;
+  TF_ASSERT_OK(
+      ReadFileToString(Env::Default(), io::JoinPath(dir, "index"), &index));
+  index[index.size() / 2] ^= 1;
+  TF_ASSERT_OK(
+      WriteStringToFile(Env::Default(), io::JoinPath(dir, "index"), index));
+  DiskFileBlockCache cache(16, 1024, dir, file.fetcher());
+  EXPECT_EQ(cache.CacheSize(), 0);
+  EXPECT_TRUE(BlockFiles(dir).empty());
+}
+
+TEST(DiskFileBlockCacheTest, CorruptedBlock) {
+  FakeFile file(64);
+  const string dir = MakeCacheDir("corrupted_block");
+  DiskFileBlockCache cache(16, 1024, dir, file.fetcher());
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 1));
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  std::vector<string> block_files = BlockFiles(dir);
+  ASSERT_EQ(block_files.size(), 1);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(),
+                                 io::JoinPath(dir, block_files[0]),
+                                 string(16, 'z')));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_EQ(file.calls(), 2);
+  EXPECT_EQ(out, file.Slice(0, 16));
+}
+
+TEST(DiskFileBlockCacheTest, RemoveFileAndFlush) {
+  FakeFile file(64);
+  const string dir = MakeCacheDir("remove_file");
+  DiskFileBlockCache cache(16, 1024, dir, file.fetcher());
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 1));
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("b", 1));
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 32, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "b", 0, 32, &out));
+  cache.RemoveFile("a");
+  EXPECT_EQ(cache.CacheSize(), 32);
+  EXPECT_EQ(BlockFiles(dir).size(), 2);
+  cache.Flush();
+  EXPECT_EQ(cache.CacheSize(), 0);
+  EXPECT_TRUE(BlockFiles(dir).empty());
+}
+
+TEST(DiskFileBlockCacheTest, UnderRamFileBlockCache) {
+  FakeFile file(64);
+  DiskFileBlockCache disk_cache(16, 1024, MakeCacheDir("under_ram"),
+                                file.fetcher());
+  auto fetcher = [&disk_cache](const string& filename, size_t offset, size_t n,
+                               char* buffer, size_t* bytes_transferred) {
+    return disk_cache.Read(filename, offset, n, buffer, bytes_transferred);
+  };
+  std::vector<char> out;
+  for (int i = 0; i < 2; ++i) {
+    // A new RamFileBlockCache per epoch, as after a restart.
+    RamFileBlockCache ram_cache(16, 64, 0, fetcher);
+    EXPECT_TRUE(ram_cache.ValidateAndUpdateFileSignature("file", 1));
+    EXPECT_TRUE(disk_cache.ValidateAndUpdateFileSignature("file", 1));
+    TF_EXPECT_OK(ReadCache(&ram_cache, "file", 0, 64, &out));
+    EXPECT_EQ(out, file.Slice(0, 64));
+  }
+  EXPECT_EQ(file.calls(), 4);
+}
+
+}  // namespace
+}  // namespace tsl
@@ -94,6 +94,12 @@ class FileBlockCache {
   virtual Status Read(const string& filename, size_t offset, size_t n,
                       char* buffer, size_t* bytes_transferred) = 0;
 
+  /// Starts fetching the blocks of `filename` that overlap the range
+  /// [offset, offset + n) and are not cached yet in the background, if the
+  /// cache supports it, so that later reads of the range find them cached.
+  /// The range must not extend past the end of the file.
+  virtual void Prefetch(const string& filename, size_t offset, size_t n) {}
+
   // Validate the given file signature with the existing file signature in the
   // cache. Returns true if the signature doesn't change or the file did not
   // exist before. If the signature changes, update the existing signature with
@@ -39,6 +39,7 @@ limitations under the License.
 #include "absl/base/macros.h"
 #include "json/json.h"
 #include "tensorflow/tsl/platform/cloud/curl_http_request.h"
+#include "tensorflow/tsl/platform/cloud/disk_file_block_cache.h"
 #include "tensorflow/tsl/platform/cloud/file_block_cache.h"
 #include "tensorflow/tsl/platform/cloud/google_auth_provider.h"
 #include "tensorflow/tsl/platform/cloud/ram_file_block_cache.h"
@@ -846,12 +847,25 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+
+  if (GetEnvVar(kReadCacheFetchThreads, strings::safe_strtou64, &value)) {
+    read_cache_fetch_threads_ = value;
+  }
+  if (GetEnvVar(kReadAheadMaxBlocks, strings::safe_strtou64, &value)) {
+    read_ahead_max_blocks_ = value;
+  }
+  if (GetEnvVar(kDiskCacheMaxSize, strings::safe_strtou64, &value)) {
+    disk_cache_max_bytes_ = value * 1024 * 1024;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
+  } else if (const char* disk_cache_dir = std::getenv(kDiskCacheDir)) {
+    disk_cache_dir_ = disk_cache_dir;
   }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "disk cache dir = " << disk_cache_dir_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -1010,7 +1024,10 @@ Status GcsFileSystem::NewRandomAccessFile(
   TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
   TF_RETURN_IF_ERROR(CheckBucketLocationConstraint(bucket));
   if (cache_enabled_) {
-    result->reset(new GcsRandomAccessFile(fname, [this, bucket, object](
+    // Tracks the sequential reads of the file, to read ahead of them.
+    auto read_ahead = std::make_shared<ReadAheadState>();
+    result->reset(new GcsRandomAccessFile(fname, [this, bucket, object,
+                                                  read_ahead](
                                                      const string& fname,
                                                      uint64 offset, size_t n,
                                                      StringPiece* result,
@@ -1028,6 +1045,13 @@ Status GcsFileSystem::NewRandomAccessFile(
             << "File signature has been changed. Refreshing the cache. Path: "
             << fname;
       }
+      if (disk_file_block_cache_ != nullptr) {
+        disk_file_block_cache_->ValidateAndUpdateFileSignature(
+            fname, stat.generation_number);
+      }
+      if (read_cache_fetch_threads_ > 0) {
+        PrefetchBlocks(fname, offset, n, stat.base.length, read_ahead.get());
+      }
       *result = StringPiece();
       size_t bytes_transferred;
       TF_RETURN_IF_ERROR(file_block_cache_->Read(fname, offset, n, scratch,
@@ -1061,10 +1085,43 @@ Status GcsFileSystem::NewRandomAccessFile(
   return OkStatus();
 }
 
+void GcsFileSystem::PrefetchBlocks(const string& fname, uint64 offset,
+                                   size_t n, uint64 file_size,
+                                   ReadAheadState* read_ahead) {
+  if (offset >= file_size) return;
+  const size_t block_size = file_block_cache_->block_size();
+  // Each sequential read doubles the number of blocks read ahead of the next
+  // ones, up to read_ahead_max_blocks_, and any other read resets it.
+  size_t read_ahead_blocks;
+  {
+    mutex_lock l(read_ahead->mu);
+    if (offset == read_ahead->next_offset) {
+      read_ahead->blocks = std::min<size_t>(
+          std::max<size_t>(2 * read_ahead->blocks, 1), read_ahead_max_blocks_);
+    } else {
+      read_ahead->blocks = 0;
+    }
+    read_ahead->next_offset = offset + n;
+    read_ahead_blocks = read_ahead->blocks;
+  }
+  // The blocks of the read after its first one are fetched in parallel, along
+  // with the blocks read ahead.
+  const uint64 prefetch_begin = block_size * (offset / block_size + 1);
+  const uint64 prefetch_end =
+      std::min<uint64>(offset + n + read_ahead_blocks * block_size, file_size);
+  if (prefetch_begin < prefetch_end) {
+    file_block_cache_->Prefetch(fname, prefetch_begin,
+                                prefetch_end - prefetch_begin);
+  }
+}
+
 void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
                                         size_t max_bytes,
                                         uint64 max_staleness_secs) {
   mutex_lock l(block_cache_lock_);
+  // The old cache stops fetching blocks from the disk cache before it is
+  // replaced.
+  file_block_cache_.reset();
   file_block_cache_ =
       MakeFileBlockCache(block_size_bytes, max_bytes, max_staleness_secs);
   if (stats_ != nullptr) {
@@ -1075,16 +1132,34 @@ void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
     size_t block_size, size_t max_bytes, uint64 max_staleness) {
-  std::unique_ptr<FileBlockCache> file_block_cache(new RamFileBlockCache(
-      block_size, max_bytes, max_staleness,
+  FileBlockCache::BlockFetcher block_fetcher =
       [this](const string& filename, size_t offset, size_t n, char* buffer,
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      };
+  // The blocks missing from memory are read through the cache on the local
+  // disk, with the same block size.
+  disk_file_block_cache_.reset();
+  if (!disk_cache_dir_.empty() && block_size > 0 && disk_cache_max_bytes_ > 0) {
+    disk_file_block_cache_.reset(new DiskFileBlockCache(
+        block_size, disk_cache_max_bytes_, disk_cache_dir_, block_fetcher));
+    FileBlockCache* disk_file_block_cache = disk_file_block_cache_.get();
+    block_fetcher = [disk_file_block_cache](const string& filename,
+                                            size_t offset, size_t n,
+                                            char* buffer,
+                                            size_t* bytes_transferred) {
+      return disk_file_block_cache->Read(filename, offset, n, buffer,
+                                         bytes_transferred);
+    };
+  }
+  std::unique_ptr<FileBlockCache> file_block_cache(new RamFileBlockCache(
+      block_size, max_bytes, max_staleness, block_fetcher, Env::Default(),
+      read_cache_fetch_threads_));
 
   // Check if cache is enabled here to avoid unnecessary mutex contention.
-  cache_enabled_ = file_block_cache->IsCacheEnabled();
+  cache_enabled_ = file_block_cache->IsCacheEnabled() ||
+                   disk_file_block_cache_ != nullptr;
   return file_block_cache;
 }
 
@@ -1300,6 +1375,9 @@ Status GcsFileSystem::ParseGcsPath(StringPiece fname, bool empty_object_ok,
 void GcsFileSystem::ClearFileCaches(const string& fname) {
   tf_shared_lock l(block_cache_lock_);
   file_block_cache_->RemoveFile(fname);
+  if (disk_file_block_cache_ != nullptr) {
+    disk_file_block_cache_->RemoveFile(fname);
+  }
   stat_cache_->Delete(fname);
   // TODO(rxsang): Remove the patterns that matche the file in
   // MatchingPathsCache as well.
@@ -2109,6 +2187,9 @@ Status GcsFileSystem::DeleteRecursively(const string& dirname,
 void GcsFileSystem::FlushCaches(TransactionToken* token) {
   tf_shared_lock l(block_cache_lock_);
   file_block_cache_->Flush();
+  if (disk_file_block_cache_ != nullptr) {
+    disk_file_block_cache_->Flush();
+  }
   stat_cache_->Clear();
   matching_paths_cache_->Clear();
   bucket_location_cache_->Clear();
@@ -62,6 +62,23 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets the number of threads that fetch blocks
+// of the LRU cache in parallel, for reads of several blocks and for the
+// read-ahead of sequential reads. 0, the default, disables both.
+constexpr char kReadCacheFetchThreads[] = "GCS_READ_CACHE_FETCH_THREADS";
+// The environment variable that overrides the maximum number of blocks read
+// ahead of the sequential reads of a file, when fetch threads are enabled.
+constexpr char kReadAheadMaxBlocks[] = "GCS_READ_AHEAD_MAX_BLOCKS";
+constexpr size_t kDefaultReadAheadMaxBlocks = 4;
+// The environment variable that sets a directory of the local disk (e.g. on an
+// SSD) where the blocks read from GCS are also cached, under the LRU cache in
+// memory. The blocks are kept across jobs, and validated by the generation of
+// their objects.
+constexpr char kDiskCacheDir[] = "GCS_DISK_CACHE_DIR";
+// The environment variable that overrides the max size of the cache of blocks
+// on the local disk. Specified in MB.
+constexpr char kDiskCacheMaxSize[] = "GCS_DISK_CACHE_MAX_SIZE_MB";
+constexpr size_t kDefaultDiskCacheMaxSize = 10240LL * 1024LL * 1024LL;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -288,6 +305,22 @@ class GcsFileSystem : public FileSystem {
   virtual std::unique_ptr<FileBlockCache> MakeFileBlockCache(
       size_t block_size, size_t max_bytes, uint64 max_staleness);
 
+  /// The sequential reads of a file.
+  struct ReadAheadState {
+    mutex mu;
+    /// The offset that follows the last read.
+    uint64 next_offset TF_GUARDED_BY(mu) = 0;
+    /// The number of blocks read ahead of the last read.
+    size_t blocks TF_GUARDED_BY(mu) = 0;
+  };
+
+  /// Prefetches the blocks of a read of `n` bytes at `offset` of `fname` into
+  /// the block cache, except for the first one, and the blocks that follow
+  /// the read if the file is read sequentially.
+  void PrefetchBlocks(const string& fname, uint64 offset, size_t n,
+                      uint64 file_size, ReadAheadState* read_ahead)
+      TF_SHARED_LOCKS_REQUIRED(block_cache_lock_);
+
   /// Loads file contents from GCS for a given filename, offset, and length.
   virtual Status LoadBufferFromGCS(const string& fname, size_t offset, size_t n,
                                    char* buffer, size_t* bytes_transferred);
@@ -415,9 +448,23 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
-  // block_cache_lock_ protects the file_block_cache_ pointer (Note that
-  // FileBlockCache instances are themselves threadsafe).
+  // The number of threads of the block cache that fetch blocks in parallel.
+  size_t read_cache_fetch_threads_ = 0;
+  // The maximum number of blocks read ahead of sequential reads.
+  size_t read_ahead_max_blocks_ = kDefaultReadAheadMaxBlocks;
+
+  // The directory of the cache of blocks on the local disk, or empty if there
+  // is none.
+  string disk_cache_dir_;
+  // The maximum number of bytes of the cache on the local disk.
+  size_t disk_cache_max_bytes_ = kDefaultDiskCacheMaxSize;
+
+  // block_cache_lock_ protects the file_block_cache_ and disk_file_block_cache_
+  // pointers (Note that FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
+  // The cache on the local disk that file_block_cache_ reads its missing blocks
+  // from, or nullptr. Declared first so that it outlives file_block_cache_.
+  std::unique_ptr<FileBlockCache> disk_file_block_cache_;
   std::unique_ptr<FileBlockCache> file_block_cache_
       TF_GUARDED_BY(block_cache_lock_);
 
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <cstring>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/cleanup/cleanup.h"
 #include "tensorflow/tsl/platform/env.h"
@@ -48,6 +50,11 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
     }
   }
 
+  return Insert(key);
+}
+
+std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Insert(
+    const Key& key) {
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
@@ -229,6 +236,47 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   return OkStatus();
 }
 
+void RamFileBlockCache::Prefetch(const string& filename, size_t offset,
+                                 size_t n) {
+  if (fetch_threads_ == nullptr || n == 0 || n > max_bytes_) return;
+  const size_t start = block_size_ * (offset / block_size_);
+  std::vector<std::pair<Key, std::shared_ptr<Block>>> new_blocks;
+  {
+    mutex_lock lock(mu_);
+    for (size_t pos = start; pos < offset + n; pos += block_size_) {
+      Key key = std::make_pair(filename, pos);
+      // Readers refresh the blocks that are cached but stale.
+      if (block_map_.find(key) != block_map_.end()) continue;
+      new_blocks.emplace_back(key, Insert(key));
+    }
+  }
+  for (auto& key_and_block : new_blocks) {
+    fetch_threads_->Schedule([this, key_and_block]() {
+      const Key& key = key_and_block.first;
+      const std::shared_ptr<Block>& block = key_and_block.second;
+      {
+        // A reader may have started to fetch the block itself.
+        mutex_lock l(block->mu);
+        if (block->state != FetchState::CREATED) return;
+      }
+      // The block was evicted before it could be fetched.
+      {
+        mutex_lock lock(mu_);
+        if (block->timestamp == 0) return;
+      }
+      Status status = MaybeFetch(key, block);
+      if (!status.ok()) {
+        // A reader of the block fetches it again.
+        VLOG(1) << "Failed to prefetch " << key.first << " @ " << key.second
+                << ": " << status;
+        return;
+      }
+      mutex_lock lock(mu_);
+      Trim();
+    });
+  }
+}
+
 bool RamFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
                                                        int64_t file_signature) {
   mutex_lock lock(mu_);
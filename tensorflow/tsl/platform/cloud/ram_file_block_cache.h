@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
 #include "tensorflow/tsl/platform/thread_annotations.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 #include "tensorflow/tsl/platform/types.h"
 
 namespace tsl {
@@ -50,8 +51,11 @@ class RamFileBlockCache : public FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// Blocks are prefetched by up to `num_fetch_threads` threads. No blocks
+  /// are prefetched if it is 0.
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t num_fetch_threads = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
@@ -61,11 +65,17 @@ class RamFileBlockCache : public FileBlockCache {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (num_fetch_threads > 0 && IsCacheEnabled()) {
+      fetch_threads_.reset(new thread::ThreadPool(env_, "TF_fetch_FBC",
+                                                  num_fetch_threads));
+    }
     VLOG(1) << "GCS file block cache is "
             << (IsCacheEnabled() ? "enabled" : "disabled");
   }
 
   ~RamFileBlockCache() override {
+    // Waits for the blocks being prefetched.
+    fetch_threads_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -91,6 +101,10 @@ class RamFileBlockCache : public FileBlockCache {
   Status Read(const string& filename, size_t offset, size_t n, char* buffer,
               size_t* bytes_transferred) override;
 
+  /// Fetches the blocks on the fetch threads, several at a time.
+  void Prefetch(const string& filename, size_t offset, size_t n) override
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Validate the given file signature with the existing file signature in the
   // cache. Returns true if the signature doesn't change or the file doesn't
   // exist before. If the signature changes, update the existing signature with
@@ -197,6 +211,10 @@ class RamFileBlockCache : public FileBlockCache {
   /// Look up a Key in the block cache.
   std::shared_ptr<Block> Lookup(const Key& key) TF_LOCKS_EXCLUDED(mu_);
 
+  /// Insert a new empty block for `key`, which must not be in the cache.
+  std::shared_ptr<Block> Insert(const Key& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
 
@@ -221,6 +239,10 @@ class RamFileBlockCache : public FileBlockCache {
   /// Notification for stopping the cache pruning thread.
   Notification stop_pruning_thread_;
 
+  /// The threads that prefetch blocks, or nullptr if blocks are not
+  /// prefetched.
+  std::unique_ptr<thread::ThreadPool> fetch_threads_;
+
   /// Guards access to the block map, LRU list, and cached byte count.
   mutable mutex mu_;
 
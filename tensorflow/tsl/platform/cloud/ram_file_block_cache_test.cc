@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/tsl/platform/cloud/ram_file_block_cache.h"
 
+#include <atomic>
 #include <cstring>
 
 #include "tensorflow/tsl/lib/core/status_test_util.h"
@@ -513,6 +514,36 @@ TEST(RamFileBlockCacheTest, ParallelReads) {
   // executed, or 10 seconds have passed).
 }
 
+TEST(RamFileBlockCacheTest, Prefetch) {
+  // This fetcher won't respond until `num_blocks` fetches are running
+  // concurrently, or 10 seconds have elapsed.
+  const int num_blocks = 4;
+  BlockingCounter counter(num_blocks);
+  std::atomic<int> calls(0);
+  auto fetcher = [&counter, &calls](const string& filename, size_t offset,
+                                    size_t n, char* buffer,
+                                    size_t* bytes_transferred) {
+    ++calls;
+    counter.DecrementCount();
+    if (!counter.WaitFor(std::chrono::seconds(10))) {
+      return errors::FailedPrecondition("desired concurrency not reached");
+    }
+    memset(buffer, 'a' + offset / n, n);
+    *bytes_transferred = n;
+    return OkStatus();
+  };
+  const int block_size = 8;
+  RamFileBlockCache cache(block_size, 2 * num_blocks * block_size, 0, fetcher,
+                          Env::Default(), /*num_fetch_threads=*/num_blocks);
+  cache.Prefetch("a", 3, num_blocks * block_size - 3);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, num_blocks * block_size, &out));
+  for (int i = 0; i < num_blocks; ++i) {
+    EXPECT_EQ(out[i * block_size], 'a' + i);
+  }
+  EXPECT_EQ(calls, num_blocks);
+}
+
 TEST(RamFileBlockCacheTest, CoalesceConcurrentReads) {
   // Concurrent reads to the same file blocks should be de-duplicated.
   const size_t block_size = 16;
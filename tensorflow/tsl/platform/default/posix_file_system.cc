@@ -29,13 +29,33 @@ limitations under the License.
 #include <time.h>
 #include <unistd.h>
 
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define TSL_POSIX_IO_URING 1
+#endif
+#endif
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/tsl/platform/default/posix_file_system.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/file_system_helper.h"
 #include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/platform/mutex.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/strcat.h"
+#include "tensorflow/tsl/platform/thread_annotations.h"
 #include "tensorflow/tsl/protobuf/error_codes.pb.h"
 
 namespace tsl {
@@ -45,6 +65,247 @@ using ::tsl::errors::IOError;
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
+#if defined(TSL_POSIX_IO_URING)
+// Reads files through an io_uring shared by the whole process, so that a few
+// threads can keep many reads in flight. Reads that are started while another
+// thread is submitting are submitted along with its reads, in one
+// io_uring_enter() call. A single thread reaps the completions and runs the
+// callbacks of the reads.
+//
+// Enabled by setting the environment variable TF_POSIX_IO_URING to 1.
+class PosixIoUring {
+ public:
+  // Called with the number of bytes read and 0, or with the errno of the read
+  // that failed.
+  typedef std::function<void(size_t bytes_read, int error)> DoneCallback;
+
+  // Returns the ring of the process, or nullptr if io_uring is not enabled
+  // or not supported by the kernel.
+  static PosixIoUring* Get() {
+    static PosixIoUring* ring = []() -> PosixIoUring* {
+      const char* enabled = std::getenv("TF_POSIX_IO_URING");
+      if (enabled == nullptr || std::strcmp(enabled, "1") != 0) {
+        return nullptr;
+      }
+      PosixIoUring* ring = new PosixIoUring;
+      if (!ring->Init()) {
+        LOG(WARNING) << "io_uring is not available, reading files with pread: "
+                     << strerror(errno);
+        delete ring;
+        return nullptr;
+      }
+      return ring;
+    }();
+    return ring;
+  }
+
+  // Reads `n` bytes at `offset` of `fd` into `dst`, or up to the end of the
+  // file, and then calls `done`.
+  void Read(int fd, uint64 offset, size_t n, char* dst, DoneCallback done) {
+    Request* request = new Request;
+    request->fd = fd;
+    request->offset = offset;
+    request->dst = dst;
+    request->remaining = n;
+    request->done = std::move(done);
+    {
+      mutex_lock l(mu_);
+      while (num_in_flight_ >= num_entries_) space_.wait(l);
+      ++num_in_flight_;
+      Push(request);
+    }
+    Submit();
+  }
+
+ private:
+  struct Request {
+    int fd;
+    uint64 offset;
+    char* dst;
+    size_t remaining;
+    size_t bytes_read = 0;
+    int error = 0;
+    struct iovec iov;
+    DoneCallback done;
+  };
+
+  // The number of entries of the submission queue. At most this many reads
+  // are in flight.
+  static constexpr unsigned kNumEntries = 256;
+
+  PosixIoUring() = default;
+
+  ~PosixIoUring() {
+    if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+    if (cq_ring_ != MAP_FAILED) munmap(cq_ring_, cq_ring_size_);
+    if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+    if (fd_ >= 0) close(fd_);
+  }
+
+  // Sets up the ring and starts the completion thread. Returns false, with
+  // errno set, on failure.
+  bool Init() {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    fd_ = syscall(__NR_io_uring_setup, kNumEntries, &params);
+    if (fd_ < 0) return false;
+    num_entries_ = params.sq_entries;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) return false;
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) return false;
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED) return false;
+
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Never joined, as the ring lives as long as the process.
+    Env::Default()->StartThread(ThreadOptions(), "tf_io_uring",
+                                [this]() { ReapCompletions(); });
+    return true;
+  }
+
+  // Adds a read of the rest of `request` to the submission queue. The queue
+  // has room for it, as it has as many entries as there are reads in flight.
+  void Push(Request* request) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    request->iov.iov_base = request->dst;
+    request->iov.iov_len =
+        std::min<size_t>(request->remaining, static_cast<size_t>(INT32_MAX));
+    const unsigned tail = *sq_tail_;
+    const unsigned index = tail & sq_mask_;
+    struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(sqes_) + index;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = request->fd;
+    sqe->addr = reinterpret_cast<uint64>(&request->iov);
+    sqe->len = 1;
+    sqe->off = request->offset;
+    sqe->user_data = reinterpret_cast<uint64>(request);
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    ++num_unsubmitted_;
+  }
+
+  // Submits the pushed reads, unless another thread is already submitting,
+  // in which case that thread also submits them.
+  void Submit() {
+    {
+      mutex_lock l(mu_);
+      if (submitting_) return;
+      submitting_ = true;
+    }
+    while (true) {
+      unsigned to_submit;
+      {
+        mutex_lock l(mu_);
+        if (num_unsubmitted_ == 0) {
+          submitting_ = false;
+          return;
+        }
+        to_submit = num_unsubmitted_;
+      }
+      const int submitted =
+          syscall(__NR_io_uring_enter, fd_, to_submit, 0, 0, nullptr, 0);
+      if (submitted < 0) {
+        // The pushed entries stay in the queue and are submitted again.
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+          LOG(FATAL) << "io_uring_enter() failed: " << strerror(errno);
+        }
+        continue;
+      }
+      mutex_lock l(mu_);
+      num_unsubmitted_ -= submitted;
+    }
+  }
+
+  // Runs on the completion thread.
+  void ReapCompletions() {
+    std::vector<Request*> finished;
+    while (true) {
+      if (syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS,
+                  nullptr, 0) < 0 &&
+          errno != EINTR) {
+        LOG(ERROR) << "io_uring_enter() failed: " << strerror(errno);
+      }
+      bool resubmit = false;
+      {
+        mutex_lock l(mu_);
+        unsigned head = *cq_head_;
+        const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+          const struct io_uring_cqe& cqe = cqes_[head & cq_mask_];
+          Request* request = reinterpret_cast<Request*>(cqe.user_data);
+          if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+            // Retry
+          } else if (cqe.res < 0) {
+            request->error = -cqe.res;
+          } else {
+            request->dst += cqe.res;
+            request->offset += cqe.res;
+            request->remaining -= cqe.res;
+            request->bytes_read += cqe.res;
+          }
+          if (request->error == 0 && request->remaining > 0 && cqe.res != 0) {
+            // The request keeps its place among the reads in flight.
+            Push(request);
+            resubmit = true;
+          } else {
+            finished.push_back(request);
+          }
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        num_in_flight_ -= finished.size();
+        space_.notify_all();
+      }
+      if (resubmit) Submit();
+      for (Request* request : finished) {
+        request->done(request->bytes_read, request->error);
+        delete request;
+      }
+      finished.clear();
+    }
+  }
+
+  int fd_ = -1;
+  void* sq_ring_ = MAP_FAILED;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = MAP_FAILED;
+  size_t cq_ring_size_ = 0;
+  void* sqes_ = MAP_FAILED;
+  size_t sqes_size_ = 0;
+  unsigned num_entries_ = 0;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  struct io_uring_cqe* cqes_ = nullptr;
+
+  mutex mu_;
+  condition_variable space_;
+  unsigned num_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  unsigned num_unsubmitted_ TF_GUARDED_BY(mu_) = 0;
+  bool submitting_ TF_GUARDED_BY(mu_) = false;
+};
+#endif  // TSL_POSIX_IO_URING
+
 // pread() based random-access
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
@@ -96,6 +357,38 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 
+  void ReadAsync(
+      uint64 offset, size_t n, char* scratch,
+      std::function<void(const Status&, StringPiece)> done) const override {
+#if defined(TSL_POSIX_IO_URING)
+    PosixIoUring* ring = PosixIoUring::Get();
+    if (ring != nullptr && n > 0) {
+      ring->Read(fd_, offset, n, scratch,
+                 [filename = filename_, n, scratch, done = std::move(done)](
+                     size_t bytes_read, int error) {
+                   Status s;
+                   if (error != 0) {
+                     s = IOError(filename, error);
+                   } else if (bytes_read < n) {
+                     s = Status(error::OUT_OF_RANGE,
+                                "Read less bytes than requested");
+                   }
+                   done(s, StringPiece(scratch, bytes_read));
+                 });
+      return;
+    }
+#endif
+    RandomAccessFile::ReadAsync(offset, n, scratch, std::move(done));
+  }
+
+  bool SupportsAsyncRead() const override {
+#if defined(TSL_POSIX_IO_URING)
+    return PosixIoUring::Get() != nullptr;
+#else
+    return false;
+#endif
+  }
+
 #if defined(TF_CORD_SUPPORT)
   Status Read(uint64 offset, size_t n, absl::Cord* cord) const override {
     if (n == 0) {
@@ -125,6 +418,110 @@ class PosixRandomAccessFile : public RandomAccessFile {
 #endif
 };
 
+#if defined(O_DIRECT)
+// pread() based random-access with O_DIRECT, which bypasses the page cache.
+// Reads at aligned offsets into aligned buffers go straight to the caller's
+// buffer. Other reads go through an aligned buffer, one chunk at a time.
+class PosixDirectIoRandomAccessFile : public RandomAccessFile {
+ private:
+  // The alignment of the offsets, sizes and buffers of O_DIRECT reads. A
+  // multiple of the logical block size of the devices in use.
+  static constexpr size_t kAlignment = 4096;
+  // The size of the chunks of unaligned reads.
+  static constexpr size_t kChunkSize = 1024 * 1024;
+
+  string filename_;
+  int fd_;
+
+  static bool IsAligned(uint64 value) { return value % kAlignment == 0; }
+
+  // Reads up to `n` bytes at `offset` into `dst`, all of them aligned.
+  // Returns the number of bytes read, fewer than `n` at the end of the file.
+  Status ReadAligned(uint64 offset, size_t n, char* dst,
+                     size_t* bytes_read) const {
+    *bytes_read = 0;
+    while (n > 0) {
+      // Keep the length of each read aligned and within an int32.
+      const size_t requested_read_length =
+          std::min<size_t>(n, INT32_MAX / kAlignment * kAlignment);
+      ssize_t r =
+          pread(fd_, dst, requested_read_length, static_cast<off_t>(offset));
+      if (r > 0) {
+        dst += r;
+        n -= r;
+        offset += r;
+        *bytes_read += r;
+        // Only the last block of the file can be read partially.
+        if (!IsAligned(r)) break;
+      } else if (r == 0) {
+        break;
+      } else if (errno == EINTR || errno == EAGAIN) {
+        // Retry
+      } else {
+        return IOError(filename_, errno);
+      }
+    }
+    return OkStatus();
+  }
+
+ public:
+  PosixDirectIoRandomAccessFile(const string& fname, int fd)
+      : filename_(fname), fd_(fd) {}
+  ~PosixDirectIoRandomAccessFile() override {
+    if (close(fd_) < 0) {
+      LOG(ERROR) << "close() failed: " << strerror(errno);
+    }
+  }
+
+  Status Name(StringPiece* result) const override {
+    *result = filename_;
+    return OkStatus();
+  }
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    size_t bytes_read = 0;
+    Status s;
+    if (IsAligned(offset) && IsAligned(n) &&
+        IsAligned(reinterpret_cast<uintptr_t>(scratch))) {
+      s = ReadAligned(offset, n, scratch, &bytes_read);
+    } else {
+      void* chunk = nullptr;
+      if (posix_memalign(&chunk, kAlignment, kChunkSize) != 0) {
+        return errors::ResourceExhausted("Unable to allocate ", kChunkSize,
+                                         " bytes for reading ", filename_);
+      }
+      std::unique_ptr<char, decltype(&free)> chunk_deleter(
+          static_cast<char*>(chunk), &free);
+      while (bytes_read < n) {
+        const uint64 pos = offset + bytes_read;
+        const uint64 chunk_offset = pos - pos % kAlignment;
+        const size_t skip = pos - chunk_offset;
+        const size_t chunk_bytes =
+            std::min<uint64>(kChunkSize, pos + (n - bytes_read) - chunk_offset +
+                                             kAlignment - 1) /
+            kAlignment * kAlignment;
+        size_t chunk_bytes_read;
+        s = ReadAligned(chunk_offset, chunk_bytes, static_cast<char*>(chunk),
+                        &chunk_bytes_read);
+        if (!s.ok() || chunk_bytes_read <= skip) break;
+        const size_t copy_bytes =
+            std::min<size_t>(chunk_bytes_read - skip, n - bytes_read);
+        memcpy(scratch + bytes_read, static_cast<char*>(chunk) + skip,
+               copy_bytes);
+        bytes_read += copy_bytes;
+        if (chunk_bytes_read < chunk_bytes) break;
+      }
+    }
+    *result = StringPiece(scratch, bytes_read);
+    if (s.ok() && bytes_read < n) {
+      s = Status(error::OUT_OF_RANGE, "Read less bytes than requested");
+    }
+    return s;
+  }
+};
+#endif  // O_DIRECT
+
 class PosixWritableFile : public WritableFile {
  private:
   string filename_;
@@ -235,6 +632,22 @@ Status PosixFileSystem::NewRandomAccessFile(
   return s;
 }
 
+Status PosixFileSystem::NewDirectIoRandomAccessFile(
+    const string& fname, TransactionToken* token,
+    std::unique_ptr<RandomAccessFile>* result) {
+#if defined(O_DIRECT)
+  string translated_fname = TranslateName(fname);
+  int fd = open(translated_fname.c_str(), O_RDONLY | O_DIRECT);
+  if (fd >= 0) {
+    result->reset(new PosixDirectIoRandomAccessFile(translated_fname, fd));
+    return OkStatus();
+  }
+  // File systems such as tmpfs do not support O_DIRECT.
+  if (errno != EINVAL) return IOError(fname, errno);
+#endif
+  return NewRandomAccessFile(fname, token, result);
+}
+
 Status PosixFileSystem::NewWritableFile(const string& fname,
                                         TransactionToken* token,
                                         std::unique_ptr<WritableFile>* result) {
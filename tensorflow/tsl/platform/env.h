@@ -131,6 +131,12 @@ class Env {
     return OkStatus();
   }
 
+  /// \brief Creates a random access read-only file like
+  /// NewRandomAccessFile(), whose reads bypass the page cache where the file
+  /// system supports it. See FileSystem::NewDirectIoRandomAccessFile().
+  Status NewDirectIoRandomAccessFile(const std::string& fname,
+                                     std::unique_ptr<RandomAccessFile>* result);
+
   /// \brief Creates an object that writes to a new file with the specified
   /// name.
   ///
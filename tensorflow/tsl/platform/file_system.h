@@ -80,6 +80,24 @@ class FileSystem {
     return OkStatus();
   }
 
+  /// \brief Creates a random access read-only file like
+  /// NewRandomAccessFile(), whose reads bypass the page cache of the host
+  /// where the file system supports it, e.g. with O_DIRECT.
+  ///
+  /// Meant for large files that are streamed once, such as training data and
+  /// checkpoints, so that they do not evict more useful cached data. The
+  /// default implementation calls NewRandomAccessFile().
+  virtual tsl::Status NewDirectIoRandomAccessFile(
+      const std::string& fname, std::unique_ptr<RandomAccessFile>* result) {
+    return NewDirectIoRandomAccessFile(fname, nullptr, result);
+  }
+
+  virtual tsl::Status NewDirectIoRandomAccessFile(
+      const std::string& fname, TransactionToken* token,
+      std::unique_ptr<RandomAccessFile>* result) {
+    return NewRandomAccessFile(fname, token, result);
+  }
+
   /// \brief Creates an object that writes to a new file with the specified
   /// name.
   ///
@@ -546,6 +564,7 @@ class FileSystem {
 // TODO(sami): Remove this macro when filesystem plugins migration is complete.
 #define TF_USE_FILESYSTEM_METHODS_WITH_NO_TRANSACTION_SUPPORT \
   using FileSystem::NewRandomAccessFile;                      \
+  using FileSystem::NewDirectIoRandomAccessFile;              \
   using FileSystem::NewWritableFile;                          \
   using FileSystem::NewAppendableFile;                        \
   using FileSystem::NewReadOnlyMemoryRegionFromFile;          \
@@ -581,6 +600,13 @@ class WrappedFileSystem : public FileSystem {
     return fs_->NewRandomAccessFile(fname, (token ? token : token_), result);
   }
 
+  tsl::Status NewDirectIoRandomAccessFile(
+      const std::string& fname, TransactionToken* token,
+      std::unique_ptr<RandomAccessFile>* result) override {
+    return fs_->NewDirectIoRandomAccessFile(fname, (token ? token : token_),
+                                            result);
+  }
+
   tsl::Status NewWritableFile(const std::string& fname, TransactionToken* token,
                               std::unique_ptr<WritableFile>* result) override {
     return fs_->NewWritableFile(fname, (token ? token : token_), result);
@@ -765,6 +791,30 @@ class RandomAccessFile {
   virtual tsl::Status Read(uint64 offset, size_t n, StringPiece* result,
                            char* scratch) const = 0;
 
+  /// \brief Starts reading up to `n` bytes from the file starting at
+  /// `offset` into `scratch[0..n-1]`.
+  ///
+  /// Calls `done` with the status and data of the read, as Read() would
+  /// return them, once the read is done. `done` may be called on another
+  /// thread or before ReadAsync() returns, and should not block.
+  /// `scratch[0..n-1]` and the file must be live until `done` is called.
+  ///
+  /// The default implementation reads synchronously with Read(). See
+  /// SupportsAsyncRead().
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadAsync(
+      uint64 offset, size_t n, char* scratch,
+      std::function<void(const tsl::Status&, StringPiece)> done) const {
+    StringPiece result;
+    tsl::Status s = Read(offset, n, &result, scratch);
+    done(s, result);
+  }
+
+  /// \brief Returns true if ReadAsync() returns before the read is done, so
+  /// that a single thread can keep many reads in flight.
+  virtual bool SupportsAsyncRead() const { return false; }
+
 #if defined(TF_CORD_SUPPORT)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
   virtual tsl::Status Read(uint64 offset, size_t n, absl::Cord* cord) const {
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/tsl/profiler/rpc/profiler_service_impl.h"
 
 #include <memory>
+#include <utility>
 
 #include "grpcpp/support/status.h"
 #include "absl/container/flat_hash_map.h"
@@ -66,9 +67,21 @@ Status CollectDataToRepository(const ProfileRequest& request,
 
 class ProfilerServiceImpl : public tensorflow::grpc::ProfilerService::Service {
  public:
+  explicit ProfilerServiceImpl(MonitorFunction monitor = nullptr)
+      : monitor_(std::move(monitor)) {}
+
   ::grpc::Status Monitor(::grpc::ServerContext* ctx, const MonitorRequest* req,
                          MonitorResponse* response) override {
-    return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "unimplemented.");
+    if (!monitor_) {
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED,
+                            "unimplemented.");
+    }
+    Status status = monitor_(*req, response);
+    if (!status.ok()) {
+      return ::grpc::Status(::grpc::StatusCode::INTERNAL,
+                            status.error_message());
+    }
+    return ::grpc::Status::OK;
   }
 
   ::grpc::Status Profile(::grpc::ServerContext* ctx, const ProfileRequest* req,
@@ -121,6 +134,7 @@ class ProfilerServiceImpl : public tensorflow::grpc::ProfilerService::Service {
     return it != stop_signals_per_session_.end() && it->second;
   }
 
+  const MonitorFunction monitor_;
   mutex mutex_;
   absl::flat_hash_map<std::string, bool> stop_signals_per_session_
       ABSL_GUARDED_BY(mutex_);
@@ -133,5 +147,10 @@ CreateProfilerService() {
   return std::make_unique<ProfilerServiceImpl>();
 }
 
+std::unique_ptr<tensorflow::grpc::ProfilerService::Service>
+CreateProfilerService(MonitorFunction monitor) {
+  return std::make_unique<ProfilerServiceImpl>(std::move(monitor));
+}
+
 }  // namespace profiler
 }  // namespace tsl
@@ -15,16 +15,27 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PROFILER_RPC_PROFILER_SERVICE_IMPL_H_
 #define TENSORFLOW_TSL_PROFILER_RPC_PROFILER_SERVICE_IMPL_H_
 
+#include <functional>
 #include <memory>
 
+#include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/profiler/protobuf/profiler_service.grpc.pb.h"
+#include "tensorflow/tsl/profiler/protobuf/profiler_service.pb.h"
 
 namespace tsl {
 namespace profiler {
 
+// Serves the Monitor rpc of a profiler service.
+using MonitorFunction = std::function<Status(
+    const tensorflow::MonitorRequest&, tensorflow::MonitorResponse*)>;
+
 std::unique_ptr<tensorflow::grpc::ProfilerService::Service>
 CreateProfilerService();
 
+// Creates a profiler service whose Monitor rpc is served by `monitor`.
+std::unique_ptr<tensorflow::grpc::ProfilerService::Service>
+CreateProfilerService(MonitorFunction monitor);
+
 }  // namespace profiler
 }  // namespace tsl
 
@@ -209,6 +209,8 @@ const StatTypeMap& GetStatTypeMap() {
       {"kpi_value", kKpiValue},
       {"element_id", kElementId},
       {"parent_id", kParentId},
+      {"model_processing_time_ns", kModelProcessingTimeNs},
+      {"model_buffered_elements", kModelBufferedElements},
       // XPlane semantics related.
       {"_pt", kProducerType},
       {"_ct", kConsumerType},
@@ -199,6 +199,9 @@ enum StatType {
   kKpiValue,
   kElementId,
   kParentId,
+  // tf.data autotuning model statistics of an iterator.
+  kModelProcessingTimeNs,
+  kModelBufferedElements,
   // XPlane semantics related.
   kProducerType,
   kConsumerType,
@@ -602,6 +602,15 @@ def _tf_repositories():
         urls = tf_mirror_urls("https://github.com/google/snappy/archive/984b191f0fefdeb17050b42a90b7625999c13b8d.tar.gz"),
     )
 
+    tf_http_archive(
+        name = "zstd",
+        build_file = "//third_party:zstd.BUILD",
+        sha256 = "9c4396cc829cfae319a6e2615202e82aad41372073482fce286fac78646d3ee4",
+        strip_prefix = "zstd-1.5.5",
+        system_build_file = "//third_party/systemlibs:zstd.BUILD",
+        urls = tf_mirror_urls("https://github.com/facebook/zstd/releases/download/v1.5.5/zstd-1.5.5.tar.gz"),
+    )
+
     tf_http_archive(
         name = "nccl_archive",
         build_file = "//third_party:nccl/archive.BUILD",
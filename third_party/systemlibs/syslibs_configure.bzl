@@ -45,6 +45,7 @@ VALID_LIBS = [
     "typing_extensions_archive",
     "wrapt",
     "zlib",
+    "zstd",
 ]
 
 def auto_configure_fail(msg):